@@ -434,6 +434,79 @@ local function SafeWrapGadget(gadget)
 end
 
 
+--------------------------------------------------------------------------------
+--
+--  sim-cost attribution (see /simcost); while the engine records it, the
+--  call-ins of every synced gadget are timed under the gadget's name
+--
+
+local IsSimCostProfilerEnabled = Spring.IsSimCostProfilerEnabled -- nil if unsynced
+local BeginSimCostScope = Spring.BeginSimCostScope
+local EndSimCostScope = Spring.EndSimCostScope
+
+local simCostWrapped = false
+local simCostFuncs = {} -- [gadget] = { [ciName] = { original, wrapper } }
+
+
+local function SimCostWrapGadget(gadget)
+  local gadgetName = gadget.ghInfo.name
+  local funcs = {}
+
+  for _,ciName in ipairs(CALLIN_LIST) do
+    local func = gadget[ciName]
+    if (type(func) == 'function') then
+      local wrapper = function(...)
+        local depth = BeginSimCostScope(gadgetName)
+        return EndSimCostScope(depth, func(...))
+      end
+      gadget[ciName] = wrapper
+      funcs[ciName] = { func, wrapper }
+    end
+  end
+
+  simCostFuncs[gadget] = funcs
+end
+
+
+local function SimCostUnwrapGadget(gadget)
+  local funcs = simCostFuncs[gadget]
+  if (funcs == nil) then
+    return
+  end
+
+  for ciName,f in pairs(funcs) do
+    -- leave call-ins the gadget has replaced since alone
+    if (gadget[ciName] == f[2]) then
+      gadget[ciName] = f[1]
+    end
+  end
+
+  simCostFuncs[gadget] = nil
+end
+
+
+function gadgetHandler:UpdateSimCostWrappers()
+  if (IsSimCostProfilerEnabled == nil) then
+    return
+  end
+
+  local enabled = IsSimCostProfilerEnabled()
+  if (enabled == simCostWrapped) then
+    return
+  end
+
+  for _,g in ipairs(self.gadgets) do
+    if (enabled) then
+      SimCostWrapGadget(g)
+    else
+      SimCostUnwrapGadget(g)
+    end
+  end
+
+  simCostWrapped = enabled
+end
+
+
 --------------------------------------------------------------------------------
 
 local function ArrayInsert(t, g)
@@ -480,6 +553,10 @@ function gadgetHandler:InsertGadget(gadget)
     end
   end
 
+  if (simCostWrapped) then
+    SimCostWrapGadget(gadget)
+  end
+
   self:UpdateCallIns()
   if (gadget.Initialize) then
     gadget:Initialize()
@@ -499,6 +576,7 @@ function gadgetHandler:RemoveGadget(gadget)
     gadget:Shutdown()
   end
 
+  SimCostUnwrapGadget(gadget)
   ArrayRemove(self.gadgets, gadget)
   self:RemoveGadgetGlobals(gadget)
   actionHandler.RemoveGadgetActions(gadget)
@@ -873,6 +951,8 @@ function gadgetHandler:GameOver(winningAllyTeams)
 end
 
 function gadgetHandler:GameFrame(frameNum)
+  self:UpdateSimCostWrappers()
+
   for _,g in r_ipairs(self.GameFrameList) do
     g:GameFrame(frameNum)
   end
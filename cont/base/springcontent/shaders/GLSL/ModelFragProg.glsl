@@ -33,8 +33,11 @@ uniform vec4 teamColor;
 uniform vec4 nanoColor;
 // uniform float alphaPass;
 
-// fwdDynLights[i] := {pos, dir, diffuse, specular, ambient, {fov, radius, -, -}}
-uniform vec4 fwdDynLights[MAX_LIGHT_UNIFORM_VECS];
+// lightDataTex[i * 6 + k] := {pos, dir, diffuse, specular, ambient, {fov, radius, -, -}}[k]
+// lightGridTex[c] := first index of cell c's light list, lightGridTex[c + 1] := end
+uniform samplerBuffer lightDataTex;
+uniform isamplerBuffer lightGridTex;
+uniform vec4 lightGridParams; // {1/cellSize, 1/cellSize, numCellsX, numCellsZ}
 
 
 in vec4 worldPos;
@@ -75,21 +78,28 @@ vec3 DynamicLighting(vec3 wsNormal, vec3 diffuseColor, vec4 specularColor) {
 	vec3 light = vec3(0.0);
 
 	#if (NUM_DYNAMIC_MODEL_LIGHTS > 0)
-	for (int i = 0; i < NUM_DYNAMIC_MODEL_LIGHTS; i++) {
-		int j = i * 6;
+	ivec2 lightGridSize = ivec2(lightGridParams.zw);
+	ivec2 lightGridCell = clamp(ivec2(worldPos.xz * lightGridParams.xy), ivec2(0), lightGridSize - ivec2(1));
 
-		vec4 wsLightPos = fwdDynLights[j + 0];
-		vec4 wsLightDir = fwdDynLights[j + 1];
+	int lightCellIdx = lightGridCell.y * lightGridSize.x + lightGridCell.x;
+	int lightListBeg = texelFetch(lightGridTex, lightCellIdx    ).x;
+	int lightListEnd = texelFetch(lightGridTex, lightCellIdx + 1).x;
 
-		vec4 lightDiffColor = fwdDynLights[j + 2];
-		vec4 lightSpecColor = fwdDynLights[j + 3];
-		vec4 lightAmbiColor = fwdDynLights[j + 4];
+	for (int i = lightListBeg; i < lightListEnd; i++) {
+		int j = texelFetch(lightGridTex, i).x * 6;
+
+		vec4 wsLightPos = texelFetch(lightDataTex, j + 0);
+		vec4 wsLightDir = texelFetch(lightDataTex, j + 1);
+
+		vec4 lightDiffColor = texelFetch(lightDataTex, j + 2);
+		vec4 lightSpecColor = texelFetch(lightDataTex, j + 3);
+		vec4 lightAmbiColor = texelFetch(lightDataTex, j + 4);
 
 		vec3 wsLightVec = normalize(wsLightPos.xyz - worldPos.xyz);
 		vec3 wsHalfVec = normalize((wsNormal + wsLightVec) * 0.5);
 
-		float lightAngle    = fwdDynLights[j + 5].x; // fov
-		float lightRadius   = fwdDynLights[j + 5].y; // or const. atten.
+		float lightAngle    = texelFetch(lightDataTex, j + 5).x; // fov
+		float lightRadius   = texelFetch(lightDataTex, j + 5).y; // or const. atten.
 		float lightDistance = dot(wsLightVec, wsLightPos.xyz - worldPos.xyz);
 
 
@@ -98,9 +108,9 @@ vec3 DynamicLighting(vec3 wsNormal, vec3 diffuseColor, vec4 specularColor) {
 
 		#ifdef OGL_SPEC_ATTENUATION
 		// infinite falloff
-		float cLightAtten = fwdDynLights[j + 5].y;
-		float lLightAtten = fwdDynLights[j + 5].z;
-		float qLightAtten = fwdDynLights[j + 5].w;
+		float cLightAtten = texelFetch(lightDataTex, j + 5).y;
+		float lLightAtten = texelFetch(lightDataTex, j + 5).z;
+		float qLightAtten = texelFetch(lightDataTex, j + 5).w;
 		float  lightAtten = cLightAtten + lLightAtten * lightDistance + qLightAtten * lightDistance * lightDistance;
 		float  lightConst = 1.0;
 
@@ -14,6 +14,12 @@ layout(location = 6) in uint pieceIdxAttr;
 
 uniform mat4 pieceMatrices[128];
 
+// per-instance model and piece matrices for batched draws, four texels per matrix
+// .x := index of the first matrix of this batch, .y := matrices per instance (zero
+// if the current draw is not instanced and the regular uniforms should be used)
+uniform samplerBuffer instanceMatrixTex;
+uniform ivec2 instanceParams;
+
 uniform mat4 modelMatrix;
 uniform mat4  viewMatrix;
 uniform mat4  projMatrix;
@@ -46,12 +52,28 @@ mat4 mat4mix(mat4 a, mat4 b, float alpha) {
 	return (a * (1.0 - alpha) + b * alpha);
 }
 
+mat4 GetInstanceMatrix(int matrixIdx) {
+	return mat4(
+		texelFetch(instanceMatrixTex, matrixIdx * 4 + 0),
+		texelFetch(instanceMatrixTex, matrixIdx * 4 + 1),
+		texelFetch(instanceMatrixTex, matrixIdx * 4 + 2),
+		texelFetch(instanceMatrixTex, matrixIdx * 4 + 3)
+	);
+}
+
 void main(void)
 {
 	// mat4 pieceMatrix = mat4mix(mat4(1.0), pieceMatrices[pieceIdxAttr], pieceMatrices[0][3][3]);
 	mat4 pieceMatrix = pieceMatrices[pieceIdxAttr];
 	mat4 modelPieceMatrix = modelMatrix * pieceMatrix;
 
+	if (instanceParams.y > 0) {
+		int instanceMatrixIdx = instanceParams.x + gl_InstanceID * instanceParams.y;
+
+		pieceMatrix = GetInstanceMatrix(instanceMatrixIdx + 1 + int(pieceIdxAttr));
+		modelPieceMatrix = GetInstanceMatrix(instanceMatrixIdx) * pieceMatrix;
+	}
+
 	vec4 vertexPos = vec4(positionAttr, 1.0);
 	vec4 vertexModelPos = modelPieceMatrix * vertexPos;
 	vec4 vertexViewPos = viewMatrix * vertexModelPos;
@@ -8,6 +8,8 @@ uniform mat4 shadowProjMat;
 uniform vec4 shadowParams;
 
 uniform mat4 treeMat;
+uniform samplerBuffer treeMatrixTex;
+uniform ivec2 instanceParams;
 uniform vec3 cameraDirX;
 uniform vec3 cameraDirY;
 
@@ -20,12 +22,27 @@ out vec2 vTexCoord;
 out vec4 vBaseColor;
 
 
+mat4 GetTreeMatrix() {
+	if (instanceParams.y == 0)
+		return treeMat;
+
+	int matrixIdx = instanceParams.x + gl_InstanceID;
+
+	return mat4(
+		texelFetch(treeMatrixTex, matrixIdx * 4 + 0),
+		texelFetch(treeMatrixTex, matrixIdx * 4 + 1),
+		texelFetch(treeMatrixTex, matrixIdx * 4 + 2),
+		texelFetch(treeMatrixTex, matrixIdx * 4 + 3)
+	);
+}
+
 void main() {
+	mat4 worldMat = GetTreeMatrix();
 	vec4 vertexPos = vec4(vtxPositionAttr, 1.0);
 		vertexPos.xyz += (cameraDirX * vtxNormalAttr.x);
 		vertexPos.xyz += (cameraDirY * vtxNormalAttr.y);
 
-	vec4 vertexShadowPos = shadowViewMat * treeMat * vertexPos;
+	vec4 vertexShadowPos = shadowViewMat * worldMat * vertexPos;
 		vertexShadowPos.xy *= (inversesqrt(abs(vertexShadowPos.xy) + shadowParams.zz) + shadowParams.ww);
 		vertexShadowPos.xy += shadowParams.xy;
 
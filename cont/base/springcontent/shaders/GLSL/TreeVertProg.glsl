@@ -4,6 +4,9 @@ uniform mat4 projMat;
 uniform mat4 viewMat;
 uniform mat4 treeMat;             // world-transform
 
+uniform samplerBuffer treeMatrixTex; // per-instance world-transforms
+uniform ivec2 instanceParams;     // .x := base matrix index, .y := 0 (use treeMat) or 1
+
 uniform vec3 cameraDirX;          // needed for bush-type trees
 uniform vec3 cameraDirY;
 
@@ -26,14 +29,29 @@ out vec4 vBaseColor;
 out float vFogFactor;
 
 
+mat4 GetTreeMatrix() {
+	if (instanceParams.y == 0)
+		return treeMat;
+
+	int matrixIdx = instanceParams.x + gl_InstanceID;
+
+	return mat4(
+		texelFetch(treeMatrixTex, matrixIdx * 4 + 0),
+		texelFetch(treeMatrixTex, matrixIdx * 4 + 1),
+		texelFetch(treeMatrixTex, matrixIdx * 4 + 2),
+		texelFetch(treeMatrixTex, matrixIdx * 4 + 3)
+	);
+}
+
 void main() {
+	mat4 worldMat = GetTreeMatrix();
 	vec4 vertexPos = vec4(vtxPositionAttr, 1.0);
 
 	vertexPos.xyz += (cameraDirX * vtxNormalAttr.x);
 	vertexPos.xyz += (cameraDirY * vtxNormalAttr.y);
 
 	#if (TREE_SHADOW == 1)
-	vVertexPos = treeMat * vertexPos;
+	vVertexPos = worldMat * vertexPos;
 	#endif
 
 	vBaseColor.rgb = (vtxNormalAttr.z * groundDiffuseColor.rgb) + groundAmbientColor.rgb;
@@ -42,10 +60,10 @@ void main() {
 	vTexCoord = vtxTexCoordAttr;
 
 
-	gl_Position = projMat * viewMat * treeMat * vertexPos;
+	gl_Position = projMat * viewMat * worldMat * vertexPos;
 
 	{
-		float eyeDepth = length((viewMat * treeMat * vertexPos).xyz);
+		float eyeDepth = length((viewMat * worldMat * vertexPos).xyz);
 		float fogRange = (fogParams.y - fogParams.x) * fogParams.z;
 		float fogDepth = (eyeDepth - fogParams.x * fogParams.z) / fogRange;
 		// float fogDepth = (fogParams.y * fogParams.z - eyeDepth) / fogRange;
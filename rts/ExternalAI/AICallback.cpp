@@ -384,7 +384,7 @@ int CAICallback::GiveOrder(int unitId, Command* c)
 	if (unit->team != team)
 		return -5;
 
-	clientNet->Send(CBaseNetProtocol::Get().SendAICommand(gu->myPlayerNum, skirmishAIHandler.GetCurrentAIID(), unitId, c->GetID(), c->aiCommandId, c->options, c->params));
+	clientNet->Send(CBaseNetProtocol::Get().SendAICommand(gu->myPlayerNum, skirmishAIHandler.GetCurrentAIID(), unitId, c->GetID(), c->aiCommandId, c->options, c->params.data(), c->params.size()));
 	return 0;
 }
 
@@ -827,19 +827,20 @@ static int FilterUnitsVector(const std::vector<CUnit*>& units, int* unitIds, int
 }
 
 
-static int myAllyTeamId = -1;
+// per thread, AIs can handle their events concurrently
+static thread_local int myAllyTeamId = -1;
 
-/// You have to set myAllyTeamId before calling this function. NOT thread safe!
+/// You have to set myAllyTeamId before calling this function.
 static inline bool unit_IsEnemy(const CUnit* unit) {
 	return (!teamHandler->Ally(unit->allyteam, myAllyTeamId) && !unit->IsNeutral());
 }
 
-/// You have to set myAllyTeamId before calling this function. NOT thread safe!
+/// You have to set myAllyTeamId before calling this function.
 static inline bool unit_IsFriendly(const CUnit* unit) {
 	return (teamHandler->Ally(unit->allyteam, myAllyTeamId) && !unit->IsNeutral());
 }
 
-/// You have to set myAllyTeamId before calling this function. NOT thread safe!
+/// You have to set myAllyTeamId before calling this function.
 static inline bool unit_IsInSensor(const CUnit* unit, const unsigned short losFlags) {
 	// Skip in-sensor-range test if the unit is allied with our team.
 	// This prevents errors where an allied unit is starting to build,
@@ -848,22 +849,22 @@ static inline bool unit_IsInSensor(const CUnit* unit, const unsigned short losFl
 	return (teamHandler->Ally(myAllyTeamId, unit->allyteam) || ((unit->losStatus[myAllyTeamId] & losFlags) != 0));
 }
 
-/// You have to set myAllyTeamId before calling this function. NOT thread safe!
+/// You have to set myAllyTeamId before calling this function.
 static inline bool unit_IsInLos(const CUnit* unit) {
 	return unit_IsInSensor(unit, LOS_INLOS);
 }
 
-/// You have to set myAllyTeamId before calling this function. NOT thread safe!
+/// You have to set myAllyTeamId before calling this function.
 static inline bool unit_IsEnemyAndInLos(const CUnit* unit) {
 	return (unit_IsEnemy(unit) && unit_IsInLos(unit));
 }
 
-/// You have to set myAllyTeamId before calling this function. NOT thread safe!
+/// You have to set myAllyTeamId before calling this function.
 static inline bool unit_IsEnemyAndInLosOrRadar(const CUnit* unit) {
 	return (unit_IsEnemy(unit) && ((unit->losStatus[myAllyTeamId] & (LOS_INLOS | LOS_INRADAR)) != 0));
 }
 
-/// You have to set myAllyTeamId before calling this function. NOT thread safe!
+/// You have to set myAllyTeamId before calling this function.
 static inline bool unit_IsNeutralAndInLosOrRadar(const CUnit* unit) {
 	return (unit->IsNeutral() && (unit_IsInSensor(unit, LOS_INLOS | LOS_INRADAR)));
 }
@@ -6,6 +6,7 @@
 #include "ExternalAI/SkirmishAIData.h"
 #include "ExternalAI/SkirmishAIHandler.h"
 #include "ExternalAI/IAILibraryManager.h"
+#include "ExternalAI/SSkirmishAICallbackImpl.h"
 #include "ExternalAI/Interface/AISCommands.h"
 #include "Game/GlobalUnsynced.h"
 #include "Game/Players/Player.h"
@@ -19,9 +20,11 @@
 #include "Sim/Units/CommandAI/Command.h"
 #include "Sim/Weapons/WeaponDef.h"
 #include "Net/Protocol/NetProtocol.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
 #include "System/TimeProfiler.h"
 #include "System/SafeUtil.h"
+#include "System/Threading/ThreadPool.h"
 
 #include "System/creg/STL_Map.h"
 
@@ -32,9 +35,17 @@ CR_REG_METADATA(CEngineOutHandler, (
 	//   [with _T1 = const unsigned char; _T2 = std::unique_ptr<CSkirmishAIWrapper>]’
 	//   is implicitly deleted because the default definition would be ill-formed"
 	CR_IGNORED(hostSkirmishAIs),
-	CR_MEMBER(teamSkirmishAIs)
+	CR_MEMBER(teamSkirmishAIs),
+	CR_IGNORED(aiDispatchGroups),
+	CR_IGNORED(queueAIEvents)
 ))
 
+CONFIG(bool, AIThreadedEvents).defaultValue(false).description(
+	"Queue the events of local Skirmish AIs and hand them over once per frame, "
+	"before the simulation runs, with AIs of different libraries on separate "
+	"threads. Events arrive up to a frame late and AIs can not reply to Lua messages."
+);
+
 
 static inline bool IsUnitInLosOrRadarOfAllyTeam(const CUnit& unit, const int allyTeamId) {
 	// NOTE:
@@ -76,6 +87,9 @@ void CEngineOutHandler::Destroy() {
 }
 
 
+CEngineOutHandler::CEngineOutHandler(): queueAIEvents(configHandler->GetBool("AIThreadedEvents")) {
+}
+
 CEngineOutHandler::~CEngineOutHandler() {
 	// hostSkirmishAIs should be empty already, but this can not hurt
 	// (it releases only those AI's that were not already released)
@@ -135,6 +149,56 @@ void CEngineOutHandler::Update() {
 	const int frame = gs->frameNum;
 
 	DO_FOR_SKIRMISH_AIS(Update(frame))
+
+	if (queueAIEvents)
+		DispatchQueuedAIEvents();
+}
+
+void CEngineOutHandler::DispatchQueuedAIEvents() {
+	// Called before the frame is simulated, so the AIs see a world that is not
+	// being modified at the same time. AIs of one library are handled by the
+	// same thread since a library need not support concurrent calls, and all
+	// AIs of an interface other than the native C one (e.g. the JVM of Java
+	// AIs) count as one library. AIs that enabled cheats can change the world
+	// directly and are handled last, one by one.
+	std::vector<CSkirmishAIWrapper*> cheatingAIs;
+	std::map<std::string, size_t> groupIndices;
+
+	aiDispatchGroups.clear();
+
+	for (auto& p: hostSkirmishAIs) {
+		CSkirmishAIWrapper* aiWrapper = p.second.get();
+
+		if (skirmishAiCallback_usesCheats(aiWrapper->GetSkirmishAIID())) {
+			cheatingAIs.push_back(aiWrapper);
+			continue;
+		}
+
+		const SkirmishAIKey& aiKey = aiWrapper->GetKey();
+		const std::string& interfaceName = aiKey.GetInterface().GetShortName();
+		const std::string groupName = (interfaceName != "C")? interfaceName: aiKey.ToString();
+
+		const auto it = groupIndices.emplace(groupName, aiDispatchGroups.size()).first;
+
+		if (it->second == aiDispatchGroups.size())
+			aiDispatchGroups.emplace_back();
+
+		aiDispatchGroups[it->second].push_back(aiWrapper);
+	}
+
+	skirmishAiCallback_setThreadedEvents(true);
+
+	for_mt_dynamic(0, aiDispatchGroups.size(), [&](const int i) {
+		for (CSkirmishAIWrapper* aiWrapper: aiDispatchGroups[i]) {
+			aiWrapper->DispatchQueuedEvents();
+		}
+	});
+
+	skirmishAiCallback_setThreadedEvents(false);
+
+	for (CSkirmishAIWrapper* aiWrapper: cheatingAIs) {
+		aiWrapper->DispatchQueuedEvents();
+	}
 }
 
 
@@ -569,6 +633,7 @@ void CEngineOutHandler::CreateSkirmishAI(const uint8_t skirmishAIId) {
 		teamSkirmishAIs[aiWrapper->GetTeamId()].push_back(skirmishAIId);
 
 		aiWrapper->Init();
+		aiWrapper->SetQueueEvents(queueAIEvents);
 
 		if (aiWrapper == nullptr)
 			return;
@@ -30,6 +30,7 @@ class CEngineOutHandler {
 
 public:
 	static CEngineOutHandler* GetInstance();
+	CEngineOutHandler();
 	~CEngineOutHandler();
 
 	static void Create();
@@ -97,6 +98,13 @@ public:
 	void Load(std::istream* s, const uint8_t skirmishAIId);
 	void Save(std::ostream* s, const uint8_t skirmishAIId);
 
+private:
+	/**
+	 * Handles the events queued by all local Skirmish AIs (if AIThreadedEvents
+	 * is enabled), running AIs of different libraries in parallel.
+	 */
+	void DispatchQueuedAIEvents();
+
 private:
 	typedef std::vector<uint8_t> ids_t;
 	typedef std::map<uint8_t, std::unique_ptr<CSkirmishAIWrapper> > id_ai_t;
@@ -110,6 +118,11 @@ private:
 	 * There can be multiple Skirmish AIs per team.
 	 */
 	team_ais_t teamSkirmishAIs;
+
+	/// per library, the AIs whose events are handled by one thread in DispatchQueuedAIEvents
+	std::vector< std::vector<CSkirmishAIWrapper*> > aiDispatchGroups;
+
+	bool queueAIEvents;
 };
 
 #define eoh CEngineOutHandler::GetInstance()
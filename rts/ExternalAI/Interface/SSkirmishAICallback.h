@@ -10,6 +10,22 @@ extern "C" {
 #endif
 
 
+/**
+ * Fields of units that can be read in bulk through
+ * SSkirmishAICallback.getUnitsData, or'ed together.
+ * Each field takes one value per unit (three for positions and velocities,
+ * as x, y, z), in the order of this enum.
+ */
+enum UnitDataFields {
+	UNIT_DATA_DEF        = (1 << 0), //  1, unitDefId, -1 if not known
+	UNIT_DATA_TEAM       = (1 << 1), //  2
+	UNIT_DATA_HEALTH     = (1 << 2), //  4
+	UNIT_DATA_MAX_HEALTH = (1 << 3), //  8
+	UNIT_DATA_POS        = (1 << 4), // 16
+	UNIT_DATA_VEL        = (1 << 5), // 32
+};
+
+
 /**
  * @brief Skirmish AI Callback function pointers.
  * Each Skirmish AI instance will receive an instance of this struct
@@ -1199,6 +1215,15 @@ struct SSkirmishAICallback {
 	 */
 	int               (CALLING_CONV *getSelectedUnits)(int skirmishAIId, int* unitIds, int unitIds_sizeMax); //$ FETCHER:MULTI:IDs:Unit:unitIds
 
+	/**
+	 * Reads the fields given by the UnitDataFields mask of all the units
+	 * in unitIds at once, unit after unit, which is a lot cheaper than the
+	 * equivalent Unit_get* calls (especially for non-native AIs).
+	 * Units the AI can not see get the same values as Unit_get* would return.
+	 * @return the number of values written (or needed, if values is NULL)
+	 */
+	int               (CALLING_CONV *getUnitsData)(int skirmishAIId, int* unitIds, int unitIds_size, int fields, float* values, int values_sizeMax); //$ ARRAY:values
+
 	/**
 	 * Returns the unit's unitdef struct from which you can read all
 	 * the statistics of the unit, do NOT try to change any values in it.
@@ -45,6 +45,7 @@
 #include "System/myMath.h"
 #include "System/FileSystem/ArchiveScanner.h"
 #include "System/Log/ILog.h"
+#include "System/Threading/SpringThreading.h"
 
 
 static const char* SKIRMISH_AIS_VERSION_COMMON = "common";
@@ -58,6 +59,10 @@ static std::map<int, bool> skirmishAIId_cheatingEnabled;
 static std::map<int, bool> skirmishAIId_usesCheats;
 static std::map<int, int>  skirmishAIId_teamId;
 
+// set while multiple AIs handle their events in parallel
+static bool threadedEvents = false;
+static spring::recursive_mutex handleCommandMutex;
+
 static const size_t MARKERS_MAX_SIZE = 16384;
 static std::vector<PointMarker> tmpPointMarkerArr[MAX_SKIRMISH_AIS];
 static std::vector<LineMarker> tmpLineMarkerArr[MAX_SKIRMISH_AIS];
@@ -638,6 +643,13 @@ EXPORT(int) skirmishAiCallback_Engine_handleCommand(
 	int commandTopic,
 	void* commandData
 ) {
+	// commands are mostly sent through the network, but the rest (drawing, path
+	// requests, Lua calls, group management) are not safe to run concurrently
+	std::unique_lock<spring::recursive_mutex> lock(handleCommandMutex, std::defer_lock);
+
+	if (threadedEvents)
+		lock.lock();
+
 	int ret = 0;
 
 	CAICallback* clb = skirmishAIId_callback[skirmishAIId];
@@ -1444,7 +1456,8 @@ EXPORT(char*) skirmishAiCallback_DataDirs_allocatePath(
 	bool dir,
 	bool common
 ) {
-	static char path[2048];
+	// per thread, AIs might handle their events concurrently
+	static thread_local char path[2048];
 
 	if (!skirmishAiCallback_DataDirs_locatePath(skirmishAIId, &path[0], sizeof(path), relPath, writeable, create, dir, common))
 		path[0] = 0;
@@ -1456,13 +1469,8 @@ EXPORT(char*) skirmishAiCallback_DataDirs_allocatePath(
 EXPORT(const char*) skirmishAiCallback_DataDirs_getWriteableDir(int skirmishAIId) {
 	checkSkirmishAIId(skirmishAIId);
 
-	static std::vector<std::string> writeableDataDirs;
-
-	// fill up writeableDataDirs until teamId index is in there
-	// if it is not yet
-	for (size_t wdd = writeableDataDirs.size(); wdd <= (size_t)skirmishAIId; ++wdd) {
-		writeableDataDirs.push_back("");
-	}
+	// fixed size, AIs might be calling this concurrently
+	static std::string writeableDataDirs[MAX_SKIRMISH_AIS];
 
 	if (writeableDataDirs[skirmishAIId].empty()) {
 		char tmpRes[1024];
@@ -1489,6 +1497,12 @@ EXPORT(bool) skirmishAiCallback_Cheats_isEnabled(int skirmishAIId) {
 }
 
 EXPORT(bool) skirmishAiCallback_Cheats_setEnabled(int skirmishAIId, bool enabled) {
+	// other AIs might be reading the world concurrently
+	if (enabled && threadedEvents && !skirmishAIId_usesCheats[skirmishAIId]) {
+		LOG_L(L_WARNING, "SkirmishAI (ID = %i, team ID = %i) can only enable cheats when not handling queued events",
+				skirmishAIId, skirmishAIId_teamId[skirmishAIId]);
+		return false;
+	}
 
 	skirmishAIId_cheatingEnabled[skirmishAIId] = enabled;
 	if (enabled && !skirmishAIId_usesCheats[skirmishAIId]) {
@@ -3848,7 +3862,7 @@ EXPORT(int) skirmishAiCallback_Unit_CurrentCommand_getParams(
 	if (!CHECK_COMMAND_ID(q, commandId))
 		return -1;
 
-	const std::vector<float>& ps = q->at(commandId).params;
+	const CommandParams& ps = q->at(commandId).params;
 	const int paramsRealSize = ps.size();
 
 	size_t paramsSize = paramsRealSize;
@@ -4095,6 +4109,68 @@ EXPORT(int) skirmishAiCallback_getSelectedUnits(int skirmishAIId, int* unitIds,
 	return skirmishAIId_callback[skirmishAIId]->GetSelectedUnits(unitIds, unitIdsMaxSize);
 }
 
+static int getNumUnitDataValues(int fields) {
+	int numValues = 0;
+
+	numValues += ((fields & UNIT_DATA_DEF       ) != 0);
+	numValues += ((fields & UNIT_DATA_TEAM      ) != 0);
+	numValues += ((fields & UNIT_DATA_HEALTH    ) != 0);
+	numValues += ((fields & UNIT_DATA_MAX_HEALTH) != 0);
+	numValues += ((fields & UNIT_DATA_POS       ) != 0) * 3;
+	numValues += ((fields & UNIT_DATA_VEL       ) != 0) * 3;
+
+	return numValues;
+}
+
+// CAICallback or CAICheats, both apply their own visibility rules per unit
+template<typename Callback>
+static void fillUnitsData(Callback* clb, const int* unitIds, int numUnits, int fields, float* values) {
+	for (int i = 0; i < numUnits; ++i) {
+		const int unitId = unitIds[i];
+
+		if (fields & UNIT_DATA_DEF) {
+			const UnitDef* unitDef = clb->GetUnitDef(unitId);
+			*(values++) = (unitDef != nullptr)? unitDef->id: -1;
+		}
+		if (fields & UNIT_DATA_TEAM)
+			*(values++) = clb->GetUnitTeam(unitId);
+		if (fields & UNIT_DATA_HEALTH)
+			*(values++) = clb->GetUnitHealth(unitId);
+		if (fields & UNIT_DATA_MAX_HEALTH)
+			*(values++) = clb->GetUnitMaxHealth(unitId);
+
+		if (fields & UNIT_DATA_POS) {
+			clb->GetUnitPos(unitId).copyInto(values);
+			values += 3;
+		}
+		if (fields & UNIT_DATA_VEL) {
+			clb->GetUnitVelocity(unitId).copyInto(values);
+			values += 3;
+		}
+	}
+}
+
+EXPORT(int) skirmishAiCallback_getUnitsData(int skirmishAIId, int* unitIds, int unitIdsSize, int fields, float* values, int valuesMaxSize) {
+	const int numUnitValues = getNumUnitDataValues(fields);
+
+	if (numUnitValues == 0 || unitIds == nullptr)
+		return 0;
+
+	if (values == nullptr)
+		return (unitIdsSize * numUnitValues);
+
+	// only whole units
+	const int numUnits = std::min(unitIdsSize, valuesMaxSize / numUnitValues);
+
+	if (skirmishAiCallback_Cheats_isEnabled(skirmishAIId)) {
+		fillUnitsData(skirmishAIId_cheatCallback[skirmishAIId], unitIds, numUnits, fields, values);
+	} else {
+		fillUnitsData(skirmishAIId_callback[skirmishAIId], unitIds, numUnits, fields, values);
+	}
+
+	return (numUnits * numUnitValues);
+}
+
 EXPORT(int) skirmishAiCallback_getTeamUnits(int skirmishAIId, int* unitIds, int unitIdsMaxSize) {
 	int a = 0;
 
@@ -5198,7 +5274,7 @@ EXPORT(int) skirmishAiCallback_Group_OrderPreview_getParams(
 	if (!isControlledByLocalPlayer(skirmishAIId))
 		return 0;
 
-	const std::vector<float>& ps = guihandler->GetOrderPreview().params;
+	const CommandParams& ps = guihandler->GetOrderPreview().params;
 	const int paramsRealSize = ps.size();
 
 	size_t paramsSize = paramsRealSize;
@@ -5554,6 +5630,7 @@ static void skirmishAiCallback_init(SSkirmishAICallback* callback) {
 	callback->getNeutralUnitsIn = &skirmishAiCallback_getNeutralUnitsIn;
 	callback->getTeamUnits = &skirmishAiCallback_getTeamUnits;
 	callback->getSelectedUnits = &skirmishAiCallback_getSelectedUnits;
+	callback->getUnitsData = &skirmishAiCallback_getUnitsData;
 	callback->Unit_getDef = &skirmishAiCallback_Unit_getDef;
 	callback->Unit_getRulesParamFloat = &skirmishAiCallback_Unit_getRulesParamFloat;
 	callback->Unit_getRulesParamString = &skirmishAiCallback_Unit_getRulesParamString;
@@ -5872,6 +5949,7 @@ SSkirmishAICallback* skirmishAiCallback_getInstanceFor(
 	skirmishAIId_callback[skirmishAIId]      = aiCallback;
 	skirmishAIId_cheatCallback[skirmishAIId] = aiCheats;
 
+	skirmishAIId_cheatingEnabled[skirmishAIId] = false;
 	skirmishAIId_usesCheats[skirmishAIId]    = false;
 	skirmishAIId_teamId[skirmishAIId]        = teamId;
 
@@ -5890,3 +5968,11 @@ void skirmishAiCallback_release(int skirmishAIId) {
 	skirmishAIId_teamId.erase(skirmishAIId);
 }
 
+bool skirmishAiCallback_usesCheats(int skirmishAIId) {
+	return skirmishAIId_usesCheats[skirmishAIId];
+}
+
+void skirmishAiCallback_setThreadedEvents(bool enabled) {
+	threadedEvents = enabled;
+}
+
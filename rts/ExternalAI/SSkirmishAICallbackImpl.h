@@ -692,6 +692,8 @@ EXPORT(int              ) skirmishAiCallback_getTeamUnits(int skirmishAIId, int*
 
 EXPORT(int              ) skirmishAiCallback_getSelectedUnits(int skirmishAIId, int* unitIds, int unitIds_sizeMax);
 
+EXPORT(int              ) skirmishAiCallback_getUnitsData(int skirmishAIId, int* unitIds, int unitIds_size, int fields, float* values, int values_sizeMax);
+
 EXPORT(int              ) skirmishAiCallback_Unit_getDef(int skirmishAIId, int unitId);
 
 EXPORT(float            ) skirmishAiCallback_Unit_getRulesParamFloat(int skirmishAIId, int unitId, const char* rulesParamName, float defaultValue);
@@ -1372,6 +1374,19 @@ SSkirmishAICallback* skirmishAiCallback_getInstanceFor(int skirmishAIId, int tea
  */
 void skirmishAiCallback_release(int skirmishAIId);
 
+/**
+ * Whether a specific AI has enabled cheats at any time,
+ * which allows it to modify the world directly.
+ */
+bool skirmishAiCallback_usesCheats(int skirmishAIId);
+
+/**
+ * Marks the phase in which the queued events of multiple AIs are handled
+ * concurrently; cheats can not be enabled and commands are serialized.
+ * @see CEngineOutHandler::DispatchQueuedAIEvents
+ */
+void skirmishAiCallback_setThreadedEvents(bool enabled);
+
 #endif // defined __cplusplus && !defined BUILDING_AI
 
 #endif // S_SKIRMISH_AI_CALLBACK_IMPL_H
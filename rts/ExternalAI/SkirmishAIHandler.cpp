@@ -25,11 +25,14 @@ CR_REG_METADATA(CSkirmishAIHandler, (
 	CR_MEMBER(id_dieReason),
 	CR_MEMBER(id_libKey),
 	CR_MEMBER(gameInitialized),
-	CR_MEMBER(luaAIShortNames),
-	CR_IGNORED(currentAIId)
+	CR_MEMBER(luaAIShortNames)
 ))
 
 
+// per thread, since AIs can handle their events concurrently
+static thread_local unsigned char currentAIId = MAX_AIS;
+
+
 // not extern'ed, so static
 static CSkirmishAIHandler* gSkirmishAIHandler = nullptr;
 
@@ -65,6 +68,10 @@ void CSkirmishAIHandler::ResetState()
 	gameInitialized = false;
 }
 
+unsigned char CSkirmishAIHandler::GetCurrentAIID() const { return currentAIId; }
+void CSkirmishAIHandler::SetCurrentAIID(unsigned char id) { currentAIId = id; }
+
+
 void CSkirmishAIHandler::LoadFromSetup(const CGameSetup& setup) {
 
 	for (size_t a = 0; a < setup.GetAIStartingDataCont().size(); ++a) {
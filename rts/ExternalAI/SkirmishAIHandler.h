@@ -181,8 +181,9 @@ public:
 
 	const std::set<std::string>& GetLuaAIImplShortNames() const { return luaAIShortNames; }
 
-	unsigned char GetCurrentAIID() { return currentAIId; }
-	void SetCurrentAIID(unsigned char id) { currentAIId = id; }
+	/// the local AI executing on the calling thread, MAX_AIS if none (e.g. LuaUI)
+	unsigned char GetCurrentAIID() const;
+	void SetCurrentAIID(unsigned char id);
 
 private:
 	static bool IsLocalSkirmishAI(const SkirmishAIData& aiData);
@@ -209,9 +210,6 @@ private:
 
 	std::set<std::string> luaAIShortNames;
 
-	// the current local AI ID that is executing, MAX_AIS if none (e.g. LuaUI)
-	unsigned char currentAIId;
-
 	bool gameInitialized;
 };
 
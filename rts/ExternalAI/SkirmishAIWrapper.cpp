@@ -19,6 +19,7 @@
 
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
+#include "Sim/Units/CommandAI/Command.h"
 #include "Sim/Misc/TeamHandler.h"
 
 #include "System/FileSystem/DataDirsAccess.h"
@@ -57,6 +58,11 @@ CR_REG_METADATA(CSkirmishAIWrapper, (
 	CR_MEMBER(initOk),
 	CR_MEMBER(dieing),
 
+	// queues are flushed (by Save) or dropped before serialization
+	CR_IGNORED(queuedEvents),
+	CR_IGNORED(queuedEventsMutex),
+	CR_IGNORED(queueEvents),
+
 	CR_SERIALIZER(Serialize),
 	CR_POSTLOAD(PostLoad)
 ))
@@ -74,7 +80,8 @@ CSkirmishAIWrapper::CSkirmishAIWrapper():
 	cheatEvents(false),
 
 	initOk(false),
-	dieing(false)
+	dieing(false),
+	queueEvents(false)
 {
 }
 
@@ -90,7 +97,8 @@ CSkirmishAIWrapper::CSkirmishAIWrapper(const int skirmishAIId):
 	cheatEvents(false),
 
 	initOk(false),
-	dieing(false)
+	dieing(false),
+	queueEvents(false)
 {
 	const SkirmishAIData* aiData = skirmishAIHandler.GetSkirmishAI(skirmishAIId);
 
@@ -117,7 +125,7 @@ CSkirmishAIWrapper::~CSkirmishAIWrapper() {
 	Release(skirmishAIHandler.GetLocalSkirmishAIDieReason(skirmishAIId));
 
 	{
-		SCOPED_TIMER(timerName.c_str());
+		SCOPED_NAMED_TIMER(timerName.c_str());
 
 		if (initOk)
 			library->Release(skirmishAIId);
@@ -148,7 +156,7 @@ void CSkirmishAIWrapper::PostLoad() {
 
 bool CSkirmishAIWrapper::LoadSkirmishAI(bool postLoad) {
 	{
-		SCOPED_TIMER(timerName.c_str());
+		SCOPED_NAMED_TIMER(timerName.c_str());
 
 		library = IAILibraryManager::GetInstance()->FetchSkirmishAILibrary(key);
 
@@ -233,6 +241,12 @@ void CSkirmishAIWrapper::Release(int reason) {
 	if (!initialized || released)
 		return;
 
+	{
+		// pending events would refer to a world the AI no longer plays in
+		std::lock_guard<spring::mutex> lock(queuedEventsMutex);
+		queuedEvents.clear();
+	}
+
 	// NOTE: further cleanup is done in the destructor
 	const SReleaseEvent evtData = {reason};
 	HandleEvent(EVENT_RELEASE, &evtData);
@@ -289,6 +303,9 @@ void CSkirmishAIWrapper::Load(std::istream* loadStream)
 
 void CSkirmishAIWrapper::Save(std::ostream* saveStream)
 {
+	// the save has to reflect every event up to now
+	DispatchQueuedEvents();
+
 	const std::string tmpFile = createTempFileName("save", teamId, skirmishAIId);
 	const SSaveEvent evtData = {tmpFile.c_str()};
 
@@ -311,21 +328,41 @@ void CSkirmishAIWrapper::Save(std::ostream* saveStream)
 
 
 void CSkirmishAIWrapper::UnitIdle(int unitId) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { UnitIdle(unitId); });
+		return;
+	}
+
 	const SUnitIdleEvent evtData = {unitId};
 	HandleEvent(EVENT_UNIT_IDLE, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitCreated(int unitId, int builderId) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { UnitCreated(unitId, builderId); });
+		return;
+	}
+
 	const SUnitCreatedEvent evtData = {unitId, builderId};
 	HandleEvent(EVENT_UNIT_CREATED, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitFinished(int unitId) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { UnitFinished(unitId); });
+		return;
+	}
+
 	const SUnitFinishedEvent evtData = {unitId};
 	HandleEvent(EVENT_UNIT_FINISHED, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitDestroyed(int unitId, int attackerUnitId) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { UnitDestroyed(unitId, attackerUnitId); });
+		return;
+	}
+
 	const SUnitDestroyedEvent evtData = {unitId, attackerUnitId};
 	HandleEvent(EVENT_UNIT_DESTROYED, &evtData);
 }
@@ -339,58 +376,113 @@ void CSkirmishAIWrapper::UnitDamaged(
 	bool paralyzer
 ) {
 	float3 cpyDir = dir;
+
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { UnitDamaged(unitId, attackerUnitId, damage, cpyDir, weaponDefId, paralyzer); });
+		return;
+	}
 	const SUnitDamagedEvent evtData = {unitId, attackerUnitId, damage, &cpyDir[0], weaponDefId, paralyzer};
 
 	HandleEvent(EVENT_UNIT_DAMAGED, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitMoveFailed(int unitId) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { UnitMoveFailed(unitId); });
+		return;
+	}
+
 	const SUnitMoveFailedEvent evtData = {unitId};
 	HandleEvent(EVENT_UNIT_MOVE_FAILED, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitGiven(int unitId, int oldTeam, int newTeam) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { UnitGiven(unitId, oldTeam, newTeam); });
+		return;
+	}
+
 	const SUnitGivenEvent evtData = {unitId, oldTeam, newTeam};
 	HandleEvent(EVENT_UNIT_GIVEN, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitCaptured(int unitId, int oldTeam, int newTeam) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { UnitCaptured(unitId, oldTeam, newTeam); });
+		return;
+	}
+
 	const SUnitCapturedEvent evtData = {unitId, oldTeam, newTeam};
 	HandleEvent(EVENT_UNIT_CAPTURED, &evtData);
 }
 
 
 void CSkirmishAIWrapper::EnemyCreated(int unitId) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { EnemyCreated(unitId); });
+		return;
+	}
+
 	const SEnemyCreatedEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_CREATED, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyFinished(int unitId) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { EnemyFinished(unitId); });
+		return;
+	}
+
 	const SEnemyFinishedEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_FINISHED, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyEnterLOS(int unitId) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { EnemyEnterLOS(unitId); });
+		return;
+	}
+
 	const SEnemyEnterLOSEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_ENTER_LOS, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyLeaveLOS(int unitId) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { EnemyLeaveLOS(unitId); });
+		return;
+	}
+
 	const SEnemyLeaveLOSEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_LEAVE_LOS, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyEnterRadar(int unitId) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { EnemyEnterRadar(unitId); });
+		return;
+	}
+
 	const SEnemyEnterRadarEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_ENTER_RADAR, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyLeaveRadar(int unitId) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { EnemyLeaveRadar(unitId); });
+		return;
+	}
+
 	const SEnemyLeaveRadarEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_LEAVE_RADAR, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyDestroyed(int enemyUnitId, int attackerUnitId) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { EnemyDestroyed(enemyUnitId, attackerUnitId); });
+		return;
+	}
+
 	const SEnemyDestroyedEvent evtData = {enemyUnitId, attackerUnitId};
 	HandleEvent(EVENT_ENEMY_DESTROYED, &evtData);
 }
@@ -404,27 +496,55 @@ void CSkirmishAIWrapper::EnemyDamaged(
 	bool paralyzer
 ) {
 	float3 cpyDir = dir;
+
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { EnemyDamaged(enemyUnitId, attackerUnitId, damage, cpyDir, weaponDefId, paralyzer); });
+		return;
+	}
 	const SEnemyDamagedEvent evtData = {enemyUnitId, attackerUnitId, damage, &cpyDir[0], weaponDefId, paralyzer};
 
 	HandleEvent(EVENT_ENEMY_DAMAGED, &evtData);
 }
 
 void CSkirmishAIWrapper::Update(int frame) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { Update(frame); });
+		return;
+	}
+
 	const SUpdateEvent evtData = {frame};
 	HandleEvent(EVENT_UPDATE, &evtData);
 }
 
 void CSkirmishAIWrapper::SendChatMessage(const char* msg, int fromPlayerId) {
+	if (IsQueueingEvents()) {
+		const std::string msgStr = msg;
+		QueueEvent([=]() { SendChatMessage(msgStr.c_str(), fromPlayerId); });
+		return;
+	}
+
 	const SMessageEvent evtData = {fromPlayerId, msg};
 	HandleEvent(EVENT_MESSAGE, &evtData);
 }
 
 void CSkirmishAIWrapper::SendLuaMessage(const char* inData, const char** outData) {
+	if (IsQueueingEvents()) {
+		// the AI can not reply to a queued message, outData keeps its value
+		const std::string inDataStr = inData;
+		QueueEvent([=]() { SendLuaMessage(inDataStr.c_str(), nullptr); });
+		return;
+	}
+
 	const SLuaMessageEvent evtData = {inData /*outData*/};
 	HandleEvent(EVENT_LUA_MESSAGE, &evtData);
 }
 
 void CSkirmishAIWrapper::WeaponFired(int unitId, int weaponDefId) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { WeaponFired(unitId, weaponDefId); });
+		return;
+	}
+
 	const SWeaponFiredEvent evtData = {unitId, weaponDefId};
 	HandleEvent(EVENT_WEAPON_FIRED, &evtData);
 }
@@ -434,6 +554,11 @@ void CSkirmishAIWrapper::PlayerCommandGiven(
 	const Command& c,
 	int playerId
 ) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { PlayerCommandGiven(playerSelectedUnits, c, playerId); });
+		return;
+	}
+
 	std::vector<int> unitIds = playerSelectedUnits;
 
 	const int cCommandId = extractAICommandTopic(&c, unitHandler->MaxUnits());
@@ -443,6 +568,11 @@ void CSkirmishAIWrapper::PlayerCommandGiven(
 }
 
 void CSkirmishAIWrapper::CommandFinished(int unitId, int commandId, int commandTopicId) {
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { CommandFinished(unitId, commandId, commandTopicId); });
+		return;
+	}
+
 	const SCommandFinishedEvent evtData = {unitId, commandId, commandTopicId};
 	HandleEvent(EVENT_COMMAND_FINISHED, &evtData);
 }
@@ -454,14 +584,59 @@ void CSkirmishAIWrapper::SeismicPing(
 	float strength
 ) {
 	float3 cpyPos = pos;
+
+	if (IsQueueingEvents()) {
+		QueueEvent([=]() { SeismicPing(allyTeam, unitId, cpyPos, strength); });
+		return;
+	}
 	const SSeismicPingEvent evtData = {&cpyPos[0], strength};
 
 	HandleEvent(EVENT_SEISMIC_PING, &evtData);
 }
 
 
+// the AI (if any) whose queued events are being handled by this thread
+static thread_local const CSkirmishAIWrapper* dispatchingAI = nullptr;
+
+bool CSkirmishAIWrapper::IsQueueingEvents() const {
+	return (queueEvents && dispatchingAI != this);
+}
+
+void CSkirmishAIWrapper::QueueEvent(std::function<void()>&& event) {
+	std::lock_guard<spring::mutex> lock(queuedEventsMutex);
+	queuedEvents.emplace_back(std::move(event));
+}
+
+void CSkirmishAIWrapper::DispatchQueuedEvents() {
+	const CSkirmishAIWrapper* prevDispatchingAI = dispatchingAI;
+
+	dispatchingAI = this;
+
+	// events can still be queued for this AI by other threads while it
+	// handles the current ones (e.g. chat messages forwarded by another AI)
+	for (size_t i = 0; ; i++) {
+		std::function<void()> event;
+
+		{
+			std::lock_guard<spring::mutex> lock(queuedEventsMutex);
+
+			if (i >= queuedEvents.size()) {
+				queuedEvents.clear();
+				break;
+			}
+
+			event = std::move(queuedEvents[i]);
+		}
+
+		event();
+	}
+
+	dispatchingAI = prevDispatchingAI;
+}
+
+
 int CSkirmishAIWrapper::HandleEvent(int topic, const void* data) const {
-	SCOPED_TIMER(timerName.c_str());
+	SCOPED_NAMED_TIMER(timerName.c_str());
 
 	if (!dieing || (topic == EVENT_RELEASE))
 		return library->HandleEvent(skirmishAIId, topic, data);
@@ -6,10 +6,13 @@
 #include "System/Object.h"
 #include "SkirmishAIKey.h"
 #include "System/Platform/SharedLib.h"
+#include "System/Threading/SpringThreading.h"
 
+#include <functional>
 #include <map>
 #include <string>
 #include <memory>
+#include <vector>
 
 class CAICallback;
 class CAICheats;
@@ -99,9 +102,23 @@ public:
 	void SetCheatEventsEnabled(bool enable) { cheatEvents = enable; }
 	bool IsCheatEventsEnabled() const { return cheatEvents; }
 
+	/**
+	 * If enabled, AI events (except Init, Release, Load and Save) are queued
+	 * instead of being sent to the AI right away, and delivered in order by
+	 * DispatchQueuedEvents. Events raised while the AI is handling its queue
+	 * (e.g. replies to its own Lua messages) are still sent immediately.
+	 * @see CEngineOutHandler::DispatchQueuedAIEvents
+	 */
+	void SetQueueEvents(bool enable) { queueEvents = enable; }
+	/// safe to call from any thread, but not for one AI on two at once
+	void DispatchQueuedEvents();
+
 private:
 	bool LoadSkirmishAI(bool postLoad);
 
+	bool IsQueueingEvents() const;
+	void QueueEvent(std::function<void()>&& event);
+
 	/**
 	 * CAUTION: takes C AI Interface events, not engine C++ ones!
 	 */
@@ -118,6 +135,9 @@ private:
 
 	std::string timerName;
 
+	std::vector<std::function<void()>> queuedEvents;
+	spring::mutex queuedEventsMutex;
+
 
 	int skirmishAIId;
 	int teamId;
@@ -128,6 +148,7 @@ private:
 
 	bool initOk;
 	bool dieing;
+	bool queueEvents;
 };
 
 #endif // SKIRMISH_AI_WRAPPER_H
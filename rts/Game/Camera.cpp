@@ -20,6 +20,9 @@ CONFIG(bool, EdgeMoveDynamic)
 	.defaultValue(true)
 	.description("If EdgeMove scrolling speed should fade with edge distance.");
 
+static ConfigHandle<float> edgeMoveWidth("EdgeMoveWidth");
+static ConfigHandle<bool> edgeMoveDynamic("EdgeMoveDynamic");
+
 
 
 // cameras[ACTIVE] is just used to store which of the others is active
@@ -594,8 +597,8 @@ float3 CCamera::GetMoveVectorFromState(bool fromKeyState) const
 			(globalRendering->viewSizeX << 1):
 			(globalRendering->viewSizeX     );
 
-		const float width  = configHandler->GetFloat("EdgeMoveWidth");
-		const bool dynamic = configHandler->GetBool("EdgeMoveDynamic");
+		const float width  = edgeMoveWidth.Get();
+		const bool dynamic = edgeMoveDynamic.Get();
 
 		int2 border;
 		border.x = std::max<int>(1, screenW * width);
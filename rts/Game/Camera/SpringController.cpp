@@ -23,6 +23,9 @@ CONFIG(bool,  CamSpringZoomInToMousePos).defaultValue(true);
 CONFIG(bool,  CamSpringZoomOutFromMousePos).defaultValue(false);
 CONFIG(bool,  CamSpringEdgeRotate).defaultValue(false).description("Rotate camera when cursor touches screen borders.");
 
+static ConfigHandle<bool> camSpringLockCardinalDirs("CamSpringLockCardinalDirections");
+static ConfigHandle<bool> camSpringEdgeRotate("CamSpringEdgeRotate");
+
 
 CSpringController::CSpringController()
 : rot(2.677f, 0.0f, 0.0f)
@@ -69,7 +72,7 @@ void CSpringController::MouseMove(float3 move)
 
 void CSpringController::ScreenEdgeMove(float3 move)
 {
-	const bool doRotate = configHandler->GetBool("CamSpringEdgeRotate");
+	const bool doRotate = camSpringEdgeRotate.Get();
 	const bool belowMax = (mouse->lasty < globalRendering->viewSizeY /  3);
 	const bool aboveMin = (mouse->lasty > globalRendering->viewSizeY / 10);
 
@@ -233,7 +236,7 @@ float CSpringController::MoveAzimuth(float move)
 
 	rot.y -= move;
 
-	if (configHandler->GetBool("CamSpringLockCardinalDirections"))
+	if (camSpringLockCardinalDirs.Get())
 		return GetRotationWithCardinalLock(rot.y);
 	if (KeyInput::GetKeyModState(KMOD_CTRL))
 		rot.y = Clamp(rot.y, minRot + 0.02f, maxRot - 0.02f);
@@ -244,7 +247,7 @@ float CSpringController::MoveAzimuth(float move)
 
 float CSpringController::GetAzimuth() const
 {
-	if (configHandler->GetBool("CamSpringLockCardinalDirections"))
+	if (camSpringLockCardinalDirs.Get())
 		return GetRotationWithCardinalLock(rot.y);
 	return rot.y;
 }
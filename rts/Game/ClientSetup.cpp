@@ -19,6 +19,8 @@ CONFIG(int, HostPortDefault).defaultValue(8452).minimumValue(0).maximumValue(655
 ClientSetup::ClientSetup()
 	: hostIP(configHandler->GetString("HostIPDefault"))
 	, hostPort(configHandler->GetInt("HostPortDefault"))
+	, autohostIP(configHandler->GetString("AutohostIP"))
+	, autohostPort(configHandler->GetInt("AutohostPort"))
 	, isHost(false)
 {
 }
@@ -59,17 +61,16 @@ void ClientSetup::LoadFromStartScript(const std::string& setup)
 	}
 #endif
 
+	// kept per setup (not as config overrides) so that every
+	// server in a multi-game dedicated process has its own
+	file.GetDef(autohostIP,   autohostIP, "GAME\\AutohostIP");
+	file.GetDef(autohostPort, IntToString(autohostPort), "GAME\\AutohostPort");
+
 	//FIXME WTF
-	std::string sourceport, autohostip, autohostport;
+	std::string sourceport;
 	if (file.SGetValue(sourceport, "GAME\\SourcePort")) {
 		configHandler->SetString("SourcePort", sourceport, true);
 	}
-	if (file.SGetValue(autohostip, "GAME\\AutohostIP")) {
-		configHandler->SetString("AutohostIP", autohostip, true);
-	}
-	if (file.SGetValue(autohostport, "GAME\\AutohostPort")) {
-		configHandler->SetString("AutohostPort", autohostport, true);
-	}
 
 	file.GetDef(saveFile, "", "GAME\\SaveFile");
 	file.GetDef(demoFile, "", "GAME\\DemoFile");
@@ -27,6 +27,10 @@ public:
 	//! if this client is the server player, the port over which we accept incoming connections
 	int hostPort;
 
+	//! address of the autohost controlling this game's server, disabled if autohostPort is 0
+	std::string autohostIP;
+	int autohostPort;
+
 	bool isHost;
 };
 
@@ -0,0 +1,423 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include "DemoBatch.h"
+
+#include "GameSetup.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/Team.h"
+#include "Sim/Misc/TeamHandler.h"
+#include "System/EventHandler.h"
+#include "System/LogOutput.h"
+#include "System/SpringExitCode.h"
+#include "System/SpringFormat.h"
+#include "System/StringUtil.h"
+#include "System/TimeProfiler.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/ArchiveScanner.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/Log/Backend.h"
+#include "System/Log/FileSink.h"
+#include "System/Log/ILog.h"
+#include "System/Platform/Misc.h"
+#include "System/Platform/Threading.h"
+
+bool CDemoBatch::enabled = false;
+bool CDemoBatch::unlimited = false;
+bool CDemoBatch::recordTimers = false;
+
+// shared by the supervisor and all children, opened with O_APPEND
+static int outputFd = -1;
+static std::string batchDemoFile;
+
+
+#ifndef WIN32
+static void InitChild(size_t demoNum, const std::string& demoFile)
+{
+	CDemoBatch::enabled = true;
+	batchDemoFile = demoFile;
+
+	// the inherited log belongs to the supervisor, give each child its own
+	const std::string& logFile = logOutput.GetFilePath();
+	const std::string childLogFile = logFile.substr(0, logFile.find_last_of('.')) + IntToString(demoNum, "-batch%i.txt");
+
+	log_file_removeLogFile(logFile.c_str());
+	log_file_addLogFile(childLogFile.c_str(), nullptr, LOG_LEVEL_ALL, configHandler->GetInt("LogFlushLevel"));
+
+	LOG("[DemoBatch::%s] replaying demo %u: %s", __func__, unsigned(demoNum), demoFile.c_str());
+}
+#endif
+
+
+bool CDemoBatch::Supervise(const std::string& listFile, const std::string& outputFile, int numJobs, std::string& demoFile, int& exitCode)
+{
+	exitCode = spring::EXIT_CODE_FAILURE;
+
+#ifdef WIN32
+	LOG_L(L_ERROR, "[DemoBatch::%s] batch replays need fork(), which is not available on this platform", __func__);
+	return true;
+#else
+	const std::string listPath = FileSystem::IsAbsolutePath(listFile)? listFile: (Platform::GetOrigCWD() + listFile);
+
+	std::ifstream listStream(listPath);
+	std::vector<std::string> demoFiles;
+
+	if (!listStream.good()) {
+		LOG_L(L_ERROR, "[DemoBatch::%s] can not read demo list %s", __func__, listPath.c_str());
+		return true;
+	}
+
+	// one demo per line, blank lines and #comments are skipped
+	for (std::string line; std::getline(listStream, line); ) {
+		StringTrimInPlace(line);
+
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		demoFiles.push_back(line);
+	}
+
+	if ((outputFd = open(outputFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644)) == -1) {
+		LOG_L(L_ERROR, "[DemoBatch::%s] can not open %s for writing: %s", __func__, outputFile.c_str(), strerror(errno));
+		return true;
+	}
+
+	if (numJobs <= 0)
+		numJobs = Threading::GetPhysicalCpuCores();
+
+	LOG("[DemoBatch::%s] replaying %u demos (%d at a time%s), writing records to %s", __func__, unsigned(demoFiles.size()), numJobs, (unlimited? ", unlimited speed": ""), outputFile.c_str());
+
+	// a writer thread would not exist in the children (see LogAsync)
+	log_backend_stopAsync();
+
+	// scan all archives once, every child inherits the result instead of redoing it
+	// (there are no other threads yet, which keeps forking safe)
+	archiveScanner = new CArchiveScanner();
+
+	std::map<pid_t, size_t> children;
+
+	size_t nextDemo = 0;
+	size_t numFailed = 0;
+
+	while (nextDemo < demoFiles.size() || !children.empty()) {
+		if (nextDemo < demoFiles.size() && children.size() < size_t(numJobs)) {
+			// nothing still buffered may be written by the children again
+			fflush(nullptr);
+
+			const pid_t pid = fork();
+
+			if (pid == 0) {
+				demoFile = demoFiles[nextDemo];
+
+				InitChild(nextDemo, demoFile);
+				return false;
+			}
+
+			if (pid == -1) {
+				LOG_L(L_ERROR, "[DemoBatch::%s] fork failed for %s: %s", __func__, demoFiles[nextDemo].c_str(), strerror(errno));
+
+				batchDemoFile = demoFiles[nextDemo++];
+				numFailed += 1;
+
+				WriteRecord("error", "\"status\":\"fork failed\"");
+				continue;
+			}
+
+			children[pid] = nextDemo++;
+			continue;
+		}
+
+		int status = 0;
+		const pid_t pid = waitpid(-1, &status, 0);
+
+		if (pid == -1) {
+			if (errno == EINTR)
+				continue;
+
+			LOG_L(L_ERROR, "[DemoBatch::%s] waitpid failed: %s", __func__, strerror(errno));
+			break;
+		}
+
+		const auto it = children.find(pid);
+
+		if (it == children.end())
+			continue;
+
+		batchDemoFile = demoFiles[it->second];
+		children.erase(it);
+
+		if (WIFEXITED(status) && WEXITSTATUS(status) == spring::EXIT_CODE_SUCCESS) {
+			LOG("[DemoBatch::%s] finished %s (%u left)", __func__, batchDemoFile.c_str(), unsigned(demoFiles.size() - nextDemo + children.size()));
+			continue;
+		}
+
+		// a crashed child can not say so itself
+		const std::string reason = WIFEXITED(status)? IntToString(int(int8_t(WEXITSTATUS(status))), "exit code %i"): IntToString(WTERMSIG(status), "signal %i");
+
+		LOG_L(L_WARNING, "[DemoBatch::%s] replay of %s failed (%s)", __func__, batchDemoFile.c_str(), reason.c_str());
+		WriteRecord("error", "\"status\":" + QuoteString(reason));
+
+		numFailed += 1;
+	}
+
+	close(outputFd);
+	outputFd = -1;
+
+	LOG("[DemoBatch::%s] replayed %u demos, %u failed", __func__, unsigned(demoFiles.size()), unsigned(numFailed));
+
+	if (numFailed == 0)
+		exitCode = spring::EXIT_CODE_SUCCESS;
+
+	return true;
+#endif
+}
+
+
+bool CDemoBatch::WriteRecord(const char* type, const std::string& fields)
+{
+	if (outputFd == -1)
+		return false;
+
+	std::string line = "{\"demo\":" + QuoteString(batchDemoFile) + ",\"type\":\"" + type + "\"";
+
+	if (!fields.empty())
+		line += "," + fields;
+
+	line += "}\n";
+
+#ifndef WIN32
+	// O_APPEND puts the whole line at the end of the file, whichever child writes
+	return (write(outputFd, line.data(), line.size()) == ssize_t(line.size()));
+#else
+	return false;
+#endif
+}
+
+std::string CDemoBatch::QuoteString(const std::string& str)
+{
+	std::string ret = "\"";
+	ret.reserve(str.size() + 2);
+
+	for (const char c: str) {
+		switch (c) {
+			case '"' : { ret += "\\\""; } break;
+			case '\\': { ret += "\\\\"; } break;
+			case '\n': { ret += "\\n"; } break;
+			case '\r': { ret += "\\r"; } break;
+			case '\t': { ret += "\\t"; } break;
+			default: {
+				if ((unsigned char)c < 0x20) {
+					ret += IntToString(c, "\\u%04x");
+				} else {
+					ret += c;
+				}
+			} break;
+		}
+	}
+
+	return (ret + "\"");
+}
+
+
+CDemoBatch* CDemoBatch::GetInstance()
+{
+	static CDemoBatch instance;
+	return &instance;
+}
+
+CDemoBatch::CDemoBatch()
+	: CEventClient("[CDemoBatch]", 271991, false)
+	, numTimerFrames(0)
+	, gameOver(false)
+{
+	eventHandler.AddClient(this);
+}
+
+CDemoBatch::~CDemoBatch()
+{
+	eventHandler.RemoveClient(this);
+}
+
+
+void CDemoBatch::ResetState()
+{
+	numWrittenStats.clear();
+	winningAllyTeams.clear();
+
+	startTime = spring_gettime();
+	gameOver = false;
+
+	timerFrameTimes.clear();
+	timerTotals.clear();
+	numTimerFrames = 0;
+
+	if (recordTimers) {
+		// nothing is drawn in a batch, so this stays on; otherwise only special timers count
+		profiler.SetEnabled(true);
+
+		// time spent while loading does not belong to any frame
+		for (unsigned timerID = 0, numTimers = profiler.GetNumTimers(); timerID < numTimers; timerID++) {
+			timerTotals.push_back(profiler.GetTimerTotal(timerID));
+		}
+	}
+
+	WriteRecord("start", "\"game\":" + QuoteString(gameSetup->modName) + ",\"map\":" + QuoteString(gameSetup->mapName));
+}
+
+
+void CDemoBatch::GameFrame(int gameFrame)
+{
+	const int numTeams = teamHandler->ActiveTeams() - int(gs->useLuaGaia);
+
+	numWrittenStats.resize(numTeams, 0);
+
+	if (recordTimers)
+		SampleTimers();
+
+	for (int teamNum = 0; teamNum < numTeams; teamNum++) {
+		const CTeam* team = teamHandler->Team(teamNum);
+
+		// the last entry is still being accumulated
+		for (size_t& n = numWrittenStats[teamNum]; (n + 1) < team->statHistory.size(); n++) {
+			WriteTeamStats(teamNum, n, false);
+		}
+	}
+}
+
+void CDemoBatch::GameOver(const std::vector<unsigned char>& winners)
+{
+	winningAllyTeams = winners;
+	gameOver = true;
+}
+
+
+void CDemoBatch::DemoEnd()
+{
+	GameFrame(gs->frameNum);
+
+	for (size_t teamNum = 0; teamNum < numWrittenStats.size(); teamNum++) {
+		WriteTeamStats(teamNum, teamHandler->Team(teamNum)->statHistory.size() - 1, true);
+	}
+
+	if (recordTimers)
+		WriteTimerStats();
+
+	std::string winners;
+
+	for (const unsigned char allyTeam: winningAllyTeams) {
+		winners += (winners.empty()? "": ",") + IntToString(allyTeam);
+	}
+
+	WriteRecord("end", spring::format("\"frame\":%d,\"gameOver\":%s,\"winners\":[%s],\"wallTime\":%.3f",
+		gs->frameNum,
+		(gameOver? "true": "false"),
+		winners.c_str(),
+		(spring_gettime() - startTime).toSecsf()
+	));
+}
+
+
+void CDemoBatch::WriteTeamStats(int teamNum, size_t statNum, bool final)
+{
+	const TeamStatistics& stats = teamHandler->Team(teamNum)->statHistory[statNum];
+
+	// the unfinished last entry is stamped with the current frame, not the one it would complete at
+	WriteRecord("teamstats", spring::format(
+		"\"team\":%d,\"frame\":%d,\"final\":%s,"
+		"\"metalUsed\":%.9g,\"energyUsed\":%.9g,"
+		"\"metalProduced\":%.9g,\"energyProduced\":%.9g,"
+		"\"metalExcess\":%.9g,\"energyExcess\":%.9g,"
+		"\"metalReceived\":%.9g,\"energyReceived\":%.9g,"
+		"\"metalSent\":%.9g,\"energySent\":%.9g,"
+		"\"damageDealt\":%.9g,\"damageReceived\":%.9g,"
+		"\"unitsProduced\":%d,\"unitsDied\":%d,"
+		"\"unitsReceived\":%d,\"unitsSent\":%d,"
+		"\"unitsCaptured\":%d,\"unitsOutCaptured\":%d,"
+		"\"unitsKilled\":%d",
+		teamNum, (final? gs->frameNum: stats.frame), (final? "true": "false"),
+		stats.metalUsed, stats.energyUsed,
+		stats.metalProduced, stats.energyProduced,
+		stats.metalExcess, stats.energyExcess,
+		stats.metalReceived, stats.energyReceived,
+		stats.metalSent, stats.energySent,
+		stats.damageDealt, stats.damageReceived,
+		stats.unitsProduced, stats.unitsDied,
+		stats.unitsReceived, stats.unitsSent,
+		stats.unitsCaptured, stats.unitsOutCaptured,
+		stats.unitsKilled
+	));
+}
+
+
+void CDemoBatch::SampleTimers()
+{
+	const unsigned numTimers = profiler.GetNumTimers();
+
+	// timers registered since the last sample start from zero
+	timerFrameTimes.resize(numTimers);
+	timerTotals.resize(numTimers, spring_notime);
+
+	for (unsigned timerID = 0; timerID < numTimers; timerID++) {
+		const spring_time total = profiler.GetTimerTotal(timerID);
+
+		std::vector<float>& frameTimes = timerFrameTimes[timerID];
+
+		// a timer registered mid-demo did not run in the frames before
+		frameTimes.resize(numTimerFrames, 0.0f);
+		frameTimes.push_back((total - timerTotals[timerID]).toMilliSecsf());
+
+		timerTotals[timerID] = total;
+	}
+
+	numTimerFrames += 1;
+}
+
+void CDemoBatch::WriteTimerStats()
+{
+	for (size_t timerID = 0; timerID < timerFrameTimes.size(); timerID++) {
+		std::vector<float>& frameTimes = timerFrameTimes[timerID];
+
+		frameTimes.resize(numTimerFrames, 0.0f);
+
+		float total = 0.0f;
+
+		for (const float t: frameTimes) {
+			total += t;
+		}
+
+		if (total <= 0.0f)
+			continue;
+
+		std::sort(frameTimes.begin(), frameTimes.end());
+
+		// nearest-rank
+		const auto Percentile = [&](float p) {
+			return frameTimes[std::max(size_t(std::ceil(p * frameTimes.size())), size_t(1)) - 1];
+		};
+
+		WriteRecord("timer", spring::format("\"timer\":%s,\"frames\":%u,\"total\":%.3f,\"mean\":%.4f,\"p50\":%.4f,\"p90\":%.4f,\"p99\":%.4f,\"max\":%.4f",
+			QuoteString(profiler.GetTimerName(timerID)).c_str(),
+			unsigned(frameTimes.size()),
+			total,
+			total / frameTimes.size(),
+			Percentile(0.5f),
+			Percentile(0.9f),
+			Percentile(0.99f),
+			frameTimes.back()
+		));
+	}
+}
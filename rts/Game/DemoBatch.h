@@ -0,0 +1,91 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _DEMO_BATCH_H
+#define _DEMO_BATCH_H
+
+#include <string>
+#include <vector>
+
+#include "System/EventClient.h"
+#include "System/Misc/SpringTime.h"
+
+/**
+ * @brief replays a list of demos in forked engine instances
+ *
+ * The supervising process scans all archives once, then forks up to numJobs
+ * children at a time which inherit the scan and each replay one demo like a
+ * regular command-line replay. Every child appends its records to the shared
+ * output file as JSON lines, each written with a single write() call so that
+ * lines of concurrent children never interleave.
+ *
+ * With recordTimers, every child also records the per-frame time of each
+ * profiler timer and writes one "timer" record per timer that ran, holding
+ * its total, mean, 50th/90th/99th percentile and maximum frame time (in ms)
+ * over the whole demo; see tools/benchmark/sim_benchmark.sh.
+ */
+class CDemoBatch : public CEventClient
+{
+public:
+	/// true in a child replaying one demo of a batch
+	static bool enabled;
+	/// feed and simulate the demo as fast as possible, skip all unsynced work
+	static bool unlimited;
+	/// write per-frame percentiles of every profiler timer at the end of each demo
+	static bool recordTimers;
+
+	/**
+	 * Returns true in the supervisor once every demo in listFile has been
+	 * replayed (exitCode tells if all of them succeeded), false in a forked
+	 * child which should continue by replaying demoFile.
+	 */
+	static bool Supervise(const std::string& listFile, const std::string& outputFile, int numJobs, std::string& demoFile, int& exitCode);
+
+	/// appends {"demo":..., "type":type, <fields>} to the output, false when not batching
+	static bool WriteRecord(const char* type, const std::string& fields);
+	static std::string QuoteString(const std::string& str);
+
+	static CDemoBatch* GetInstance();
+
+public:
+	CDemoBatch();
+	~CDemoBatch();
+
+	void ResetState();
+
+	// CEventClient interface
+	bool WantsEvent(const std::string& eventName) {
+		return (eventName == "GameFrame") || (eventName == "GameOver");
+	}
+	bool GetFullRead() const { return true; }
+	int  GetReadAllyTeam() const { return AllAccessTeam; }
+
+	void GameFrame(int gameFrame);
+	void GameOver(const std::vector<unsigned char>& winningAllyTeams);
+
+	/// writes the final records, called after the last frame of the demo was simulated
+	void DemoEnd();
+
+private:
+	void WriteTeamStats(int teamNum, size_t statNum, bool final);
+
+	void SampleTimers();
+	void WriteTimerStats();
+
+private:
+	/// per team, number of finished statHistory entries written so far
+	std::vector<size_t> numWrittenStats;
+	std::vector<unsigned char> winningAllyTeams;
+
+	/// per timer (by id), its time in each frame sampled so far
+	std::vector< std::vector<float> > timerFrameTimes;
+	/// per timer, GetTimerTotal at the last sample
+	std::vector<spring_time> timerTotals;
+
+	size_t numTimerFrames;
+
+	spring_time startTime;
+
+	bool gameOver;
+};
+
+#endif // _DEMO_BATCH_H
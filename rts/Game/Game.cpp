@@ -6,6 +6,7 @@
 
 #include "Game.h"
 #include "Benchmark.h"
+#include "DemoBatch.h"
 #include "Camera.h"
 #include "CameraHandler.h"
 #include "ChatMessage.h"
@@ -15,7 +16,9 @@
 #include "GameSetup.h"
 #include "GlobalUnsynced.h"
 #include "LoadScreen.h"
+#include "LoadTaskGraph.h"
 #include "SelectedUnitsHandler.h"
+#include "SlowFrameCapture.h"
 #include "WaitCommandsAI.h"
 #include "WordCompletion.h"
 #include "IVideoCapturing.h"
@@ -39,9 +42,11 @@
 #include "Rendering/Env/MapRendering.h"
 #include "Rendering/Fonts/CFontTexture.h"
 #include "Rendering/Fonts/glFont.h"
+#include "Rendering/GL/GLTimerProfiler.h"
 #include "Rendering/GL/MatrixState.hpp"
 #include "Rendering/CommandDrawer.h"
 #include "Rendering/LineDrawer.h"
+#include "Rendering/Screenshot.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/DebugDrawerAI.h"
 #include "Rendering/HUDDrawer.h"
@@ -49,7 +54,9 @@
 #include "Rendering/TeamHighlight.h"
 #include "Rendering/UnitDrawer.h"
 #include "Rendering/Map/InfoTexture/IInfoTextureHandler.h"
+#include "Rendering/Models/IModelParser.h"
 #include "Rendering/Textures/NamedTextures.h"
+#include "Lua/LuaDefsCache.h"
 #include "Lua/LuaGaia.h"
 #include "Lua/LuaHandle.h"
 #include "Lua/LuaInputReceiver.h"
@@ -81,6 +88,7 @@
 #include "Sim/Misc/ResourceHandler.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/MoveTypes/MoveTypeFactory.h"
+#include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #include "Sim/Path/IPathManager.h"
 #include "Sim/Projectiles/ExplosionGenerator.h"
 #include "Sim/Projectiles/Projectile.h"
@@ -114,20 +122,26 @@
 #include "Net/GameServer.h"
 #include "Net/Protocol/NetProtocol.h"
 #include "System/SafeUtil.h"
+#include "System/FrameArena.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/FileSystem/VFSHandler.h"
 #include "System/LoadSave/LoadSaveHandler.h"
+#include "System/LoadSave/CregLoadSaveHandler.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/Watchdog.h"
 #include "System/Sound/ISound.h"
 #include "System/Sound/ISoundChannels.h"
 #include "System/Sync/DumpState.h"
+#include "System/Sync/SyncedPrimitiveBase.h"
 #include "System/TimeProfiler.h"
 
 
 #undef CreateDirectory
 
 CONFIG(bool, GameEndOnConnectionLoss).defaultValue(true);
+CONFIG(bool, LoadingParallel).defaultValue(true).description("Run independent loading steps (gamedata, sound and CEG parsing, ...) on worker threads while the map and GL resources load.");
+CONFIG(bool, PreloadModels).defaultValue(true).description("Parse the models and textures of all unit and feature definitions on worker threads during loading, instead of when each is first needed in-game.");
 CONFIG(bool, WindowedEdgeMove).defaultValue(true).description("Sets whether moving the mouse cursor to the screen edge will move the camera across the map.");
 CONFIG(bool, FullscreenEdgeMove).defaultValue(true).description("see WindowedEdgeMove, just for fullscreen mode");
 CONFIG(bool, ShowFPS).defaultValue(false).description("Displays current framerate.");
@@ -136,6 +150,12 @@ CONFIG(bool, ShowSpeed).defaultValue(false).description("Displays current game s
 CONFIG(int, ShowPlayerInfo).defaultValue(1).headlessValue(0);
 CONFIG(float, GuiOpacity).defaultValue(0.8f).minimumValue(0.0f).maximumValue(1.0f).description("Sets the opacity of the built-in Spring UI. Generally has no effect on LuaUI widgets. Can be set in-game using shift+, to decrease and shift+. to increase.");
 CONFIG(std::string, InputTextGeo).defaultValue("");
+CONFIG(int, LateJoinCheckpointInterval).defaultValue(0).minimumValue(0).description("If hosting, save the game-state every N seconds so late-joining clients can load it instead of simulating the game from its start. 0 disables; unsuitable for games whose Lua state is not restored by the Load call-in.");
+CONFIG(int, DemoCheckpointInterval).defaultValue(0).minimumValue(0).description("Save the game-state into the recorded demo every N seconds, /skip then jumps to the last one before its target instead of simulating every skipped frame. 0 disables; checkpoints only load in the same engine version.");
+
+// read every sim frame
+static ConfigHandle<int> lateJoinCheckpointInterval("LateJoinCheckpointInterval");
+static ConfigHandle<int> demoCheckpointInterval("DemoCheckpointInterval");
 
 
 CGame* game = nullptr;
@@ -194,6 +214,7 @@ CR_REG_METADATA(CGame, (
 	CR_IGNORED(skipSoundmute),
 	CR_IGNORED(skipOldSpeed),
 	CR_IGNORED(skipOldUserSpeed),
+	CR_IGNORED(fastForwardSoundMute),
 
 	CR_MEMBER(speedControl),
 
@@ -202,6 +223,9 @@ CR_REG_METADATA(CGame, (
 	CR_IGNORED(worldDrawer),
 	CR_IGNORED(defsParser),
 	CR_IGNORED(saveFile),
+	CR_IGNORED(checkpointData),
+	CR_IGNORED(lastCheckpointFrame),
+	CR_IGNORED(lastDemoCheckpointFrame),
 
 	// from CGameController
 	CR_IGNORED(writingPos),
@@ -249,11 +273,14 @@ CGame::CGame(const std::string& mapName, const std::string& modName, ILoadSaveHa
 	, skipSoundmute(false)
 	, skipOldSpeed(0.0f)
 	, skipOldUserSpeed(0.0f)
+	, fastForwardSoundMute(false)
 	, speedControl(-1)
 	, consoleHistory(nullptr)
 	, worldDrawer(nullptr)
 	, defsParser(nullptr)
 	, saveFile(saveFile)
+	, lastCheckpointFrame(0)
+	, lastDemoCheckpointFrame(0)
 	, finishedLoading(false)
 	, gameOver(false)
 {
@@ -385,70 +412,49 @@ void CGame::LoadGame(const std::string& mapName)
 	auto& globalQuit = gu->globalQuit;
 	bool  forcedQuit = false;
 
-	try {
-		LOG("[Game::%s][1] globalQuit=%d threaded=%d", __func__, globalQuit, !Threading::IsMainThread());
-
-		LoadMap(mapName);
-		LoadDefs();
-	} catch (const content_error& e) {
-		LOG_L(L_WARNING, "[Game::%s][1] forced quit with exception \"%s\"", __func__, e.what());
-
-		// we can not (yet) do a clean early exit here because the dtor assumes
-		// all loading stages proceeded normally; just force automatic shutdown
-		forcedQuit = true;
-	}
-
-	try {
-		LOG("[Game::%s][2] globalQuit=%d forcedQuit=%d", __func__, globalQuit, forcedQuit);
-
-		PreLoadSimulation();
-		PreLoadRendering();
-	} catch (const content_error& e) {
-		LOG_L(L_WARNING, "[Game::%s][2] forced quit with exception \"%s\"", __func__, e.what());
-		forcedQuit = true;
-	}
-
-	try {
-		LOG("[Game::%s][3] globalQuit=%d forcedQuit=%d", __func__, globalQuit, forcedQuit);
-
-		PostLoadSimulation();
-		PostLoadRendering();
-	} catch (const content_error& e) {
-		LOG_L(L_WARNING, "[Game::%s][3] forced quit with exception \"%s\"", __func__, e.what());
-		forcedQuit = true;
-	}
-
-	try {
-		LOG("[Game::%s][4] globalQuit=%d forcedQuit=%d", __func__, globalQuit, forcedQuit);
-
-		LoadInterface();
-		LoadLua();
-	} catch (const content_error& e) {
-		LOG_L(L_WARNING, "[Game::%s][4] forced quit with exception \"%s\"", __func__, e.what());
-		forcedQuit = true;
-	}
-
-	try {
-		LOG("[Game::%s][5] globalQuit=%d forcedQuit=%d", __func__, globalQuit, forcedQuit);
+	LOG("[Game::%s] globalQuit=%d threaded=%d", __func__, globalQuit, !Threading::IsMainThread());
+
+	typedef CLoadTaskGraph Graph;
+	Graph graph;
+
+	// map, icons and GL resources in general can only be created by the load-thread
+	// worker tasks must not touch the event handler, defsParser (after gamedata), or Lua
+	const Graph::TaskID map = graph.AddTask("Map", "Parsing Map Information", Graph::LOAD_THREAD, [&]() { LoadMap(mapName); });
+	const Graph::TaskID gameData = graph.AddTask("GameData", "Loading GameData Definitions", Graph::WORKER, [&]() { LoadGameData(); });
+	const Graph::TaskID soundDefs = graph.AddTask("SoundDefs", "Loading Sound Definitions", Graph::WORKER, [&]() { LoadSoundDefs(); });
+	const Graph::TaskID cegs = graph.AddTask("CEGs", "Parsing CEG Definitions", Graph::WORKER, [&]() { explGenHandler = new CExplosionGeneratorHandler(); });
+	const Graph::TaskID icons = graph.AddTask("Icons", "Loading Radar Icons", Graph::LOAD_THREAD, [&]() { icon::iconHandler = new icon::CIconHandler(); });
+
+	const Graph::TaskID quadField = graph.AddTask("QuadField", "Creating QuadField", Graph::WORKER, [&]() { LoadQuadField(); }, {map});
+	// uses for_mt, which only the load-thread may
+	const Graph::TaskID smoothGround = graph.AddTask("SmoothGround", "Creating Smooth Height Mesh", Graph::LOAD_THREAD, [&]() { LoadSmoothGround(); }, {map});
+	const Graph::TaskID moveDefs = graph.AddTask("MoveDefs", "Loading Move and Armor Definitions", Graph::LOAD_THREAD, [&]() { LoadMoveDefs(); }, {map, gameData});
+	const Graph::TaskID preRendering = graph.AddTask("PreLoadRendering", "", Graph::LOAD_THREAD, [&]() { PreLoadRendering(); }, {map});
+
+	const Graph::TaskID simulation = graph.AddTask("PostLoadSimulation", "", Graph::LOAD_THREAD, [&]() { PostLoadSimulation(); }, {icons, soundDefs, cegs, quadField, smoothGround, moveDefs, preRendering});
+	const Graph::TaskID rendering = graph.AddTask("PostLoadRendering", "", Graph::LOAD_THREAD, [&]() { PostLoadRendering(); }, {simulation});
+
+	// everything from here on depends on everything before it
+	const Graph::TaskID ui = graph.AddTask("Interface", "", Graph::LOAD_THREAD, [&]() { LoadInterface(); }, {rendering});
+	const Graph::TaskID lua = graph.AddTask("Lua", "", Graph::LOAD_THREAD, [&]() { LoadLua(); }, {ui});
+	const Graph::TaskID models = graph.AddTask("Models", "Loading Models", Graph::LOAD_THREAD, [&]() { LoadModels(); }, {lua});
+	const Graph::TaskID finalize = graph.AddTask("Finalize", "", Graph::LOAD_THREAD, [&]() { LoadFinalize(); }, {models});
+	const Graph::TaskID skirmishAIs = graph.AddTask("SkirmishAIs", "", Graph::LOAD_THREAD, [&]() { LoadSkirmishAIs(); }, {finalize});
+
+	graph.AddTask("SavedGame", "", Graph::LOAD_THREAD, [&]() {
+		if (globalQuit || saveFile == nullptr)
+			return;
 
-		LoadFinalize();
-		LoadSkirmishAIs();
-	} catch (const content_error& e) {
-		LOG_L(L_WARNING, "[Game::%s][5] forced quit with exception \"%s\"", __func__, e.what());
-		forcedQuit = true;
-	}
+		loadscreen->SetLoadMessage("Loading Saved Game");
+		saveFile->LoadGame();
+	}, {skirmishAIs});
 
-	try {
-		LOG("[Game::%s][6] globalQuit=%d forcedQuit=%d", __func__, globalQuit, forcedQuit);
+	// any content_error is logged by the graph; we can not (yet) do a clean
+	// early exit because the dtor assumes all loading stages proceeded, so
+	// every step still runs and automatic shutdown is forced afterwards
+	forcedQuit = !graph.Run(configHandler->GetBool("LoadingParallel"));
 
-		if (!globalQuit && saveFile != nullptr) {
-			loadscreen->SetLoadMessage("Loading Saved Game");
-			saveFile->LoadGame();
-		}
-	} catch (const content_error& e) {
-		LOG_L(L_WARNING, "[Game::%s][6] forced quit with exception \"%s\"", __func__, e.what());
-		forcedQuit = true;
-	}
+	LOG("[Game::%s] globalQuit=%d forcedQuit=%d", __func__, globalQuit, forcedQuit);
 
 	Watchdog::DeregisterThread(WDT_LOAD);
 	AddTimedJobs();
@@ -463,15 +469,13 @@ void CGame::LoadMap(const std::string& mapName)
 	ENTER_SYNCED_CODE();
 
 	{
-		loadscreen->SetLoadMessage("Parsing Map Information");
-
 		waterRendering->Init();
 		mapRendering->Init();
 
 		// simulation components
 		helper->Init();
 		readMap = CReadMap::LoadMap(mapName);
-		groundBlockingObjectMap = new CGroundBlockingObjectMap(mapDims.mapSquares);
+		groundBlockingObjectMap = new CGroundBlockingObjectMap(mapDims.mapx, mapDims.mapy);
 		buildingMaskMap = new BuildingMaskMap();
 	}
 
@@ -479,81 +483,77 @@ void CGame::LoadMap(const std::string& mapName)
 }
 
 
-void CGame::LoadDefs()
+void CGame::LoadGameData()
 {
-	ENTER_SYNCED_CODE();
+	ScopedOnceTimer timer("Game::LoadGameData");
 
-	{
-		loadscreen->SetLoadMessage("Loading Radar Icons");
-		icon::iconHandler = new icon::CIconHandler();
-	}
+	defsParser = new LuaParser("gamedata/defs.lua", SPRING_VFS_MOD_BASE, SPRING_VFS_ZIP, {true});
+	// customize the defs environment
+	defsParser->GetTable("Spring");
+	defsParser->AddFunc("GetModOptions", LuaSyncedRead::GetModOptions);
+	defsParser->AddFunc("GetMapOptions", LuaSyncedRead::GetMapOptions);
+	defsParser->EndTable();
 
-	{
-		ScopedOnceTimer timer("Game::LoadDefs (GameData)");
-		loadscreen->SetLoadMessage("Loading GameData Definitions");
+	// run the parser, or load its cached output
+	if (!LuaDefsCache::Execute(defsParser))
+		throw content_error("Defs-Parser: " + defsParser->GetErrorLog());
 
-		defsParser = new LuaParser("gamedata/defs.lua", SPRING_VFS_MOD_BASE, SPRING_VFS_ZIP, {true});
-		// customize the defs environment
-		defsParser->GetTable("Spring");
-		defsParser->AddFunc("GetModOptions", LuaSyncedRead::GetModOptions);
-		defsParser->AddFunc("GetMapOptions", LuaSyncedRead::GetMapOptions);
-		defsParser->EndTable();
+	const LuaTable& root = defsParser->GetRoot();
 
-		// run the parser
-		if (!defsParser->Execute())
-			throw content_error("Defs-Parser: " + defsParser->GetErrorLog());
+	if (!root.IsValid())
+		throw content_error("Error loading gamedata definitions");
 
-		const LuaTable& root = defsParser->GetRoot();
+	// bail now if any of these tables are invalid
+	// makes searching for errors that much easier
+	if (!root.SubTable("UnitDefs").IsValid())
+		throw content_error("Error loading UnitDefs");
 
-		if (!root.IsValid())
-			throw content_error("Error loading gamedata definitions");
+	if (!root.SubTable("FeatureDefs").IsValid())
+		throw content_error("Error loading FeatureDefs");
 
-		// bail now if any of these tables are invalid
-		// makes searching for errors that much easier
-		if (!root.SubTable("UnitDefs").IsValid())
-			throw content_error("Error loading UnitDefs");
+	if (!root.SubTable("WeaponDefs").IsValid())
+		throw content_error("Error loading WeaponDefs");
 
-		if (!root.SubTable("FeatureDefs").IsValid())
-			throw content_error("Error loading FeatureDefs");
+	if (!root.SubTable("ArmorDefs").IsValid())
+		throw content_error("Error loading ArmorDefs");
 
-		if (!root.SubTable("WeaponDefs").IsValid())
-			throw content_error("Error loading WeaponDefs");
-
-		if (!root.SubTable("ArmorDefs").IsValid())
-			throw content_error("Error loading ArmorDefs");
-
-		if (!root.SubTable("MoveDefs").IsValid())
-			throw content_error("Error loading MoveDefs");
+	if (!root.SubTable("MoveDefs").IsValid())
+		throw content_error("Error loading MoveDefs");
+}
 
-	}
+void CGame::LoadSoundDefs()
+{
+	ScopedOnceTimer timer("Game::LoadSoundDefs");
 
-	{
-		ScopedOnceTimer timer("Game::LoadDefs (Sound)");
-		loadscreen->SetLoadMessage("Loading Sound Definitions");
+	sound->LoadSoundDefs("gamedata/sounds.lua", SPRING_VFS_MOD_BASE);
+	chatSound = sound->GetSoundId("IncomingChat");
+}
 
-		sound->LoadSoundDefs("gamedata/sounds.lua", SPRING_VFS_MOD_BASE);
-		chatSound = sound->GetSoundId("IncomingChat");
-	}
 
-	LEAVE_SYNCED_CODE();
+void CGame::LoadQuadField()
+{
+	quadField = new CQuadField(int2(mapDims.mapx, mapDims.mapy), CQuadField::BASE_QUAD_SIZE);
 }
 
-void CGame::PreLoadSimulation()
+void CGame::LoadSmoothGround()
 {
 	ENTER_SYNCED_CODE();
-
-	loadscreen->SetLoadMessage("Creating Smooth Height Mesh");
 	smoothGround = new SmoothHeightMesh(float3::maxxpos, float3::maxzpos, SQUARE_SIZE * 2, SQUARE_SIZE * 40);
+	LEAVE_SYNCED_CODE();
+}
 
-	loadscreen->SetLoadMessage("Creating QuadField & CEGs");
+void CGame::LoadMoveDefs()
+{
+	ENTER_SYNCED_CODE();
 	moveDefHandler = new MoveDefHandler(defsParser);
-	quadField = new CQuadField(int2(mapDims.mapx, mapDims.mapy), CQuadField::BASE_QUAD_SIZE);
 	damageArrayHandler = new CDamageArrayHandler(defsParser);
-	explGenHandler = new CExplosionGeneratorHandler();
+	LEAVE_SYNCED_CODE();
 }
 
 void CGame::PostLoadSimulation()
 {
+	ENTER_SYNCED_CODE();
+
 	{
 		ScopedOnceTimer timer("Game::PostLoadSim (WeaponDefs)");
 		loadscreen->SetLoadMessage("Loading Weapon Definitions");
@@ -570,6 +570,8 @@ void CGame::PostLoadSimulation()
 		featureDefHandler = new CFeatureDefHandler(defsParser);
 	}
 
+	PreloadModels();
+
 	CUnit::InitStatic();
 	CCommandAI::InitCommandDescriptionCache();
 	CUnitScriptFactory::InitStatic();
@@ -602,6 +604,8 @@ void CGame::PostLoadSimulation()
 	//   --> need a way to let Lua flush it or re-calculate map
 	//   checksum (over heightmap + blockmap, not raw archive)
 	mapDamage = IMapDamage::GetMapDamage();
+	// the path-managers query these tables while initializing
+	CMoveMath::InitSpeedModMaps();
 	pathManager = IPathManager::GetInstance(modInfo.pathFinderSystem);
 
 	// load map-specific features
@@ -622,6 +626,36 @@ void CGame::PostLoadSimulation()
 	LEAVE_SYNCED_CODE();
 }
 
+void CGame::PreloadModels()
+{
+	if (!configHandler->GetBool("PreloadModels"))
+		return;
+
+	std::vector<std::string> files;
+	files.reserve((unitDefHandler->unitDefs.size() * 2) + featureDefHandler->GetFeatureDefs().size());
+
+	for (const UnitDef& unitDef: unitDefHandler->unitDefs) {
+		files.push_back(modelLoader.FindModelPath(unitDef.modelName));
+		files.push_back(unitDef.scriptName);
+	}
+	for (const auto& p: featureDefHandler->GetFeatureDefs()) {
+		files.push_back(modelLoader.FindModelPath(featureDefHandler->GetFeatureDefByID(p.second)->modelName));
+	}
+
+	// lets solid (.sd7) archives decode each of their blocks only once
+	vfsHandler->PrefetchFiles(files, CVFSHandler::Mod);
+	vfsHandler->PrefetchFiles(files, CVFSHandler::Map);
+
+	// parsed by the ThreadPool while the rest of loading continues;
+	// their GL data is uploaded in one batch by LoadModels
+	for (const UnitDef& unitDef: unitDefHandler->unitDefs) {
+		unitDef.PreloadModel();
+	}
+	for (const auto& p: featureDefHandler->GetFeatureDefs()) {
+		featureDefHandler->GetFeatureDefByID(p.second)->PreloadModel();
+	}
+}
+
 void CGame::PreLoadRendering()
 {
 	geometricObjects = new CGeometricObjects();
@@ -710,6 +744,23 @@ void CGame::LoadInterface()
 	GameSetupDrawer::Enable();
 }
 
+void CGame::LoadModels()
+{
+	if (!configHandler->GetBool("PreloadModels"))
+		return;
+
+	ScopedOnceTimer timer("Game::LoadModels");
+
+	// waits for any model the workers are still parsing, then creates
+	// its buffers and textures here, the thread that owns a GL context
+	for (const UnitDef& unitDef: unitDefHandler->unitDefs) {
+		unitDef.LoadModel();
+	}
+	for (const auto& p: featureDefHandler->GetFeatureDefs()) {
+		featureDefHandler->GetFeatureDefByID(p.second)->LoadModel();
+	}
+}
+
 void CGame::LoadLua()
 {
 	// Lua components
@@ -777,6 +828,11 @@ void CGame::LoadFinalize()
 		benchmark.ResetState();
 	}
 
+	if (CDemoBatch::enabled)
+		CDemoBatch::GetInstance()->ResetState();
+
+	slowFrameCapture.ResetState();
+
 	lastReadNetTime = spring_gettime();
 	lastSimFrameTime = lastReadNetTime;
 	lastDrawFrameTime = lastReadNetTime;
@@ -828,6 +884,7 @@ void CGame::KillMisc()
 	LOG("[Game::%s][1]", __func__);
 	CEndGameBox::Destroy();
 	IVideoCapturing::FreeInstance();
+	slowFrameCapture.Kill();
 
 	LOG("[Game::%s][2]", __func__);
 	// delete this first since AI's might call back into sim-components in their dtors
@@ -898,6 +955,7 @@ void CGame::KillSimulation()
 
 	LOG("[Game::%s][3]", __func__);
 	IPathManager::FreeInstance(pathManager);
+	CMoveMath::FreeSpeedModMaps();
 
 	spring::SafeDelete(readMap);
 	spring::SafeDelete(smoothGround);
@@ -1070,6 +1128,12 @@ bool CGame::Update()
 			GameEnd({}, true);
 	}
 
+	// a batch replay is done once the last frame of its demo was simulated
+	if (CDemoBatch::enabled && !gu->globalQuit && gameServer != nullptr && gameServer->DemoReachedEnd() && GetNumQueuedSimFrameMessages(1) == 0) {
+		CDemoBatch::GetInstance()->DemoEnd();
+		gu->globalQuit = true;
+	}
+
 	LEAVE_SYNCED_CODE();
 
 	{
@@ -1256,6 +1320,13 @@ bool CGame::UpdateUnsynced(const spring_time currentTime)
 
 
 bool CGame::Draw() {
+	// unlimited-speed batch replays skip every unsynced update
+	if (CDemoBatch::unlimited)
+		return false;
+
+	// recycle the per-frame temporaries of everything that ran before
+	FrameArena::BeginFrame(FrameArena::FRAME_TYPE_DRAW);
+
 	const spring_time currentTimePreUpdate = spring_gettime();
 
 	if (UpdateUnsynced(currentTimePreUpdate))
@@ -1267,7 +1338,7 @@ bool CGame::Draw() {
 	const bool doDrawWorld = hideInterface || !fullMiniMap;
 
 	SCOPED_SPECIAL_TIMER("Draw");
-	globalRendering->SetGLTimeStamp(0);
+	SCOPED_GL_TIMER("Draw");
 
 	{
 		SCOPED_TIMER("Draw::DrawGenesis");
@@ -1335,6 +1406,7 @@ bool CGame::Draw() {
 
 	{
 		SCOPED_TIMER("Draw::Screen");
+		SCOPED_GL_TIMER("Draw::Screen");
 
 		if (doDrawWorld)
 			eventHandler.DrawScreenEffects();
@@ -1360,6 +1432,8 @@ bool CGame::Draw() {
 		videoCapturing->RenderFrame();
 	}
 
+	FinishScreenshots();
+
 	SetDrawMode(gameNotDrawing);
 	CTeamHighlight::Disable();
 
@@ -1368,7 +1442,6 @@ bool CGame::Draw() {
 	gu->avgDrawFrameTime = mix(gu->avgDrawFrameTime, currentFrameDrawTime.toMilliSecsf(), 0.05f);
 
 	eventHandler.DbgTimingInfo(TIMING_VIDEO, currentTimePreDraw, currentTimePostDraw);
-	globalRendering->SetGLTimeStamp(CGlobalRendering::FRAME_TIME_QUERY_IDX);
 
 	return true;
 }
@@ -1555,6 +1628,9 @@ void CGame::SimFrame() {
 	gs->frameNum += 1;
 	lastFrameTime = spring_gettime();
 
+	slowFrameCapture.BeginFrame();
+	FrameArena::BeginFrame(FrameArena::FRAME_TYPE_SIM);
+
 	// clear allocator statistics periodically
 	// note: allocator itself should do this (so that
 	// stats are reliable when paused) but see LuaUser
@@ -1564,7 +1640,7 @@ void CGame::SimFrame() {
 	tracefile << "New frame:" << gs->frameNum << " " << gsRNG.GetLastSeed() << "\n";
 #endif
 
-	if (!skipping) {
+	if (!skipping && !gu->fastForwarding && !CDemoBatch::unlimited) {
 		// everything here is unsynced and should ideally moved to Game::Update()
 		waitCommandsAI.Update();
 		geometricObjects->Update();
@@ -1587,24 +1663,42 @@ void CGame::SimFrame() {
 		SCOPED_SPECIAL_TIMER("Sim");
 		{
 			SCOPED_TIMER("Sim::GameFrame");
+			SCOPED_SYNC_SUBSYSTEM(SYNC_LUA);
 			eventHandler.GameFrame(gs->frameNum);
 		}
 		helper->Update();
 		mapDamage->Update();
-		pathManager->Update();
-		unitHandler->Update();
-		projectileHandler->Update();
-		featureHandler->Update();
+		{
+			SCOPED_SYNC_SUBSYSTEM(SYNC_PATH);
+			pathManager->Update();
+		}
+		{
+			SCOPED_SYNC_SUBSYSTEM(SYNC_UNITS);
+			unitHandler->Update();
+		}
+		{
+			SCOPED_SYNC_SUBSYSTEM(SYNC_PROJECTILES);
+			projectileHandler->Update();
+		}
+		{
+			SCOPED_SYNC_SUBSYSTEM(SYNC_FEATURES);
+			featureHandler->Update();
+		}
 		{
 			SCOPED_TIMER("Sim::Script");
 			unitScriptEngine->Tick(33);
 		}
 		wind.Update();
 		losHandler->Update();
+		eventHandler.FlushQueuedEvents();
 		// dead ghosts have to be updated in sim, after los,
 		// to make sure they represent the current knowledge correctly.
 		// should probably be split from drawer
-		unitDrawer->UpdateGhostedBuildings();
+		// (done once by EndFastForward when catching up)
+		if (!gu->fastForwarding) {
+			unitDrawer->UpdateGhostedBuildings();
+			unitDrawer->UpdateDrawPosSnapshots(gs->frameNum);
+		}
 		interceptHandler.Update(false);
 
 		teamHandler->GameFrame(gs->frameNum);
@@ -1616,9 +1710,10 @@ void CGame::SimFrame() {
 	gu->avgSimFrameTime = std::max(gu->avgSimFrameTime, 0.001f);
 
 	eventHandler.DbgTimingInfo(TIMING_SIM, lastFrameTime, lastSimFrameTime);
+	slowFrameCapture.EndFrame(gs->frameNum, lastFrameTime, lastSimFrameTime);
 
 	#ifdef HEADLESS
-	{
+	if (!CDemoBatch::unlimited) {
 		const float msecMaxSimFrameTime = 1000.0f / (GAME_SPEED * gs->wantedSpeedFactor);
 		const float msecDifSimFrameTime = (lastSimFrameTime - lastFrameTime).toMilliSecsf();
 		// multiply by 0.5 to give unsynced code some execution time (50% of our sleep-budget)
@@ -1863,6 +1958,33 @@ void CGame::EndSkip() {
 }
 
 
+void CGame::StartFastForward() {
+	assert(!gu->fastForwarding);
+
+	LOG("[Game::%s] catching up from frame %i", __func__, gs->frameNum);
+
+	// only unsynced work is suppressed, the simulation itself is unchanged
+	gu->fastForwarding = true;
+
+	if (!(fastForwardSoundMute = sound->IsMuted()))
+		sound->Mute();
+}
+
+void CGame::EndFastForward() {
+	assert(gu->fastForwarding);
+
+	LOG("[Game::%s] caught up at frame %i", __func__, gs->frameNum);
+
+	gu->fastForwarding = false;
+
+	if (!fastForwardSoundMute)
+		sound->Mute();
+
+	// bring the render-side state skipped by SimFrame up to date
+	unitDrawer->UpdateGhostedBuildings(true);
+}
+
+
 
 void CGame::DrawSkip(bool blackscreen) {
 	const int framesLeft = (skipEndFrame - gs->frameNum);
@@ -1955,6 +2077,68 @@ void CGame::SaveGame(const std::string& filename, bool overwrite, bool usecreg)
 }
 
 
+void CGame::SaveCheckpoint()
+{
+	// demos being watched carry their own checkpoints
+	if (gameServer != nullptr && gameServer->GetDemoReader() != nullptr)
+		return;
+
+	CDemoRecorder* demoRecorder = clientNet->GetDemoRecorder();
+
+	// only the client running next to the server can hand it checkpoints
+	const int lateJoinInterval = (gameServer != nullptr)? lateJoinCheckpointInterval.Get(): 0;
+	const int demoInterval = (demoRecorder != nullptr)? demoCheckpointInterval.Get(): 0;
+
+	const bool lateJoinCheckpoint = (lateJoinInterval > 0 && gs->frameNum >= (lastCheckpointFrame + lateJoinInterval * GAME_SPEED));
+	const bool demoCheckpoint = (demoInterval > 0 && gs->frameNum >= (lastDemoCheckpointFrame + demoInterval * GAME_SPEED));
+
+	if (!lateJoinCheckpoint && !demoCheckpoint)
+		return;
+
+	SCOPED_TIMER("Game::SaveCheckpoint");
+
+	CCregLoadSaveHandler ls;
+	std::vector<std::uint8_t> data;
+
+	ls.mapName = gameSetup->mapName;
+	ls.modName = gameSetup->modName;
+
+	if (lateJoinCheckpoint)
+		lastCheckpointFrame = gs->frameNum;
+	if (demoCheckpoint)
+		lastDemoCheckpointFrame = gs->frameNum;
+
+	if (!ls.SaveGameToBuffer(data)) {
+		LOG_L(L_WARNING, "[Game::%s] could not create checkpoint for frame %d", __func__, gs->frameNum);
+		return;
+	}
+
+	if (lateJoinCheckpoint)
+		gameServer->AddCheckpoint(gs->frameNum, data);
+	if (demoCheckpoint)
+		demoRecorder->AddCheckpoint(gs->frameNum, data);
+}
+
+void CGame::LoadCheckpoint(int frameNum)
+{
+	LOG("[Game::%s] loading checkpoint for frame %d (%u bytes)", __func__, frameNum, unsigned(checkpointData.size()));
+
+	// the saved unsynced state belongs to the host
+	const int myPlayerNum = gu->myPlayerNum;
+
+	CCregLoadSaveHandler ls;
+
+	if (ls.LoadGameFromBuffer(checkpointData)) {
+		gu->SetMyPlayer(myPlayerNum);
+	} else {
+		LOG_L(L_ERROR, "[Game::%s] invalid checkpoint received from server", __func__);
+	}
+
+	checkpointData.clear();
+	checkpointData.shrink_to_fit();
+}
+
+
 void CGame::ReloadGame()
 {
 	if (saveFile) {
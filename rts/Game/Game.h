@@ -59,13 +59,18 @@ private:
 	void AddTimedJobs();
 
 	void LoadMap(const std::string& mapName);
-	void LoadDefs();
-	void PreLoadSimulation();
+	void LoadGameData();
+	void LoadSoundDefs();
+	void LoadQuadField();
+	void LoadSmoothGround();
+	void LoadMoveDefs();
 	void PostLoadSimulation();
+	void PreloadModels();
 	void PreLoadRendering();
 	void PostLoadRendering();
 	void LoadInterface();
 	void LoadLua();
+	void LoadModels();
 	void LoadSkirmishAIs();
 	void LoadFinalize();
 	void PostLoad();
@@ -98,10 +103,18 @@ public:
 	void StartSkip(int toFrame);
 	void EndSkip();
 
+	/// entered and left by the client when falling behind the server by many frames
+	void StartFastForward();
+	void EndFastForward();
+
 	void ParseInputTextGeometry(const std::string& geo);
 
 	void ReloadGame();
 	void SaveGame(const std::string& filename, bool overwrite, bool usecreg);
+	/// hands the game-state to the local server for late-joining clients (host only) and to the demo recorder
+	void SaveCheckpoint();
+	/// loads the NETMSG_CHECKPOINT chunks received so far (late-joiners only)
+	void LoadCheckpoint(int frameNum);
 
 	void ResizeEvent() override;
 
@@ -211,6 +224,8 @@ public:
 	float skipOldSpeed;
 	float skipOldUserSpeed;
 
+	bool fastForwardSoundMute;
+
 	/**
 	 * @see CGameServer#speedControl
 	 */
@@ -228,6 +243,11 @@ private:
 	/// for reloading the savefile
 	ILoadSaveHandler* saveFile;
 
+	/// late-join checkpoint being received
+	std::vector<std::uint8_t> checkpointData;
+	int lastCheckpointFrame;
+	int lastDemoCheckpointFrame;
+
 	volatile bool finishedLoading;
 	bool gameOver;
 };
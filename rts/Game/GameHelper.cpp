@@ -39,6 +39,11 @@
 #include "System/myMath.h"
 #include "System/Sound/ISoundChannels.h"
 #include "System/Sync/SyncTracer.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <array>
+#include <limits>
+#include <xmmintrin.h>
 
 
 static CGameHelper gGameHelper;
@@ -227,6 +232,176 @@ void CGameHelper::DamageObjectsInExplosionRadius(
 	featureCache.resize(oldNumFeatures);
 }
 
+
+
+void CGameHelper::QueueExplosionDamage(const CExplosionParams& params, const float expRad, const int weaponDefID)
+{
+	// groups are kept small enough that their gathers do not turn into
+	// full-map scans when explosions are spread out; larger explosions
+	// simply get a group of their own
+	constexpr float MAX_GROUP_EXTENT = 256.0f;
+	constexpr unsigned int MAX_OPEN_GROUPS = 16;
+
+	batchedExplosions.emplace_back();
+
+	BatchedExplosion& be = batchedExplosions.back();
+
+	be.pos = params.pos;
+	be.damages = params.damages;
+	be.owner = params.owner;
+	be.hitUnit = params.hitUnit;
+	be.hitFeature = params.hitFeature;
+	be.radius = expRad;
+	be.edgeEffectiveness = params.edgeEffectiveness;
+	be.explosionSpeed = params.explosionSpeed;
+	be.impactOnly = params.impactOnly;
+	be.ignoreOwner = params.ignoreOwner;
+	be.weaponDefID = weaponDefID;
+	be.projectileID = params.projectileID;
+	be.groupIndex = -1;
+
+	if (be.impactOnly)
+		return;
+
+	const float3 expMins = be.pos - float3(expRad, expRad, expRad);
+	const float3 expMaxs = be.pos + float3(expRad, expRad, expRad);
+
+	// try to fit into one of the most recently opened groups
+	for (size_t n = explosionGroups.size(), i = n - std::min(n, size_t(MAX_OPEN_GROUPS)); i < n; i++) {
+		ExplosionGroup& eg = explosionGroups[i];
+
+		const float3 mins = float3::min(eg.mins, expMins);
+		const float3 maxs = float3::max(eg.maxs, expMaxs);
+
+		if ((maxs.x - mins.x) > MAX_GROUP_EXTENT || (maxs.z - mins.z) > MAX_GROUP_EXTENT)
+			continue;
+
+		eg.mins = mins;
+		eg.maxs = maxs;
+
+		be.groupIndex = i;
+		return;
+	}
+
+	explosionGroups.emplace_back();
+	explosionGroups.back().mins = expMins;
+	explosionGroups.back().maxs = expMaxs;
+
+	be.groupIndex = explosionGroups.size() - 1;
+}
+
+void CGameHelper::FlushExplosionBatch()
+{
+	batchExplosions = false;
+
+	if (batchedExplosions.empty())
+		return;
+
+	SCOPED_TIMER("Sim::Projectiles::ExplosionBatch");
+
+	// gather once per group; objects are never removed from the QuadField
+	// while damage is being applied (dead units and features linger until a
+	// later update), so the caches stay valid throughout
+	for (ExplosionGroup& eg: explosionGroups) {
+		const float3 center = (eg.mins + eg.maxs) * 0.5f;
+		// pad the radius s.t. rounding can not exclude objects which the
+		// sphere-test of any individual explosion in the group would pass
+		const float radius = (eg.maxs - center).Length() * 1.001f + 1.0f;
+
+		eg.units.clear();
+		eg.features.clear();
+
+		quadField->GetUnitsAndFeaturesColVol(center, radius, eg.units, eg.features);
+
+		for (int k = 0; k < 4; k++) {
+			eg.unitVolData[k].clear();
+			eg.featureVolData[k].clear();
+		}
+
+		for (const CUnit* u: eg.units) {
+			const float3 volPos = u->collisionVolume.GetWorldSpacePos(u);
+
+			eg.unitVolData[0].push_back(volPos.x);
+			eg.unitVolData[1].push_back(volPos.y);
+			eg.unitVolData[2].push_back(volPos.z);
+			eg.unitVolData[3].push_back(u->collisionVolume.GetBoundingRadius());
+		}
+		for (const CFeature* f: eg.features) {
+			const float3 volPos = f->collisionVolume.GetWorldSpacePos(f);
+
+			eg.featureVolData[0].push_back(volPos.x);
+			eg.featureVolData[1].push_back(volPos.y);
+			eg.featureVolData[2].push_back(volPos.z);
+			eg.featureVolData[3].push_back(f->collisionVolume.GetBoundingRadius());
+		}
+
+		// pad to a multiple of four with entries that can never pass
+		for (int k = 0; k < 4; k++) {
+			eg.unitVolData[k].resize((eg.units.size() + 3) & ~3u, 1e30f);
+			eg.featureVolData[k].resize((eg.features.size() + 3) & ~3u, 1e30f);
+		}
+	}
+
+	// apply in the order the explosions happened; nested explosions (e.g. from
+	// units killed here) are not batched and take effect immediately as usual
+	for (const BatchedExplosion& be: batchedExplosions) {
+		if (!be.impactOnly) {
+			DamageObjectsInExplosionGroup(be, explosionGroups[be.groupIndex]);
+			continue;
+		}
+
+		if (be.hitUnit != nullptr)
+			DoExplosionDamage(be.hitUnit, be.owner, be.pos, 0.0f, be.explosionSpeed, be.edgeEffectiveness, be.ignoreOwner, be.damages, be.weaponDefID, be.projectileID);
+
+		if (be.hitFeature != nullptr)
+			DoExplosionDamage(be.hitFeature, be.owner, be.pos, 0.0f, be.edgeEffectiveness, be.damages, be.weaponDefID, be.projectileID);
+	}
+
+	batchedExplosions.clear();
+	explosionGroups.clear();
+}
+
+// bit i of the returned mask is set iff pos lies strictly within expRad+rad[i]
+// of center i; same arithmetic as the CQuadField::GetUnitsAndFeaturesColVol test
+static int ExplosionSpheresMask(const float* const data[4], unsigned int i, const float3& pos, const float expRad)
+{
+	const __m128 dx = _mm_sub_ps(_mm_set1_ps(pos.x), _mm_loadu_ps(data[0] + i));
+	const __m128 dy = _mm_sub_ps(_mm_set1_ps(pos.y), _mm_loadu_ps(data[1] + i));
+	const __m128 dz = _mm_sub_ps(_mm_set1_ps(pos.z), _mm_loadu_ps(data[2] + i));
+	const __m128 dd = _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+	const __m128 rr = _mm_add_ps(_mm_set1_ps(expRad), _mm_loadu_ps(data[3] + i));
+
+	return (_mm_movemask_ps(_mm_cmplt_ps(dd, _mm_mul_ps(rr, rr))));
+}
+
+void CGameHelper::DamageObjectsInExplosionGroup(const BatchedExplosion& be, const ExplosionGroup& eg)
+{
+	const float* unitData[4] = {eg.unitVolData[0].data(), eg.unitVolData[1].data(), eg.unitVolData[2].data(), eg.unitVolData[3].data()};
+	const float* featureData[4] = {eg.featureVolData[0].data(), eg.featureVolData[1].data(), eg.featureVolData[2].data(), eg.featureVolData[3].data()};
+
+	for (unsigned int i = 0, n = eg.units.size(); i < n; i += 4) {
+		const int mask = ExplosionSpheresMask(unitData, i, be.pos, be.radius);
+
+		for (unsigned int j = 0; j < 4; j++) {
+			if ((mask & (1 << j)) == 0)
+				continue;
+
+			DoExplosionDamage(eg.units[i + j], be.owner, be.pos, be.radius, be.explosionSpeed, be.edgeEffectiveness, be.ignoreOwner, be.damages, be.weaponDefID, be.projectileID);
+		}
+	}
+
+	for (unsigned int i = 0, n = eg.features.size(); i < n; i += 4) {
+		const int mask = ExplosionSpheresMask(featureData, i, be.pos, be.radius);
+
+		for (unsigned int j = 0; j < 4; j++) {
+			if ((mask & (1 << j)) == 0)
+				continue;
+
+			DoExplosionDamage(eg.features[i + j], be.owner, be.pos, be.radius, be.edgeEffectiveness, be.damages, be.weaponDefID, be.projectileID);
+		}
+	}
+}
+
 void CGameHelper::Explosion(const CExplosionParams& params) {
 	const DamageArray& damages = params.damages;
 
@@ -250,7 +425,9 @@ void CGameHelper::Explosion(const CExplosionParams& params) {
 	if (luaUI != nullptr && weaponDef != nullptr)
 		luaUI->ShockFront(params.pos, weaponDef->cameraShake, damageAOE);
 
-	if (params.impactOnly) {
+	if (batchExplosions) {
+		QueueExplosionDamage(params, params.impactOnly? 0.0f: damageAOE, weaponDefID);
+	} else if (params.impactOnly) {
 		if (params.hitUnit != nullptr) {
 			DoExplosionDamage(
 				params.hitUnit,
@@ -280,7 +457,9 @@ void CGameHelper::Explosion(const CExplosionParams& params) {
 		}
 	} else {
 		DamageObjectsInExplosionRadius(params, damageAOE, weaponDefID);
+	}
 
+	if (!params.impactOnly) {
 		// deform the map if the explosion was above-ground
 		// (but had large enough radius to touch the ground)
 		if (altitude >= -1.0f) {
@@ -348,25 +527,51 @@ void CGameHelper::Explosion(const CExplosionParams& params) {
  * should be implemented in the Query object if desired.
  * (It isn't necessary for e.g. GetClosest** methods.)
  */
+// per-thread replacement for CUnit::tempNum, which can not be written to by
+// the concurrent queries made from CUnitHandler's batches
+static std::array<std::vector<int>, ThreadPool::MAX_THREADS> targetVisitFlags;
+static std::array<int, ThreadPool::MAX_THREADS> targetVisitNums = {{0}};
+
+static std::vector<int>& GetVisitFlags(int& visitNum)
+{
+	const int threadNum = ThreadPool::GetThreadNum();
+
+	std::vector<int>& visitFlags = targetVisitFlags[threadNum];
+	int& nextVisitNum = targetVisitNums[threadNum];
+
+	if (visitFlags.size() < unitHandler->MaxUnits())
+		visitFlags.resize(unitHandler->MaxUnits(), 0);
+
+	if ((nextVisitNum += 1) == std::numeric_limits<int>::max()) {
+		std::fill(visitFlags.begin(), visitFlags.end(), 0);
+		nextVisitNum = 1;
+	}
+
+	visitNum = nextVisitNum;
+	return visitFlags;
+}
+
 template<typename TFilter, typename TQuery>
 static inline void QueryUnits(TFilter filter, TQuery& query)
 {
 	QuadFieldQuery qfQuery;
 	quadField->GetQuads(qfQuery, query.pos, query.radius);
-	const int tempNum = gs->GetTempNum();
+
+	int visitNum = 0;
+	std::vector<int>& visitFlags = GetVisitFlags(visitNum);
 
 	for (int t = 0; t < teamHandler->ActiveAllyTeams(); ++t) { //FIXME
 		if (!filter.Team(t))
 			continue;
 
 		for (const int qi: *qfQuery.quads) {
-			const auto& allyTeamUnits = quadField->GetQuad(qi).teamUnits[t];
+			const auto& allyTeamUnits = quadField->GetQuad(qi).GetAllyTeamUnits(t);
 
 			for (CUnit* u: allyTeamUnits) {
-				if (u->tempNum == tempNum)
+				if (visitFlags[u->id] == visitNum)
 					continue;
 
-				u->tempNum = tempNum;
+				visitFlags[u->id] = visitNum;
 
 				if (!filter.Unit(u))
 					continue;
@@ -631,12 +836,17 @@ namespace {
 
 
 void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
+{
+	GatherWeaponTargets(weapon, avoidUnit, targets);
+	FilterWeaponTargets(weapon, targets);
+}
+
+void CGameHelper::GatherWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
 {
 	const CUnit* owner    = weapon->owner;
 	const float radius    = weapon->range;
 	const float3& pos     = owner->pos;
 	const float aHeight   = weapon->aimFromPos.y;
-	const CUnit* lastAttacker = ((owner->lastAttackFrame + 200) <= gs->frameNum) ? owner->lastAttacker : nullptr;
 
 	const WeaponDef* weaponDef = weapon->weaponDef;
 	const float heightMod = weaponDef->heightmod;
@@ -645,23 +855,24 @@ void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoi
 	const float secDamage = weapon->damages->GetDefault() * weapon->salvoSize / weapon->reloadTime * GAME_SPEED;
 	const bool paralyzer  = (weapon->damages->paralyzeDamageTime != 0);
 
-	// copy on purpose since the below calls lua
+	int visitNum = 0;
+	std::vector<int>& visitFlags = GetVisitFlags(visitNum);
+
 	QuadFieldQuery qfQuery;
 	quadField->GetQuads(qfQuery, pos, radius + (aHeight - std::max(0.0f, readMap->GetInitMinHeight())) * heightMod);
-	const int tempNum = gs->GetTempNum();
 
 	for (int t = 0; t < teamHandler->ActiveAllyTeams(); ++t) {
 		if (teamHandler->Ally(owner->allyteam, t))
 			continue;
 
 		for (const int qi: *qfQuery.quads) {
-			const std::vector<CUnit*>& allyTeamUnits = quadField->GetQuad(qi).teamUnits[t];
+			const auto& allyTeamUnits = quadField->GetQuad(qi).GetAllyTeamUnits(t);
 
 			for (CUnit* targetUnit: allyTeamUnits) {
-				if (targetUnit->tempNum == tempNum)
+				if (visitFlags[targetUnit->id] == visitNum)
 					continue;
 
-				targetUnit->tempNum = tempNum;
+				visitFlags[targetUnit->id] = visitNum;
 
 				float targetPriority = 1.0f;
 
@@ -690,7 +901,6 @@ void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoi
 
 				const float dist2D = (pos - targPos).Length2D();
 				const float rangeMul = (dist2D * weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
-				const float damageMul = weapon->damages->Get(targetUnit->armorType) * targetUnit->curArmorMultiple;
 
 				targetPriority *= rangeMul;
 
@@ -699,43 +909,66 @@ void CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoi
 
 					if (paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health))
 						targetPriority *= 4.0f;
-
-					if (weapon->hasTargetWeight)
-						targetPriority *= weapon->TargetWeight(targetUnit);
-
 				} else {
 					targetPriority *= (secDamage + 10000.0f);
 				}
 
-				if (targetLOSState & LOS_PREVLOS) {
-					targetPriority /= (damageMul * targetUnit->power * (0.7f + gsRNG.NextFloat() * 0.6f));
+				targets.push_back(std::pair<float, CUnit*>(targetPriority, targetUnit));
+			}
+		}
+	}
+}
 
-					if (targetUnit->category & weapon->badTargetCategory)
-						targetPriority *= 100.0f;
+void CGameHelper::FilterWeaponTargets(const CWeapon* weapon, std::vector<std::pair<float, CUnit*>>& targets)
+{
+	const CUnit* owner = weapon->owner;
+	const CUnit* lastAttacker = ((owner->lastAttackFrame + 200) <= gs->frameNum) ? owner->lastAttacker : nullptr;
 
-					if (targetUnit->IsCrashing())
-						targetPriority *= 1000.0f;
+	const WeaponDef* weaponDef = weapon->weaponDef;
 
-					if (targetUnit == lastAttacker)
-						targetPriority *= 0.5f;
-				}
+	size_t numTargets = 0;
 
-				const bool allow = eventHandler.AllowWeaponTarget(owner->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority);
-				//Lua call may have changed tempNum, so needs to be set again.
-				targetUnit->tempNum = tempNum;
+	// script weights, the synced RNG and Lua are consulted here (strictly in
+	// gather-order) rather than in GatherWeaponTargets, since none of them is
+	// safe to call concurrently
+	for (size_t i = 0, n = targets.size(); i < n; i++) {
+		CUnit* targetUnit = targets[i].second;
 
-				if (!allow)
-					continue;
+		float targetPriority = targets[i].first;
 
-				targets.push_back(std::pair<float, CUnit*>(targetPriority, targetUnit));
-			}
+		const unsigned short targetLOSState = targetUnit->losStatus[owner->allyteam];
+
+		if ((targetLOSState & LOS_INLOS) && weapon->hasTargetWeight)
+			targetPriority *= weapon->TargetWeight(targetUnit);
+
+		if (targetLOSState & LOS_PREVLOS) {
+			const float damageMul = weapon->damages->Get(targetUnit->armorType) * targetUnit->curArmorMultiple;
+
+			targetPriority /= (damageMul * targetUnit->power * (0.7f + gsRNG.NextFloat() * 0.6f));
+
+			if (targetUnit->category & weapon->badTargetCategory)
+				targetPriority *= 100.0f;
+
+			if (targetUnit->IsCrashing())
+				targetPriority *= 1000.0f;
+
+			if (targetUnit == lastAttacker)
+				targetPriority *= 0.5f;
 		}
+
+		if (!eventHandler.AllowWeaponTarget(owner->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority))
+			continue;
+
+		targets[numTargets++] = std::pair<float, CUnit*>(targetPriority, targetUnit);
 	}
+
+	targets.resize(numTargets);
+
 	std::stable_sort(targets.begin(), targets.end(), [](const std::pair<float, CUnit*>& a, const std::pair<float, CUnit*>& b) { return (a.first < b.first); });
 
 #ifdef TRACE_SYNC
 	{
-		tracefile << "[GenerateWeaponTargets] ownerID, attackRadius: " << owner->id << ", " << radius << " ";
+		tracefile << "[GenerateWeaponTargets] ownerID, attackRadius: " << owner->id << ", " << weapon->range << " ";
 
 		for (const auto& ti: targets) {
 			tracefile << "\tpriority: " << (ti.first) <<  ", targetID: " << (ti.second)->id <<  " ";
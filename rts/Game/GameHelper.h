@@ -122,6 +122,10 @@ public:
 	static float3 ClosestBuildSite(int team, const UnitDef* unitDef, float3 pos, float searchRadius, int minDist, int facing = 0);
 
 	static void GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets);
+	/// thread-safe part of GenerateWeaponTargets; only reads sim-state, <targets> holds partial priorities
+	static void GatherWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets);
+	/// completes the priorities of gathered <targets> (script, RNG, Lua) and sorts them; must run serially
+	static void FilterWeaponTargets(const CWeapon* weapon, std::vector<std::pair<float, CUnit*>>& targets);
 
 	void Init();
 	void Update();
@@ -154,6 +158,10 @@ public:
 	void DamageObjectsInExplosionRadius(const CExplosionParams& params, const float expRad, const int weaponDefID);
 	void Explosion(const CExplosionParams& params);
 
+	/// while a batch is open, explosion damage is queued and applied (in order) by FlushExplosionBatch
+	void BeginExplosionBatch(bool enable) { batchExplosions = enable; }
+	void FlushExplosionBatch();
+
 private:
 	struct WaitingDamage {
 		WaitingDamage(const DamageArray& _damage, const float3& _impulse, int _attackerID, int _targetID, int _weaponID, int _projectileID)
@@ -174,8 +182,50 @@ private:
 		float3 impulse;
 	};
 
+	struct BatchedExplosion {
+		float3 pos;
+		DamageArray damages;
+
+		CUnit* owner;
+		CUnit* hitUnit;
+		CFeature* hitFeature;
+
+		float radius;
+		float edgeEffectiveness;
+		float explosionSpeed;
+
+		bool impactOnly;
+		bool ignoreOwner;
+
+		int weaponDefID;
+		int projectileID;
+		int groupIndex;
+	};
+
+	// explosions whose spheres fit into one box share a single QuadField gather
+	// positions and bounding-radii of the gathered objects are kept as SoA for
+	// the vectorized per-explosion sphere tests
+	struct ExplosionGroup {
+		float3 mins;
+		float3 maxs;
+
+		std::vector<CUnit*> units;
+		std::vector<CFeature*> features;
+
+		std::vector<float> unitVolData[4];
+		std::vector<float> featureVolData[4];
+	};
+
+	void QueueExplosionDamage(const CExplosionParams& params, const float expRad, const int weaponDefID);
+	void DamageObjectsInExplosionGroup(const BatchedExplosion& be, const ExplosionGroup& eg);
+
 	// note: size must be a power of two
 	std::array<std::vector<WaitingDamage>, 128> waitingDamages;
+
+	std::vector<BatchedExplosion> batchedExplosions;
+	std::vector<ExplosionGroup> explosionGroups;
+
+	bool batchExplosions = false;
 };
 
 extern CGameHelper* helper;
@@ -49,6 +49,7 @@ CR_REG_METADATA(CGlobalUnsynced, (
 	CR_MEMBER(spectatingFullView),
 	CR_MEMBER(spectatingFullSelect),
 	CR_IGNORED(fpsMode),
+	CR_IGNORED(fastForwarding),
 	CR_IGNORED(globalQuit),
 	CR_IGNORED(globalReload),
 	CR_IGNORED(reloadScript)
@@ -92,6 +93,7 @@ void CGlobalUnsynced::ResetState()
 	spectatingFullSelect = false;
 
 	fpsMode = false;
+	fastForwarding = false;
 	globalQuit = false;
 	globalReload = false;
 	reloadScript = "";
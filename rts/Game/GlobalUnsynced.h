@@ -163,6 +163,15 @@ public:
 	 */
 	bool fpsMode;
 
+	/**
+	 * @brief fastForwarding
+	 *
+	 * Whether this client is catching up to the server
+	 * (e.g. rejoining); unsynced work that has no lasting
+	 * effect, like sounds and particle effects, is skipped
+	 */
+	bool fastForwarding;
+
 	/**
 	* @brief global quit
 	*
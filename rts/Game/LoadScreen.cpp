@@ -21,12 +21,16 @@
 #include "Sim/Path/IPathManager.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/Exceptions.h"
+#include "System/LoadTrace.h"
 #include "System/Sync/FPUCheck.h"
 #include "System/Log/ILog.h"
 #include "Net/Protocol/NetProtocol.h"
 #include "System/Matrix44f.h"
 #include "System/SafeUtil.h"
+#include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/VFSHandler.h"
 #include "System/Platform/Watchdog.h"
 #include "System/Platform/Threading.h"
 #include "System/Sound/ISound.h"
@@ -40,6 +44,7 @@
 #include <vector>
 
 CONFIG(int, LoadingMT).defaultValue(0).safemodeValue(0);
+CONFIG(bool, WriteLoadTrace).defaultValue(false).description("Write the time (wall and CPU), VFS bytes and memory used by every loading step to loadtrace.json in the data-dir, in the Chrome trace-event format.");
 
 
 CLoadScreen* CLoadScreen::singleton = nullptr;
@@ -59,6 +64,9 @@ CLoadScreen::~CLoadScreen()
 	// thread can not access singleton while its dtor is running
 	assert(!gameLoadThread.joinable());
 
+	if (loadTrace.IsActive())
+		loadTrace.Stop(dataDirsAccess.LocateFile("loadtrace.json", FileQueryFlags::WRITE), CVFSHandler::GetNumBytesLoaded());
+
 	if (clientNet != nullptr)
 		clientNet->KeepUpdating(false);
 	if (netHeartbeatThread.joinable())
@@ -80,6 +88,9 @@ bool CLoadScreen::Init()
 {
 	activeController = this;
 
+	if (configHandler->GetBool("WriteLoadTrace"))
+		loadTrace.Start();
+
 	// hide the cursor until we are ingame
 	SDL_ShowCursor(SDL_DISABLE);
 
@@ -314,6 +325,10 @@ void CLoadScreen::SetLoadMessage(const std::string& text, bool replace_lastline)
 	}
 	curLoadMessage = text;
 
+	// updates of the last line (progress) belong to the same phase
+	if (!replace_lastline)
+		loadTrace.SetPhase(text, CVFSHandler::GetNumBytesLoaded());
+
 	LOG("%s", text.c_str());
 	LOG_CLEANUP();
 
@@ -0,0 +1,156 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cassert>
+#include <chrono>
+
+#include "LoadTaskGraph.h"
+#include "LoadScreen.h"
+#include "System/Exceptions.h"
+#include "System/TimeProfiler.h"
+#include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
+
+
+CLoadTaskGraph::TaskID CLoadTaskGraph::AddTask(
+	const char* name,
+	const std::string& message,
+	TaskThread thread,
+	const std::function<void()>& func,
+	const std::vector<TaskID>& deps
+) {
+	Task task;
+	task.name = name;
+	task.message = message;
+	task.thread = thread;
+	task.state = TASK_PENDING;
+	task.func = func;
+	task.deps = deps;
+	task.failed = false;
+
+	// only earlier tasks can be depended on, which also rules out cycles
+	for (const TaskID dep: deps) {
+		assert(dep < tasks.size());
+	}
+
+	tasks.push_back(task);
+	return (tasks.size() - 1);
+}
+
+
+bool CLoadTaskGraph::IsReady(const Task& task) const
+{
+	for (const TaskID dep: task.deps) {
+		if (tasks[dep].state != TASK_FINISHED)
+			return false;
+	}
+
+	return true;
+}
+
+void CLoadTaskGraph::Execute(Task* task)
+{
+	try {
+		ScopedOnceTimer timer(std::string("LoadTaskGraph::") + task->name);
+		task->func();
+	} catch (const content_error& e) {
+		LOG_L(L_WARNING, "[LoadTaskGraph::%s] forced quit with exception \"%s\" in task \"%s\"", __func__, e.what(), task->name);
+		task->failed = true;
+	} catch (...) {
+		task->exception = std::current_exception();
+	}
+}
+
+bool CLoadTaskGraph::Finish(Task& task)
+{
+	task.state = TASK_FINISHED;
+	task.future.reset();
+	task.func = nullptr;
+
+	return (!task.failed);
+}
+
+
+bool CLoadTaskGraph::Run(bool useWorkers)
+{
+	std::exception_ptr exception;
+
+	size_t numFinished = 0;
+	size_t numRunning = 0;
+
+	bool ret = true;
+
+	while (numFinished < tasks.size()) {
+		Task* nextTask = nullptr;
+
+		// hand everything that became ready to the workers first, so
+		// it overlaps with the load-thread task that is picked below
+		for (Task& task: tasks) {
+			if (task.state != TASK_PENDING || !IsReady(task))
+				continue;
+
+			// after an unexpected exception, only wait for what is running
+			if (exception != nullptr)
+				break;
+
+			if (task.thread == LOAD_THREAD || !useWorkers) {
+				if (nextTask == nullptr)
+					nextTask = &task;
+
+				continue;
+			}
+
+			if (!task.message.empty())
+				loadscreen->SetLoadMessage(task.message);
+
+			task.state = TASK_RUNNING;
+			task.future = ThreadPool::Enqueue(&CLoadTaskGraph::Execute, &task);
+
+			numRunning += 1;
+		}
+
+		if (nextTask != nullptr && exception == nullptr) {
+			if (!nextTask->message.empty())
+				loadscreen->SetLoadMessage(nextTask->message);
+
+			nextTask->state = TASK_RUNNING;
+
+			Execute(nextTask);
+
+			if (nextTask->exception != nullptr)
+				exception = nextTask->exception;
+
+			ret &= Finish(*nextTask);
+			numFinished += 1;
+			continue;
+		}
+
+		if (numRunning == 0) {
+			// everything left depends on a task that never ran
+			assert(exception != nullptr);
+			break;
+		}
+
+		// nothing for this thread to do until a worker finishes
+		for (Task& task: tasks) {
+			if (task.state != TASK_RUNNING)
+				continue;
+
+			if (task.future->wait_for(std::chrono::milliseconds(1)) != std::future_status::ready)
+				continue;
+
+			task.future->get();
+
+			if (task.exception != nullptr && exception == nullptr)
+				exception = task.exception;
+
+			ret &= Finish(task);
+			numFinished += 1;
+			numRunning -= 1;
+		}
+	}
+
+	if (exception != nullptr)
+		std::rethrow_exception(exception);
+
+	return ret;
+}
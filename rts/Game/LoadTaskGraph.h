@@ -0,0 +1,86 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _LOAD_TASK_GRAPH_H
+#define _LOAD_TASK_GRAPH_H
+
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief runs the steps of CGame::LoadGame in dependency order
+ *
+ * Every task names the tasks it depends on; a task starts as soon as all of
+ * them have finished. LOAD_THREAD tasks are run one at a time by the thread
+ * calling Run, the only one that owns a GL context while loading (and that
+ * may touch the event handler, Lua, or call for_mt). WORKER tasks run on the
+ * ThreadPool concurrently with everything else and must only touch what none
+ * of the tasks running at the same time can.
+ *
+ * A content_error thrown by a task is logged and the task counts as finished;
+ * loading continues like it did before steps were run as a graph, since the
+ * game can not be torn down half-constructed. Any other exception is thrown
+ * out of Run once all started tasks have returned.
+ */
+class CLoadTaskGraph
+{
+public:
+	typedef unsigned TaskID;
+
+	enum TaskThread {
+		LOAD_THREAD = 0,
+		WORKER      = 1,
+	};
+
+	TaskID AddTask(
+		const char* name,
+		const std::string& message,
+		TaskThread thread,
+		const std::function<void()>& func,
+		const std::vector<TaskID>& deps = {}
+	);
+
+	/**
+	 * Returns false if any task failed with a content_error.
+	 * If useWorkers is false, WORKER tasks are run by the calling thread too.
+	 */
+	bool Run(bool useWorkers);
+
+private:
+	enum TaskState {
+		TASK_PENDING  = 0,
+		TASK_RUNNING  = 1,
+		TASK_FINISHED = 2,
+	};
+
+	struct Task {
+		const char* name;
+		std::string message;
+
+		TaskThread thread;
+		TaskState state;
+
+		std::function<void()> func;
+		std::vector<TaskID> deps;
+
+		std::shared_ptr< std::future<void> > future;
+
+		/// set by whichever thread ran the task, read after it finished
+		std::exception_ptr exception;
+		bool failed;
+	};
+
+	bool IsReady(const Task& task) const;
+	/// called when the task has finished, false if it failed
+	bool Finish(Task& task);
+
+	static void Execute(Task* task);
+
+private:
+	std::vector<Task> tasks;
+};
+
+#endif // _LOAD_TASK_GRAPH_H
@@ -111,6 +111,7 @@ void CPlayerHandler::AddPlayer(const CPlayer& player)
 			stub->playerNum = (int)i;
 			players.push_back(stub);
 			selectedUnitsHandler.netSelected.push_back(std::vector<int>());
+			selectedUnitsHandler.netSelectGens.push_back(0);
 		}
 
 		CPlayer* newPlayer = players[player.playerNum];
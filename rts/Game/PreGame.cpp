@@ -9,6 +9,7 @@
 
 #include "ClientData.h"
 #include "ClientSetup.h"
+#include "DemoBatch.h"
 #include "System/Sync/FPUCheck.h"
 #include "Game.h"
 #include "GameData.h"
@@ -437,6 +438,7 @@ void CPreGame::StartServerForDemo(const std::string& demoName)
 	good_fpu_control_registers("before CGameServer creation");
 
 	gameServer = new CGameServer(clientSetup, gameData, demoGameSetup);
+	gameServer->SetUnlimitedDemoSpeed(CDemoBatch::unlimited);
 	gameServer->AddLocalClient(clientSetup->myPlayerName, SpringVersion::GetFull());
 
 	good_fpu_control_registers("after CGameServer creation");
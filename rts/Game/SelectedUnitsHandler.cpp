@@ -39,6 +39,11 @@
 #include "System/Sound/ISound.h"
 #include "System/Sound/ISoundChannels.h"
 
+#include <algorithm>
+#include <iterator>
+
+#include <xmmintrin.h>
+
 #include <SDL_mouse.h>
 #include <SDL_keycode.h>
 
@@ -54,6 +59,7 @@ CSelectedUnitsHandler selectedUnitsHandler;
 CSelectedUnitsHandler::CSelectedUnitsHandler()
 	: selectionChanged(false)
 	, possibleCommandsChanged(true)
+	, sentNetSelectGen(-1)
 	, selectedGroup(-1)
 	, soundMultiselID(0)
 	, autoAddBuiltUnitsToFactoryGroup(false)
@@ -71,6 +77,10 @@ void CSelectedUnitsHandler::Init(unsigned numPlayers)
 	autoAddBuiltUnitsToFactoryGroup = configHandler->GetBool("AutoAddBuiltUnitsToFactoryGroup");
 	autoAddBuiltUnitsToSelectedGroup = configHandler->GetBool("AutoAddBuiltUnitsToSelectedGroup");
 	netSelected.resize(numPlayers);
+	netSelectGens.assign(numPlayers, 0);
+
+	sentNetSelection.clear();
+	sentNetSelectGen = -1;
 }
 
 
@@ -281,8 +291,38 @@ void CSelectedUnitsHandler::GiveCommand(Command c, bool fromUser)
 }
 
 
+// SoA scratch-space for HandleUnitBoxSelection, padded to a multiple of 4
+static std::vector<float> boxSelectPos[3];
+
+// bit i of the returned mask is set iff point i lies on the negative side
+// of all four planes; same arithmetic as float4::dot4 (with w=1)
+static int BoxSelectionMask(unsigned int i, const float4* planes)
+{
+	const __m128 px = _mm_loadu_ps(boxSelectPos[0].data() + i);
+	const __m128 py = _mm_loadu_ps(boxSelectPos[1].data() + i);
+	const __m128 pz = _mm_loadu_ps(boxSelectPos[2].data() + i);
+
+	__m128 inside = _mm_cmpeq_ps(px, px);
+
+	for (int n = 0; n < 4; n++) {
+		const float4& p = planes[n];
+
+		__m128 d = _mm_mul_ps(px, _mm_set1_ps(p.x));
+		d = _mm_add_ps(d, _mm_mul_ps(py, _mm_set1_ps(p.y)));
+		d = _mm_add_ps(d, _mm_mul_ps(pz, _mm_set1_ps(p.z)));
+		d = _mm_add_ps(d, _mm_set1_ps(p.w));
+
+		inside = _mm_and_ps(inside, _mm_cmplt_ps(d, _mm_setzero_ps()));
+	}
+
+	return (_mm_movemask_ps(inside));
+}
+
 void CSelectedUnitsHandler::HandleUnitBoxSelection(const float4& planeRight, const float4& planeLeft, const float4& planeTop, const float4& planeBottom)
 {
+	const float4 planes[4] = {planeRight, planeLeft, planeTop, planeBottom};
+	const bool ctrlKey = KeyInput::GetKeyModState(KMOD_CTRL);
+
 	CUnit* unit = nullptr;
 
 	int addedunits = 0;
@@ -300,23 +340,40 @@ void CSelectedUnitsHandler::HandleUnitBoxSelection(const float4& planeRight, con
 	}
 
 	for (; team <= lastTeam; team++) {
-		for (CUnit* u: teamHandler->Team(team)->units) {
-			const float4 vec(u->midPos, 1.0f);
+		const std::vector<CUnit*>& teamUnits = teamHandler->Team(team)->units;
 
-			if (vec.dot4(planeRight) >= 0.0f)
-				continue;
-			if (vec.dot4(planeLeft) >= 0.0f)
-				continue;
-			if (vec.dot4(planeTop) >= 0.0f)
-				continue;
-			if (vec.dot4(planeBottom) >= 0.0f)
+		const unsigned int numUnits = teamUnits.size();
+		const unsigned int numPadded = (numUnits + 3) & ~3u;
+
+		for (std::vector<float>& v: boxSelectPos) {
+			v.resize(numPadded);
+		}
+
+		for (unsigned int i = 0; i < numUnits; i++) {
+			boxSelectPos[0][i] = teamUnits[i]->midPos.x;
+			boxSelectPos[1][i] = teamUnits[i]->midPos.y;
+			boxSelectPos[2][i] = teamUnits[i]->midPos.z;
+		}
+
+		// test four units per batch, in team order
+		for (unsigned int i = 0; i < numPadded; i += 4) {
+			const int mask = BoxSelectionMask(i, planes);
+
+			if (mask == 0)
 				continue;
 
-			if (KeyInput::GetKeyModState(KMOD_CTRL) && (selectedUnits.find(u->id) != selectedUnits.end())) {
-				RemoveUnit(u);
-			} else {
-				AddUnit(unit = u);
-				addedunits++;
+			for (unsigned int j = 0; j < 4 && (i + j) < numUnits; j++) {
+				if ((mask & (1 << j)) == 0)
+					continue;
+
+				CUnit* u = teamUnits[i + j];
+
+				if (ctrlKey && (selectedUnits.find(u->id) != selectedUnits.end())) {
+					RemoveUnit(u);
+				} else {
+					AddUnit(unit = u);
+					addedunits++;
+				}
 			}
 		}
 	}
@@ -599,9 +656,18 @@ void CSelectedUnitsHandler::Draw()
 
 			if (unit->isIcon)
 				continue;
-			if (!IsUnitSelected(unit))
+			// members of selectedUnits need no lookup
+			if (unitSet != &selectedUnits && !IsUnitSelected(unit))
 				continue;
 
+			{
+				// (xsize + zsize) / 2 bounds the half-diagonal of either footprint
+				const int maxFootprint = std::max(unit->xsize + unit->zsize, (moveDef != nullptr)? (moveDef->xsize + moveDef->zsize): 0);
+
+				if (!camera->InView(unit->drawPos, std::max(unit->radius, maxFootprint * SQUARE_SIZE * 0.5f)))
+					continue;
+			}
+
 			const float3& drawPos = unit->drawPos;
 
 			{
@@ -701,6 +767,31 @@ void CSelectedUnitsHandler::NetSelect(std::vector<int>& s, int playerId)
 }
 
 
+void CSelectedUnitsHandler::NetSelectDelta(const std::vector<int>& removed, const std::vector<int>& added, unsigned char selectGen, int playerId)
+{
+	assert(unsigned(playerId) < netSelected.size());
+
+	// the selection this delta was based on has been cleared in the meantime
+	if (selectGen != netSelectGens[playerId])
+		return;
+
+	std::vector<int>& selected = netSelected[playerId];
+
+	const auto IsRemoved = [&](int unitID) { return (std::find(removed.begin(), removed.end(), unitID) != removed.end()); };
+	const auto IsSelected = [&](int unitID) { return (std::find(selected.begin(), selected.end(), unitID) != selected.end()); };
+
+	if (!removed.empty())
+		selected.erase(std::remove_if(selected.begin(), selected.end(), IsRemoved), selected.end());
+
+	for (const int unitID: added) {
+		if (IsSelected(unitID))
+			continue;
+
+		selected.push_back(unitID);
+	}
+}
+
+
 void CSelectedUnitsHandler::NetOrder(Command& c, int playerId)
 {
 	assert(unsigned(playerId) < netSelected.size());
@@ -715,6 +806,7 @@ void CSelectedUnitsHandler::NetOrder(Command& c, int playerId)
 void CSelectedUnitsHandler::ClearNetSelect(int playerId)
 {
 	netSelected[playerId].clear();
+	netSelectGens[playerId] += 1;
 }
 
 void CSelectedUnitsHandler::AiOrder(int unitid, const Command &c, int playerId)
@@ -988,18 +1080,37 @@ void CSelectedUnitsHandler::SendCommand(const Command& c)
 {
 	if (selectionChanged) {
 		// send new selection; first gather unit IDs
-		std::vector<int16_t> selectedUnitIDs(selectedUnits.size(), 0);
-		std::vector<int16_t>::iterator idIter = selectedUnitIDs.begin();
+		std::vector<int16_t> selectedUnitIDs(selectedUnits.begin(), selectedUnits.end());
+		std::sort(selectedUnitIDs.begin(), selectedUnitIDs.end());
 
-		for (auto ui = selectedUnits.begin(); ui != selectedUnits.end(); ++idIter, ++ui) {
-			*idIter = *ui;
+		const int selectGen = netSelectGens[gu->myPlayerNum];
+
+		// send only the changes if everyone still has our last selection
+		// and that is smaller; it is reset by ClearNetSelect, in which case
+		// a delta still in flight is ignored and the next one is a full list
+		if (sentNetSelectGen == selectGen) {
+			std::vector<int16_t> removedUnitIDs;
+			std::vector<int16_t> addedUnitIDs;
+
+			std::set_difference(sentNetSelection.begin(), sentNetSelection.end(), selectedUnitIDs.begin(), selectedUnitIDs.end(), std::back_inserter(removedUnitIDs));
+			std::set_difference(selectedUnitIDs.begin(), selectedUnitIDs.end(), sentNetSelection.begin(), sentNetSelection.end(), std::back_inserter(addedUnitIDs));
+
+			// NETMSG_SELECT_DELTA carries 3 more bytes of header
+			if ((removedUnitIDs.size() + addedUnitIDs.size()) * sizeof(int16_t) + 3 < selectedUnitIDs.size() * sizeof(int16_t)) {
+				clientNet->Send(CBaseNetProtocol::Get().SendSelectDelta(gu->myPlayerNum, selectGen, removedUnitIDs, addedUnitIDs));
+			} else {
+				clientNet->Send(CBaseNetProtocol::Get().SendSelect(gu->myPlayerNum, selectedUnitIDs));
+			}
+		} else {
+			clientNet->Send(CBaseNetProtocol::Get().SendSelect(gu->myPlayerNum, selectedUnitIDs));
 		}
 
-		clientNet->Send(CBaseNetProtocol::Get().SendSelect(gu->myPlayerNum, selectedUnitIDs));
+		sentNetSelection.swap(selectedUnitIDs);
+		sentNetSelectGen = selectGen;
 		selectionChanged = false;
 	}
 
-	clientNet->Send(CBaseNetProtocol::Get().SendCommand(gu->myPlayerNum, c.GetID(), c.options, c.params));
+	clientNet->Send(CBaseNetProtocol::Get().SendCommand(gu->myPlayerNum, c.GetID(), c.options, c.params.data(), c.params.size()));
 }
 
 
@@ -3,6 +3,7 @@
 #ifndef SELECTED_UNITS_H
 #define SELECTED_UNITS_H
 
+#include <cstdint>
 #include <vector>
 #include <string>
 
@@ -27,6 +28,7 @@ public:
 	bool CommandsChanged() const { return possibleCommandsChanged; }
 	void NetOrder(Command& c, int playerId);
 	void NetSelect(std::vector<int>& s, int playerId);
+	void NetSelectDelta(const std::vector<int>& removed, const std::vector<int>& added, unsigned char selectGen, int playerId);
 	void ClearNetSelect(int playerId);
 	void DependentDied(CObject* o);
 	void Draw();
@@ -71,8 +73,15 @@ public:
 
 	spring::unordered_set<int> selectedUnits;
 	std::vector< std::vector<int> > netSelected;
+	/// per player, bumped by ClearNetSelect so stale NETMSG_SELECT_DELTA's can be detected
+	std::vector<unsigned char> netSelectGens;
 
 private:
+	/// sorted IDs of the last selection we sent, base of the next delta
+	std::vector<int16_t> sentNetSelection;
+	/// netSelectGens[myPlayerNum] at that time, -1 if nothing was sent yet
+	int sentNetSelectGen;
+
 	int selectedGroup;
 	int soundMultiselID;
 
@@ -0,0 +1,177 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#include "SlowFrameCapture.h"
+#include "Lua/LuaProfiler.h"
+#include "Sim/Features/FeatureHandler.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Path/IPathManager.h"
+#include "Sim/Projectiles/ProjectileHandler.h"
+#include "Sim/Units/UnitHandler.h"
+#include "System/TimeProfiler.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/Log/ILog.h"
+
+CONFIG(int, SlowSimFrameBudget).defaultValue(0).minimumValue(0).description("Sim frames taking longer than this many milliseconds are captured to slowframes/ (a trace of the frame, the time per profiler timer, object counts and the most expensive Lua call-ins). 0 disables the capture.");
+CONFIG(int, SlowSimFrameMaxCaptures).defaultValue(10).minimumValue(1).description("Maximum number of slow sim frames captured per game, see SlowSimFrameBudget.");
+CONFIG(bool, SlowSimFrameLuaCallIns).defaultValue(true).description("Profile Lua call-ins while SlowSimFrameBudget is set, so captures list the most expensive call-ins of their frame.");
+
+// a run of slow frames only gets its first frame captured
+static constexpr int MIN_CAPTURE_INTERVAL = GAME_SPEED;
+static constexpr size_t MAX_REPORT_ENTRIES = 40;
+
+
+CSlowFrameCapture& CSlowFrameCapture::GetInstance()
+{
+	static CSlowFrameCapture instance;
+	return instance;
+}
+
+
+void CSlowFrameCapture::ResetState()
+{
+	Kill();
+
+	budget = spring_msecs(configHandler->GetInt("SlowSimFrameBudget"));
+	maxCaptures = configHandler->GetInt("SlowSimFrameMaxCaptures");
+	numCaptures = 0;
+	lastCaptureFrame = -MIN_CAPTURE_INTERVAL;
+
+	if (!IsEnabled())
+		return;
+
+	// do not interfere with a manually started /trace or /luaprofile
+	if ((startedTrace = !profiler.IsTracing()))
+		profiler.StartTrace();
+	if ((startedLuaProfiler = (configHandler->GetBool("SlowSimFrameLuaCallIns") && !luaProfiler.IsEnabled())))
+		luaProfiler.SetEnabled(true);
+
+	LOG("[SlowFrameCapture::%s] capturing up to %d sim frames slower than %dms", __func__, maxCaptures, int(budget.toMilliSecsi()));
+}
+
+void CSlowFrameCapture::Kill()
+{
+	if (startedTrace)
+		profiler.AbortTrace();
+	if (startedLuaProfiler)
+		luaProfiler.SetEnabled(false);
+
+	startedTrace = false;
+	startedLuaProfiler = false;
+
+	budget = spring_notime;
+}
+
+
+void CSlowFrameCapture::BeginFrame()
+{
+	if (!IsEnabled())
+		return;
+
+	timerTotals.resize(profiler.GetNumTimers());
+
+	for (unsigned int i = 0; i < timerTotals.size(); i++) {
+		timerTotals[i] = profiler.GetTimerTotal(i);
+	}
+
+	numPathRequests = pathManager->GetNumPathRequests();
+}
+
+void CSlowFrameCapture::EndFrame(int frameNum, spring_time startTime, spring_time endTime)
+{
+	if (!IsEnabled())
+		return;
+	if ((endTime - startTime) <= budget)
+		return;
+	if (numCaptures >= maxCaptures)
+		return;
+	if ((frameNum - lastCaptureFrame) < MIN_CAPTURE_INTERVAL)
+		return;
+
+	WriteCapture(frameNum, startTime, endTime);
+
+	lastCaptureFrame = frameNum;
+	numCaptures += 1;
+}
+
+
+void CSlowFrameCapture::WriteCapture(int frameNum, spring_time startTime, spring_time endTime) const
+{
+	char fileName[64];
+
+	snprintf(fileName, sizeof(fileName), "slowframes/frame-%d.json", frameNum);
+
+	const std::string tracePath = dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
+	const std::string reportPath = tracePath.substr(0, tracePath.size() - 5) + ".txt";
+
+	std::ofstream file(reportPath);
+
+	if (!file.is_open()) {
+		LOG_L(L_WARNING, "[SlowFrameCapture::%s] could not write \"%s\"", __func__, reportPath.c_str());
+		return;
+	}
+
+	char line[512];
+
+	{
+		const int2 pfsUpdates = pathManager->GetNumQueuedUpdates();
+
+		snprintf(line, sizeof(line), "frame %d took %.2fms (budget %dms)\n\n", frameNum, (endTime - startTime).toMilliSecsf(), int(budget.toMilliSecsi()));
+		file << line;
+		snprintf(line, sizeof(line), "units=%u features=%u projectiles={synced=%u, unsynced=%u}\n",
+			unsigned(unitHandler->GetActiveUnits().size()),
+			unsigned(featureHandler->GetActiveFeatureIDs().size()),
+			unsigned(projectileHandler->syncedProjectiles.size()),
+			unsigned(projectileHandler->unsyncedProjectiles.size())
+		);
+		file << line;
+		snprintf(line, sizeof(line), "path-requests=%u queued-PFS-updates={%d, %d}\n\n", pathManager->GetNumPathRequests() - numPathRequests, pfsUpdates.x, pfsUpdates.y);
+		file << line;
+	}
+	{
+		std::vector< std::pair<spring_time, unsigned int> > timerTimes;
+
+		// timers registered during the frame started from zero
+		for (unsigned int i = 0, n = profiler.GetNumTimers(); i < n; i++) {
+			const spring_time t = profiler.GetTimerTotal(i) - ((i < timerTotals.size())? timerTotals[i]: spring_notime);
+
+			if (t > spring_notime)
+				timerTimes.emplace_back(t, i);
+		}
+
+		std::sort(timerTimes.begin(), timerTimes.end(), [](const std::pair<spring_time, unsigned int>& a, const std::pair<spring_time, unsigned int>& b) { return (a.first > b.first); });
+
+		file << "profiler timers (ms, nested timers are included in their parents, worker threads are summed):\n";
+
+		for (size_t i = 0, n = std::min(timerTimes.size(), MAX_REPORT_ENTRIES); i < n; i++) {
+			snprintf(line, sizeof(line), "\t%8.2f  %s\n", timerTimes[i].first.toMilliSecsf(), profiler.GetTimerName(timerTimes[i].second).c_str());
+			file << line;
+		}
+
+		file << "\n";
+	}
+	if (luaProfiler.IsEnabled()) {
+		std::vector<CLuaProfiler::CallInTime> callInTimes;
+
+		luaProfiler.GetCallInTimes(startTime, endTime, callInTimes);
+
+		file << "Lua call-ins (ms, calls):\n";
+
+		for (size_t i = 0, n = std::min(callInTimes.size(), MAX_REPORT_ENTRIES); i < n; i++) {
+			snprintf(line, sizeof(line), "\t%8.2f  %5u  %s\n", callInTimes[i].totalTime.toMilliSecsf(), callInTimes[i].numCalls, callInTimes[i].name.c_str());
+			file << line;
+		}
+	}
+
+	file.close();
+
+	if (!profiler.WriteTrace(tracePath, startTime, endTime))
+		LOG_L(L_WARNING, "[SlowFrameCapture::%s] could not write the trace \"%s\"", __func__, tracePath.c_str());
+
+	LOG_L(L_WARNING, "[SlowFrameCapture::%s] sim frame %d took %.1fms, captured to \"%s\"", __func__, frameNum, (endTime - startTime).toMilliSecsf(), reportPath.c_str());
+}
@@ -0,0 +1,59 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _SLOW_FRAME_CAPTURE_H
+#define _SLOW_FRAME_CAPTURE_H
+
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+
+/**
+ * @brief writes post-mortem data of sim frames exceeding a time budget
+ *
+ * Enabled by SlowSimFrameBudget. While enabled, the scope tracer of
+ * CTimeProfiler keeps running (and, with SlowSimFrameLuaCallIns, the Lua
+ * call-in profiler) so that the events of a slow frame are still in their
+ * ring-buffers once the frame has ended. Every other frame only costs a
+ * snapshot of the profiler timer totals.
+ *
+ * Each capture is written to slowframes/ as a Chrome trace of the frame
+ * (frame-<N>.json) and a report (frame-<N>.txt) holding the time spent per
+ * profiler timer, unit/feature/projectile and path-request counts, and the
+ * most expensive Lua call-ins of the frame.
+ */
+class CSlowFrameCapture
+{
+public:
+	static CSlowFrameCapture& GetInstance();
+
+	/// reads the configuration, called when a game has finished loading
+	void ResetState();
+	void Kill();
+
+	bool IsEnabled() const { return (budget > spring_notime); }
+
+	void BeginFrame();
+	void EndFrame(int frameNum, spring_time startTime, spring_time endTime);
+
+private:
+	void WriteCapture(int frameNum, spring_time startTime, spring_time endTime) const;
+
+private:
+	/// per profiler timer (by id), GetTimerTotal at the start of the current frame
+	std::vector<spring_time> timerTotals;
+
+	spring_time budget;
+
+	int lastCaptureFrame = 0;
+	int numCaptures = 0;
+	int maxCaptures = 0;
+
+	unsigned int numPathRequests = 0;
+
+	bool startedTrace = false;
+	bool startedLuaProfiler = false;
+};
+
+#define slowFrameCapture (CSlowFrameCapture::GetInstance())
+
+#endif // _SLOW_FRAME_CAPTURE_H
@@ -210,8 +210,41 @@ float TraceRay(
 		if (hitColQuery == nullptr)
 			hitColQuery = &cq;
 
+		// candidates are gathered per quad (in order) and bounding-sphere
+		// culled in batches before running the exact per-object tests
+		constexpr unsigned int MAX_CANDIDATES = 64;
+
+		const CSolidObject* candidates[MAX_CANDIDATES];
+		unsigned int numCandidates = 0;
+
+		const auto TestCandidates = [&](CSolidObject*& hitObject) {
+			const unsigned int numHitCandidates = CCollisionHandler::CullSegmentMisses(candidates, numCandidates, pos, pos + dir * traceLength);
+
+			for (unsigned int i = 0; i < numHitCandidates; i++) {
+				const CSolidObject* o = candidates[i];
+
+				if (!CCollisionHandler::DetectHit(o, o->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true))
+					continue;
+
+				const float len = cq.GetHitPosDist(pos, dir);
+
+				// we want the closest object (intersection point) on the ray
+				if (len >= traceLength)
+					continue;
+
+				traceLength = len;
+
+				hitObject = const_cast<CSolidObject*>(o);
+				*hitColQuery = cq;
+			}
+
+			numCandidates = 0;
+		};
+
 		// feature intersection
 		if (scanForFeatures) {
+			CSolidObject* hitObject = nullptr;
+
 			for (const int quadIdx: *qfQuery.quads) {
 				const CQuadField::Quad& quad = quadField->GetQuad(quadIdx);
 
@@ -222,24 +255,22 @@ float TraceRay(
 					if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
 						continue;
 
-					if (CCollisionHandler::DetectHit(f, f->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
-						const float len = cq.GetHitPosDist(pos, dir);
-
-						// we want the closest feature (intersection point) on the ray
-						if (len >= traceLength)
-							continue;
+					candidates[numCandidates++] = f;
 
-						traceLength = len;
-
-						hitFeature = f;
-						*hitColQuery = cq;
-					}
+					if (numCandidates == MAX_CANDIDATES)
+						TestCandidates(hitObject);
 				}
+
+				TestCandidates(hitObject);
 			}
+
+			hitFeature = static_cast<CFeature*>(hitObject);
 		}
 
 		// unit intersection
 		if (scanForAnyUnits) {
+			CSolidObject* hitObject = nullptr;
+
 			for (const int quadIdx: *qfQuery.quads) {
 				const CQuadField::Quad& quad = quadField->GetQuad(quadIdx);
 
@@ -260,21 +291,17 @@ float TraceRay(
 					if (!doHitTest)
 						continue;
 
-					if (CCollisionHandler::DetectHit(u, u->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
-						const float len = cq.GetHitPosDist(pos, dir);
-
-						// we want the closest unit (intersection point) on the ray
-						if (len >= traceLength)
-							continue;
-
-						traceLength = len;
+					candidates[numCandidates++] = u;
 
-						hitUnit = u;
-						*hitColQuery = cq;
-					}
+					if (numCandidates == MAX_CANDIDATES)
+						TestCandidates(hitObject);
 				}
+
+				TestCandidates(hitObject);
 			}
 
+			hitUnit = static_cast<CUnit*>(hitObject);
+
 			// units override features, so feature != null implies no unit was hit
 			if (hitUnit != nullptr)
 				hitFeature = nullptr;
@@ -492,7 +519,7 @@ bool TestCone(
 		const CQuadField::Quad& quad = quadField->GetQuad(quadIdx);
 
 		if (scanForAllies) {
-			for (const CUnit* u: quad.teamUnits[allyteam]) {
+			for (const CUnit* u: quad.GetAllyTeamUnits(allyteam)) {
 				if (u == owner)
 					continue;
 				if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
@@ -559,7 +586,7 @@ bool TestTrajectoryCone(
 
 		// friendly units in this quad
 		if (scanForAllies) {
-			for (const CUnit* u: quad.teamUnits[allyteam]) {
+			for (const CUnit* u: quad.GetAllyTeamUnits(allyteam)) {
 				if (u == owner)
 					continue;
 				if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
@@ -600,6 +600,8 @@ void CGuiHandler::LayoutIcons(bool useSelectionPage)
 
 	if (luaUI != nullptr && luaUI->WantsEvent("LayoutButtons")) {
 		if (LayoutCustomIcons(useSelectionPage)) {
+			UpdateCommandTextures();
+
 			if (validInCommand)
 				RevertToCmdDesc(cmdDesc, defCmd, samePage);
 
@@ -720,6 +722,8 @@ void CGuiHandler::LayoutIcons(bool useSelectionPage)
 		commands.push_back(cd);
 	}
 
+	UpdateCommandTextures();
+
 	// try to setup the old command state
 	// (inCommand, activePage, showingMetal)
 	if (validInCommand) {
@@ -2611,7 +2615,7 @@ void CGuiHandler::DrawCustomButton(const IconInfo& icon, bool highlight)
 {
 	const SCommandDescription& cmdDesc = commands[icon.commandsID];
 
-	const bool usedTexture = DrawTexture(icon, cmdDesc.iconname);
+	const bool usedTexture = DrawTexture(icon);
 	const bool drawName = !usedTexture || !cmdDesc.onlyTexture;
 
 	// highlight overlay before text is applied
@@ -2765,8 +2769,10 @@ static inline bool BindLuaTexByString(const std::string& str)
 }
 
 
-static bool BindTextureString(const std::string& str)
+static bool BindTextureAtom(StringAtoms::atom_t atom)
 {
+	const std::string& str = StringAtoms::GetString(atom);
+
 	if (str[0] == '#')
 		return BindUnitTexByString(str);
 
@@ -2776,37 +2782,64 @@ static bool BindTextureString(const std::string& str)
 	if (str[0] == LuaTextures::prefix) // '!'
 		return BindLuaTexByString(str);
 
-	return CNamedTextures::Bind(str);
+	return CNamedTextures::Bind(atom);
 }
 
 
-bool CGuiHandler::DrawTexture(const IconInfo& icon, const std::string& texName)
+void CGuiHandler::UpdateCommandTextures()
 {
-	if (texName.empty())
-		return false;
+	// parse and intern the texture names once per layout, not every frame
+	commandTextures.clear();
+	commandTextures.reserve(commands.size());
 
-	std::string tex1;
-	std::string tex2;
-	float xscale = 1.0f;
-	float yscale = 1.0f;
+	for (const SCommandDescription& cd: commands) {
+		const std::string& texName = cd.iconname;
 
-	// double texture?
-	if (texName[0] == '&') {
-		if (!ParseTextures(texName, tex1, tex2, xscale, yscale))
-			return false;
-	} else {
-		tex1 = texName;
+		commandTextures.push_back({StringAtoms::NONE, StringAtoms::NONE, 1.0f, 1.0f});
+
+		if (texName.empty())
+			continue;
+
+		CommandTexture& ct = commandTextures.back();
+
+		// double texture?
+		if (texName[0] == '&') {
+			std::string tex1;
+			std::string tex2;
+
+			if (!ParseTextures(texName, tex1, tex2, ct.xscale, ct.yscale))
+				continue;
+
+			ct.tex1 = StringAtoms::Get(tex1);
+			ct.tex2 = StringAtoms::Get(tex2);
+		} else {
+			ct.tex1 = StringAtoms::Get(texName);
+		}
 	}
+}
+
+
+bool CGuiHandler::DrawTexture(const IconInfo& icon)
+{
+	if (size_t(icon.commandsID) >= commandTextures.size())
+		return false;
+
+	const CommandTexture& ct = commandTextures[icon.commandsID];
+
+	if (ct.tex1 == StringAtoms::NONE && ct.tex2 == StringAtoms::NONE)
+		return false;
+
+	StringAtoms::atom_t tex2 = ct.tex2;
 
 	// bind the texture for the full size quad
-	if (!BindTextureString(tex1)) {
-		if (tex2.empty())
+	if (!BindTextureAtom(ct.tex1)) {
+		if (tex2 == StringAtoms::NONE)
 			return false;
 
-		if (!BindTextureString(tex2))
+		if (!BindTextureAtom(tex2))
 			return false;
 
-		tex2.clear(); // cancel the scaled draw
+		tex2 = StringAtoms::NONE; // cancel the scaled draw
 	}
 
 	glEnable(GL_TEXTURE_2D);
@@ -2821,21 +2854,21 @@ bool CGuiHandler::DrawTexture(const IconInfo& icon, const std::string& texName)
 	glTexCoord2f(0.0f, 1.0f); glVertex2f(b.x1, b.y2);
 	glEnd();
 
-	if (tex2.empty())
+	if (tex2 == StringAtoms::NONE)
 		return true; // success, no second texture to draw
 
 	// bind the texture for the scaled quad
-	if (!BindTextureString(tex2))
+	if (!BindTextureAtom(tex2))
 		return false;
 
-	assert(xscale<=0.5); //border >= 50% makes no sence
-	assert(yscale<=0.5);
+	assert(ct.xscale<=0.5); //border >= 50% makes no sence
+	assert(ct.yscale<=0.5);
 
 	// calculate the scaled quad
-	const float x1 = b.x1 + (xIconSize * xscale);
-	const float x2 = b.x2 - (xIconSize * xscale);
-	const float y1 = b.y1 - (yIconSize * yscale);
-	const float y2 = b.y2 + (yIconSize * yscale);
+	const float x1 = b.x1 + (xIconSize * ct.xscale);
+	const float x2 = b.x2 - (xIconSize * ct.xscale);
+	const float y1 = b.y1 - (yIconSize * ct.yscale);
+	const float y2 = b.y2 + (yIconSize * ct.yscale);
 
 	// draw the scaled quad
 	glBegin(GL_QUADS);
@@ -3011,7 +3044,7 @@ void CGuiHandler::DrawButtons() // Only called by Draw
 			const bool useLEDs = useOptionLEDs && (cmdDesc.type == CMDTYPE_ICON_MODE);
 
 			// specified texture
-			if (DrawTexture(icon, cmdDesc.iconname))
+			if (DrawTexture(icon))
 				usedTexture = true;
 
 			// unit buildpic
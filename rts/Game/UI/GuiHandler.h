@@ -11,6 +11,7 @@
 #include "Game/Camera.h"
 #include "Sim/Units/BuildInfo.h"
 #include "Sim/Units/CommandAI/Command.h"
+#include "System/StringAtoms.h"
 
 #define DEFAULT_GUI_CONFIG "ctrlpanel.txt"
 
@@ -119,6 +120,7 @@ private:
 	bool LayoutCustomIcons(bool useSelectionPage);
 	void ResizeIconArray(size_t size);
 	void AppendPrevAndNext(std::vector<SCommandDescription>& cmds);
+	void UpdateCommandTextures();
 	void ConvertCommands(std::vector<SCommandDescription>& cmds);
 
 	int  FindInCommandPage();
@@ -137,7 +139,7 @@ private:
 	void DrawButtons();
 	void DrawCustomButton(const IconInfo& icon, bool highlight);
 	bool DrawUnitBuildIcon(const IconInfo& icon, int unitDefID);
-	bool DrawTexture(const IconInfo& icon, const std::string& texName);
+	bool DrawTexture(const IconInfo& icon);
 	void DrawName(const IconInfo& icon, const std::string& text, bool offsetForLEDs);
 	void DrawNWtext(const IconInfo& icon, const std::string& text);
 	void DrawSWtext(const IconInfo& icon, const std::string& text);
@@ -239,6 +241,15 @@ private:
 		Box selection;
 	};
 	std::vector<IconInfo> icons;
+
+	// parsed SCommandDescription::iconname's, parallel to commands
+	struct CommandTexture {
+		StringAtoms::atom_t tex1; // full size quad
+		StringAtoms::atom_t tex2; // scaled quad (or NONE)
+		float xscale;
+		float yscale;
+	};
+	std::vector<CommandTexture> commandTextures;
 	// number of slots taken up in <icons>
 	int iconsCount;
 
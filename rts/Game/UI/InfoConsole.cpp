@@ -9,6 +9,7 @@
 #include "System/EventHandler.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/Log/LogSinkHandler.h"
+#include "System/Threading/LockStats.h"
 
 #define border 7
 
@@ -66,7 +67,7 @@ void CInfoConsole::Draw()
 	if (!smallFont) return;
 	if (data.empty()) return;
 
-	std::lock_guard<spring::recursive_mutex> scoped_lock(infoConsoleMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> scoped_lock(infoConsoleMutex, LockStats::LOCK_LOG);
 
 	if (guihandler != nullptr && !guihandler->GetOutlineFonts()) {
 		// draw a black background when not using outlined font
@@ -101,7 +102,7 @@ void CInfoConsole::Draw()
 
 void CInfoConsole::Update()
 {
-	std::lock_guard<spring::recursive_mutex> scoped_lock(infoConsoleMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> scoped_lock(infoConsoleMutex, LockStats::LOCK_LOG);
 	if (data.empty())
 		return;
 
@@ -133,7 +134,7 @@ void CInfoConsole::PushNewLinesToEventHandler()
 	std::deque<RawLine> newRawLines;
 
 	{
-		std::lock_guard<spring::recursive_mutex> scoped_lock(infoConsoleMutex);
+		LockStats::ScopedLock<spring::recursive_mutex> scoped_lock(infoConsoleMutex, LockStats::LOCK_LOG);
 
 		const int count = (int)rawData.size();
 		const int start = count - newLines;
@@ -151,7 +152,7 @@ void CInfoConsole::PushNewLinesToEventHandler()
 
 int CInfoConsole::GetRawLines(std::deque<RawLine>& lines)
 {
-	std::lock_guard<spring::recursive_mutex> scoped_lock(infoConsoleMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> scoped_lock(infoConsoleMutex, LockStats::LOCK_LOG);
 	lines = rawData;
 	const int tmp = newLines;
 	newLines = 0;
@@ -161,7 +162,7 @@ int CInfoConsole::GetRawLines(std::deque<RawLine>& lines)
 
 void CInfoConsole::RecordLogMessage(int level, const std::string& section, const std::string& text)
 {
-	std::lock_guard<spring::recursive_mutex> scoped_lock(infoConsoleMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> scoped_lock(infoConsoleMutex, LockStats::LOCK_LOG);
 
 	if (rawData.size() > maxRawLines)
 		rawData.pop_front();
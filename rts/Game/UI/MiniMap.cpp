@@ -15,6 +15,7 @@
 #include "Game/SelectedUnitsHandler.h"
 #include "Game/Players/Player.h"
 #include "Game/UI/UnitTracker.h"
+#include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Lua/LuaUnsyncedCtrl.h"
 #include "Map/BaseGroundDrawer.h"
@@ -60,7 +61,7 @@ CONFIG(bool, MiniMapDrawProjectiles).defaultValue(true).headlessValue(false);
 CONFIG(bool, SimpleMiniMapColors).defaultValue(false);
 
 CONFIG(bool, MiniMapRenderToTexture).defaultValue(true).safemodeValue(false).description("Asynchronous render MiniMap to a texture independent of screen FPS.");
-CONFIG(int, MiniMapRefreshRate).defaultValue(0).minimumValue(0).description("The refresh rate of the async MiniMap texture. Needs MiniMapRenderToTexture to be true. Value of \"0\" autoselects between 10-60FPS.");
+CONFIG(int, MiniMapRefreshRate).defaultValue(0).minimumValue(0).description("The refresh rate of the async MiniMap texture. Needs MiniMapRenderToTexture to be true. Value of \"0\" autoselects between 15-30FPS.");
 
 
 
@@ -117,6 +118,7 @@ CMiniMap::CMiniMap()
 	drawProjectiles = configHandler->GetBool("MiniMapDrawProjectiles");
 	simpleColors = configHandler->GetBool("SimpleMiniMapColors");
 	minimapRefreshRate = configHandler->GetInt("MiniMapRefreshRate");
+	nextTexUpdateTime = spring_gettime();
 	renderToTexture = configHandler->GetBool("MiniMapRenderToTexture") && FBO::IsSupported();
 
 	UpdateGeometry();
@@ -894,9 +896,9 @@ void CMiniMap::Update()
 	if (!renderToTexture)
 		return;
 
-	static spring_time nextDrawScreen = spring_gettime();
+	const spring_time curTime = spring_gettime();
 
-	if (spring_gettime() <= nextDrawScreen)
+	if (curTime <= nextTexUpdateTime)
 		return;
 
 	float refreshRate = minimapRefreshRate;
@@ -904,9 +906,12 @@ void CMiniMap::Update()
 	if (minimapRefreshRate == 0) {
 		const float viewArea = globalRendering->viewSizeX * globalRendering->viewSizeY;
 		const float mmapArea = (curDim.x * curDim.y) / viewArea;
-		refreshRate = (mmapArea >= 0.45f) ? 60 : (mmapArea > 0.15f) ? 25 : 15;
+		// even a maximized minimap gains nothing from refreshing faster
+		// than the simulation advances, while redrawing every frame makes
+		// the texture cache more expensive than not having one
+		refreshRate = (mmapArea >= 0.45f) ? GAME_SPEED : (mmapArea > 0.15f) ? 25 : 15;
 	}
-	nextDrawScreen = spring_gettime() + spring_msecs(1000.0f / refreshRate);
+	nextTexUpdateTime = curTime + spring_msecs(1000.0f / refreshRate);
 
 	fbo.Bind();
 	if (minimapTexSize != curDim)
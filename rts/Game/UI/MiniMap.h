@@ -10,6 +10,7 @@
 #include "System/Color.h"
 #include "System/float3.h"
 #include "System/type2.h"
+#include "System/Misc/SpringTime.h"
 
 
 class CUnit;
@@ -173,6 +174,9 @@ protected:
 	int2 minimapTexSize;
 	float minimapRefreshRate;
 
+	// next time the cached texture is due for a refresh
+	spring_time nextTexUpdateTime;
+
 	GLuint buttonsTexture;
 	GLuint circleLists; // 8 - 256 divs
 	static const int circleListsCount = 6;
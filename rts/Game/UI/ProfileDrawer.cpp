@@ -8,6 +8,8 @@
 #include "Game/GlobalUnsynced.h"
 #include "Lua/LuaAllocState.h"
 #include "Rendering/GL/myGL.h"
+#include "Rendering/GL/GLTimerProfiler.h"
+#include "Rendering/GL/StreamBuffer.h"
 #include "Rendering/Fonts/glFont.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/GlobalRenderingInfo.h"
@@ -20,9 +22,13 @@
 #include "Sim/Projectiles/ProjectileHandler.h"
 #include "Sim/Projectiles/ProjectileMemPool.h"
 #include "Sim/Weapons/WeaponMemPool.h"
+#include "System/AllocTracker.h"
 #include "System/EventHandler.h"
+#include "System/FrameArena.h"
 #include "System/TimeProfiler.h"
 #include "System/SafeUtil.h"
+#include "System/Threading/LockStats.h"
+#include "System/Threading/ThreadPool.h"
 #include "lib/lua/include/LuaUser.h" // spring_lua_alloc_get_stats
 
 ProfileDrawer* ProfileDrawer::instance = nullptr;
@@ -62,6 +68,9 @@ void ProfileDrawer::SetEnabled(bool enable)
 	} else {
 		spring::SafeDelete(instance);
 	}
+
+	// GPU timers only record while they are displayed
+	glTimerProfiler.SetEnabled(enable);
 }
 
 
@@ -238,6 +247,166 @@ static void DrawFrameBarcode()
 }
 
 
+static void DrawFrameTimeHistogram()
+{
+	const float drawArea[4] = {0.01f, 0.41f, (start_x * 0.5f), 0.48f};
+
+	static CGLTimerProfiler::FrameTimeStats stats;
+
+	if ((globalRendering->drawFrame % 10) == 0 || stats.numFrames == 0)
+		glTimerProfiler.GetFrameTimeStats(stats);
+
+	CVertexArray* va = GetVertexArray();
+
+	{
+		// background
+		va->Initialize();
+			va->AddVertex0(drawArea[0] - 10 * globalRendering->pixelX, drawArea[1] - 20 * globalRendering->pixelY, 0.0f);
+			va->AddVertex0(drawArea[0] - 10 * globalRendering->pixelX, drawArea[3] + 20 * globalRendering->pixelY, 0.0f);
+			va->AddVertex0(drawArea[2] + 10 * globalRendering->pixelX, drawArea[3] + 20 * globalRendering->pixelY, 0.0f);
+			va->AddVertex0(drawArea[2] + 10 * globalRendering->pixelX, drawArea[1] - 20 * globalRendering->pixelY, 0.0f);
+		glColor4f(0.0f, 0.0f, 0.0f, 0.5f);
+		va->DrawArray0(GL_QUADS);
+	}
+	{
+		// title, percentiles and axis labels
+		font->glFormat(drawArea[0], drawArea[3] + 10 * globalRendering->pixelY, 0.7f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED,
+			"Frame Times (%u frames) p50=%.1fms p90=%.1fms p99=%.1fms max=%.1fms missed-vsyncs=%u dropped-GPU-queries=%u",
+			stats.numFrames, stats.percentiles[0], stats.percentiles[1], stats.percentiles[2], stats.maxFrameTime,
+			stats.numMissedVSyncs, glTimerProfiler.GetNumDroppedScopes()
+		);
+
+		font->glFormat(drawArea[0], drawArea[1] - 2 * globalRendering->pixelY, 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "0ms");
+		font->glFormat(drawArea[2], drawArea[1] - 2 * globalRendering->pixelY, 0.5f, FONT_TOP | FONT_RIGHT | DBG_FONT_FLAGS | FONT_BUFFERED, "%.0f+ms",
+			(CGLTimerProfiler::NUM_HISTOGRAM_BINS - 1) * CGLTimerProfiler::HISTOGRAM_BIN_SIZE);
+	}
+
+	if (stats.maxBinCount == 0)
+		return;
+
+	{
+		// bars, the last bin collects every longer frame
+		const float binWidth = (drawArea[2] - drawArea[0]) / CGLTimerProfiler::NUM_HISTOGRAM_BINS;
+
+		va->Initialize();
+
+		for (unsigned i = 0; i < CGLTimerProfiler::NUM_HISTOGRAM_BINS; i++) {
+			const float x1 = drawArea[0] + (i    ) * binWidth;
+			const float x2 = drawArea[0] + (i + 1) * binWidth - 2 * globalRendering->pixelX;
+			const float y2 = drawArea[1] + (drawArea[3] - drawArea[1]) * stats.histogram[i] / stats.maxBinCount;
+
+			va->AddVertex0(x1, drawArea[1], 0.0f);
+			va->AddVertex0(x1, y2         , 0.0f);
+			va->AddVertex0(x2, y2         , 0.0f);
+			va->AddVertex0(x2, drawArea[1], 0.0f);
+		}
+
+		glColor4f(0.0f, 1.0f, 0.0f, 0.6f);
+		va->DrawArray0(GL_QUADS);
+	}
+}
+
+
+static void DrawThreadStats()
+{
+	struct WorkerRates {
+		float tasks;
+		float steals;
+		float stealAttempts;
+		float busy;
+		float idle;
+		float blocked;
+	};
+	struct LockRates {
+		float locks;
+		float contended;
+		float waitTime;
+		float maxWaitTime;
+	};
+
+	static std::array<ThreadPool::WorkerStats, ThreadPool::MAX_THREADS> prevWorkerStats;
+	static std::array<LockStats::Stats, LockStats::NUM_LOCKS> prevLockStats;
+	static std::array<WorkerRates, ThreadPool::MAX_THREADS> workerRates;
+	static std::array<LockRates, LockStats::NUM_LOCKS> lockRates;
+
+	static spring_time prevTime;
+
+	const int numThreads = std::min(ThreadPool::GetNumThreads(), int(ThreadPool::MAX_THREADS));
+
+	const float lineStep = lineHeight * 0.7f;
+	const float drawArea[4] = {0.01f, 0.53f, (start_x * 0.5f), 0.53f + (numThreads + LockStats::NUM_LOCKS + 2) * lineStep + 2 * lineHeight};
+
+	// totals are sampled once per second, the panel shows the deltas
+	if ((spring_now() - prevTime).toSecsf() >= 1.0f) {
+		const spring_time curTime = spring_now();
+		const float dt = (curTime - prevTime).toSecsf();
+		const float ns = dt * 1e9f;
+
+		for (int i = 0; i < numThreads; i++) {
+			const ThreadPool::WorkerStats cur = ThreadPool::GetWorkerStats(i, false);
+			const ThreadPool::WorkerStats& prv = prevWorkerStats[i];
+
+			workerRates[i].tasks         = (cur.numTasksRun - prv.numTasksRun) / dt;
+			workerRates[i].steals        = (cur.numRangeSteals - prv.numRangeSteals) / dt;
+			workerRates[i].stealAttempts = (cur.numStealAttempts - prv.numStealAttempts) / dt;
+			workerRates[i].busy          = (cur.sumExecTime - prv.sumExecTime) * 100.0f / ns;
+			workerRates[i].idle          = (cur.sumIdleTime - prv.sumIdleTime) * 100.0f / ns;
+			workerRates[i].blocked       = (cur.sumBlockTime - prv.sumBlockTime) * 100.0f / ns;
+
+			prevWorkerStats[i] = cur;
+		}
+
+		for (int i = 0; i < LockStats::NUM_LOCKS; i++) {
+			const LockStats::Stats cur = LockStats::GetStats(i);
+			const LockStats::Stats& prv = prevLockStats[i];
+
+			lockRates[i].locks       = (cur.numLocks - prv.numLocks) / dt;
+			lockRates[i].contended   = (cur.numContended - prv.numContended) * 100.0f / std::max(cur.numLocks - prv.numLocks, uint64_t(1));
+			lockRates[i].waitTime    = (cur.sumWaitTime - prv.sumWaitTime) * 1e-6f / dt;
+			lockRates[i].maxWaitTime = cur.maxWaitTime * 1e-6f;
+
+			prevLockStats[i] = cur;
+		}
+
+		prevTime = curTime;
+	}
+
+	{
+		// background
+		CVertexArray* va = GetVertexArray();
+		va->Initialize();
+			va->AddVertex0(drawArea[0] - 10 * globalRendering->pixelX, drawArea[1] - 10 * globalRendering->pixelY, 0.0f);
+			va->AddVertex0(drawArea[0] - 10 * globalRendering->pixelX, drawArea[3] + 10 * globalRendering->pixelY, 0.0f);
+			va->AddVertex0(drawArea[2] + 10 * globalRendering->pixelX, drawArea[3] + 10 * globalRendering->pixelY, 0.0f);
+			va->AddVertex0(drawArea[2] + 10 * globalRendering->pixelX, drawArea[1] - 10 * globalRendering->pixelY, 0.0f);
+		glColor4f(0.0f, 0.0f, 0.0f, 0.5f);
+		va->DrawArray0(GL_QUADS);
+	}
+
+	float y = drawArea[3];
+
+	font->glFormat(drawArea[0], y, 0.7f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "ThreadPool Utilisation (per second)");
+	font->glFormat(drawArea[0], y -= lineHeight, 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "thread     tasks  steals/attempts    busy    idle  blocked  (0=main)");
+
+	for (int i = 0; i < numThreads; i++) {
+		const WorkerRates& r = workerRates[i];
+
+		// idle time is not known for the main thread
+		font->glFormat(drawArea[0], y -= lineStep, 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "%-6d %9.0f  %6.0f/%-8.0f %5.1f%%  %5.1f%%  %5.1f%%",
+			i, r.tasks, r.steals, r.stealAttempts, r.busy, r.idle, r.blocked);
+	}
+
+	font->glFormat(drawArea[0], y -= lineHeight, 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "lock       locks  contended  wait  max-wait");
+
+	for (int i = 0; i < LockStats::NUM_LOCKS; i++) {
+		const LockRates& r = lockRates[i];
+
+		font->glFormat(drawArea[0], y -= lineStep, 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "%-8s %9.0f  %8.2f%%  %4.2fms  %6.2fms",
+			LockStats::GetLockName(i), r.locks, r.contended, r.waitTime, r.maxWaitTime);
+	}
+}
+
+
 static void DrawProfiler()
 {
 	font->SetTextColor(1.0f, 1.0f, 1.0f, 1.0f);
@@ -273,6 +442,15 @@ static void DrawProfiler()
 		font->glPrint(fStartX += 0.04f, fStartY, textSize, FONT_SHADOW | FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_RIGHT | FONT_BUFFERED, "max-%usage");
 		font->glPrint(fStartX += 0.04f, fStartY, textSize, FONT_SHADOW | FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_RIGHT | FONT_BUFFERED, "lag");
 
+		// print GPU time per frame of the SCOPED_GL_TIMER with the same name
+		font->glPrint(fStartX += 0.04f, fStartY, textSize, FONT_SHADOW | FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_RIGHT | FONT_BUFFERED, "gpu");
+
+		// print heap allocations per frame made directly within the scope
+		if (AllocTracker::IsEnabled()) {
+			font->glPrint(fStartX += 0.04f, fStartY, textSize, FONT_SHADOW | FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_RIGHT | FONT_BUFFERED, "allocs/f");
+			font->glPrint(fStartX += 0.04f, fStartY, textSize, FONT_SHADOW | FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_RIGHT | FONT_BUFFERED, "KB/f");
+		}
+
 		// print timer name
 		font->glPrint(fStartX += 0.01f, fStartY, textSize, FONT_SHADOW | FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_BUFFERED, "title");
 	}
@@ -280,6 +458,8 @@ static void DrawProfiler()
 	// draw the textual info (total-time, short-time percentual time, timer-name)
 	int y = 1;
 
+	unsigned glTimerID = -1u;
+
 	for (const auto& p: profiler.sortedProfile) {
 		const auto& profileData = p.second;
 
@@ -294,6 +474,17 @@ static void DrawProfiler()
 		font->glFormat(fStartX += 0.04f, fStartY, textSize, FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_RIGHT | FONT_BUFFERED, "\xff\xff%c%c%.2f%%", profileData.newPeak?1:255, profileData.newPeak?1:255, profileData.peak * 100);
 		font->glFormat(fStartX += 0.04f, fStartY, textSize, FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_RIGHT | FONT_BUFFERED, "\xff\xff%c%c%.0fms", profileData.newLagPeak?1:255, profileData.newLagPeak?1:255, profileData.maxLag);
 
+		if ((glTimerID = glTimerProfiler.FindTimer(p.first)) != -1u) {
+			font->glFormat(fStartX + 0.04f, fStartY, textSize, FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_RIGHT | FONT_BUFFERED, "%.2fms", glTimerProfiler.GetTimerTime(glTimerID));
+		}
+
+		fStartX += 0.04f;
+
+		if (AllocTracker::IsEnabled()) {
+			font->glFormat(fStartX += 0.04f, fStartY, textSize, FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_RIGHT | FONT_BUFFERED, "%.1f", profileData.allocsPerFrame);
+			font->glFormat(fStartX += 0.04f, fStartY, textSize, FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_RIGHT | FONT_BUFFERED, "%.1f", profileData.allocKBPerFrame);
+		}
+
 		// print timer name
 		font->glPrint(fStartX += 0.01f, fStartY, textSize, FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_BUFFERED, p.first);
 	}
@@ -373,8 +564,8 @@ static void DrawInfoText()
 	CVertexArray* va = GetVertexArray();
 	va->Initialize();
 		va->AddVertex0(          0.01f - 10 * globalRendering->pixelX, 0.02f - 10 * globalRendering->pixelY, 0.0f);
-		va->AddVertex0(          0.01f - 10 * globalRendering->pixelX, 0.17f + 20 * globalRendering->pixelY, 0.0f);
-		va->AddVertex0(start_x - 0.05f + 10 * globalRendering->pixelX, 0.17f + 20 * globalRendering->pixelY, 0.0f);
+		va->AddVertex0(          0.01f - 10 * globalRendering->pixelX, 0.21f + 20 * globalRendering->pixelY, 0.0f);
+		va->AddVertex0(start_x - 0.05f + 10 * globalRendering->pixelX, 0.21f + 20 * globalRendering->pixelY, 0.0f);
 		va->AddVertex0(start_x - 0.05f + 10 * globalRendering->pixelX, 0.02f - 10 * globalRendering->pixelY, 0.0f);
 	glColor4f(0.0f, 0.0f, 0.0f, 0.5f);
 	va->DrawArray0(GL_QUADS);
@@ -387,10 +578,12 @@ static void DrawInfoText()
 	const char* avgFmtStr = "[3] {Sim,Update,Draw}FrameTime={%s%2.1f, %s%2.1f, %s%2.1f (GL=%2.1f)}ms";
 	const char* spdFmtStr = "[4] {Current,Wanted}SimSpeedMul={%2.2f, %2.2f}x";
 	const char* sfxFmtStr = "[5] {Synced,Unsynced}Projectiles={%u,%u} Particles=%u Saturation=%.1f";
-	const char* pfsFmtStr = "[6] (%s)PFS-updates queued: {%i, %i}";
+	const char* pfsFmtStr = "[6] (%s)PFS-updates queued: {%i, %i} (max. age {%i, %i} frames)";
 	const char* luaFmtStr = "[7] Lua-allocated memory: %.1fMB (%.1fK allocs : %.5u usecs : %.1u states)";
 	const char* gpuFmtStr = "[8] GPU-allocated memory: %.1fMB / %.1fMB";
-	const char* sopFmtStr = "[9] SOP-allocated memory: {U,F,P,W}={%.1f/%.1f, %.1f/%.1f, %.1f/%.1f, %.1f/%.1f}KB";
+	const char* sopFmtStr = "[9] SOP {live/peak objects, KB}: U={%u/%u, %.0f} F={%u/%u, %.0f} P={%u/%u, %.0f} W={%u/%u, %.0f}";
+	const char* fraFmtStr = "[10] Frame-arena peak {Sim,Draw}={%.1f, %.1f}KB (main-thread chunks %.0fKB)";
+	const char* sbfFmtStr = "[11] Streamed vertex data: %.1fKB/frame (%.0fKB ring), %u fence-waits (%.2fms)";
 
 	const CProjectileHandler* ph = projectileHandler;
 	const IPathManager* pm = pathManager;
@@ -403,7 +596,7 @@ static void DrawInfoText()
 		(gu->avgSimFrameTime  > 16) ? "\xff\xff\x01\x01" : "", gu->avgSimFrameTime,
 		(gu->avgFrameTime     > 30) ? "\xff\xff\x01\x01" : "", gu->avgFrameTime,
 		(gu->avgDrawFrameTime > 16) ? "\xff\xff\x01\x01" : "", gu->avgDrawFrameTime,
-		(globalRendering->CalcGLDeltaTime(0, CGlobalRendering::FRAME_TIME_QUERY_IDX) * 0.001f) * 0.001f
+		glTimerProfiler.GetTimerTime(glTimerProfiler.FindTimer("Draw"))
 	);
 
 	font->glFormat(0.01f, 0.08f, 0.5f, DBG_FONT_FLAGS | FONT_BUFFERED, spdFmtStr, gs->speedFactor, gs->wantedSpeedFactor);
@@ -411,13 +604,14 @@ static void DrawInfoText()
 
 	{
 		const int2 pfsUpdates = pm->GetNumQueuedUpdates();
+		const int2 pfsUpdateAges = pm->GetQueuedUpdateAges();
 
 		switch (pm->GetPathFinderType()) {
 			case PFS_TYPE_DEFAULT: {
-				font->glFormat(0.01f, 0.12f, 0.5f, DBG_FONT_FLAGS | FONT_BUFFERED, pfsFmtStr, "DEF", pfsUpdates.x, pfsUpdates.y);
+				font->glFormat(0.01f, 0.12f, 0.5f, DBG_FONT_FLAGS | FONT_BUFFERED, pfsFmtStr, "DEF", pfsUpdates.x, pfsUpdates.y, pfsUpdateAges.x, pfsUpdateAges.y);
 			} break;
 			case PFS_TYPE_QTPFS: {
-				font->glFormat(0.01f, 0.12f, 0.5f, DBG_FONT_FLAGS | FONT_BUFFERED, pfsFmtStr, "QT", pfsUpdates.x, pfsUpdates.y);
+				font->glFormat(0.01f, 0.12f, 0.5f, DBG_FONT_FLAGS | FONT_BUFFERED, pfsFmtStr, "QT", pfsUpdates.x, pfsUpdates.y, pfsUpdateAges.x, pfsUpdateAges.y);
 			} break;
 		}
 	}
@@ -443,15 +637,32 @@ static void DrawInfoText()
 	}
 
 	font->glFormat(0.01f, 0.18f, 0.5f, DBG_FONT_FLAGS | FONT_BUFFERED, sopFmtStr,
-		unitMemPool.alloc_size() / 1024.0f,
-		unitMemPool.freed_size() / 1024.0f,
-		featureMemPool.alloc_size() / 1024.0f,
-		featureMemPool.freed_size() / 1024.0f,
-		projMemPool.alloc_size() / 1024.0f,
-		projMemPool.freed_size() / 1024.0f,
-		weaponMemPool.alloc_size() / 1024.0f,
-		weaponMemPool.freed_size() / 1024.0f
+		unsigned(unitMemPool.used_count()), unsigned(unitMemPool.peak_count()), unitMemPool.alloc_size() / 1024.0f,
+		unsigned(featureMemPool.used_count()), unsigned(featureMemPool.peak_count()), featureMemPool.alloc_size() / 1024.0f,
+		unsigned(projMemPool.used_count()), unsigned(projMemPool.peak_count()), projMemPool.alloc_size() / 1024.0f,
+		unsigned(weaponMemPool.used_count()), unsigned(weaponMemPool.peak_count()), weaponMemPool.alloc_size() / 1024.0f
 	);
+
+	{
+		const FrameArena::Stats stats = FrameArena::GetStats();
+
+		font->glFormat(0.01f, 0.20f, 0.5f, DBG_FONT_FLAGS | FONT_BUFFERED, fraFmtStr,
+			stats.peakBytes[FrameArena::FRAME_TYPE_SIM] / 1024.0f,
+			stats.peakBytes[FrameArena::FRAME_TYPE_DRAW] / 1024.0f,
+			stats.chunkBytes / 1024.0f
+		);
+	}
+
+	{
+		const GL::StreamBuffer::Stats& stats = GL::GetStreamBuffer()->GetStats();
+
+		font->glFormat(0.01f, 0.22f, 0.5f, DBG_FONT_FLAGS | FONT_BUFFERED, sbfFmtStr,
+			stats.streamedBytes / 1024.0f,
+			stats.bufferBytes / 1024.0f,
+			stats.fenceWaits,
+			stats.fenceWaitTime
+		);
+	}
 }
 
 
@@ -467,6 +678,8 @@ void ProfileDrawer::DrawScreen()
 
 	DrawThreadBarcode();
 	DrawFrameBarcode();
+	DrawFrameTimeHistogram();
+	DrawThreadStats();
 	DrawProfiler();
 	DrawInfoText();
 
@@ -54,12 +54,14 @@
 #include "Rendering/Map/InfoTexture/IInfoTextureHandler.h"
 #include "Rendering/Map/InfoTexture/Modern/Path.h"
 #include "Lua/LuaOpenGL.h"
+#include "Lua/LuaProfiler.h"
 #include "Lua/LuaUI.h"
 #include "Lua/LuaGaia.h"
 #include "Lua/LuaRules.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/ModInfo.h"
+#include "Sim/Misc/SimCostProfiler.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Units/UnitDef.h"
 #include "Sim/Units/UnitDefHandler.h"
@@ -81,15 +83,20 @@
 #include "UI/TooltipConsole.h"
 #include "UI/UnitTracker.h"
 #include "UI/ProfileDrawer.h"
+#include "System/AllocTracker.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/EventHandler.h"
 #include "System/Log/ILog.h"
 #include "System/GlobalConfig.h"
 #include "Net/Protocol/NetProtocol.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/SimpleParser.h"
 #include "System/Sound/ISound.h"
 #include "System/Sound/ISoundChannels.h"
 #include "System/Sync/DumpState.h"
+#include "System/Threading/LockStats.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/SafeUtil.h"
 #include "System/EventHandler.h"
 
@@ -1162,6 +1169,225 @@ public:
 	}
 };
 
+class LuaProfileActionExecutor : public IUnsyncedActionExecutor {
+public:
+	LuaProfileActionExecutor() : IUnsyncedActionExecutor(
+		"LuaProfile",
+		"Profile Lua call-ins; arguments are [start|stop|clear|print [n]|trace [fileName]]"
+	) {}
+
+	bool Execute(const UnsyncedAction& action) const {
+		const std::vector<std::string>& args = _local_strSpaceTokenize(action.GetArgs());
+
+		if (args.empty()) {
+			// toggle
+			luaProfiler.SetEnabled(!luaProfiler.IsEnabled());
+			LogSystemStatus("Lua call-in profiling", luaProfiler.IsEnabled());
+			return true;
+		}
+
+		if (args[0] == "start" || args[0] == "stop") {
+			luaProfiler.SetEnabled(args[0] == "start");
+			LogSystemStatus("Lua call-in profiling", luaProfiler.IsEnabled());
+			return true;
+		}
+		if (args[0] == "clear") {
+			luaProfiler.Clear();
+			return true;
+		}
+		if (args[0] == "print") {
+			luaProfiler.PrintProfilingInfo((args.size() > 1)? std::max(0, atoi(args[1].c_str())): 20);
+			return true;
+		}
+		if (args[0] == "trace") {
+			const std::string fileName = (args.size() > 1)? args[1]: "luaprofile.json";
+
+			if (luaProfiler.WriteTrace(fileName)) {
+				LOG("[LuaProfile] wrote trace to \"%s\"", fileName.c_str());
+			} else {
+				LOG_L(L_WARNING, "[LuaProfile] could not write trace to \"%s\"", fileName.c_str());
+			}
+
+			return true;
+		}
+
+		return false;
+	}
+};
+
+class AllocTrackerActionExecutor : public IUnsyncedActionExecutor {
+public:
+	AllocTrackerActionExecutor() : IUnsyncedActionExecutor(
+		"AllocTracker",
+		"Count heap allocations per profiler timer (needs an ALLOC_TRACKER build); arguments are [start|stop|print [n]]"
+	) {}
+
+	bool Execute(const UnsyncedAction& action) const {
+		if (!AllocTracker::IsAvailable()) {
+			LOG_L(L_WARNING, "[AllocTracker] not available, the engine was built with ALLOC_TRACKER=OFF");
+			return true;
+		}
+
+		const std::vector<std::string>& args = _local_strSpaceTokenize(action.GetArgs());
+
+		if (args.empty()) {
+			// toggle
+			AllocTracker::SetEnabled(!AllocTracker::IsEnabled());
+			LogSystemStatus("allocation tracking", AllocTracker::IsEnabled());
+			return true;
+		}
+
+		if (args[0] == "start" || args[0] == "stop") {
+			AllocTracker::SetEnabled(args[0] == "start");
+			LogSystemStatus("allocation tracking", AllocTracker::IsEnabled());
+			return true;
+		}
+		if (args[0] == "print") {
+			AllocTracker::PrintProfilingInfo((args.size() > 1)? std::max(0, atoi(args[1].c_str())): 20);
+			return true;
+		}
+
+		return false;
+	}
+};
+
+class ThreadStatsActionExecutor : public IUnsyncedActionExecutor {
+public:
+	ThreadStatsActionExecutor() : IUnsyncedActionExecutor(
+		"ThreadStats",
+		"Log ThreadPool worker utilisation and lock contention since the previous call (or engine start)"
+	) {}
+
+	bool Execute(const UnsyncedAction& action) const {
+		const spring_time curTime = spring_now();
+		const float ns = std::max((curTime - prevTime).toSecsf(), 0.001f) * 1e9f;
+
+		LOG("[ThreadStats] over the last %.1fs (thread 0 is the main thread, lock maxwaittime is since engine start)", ns * 1e-9f);
+
+		for (int i = 0, n = std::min(ThreadPool::GetNumThreads(), int(ThreadPool::MAX_THREADS)); i < n; i++) {
+			const ThreadPool::WorkerStats cur = ThreadPool::GetWorkerStats(i, false);
+			const ThreadPool::WorkerStats& prv = prevWorkerStats[i];
+
+			LOG("\tthread=%d tasks=%lu steals=%lu/%lu {exec,idle,blocked}time={%.1f%%, %.1f%%, %.1f%%} waits=%lu",
+				i,
+				static_cast<unsigned long>(cur.numTasksRun - prv.numTasksRun),
+				static_cast<unsigned long>(cur.numRangeSteals - prv.numRangeSteals),
+				static_cast<unsigned long>(cur.numStealAttempts - prv.numStealAttempts),
+				(cur.sumExecTime - prv.sumExecTime) * 100.0f / ns,
+				(cur.sumIdleTime - prv.sumIdleTime) * 100.0f / ns,
+				(cur.sumBlockTime - prv.sumBlockTime) * 100.0f / ns,
+				static_cast<unsigned long>(cur.numWaits - prv.numWaits)
+			);
+
+			prevWorkerStats[i] = cur;
+		}
+
+		for (int i = 0; i < LockStats::NUM_LOCKS; i++) {
+			const LockStats::Stats cur = LockStats::GetStats(i);
+			const LockStats::Stats& prv = prevLockStats[i];
+
+			LOG("\tlock=%s locks=%lu contended=%lu waittime=%.3fms maxwaittime=%.3fms",
+				LockStats::GetLockName(i),
+				static_cast<unsigned long>(cur.numLocks - prv.numLocks),
+				static_cast<unsigned long>(cur.numContended - prv.numContended),
+				(cur.sumWaitTime - prv.sumWaitTime) * 1e-6f,
+				cur.maxWaitTime * 1e-6f
+			);
+
+			prevLockStats[i] = cur;
+		}
+
+		prevTime = curTime;
+		return true;
+	}
+
+private:
+	mutable std::array<ThreadPool::WorkerStats, ThreadPool::MAX_THREADS> prevWorkerStats = {};
+	mutable std::array<LockStats::Stats, LockStats::NUM_LOCKS> prevLockStats = {};
+
+	mutable spring_time prevTime;
+};
+
+class SimCostActionExecutor : public IUnsyncedActionExecutor {
+public:
+	SimCostActionExecutor() : IUnsyncedActionExecutor(
+		"SimCost",
+		"Attribute sim time to unit-, weapon-types and gadgets; arguments are [start|stop|clear|print [unitdefs|weapondefs|gadgets] [n]]"
+	) {}
+
+	bool Execute(const UnsyncedAction& action) const {
+		const std::vector<std::string>& args = _local_strSpaceTokenize(action.GetArgs());
+
+		if (args.empty()) {
+			// toggle
+			simCostProfiler.SetEnabled(!simCostProfiler.IsEnabled());
+			LogSystemStatus("sim-cost attribution", simCostProfiler.IsEnabled());
+			return true;
+		}
+
+		if (args[0] == "start" || args[0] == "stop") {
+			simCostProfiler.SetEnabled(args[0] == "start");
+			LogSystemStatus("sim-cost attribution", simCostProfiler.IsEnabled());
+			return true;
+		}
+		if (args[0] == "clear") {
+			simCostProfiler.Clear();
+			return true;
+		}
+		if (args[0] == "print") {
+			const size_t maxEntries = (args.size() > 2)? std::max(0, atoi(args[2].c_str())): 20;
+
+			for (int c = 0; c < CSimCostProfiler::NUM_CATEGORIES; c++) {
+				const auto category = static_cast<CSimCostProfiler::Category>(c);
+
+				if (args.size() > 1 && args[1] != CSimCostProfiler::GetCategoryName(category))
+					continue;
+
+				simCostProfiler.PrintRows(category, maxEntries);
+			}
+
+			return true;
+		}
+
+		return false;
+	}
+};
+
+class TraceActionExecutor : public IUnsyncedActionExecutor {
+public:
+	TraceActionExecutor() : IUnsyncedActionExecutor(
+		"Trace",
+		"Record the nesting of all profiled scopes per thread; arguments are [start|stop [fileName]]"
+	) {}
+
+	bool Execute(const UnsyncedAction& action) const {
+		const std::vector<std::string>& args = _local_strSpaceTokenize(action.GetArgs());
+
+		if (args.empty())
+			return false;
+
+		if (args[0] == "start") {
+			profiler.StartTrace();
+			LogSystemStatus("scope tracing", true);
+			return true;
+		}
+		if (args[0] == "stop") {
+			const std::string fileName = (args.size() > 1)? args[1]: "trace.json";
+			const std::string filePath = dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS);
+
+			if (profiler.StopTrace(filePath)) {
+				LOG("[Trace] wrote trace to \"%s\"", filePath.c_str());
+			} else {
+				LOG_L(L_WARNING, "[Trace] could not write trace to \"%s\" (or not tracing)", filePath.c_str());
+			}
+
+			return true;
+		}
+
+		return false;
+	}
+};
+
 class DebugGLActionExecutor : public IUnsyncedActionExecutor {
 public:
 	DebugGLActionExecutor() : IUnsyncedActionExecutor("DebugGL", "Enable/Disable OpenGL debug-context output") {}
@@ -1299,7 +1525,7 @@ public:
 class SpeedControlActionExecutor : public IUnsyncedActionExecutor {
 public:
 	SpeedControlActionExecutor() : IUnsyncedActionExecutor("SpeedControl",
-			"Sets how server adjusts speed according to player's load (CPU), 1: use average, 2: use highest,") {}
+			"Sets how server adjusts speed according to player's load (CPU), 1: use average, 2: use highest, 3: use percentiles") {}
 
 	bool Execute(const UnsyncedAction& action) const {
 		if (!gameServer) {
@@ -1308,7 +1534,7 @@ public:
 		if (action.GetArgs().empty()) {
 			// switch to next value
 			++game->speedControl;
-			if (game->speedControl > 2) {
+			if (game->speedControl > 3) {
 				game->speedControl = 1;
 			}
 		} else {
@@ -1316,7 +1542,7 @@ public:
 			game->speedControl = atoi(action.GetArgs().c_str());
 		}
 		// constrain to bounds
-		game->speedControl = std::max(1, std::min(game->speedControl, 2));
+		game->speedControl = std::max(1, std::min(game->speedControl, 3));
 		gameServer->UpdateSpeedControl(game->speedControl);
 		return true;
 	}
@@ -3063,6 +3289,11 @@ void UnsyncedGameCommands::AddDefaultActionExecutors() {
 	AddActionExecutor(new TrackModeActionExecutor());
 	AddActionExecutor(new PauseActionExecutor());
 	AddActionExecutor(new DebugActionExecutor());
+	AddActionExecutor(new LuaProfileActionExecutor());
+	AddActionExecutor(new AllocTrackerActionExecutor());
+	AddActionExecutor(new ThreadStatsActionExecutor());
+	AddActionExecutor(new SimCostActionExecutor());
+	AddActionExecutor(new TraceActionExecutor());
 	AddActionExecutor(new DebugGLActionExecutor());
 	AddActionExecutor(new DebugGLErrorsActionExecutor());
 	AddActionExecutor(new DebugColVolDrawerActionExecutor());
@@ -17,6 +17,7 @@
 #include "Sim/Units/CommandAI/CommandAI.h"
 #include "Sim/Units/CommandAI/FactoryCAI.h"
 #include "Sim/Units/UnitTypes/Factory.h"
+#include "System/FrameArena.h"
 #include "System/Object.h"
 #include "System/StringUtil.h"
 #include "System/creg/STL_Map.h"
@@ -753,7 +754,7 @@ void CWaitCommandsAI::DeathWait::Update()
 		return; // more must die
 
 	spring::unordered_set<int> unblockSet;
-	std::vector<int> voidWaitUnitIDs;
+	FrameVector<int> voidWaitUnitIDs;
 
 	for (const int unitID: waitUnits) {
 		const WaitState state = GetWaitState(unitHandler->GetUnit(unitID));
@@ -947,7 +948,7 @@ void CWaitCommandsAI::SquadWait::Update()
 
 	if ((int)waitUnits.size() >= squadCount) {
 		spring::unordered_set<int> unblockSet;
-		std::vector<int> voidWaitUnitIDs;
+		FrameVector<int> voidWaitUnitIDs;
 
 		for (const int unitID: waitUnits) {
 			const WaitState state = GetWaitState(unitHandler->GetUnit(unitID));
@@ -1085,7 +1086,7 @@ void CWaitCommandsAI::GatherWait::Update()
 		return;
 	}
 
-	std::vector<int> voidWaitUnitIDs;
+	FrameVector<int> voidWaitUnitIDs;
 
 	for (const int unitID: waitUnits) {
 		const WaitState state = GetWaitState(unitHandler->GetUnit(unitID));
@@ -0,0 +1,171 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LuaChunkCache.h"
+#include "LuaInclude.h"
+#include "Game/GameVersion.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/StringUtil.h"
+#include "System/Sync/HsiehHash.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+CONFIG(bool, UseLuaChunkCache).defaultValue(true).description("Store compiled Lua chunks in the cache directory and load those instead of parsing the same sources again.");
+
+
+static constexpr char CHUNK_CACHE_MAGIC[4] = {'S', 'P', 'L', 'C'};
+
+struct ChunkCacheHeader {
+	char magic[4];
+
+	std::uint32_t check;
+	std::uint32_t dataCheck;
+	std::uint32_t size;
+};
+
+struct ChunkCacheKey {
+	ChunkCacheKey(const char* code, size_t size, const char* chunkName) {
+		// bytecode layout can change between engine (and thereby Lua) builds
+		const std::string& version = SpringVersion::GetSync();
+
+		Add(version.data(), version.size());
+		Add(chunkName, std::strlen(chunkName));
+		Add(code, size);
+	}
+
+	void Add(const void* data, size_t size) {
+		hash  = HsiehHash(data, size, hash  ^ 0x9e3779b9u);
+		check = HsiehHash(data, size, check ^ 0x7f4a7c15u);
+	}
+
+	std::uint32_t hash = 0;
+	std::uint32_t check = 0;
+};
+
+
+static const std::string GetChunkCacheDir() {
+	return (FileSystem::GetCacheDir() + "/lua/");
+}
+
+static std::string GetChunkCacheFileName(unsigned int hash) {
+	return (GetChunkCacheDir() + IntToString(hash, "%08x") + ".luac");
+}
+
+static int ChunkWriter(lua_State* L, const void* p, size_t size, void* ud)
+{
+	std::vector<char>* data = reinterpret_cast<std::vector<char>*>(ud);
+	const char* bytes = reinterpret_cast<const char*>(p);
+
+	data->insert(data->end(), bytes, bytes + size);
+	return 0;
+}
+
+
+static bool LoadCachedChunk(lua_State* L, const ChunkCacheKey& key, const char* chunkName)
+{
+	std::ifstream file(dataDirsAccess.LocateFile(GetChunkCacheFileName(key.hash)), std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	ChunkCacheHeader header;
+	std::vector<char> data;
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return false;
+	if (std::memcmp(header.magic, CHUNK_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.check != key.check)
+		return false;
+
+	data.resize(header.size);
+
+	if (data.empty() || !file.read(data.data(), data.size()))
+		return false;
+
+	// the undumper trusts its input, reject truncated or otherwise damaged files
+	if (data[0] != LUA_SIGNATURE[0] || HsiehHash(data.data(), data.size(), 0) != header.dataCheck)
+		return false;
+
+	if (luaL_loadbuffer(L, data.data(), data.size(), chunkName) != 0) {
+		lua_pop(L, 1);
+		return false;
+	}
+
+	return true;
+}
+
+static bool SaveCachedChunk(lua_State* L, const ChunkCacheKey& key)
+{
+	std::vector<char> data;
+
+	if (lua_dump(L, ChunkWriter, &data) != 0 || data.empty())
+		return false;
+
+	if (!FileSystem::CreateDirectory(GetChunkCacheDir()))
+		return false;
+
+	const std::string cacheFileName = GetChunkCacheFileName(key.hash);
+	const std::string tempFileName = dataDirsAccess.LocateFile(cacheFileName + ".tmp", FileQueryFlags::WRITE);
+
+	ChunkCacheHeader header;
+
+	std::memcpy(header.magic, CHUNK_CACHE_MAGIC, sizeof(header.magic));
+	header.check = key.check;
+	header.dataCheck = HsiehHash(data.data(), data.size(), 0);
+	header.size = data.size();
+
+	{
+		std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+			return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(data.data(), data.size());
+
+		if (!file.good()) {
+			file.close();
+			FileSystem::Remove(tempFileName);
+			return false;
+		}
+	}
+
+	const std::string destFileName = dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE);
+
+	#ifdef _WIN32
+	// rename does not replace existing files here
+	FileSystem::Remove(destFileName);
+	#endif
+
+	// other instances must never see a partially written file
+	if (std::rename(tempFileName.c_str(), destFileName.c_str()) != 0) {
+		FileSystem::Remove(tempFileName);
+		return false;
+	}
+
+	return true;
+}
+
+
+int LuaChunkCache::LoadBuffer(lua_State* L, const char* code, size_t size, const char* chunkName)
+{
+	// precompiled chunks are passed through as-is
+	if (size == 0 || code[0] == LUA_SIGNATURE[0] || !configHandler->GetBool("UseLuaChunkCache"))
+		return (luaL_loadbuffer(L, code, size, chunkName));
+
+	const ChunkCacheKey key(code, size, chunkName);
+
+	if (LoadCachedChunk(L, key, chunkName))
+		return 0;
+
+	const int error = luaL_loadbuffer(L, code, size, chunkName);
+
+	if (error == 0)
+		SaveCachedChunk(L, key);
+
+	return error;
+}
@@ -0,0 +1,21 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_CHUNK_CACHE_H
+#define LUA_CHUNK_CACHE_H
+
+#include <cstddef>
+
+struct lua_State;
+
+/**
+ * Drop-in replacement for luaL_loadbuffer that keeps the lua_dump output of
+ * compiled chunks in the cache directory. Cache entries are keyed by engine
+ * version, chunk name and source content, so edited files and files from
+ * different archives cannot collide; the bytecode itself is identical to what
+ * the parser produces and therefore safe for synced states as well.
+ */
+namespace LuaChunkCache {
+	int LoadBuffer(lua_State* L, const char* code, size_t size, const char* chunkName);
+};
+
+#endif // LUA_CHUNK_CACHE_H
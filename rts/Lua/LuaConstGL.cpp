@@ -170,6 +170,23 @@ bool LuaConstGL::PushEntries(lua_State* L)
 	PUSH_GL(FASTEST);
 	PUSH_GL(NICEST);
 
+	// Buffer Object targets
+	PUSH_GL(ARRAY_BUFFER);
+	PUSH_GL(ELEMENT_ARRAY_BUFFER);
+	// Buffer Object usage hints
+	PUSH_GL(STREAM_DRAW);
+	PUSH_GL(STATIC_DRAW);
+	PUSH_GL(DYNAMIC_DRAW);
+
+	// Vertex Attribute types
+	PUSH_GL(BYTE);
+	PUSH_GL(UNSIGNED_BYTE);
+	PUSH_GL(SHORT);
+	PUSH_GL(UNSIGNED_SHORT);
+	PUSH_GL(INT);
+	PUSH_GL(UNSIGNED_INT);
+	PUSH_GL(FLOAT);
+
 	// Light Specification
 	PUSH_GL(AMBIENT);
 	PUSH_GL(DIFFUSE);
@@ -10,6 +10,8 @@
 #include "LuaTextures.h"
 #include "LuaFBOs.h"
 #include "LuaRBOs.h"
+#include "LuaVBOs.h"
+#include "LuaWorkers.h"
 
 #include "Rendering/GL/MatrixStateTracker.h"
 #endif
@@ -69,6 +71,8 @@ public:
 		textures.Clear();
 		fbos.Clear();
 		rbos.Clear();
+		vbos.Clear();
+		workers.Clear();
 		#endif
 	}
 
@@ -107,6 +111,8 @@ public:
 	LuaTextures textures;
 	LuaFBOs fbos;
 	LuaRBOs rbos;
+	LuaVBOs vbos;
+	LuaWorkers workers;
 
 	GLMatrixStateTracker glMatrixTracker;
 #endif
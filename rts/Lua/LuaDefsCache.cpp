@@ -0,0 +1,184 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LuaDefsCache.h"
+#include "LuaParser.h"
+#include "Game/GameSetup.h"
+#include "Game/GameVersion.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/ArchiveScanner.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/Log/ILog.h"
+#include "System/StringUtil.h"
+#include "System/Sync/HsiehHash.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+CONFIG(bool, UseLuaDefsCache).defaultValue(true).description("Store the processed gamedata definitions in the cache directory and load those instead of running defs.lua when the game, map and options did not change.");
+
+
+static constexpr char DEFS_CACHE_MAGIC[4] = {'S', 'P', 'L', 'D'};
+
+struct DefsCacheHeader {
+	char magic[4];
+
+	std::uint32_t check;
+	std::uint32_t dataCheck;
+	std::uint32_t size;
+};
+
+struct DefsCacheKey {
+	DefsCacheKey() {
+		// the dump layout and LuaParser environment can change between builds
+		const std::string& version = SpringVersion::GetSync();
+
+		const std::uint32_t modChecksum = archiveScanner->GetArchiveCompleteChecksum(archiveScanner->ArchiveFromName(gameSetup->modName));
+		const std::uint32_t mapChecksum = archiveScanner->GetArchiveCompleteChecksum(archiveScanner->ArchiveFromName(gameSetup->mapName));
+
+		Add(version.data(), version.size());
+		Add(&modChecksum, sizeof(modChecksum));
+		Add(&mapChecksum, sizeof(mapChecksum));
+		// both are exposed to defs.lua by CGame::LoadGameData
+		AddOptions(CGameSetup::GetModOptions());
+		AddOptions(CGameSetup::GetMapOptions());
+	}
+
+	void AddOptions(const spring::unordered_map<std::string, std::string>& options) {
+		std::vector< std::pair<std::string, std::string> > sortedOptions(options.begin(), options.end());
+		std::sort(sortedOptions.begin(), sortedOptions.end());
+
+		const std::uint32_t numOptions = sortedOptions.size();
+
+		Add(&numOptions, sizeof(numOptions));
+
+		// include the terminators to keep key and value boundaries apart
+		for (const auto& option: sortedOptions) {
+			Add(option.first.c_str(), option.first.size() + 1);
+			Add(option.second.c_str(), option.second.size() + 1);
+		}
+	}
+
+	void Add(const void* data, size_t size) {
+		hash  = HsiehHash(data, size, hash  ^ 0x9e3779b9u);
+		check = HsiehHash(data, size, check ^ 0x7f4a7c15u);
+	}
+
+	std::uint32_t hash = 0;
+	std::uint32_t check = 0;
+};
+
+
+static const std::string GetDefsCacheDir() {
+	return (FileSystem::GetCacheDir() + "/defs/");
+}
+
+static std::string GetDefsCacheFileName(unsigned int hash) {
+	return (GetDefsCacheDir() + IntToString(hash, "%08x") + ".defs");
+}
+
+
+static bool LoadCachedDefs(const DefsCacheKey& key, std::vector<std::uint8_t>& data)
+{
+	std::ifstream file(dataDirsAccess.LocateFile(GetDefsCacheFileName(key.hash)), std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	DefsCacheHeader header;
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return false;
+	if (std::memcmp(header.magic, DEFS_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.check != key.check)
+		return false;
+
+	data.resize(header.size);
+
+	if (data.empty() || !file.read(reinterpret_cast<char*>(data.data()), data.size()))
+		return false;
+
+	// LoadRoot only bounds-checks, reject damaged files that would still decode
+	return (HsiehHash(data.data(), data.size(), 0) == header.dataCheck);
+}
+
+static bool SaveCachedDefs(const DefsCacheKey& key, const std::vector<std::uint8_t>& data)
+{
+	if (!FileSystem::CreateDirectory(GetDefsCacheDir()))
+		return false;
+
+	const std::string cacheFileName = GetDefsCacheFileName(key.hash);
+	const std::string tempFileName = dataDirsAccess.LocateFile(cacheFileName + ".tmp", FileQueryFlags::WRITE);
+
+	DefsCacheHeader header;
+
+	std::memcpy(header.magic, DEFS_CACHE_MAGIC, sizeof(header.magic));
+	header.check = key.check;
+	header.dataCheck = HsiehHash(data.data(), data.size(), 0);
+	header.size = data.size();
+
+	{
+		std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+			return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+		if (!file.good()) {
+			file.close();
+			FileSystem::Remove(tempFileName);
+			return false;
+		}
+	}
+
+	const std::string destFileName = dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE);
+
+	#ifdef _WIN32
+	// rename does not replace existing files here
+	FileSystem::Remove(destFileName);
+	#endif
+
+	// other instances must never see a partially written file
+	if (std::rename(tempFileName.c_str(), destFileName.c_str()) != 0) {
+		FileSystem::Remove(tempFileName);
+		return false;
+	}
+
+	return true;
+}
+
+
+bool LuaDefsCache::Execute(LuaParser* parser)
+{
+	const bool useCache = configHandler->GetBool("UseLuaDefsCache");
+
+	std::vector<std::uint8_t> data;
+
+	if (useCache) {
+		const DefsCacheKey key;
+
+		if (LoadCachedDefs(key, data) && parser->LoadRoot(data)) {
+			LOG("[LuaDefsCache::%s] loaded cached definitions (%u bytes)", __func__, unsigned(data.size()));
+			return true;
+		}
+	}
+
+	if (!parser->Execute())
+		return false;
+
+	// RNG-dependent results must be recomputed every time, and
+	// tables holding functions can not be represented in a dump
+	if (parser->UsedRandom() || !parser->DumpRoot(data))
+		return true;
+
+	// uncached clients have to see the same table layout as cached ones
+	if (parser->LoadRoot(data) && useCache)
+		SaveCachedDefs(DefsCacheKey(), data);
+
+	return true;
+}
@@ -0,0 +1,21 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_DEFS_CACHE_H
+#define LUA_DEFS_CACHE_H
+
+class LuaParser;
+
+/**
+ * Replacement for LuaParser::Execute on the gamedata/defs.lua parser which
+ * keeps the processed root table in the cache directory. Entries are keyed by
+ * engine version, game and map archive checksums and mod- and map-options;
+ * defs that draw from the synced RNG or return functions are never cached.
+ *
+ * The root table is always rebuilt from its canonical dump, so its layout is
+ * the same on every client regardless of whether an entry was cached.
+ */
+namespace LuaDefsCache {
+	bool Execute(LuaParser* parser);
+};
+
+#endif // LUA_DEFS_CACHE_H
@@ -62,15 +62,20 @@ bool LuaFeatureDefs::PushEntries(lua_State* L)
 	const std::array<const IndxFuncType, 3> indxFuncs = {{FeatureDefIndex, FeatureDefNewIndex, FeatureDefMetatable}};
 	const std::array<const IterFuncType, 2> iterFuncs = {{Pairs, Next}};
 
+	const int defsTableIdx = lua_gettop(L);
+	const int metaTableIdx = PushObjectDefProxyMetaTable(L, indxOpers, indxFuncs);
+
 	for (auto it = defsMap.cbegin(); it != defsMap.cend(); ++it) {
 		const auto def = featureDefHandler->GetFeatureDefByID(it->second); // ObjectDefMapType::mapped_type
 
 		if (def == nullptr)
 			continue;
 
-		PushObjectDefProxyTable(L, indxOpers, iterOpers, indxFuncs, iterFuncs, def);
+		PushObjectDefProxyTable(L, iterOpers, iterFuncs, def, defsTableIdx, metaTableIdx);
 	}
 
+	// pop the metatable and proxy-to-def table
+	lua_pop(L, 2);
 	return true;
 }
 
@@ -134,7 +139,7 @@ static int FeatureDefIndex(lua_State* L)
 		return 1;
 	}
 
-	const void* userData = lua_touserdata(L, lua_upvalueindex(1));
+	const void* userData = GetObjectDefProxyData(L);
 	const FeatureDef* fd = static_cast<const FeatureDef*>(userData);
 	const DataElement& elem = it->second;
 	const void* p = ((const char*)fd) + elem.offset;
@@ -190,7 +195,7 @@ static int FeatureDefNewIndex(lua_State* L)
 		return 0;
 	}
 
-	const void* userData = lua_touserdata(L, lua_upvalueindex(1));
+	const void* userData = GetObjectDefProxyData(L);
 	const FeatureDef* fd = static_cast<const FeatureDef*>(userData);
 
 	// write-protected
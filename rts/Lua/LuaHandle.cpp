@@ -7,9 +7,11 @@
 #include "LuaUI.h"
 
 #include "LuaCallInCheck.h"
+#include "LuaChunkCache.h"
 #include "LuaConfig.h"
 #include "LuaHashString.h"
 #include "LuaOpenGL.h"
+#include "LuaProfiler.h"
 #include "LuaBitOps.h"
 #include "LuaMathExtra.h"
 #include "LuaUtils.h"
@@ -24,6 +26,7 @@
 #include "Game/UI/MiniMap.h"
 #include "Rendering/GlobalRendering.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/SimCostProfiler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Projectiles/Projectile.h"
 #include "Sim/Projectiles/WeaponProjectiles/WeaponProjectile.h"
@@ -41,6 +44,7 @@
 #include "System/StringUtil.h"
 #include "System/Log/ILog.h"
 #include "System/Input/KeyInput.h"
+#include "System/Sync/SyncedPrimitiveBase.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/Platform/SDL1_keysym.h"
 
@@ -51,9 +55,13 @@
 #include <SDL_mouse.h>
 
 
+#include <algorithm>
+#include <cstring>
+#include <iterator>
 #include <string>
 
 bool CLuaHandle::devMode = false;
+int CLuaHandle::gcTotalMemFootPrintKB = 0;
 
 
 /******************************************************************************/
@@ -128,12 +136,18 @@ void CLuaHandle::KillLua(bool inFreeHandler)
 	if (inFreeHandler)
 		Shutdown();
 
-	// 3. delete the lua_State
+	// 3. cancel worker jobs, their results can not be collected anymore
+	D.workers.Clear();
+
+	// 4. delete the lua_State
 	//
 	// must be done here: if called from a ctor, we want the
 	// state to become non-valid so that LoadHandler returns
 	// false and FreeHandler runs next
 	LUA_CLOSE(&L);
+
+	gcTotalMemFootPrintKB -= gcMemFootPrintKB;
+	gcMemFootPrintKB = 0;
 }
 
 
@@ -268,6 +282,8 @@ int CLuaHandle::RunCallInTraceback(
 ) {
 	// do not signal floating point exceptions in user Lua code
 	ScopedDisableFpuExceptions fe;
+	// whatever synced state a synced callin touches is accounted to Lua
+	SCOPED_SYNC_SUBSYSTEM_IF(GetHandleSynced(L), SYNC_LUA);
 
 	struct ScopedLuaCall {
 	public:
@@ -301,10 +317,20 @@ int CLuaHandle::RunCallInTraceback(
 			}
 
 			top = lua_gettop(state);
+
+			CLuaProfiler::ScopedSample profSample(state, handle->GetName(), luaFunc, nInArgs);
+
+			const int simCostScopeDepth = simCostProfiler.GetGadgetScopeDepth();
+
 			// note1: disable GC outside of this scope to prevent sync errors and similar
 			// note2: we collect garbage now in its own callin "CollectGarbage"
 			// lua_gc(L, LUA_GCRESTART, 0);
 			error = lua_pcall(state, nInArgs, nOutArgs, errFuncIdx);
+			profSample.Finish();
+
+			// close the scopes of gadgets that raised an error
+			if (error != 0)
+				simCostProfiler.EndGadgetScope(simCostScopeDepth + 1);
 			// only run GC inside of "SetHandleRunning(L, true) ... SetHandleRunning(L, false)"!
 			lua_gc(state, LUA_GCSTOP, 0);
 
@@ -429,7 +455,7 @@ bool CLuaHandle::LoadCode(lua_State* L, const string& code, const string& debug)
 
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
-	const int error = luaL_loadbuffer(L, code.c_str(), code.size(), debug.c_str());
+	const int error = LuaChunkCache::LoadBuffer(L, code.c_str(), code.size(), debug.c_str());
 
 	if (error != 0) {
 		LOG_L(L_ERROR, "[%s::%s] error=%i (%s) debug=%s msg=%s", name.c_str(), __func__, error, LuaErrorString(error), debug.c_str(), lua_tostring(L, -1));
@@ -773,6 +799,9 @@ inline void CLuaHandle::UnitCallIn(const LuaHashString& hs, const CUnit* unit)
 
 void CLuaHandle::UnitCreated(const CUnit* unit, const CUnit* builder)
 {
+	if (!eventFilters[EVENT_FILTER_UNIT_CREATED].Pass(unit->unitDef->id, -1, unit->team))
+		return;
+
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 7, __func__);
 
@@ -795,6 +824,9 @@ void CLuaHandle::UnitCreated(const CUnit* unit, const CUnit* builder)
 
 void CLuaHandle::UnitFinished(const CUnit* unit)
 {
+	if (!eventFilters[EVENT_FILTER_UNIT_FINISHED].Pass(unit->unitDef->id, -1, unit->team))
+		return;
+
 	static const LuaHashString cmdStr(__func__);
 	UnitCallIn(cmdStr, unit);
 }
@@ -832,6 +864,9 @@ void CLuaHandle::UnitReverseBuilt(const CUnit* unit)
 
 void CLuaHandle::UnitDestroyed(const CUnit* unit, const CUnit* attacker)
 {
+	if (!eventFilters[EVENT_FILTER_UNIT_DESTROYED].Pass(unit->unitDef->id, -1, unit->team))
+		return;
+
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 9, __func__);
 
@@ -954,6 +989,9 @@ void CLuaHandle::UnitDamaged(
 	int projectileID,
 	bool paralyzer)
 {
+	if (!eventFilters[EVENT_FILTER_UNIT_DAMAGED].Pass(unit->unitDef->id, weaponDefID, unit->team))
+		return;
+
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 11, __func__);
 
@@ -1353,6 +1391,9 @@ void CLuaHandle::FeatureDamaged(
 	int weaponDefID,
 	int projectileID)
 {
+	if (!eventFilters[EVENT_FILTER_FEATURE_DAMAGED].Pass(-1, weaponDefID, feature->team))
+		return;
+
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 11, __func__);
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
@@ -1403,6 +1444,12 @@ void CLuaHandle::ProjectileCreated(const CProjectile* p)
 	if (p->weapon && (wd == NULL || !watchWeaponDefs[wd->id]))
 		return;
 
+	const int ownerDefID = (owner != nullptr)? owner->unitDef->id: -1;
+	const int ownerTeam = (owner != nullptr)? owner->team: -1;
+
+	if (!eventFilters[EVENT_FILTER_PROJECTILE_CREATED].Pass(ownerDefID, (wd != nullptr)? wd->id: -1, ownerTeam))
+		return;
+
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 5, __func__);
 
@@ -2417,7 +2464,7 @@ void CLuaHandle::DownloadProgress(int ID, long downloaded, long total)
 /******************************************************************************/
 /******************************************************************************/
 
-CONFIG(float, MaxLuaGarbageCollectionTime ).defaultValue(5.f).minimumValue(1.0f).description("in MilliSecs");
+CONFIG(float, MaxLuaGarbageCollectionTime ).defaultValue(5.f).minimumValue(1.0f).description("Time budget (in MilliSecs) for each garbage collection pass, shared by all Lua handles in proportion to their memory footprint.");
 
 
 void CLuaHandle::CollectGarbage()
@@ -2433,7 +2480,12 @@ void CLuaHandle::CollectGarbage()
 	// 30x per second !!!
 	static const float maxLuaGarbageCollectTime = configHandler->GetFloat("MaxLuaGarbageCollectionTime");
 
-	float maxRunTime = smoothstep(10, 100, luaMemFootPrintKB / 1024) * maxLuaGarbageCollectTime;
+	gcTotalMemFootPrintKB += (luaMemFootPrintKB - gcMemFootPrintKB);
+	gcMemFootPrintKB = luaMemFootPrintKB;
+
+	// the budget covers all handles per pass so that many states can not add up to a spike
+	const float memFootPrintFrac = luaMemFootPrintKB / std::max(1.0f, gcTotalMemFootPrintKB * 1.0f);
+	const float maxRunTime = smoothstep(10, 100, gcTotalMemFootPrintKB / 1024) * maxLuaGarbageCollectTime * memFootPrintFrac;
 
 	const spring_time startTime = spring_gettime();
 	const spring_time endTime = startTime + spring_msecs(maxRunTime);
@@ -2457,6 +2509,11 @@ void CLuaHandle::CollectGarbage()
 	}
 
 	lua_gc(L_GC, LUA_GCSTOP, 0); // don't collect garbage outside of this function
+
+	luaMemFootPrintKB = lua_gc(L_GC, LUA_GCCOUNT, 0);
+	gcTotalMemFootPrintKB += (luaMemFootPrintKB - gcMemFootPrintKB);
+	gcMemFootPrintKB = luaMemFootPrintKB;
+
 	SetHandleRunning(L_GC, false);
 	lua_unlock(L_GC);
 
@@ -2482,6 +2539,7 @@ bool CLuaHandle::AddBasicCalls(lua_State* L)
 	lua_newtable(L); {
 		HSTR_PUSH_CFUNC(L, "Kill",            KillActiveHandle);
 		HSTR_PUSH_CFUNC(L, "UpdateCallIn",    CallOutUpdateCallIn);
+		HSTR_PUSH_CFUNC(L, "SetEventFilter",  CallOutSetEventFilter);
 		HSTR_PUSH_CFUNC(L, "GetName",         CallOutGetName);
 		HSTR_PUSH_CFUNC(L, "GetSynced",       CallOutGetSynced);
 		HSTR_PUSH_CFUNC(L, "GetFullCtrl",     CallOutGetFullCtrl);
@@ -2645,6 +2703,64 @@ int CLuaHandle::CallOutUpdateCallIn(lua_State* L)
 }
 
 
+static void ParseEventFilterIDs(lua_State* L, int table, const char* key, vector<bool>& ids)
+{
+	lua_getfield(L, table, key);
+
+	if (lua_istable(L, -1)) {
+		for (lua_pushnil(L); lua_next(L, -2) != 0; lua_pop(L, 1)) {
+			if (!lua_isnumber(L, -1))
+				continue;
+
+			const int id = lua_toint(L, -1);
+
+			// no def or team comes anywhere near this
+			if (id < 0 || id >= (1 << 16))
+				continue;
+
+			ids.resize(std::max(ids.size(), static_cast<size_t>(id + 1)), false);
+			ids[id] = true;
+		}
+	}
+
+	lua_pop(L, 1);
+}
+
+int CLuaHandle::CallOutSetEventFilter(lua_State* L)
+{
+	static const char* filterNames[EVENT_FILTER_COUNT] = {
+		"UnitCreated",
+		"UnitFinished",
+		"UnitDestroyed",
+		"UnitDamaged",
+		"FeatureDamaged",
+		"ProjectileCreated",
+	};
+
+	const char* name = luaL_checkstring(L, 1);
+	const auto pred = [&](const char* filterName) { return (strcmp(filterName, name) == 0); };
+	const auto iter = std::find_if(std::begin(filterNames), std::end(filterNames), pred);
+
+	if (iter == std::end(filterNames)) {
+		lua_pushboolean(L, false);
+		return 1;
+	}
+
+	// no table (or nil) removes the filter
+	EventFilter& filter = GetHandle(L)->eventFilters[iter - std::begin(filterNames)];
+	filter.Clear();
+
+	if (lua_istable(L, 2)) {
+		ParseEventFilterIDs(L, 2, "unitDefs", filter.unitDefs);
+		ParseEventFilterIDs(L, 2, "weaponDefs", filter.weaponDefs);
+		ParseEventFilterIDs(L, 2, "teams", filter.teams);
+	}
+
+	lua_pushboolean(L, true);
+	return 1;
+}
+
+
 /******************************************************************************/
 /******************************************************************************/
 
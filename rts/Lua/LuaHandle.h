@@ -38,6 +38,7 @@ struct SRectangle;
 struct LuaHashString;
 struct lua_State;
 class LuaRBOs;
+class LuaVBOs;
 class LuaFBOs;
 class LuaTextures;
 class LuaShaders;
@@ -97,6 +98,7 @@ class CLuaHandle : public CEventClient
 		LuaTextures& GetTextures(const lua_State* L = NULL) { return GetLuaContextData(L)->textures; }
 		LuaFBOs& GetFBOs(const lua_State* L = NULL) { return GetLuaContextData(L)->fbos; }
 		LuaRBOs& GetRBOs(const lua_State* L = NULL) { return GetLuaContextData(L)->rbos; }
+		LuaVBOs& GetVBOs(const lua_State* L = NULL) { return GetLuaContextData(L)->vbos; }
 #endif
 
 	public: // call-ins
@@ -305,8 +307,44 @@ class CLuaHandle : public CEventClient
 		vector<bool> watchFeatureDefs;
 		vector<bool> watchWeaponDefs; // for the Explosion call-in
 
+		// per-callin filters set via Script.SetEventFilter, checked
+		// before the call-in is looked up; empty lists pass any ID
+		// as do events without a unitDef, weaponDef or team (ID -1)
+		enum {
+			EVENT_FILTER_UNIT_CREATED       = 0,
+			EVENT_FILTER_UNIT_FINISHED      = 1,
+			EVENT_FILTER_UNIT_DESTROYED     = 2,
+			EVENT_FILTER_UNIT_DAMAGED       = 3,
+			EVENT_FILTER_FEATURE_DAMAGED    = 4,
+			EVENT_FILTER_PROJECTILE_CREATED = 5,
+			EVENT_FILTER_COUNT              = 6,
+		};
+
+		struct EventFilter {
+			void Clear() { unitDefs.clear(); weaponDefs.clear(); teams.clear(); }
+
+			bool Pass(int unitDefID, int weaponDefID, int teamID) const {
+				return (Match(unitDefs, unitDefID) && Match(weaponDefs, weaponDefID) && Match(teams, teamID));
+			}
+
+			static bool Match(const vector<bool>& ids, int id) {
+				return (ids.empty() || id < 0 || (static_cast<size_t>(id) < ids.size() && ids[id]));
+			}
+
+			vector<bool> unitDefs;
+			vector<bool> weaponDefs;
+			vector<bool> teams;
+		};
+
+		EventFilter eventFilters[EVENT_FILTER_COUNT];
+
 		int callinErrors;
 
+		// footprint seen by the last CollectGarbage, summed over all handles
+		// to split MaxLuaGarbageCollectionTime between them
+		int gcMemFootPrintKB = 0;
+		static int gcTotalMemFootPrintKB;
+
 	private: // call-outs
 		static int KillActiveHandle(lua_State* L);
 		static int CallOutGetName(lua_State* L);
@@ -321,6 +359,7 @@ class CLuaHandle : public CEventClient
 		static int CallOutGetRegistry(lua_State* L);
 		static int CallOutGetCallInList(lua_State* L);
 		static int CallOutUpdateCallIn(lua_State* L);
+		static int CallOutSetEventFilter(lua_State* L);
 		static int CallOutIsEngineMinVersion(lua_State* L);
 
 	public: // static
@@ -329,6 +368,7 @@ class CLuaHandle : public CEventClient
 		static inline LuaTextures& GetActiveTextures(lua_State* L) { return GetLuaContextData(L)->textures; }
 		static inline LuaFBOs& GetActiveFBOs(lua_State* L) { return GetLuaContextData(L)->fbos; }
 		static inline LuaRBOs& GetActiveRBOs(lua_State* L) { return GetLuaContextData(L)->rbos; }
+		static inline LuaVBOs& GetActiveVBOs(lua_State* L) { return GetLuaContextData(L)->vbos; }
 #endif
 
 		static void SetDevMode(bool value) { devMode = value; }
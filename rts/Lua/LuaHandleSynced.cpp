@@ -20,6 +20,7 @@
 #include "LuaSyncedRead.h"
 #include "LuaSyncedTable.h"
 #include "LuaUICommand.h"
+#include "LuaWorkers.h"
 #include "LuaUnsyncedCtrl.h"
 #include "LuaUnsyncedRead.h"
 #include "LuaFeatureDefs.h"
@@ -48,6 +49,9 @@
 #include "System/Log/ILog.h"
 #include "System/myMath.h"
 
+#include <algorithm>
+#include <cstring>
+
 
 
 LuaRulesParams::Params  CLuaHandleSynced::gameParams;
@@ -106,6 +110,7 @@ bool CUnsyncedLuaHandle::Init(const string& code, const string& file)
 	// remove Script.Kill()
 	lua_getglobal(L, "Script");
 		LuaPushNamedNil(L, "Kill");
+		LuaPushNamedCFunc(L, "GetMirror", GetMirror);
 	lua_pop(L, 1);
 
 	LuaPushNamedCFunc(L, "loadstring", CLuaHandleSynced::LoadStringData);
@@ -130,6 +135,7 @@ bool CUnsyncedLuaHandle::Init(const string& code, const string& file)
 		if (!AddEntriesToTable(L, "Spring",       LuaUnsyncedCtrl::PushEntries        )) KILL
 		if (!AddEntriesToTable(L, "Spring",       LuaUnsyncedRead::PushEntries        )) KILL
 		if (!AddEntriesToTable(L, "Spring",          LuaUICommand::PushEntries        )) KILL
+		if (!AddEntriesToTable(L, "Spring",            LuaWorkers::PushEntries        )) KILL
 		if (!AddEntriesToTable(L, "gl",                 LuaOpenGL::PushEntries        )) KILL
 		if (!AddEntriesToTable(L, "GL",                LuaConstGL::PushEntries        )) KILL
 		if (!AddEntriesToTable(L, "Engine",        LuaConstEngine::PushEntries        )) KILL
@@ -178,13 +184,200 @@ void CUnsyncedLuaHandle::RecvFromSynced(lua_State* srcState, int args)
 	if (!cmdStr.GetGlobalFunc(L))
 		return; // the call is not defined
 
-	LuaUtils::CopyData(L, srcState, args);
+	// SendToUnsynced only accepts scalars, which do not need the
+	// recursion-tracking (registry references and map) of CopyData
+	for (int i = lua_gettop(srcState) - args + 1, n = lua_gettop(srcState); i <= n; i++) {
+		switch (lua_type(srcState, i)) {
+			case LUA_TBOOLEAN: {
+				lua_pushboolean(L, lua_toboolean(srcState, i));
+			} break;
+			case LUA_TNUMBER: {
+				lua_pushnumber(L, lua_tonumber(srcState, i));
+			} break;
+			case LUA_TSTRING: {
+				size_t len = 0;
+				const char* str = lua_tolstring(srcState, i, &len);
+				lua_pushlstring(L, str, len);
+			} break;
+			default: {
+				lua_pushnil(L);
+			} break;
+		}
+	}
 
 	// call the routine
 	RunCallIn(L, cmdStr, args, 0);
 }
 
 
+// nested tables beyond this are not mirrored (also guards against cycles)
+static constexpr int MAX_MIRROR_DEPTH = 16;
+
+static bool IsMirrorScalar(int type)
+{
+	return (type == LUA_TBOOLEAN || type == LUA_TNUMBER || type == LUA_TSTRING);
+}
+
+static bool PushMirrorScalar(lua_State* dstL, lua_State* srcL, int srcIdx)
+{
+	switch (lua_type(srcL, srcIdx)) {
+		case LUA_TBOOLEAN: {
+			lua_pushboolean(dstL, lua_toboolean(srcL, srcIdx));
+		} return true;
+		case LUA_TNUMBER: {
+			lua_pushnumber(dstL, lua_tonumber(srcL, srcIdx));
+		} return true;
+		case LUA_TSTRING: {
+			size_t len = 0;
+			const char* str = lua_tolstring(srcL, srcIdx, &len);
+			lua_pushlstring(dstL, str, len);
+		} return true;
+		default: {
+		} break;
+	}
+
+	return false;
+}
+
+static bool MirrorScalarsEqual(lua_State* srcL, int srcIdx, lua_State* dstL, int dstIdx)
+{
+	if (lua_type(srcL, srcIdx) != lua_type(dstL, dstIdx))
+		return false;
+
+	switch (lua_type(srcL, srcIdx)) {
+		case LUA_TBOOLEAN: {
+			return (lua_toboolean(srcL, srcIdx) == lua_toboolean(dstL, dstIdx));
+		} break;
+		case LUA_TNUMBER: {
+			return (lua_tonumber(srcL, srcIdx) == lua_tonumber(dstL, dstIdx));
+		} break;
+		case LUA_TSTRING: {
+			size_t srcLen = 0;
+			size_t dstLen = 0;
+			const char* srcStr = lua_tolstring(srcL, srcIdx, &srcLen);
+			const char* dstStr = lua_tolstring(dstL, dstIdx, &dstLen);
+			return (srcLen == dstLen && memcmp(srcStr, dstStr, srcLen) == 0);
+		} break;
+		default: {
+		} break;
+	}
+
+	return false;
+}
+
+static void ClearMirrorTable(lua_State* dstL, int dstIdx)
+{
+	lua_pushnil(dstL);
+
+	while (lua_next(dstL, dstIdx) != 0) {
+		lua_pop(dstL, 1);
+		lua_pushvalue(dstL, -1);
+		lua_pushnil(dstL);
+		lua_rawset(dstL, dstIdx);
+	}
+}
+
+/*
+ * Brings the table at dstIdx in line with the one at srcIdx, writing only the
+ * entries that differ. Keys must be scalars and values scalars or tables, all
+ * other entries (functions, userdata, ...) are left out of the mirror. Never
+ * modifies srcL's tables, so this is safe to run on synced state.
+ */
+static void SyncMirrorTable(lua_State* srcL, int srcIdx, lua_State* dstL, int dstIdx, int depth)
+{
+	luaL_checkstack(srcL, 3, __func__);
+	luaL_checkstack(dstL, 4, __func__);
+
+	// pass 1: add and update
+	for (lua_pushnil(srcL); lua_next(srcL, srcIdx) != 0; lua_pop(srcL, 1)) {
+		const int valType = lua_type(srcL, -1);
+
+		if (!PushMirrorScalar(dstL, srcL, -2))
+			continue;
+
+		lua_pushvalue(dstL, -1);
+		lua_rawget(dstL, dstIdx);
+
+		if (IsMirrorScalar(valType)) {
+			if (!MirrorScalarsEqual(srcL, -1, dstL, -1)) {
+				lua_pop(dstL, 1);
+				PushMirrorScalar(dstL, srcL, -1);
+				lua_rawset(dstL, dstIdx);
+				continue;
+			}
+		} else if (valType == LUA_TTABLE && depth < MAX_MIRROR_DEPTH) {
+			if (!lua_istable(dstL, -1)) {
+				lua_pop(dstL, 1);
+				lua_newtable(dstL);
+				lua_pushvalue(dstL, -2);
+				lua_pushvalue(dstL, -2);
+				lua_rawset(dstL, dstIdx);
+			}
+
+			SyncMirrorTable(srcL, lua_gettop(srcL), dstL, lua_gettop(dstL), depth + 1);
+		}
+
+		lua_pop(dstL, 2);
+	}
+
+	// pass 2: remove entries that are gone (or no longer mirrorable) in srcL
+	for (lua_pushnil(dstL); lua_next(dstL, dstIdx) != 0; ) {
+		lua_pop(dstL, 1);
+
+		bool keep = false;
+
+		if (PushMirrorScalar(srcL, dstL, -1)) {
+			lua_rawget(srcL, srcIdx);
+
+			const int valType = lua_type(srcL, -1);
+
+			keep |= IsMirrorScalar(valType);
+			keep |= (valType == LUA_TTABLE && depth < MAX_MIRROR_DEPTH);
+
+			lua_pop(srcL, 1);
+		}
+
+		if (keep)
+			continue;
+
+		// clearing fields during traversal is allowed
+		lua_pushvalue(dstL, -1);
+		lua_pushnil(dstL);
+		lua_rawset(dstL, dstIdx);
+	}
+}
+
+
+void CUnsyncedLuaHandle::RecvMirror(lua_State* srcState, const string& name, int version)
+{
+	if (!IsValid())
+		return;
+
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 2, __func__);
+
+	auto it = mirrorTables.find(name);
+
+	if (it == mirrorTables.end()) {
+		lua_newtable(L);
+		it = mirrorTables.emplace(name, MirrorTable{luaL_ref(L, LUA_REGISTRYINDEX), 0}).first;
+	}
+
+	it->second.version = version;
+
+	// the source table is on top of srcState, nil if unpublished
+	lua_rawgeti(L, LUA_REGISTRYINDEX, it->second.tableRef);
+
+	if (lua_istable(srcState, -1)) {
+		SyncMirrorTable(srcState, lua_gettop(srcState), L, lua_gettop(L), 0);
+	} else {
+		ClearMirrorTable(L, lua_gettop(L));
+	}
+
+	lua_pop(L, 1);
+}
+
+
 bool CUnsyncedLuaHandle::DrawUnit(const CUnit* unit)
 {
 	LUA_CALL_IN_CHECK(L, false);
@@ -301,6 +494,19 @@ bool CUnsyncedLuaHandle::DrawProjectile(const CProjectile* projectile)
 // Call-Outs
 //
 
+int CUnsyncedLuaHandle::GetMirror(lua_State* L)
+{
+	const CUnsyncedLuaHandle* ulh = GetUnsyncedHandle(L);
+	const auto it = ulh->mirrorTables.find(luaL_checkstring(L, 1));
+
+	if (it == ulh->mirrorTables.end())
+		return 0;
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, it->second.tableRef);
+	lua_pushnumber(L, it->second.version);
+	return 2;
+}
+
 
 /******************************************************************************/
 /******************************************************************************/
@@ -389,6 +595,7 @@ bool CSyncedLuaHandle::Init(const string& code, const string& file)
 		LuaPushNamedCFunc(L, "SetWatchFeature",      SetWatchFeatureDef);
 		LuaPushNamedCFunc(L, "GetWatchWeapon",       GetWatchWeaponDef);
 		LuaPushNamedCFunc(L, "SetWatchWeapon",       SetWatchWeaponDef);
+		LuaPushNamedCFunc(L, "PublishMirror",        PublishMirror);
 	lua_pop(L, 1);
 
 	// add the custom file loader
@@ -457,6 +664,45 @@ bool CSyncedLuaHandle::SyncedActionFallback(const string& msg, int playerID)
 }
 
 
+void CSyncedLuaHandle::GameFrame(int frameNum)
+{
+	if (killMe) {
+		// deletes us
+		CLuaHandle::GameFrame(frameNum);
+		return;
+	}
+
+	CLuaHandle::GameFrame(frameNum);
+
+	LUA_CALL_IN_CHECK(L);
+	luaL_checkstack(L, 2, __func__);
+
+	// deliver everything published this frame in one go, so unsynced
+	// reads are plain table accesses instead of going through SYNCED
+	for (MirrorTable& m: mirrorTables) {
+		if (!m.dirty)
+			continue;
+
+		m.dirty = false;
+
+		lua_rawgeti(L, LUA_REGISTRYINDEX, m.tableRef);
+		base.unsyncedLuaHandle.RecvMirror(L, m.name, m.version);
+		lua_pop(L, 1);
+	}
+}
+
+
+bool CSyncedLuaHandle::UpdateCallIn(lua_State* L, const string& name)
+{
+	if (name == "GameFrame" && !mirrorTables.empty()) {
+		eventHandler.InsertEvent(this, name);
+		return true;
+	}
+
+	return CLuaHandle::UpdateCallIn(L, name);
+}
+
+
 bool CSyncedLuaHandle::CommandFallback(const CUnit* unit, const Command& cmd)
 {
 	LUA_CALL_IN_CHECK(L, true);
@@ -1264,6 +1510,45 @@ int CSyncedLuaHandle::SendToUnsynced(lua_State* L)
 }
 
 
+int CSyncedLuaHandle::PublishMirror(lua_State* L)
+{
+	const string name = luaL_checkstring(L, 1);
+
+	if (!lua_isnoneornil(L, 2))
+		luaL_checktype(L, 2, LUA_TTABLE);
+
+	CSyncedLuaHandle* slh = GetSyncedHandle(L);
+
+	auto pred = [&](const MirrorTable& m) { return (m.name == name); };
+	auto iter = std::find_if(slh->mirrorTables.begin(), slh->mirrorTables.end(), pred);
+
+	if (iter == slh->mirrorTables.end()) {
+		slh->mirrorTables.push_back({name, LUA_REFNIL, 0, false});
+		iter = slh->mirrorTables.end() - 1;
+
+		// mirrors are delivered after the GameFrame call-in
+		eventHandler.InsertEvent(slh, "GameFrame");
+	}
+
+	MirrorTable& m = *iter;
+
+	lua_settop(L, 2);
+	lua_rawgeti(L, LUA_REGISTRYINDEX, m.tableRef);
+
+	if (!lua_rawequal(L, 2, 3)) {
+		luaL_unref(L, LUA_REGISTRYINDEX, m.tableRef);
+		lua_pushvalue(L, 2);
+		m.tableRef = luaL_ref(L, LUA_REGISTRYINDEX);
+	}
+
+	m.version += 1;
+	m.dirty = true;
+
+	lua_pushnumber(L, m.version);
+	return 1;
+}
+
+
 int CSyncedLuaHandle::AddSyncedActionFallback(lua_State* L)
 {
 	string cmdRaw = luaL_checkstring(L, 1);
@@ -4,6 +4,7 @@
 #define LUA_HANDLE_SYNCED
 
 #include <string>
+#include <vector>
 
 using std::string;
 
@@ -29,6 +30,7 @@ class CUnsyncedLuaHandle : public CLuaHandle
 
 	public: // all non-eventhandler callins
 		void RecvFromSynced(lua_State* srcState, int args); // not an engine call-in
+		void RecvMirror(lua_State* srcState, const string& name, int version); // not an engine call-in
 
 	protected:
 		CUnsyncedLuaHandle(CLuaHandleSynced* base, const string& name, int order);
@@ -43,6 +45,18 @@ class CUnsyncedLuaHandle : public CLuaHandle
 
 	protected:
 		CLuaHandleSynced& base;
+
+	private:
+		struct MirrorTable {
+			int tableRef;
+			int version;
+		};
+
+		/// unsynced copies of the tables published via Script.PublishMirror
+		spring::unordered_map<string, MirrorTable> mirrorTables;
+
+	private: // call-outs
+		static int GetMirror(lua_State* L);
 };
 
 
@@ -113,6 +127,11 @@ class CSyncedLuaHandle : public CLuaHandle
 
 		bool SyncedActionFallback(const string& line, int playerID);
 
+		void GameFrame(int frameNum) override;
+
+		// keeps GameFrame registered while mirrors are published
+		bool UpdateCallIn(lua_State* L, const string& name) override;
+
 	protected:
 		CSyncedLuaHandle(CLuaHandleSynced* base, const string& name, int order);
 		virtual ~CSyncedLuaHandle();
@@ -132,6 +151,16 @@ class CSyncedLuaHandle : public CLuaHandle
 	private:
 		int origNextRef;
 
+		struct MirrorTable {
+			string name;
+			int tableRef;
+			int version;
+			bool dirty;
+		};
+
+		/// sent to the unsynced handle once per frame if dirty
+		std::vector<MirrorTable> mirrorTables;
+
 	private: // call-outs
 		static int SyncedRandom(lua_State* L);
 		static int SyncedRandomSeed(lua_State* L);
@@ -140,6 +169,7 @@ class CSyncedLuaHandle : public CLuaHandle
 		static int SyncedPairs(lua_State* L);
 
 		static int SendToUnsynced(lua_State* L);
+		static int PublishMirror(lua_State* L);
 
 		static int AddSyncedActionFallback(lua_State* L);
 		static int RemoveSyncedActionFallback(lua_State* L);
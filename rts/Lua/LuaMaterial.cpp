@@ -16,6 +16,7 @@
 #include "System/Log/ILog.h"
 #include "System/StringUtil.h"
 
+#include <algorithm>
 #include <cctype>
 
 struct ActiveUniform {
@@ -816,6 +817,17 @@ void LuaMatBin::UnRef()
 }
 
 
+void LuaMatBin::SortObjectsByTeam(LuaObjType objType)
+{
+	std::vector<CSolidObject*>& objects = (objType == LUAOBJ_UNIT)? units: features;
+
+	// stable, keeps the draw-order within each team
+	std::stable_sort(objects.begin(), objects.end(), [](const CSolidObject* a, const CSolidObject* b) {
+		return (a->team < b->team);
+	});
+}
+
+
 void LuaMatBin::Print(const string& indent) const
 {
 	LOG("%s|units| = " _STPF_, indent.c_str(), units.size());
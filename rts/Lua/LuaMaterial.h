@@ -308,6 +308,10 @@ class LuaMatBin : public LuaMaterial {
 			}
 		}
 
+		/// groups the objects by team so each team-color is set only once;
+		/// only allowed for bins whose draw-order does not matter (opaque)
+		void SortObjectsByTeam(LuaObjType objType);
+
 		void Print(const std::string& indent) const;
 
 	private:
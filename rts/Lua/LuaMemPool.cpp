@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
-#include <algorithm> // std::min
+#include <algorithm> // std::{min,max,count}
+#include <cassert>
 #include <cstdint> // std::uint8_t
 #include <cstring> // std::mem{cpy,set}
 #include <new>
@@ -8,14 +9,14 @@
 #include "LuaMemPool.h"
 #include "System/SafeUtil.h"
 #include "System/Log/ILog.h"
+#include "System/Threading/LockStats.h"
 #include "System/Threading/SpringThreading.h"
 
 // if 1, places an upper limit on pool allocation size
-// needed most when free chunks are stored in an array
-// rather than a hmap since the former would be highly
-// sparse; it also prevents the larger (ie more rarely
-// requested, so not often recycled either) allocations
-// from accumulating
+// (the size-class table only covers sizes up to this)
+// it also prevents the larger (ie more rarely requested
+// so not often recycled either) allocations from piling
+// up
 #define CHECK_MAX_ALLOC_SIZE 1
 
 
@@ -46,7 +47,7 @@ LuaMemPool* LuaMemPool::AcquirePtr(bool shared, bool owned)
 	if (!shared) {
 		// caller can be any thread; cf LuaParser context-data ctors
 		// (the shared pool must *not* be used by different threads)
-		gMutex.lock();
+		LockStats::Lock(gMutex, LockStats::LOCK_LUA);
 
 		if (gIndcs.empty()) {
 			gPools.push_back(p = new LuaMemPool(gPools.size()));
@@ -81,7 +82,7 @@ void LuaMemPool::ReleasePtr(LuaMemPool* p, const CLuaHandle* o)
 		return;
 	}
 
-	gMutex.lock();
+	LockStats::Lock(gMutex, LockStats::LOCK_LUA);
 	gIndcs.push_back(p->GetGlobalIndex());
 	gMutex.unlock();
 }
@@ -100,8 +101,43 @@ void LuaMemPool::KillStatic()
 
 
 
+size_t LuaMemPool::GetSizeClass(size_t size)
+{
+	assert(size >= MIN_ALLOC_SIZE && size <= MAX_ALLOC_SIZE);
+
+	if (size <= SMALL_CLASS_SIZE)
+		return ((size + MIN_CLASS_SIZE - 1) / MIN_CLASS_SIZE - 1);
+
+	// size is in (2^k, 2^(k+1)], select one of its four steps
+	#ifdef __GNUC__
+	const size_t k = (sizeof(unsigned int) * 8 - 1) - __builtin_clz(size - 1);
+	#else
+	size_t k = 8;
+
+	while ((size - 1) >= (size_t(2) << k))
+		k++;
+	#endif
+	const size_t j = ((size - 1) - (size_t(1) << k)) >> (k - 2);
+
+	return (NUM_SMALL_CLASSES + (k - 8) * 4 + j);
+}
+
+size_t LuaMemPool::GetClassSize(size_t sizeClass)
+{
+	if (sizeClass < NUM_SMALL_CLASSES)
+		return ((sizeClass + 1) * MIN_CLASS_SIZE);
+
+	const size_t k = ((sizeClass - NUM_SMALL_CLASSES) / 4) + 8;
+	const size_t j = ((sizeClass - NUM_SMALL_CLASSES) % 4);
+
+	return ((size_t(1) << k) + ((j + 1) << (k - 2)));
+}
+
+
 LuaMemPool::LuaMemPool(size_t lmpIndex): globalIndex(lmpIndex)
 {
+	ClearTables();
+
 	if (!LuaMemPool::enabled)
 		return;
 
@@ -112,17 +148,18 @@ LuaMemPool::LuaMemPool(size_t lmpIndex): globalIndex(lmpIndex)
 void LuaMemPool::LogStats(const char* handle, const char* lctype) const
 {
 	LOG(
-		"[LuaMemPool::%s][handle=%s (%s)] index=%lu {blocks,sizes}={%lu,%lu} {int,ext,rec}Allocs={%lu,%lu,%lu} {chunk,block}Bytes={%lu,%lu}",
+		"[LuaMemPool::%s][handle=%s (%s)] index=%lu {blocks,classes}={%lu,%lu} {int,ext,rec}Allocs={%lu,%lu,%lu} {chunk,peak,block}Bytes={%lu,%lu,%lu}",
 		__func__,
 		handle,
 		lctype,
 		(unsigned long) globalIndex,
 		(unsigned long) allocBlocks.size(),
-		(unsigned long) chunkCountTable.size(),
+		(unsigned long) (chunkCountTable.size() - std::count(chunkCountTable.begin(), chunkCountTable.end(), 0)),
 		(unsigned long) allocStats[STAT_NIA],
 		(unsigned long) allocStats[STAT_NEA],
 		(unsigned long) allocStats[STAT_NRA],
 		(unsigned long) allocStats[STAT_NCB],
+		(unsigned long) allocStats[STAT_NPB],
 		(unsigned long) allocStats[STAT_NBB]
 	);
 }
@@ -146,30 +183,25 @@ void* LuaMemPool::Alloc(size_t size)
 		return ::operator new(size);
 	}
 
-	allocStats[STAT_NIA] += 1;
-	allocStats[STAT_NCB] += (size = std::max(size, size_t(MIN_ALLOC_SIZE)));
-
-	auto freeChunksTablePair = std::make_pair(freeChunksTable.find(size), false);
+	const size_t sizeClass = GetSizeClass(std::max(size, size_t(MIN_ALLOC_SIZE)));
+	const size_t chunkSize = GetClassSize(sizeClass);
 
-	if (freeChunksTablePair.first == freeChunksTable.end())
-		freeChunksTablePair = freeChunksTable.insert(size, nullptr);
+	allocStats[STAT_NIA] += 1;
+	allocStats[STAT_NCB] += chunkSize;
+	allocStats[STAT_NPB] = std::max(allocStats[STAT_NPB], allocStats[STAT_NCB]);
 
-	void* ptr = (freeChunksTablePair.first)->second;
+	void* ptr = freeChunksTable[sizeClass];
 
 	if (ptr != nullptr) {
-		(freeChunksTablePair.first)->second = (*(void**) ptr);
+		freeChunksTable[sizeClass] = (*(void**) ptr);
 
 		allocStats[STAT_NRA] += 1;
 		return ptr;
 	}
 
-	auto chunkCountTablePair = std::make_pair(chunkCountTable.find(size), false);
-
-	if (chunkCountTablePair.first == chunkCountTable.end())
-		chunkCountTablePair = chunkCountTable.insert(size, 8);
-
-	const size_t numChunks = (chunkCountTablePair.first)->second;
-	const size_t numBytes = size * numChunks;
+	// fewer chunks per block for the larger classes, growth is geometric either way
+	const size_t numChunks = (chunkCountTable[sizeClass] == 0)? ((chunkSize <= 4096)? 8: 2): chunkCountTable[sizeClass];
+	const size_t numBytes = chunkSize * numChunks;
 
 	void* newBlock = ::operator new(numBytes);
 	uint8_t* newBytes = reinterpret_cast<uint8_t*>(newBlock);
@@ -179,15 +211,15 @@ void* LuaMemPool::Alloc(size_t size)
 	#endif
 
 	// new allocation; construct chain of chunks within the memory block
-	// (this requires the block size to be at least MIN_ALLOC_SIZE bytes)
+	// (this requires the chunk size to be at least MIN_ALLOC_SIZE bytes)
 	for (size_t i = 0; i < (numChunks - 1); ++i) {
-		*(void**) &newBytes[i * size] = (void*) &newBytes[(i + 1) * size];
+		*(void**) &newBytes[i * chunkSize] = (void*) &newBytes[(i + 1) * chunkSize];
 	}
 
-	*(void**) &newBytes[(numChunks - 1) * size] = nullptr;
+	*(void**) &newBytes[(numChunks - 1) * chunkSize] = nullptr;
 
-	freeChunksTable[size] = (*(void**) newBlock);
-	chunkCountTable[size] *= 2; // geometric increase
+	freeChunksTable[sizeClass] = (*(void**) newBlock);
+	chunkCountTable[sizeClass] = numChunks * 2; // geometric increase
 
 	allocStats[STAT_NBB] += numBytes;
 	return newBlock;
@@ -217,9 +249,11 @@ void LuaMemPool::Free(void* ptr, size_t size)
 		return;
 	}
 
-	allocStats[STAT_NCB] -= (size = std::max(size, size_t(MIN_ALLOC_SIZE)));
+	const size_t sizeClass = GetSizeClass(std::max(size, size_t(MIN_ALLOC_SIZE)));
+
+	allocStats[STAT_NCB] -= GetClassSize(sizeClass);
 
-	*(void**) ptr = freeChunksTable[size];
-	freeChunksTable[size] = ptr;
+	*(void**) ptr = freeChunksTable[sizeClass];
+	freeChunksTable[sizeClass] = ptr;
 }
 
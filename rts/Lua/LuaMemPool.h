@@ -3,11 +3,10 @@
 #ifndef LUA_MEM_POOL_H_
 #define LUA_MEM_POOL_H_
 
+#include <array>
 #include <cstddef>
 #include <vector>
 
-#include "System/UnorderedMap.hpp"
-
 class CLuaHandle;
 class LuaMemPool {
 public:
@@ -39,9 +38,6 @@ public:
 	}
 
 	void Reserve(size_t size) {
-		freeChunksTable.reserve(size);
-		chunkCountTable.reserve(size);
-
 		#if 1
 		allocBlocks.reserve(size / 16);
 		#endif
@@ -59,11 +55,12 @@ public:
 		allocStats[STAT_NRA] *= (1 - b);
 		allocStats[STAT_NCB] *= (1 - b);
 		allocStats[STAT_NBB] *= (1 - b);
+		allocStats[STAT_NPB] *= (1 - b);
 	}
 
 	void ClearTables() {
-		freeChunksTable.clear();
-		chunkCountTable.clear();
+		freeChunksTable.fill(nullptr);
+		chunkCountTable.fill(0);
 	}
 
 	size_t  GetGlobalIndex() const { return globalIndex; }
@@ -74,11 +71,22 @@ public:
 	static constexpr size_t MIN_ALLOC_SIZE = sizeof(void*);
 	static constexpr size_t MAX_ALLOC_SIZE = (1024 * 1024) - 1;
 
+	// sizes up to SMALL_CLASS_SIZE are rounded to multiples of MIN_CLASS_SIZE,
+	// larger ones to one of four steps per power of two (at most 25% waste)
+	static constexpr size_t MIN_CLASS_SIZE = 8;
+	static constexpr size_t SMALL_CLASS_SIZE = 256;
+	static constexpr size_t NUM_SMALL_CLASSES = SMALL_CLASS_SIZE / MIN_CLASS_SIZE;
+	static constexpr size_t NUM_SIZE_CLASSES = NUM_SMALL_CLASSES + (20 - 8) * 4;
+
+	static size_t GetSizeClass(size_t size);
+	static size_t GetClassSize(size_t sizeClass);
+
 	static bool enabled;
 
 private:
-	spring::unsynced_map<size_t, void*> freeChunksTable;
-	spring::unsynced_map<size_t, size_t> chunkCountTable;
+	// per size-class list of free chunks and number of chunks for the next block
+	std::array<void*, NUM_SIZE_CLASSES> freeChunksTable;
+	std::array<size_t, NUM_SIZE_CLASSES> chunkCountTable;
 
 	std::vector<void*> allocBlocks;
 
@@ -88,9 +96,10 @@ private:
 		STAT_NRA = 2, // number of recycled allocs
 		STAT_NCB = 3, // number of chunk bytes currently in use
 		STAT_NBB = 4, // number of block bytes alloced in total
+		STAT_NPB = 5, // peak number of chunk bytes in use
 	};
 
-	size_t allocStats[5] = {0, 0, 0, 0, 0};
+	size_t allocStats[6] = {0, 0, 0, 0, 0, 0};
 	size_t globalIndex = 0;
 	size_t sharedCount = 0;
 };
@@ -7,6 +7,8 @@
 #include "LuaUtils.h"
 #include "Map/MetalMap.h"
 #include "Map/ReadMap.h"
+#include "Sim/Misc/ResourceHandler.h"
+#include "Sim/Misc/ResourceMapAnalyzer.h"
 
 /******************************************************************************/
 /******************************************************************************/
@@ -16,6 +18,7 @@ bool LuaMetalMap::PushReadEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetMetalMapSize);
 	REGISTER_LUA_CFUNC(GetMetalAmount);
 	REGISTER_LUA_CFUNC(GetMetalExtraction);
+	REGISTER_LUA_CFUNC(GetMetalMapSpots);
 	return true;
 }
 
@@ -60,6 +63,30 @@ int LuaMetalMap::GetMetalExtraction(lua_State* L)
 	return 1;
 }
 
+int LuaMetalMap::GetMetalMapSpots(lua_State* L)
+{
+	// same (cached) analysis the AI interface has access to, computed on first use
+	const CResourceMapAnalyzer* rma = resourceHandler->GetResourceMapAnalyzer(resourceHandler->GetMetalId());
+
+	if (rma == nullptr)
+		return 0;
+
+	const std::vector<float3>& spots = rma->GetSpots();
+
+	lua_createtable(L, spots.size(), 0);
+
+	for (size_t i = 0; i < spots.size(); i++) {
+		// world-space {x, z, worth}; worth is only meaningful relative to other spots
+		lua_createtable(L, 3, 0);
+		lua_pushnumber(L, spots[i].x); lua_rawseti(L, -2, 1);
+		lua_pushnumber(L, spots[i].z); lua_rawseti(L, -2, 2);
+		lua_pushnumber(L, spots[i].y); lua_rawseti(L, -2, 3);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	return 1;
+}
+
 
 
 
@@ -15,6 +15,7 @@ class LuaMetalMap {
 		static int GetMetalAmount(lua_State* L);
 		static int SetMetalAmount(lua_State* L);
 		static int GetMetalExtraction(lua_State* L);
+		static int GetMetalMapSpots(lua_State* L);
 };
 
 
@@ -206,8 +206,17 @@ public:
 		if (!Enabled())
 			return false;
 
+		UpdateCurrentLOD(objType, lodDist, matType);
+		return (AddObjectForCurrentLOD(o, objType, matType));
+	}
+
+	/// as AddObjectForLOD, but with the LOD already set by UpdateCurrentLOD
+	bool AddObjectForCurrentLOD(CSolidObject* o, LuaObjType objType, LuaMatType matType) {
+		if (!Enabled())
+			return false;
+
 		LuaObjectMaterial* objMat = GetLuaMaterial(matType);
-		LuaObjectLODMaterial* lodMat = objMat->GetMaterial(SetCurrentLOD(CalcCurrentLOD(objType, lodDist, objMat->GetLastLOD())));
+		LuaObjectLODMaterial* lodMat = objMat->GetMaterial(currentLOD);
 
 		if ((lodMat != nullptr) && lodMat->IsActive()) {
 			switch (objType) {
@@ -225,6 +234,9 @@ public:
 	static void SetGlobalLODFactor(LuaObjType objType, float lodFactor) {
 		GLOBAL_LOD_FACTORS[objType] = lodFactor;
 	}
+	static float GetGlobalLODFactor(LuaObjType objType) {
+		return GLOBAL_LOD_FACTORS[objType];
+	}
 
 private:
 	static float GLOBAL_LOD_FACTORS[LUAOBJ_LAST];
@@ -12,6 +12,7 @@
 #include <string>
 #include <vector>
 #include <algorithm>
+#include <memory>
 
 #include "LuaOpenGL.h"
 
@@ -24,6 +25,7 @@
 #include "LuaIO.h"
 #include "LuaOpenGLUtils.h"
 #include "LuaRBOs.h"
+#include "LuaVBOs.h"
 #include "LuaShaders.h"
 #include "LuaTextures.h"
 #include "LuaUtils.h"
@@ -51,6 +53,7 @@
 #include "Rendering/Env/MapRendering.h"
 #include "Rendering/Env/CubeMapHandler.h"
 #include "Rendering/GL/glExtra.h"
+#include "Rendering/GL/PixelReadback.h"
 #include "Rendering/Models/3DModel.h"
 #include "Rendering/Shaders/Shader.h"
 #include "Rendering/Textures/Bitmap.h"
@@ -95,6 +98,19 @@ float LuaOpenGL::screenDistance = 0.60f; // eye-to-screen (meters)
 std::vector<LuaOpenGL::OcclusionQuery*> LuaOpenGL::occlusionQueries;
 
 
+// pending gl.ReadPixelsAsync reads; handles are indices plus one
+struct LuaPixelReadback {
+	GL::PixelReadbackRing ring;
+
+	int w;
+	int h;
+	int fSize;
+};
+
+static constexpr size_t MAX_PIXEL_READBACKS = 64;
+static std::vector<std::unique_ptr<LuaPixelReadback>> pixelReadbacks;
+
+
 
 
 static inline CUnit* ParseUnit(lua_State* L, const char* caller, int index, bool allyCheck = true)
@@ -178,6 +194,7 @@ void LuaOpenGL::Free()
 	}
 
 	occlusionQueries.clear();
+	pixelReadbacks.clear();
 }
 
 /******************************************************************************/
@@ -335,6 +352,9 @@ bool LuaOpenGL::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(Finish);
 
 	REGISTER_LUA_CFUNC(ReadPixels);
+	REGISTER_LUA_CFUNC(ReadPixelsAsync);
+	REGISTER_LUA_CFUNC(GetReadPixelsAsync);
+	REGISTER_LUA_CFUNC(DeleteReadPixelsAsync);
 	REGISTER_LUA_CFUNC(SaveImage);
 
 	REGISTER_LUA_CFUNC(CreateQuery);
@@ -354,7 +374,7 @@ bool LuaOpenGL::PushEntries(lua_State* L)
 	LuaShaders::PushEntries(L);
  	LuaFBOs::PushEntries(L);
  	LuaRBOs::PushEntries(L);
-	// TODO LuaVBOs::PushEntries(L);
+ 	LuaVBOs::PushEntries(L);
 
 	LuaFonts::PushEntries(L);
 	return true;
@@ -3397,74 +3417,178 @@ static void PushPixelData(lua_State* L, int fSize, const float*& data)
 }
 
 
-int LuaOpenGL::ReadPixels(lua_State* L)
+static int PushPixels(lua_State* L, int w, int h, int fSize, const float* data)
 {
-	const GLint x = luaL_checkint(L, 1);
-	const GLint y = luaL_checkint(L, 2);
-	const GLint w = luaL_checkint(L, 3);
-	const GLint h = luaL_checkint(L, 4);
-	const GLenum format = luaL_optint(L, 5, GL_RGBA);
-	if ((w <= 0) || (h <= 0)) {
-		return 0;
-	}
-
-	int fSize = PixelFormatSize(format);
-	if (fSize < 0) {
-		fSize = 4; // good enough?
-	}
-
-	float* data = new float[(h * w) * fSize * sizeof(float)];
-	glReadPixels(x, y, w, h, format, GL_FLOAT, data);
-
-	int retCount = 0;
-
 	const float* d = data;
 
 	if ((w == 1) && (h == 1)) {
 		for (int e = 0; e < fSize; e++) {
 			lua_pushnumber(L, data[e]);
 		}
-		retCount = fSize;
+		return fSize;
 	}
-	else if ((w == 1) && (h > 1)) {
+
+	if ((w == 1) && (h > 1)) {
 		lua_newtable(L);
 		for (int i = 1; i <= h; i++) {
 			lua_pushnumber(L, i);
 			PushPixelData(L, fSize, d);
 			lua_rawset(L, -3);
 		}
-		retCount = 1;
+		return 1;
 	}
-	else if ((w > 1) && (h == 1)) {
+
+	if ((w > 1) && (h == 1)) {
 		lua_newtable(L);
 		for (int i = 1; i <= w; i++) {
 			lua_pushnumber(L, i);
 			PushPixelData(L, fSize, d);
 			lua_rawset(L, -3);
 		}
-		retCount = 1;
+		return 1;
 	}
-	else {
+
+	lua_newtable(L);
+	for (int x = 1; x <= w; x++) {
+		lua_pushnumber(L, x);
 		lua_newtable(L);
-		for (int x = 1; x <= w; x++) {
-			lua_pushnumber(L, x);
-			lua_newtable(L);
-			for (int y = 1; y <= h; y++) {
-				lua_pushnumber(L, y);
-				PushPixelData(L, fSize, d);
-				lua_rawset(L, -3);
-			}
+		for (int y = 1; y <= h; y++) {
+			lua_pushnumber(L, y);
+			PushPixelData(L, fSize, d);
 			lua_rawset(L, -3);
 		}
-		retCount = 1;
+		lua_rawset(L, -3);
+	}
+	return 1;
+}
+
+
+int LuaOpenGL::ReadPixels(lua_State* L)
+{
+	const GLint x = luaL_checkint(L, 1);
+	const GLint y = luaL_checkint(L, 2);
+	const GLint w = luaL_checkint(L, 3);
+	const GLint h = luaL_checkint(L, 4);
+	const GLenum format = luaL_optint(L, 5, GL_RGBA);
+	if ((w <= 0) || (h <= 0)) {
+		return 0;
+	}
+
+	int fSize = PixelFormatSize(format);
+	if (fSize < 0) {
+		fSize = 4; // good enough?
 	}
 
+	float* data = new float[(h * w) * fSize * sizeof(float)];
+	glReadPixels(x, y, w, h, format, GL_FLOAT, data);
+
+	const int retCount = PushPixels(L, w, h, fSize, data);
+
 	delete[] data;
 
 	return retCount;
 }
 
 
+static size_t GetPixelReadbackIndex(lua_State* L)
+{
+	const size_t idx = luaL_checkint(L, 1) - 1;
+
+	if (idx >= pixelReadbacks.size() || pixelReadbacks[idx] == nullptr)
+		return size_t(-1);
+
+	return idx;
+}
+
+// like ReadPixels, but only queues the copy into a pixel-pack buffer and
+// returns a handle; the result is fetched in a later frame through
+// GetReadPixelsAsync(handle[, wait]) which returns false while the read
+// is pending and afterwards the same values as ReadPixels
+int LuaOpenGL::ReadPixelsAsync(lua_State* L)
+{
+	const GLint x = luaL_checkint(L, 1);
+	const GLint y = luaL_checkint(L, 2);
+	const GLint w = luaL_checkint(L, 3);
+	const GLint h = luaL_checkint(L, 4);
+	const GLenum format = luaL_optint(L, 5, GL_RGBA);
+	if ((w <= 0) || (h <= 0)) {
+		return 0;
+	}
+
+	const auto it = std::find(pixelReadbacks.begin(), pixelReadbacks.end(), nullptr);
+	const size_t idx = it - pixelReadbacks.begin();
+
+	if (idx >= MAX_PIXEL_READBACKS) {
+		LOG_L(L_WARNING, "gl.ReadPixelsAsync: too many pending reads (max %u)", static_cast<unsigned int>(MAX_PIXEL_READBACKS));
+		return 0;
+	}
+
+	int fSize = PixelFormatSize(format);
+	if (fSize < 0) {
+		fSize = 4; // good enough?
+	}
+
+	std::unique_ptr<LuaPixelReadback> rb(new LuaPixelReadback());
+
+	rb->ring.Init(1);
+	rb->w = w;
+	rb->h = h;
+	rb->fSize = fSize;
+
+	if (!rb->ring.ReadPixels(x, y, w, h, format, GL_FLOAT, (w * h) * fSize * sizeof(float)))
+		return 0;
+
+	if (it == pixelReadbacks.end()) {
+		pixelReadbacks.emplace_back(std::move(rb));
+	} else {
+		*it = std::move(rb);
+	}
+
+	lua_pushnumber(L, idx + 1);
+	return 1;
+}
+
+int LuaOpenGL::GetReadPixelsAsync(lua_State* L)
+{
+	const size_t idx = GetPixelReadbackIndex(L);
+
+	if (idx == size_t(-1))
+		return 0;
+
+	LuaPixelReadback* rb = pixelReadbacks[idx].get();
+
+	const float* data = reinterpret_cast<const float*>(rb->ring.MapFinished(luaL_optboolean(L, 2, false)));
+
+	if (data == nullptr) {
+		// not finished yet; an empty ring means the buffer could not be mapped
+		if (!rb->ring.Empty()) {
+			lua_pushboolean(L, false);
+			return 1;
+		}
+
+		pixelReadbacks[idx].reset();
+		return 0;
+	}
+
+	const int retCount = PushPixels(L, rb->w, rb->h, rb->fSize, data);
+
+	rb->ring.PopFinished();
+	pixelReadbacks[idx].reset();
+	return retCount;
+}
+
+int LuaOpenGL::DeleteReadPixelsAsync(lua_State* L)
+{
+	const size_t idx = GetPixelReadbackIndex(L);
+
+	if (idx == size_t(-1))
+		return 0;
+
+	pixelReadbacks[idx].reset();
+	return 0;
+}
+
+
 int LuaOpenGL::SaveImage(lua_State* L)
 {
 	const GLint x = (GLint)luaL_checknumber(L, 1);
@@ -303,6 +303,9 @@ class LuaOpenGL {
 		static int Finish(lua_State* L);
 
 		static int ReadPixels(lua_State* L);
+		static int ReadPixelsAsync(lua_State* L);
+		static int GetReadPixelsAsync(lua_State* L);
+		static int DeleteReadPixelsAsync(lua_State* L);
 		static int SaveImage(lua_State* L);
 
 		static int CreateQuery(lua_State* L);
@@ -4,6 +4,7 @@
 #include "LuaParser.h"
 
 #include <algorithm>
+#include <cstring>
 #include <limits.h>
 
 #include "lib/streflop/streflop_cond.h"
@@ -50,6 +51,7 @@ LuaParser::LuaParser(const string& _fileName, const string& _fileModes, const st
 	, currentRef(LUA_NOREF)
 
 	, valid(false)
+	, usedRandom(false)
 	, lowerKeys(true)
 	, lowerCppKeys(true)
 {
@@ -75,6 +77,7 @@ LuaParser::LuaParser(const string& _textChunk, const string& _accessModes, const
 	, currentRef(LUA_NOREF)
 
 	, valid(false)
+	, usedRandom(false)
 	, lowerKeys(true)
 	, lowerCppKeys(true)
 {
@@ -244,6 +247,280 @@ bool LuaParser::Execute()
 }
 
 
+/******************************************************************************/
+
+enum {
+	DUMP_TYPE_BOOLEAN = 1,
+	DUMP_TYPE_NUMBER  = 2,
+	DUMP_TYPE_STRING  = 3,
+	DUMP_TYPE_TABLE   = 4,
+};
+
+// also bounds the Lua stack space needed by LoadRoot
+static constexpr int DUMP_MAX_DEPTH = 64;
+
+struct DumpKey {
+	bool operator < (const DumpKey& k) const {
+		if (type != k.type)
+			return (type < k.type);
+
+		switch (type) {
+			case DUMP_TYPE_BOOLEAN: { return (b < k.b); } break;
+			case DUMP_TYPE_NUMBER : { return (n < k.n); } break;
+			default               : {                 } break;
+		}
+
+		return (s < k.s);
+	}
+
+	int type;
+	bool b;
+	lua_Number n;
+	std::string s;
+};
+
+static void DumpBytes(std::vector<std::uint8_t>& data, const void* p, size_t size)
+{
+	const std::uint8_t* bytes = reinterpret_cast<const std::uint8_t*>(p);
+	data.insert(data.end(), bytes, bytes + size);
+}
+
+static void DumpCount(std::vector<std::uint8_t>& data, std::uint32_t count) { DumpBytes(data, &count, sizeof(count)); }
+
+static bool DumpValue(lua_State* L, int index, std::vector<std::uint8_t>& data, int depth);
+static bool DumpTable(lua_State* L, int index, std::vector<std::uint8_t>& data, int depth)
+{
+	if (depth > DUMP_MAX_DEPTH || !lua_checkstack(L, 4))
+		return false;
+	if (index < 0)
+		index = lua_gettop(L) + index + 1;
+
+	std::vector<DumpKey> keys;
+
+	for (lua_pushnil(L); lua_next(L, index) != 0; lua_pop(L, 1)) {
+		DumpKey key;
+
+		switch (lua_type(L, -2)) {
+			case LUA_TBOOLEAN: { key.type = DUMP_TYPE_BOOLEAN; key.b = lua_toboolean(L, -2); } break;
+			case LUA_TNUMBER : { key.type = DUMP_TYPE_NUMBER ; key.n = lua_tonumber(L, -2); } break;
+			// lua_tolstring on number keys would convert them in-place and break lua_next
+			case LUA_TSTRING : {
+				size_t len = 0;
+				const char* str = lua_tolstring(L, -2, &len);
+
+				key.type = DUMP_TYPE_STRING;
+				key.s.assign(str, len);
+			} break;
+			default: {
+				lua_pop(L, 2);
+				return false;
+			} break;
+		}
+
+		keys.push_back(std::move(key));
+	}
+
+	// ordering by key makes the output independent of table internals
+	std::sort(keys.begin(), keys.end());
+	DumpCount(data, keys.size());
+
+	for (const DumpKey& key: keys) {
+		data.push_back(key.type);
+
+		switch (key.type) {
+			case DUMP_TYPE_BOOLEAN: { data.push_back(key.b); lua_pushboolean(L, key.b); } break;
+			case DUMP_TYPE_NUMBER : { DumpBytes(data, &key.n, sizeof(key.n)); lua_pushnumber(L, key.n); } break;
+			case DUMP_TYPE_STRING : {
+				DumpCount(data, key.s.size());
+				DumpBytes(data, key.s.data(), key.s.size());
+				lua_pushlstring(L, key.s.data(), key.s.size());
+			} break;
+			default: { assert(false); } break;
+		}
+
+		lua_rawget(L, index);
+
+		const bool ret = DumpValue(L, -1, data, depth);
+
+		lua_pop(L, 1);
+
+		if (!ret)
+			return false;
+	}
+
+	return true;
+}
+
+static bool DumpValue(lua_State* L, int index, std::vector<std::uint8_t>& data, int depth)
+{
+	switch (lua_type(L, index)) {
+		case LUA_TBOOLEAN: {
+			data.push_back(DUMP_TYPE_BOOLEAN);
+			data.push_back(lua_toboolean(L, index));
+		} break;
+		case LUA_TNUMBER: {
+			const lua_Number n = lua_tonumber(L, index);
+
+			data.push_back(DUMP_TYPE_NUMBER);
+			DumpBytes(data, &n, sizeof(n));
+		} break;
+		case LUA_TSTRING: {
+			size_t len = 0;
+			const char* str = lua_tolstring(L, index, &len);
+
+			data.push_back(DUMP_TYPE_STRING);
+			DumpCount(data, len);
+			DumpBytes(data, str, len);
+		} break;
+		case LUA_TTABLE: {
+			// metatables (and thereby __index defaults) can not be represented
+			if (lua_getmetatable(L, index) != 0) {
+				lua_pop(L, 1);
+				return false;
+			}
+
+			data.push_back(DUMP_TYPE_TABLE);
+			return (DumpTable(L, index, data, depth + 1));
+		} break;
+		default: {
+			// functions, userdata, threads
+			return false;
+		} break;
+	}
+
+	return true;
+}
+
+
+struct DumpReader {
+	template<typename T> bool Read(T& v) {
+		if (size_t(end - pos) < sizeof(T))
+			return false;
+
+		std::memcpy(&v, pos, sizeof(T));
+		pos += sizeof(T);
+		return true;
+	}
+
+	bool Read(std::string& s) {
+		std::uint32_t len = 0;
+
+		if (!Read(len) || size_t(end - pos) < len)
+			return false;
+
+		s.assign(reinterpret_cast<const char*>(pos), len);
+		pos += len;
+		return true;
+	}
+
+	const std::uint8_t* pos;
+	const std::uint8_t* end;
+};
+
+static bool LoadValue(lua_State* L, DumpReader& reader, bool isKey, int depth)
+{
+	std::uint8_t type = 0;
+
+	if (!reader.Read(type))
+		return false;
+
+	switch (type) {
+		case DUMP_TYPE_BOOLEAN: {
+			std::uint8_t b = 0;
+
+			if (!reader.Read(b))
+				return false;
+
+			lua_pushboolean(L, b);
+		} break;
+		case DUMP_TYPE_NUMBER: {
+			lua_Number n = 0;
+
+			if (!reader.Read(n))
+				return false;
+
+			lua_pushnumber(L, n);
+		} break;
+		case DUMP_TYPE_STRING: {
+			std::string s;
+
+			if (!reader.Read(s))
+				return false;
+
+			lua_pushlstring(L, s.data(), s.size());
+		} break;
+		case DUMP_TYPE_TABLE: {
+			std::uint32_t count = 0;
+
+			if (isKey || depth > DUMP_MAX_DEPTH || !reader.Read(count) || !lua_checkstack(L, 3))
+				return false;
+
+			lua_newtable(L);
+
+			for (std::uint32_t i = 0; i < count; i++) {
+				if (!LoadValue(L, reader, true, depth + 1)) {
+					lua_pop(L, 1);
+					return false;
+				}
+				if (!LoadValue(L, reader, false, depth + 1)) {
+					lua_pop(L, 2);
+					return false;
+				}
+
+				lua_rawset(L, -3);
+			}
+		} break;
+		default: {
+			return false;
+		} break;
+	}
+
+	return true;
+}
+
+
+bool LuaParser::DumpRoot(std::vector<std::uint8_t>& data) const
+{
+	data.clear();
+
+	if (!valid)
+		return false;
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, rootRef);
+
+	const bool ret = DumpValue(L, -1, data, 0);
+
+	lua_pop(L, 1);
+	return ret;
+}
+
+bool LuaParser::LoadRoot(const std::vector<std::uint8_t>& data)
+{
+	if (!IsValid())
+		return false;
+
+	DumpReader reader = {data.data(), data.data() + data.size()};
+
+	if (!LoadValue(L, reader, false, 0))
+		return false;
+
+	if (!lua_istable(L, -1) || reader.pos != reader.end) {
+		lua_pop(L, 1);
+		return false;
+	}
+
+	// parameters can not be added after this
+	initDepth = -1;
+
+	luaL_unref(L, LUA_REGISTRYINDEX, rootRef);
+
+	rootRef = luaL_ref(L, LUA_REGISTRYINDEX);
+	lua_settop(L, 0);
+	valid = true;
+	return true;
+}
+
+
 void LuaParser::AddTable(LuaTable* tbl) { spring::VectorInsertUnique(tables, tbl); }
 void LuaParser::RemoveTable(LuaTable* tbl) { spring::VectorErase(tables, tbl); }
 
@@ -476,6 +753,8 @@ int LuaParser::Random(lua_State* L)
 {
 	// both US and DS depend on LuaParser via MapParser, etc
 	#if (!defined(UNITSYNC) && !defined(DEDICATED))
+	// results depending on the RNG state must never be cached
+	GetLuaParser(L)->usedRandom = true;
 	lua_pushnumber(L, gsRNG.NextFloat());
 	return 1;
 	#else
@@ -690,6 +969,8 @@ LuaTable::LuaTable(const LuaTable& tbl)
 	L      = tbl.L;
 	path   = tbl.path;
 
+	fieldIndex = tbl.fieldIndex;
+
 	if (parser != nullptr)
 		parser->AddTable(this);
 
@@ -726,6 +1007,8 @@ LuaTable& LuaTable::operator=(const LuaTable& tbl)
 	L    = tbl.L;
 	path = tbl.path;
 
+	fieldIndex = tbl.fieldIndex;
+
 	if (tbl.PushTable()) {
 		lua_pushvalue(L, -1); // copy
 		refnum = luaL_ref(L, LUA_REGISTRYINDEX);
@@ -979,6 +1262,137 @@ bool LuaTable::PushValue(const string& mixedKey) const
 }
 
 
+/******************************************************************************/
+/******************************************************************************/
+//
+//  Field index
+//
+
+struct LuaTable::IndexedField {
+	std::uint32_t hash;
+	int type;
+
+	lua_Number number;
+	bool boolean;
+
+	string key;
+	string str;
+};
+
+struct LuaTable::FieldIndex {
+	// sorted by hash
+	std::vector<IndexedField> fields;
+};
+
+
+static std::uint32_t GetFieldKeyHash(const char* key, size_t len, bool lower)
+{
+	// FNV-1a; folding the case here spares the StringToLower copy per lookup
+	std::uint32_t hash = 2166136261u;
+
+	for (size_t i = 0; i < len; i++) {
+		hash ^= std::uint8_t(lower? tolower(key[i]): key[i]);
+		hash *= 16777619u;
+	}
+
+	return hash;
+}
+
+static bool FieldKeysEqual(const string& fieldKey, const string& key, bool lower)
+{
+	if (fieldKey.size() != key.size())
+		return false;
+	if (!lower)
+		return (fieldKey == key);
+
+	for (size_t i = 0; i < key.size(); i++) {
+		if (fieldKey[i] != char(tolower(key[i])))
+			return false;
+	}
+
+	return true;
+}
+
+
+void LuaTable::IndexFields()
+{
+	if (!PushTable())
+		return;
+
+	if (lua_getmetatable(L, -1) != 0) {
+		lua_pop(L, 1);
+		return;
+	}
+
+	std::shared_ptr<FieldIndex> index(new FieldIndex());
+
+	const int table = lua_gettop(L);
+
+	for (lua_pushnil(L); lua_next(L, table) != 0; lua_pop(L, 1)) {
+		// integer keys keep going through the Lua stack
+		if (lua_type(L, -2) != LUA_TSTRING)
+			continue;
+
+		size_t keyLen = 0;
+		size_t strLen = 0;
+
+		const char* key = lua_tolstring(L, -2, &keyLen);
+
+		IndexedField field;
+		field.hash = GetFieldKeyHash(key, keyLen, false);
+		field.type = lua_type(L, -1);
+		field.number = 0;
+		field.boolean = false;
+		field.key.assign(key, keyLen);
+
+		switch (field.type) {
+			case LUA_TNUMBER : { field.number = lua_tonumber(L, -1); } break;
+			case LUA_TBOOLEAN: { field.boolean = lua_toboolean(L, -1); } break;
+			case LUA_TSTRING : {
+				const char* str = lua_tolstring(L, -1, &strLen);
+				field.str.assign(str, strLen);
+			} break;
+			default: {
+			} break;
+		}
+
+		index->fields.push_back(std::move(field));
+	}
+
+	std::sort(index->fields.begin(), index->fields.end(), [](const IndexedField& a, const IndexedField& b) { return (a.hash < b.hash); });
+
+	fieldIndex = std::move(index);
+}
+
+
+bool LuaTable::FindField(const string& key, const IndexedField*& field) const
+{
+	field = nullptr;
+
+	if (fieldIndex == nullptr || !isValid)
+		return false;
+	// nested keys are resolved by PushValue
+	if (key.find('.') != string::npos)
+		return false;
+
+	const bool lower = (parser != nullptr)? parser->lowerCppKeys: true;
+	const std::uint32_t hash = GetFieldKeyHash(key.data(), key.size(), lower);
+
+	const std::vector<IndexedField>& fields = fieldIndex->fields;
+	const auto pred = [](const IndexedField& f, std::uint32_t h) { return (f.hash < h); };
+
+	for (auto it = std::lower_bound(fields.begin(), fields.end(), hash, pred); it != fields.end() && it->hash == hash; ++it) {
+		if (!FieldKeysEqual(it->key, key, lower))
+			continue;
+
+		field = &(*it);
+		break;
+	}
+
+	return true;
+}
+
+
 /******************************************************************************/
 /******************************************************************************/
 //
@@ -997,6 +1411,11 @@ bool LuaTable::KeyExists(int key) const
 
 bool LuaTable::KeyExists(const string& key) const
 {
+	const IndexedField* field = nullptr;
+
+	if (FindField(key, field))
+		return (field != nullptr);
+
 	if (!PushValue(key)) {
 		return false;
 	}
@@ -1031,11 +1450,19 @@ LuaTable::DataType LuaTable::GetType(int key) const
 
 LuaTable::DataType LuaTable::GetType(const string& key) const
 {
-	if (!PushValue(key)) {
-		return NIL;
+	const IndexedField* field = nullptr;
+
+	int type = LUA_TNIL;
+
+	if (FindField(key, field)) {
+		type = (field != nullptr)? field->type: LUA_TNIL;
+	} else {
+		if (!PushValue(key)) {
+			return NIL;
+		}
+		type = lua_type(L, -1);
+		lua_pop(L, 1);
 	}
-	const int type = lua_type(L, -1);
-	lua_pop(L, 1);
 
 	switch (type) {
 		case LUA_TBOOLEAN: return BOOLEAN;
@@ -1308,6 +1735,18 @@ static bool ParseBoolean(lua_State* L, int index, bool& value)
 
 int LuaTable::Get(const string& key, int def) const
 {
+	const IndexedField* field = nullptr;
+
+	// strings are left to Lua's number conversion
+	if (FindField(key, field) && (field == nullptr || field->type != LUA_TSTRING)) {
+		if (field == nullptr || field->type != LUA_TNUMBER)
+			return def;
+
+		lua_Integer value;
+		lua_number2integer(value, field->number);
+		return (int)value;
+	}
+
 	if (!PushValue(key)) {
 		return def;
 	}
@@ -1323,6 +1762,22 @@ int LuaTable::Get(const string& key, int def) const
 
 bool LuaTable::Get(const string& key, bool def) const
 {
+	const IndexedField* field = nullptr;
+
+	// strings are left to ParseBoolean
+	if (FindField(key, field) && (field == nullptr || field->type != LUA_TSTRING)) {
+		if (field == nullptr)
+			return def;
+
+		switch (field->type) {
+			case LUA_TBOOLEAN: { return (field->boolean); } break;
+			case LUA_TNUMBER : { return (field->number != 0.0f); } break;
+			default          : {                        } break;
+		}
+
+		return def;
+	}
+
 	if (!PushValue(key)) {
 		return def;
 	}
@@ -1338,6 +1793,16 @@ bool LuaTable::Get(const string& key, bool def) const
 
 float LuaTable::Get(const string& key, float def) const
 {
+	const IndexedField* field = nullptr;
+
+	// strings are left to Lua's number conversion
+	if (FindField(key, field) && (field == nullptr || field->type != LUA_TSTRING)) {
+		if (field == nullptr || field->type != LUA_TNUMBER)
+			return def;
+
+		return (field->number);
+	}
+
 	if (!PushValue(key)) {
 		return def;
 	}
@@ -1384,6 +1849,16 @@ float4 LuaTable::Get(const string& key, const float4& def) const
 
 string LuaTable::Get(const string& key, const string& def) const
 {
+	const IndexedField* field = nullptr;
+
+	// numbers are left to Lua's string conversion
+	if (FindField(key, field) && (field == nullptr || field->type != LUA_TNUMBER)) {
+		if (field == nullptr || field->type != LUA_TSTRING)
+			return def;
+
+		return (field->str);
+	}
+
 	if (!PushValue(key)) {
 		return def;
 	}
@@ -3,6 +3,8 @@
 #ifndef LUA_PARSER_H
 #define LUA_PARSER_H
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -37,6 +39,13 @@ public:
 
 	bool IsValid() const { return (parser != nullptr); }
 
+	/// reads all string-keyed fields in a single traversal; afterwards scalar
+	/// Get's and KeyExists for such keys are answered from a flat hash index
+	/// instead of going through the Lua stack. Only meant for tables that are
+	/// no longer modified, e.g. the per-def tables; a no-op for tables with a
+	/// metatable (whose __index can supply keys the traversal does not see)
+	void IndexFields();
+
 	const string& GetPath() const { return path; }
 
 	int GetLength() const;                  // lua '#' operator
@@ -103,12 +112,20 @@ private:
 	bool PushValue(int key) const;
 	bool PushValue(const string& key) const;
 
+	struct IndexedField;
+	struct FieldIndex;
+
+	/// true if the index can answer for key, field is null if the key is absent
+	bool FindField(const string& key, const IndexedField*& field) const;
+
 private:
 	string path;
 	mutable bool isValid;
 	LuaParser* parser;
 	lua_State* L;
 	int refnum;
+
+	std::shared_ptr<const FieldIndex> fieldIndex;
 };
 
 
@@ -128,6 +145,16 @@ public:
 	bool Execute();
 	bool IsValid() const { return (L != nullptr); }
 
+	/// serializes the root table into a canonical (key-sorted) binary form, fails
+	/// if it holds anything besides nested tables, strings, numbers and booleans
+	bool DumpRoot(std::vector<std::uint8_t>& data) const;
+	/// replaces the root table by one rebuilt from DumpRoot output; may be used
+	/// instead of Execute, e.g. when the output of an earlier run was cached
+	bool LoadRoot(const std::vector<std::uint8_t>& data);
+
+	/// true if the executed code drew numbers from the synced RNG
+	bool UsedRandom() const { return usedRandom; }
+
 	LuaTable GetRoot();
 	LuaTable SubTableExpr(const string& expr) {
 		return GetRoot().SubTableExpr(expr);
@@ -180,6 +207,7 @@ private:
 	int currentRef;
 
 	bool valid;
+	bool usedRandom;
 	bool lowerKeys; // convert all returned keys to lower case
 	bool lowerCppKeys; // convert strings in arguments keys to lower case
 
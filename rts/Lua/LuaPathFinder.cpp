@@ -69,6 +69,7 @@ bool LuaPathFinder::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetPathNodeCosts);
 	REGISTER_LUA_CFUNC(SetPathNodeCost);
 	REGISTER_LUA_CFUNC(GetPathNodeCost);
+	REGISTER_LUA_CFUNC(GetQueuedUpdates);
 
 	return true;
 }
@@ -410,5 +411,17 @@ int LuaPathFinder::GetPathNodeCost(lua_State* L)
 	return 1;
 }
 
+int LuaPathFinder::GetQueuedUpdates(lua_State* L)
+{
+	const int2 numUpdates = pathManager->GetNumQueuedUpdates();
+	const int2 updateAges = pathManager->GetQueuedUpdateAges();
+
+	lua_pushnumber(L, numUpdates.x);
+	lua_pushnumber(L, numUpdates.y);
+	lua_pushnumber(L, updateAges.x);
+	lua_pushnumber(L, updateAges.y);
+	return 4;
+}
+
 /******************************************************************************/
 /******************************************************************************/
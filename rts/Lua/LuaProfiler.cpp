@@ -0,0 +1,298 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <fstream>
+
+#include "LuaProfiler.h"
+#include "LuaInclude.h"
+#include "Rendering/GlobalRendering.h"
+#include "System/TimeProfiler.h"
+#include "System/UnorderedMap.hpp"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/Log/ILog.h"
+
+
+static void CopyName(char* dst, size_t dstSize, const char* src)
+{
+	std::strncpy(dst, src, dstSize - 1);
+	dst[dstSize - 1] = 0;
+}
+
+static std::int64_t GetAllocatedBytes(lua_State* L)
+{
+	// GC is stopped while call-ins run, so the footprint only grows
+	return ((lua_gc(L, LUA_GCCOUNT, 0) * std::int64_t(1024)) + lua_gc(L, LUA_GCCOUNTB, 0));
+}
+
+static std::string EscapeJSON(const char* str)
+{
+	std::string ret;
+
+	for (const char* c = str; *c != 0; c++) {
+		switch (*c) {
+			case '"' : { ret += "\\\""; } break;
+			case '\\': { ret += "\\\\"; } break;
+			default  : { ret += ((*c >= 0x20)? *c: '?'); } break;
+		}
+	}
+
+	return ret;
+}
+
+
+
+CLuaProfiler& CLuaProfiler::GetInstance()
+{
+	static CLuaProfiler instance;
+	return instance;
+}
+
+
+CLuaProfiler::ScopedSample::ScopedSample(lua_State* _L, const std::string& handleName, const char* callInName, int numInArgs)
+	: L(_L)
+	, handle(&handleName)
+	, callIn(callInName)
+	, startBytes(0)
+	, active(luaProfiler.IsEnabled())
+{
+	if (!active)
+		return;
+
+	lua_Debug ar;
+
+	// the function about to be called sits below its arguments
+	lua_pushvalue(L, -(numInArgs + 1));
+
+	if (lua_isfunction(L, -1)) {
+		// pops the function
+		lua_getinfo(L, ">S", &ar);
+		snprintf(function, sizeof(function), "%s:%d", ar.short_src, ar.linedefined);
+	} else {
+		lua_pop(L, 1);
+		CopyName(function, sizeof(function), "?");
+	}
+
+	startBytes = GetAllocatedBytes(L);
+	startTime = spring_gettime();
+}
+
+CLuaProfiler::ScopedSample::~ScopedSample() { Finish(); }
+
+void CLuaProfiler::ScopedSample::Finish()
+{
+	if (!active)
+		return;
+
+	Sample s;
+
+	s.startTime = startTime;
+	s.deltaTime = spring_gettime() - startTime;
+	s.allocBytes = GetAllocatedBytes(L) - startBytes;
+	s.drawFrame = globalRendering->drawFrame;
+
+	CopyName(s.handle, sizeof(s.handle), handle->c_str());
+	CopyName(s.callIn, sizeof(s.callIn), callIn);
+	CopyName(s.function, sizeof(s.function), function);
+
+	luaProfiler.AddSample(s);
+	active = false;
+}
+
+
+
+void CLuaProfiler::SetEnabled(bool b)
+{
+	// allocated once and never resized, so writers need no lock
+	if (b && samples.empty())
+		samples.resize(NUM_SAMPLES);
+
+	enabled.store(b);
+}
+
+void CLuaProfiler::Clear()
+{
+	numSamples.store(0);
+}
+
+void CLuaProfiler::AddSample(const Sample& s)
+{
+	samples[numSamples.fetch_add(1) % NUM_SAMPLES] = s;
+}
+
+void CLuaProfiler::GetSamples(std::vector<Sample>& v) const
+{
+	const unsigned int n = numSamples.load();
+	const unsigned int k = std::min(n, NUM_SAMPLES);
+
+	v.clear();
+	v.reserve(k);
+
+	// oldest first; samples written concurrently with a running profiler can be mixed up
+	for (unsigned int i = n - k; i != n; i++) {
+		v.push_back(samples[i % NUM_SAMPLES]);
+	}
+}
+
+
+void CLuaProfiler::PrintProfilingInfo(size_t maxEntries) const
+{
+	struct Entry {
+		std::string name;
+
+		spring_time totalTime;
+		spring_time peakTime;
+		std::int64_t allocBytes = 0;
+		unsigned int numCalls = 0;
+
+		unsigned int lastFrame = -1u;
+		spring_time frameTime;
+
+		// frames whose summed time was below 0.1, 0.5, 1, 2, 4, 8, 16 and above 16ms
+		unsigned int histogram[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+	};
+
+	static constexpr float bucketLimits[] = {0.1f, 0.5f, 1.0f, 2.0f, 4.0f, 8.0f, 16.0f};
+
+	const auto AddFrameTime = [&](Entry& e) {
+		if (e.lastFrame == -1u)
+			return;
+
+		const float ms = e.frameTime.toMilliSecsf();
+		const auto iter = std::upper_bound(std::begin(bucketLimits), std::end(bucketLimits), ms);
+
+		e.histogram[iter - std::begin(bucketLimits)] += 1;
+	};
+
+	std::vector<Sample> v;
+	std::vector<Entry> entries;
+	spring::unordered_map<std::string, size_t> entryIndices;
+
+	GetSamples(v);
+
+	for (const Sample& s: v) {
+		const std::string key = std::string(s.handle) + "::" + s.callIn + " (" + s.function + ")";
+		const auto iter = entryIndices.find(key);
+
+		if (iter == entryIndices.end()) {
+			entryIndices[key] = entries.size();
+			entries.emplace_back();
+			entries.back().name = key;
+		}
+
+		Entry& e = entries[entryIndices[key]];
+
+		e.totalTime += s.deltaTime;
+		e.peakTime = std::max(e.peakTime, s.deltaTime);
+		e.allocBytes += s.allocBytes;
+		e.numCalls += 1;
+
+		// samples are ordered by time, so a new frame ends the previous one
+		if (s.drawFrame != e.lastFrame) {
+			AddFrameTime(e);
+
+			e.lastFrame = s.drawFrame;
+			e.frameTime = spring_notime;
+		}
+
+		e.frameTime += s.deltaTime;
+	}
+
+	for (Entry& e: entries) {
+		AddFrameTime(e);
+	}
+
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) { return (a.totalTime > b.totalTime); });
+
+	LOG("[LuaProfiler::%s] %u samples (%u kept), histogram of per-frame times {<0.1,<0.5,<1,<2,<4,<8,<16,>=16}ms", __func__, numSamples.load(), unsigned(v.size()));
+
+	for (size_t i = 0, n = std::min(entries.size(), maxEntries); i < n; i++) {
+		const Entry& e = entries[i];
+		const unsigned int* h = &e.histogram[0];
+
+		LOG(
+			"\t%s: calls=%u total=%.2fms peak=%.2fms alloc=%.1fKB frames={%u,%u,%u,%u,%u,%u,%u,%u}",
+			e.name.c_str(), e.numCalls,
+			e.totalTime.toMilliSecsf(), e.peakTime.toMilliSecsf(), e.allocBytes / 1024.0f,
+			h[0], h[1], h[2], h[3], h[4], h[5], h[6], h[7]
+		);
+	}
+}
+
+
+void CLuaProfiler::GetCallInTimes(spring_time beginTime, spring_time endTime, std::vector<CallInTime>& callInTimes) const
+{
+	spring::unordered_map<std::string, size_t> indices;
+
+	const unsigned int n = numSamples.load();
+	const unsigned int k = std::min(n, NUM_SAMPLES);
+
+	callInTimes.clear();
+
+	// newest first, stop at the first sample older than the interval
+	for (unsigned int i = n; i != (n - k); i--) {
+		const Sample& s = samples[(i - 1) % NUM_SAMPLES];
+
+		if (s.startTime < beginTime)
+			break;
+		if (s.startTime > endTime)
+			continue;
+
+		const std::string key = std::string(s.handle) + "::" + s.callIn + " (" + s.function + ")";
+		const auto iter = indices.find(key);
+
+		if (iter == indices.end()) {
+			indices[key] = callInTimes.size();
+			callInTimes.push_back({key, spring_notime, 0});
+		}
+
+		CallInTime& c = callInTimes[indices[key]];
+
+		c.totalTime += s.deltaTime;
+		c.numCalls += 1;
+	}
+
+	std::sort(callInTimes.begin(), callInTimes.end(), [](const CallInTime& a, const CallInTime& b) { return (a.totalTime > b.totalTime); });
+}
+
+
+bool CLuaProfiler::WriteTrace(const std::string& fileName) const
+{
+	std::ofstream file(dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE | FileQueryFlags::CREATE_DIRS));
+
+	if (!file.is_open())
+		return false;
+
+	std::vector<Sample> v;
+	std::vector< std::deque< std::pair<spring_time, spring_time> > > threadSpans;
+
+	GetSamples(v);
+	profiler.GetThreadProfile(threadSpans);
+
+	const char* sep = "";
+
+	file << "{\"traceEvents\":[\n";
+
+	// Lua call-ins on tid 0, ThreadPool activity (from CTimeProfiler) on tid 1+
+	for (const Sample& s: v) {
+		file << sep << "{\"name\":\"" << EscapeJSON(s.callIn) << "\",\"cat\":\"" << EscapeJSON(s.handle) << "\",\"ph\":\"X\"";
+		file << ",\"ts\":" << s.startTime.toMicroSecsi() << ",\"dur\":" << s.deltaTime.toMicroSecsi() << ",\"pid\":0,\"tid\":0";
+		file << ",\"args\":{\"function\":\"" << EscapeJSON(s.function) << "\",\"allocBytes\":" << s.allocBytes << ",\"drawFrame\":" << s.drawFrame << "}}";
+		sep = ",\n";
+	}
+
+	for (size_t i = 0; i < threadSpans.size(); i++) {
+		for (const auto& span: threadSpans[i]) {
+			file << sep << "{\"name\":\"ThreadPool\",\"cat\":\"engine\",\"ph\":\"X\"";
+			file << ",\"ts\":" << span.first.toMicroSecsi() << ",\"dur\":" << (span.second - span.first).toMicroSecsi();
+			file << ",\"pid\":0,\"tid\":" << (i + 1) << "}";
+			sep = ",\n";
+		}
+	}
+
+	file << "\n]}\n";
+	return (file.good());
+}
@@ -0,0 +1,96 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_PROFILER_H
+#define LUA_PROFILER_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+
+struct lua_State;
+
+/**
+ * Opt-in profiler for Lua call-ins; records one sample per call-in run by
+ * CLuaHandle::RunCallInTraceback (wall time, bytes allocated and the Lua
+ * function that handled it) into a ring-buffer that writers claim slots in
+ * atomically. When disabled the only cost per call-in is one atomic load.
+ */
+class CLuaProfiler
+{
+public:
+	static CLuaProfiler& GetInstance();
+
+	struct Sample {
+		char handle[32];
+		char callIn[32];
+		char function[64];
+
+		spring_time startTime;
+		spring_time deltaTime;
+
+		std::int64_t allocBytes;
+		unsigned int drawFrame;
+	};
+
+	struct CallInTime {
+		std::string name; // handle::callIn (function)
+
+		spring_time totalTime;
+		unsigned int numCalls;
+	};
+
+	struct ScopedSample {
+	public:
+		ScopedSample(lua_State* L, const std::string& handleName, const char* callInName, int numInArgs);
+		~ScopedSample();
+
+		// the sample's delta-time includes everything up to this call
+		void Finish();
+
+	private:
+		lua_State* L;
+
+		const std::string* handle;
+		const char* callIn;
+
+		char function[64];
+
+		spring_time startTime;
+		std::int64_t startBytes;
+
+		bool active;
+	};
+
+public:
+	bool IsEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+	void SetEnabled(bool b);
+	void Clear();
+
+	void AddSample(const Sample& s);
+
+	/// logs the callins with the largest total time, with a histogram of their per-frame times
+	void PrintProfilingInfo(size_t maxEntries) const;
+	/// writes all samples (and ThreadPool activity) in the Chrome trace-event JSON format
+	bool WriteTrace(const std::string& fileName) const;
+	/// sums the samples started within [beginTime, endTime] per call-in and function, most expensive first
+	void GetCallInTimes(spring_time beginTime, spring_time endTime, std::vector<CallInTime>& callInTimes) const;
+
+private:
+	void GetSamples(std::vector<Sample>& samples) const;
+
+private:
+	static constexpr unsigned int NUM_SAMPLES = 1 << 16;
+
+	std::vector<Sample> samples;
+	std::atomic<unsigned int> numSamples = {0};
+
+	std::atomic<bool> enabled = {false};
+};
+
+#define luaProfiler (CLuaProfiler::GetInstance())
+
+#endif // LUA_PROFILER_H
@@ -28,11 +28,14 @@ namespace LuaRulesParams
 	struct Param {
 		CR_DECLARE_STRUCT(Param)
 
-		Param() : los(RULESPARAMLOS_PRIVATE),valueInt(0.0f) {};
+		Param() : los(RULESPARAMLOS_PRIVATE),valueInt(0.0f),changeFrame(0) {};
 
 		int   los;
 		float valueInt;
 		std::string valueString;
+
+		//! last sim-frame in which the value or los of this param changed
+		int changeFrame;
 	};
 
 	typedef spring::unordered_map<std::string, Param> Params;
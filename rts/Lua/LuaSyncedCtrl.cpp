@@ -2,6 +2,7 @@
 
 #include <vector>
 #include <cctype>
+#include <cstring>
 
 #include "LuaSyncedCtrl.h"
 
@@ -38,12 +39,14 @@
 #include "Sim/Misc/DamageArrayHandler.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/ModInfo.h"
+#include "Sim/Misc/SimCostProfiler.h"
 #include "Sim/Misc/SmoothHeightMesh.h"
 #include "Sim/Misc/Team.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/BuildingMaskMap.h"
 #include "Sim/MoveTypes/AAirMoveType.h"
+#include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #include "Sim/Path/IPathManager.h"
 #include "Sim/Projectiles/ExplosionGenerator.h"
 #include "Sim/Projectiles/Projectile.h"
@@ -318,6 +321,10 @@ bool LuaSyncedCtrl::PushEntries(lua_State* L)
 
 	REGISTER_LUA_CFUNC(SetRadarErrorParams);
 
+	REGISTER_LUA_CFUNC(IsSimCostProfilerEnabled);
+	REGISTER_LUA_CFUNC(BeginSimCostScope);
+	REGISTER_LUA_CFUNC(EndSimCostScope);
+
 	if (!LuaSyncedMoveCtrl::PushMoveCtrl(L))
 		return false;
 
@@ -970,19 +977,44 @@ void SetRulesParam(lua_State* L, const char* caller, int offset,
 	const int valIndex = offset + 2;
 	const int losIndex = offset + 3;
 
-	const string key = luaL_checkstring(L, index);
+	// reused so that updating an existing param does not allocate
+	static std::string key;
+
+	size_t keyLen = 0;
+	const char* keyStr = luaL_checklstring(L, index, &keyLen);
+
+	key.assign(keyStr, keyLen);
+
+	if (lua_isnoneornil(L, valIndex)) {
+		params.erase(key);
+		return; //no need to set los if param was erased
+	}
+
+	const size_t numParams = params.size();
 
 	LuaRulesParams::Param& param = params[key];
 
+	const int prevLos = param.los;
+	const float prevValueInt = param.valueInt;
+
+	bool changed = (params.size() != numParams);
+
 	//! set the value of the parameter
 	if (lua_isnumber(L, valIndex)) {
 		param.valueInt = lua_tofloat(L, valIndex);
-		param.valueString.resize(0);
+
+		changed |= (param.valueInt != prevValueInt);
+		changed |= (!param.valueString.empty());
+
+		param.valueString.clear();
 	} else if (lua_isstring(L, valIndex)) {
-		param.valueString = lua_tostring(L, valIndex);
-	} else if (lua_isnoneornil(L, valIndex)) {
-		params.erase(key);
-		return; //no need to set los if param was erased
+		size_t valLen = 0;
+		const char* valStr = lua_tolstring(L, valIndex, &valLen);
+
+		if (param.valueString.size() != valLen || param.valueString.compare(0, valLen, valStr, valLen) != 0) {
+			param.valueString.assign(valStr, valLen);
+			changed = true;
+		}
 	} else {
 		luaL_error(L, "Incorrect arguments to %s()", caller);
 	}
@@ -1000,18 +1032,18 @@ void SetRulesParam(lua_State* L, const char* caller, int offset,
 
 			//! read the losType from the key
 			if (lua_isstring(L, -2)) {
-				const string losType = lua_tostring(L, -2);
+				const char* losType = lua_tostring(L, -2);
 
-				if (losType == "public") {
+				if (strcmp(losType, "public") == 0) {
 					losMask |= LuaRulesParams::RULESPARAMLOS_PUBLIC;
 				}
-				else if (losType == "inlos") {
+				else if (strcmp(losType, "inlos") == 0) {
 					losMask |= LuaRulesParams::RULESPARAMLOS_INLOS;
 				}
-				else if (losType == "inradar") {
+				else if (strcmp(losType, "inradar") == 0) {
 					losMask |= LuaRulesParams::RULESPARAMLOS_INRADAR;
 				}
-				else if (losType == "allied") {
+				else if (strcmp(losType, "allied") == 0) {
 					losMask |= LuaRulesParams::RULESPARAMLOS_ALLIED;
 				}
 				/*else if (losType == "private") {
@@ -1025,7 +1057,9 @@ void SetRulesParam(lua_State* L, const char* caller, int offset,
 		param.los = luaL_optint(L, losIndex, param.los);
 	}
 
-	return;
+	//! let readers skip params that did not change since their last poll
+	if (changed || param.los != prevLos)
+		param.changeFrame = gs->frameNum;
 }
 
 
@@ -3980,6 +4014,7 @@ int LuaSyncedCtrl::SetMapSquareTerrainType(lua_State* L)
 	const int ntt = luaL_checkint(L, 3);
 
 	readMap->GetTypeMapSynced()[tz * mapDims.hmapx + tx] = std::max(0, std::min(ntt, (CMapInfo::NUM_TERRAIN_TYPES - 1)));
+	CMoveMath::UpdateSpeedModMaps(hx, hz, hx, hz);
 	pathManager->TerrainChange(hx, hz,  hx + 1, hz + 1,  TERRAINCHANGE_SQUARE_TYPEMAP_INDEX);
 
 	lua_pushnumber(L, ott);
@@ -4016,8 +4051,10 @@ int LuaSyncedCtrl::SetTerrainTypeData(lua_State* L)
 	// hardness changes do not require repathing
 	if (ttHardnessChanged)
 		mapDamage->TerrainTypeHardnessChanged(tti);
-	if (ttSpeedModChanged)
+	if (ttSpeedModChanged) {
+		CMoveMath::UpdateSpeedModMaps(0, 0, mapDims.mapxm1, mapDims.mapym1);
 		mapDamage->TerrainTypeSpeedModChanged(tti);
+	}
 
 	lua_pushboolean(L, true);
 	return 1;
@@ -4628,5 +4665,30 @@ int LuaSyncedCtrl::RemoveUnitCmdDesc(lua_State* L)
 }
 
 
+/******************************************************************************/
+
+// local state; the gadget handler only uses it to decide whether to wrap
+// gadget call-ins in {Begin,End}SimCostScope, which never affect the game
+int LuaSyncedCtrl::IsSimCostProfilerEnabled(lua_State* L)
+{
+	lua_pushboolean(L, simCostProfiler.IsEnabled());
+	return 1;
+}
+
+int LuaSyncedCtrl::BeginSimCostScope(lua_State* L)
+{
+	lua_pushnumber(L, simCostProfiler.BeginGadgetScope(luaL_checkstring(L, 1)));
+	return 1;
+}
+
+int LuaSyncedCtrl::EndSimCostScope(lua_State* L)
+{
+	simCostProfiler.EndGadgetScope(luaL_checkint(L, 1));
+
+	// pass the remaining arguments (the wrapped call-in's results) through
+	return (lua_gettop(L) - 1);
+}
+
+
 /******************************************************************************/
 /******************************************************************************/
@@ -200,6 +200,10 @@ class LuaSyncedCtrl
 		static int SetExperienceGrade(lua_State* L);
 
 		static int SetRadarErrorParams(lua_State* L);
+
+		static int IsSimCostProfilerEnabled(lua_State* L);
+		static int BeginSimCostScope(lua_State* L);
+		static int EndSimCostScope(lua_State* L);
 };
 
 
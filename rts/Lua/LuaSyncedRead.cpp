@@ -69,10 +69,14 @@
 #include "System/myMath.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/FrameArena.h"
 #include "System/StringUtil.h"
 
+#include <algorithm>
+#include <array>
 #include <map>
 #include <cctype>
+#include <cstring>
 
 
 using std::min;
@@ -210,6 +214,7 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetUnitDirection);
 	REGISTER_LUA_CFUNC(GetUnitHeading);
 	REGISTER_LUA_CFUNC(GetUnitVelocity);
+	REGISTER_LUA_CFUNC(GetUnitsData);
 	REGISTER_LUA_CFUNC(GetUnitBuildFacing);
 	REGISTER_LUA_CFUNC(GetUnitIsBuilding);
 	REGISTER_LUA_CFUNC(GetUnitCurrentBuildPower);
@@ -733,8 +738,12 @@ static inline CTeam* ParseTeam(lua_State* L, const char* caller, int index)
 
 static int PushRulesParams(lua_State* L, const char* caller,
                           const LuaRulesParams::Params& params,
-                          const int losStatus)
+                          const int losStatus,
+                          const int sinceFrameIndex)
 {
+	// optional; only params that changed in or after this frame are returned
+	const int sinceFrame = luaL_optint(L, sinceFrameIndex, 0);
+
 	lua_createtable(L, 0, params.size());
 
 	for (auto& it: params) {
@@ -742,6 +751,8 @@ static int PushRulesParams(lua_State* L, const char* caller,
 		const LuaRulesParams::Param& param = it.second;
 		if (!(param.los & losStatus))
 			continue;
+		if (param.changeFrame < sinceFrame)
+			continue;
 
 		if (!param.valueString.empty()) {
 			LuaPushNamedString(L, name, param.valueString);
@@ -758,7 +769,14 @@ static int GetRulesParam(lua_State* L, const char* caller, int index,
                           const LuaRulesParams::Params& params,
                           const int& losStatus)
 {
-	const std::string& key = luaL_checkstring(L, index);
+	// reused so that polling a param does not allocate
+	static std::string key;
+
+	size_t keyLen = 0;
+	const char* keyStr = luaL_checklstring(L, index, &keyLen);
+
+	key.assign(keyStr, keyLen);
+
 	const auto it = params.find(key);
 	if (it == params.end())
 		return 0;
@@ -904,7 +922,7 @@ int LuaSyncedRead::GetWind(lua_State* L)
 int LuaSyncedRead::GetGameRulesParams(lua_State* L)
 {
 	// always readable for all
-	return PushRulesParams(L, __func__, CLuaHandleSynced::GetGameParams(), LuaRulesParams::RULESPARAMLOS_PRIVATE_MASK);
+	return PushRulesParams(L, __func__, CLuaHandleSynced::GetGameParams(), LuaRulesParams::RULESPARAMLOS_PRIVATE_MASK, 1);
 }
 
 
@@ -1293,7 +1311,7 @@ int LuaSyncedRead::GetTeamRulesParams(lua_State* L)
 		losMask |= LuaRulesParams::RULESPARAMLOS_ALLIED_MASK;
 	}
 
-	return PushRulesParams(L, __func__, team->modParams, losMask);
+	return PushRulesParams(L, __func__, team->modParams, losMask, 2);
 }
 
 
@@ -1805,7 +1823,7 @@ int LuaSyncedRead::GetTeamUnitsCounts(lua_State* L)
 	}
 
 	// tally the counts for enemies
-	std::vector< std::pair<int, int> > unitDefCounts;
+	FrameVector< std::pair<int, int> > unitDefCounts;
 	unitDefCounts.resize(unitDefHandler->unitDefs.size() + 1, {0, 0});
 
 	for (const CUnit* unit: team->units) {
@@ -1843,7 +1861,7 @@ int LuaSyncedRead::GetTeamUnitsCounts(lua_State* L)
 }
 
 
-static inline void InsertSearchUnitDefs(const UnitDef* ud, bool allied, std::vector<int>& unitDefIDs)
+static inline void InsertSearchUnitDefs(const UnitDef* ud, bool allied, FrameVector<int>& unitDefIDs)
 {
 	if (ud == nullptr)
 		return;
@@ -1886,7 +1904,7 @@ int LuaSyncedRead::GetTeamUnitsByDefs(lua_State* L)
 	const bool allied = IsAlliedTeam(L, teamID);
 
 	// parse the unitDefs
-	std::vector<int> unitDefIDs;
+	FrameVector<int> unitDefIDs;
 
 	if (lua_isnumber(L, 2)) {
 		InsertSearchUnitDefs(unitDefHandler->GetUnitDefByID(lua_toint(L, 2)), allied, unitDefIDs);
@@ -3001,6 +3019,233 @@ int LuaSyncedRead::GetUnitVelocity(lua_State* L)
 }
 
 
+/*
+ * Spring.GetUnitsData({unitIDs...}, {fieldNames...}[, resultTable]) -> resultTable
+ *
+ * resultTable[fieldName] is an array with one entry per unitID (or three
+ * for vector fields, stored flat at [3*i-2, 3*i]); entries for units the
+ * caller may not read (same rules as the Spring.GetUnit* equivalents) are
+ * false. Passing the previous result back in reuses its arrays.
+ */
+int LuaSyncedRead::GetUnitsData(lua_State* L)
+{
+	enum {
+		UNIT_DATA_DEFID,
+		UNIT_DATA_TEAM,
+		UNIT_DATA_ALLYTEAM,
+		UNIT_DATA_POS,
+		UNIT_DATA_MIDPOS,
+		UNIT_DATA_AIMPOS,
+		UNIT_DATA_VEL,
+		UNIT_DATA_SPEED,
+		UNIT_DATA_DIR,
+		UNIT_DATA_HEADING,
+		UNIT_DATA_HEALTH,
+		UNIT_DATA_MAXHEALTH,
+		UNIT_DATA_BUILDPROGRESS,
+		UNIT_DATA_RADIUS,
+		UNIT_DATA_HEIGHT,
+		UNIT_DATA_COUNT,
+	};
+
+	static const std::array<std::pair<const char*, int>, UNIT_DATA_COUNT> fieldNames = {{
+		{"defID"        , 1},
+		{"team"         , 1},
+		{"allyTeam"     , 1},
+		{"pos"          , 3},
+		{"midPos"       , 3},
+		{"aimPos"       , 3},
+		{"vel"          , 3},
+		{"speed"        , 1},
+		{"dir"          , 3},
+		{"heading"      , 1},
+		{"health"       , 1},
+		{"maxHealth"    , 1},
+		{"buildProgress", 1},
+		{"radius"       , 1},
+		{"height"       , 1},
+	}};
+
+	luaL_checktype(L, 1, LUA_TTABLE);
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	const int numUnits = lua_objlen(L, 1);
+	const int numFields = std::min(int(lua_objlen(L, 2)), int(UNIT_DATA_COUNT));
+
+	if (!lua_istable(L, 3)) {
+		lua_settop(L, 2);
+		lua_createtable(L, 0, numFields);
+	} else {
+		lua_settop(L, 3);
+	}
+
+	luaL_checkstack(L, numFields + 4, __func__);
+
+	// <fields> holds the field type per array, which are kept above the result table
+	std::array<int, UNIT_DATA_COUNT> fields;
+
+	for (int i = 0; i < numFields; i++) {
+		lua_rawgeti(L, 2, i + 1);
+
+		const char* name = luaL_checkstring(L, -1);
+		const auto pred = [&](const std::pair<const char*, int>& p) { return (strcmp(p.first, name) == 0); };
+		const auto iter = std::find_if(fieldNames.begin(), fieldNames.end(), pred);
+
+		if (iter == fieldNames.end())
+			luaL_error(L, "[%s] unknown field \"%s\"", __func__, name);
+
+		fields[i] = iter - fieldNames.begin();
+
+		// reuse the array from a previous call if there is one
+		lua_pushvalue(L, -1);
+		lua_rawget(L, 3);
+
+		if (!lua_istable(L, -1)) {
+			lua_pop(L, 1);
+			lua_createtable(L, numUnits * fieldNames[fields[i]].second, 0);
+			lua_pushvalue(L, -2);
+			lua_pushvalue(L, -2);
+			lua_rawset(L, 3);
+		}
+
+		// drop the name, leaving the array at index 4 + i
+		lua_remove(L, -2);
+	}
+
+	const auto SetNumber = [&](int fieldIdx, int slot, float value) {
+		lua_pushnumber(L, value);
+		lua_rawseti(L, 4 + fieldIdx, slot);
+	};
+	const auto SetFalse = [&](int fieldIdx, int slot, int count) {
+		for (int k = 0; k < count; k++) {
+			lua_pushboolean(L, false);
+			lua_rawseti(L, 4 + fieldIdx, slot + k);
+		}
+	};
+	const auto SetVector = [&](int fieldIdx, int slot, const float3& v) {
+		SetNumber(fieldIdx, slot + 0, v.x);
+		SetNumber(fieldIdx, slot + 1, v.y);
+		SetNumber(fieldIdx, slot + 2, v.z);
+	};
+
+	const int readAllyTeam = CLuaHandle::GetHandleReadAllyTeam(L);
+	const bool fullRead = CLuaHandle::GetHandleFullRead(L);
+
+	for (int i = 0; i < numUnits; i++) {
+		lua_rawgeti(L, 1, i + 1);
+		const CUnit* unit = lua_isnumber(L, -1)? unitHandler->GetUnit(lua_toint(L, -1)): nullptr;
+		lua_pop(L, 1);
+
+		const bool isVisible = (unit != nullptr && IsUnitVisible(L, unit));
+		const bool isAllied  = (isVisible && IsAllyUnit(L, unit));
+		const bool isInLos   = (isVisible && ::IsUnitInLos(L, unit));
+		const bool isTyped   = (isVisible && IsUnitTyped(L, unit));
+
+		float3 errorVec;
+
+		if (isVisible && !isAllied)
+			errorVec = unit->GetLuaErrorVector(readAllyTeam, fullRead);
+
+		for (int j = 0; j < numFields; j++) {
+			const int numSlots = fieldNames[fields[j]].second;
+			const int slot = i * numSlots + 1;
+
+			switch (fields[j]) {
+				case UNIT_DATA_DEFID: {
+					if (!isTyped) { SetFalse(j, slot, numSlots); break; }
+					SetNumber(j, slot, EffectiveUnitDef(L, unit)->id);
+				} break;
+				case UNIT_DATA_TEAM: {
+					if (!isVisible) { SetFalse(j, slot, numSlots); break; }
+					SetNumber(j, slot, unit->team);
+				} break;
+				case UNIT_DATA_ALLYTEAM: {
+					if (!isVisible) { SetFalse(j, slot, numSlots); break; }
+					SetNumber(j, slot, unit->allyteam);
+				} break;
+
+				case UNIT_DATA_POS: {
+					if (!isVisible) { SetFalse(j, slot, numSlots); break; }
+					SetVector(j, slot, unit->pos + errorVec);
+				} break;
+				case UNIT_DATA_MIDPOS: {
+					if (!isVisible) { SetFalse(j, slot, numSlots); break; }
+					SetVector(j, slot, unit->midPos + errorVec);
+				} break;
+				case UNIT_DATA_AIMPOS: {
+					if (!isVisible) { SetFalse(j, slot, numSlots); break; }
+					SetVector(j, slot, unit->aimPos + errorVec);
+				} break;
+
+				case UNIT_DATA_VEL: {
+					if (!isInLos) { SetFalse(j, slot, numSlots); break; }
+					SetVector(j, slot, unit->speed);
+				} break;
+				case UNIT_DATA_SPEED: {
+					if (!isInLos) { SetFalse(j, slot, numSlots); break; }
+					SetNumber(j, slot, unit->speed.w);
+				} break;
+				case UNIT_DATA_DIR: {
+					if (!isInLos) { SetFalse(j, slot, numSlots); break; }
+					SetVector(j, slot, unit->frontdir);
+				} break;
+				case UNIT_DATA_HEADING: {
+					if (!isInLos) { SetFalse(j, slot, numSlots); break; }
+					SetNumber(j, slot, unit->heading);
+				} break;
+
+				case UNIT_DATA_HEALTH:
+				case UNIT_DATA_MAXHEALTH: {
+					const UnitDef* ud = isInLos? unit->unitDef: nullptr;
+
+					// same rules as GetUnitHealth
+					if (ud == nullptr || (ud->hideDamage && !isAllied)) {
+						SetFalse(j, slot, numSlots);
+						break;
+					}
+
+					const float scale = (isAllied || ud->decoyDef == nullptr)? 1.0f: (ud->decoyDef->health / ud->health);
+					const float value = (fields[j] == UNIT_DATA_HEALTH)? unit->health: unit->maxHealth;
+
+					SetNumber(j, slot, value * scale);
+				} break;
+				case UNIT_DATA_BUILDPROGRESS: {
+					if (!isInLos) { SetFalse(j, slot, numSlots); break; }
+					SetNumber(j, slot, unit->buildProgress);
+				} break;
+
+				case UNIT_DATA_RADIUS: {
+					if (!isTyped) { SetFalse(j, slot, numSlots); break; }
+					SetNumber(j, slot, unit->radius);
+				} break;
+				case UNIT_DATA_HEIGHT: {
+					if (!isTyped) { SetFalse(j, slot, numSlots); break; }
+					SetNumber(j, slot, unit->height);
+				} break;
+
+				default: {
+					assert(false);
+				} break;
+			}
+		}
+	}
+
+	// clear entries left over from a previous (larger) call
+	for (int j = 0; j < numFields; j++) {
+		const int numSlots = fieldNames[fields[j]].second;
+		const int prevSize = lua_objlen(L, 4 + j);
+
+		for (int k = prevSize; k > numUnits * numSlots; k--) {
+			lua_pushnil(L);
+			lua_rawseti(L, 4 + j, k);
+		}
+	}
+
+	lua_settop(L, 3);
+	return 1;
+}
+
+
 int LuaSyncedRead::GetUnitBuildFacing(lua_State* L)
 {
 	CUnit* unit = ParseInLosUnit(L, __func__, 1);
@@ -4313,7 +4558,7 @@ int LuaSyncedRead::GetUnitRulesParams(lua_State* L)
 
 	const LuaRulesParams::Params&  params = unit->modParams;
 
-	return PushRulesParams(L, __func__, params, losMask);
+	return PushRulesParams(L, __func__, params, losMask, 2);
 }
 
 
@@ -4677,7 +4922,7 @@ int LuaSyncedRead::GetFeatureRulesParams(lua_State* L)
 
 	const LuaRulesParams::Params&  params = feature->modParams;
 
-	return PushRulesParams(L, __func__, params, losMask);
+	return PushRulesParams(L, __func__, params, losMask, 2);
 }
 
 
@@ -16,6 +16,7 @@
 #include "LuaInterCall.h"
 #include "LuaUnsyncedRead.h"
 #include "LuaUICommand.h"
+#include "LuaWorkers.h"
 #include "LuaFeatureDefs.h"
 #include "LuaUnitDefs.h"
 #include "LuaWeaponDefs.h"
@@ -182,6 +183,7 @@ CLuaUI::CLuaUI()
 	    !AddEntriesToTable(L, "Spring",      LuaUnsyncedCtrl::PushEntries)      ||
 	    !AddEntriesToTable(L, "Spring",      LuaUnsyncedRead::PushEntries)      ||
 	    !AddEntriesToTable(L, "Spring",      LuaUICommand::PushEntries)         ||
+	    !AddEntriesToTable(L, "Spring",      LuaWorkers::PushEntries)           ||
 	    !AddEntriesToTable(L, "gl",          LuaOpenGL::PushEntries)            ||
 	    !AddEntriesToTable(L, "GL",          LuaConstGL::PushEntries)           ||
 	    !AddEntriesToTable(L, "Engine",      LuaConstEngine::PushEntries)       ||
@@ -51,6 +51,11 @@ static int WeaponsTable(lua_State* L, const void* data);
 static int CategorySetFromBits(lua_State* L, const void* data);
 static int CategorySetFromString(lua_State* L, const void* data);
 
+// built once per state, see LuaUtils::PushCachedDefTable
+static int CachedCustomParamsTable(lua_State* L, const void* data) { return LuaUtils::PushCachedDefTable(L, data, CustomParamsTable); }
+static int CachedBuildOptions(lua_State* L, const void* data) { return LuaUtils::PushCachedDefTable(L, data, BuildOptions); }
+static int CachedWeaponsTable(lua_State* L, const void* data) { return LuaUtils::PushCachedDefTable(L, data, WeaponsTable); }
+
 
 /******************************************************************************/
 /******************************************************************************/
@@ -77,15 +82,20 @@ bool LuaUnitDefs::PushEntries(lua_State* L)
 	const std::array<const IndxFuncType, 3> indxFuncs = {{UnitDefIndex, UnitDefNewIndex, UnitDefMetatable}};
 	const std::array<const IterFuncType, 2> iterFuncs = {{Pairs, Next}};
 
+	const int defsTableIdx = lua_gettop(L);
+	const int metaTableIdx = PushObjectDefProxyMetaTable(L, indxOpers, indxFuncs);
+
 	for (auto it = defsMap.cbegin(); it != defsMap.cend(); ++it) {
 		const auto def = unitDefHandler->GetUnitDefByID(it->second);
 
 		if (def == nullptr)
 			continue;
 
-		PushObjectDefProxyTable(L, indxOpers, iterOpers, indxFuncs, iterFuncs, def);
+		PushObjectDefProxyTable(L, iterOpers, iterFuncs, def, defsTableIdx, metaTableIdx);
 	}
 
+	// pop the metatable and proxy-to-def table
+	lua_pop(L, 2);
 	return true;
 }
 
@@ -110,7 +120,7 @@ static int UnitDefIndex(lua_State* L)
 	  return 1;
 	}
 
-	const void* userData = lua_touserdata(L, lua_upvalueindex(1));
+	const void* userData = GetObjectDefProxyData(L);
 	const UnitDef* ud = static_cast<const UnitDef*>(userData);
 	const DataElement& elem = it->second;
 	const void* p = ((const char*)ud) + elem.offset;
@@ -166,7 +176,7 @@ static int UnitDefNewIndex(lua_State* L)
 		return 0;
 	}
 
-	const void* userData = lua_touserdata(L, lua_upvalueindex(1));
+	const void* userData = GetObjectDefProxyData(L);
 	const UnitDef* ud = static_cast<const UnitDef*>(userData);
 
 	// write-protected
@@ -215,7 +225,7 @@ static int UnitDefNewIndex(lua_State* L)
 static int UnitDefMetatable(lua_State* L)
 {
 	lua_touserdata(L, lua_upvalueindex(1));
-	// const void* userData = lua_touserdata(L, lua_upvalueindex(1));
+	// const void* userData = GetObjectDefProxyData(L);
 	// const UnitDef* ud = (const UnitDef*)userData;
 	return 0;
 }
@@ -444,6 +454,7 @@ static int MoveDefTable(lua_State* L, const void* data)
 		return 1;
 
 	HSTR_PUSH_NUMBER(L, "id", md->pathType);
+	HSTR_PUSH_NUMBER(L, "pathLayer", md->pathLayer);
 
 	// TODO: remove after 102
 	switch (md->speedModClass) {
@@ -605,10 +616,10 @@ ADD_BOOL("canAttackWater",  canAttackWater); // CUSTOM
 	ADD_FUNCTION("springCategories",   ud.category,        CategorySetFromBits);
 	ADD_FUNCTION("noChaseCategories",  ud.noChaseCategory, CategorySetFromBits);
 
-	ADD_FUNCTION("customParams",       ud.customParams,       CustomParamsTable);
-	ADD_FUNCTION("buildOptions",       ud.buildOptions,       BuildOptions);
+	ADD_FUNCTION("customParams",       ud.customParams,       CachedCustomParamsTable);
+	ADD_FUNCTION("buildOptions",       ud.buildOptions,       CachedBuildOptions);
 	ADD_FUNCTION("decoyDef",           ud.decoyDef,           UnitDefToID);
-	ADD_FUNCTION("weapons",            ud.weapons,            WeaponsTable);
+	ADD_FUNCTION("weapons",            ud.weapons,            CachedWeaponsTable);
 	ADD_FUNCTION("sounds",             ud.sounds,             SoundsTable);
 	ADD_FUNCTION("model",              ud,                    ModelTable);
 	ADD_FUNCTION("moveDef",            ud.pathType,           MoveDefTable);
@@ -15,6 +15,7 @@
 #include "Game/Camera.h"
 #include "Game/CameraHandler.h"
 #include "Game/Camera/CameraController.h"
+#include "Game/DemoBatch.h"
 #include "Game/GameSetup.h"
 #include "Game/GlobalUnsynced.h"
 #include "Game/IVideoCapturing.h"
@@ -58,6 +59,7 @@
 #include "Sim/Features/FeatureDef.h"
 #include "Sim/Features/FeatureDefHandler.h"
 #include "Sim/Features/FeatureHandler.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Projectiles/Projectile.h"
 #include "Sim/Projectiles/ProjectileHandler.h"
@@ -72,6 +74,7 @@
 #include "System/Net/PackPacket.h"
 #include "System/Platform/Misc.h"
 #include "System/SafeUtil.h"
+#include "System/SpringFormat.h"
 #include "System/UnorderedMap.hpp"
 #include "System/StringUtil.h"
 #include "System/Sound/ISound.h"
@@ -257,6 +260,7 @@ bool LuaUnsyncedCtrl::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(SendSkirmishAIMessage);
 
 	REGISTER_LUA_CFUNC(SetLogSectionFilterLevel);
+	REGISTER_LUA_CFUNC(WriteBatchRecord);
 
 	REGISTER_LUA_CFUNC(ClearWatchDogTimer);
 
@@ -2369,7 +2373,7 @@ int LuaUnsyncedCtrl::GiveOrderToUnit(lua_State* L)
 
 	Command cmd = LuaUtils::ParseCommand(L, __FUNCTION__, 2);
 
-	clientNet->Send(CBaseNetProtocol::Get().SendAICommand(gu->myPlayerNum, skirmishAIHandler.GetCurrentAIID(), unit->id, cmd.GetID(), cmd.aiCommandId, cmd.options, cmd.params));
+	clientNet->Send(CBaseNetProtocol::Get().SendAICommand(gu->myPlayerNum, skirmishAIHandler.GetCurrentAIID(), unit->id, cmd.GetID(), cmd.aiCommandId, cmd.options, cmd.params.data(), cmd.params.size()));
 
 	lua_pushboolean(L, true);
 	return 1;
@@ -2908,6 +2912,90 @@ int LuaUnsyncedCtrl::SetLogSectionFilterLevel(lua_State* L) {
 	return 0;
 }
 
+static void LuaValueToJSON(lua_State* L, int index, std::string& json, int depth)
+{
+	switch (lua_type(L, index)) {
+		case LUA_TBOOLEAN: {
+			json += (lua_toboolean(L, index)? "true": "false");
+		} break;
+		case LUA_TNUMBER: {
+			const float value = lua_tonumber(L, index);
+			json += ((math::isinf(value) || math::isnan(value))? "null": spring::format("%.9g", value));
+		} break;
+		case LUA_TSTRING: {
+			size_t len = 0;
+			const char* str = lua_tolstring(L, index, &len);
+			json += CDemoBatch::QuoteString(std::string(str, len));
+		} break;
+		case LUA_TTABLE: {
+			// also guards against cyclic tables
+			if (depth >= 16) {
+				json += "null";
+				break;
+			}
+
+			const int table = (index > 0)? index: (lua_gettop(L) + index + 1);
+			const size_t len = lua_objlen(L, table);
+
+			// non-empty sequences become arrays, everything else objects
+			if (len > 0) {
+				json += "[";
+
+				for (size_t i = 1; i <= len; i++) {
+					json += ((i > 1)? ",": "");
+
+					lua_rawgeti(L, table, i);
+					LuaValueToJSON(L, -1, json, depth + 1);
+					lua_pop(L, 1);
+				}
+
+				json += "]";
+				break;
+			}
+
+			json += "{";
+
+			for (lua_pushnil(L); lua_next(L, table) != 0; lua_pop(L, 1)) {
+				std::string key;
+
+				// no lua_tostring on number keys, it would break lua_next
+				switch (lua_type(L, -2)) {
+					case LUA_TSTRING: { key = lua_tostring(L, -2); } break;
+					case LUA_TNUMBER: { key = spring::format("%.9g", float(lua_tonumber(L, -2))); } break;
+					default: { continue; } break;
+				}
+
+				json += ((json.back() != '{')? ",": "");
+				json += CDemoBatch::QuoteString(key) + ":";
+
+				LuaValueToJSON(L, -1, json, depth + 1);
+			}
+
+			json += "}";
+		} break;
+		default: {
+			json += "null";
+		} break;
+	}
+}
+
+int LuaUnsyncedCtrl::WriteBatchRecord(lua_State* L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	// not batch-replaying, nothing to write to
+	if (!CDemoBatch::enabled) {
+		lua_pushboolean(L, false);
+		return 1;
+	}
+
+	std::string json;
+	LuaValueToJSON(L, 1, json, 0);
+
+	lua_pushboolean(L, CDemoBatch::WriteRecord("lua", spring::format("\"frame\":%d,\"data\":", gs->frameNum) + json));
+	return 1;
+}
+
 /******************************************************************************/
 /******************************************************************************/
 
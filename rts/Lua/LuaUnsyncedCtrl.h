@@ -160,6 +160,7 @@ class LuaUnsyncedCtrl {
 		static int SendSkirmishAIMessage(lua_State* L);
 
 		static int SetLogSectionFilterLevel(lua_State* L);
+		static int WriteBatchRecord(lua_State* L);
 
 		static int ClearWatchDogTimer(lua_State* L);
 
@@ -45,6 +45,7 @@
 #include "Sim/Features/FeatureHandler.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/ModInfo.h"
+#include "Sim/Misc/SimCostProfiler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Projectiles/Projectile.h"
@@ -57,9 +58,11 @@
 #include "Net/Protocol/NetProtocol.h" // NETMSG_*
 #include "System/Config/ConfigHandler.h"
 #include "System/Config/ConfigVariable.h"
+#include "System/FrameArena.h"
 #include "System/Input/KeyInput.h"
 #include "System/LoadSave/DemoReader.h"
 #include "System/Log/DefaultFilter.h"
+#include "System/Net/Connection.h"
 #include "System/Platform/SDL1_keysym.h"
 #include "System/Sound/ISoundChannels.h"
 #include "System/Misc/SpringTime.h"
@@ -90,6 +93,7 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 
 	REGISTER_LUA_CFUNC(GetLuaMemUsage);
 	REGISTER_LUA_CFUNC(GetVidMemUsage);
+	REGISTER_LUA_CFUNC(GetSimCostTable);
 
 	REGISTER_LUA_CFUNC(GetDrawFrame);
 	REGISTER_LUA_CFUNC(GetFrameTimeOffset);
@@ -224,6 +228,7 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetPlayerRoster);
 	REGISTER_LUA_CFUNC(GetPlayerTraffic);
 	REGISTER_LUA_CFUNC(GetPlayerStatistics);
+	REGISTER_LUA_CFUNC(GetPlayerLinkStats);
 
 	REGISTER_LUA_CFUNC(GetDrawSelectionInfo);
 
@@ -404,6 +409,57 @@ int LuaUnsyncedRead::GetVidMemUsage(lua_State* L)
 	return 2;
 }
 
+int LuaUnsyncedRead::GetSimCostTable(lua_State* L)
+{
+	static const char* categoryNames[] = {"unitdefs", "weapondefs", "gadgets", nullptr};
+
+	const auto category = static_cast<CSimCostProfiler::Category>(luaL_checkoption(L, 1, nullptr, categoryNames));
+	const int numFrames = std::max(1, simCostProfiler.GetNumFrames());
+
+	std::vector<CSimCostProfiler::Row> rows;
+	simCostProfiler.GetRows(category, rows);
+
+	// rows = {[1] = {id=, name=, time=, calls=, parts={...}}, ...}, most expensive first; times in ms per frame
+	lua_createtable(L, rows.size(), 0);
+
+	for (size_t i = 0; i < rows.size(); i++) {
+		const CSimCostProfiler::Row& r = rows[i];
+
+		std::uint64_t numCalls = 0;
+
+		lua_createtable(L, 0, 5);
+		HSTR_PUSH_NUMBER(L, "id", r.id);
+		HSTR_PUSH_STRING(L, "name", r.name);
+		HSTR_PUSH_NUMBER(L, "time", r.totalTime * 1e-6 / numFrames);
+
+		HSTR_PUSH(L, "parts");
+		lua_createtable(L, 0, CSimCostProfiler::NUM_PARTS);
+
+		for (int p = 0; p < CSimCostProfiler::NUM_PARTS; p++) {
+			const char* partName = CSimCostProfiler::GetPartName(category, p);
+
+			if (partName == nullptr)
+				continue;
+
+			lua_pushstring(L, partName);
+			lua_createtable(L, 0, 2);
+			HSTR_PUSH_NUMBER(L, "time", r.entry.partTimes[p] * 1e-6 / numFrames);
+			HSTR_PUSH_NUMBER(L, "calls", r.entry.partCalls[p] / double(numFrames));
+			lua_rawset(L, -3);
+
+			numCalls += r.entry.partCalls[p];
+		}
+
+		lua_rawset(L, -3);
+
+		HSTR_PUSH_NUMBER(L, "calls", numCalls / double(numFrames));
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	lua_pushnumber(L, simCostProfiler.GetNumFrames());
+	return 2;
+}
+
 /******************************************************************************/
 
 int LuaUnsyncedRead::GetViewGeometry(lua_State* L)
@@ -2303,7 +2359,7 @@ int LuaUnsyncedRead::GetGroupUnitsSorted(lua_State* L)
 	if ((groupID < 0) || ((size_t)groupID >= groups.size()) || (groups[groupID] == nullptr))
 		return 0; // nils
 
-	std::vector< std::pair<int, std::vector<const CUnit*> > > unitDefMap;
+	FrameVector< std::pair<int, FrameVector<const CUnit*> > > unitDefMap;
 	unitDefMap.resize(unitDefHandler->unitDefs.size() + 1);
 
 	for (const int unitID: groups[groupID]->units) {
@@ -2317,7 +2373,7 @@ int LuaUnsyncedRead::GetGroupUnitsSorted(lua_State* L)
 	lua_createtable(L, 0, unitDefMap.size());
 
 	for (auto mit = unitDefMap.cbegin(); mit != unitDefMap.cend(); ++mit) {
-		const std::vector<const CUnit*>& v = mit->second;
+		const FrameVector<const CUnit*>& v = mit->second;
 
 		if (v.empty())
 			continue;
@@ -2345,7 +2401,7 @@ int LuaUnsyncedRead::GetGroupUnitsCounts(lua_State* L)
 	if ((groupID < 0) || ((size_t)groupID >= groups.size()) || (groups[groupID] == nullptr))
 		return 0; // nils
 
-	std::vector< std::pair<int, int> > countMap;
+	FrameVector< std::pair<int, int> > countMap;
 	countMap.resize(unitDefHandler->unitDefs.size() + 1, {0, 0});
 
 	for (const int unitID: groups[groupID]->units) {
@@ -2481,6 +2537,32 @@ int LuaUnsyncedRead::GetPlayerStatistics(lua_State* L)
 	return 5;
 }
 
+int LuaUnsyncedRead::GetPlayerLinkStats(lua_State* L)
+{
+	const int playerID = luaL_checkint(L, 1);
+
+	if (!playerHandler->IsValidPlayer(playerID))
+		return 0;
+
+	netcode::LinkStats stats;
+
+	// the host sees every link, others only their own
+	if (gameServer != nullptr) {
+		stats = gameServer->GetPlayerLinkStats(playerID);
+	} else if (playerID == gu->myPlayerNum) {
+		stats = clientNet->GetLinkStats();
+	} else {
+		return 0;
+	}
+
+	lua_pushnumber(L, stats.rtt * 0.001f);
+	lua_pushnumber(L, stats.rttVar * 0.001f);
+	lua_pushnumber(L, stats.lossRate);
+	lua_pushnumber(L, stats.resendTimeout * 0.001f);
+	lua_pushnumber(L, stats.sendWindow);
+	return 5;
+}
+
 
 /******************************************************************************/
 /******************************************************************************/
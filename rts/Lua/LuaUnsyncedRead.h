@@ -21,6 +21,7 @@ class LuaUnsyncedRead {
 
 		static int GetLuaMemUsage(lua_State* L);
 		static int GetVidMemUsage(lua_State* L);
+		static int GetSimCostTable(lua_State* L);
 
 		static int GetDrawFrame(lua_State* L);
 		static int GetFrameTimeOffset(lua_State* L);
@@ -155,6 +156,7 @@ class LuaUnsyncedRead {
 		static int GetPlayerRoster(lua_State* L);
 		static int GetPlayerTraffic(lua_State* L);
 		static int GetPlayerStatistics(lua_State* L);
+		static int GetPlayerLinkStats(lua_State* L);
 
 		static int GetDrawSelectionInfo(lua_State* L);
 
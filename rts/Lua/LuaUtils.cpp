@@ -25,7 +25,7 @@
 
 
 static const int maxDepth = 16;
-int LuaUtils::exportedDataSize = 0;
+std::atomic<int> LuaUtils::exportedDataSize = {0};
 
 
 /******************************************************************************/
@@ -1374,6 +1374,42 @@ void LuaUtils::PushStringVector(lua_State* L, const vector<string>& vec)
 	}
 }
 
+int LuaUtils::PushCachedDefTable(lua_State* L, const void* data, AccessFunc func)
+{
+	// registry[cacheKey][data] holds the table from a previous access
+	static const char* cacheKey = "ObjectDefTableCache";
+
+	lua_getfield(L, LUA_REGISTRYINDEX, cacheKey);
+
+	if (!lua_istable(L, -1)) {
+		lua_pop(L, 1);
+		lua_newtable(L);
+		lua_pushvalue(L, -1);
+		lua_setfield(L, LUA_REGISTRYINDEX, cacheKey);
+	}
+
+	lua_pushlightuserdata(L, const_cast<void*>(data));
+	lua_rawget(L, -2);
+
+	if (!lua_isnil(L, -1)) {
+		lua_remove(L, -2);
+		return 1;
+	}
+
+	lua_pop(L, 1);
+
+	if (func(L, data) != 1) {
+		lua_pop(L, 1);
+		return 0;
+	}
+
+	lua_pushlightuserdata(L, const_cast<void*>(data));
+	lua_pushvalue(L, -2);
+	lua_rawset(L, -4);
+	lua_remove(L, -2);
+	return 1;
+}
+
 /******************************************************************************/
 /******************************************************************************/
 
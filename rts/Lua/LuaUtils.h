@@ -3,6 +3,7 @@
 #ifndef LUA_UTILS_H
 #define LUA_UTILS_H
 
+#include <atomic>
 #include <string>
 #include <vector>
 using std::string;
@@ -70,7 +71,7 @@ class LuaUtils {
 
 	public:
 		// Backups lua data into a c++ vector and restores it from it
-		static int exportedDataSize; //< performance stat
+		static std::atomic<int> exportedDataSize; //< performance stat
 		static int Backup(std::vector<DataDump> &backup, lua_State* src, int count);
 		static int Restore(const std::vector<DataDump> &backup, lua_State* dst);
 
@@ -142,32 +143,53 @@ class LuaUtils {
 
 		static void PushStringVector(lua_State* L, const vector<string>& vec);
 
+		/// pushes the table built by <func> for immutable def <data>, which
+		/// is only called on the first access and then cached per state
+		static int PushCachedDefTable(lua_State* L, const void* data, AccessFunc func);
+
 		static void PushCommandDesc(lua_State* L, const SCommandDescription& cd);
 };
 
 
 
-template<typename ObjectDefType, size_t indxFuncsSize, size_t iterFuncsSize>
-static void PushObjectDefProxyTable(
+// pushes the metatable shared by all proxy tables of one def-type, preceded
+// by the table mapping each proxy to its def (upvalue of the meta-functions)
+// returns the (absolute) stack index of the metatable
+template<size_t indxFuncsSize>
+static int PushObjectDefProxyMetaTable(
 	lua_State* L,
 	const std::array<const LuaHashString, indxFuncsSize>& indxOpers,
+	const std::array<const lua_CFunction, indxFuncsSize>& indxFuncs
+) {
+	lua_newtable(L); // proxy-to-def table
+	lua_newtable(L); // the metatable
+
+	for (size_t n = 0; n < indxFuncsSize; n++) {
+		indxOpers[n].Push(L);
+		lua_pushvalue(L, -3);
+		lua_pushcclosure(L, indxFuncs[n], 1);
+		lua_rawset(L, -3); // closure
+	}
+
+	return (lua_gettop(L));
+}
+
+template<typename ObjectDefType, size_t iterFuncsSize>
+static void PushObjectDefProxyTable(
+	lua_State* L,
 	const std::array<const LuaHashString, iterFuncsSize>& iterOpers,
-	const std::array<const lua_CFunction, indxFuncsSize>& indxFuncs,
 	const std::array<const lua_CFunction, iterFuncsSize>& iterFuncs,
-	const ObjectDefType* def
+	const ObjectDefType* def,
+	int defsTableIdx,
+	int metaTableIdx
 ) {
 	lua_pushnumber(L, def->id);
 	lua_newtable(L); { // the proxy table
+		lua_pushvalue(L, -1);
+		lua_pushlightuserdata(L, (void*) def);
+		lua_rawset(L, metaTableIdx - 1);
 
-		lua_newtable(L); // the metatable
-
-		for (size_t n = 0; n < indxFuncsSize; n++) {
-			indxOpers[n].Push(L);
-			lua_pushlightuserdata(L, (void*) def);
-			lua_pushcclosure(L, indxFuncs[n], 1);
-			lua_rawset(L, -3); // closure
-		}
-
+		lua_pushvalue(L, metaTableIdx);
 		lua_setmetatable(L, -2);
 	}
 
@@ -177,7 +199,20 @@ static void PushObjectDefProxyTable(
 		lua_rawset(L, -3);
 	}
 
-	lua_rawset(L, -3); // set the proxy table
+	lua_rawset(L, defsTableIdx); // set the proxy table
+}
+
+// returns the def of the proxy table at index 1, for meta-functions
+// created by PushObjectDefProxyMetaTable
+static inline const void* GetObjectDefProxyData(lua_State* L)
+{
+	lua_pushvalue(L, 1);
+	lua_rawget(L, lua_upvalueindex(1));
+
+	const void* def = lua_touserdata(L, -1);
+
+	lua_pop(L, 1);
+	return def;
 }
 
 
@@ -0,0 +1,602 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+
+#include "LuaVBOs.h"
+
+#include "LuaInclude.h"
+
+#include "LuaHandle.h"
+#include "LuaHashString.h"
+#include "LuaOpenGL.h"
+#include "LuaUtils.h"
+
+#include "Game/Camera.h"
+#include "Sim/Misc/LosHandler.h"
+#include "Sim/Misc/TeamHandler.h"
+#include "Sim/Units/Unit.h"
+#include "Sim/Units/UnitHandler.h"
+
+
+// scratch space for uploads, Lua GL calls only run on the main thread
+static std::vector<GLfloat> floatData;
+static std::vector<GLuint> uintData;
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+LuaVBOs::~LuaVBOs()
+{
+	for (const VBO* vbo: vbos) {
+		glDeleteBuffers(1, &vbo->id);
+	}
+	for (const VAO* vao: vaos) {
+		glDeleteVertexArrays(1, &vao->id);
+	}
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+bool LuaVBOs::PushEntries(lua_State* L)
+{
+	CreateMetatables(L);
+
+	REGISTER_LUA_CFUNC(CreateVBO);
+	REGISTER_LUA_CFUNC(DeleteVBO);
+	REGISTER_LUA_CFUNC(UploadVBO);
+	REGISTER_LUA_CFUNC(UploadVBOUnits);
+
+	REGISTER_LUA_CFUNC(CreateVAO);
+	REGISTER_LUA_CFUNC(DeleteVAO);
+	REGISTER_LUA_CFUNC(VAOAttrib);
+	REGISTER_LUA_CFUNC(VAOElements);
+	REGISTER_LUA_CFUNC(DrawVAO);
+
+	return true;
+}
+
+
+bool LuaVBOs::CreateMetatables(lua_State* L)
+{
+	luaL_newmetatable(L, "VBO");
+	HSTR_PUSH_CFUNC(L, "__gc",        meta_gc_vbo);
+	HSTR_PUSH_CFUNC(L, "__index",     meta_index_vbo);
+	HSTR_PUSH_CFUNC(L, "__newindex",  meta_newindex);
+	lua_pop(L, 1);
+
+	luaL_newmetatable(L, "VAO");
+	HSTR_PUSH_CFUNC(L, "__gc",        meta_gc_vao);
+	HSTR_PUSH_CFUNC(L, "__index",     meta_index_vao);
+	HSTR_PUSH_CFUNC(L, "__newindex",  meta_newindex);
+	lua_pop(L, 1);
+	return true;
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+inline void CheckDrawingEnabled(lua_State* L, const char* caller)
+{
+	if (!LuaOpenGL::IsDrawingEnabled(L)) {
+		luaL_error(L, "%s(): OpenGL calls can only be used in Draw() "
+		              "call-ins, or while creating display lists", caller);
+	}
+}
+
+static LuaVBOs::VBO* CheckValidVBO(lua_State* L, int index, const char* caller)
+{
+	LuaVBOs::VBO* vbo = static_cast<LuaVBOs::VBO*>(luaL_checkudata(L, index, "VBO"));
+
+	if (vbo->id == 0)
+		luaL_error(L, "%s(): deleted VBO", caller);
+
+	return vbo;
+}
+
+static LuaVBOs::VAO* CheckValidVAO(lua_State* L, int index, const char* caller)
+{
+	LuaVBOs::VAO* vao = static_cast<LuaVBOs::VAO*>(luaL_checkudata(L, index, "VAO"));
+
+	if (vao->id == 0)
+		luaL_error(L, "%s(): deleted VAO", caller);
+
+	return vao;
+}
+
+// same access rules as gl.Unit; ally units or enemies in LOS
+static bool CanReadUnit(const CUnit* unit, int readAllyTeam)
+{
+	if (readAllyTeam < 0)
+		return (readAllyTeam != CEventClient::NoAccessTeam);
+
+	if (teamHandler->Ally(readAllyTeam, unit->allyteam))
+		return true;
+
+	return ((unit->losStatus[readAllyTeam] & LOS_INLOS) != 0);
+}
+
+static void BufferSubData(const LuaVBOs::VBO* vbo, GLintptr offset, GLsizeiptr size, const void* data)
+{
+	// bind to a target that is not part of any VAO's state
+	glBindBuffer(GL_COPY_WRITE_BUFFER, vbo->id);
+	glBufferSubData(GL_COPY_WRITE_BUFFER, offset, size, data);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+const LuaVBOs::VBO* LuaVBOs::GetLuaVBO(lua_State* L, int index)
+{
+	return static_cast<VBO*>(LuaUtils::GetUserData(L, index, "VBO"));
+}
+
+const LuaVBOs::VAO* LuaVBOs::GetLuaVAO(lua_State* L, int index)
+{
+	return static_cast<VAO*>(LuaUtils::GetUserData(L, index, "VAO"));
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+void LuaVBOs::VBO::Init()
+{
+	index  = -1u;
+	id     = 0;
+	target = GL_ARRAY_BUFFER;
+	usage  = GL_STATIC_DRAW;
+	size   = 0;
+}
+
+
+void LuaVBOs::VBO::Free(lua_State* L)
+{
+	if (id == 0)
+		return;
+
+	glDeleteBuffers(1, &id);
+	id = 0;
+
+	{
+		// get rid of the userdatum
+		LuaVBOs& activeVBOs = CLuaHandle::GetActiveVBOs(L);
+		auto& vbos = activeVBOs.vbos;
+
+		assert(index < vbos.size());
+		assert(vbos[index] == this);
+
+		vbos[index] = vbos.back();
+		vbos[index]->index = index;
+		vbos.pop_back();
+	}
+}
+
+
+void LuaVBOs::VAO::Init()
+{
+	index   = -1u;
+	id      = 0;
+	elemsID = 0;
+}
+
+
+void LuaVBOs::VAO::Free(lua_State* L)
+{
+	if (id == 0)
+		return;
+
+	glDeleteVertexArrays(1, &id);
+	id = 0;
+
+	{
+		LuaVBOs& activeVBOs = CLuaHandle::GetActiveVBOs(L);
+		auto& vaos = activeVBOs.vaos;
+
+		assert(index < vaos.size());
+		assert(vaos[index] == this);
+
+		vaos[index] = vaos.back();
+		vaos[index]->index = index;
+		vaos.pop_back();
+	}
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+int LuaVBOs::meta_gc_vbo(lua_State* L)
+{
+	VBO* vbo = static_cast<VBO*>(luaL_checkudata(L, 1, "VBO"));
+	vbo->Free(L);
+	return 0;
+}
+
+int LuaVBOs::meta_gc_vao(lua_State* L)
+{
+	VAO* vao = static_cast<VAO*>(luaL_checkudata(L, 1, "VAO"));
+	vao->Free(L);
+	return 0;
+}
+
+
+int LuaVBOs::meta_index_vbo(lua_State* L)
+{
+	const VBO* vbo = static_cast<VBO*>(luaL_checkudata(L, 1, "VBO"));
+	const std::string& key = luaL_checkstring(L, 2);
+
+	if (key ==  "valid") { lua_pushboolean(L, vbo->id != 0 && glIsBuffer(vbo->id)); return 1; }
+	if (key == "target") { lua_pushnumber(L, vbo->target); return 1; }
+	if (key ==  "usage") { lua_pushnumber(L, vbo->usage ); return 1; }
+	if (key ==   "size") { lua_pushnumber(L, vbo->size  ); return 1; }
+
+	return 0;
+}
+
+int LuaVBOs::meta_index_vao(lua_State* L)
+{
+	const VAO* vao = static_cast<VAO*>(luaL_checkudata(L, 1, "VAO"));
+	const std::string& key = luaL_checkstring(L, 2);
+
+	if (key ==    "valid") { lua_pushboolean(L, vao->id != 0 && glIsVertexArray(vao->id)); return 1; }
+	if (key == "elements") { lua_pushboolean(L, vao->elemsID != 0); return 1; }
+
+	return 0;
+}
+
+
+int LuaVBOs::meta_newindex(lua_State* L)
+{
+	return 0;
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+int LuaVBOs::CreateVBO(lua_State* L)
+{
+	VBO vbo;
+	vbo.Init();
+
+	vbo.size = (GLsizeiptr)luaL_checknumber(L, 1);
+
+	if (vbo.size <= 0)
+		luaL_error(L, "[%s] non-positive buffer size %d", __func__, int(vbo.size));
+
+	const int table = 2;
+	if (lua_istable(L, table)) {
+		lua_getfield(L, table, "target");
+		if (lua_isnumber(L, -1)) {
+			vbo.target = (GLenum)lua_tonumber(L, -1);
+		}
+		lua_pop(L, 1);
+		lua_getfield(L, table, "usage");
+		if (lua_isnumber(L, -1)) {
+			vbo.usage = (GLenum)lua_tonumber(L, -1);
+		}
+		lua_pop(L, 1);
+	}
+
+	if (vbo.target != GL_ARRAY_BUFFER && vbo.target != GL_ELEMENT_ARRAY_BUFFER)
+		luaL_error(L, "[%s] target must be GL.ARRAY_BUFFER or GL.ELEMENT_ARRAY_BUFFER", __func__);
+
+	glGenBuffers(1, &vbo.id);
+
+	// allocate the memory
+	glBindBuffer(GL_COPY_WRITE_BUFFER, vbo.id);
+	glBufferData(GL_COPY_WRITE_BUFFER, vbo.size, nullptr, vbo.usage);
+	glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+	VBO* vboPtr = static_cast<VBO*>(lua_newuserdata(L, sizeof(VBO)));
+	*vboPtr = vbo;
+
+	luaL_getmetatable(L, "VBO");
+	lua_setmetatable(L, -2);
+
+	if (vboPtr->id != 0) {
+		LuaVBOs& activeVBOs = CLuaHandle::GetActiveVBOs(L);
+		auto& vbos = activeVBOs.vbos;
+
+		vbos.push_back(vboPtr);
+		vboPtr->index = vbos.size() - 1;
+	}
+
+	return 1;
+}
+
+
+int LuaVBOs::DeleteVBO(lua_State* L)
+{
+	if (lua_isnil(L, 1)) {
+		return 0;
+	}
+	VBO* vbo = static_cast<VBO*>(luaL_checkudata(L, 1, "VBO"));
+	vbo->Free(L);
+	return 0;
+}
+
+
+int LuaVBOs::UploadVBO(lua_State* L)
+{
+	const VBO* vbo = CheckValidVBO(L, 1, __func__);
+
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	const GLintptr offset = luaL_optint(L, 3, 0);
+	const size_t numValues = lua_objlen(L, 2);
+
+	// index buffers hold integers, everything else is uploaded as floats
+	const bool elements = (vbo->target == GL_ELEMENT_ARRAY_BUFFER);
+
+	if (offset < 0 || (offset + GLsizeiptr(numValues * sizeof(GLfloat))) > vbo->size)
+		luaL_error(L, "[%s] upload of %d values at offset %d exceeds buffer size %d", __func__, int(numValues), int(offset), int(vbo->size));
+
+	if (elements) {
+		uintData.resize(numValues);
+	} else {
+		floatData.resize(numValues);
+	}
+
+	for (size_t i = 0; i < numValues; i++) {
+		lua_rawgeti(L, 2, i + 1);
+
+		if (elements) {
+			uintData[i] = lua_tonumber(L, -1);
+		} else {
+			floatData[i] = lua_tonumber(L, -1);
+		}
+
+		lua_pop(L, 1);
+	}
+
+	if (numValues > 0) {
+		if (elements) {
+			BufferSubData(vbo, offset, numValues * sizeof(GLuint), uintData.data());
+		} else {
+			BufferSubData(vbo, offset, numValues * sizeof(GLfloat), floatData.data());
+		}
+	}
+
+	lua_pushnumber(L, numValues);
+	return 1;
+}
+
+
+int LuaVBOs::UploadVBOUnits(lua_State* L)
+{
+	const VBO* vbo = CheckValidVBO(L, 1, __func__);
+
+	const GLintptr offset = luaL_optint(L, 3, 0);
+	const int readAllyTeam = CLuaHandle::GetHandleReadAllyTeam(L);
+
+	constexpr size_t valuesPerUnit = 4;
+
+	if (offset < 0 || offset > vbo->size)
+		luaL_error(L, "[%s] offset %d exceeds buffer size %d", __func__, int(offset), int(vbo->size));
+
+	// {drawPos.x, drawPos.y, drawPos.z, unitID} per unit
+	const auto AddUnit = [&](const CUnit* unit) {
+		floatData.push_back(unit->drawPos.x);
+		floatData.push_back(unit->drawPos.y);
+		floatData.push_back(unit->drawPos.z);
+		floatData.push_back(unit->id);
+	};
+
+	floatData.clear();
+
+	if (lua_istable(L, 2)) {
+		// caller-supplied unitIDs, in the given order
+		const size_t numUnits = lua_objlen(L, 2);
+
+		for (size_t i = 0; i < numUnits; i++) {
+			lua_rawgeti(L, 2, i + 1);
+
+			const CUnit* unit = unitHandler->GetUnit(lua_toint(L, -1));
+
+			lua_pop(L, 1);
+
+			if (unit == nullptr || !CanReadUnit(unit, readAllyTeam))
+				continue;
+
+			AddUnit(unit);
+		}
+	} else {
+		// every readable unit that is drawn as a model by the current camera
+		for (const CUnit* unit: unitHandler->GetActiveUnits()) {
+			if (unit->noDraw || unit->isIcon || unit->IsInVoid())
+				continue;
+			if (!CanReadUnit(unit, readAllyTeam))
+				continue;
+			if (!camera->InView(unit->drawMidPos, unit->radius))
+				continue;
+
+			AddUnit(unit);
+		}
+	}
+
+	// write as many units as fit
+	const size_t maxUnits = (vbo->size - offset) / (valuesPerUnit * sizeof(GLfloat));
+	const size_t numUnits = std::min(floatData.size() / valuesPerUnit, maxUnits);
+
+	if (numUnits > 0)
+		BufferSubData(vbo, offset, numUnits * valuesPerUnit * sizeof(GLfloat), floatData.data());
+
+	lua_pushnumber(L, numUnits);
+	return 1;
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+int LuaVBOs::CreateVAO(lua_State* L)
+{
+	VAO vao;
+	vao.Init();
+
+	glGenVertexArrays(1, &vao.id);
+
+	VAO* vaoPtr = static_cast<VAO*>(lua_newuserdata(L, sizeof(VAO)));
+	*vaoPtr = vao;
+
+	luaL_getmetatable(L, "VAO");
+	lua_setmetatable(L, -2);
+
+	if (vaoPtr->id != 0) {
+		LuaVBOs& activeVBOs = CLuaHandle::GetActiveVBOs(L);
+		auto& vaos = activeVBOs.vaos;
+
+		vaos.push_back(vaoPtr);
+		vaoPtr->index = vaos.size() - 1;
+	}
+
+	return 1;
+}
+
+
+int LuaVBOs::DeleteVAO(lua_State* L)
+{
+	if (lua_isnil(L, 1)) {
+		return 0;
+	}
+	VAO* vao = static_cast<VAO*>(luaL_checkudata(L, 1, "VAO"));
+	vao->Free(L);
+	return 0;
+}
+
+
+int LuaVBOs::VAOAttrib(lua_State* L)
+{
+	const VAO* vao = CheckValidVAO(L, 1, __func__);
+	const VBO* vbo = CheckValidVBO(L, 3, __func__);
+
+	const GLuint attribIndex = luaL_checkint(L, 2);
+	const GLint attribSize = luaL_checkint(L, 4);
+
+	GLenum type = GL_FLOAT;
+	GLsizei stride = 0;
+	GLintptr offset = 0;
+	GLuint divisor = 0;
+
+	bool normalized = false;
+	bool integer = false;
+
+	const int table = 5;
+	if (lua_istable(L, table)) {
+		lua_getfield(L, table, "type");
+		if (lua_isnumber(L, -1)) {
+			type = (GLenum)lua_tonumber(L, -1);
+		}
+		lua_pop(L, 1);
+		lua_getfield(L, table, "stride");
+		if (lua_isnumber(L, -1)) {
+			stride = (GLsizei)lua_tonumber(L, -1);
+		}
+		lua_pop(L, 1);
+		lua_getfield(L, table, "offset");
+		if (lua_isnumber(L, -1)) {
+			offset = (GLintptr)lua_tonumber(L, -1);
+		}
+		lua_pop(L, 1);
+		lua_getfield(L, table, "divisor");
+		if (lua_isnumber(L, -1)) {
+			divisor = (GLuint)lua_tonumber(L, -1);
+		}
+		lua_pop(L, 1);
+		lua_getfield(L, table, "normalized");
+		if (lua_isboolean(L, -1)) {
+			normalized = lua_toboolean(L, -1);
+		}
+		lua_pop(L, 1);
+		lua_getfield(L, table, "integer");
+		if (lua_isboolean(L, -1)) {
+			integer = lua_toboolean(L, -1);
+		}
+		lua_pop(L, 1);
+	}
+
+	GLint maxAttribs = 0;
+	glGetIntegerv(GL_MAX_VERTEX_ATTRIBS, &maxAttribs);
+
+	if (attribIndex >= GLuint(maxAttribs))
+		luaL_error(L, "[%s] attribute index %d exceeds GL_MAX_VERTEX_ATTRIBS (%d)", __func__, int(attribIndex), maxAttribs);
+	if (attribSize < 1 || attribSize > 4)
+		luaL_error(L, "[%s] attribute size must be in [1, 4]", __func__);
+
+	glBindVertexArray(vao->id);
+	glBindBuffer(GL_ARRAY_BUFFER, vbo->id);
+	glEnableVertexAttribArray(attribIndex);
+
+	if (integer) {
+		glVertexAttribIPointer(attribIndex, attribSize, type, stride, reinterpret_cast<const GLvoid*>(offset));
+	} else {
+		glVertexAttribPointer(attribIndex, attribSize, type, normalized, stride, reinterpret_cast<const GLvoid*>(offset));
+	}
+
+	glVertexAttribDivisor(attribIndex, divisor);
+	glBindVertexArray(0);
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+	return 0;
+}
+
+
+int LuaVBOs::VAOElements(lua_State* L)
+{
+	VAO* vao = CheckValidVAO(L, 1, __func__);
+
+	if (lua_isnil(L, 2)) {
+		vao->elemsID = 0;
+	} else {
+		const VBO* vbo = CheckValidVBO(L, 2, __func__);
+
+		if (vbo->target != GL_ELEMENT_ARRAY_BUFFER)
+			luaL_error(L, "[%s] VBO target must be GL.ELEMENT_ARRAY_BUFFER", __func__);
+
+		vao->elemsID = vbo->id;
+	}
+
+	// the element binding is part of VAO state, set it while the VAO is bound
+	glBindVertexArray(vao->id);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, vao->elemsID);
+	glBindVertexArray(0);
+	return 0;
+}
+
+
+int LuaVBOs::DrawVAO(lua_State* L)
+{
+	CheckDrawingEnabled(L, __func__);
+
+	const VAO* vao = CheckValidVAO(L, 1, __func__);
+
+	const GLenum primType = (GLenum)luaL_checkint(L, 2);
+	const GLsizei count = luaL_checkint(L, 3);
+	const GLint first = luaL_optint(L, 4, 0);
+	const GLsizei numInstances = luaL_optint(L, 5, 1);
+
+	if (count <= 0 || numInstances <= 0)
+		return 0;
+	if (first < 0)
+		luaL_error(L, "[%s] negative first vertex or element", __func__);
+
+	glBindVertexArray(vao->id);
+
+	if (vao->elemsID != 0) {
+		glDrawElementsInstanced(primType, count, GL_UNSIGNED_INT, reinterpret_cast<const GLvoid*>(first * sizeof(GLuint)), numInstances);
+	} else {
+		glDrawArraysInstanced(primType, first, count, numInstances);
+	}
+
+	glBindVertexArray(0);
+	return 0;
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
@@ -0,0 +1,81 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_VBOS_H
+#define LUA_VBOS_H
+
+#include <vector>
+
+#include "Rendering/GL/myGL.h"
+
+
+struct lua_State;
+
+
+class LuaVBOs {
+	public:
+		LuaVBOs() { vbos.reserve(8); vaos.reserve(8); }
+		~LuaVBOs();
+
+		void Clear() { vbos.clear(); vaos.clear(); }
+
+		static bool PushEntries(lua_State* L);
+
+		struct VBO;
+		struct VAO;
+		static const VBO* GetLuaVBO(lua_State* L, int index);
+		static const VAO* GetLuaVAO(lua_State* L, int index);
+
+	public:
+		struct VBO {
+			VBO() : index(-1u), id(0), target(0), usage(0), size(0) {}
+
+			void Init();
+			void Free(lua_State* L);
+
+			GLuint index; // into LuaVBOs::vbos
+			GLuint id;
+			GLenum target;
+			GLenum usage;
+			GLsizeiptr size; // in bytes
+		};
+
+		struct VAO {
+			VAO() : index(-1u), id(0), elemsID(0) {}
+
+			void Init();
+			void Free(lua_State* L);
+
+			GLuint index; // into LuaVBOs::vaos
+			GLuint id;
+			GLuint elemsID; // attached index buffer, drawn as GL_UNSIGNED_INT if non-zero
+		};
+
+	private:
+		std::vector<VBO*> vbos;
+		std::vector<VAO*> vaos;
+
+	private: // helpers
+		static bool CreateMetatables(lua_State* L);
+
+	private: // metatable methods
+		static int meta_gc_vbo(lua_State* L);
+		static int meta_gc_vao(lua_State* L);
+		static int meta_index_vbo(lua_State* L);
+		static int meta_index_vao(lua_State* L);
+		static int meta_newindex(lua_State* L);
+
+	private:
+		static int CreateVBO(lua_State* L);
+		static int DeleteVBO(lua_State* L);
+		static int UploadVBO(lua_State* L);
+		static int UploadVBOUnits(lua_State* L);
+
+		static int CreateVAO(lua_State* L);
+		static int DeleteVAO(lua_State* L);
+		static int VAOAttrib(lua_State* L);
+		static int VAOElements(lua_State* L);
+		static int DrawVAO(lua_State* L);
+};
+
+
+#endif /* LUA_VBOS_H */
@@ -5,10 +5,12 @@
 
 #include "LuaVFS.h"
 #include "LuaInclude.h"
+#include "LuaChunkCache.h"
 #include "LuaHandle.h"
 #include "LuaHashString.h"
 #include "LuaIO.h"
 #include "LuaUtils.h"
+#include "LuaWorkers.h"
 #include "LuaZip.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/FileSystem/ArchiveScanner.h"
@@ -78,6 +80,8 @@ bool LuaVFS::PushUnsynced(lua_State* L)
 
 	HSTR_PUSH_CFUNC(L, "Include",        UnsyncInclude);
 	HSTR_PUSH_CFUNC(L, "LoadFile",       UnsyncLoadFile);
+	HSTR_PUSH_CFUNC(L, "LoadFileAsync",  LuaWorkers::LoadFileAsync);
+	HSTR_PUSH_CFUNC(L, "GetLoadFileAsyncResult", LuaWorkers::GetLoadFileAsyncResult);
 	HSTR_PUSH_CFUNC(L, "FileExists",     UnsyncFileExists);
 	HSTR_PUSH_CFUNC(L, "DirList",        UnsyncDirList);
 	HSTR_PUSH_CFUNC(L, "SubDirs",        UnsyncSubDirs);
@@ -157,7 +161,7 @@ int LuaVFS::Include(lua_State* L, bool synced)
  		lua_error(L);
 	}
 
-	int error = luaL_loadbuffer(L, code.c_str(), code.size(), filename.c_str());
+	int error = LuaChunkCache::LoadBuffer(L, code.c_str(), code.size(), filename.c_str());
 	if (error != 0) {
 		char buf[1024];
 		SNPRINTF(buf, sizeof(buf), "error = %i, %s, %s", error, filename.c_str(), lua_tostring(L, -1));
@@ -345,11 +349,16 @@ int LuaVFS::UseArchive(lua_State* L)
 	CVFSHandler* oldHandler = vfsHandler;
 	CVFSHandler  tmpHandler;
 
+	// async loads read through whichever handler is current
+	LuaWorkers::WaitForFileLoads();
+
 	vfsHandler = &tmpHandler;
 	vfsHandler->AddArchive(filename, false);
 
 	const int error = lua_pcall(L, lua_gettop(L) - funcIndex, LUA_MULTRET, 0);
 
+	LuaWorkers::WaitForFileLoads();
+
 	vfsHandler = oldHandler;
 
 	if (error != 0)
@@ -401,6 +410,8 @@ int LuaVFS::MapArchive(lua_State* L)
 		}
 	}
 
+	LuaWorkers::WaitForFileLoads();
+
 	if (!vfsHandler->AddArchive(filename, false)) {
 		std::ostringstream buf;
 		buf << "[" << __FUNCTION__ << "] failed to load archive: " << filename;
@@ -426,6 +437,8 @@ int LuaVFS::UnmapArchive(lua_State* L)
 	if (!LuaIO::IsSimplePath(filename))
 		return 0;
 
+	LuaWorkers::WaitForFileLoads();
+
 	if (!vfsHandler->RemoveArchive(filename)) {
 		std::ostringstream buf;
 		buf << "[" << __FUNCTION__ << "] failed to remove archive: " << filename;
@@ -107,7 +107,23 @@ static void AddQueueEvent(std::shared_ptr<DLEvent> ev) {
 static void QueueDownloadStarted(int id) { AddQueueEvent(std::make_shared<DLStartedEvent>(id)); }
 static void QueueDownloadFinished(int id) { AddQueueEvent(std::make_shared<DLFinishedEvent>(id)); }
 static void QueueDownloadFailed(int id, int errorID) { AddQueueEvent(std::make_shared<DLFailedEvent>(id, errorID)); }
-static void QueueDownloadProgress(int id, long downloaded, long total) { AddQueueEvent(std::make_shared<DLProgressEvent>(id, downloaded, total)); }
+static void QueueDownloadProgress(int id, long downloaded, long total) {
+	std::lock_guard<spring::mutex> lck(dlEventQueueMutex);
+
+	// rapid reports progress per received chunk of every pool file; only the
+	// latest state matters, so merge with a still unprocessed progress event
+	if (!dlEventQueue.empty()) {
+		DLProgressEvent* ev = dynamic_cast<DLProgressEvent*>(dlEventQueue.back().get());
+
+		if (ev != nullptr && ev->id == id) {
+			ev->downloaded = downloaded;
+			ev->total = total;
+			return;
+		}
+	}
+
+	dlEventQueue.push_back(std::make_shared<DLProgressEvent>(id, downloaded, total));
+}
 
 static void UpdateProgress(int done, int size) { QueueDownloadProgress(currentDownloadID, done, size); }
 
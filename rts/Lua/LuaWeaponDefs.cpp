@@ -49,6 +49,9 @@ static int CustomParamsTable(lua_State* L, const void* data);
 static int GuiSoundSetTable(lua_State* L, const void* data);
 //static int CategorySetFromBits(lua_State* L, const void* data);
 
+// built once per state, see LuaUtils::PushCachedDefTable
+static int CachedCustomParamsTable(lua_State* L, const void* data) { return LuaUtils::PushCachedDefTable(L, data, CustomParamsTable); }
+
 
 /******************************************************************************/
 /******************************************************************************/
@@ -75,15 +78,20 @@ bool LuaWeaponDefs::PushEntries(lua_State* L)
 	const std::array<const IndxFuncType, 3> indxFuncs = {{WeaponDefIndex, WeaponDefNewIndex, WeaponDefMetatable}};
 	const std::array<const IterFuncType, 2> iterFuncs = {{Pairs, Next}};
 
+	const int defsTableIdx = lua_gettop(L);
+	const int metaTableIdx = PushObjectDefProxyMetaTable(L, indxOpers, indxFuncs);
+
 	for (auto it = defsMap.cbegin(); it != defsMap.cend(); ++it) {
 		const auto def = weaponDefHandler->GetWeaponDefByID(it->second);
 
 		if (def == nullptr)
 			continue;
 
-		PushObjectDefProxyTable(L, indxOpers, iterOpers, indxFuncs, iterFuncs, def);
+		PushObjectDefProxyTable(L, iterOpers, iterFuncs, def, defsTableIdx, metaTableIdx);
 	}
 
+	// pop the metatable and proxy-to-def table
+	lua_pop(L, 2);
 	return true;
 }
 
@@ -107,7 +115,7 @@ static int WeaponDefIndex(lua_State* L)
 		return 1;
 	}
 
-	const void* userData = lua_touserdata(L, lua_upvalueindex(1));
+	const void* userData = GetObjectDefProxyData(L);
 	const WeaponDef* wd = static_cast<const WeaponDef*>(userData);
 	const DataElement& elem = it->second;
 	const void* p = ((const char*)wd) + elem.offset;
@@ -163,7 +171,7 @@ static int WeaponDefNewIndex(lua_State* L)
 		return 0;
 	}
 
-	const void* userData = lua_touserdata(L, lua_upvalueindex(1));
+	const void* userData = GetObjectDefProxyData(L);
 	const WeaponDef* wd = static_cast<const WeaponDef*>(userData);
 
 	// write-protected
@@ -211,7 +219,7 @@ static int WeaponDefNewIndex(lua_State* L)
 
 static int WeaponDefMetatable(lua_State* L)
 {
-	//const void* userData = lua_touserdata(L, lua_upvalueindex(1));
+	//const void* userData = GetObjectDefProxyData(L);
 	//const WeaponDef* wd = (const WeaponDef*)userData;
 	return 0;
 }
@@ -421,7 +429,7 @@ static bool InitParamMap()
 	ADD_FUNCTION("hitSound",     wd.hitSound,  GuiSoundSetTable);
 	ADD_FUNCTION("fireSound",    wd.fireSound, GuiSoundSetTable);
 
-	ADD_FUNCTION("customParams",         wd.customParams,   CustomParamsTable);
+	ADD_FUNCTION("customParams",         wd.customParams,   CachedCustomParamsTable);
 	ADD_FUNCTION("noEnemyCollide",       wd.collisionFlags, NoEnemyCollide);
 	ADD_FUNCTION("noFriendlyCollide",    wd.collisionFlags, NoFriendlyCollide);
 	ADD_FUNCTION("noFeatureCollide",     wd.collisionFlags, NoFeatureCollide);
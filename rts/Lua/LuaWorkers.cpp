@@ -0,0 +1,365 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <atomic>
+#include <future>
+#include <memory>
+#include <string>
+
+#include "LuaWorkers.h"
+#include "LuaContextData.h"
+#include "LuaInclude.h"
+#include "LuaUtils.h"
+#include "LuaHandle.h"
+#include "System/SafeUtil.h"
+#include "System/FileSystem/FileHandler.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Threading/LockStats.h"
+#include "System/Threading/ThreadPool.h"
+
+
+// maximum number of results (and pending jobs) a handle can hold
+static constexpr size_t MAX_JOBS = 1024;
+// jobs running longer than this (in milliseconds) are aborted
+static constexpr int MAX_JOB_TIME = 2000;
+
+struct LuaWorkers::Job {
+	std::string chunk;
+
+	std::vector<LuaUtils::DataDump> args;
+	std::vector<LuaUtils::DataDump> results;
+
+	std::string error;
+	std::shared_ptr< std::future<void> > future;
+
+	std::atomic<bool> cancel = {false};
+};
+
+struct LuaWorkers::FileLoad {
+	std::string fileName;
+	std::string modes;
+	std::string data;
+
+	std::shared_ptr< std::future<void> > future;
+
+	bool loaded = false;
+};
+
+// number of file loads in progress across all handles
+static spring::mutex fileLoadMutex;
+static spring::condition_variable_any fileLoadCond;
+static unsigned int numFileLoads = 0;
+
+struct LuaWorkers::WorkerState {
+	WorkerState(): lcd(false, false) {
+		if ((L = LUA_OPEN(&lcd)) == nullptr)
+			return;
+
+		LUA_OPEN_LIB(L, luaopen_base);
+		LUA_OPEN_LIB(L, luaopen_math);
+		LUA_OPEN_LIB(L, luaopen_table);
+		LUA_OPEN_LIB(L, luaopen_string);
+
+		// no file-system access and nothing that outlives a job
+		lua_pushnil(L); lua_setglobal(L, "dofile");
+		lua_pushnil(L); lua_setglobal(L, "loadfile");
+		lua_pushnil(L); lua_setglobal(L, "loadlib");
+		lua_pushnil(L); lua_setglobal(L, "require");
+		lua_pushnil(L); lua_setglobal(L, "print");
+		lua_pushnil(L); lua_setglobal(L, "newproxy");
+	}
+
+	~WorkerState() {
+		lcd.Clear();
+
+		if (L != nullptr)
+			LUA_CLOSE(&L);
+	}
+
+	luaContextData lcd;
+	lua_State* L = nullptr;
+};
+
+
+static int ChunkWriter(lua_State* L, const void* p, size_t size, void* ud)
+{
+	std::string* chunk = reinterpret_cast<std::string*>(ud);
+	chunk->append(reinterpret_cast<const char*>(p), size);
+	return 0;
+}
+
+// set per worker thread while a job runs, read by the count-hook
+static thread_local const LuaWorkers::Job* hookJob = nullptr;
+static thread_local spring_time hookTime;
+
+static void JobHook(lua_State* L, lua_Debug* ar)
+{
+	if (hookJob->cancel.load())
+		luaL_error(L, "job cancelled");
+	if ((spring_gettime() - hookTime).toMilliSecsi() > MAX_JOB_TIME)
+		luaL_error(L, "job exceeded %dms", MAX_JOB_TIME);
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+bool LuaWorkers::PushEntries(lua_State* L)
+{
+	REGISTER_LUA_CFUNC(PostWorkerJob);
+	REGISTER_LUA_CFUNC(GetWorkerJobResult);
+	return true;
+}
+
+
+void LuaWorkers::Clear()
+{
+	for (auto& pair: jobs) {
+		pair.second->cancel.store(true);
+	}
+
+	for (auto& pair: jobs) {
+		pair.second->future->wait();
+		spring::SafeDelete(pair.second);
+	}
+
+	for (auto& pair: fileLoads) {
+		pair.second->future->wait();
+		spring::SafeDelete(pair.second);
+	}
+
+	for (WorkerState*& state: idleStates) {
+		spring::SafeDelete(state);
+	}
+
+	jobs.clear();
+	fileLoads.clear();
+	idleStates.clear();
+}
+
+
+void LuaWorkers::WaitForFileLoads()
+{
+	std::unique_lock<spring::mutex> lock(fileLoadMutex);
+	fileLoadCond.wait(lock, []() { return (numFileLoads == 0); });
+}
+
+
+LuaWorkers::WorkerState* LuaWorkers::AcquireState()
+{
+	LockStats::ScopedLock<spring::mutex> lock(stateMutex, LockStats::LOCK_LUA);
+
+	if (idleStates.empty())
+		return (new WorkerState());
+
+	WorkerState* state = idleStates.back();
+	idleStates.pop_back();
+	return state;
+}
+
+void LuaWorkers::ReleaseState(WorkerState* state)
+{
+	LockStats::ScopedLock<spring::mutex> lock(stateMutex, LockStats::LOCK_LUA);
+	idleStates.push_back(state);
+}
+
+
+void LuaWorkers::RunJob(Job* job)
+{
+	WorkerState* state = AcquireState();
+	lua_State* L = state->L;
+
+	if (L == nullptr) {
+		job->error = "could not create worker state";
+		ReleaseState(state);
+		return;
+	}
+
+	lua_settop(L, 0);
+
+	if (luaL_loadbuffer(L, job->chunk.data(), job->chunk.size(), "=WorkerJob") != 0) {
+		job->error = lua_tostring(L, -1);
+		lua_settop(L, 0);
+		ReleaseState(state);
+		return;
+	}
+
+	// every job gets its own globals, library tables are read through
+	lua_newtable(L);
+	lua_newtable(L);
+	lua_pushvalue(L, LUA_GLOBALSINDEX);
+	lua_setfield(L, -2, "__index");
+	lua_setmetatable(L, -2);
+	lua_setfenv(L, -2);
+
+	LuaUtils::Restore(job->args, L);
+
+	hookJob = job;
+	hookTime = spring_gettime();
+	lua_sethook(L, JobHook, LUA_MASKCOUNT, 1 << 16);
+
+	if (lua_pcall(L, job->args.size(), LUA_MULTRET, 0) != 0) {
+		job->error = lua_isstring(L, -1)? lua_tostring(L, -1): "unknown error";
+	} else {
+		LuaUtils::Backup(job->results, L, lua_gettop(L));
+	}
+
+	lua_sethook(L, nullptr, 0, 0);
+	hookJob = nullptr;
+
+	lua_settop(L, 0);
+	ReleaseState(state);
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+int LuaWorkers::PostWorkerJob(lua_State* L)
+{
+	LuaWorkers& workers = GetLuaContextData(L)->workers;
+
+	luaL_checktype(L, 1, LUA_TFUNCTION);
+
+	if (lua_iscfunction(L, 1))
+		luaL_error(L, "[%s] job function must be a Lua function", __func__);
+
+	if (workers.jobs.size() >= MAX_JOBS)
+		return 0;
+
+	{
+		lua_Debug ar;
+		lua_pushvalue(L, 1);
+		lua_getinfo(L, ">u", &ar);
+
+		// the function is run in another state, globals are the only shared context
+		if (ar.nups > 0)
+			luaL_error(L, "[%s] job function must not have upvalues (found %d)", __func__, ar.nups);
+	}
+
+	Job* job = new Job();
+
+	lua_pushvalue(L, 1);
+	lua_dump(L, ChunkWriter, &job->chunk);
+	lua_pop(L, 1);
+
+	// tables are deep-copied, functions and userdata become nil
+	LuaUtils::Backup(job->args, L, lua_gettop(L) - 1);
+
+	const int jobID = ++workers.lastJobID;
+
+	workers.jobs[jobID] = job;
+	job->future = ThreadPool::Enqueue([&workers, job]() { workers.RunJob(job); });
+
+	lua_pushnumber(L, jobID);
+	return 1;
+}
+
+
+int LuaWorkers::GetWorkerJobResult(lua_State* L)
+{
+	LuaWorkers& workers = GetLuaContextData(L)->workers;
+
+	const int jobID = luaL_checkint(L, 1);
+	const auto iter = workers.jobs.find(jobID);
+
+	if (iter == workers.jobs.end())
+		luaL_error(L, "[%s] invalid jobID %d", __func__, jobID);
+
+	Job* job = iter->second;
+
+	// still running; nothing
+	if (job->future->wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return 0;
+
+	int numResults = 1;
+
+	if (job->error.empty()) {
+		lua_pushboolean(L, true);
+		numResults += LuaUtils::Restore(job->results, L);
+	} else {
+		lua_pushboolean(L, false);
+		lua_pushsstring(L, job->error);
+		numResults += 1;
+	}
+
+	workers.jobs.erase(iter);
+	delete job;
+	return numResults;
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+int LuaWorkers::LoadFileAsync(lua_State* L)
+{
+	// only from unsynced
+	if (CLuaHandle::GetHandleSynced(L))
+		return 0;
+
+	LuaWorkers& workers = GetLuaContextData(L)->workers;
+
+	if (workers.fileLoads.size() >= MAX_JOBS)
+		return 0;
+
+	FileLoad* load = new FileLoad();
+
+	load->fileName = luaL_checkstring(L, 1);
+	load->modes = luaL_optstring(L, 2, SPRING_VFS_RAW_FIRST);
+
+	{
+		std::lock_guard<spring::mutex> lock(fileLoadMutex);
+		numFileLoads += 1;
+	}
+
+	const int jobID = ++workers.lastJobID;
+
+	workers.fileLoads[jobID] = load;
+	load->future = ThreadPool::Enqueue([load]() {
+		CFileHandler fh(load->fileName, load->modes);
+
+		load->loaded = (fh.FileExists() && fh.LoadStringData(load->data));
+
+		{
+			std::lock_guard<spring::mutex> lock(fileLoadMutex);
+			numFileLoads -= 1;
+		}
+
+		fileLoadCond.notify_all();
+	});
+
+	lua_pushnumber(L, jobID);
+	return 1;
+}
+
+
+int LuaWorkers::GetLoadFileAsyncResult(lua_State* L)
+{
+	LuaWorkers& workers = GetLuaContextData(L)->workers;
+
+	const int jobID = luaL_checkint(L, 1);
+	const auto iter = workers.fileLoads.find(jobID);
+
+	if (iter == workers.fileLoads.end())
+		luaL_error(L, "[%s] invalid jobID %d", __func__, jobID);
+
+	FileLoad* load = iter->second;
+
+	// still loading; nothing
+	if (load->future->wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+		return 0;
+
+	int numResults = 2;
+
+	if (load->loaded) {
+		lua_pushboolean(L, true);
+		lua_pushsstring(L, load->data);
+	} else {
+		lua_pushboolean(L, false);
+		lua_pushfstring(L, "could not load \"%s\"", load->fileName.c_str());
+	}
+
+	workers.fileLoads.erase(iter);
+	delete load;
+	return numResults;
+}
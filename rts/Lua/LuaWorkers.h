@@ -0,0 +1,65 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_WORKERS_H
+#define LUA_WORKERS_H
+
+#include <vector>
+
+#include "System/UnorderedMap.hpp"
+#include "System/Threading/SpringThreading.h"
+
+
+struct lua_State;
+
+
+/**
+ * Runs pure Lua functions on ThreadPool workers, each in a sandboxed state
+ * that only has the base, math, string and table libraries (no Spring, gl or
+ * VFS access). Functions must not have upvalues; they are transferred as
+ * bytecode, and arguments and results as plain data (see LuaUtils::Backup).
+ */
+class LuaWorkers {
+	public:
+		LuaWorkers() { jobs.reserve(8); fileLoads.reserve(8); }
+		~LuaWorkers() { Clear(); }
+
+		// cancels and waits for all jobs posted by the owning handle
+		void Clear();
+
+		static bool PushEntries(lua_State* L);
+
+		// blocks until no VFS.LoadFileAsync read (of any handle) is in progress;
+		// called before the VFS archive set is changed
+		static void WaitForFileLoads();
+
+		// exposed through the unsynced VFS table
+		static int LoadFileAsync(lua_State* L);
+		static int GetLoadFileAsyncResult(lua_State* L);
+
+	public:
+		struct Job;
+		struct FileLoad;
+		struct WorkerState;
+
+	private:
+		void RunJob(Job* job);
+
+		WorkerState* AcquireState();
+		void ReleaseState(WorkerState* state);
+
+	private:
+		spring::unordered_map<int, Job*> jobs;
+		spring::unordered_map<int, FileLoad*> fileLoads;
+
+		std::vector<WorkerState*> idleStates;
+		spring::mutex stateMutex;
+
+		int lastJobID = 0;
+
+	private:
+		static int PostWorkerJob(lua_State* L);
+		static int GetWorkerJobResult(lua_State* L);
+};
+
+
+#endif /* LUA_WORKERS_H */
@@ -1,18 +1,23 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 
+#include <limits>
+
 #include "BasicMapDamage.h"
 #include "ReadMap.h"
 #include "MapInfo.h"
 #include "Rendering/Env/GrassDrawer.h"
 #include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/LosHandler.h"
+#include "Sim/Misc/ModInfo.h"
+#include "Sim/Misc/SmoothHeightMesh.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Path/IPathManager.h"
 #include "Sim/Features/FeatureHandler.h"
 #include "System/TimeProfiler.h"
+#include "System/Threading/ThreadPool.h"
 
 
 CBasicMapDamage::CBasicMapDamage()
@@ -88,7 +93,13 @@ void CBasicMapDamage::Explosion(const float3& pos, float strength, float radius)
 	e.x2 = Clamp<int>((pos.x + radius) / SQUARE_SIZE, 1, mapDims.mapxm1);
 	e.y1 = Clamp<int>((pos.z - radius) / SQUARE_SIZE, 1, mapDims.mapym1);
 	e.y2 = Clamp<int>((pos.z + radius) / SQUARE_SIZE, 1, mapDims.mapym1);
-	e.squares.reserve((e.y2 - e.y1 + 1) * (e.x2 - e.x1 + 1));
+
+	const int numCols = e.x2 - e.x1 + 1;
+	const int numRows = e.y2 - e.y1 + 1;
+
+	e.squares.resize(numRows * numCols, 0.0f);
+	grassSquares.clear();
+	grassSquares.resize(numRows * numCols, 0);
 
 	const float* curHeightMap = readMap->GetCornerHeightMapSynced();
 	const float* orgHeightMap = readMap->GetOriginalHeightMapSynced();
@@ -97,16 +108,18 @@ void CBasicMapDamage::Explosion(const float3& pos, float strength, float radius)
 	const float baseStrength = -math::pow(strength, 0.6f) * 3.0f;
 	const float invRadius = 1.0f / radius;
 
-	// figure out how much height to add to each square
-	for (int y = e.y1; y <= e.y2; ++y) {
+	// figure out how much height to add to each square; squares only
+	// depend on the pre-explosion state so rows can run concurrently
+	const auto CalcCraterRow = [&](const int y) {
+		float* rowSquares = &e.squares[(y - e.y1) * numCols];
+		unsigned char* rowGrass = &grassSquares[(y - e.y1) * numCols];
+
 		for (int x = e.x1; x <= e.x2; ++x) {
 			const CSolidObject* so = groundBlockingObjectMap->GroundBlockedUnsafe(y * mapDims.mapx + x);
 
 			// do not change squares with buildings on them here
-			if (so != nullptr && so->blockHeightChanges) {
-				e.squares.push_back(0.0f);
+			if (so != nullptr && so->blockHeightChanges)
 				continue;
-			}
 
 			// calculate the distance and normalize it
 			const float expDist = pos.distance2D(float3(x * SQUARE_SIZE, 0.0f, y * SQUARE_SIZE));
@@ -146,10 +159,25 @@ void CBasicMapDamage::Explosion(const float3& pos, float strength, float radius)
 			if ((prevDif * explDif) > 0.0f)
 				explDif /= ((math::fabs(prevDif) / EXPLOSION_LIFETIME) + 1);
 
-			if (explDif < -0.3f && strength > 200.0f)
-				grassDrawer->RemoveGrass(float3(x * SQUARE_SIZE, 0.0f, y * SQUARE_SIZE));
+			rowSquares[x - e.x1] = explDif;
+			rowGrass[x - e.x1] = (explDif < -0.3f && strength > 200.0f);
+		}
+	};
+
+	if (e.squares.size() < MIN_PARALLEL_SQUARES) {
+		for (int y = e.y1; y <= e.y2; ++y) {
+			CalcCraterRow(y);
+		}
+	} else {
+		for_mt(e.y1, e.y2 + 1, CalcCraterRow);
+	}
+
+	for (int y = e.y1; y <= e.y2; ++y) {
+		for (int x = e.x1; x <= e.x2; ++x) {
+			if (grassSquares[(y - e.y1) * numCols + (x - e.x1)] == 0)
+				continue;
 
-			e.squares.push_back(explDif);
+			grassDrawer->RemoveGrass(float3(x * SQUARE_SIZE, 0.0f, y * SQUARE_SIZE));
 		}
 	}
 
@@ -198,6 +226,7 @@ void CBasicMapDamage::Explosion(const float3& pos, float strength, float radius)
 			eb.tx2 = unit->mapPos.x + unit->xsize;
 			eb.tz1 = unit->mapPos.y;
 			eb.tz2 = unit->mapPos.y + unit->zsize;
+			eb.unit = nullptr;
 		}
 	}
 }
@@ -206,6 +235,11 @@ void CBasicMapDamage::RecalcArea(int x1, int x2, int y1, int y2)
 {
 	readMap->UpdateHeightMapSynced(SRectangle(x1, y1, x2, y2));
 	featureHandler->TerrainChanged(x1, y1, x2, y2);
+
+	if (modInfo.allowSmoothMeshUpdates) {
+		SCOPED_TIMER("Sim::BasicMapDamage::SmoothMesh");
+		smoothGround->UpdateSmoothMesh(SRectangle(x1, y1, x2, y2));
+	}
 	{
 		SCOPED_TIMER("Sim::BasicMapDamage::Los");
 		losHandler->UpdateHeightMapSynced(SRectangle(x1, y1, x2, y2));
@@ -221,41 +255,105 @@ void CBasicMapDamage::Update()
 {
 	SCOPED_TIMER("Sim::BasicMapDamage");
 
+	updateExplosions.clear();
+
+	int minRow = mapDims.mapy;
+	int maxRow = -1;
+	unsigned int numSquares = 0;
+
 	for (Explo& e: explosions) {
 		if (e.ttl <= 0)
 			continue;
 
 		--e.ttl;
 
-		auto si = e.squares.cbegin();
+		// building footprints can stick out of the explosion's area
+		for (ExploBuilding& b: e.buildings) {
+			b.unit = unitHandler->GetUnit(b.id);
 
-		for (int y = e.y1; y <= e.y2; ++y) {
-			for (int x = e.x1; x <= e.x2; ++x) {
-				readMap->AddHeight(y * mapDims.mapxp1 + x, *(si++));
-			}
+			minRow = std::min(minRow, b.tz1);
+			maxRow = std::max(maxRow, b.tz2 - 1);
 		}
 
-		for (const ExploBuilding& b: e.buildings) {
-			CUnit* unit = unitHandler->GetUnit(b.id);
+		updateExplosions.push_back(&e);
 
-			if (unit == nullptr)
-				continue;
+		minRow = std::min(minRow, e.y1);
+		maxRow = std::max(maxRow, e.y2);
+		numSquares += e.squares.size();
 
-			// only change ground level if building is still here
-			for (int z = b.tz1; z < b.tz2; z++) {
-				for (int x = b.tx1; x < b.tx2; x++) {
-					readMap->AddHeight(z * mapDims.mapxp1 + x, b.dif);
+		// optimizer treats rectangles as half-open, RecalcArea as inclusive
+		if (e.ttl == 0) {
+			recalcRects.push_back(SRectangle(e.x1 - 1, e.y1 - 1, e.x2 + 2, e.y2 + 2));
+		}
+	}
+
+	if (!updateExplosions.empty()) {
+		rowHeightBounds.clear();
+		rowHeightBounds.resize(maxRow - minRow + 1, {std::numeric_limits<float>::max(), std::numeric_limits<float>::lowest()});
+
+		// every square receives the deltas of all explosions covering it in
+		// the same order as when they were applied one explosion at a time,
+		// so the heights (and the bounds reached) do not depend on threading
+		const auto ApplyDeltaRow = [&](const int y) {
+			float2& bounds = rowHeightBounds[y - minRow];
+
+			for (const Explo* e: updateExplosions) {
+				if (y < e->y1 || y > e->y2)
+					continue;
+
+				const int numCols = e->x2 - e->x1 + 1;
+				const float* rowSquares = &e->squares[(y - e->y1) * numCols];
+
+				for (int x = e->x1; x <= e->x2; ++x) {
+					readMap->AddHeight(y * mapDims.mapxp1 + x, rowSquares[x - e->x1], bounds);
+				}
+
+				for (const ExploBuilding& b: e->buildings) {
+					// only change ground level if building is still here
+					if (b.unit == nullptr)
+						continue;
+					if (y < b.tz1 || y >= b.tz2)
+						continue;
+
+					for (int x = b.tx1; x < b.tx2; x++) {
+						readMap->AddHeight(y * mapDims.mapxp1 + x, b.dif, bounds);
+					}
 				}
 			}
+		};
 
-			unit->Move(UpVector * b.dif, true);
+		if (numSquares < MIN_PARALLEL_SQUARES) {
+			for (int y = minRow; y <= maxRow; ++y) {
+				ApplyDeltaRow(y);
+			}
+		} else {
+			for_mt(minRow, maxRow + 1, ApplyDeltaRow);
 		}
 
-		if (e.ttl == 0) {
-			RecalcArea(e.x1 - 1, e.x2 + 1, e.y1 - 1, e.y2 + 1);
+		for (const float2& bounds: rowHeightBounds) {
+			readMap->ExpandHeightBounds(bounds);
+		}
+
+		for (const Explo* e: updateExplosions) {
+			for (const ExploBuilding& b: e->buildings) {
+				if (b.unit == nullptr)
+					continue;
+
+				b.unit->Move(UpVector * b.dif, true);
+			}
 		}
 	}
 
+	// coalesce the areas of all explosions that expired this frame, so that
+	// overlapping craters trigger only one update of every dependent system
+	recalcRects.Optimize();
+
+	for (const SRectangle& r: recalcRects) {
+		RecalcArea(r.x1, r.x2 - 1, r.z1, r.z2 - 1);
+	}
+
+	recalcRects.clear();
+
 	while (!explosions.empty()) {
 		const Explo& explosion = explosions.front();
 
@@ -4,6 +4,8 @@
 #define _BASIC_MAP_DAMAGE_H
 
 #include "MapDamage.h"
+#include "System/Misc/RectangleOptimizer.h"
+#include "System/type2.h"
 
 #include <deque>
 #include <vector>
@@ -31,6 +33,9 @@ private:
 		/// How much to move the building and the ground below it.
 		float dif;
 		int tx1, tx2, tz1, tz2;
+
+		/// looked up by id at the start of every Update, null if dead
+		CUnit* unit;
 	};
 
 	struct Explo {
@@ -48,8 +53,20 @@ private:
 
 	std::deque<Explo> explosions;
 
+	/// areas of the explosions that expired during the current Update
+	CRectangleOptimizer recalcRects;
+
+	/// explosions applied during the current Update, in creation order
+	std::vector<Explo*> updateExplosions;
+	/// per-row heights reached during the current Update, see CReadMap::AddHeight
+	std::vector<float2> rowHeightBounds;
+	/// squares of the current Explosion that lose their grass
+	std::vector<unsigned char> grassSquares;
+
 	static const unsigned int CRATER_TABLE_SIZE = 200;
 	static const unsigned int EXPLOSION_LIFETIME = 10;
+	/// smaller areas are not worth spreading over the thread-pool
+	static const unsigned int MIN_PARALLEL_SQUARES = 64 * 64;
 
 	float craterTable[CRATER_TABLE_SIZE + 1];
 	float rawHardness[/*CMapInfo::NUM_TERRAIN_TYPES*/ 256];
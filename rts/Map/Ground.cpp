@@ -206,43 +206,9 @@ inline static bool ClampInMapHeight(float3& from, float3& to)
 }
 
 
-float CGround::LineGroundCol(float3 from, float3 to, bool synced)
+// walks all squares between <from> and <to> (both inside the map)
+static float LineGroundWalkCol(const float* hm, const float3* nm, const float3& from, const float3& to)
 {
-	const float* hm  = readMap->GetSharedCornerHeightMap(synced);
-	const float3* nm = readMap->GetSharedFaceNormals(synced);
-
-	const float3 pfrom = from;
-
-	// only for performance -> skip part that can impossibly collide
-	// with the terrain, cause it is above map's current max height
-	ClampInMapHeight(from, to);
-
-	// handle special cases where the ray origin is out of bounds:
-	// need to move <from> to the closest map-edge along the ray
-	// (if both <from> and <to> are out of bounds, the ray might
-	// still hit)
-	// clamping <from> naively would change the direction of the
-	// ray, hence we save the distance along it that got skipped
-	ClampLineInMap(from, to);
-
-	if (from == to) {
-		// ClampLineInMap & ClampInMapHeight set `from == to == vec(-1,-1,-1)`
-		// in case the line is outside of the map
-		return -1.0f;
-	}
-
-	const float skippedDist = pfrom.distance(from);
-
-	if (synced) { //TODO do this in unsynced too once the map border rendering is finished?
-		// check if our start position is underground (assume ground is unpassable for cannons etc.)
-		const int sx = from.x / SQUARE_SIZE;
-		const int sz = from.z / SQUARE_SIZE;
-
-		if (from.y <= hm[sz * mapDims.mapxp1 + sx]) {
-			return 0.0f + skippedDist;
-		}
-	}
-
 	const float dx = to.x - from.x;
 	const float dz = to.z - from.z;
 	const int dirx = (dx > 0.0f) ? 1 : -1;
@@ -266,7 +232,7 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 		const float ret = LineGroundSquareCol(hm, nm,  from, to,  fsx, fsz);
 
 		if (ret >= 0.0f) {
-			return (ret + skippedDist);
+			return ret;
 		}
 	} else if (fsx == tsx) {
 		// ray is parallel to z-axis
@@ -276,7 +242,7 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 			const float ret = LineGroundSquareCol(hm, nm,  from, to,  fsx, zp);
 
 			if (ret >= 0.0f) {
-				return (ret + skippedDist);
+				return ret;
 			}
 
 			keepgoing = (zp != tsz);
@@ -290,7 +256,7 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 			const float ret = LineGroundSquareCol(hm, nm,  from, to,  xp, fsz);
 
 			if (ret >= 0.0f) {
-				return (ret + skippedDist);
+				return ret;
 			}
 
 			keepgoing = (xp != tsx);
@@ -327,7 +293,7 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 			const float ret = LineGroundSquareCol(hm, nm,  from, to,  curx, curz);
 
 			if (ret >= 0.0f) {
-				return (ret + skippedDist);
+				return ret;
 			}
 
 			// check if we reached the end already and need to stop the loop
@@ -374,6 +340,123 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 	return -1.0f;
 }
 
+
+float CGround::LineGroundCol(float3 from, float3 to, bool synced)
+{
+	const float* hm  = readMap->GetSharedCornerHeightMap(synced);
+	const float3* nm = readMap->GetSharedFaceNormals(synced);
+
+	const float3 pfrom = from;
+
+	// only for performance -> skip part that can impossibly collide
+	// with the terrain, cause it is above map's current max height
+	ClampInMapHeight(from, to);
+
+	// handle special cases where the ray origin is out of bounds:
+	// need to move <from> to the closest map-edge along the ray
+	// (if both <from> and <to> are out of bounds, the ray might
+	// still hit)
+	// clamping <from> naively would change the direction of the
+	// ray, hence we save the distance along it that got skipped
+	ClampLineInMap(from, to);
+
+	if (from == to) {
+		// ClampLineInMap & ClampInMapHeight set `from == to == vec(-1,-1,-1)`
+		// in case the line is outside of the map
+		return -1.0f;
+	}
+
+	const float skippedDist = pfrom.distance(from);
+
+	if (synced) { //TODO do this in unsynced too once the map border rendering is finished?
+		// check if our start position is underground (assume ground is unpassable for cannons etc.)
+		const int sx = from.x / SQUARE_SIZE;
+		const int sz = from.z / SQUARE_SIZE;
+
+		if (from.y <= hm[sz * mapDims.mapxp1 + sx]) {
+			return 0.0f + skippedDist;
+		}
+	}
+
+	// only the synced heightmap has max-height MIP maps
+	if (!synced) {
+		const float ret = LineGroundWalkCol(hm, nm, from, to);
+		return ((ret >= 0.0f)? (ret + skippedDist): -1.0f);
+	}
+
+	// split the line into pieces and only walk those that are not entirely
+	// above the highest ground (corner) under their bounding squares; the
+	// pieces are handled in order so the first hit is still the closest one
+	const float lineSquares = std::max(math::fabs(to.x - from.x), math::fabs(to.z - from.z)) / SQUARE_SIZE;
+
+	const auto GetSquareX = [](float x) { return Clamp(int(x) / SQUARE_SIZE, 0, mapDims.mapxm1); };
+	const auto GetSquareZ = [](float z) { return Clamp(int(z) / SQUARE_SIZE, 0, mapDims.mapym1); };
+
+	const auto IsPieceAboveGround = [&](const float3& p0, const float3& p1) {
+		const int sx0 = std::min(GetSquareX(p0.x), GetSquareX(p1.x));
+		const int sx1 = std::max(GetSquareX(p0.x), GetSquareX(p1.x));
+		const int sz0 = std::min(GetSquareZ(p0.z), GetSquareZ(p1.z));
+		const int sz1 = std::max(GetSquareZ(p0.z), GetSquareZ(p1.z));
+
+		// smallest (corner-based, so >= 1) MIP level at which the squares fit into 2x2 texels
+		int mip = 1;
+
+		while (((sx1 >> mip) - (sx0 >> mip)) > 1 || ((sz1 >> mip) - (sz0 >> mip)) > 1) {
+			if ((++mip) >= CReadMap::numHeightMipMaps)
+				return false;
+		}
+
+		const float* maxHeightMap = readMap->GetMIPMaxHeightMapSynced(mip);
+		const int mipSizeX = mapDims.mapx >> mip;
+		const int mipSizeZ = mapDims.mapy >> mip;
+
+		float maxGroundHeight = std::numeric_limits<float>::lowest();
+
+		for (int z = (sz0 >> mip); z <= (sz1 >> mip); z++) {
+			for (int x = (sx0 >> mip); x <= (sx1 >> mip); x++) {
+				// squares on odd-sized borders are not covered by any texel
+				if (x >= mipSizeX || z >= mipSizeZ)
+					return false;
+
+				maxGroundHeight = std::max(maxGroundHeight, maxHeightMap[x + z * mipSizeX]);
+			}
+		}
+
+		return (maxGroundHeight < (std::min(p0.y, p1.y) - 1.0f));
+	};
+
+	std::pair<float, float> pieces[64];
+	int numPieces = 0;
+
+	pieces[numPieces++] = {0.0f, 1.0f};
+
+	while (numPieces > 0) {
+		const std::pair<float, float> piece = pieces[--numPieces];
+
+		const float3 p0 = mix(from, to, piece.first);
+		const float3 p1 = mix(from, to, piece.second);
+
+		if (IsPieceAboveGround(p0, p1))
+			continue;
+
+		if (((piece.second - piece.first) * lineSquares) > 8.0f && numPieces < 62) {
+			// test the first half first
+			const float mid = (piece.first + piece.second) * 0.5f;
+
+			pieces[numPieces++] = {mid, piece.second};
+			pieces[numPieces++] = {piece.first, mid};
+			continue;
+		}
+
+		const float ret = LineGroundWalkCol(hm, nm, p0, p1);
+
+		if (ret >= 0.0f)
+			return (from.distance(p0) + ret + skippedDist);
+	}
+
+	return -1.0f;
+}
+
 float CGround::LineGroundCol(const float3 pos, const float3 dir, float len, bool synced)
 {
 	return (LineGroundCol(pos, pos + dir * std::max(len, 0.0f), synced));
@@ -539,11 +622,94 @@ float CGround::TrajectoryGroundCol(float3 from, const float3& flatdir, float len
 	const float near = length * std::max(0.0f, near_far.first);
 	const float far  = length * std::min(1.0f, near_far.second);
 
-	for (float l = near; l < far; l += SQUARE_SIZE) {
-		const float3 pos = (from + dir * l) + (UpVector * quadratic * l * l);
+	if (near >= far)
+		return -1.0f;
+
+	// the trajectory is sampled at l = near + i * SQUARE_SIZE (for l < far);
+	// runs of samples are rejected as a whole when the highest ground below
+	// them (from the max-height MIP maps) stays under their lowest point, so
+	// this returns the same first colliding sample as testing all of them
+	const int numSamples = int(math::ceil((far - near) / SQUARE_SIZE));
+
+	const auto GetSamplePos = [&](float l) { return ((from + dir * l) + (UpVector * quadratic * l * l)); };
+	const auto GetSampleDist = [&](int i) { return (near + i * SQUARE_SIZE); };
+	const auto GetSquareX = [](float x) { return Clamp(int(x) / SQUARE_SIZE, 0, mapDims.mapxm1); };
+	const auto GetSquareZ = [](float z) { return Clamp(int(z) / SQUARE_SIZE, 0, mapDims.mapym1); };
+
+	const auto IsRunAboveGround = [&](int i0, int i1) {
+		const float l0 = GetSampleDist(i0);
+		const float l1 = GetSampleDist(i1);
+		const float3 p0 = GetSamplePos(l0);
+		const float3 p1 = GetSamplePos(l1);
+
+		float minHeight = std::min(p0.y, p1.y);
+
+		// apex of an upward-curved trajectory (positive quadratic term)
+		if (quadratic > 0.0f) {
+			const float la = -linear / (2.0f * quadratic);
+
+			if (la > l0 && la < l1)
+				minHeight = std::min(minHeight, GetSamplePos(la).y);
+		}
+
+		const int sx0 = std::min(GetSquareX(p0.x), GetSquareX(p1.x));
+		const int sx1 = std::max(GetSquareX(p0.x), GetSquareX(p1.x));
+		const int sz0 = std::min(GetSquareZ(p0.z), GetSquareZ(p1.z));
+		const int sz1 = std::max(GetSquareZ(p0.z), GetSquareZ(p1.z));
+
+		// smallest MIP level at which the squares fit into 2x2 texels
+		int mip = 0;
+
+		while (((sx1 >> mip) - (sx0 >> mip)) > 1 || ((sz1 >> mip) - (sz0 >> mip)) > 1) {
+			if ((++mip) >= CReadMap::numHeightMipMaps)
+				return false;
+		}
+
+		const float* maxHeightMap = readMap->GetMIPMaxHeightMapSynced(mip);
+		const int mipSizeX = mapDims.mapx >> mip;
+
+		float maxGroundHeight = std::numeric_limits<float>::lowest();
+
+		for (int z = (sz0 >> mip); z <= (sz1 >> mip); z++) {
+			for (int x = (sx0 >> mip); x <= (sx1 >> mip); x++) {
+				maxGroundHeight = std::max(maxGroundHeight, maxHeightMap[x + z * mipSizeX]);
+			}
+		}
+
+		// leave some room for rounding of the interior samples
+		return (maxGroundHeight < (minHeight - 1.0f));
+	};
+
+	std::pair<int, int> runs[64];
+	int numRuns = 0;
+
+	runs[numRuns++] = {0, numSamples - 1};
 
-		if (GetApproximateHeight(pos.x, pos.z) > pos.y) {
-			return l;
+	while (numRuns > 0) {
+		const std::pair<int, int> run = runs[--numRuns];
+
+		if ((run.second - run.first) >= 4) {
+			if (IsRunAboveGround(run.first, run.second))
+				continue;
+
+			// test the first half first
+			const int mid = (run.first + run.second) >> 1;
+
+			runs[numRuns++] = {mid + 1, run.second};
+			runs[numRuns++] = {run.first, mid};
+			continue;
+		}
+
+		for (int i = run.first; i <= run.second; i++) {
+			const float l = GetSampleDist(i);
+			const float3 pos = GetSamplePos(l);
+
+			if (l >= far)
+				return -1.0f;
+
+			if (GetApproximateHeight(pos.x, pos.z) > pos.y) {
+				return l;
+			}
 		}
 	}
 
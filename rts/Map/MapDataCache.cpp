@@ -0,0 +1,192 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+
+#include "MapDataCache.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/FileSystem/MappedFile.h"
+#include "System/Log/ILog.h"
+#include "System/StringUtil.h"
+#include "System/Sync/HsiehHash.h"
+
+CONFIG(bool, MapDataCache).defaultValue(true).description("Cache the normals, slopes and smoothed heights derived from a map's heightmap in CacheDir, s.t. later loads of the same map can skip computing them.");
+
+
+/*
+ * cache-file layout (all sizes and positions in bytes):
+ *   header, section sizes (numSections entries)
+ *   [aligned] data of every section, each starting at an aligned position
+ */
+static constexpr std::uint32_t MAP_DATA_CACHE_VERSION = 1;
+static constexpr std::uint32_t MAP_DATA_CACHE_ALIGNMENT = 16;
+static constexpr char MAP_DATA_CACHE_MAGIC[8] = {'S', 'P', 'R', 'M', 'D', 'C', 'C', '\0'};
+
+struct MapDataCacheHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t hashCode;
+	std::uint32_t numSections;
+	std::uint32_t dataChecksum; // over the data of all sections
+	std::uint64_t dataPos;
+	std::uint64_t fileSize;
+};
+
+static std::uint64_t AlignMapDataCachePos(std::uint64_t pos) {
+	return ((pos + MAP_DATA_CACHE_ALIGNMENT - 1) & ~std::uint64_t(MAP_DATA_CACHE_ALIGNMENT - 1));
+}
+
+static std::uint32_t CalcMapDataCacheChecksum(const std::uint8_t* data, std::uint64_t size, std::uint32_t cs) {
+	// HsiehHash takes an int length
+	for (std::uint64_t pos = 0, len = 0; pos < size; pos += len) {
+		len = std::min(size - pos, std::uint64_t(1) << 30);
+		cs = HsiehHash(data + pos, len, cs);
+	}
+
+	return cs;
+}
+
+
+CMapDataCache::CMapDataCache(const std::string& name, std::uint32_t hashCode_)
+	: fileName(FileSystem::GetCacheDir() + "/maps/" + name + "-" + IntToString(hashCode_, "%x") + ".mapcache")
+	, hashCode(hashCode_)
+{
+}
+
+bool CMapDataCache::IsEnabled() { return (configHandler->GetBool("MapDataCache")); }
+
+
+bool CMapDataCache::Read()
+{
+	if (!FileSystem::FileExists(fileName))
+		return false;
+
+	CMappedFile file;
+
+	const auto DiscardFile = [&]() {
+		file.Close();
+		FileSystem::Remove(fileName);
+		return false;
+	};
+
+	if (!file.Open(dataDirsAccess.LocateFile(fileName)))
+		return false;
+
+	const std::uint8_t* fileData = file.GetData();
+	const std::uint64_t fileSize = file.GetSize();
+
+	if (fileSize < (sizeof(MapDataCacheHeader) + sections.size() * sizeof(std::uint64_t)))
+		return (DiscardFile());
+
+	MapDataCacheHeader header;
+	std::memcpy(&header, fileData, sizeof(header));
+
+	if (std::memcmp(header.magic, MAP_DATA_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != MAP_DATA_CACHE_VERSION)
+		return (DiscardFile());
+	if (header.hashCode != hashCode || header.numSections != sections.size())
+		return (DiscardFile());
+	if (header.fileSize != fileSize || header.dataPos > fileSize)
+		return (DiscardFile());
+
+	std::vector<std::uint64_t> sectionPositions(sections.size());
+	std::uint32_t dataChecksum = 0;
+	std::uint64_t pos = header.dataPos;
+
+	for (size_t n = 0; n < sections.size(); n++) {
+		std::uint64_t size = 0;
+		std::memcpy(&size, fileData + sizeof(MapDataCacheHeader) + n * sizeof(size), sizeof(size));
+
+		if (size != sections[n].size || (pos + size) > fileSize)
+			return (DiscardFile());
+
+		dataChecksum = CalcMapDataCacheChecksum(fileData + pos, size, dataChecksum);
+		sectionPositions[n] = pos;
+
+		pos = AlignMapDataCachePos(pos + size);
+	}
+
+	if (dataChecksum != header.dataChecksum)
+		return (DiscardFile());
+
+	// everything checks out, only now overwrite the targets
+	for (size_t n = 0; n < sections.size(); n++) {
+		std::memcpy(sections[n].data, fileData + sectionPositions[n], sections[n].size);
+	}
+
+	LOG("[MapDataCache::%s] file=\"%s\"", __func__, fileName.c_str());
+	return true;
+}
+
+bool CMapDataCache::Write() const
+{
+	FileSystem::CreateDirectory(FileSystem::GetCacheDir() + "/maps/");
+
+	const std::string tempFileName = dataDirsAccess.LocateFile(fileName + ".tmp", FileQueryFlags::WRITE);
+
+	MapDataCacheHeader header;
+
+	std::memcpy(header.magic, MAP_DATA_CACHE_MAGIC, sizeof(header.magic));
+	header.version = MAP_DATA_CACHE_VERSION;
+	header.hashCode = hashCode;
+	header.numSections = sections.size();
+	header.dataChecksum = 0;
+	header.dataPos = AlignMapDataCachePos(sizeof(MapDataCacheHeader) + sections.size() * sizeof(std::uint64_t));
+	header.fileSize = header.dataPos;
+
+	std::vector<std::uint64_t> sectionSizes(sections.size());
+
+	for (size_t n = 0; n < sections.size(); n++) {
+		// the last section is not padded
+		header.fileSize = AlignMapDataCachePos(header.fileSize) + sections[n].size;
+		header.dataChecksum = CalcMapDataCacheChecksum(reinterpret_cast<const std::uint8_t*>(sections[n].data), sections[n].size, header.dataChecksum);
+
+		sectionSizes[n] = sections[n].size;
+	}
+
+	{
+		std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+			return false;
+
+		const char padding[MAP_DATA_CACHE_ALIGNMENT] = {0};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(sectionSizes.data()), sectionSizes.size() * sizeof(std::uint64_t));
+		file.write(padding, header.dataPos - (sizeof(header) + sectionSizes.size() * sizeof(std::uint64_t)));
+
+		for (std::uint64_t n = 0, pos = header.dataPos; n < sections.size(); n++) {
+			file.write(padding, AlignMapDataCachePos(pos) - pos);
+			file.write(reinterpret_cast<const char*>(sections[n].data), sections[n].size);
+
+			pos = AlignMapDataCachePos(pos) + sections[n].size;
+		}
+
+		if (!file.good()) {
+			file.close();
+			FileSystem::Remove(tempFileName);
+			return false;
+		}
+	}
+
+	const std::string destFileName = dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE);
+
+	#ifdef _WIN32
+	// rename does not replace existing files here
+	FileSystem::Remove(destFileName);
+	#endif
+
+	// other instances must never see a partially written file
+	if (std::rename(tempFileName.c_str(), destFileName.c_str()) != 0) {
+		FileSystem::Remove(tempFileName);
+		return false;
+	}
+
+	LOG("[MapDataCache::%s] file=\"%s\"", __func__, fileName.c_str());
+	return true;
+}
@@ -0,0 +1,44 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef MAP_DATA_CACHE_H
+#define MAP_DATA_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief stores data derived from a map in CacheDir/maps/
+ *
+ * Sections are registered in a fixed order, each as a buffer of known size
+ * that Read fills and Write stores. The file name contains a hash of all
+ * inputs (heightmap, map dimensions, derivation constants) which the header
+ * repeats; files are memory-mapped and only trusted if header, section sizes
+ * and the data checksum all match.
+ */
+class CMapDataCache {
+public:
+	CMapDataCache(const std::string& name, std::uint32_t hashCode);
+
+	template<typename T> void AddSection(std::vector<T>& v) { AddSection(v.data(), v.size() * sizeof(T)); }
+	void AddSection(void* data, std::uint64_t size) { sections.push_back({data, size}); }
+
+	/// fills all sections, false (and untouched sections) if there is no valid file
+	bool Read();
+	bool Write() const;
+
+	static bool IsEnabled();
+
+private:
+	struct Section {
+		void* data;
+		std::uint64_t size;
+	};
+
+	std::string fileName;
+	std::uint32_t hashCode;
+
+	std::vector<Section> sections;
+};
+
+#endif // MAP_DATA_CACHE_H
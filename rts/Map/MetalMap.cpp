@@ -6,6 +6,7 @@
 #include "System/myMath.h"
 #include "System/EventHandler.h"
 
+#include <algorithm>
 #include <cstring>
 
 CONFIG(bool, MetalMapPalette).defaultValue(false);
@@ -18,15 +19,29 @@ CR_REG_METADATA(CMetalMap,(
 	CR_MEMBER(sizeZ),
 	CR_MEMBER(metalPal),
 	CR_MEMBER(distributionMap),
-	CR_MEMBER(extractionMap)
+	CR_MEMBER(extractionMap),
+	CR_MEMBER(coverHeads),
+	CR_MEMBER(covers),
+	CR_MEMBER(freeCover)
+))
+
+CR_BIND(CMetalMap::ExtractorCover, )
+CR_REG_METADATA_SUB(CMetalMap, ExtractorCover, (
+	CR_MEMBER(unitID),
+	CR_MEMBER(areaIdx),
+	CR_MEMBER(next),
+	CR_MEMBER(depth),
+	CR_MEMBER(share)
 ))
 
 CMetalMap::CMetalMap(const unsigned char* map, int _sizeX, int _sizeZ, float _metalScale)
 	: metalScale(_metalScale)
 	, sizeX(_sizeX)
 	, sizeZ(_sizeZ)
+	, freeCover(-1)
 {
 	extractionMap.resize(sizeX * sizeZ, 0.0f);
+	coverHeads.resize(sizeX * sizeZ, -1);
 	distributionMap.resize(sizeX * sizeZ, 0);
 
 	if (map != NULL) {
@@ -105,31 +120,80 @@ void CMetalMap::SetMetalAmount(int x, int z, float m)
 }
 
 
-float CMetalMap::RequestExtraction(int x, int z, float toDepth)
+float CMetalMap::AddExtractor(int x, int z, int unitID, int areaIdx, float toDepth)
 {
 	ClampInt(x, 0, sizeX);
 	ClampInt(z, 0, sizeZ);
 
-	const float current = extractionMap[(z * sizeX) + x];
+	int coverIdx = freeCover;
 
-	if (toDepth <= current) {
-		return 0.0f;
+	if (coverIdx != -1) {
+		freeCover = covers[coverIdx].next;
+	} else {
+		coverIdx = covers.size();
+		covers.emplace_back();
 	}
 
-	const float available = toDepth - current;
+	const int sqrIdx = (z * sizeX) + x;
+	// deepest extraction of everything covering the square before us
+	const float current = extractionMap[sqrIdx];
+
+	ExtractorCover& cover = covers[coverIdx];
+	cover.unitID = unitID;
+	cover.areaIdx = areaIdx;
+	cover.next = -1;
+	cover.depth = toDepth;
+	cover.share = std::max(toDepth - current, 0.0f);
+
+	// append, the list order decides who owns which depth-range
+	int* link = &coverHeads[sqrIdx];
 
-	extractionMap[(z * sizeX) + x] = toDepth;
+	while (*link != -1)
+		link = &covers[*link].next;
 
-	return available;
+	*link = coverIdx;
+
+	extractionMap[sqrIdx] = std::max(current, toDepth);
+	return cover.share;
 }
 
 
-void CMetalMap::RemoveExtraction(int x, int z, float depth)
+void CMetalMap::RemoveExtractor(int x, int z, int unitID, std::vector<ExtractionChange>& changes)
 {
 	ClampInt(x, 0, sizeX);
 	ClampInt(z, 0, sizeZ);
 
-	extractionMap[(z * sizeX) + x] -= depth;
+	const int sqrIdx = (z * sizeX) + x;
+
+	for (int* link = &coverHeads[sqrIdx]; *link != -1; link = &covers[*link].next) {
+		const int coverIdx = *link;
+
+		if (covers[coverIdx].unitID != unitID)
+			continue;
+
+		*link = covers[coverIdx].next;
+
+		covers[coverIdx].next = freeCover;
+		freeCover = coverIdx;
+		break;
+	}
+
+	float depth = 0.0f;
+
+	// re-derive every remaining share in arrival order
+	for (int coverIdx = coverHeads[sqrIdx]; coverIdx != -1; coverIdx = covers[coverIdx].next) {
+		ExtractorCover& cover = covers[coverIdx];
+
+		const float share = std::max(cover.depth - depth, 0.0f);
+
+		if (share != cover.share)
+			changes.push_back({cover.unitID, cover.areaIdx, share - cover.share});
+
+		cover.share = share;
+		depth = std::max(depth, cover.depth);
+	}
+
+	extractionMap[sqrIdx] = depth;
 }
 
 
@@ -15,6 +15,7 @@ static const float METAL_MAP_SQUARE_SIZE = SQUARE_SIZE * 2;
 class CMetalMap
 {
 	CR_DECLARE_STRUCT(CMetalMap)
+	CR_DECLARE_SUB(ExtractorCover)
 
 public:
 	/** Receiving a map over all metal, and creating a map over extraction. */
@@ -26,21 +27,28 @@ public:
 	float GetMetalAmount(int x, int z);
 	/** Sets the amount of metal on a single square. */
 	void SetMetalAmount(int x, int z, float m);
+	/// change of the depth an extractor gets from one of its squares
+	struct ExtractionChange {
+		int unitID;
+		int areaIdx;
+		float delta;
+	};
+
 	/**
-	 * Makes a request for extracting metal from a given square.
-	 * If there is metal left to extract to the requested depth,
-	 * the amount available will be returned and the requested
-	 * depth will be sat as new extraction-depth on the extraction-map.
-	 * If the requested depth is greater than the current
-	 * extraction-depth 0.0 will be returned and nothing changed.
+	 * Adds an extractor to the list of those covering a square.
+	 * Extractors on a square are ordered by arrival; each one gets
+	 * whatever part of its depth is not already dug out by the ones
+	 * before it, which is also the share returned here (0.0 if the
+	 * square is dug at least as deep already).
+	 * areaIdx is handed back unchanged through ExtractionChange.
 	 */
-	float RequestExtraction(int x, int z, float toDepth);
+	float AddExtractor(int x, int z, int unitID, int areaIdx, float toDepth);
 	/**
-	 * When a extraction ends, the digged depth should be left
-	 * back to the extraction-map. To be available for other
-	 * extractors to use.
+	 * Removes an extractor from a square and hands its share to the
+	 * extractors after it; one ExtractionChange is appended for every
+	 * one whose share changed. Only this square is touched.
 	 */
-	void RemoveExtraction(int x, int z, float depth);
+	void RemoveExtractor(int x, int z, int unitID, std::vector<ExtractionChange>& changes);
 
 	int GetMetalExtraction(int x, int z);
 
@@ -61,6 +69,24 @@ private:
 
 	std::vector<unsigned char> distributionMap;
 	std::vector<        float> extractionMap;
+
+	struct ExtractorCover {
+		CR_DECLARE_STRUCT(ExtractorCover)
+
+		int unitID;
+		int areaIdx;
+		int next;
+
+		float depth;
+		float share;
+	};
+
+	/// per square, index of the first ExtractorCover covering it (or -1)
+	std::vector<int> coverHeads;
+	/// linked lists of coverHeads; recycled entries are chained by freeCover
+	std::vector<ExtractorCover> covers;
+
+	int freeCover;
 };
 
 #endif /* METAL_MAP_H */
@@ -3,15 +3,18 @@
 
 #include <cstdlib>
 #include <cstring> // memcpy
+#include <limits>
 
 #include "ReadMap.h"
 #include "MapDamage.h"
+#include "MapDataCache.h"
 #include "MapInfo.h"
 #include "MetalMap.h"
 #include "Rendering/Env/MapRendering.h"
 #include "SMF/SMFReadMap.h"
 #include "Game/LoadScreen.h"
 #include "System/bitops.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/EventHandler.h"
 #include "System/Exceptions.h"
 #include "System/myMath.h"
@@ -27,6 +30,7 @@
 #ifdef USE_UNSYNCED_HEIGHTMAP
 #include "Game/GlobalUnsynced.h"
 #include "Sim/Misc/LosHandler.h"
+#include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #endif
 
 //////////////////////////////////////////////////////////////////////
@@ -103,6 +107,8 @@ CR_REG_METADATA(CReadMap, (
 
 
 
+CONFIG(int, HeightMapUpdateAreaLimit).defaultValue(256 * 256).minimumValue(0).description("Maximum heightmap area (in squares) whose normals and textures are refreshed per frame after terrain deformation, the rest is deferred to later frames. 0 means no limit.");
+
 // initialized in CGame::LoadMap
 CReadMap* readMap = nullptr;
 
@@ -111,6 +117,7 @@ MapDimensions mapDims;
 std::vector<float> CReadMap::originalHeightMap;
 std::vector<float> CReadMap::centerHeightMap;
 std::array<std::vector<float>, CReadMap::numHeightMipMaps - 1> CReadMap::mipCenterHeightMaps;
+std::array<std::vector<float>, CReadMap::numHeightMipMaps - 1> CReadMap::mipMaxHeightMaps;
 
 std::vector<float3> CReadMap::visVertexNormals;
 std::vector<float3> CReadMap::faceNormalsSynced;
@@ -299,9 +306,9 @@ void CReadMap::Initialize()
 			((  mapDims.hmapx     * mapDims.hmapy           * sizeof(float))         / 1024) +   // MetalMap::extractionMap
 			((  mapDims.hmapx     * mapDims.hmapy           * sizeof(unsigned char)) / 1024);    // MetalMap::metalMap
 
-		// mipCenterHeightMaps[i]
+		// mipCenterHeightMaps[i], mipMaxHeightMaps[i]
 		for (int i = 1; i < numHeightMipMaps; i++) {
-			reqMemFootPrintKB += ((((mapDims.mapx >> i) * (mapDims.mapy >> i)) * sizeof(float)) / 1024);
+			reqMemFootPrintKB += ((((mapDims.mapx >> i) * (mapDims.mapy >> i)) * 2 * sizeof(float)) / 1024);
 		}
 
 		sprintf(loadMsg, fmtString, reqMemFootPrintKB / 1024);
@@ -332,6 +339,8 @@ void CReadMap::Initialize()
 	for (int i = 1; i < numHeightMipMaps; i++) {
 		mipCenterHeightMaps[i - 1].clear();
 		mipCenterHeightMaps[i - 1].resize((mapDims.mapx >> i) * (mapDims.mapy >> i));
+		mipMaxHeightMaps[i - 1].clear();
+		mipMaxHeightMaps[i - 1].resize((mapDims.mapx >> i) * (mapDims.mapy >> i));
 
 		mipPointerHeightMaps[i] = &mipCenterHeightMaps[i - 1][0];
 	}
@@ -446,8 +455,14 @@ void CReadMap::UpdateDraw(bool firstCall)
 			if (!unsyncedHeightMapUpdatesTemp.empty()) {
 				unsyncedHeightMapUpdatesTemp.Optimize();
 
+				const int maxUpdateArea = configHandler->GetInt("HeightMapUpdateAreaLimit");
+
 				int updateArea = unsyncedHeightMapUpdatesTemp.GetTotalArea() * 0.0625f + (50 * 50);
 
+				// bound the per-frame cost of mass deformations, the remaining rects are spread over later frames
+				if (maxUpdateArea > 0)
+					updateArea = std::min(updateArea, maxUpdateArea);
+
 				while (updateArea > 0 && !unsyncedHeightMapUpdatesTemp.empty()) {
 					const SRectangle& rect = unsyncedHeightMapUpdatesTemp.front();
 					updateArea -= rect.GetArea();
@@ -485,10 +500,20 @@ void CReadMap::UpdateHeightMapSynced(SRectangle hmRect, bool initialize)
 	hmRect.x2 = std::min(mapDims.mapxm1, hmRect.x2 + 1);
 	hmRect.z2 = std::min(mapDims.mapym1, hmRect.z2 + 1);
 
-	UpdateCenterHeightmap(hmRect, initialize);
-	UpdateMipHeightmaps(hmRect, initialize);
-	UpdateFaceNormals(hmRect, initialize);
-	UpdateSlopemap(hmRect, initialize); // must happen after UpdateFaceNormals()!
+	// the pristine map derives the same data on every load
+	if (!initialize || !ReadDerivedMapCache()) {
+		UpdateCenterHeightmap(hmRect, initialize);
+		UpdateMipHeightmaps(hmRect, initialize);
+		UpdateMipMaxHeightmaps(hmRect);
+		UpdateFaceNormals(hmRect, initialize);
+		UpdateSlopemap(hmRect, initialize); // must happen after UpdateFaceNormals()!
+
+		if (initialize)
+			WriteDerivedMapCache();
+	}
+
+	// cover the (typemap-resolution) squares touched by UpdateSlopemap
+	CMoveMath::UpdateSpeedModMaps(hmRect.x1 - 2, hmRect.z1 - 2, hmRect.x2 + 2, hmRect.z2 + 2);
 
 	assert(initialize == (losHandler == nullptr));
 
@@ -568,6 +593,48 @@ void CReadMap::UpdateMipHeightmaps(const SRectangle& rect, bool initialize)
 }
 
 
+void CReadMap::UpdateMipMaxHeightmaps(const SRectangle& rect)
+{
+	const float* heightmapSynced = GetCornerHeightMapSynced();
+
+	// the first level is built from the corners of its 2x2 squares rather
+	// than their center heights, s.t. it bounds the triangle faces as well
+	for (int y = (rect.z1 >> 1), ey = std::min(rect.z2 >> 1, (mapDims.mapy >> 1) - 1); y <= ey; y++) {
+		for (int x = (rect.x1 >> 1), ex = std::min(rect.x2 >> 1, (mapDims.mapx >> 1) - 1); x <= ex; x++) {
+			float maxHeight = std::numeric_limits<float>::lowest();
+
+			for (int cz = y * 2; cz <= (y * 2 + 2); cz++) {
+				for (int cx = x * 2; cx <= (x * 2 + 2); cx++) {
+					maxHeight = std::max(maxHeight, heightmapSynced[cz * mapDims.mapxp1 + cx]);
+				}
+			}
+
+			mipMaxHeightMaps[0][x + y * (mapDims.mapx >> 1)] = maxHeight;
+		}
+	}
+
+	for (int i = 2; i < numHeightMipMaps; i++) {
+		const int topSizeX = mapDims.mapx >> (i - 1);
+		const int subSizeX = mapDims.mapx >> i;
+		const int subSizeY = mapDims.mapy >> i;
+
+		const float* topMipMap = GetMIPMaxHeightMapSynced(i - 1);
+		      float* subMipMap = &mipMaxHeightMaps[i - 1][0];
+
+		for (int y = (rect.z1 >> i), ey = std::min(rect.z2 >> i, subSizeY - 1); y <= ey; y++) {
+			for (int x = (rect.x1 >> i), ex = std::min(rect.x2 >> i, subSizeX - 1); x <= ex; x++) {
+				const int topIdx = (x * 2) + (y * 2) * topSizeX;
+
+				subMipMap[x + y * subSizeX] = std::max(
+					std::max(topMipMap[topIdx           ], topMipMap[topIdx            + 1]),
+					std::max(topMipMap[topIdx + topSizeX], topMipMap[topIdx + topSizeX + 1])
+				);
+			}
+		}
+	}
+}
+
+
 void CReadMap::UpdateFaceNormals(const SRectangle& rect, bool initialize)
 {
 	const float* heightmapSynced = GetCornerHeightMapSynced();
@@ -680,6 +747,54 @@ void CReadMap::UpdateSlopemap(const SRectangle& rect, bool initialize)
 }
 
 
+// bump when anything derived by UpdateHeightMapSynced changes
+static constexpr std::uint32_t DERIVED_MAP_CACHE_VERSION = 3;
+
+CMapDataCache CReadMap::GetDerivedMapCache()
+{
+	const std::uint32_t hashData[] = {mapChecksum, DERIVED_MAP_CACHE_VERSION, std::uint32_t(mapDims.mapx), std::uint32_t(mapDims.mapy), sizeof(float3)};
+
+	CMapDataCache cache("heightmap", HsiehHash(hashData, sizeof(hashData), 0));
+
+	cache.AddSection(centerHeightMap);
+	for (std::vector<float>& mipHeightMap: mipCenterHeightMaps) {
+		cache.AddSection(mipHeightMap);
+	}
+	for (std::vector<float>& mipHeightMap: mipMaxHeightMaps) {
+		cache.AddSection(mipHeightMap);
+	}
+	cache.AddSection(faceNormalsSynced);
+	cache.AddSection(centerNormalsSynced);
+	cache.AddSection(centerNormals2D);
+	cache.AddSection(slopeMap);
+	return cache;
+}
+
+bool CReadMap::ReadDerivedMapCache()
+{
+	if (!CMapDataCache::IsEnabled())
+		return false;
+	if (!GetDerivedMapCache().Read())
+		return false;
+
+	#ifdef USE_UNSYNCED_HEIGHTMAP
+	std::copy(faceNormalsSynced.begin(), faceNormalsSynced.end(), faceNormalsUnsynced.begin());
+	std::copy(centerNormalsSynced.begin(), centerNormalsSynced.end(), centerNormalsUnsynced.begin());
+	#endif
+	return true;
+}
+
+void CReadMap::WriteDerivedMapCache()
+{
+	if (!CMapDataCache::IsEnabled())
+		return;
+	if (GetDerivedMapCache().Write())
+		return;
+
+	LOG_L(L_WARNING, "[ReadMap::%s] could not write the derived-map cache", __func__);
+}
+
+
 /// split the update into multiple invididual (los-square) chunks
 void CReadMap::HeightMapUpdateLOSCheck(const SRectangle& hmRect)
 {
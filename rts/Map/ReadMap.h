@@ -23,6 +23,7 @@ class CCamera;
 class CUnit;
 class CSolidObject;
 class CBaseGroundDrawer;
+class CMapDataCache;
 
 
 struct MapFeatureInfo
@@ -161,6 +162,9 @@ public:
 	const float* GetOriginalHeightMapSynced() const { return &originalHeightMap[0]; }
 	const float* GetCenterHeightMapSynced() const { return &centerHeightMap[0]; }
 	const float* GetMIPHeightMapSynced(unsigned int mip) const { return mipPointerHeightMaps[mip]; }
+	/// like GetMIPHeightMapSynced, but every texel holds the maximum height of its squares
+	/// (of their centers for mip=0, of their corners for mip>0)
+	const float* GetMIPMaxHeightMapSynced(unsigned int mip) const { return ((mip == 0)? &centerHeightMap[0]: &mipMaxHeightMaps[mip - 1][0]); }
 	const float* GetSlopeMapSynced() const { return &slopeMap[0]; }
 	const uint8_t* GetTypeMapSynced() const { return &typeMap[0]; }
 	      uint8_t* GetTypeMapSynced()       { return &typeMap[0]; }
@@ -189,6 +193,10 @@ public:
 	/// if you modify the heightmap through these, call UpdateHeightMapSynced
 	float SetHeight(const int idx, const float h, const int add = 0);
 	float AddHeight(const int idx, const float a);
+	/// for concurrent writes to distinct indices; the reached heights are
+	/// collected in <bounds>, which has to be passed to ExpandHeightBounds
+	float AddHeight(const int idx, const float a, float2& bounds);
+	void ExpandHeightBounds(const float2& bounds);
 
 
 	float GetInitMinHeight() const { return initHeightBounds.x; }
@@ -210,9 +218,15 @@ public:
 private:
 	void UpdateCenterHeightmap(const SRectangle& rect, bool initialize);
 	void UpdateMipHeightmaps(const SRectangle& rect, bool initialize);
+	void UpdateMipMaxHeightmaps(const SRectangle& rect);
 	void UpdateFaceNormals(const SRectangle& rect, bool initialize);
 	void UpdateSlopemap(const SRectangle& rect, bool initialize);
 
+	/// read or write everything derived from the pristine heightmap by the above
+	CMapDataCache GetDerivedMapCache();
+	bool ReadDerivedMapCache();
+	void WriteDerivedMapCache();
+
 	inline void HeightMapUpdateLOSCheck(const SRectangle& hmRect);
 	inline bool HasHeightMapChanged(const int lmx, const int lmy);
 
@@ -235,6 +249,7 @@ protected:
 	static std::vector<float> originalHeightMap;        //< size: (mapx+1)*(mapy+1) (per vertex) [SYNCED, does NOT update on terrain deformation]
 	static std::vector<float> centerHeightMap;          //< size: (mapx  )*(mapy  ) (per face) [SYNCED, updates on terrain deformation]
 	static std::array<std::vector<float>, numHeightMipMaps - 1> mipCenterHeightMaps;
+	static std::array<std::vector<float>, numHeightMipMaps - 1> mipMaxHeightMaps; //< same sizes as mipCenterHeightMaps [SYNCED]
 
 	/**
 	 * array of pointers to heightmaps in different resolutions
@@ -305,6 +320,22 @@ inline float CReadMap::AddHeight(const int idx, const float a) {
 	return SetHeight(idx, a, 1);
 }
 
+inline float CReadMap::AddHeight(const int idx, const float a, float2& bounds) {
+	float& x = (*heightMapSyncedPtr)[idx];
+
+	x += a;
+
+	bounds.x = std::min(x, bounds.x);
+	bounds.y = std::max(x, bounds.y);
+
+	return x;
+}
+
+inline void CReadMap::ExpandHeightBounds(const float2& bounds) {
+	currHeightBounds.x = std::min(bounds.x, currHeightBounds.x);
+	currHeightBounds.y = std::max(bounds.y, currHeightBounds.y);
+}
+
 
 
 
@@ -134,21 +134,39 @@ void CBasicMeshDrawer::Update(const DrawPass::e& drawPass) {
 }
 
 void CBasicMeshDrawer::UnsyncedHeightMapUpdate(const SRectangle& rect) {
-	const uint32_t minPatchX = std::max(rect.x1 / PATCH_SIZE,    (              0));
-	const uint32_t minPatchY = std::max(rect.z1 / PATCH_SIZE,    (              0));
-	const uint32_t maxPatchX = std::min(rect.x2 / PATCH_SIZE, int(numPatchesX - 1));
-	const uint32_t maxPatchY = std::min(rect.z2 / PATCH_SIZE, int(numPatchesY - 1));
+	// vertices on patch edges are shared, so grow the rect by one in each direction
+	const SRectangle vertRect = {
+		std::max(rect.x1 - 1,            0), std::max(rect.z1 - 1,            0),
+		std::min(rect.x2 + 1, mapDims.mapx), std::min(rect.z2 + 1, mapDims.mapy),
+	};
+
+	const uint32_t minPatchX = std::max((vertRect.x1 - 1) / PATCH_SIZE, (              0));
+	const uint32_t minPatchY = std::max((vertRect.z1 - 1) / PATCH_SIZE, (              0));
+	const uint32_t maxPatchX = std::min( vertRect.x2      / PATCH_SIZE, int(numPatchesX - 1));
+	const uint32_t maxPatchY = std::min( vertRect.z2      / PATCH_SIZE, int(numPatchesY - 1));
 	const uint32_t lodLevels = std::max(1, LOD_LEVELS * USE_MIPMAP_BUFFERS);
 
+	// borders only sample the outermost rows and columns of the heightmap
+	const bool borderUpdate =
+		(vertRect.x1 == 0 || vertRect.x2 == mapDims.mapx) ||
+		(vertRect.z1 == 0 || vertRect.z2 == mapDims.mapy);
+
 	const float* heightMap = readMap->GetCornerHeightMapUnsynced();
 	const float3* normalMap = readMap->GetVisVertexNormalsUnsynced();
 
-	// TODO: update asynchronously, clip rect against patch bounds
+	// TODO: update asynchronously
 	for (uint32_t py = minPatchY; py <= maxPatchY; py += 1) {
 		for (uint32_t px = minPatchX; px <= maxPatchX; px += 1) {
-			for (uint32_t n = 0; n < lodLevels; n += 1) {
-				UploadPatchSquareGeometry(n, px, py, heightMap, normalMap);
+			// patches whose vertices are persistently mapped get only the changed heights rewritten
+			if (!UpdatePatchSquareHeights(px, py, vertRect, heightMap)) {
+				for (uint32_t n = 0; n < lodLevels; n += 1) {
+					UploadPatchSquareGeometry(n, px, py, heightMap, normalMap);
+				}
 			}
+
+			if (!borderUpdate)
+				continue;
+
 			// need border data at all MIP's regardless of USE_MIPMAP_BUFFERS
 			for (uint32_t n = 0; n < LOD_LEVELS; n += 1) {
 				UploadPatchBorderGeometry(n, px, py, heightMap, normalMap);
@@ -159,6 +177,41 @@ void CBasicMeshDrawer::UnsyncedHeightMapUpdate(const SRectangle& rect) {
 
 
 
+bool CBasicMeshDrawer::UpdatePatchSquareHeights(uint32_t px, uint32_t py, const SRectangle& vertRect, const float* chm) {
+	#if (USE_MAPPED_BUFFERS == 1 && USE_MIPMAP_BUFFERS == 0)
+	MeshPatch& meshPatch = meshPatches[py * numPatchesX + px];
+
+	float3* verts = meshPatch.squareVertexPtrs[0];
+
+	if (verts == nullptr)
+		return false;
+
+	constexpr uint32_t numVerts = PATCH_SIZE + 1;
+
+	const uint32_t bpx = px * PATCH_SIZE;
+	const uint32_t bpy = py * PATCH_SIZE;
+
+	// clip the vertex-rect against the patch; both are inclusive
+	const uint32_t minVX = std::max(vertRect.x1 - int(bpx), 0);
+	const uint32_t minVY = std::max(vertRect.z1 - int(bpy), 0);
+	const uint32_t maxVX = std::min(vertRect.x2 - int(bpx), int(PATCH_SIZE));
+	const uint32_t maxVY = std::min(vertRect.z2 - int(bpy), int(PATCH_SIZE));
+
+	meshPatch.uhmUpdateFrames[0] = globalRendering->drawFrame;
+
+	for (uint32_t vy = minVY; vy <= maxVY; vy += 1) {
+		for (uint32_t vx = minVX; vx <= maxVX; vx += 1) {
+			verts[vy * numVerts + vx].y = chm[(bpy + vy) * mapDims.mapxp1 + (bpx + vx)];
+		}
+	}
+
+	return true;
+	#else
+	return false;
+	#endif
+}
+
+
 void CBasicMeshDrawer::UploadPatchSquareGeometry(uint32_t n, uint32_t px, uint32_t py, const float* chm, const float3* cnm) {
 	MeshPatch& meshPatch = meshPatches[py * numPatchesX + px];
 
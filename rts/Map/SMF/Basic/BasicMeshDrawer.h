@@ -62,6 +62,8 @@ public:
 	void DrawBorderMesh(const DrawPass::e& drawPass) override;
 
 private:
+	bool UpdatePatchSquareHeights(uint32_t px, uint32_t py, const SRectangle& vertRect, const float* chm);
+
 	void UploadPatchSquareGeometry(uint32_t n, uint32_t px, uint32_t py, const float* chm, const float3* cnm);
 	void UploadPatchBorderGeometry(uint32_t n, uint32_t px, uint32_t py, const float* chm, const float3* cnm);
 	void UploadPatchIndices(uint32_t n);
@@ -115,6 +115,7 @@ Patch::Patch()
 	, currentVariance(nullptr)
 	, isDirty(true)
 	, isTesselated(false)
+	, isVBODirty(true)
 	, varianceMaxLimit(std::numeric_limits<float>::max())
 	, camDistLODFactor(1.0f)
 	, coors(-1, -1)
@@ -202,10 +203,21 @@ void Patch::UpdateHeightMap(const SRectangle& rect)
 		}
 	}
 
-	UploadVertices();
+	// deferred, a patch can receive many updates per frame
 	// UploadBorderVertices();
 
 	isDirty = true;
+	isVBODirty = true;
+}
+
+void Patch::UploadDirtyVertices()
+{
+	if (!isVBODirty)
+		return;
+
+	UploadVertices();
+
+	isVBODirty = false;
 }
 
 
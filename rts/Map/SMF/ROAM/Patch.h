@@ -105,6 +105,8 @@ public:
 	char IsDirty() const { return isDirty; }
 
 	void UpdateHeightMap(const SRectangle& rect = SRectangle(0, 0, PATCH_SIZE, PATCH_SIZE));
+	// uploads the vertices once after any number of UpdateHeightMap calls
+	void UploadDirtyVertices();
 
 	// create an approximate mesh
 	bool Tessellate(const float3& camPos, int viewRadius, bool shadowPass);
@@ -167,6 +169,8 @@ private:
 	// does the variance-tree need to be recalculated for this Patch?
 	bool isDirty;
 	bool isTesselated;
+	// do the vertices need to be re-uploaded before drawing?
+	bool isVBODirty;
 
 	float varianceMaxLimit;
 	float camDistLODFactor; // defines the LOD falloff in camera distance
@@ -68,12 +68,14 @@ CRoamMeshDrawer::CRoamMeshDrawer(CSMFGroundDrawer* gd)
 
 		for (int y = 0; y < numPatchesY; ++y) {
 			for (int x = 0; x < numPatchesX; ++x) {
-				Patch& patch = patches[y * numPatchesX + x];
-
-				patch.Init(smfGroundDrawer, x * PATCH_SIZE, y * PATCH_SIZE);
-				patch.ComputeVariance();
+				patches[y * numPatchesX + x].Init(smfGroundDrawer, x * PATCH_SIZE, y * PATCH_SIZE);
 			}
 		}
+
+		// variance-trees only depend on the patch's own vertices
+		for_mt(0, patches.size(), [&patches](const int j) {
+			patches[j].ComputeVariance();
+		});
 	}
 
 	for (unsigned int i = MESH_NORMAL; i <= MESH_SHADOW; i++) {
@@ -128,8 +130,10 @@ void CRoamMeshDrawer::Update()
 		// Check if a retessellation is needed
 		//SCOPED_TIMER("ROAM::ComputeVariance");
 
+		dirtyPatchIndices.clear();
+
 		for (int i = 0; i < (numPatchesX * numPatchesY); ++i) {
-			//FIXME multithread? don't retessellate on small heightmap changes?
+			//FIXME don't retessellate on small heightmap changes?
 			Patch& p = patches[i];
 
 		#if (RETESSELLATE_MODE == 2)
@@ -139,8 +143,7 @@ void CRoamMeshDrawer::Update()
 					retessellate = true;
 				}
 				if (p.IsDirty()) {
-					p.ComputeVariance();
-					retessellate = true;
+					dirtyPatchIndices.push_back(i);
 				}
 			} else {
 				pvflags[i] = 0;
@@ -153,11 +156,17 @@ void CRoamMeshDrawer::Update()
 				retessellate = true;
 			}
 			if (p.IsVisible(cam) && p.IsDirty()) {
-				p.ComputeVariance();
-				retessellate = true;
+				dirtyPatchIndices.push_back(i);
 			}
 		#endif
 		}
+
+		// each patch only touches its own variance-tree
+		for_mt(0, dirtyPatchIndices.size(), [&](const int i) {
+			patches[ dirtyPatchIndices[i] ].ComputeVariance();
+		});
+
+		retessellate |= (!dirtyPatchIndices.empty());
 	}
 
 	// Further conditions that can cause a retessellation
@@ -219,7 +228,8 @@ void CRoamMeshDrawer::DrawMesh(const DrawPass::e& drawPass)
 	//   Updating for all passes produces the optimal tessellation per
 	//   camera but consumes far too many cycles; force any non-shadow
 	//   pass to reuse MESH_NORMAL
-	SCOPED_TIMER(drawPass == DrawPass::Normal ? "Draw::World::Terrain::ROAM" : "Misc::ROAM");
+	static const unsigned timerIDs[] = {profiler.RegisterTimer("Draw::World::Terrain::ROAM"), profiler.RegisterTimer("Misc::ROAM")};
+	ScopedTimer timer(timerIDs[drawPass != DrawPass::Normal]);
 
 	switch (drawPass) {
 		case DrawPass::Normal: { Update(); } break;
@@ -229,6 +239,8 @@ void CRoamMeshDrawer::DrawMesh(const DrawPass::e& drawPass)
 		} break;
 	}
 
+	UploadDirtyVertices(drawPass == DrawPass::Shadow);
+
 	for (Patch& p: patchMeshGrid[drawPass == DrawPass::Shadow]) {
 		if (!p.IsVisible(CCamera::GetActiveCamera()))
 			continue;
@@ -278,6 +290,15 @@ void CRoamMeshDrawer::DrawInMiniMap()
 
 
 
+void CRoamMeshDrawer::UploadDirtyVertices(bool shadowPass)
+{
+	// heightmap updates only modify the CPU-side copy; invisible patches are
+	// uploaded as well since other passes (e.g. reflection) might draw them
+	for (Patch& p: patchMeshGrid[shadowPass]) {
+		p.UploadDirtyVertices();
+	}
+}
+
 void CRoamMeshDrawer::Reset(bool shadowPass)
 {
 	std::vector<Patch>& patches = patchMeshGrid[shadowPass];
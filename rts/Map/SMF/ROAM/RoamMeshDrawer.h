@@ -60,6 +60,7 @@ public:
 
 private:
 	void Reset(bool shadowPass);
+	void UploadDirtyVertices(bool shadowPass);
 	bool Tessellate(std::vector<Patch>& patches, const CCamera* cam, int viewRadius, bool shadowPass);
 
 private:
@@ -78,6 +79,9 @@ private:
 	//< char instead of bool, accessors to different elements must be thread-safe
 	std::vector<uint8_t> patchVisFlags[MESH_COUNT];
 
+	//< visible patches whose variance-trees are recomputed this frame
+	std::vector<int> dirtyPatchIndices;
+
 	//< whether tessellation should be forcibly performed next frame
 	static bool forceTessellate[MESH_COUNT];
 };
@@ -1,9 +1,11 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <cstdio>
+#include <limits>
 
 #include "SMFGroundTextures.h"
 #include "SMFFormat.h"
@@ -15,6 +17,7 @@
 #include "Game/Game.h"
 #include "Game/GameSetup.h"
 #include "Game/LoadScreen.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Exceptions.h"
 #include "System/FastMath.h"
 #include "System/Log/ILog.h"
@@ -35,6 +38,8 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_SMF_GROUND_TEXTURES)
 #endif
 #define LOG_SECTION_CURRENT LOG_SECTION_SMF_GROUND_TEXTURES
 
+CONFIG(int, GroundTextureUploadBudget).defaultValue(2048).minimumValue(0).description("Maximum number of kilobytes of map square-texture data uploaded per frame when their detail-level changes, nearest squares first. 0 means unlimited.");
+
 
 
 std::vector<CSMFGroundTextures::GroundSquare> CSMFGroundTextures::squares;
@@ -46,6 +51,8 @@ std::vector<float> CSMFGroundTextures::heightMaxima;
 std::vector<float> CSMFGroundTextures::heightMinima;
 std::vector<float> CSMFGroundTextures::stretchFactors;
 
+std::vector<CSMFGroundTextures::SquareUpload> CSMFGroundTextures::squareUploads;
+
 
 
 CSMFGroundTextures::GroundSquare::~GroundSquare()
@@ -60,6 +67,8 @@ CSMFGroundTextures::GroundSquare::~GroundSquare()
 
 CSMFGroundTextures::CSMFGroundTextures(CSMFReadMap* rm): smfMap(rm)
 {
+	uploadBudget = configHandler->GetInt("GroundTextureUploadBudget") * 1024;
+
 	LoadTiles(smfMap->GetFile());
 	LoadSquareTextures(3);
 	ConvolveHeightMap(mapDims.mapx, 1);
@@ -151,10 +160,9 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 			throw content_error(t);
 		}
 
-		for (int b = 0; b < numSmallTiles; ++b) {
-			tileFile.Read(&tiles[curTile * SMALL_TILE_SIZE], SMALL_TILE_SIZE);
-			curTile++;
-		}
+		// tiles are stored back to back, copy all of them at once
+		tileFile.Read(&tiles[curTile * SMALL_TILE_SIZE], numSmallTiles * SMALL_TILE_SIZE);
+		curTile += numSmallTiles;
 	}
 
 	ifs->Read(&tileMap[0], smfMap->tileCount * sizeof(int));
@@ -174,10 +182,20 @@ void CSMFGroundTextures::LoadSquareTextures(const int mipLevel)
 {
 	loadscreen->SetLoadMessage("Loading Square Textures");
 
+	const int mipSqSize = smfMap->bigTexSize >> mipLevel;
+	const int numSqInts = ((mipSqSize * mipSqSize) / 2) / sizeof(GLint);
+
+	// the tiles of every square are gathered by the workers, only the uploads are serial
+	std::vector<GLint> tileBuf(squares.size() * numSqInts);
+
+	for_mt(0, squares.size(), [&](const int i) {
+		ExtractSquareTiles(i % smfMap->numBigTexX, i / smfMap->numBigTexX, mipLevel, &tileBuf[i * numSqInts]);
+	});
+
 	for (int y = 0; y < smfMap->numBigTexY; ++y) {
 		for (int x = 0; x < smfMap->numBigTexX; ++x) {
 			// start at the lowest mip-level
-			LoadSquareTexture(x, y, mipLevel);
+			CreateSquareTexture(x, y, mipLevel, &tileBuf[(y * smfMap->numBigTexX + x) * numSqInts]);
 		}
 	}
 }
@@ -203,7 +221,8 @@ void CSMFGroundTextures::ConvolveHeightMap(const int mapWidth, const int mipLeve
 	stretchFactors.clear();
 	stretchFactors.resize(nb, 0.0f);
 
-	for (int y = 0; y < nby; ++y) {
+	// every big square only writes its own entries
+	for_mt(0, nby, [&](const int y) {
 		for (int x = 0; x < nbx; ++x) {
 
 			// NOTE: we leave out the borders on sampling because it is easier to do the Sobel kernel convolution
@@ -246,7 +265,7 @@ void CSMFGroundTextures::ConvolveHeightMap(const int mapWidth, const int mipLeve
 
 			stretchFactors[y * nbx + x] += 1.0f;
 		}
-	}
+	});
 }
 
 
@@ -277,6 +296,9 @@ void CSMFGroundTextures::DrawUpdate()
 	const float vsySq = globalRendering->viewSizeY * globalRendering->viewSizeY;
 	const float vdiag = fastmath::apxsqrt(vsxSq + vsySq);
 
+	squareUploads.clear();
+	squareUploads.reserve(squares.size());
+
 	for (int y = 0; y < smfMap->numBigTexY; ++y) {
 		float dz = cam->GetPos().z - (y * smfMap->bigSquareSize * SQUARE_SIZE);
 		dz -= (SQUARE_SIZE << 6);
@@ -294,7 +316,7 @@ void CSMFGroundTextures::DrawUpdate()
 				if ((square->GetMipLevel() < 3) && ((globalRendering->drawFrame - square->GetDrawFrame()) > 120)) {
 					// `unload` texture (load lowest mip-map) if
 					// the square wasn't visible for 120 vframes
-					LoadSquareTexture(x, y, 3);
+					squareUploads.push_back({x, y, 3, std::numeric_limits<float>::max()});
 				}
 				continue;
 			}
@@ -350,10 +372,37 @@ void CSMFGroundTextures::DrawUpdate()
 				wantedLevel--;
 
 			if (square->GetMipLevel() != wantedLevel) {
-				LoadSquareTexture(x, y, wantedLevel);
+				squareUploads.push_back({x, y, wantedLevel, dist});
 			}
 		}
 	}
+
+	UploadSquareTextures();
+}
+
+void CSMFGroundTextures::UploadSquareTextures()
+{
+	if (squareUploads.empty())
+		return;
+
+	// nearest squares first, unloads of hidden squares last
+	std::sort(squareUploads.begin(), squareUploads.end(), [](const SquareUpload& a, const SquareUpload& b) {
+		return (a.dist < b.dist);
+	});
+
+	int uploadedBytes = 0;
+
+	for (const SquareUpload& upload: squareUploads) {
+		const int mipSqSize = smfMap->bigTexSize >> upload.level;
+		const int numSqBytes = (mipSqSize * mipSqSize) / 2;
+
+		// always upload at least one square per frame, remaining ones are retried next frame
+		if (uploadBudget > 0 && uploadedBytes > 0 && (uploadedBytes + numSqBytes) > uploadBudget)
+			break;
+
+		LoadSquareTexture(upload.x, upload.y, upload.level);
+		uploadedBytes += numSqBytes;
+	}
 }
 
 
@@ -442,6 +491,22 @@ void CSMFGroundTextures::ExtractSquareTiles(
 }
 
 void CSMFGroundTextures::LoadSquareTexture(int x, int y, int level)
+{
+	const int mipSqSize = smfMap->bigTexSize >> level;
+	const int numSqBytes = (mipSqSize * mipSqSize) / 2;
+
+	pbo.Bind();
+	pbo.New(numSqBytes);
+	ExtractSquareTiles(x, y, level, (GLint*) pbo.MapBuffer());
+	pbo.UnmapBuffer();
+
+	CreateSquareTexture(x, y, level, pbo.GetPtr());
+
+	pbo.Invalidate();
+	pbo.Unbind();
+}
+
+void CSMFGroundTextures::CreateSquareTexture(int x, int y, int level, const void* tileData)
 {
 	static const GLenum ttarget = GL_TEXTURE_2D;
 
@@ -452,11 +517,6 @@ void CSMFGroundTextures::LoadSquareTexture(int x, int y, int level)
 	square->SetMipLevel(level);
 	assert(!square->HasLuaTexture());
 
-	pbo.Bind();
-	pbo.New(numSqBytes);
-	ExtractSquareTiles(x, y, level, (GLint*) pbo.MapBuffer());
-	pbo.UnmapBuffer();
-
 	glDeleteTextures(1, square->GetTextureIDPtr());
 	glGenTextures(1, square->GetTextureIDPtr());
 	glBindTexture(ttarget, square->GetTextureID());
@@ -474,10 +534,7 @@ void CSMFGroundTextures::LoadSquareTexture(int x, int y, int level)
 		glTexParameterf(ttarget, GL_TEXTURE_PRIORITY, 0.5f);
 	}
 
-	glCompressedTexImage2D(ttarget, 0, tileTexFormat, mipSqSize, mipSqSize, 0, numSqBytes, pbo.GetPtr());
-
-	pbo.Invalidate();
-	pbo.Unbind();
+	glCompressedTexImage2D(ttarget, 0, tileTexFormat, mipSqSize, mipSqSize, 0, numSqBytes, tileData);
 }
 
 void CSMFGroundTextures::BindSquareTexture(int texSquareX, int texSquareY)
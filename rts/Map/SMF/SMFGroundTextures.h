@@ -27,6 +27,9 @@ protected:
 	void ConvolveHeightMap(const int mapWidth, const int mipLevel);
 	void ExtractSquareTiles(const int texSquareX, const int texSquareY, const int mipLevel, GLint* tileBuf) const;
 	void LoadSquareTexture(int x, int y, int level);
+	/// (re)creates the square's texture from tile data (or an offset into the bound PBO)
+	void CreateSquareTexture(int x, int y, int level, const void* tileData);
+	void UploadSquareTextures();
 
 	inline bool TexSquareInView(int, int) const;
 
@@ -60,8 +63,17 @@ private:
 		unsigned int texDrawFrame;
 	};
 
+	struct SquareUpload {
+		int x;
+		int y;
+		int level;
+		float dist;
+	};
+
 	// note: intentionally declared static (see ReadMap)
 	static std::vector<GroundSquare> squares;
+	// squares whose mip-level changed this frame, uploaded within a byte-budget
+	static std::vector<SquareUpload> squareUploads;
 
 	static std::vector<int> tileMap;
 	static std::vector<char> tiles;
@@ -75,6 +87,7 @@ private:
 	PBO pbo;
 
 	int tileTexFormat;
+	int uploadBudget;
 };
 
 #endif // _BF_GROUND_TEXTURES_H_
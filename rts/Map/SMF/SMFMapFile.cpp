@@ -48,6 +48,19 @@ CSMFMapFile::CSMFMapFile(const std::string& mapFileName)
 	throw content_error(buf);
 }
 
+const unsigned char* CSMFMapFile::GetSectionData(int offset, int size) const
+{
+	const IArchive::FileView& view = ifs.GetFileView();
+
+	if (view.empty())
+		return nullptr;
+	if (offset < 0 || size < 0 || (size_t(offset) + size) > view.size)
+		return nullptr;
+
+	return (view.data + offset);
+}
+
+
 void CSMFMapFile::ReadMinimap(void* data)
 {
 	ifs.Seek(header.minimapPtr);
@@ -93,19 +106,31 @@ void CSMFMapFile::ReadHeightmap(float* sHeightMap, float* uHeightMap, float base
 {
 	const int hmx = header.mapx + 1;
 	const int hmy = header.mapy + 1;
-	unsigned short* temphm = new unsigned short[hmx * hmy];
+	const int hms = hmx * hmy * sizeof(unsigned short);
 
-	ifs.Seek(header.heightmapPtr);
-	ifs.Read(temphm, hmx * hmy * 2);
+	std::vector<unsigned short> temphm;
+
+	// decode straight out of the archive's copy of the file if possible
+	const unsigned char* hmData = GetSectionData(header.heightmapPtr, hms);
+
+	if (hmData == nullptr) {
+		temphm.resize(hmx * hmy);
+
+		ifs.Seek(header.heightmapPtr);
+		ifs.Read(temphm.data(), hms);
+
+		hmData = reinterpret_cast<const unsigned char*>(temphm.data());
+	}
 
 	for (int y = 0; y < hmx * hmy; ++y) {
-		const float h = base + swabWord(temphm[y]) * mod;
+		unsigned short rawHeight;
+		memcpy(&rawHeight, hmData + y * sizeof(unsigned short), sizeof(unsigned short));
+
+		const float h = base + swabWord(rawHeight) * mod;
 
 		if (sHeightMap != NULL) { sHeightMap[y] = h; }
 		if (uHeightMap != NULL) { uHeightMap[y] = h; }
 	}
-
-	delete[] temphm;
 }
 
 
@@ -43,6 +43,14 @@ public:
 	static void ReadMapTileHeader(MapTileHeader& head, CFileHandler& file);
 	static void ReadMapTileFileHeader(TileFileHeader& head, CFileHandler& file);
 
+	/**
+	 * @return pointer to size bytes at offset in the file, if the file came
+	 *   from an archive that keeps it in memory; nullptr otherwise (or when
+	 *   the section is out of bounds). Unlike Seek and Read, this can also
+	 *   be used by several threads at once.
+	 */
+	const unsigned char* GetSectionData(int offset, int size) const;
+
 private:
 	bool ReadGrassMap(void* data);
 	void ReadMapHeader(SMFHeader& head, CFileHandler& file);
@@ -64,6 +64,9 @@ CSMFReadMap::CSMFReadMap(std::string mapname)
 	// Detail Normal Splatting requires at least one splatDetailNormalTexture and a distribution texture
 	haveSplatNormalDistribTexture &= !mapInfo->smf.splatDistrTexName.empty();
 
+	// decoded by workers in the meantime, only the uploads remain for this thread
+	PreloadBitmaps();
+
 	ParseHeader();
 	LoadHeightMap();
 	CReadMap::Initialize();
@@ -85,6 +88,79 @@ CSMFReadMap::CSMFReadMap(std::string mapname)
 
 
 
+void CSMFReadMap::PreloadBitmap(unsigned int idx, const std::string& texName, bool grayscale)
+{
+	MapBitmap& mb = mapBitmaps[idx];
+
+	mb.texName = texName;
+	mb.grayscale = grayscale;
+
+	if (texName.empty() || !ThreadPool::HasThreads())
+		return;
+
+	mb.future = ThreadPool::Enqueue([&mb]() {
+		if (mb.grayscale) {
+			mb.loaded = mb.bitmap.LoadGrayscale(mb.texName);
+		} else {
+			mb.loaded = mb.bitmap.Load(mb.texName);
+		}
+	});
+}
+
+bool CSMFReadMap::GetMapBitmap(unsigned int idx, const std::string& texName, CBitmap& bitmap)
+{
+	MapBitmap& mb = mapBitmaps[idx];
+
+	if (mb.future == nullptr || mb.texName != texName) {
+		if (mb.grayscale)
+			return (bitmap.LoadGrayscale(texName));
+
+		return (bitmap.Load(texName));
+	}
+
+	// rethrows whatever the worker might have thrown
+	mb.future->get();
+	mb.future.reset();
+
+	bitmap = std::move(mb.bitmap);
+	return mb.loaded;
+}
+
+void CSMFReadMap::PreloadBitmaps()
+{
+	static_assert(NUM_MAP_BITMAPS == (MAP_BITMAP_SPLAT_NORMAL + NUM_SPLAT_DETAIL_NORMALS), "");
+
+	const CMapInfo::smf_t& smf = mapInfo->smf;
+
+	PreloadBitmap(MAP_BITMAP_MINIMAP, smf.minimapTexName);
+	PreloadBitmap(MAP_BITMAP_GRASS_SHADING, smf.grassShadingTexName);
+	PreloadBitmap(MAP_BITMAP_DETAIL, smf.detailTexName);
+	PreloadBitmap(MAP_BITMAP_METAL_MAP, smf.metalmapTexName, true);
+	PreloadBitmap(MAP_BITMAP_TYPE_MAP, smf.typemapTexName, true);
+
+	if (haveSpecularTexture) {
+		PreloadBitmap(MAP_BITMAP_SPECULAR, smf.specularTexName);
+		PreloadBitmap(MAP_BITMAP_SKY_REFLECT_MOD, smf.skyReflectModTexName);
+		PreloadBitmap(MAP_BITMAP_BLEND_NORMALS, smf.blendNormalsTexName);
+		PreloadBitmap(MAP_BITMAP_LIGHT_EMISSION, smf.lightEmissionTexName);
+		PreloadBitmap(MAP_BITMAP_PARALLAX_HEIGHT, smf.parallaxHeightTexName);
+	}
+
+	if (!haveSplatDetailDistribTexture)
+		return;
+
+	PreloadBitmap(MAP_BITMAP_SPLAT_DETAIL, smf.splatDetailTexName);
+	PreloadBitmap(MAP_BITMAP_SPLAT_DISTR, smf.splatDistrTexName);
+
+	if (!haveSplatNormalDistribTexture)
+		return;
+
+	for (size_t i = 0; i < std::min(smf.splatDetailNormalTexNames.size(), size_t(NUM_SPLAT_DETAIL_NORMALS)); i++) {
+		PreloadBitmap(MAP_BITMAP_SPLAT_NORMAL + i, smf.splatDetailNormalTexNames[i]);
+	}
+}
+
+
 void CSMFReadMap::ParseHeader()
 {
 	const SMFHeader& header = file.GetHeader();
@@ -137,7 +213,7 @@ void CSMFReadMap::LoadMinimap()
 {
 	CBitmap minimapTexBM;
 
-	if (minimapTexBM.Load(mapInfo->smf.minimapTexName)) {
+	if (GetMapBitmap(MAP_BITMAP_MINIMAP, mapInfo->smf.minimapTexName, minimapTexBM)) {
 		minimapTex.SetRawTexID(minimapTexBM.CreateTexture());
 		minimapTex.SetRawSize(int2(minimapTexBM.xsize, minimapTexBM.ysize));
 		return;
@@ -191,7 +267,7 @@ void CSMFReadMap::CreateSpecularTex()
 	CBitmap lightEmissionTexBM;
 	CBitmap parallaxHeightTexBM;
 
-	if (!specularTexBM.Load(mapInfo->smf.specularTexName)) {
+	if (!GetMapBitmap(MAP_BITMAP_SPECULAR, mapInfo->smf.specularTexName, specularTexBM)) {
 		// maps wants specular lighting, but no moderation
 		specularTexBM.channels = 4;
 		specularTexBM.AllocDummy(SColor(255, 255, 255, 255));
@@ -201,22 +277,22 @@ void CSMFReadMap::CreateSpecularTex()
 	specularTex.SetRawSize(int2(specularTexBM.xsize, specularTexBM.ysize));
 
 	// no default 1x1 textures for these
-	if (skyReflectModTexBM.Load(mapInfo->smf.skyReflectModTexName)) {
+	if (GetMapBitmap(MAP_BITMAP_SKY_REFLECT_MOD, mapInfo->smf.skyReflectModTexName, skyReflectModTexBM)) {
 		skyReflectModTex.SetRawTexID(skyReflectModTexBM.CreateTexture());
 		skyReflectModTex.SetRawSize(int2(skyReflectModTexBM.xsize, skyReflectModTexBM.ysize));
 	}
 
-	if (blendNormalsTexBM.Load(mapInfo->smf.blendNormalsTexName)) {
+	if (GetMapBitmap(MAP_BITMAP_BLEND_NORMALS, mapInfo->smf.blendNormalsTexName, blendNormalsTexBM)) {
 		blendNormalsTex.SetRawTexID(blendNormalsTexBM.CreateTexture());
 		blendNormalsTex.SetRawSize(int2(blendNormalsTexBM.xsize, blendNormalsTexBM.ysize));
 	}
 
-	if (lightEmissionTexBM.Load(mapInfo->smf.lightEmissionTexName)) {
+	if (GetMapBitmap(MAP_BITMAP_LIGHT_EMISSION, mapInfo->smf.lightEmissionTexName, lightEmissionTexBM)) {
 		lightEmissionTex.SetRawTexID(lightEmissionTexBM.CreateTexture());
 		lightEmissionTex.SetRawSize(int2(lightEmissionTexBM.xsize, lightEmissionTexBM.ysize));
 	}
 
-	if (parallaxHeightTexBM.Load(mapInfo->smf.parallaxHeightTexName)) {
+	if (GetMapBitmap(MAP_BITMAP_PARALLAX_HEIGHT, mapInfo->smf.parallaxHeightTexName, parallaxHeightTexBM)) {
 		parallaxHeightTex.SetRawTexID(parallaxHeightTexBM.CreateTexture());
 		parallaxHeightTex.SetRawSize(int2(parallaxHeightTexBM.xsize, parallaxHeightTexBM.ysize));
 	}
@@ -232,13 +308,13 @@ void CSMFReadMap::CreateSplatDetailTextures()
 
 	// if the map supplies an intensity- AND a distribution-texture for
 	// detail-splat blending, the regular detail-texture is not used
-	if (!splatDetailTexBM.Load(mapInfo->smf.splatDetailTexName)) {
+	if (!GetMapBitmap(MAP_BITMAP_SPLAT_DETAIL, mapInfo->smf.splatDetailTexName, splatDetailTexBM)) {
 		// default detail-texture should be all-grey
 		splatDetailTexBM.channels = 4;
 		splatDetailTexBM.AllocDummy(SColor(127,127,127,127));
 	}
 
-	if (!splatDistrTexBM.Load(mapInfo->smf.splatDistrTexName)) {
+	if (!GetMapBitmap(MAP_BITMAP_SPLAT_DISTR, mapInfo->smf.splatDistrTexName, splatDistrTexBM)) {
 		splatDistrTexBM.channels = 4;
 		splatDistrTexBM.AllocDummy(SColor(255,0,0,0));
 	}
@@ -259,7 +335,7 @@ void CSMFReadMap::CreateSplatDetailTextures()
 
 		CBitmap splatDetailNormalTextureBM;
 
-		if (!splatDetailNormalTextureBM.Load(mapInfo->smf.splatDetailNormalTexNames[i])) {
+		if (!GetMapBitmap(MAP_BITMAP_SPLAT_NORMAL + i, mapInfo->smf.splatDetailNormalTexNames[i], splatDetailNormalTextureBM)) {
 			splatDetailNormalTextureBM.channels = 4;
 			splatDetailNormalTextureBM.Alloc(1, 1);
 			splatDetailNormalTextureBM.GetRawMem()[0] = 127; // RGB is packed standard normal map
@@ -281,7 +357,7 @@ void CSMFReadMap::CreateGrassTex()
 	grassShadingTex.SetRawSize(int2(1024, 1024));
 
 	CBitmap grassShadingTexBM;
-	if (grassShadingTexBM.Load(mapInfo->smf.grassShadingTexName)) {
+	if (GetMapBitmap(MAP_BITMAP_GRASS_SHADING, mapInfo->smf.grassShadingTexName, grassShadingTexBM)) {
 		grassShadingTex.SetRawTexID(grassShadingTexBM.CreateMipMapTexture());
 		grassShadingTex.SetRawSize(int2(grassShadingTexBM.xsize, grassShadingTexBM.ysize));
 	}
@@ -292,7 +368,7 @@ void CSMFReadMap::CreateDetailTex()
 {
 	CBitmap detailTexBM;
 
-	if (!detailTexBM.Load(mapInfo->smf.detailTexName)) {
+	if (!GetMapBitmap(MAP_BITMAP_DETAIL, mapInfo->smf.detailTexName, detailTexBM)) {
 		throw content_error("Could not load detail texture from file " + mapInfo->smf.detailTexName);
 	}
 
@@ -497,7 +573,7 @@ void CSMFReadMap::UpdateNormalTexture(const SRectangle& update)
 	pixels.resize(xsize * zsize * 2, 0.0f);
 #endif
 
-	for (int z = minz; z <= maxz; z++) {
+	for_mt(minz, maxz + 1, [&](const int z) {
 		for (int x = minx; x <= maxx; x++) {
 			const float3& vertNormal = vvn[z * mapDims.mapxp1 + x];
 
@@ -514,7 +590,7 @@ void CSMFReadMap::UpdateNormalTexture(const SRectangle& update)
 			pixels[((z - minz) * xsize + (x - minx)) * 2 + 1] = vertNormal.z;
 		#endif
 		}
-	}
+	});
 
 	glBindTexture(GL_TEXTURE_2D, normalsTex.GetID());
 #if (SSMF_UNCOMPRESSED_NORMALS == 1)
@@ -846,16 +922,26 @@ unsigned char* CSMFReadMap::GetInfoMap(const std::string& name, MapBitmapInfo* b
 
 	CBitmap infomapBM;
 	std::string texName;
+	unsigned int bitmapIdx = NUM_MAP_BITMAPS;
+
 	if (name == "metal" && !mapInfo->smf.metalmapTexName.empty()) {
 		texName = mapInfo->smf.metalmapTexName;
+		bitmapIdx = MAP_BITMAP_METAL_MAP;
 	} else if (name == "type" && !mapInfo->smf.typemapTexName.empty()) {
 		texName = mapInfo->smf.typemapTexName;
+		bitmapIdx = MAP_BITMAP_TYPE_MAP;
 	} else if (name == "grass" && !mapInfo->smf.grassmapTexName.empty()) {
 		texName = mapInfo->smf.grassmapTexName;
 	}
 
-	if (!texName.empty() && !infomapBM.LoadGrayscale(texName))
-		throw content_error("[CSMFReadMap::GetInfoMap] cannot load: " + texName);
+	if (!texName.empty()) {
+		const bool loaded = (bitmapIdx != NUM_MAP_BITMAPS)?
+			GetMapBitmap(bitmapIdx, texName, infomapBM):
+			infomapBM.LoadGrayscale(texName);
+
+		if (!loaded)
+			throw content_error("[CSMFReadMap::GetInfoMap] cannot load: " + texName);
+	}
 
 	if (!infomapBM.Empty()) {
 		if (infomapBM.xsize == bmInfo->width && infomapBM.ysize == bmInfo->height) {
@@ -3,8 +3,13 @@
 #ifndef SMFREADMAP_H
 #define SMFREADMAP_H
 
+#include <array>
+#include <future>
+#include <memory>
+
 #include "SMFMapFile.h"
 #include "Map/ReadMap.h"
+#include "Rendering/Textures/Bitmap.h"
 #include "System/EventClient.h"
 #include "System/type2.h"
 
@@ -144,6 +149,43 @@ public:
 	}
 
 private:
+	enum {
+		MAP_BITMAP_MINIMAP          =  0,
+		MAP_BITMAP_SPECULAR         =  1,
+		MAP_BITMAP_SKY_REFLECT_MOD  =  2,
+		MAP_BITMAP_BLEND_NORMALS    =  3,
+		MAP_BITMAP_LIGHT_EMISSION   =  4,
+		MAP_BITMAP_PARALLAX_HEIGHT  =  5,
+		MAP_BITMAP_SPLAT_DETAIL     =  6,
+		MAP_BITMAP_SPLAT_DISTR      =  7,
+		MAP_BITMAP_GRASS_SHADING    =  8,
+		MAP_BITMAP_DETAIL           =  9,
+		MAP_BITMAP_METAL_MAP        = 10,
+		MAP_BITMAP_TYPE_MAP         = 11,
+		MAP_BITMAP_SPLAT_NORMAL     = 12, // first of NUM_SPLAT_DETAIL_NORMALS
+		NUM_MAP_BITMAPS             = 16,
+	};
+
+	/// texture supplied by the map, decoded by a worker while the heightmap is processed
+	struct MapBitmap {
+		~MapBitmap() { if (future != nullptr) future->wait(); }
+
+		CBitmap bitmap;
+		std::string texName;
+		std::shared_ptr< std::future<void> > future;
+
+		bool grayscale = false;
+		bool loaded = false;
+	};
+
+	void PreloadBitmap(unsigned int idx, const std::string& texName, bool grayscale = false);
+	/**
+	 * Hands out a preloaded texture (each only once), or loads it now.
+	 * @return whether the texture could be loaded, as CBitmap::Load
+	 */
+	bool GetMapBitmap(unsigned int idx, const std::string& texName, CBitmap& bitmap);
+
+	void PreloadBitmaps();
 	void ParseHeader();
 	void LoadHeightMap();
 	void LoadMinimap();
@@ -189,6 +231,8 @@ private:
 	CSMFMapFile file;
 	CSMFGroundDrawer* groundDrawer;
 
+	std::array<MapBitmap, NUM_MAP_BITMAPS> mapBitmaps;
+
 private:
 	// note: intentionally declared static (see ReadMap)
 	static std::vector<float> cornerHeightMapSynced;
@@ -116,7 +116,6 @@ void SMFRenderStateGLSL::Update(
 
 			glslShaders[n]->SetFlag("NUM_DYNAMIC_MAP_LIGHTS", lightHandler->NumConfigLights());
 			glslShaders[n]->SetFlag("MAX_DYNAMIC_MAP_LIGHTS", GL::LightHandler::MaxConfigLights());
-			glslShaders[n]->SetFlag("MAX_LIGHT_UNIFORM_VECS", GL::LightHandler::MaxUniformVecs());
 
 			// both are runtime set in ::Enable, but ATI drivers need values from the beginning
 			glslShaders[n]->SetFlag("HAVE_SHADOWS", false);
@@ -152,6 +151,8 @@ void SMFRenderStateGLSL::Update(
 			glslShaders[n]->SetUniform("splatDetailNormalTex2", 16);
 			glslShaders[n]->SetUniform("splatDetailNormalTex3", 17);
 			glslShaders[n]->SetUniform("splatDetailNormalTex4", 18);
+			glslShaders[n]->SetUniform("lightDataTex",          19);
+			glslShaders[n]->SetUniform("lightGridTex",          20);
 
 			glslShaders[n]->SetUniform("mapSizePO2", mapDims.pwr2mapx * SQUARE_SIZE * 1.0f, mapDims.pwr2mapy * SQUARE_SIZE * 1.0f);
 			glslShaders[n]->SetUniform("mapSize",    mapDims.mapx     * SQUARE_SIZE * 1.0f, mapDims.mapy     * SQUARE_SIZE * 1.0f);
@@ -172,8 +173,7 @@ void SMFRenderStateGLSL::Update(
 			glslShaders[n]->SetUniformMatrix4x4<const char*, float>("shadowMat", false, shadowHandler->GetShadowViewMatrix());
 			glslShaders[n]->SetUniform4v<const char*, float>("shadowParams", shadowHandler->GetShadowParams());
 
-			// Enable always sets these
-			// glslShaders[n]->SetUniform4v<const char*, float>("fwdDynLights", lightHandler->NumLightUniformVecs(), lightHandler->GetRawLightDataPtr());
+			glslShaders[n]->SetUniform4v<const char*, float>("lightGridParams", &lightHandler->GetLightGridParams().x);
 
 			glslShaders[n]->SetUniform3v<const char*, float>("fogParams", &fogParams.x);
 			glslShaders[n]->SetUniform4v<const char*, float>("fogColor", sky->fogColor);
@@ -246,10 +246,8 @@ void SMFRenderStateGLSL::Enable(const CSMFGroundDrawer* smfGroundDrawer, const D
 	shader->SetUniform3v<const char*, float>("fogParams", &fogParams.x);
 	shader->SetUniform<const char*, float>("infoTexIntensityMul", float(infoTextureHandler->InMetalMode()) + 1.0f);
 
-	if (cLightHandler->NumConfigLights() > 0) {
+	if (cLightHandler->NumConfigLights() > 0)
 		mLightHandler->Update();
-		shader->SetUniform4v<const char*, float>("fwdDynLights", cLightHandler->NumUniformVecs(), cLightHandler->GetRawLightDataPtr());
-	}
 
 	switch (drawPass) {
 		case DrawPass::WaterReflection: { shader->SetUniform4v<const char*, float>("clipPlane", IWater::MapReflClipPlane()); } break;
@@ -278,6 +276,11 @@ void SMFRenderStateGLSL::Enable(const CSMFGroundDrawer* smfGroundDrawer, const D
 		}
 	}
 
+	if (cLightHandler->NumConfigLights() > 0) {
+		glActiveTexture(GL_TEXTURE19); glBindTexture(GL_TEXTURE_BUFFER, cLightHandler->GetLightDataTexture());
+		glActiveTexture(GL_TEXTURE20); glBindTexture(GL_TEXTURE_BUFFER, cLightHandler->GetLightGridTexture());
+	}
+
 	glActiveTexture(GL_TEXTURE0);
 }
 
@@ -4,8 +4,10 @@
 
 #include "Net/Protocol/BaseNetProtocol.h"
 #include "System/Log/ILog.h"
+#include "System/Net/Connection.h"
 #include "System/Net/Socket.h"
 
+#include <algorithm>
 #include <string.h>
 #include <vector>
 #include <cinttypes>
@@ -48,6 +50,14 @@ enum EVENT
 	/// Server gave out a warning (string warningmessage)
 	SERVER_WARNING = 5,
 
+	/**
+	 * @brief inputs and outcome of a SpeedControl 3 decision, every two seconds in-game
+	 *
+	 * (uchar speedcontrol, float current speed, float wanted speed,
+	 * uchar number of the limiting player (255 if none))
+	 */
+	SERVER_SPEEDCONTROL = 6,
+
 	/// Player has joined the game (uchar playernumber, string name)
 	PLAYER_JOINED = 10,
 
@@ -79,6 +89,22 @@ enum EVENT
 	/// Player has been defeated (uchar playernumber)
 	PLAYER_DEFEATED = 14,
 
+	/**
+	 * @brief quality of the server's link to a player, sent along with ping updates
+	 *
+	 * (uchar playernumber, uint16 rtt, uint16 rtt deviation, uint16 resend timeout
+	 * (all in milliseconds), uchar loss (in percent of chunks resent), uint16 send window)
+	 */
+	PLAYER_LINKSTATS = 15,
+
+	/**
+	 * @brief a player's load as used by SpeedControl 3, sent before SERVER_SPEEDCONTROL
+	 *
+	 * (uchar playernumber, float load (90th percentile of recent reports, 0 to 1),
+	 * uint16 frames the player is behind beyond its round-trip time)
+	 */
+	PLAYER_SIMLOAD = 16,
+
 	/**
 	 * @brief Message sent by lua script
 	 *
@@ -284,6 +310,69 @@ void AutohostInterface::SendPlayerDefeated(uchar playerNum)
 	Send(asio::buffer(&msg, 2 * sizeof(uchar)));
 }
 
+void AutohostInterface::SendPlayerLinkStats(uchar playerNum, const netcode::LinkStats& stats)
+{
+	const std::uint16_t values[] = {
+		static_cast<std::uint16_t>(std::min(stats.rtt, 65535.0f)),
+		static_cast<std::uint16_t>(std::min(stats.rttVar, 65535.0f)),
+		static_cast<std::uint16_t>(std::min(stats.resendTimeout, 65535.0f)),
+	};
+
+	const std::uint16_t sendWindow = std::min(stats.sendWindow, 65535u);
+
+	std::uint8_t msg[2 + sizeof(values) + 1 + sizeof(sendWindow)];
+	unsigned int pos = 0;
+
+	msg[pos++] = PLAYER_LINKSTATS;
+	msg[pos++] = playerNum;
+
+	memcpy(&msg[pos], values, sizeof(values));
+	pos += sizeof(values);
+
+	msg[pos++] = static_cast<std::uint8_t>(std::min(stats.lossRate, 1.0f) * 100.0f);
+
+	memcpy(&msg[pos], &sendWindow, sizeof(sendWindow));
+
+	Send(asio::buffer(msg));
+}
+
+void AutohostInterface::SendPlayerSimLoad(uchar playerNum, float load, float backlogFrames)
+{
+	const std::uint16_t backlog = std::min(backlogFrames, 65535.0f);
+
+	std::uint8_t msg[2 + sizeof(load) + sizeof(backlog)];
+	unsigned int pos = 0;
+
+	msg[pos++] = PLAYER_SIMLOAD;
+	msg[pos++] = playerNum;
+
+	memcpy(&msg[pos], &load, sizeof(load));
+	pos += sizeof(load);
+
+	memcpy(&msg[pos], &backlog, sizeof(backlog));
+
+	Send(asio::buffer(msg));
+}
+
+void AutohostInterface::SendSpeedControl(uchar speedCtrl, float curSpeed, float wantedSpeed, int limitingPlayer)
+{
+	std::uint8_t msg[2 + sizeof(curSpeed) + sizeof(wantedSpeed) + 1];
+	unsigned int pos = 0;
+
+	msg[pos++] = SERVER_SPEEDCONTROL;
+	msg[pos++] = speedCtrl;
+
+	memcpy(&msg[pos], &curSpeed, sizeof(curSpeed));
+	pos += sizeof(curSpeed);
+
+	memcpy(&msg[pos], &wantedSpeed, sizeof(wantedSpeed));
+	pos += sizeof(wantedSpeed);
+
+	msg[pos++] = (limitingPlayer >= 0)? limitingPlayer: 255;
+
+	Send(asio::buffer(msg));
+}
+
 void AutohostInterface::Message(const std::string& message)
 {
 	if (autohost.is_open()) {
@@ -7,6 +7,10 @@
 #include <cinttypes>
 #include <asio/ip/udp.hpp>
 
+namespace netcode {
+	struct LinkStats;
+}
+
 /**
  * API for engine <-> autohost (or similar) communication, using UDP over
  * loopback.
@@ -42,6 +46,9 @@ public:
 	void SendPlayerReady(uchar playerNum, uchar readyState);
 	void SendPlayerChat(uchar playerNum, uchar destination, const std::string& msg);
 	void SendPlayerDefeated(uchar playerNum);
+	void SendPlayerLinkStats(uchar playerNum, const netcode::LinkStats& stats);
+	void SendPlayerSimLoad(uchar playerNum, float load, float backlogFrames);
+	void SendSpeedControl(uchar speedCtrl, float curSpeed, float wantedSpeed, int limitingPlayer);
 
 	void Message(const std::string& message);
 	void Warning(const std::string& message);
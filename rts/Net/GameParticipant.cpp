@@ -2,6 +2,8 @@
 
 #include "GameParticipant.h"
 
+#include <algorithm>
+
 #include "Net/Protocol/BaseNetProtocol.h"
 #include "Sim/Misc/GlobalConstants.h"
 #include "System/Net/Connection.h"
@@ -12,6 +14,7 @@ GameParticipant::GameParticipant()
 , myState(UNCONNECTED)
 , lastFrameResponse(0)
 , speedControl(0)
+, numCpuUsageSamples(0)
 , isLocal(false)
 , isReconn(false)
 , isMidgameJoin(false)
@@ -32,6 +35,29 @@ void GameParticipant::Connected(std::shared_ptr<netcode::CConnection> _link, boo
 	isLocal = local;
 	myState = CONNECTED;
 	lastFrameResponse = 0;
+	numCpuUsageSamples = 0;
+}
+
+void GameParticipant::AddCpuUsageSample(float usage)
+{
+	cpuUsageHistory[(numCpuUsageSamples++) % CPU_USAGE_HISTORY_SIZE] = usage;
+}
+
+float GameParticipant::GetCpuUsagePercentile(float p) const
+{
+	const unsigned int numSamples = std::min(numCpuUsageSamples, CPU_USAGE_HISTORY_SIZE);
+
+	if (numSamples == 0)
+		return 0.0f;
+
+	std::array<float, CPU_USAGE_HISTORY_SIZE> samples;
+	std::copy(cpuUsageHistory.begin(), cpuUsageHistory.begin() + numSamples, samples.begin());
+
+	// nearest-rank
+	const unsigned int rank = std::min(unsigned(p * numSamples), numSamples - 1);
+
+	std::nth_element(samples.begin(), samples.begin() + rank, samples.begin() + numSamples);
+	return samples[rank];
 }
 
 void GameParticipant::Kill(const std::string& reason, const bool flush)
@@ -50,6 +76,7 @@ void GameParticipant::Kill(const std::string& reason, const bool flush)
 	linkData[MAX_AIS].link.reset();
 #ifdef SYNCCHECK
 	syncResponse.clear();
+	syncSubsystems.clear();
 #endif
 	myState = DISCONNECTED;
 }
@@ -3,7 +3,10 @@
 #ifndef _GAME_PARTICIPANT_H
 #define _GAME_PARTICIPANT_H
 
+#include <array>
+#include <map>
 #include <memory>
+#include <vector>
 
 #include "Game/Players/PlayerBase.h"
 #include "Game/Players/PlayerStatistics.h"
@@ -26,6 +29,10 @@ public:
 
 	GameParticipant& operator=(const PlayerBase& base) { PlayerBase::operator=(base); return *this; };
 
+	void AddCpuUsageSample(float usage);
+	/// p-th percentile (0 to 1) of the recent CPU-usage reports, 0 if there are none
+	float GetCpuUsagePercentile(float p) const;
+
 public:
 	int id;
 
@@ -41,6 +48,12 @@ public:
 	int lastFrameResponse;
 	int speedControl;
 
+	/// the last CPU_USAGE_HISTORY_SIZE in-game load reports (one per second), ring-buffered
+	static constexpr unsigned int CPU_USAGE_HISTORY_SIZE = 16;
+
+	std::array<float, CPU_USAGE_HISTORY_SIZE> cpuUsageHistory;
+	unsigned int numCpuUsageSamples;
+
 	bool isLocal;
 	bool isReconn;
 	bool isMidgameJoin;
@@ -56,6 +69,7 @@ public:
 
 #ifdef SYNCCHECK
 	std::map<int, unsigned> syncResponse; // syncResponse[frameNum] = checksum
+	std::map<int, std::vector<unsigned> > syncSubsystems; // syncSubsystems[frameNum] = per-subsystem checksums
 #endif
 };
 
@@ -3,7 +3,9 @@
 #include "System/Net/UDPListener.h"
 #include "System/Net/UDPConnection.h"
 
+#include <algorithm>
 #include <functional>
+#include <limits>
 
 #if defined DEDICATED || defined DEBUG
 	#include <iostream>
@@ -67,8 +69,9 @@ using netcode::RawPacket;
 
 CONFIG(int, AutohostPort).defaultValue(0);
 CONFIG(int, ServerSleepTime).defaultValue(5).description("number of milliseconds to sleep per tick");
-CONFIG(int, SpeedControl).defaultValue(1).minimumValue(1).maximumValue(2)
-	.description("Sets how server adjusts speed according to player's load (CPU), 1: use average, 2: use highest");
+CONFIG(int, SpeedControl).defaultValue(1).minimumValue(1).maximumValue(3)
+	.description("Sets how server adjusts speed according to player's load (CPU), 1: use average, 2: use highest, 3: use each player's recent 90th-percentile load and leave room for catching up");
+CONFIG(bool, SpeedControlIncludeSpectators).defaultValue(false).description("Let the load of spectators also limit the game speed.");
 CONFIG(bool, AllowSpectatorJoin).defaultValue(true).description("allow any unauthenticated clients to join as spectator with any name, name will be prefixed with ~");
 CONFIG(bool, WhiteListAdditionalPlayers).defaultValue(true);
 CONFIG(bool, ServerRecordDemos).defaultValue(false).dedicatedValue(true);
@@ -109,6 +112,16 @@ static const unsigned gameProgressFrameInterval = GAME_SPEED * 10;
 
 static const unsigned syncResponseEchoInterval = GAME_SPEED * 2;
 
+/// upper bound (in milliseconds) on how long UpdateLoop blocks before the game started
+static const int IDLE_LOOP_WAIT_TIME = 50;
+
+/// SpeedControl 3: load percentile per player, seconds allowed to work off a backlog
+/// of frames, and the fraction of the remaining distance to the wanted speed taken
+/// per LagProtection call
+static const float SPEED_CONTROL_LOAD_PERCENTILE = 0.9f;
+static const float SPEED_CONTROL_CATCHUP_TIME = 10.0f;
+static const float SPEED_CONTROL_SMOOTHING = 0.3f;
+
 
 //FIXME remodularize server commands, so they get registered in word completion etc.
 static const std::array<std::string, 23> SERVER_COMMANDS = {
@@ -125,6 +138,40 @@ static const std::array<std::string, 23> SERVER_COMMANDS = {
 std::set<std::string> CGameServer::commandBlacklist;
 
 
+// the player and AI lists are not part of a checkpoint
+static bool CoveredByCheckpoint(unsigned char msgCode)
+{
+	switch (msgCode) {
+		case NETMSG_PLAYERNAME:
+		case NETMSG_PLAYERLEFT:
+		case NETMSG_CREATE_NEWPLAYER:
+		case NETMSG_AI_CREATED:
+		case NETMSG_AI_STATE_CHANGED: {
+			return false;
+		} break;
+		default: {
+		} break;
+	}
+
+	return true;
+}
+
+static void PackCheckpoint(int frameNum, const std::vector<uint8_t>& data, std::vector< std::shared_ptr<const netcode::RawPacket> >& packets)
+{
+	// 64KB packet limit, minus header
+	constexpr size_t CHECKPOINT_CHUNK_SIZE = 60 * 1024;
+
+	packets.clear();
+
+	for (size_t offset = 0; offset < data.size(); offset += CHECKPOINT_CHUNK_SIZE) {
+		const auto chunkBeg = data.begin() + offset;
+		const auto chunkEnd = data.begin() + std::min(offset + CHECKPOINT_CHUNK_SIZE, data.size());
+
+		packets.push_back(CBaseNetProtocol::Get().SendCheckpoint(frameNum, data.size(), offset, std::vector<uint8_t>(chunkBeg, chunkEnd)));
+	}
+}
+
+
 
 CGameServer* gameServer = NULL;
 
@@ -134,6 +181,8 @@ CGameServer::CGameServer(
 	const std::shared_ptr<const  CGameSetup> newGameSetup
 )
 : quitServer(false)
+, demoReachedEnd(false)
+, unlimitedDemoSpeed(false)
 , serverFrameNum(-1)
 
 , serverStartTime(spring_gettime())
@@ -161,6 +210,9 @@ CGameServer::CGameServer(
 , canReconnect(false)
 , allowSpecDraw(true)
 
+, gameStartCachePos(0)
+, checkpointCachePos(0)
+
 , syncErrorFrame(0)
 , syncWarningFrame(0)
 
@@ -195,6 +247,7 @@ void CGameServer::Initialize()
 {
 	// configs
 	curSpeedCtrl = configHandler->GetInt("SpeedControl");
+	speedCtrlIncludeSpecs = configHandler->GetBool("SpeedControlIncludeSpectators");
 	allowSpecJoin = configHandler->GetBool("AllowSpectatorJoin");
 	whiteListAdditionalPlayers = configHandler->GetBool("WhiteListAdditionalPlayers");
 	logInfoMessages = configHandler->GetBool("ServerLogInfoMessages");
@@ -202,11 +255,15 @@ void CGameServer::Initialize()
 
 	rng.Seed((myGameData->GetSetupText()).length());
 
+#ifdef SYNCCHECK
+	syncSubsystemErrorFrames.fill(0);
+#endif
+
 	// start network
 	if (!myGameSetup->onlyLocal)
 		UDPNet.reset(new netcode::UDPListener(myClientSetup->hostPort, myClientSetup->hostIP));
 
-	AddAutohostInterface(StringToLower(configHandler->GetString("AutohostIP")), configHandler->GetInt("AutohostPort"));
+	AddAutohostInterface(StringToLower(myClientSetup->autohostIP), myClientSetup->autohostPort);
 	Message(spring::format(ServerStart, myClientSetup->hostPort), false);
 
 	// start script
@@ -431,6 +488,8 @@ void CGameServer::SkipTo(int targetFrameNum)
 	CommandMessage endMsg("skip end", SERVER_PLAYER);
 	Broadcast(std::shared_ptr<const netcode::RawPacket>(startMsg.Pack()));
 
+	SkipToCheckpoint(targetFrameNum);
+
 	// fast-read and send demo data
 	//
 	// note that we must maintain <modGameTime> ourselves
@@ -456,6 +515,54 @@ void CGameServer::SkipTo(int targetFrameNum)
 	isPaused = wasPaused;
 }
 
+void CGameServer::SkipToCheckpoint(int targetFrameNum)
+{
+	const std::vector<DemoCheckpointHeader>& checkpoints = demoReader->GetCheckpoints();
+
+	// last checkpoint not past the target; checkpoints are stored in frame order
+	const auto iter = std::upper_bound(checkpoints.begin(), checkpoints.end(), targetFrameNum, [](int frameNum, const DemoCheckpointHeader& h) { return (frameNum < h.frameNum); });
+
+	if (iter == checkpoints.begin())
+		return;
+
+	const size_t checkpointNum = (iter - checkpoints.begin()) - 1;
+	const DemoCheckpointHeader& checkpoint = checkpoints[checkpointNum];
+
+	if (checkpoint.frameNum <= serverFrameNum)
+		return;
+
+	std::vector<uint8_t> data;
+	std::vector< std::shared_ptr<const RawPacket> > packets;
+
+	if (!demoReader->ReadCheckpoint(checkpointNum, data)) {
+		Message(spring::format("Warning: could not read demo checkpoint for frame %d", checkpoint.frameNum));
+		return;
+	}
+
+	// the frames up to the checkpoint are not simulated, only read
+	while (!demoReader->ReachedEnd() && demoReader->GetStreamOffset() < checkpoint.streamOffset) {
+		netcode::RawPacket* buf = demoReader->GetData(std::numeric_limits<float>::max());
+
+		if (buf == nullptr)
+			continue;
+
+		HandleDemoPacket(std::shared_ptr<const RawPacket>(buf), targetFrameNum, true);
+	}
+
+	if (serverFrameNum != checkpoint.frameNum)
+		Message(spring::format("Warning: demo checkpoint for frame %d found at frame %d", checkpoint.frameNum, serverFrameNum));
+
+	serverFrameNum = checkpoint.frameNum;
+	gameTime = GetDemoTime();
+	modGameTime = demoReader->GetModGameTime() + 0.001f;
+
+	PackCheckpoint(checkpoint.frameNum, data, packets);
+
+	for (const std::shared_ptr<const RawPacket>& packet: packets) {
+		Broadcast(packet);
+	}
+}
+
 std::string CGameServer::GetPlayerNames(const std::vector<int>& indices) const
 {
 	std::string playerstring;
@@ -467,6 +574,16 @@ std::string CGameServer::GetPlayerNames(const std::vector<int>& indices) const
 	return playerstring;
 }
 
+netcode::LinkStats CGameServer::GetPlayerLinkStats(int playerNum) const
+{
+	std::lock_guard<spring::recursive_mutex> scoped_lock(gameServerMutex);
+
+	if (playerNum < 0 || playerNum >= players.size() || players[playerNum].link == nullptr)
+		return netcode::LinkStats();
+
+	return (players[playerNum].link->GetLinkStats());
+}
+
 
 bool CGameServer::SendDemoData(int targetFrameNum)
 {
@@ -479,93 +596,101 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 
 	// get all packets from the stream up to <modGameTime>
 	while ((buf = demoReader->GetData(modGameTime))) {
-		std::shared_ptr<const RawPacket> rpkt(buf);
+		HandleDemoPacket(std::shared_ptr<const RawPacket>(buf), targetFrameNum, false);
+	}
 
-		if (buf->length <= 0) {
-			Message("Warning: Discarding zero size packet in demo");
-			continue;
-		}
+	if (targetFrameNum > 0) {
+		// skipping
+		ret = (serverFrameNum < targetFrameNum);
+	}
+
+	if (demoReader->ReachedEnd()) {
+		demoReader.reset();
+		demoReachedEnd = true;
+		Message(DemoEnd);
+		gameEndTime = spring_gettime();
+		ret = false;
+	}
 
-		const unsigned msgCode = buf->data[0];
+	return ret;
+}
 
-		switch (msgCode) {
-			case NETMSG_NEWFRAME:
-			case NETMSG_KEYFRAME: {
-				// we can't use CreateNewFrame() here
-				lastNewFrameTick = spring_gettime();
-				serverFrameNum++;
+void CGameServer::HandleDemoPacket(std::shared_ptr<const RawPacket> rpkt, int targetFrameNum, bool replaced)
+{
+	if (rpkt->length <= 0) {
+		Message("Warning: Discarding zero size packet in demo");
+		return;
+	}
+
+	const unsigned msgCode = rpkt->data[0];
+
+	switch (msgCode) {
+		case NETMSG_NEWFRAME:
+		case NETMSG_KEYFRAME: {
+			// we can't use CreateNewFrame() here
+			lastNewFrameTick = spring_gettime();
+			serverFrameNum++;
 
 #ifdef SYNCCHECK
-				if (targetFrameNum == -1) {
-					// not skipping
-					outstandingSyncFrames.insert(serverFrameNum);
-				}
-				CheckSync();
+			if (targetFrameNum == -1) {
+				// not skipping
+				outstandingSyncFrames.insert(serverFrameNum);
+			}
+			CheckSync();
 #endif
 
+			if (!replaced)
 				Broadcast(rpkt);
-				break;
+			break;
+		}
+
+		case NETMSG_CREATE_NEWPLAYER: {
+			try {
+				netcode::UnpackPacket pckt(rpkt, 3);
+				unsigned char spectator, team, playerNum;
+				std::string name;
+				pckt >> playerNum;
+				pckt >> spectator;
+				pckt >> team;
+				pckt >> name;
+				AddAdditionalUser(name, "", true, (bool)spectator, (int)team, playerNum); // even though this is a demo, keep the players vector properly updated
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(spring::format("Warning: Discarding invalid new player packet in demo: %s", ex.what()));
+				return;
 			}
 
-			case NETMSG_CREATE_NEWPLAYER: {
-				try {
-					netcode::UnpackPacket pckt(rpkt, 3);
-					unsigned char spectator, team, playerNum;
-					std::string name;
-					pckt >> playerNum;
-					pckt >> spectator;
-					pckt >> team;
-					pckt >> name;
-					AddAdditionalUser(name, "", true, (bool)spectator, (int)team, playerNum); // even though this is a demo, keep the players vector properly updated
-				} catch (const netcode::UnpackPacketException& ex) {
-					Message(spring::format("Warning: Discarding invalid new player packet in demo: %s", ex.what()));
-					continue;
-				}
+			Broadcast(rpkt);
+			break;
+		}
 
-				Broadcast(rpkt);
-				break;
+		case NETMSG_GAMEDATA:
+		case NETMSG_SETPLAYERNUM:
+		case NETMSG_USER_SPEED:
+		case NETMSG_INTERNAL_SPEED: {
+			// never send these from demos
+			break;
+		}
+		case NETMSG_CCOMMAND: {
+			try {
+				CommandMessage msg(rpkt);
+				const Action& action = msg.GetAction();
+				if (msg.GetPlayerID() == SERVER_PLAYER && action.command == "cheat")
+					InverseOrSetBool(cheating, action.extra);
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(spring::format("Warning: Discarding invalid command message packet in demo: %s", ex.what()));
+				return;
 			}
 
-			case NETMSG_GAMEDATA:
-			case NETMSG_SETPLAYERNUM:
-			case NETMSG_USER_SPEED:
-			case NETMSG_INTERNAL_SPEED: {
-				// never send these from demos
-				break;
-			}
-			case NETMSG_CCOMMAND: {
-				try {
-					CommandMessage msg(rpkt);
-					const Action& action = msg.GetAction();
-					if (msg.GetPlayerID() == SERVER_PLAYER && action.command == "cheat")
-						InverseOrSetBool(cheating, action.extra);
-				} catch (const netcode::UnpackPacketException& ex) {
-					Message(spring::format("Warning: Discarding invalid command message packet in demo: %s", ex.what()));
-					continue;
-				}
+			if (!replaced)
 				Broadcast(rpkt);
-				break;
-			}
-			default: {
+			break;
+		}
+		default: {
+			if (!replaced || !CoveredByCheckpoint(msgCode))
 				Broadcast(rpkt);
-				break;
-			}
+			break;
 		}
 	}
-
-	if (targetFrameNum > 0) {
-		// skipping
-		ret = (serverFrameNum < targetFrameNum);
-	}
-
-	if (demoReader->ReachedEnd()) {
-		demoReader.reset();
-		Message(DemoEnd);
-		gameEndTime = spring_gettime();
-		ret = false;
-	}
-
-	return ret;
 }
 
 void CGameServer::Broadcast(std::shared_ptr<const netcode::RawPacket> packet)
@@ -789,6 +914,8 @@ void CGameServer::CheckSync()
 		++outstandingSyncFrameIt;
 	}
 
+	CheckSyncSubsystems();
+
 #else
 
 	// Make it clear this build isn't suitable for release.
@@ -800,6 +927,101 @@ void CGameServer::CheckSync()
 }
 
 
+void CGameServer::CheckSyncSubsystems()
+{
+#ifdef SYNCCHECK
+	std::set<int> subsystemFrames;
+
+	for (const GameParticipant& p: players) {
+		for (const auto& pair: p.syncSubsystems) {
+			subsystemFrames.insert(pair.first);
+		}
+	}
+
+	std::vector<int> desyncedPlayers;
+	std::vector< std::pair<unsigned, unsigned> > checksums; // <subsystem checksum, #clients matching checksum>
+
+	for (const int frameNum: subsystemFrames) {
+		bool completeResponseSet = true;
+
+		for (const GameParticipant& p: players) {
+			if (!p.link)
+				continue;
+
+			completeResponseSet &= (p.syncSubsystems.find(frameNum) != p.syncSubsystems.end());
+		}
+
+		// wait for stragglers, but not forever (CheckSync complains about those)
+		if (!completeResponseSet && frameNum >= (serverFrameNum - static_cast<int>(SYNCCHECK_TIMEOUT)))
+			continue;
+
+		for (unsigned s = 0; s < CSyncChecker::SYNC_SUBSYSTEM_COUNT; s++) {
+			unsigned correctChecksum = 0;
+			unsigned maxChecksumCount = 0;
+
+			if (HasLocalClient()) {
+				// dictatorship, as in CheckSync
+				const auto it = players[localClientNumber].syncSubsystems.find(frameNum);
+
+				if (it == players[localClientNumber].syncSubsystems.end())
+					break;
+
+				correctChecksum = it->second[s];
+			} else {
+				checksums.clear();
+
+				for (const GameParticipant& p: players) {
+					const auto it = p.syncSubsystems.find(frameNum);
+
+					if (!p.link || it == p.syncSubsystems.end())
+						continue;
+
+					auto checksumIt = std::find_if(checksums.begin(), checksums.end(), [&](const std::pair<unsigned, unsigned>& c) { return (c.first == it->second[s]); });
+
+					if (checksumIt == checksums.end())
+						checksumIt = checksums.insert(checksums.end(), std::pair<unsigned, unsigned>(it->second[s], 0));
+
+					if (maxChecksumCount < (++checksumIt->second)) {
+						maxChecksumCount = checksumIt->second;
+						correctChecksum = checksumIt->first;
+					}
+				}
+			}
+
+			desyncedPlayers.clear();
+
+			for (const GameParticipant& p: players) {
+				const auto it = p.syncSubsystems.find(frameNum);
+
+				if (!p.link || it == p.syncSubsystems.end() || it->second[s] == correctChecksum)
+					continue;
+
+				if (demoReader || !p.spectator) {
+					desyncedPlayers.push_back(p.id);
+				} else {
+					PrivateMessage(p.id, spring::format(SyncSubsystemError, p.name.c_str(), frameNum, CSyncChecker::GetSubsystemName(s)));
+				}
+			}
+
+			if (desyncedPlayers.empty())
+				continue;
+
+			// report each subsystem once per desync; later frames only repeat the first divergence
+			if (syncSubsystemErrorFrames[s] != 0 && (frameNum - syncSubsystemErrorFrames[s]) <= static_cast<int>(SYNCCHECK_MSG_TIMEOUT))
+				continue;
+
+			syncSubsystemErrorFrames[s] = frameNum;
+			Message(spring::format(SyncSubsystemError, GetPlayerNames(desyncedPlayers).c_str(), frameNum, CSyncChecker::GetSubsystemName(s)));
+		}
+
+		for (GameParticipant& p: players) {
+			p.syncSubsystems.erase(frameNum);
+		}
+	}
+#endif
+}
+
+
 float CGameServer::GetDemoTime() const {
 	if (!gameHasStarted) return gameTime;
 	return (startTime + serverFrameNum / float(GAME_SPEED));
@@ -819,6 +1041,10 @@ void CGameServer::Update()
 		// <modGameTime>
 		if (demoReader == NULL || !HasLocalClient() || (serverFrameNum - players[localClientNumber].lastFrameResponse) < GAME_SPEED)
 			modGameTime += (tdif * internalSpeed);
+
+		// at unlimited speed hand out the next second of the demo as soon as the client caught up
+		if (unlimitedDemoSpeed && demoReader != NULL && HasLocalClient() && (serverFrameNum - players[localClientNumber].lastFrameResponse) < GAME_SPEED)
+			modGameTime = std::max(modGameTime, demoReader->GetModGameTime() + 1.0f);
 	}
 
 	if (lastPlayerInfo < (spring_gettime() - playerInfoTime)) {
@@ -897,23 +1123,58 @@ void CGameServer::LagProtection()
 
 	// detect reference cpu usage ( highest )
 	float refCpuUsage = 0.0f;
+
+	// SpeedControl 3: highest speed every reference player can sustain
+	float sustainedSpeed = userSpeedFactor;
+	int limitingPlayer = -1;
+
 	for (GameParticipant& player: players) {
 		if (player.myState == GameParticipant::INGAME) {
 			// send info about the players
 			const int curPing = ((serverFrameNum - player.lastFrameResponse) * 1000) / (GAME_SPEED * internalSpeed);
 			Broadcast(CBaseNetProtocol::Get().SendPlayerInfo(player.id, player.cpuUsage, curPing));
 
+			const netcode::LinkStats linkStats = (player.link != nullptr)? player.link->GetLinkStats(): netcode::LinkStats();
+
+			if (hostif != nullptr && player.link != nullptr)
+				hostif->SendPlayerLinkStats(player.id, linkStats);
+
 			const float playerCpuUsage = player.cpuUsage;
 			const float correctedCpu   = Clamp(playerCpuUsage, 0.0f, 1.0f);
 
 			if (player.isReconn && curPing < 2 * GAME_SPEED)
 				player.isReconn = false;
 
-			if ((player.isLocal) || (demoReader ? !player.isFromDemo : !player.spectator)) {
+			if ((player.isLocal) || (demoReader ? !player.isFromDemo : (!player.spectator || speedCtrlIncludeSpecs))) {
 				if (!player.isReconn && correctedCpu > refCpuUsage)
 					refCpuUsage = correctedCpu;
 				cpu.push_back(correctedCpu);
 				ping.push_back(curPing);
+
+				if (curSpeedCtrl != 3)
+					continue;
+
+				// frames the player is behind beyond what its round-trip time (and keyframe responses) explain
+				const float latencyFrames = (linkStats.rtt * 0.001f) * GAME_SPEED * internalSpeed + serverKeyframeInterval;
+				const float backlogFrames = std::max(0.0f, (serverFrameNum - player.lastFrameResponse) - latencyFrames);
+				const float loadPercentile = Clamp(player.GetCpuUsagePercentile(SPEED_CONTROL_LOAD_PERCENTILE), 0.0f, 1.0f);
+
+				if (hostif != nullptr)
+					hostif->SendPlayerSimLoad(player.id, loadPercentile, backlogFrames);
+
+				if (player.isReconn || loadPercentile <= 0.0f)
+					continue;
+
+				// the player runs at most maxSpeed when at full load, keep it at the
+				// wanted load and leave room to work off its backlog in time
+				const float maxSpeed = internalSpeed / loadPercentile;
+				const float catchupSpeed = backlogFrames / (GAME_SPEED * SPEED_CONTROL_CATCHUP_TIME);
+				const float playerSpeed = std::min(maxSpeed * 0.75f, maxSpeed - catchupSpeed);
+
+				if (playerSpeed < sustainedSpeed) {
+					sustainedSpeed = playerSpeed;
+					limitingPlayer = player.id;
+				}
 			}
 		}
 	}
@@ -935,11 +1196,27 @@ void CGameServer::LagProtection()
 		refCpuUsage = medianCpu;
 	}
 
+	if (isPaused)
+		return;
+
+	float newSpeed = internalSpeed;
+
 	// adjust game speed
-	if (refCpuUsage > 0.0f && !isPaused) {
+	if (curSpeedCtrl == 3) {
+		const float wantedSpeed = Clamp(sustainedSpeed, 0.1f, userSpeedFactor);
+
+		// move gradually, but do not creep towards the target in ever smaller broadcast steps
+		newSpeed = mix(internalSpeed, wantedSpeed, SPEED_CONTROL_SMOOTHING);
+
+		if (std::fabs(wantedSpeed - newSpeed) < 0.01f)
+			newSpeed = wantedSpeed;
+
+		if (hostif != nullptr)
+			hostif->SendSpeedControl(curSpeedCtrl, internalSpeed, wantedSpeed, limitingPlayer);
+	} else if (refCpuUsage > 0.0f) {
 		//userSpeedFactor holds the wanted speed adjusted manually by user ( normally 1)
 		//internalSpeed holds the current speed the sim is running
-		//refCpuUsage holds the highest cpu if curSpeedCtrl == 0 or median if curSpeedCtrl == 1
+		//refCpuUsage holds the highest cpu if curSpeedCtrl == 2 or median if curSpeedCtrl == 1
 
 		// aim for 60% cpu usage if median is used as reference and 75% cpu usage if max is the reference
 		float wantedCpuUsage = (curSpeedCtrl == 1) ?  0.60f : 0.75f;
@@ -948,20 +1225,23 @@ void CGameServer::LagProtection()
 		//if the current cpu of the target is smaller than the aimed cpu target but the clamp will cap it
 		// the clamp will throttle it to the wanted one, otherwise it's a simple linear proportion aiming
 		// to keep cpu load constant
-		float newSpeed = internalSpeed/refCpuUsage*wantedCpuUsage;
+		newSpeed = internalSpeed/refCpuUsage*wantedCpuUsage;
 		newSpeed = Clamp(newSpeed, 0.1f, userSpeedFactor);
 		//average to smooth the speed change over time to reduce the impact of cpu spikes in the players
 		newSpeed = (newSpeed + internalSpeed) * 0.5f;
+	} else {
+		return;
+	}
+
 #ifndef DEDICATED
-		// in non-dedicated hosting, we'll add an additional safeguard to make sure the host can keep up with the game's speed
-		// adjust game speed to localclient's (:= host) maximum SimFrame rate
-		const float maxSimFPS = (1000.0f / gu->avgSimFrameTime) * (1.0f - gu->reconnectSimDrawBalance);
-		newSpeed = Clamp(newSpeed, 0.1f, ((maxSimFPS / GAME_SPEED) + internalSpeed) * 0.5f);
+	// in non-dedicated hosting, we'll add an additional safeguard to make sure the host can keep up with the game's speed
+	// adjust game speed to localclient's (:= host) maximum SimFrame rate
+	const float maxSimFPS = (1000.0f / gu->avgSimFrameTime) * (1.0f - gu->reconnectSimDrawBalance);
+	newSpeed = Clamp(newSpeed, 0.1f, ((maxSimFPS / GAME_SPEED) + internalSpeed) * 0.5f);
 #endif
 
-		if (newSpeed != internalSpeed)
-			InternalSpeedChange(newSpeed);
-	}
+	if (newSpeed != internalSpeed)
+		InternalSpeedChange(newSpeed);
 }
 
 
@@ -1057,6 +1337,10 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 
 		case NETMSG_CPU_USAGE:
 			players[a].cpuUsage = *((float*)&inbuf[1]);
+
+			// pre-game reports carry path-estimator progress instead
+			if (gameHasStarted)
+				players[a].AddCpuUsageSample(players[a].cpuUsage);
 			break;
 
 		case NETMSG_QUIT: {
@@ -1186,6 +1470,7 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 			break;
 
 		case NETMSG_SELECT:
+		case NETMSG_SELECT_DELTA:
 			try {
 				netcode::UnpackPacket pckt(packet, 3);
 				unsigned char playerNum;
@@ -1332,6 +1617,36 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 #endif
 		} break;
 
+		case NETMSG_SYNC_SUBSYSTEMS: {
+#ifdef SYNCCHECK
+			try {
+				netcode::UnpackPacket pckt(packet, 1);
+
+				unsigned char totalSize; pckt >> totalSize;
+				unsigned char playerNum; pckt >> playerNum;
+				          int  frameNum; pckt >> frameNum;
+
+				if (playerNum != a) {
+					Message(spring::format(WrongPlayer, msgCode, a, (unsigned)playerNum));
+					break;
+				}
+
+				// ignore clients built with a different set of subsystems
+				if (totalSize != (7 + CSyncChecker::SYNC_SUBSYSTEM_COUNT * sizeof(uint32_t)))
+					break;
+				// too old to still be compared
+				if (frameNum < (serverFrameNum - static_cast<int>(SYNCCHECK_TIMEOUT)))
+					break;
+
+				std::vector<unsigned>& checksums = players[a].syncSubsystems[frameNum];
+				checksums.resize(CSyncChecker::SYNC_SUBSYSTEM_COUNT);
+				pckt >> checksums;
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(spring::format("Player %s sent invalid SyncSubsystems: %s", players[a].name.c_str(), ex.what()));
+			}
+#endif
+		} break;
+
 		case NETMSG_SHARE:
 			if (inbuf[1] != a) {
 				Message(spring::format(WrongPlayer, msgCode, a, (unsigned)inbuf[1]));
@@ -2066,7 +2381,7 @@ void CGameServer::StartGame(bool forced)
 	gameHasStarted = true;
 	startTime = gameTime;
 	if (!canReconnect && !allowSpecJoin)
-		packetCache.clear(); // free memory
+		packetCache.Clear(); // free memory
 
 	if (UDPNet && !canReconnect && !allowSpecJoin)
 		UDPNet->SetAcceptingConnections(false); // do not accept new connections
@@ -2134,6 +2449,9 @@ void CGameServer::StartGame(bool forced)
 
 	Broadcast(CBaseNetProtocol::Get().SendStartPlaying(0));
 
+	// everything from here on can be replaced by a checkpoint
+	gameStartCachePos = packetCache.GetNumPackets();
+
 	if (hostif != NULL) {
 		if (demoRecorder != NULL) {
 			hostif->SendStartPlaying(gameID.charArray, demoRecorder->GetName());
@@ -2527,11 +2845,14 @@ void CGameServer::UpdateSpeedControl(int speedCtrl)
 std::string CGameServer::SpeedControlToString(int speedCtrl)
 {
 	std::string desc = "<invalid>";
-	if (speedCtrl == 0) {
-		desc = "Maximum CPU";
-	} else
 	if (speedCtrl == 1) {
 		desc = "Average CPU";
+	} else
+	if (speedCtrl == 2) {
+		desc = "Maximum CPU";
+	} else
+	if (speedCtrl == 3) {
+		desc = "Percentile CPU";
 	}
 	return desc;
 }
@@ -2544,15 +2865,23 @@ void CGameServer::UpdateLoop()
 		Threading::SetThreadName("netcode");
 		Threading::SetAffinity(~0);
 
-		while (!quitServer) {
-			spring_msecs(loopSleepTime).sleep(true);
+		int waitTime = loopSleepTime;
 
-			if (UDPNet != nullptr)
+		while (!quitServer) {
+			// packets wake the loop as soon as they arrive instead of
+			// waiting out the full sleep, local links are still polled
+			if (UDPNet != nullptr) {
+				UDPNet->WaitForData(waitTime);
 				UDPNet->Update();
+			} else {
+				spring_msecs(waitTime).sleep(true);
+			}
 
 			std::lock_guard<spring::recursive_mutex> scoped_lock(gameServerMutex);
 			ServerReadNet();
 			Update();
+
+			waitTime = GetLoopWaitTime();
 		}
 
 		if (hostif != nullptr)
@@ -2579,6 +2908,24 @@ void CGameServer::UpdateLoop()
 }
 
 
+int CGameServer::GetLoopWaitTime() const
+{
+	// nothing time-critical happens before the game starts, only
+	// local (non-socket) connections need regular polling then
+	if (!gameHasStarted)
+		return (HasLocalClient()? loopSleepTime: std::max(loopSleepTime, IDLE_LOOP_WAIT_TIME));
+
+	if (isPaused || demoReader != nullptr || internalSpeed <= 0.0f)
+		return loopSleepTime;
+
+	// CreateNewFrame generates the next frame once frameTimeLeft turns positive
+	const float msecsPerFrame = 1.0f / ((GAME_SPEED * 0.001f) * internalSpeed);
+	const int frameWaitTime = -frameTimeLeft * msecsPerFrame;
+
+	return (Clamp(frameWaitTime, 1, loopSleepTime));
+}
+
+
 void CGameServer::KickPlayer(const int playerNum)
 {
 	if (!players[playerNum].link) { // only kick connected players
@@ -2796,9 +3143,22 @@ unsigned CGameServer::BindConnection(std::string name, const std::string& passwd
 	newPlayer.SendData(CBaseNetProtocol::Get().SendSetPlayerNum((unsigned char)newPlayerNumber));
 
 	// after gamedata and playerNum, the player can start loading
-	// throw at him all stuff he missed until now
-	for (const std::shared_ptr<const netcode::RawPacket>& p: packetCache)
-		newPlayer.SendData(p);
+	// throw at him all stuff he missed until now; the checkpoint
+	// (if any) stands in for the frames dropped from the cache
+	{
+		const size_t cachePos = checkpointPackets.empty()? packetCache.GetNumPackets(): checkpointCachePos;
+
+		const auto SendCachedPacket = [&](const unsigned char* data, unsigned int length) {
+			newPlayer.SendData(std::make_shared<const netcode::RawPacket>(data, length));
+		};
+
+		packetCache.ForEachPacket(0, cachePos, SendCachedPacket);
+
+		for (const std::shared_ptr<const netcode::RawPacket>& p: checkpointPackets)
+			newPlayer.SendData(p);
+
+		packetCache.ForEachPacket(cachePos, packetCache.GetNumPackets(), SendCachedPacket);
+	}
 
 	if (demoReader == NULL || myGameSetup->demoName.empty()) {
 		// player wants to play -> join team
@@ -2871,5 +3231,50 @@ uint8_t CGameServer::ReserveSkirmishAIId()
 
 void CGameServer::AddToPacketCache(std::shared_ptr<const netcode::RawPacket> &pckt)
 {
-	packetCache.push_back(pckt);
+	packetCache.AddPacket(pckt.get());
+}
+
+
+void CGameServer::AddCheckpoint(int frameNum, const std::vector<uint8_t>& data)
+{
+	std::lock_guard<spring::recursive_mutex> scoped_lock(gameServerMutex);
+
+	// no one could join later, or the cache is not kept at all
+	if (!gameHasStarted || demoReader != nullptr || (!canReconnect && !allowSpecJoin))
+		return;
+
+	// the checkpoint covers everything up to and including the keyframe
+	size_t cachePos = gameStartCachePos;
+	size_t packetNum = gameStartCachePos;
+
+	packetCache.ForEachPacket(gameStartCachePos, packetCache.GetNumPackets(), [&](const unsigned char* data, unsigned int length) {
+		packetNum += 1;
+
+		if (data[0] == NETMSG_KEYFRAME && *reinterpret_cast<const int32_t*>(data + 1) == frameNum)
+			cachePos = packetNum;
+	});
+
+	if (cachePos == gameStartCachePos) {
+		LOG_L(L_WARNING, "[GameServer::%s] keyframe %d not found in packet-cache, checkpoint dropped", __func__, frameNum);
+		return;
+	}
+
+	CPacketCache newPacketCache;
+
+	const auto CopyPacket = [&](const unsigned char* data, unsigned int length) { newPacketCache.AddPacket(data, length); };
+
+	packetCache.ForEachPacket(0, gameStartCachePos, CopyPacket);
+
+	// keep whatever changed the parts of the game not covered by the saved state
+	packetCache.ForEachPacket(gameStartCachePos, cachePos, [&](const unsigned char* data, unsigned int length) {
+		if (!CoveredByCheckpoint(data[0]))
+			newPacketCache.AddPacket(data, length);
+	});
+
+	checkpointCachePos = newPacketCache.GetNumPackets();
+
+	packetCache.ForEachPacket(cachePos, packetCache.GetNumPackets(), CopyPacket);
+	packetCache = std::move(newPacketCache);
+
+	PackCheckpoint(frameNum, data, checkpointPackets);
 }
@@ -14,6 +14,7 @@
 #include <vector>
 
 #include "Game/GameData.h"
+#include "Net/PacketCache.h"
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/TeamBase.h"
 #include "System/float3.h"
@@ -21,6 +22,10 @@
 #include "System/Misc/SpringTime.h"
 #include "System/Threading/SpringThreading.h"
 
+#ifdef SYNCCHECK
+#include "System/Sync/SyncChecker.h"
+#endif
+
 /**
  * "player" number for GameServer-generated messages
  */
@@ -31,6 +36,7 @@ namespace netcode
 	class RawPacket;
 	class CConnection;
 	class UDPListener;
+	struct LinkStats;
 }
 class CDemoReader;
 class Action;
@@ -88,8 +94,17 @@ public:
 
 	void CreateNewFrame(bool fromServerThread, bool fixedFrameTime);
 
+	/**
+	 * @brief store a game-state checkpoint taken by the local client after
+	 * the keyframe for frameNum; late-joining clients receive it instead of
+	 * every cached packet up to that frame, which are dropped from the cache
+	 */
+	void AddCheckpoint(int frameNum, const std::vector<uint8_t>& data);
+
 	void SetGamePausable(const bool arg);
 	void SetReloading(const bool arg) { reloadingServer = arg; }
+	/// feed demo frames as fast as the local client simulates them instead of in real-time
+	void SetUnlimitedDemoSpeed(const bool arg) { unlimitedDemoSpeed = arg; }
 
 	bool PreSimFrame() const { return (serverFrameNum == -1); }
 	bool HasStarted() const { return gameHasStarted; }
@@ -97,12 +112,16 @@ public:
 	bool HasLocalClient() const { return (localClientNumber != -1u); }
 	/// Is the server still running?
 	bool HasFinished() const;
+	/// has the demo being played back been sent out completely?
+	bool DemoReachedEnd() const { return demoReachedEnd; }
 
 	void UpdateSpeedControl(int speedCtrl);
 	static std::string SpeedControlToString(int speedCtrl);
 	static const std::set<std::string>& GetCommandBlackList() { return commandBlacklist; }
 
 	std::string GetPlayerNames(const std::vector<int>& indices) const;
+	/// quality of the server's link to a player, all zero if not connected
+	netcode::LinkStats GetPlayerLinkStats(int playerNum) const;
 
 	const std::shared_ptr<const ClientSetup> GetClientSetup() const { return myClientSetup; }
 	const std::shared_ptr<const    GameData> GetGameData() const { return myGameData; }
@@ -143,9 +162,12 @@ private:
 	void CheckForGameStart(bool forced = false);
 	void StartGame(bool forced);
 	void UpdateLoop();
+	/// how long UpdateLoop may block waiting for packets before the next frame is due
+	int GetLoopWaitTime() const;
 	void Update();
 	void ProcessPacket(const unsigned playerNum, std::shared_ptr<const netcode::RawPacket> packet);
 	void CheckSync();
+	void CheckSyncSubsystems();
 	void HandleConnectionAttempts();
 	void ServerReadNet();
 
@@ -157,6 +179,8 @@ private:
 	void WriteDemoData();
 	/// read data from demo and send it to clients
 	bool SendDemoData(int targetFrameNum);
+	/// replaced packets are only sent if a checkpoint does not cover them
+	void HandleDemoPacket(std::shared_ptr<const netcode::RawPacket> packet, int targetFrameNum, bool replaced);
 
 	void Broadcast(std::shared_ptr<const netcode::RawPacket> packet);
 
@@ -167,6 +191,8 @@ private:
 	 * targetFrame to all clients
 	 */
 	void SkipTo(int targetFrameNum);
+	/// load the last checkpoint embedded in the demo before targetFrame (if any)
+	void SkipToCheckpoint(int targetFrameNum);
 
 	void Message(const std::string& message, bool broadcast = true, bool internal = false);
 	void PrivateMessage(int playerNum, const std::string& message);
@@ -183,6 +209,8 @@ private:
 
 	/////////////////// game status variables ///////////////////
 	volatile bool quitServer;
+	volatile bool demoReachedEnd;
+	volatile bool unlimitedDemoSpeed;
 	int serverFrameNum;
 
 	spring_time serverStartTime;
@@ -222,6 +250,7 @@ private:
 	float medianCpu;
 	int medianPing;
 	int curSpeedCtrl;
+	bool speedCtrlIncludeSpecs;
 	int loopSleepTime;
 
 	/// The maximum speed users are allowed to set
@@ -239,11 +268,18 @@ private:
 	bool logInfoMessages;
 	bool logDebugMessages;
 
-	std::deque< std::shared_ptr<const netcode::RawPacket> > packetCache;
+	CPacketCache packetCache;
+	/// latest checkpoint split into NETMSG_CHECKPOINT chunks, sent in place of the cached frames before it
+	std::vector< std::shared_ptr<const netcode::RawPacket> > checkpointPackets;
+
+	size_t gameStartCachePos;
+	size_t checkpointCachePos;
 
 	/////////////////// sync stuff ///////////////////
 #ifdef SYNCCHECK
 	std::set<int> outstandingSyncFrames;
+	/// per subsystem, frame the last divergence was reported for
+	std::array<int, CSyncChecker::SYNC_SUBSYSTEM_COUNT> syncSubsystemErrorFrames;
 #endif
 	int syncErrorFrame;
 	int syncWarningFrame;
@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <cinttypes>
+#include <limits>
 
 #include "Game/Game.h"
 #include "GameServer.h"
@@ -9,6 +10,7 @@
 #include "ExternalAI/SkirmishAIHandler.h"
 #include "Game/ClientData.h"
 #include "Game/CommandMessage.h"
+#include "Game/DemoBatch.h"
 #include "Game/GameSetup.h"
 #include "Game/GlobalUnsynced.h"
 #include "Game/SelectedUnitsHandler.h"
@@ -38,12 +40,19 @@
 #include "System/Sound/ISound.h"
 
 CONFIG(bool, LogClientData).defaultValue(false);
+CONFIG(int, FastForwardQueuedFrames).defaultValue(GAME_SPEED * 10).minimumValue(0).description("Number of queued sim frames above which a client catching up to the server (e.g. when rejoining) stops playing sounds, spawning effects and updating AIs and UI until it is close to the server again. 0 disables.");
+
+static ConfigHandle<int> fastForwardQueuedFrames("FastForwardQueuedFrames");
 
 #define LOG_SECTION_NET "Net"
 LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_NET)
 
 static spring::unordered_map<int, unsigned int> localSyncChecksums;
 
+// every 64 frames per-subsystem checksums are sent along with the sync-response
+// (4096 is a multiple, so the last set before each checksum reset is not lost)
+static constexpr int SYNC_SUBSYSTEMS_INTERVAL = 64;
+
 
 void CGame::AddTraffic(int playerID, int packetCode, int length)
 {
@@ -141,6 +150,19 @@ void CGame::UpdateNumQueuedSimFrames()
 	//
 	const unsigned int numQueuedFrames = GetNumQueuedSimFrameMessages(-1u);
 
+	{
+		// leave at a quarter of the threshold to not toggle on network jitter
+		const unsigned int maxQueuedFrames = fastForwardQueuedFrames.Get();
+
+		if (!gu->fastForwarding) {
+			if (maxQueuedFrames > 0 && numQueuedFrames > maxQueuedFrames)
+				StartFastForward();
+		} else {
+			if (maxQueuedFrames == 0 || numQueuedFrames <= (maxQueuedFrames / 4))
+				EndFastForward();
+		}
+	}
+
 	if (globalConfig->useNetMessageSmoothingBuffer) {
 		if (numQueuedFrames < lastNumQueuedSimFrames) {
 			// conservative policy: take minimum of current and previous queue size
@@ -196,6 +218,10 @@ void CGame::UpdateNetMessageProcessingTimeLeft()
 		// ensure ClientReadNet returns at least every 15 simframes
 		// so CGame can process keyboard input, and render etc.
 		msgProcTimeLeft = (GAME_SPEED / float(gu->minFPS) * gs->wantedSpeedFactor) * 1000.0f;
+
+		// batch replays only stop for the processing-time limit
+		if (CDemoBatch::unlimited)
+			msgProcTimeLeft = std::numeric_limits<float>::max();
 	}
 }
 
@@ -513,6 +539,14 @@ void CGame::ClientReadNet()
 				ASSERT_SYNCED(CSyncChecker::GetChecksum());
 				clientNet->Send(CBaseNetProtocol::Get().SendSyncResponse(gu->myPlayerNum, gs->frameNum, CSyncChecker::GetChecksum()));
 
+				if ((gs->frameNum % SYNC_SUBSYSTEMS_INTERVAL) == 0) {
+					// lets the server name the part of the simulation that desynced first
+					std::vector<uint32_t> subsystemChecksums(CSyncChecker::SYNC_SUBSYSTEM_COUNT);
+					CSyncChecker::GetSubsystemChecksums(subsystemChecksums.data());
+
+					clientNet->Send(CBaseNetProtocol::Get().SendSyncSubsystems(gu->myPlayerNum, gs->frameNum, subsystemChecksums));
+				}
+
 				if (gameServer != NULL && gameServer->GetDemoReader() != NULL) {
 					// buffer all checksums, so we can check sync later between demo & local
 					localSyncChecksums[gs->frameNum] = CSyncChecker::GetChecksum();
@@ -523,10 +557,52 @@ void CGame::ClientReadNet()
 					CSyncChecker::NewFrame();
 				}
 #endif
+				if (packetCode == NETMSG_KEYFRAME)
+					SaveCheckpoint();
+
 				AddTraffic(-1, packetCode, dataLength);
 
 			} break;
 
+			case NETMSG_CHECKPOINT: {
+				try {
+					netcode::UnpackPacket unpack(packet, sizeof(uint8_t));
+
+					std::uint16_t packetSize;
+					std::int32_t frameNum;
+					std::uint32_t totalSize;
+					std::uint32_t offset;
+
+					unpack >> packetSize;
+					if (packetSize != packet->length)
+						throw netcode::UnpackPacketException("invalid packet-size");
+
+					unpack >> frameNum;
+					unpack >> totalSize;
+					unpack >> offset;
+
+					std::vector<std::uint8_t> chunk(packetSize - (1 + sizeof(packetSize) + sizeof(frameNum) + sizeof(totalSize) + sizeof(offset)));
+
+					unpack >> chunk;
+
+					if (offset == 0)
+						checkpointData.clear();
+					if (offset != checkpointData.size() || (offset + chunk.size()) > totalSize)
+						throw netcode::UnpackPacketException("invalid chunk");
+
+					checkpointData.insert(checkpointData.end(), chunk.begin(), chunk.end());
+
+					// chunks arrive in order, the last one completes the checkpoint
+					if (checkpointData.size() == totalSize)
+						LoadCheckpoint(frameNum);
+
+					AddTraffic(-1, packetCode, dataLength);
+				} catch (const netcode::UnpackPacketException& ex) {
+					checkpointData.clear();
+					LOG_L(L_ERROR, "[Game::%s][NETMSG_CHECKPOINT] exception \"%s\"", __func__, ex.what());
+				}
+			} break;
+
 			case NETMSG_SYNCRESPONSE: {
 #if (defined(SYNCCHECK))
 				if (gameServer != nullptr && gameServer->GetDemoReader() != nullptr) {
@@ -633,6 +709,54 @@ void CGame::ClientReadNet()
 				break;
 			}
 
+			case NETMSG_SELECT_DELTA: {
+				try {
+					netcode::UnpackPacket pckt(packet, 1);
+
+					unsigned short packetSize; pckt >> packetSize;
+					unsigned char playerNum; pckt >> playerNum;
+					unsigned char selectGen; pckt >> selectGen;
+					unsigned short numRemoved; pckt >> numRemoved;
+
+					if (!playerHandler->IsValidPlayer(playerNum))
+						throw netcode::UnpackPacketException("Invalid player number");
+					if (packetSize < (7 + numRemoved * sizeof(short int)))
+						throw netcode::UnpackPacketException("Invalid removed unit count");
+
+					const unsigned int numAdded = (packetSize - 7 - numRemoved * sizeof(short int)) / sizeof(short int);
+
+					std::vector<int> removedUnitIDs;
+					std::vector<int> addedUnitIDs;
+					removedUnitIDs.reserve(numRemoved);
+					addedUnitIDs.reserve(numAdded);
+
+					for (int a = 0; a < numRemoved; ++a) {
+						short int unitID; pckt >> unitID;
+						removedUnitIDs.push_back(unitID);
+					}
+
+					// same checks as NETMSG_SELECT
+					for (int a = 0; a < numAdded; ++a) {
+						short int unitID; pckt >> unitID;
+						const CUnit* unit = unitHandler->GetUnit(unitID);
+
+						if (unit == nullptr)
+							continue;
+
+						if (playerHandler->Player(playerNum)->CanControlTeam(unit->team)) {
+							addedUnitIDs.push_back(unitID);
+						}
+					}
+
+					selectedUnitsHandler.NetSelectDelta(removedUnitIDs, addedUnitIDs, selectGen, playerNum);
+					AddTraffic(playerNum, packetCode, dataLength);
+				} catch (const netcode::UnpackPacketException& ex) {
+					LOG_L(L_ERROR, "[Game::%s][NETMSG_SELECT_DELTA] exception \"%s\"", __func__, ex.what());
+				}
+
+				break;
+			}
+
 			case NETMSG_AICOMMAND:
 			case NETMSG_AICOMMAND_TRACKED: {
 				try {
@@ -0,0 +1,127 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <zlib.h>
+
+#include "PacketCache.h"
+#include "System/Net/RawPacket.h"
+#include "System/Log/ILog.h"
+
+// packets are at most 64KB, so every chunk holds at least a few of them
+static constexpr unsigned int CHUNK_SIZE = 256 * 1024;
+
+
+void CPacketCache::AddPacket(const netcode::RawPacket* packet)
+{
+	AddPacket(packet->data, packet->length);
+}
+
+void CPacketCache::AddPacket(const unsigned char* data, unsigned int length)
+{
+	if (chunks.empty() || (chunks.back().rawSize + length) > CHUNK_SIZE) {
+		if (!chunks.empty())
+			SealChunk(chunks.back());
+
+		chunks.emplace_back();
+		chunks.back().bytes.reserve(std::max(length, CHUNK_SIZE));
+		chunks.back().firstPacket = numPackets;
+	}
+
+	Chunk& chunk = chunks.back();
+
+	chunk.offsets.push_back(chunk.rawSize);
+	chunk.bytes.insert(chunk.bytes.end(), data, data + length);
+	chunk.rawSize += length;
+
+	numPackets += 1;
+}
+
+void CPacketCache::Clear()
+{
+	chunks.clear();
+	chunks.shrink_to_fit();
+
+	numPackets = 0;
+}
+
+
+void CPacketCache::SealChunk(Chunk& chunk)
+{
+	chunk.offsets.shrink_to_fit();
+
+	uLongf packedSize = compressBound(chunk.rawSize);
+	std::vector<unsigned char> packed(packedSize);
+
+	// keep the raw bytes if compression does not pay off
+	if (compress2(packed.data(), &packedSize, chunk.bytes.data(), chunk.rawSize, Z_BEST_SPEED) != Z_OK || packedSize >= chunk.rawSize) {
+		chunk.bytes.shrink_to_fit();
+		return;
+	}
+
+	packed.resize(packedSize);
+	packed.shrink_to_fit();
+
+	chunk.bytes = std::move(packed);
+	chunk.compressed = true;
+}
+
+const unsigned char* CPacketCache::GetChunkData(const Chunk& chunk, std::vector<unsigned char>& buffer) const
+{
+	if (!chunk.compressed)
+		return chunk.bytes.data();
+
+	uLongf rawSize = chunk.rawSize;
+	buffer.resize(rawSize);
+
+	if (uncompress(buffer.data(), &rawSize, chunk.bytes.data(), chunk.bytes.size()) != Z_OK || rawSize != chunk.rawSize) {
+		LOG_L(L_ERROR, "[PacketCache::%s] corrupted chunk (first packet %u)", __func__, unsigned(chunk.firstPacket));
+		return nullptr;
+	}
+
+	return buffer.data();
+}
+
+
+void CPacketCache::ForEachPacket(size_t beg, size_t end, const PacketFunc& func) const
+{
+	end = std::min(end, numPackets);
+
+	if (beg >= end)
+		return;
+
+	// first chunk holding packets at or after beg
+	auto iter = std::upper_bound(chunks.begin(), chunks.end(), beg, [](size_t n, const Chunk& c) { return (n < c.firstPacket); }) - 1;
+
+	std::vector<unsigned char> buffer;
+
+	for (; iter != chunks.end() && iter->firstPacket < end; ++iter) {
+		const Chunk& chunk = *iter;
+		const unsigned char* data = GetChunkData(chunk, buffer);
+
+		if (data == nullptr)
+			continue;
+
+		const size_t chunkBeg = std::max(beg, chunk.firstPacket) - chunk.firstPacket;
+		const size_t chunkEnd = std::min(end - chunk.firstPacket, chunk.offsets.size());
+
+		for (size_t n = chunkBeg; n < chunkEnd; n++) {
+			const unsigned int packetBeg = chunk.offsets[n];
+			const unsigned int packetEnd = ((n + 1) < chunk.offsets.size())? chunk.offsets[n + 1]: chunk.rawSize;
+
+			func(data + packetBeg, packetEnd - packetBeg);
+		}
+	}
+}
+
+
+size_t CPacketCache::GetMemoryUsage() const
+{
+	size_t bytes = chunks.capacity() * sizeof(Chunk);
+
+	for (const Chunk& chunk: chunks) {
+		bytes += chunk.bytes.capacity();
+		bytes += chunk.offsets.capacity() * sizeof(unsigned int);
+	}
+
+	return bytes;
+}
@@ -0,0 +1,60 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _PACKET_CACHE_H
+#define _PACKET_CACHE_H
+
+#include <functional>
+#include <vector>
+
+namespace netcode
+{
+	class RawPacket;
+}
+
+/**
+ * @brief append-only store for the packets a (late-)joining client has missed
+ *
+ * Packets are copied into contiguous chunks with an offset index instead of
+ * keeping one allocation per packet alive for the whole game. Full chunks are
+ * compressed, they are only read back when a client joins.
+ */
+class CPacketCache
+{
+public:
+	typedef std::function<void(const unsigned char* data, unsigned int length)> PacketFunc;
+
+	CPacketCache(): numPackets(0) {}
+
+	void AddPacket(const netcode::RawPacket* packet);
+	void AddPacket(const unsigned char* data, unsigned int length);
+	void Clear();
+
+	/// calls func for each cached packet in [beg, end), in order
+	void ForEachPacket(size_t beg, size_t end, const PacketFunc& func) const;
+
+	size_t GetNumPackets() const { return numPackets; }
+	size_t GetMemoryUsage() const;
+
+private:
+	struct Chunk {
+		/// packet data, compressed once the chunk is sealed
+		std::vector<unsigned char> bytes;
+		/// packet n starts at offsets[n], ends where the next one starts (or at rawSize)
+		std::vector<unsigned int> offsets;
+
+		size_t firstPacket = 0;
+		unsigned int rawSize = 0;
+		bool compressed = false;
+	};
+
+	void SealChunk(Chunk& chunk);
+
+	const unsigned char* GetChunkData(const Chunk& chunk, std::vector<unsigned char>& buffer) const;
+
+private:
+	std::vector<Chunk> chunks;
+
+	size_t numPackets;
+};
+
+#endif // _PACKET_CACHE_H
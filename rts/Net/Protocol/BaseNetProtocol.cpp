@@ -95,14 +95,15 @@ PacketType CBaseNetProtocol::SendPathCheckSum(uint8_t myPlayerNum, uint32_t chec
 }
 
 
-PacketType CBaseNetProtocol::SendCommand(uint8_t myPlayerNum, int32_t id, uint8_t options, const std::vector<float>& params)
+PacketType CBaseNetProtocol::SendCommand(uint8_t myPlayerNum, int32_t id, uint8_t options, const float* params, uint32_t numParams)
 {
-	const uint32_t payloadSize = sizeof(myPlayerNum) + sizeof(id) + sizeof(options) + (params.size() * sizeof(float));
+	const uint32_t payloadSize = sizeof(myPlayerNum) + sizeof(id) + sizeof(options) + (numParams * sizeof(float));
 	const uint32_t headerSize = sizeof(uint8_t) + sizeof(uint16_t);
 	const uint32_t packetSize = headerSize + payloadSize;
 
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_COMMAND);
-	*packet << static_cast<uint16_t>(packetSize) << myPlayerNum << id << options << params;
+	*packet << static_cast<uint16_t>(packetSize) << myPlayerNum << id << options;
+	packet->WriteArray(params, numParams);
 	return PacketType(packet);
 }
 
@@ -117,6 +118,21 @@ PacketType CBaseNetProtocol::SendSelect(uint8_t myPlayerNum, const std::vector<i
 	return PacketType(packet);
 }
 
+PacketType CBaseNetProtocol::SendSelectDelta(uint8_t myPlayerNum, uint8_t selectGen, const std::vector<int16_t>& removedUnitIDs, const std::vector<int16_t>& addedUnitIDs)
+{
+	const uint32_t payloadSize = sizeof(myPlayerNum) + sizeof(selectGen) + sizeof(uint16_t) + ((removedUnitIDs.size() + addedUnitIDs.size()) * sizeof(int16_t));
+	const uint32_t headerSize = sizeof(uint8_t) + sizeof(uint16_t);
+	const uint32_t packetSize = headerSize + payloadSize;
+
+	if (packetSize >= (1 << (sizeof(uint16_t) * 8)))
+		throw netcode::PackPacketException("[BaseNetProto::SendSelectDelta] maximum packet-size exceeded");
+
+	PackPacket* packet = new PackPacket(packetSize, NETMSG_SELECT_DELTA);
+	*packet << static_cast<uint16_t>(packetSize) << myPlayerNum << selectGen << static_cast<uint16_t>(removedUnitIDs.size());
+	*packet << removedUnitIDs << addedUnitIDs;
+	return PacketType(packet);
+}
+
 
 PacketType CBaseNetProtocol::SendPause(uint8_t myPlayerNum, uint8_t bPaused)
 {
@@ -134,13 +150,14 @@ PacketType CBaseNetProtocol::SendAICommand(
 	int32_t commandID,
 	int32_t aiCommandID,
 	uint8_t options,
-	const std::vector<float>& params
+	const float* params,
+	uint32_t numParams
 ) {
 	const int32_t commandTypeID = (aiCommandID != -1)? NETMSG_AICOMMAND_TRACKED: NETMSG_AICOMMAND;
 
 	const uint32_t payloadSize =
 		sizeof(myPlayerNum) + sizeof(aiID) + sizeof(unitID) + sizeof(commandID) + sizeof(options) +
-		(sizeof(commandTypeID) * (commandTypeID == NETMSG_AICOMMAND_TRACKED)) + (params.size() * sizeof(float));
+		(sizeof(commandTypeID) * (commandTypeID == NETMSG_AICOMMAND_TRACKED)) + (numParams * sizeof(float));
 	const uint32_t headerSize = sizeof(uint8_t) + sizeof(uint16_t);
 	const uint32_t packetSize = headerSize + payloadSize;
 
@@ -154,7 +171,7 @@ PacketType CBaseNetProtocol::SendAICommand(
 	if (commandTypeID == NETMSG_AICOMMAND_TRACKED)
 		*packet << aiCommandID;
 
-	*packet << params;
+	packet->WriteArray(params, numParams);
 	return PacketType(packet);
 }
 
@@ -337,6 +354,17 @@ PacketType CBaseNetProtocol::SendSyncResponse(uint8_t myPlayerNum, int32_t frame
 	return PacketType(packet);
 }
 
+PacketType CBaseNetProtocol::SendSyncSubsystems(uint8_t myPlayerNum, int32_t frameNum, const std::vector<uint32_t>& checksums)
+{
+	const uint32_t payloadSize = sizeof(myPlayerNum) + sizeof(frameNum) + (checksums.size() * sizeof(uint32_t));
+	const uint32_t headerSize = sizeof(uint8_t) + sizeof(uint8_t);
+	const uint32_t packetSize = headerSize + payloadSize;
+
+	PackPacket* packet = new PackPacket(packetSize, NETMSG_SYNC_SUBSYSTEMS);
+	*packet << static_cast<uint8_t>(packetSize) << myPlayerNum << frameNum << checksums;
+	return PacketType(packet);
+}
+
 PacketType CBaseNetProtocol::SendSystemMessage(uint8_t myPlayerNum, std::string message)
 {
 	if (message.size() > 65000) {
@@ -499,6 +527,20 @@ PacketType CBaseNetProtocol::SendClientData(uint8_t playerNum, const std::vector
 	return PacketType(packet);
 }
 
+PacketType CBaseNetProtocol::SendCheckpoint(int32_t frameNum, uint32_t totalSize, uint32_t offset, const std::vector<uint8_t>& data)
+{
+	const uint32_t payloadSize = sizeof(frameNum) + sizeof(totalSize) + sizeof(offset) + data.size();
+	const uint32_t headerSize = sizeof(uint8_t) + sizeof(uint16_t);
+	const uint32_t packetSize = headerSize + payloadSize;
+
+	if (packetSize >= (1 << (sizeof(uint16_t) * 8)))
+		throw netcode::PackPacketException("[BaseNetProto::SendCheckpoint] maximum packet-size exceeded");
+
+	PackPacket* packet = new PackPacket(packetSize, NETMSG_CHECKPOINT);
+	*packet << static_cast<uint16_t>(packetSize) << frameNum << totalSize << offset << data;
+	return PacketType(packet);
+}
+
 
 
 #ifdef SYNCDEBUG
@@ -606,6 +648,9 @@ CBaseNetProtocol::CBaseNetProtocol()
 	proto->AddType(NETMSG_AI_CREATED, -1);
 	proto->AddType(NETMSG_AI_STATE_CHANGED, 4);
 	proto->AddType(NETMSG_GAME_FRAME_PROGRESS,5);
+	proto->AddType(NETMSG_CHECKPOINT, -2);
+	proto->AddType(NETMSG_SYNC_SUBSYSTEMS, -1);
+	proto->AddType(NETMSG_SELECT_DELTA, -2);
 
 #ifdef SYNCDEBUG
 	proto->AddType(NETMSG_SD_CHKREQUEST, 5);
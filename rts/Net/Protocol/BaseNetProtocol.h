@@ -116,6 +116,13 @@ enum NETMSG {
 
 	NETMSG_GAME_FRAME_PROGRESS= 77, // int32_t frameNum # this special packet skips queue & cache entirely, indicates current game progress for clients fast-forwarding to current point the game #
 
+	NETMSG_CHECKPOINT       = 78, // uint16_t messageSize, int32_t frameNum, uint32_t totalSize, uint32_t offset, std::vector<uint8_t> data # only sent to late-joining clients, one chunk of a game-state checkpoint #
+
+	NETMSG_SYNC_SUBSYSTEMS  = 79, // uint8_t messageSize, uint8_t myPlayerNum; int32_t frameNum; std::vector<uint32_t> checksums # one per CSyncChecker subsystem, sent every few sync-responses #
+
+	NETMSG_SELECT_DELTA     = 80, // uint16_t messageSize, uint8_t myPlayerNum; uint8_t selectGen; uint16_t numRemoved; std::vector<int16_t> removedUnitIDs; std::vector<int16_t> addedUnitIDs
+	                              // # changes the previous selection instead of replacing it, ignored if that selection was cleared (selectGen mismatch) #
+
 
 	NETMSG_LAST //max types of netmessages, internal only
 };
@@ -161,11 +168,12 @@ public:
 	PacketType SendRandSeed(uint32_t randSeed);
 	PacketType SendGameID(const uint8_t* buf);
 	PacketType SendPathCheckSum(uint8_t myPlayerNum, uint32_t checksum);
-	PacketType SendCommand(uint8_t myPlayerNum, int32_t id, uint8_t options, const std::vector<float>& params);
+	PacketType SendCommand(uint8_t myPlayerNum, int32_t id, uint8_t options, const float* params, uint32_t numParams);
 	PacketType SendSelect(uint8_t myPlayerNum, const std::vector<int16_t>& selectedUnitIDs);
+	PacketType SendSelectDelta(uint8_t myPlayerNum, uint8_t selectGen, const std::vector<int16_t>& removedUnitIDs, const std::vector<int16_t>& addedUnitIDs);
 	PacketType SendPause(uint8_t myPlayerNum, uint8_t bPaused);
 
-	PacketType SendAICommand(uint8_t myPlayerNum, uint8_t aiID, int16_t unitID, int32_t commandID, int32_t aiCommandID, uint8_t options, const std::vector<float>& params);
+	PacketType SendAICommand(uint8_t myPlayerNum, uint8_t aiID, int16_t unitID, int32_t commandID, int32_t aiCommandID, uint8_t options, const float* params, uint32_t numParams);
 	PacketType SendAIShare(uint8_t myPlayerNum, uint8_t aiID, uint8_t sourceTeam, uint8_t destTeam, float metal, float energy, const std::vector<int16_t>& unitIDs);
 
 	PacketType SendUserSpeed(uint8_t myPlayerNum, float userSpeed);
@@ -184,6 +192,7 @@ public:
 	PacketType SendMapDrawLine(uint8_t myPlayerNum, int16_t x1, int16_t z1, int16_t x2, int16_t z2, bool);
 	PacketType SendMapDrawPoint(uint8_t myPlayerNum, int16_t x, int16_t z, const std::string& label, bool);
 	PacketType SendSyncResponse(uint8_t myPlayerNum, int32_t frameNum, uint32_t checksum);
+	PacketType SendSyncSubsystems(uint8_t myPlayerNum, int32_t frameNum, const std::vector<uint32_t>& checksums);
 	PacketType SendSystemMessage(uint8_t myPlayerNum, std::string message);
 	PacketType SendStartPos(uint8_t myPlayerNum, uint8_t teamNum, uint8_t readyState, float x, float y, float z);
 	PacketType SendPlayerInfo(uint8_t myPlayerNum, float cpuUsage, int32_t ping);
@@ -219,6 +228,8 @@ public:
 
 	PacketType SendClientData(uint8_t playerNum, const std::vector<uint8_t>& data);
 
+	PacketType SendCheckpoint(int32_t frameNum, uint32_t totalSize, uint32_t offset, const std::vector<uint8_t>& data);
+
 #ifdef SYNCDEBUG
 	PacketType SendSdCheckrequest(int32_t frameNum);
 	PacketType SendSdCheckresponse(uint8_t myPlayerNum, uint64_t flop, std::vector<uint32_t> checksums);
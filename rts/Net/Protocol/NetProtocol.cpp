@@ -164,4 +164,5 @@ void CNetProtocol::SetDemoRecorder(CDemoRecorder* r) { demoRecorder.reset(r); }
 CDemoRecorder* CNetProtocol::GetDemoRecorder() const { return demoRecorder.get(); }
 
 unsigned int CNetProtocol::GetNumWaitingServerPackets() const { return (serverConn.get())->GetPacketQueueSize(); }
+netcode::LinkStats CNetProtocol::GetLinkStats() const { return (serverConn.get())->GetLinkStats(); }
 
@@ -13,6 +13,7 @@ namespace netcode
 {
 	class RawPacket;
 	class CConnection;
+	struct LinkStats;
 }
 
 /**
@@ -103,6 +104,7 @@ public:
 	CDemoRecorder* GetDemoRecorder() const;
 
 	unsigned int GetNumWaitingServerPackets() const;
+	netcode::LinkStats GetLinkStats() const;
 
 
 private:
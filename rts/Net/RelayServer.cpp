@@ -0,0 +1,221 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/Net/UDPListener.h"
+#include "System/Net/UDPConnection.h"
+
+#include "RelayServer.h"
+#include "Game/GameVersion.h"
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "System/GlobalConfig.h"
+#include "System/SpringFormat.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Net/UnpackPacket.h"
+#include "System/Platform/errorhandler.h"
+#include "System/Platform/Threading.h"
+
+
+CRelayServer::CRelayServer(
+	const std::string& upstreamHost,
+	unsigned int upstreamPort,
+	unsigned int listenPort,
+	const std::string& name,
+	const std::string& passwd
+)
+	: quitRelay(false)
+	, finished(false)
+	, thread(nullptr)
+{
+	loopSleepTime = configHandler->GetInt("ServerSleepTime");
+
+	listener.reset(new netcode::UDPListener(listenPort));
+
+	upstream.reset(new netcode::UDPConnection(0, upstreamHost, upstreamPort));
+	upstream->Unmute();
+	upstream->SendData(CBaseNetProtocol::Get().SendAttemptConnect(name, passwd, SpringVersion::GetFull(), globalConfig->networkLossFactor));
+	upstream->Flush(true);
+
+	LOG("[RelayServer] connecting to %s as %s, serving spectators on port %u", upstream->GetFullAddress().c_str(), name.c_str(), listenPort);
+
+	thread = new spring::thread(std::bind(&CRelayServer::UpdateLoop, this));
+}
+
+CRelayServer::~CRelayServer()
+{
+	quitRelay.store(true);
+
+	thread->join();
+	delete thread;
+
+	LOG("%s", upstream->Statistics().c_str());
+}
+
+
+void CRelayServer::UpdateLoop()
+{
+	try {
+		Threading::SetThreadName("relay");
+
+		while (!quitRelay.load()) {
+			spring_msecs(loopSleepTime).sleep(true);
+
+			listener->Update();
+
+			HandleConnectionAttempts();
+			ReadUpstream();
+			UpdateClients();
+		}
+
+		upstream->SendData(CBaseNetProtocol::Get().SendQuit("Relay shutdown"));
+		upstream->Close(true);
+
+		// flush the quit messages (ours, or the one forwarded from upstream)
+		for (const auto& client: clients) {
+			client->Flush(true);
+		}
+
+		spring_sleep(spring_msecs(500));
+	} CATCH_SPRING_ERRORS
+
+	finished.store(true);
+}
+
+
+void CRelayServer::Broadcast(std::shared_ptr<const netcode::RawPacket> packet)
+{
+	for (const auto& client: clients) {
+		client->SendData(packet);
+	}
+
+	packetCache.AddPacket(packet.get());
+}
+
+
+void CRelayServer::ReadUpstream()
+{
+	upstream->Update();
+
+	std::shared_ptr<const netcode::RawPacket> packet;
+
+	while ((packet = upstream->GetData()) != nullptr) {
+		Broadcast(packet);
+
+		switch (packet->data[0]) {
+			case NETMSG_KEYFRAME: {
+				// answer on behalf of the clients, keeps the relay's ping sane upstream
+				upstream->SendData(CBaseNetProtocol::Get().SendKeyFrame(*(int*)(packet->data + 1)));
+			} break;
+
+			case NETMSG_QUIT:
+			case NETMSG_REJECT_CONNECT: {
+				std::string reason;
+
+				try {
+					netcode::UnpackPacket msg(packet, 3);
+					msg >> reason;
+				} catch (const netcode::UnpackPacketException& ex) {
+					reason = ex.what();
+				}
+
+				LOG("[RelayServer] upstream closed the connection: %s", reason.c_str());
+				quitRelay.store(true);
+				return;
+			}
+
+			default: {
+			} break;
+		}
+	}
+
+	if (upstream->CheckTimeout(0, packetCache.GetNumPackets() == 0)) {
+		LOG_L(L_WARNING, "[RelayServer] connection to %s timed out", upstream->GetFullAddress().c_str());
+		Broadcast(CBaseNetProtocol::Get().SendQuit("Relay lost the connection to the server"));
+		quitRelay.store(true);
+	}
+}
+
+
+void CRelayServer::HandleConnectionAttempts()
+{
+	while (listener->HasIncomingConnections()) {
+		std::shared_ptr<netcode::UDPConnection> prev = listener->PreviewConnection().lock();
+		std::shared_ptr<const netcode::RawPacket> packet = prev->GetData();
+
+		if (packet == nullptr) {
+			listener->RejectConnection();
+			continue;
+		}
+
+		try {
+			if (packet->length < 3 || packet->data[0] != NETMSG_ATTEMPTCONNECT)
+				throw netcode::UnpackPacketException("Invalid message ID");
+
+			netcode::UnpackPacket msg(packet, 3);
+			std::string name, passwd, version;
+			unsigned char reconnect;
+			unsigned short netversion;
+			msg >> netversion;
+			msg >> name;
+			msg >> passwd;
+			msg >> version;
+			msg >> reconnect;
+
+			if (netversion != NETWORK_VERSION)
+				throw netcode::UnpackPacketException(spring::format("Wrong network version: received %d, required %d", (int)netversion, (int)NETWORK_VERSION));
+			// the stream state of the old connection is gone, a fresh one replays everything
+			if (reconnect)
+				throw netcode::UnpackPacketException("Relays do not support reconnecting, rejoin instead");
+
+			std::shared_ptr<netcode::UDPConnection> client = listener->AcceptConnection();
+
+			client->Unmute();
+
+			// throw at him all stuff he missed until now
+			packetCache.ForEachPacket(0, packetCache.GetNumPackets(), [&client](const unsigned char* data, unsigned int length) {
+				client->SendData(std::make_shared<const netcode::RawPacket>(data, length));
+			});
+
+			clients.push_back(client);
+
+			LOG("[RelayServer] %s joined from %s (%u spectators)", name.c_str(), client->GetFullAddress().c_str(), unsigned(clients.size()));
+		} catch (const netcode::UnpackPacketException& ex) {
+			LOG_L(L_WARNING, "[RelayServer] rejected connection from %s: %s", prev->GetFullAddress().c_str(), ex.what());
+
+			prev->Unmute();
+			prev->SendData(CBaseNetProtocol::Get().SendRejectConnect(ex.what()));
+			prev->Flush(true);
+
+			listener->RejectConnection();
+		}
+	}
+}
+
+
+void CRelayServer::UpdateClients()
+{
+	for (size_t n = 0; n < clients.size(); ) {
+		netcode::UDPConnection* client = clients[n].get();
+
+		std::shared_ptr<const netcode::RawPacket> packet;
+
+		bool quit = false;
+
+		// spectators have nothing to tell upstream; only notice them leaving
+		while ((packet = client->GetData()) != nullptr) {
+			quit |= (packet->data[0] == NETMSG_QUIT);
+		}
+
+		if (quit || client->CheckTimeout()) {
+			LOG("[RelayServer] %s %s (%u spectators)", client->GetFullAddress().c_str(), (quit? "left": "timed out"), unsigned(clients.size() - 1));
+
+			client->Close(false);
+			clients[n] = clients.back();
+			clients.pop_back();
+			continue;
+		}
+
+		client->Update();
+		n += 1;
+	}
+}
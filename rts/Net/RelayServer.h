@@ -0,0 +1,74 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _RELAY_SERVER_H
+#define _RELAY_SERVER_H
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "Net/PacketCache.h"
+#include "System/Threading/SpringThreading.h"
+
+namespace netcode
+{
+	class RawPacket;
+	class UDPConnection;
+	class UDPListener;
+}
+
+/**
+ * @brief re-serves the packet stream of a game server to spectators
+ *
+ * The relay joins its upstream server (or another relay) as one spectator and
+ * hands everything it receives, history included, to any number of downstream
+ * spectators. Those share the relay's player number and cannot send anything
+ * upstream, so the upstream host only ever sees a single connection no matter
+ * how many clients are watching through the relay (or chain of relays).
+ */
+class CRelayServer
+{
+public:
+	CRelayServer(
+		const std::string& upstreamHost,
+		unsigned int upstreamPort,
+		unsigned int listenPort,
+		const std::string& name,
+		const std::string& passwd
+	);
+	~CRelayServer();
+
+	CRelayServer(const CRelayServer&) = delete;
+	CRelayServer& operator=(const CRelayServer&) = delete;
+
+	bool HasFinished() const { return finished.load(); }
+
+private:
+	void UpdateLoop();
+
+	void ReadUpstream();
+	void HandleConnectionAttempts();
+	void UpdateClients();
+
+	void Broadcast(std::shared_ptr<const netcode::RawPacket> packet);
+
+private:
+	std::shared_ptr<netcode::UDPConnection> upstream;
+	std::unique_ptr<netcode::UDPListener> listener;
+
+	/// downstream spectators
+	std::vector< std::shared_ptr<netcode::UDPConnection> > clients;
+
+	/// everything received from upstream, replayed to each new client
+	CPacketCache packetCache;
+
+	std::atomic<bool> quitRelay;
+	std::atomic<bool> finished;
+
+	int loopSleepTime;
+
+	spring::thread* thread;
+};
+
+#endif // _RELAY_SERVER_H
@@ -15,6 +15,7 @@
 
 #include <functional>
 #include <cassert>
+#include <cstring>
 
 #if defined(_WIN32) && !defined(__MINGW32__)
 #pragma message("Adding library: vfw32.lib")
@@ -365,28 +366,61 @@ HRESULT CAVIGenerator::AddFrame(unsigned char* pixelData)
 
 bool CAVIGenerator::readOpenglPixelDataThreaded()
 {
-	while (true) {
-		std::unique_lock<spring::mutex> lock(AVIMutex);
+	if (!readbackRing.Valid())
+		readbackRing.Init(3);
 
-		if (quitAVIgen)
+	// this frame's pixels arrive a few frames later, the ring keeps them in order
+	if (readbackRing.Full() && !QueueFinishedFrames(true))
+		return false;
+
+	readbackRing.ReadPixels(0, 0, bitmapInfo.biWidth, bitmapInfo.biHeight, GL_BGR, GL_UNSIGNED_BYTE, bitmapInfo.biSizeImage);
+	return (QueueFinishedFrames(false));
+}
+
+bool CAVIGenerator::QueueFinishedFrames(bool waitFirst)
+{
+	for (bool wait = waitFirst; !readbackRing.Empty(); wait = false) {
+		const GLubyte* pixels = readbackRing.MapFinished(wait);
+
+		if (pixels == nullptr)
+			break;
+
+		const bool queued = QueueFrame(pixels);
+
+		readbackRing.PopFinished();
+
+		if (!queued)
 			return false;
+	}
 
-		if (readBuf != nullptr) {
-			imageBuffers.push_back(readBuf);
-			readBuf = nullptr;
-			AVICondition.notify_all();
-		}
+	return true;
+}
+
+bool CAVIGenerator::QueueFrame(const unsigned char* pixels)
+{
+	std::unique_lock<spring::mutex> lock(AVIMutex);
+
+	while (true) {
+		if (quitAVIgen)
+			return false;
 
-		if (freeImageBuffers.empty()) {
-			AVICondition.wait(lock);
-		} else {
-			readBuf = freeImageBuffers.front();
-			freeImageBuffers.pop_front();
+		if (!freeImageBuffers.empty())
 			break;
-		}
+
+		AVICondition.wait(lock);
 	}
 
-	glReadPixels(0, 0, bitmapInfo.biWidth, bitmapInfo.biHeight, GL_BGR, GL_UNSIGNED_BYTE, readBuf);
+	readBuf = freeImageBuffers.front();
+	freeImageBuffers.pop_front();
+
+	// the encoder only touches buffers it has been handed
+	lock.unlock();
+	std::memcpy(readBuf, pixels, bitmapInfo.biSizeImage);
+	lock.lock();
+
+	imageBuffers.push_back(readBuf);
+	readBuf = nullptr;
+	AVICondition.notify_all();
 	return true;
 }
 
@@ -5,6 +5,7 @@
 
 #ifdef WIN32
 
+#include "Rendering/GL/PixelReadback.h"
 #include "System/Threading/SpringThreading.h"
 #include "System/Misc/NonCopyable.h"
 
@@ -31,6 +32,10 @@ public:
 	bool readOpenglPixelDataThreaded();
 
 private:
+	/// hands the frames the GPU has finished reading back to the encoder
+	bool QueueFinishedFrames(bool waitFirst);
+	bool QueueFrame(const unsigned char* pixels);
+
 	bool initVFW();
 
 	HRESULT InitAVICompressionEngine();
@@ -66,6 +71,9 @@ private:
 
 	unsigned char* readBuf;
 
+	/// frames not yet read back from the GPU; any still in flight are dropped when stopping
+	GL::PixelReadbackRing readbackRing;
+
 
 	/// frame counter
 	long m_lFrame;
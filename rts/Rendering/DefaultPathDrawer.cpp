@@ -88,9 +88,9 @@ void DefaultPathDrawer::DrawInMiniMap()
 	glDisable(GL_TEXTURE_2D);
 	glColor4f(1.0f, 1.0f, 0.0f, 0.7f);
 
-	for (const int2& sb: pe->updatedBlocks) {
-		const int blockIdxX = sb.x * pe->GetBlockSize();
-		const int blockIdxY = sb.y * pe->GetBlockSize();
+	for (const auto& qb: pe->updatedBlocks) {
+		const int blockIdxX = qb.blockPos.x * pe->GetBlockSize();
+		const int blockIdxY = qb.blockPos.y * pe->GetBlockSize();
 		glRectf(blockIdxX, blockIdxY, blockIdxX + pe->GetBlockSize(), blockIdxY + pe->GetBlockSize());
 	}
 
@@ -401,15 +401,15 @@ void DefaultPathDrawer::Draw(const CPathEstimator* pe) const {
 	// compiling)
 	if (drawLowResPE || drawMedResPE) {
 		const int2 peNumBlocks = pe->GetNumBlocks();
-		const int vertexBaseNr = md->pathType * peNumBlocks.x * peNumBlocks.y * PATH_DIRECTION_VERTICES;
+		const int vertexBaseNr = md->pathLayer * peNumBlocks.x * peNumBlocks.y * PATH_DIRECTION_VERTICES;
 
 		for (int z = 0; z < peNumBlocks.y; z++) {
 			for (int x = 0; x < peNumBlocks.x; x++) {
 				const int blockNr = pe->BlockPosToIdx(int2(x, z));
 
 				float3 p1;
-					p1.x = (blockStates.peNodeOffsets[md->pathType][blockNr].x) * SQUARE_SIZE;
-					p1.z = (blockStates.peNodeOffsets[md->pathType][blockNr].y) * SQUARE_SIZE;
+					p1.x = (blockStates.peNodeOffsets[md->pathLayer][blockNr].x) * SQUARE_SIZE;
+					p1.z = (blockStates.peNodeOffsets[md->pathLayer][blockNr].y) * SQUARE_SIZE;
 					p1.y = CGround::GetHeightAboveWater(p1.x, p1.z, false) + 10.0f;
 
 				if (!camera->InView(p1))
@@ -437,8 +437,8 @@ void DefaultPathDrawer::Draw(const CPathEstimator* pe) const {
 						continue;
 
 					float3 p2;
-						p2.x = (blockStates.peNodeOffsets[md->pathType][obBlockNr].x) * SQUARE_SIZE;
-						p2.z = (blockStates.peNodeOffsets[md->pathType][obBlockNr].y) * SQUARE_SIZE;
+						p2.x = (blockStates.peNodeOffsets[md->pathLayer][obBlockNr].x) * SQUARE_SIZE;
+						p2.z = (blockStates.peNodeOffsets[md->pathLayer][obBlockNr].y) * SQUARE_SIZE;
 						p2.y = CGround::GetHeightAboveWater(p2.x, p2.z, false) + 10.0f;
 
 					rdbc->SafeAppend({p1, SColor(1.0f / std::sqrt(nrmCost), 1.0f / nrmCost, 0.75f * drawLowResPE, 1.0f)});
@@ -457,8 +457,8 @@ void DefaultPathDrawer::Draw(const CPathEstimator* pe) const {
 				const int blockNr = pe->BlockPosToIdx(int2(x, z));
 
 				float3 p1;
-					p1.x = (blockStates.peNodeOffsets[md->pathType][blockNr].x) * SQUARE_SIZE;
-					p1.z = (blockStates.peNodeOffsets[md->pathType][blockNr].y) * SQUARE_SIZE;
+					p1.x = (blockStates.peNodeOffsets[md->pathLayer][blockNr].x) * SQUARE_SIZE;
+					p1.z = (blockStates.peNodeOffsets[md->pathLayer][blockNr].y) * SQUARE_SIZE;
 					p1.y = CGround::GetHeightAboveWater(p1.x, p1.z, false) + 10.0f;
 
 				if (!camera->InView(p1))
@@ -484,8 +484,8 @@ void DefaultPathDrawer::Draw(const CPathEstimator* pe) const {
 						continue;
 
 					float3 p2;
-						p2.x = (blockStates.peNodeOffsets[md->pathType][obBlockNr].x) * SQUARE_SIZE;
-						p2.z = (blockStates.peNodeOffsets[md->pathType][obBlockNr].y) * SQUARE_SIZE;
+						p2.x = (blockStates.peNodeOffsets[md->pathLayer][obBlockNr].x) * SQUARE_SIZE;
+						p2.z = (blockStates.peNodeOffsets[md->pathLayer][obBlockNr].y) * SQUARE_SIZE;
 						p2.y = CGround::GetHeightAboveWater(p2.x, p2.z, false) + 10.0f;
 
 					// draw cost at middle of edge
@@ -524,12 +524,12 @@ void DefaultPathDrawer::Draw(const CPathEstimator* pe) const {
 				continue;
 
 			float3 p1;
-				p1.x = (blockStates.peNodeOffsets[md->pathType][blockNr].x) * SQUARE_SIZE;
-				p1.z = (blockStates.peNodeOffsets[md->pathType][blockNr].y) * SQUARE_SIZE;
+				p1.x = (blockStates.peNodeOffsets[md->pathLayer][blockNr].x) * SQUARE_SIZE;
+				p1.z = (blockStates.peNodeOffsets[md->pathLayer][blockNr].y) * SQUARE_SIZE;
 				p1.y = CGround::GetHeightAboveWater(p1.x, p1.z, false) + 15.0f;
 			float3 p2;
-				p2.x = (blockStates.peNodeOffsets[md->pathType][obBlockNr].x) * SQUARE_SIZE;
-				p2.z = (blockStates.peNodeOffsets[md->pathType][obBlockNr].y) * SQUARE_SIZE;
+				p2.x = (blockStates.peNodeOffsets[md->pathLayer][obBlockNr].x) * SQUARE_SIZE;
+				p2.z = (blockStates.peNodeOffsets[md->pathLayer][obBlockNr].y) * SQUARE_SIZE;
 				p2.y = CGround::GetHeightAboveWater(p2.x, p2.z, false) + 15.0f;
 
 			if (!camera->InView(p1) && !camera->InView(p2))
@@ -554,8 +554,8 @@ void DefaultPathDrawer::Draw(const CPathEstimator* pe) const {
 			const int blockNr = ob->nodeNum;
 
 			float3 p1;
-				p1.x = (blockStates.peNodeOffsets[md->pathType][blockNr].x) * SQUARE_SIZE;
-				p1.z = (blockStates.peNodeOffsets[md->pathType][blockNr].y) * SQUARE_SIZE;
+				p1.x = (blockStates.peNodeOffsets[md->pathLayer][blockNr].x) * SQUARE_SIZE;
+				p1.z = (blockStates.peNodeOffsets[md->pathLayer][blockNr].y) * SQUARE_SIZE;
 				p1.y = CGround::GetHeightAboveWater(p1.x, p1.z, false) + 35.0f;
 
 			if (!camera->InView(p1))
@@ -16,6 +16,9 @@
 #include "Sim/Misc/LosHandler.h"
 #include "System/GlobalRNG.h"
 #include "System/Matrix44f.h"
+#include "System/Config/ConfigHandler.h"
+
+CONFIG(bool, InstancedTreeRendering).defaultValue(false).description("Draw all visible trees of the same type with one instanced call, in both the regular and the shadow pass.");
 
 
 struct CAdvTreeSquareDrawer : public CReadMap::IQuadDrawer
@@ -66,10 +69,34 @@ CAdvTreeDrawer::CAdvTreeDrawer(): ITreeDrawer()
 	rng.SetSeed(reinterpret_cast<CGlobalUnsyncedRNG::rng_val_type>(this), true);
 
 	treeSquares.resize(nTrees);
+
+	if ((drawInstanced = configHandler->GetBool("InstancedTreeRendering"))) {
+		GLint maxTexBufferSize = 0;
+
+		glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexBufferSize);
+
+		maxInstanceMatrices = maxTexBufferSize / 4;
+
+		glGenBuffers(1, &instanceMatrixBuffer);
+		glBindBuffer(GL_TEXTURE_BUFFER, instanceMatrixBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(CMatrix44f), nullptr, GL_STREAM_DRAW);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+		glGenTextures(1, &instanceMatrixTexture);
+		glBindTexture(GL_TEXTURE_BUFFER, instanceMatrixTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, instanceMatrixBuffer);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+
+	instanceOffsets.fill(0);
+	instanceCounts.fill(0);
 }
 
 CAdvTreeDrawer::~CAdvTreeDrawer()
 {
+	glDeleteTextures(1, &instanceMatrixTexture);
+	glDeleteBuffers(1, &instanceMatrixBuffer);
+
 	shaderHandler->ReleaseProgramObjects("[TreeDrawer]");
 }
 
@@ -107,6 +134,9 @@ void CAdvTreeDrawer::LoadTreeShaders() {
 		"treeMat",             // VP, idx 13
 		"viewMat",             // VP, idx 14
 		"projMat",             // VP, idx 15
+
+		"treeMatrixTex",       // VP, idx 16
+		"instanceParams",      // VP, idx 17
 	};
 
 
@@ -142,6 +172,8 @@ void CAdvTreeDrawer::LoadTreeShaders() {
 		tp->SetUniform1i(8, 1);
 		tp->SetUniform1i(9, 0);
 		tp->SetUniform1f(12, 1.0f - (sunLighting->groundShadowDensity * 0.5f));
+		tp->SetUniform1i(16, 2);
+		tp->SetUniform2i(17, 0, 0);
 		tp->Disable();
 		tp->Validate();
 	}
@@ -239,6 +271,76 @@ void CAdvTreeDrawer::BindTreeGeometry(int treeType) const { treeGen.BindTreeBuff
 void CAdvTreeDrawer::DrawTreeGeometry(int treeType) const { treeGen.DrawTreeBuffer(treeType); }
 
 
+bool CAdvTreeDrawer::UpdateInstanceMatrices(const CCamera* cam)
+{
+	// the shadow pass (which runs first) and the regular pass both use the player camera
+	if (instanceMatricesFrame == globalRendering->drawFrame)
+		return haveInstanceMatrices;
+
+	constexpr int sqrWorldSize = SQUARE_SIZE * TREE_SQUARE_SIZE;
+
+	for (auto& matrices: typeInstanceMatrices) {
+		matrices.clear();
+	}
+
+	// same selection as the non-instanced path
+	for (const int2 idx: squareDrawer.inViewQuads) {
+		const float3 camPos  = cam->GetPos();
+		const float2 midPos = {(idx.x + 0.5f) * sqrWorldSize, (idx.y + 0.5f) * sqrWorldSize};
+		const float3 sqrPos = {midPos.x, CGround::GetHeightReal(midPos.x, midPos.y, false), midPos.y};
+
+		const float drawProb = std::min(1.0f, Square(GetDrawDistance()) / sqrPos.SqDistance(camPos));
+
+		if (drawProb <= 0.001f)
+			continue;
+
+		rng.SetSeed(rng.GetInitSeed());
+
+		for (int i = 0; i < 2; i++) {
+			const auto& treeSquare = treeSquares[(idx.y * NumTreesX()) + idx.x];
+			const auto& treeStructs = treeSquare.trees[i];
+
+			for (const ITreeDrawer::TreeStruct& ts: treeStructs) {
+				if (rng.NextFloat() > drawProb)
+					continue;
+
+				const CFeature* f = featureHandler->GetFeature(ts.id);
+
+				if (f == nullptr)
+					continue;
+				if (!f->IsInLosForAllyTeam(gu->myAllyTeam))
+					continue;
+
+				assert(ts.type >= 0 && ts.type < int(NUM_TREE_TYPES * 2));
+				typeInstanceMatrices[ts.type].push_back(ts.mat);
+			}
+		}
+	}
+
+	instanceMatrices.clear();
+
+	for (unsigned int t = 0; t < (NUM_TREE_TYPES * 2); t++) {
+		instanceOffsets[t] = instanceMatrices.size();
+		instanceCounts[t] = typeInstanceMatrices[t].size();
+
+		instanceMatrices.insert(instanceMatrices.end(), typeInstanceMatrices[t].begin(), typeInstanceMatrices[t].end());
+	}
+
+	instanceMatricesFrame = globalRendering->drawFrame;
+	haveInstanceMatrices = (instanceMatrices.size() <= maxInstanceMatrices);
+
+	if (!haveInstanceMatrices || instanceMatrices.empty())
+		return haveInstanceMatrices;
+
+	// orphan the previous frame's data so this upload does not wait on its draws
+	glBindBuffer(GL_TEXTURE_BUFFER, instanceMatrixBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, instanceMatrices.size() * sizeof(CMatrix44f), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_TEXTURE_BUFFER, 0, instanceMatrices.size() * sizeof(CMatrix44f), instanceMatrices.data());
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+	return true;
+}
+
+
 
 
 void CAdvTreeDrawer::SetupDrawState() { SetupDrawState(CCamera::GetCamera(CCamera::CAMTYPE_PLAYER), treeShaders[shadowHandler->ShadowsLoaded()]); }
@@ -347,6 +449,11 @@ void CAdvTreeDrawer::ResetShadowDrawState()
 
 void CAdvTreeDrawer::DrawTrees(const CCamera* cam, Shader::IProgramObject* ipo)
 {
+	if (drawInstanced && UpdateInstanceMatrices(cam)) {
+		DrawInstancedTrees(ipo);
+		return;
+	}
+
 	constexpr int sqrWorldSize = SQUARE_SIZE * TREE_SQUARE_SIZE;
 	const     int matUniformIdx = mix(13, 3, shadowHandler->InShadowPass());
 
@@ -382,6 +489,32 @@ void CAdvTreeDrawer::DrawTrees(const CCamera* cam, Shader::IProgramObject* ipo)
 	}
 }
 
+void CAdvTreeDrawer::DrawInstancedTrees(Shader::IProgramObject* ipo) const
+{
+	const int paramsUniformIdx = mix(17, 10, shadowHandler->InShadowPass());
+
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_BUFFER, instanceMatrixTexture);
+	glActiveTexture(GL_TEXTURE0);
+
+	for (unsigned int t = 0; t < (NUM_TREE_TYPES * 2); t++) {
+		if (instanceCounts[t] == 0)
+			continue;
+
+		BindTreeGeometry(t);
+
+		ipo->SetUniform2i(paramsUniformIdx, instanceOffsets[t], 1);
+		treeGen.DrawTreeBufferInstanced(t, instanceCounts[t]);
+	}
+
+	// falling trees and Lua-drawn trees still use treeMat
+	ipo->SetUniform2i(paramsUniformIdx, 0, 0);
+
+	glActiveTexture(GL_TEXTURE2);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+	glActiveTexture(GL_TEXTURE0);
+}
+
 void CAdvTreeDrawer::DrawFallingTrees(const CCamera* cam, Shader::IProgramObject* ipo) const
 {
 	const int matUniformIdx = mix(13, 3, shadowHandler->InShadowPass());
@@ -29,6 +29,7 @@ public:
 	void SetupShadowDrawState(const CCamera* cam, Shader::IProgramObject* ipo);
 	void ResetShadowDrawState();
 	void DrawTrees(const CCamera* cam, Shader::IProgramObject* ipo);
+	void DrawInstancedTrees(Shader::IProgramObject* ipo) const;
 	void DrawFallingTrees(const CCamera* cam, Shader::IProgramObject* ipo) const;
 
 	void Update() override;
@@ -40,6 +41,8 @@ public:
 	void BindTreeGeometry(int treeType) const;
 	void DrawTreeGeometry(int treeType) const;
 
+	bool UpdateInstanceMatrices(const CCamera* cam);
+
 	void AddFallingTree(int treeID, int treeType, const float3& pos, const float3& dir) override;
 
 	struct FallingTree {
@@ -64,12 +67,27 @@ private:
 	std::array<Shader::IProgramObject*, TREE_PROGRAM_LAST> treeShaders;
 	std::vector<FallingTree> fallingTrees[2];
 
+	// matrices of all visible trees, grouped by type; rebuilt once per
+	// draw-frame and shared by the shadow and regular passes
+	std::vector<CMatrix44f> instanceMatrices;
+	std::vector<CMatrix44f> typeInstanceMatrices[NUM_TREE_TYPES * 2];
+
+	std::array<unsigned int, NUM_TREE_TYPES * 2> instanceOffsets;
+	std::array<unsigned int, NUM_TREE_TYPES * 2> instanceCounts;
+
+	unsigned int instanceMatrixBuffer = 0;
+	unsigned int instanceMatrixTexture = 0;
+	unsigned int maxInstanceMatrices = 0;
+	unsigned int instanceMatricesFrame = -1u;
+
 	CAdvTreeGenerator treeGen;
 
 	float3 prvUpdateCamPos;
 	float3 prvUpdateCamDir;
 
 	bool updateVisibility = false;
+	bool drawInstanced = false;
+	bool haveInstanceMatrices = false;
 };
 
 #endif // _ADV_TREE_DRAWER_H_
@@ -250,6 +250,18 @@ void CAdvTreeGenerator::DrawTreeBuffer(unsigned int treeType) const {
 	glDrawArrays(primTypes[pineType], baseType * MAX_TREE_VERTS, numTreeVerts[treeType]);
 }
 
+void CAdvTreeGenerator::DrawTreeBufferInstanced(unsigned int treeType, unsigned int numInstances) const {
+	treeType = mix(treeType + NUM_TREE_TYPES, treeType - NUM_TREE_TYPES, treeType >= NUM_TREE_TYPES);
+
+	constexpr unsigned int primTypes[] = {GL_QUADS, GL_TRIANGLES};
+
+	const unsigned int pineType = (treeType >= NUM_TREE_TYPES);
+	const unsigned int baseType = treeType - (NUM_TREE_TYPES * pineType);
+
+	// per-instance transforms are fetched by the shader via gl_InstanceID
+	glDrawArraysInstanced(primTypes[pineType], baseType * MAX_TREE_VERTS, numTreeVerts[treeType], numInstances);
+}
+
 
 
 void CAdvTreeGenerator::DrawTrunk(const float3& start, const float3& end, const float3& orto1, const float3& orto2, float size)
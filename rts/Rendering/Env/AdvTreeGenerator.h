@@ -23,6 +23,7 @@ public:
 
 	void BindTreeBuffer(unsigned int treeType) const;
 	void DrawTreeBuffer(unsigned int treeType) const;
+	void DrawTreeBufferInstanced(unsigned int treeType, unsigned int numInstances) const;
 
 	unsigned int GetBushBuffer() const { return treeVBOs[0]; }
 	unsigned int GetPineBuffer() const { return treeVBOs[1]; }
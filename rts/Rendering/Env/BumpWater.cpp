@@ -43,6 +43,7 @@ using std::max;
 
 CONFIG(int, BumpWaterTexSizeReflection).defaultValue(512).headlessValue(32).minimumValue(32).description("Sets the size of the framebuffer texture used to store the reflection in Bumpmapped water.");
 CONFIG(int, BumpWaterReflection).defaultValue(1).headlessValue(0).minimumValue(0).maximumValue(2).description("Determines the amount of objects reflected in Bumpmapped water.\n0:=off, 1:=fast (skip terrain), 2:=full");
+CONFIG(int, BumpWaterReflectionMaxSkipFrames).defaultValue(2).minimumValue(0).maximumValue(15).description("Maximum number of consecutive frames Bumpmapped water reuses its reflection for while the camera is (nearly) stationary.\n0:=re-render every frame");
 CONFIG(int, BumpWaterRefraction).defaultValue(1).headlessValue(0).minimumValue(0).maximumValue(1).description("Determines the method of refraction with Bumpmapped water.\n0:=off, 1:=screencopy, 2:=own rendering cycle (disabled)");
 CONFIG(float, BumpWaterAnisotropy).defaultValue(0.0f).minimumValue(0.0f);
 CONFIG(bool, BumpWaterUseDepthTexture).defaultValue(true).headlessValue(false);
@@ -129,6 +130,7 @@ CBumpWater::CBumpWater()
 	// LOAD USER CONFIGS
 	reflTexSize  = next_power_of_2(configHandler->GetInt("BumpWaterTexSizeReflection"));
 	reflection   = configHandler->GetInt("BumpWaterReflection");
+	reflMaxSkip  = configHandler->GetInt("BumpWaterReflectionMaxSkipFrames");
 	refraction   = configHandler->GetInt("BumpWaterRefraction");
 	anisotropy   = configHandler->GetFloat("BumpWaterAnisotropy");
 	depthCopy    = configHandler->GetBool("BumpWaterUseDepthTexture");
@@ -720,9 +722,11 @@ void CBumpWater::UpdateWater(CGame* game)
 	}
 
 
+	const bool drawRefl = (reflection > 0 && !CanReuseReflection());
+
 	if (refraction > 1) DrawRefraction(game);
-	if (reflection > 0) DrawReflection(game);
-	if (reflection || refraction) {
+	if (drawRefl) DrawReflection(game);
+	if (drawRefl || refraction > 1) {
 		FBO::Unbind();
 		glViewport(globalRendering->viewPosX, 0, globalRendering->viewSizeX, globalRendering->viewSizeY);
 	}
@@ -1172,6 +1176,29 @@ void CBumpWater::DrawRefraction(CGame* game)
 }
 
 
+bool CBumpWater::CanReuseReflection()
+{
+	const float3& camPos = camera->GetPos();
+	const float3& camDir = camera->GetDir();
+
+	// the reflected scene still changes (units, projectiles, sky) while the
+	// camera is at rest, so a reused texture is never more than a few frames
+	// stale; any noticeable camera motion forces a redraw immediately
+	const bool camMoved = (camPos.SqDistance(reflCamPos) > 1.0f || camDir.dot(reflCamDir) < 0.99995f || camera->GetVFOV() != reflCamFOV);
+
+	if (!camMoved && numReusedReflFrames < reflMaxSkip) {
+		numReusedReflFrames++;
+		return true;
+	}
+
+	numReusedReflFrames = 0;
+
+	reflCamPos = camPos;
+	reflCamDir = camDir;
+	reflCamFOV = camera->GetVFOV();
+	return false;
+}
+
 void CBumpWater::DrawReflection(CGame* game)
 {
 	reflectFBO.Bind();
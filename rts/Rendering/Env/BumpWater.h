@@ -71,11 +71,15 @@ private:
 	void UpdateDynWaves(const bool initialize = false);
 	void UnsyncedHeightMapUpdate(const SRectangle& rect);
 
+	/// true if the reflection from an earlier frame can be shown again
+	bool CanReuseReflection();
+
 private:
 	//! user options
 	char  reflection;   ///< 0:=off, 1:=don't render the terrain, 2:=render everything+terrain
 	char  refraction;   ///< 0:=off, 1:=screencopy, 2:=own rendering cycle
 	int   reflTexSize;
+	int   reflMaxSkip;  ///< max. number of consecutive frames the reflection is not re-rendered if the camera is at rest
 	bool  depthCopy;    ///< uses a screen depth copy, which allows a nicer interpolation between deep sea and shallow water
 	float anisotropy;
 	char  depthBits;    ///< depthBits for reflection/refraction RBO
@@ -120,6 +124,11 @@ private:
 
 	GLuint uniforms[20]; ///< see useUniforms
 
+	int numReusedReflFrames = 0;
+	float3 reflCamPos;  ///< camera state the reflection was last rendered with
+	float3 reflCamDir;
+	float  reflCamFOV = 0.0f;
+
 	bool wasVisibleLastFrame;
 	GLuint occlusionQuery;
 	GLuint occlusionQueryResult;
@@ -12,6 +12,7 @@
 #include "Rendering/Env/SunLighting.h"
 #include "Rendering/Env/CubeMapHandler.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/Threading/ThreadPool.h"
 
 CONFIG(int, CubeTexSizeSpecular).defaultValue(128).minimumValue(1);
 CONFIG(int, CubeTexSizeReflection).defaultValue(128).minimumValue(1);
@@ -28,6 +29,7 @@ CubeMapHandler::CubeMapHandler() {
 
 	currReflectionFace = 0;
 	specularTexIter = 0;
+	specularTexUpdates = 0;
 	mapSkyReflections = false;
 }
 
@@ -246,8 +248,19 @@ void CubeMapHandler::CreateReflectionFace(unsigned int glType, const float3& cam
 }
 
 
-void CubeMapHandler::UpdateSpecularTexture()
+void CubeMapHandler::UpdateSpecularTexture(bool lightChanged)
 {
+	// the texture only depends on the sun; once it changes, keep going
+	// until every row was regenerated (one full round-robin pass) since
+	// the last change and then stop until it changes again
+	if (lightChanged)
+		specularTexUpdates = specTexSize * 3;
+
+	if (specularTexUpdates == 0)
+		return;
+
+	specularTexUpdates -= 1;
+
 	glBindTexture(GL_TEXTURE_CUBE_MAP, specularTexID);
 
 	int specularTexRow = specularTexIter / 3; //FIXME WTF
@@ -306,9 +319,10 @@ void CubeMapHandler::CreateSpecularFace(
 {
 	std::vector<unsigned char> buf(size * size * 4, 0);
 
-	for (int y = 0; y < size; ++y) {
+	// rows are independent
+	for_mt(0, size, [&](const int y) {
 		CreateSpecularFacePart(texType, size, cdir, xdif, ydif, y, &buf[y * size * 4]);
-	}
+	});
 
 	//! note: no mipmaps, cubemap linear filtering is broken
 	glTexImage2D(texType, 0, GL_RGBA8, size, size, 0, GL_RGBA, GL_UNSIGNED_BYTE, &buf[0]);
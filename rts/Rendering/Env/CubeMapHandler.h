@@ -13,7 +13,7 @@ public:
 	void Free();
 
 	void UpdateReflectionTexture();
-	void UpdateSpecularTexture();
+	void UpdateSpecularTexture(bool lightChanged);
 
 	unsigned int GetEnvReflectionTextureID() const { return envReflectionTexID; }
 	unsigned int GetSkyReflectionTextureID() const { return skyReflectionTexID; }
@@ -36,6 +36,7 @@ private:
 
 	unsigned int currReflectionFace;
 	unsigned int specularTexIter;
+	unsigned int specularTexUpdates; // remaining iterations until the texture matches the sun again
 	bool mapSkyReflections;
 
 	std::vector<unsigned char> specTexBuf;
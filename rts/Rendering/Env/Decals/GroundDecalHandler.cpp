@@ -54,6 +54,10 @@ static std::vector<uint8_t> scarTexBuf;
 static std::vector<int> freeScarIDs;
 static std::vector<int> usedScarIDs;
 
+// vertex ranges of visible scars, submitted in one batch
+static std::vector<int32_t> scarDrawIndcs;
+static std::vector<int32_t> scarDrawSizes;
+
 
 
 float NewScarAlphaDecay(const CGroundDecalHandler::Scar& s, int f) { return (Clamp(s.startAlpha * (f - s.creationTime) *         0.1f, 0.0f, 255.0f) / 255.0f); }
@@ -72,6 +76,7 @@ CGroundDecalHandler::CGroundDecalHandler(): CEventClient("[CGroundDecalHandler]"
 		return;
 
 	eventHandler.AddClient(this);
+	eventHandler.GetUnitsMovedChannel().Subscribe(this, &UnitsMoved, [](const CUnit* const& unit) { return unit->unitDef->decalDef.useGroundDecal; });
 	CExplosionCreator::AddExplosionListener(this);
 
 	sogdMemPool.clear();
@@ -80,6 +85,10 @@ CGroundDecalHandler::CGroundDecalHandler(): CEventClient("[CGroundDecalHandler]"
 	freeScarIDs.reserve(MAX_NUM_DECALS);
 	usedScarIDs.clear();
 	usedScarIDs.reserve(128);
+	scarDrawIndcs.clear();
+	scarDrawIndcs.reserve(128);
+	scarDrawSizes.clear();
+	scarDrawSizes.reserve(128);
 	scarTexBuf.clear();
 	scarTexBuf.resize(512 * 512 * 4, 0); // 1MB
 
@@ -107,6 +116,7 @@ CGroundDecalHandler::CGroundDecalHandler(): CEventClient("[CGroundDecalHandler]"
 CGroundDecalHandler::~CGroundDecalHandler()
 {
 	eventHandler.RemoveClient(this);
+	eventHandler.GetUnitsMovedChannel().Unsubscribe(this);
 
 	for (SolidObjectDecalType& dctype: objectDecalTypes) {
 		for (SolidObjectGroundDecal*& dc: dctype.objectDecals) {
@@ -465,10 +475,18 @@ inline void CGroundDecalHandler::DrawGroundScar(CGroundDecalHandler::Scar& scar)
 		return;
 	}
 
-	if (groundScarAlphaFade && simFrame != scar.lastUpdateFrame) {
-		// update scars only every *sim*frame, faster is pointless
-		// scars younger than 10 simframes decay at different rate
-		scar.fadedAlpha = scarAlphaDecayFuncs[ (scar.creationTime + 10) <= simFrame ](scar, scar.lastUpdateFrame = simFrame);
+	// the faded alpha is stored in the vertex colors so all scars can be
+	// drawn in a single batch; since only one of the two buffers can be
+	// written per frame, each update is repeated on the next draw-frame
+	if (groundScarAlphaFade && (simFrame != scar.lastUpdateFrame || visFrame == (scar.lastWriteFrame + 1))) {
+		if (simFrame != scar.lastUpdateFrame) {
+			// update scars only every *sim*frame, faster is pointless
+			// scars younger than 10 simframes decay at different rate
+			scar.fadedAlpha = scarAlphaDecayFuncs[ (scar.creationTime + 10) <= simFrame ](scar, scar.lastUpdateFrame = simFrame);
+			scar.lastWriteFrame = visFrame;
+		}
+
+		const uint8_t alpha = scar.fadedAlpha * 255.0f;
 
 		decalVertices[0] = mapBufferPtr[    (visFrame & 1)] + decalIdx; // write
 		decalVertices[1] = mapBufferPtr[1 - (visFrame & 1)] + decalIdx; // read
@@ -478,12 +496,12 @@ inline void CGroundDecalHandler::DrawGroundScar(CGroundDecalHandler::Scar& scar)
 			const int z = int(decalVertices[1][i].p.z) >> 3;
 
 			decalVertices[0][i].p.y = cornerHeights[z * mapWidth + x];
+			decalVertices[0][i].c.a = alpha;
 		}
 	}
 
-	decalShaders[DECAL_SHADER_CURR]->SetUniform1f(11, scar.fadedAlpha);
-	decalShaders[DECAL_SHADER_CURR]->SetUniformMatrix4fv(7, false, CMatrix44f::Identity());
-	decalBuffers[1 - (visFrame & 1)].Submit(GL_QUADS, decalIdx, numVerts);
+	scarDrawIndcs.push_back(decalIdx);
+	scarDrawSizes.push_back(numVerts);
 	#endif
 }
 
@@ -606,7 +624,10 @@ void CGroundDecalHandler::AddScars()
 }
 
 void CGroundDecalHandler::DrawScars() {
-	// create and draw the 16x16 quads for each ground scar
+	scarDrawIndcs.clear();
+	scarDrawSizes.clear();
+
+	// create and gather the 16x16 quads for each ground scar
 	for (size_t i = 0; i < usedScarIDs.size(); ) {
 		Scar& scar = scars[ usedScarIDs[i] ];
 
@@ -621,6 +642,15 @@ void CGroundDecalHandler::DrawScars() {
 
 		i++;
 	}
+
+	if (scarDrawIndcs.empty())
+		return;
+
+	#ifndef HEADLESS
+	decalShaders[DECAL_SHADER_CURR]->SetUniform1f(11, 1.0f);
+	decalShaders[DECAL_SHADER_CURR]->SetUniformMatrix4fv(7, false, CMatrix44f::Identity());
+	decalBuffers[1 - (globalRendering->drawFrame & 1)].SubmitMulti(GL_QUADS, scarDrawIndcs.data(), scarDrawSizes.data(), scarDrawIndcs.size());
+	#endif
 }
 
 
@@ -734,10 +764,14 @@ void CGroundDecalHandler::AddExplosion(float3 pos, float damage, float radius)
 	if (damage > 400.0f)
 		damage = 400.0f + std::sqrt(damage - 399.0f);
 
+	// decal limit reached, make room
+	if (freeScarIDs.empty())
+		EvictScar();
+
 	const int id = GetScarID();
 	const int ttl = std::max(1.0f, decalLevel * damage * 3.0f);
 
-	// decal limit reached
+	// all slots are taken by scars added this frame
 	if (id == -1)
 		return;
 
@@ -886,6 +920,20 @@ void CGroundDecalHandler::RemoveScar(Scar& scar)
 	scar = Scar();
 }
 
+void CGroundDecalHandler::EvictScar()
+{
+	if (usedScarIDs.empty())
+		return;
+
+	// evict the scar that would have expired first, which for equal
+	// lifetimes is also the oldest; keeps the pool at a fixed capacity
+	// instead of refusing new scars during long games
+	const auto pred = [](int a, int b) { return (scars[a].lifeTime < scars[b].lifeTime); };
+	const auto iter = std::min_element(usedScarIDs.begin(), usedScarIDs.end(), pred);
+
+	RemoveScar(scars[*iter]);
+}
+
 int CGroundDecalHandler::GetSolidObjectDecalType(const std::string& name)
 {
 	if (!GetDrawDecals())
@@ -1016,7 +1064,13 @@ void CGroundDecalHandler::ForceRemoveSolidObject(CSolidObject* object)
 
 
 
-void CGroundDecalHandler::UnitMoved(const CUnit* unit) { AddDecal(const_cast<CUnit*>(unit), unit->pos); }
+void CGroundDecalHandler::UnitsMoved(void* self, const CUnit* const* units, size_t count) {
+	CGroundDecalHandler* handler = static_cast<CGroundDecalHandler*>(self);
+
+	for (size_t i = 0; i < count; i++) {
+		handler->AddDecal(const_cast<CUnit*>(units[i]), units[i]->pos);
+	}
+}
 
 void CGroundDecalHandler::GhostDestroyed(GhostSolidObject* gb) {
 	if (gb->decal == nullptr)
@@ -113,7 +113,6 @@ public:
 			(eventName == "SunChanged") ||
 			(eventName == "RenderUnitCreated") ||
 			(eventName == "RenderUnitDestroyed") ||
-			(eventName == "UnitMoved") ||
 			(eventName == "RenderFeatureCreated") ||
 			(eventName == "RenderFeatureDestroyed") ||
 			(eventName == "FeatureMoved") ||
@@ -129,10 +128,11 @@ public:
 	void RenderFeatureCreated(const CFeature* feature) override;
 	void RenderFeatureDestroyed(const CFeature* feature) override;
 	void FeatureMoved(const CFeature* feature, const float3& oldpos) override;
-	void UnitMoved(const CUnit* unit) override;
 	void UnitLoaded(const CUnit* unit, const CUnit* transport) override;
 	void UnitUnloaded(const CUnit* unit, const CUnit* transport) override;
 
+	static void UnitsMoved(void* self, const CUnit* const* units, size_t count);
+
 	// IExplosionListener
 	void ExplosionOccurred(const CExplosionParams& event) override;
 
@@ -167,6 +167,7 @@ public:
 
 			lastOverlapTest = s.lastOverlapTest;
 			lastUpdateFrame = s.lastUpdateFrame;
+			lastWriteFrame  = s.lastWriteFrame;
 
 			pos = s.pos;
 
@@ -191,6 +192,7 @@ public:
 
 		unsigned int lastOverlapTest = 0;
 		unsigned int lastUpdateFrame = 0;
+		unsigned int lastWriteFrame  = 0;
 
 		int x1 = 0, x2 = 0;
 		int y1 = 0, y2 = 0;
@@ -231,6 +233,7 @@ private:
 	int ScarOverlapSize(const Scar& s1, const Scar& s2);
 	void TestScarOverlaps(const Scar& scar);
 	void RemoveScar(Scar& scar);
+	void EvictScar();
 	void LoadScarTexture(const std::string& file, uint8_t* buf, int xoffset, int yoffset);
 
 private:
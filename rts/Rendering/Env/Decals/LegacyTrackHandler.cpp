@@ -34,6 +34,7 @@ LegacyTrackHandler::LegacyTrackHandler()
 	: CEventClient("[LegacyTrackHandler]", 314160, false)
 {
 	eventHandler.AddClient(this);
+	eventHandler.GetUnitsMovedChannel().Subscribe(this, &UnitsMoved, [](const CUnit* const& unit) { return unit->leaveTracks; });
 	LoadDecalShaders();
 }
 
@@ -42,6 +43,7 @@ LegacyTrackHandler::LegacyTrackHandler()
 LegacyTrackHandler::~LegacyTrackHandler()
 {
 	eventHandler.RemoveClient(this);
+	eventHandler.GetUnitsMovedChannel().Unsubscribe(this);
 
 	for (TrackType& tt: trackTypes) {
 		for (UnitTrackStruct* uts: tt.tracks)
@@ -504,9 +506,17 @@ void LegacyTrackHandler::RemoveTrack(CUnit* unit)
 }
 
 
-void LegacyTrackHandler::UnitMoved(const CUnit* unit)
+void LegacyTrackHandler::UnitsMoved(void* self, const CUnit* const* units, size_t count)
 {
-	AddTrack(const_cast<CUnit*>(unit), unit->pos);
+	// tracks would mostly have faded by the time the client caught up
+	if (gu->fastForwarding)
+		return;
+
+	LegacyTrackHandler* handler = static_cast<LegacyTrackHandler*>(self);
+
+	for (size_t i = 0; i < count; i++) {
+		handler->AddTrack(const_cast<CUnit*>(units[i]), units[i]->pos);
+	}
 }
 
 
@@ -84,15 +84,15 @@ public:
 	bool WantsEvent(const std::string& eventName) {
 		return
 			(eventName == "SunChanged") ||
-			(eventName == "RenderUnitDestroyed") ||
-			(eventName == "UnitMoved");
+			(eventName == "RenderUnitDestroyed");
 	}
 	bool GetFullRead() const { return true; }
 	int GetReadAllyTeam() const { return AllAccessTeam; }
 
 	void SunChanged();
 	void RenderUnitDestroyed(const CUnit*);
-	void UnitMoved(const CUnit* unit);
+
+	static void UnitsMoved(void* self, const CUnit* const* units, size_t count);
 
 private:
 	bool GetDrawTracks() const;
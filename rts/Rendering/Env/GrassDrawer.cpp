@@ -25,6 +25,7 @@
 #include "System/Color.h"
 #include "System/Exceptions.h"
 #include "System/StringUtil.h"
+#include "System/UnorderedMap.hpp"
 #include "System/Threading/ThreadPool.h"
 #include "System/TimeProfiler.h"
 #include "System/Log/ILog.h"
@@ -67,10 +68,29 @@ static constexpr int   blockMapSize    = grassSquareSize * grassBlockSize;
 static constexpr int   GSSSQ = SQUARE_SIZE * grassSquareSize;
 static constexpr int   BMSSQ = SQUARE_SIZE * blockMapSize;
 
+static constexpr int   maxSquareTurfs  = 4;                // upper bound on turfDetail.x
+static constexpr int   turfCacheMaxAge = 60;             // draw-frames before an unseen square is evicted
+
 static GrassRNG drawRNG;
 static GrassRNG turfRNG;
 
+// turf placements only depend on the square's seed and the terrain
+// under it, so they are generated once per grass square and reused
+// until the heightmap changes; turfs are kept sorted by their random
+// draw-threshold such that the subset passing the distance-dependent
+// density test is always a prefix
+struct GrassSquareTurfs {
+	std::array<CMatrix44f, maxSquareTurfs> matrices;
+	std::array<float, maxSquareTurfs> thresholds;
+
+	float midHeight;
+
+	int numTurfs;
+	int lastDrawFrame;
+};
+
 static std::array<CMatrix44f, 128> turfMatrices;
+static spring::unordered_map<int, GrassSquareTurfs> turfCache;
 
 static CGrassBlockDrawer blockDrawer;
 
@@ -151,6 +171,7 @@ CGrassDrawer::~CGrassDrawer()
 	glDeleteTextures(1, &grassBladeTex);
 
 	grassBuffer.Kill();
+	turfCache.clear();
 	shaderHandler->ReleaseProgramObjects("[GrassDrawer]");
 }
 
@@ -166,12 +187,13 @@ void CGrassDrawer::ChangeDetail(int detail) {
 	grassDrawDist = std::sqrt(detail * 1.0f) * 100.0f;
 
 	// turfs per block
-	turfDetail.x = std::min(3 + int(minDetail * 0.5f), int(turfMatrices.size()));
+	turfDetail.x = std::min(3 + int(minDetail * 0.5f), maxSquareTurfs);
 	// straws per turf
 	turfDetail.y = std::min(50 + int(std::sqrt(minDetail * 1.0f) * 10), mapInfo->grass.maxStrawsPerTurf);
 
 	// recreate turf geometry
 	CreateGrassBuffer();
+	turfCache.clear();
 }
 
 void CGrassDrawer::ConfigNotify(const std::string& key, const std::string& value) {
@@ -385,45 +407,79 @@ static float3 GetRandomTurfParams(const int2& blockPos)
 	return p;
 }
 
-static float GetGrassBlockCamDistSq(const float3& pos, const int2 coors)
+static float GetGrassBlockCamDistSq(const float3& pos, const int2 coors, float height)
 {
 	const float qx = coors.x * GSSSQ;
 	const float qz = coors.y * GSSSQ;
 
-	const float3 mid = {qx, CGround::GetHeightReal(qx, qz, false), qz};
+	const float3 mid = {qx, height, qz};
 	const float3 dif = pos - mid;
 
 	return (dif.SqLength());
 }
 
+static GrassSquareTurfs& GetGrassSquareTurfs(const int2& blockPos, int numTurfs)
+{
+	const int squareIdx = blockPos.y * (mapDims.mapx / grassSquareSize) + blockPos.x;
+	const auto iter = turfCache.find(squareIdx);
+
+	if (iter != turfCache.end())
+		return iter->second;
+
+	GrassSquareTurfs& turfs = turfCache[squareIdx];
+
+	turfs.midHeight = CGround::GetHeightReal(blockPos.x * GSSSQ, blockPos.y * GSSSQ, false);
+	turfs.numTurfs = numTurfs;
+	turfs.lastDrawFrame = globalRendering->drawFrame;
+
+	drawRNG.Seed(squareIdx);
+	turfRNG.Seed(squareIdx);
+
+	for (int a = 0; a < numTurfs; a++) {
+		const float   thr = drawRNG.NextFloat();
+		const float3& rtp = GetRandomTurfParams(blockPos);
+		const float3  pos = {rtp.x, CGround::GetHeightReal(rtp.x, rtp.y, false) - CGround::GetSlope(rtp.x, rtp.y, false) * 30.0f, rtp.y};
+
+		// insertion-sort by threshold
+		int b = a;
+
+		for (; b > 0 && turfs.thresholds[b - 1] > thr; b--) {
+			turfs.thresholds[b] = turfs.thresholds[b - 1];
+			turfs.matrices[b] = turfs.matrices[b - 1];
+		}
+
+		turfs.thresholds[b] = thr;
+		turfs.matrices[b].LoadIdentity();
+		turfs.matrices[b].Translate(pos);
+		turfs.matrices[b].RotateY(-rtp.z);
+	}
+
+	return turfs;
+}
+
 
 
 unsigned int CGrassDrawer::DrawBlock(const float3& camPos, const int2& blockPos, unsigned int turfMatIndex)
 {
-	const float blockDist = GetGrassBlockCamDistSq(camPos, blockPos);
+	GrassSquareTurfs& turfs = GetGrassSquareTurfs(blockPos, turfDetail.x);
+
+	const float blockDist = GetGrassBlockCamDistSq(camPos, blockPos, turfs.midHeight);
 	const float drawProb = std::min(1.0f, Square(grassDrawDist) / blockDist);
 
+	// keep the square alive while it is in view, even if fully thinned out
+	turfs.lastDrawFrame = globalRendering->drawFrame;
+
 	if (drawProb < 0.001f)
 		return 0;
 
-	drawRNG.Seed(blockPos.y * (mapDims.mapx / grassSquareSize) + blockPos.x);
-	turfRNG.Seed(blockPos.y * (mapDims.mapx / grassSquareSize) + blockPos.x);
-
 	unsigned int numVisibleTurfs = 0;
 
 	// TODO: LODs?
-	for (int a = 0; a < turfDetail.x; a++) {
-		if (drawRNG.NextFloat() > drawProb)
-			continue;
-
-		const float3& rtp = GetRandomTurfParams(blockPos);
-		const float3  pos = {rtp.x, CGround::GetHeightReal(rtp.x, rtp.y, false) - CGround::GetSlope(rtp.x, rtp.y, false) * 30.0f, rtp.y};
-
-		turfMatrices[turfMatIndex + numVisibleTurfs].LoadIdentity();
-		turfMatrices[turfMatIndex + numVisibleTurfs].Translate(pos);
-		turfMatrices[turfMatIndex + numVisibleTurfs].RotateY(-rtp.z);
+	for (; numVisibleTurfs < unsigned(turfs.numTurfs); numVisibleTurfs++) {
+		if (turfs.thresholds[numVisibleTurfs] > drawProb)
+			break;
 
-		numVisibleTurfs += 1;
+		turfMatrices[turfMatIndex + numVisibleTurfs] = turfs.matrices[numVisibleTurfs];
 	}
 
 	return numVisibleTurfs;
@@ -481,11 +537,43 @@ void CGrassDrawer::Update()
 		blockDrawer.ResetState();
 		readMap->GridVisibility(nullptr, &blockDrawer, grassDrawDist * grassDrawDist, blockMapSize);
 
+		// drop squares that have not been in view for a while
+		for (auto it = turfCache.begin(); it != turfCache.end(); ) {
+			if ((globalRendering->drawFrame - it->second.lastDrawFrame) > turfCacheMaxAge) {
+				it = turfCache.erase(it);
+			} else {
+				++it;
+			}
+		}
+
 		updateVisibility = false;
 	}
 }
 
 
+void CGrassDrawer::UnsyncedHeightMapUpdate(const SRectangle& rect)
+{
+	if (turfCache.empty())
+		return;
+
+	// turfs sample height and slope anywhere inside their square, and
+	// slope also depends on the neighbouring heightmap vertices
+	const int maxSqrX = mapDims.mapx / grassSquareSize - 1;
+	const int maxSqrZ = mapDims.mapy / grassSquareSize - 1;
+
+	const int x1 = Clamp((rect.x1 - 1) / grassSquareSize, 0, maxSqrX);
+	const int z1 = Clamp((rect.z1 - 1) / grassSquareSize, 0, maxSqrZ);
+	const int x2 = Clamp((rect.x2 + 1) / grassSquareSize, 0, maxSqrX);
+	const int z2 = Clamp((rect.z2 + 1) / grassSquareSize, 0, maxSqrZ);
+
+	for (int z = z1; z <= z2; z++) {
+		for (int x = x1; x <= x2; x++) {
+			turfCache.erase(z * (mapDims.mapx / grassSquareSize) + x);
+		}
+	}
+}
+
+
 
 void CGrassDrawer::SetupStateShadow()
 {
@@ -50,7 +50,7 @@ public:
 
 public:
 	// EventClient
-	void UnsyncedHeightMapUpdate(const SRectangle& rect) override {}
+	void UnsyncedHeightMapUpdate(const SRectangle& rect) override;
 	void Update() override;
 
 protected:
@@ -45,6 +45,7 @@ FlyingPiece::FlyingPiece(
 	const auto& shatterPieceData = shatterPiecePart.renderData;
 
 	splitterParts.reserve(shatterPieceData.size());
+	splitterSpeeds.reserve(shatterPieceData.size());
 
 	for (const auto& cp: shatterPieceData) {
 		if (guRNG.NextFloat() > _pieceParams.x)
@@ -53,8 +54,8 @@ FlyingPiece::FlyingPiece(
 		const float3 rndVec = guRNG.NextVector() * 0.3f;
 		const float3 flyDir = (cp.dir + rndVec).ANormalize();
 
+		splitterSpeeds.push_back(speed + flyDir * mix<float>(1.0f, EXPLOSION_SPEED, guRNG.NextFloat()));
 		splitterParts.emplace_back();
-		splitterParts.back().speed                = speed + flyDir * mix<float>(1.0f, EXPLOSION_SPEED, guRNG.NextFloat());
 		splitterParts.back().rotationAxisAndSpeed = float4(guRNG.NextVector().ANormalize(), guRNG.NextFloat() * 0.1f);
 		splitterParts.back().indexCount           = cp.indexCount;
 		splitterParts.back().vboOffset            = cp.vboOffset;
@@ -88,13 +89,14 @@ bool FlyingPiece::Update()
 	pos        = pos0 + (speed * dragFactors.x) + UpVector * (mapInfo->map.gravity * dragFactors.y);
 	drawRadius = pieceRadius + EXPLOSION_SPEED * dragFactors.x + 10.f;
 
-	// check visibility (if all particles are underground -> kill)
-	if ((age % GAME_SPEED) == 0)
+	// check visibility (if all particles are underground -> kill), once per second
+	if ((age % GAME_SPEED) != 0)
 		return true;
 
-	for (const SplitterData& sp: splitterParts) {
-		const CMatrix44f& m = GetMatrix(sp, dragFactors);
-		const float3 p = m.GetPos();
+	// rotation does not affect the translation, so the part positions
+	// follow from their speeds alone without building full matrices
+	for (const float3& partSpeed: splitterSpeeds) {
+		const float3 p = pieceMatrix.GetPos() + GetOffset(partSpeed, dragFactors);
 
 		if ((p.y + pieceRadius * 2.0f) >= CGround::GetApproximateHeight(p.x, p.z, false))
 			return true;
@@ -168,13 +170,17 @@ float3 FlyingPiece::GetDragFactors() const
 }
 
 
-CMatrix44f FlyingPiece::GetMatrix(const SplitterData& cp, const float3 dragFactors) const
+float3 FlyingPiece::GetOffset(const float3& partSpeed, const float3 dragFactors) const
 {
-	const float3 interPos = cp.speed * dragFactors.x + UpVector * mapInfo->map.gravity * dragFactors.y;
-	const float4& rot = cp.rotationAxisAndSpeed;
+	return (partSpeed * dragFactors.x + UpVector * mapInfo->map.gravity * dragFactors.y);
+}
+
+CMatrix44f FlyingPiece::GetMatrix(size_t partIdx, const float3 dragFactors) const
+{
+	const float4& rot = splitterParts[partIdx].rotationAxisAndSpeed;
 
 	CMatrix44f m = pieceMatrix;
-	m.GetPos() += interPos; //note: not the same as .Translate(pos) which does `m = m * translate(pos)`, but we want `m = translate(pos) * m`
+	m.GetPos() += GetOffset(splitterSpeeds[partIdx], dragFactors); //note: not the same as .Translate(pos) which does `m = m * translate(pos)`, but we want `m = translate(pos) * m`
 	m.Rotate(rot.w * dragFactors.z, rot.xyz);
 
 	return m;
@@ -238,8 +244,10 @@ void FlyingPiece::Draw(const FlyingPiece* prev) const
 	// set piece-matrices only once; shared by all parts
 	udState->SetMatrices(CMatrix44f::Identity(), pieceMatrices);
 
-	for (const SplitterData& sp: splitterParts) {
-		udState->SetMatrices(GetMatrix(sp, dragFactors), {});
+	for (size_t i = 0; i < splitterParts.size(); i++) {
+		const SplitterData& sp = splitterParts[i];
+
+		udState->SetMatrices(GetMatrix(i, dragFactors), {});
 
 		glDrawElements(GL_TRIANGLES, sp.indexCount, GL_UNSIGNED_INT, shatterIndices.GetPtr(sp.vboOffset));
 	}
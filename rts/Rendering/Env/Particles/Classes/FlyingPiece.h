@@ -48,8 +48,8 @@ public:
 	}
 
 private:
+	// speeds are kept apart (SoA) since Update only needs those
 	struct SplitterData {
-		float3 speed;
 		float4 rotationAxisAndSpeed;
 		size_t vboOffset;
 		size_t indexCount;
@@ -59,7 +59,8 @@ private:
 	inline void InitCommon(const float3 _pos, const float3 _speed, const float _radius, int _team, int _texture);
 	void CheckDrawStateChange(const FlyingPiece* prev) const;
 	float3 GetDragFactors() const;
-	CMatrix44f GetMatrix(const SplitterData& cp, const float3 dragFactors) const;
+	float3 GetOffset(const float3& partSpeed, const float3 dragFactors) const;
+	CMatrix44f GetMatrix(size_t partIdx, const float3 dragFactors) const;
 
 private:
 	float3 pos0;
@@ -79,6 +80,7 @@ private:
 	const S3DModelPiece* piece;
 
 	std::vector<SplitterData> splitterParts;
+	std::vector<float3> splitterSpeeds;
 };
 
 #endif // FLYING_PIECE_H
@@ -38,8 +38,11 @@ CR_REG_METADATA(CSimpleParticleSystem,
 		CR_MEMBER(directional),
 		CR_MEMBER(sizeGrowth),
 		CR_MEMBER(sizeMod),
+		CR_MEMBER(closedForm),
 	CR_MEMBER_ENDFLAG(CM_Config),
-	CR_MEMBER(particles)
+	CR_MEMBER(particles),
+	CR_MEMBER(age),
+	CR_MEMBER(minDecayRate)
 ))
 
 CR_BIND(CSimpleParticleSystem::Particle, )
@@ -75,16 +78,63 @@ CSimpleParticleSystem::CSimpleParticleSystem()
 	, sizeGrowth(0.0f)
 	, sizeMod(0.0f)
 	, numParticles(0)
+	, closedForm(false)
+	, age(0)
+	, minDecayRate(1.0f)
 {
 	checkCol = false;
 	useAirLos = true;
 }
 
+CSimpleParticleSystem::ParticleMotion CSimpleParticleSystem::CalcParticleMotion() const
+{
+	// Update applies pos += speed, speed = (speed + gravity) * airdrag and
+	// size = size * sizeMod + sizeGrowth per frame; after n frames this is
+	//   speed(n) = speed(0) * a^n + gravity * a * G(n)
+	//     pos(n) =   pos(0) + speed(0) * G(n) + gravity * a * (G(0) + ... + G(n-1))
+	//    size(n) =  size(0) * m^n + sizeGrowth * H(n)
+	// with G(n) = 1 + a + ... + a^(n-1) and H(n) the same series for m
+	const auto GeomSum = [](float r, float rn, int n) { return ((std::fabs(1.0f - r) > 1e-4f)? ((1.0f - rn) / (1.0f - r)): (n * 1.0f)); };
+
+	const float an = std::pow(airdrag, age * 1.0f);
+	const float mn = std::pow(sizeMod, age * 1.0f);
+	const float ga = GeomSum(airdrag, an, age);
+	const float gm = GeomSum(sizeMod, mn, age);
+	const float gs = (std::fabs(1.0f - airdrag) > 1e-4f)? ((age - ga) / (1.0f - airdrag)): (age * (age - 1) * 0.5f);
+
+	ParticleMotion m;
+	m.speedMul = an;
+	m.posSpeedMul = ga;
+	m.sizeMul = mn;
+	m.sizeAdd = sizeGrowth * gm;
+	m.speedAdd = gravity * (airdrag * ga);
+	m.posAdd = gravity * (airdrag * gs);
+	return m;
+}
+
+CSimpleParticleSystem::Particle CSimpleParticleSystem::GetParticle(const Particle& p, const ParticleMotion& m) const
+{
+	if (!closedForm)
+		return p;
+
+	// particles keep their spawn-state, see CalcParticleMotion
+	Particle q = p;
+	q.pos   = p.pos + p.speed * m.posSpeedMul + m.posAdd;
+	q.speed = p.speed * m.speedMul + m.speedAdd;
+	q.life  = p.decayrate * age;
+	q.size  = p.size * m.sizeMul + m.sizeAdd;
+	return q;
+}
+
+
 void CSimpleParticleSystem::Draw(GL::RenderDataBufferTC* va) const
 {
+	const ParticleMotion motion = closedForm? CalcParticleMotion(): ParticleMotion();
+
 	if (directional) {
 		for (int i = 0; i < numParticles; i++) {
-			const Particle* p = &particles[i];
+			const Particle q = GetParticle(particles[i], motion);
+			const Particle* p = &q;
 
 			if (p->life >= 1.0f)
 				continue;
@@ -114,7 +164,8 @@ void CSimpleParticleSystem::Draw(GL::RenderDataBufferTC* va) const
 		}
 	} else {
 		for (int i = 0; i < numParticles; i++) {
-			const Particle* p = &particles[i];
+			const Particle q = GetParticle(particles[i], motion);
+			const Particle* p = &q;
 
 			if (p->life >= 1.0f)
 				continue;
@@ -136,6 +187,13 @@ void CSimpleParticleSystem::Draw(GL::RenderDataBufferTC* va) const
 
 void CSimpleParticleSystem::Update()
 {
+	if (closedForm) {
+		// the slowest-decaying particle is the last to die
+		deleteMe = ((minDecayRate * age) >= 1.0f);
+		age += 1;
+		return;
+	}
+
 	deleteMe = true;
 
 	for (auto& p: particles) {
@@ -179,6 +237,8 @@ void CSimpleParticleSystem::Init(const CUnit* owner, const float3& offset)
 		p.life = 0;
 		p.decayrate = 1.0f / (particleLife + (guRNG.NextFloat() * particleLifeSpread));
 		p.size = particleSize + guRNG.NextFloat()*particleSizeSpread;
+
+		minDecayRate = std::min(minDecayRate, p.decayrate);
 	}
 
 	drawRadius = (particleSpeed + particleSpeedSpread) * (particleLife * particleLifeSpread);
@@ -207,6 +267,7 @@ bool CSimpleParticleSystem::GetMemberInfo(SExpGenSpawnableMemberInfo& memberInfo
 	CHECK_MEMBER_INFO_FLOAT (CSimpleParticleSystem, sizeMod            )
 	CHECK_MEMBER_INFO_INT   (CSimpleParticleSystem, numParticles       )
 	CHECK_MEMBER_INFO_BOOL  (CSimpleParticleSystem, directional        )
+	CHECK_MEMBER_INFO_BOOL  (CSimpleParticleSystem, closedForm         )
 	CHECK_MEMBER_INFO_PTR   (CSimpleParticleSystem, texture , projectileDrawer->textureAtlas->GetTexturePtr)
 	CHECK_MEMBER_INFO_PTR   (CSimpleParticleSystem, colorMap, CColorMap::LoadFromDefString                 )
 
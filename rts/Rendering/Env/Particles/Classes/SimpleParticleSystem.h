@@ -51,6 +51,9 @@ protected:
 
 	int numParticles;
 
+	/// if true, particles are not stepped by Update but evaluated in closed form when drawn
+	bool closedForm;
+
 	struct Particle
 	{
 		CR_DECLARE_STRUCT(Particle)
@@ -65,8 +68,26 @@ protected:
 		float sizeMod;
 	};
 
+	// closed-form motion after <age> updates, shared by all particles
+	struct ParticleMotion {
+		float speedMul;
+		float posSpeedMul;
+		float sizeMul;
+		float sizeAdd;
+
+		float3 speedAdd;
+		float3 posAdd;
+	};
+
+	ParticleMotion CalcParticleMotion() const;
+	Particle GetParticle(const Particle& p, const ParticleMotion& m) const;
+
 protected:
 	 std::vector<Particle> particles;
+
+	 // number of updates since Init and smallest decay-rate, used if closedForm
+	 int age;
+	 float minDecayRate;
 };
 
 /**
@@ -9,6 +9,7 @@
 #include "Lua/LuaParser.h"
 #include "Map/MapInfo.h"
 #include "Rendering/GroundFlash.h"
+#include "Rendering/GroundFlashDecals.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/UnitDrawer.h"
@@ -37,6 +38,17 @@
 #include "System/Log/ILog.h"
 #include "System/SafeUtil.h"
 #include "System/StringUtil.h"
+#include "System/Threading/ThreadPool.h"
+
+
+// below this many particles per thread the fill is done serially
+static constexpr size_t MIN_PARTICLE_CHUNK_SIZE = 1024;
+
+// per-chunk buffers for DrawParticles; appends go to CPU memory
+static std::vector<GL::RenderDataBufferTC> particleStagingBuffers;
+static std::vector< std::vector<VA_TYPE_TC> > particleStagingElems;
+
+static CGroundFlashDecals groundFlashDecals;
 
 
 CProjectileDrawer* projectileDrawer = nullptr;
@@ -46,8 +58,8 @@ CProjectileDrawer::CProjectileDrawer(): CEventClient("[CProjectileDrawer]", 1234
 
 	loadscreen->SetLoadMessage("Creating Projectile Textures");
 
-	textureAtlas = new CTextureAtlas(); textureAtlas->SetName("ProjectileTextureAtlas");
-	groundFXAtlas = new CTextureAtlas(); groundFXAtlas->SetName("ProjectileEffectsAtlas");
+	textureAtlas = new CTextureAtlas(CTextureAtlas::ATLAS_ALLOC_SKYLINE); textureAtlas->SetName("ProjectileTextureAtlas");
+	groundFXAtlas = new CTextureAtlas(CTextureAtlas::ATLAS_ALLOC_SKYLINE); groundFXAtlas->SetName("ProjectileEffectsAtlas");
 
 	LuaParser resourcesParser("gamedata/resources.lua", SPRING_VFS_MOD_BASE, SPRING_VFS_ZIP);
 	LuaParser mapResParser("gamedata/resources_map.lua", SPRING_VFS_MAP_BASE, SPRING_VFS_ZIP);
@@ -228,6 +240,7 @@ CProjectileDrawer::CProjectileDrawer(): CEventClient("[CProjectileDrawer]", 1234
 		perlinFB.Unbind();
 	}
 
+	groundFlashDecals.Init();
 
 	for (int modelType = MODELTYPE_3DO; modelType < MODELTYPE_OTHER; modelType++) {
 		modelRenderers[modelType] = IModelRenderContainer::GetInstance(modelType);
@@ -241,6 +254,8 @@ CProjectileDrawer::~CProjectileDrawer() {
 	spring::SafeDelete(textureAtlas);
 	spring::SafeDelete(groundFXAtlas);
 
+	groundFlashDecals.Kill();
+
 	for (int modelType = MODELTYPE_3DO; modelType < MODELTYPE_OTHER; modelType++) {
 		spring::SafeDelete(modelRenderers[modelType]);
 	}
@@ -574,13 +589,54 @@ void CProjectileDrawer::DrawProjectilePass(Shader::IProgramObject*, bool drawRef
 
 	std::sort(zSortedProjectiles.begin(), zSortedProjectiles.end(), zSortCmp);
 
-
 	// collect the alpha-translucent particle effects in fxBuffer
-	for (CProjectile* p: zSortedProjectiles) {
-		p->Draw(fxBuffer);
+	DrawParticles();
+}
+
+void CProjectileDrawer::DrawParticles()
+{
+	const size_t numSorted = zSortedProjectiles.size();
+	const size_t numParticles = numSorted + unsortedProjectiles.size();
+	const size_t numChunks = std::min(size_t(ThreadPool::GetNumThreads()), numParticles / MIN_PARTICLE_CHUNK_SIZE);
+
+	const auto GetParticle = [&](size_t i) {
+		return ((i < numSorted)? zSortedProjectiles[i]: unsortedProjectiles[i - numSorted]);
+	};
+
+	if (numChunks <= 1) {
+		for (size_t i = 0; i < numParticles; i++) {
+			GetParticle(i)->Draw(fxBuffer);
+		}
+
+		return;
 	}
-	for (CProjectile* p: unsortedProjectiles) {
-		p->Draw(fxBuffer);
+
+	// each chunk can hold as much as fxBuffer itself, same overflow behavior as a serial fill
+	const size_t maxChunkElems = fxBuffer->NumFreeElems();
+
+	particleStagingBuffers.resize(std::max(particleStagingBuffers.size(), numChunks));
+	particleStagingElems.resize(std::max(particleStagingElems.size(), numChunks));
+
+	// every chunk is a contiguous range of the sorted-then-unsorted sequence;
+	// copying them back in order leaves fxBuffer exactly as the serial fill
+	for_mt(0, numChunks, [&](const int k) {
+		std::vector<VA_TYPE_TC>& chunkElems = particleStagingElems[k];
+		GL::RenderDataBufferTC& chunkBuffer = particleStagingBuffers[k];
+
+		if (chunkElems.size() < maxChunkElems)
+			chunkElems.resize(maxChunkElems);
+
+		chunkBuffer.SetupStaging(chunkElems.data(), chunkElems.size());
+
+		for (size_t i = (numParticles * k) / numChunks, n = (numParticles * (k + 1)) / numChunks; i < n; i++) {
+			GetParticle(i)->Draw(&chunkBuffer);
+		}
+	});
+
+	for (size_t k = 0; k < numChunks; k++) {
+		const GL::RenderDataBufferTC& chunkBuffer = particleStagingBuffers[k];
+
+		fxBuffer->SafeAppend(chunkBuffer.GetPendingElems(), std::min(chunkBuffer.NumElems(), fxBuffer->NumFreeElems()));
 	}
 }
 
@@ -753,12 +809,7 @@ void CProjectileDrawer::DrawGroundFlashes()
 	glPolygonOffset(-20, -1000);
 	glEnable(GL_POLYGON_OFFSET_FILL);
 
-	gfBuffer = GL::GetRenderBufferTC();
-	gfShader = gfBuffer->GetShader();
-
-	gfShader->Enable();
-	gfShader->SetUniformMatrix4x4<const char*, float>("u_movi_mat", false, camera->GetViewMatrix());
-	gfShader->SetUniformMatrix4x4<const char*, float>("u_proj_mat", false, camera->GetProjectionMatrix());
+	groundFlashDecals.Enable();
 
 	bool depthTest = true;
 	bool depthMask = false;
@@ -771,7 +822,7 @@ void CProjectileDrawer::DrawGroundFlashes()
 			continue;
 
 		if (depthTest != gf->depthTest) {
-			gfBuffer->Submit(GL_QUADS);
+			groundFlashDecals.Flush();
 
 			if ((depthTest = gf->depthTest)) {
 				glEnable(GL_DEPTH_TEST);
@@ -780,7 +831,7 @@ void CProjectileDrawer::DrawGroundFlashes()
 			}
 		}
 		if (depthMask != gf->depthMask) {
-			gfBuffer->Submit(GL_QUADS);
+			groundFlashDecals.Flush();
 
 			if ((depthMask = gf->depthMask)) {
 				glDepthMask(GL_TRUE);
@@ -789,11 +840,10 @@ void CProjectileDrawer::DrawGroundFlashes()
 			}
 		}
 
-		gf->Draw(gfBuffer);
+		gf->Draw(&groundFlashDecals);
 	}
 
-	gfBuffer->Submit(GL_QUADS);
-	gfShader->Disable();
+	groundFlashDecals.Disable();
 
 	glFogfv(GL_FOG_COLOR, sky->fogColor);
 	glDisable(GL_POLYGON_OFFSET_FILL);
@@ -54,9 +54,7 @@ public:
 
 
 	GL::RenderDataBufferTC* fxBuffer = nullptr;
-	GL::RenderDataBufferTC* gfBuffer = nullptr;
 	Shader::IProgramObject* fxShader = nullptr;
-	Shader::IProgramObject* gfShader = nullptr;
 
 	CTextureAtlas* textureAtlas = nullptr;  ///< texture atlas for projectiles
 	CTextureAtlas* groundFXAtlas = nullptr; ///< texture atlas for ground fx
@@ -105,6 +103,7 @@ private:
 
 	void DrawProjectilePass(Shader::IProgramObject*, bool, bool);
 	void DrawParticlePass(Shader::IProgramObject*, bool, bool);
+	void DrawParticles();
 	void DrawProjectileShadowPass(Shader::IProgramObject*);
 	void DrawParticleShadowPass(Shader::IProgramObject*);
 
@@ -63,6 +63,8 @@ CFarTextureHandler::CFarTextureHandler()
 
 	fbo.Bind();
 	fbo.AttachTexture(farTextureID);
+	// kept attached rather than recreated for each batch of icons
+	fbo.CreateRenderBuffer(GL_DEPTH_ATTACHMENT, GL_DEPTH_COMPONENT16, texSize.x, texSize.y);
 
 	if (fbo.CheckStatus("FARTEXTURE")) {
 		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
@@ -118,29 +120,48 @@ bool CFarTextureHandler::HaveFarIcon(const CSolidObject* obj) const
 
 
 /**
- * @brief Really create the far-texture for the given model.
+ * @brief Really create the far-textures for all queued models.
+ *
+ * The FBO and model-drawing state are set up once for the whole batch.
  */
-void CFarTextureHandler::CreateFarTexture(const CSolidObject* obj)
+void CFarTextureHandler::CreateFarTextures()
 {
-	const S3DModel* model = obj->model;
+	unsigned int numCreated = 0;
 
-	// make space
-	if (obj->team >= iconCache.size())
-		iconCache.resize(std::max(iconCache.size() * 2, size_t(obj->team + 1)), {});
+	// make space and drop objects whose icons already exist; the same
+	// object or model can be queued multiple times in different passes
+	for (const CSolidObject* obj: createQueue) {
+		const S3DModel* model = obj->model;
 
-	if (model->id >= iconCache[obj->team].size())
-		iconCache[obj->team].resize(std::max(iconCache[obj->team].size() * 2, size_t(model->id + 1)), {0});
+		if (obj->team >= iconCache.size())
+			iconCache.resize(std::max(iconCache.size() * 2, size_t(obj->team + 1)), {});
 
-	// same object can be queued multiple times in different passes
-	if (iconCache[obj->team][model->id].farTexNum != 0)
-		return;
+		if (model->id >= iconCache[obj->team].size())
+			iconCache[obj->team].resize(std::max(iconCache[obj->team].size() * 2, size_t(model->id + 1)), {0});
+
+		if (iconCache[obj->team][model->id].farTexNum != 0)
+			continue;
+
+		// mark as pending, icons are numbered in queue order
+		iconCache[obj->team][model->id].farTexNum = -1u;
+		createQueue[numCreated++] = obj;
+	}
+
+	createQueue.resize(numCreated);
 
-	// enough free space in the atlas?
-	if (!CheckResizeAtlas())
+	for (const CSolidObject* obj: createQueue) {
+		iconCache[obj->team][obj->model->id].farTexNum = 0;
+	}
+
+	// enough free space in the atlas? (drops whatever does not fit)
+	while (!createQueue.empty() && !CheckResizeAtlas(createQueue.size())) {
+		createQueue.pop_back();
+	}
+
+	if (createQueue.empty())
 		return;
 
 	fbo.Bind();
-	fbo.CreateRenderBuffer(GL_DEPTH_ATTACHMENT, GL_DEPTH_COMPONENT16, texSize.x, texSize.y);
 	fbo.CheckStatus("FARTEXTURE");
 
 	glPushAttrib(GL_ALL_ATTRIB_BITS);
@@ -157,6 +178,25 @@ void CFarTextureHandler::CreateFarTexture(const CSolidObject* obj)
 	//   current state (advModelShading, sunDir, etc)
 	//   and will not track later state-changes
 	unitDrawer->SetupOpaqueDrawing(false);
+
+	IUnitDrawerState* state = unitDrawer->GetDrawerState(DRAWER_STATE_SEL);
+
+	for (const CSolidObject* obj: createQueue) {
+		CreateFarTexture(obj, state);
+	}
+
+	unitDrawer->ResetOpaqueDrawing(false);
+
+	// glViewport(globalRendering->viewPosX, 0, globalRendering->viewSizeX, globalRendering->viewSizeY);
+	glPopAttrib();
+
+	fbo.Unbind();
+}
+
+void CFarTextureHandler::CreateFarTexture(const CSolidObject* obj, IUnitDrawerState* state)
+{
+	const S3DModel* model = obj->model;
+
 	unitDrawer->PushModelRenderState(model);
 	unitDrawer->SetTeamColour(obj->team);
 
@@ -176,7 +216,6 @@ void CFarTextureHandler::CreateFarTexture(const CSolidObject* obj)
 	iconCam.SetViewMatrix(viewMat);
 
 
-	IUnitDrawerState* state = unitDrawer->GetDrawerState(DRAWER_STATE_SEL);
 	Shader::IProgramObject* shader = state->GetActiveShader();
 
 	// overwrite the matrices set by SetupOpaqueDrawing
@@ -200,13 +239,6 @@ void CFarTextureHandler::CreateFarTexture(const CSolidObject* obj)
 	}
 
 	unitDrawer->PopModelRenderState(model);
-	unitDrawer->ResetOpaqueDrawing(false);
-
-	// glViewport(globalRendering->viewPosX, 0, globalRendering->viewSizeX, globalRendering->viewSizeY);
-	glPopAttrib();
-
-	fbo.Detach(GL_DEPTH_ATTACHMENT);
-	fbo.Unbind();
 
 	// cache object's current radius s.t. quad is always drawn with fixed size
 	iconCache[obj->team][model->id].farTexNum = ++usedFarTextures;
@@ -270,9 +302,8 @@ void CFarTextureHandler::Queue(const CSolidObject* obj)
 
 void CFarTextureHandler::Draw()
 {
-	for (const CSolidObject* obj: createQueue) {
-		CreateFarTexture(obj);
-	}
+	if (!createQueue.empty())
+		CreateFarTextures();
 
 	// render currently queued far-icons
 	if (!renderQueue.empty()) {
@@ -305,7 +336,7 @@ void CFarTextureHandler::Draw()
 
 
 
-bool CFarTextureHandler::CheckResizeAtlas()
+bool CFarTextureHandler::CheckResizeAtlas(unsigned int numNewIcons)
 {
 	const int oldTexSizeY = texSize.y;
 	const int maxTexSizeY = globalRendering->maxTextureSize;
@@ -316,7 +347,7 @@ bool CFarTextureHandler::CheckResizeAtlas()
 		const int maxSprites  = maxSpritesX * maxSpritesY;
 		const int numSprites  = usedFarTextures * NUM_ICON_ORIENTATIONS;
 
-		if ((numSprites + NUM_ICON_ORIENTATIONS) <= maxSprites)
+		if ((numSprites + numNewIcons * NUM_ICON_ORIENTATIONS) <= maxSprites)
 			break;
 
 		texSize.y <<= 1;
@@ -326,20 +357,13 @@ bool CFarTextureHandler::CheckResizeAtlas()
 		return true;
 
 	if (texSize.y > maxTexSizeY) {
+		texSize.y = oldTexSizeY;
+
 		LOG_L(L_DEBUG, "[FTH::%s] out of far-texture atlas space", __func__);
 		return false;
 	}
 
 
-	std::vector<unsigned char> atlasPixels(texSize.x * texSize.y * 4, 0);
-
-	glBindTexture(GL_TEXTURE_2D, farTextureID);
-	glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, &atlasPixels[0]); //TODO use the FBO?
-	glDeleteTextures(1, &farTextureID);
-
-	// zero out the newly added atlas region
-	memset(&atlasPixels[0] + texSize.x * oldTexSizeY * 4, 0, texSize.x * (texSize.y - oldTexSizeY) * 4);
-
 	GLuint newFarTextureID;
 	glGenTextures(1, &newFarTextureID);
 	glBindTexture(GL_TEXTURE_2D, newFarTextureID);
@@ -347,14 +371,28 @@ bool CFarTextureHandler::CheckResizeAtlas()
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_BORDER);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texSize.x, texSize.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, &atlasPixels[0]);
+	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texSize.x, texSize.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
 
 	fbo.Bind();
+
+	// copy the old atlas (still attached) on the GPU instead of reading it back
+	glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, texSize.x, oldTexSizeY);
+	glDeleteTextures(1, &farTextureID);
+
 	fbo.DetachAll();
 	fbo.AttachTexture(farTextureID = newFarTextureID);
-	fbo.CheckStatus("FARTEXTURE");
-	fbo.Unbind();
+	fbo.CreateRenderBuffer(GL_DEPTH_ATTACHMENT, GL_DEPTH_COMPONENT16, texSize.x, texSize.y);
 
+	if (fbo.CheckStatus("FARTEXTURE")) {
+		// zero out the newly added atlas region
+		glPushAttrib(GL_COLOR_BUFFER_BIT | GL_SCISSOR_BIT);
+		glEnable(GL_SCISSOR_TEST);
+		glScissor(0, oldTexSizeY, texSize.x, texSize.y - oldTexSizeY);
+		glClearColor(0.0f, 0.0f, 0.0f, 0.0f);
+		glClear(GL_COLOR_BUFFER_BIT);
+		glPopAttrib();
+	}
+
+	fbo.Unbind();
 	return true;
 }
-
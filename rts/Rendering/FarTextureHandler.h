@@ -10,6 +10,7 @@
 #include "Rendering/GL/RenderDataBufferFwd.hpp"
 
 class CSolidObject;
+struct IUnitDrawerState;
 
 /**
  * @brief Cheap unit lodding using imposters.
@@ -25,13 +26,14 @@ public:
 
 private:
 	bool HaveFarIcon(const CSolidObject* obj) const;
-	bool CheckResizeAtlas();
+	bool CheckResizeAtlas(unsigned int numNewIcons);
 
 	float2 GetTextureCoords(const int farTextureNum, const int orientation) const;
 	int2 GetTextureCoordsInt(const int farTextureNum, const int orientation) const;
 
 	void DrawFarTexture(const CSolidObject* obj, GL::RenderDataBufferTN* rdb);
-	void CreateFarTexture(const CSolidObject* obj);
+	void CreateFarTextures();
+	void CreateFarTexture(const CSolidObject* obj, IUnitDrawerState* state);
 
 private:
 	int2 texSize;
@@ -30,6 +30,9 @@
 #include "System/ContainerUtil.h"
 #include "System/EventHandler.h"
 #include "System/myMath.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <algorithm>
 
 #define DRAW_QUAD_SIZE 32
 
@@ -151,6 +154,7 @@ void CFeatureDrawer::RenderFeatureCreated(const CFeature* feature)
 	UpdateDrawQuad(f);
 
 	unsortedFeatures.push_back(f);
+	featuresVersion++;
 }
 
 
@@ -168,12 +172,14 @@ void CFeatureDrawer::RenderFeatureDestroyed(const CFeature* feature)
 	}
 
 	LuaObjectDrawer::SetObjectLOD(f, LUAOBJ_FEATURE, 0);
+	featuresVersion++;
 }
 
 
 void CFeatureDrawer::FeatureMoved(const CFeature* feature, const float3& oldpos)
 {
 	UpdateDrawQuad(const_cast<CFeature*>(feature));
+	featuresVersion++;
 }
 
 void CFeatureDrawer::UpdateDrawQuad(CFeature* feature)
@@ -292,12 +298,106 @@ void CFeatureDrawer::DrawOpaqueFeatures(int modelType)
 				if (!inShadowPass && LuaObjectDrawer::AddOpaqueMaterialObject(f, LUAOBJ_FEATURE))
 					continue;
 
+				// deferred until all features of this model-type have been visited
+				if (CanDrawInstancedFeature(f)) {
+					instancedFeatures.push_back(f);
+					continue;
+				}
+
 				unitDrawer->SetTeamColour(f->team);
 
 				DrawFeatureDefTrans(f, false, false);
 			}
 		}
 	}
+
+	DrawInstancedFeatures(modelType);
+}
+
+void CFeatureDrawer::DrawInstancedFeatures(int modelType)
+{
+	StaticBatch& batch = staticBatches[(CCamera::GetActiveCamera())->GetCamType()][modelType];
+
+	if (batch.version != featuresVersion || batch.members != instancedFeatures) {
+		batch.members.swap(instancedFeatures);
+		batch.features.assign(batch.members.begin(), batch.members.end());
+		batch.version = featuresVersion;
+
+		// group by bin first so each texture is bound only once
+		std::sort(batch.features.begin(), batch.features.end(), [](const CFeature* a, const CFeature* b) {
+			if (a->model->textureType != b->model->textureType)
+				return (a->model->textureType < b->model->textureType);
+			if (a->model != b->model)
+				return (a->model->id < b->model->id);
+
+			return (a->team < b->team);
+		});
+
+		batch.matrices.clear();
+
+		for (const CFeature* f: batch.features) {
+			LocalModel* model = const_cast<LocalModel*>(&f->localModel);
+
+			model->UpdatePieceMatrices(gs->frameNum);
+
+			const std::vector<CMatrix44f>& pieceMats = model->GetPieceMatrices();
+
+			batch.matrices.push_back(f->GetTransformMatrixRef());
+			batch.matrices.insert(batch.matrices.end(), pieceMats.begin(), pieceMats.end());
+		}
+	}
+
+	instancedFeatures.clear();
+
+	if (batch.features.empty())
+		return;
+
+	const IUnitDrawerState* state = unitDrawer->GetDrawerState(DRAWER_STATE_SEL);
+
+	// false if the buffer can not hold all matrices, features are then drawn separately
+	const bool batched = state->SetInstanceMatrices(batch.matrices.data(), batch.matrices.size());
+
+	const auto& features = batch.features;
+
+	for (size_t i = 0, j = 0, matrixIdx = 0; i < features.size(); i = j) {
+		const CFeature* feature = features[i];
+		const S3DModel* model = feature->model;
+
+		const size_t numInstanceMats = 1 + feature->localModel.GetPieceMatrices().size();
+
+		for (j = i + 1; j < features.size(); j++) {
+			if (features[j]->model != model || features[j]->team != feature->team)
+				break;
+		}
+
+		if (i == 0 || features[i - 1]->model->textureType != model->textureType)
+			CUnitDrawer::BindModelTypeTexture(modelType, model->textureType);
+
+		unitDrawer->SetTeamColour(feature->team);
+
+		if (batched) {
+			state->SetInstanceParams(matrixIdx, numInstanceMats);
+			model->DrawInstanced(j - i);
+		} else {
+			for (size_t k = i; k < j; k++) {
+				DrawFeatureDefTrans(features[k], false, false);
+			}
+		}
+
+		matrixIdx += ((j - i) * numInstanceMats);
+	}
+
+	state->SetInstanceParams(0, 0);
+}
+
+bool CFeatureDrawer::CanDrawInstancedFeature(const CFeature* feature) const
+{
+	// the shadow pass does not use the instancing drawer-state
+	if (inShadowPass || !unitDrawer->DrawInstancedModels())
+		return false;
+
+	// Lua may replace or augment the draw
+	return (!feature->luaDraw);
 }
 
 bool CFeatureDrawer::CanDrawFeature(const CFeature* feature) const
@@ -569,7 +669,9 @@ void CFeatureDrawer::FlagVisibleFeatures(
 
 	const CCamera* playerCam = CCamera::GetCamera(CCamera::CAMTYPE_PLAYER);
 
-	for (unsigned int n = 0; n < quads.size(); n++) {
+	// every feature is binned in exactly one draw-quad and only its own
+	// state is written below, so the quads can be processed in parallel
+	for_mt(0, quads.size(), [&](const int n) {
 		auto& mdlRenderProxy = featureDrawer->modelRenderers[ quads[n] ];
 
 		for (int i = 0; i < MODELTYPE_OTHER; ++i) {
@@ -624,7 +726,7 @@ void CFeatureDrawer::FlagVisibleFeatures(
 				}
 			}
 		}
-	}
+	});
 }
 
 void CFeatureDrawer::GetVisibleFeatures(CCamera* cam, int extraSize, bool drawFar)
@@ -7,6 +7,7 @@
 #include <array>
 
 #include "Game/Camera.h"
+#include "System/Matrix44f.h"
 #include "System/creg/creg_cond.h"
 #include "System/EventClient.h"
 #include "Rendering/Models/ModelRenderContainer.h"
@@ -75,6 +76,9 @@ private:
 	void DrawFarFeatures();
 
 	bool CanDrawFeature(const CFeature*) const;
+	bool CanDrawInstancedFeature(const CFeature*) const;
+
+	void DrawInstancedFeatures(int modelType);
 
 	static void DrawFeatureModel(const CFeature* feature, bool noLuaCall);
 
@@ -137,6 +141,27 @@ private:
 	std::array<unsigned int, CCamera::CAMTYPE_ENVMAP> camVisDrawFrames;
 	std::vector<CFeature*> unsortedFeatures;
 
+	/// opaque features drawn with instanced calls, kept per camera- and model-type
+	/// and only re-sorted and re-filled if the set of features that passed the per
+	/// frame checks (culling, LOS, fading, ...) differs from the previous frame or
+	/// a feature was created, destroyed or moved since
+	struct StaticBatch {
+		/// in visiting order, to detect changes
+		std::vector<const CFeature*> members;
+		/// members sorted by texture, model and team
+		std::vector<const CFeature*> features;
+		/// {model, piece[0], ..., piece[N-1]} matrices of each feature in <features>
+		std::vector<CMatrix44f> matrices;
+
+		unsigned int version = 0;
+	};
+
+	std::array<std::array<StaticBatch, MODELTYPE_OTHER>, CCamera::CAMTYPE_ENVMAP> staticBatches;
+	/// features of the current pass deferred to DrawInstancedFeatures
+	std::vector<const CFeature*> instancedFeatures;
+
+	unsigned int featuresVersion = 1;
+
 	GL::GeometryBuffer* geomBuffer;
 };
 
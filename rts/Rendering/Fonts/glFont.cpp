@@ -24,6 +24,9 @@
 #define ELEM_BUFFER_SIZE (sizeof(VA_TYPE_TC))
 #define QUAD_BUFFER_SIZE (4 * ELEM_BUFFER_SIZE)
 
+// number of distinct strings whose metrics are kept per font
+#define MAX_TEXT_METRICS 4096
+
 CONFIG(std::string,      FontFile).defaultValue("fonts/FreeSansBold.otf").description("Sets the font of Spring engine text.");
 CONFIG(std::string, SmallFontFile).defaultValue("fonts/FreeSansBold.otf").description("Sets the font of Spring engine small text.");
 
@@ -309,11 +312,65 @@ float CglFont::GetCharacterWidth(const char32_t c)
 
 
 
+CglFont::TextMetrics& CglFont::GetTextMetrics(const std::u8string& text)
+{
+	// strings are mostly short UI labels; bound the memory held for
+	// one-off texts (chat, console history) by starting over
+	if (textMetrics.size() >= MAX_TEXT_METRICS)
+		textMetrics.clear();
+
+	return textMetrics[text];
+}
+
 float CglFont::GetTextWidth_(const std::u8string& text)
 {
 	if (text.empty())
 		return 0.0f;
 
+	std::unique_lock<spring::recursive_mutex> lock(bufferMutex, std::defer_lock);
+
+	if (threadSafety)
+		lock.lock();
+
+	TextMetrics& tm = GetTextMetrics(text);
+
+	if (!tm.haveWidth) {
+		tm.width = CalcTextWidth(text);
+		tm.haveWidth = true;
+	}
+
+	return tm.width;
+}
+
+float CglFont::GetTextHeight_(const std::u8string& text, float* descender, int* numLines)
+{
+	if (text.empty()) {
+		if (descender != nullptr) *descender = 0.0f;
+		if (numLines != nullptr) *numLines = 0;
+		return 0.0f;
+	}
+
+	std::unique_lock<spring::recursive_mutex> lock(bufferMutex, std::defer_lock);
+
+	if (threadSafety)
+		lock.lock();
+
+	TextMetrics& tm = GetTextMetrics(text);
+
+	if (!tm.haveHeight) {
+		tm.height = CalcTextHeight(text, &tm.descender, &tm.numLines);
+		tm.haveHeight = true;
+	}
+
+	if (descender != nullptr) *descender = tm.descender;
+	if (numLines != nullptr) *numLines = tm.numLines;
+
+	return tm.height;
+}
+
+
+float CglFont::CalcTextWidth(const std::u8string& text)
+{
 	float curw = 0.0f;
 	float maxw = 0.0f;
 
@@ -377,14 +434,8 @@ float CglFont::GetTextWidth_(const std::u8string& text)
 }
 
 
-float CglFont::GetTextHeight_(const std::u8string& text, float* descender, int* numLines)
+float CglFont::CalcTextHeight(const std::u8string& text, float* descender, int* numLines)
 {
-	if (text.empty()) {
-		if (descender != nullptr) *descender = 0.0f;
-		if (numLines != nullptr) *numLines = 0;
-		return 0.0f;
-	}
-
 	float h = 0.0f;
 	float d = GetLineHeight() + GetDescender();
 
@@ -433,8 +484,8 @@ float CglFont::GetTextHeight_(const std::u8string& text, float* descender, int*
 
 	d -= ((multiLine - 1) * GetLineHeight() * (multiLine > 1));
 
-	if (descender != nullptr) *descender = d;
-	if (numLines != nullptr) *numLines = multiLine;
+	*descender = d;
+	*numLines = multiLine;
 
 	return h;
 }
@@ -12,6 +12,7 @@
 #include "Rendering/GL/VertexArray.h"
 #include "Rendering/GL/RenderDataBuffer.hpp"
 #include "System/float4.h"
+#include "System/UnorderedMap.hpp"
 #include "System/Threading/SpringThreading.h"
 
 #undef GetCharWidth // winapi.h
@@ -139,6 +140,25 @@ private:
 	float GetTextWidth_(const std::u8string& text);
 	float GetTextHeight_(const std::u8string& text, float* descender = nullptr, int* numLines = nullptr);
 
+	float CalcTextWidth(const std::u8string& text);
+	float CalcTextHeight(const std::u8string& text, float* descender, int* numLines);
+
+	// unscaled metrics only depend on the glyphs, so they can be reused
+	// by every caller (alignment in glPrint, TextWrap, Lua, ...) that
+	// measures the same string again each frame
+	struct TextMetrics {
+		float width = 0.0f;
+		float height = 0.0f;
+		float descender = 0.0f;
+
+		int numLines = 0;
+
+		bool haveWidth = false;
+		bool haveHeight = false;
+	};
+
+	TextMetrics& GetTextMetrics(const std::u8string& text);
+
 private:
 	unsigned int GetBufferIdx(bool outline) const { return (currBufferIdxGL4 * 2 + outline); }
 
@@ -158,6 +178,8 @@ private:
 	std::string fontPath;
 
 
+	spring::unordered_map<std::string, TextMetrics> textMetrics;
+
 	std::vector<float4> stripTextColors;
 	std::vector<float4> stripOutlineColors;
 	std::vector<float4>::iterator colorIterator;
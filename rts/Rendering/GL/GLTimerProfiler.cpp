@@ -0,0 +1,233 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+
+#include "GLTimerProfiler.h"
+#include "Rendering/GL/myGL.h"
+#include "System/myMath.h"
+
+
+CGLTimerProfiler& CGLTimerProfiler::GetInstance()
+{
+	static CGLTimerProfiler instance;
+	return instance;
+}
+
+
+void CGLTimerProfiler::Init()
+{
+	// core since 3.3, without it every scope is a no-op
+	if (!GLEW_ARB_timer_query)
+		return;
+
+	for (Buffer& buf: buffers) {
+		glGenQueries(buf.queries.size(), &buf.queries[0]);
+	}
+
+	haveQueries = true;
+}
+
+void CGLTimerProfiler::Kill()
+{
+	if (!haveQueries)
+		return;
+
+	for (Buffer& buf: buffers) {
+		glDeleteQueries(buf.queries.size(), &buf.queries[0]);
+	}
+
+	haveQueries = false;
+	enabled = false;
+}
+
+
+void CGLTimerProfiler::SetEnabled(bool b)
+{
+	if (b == enabled)
+		return;
+
+	if (b) {
+		for (Buffer& buf: buffers) {
+			buf.numScopes = 0;
+		}
+		for (Timer& t: timers) {
+			t.frameTime = 0.0f;
+			t.avgTime = 0.0f;
+		}
+
+		lastSwapTime = spring_now();
+
+		numFrameTimes = 0;
+		numDroppedScopes = 0;
+	}
+
+	enabled = b;
+}
+
+
+unsigned CGLTimerProfiler::RegisterTimer(const char* name)
+{
+	const auto iter = timerIDs.find(name);
+
+	if (iter != timerIDs.end())
+		return iter->second;
+
+	timerIDs[name] = timers.size();
+	timers.emplace_back();
+	timers.back().name = name;
+	return (timers.size() - 1);
+}
+
+unsigned CGLTimerProfiler::FindTimer(const std::string& name) const
+{
+	const auto iter = timerIDs.find(name);
+
+	if (iter == timerIDs.end())
+		return -1u;
+
+	return iter->second;
+}
+
+
+unsigned CGLTimerProfiler::BeginScope(unsigned timerID)
+{
+	if (!enabled || !haveQueries)
+		return -1u;
+
+	Buffer& buf = buffers[curBuffer];
+
+	if (buf.numScopes >= MAX_SCOPES)
+		return -1u;
+
+	buf.scopes[buf.numScopes] = {timerID, false};
+
+	glQueryCounter(buf.queries[buf.numScopes * 2 + 0], GL_TIMESTAMP);
+	return (buf.numScopes++);
+}
+
+void CGLTimerProfiler::EndScope(unsigned scopeIdx)
+{
+	Buffer& buf = buffers[curBuffer];
+
+	// also rejects scopes begun before the profiler was (re)enabled
+	if (!enabled || scopeIdx >= buf.numScopes)
+		return;
+
+	buf.scopes[scopeIdx].ended = true;
+
+	glQueryCounter(buf.queries[scopeIdx * 2 + 1], GL_TIMESTAMP);
+}
+
+
+void CGLTimerProfiler::EndFrame(float vsyncRate)
+{
+	if (!enabled)
+		return;
+
+	const spring_time now = spring_now();
+	const float frameTime = (now - lastSwapTime).toMilliSecsf();
+	const unsigned frameIdx = (numFrameTimes++) % NUM_FRAME_TIMES;
+
+	frameTimes[frameIdx] = frameTime;
+	frameMisses[frameIdx] = 0;
+
+	// a frame that took N vblank periods missed N-1 of them
+	if (vsyncRate > 0.0f)
+		frameMisses[frameIdx] = Clamp(int(frameTime * vsyncRate * 0.001f + 0.5f) - 1, 0, 255);
+
+	lastSwapTime = now;
+
+	// the next buffer was filled NUM_BUFFERS-1 frames ago
+	ResolveBuffer(curBuffer = (curBuffer + 1) % NUM_BUFFERS);
+}
+
+void CGLTimerProfiler::ResolveBuffer(unsigned bufferIdx)
+{
+	Buffer& buf = buffers[bufferIdx];
+
+	if (buf.numScopes == 0)
+		return;
+
+	for (Timer& t: timers) {
+		t.frameTime = 0.0f;
+	}
+
+	unsigned numDropped = 0;
+
+	for (unsigned i = 0; i < buf.numScopes; i++) {
+		const Scope& scope = buf.scopes[i];
+
+		GLint available = 0;
+		GLuint64 t0 = 0;
+		GLuint64 t1 = 0;
+
+		if (!scope.ended) {
+			numDropped++;
+			continue;
+		}
+
+		// the end-query finishes last; never wait for it
+		glGetQueryObjectiv(buf.queries[i * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+		if (!available) {
+			numDropped++;
+			continue;
+		}
+
+		glGetQueryObjectui64v(buf.queries[i * 2 + 0], GL_QUERY_RESULT, &t0);
+		glGetQueryObjectui64v(buf.queries[i * 2 + 1], GL_QUERY_RESULT, &t1);
+
+		timers[scope.timerID].frameTime += ((t1 - t0) * 1e-6f);
+	}
+
+	buf.numScopes = 0;
+	numDroppedScopes += numDropped;
+
+	// a frame with missing results would under-report, leave the averages alone
+	if (numDropped != 0)
+		return;
+
+	for (Timer& t: timers) {
+		t.avgTime = mix(t.avgTime, t.frameTime, 0.05f);
+	}
+}
+
+
+void CGLTimerProfiler::GetFrameTimeStats(FrameTimeStats& stats) const
+{
+	const unsigned numFrames = std::min(numFrameTimes, unsigned(NUM_FRAME_TIMES));
+
+	std::array<float, NUM_FRAME_TIMES> sortedTimes;
+	std::copy(frameTimes.begin(), frameTimes.begin() + numFrames, sortedTimes.begin());
+	std::sort(sortedTimes.begin(), sortedTimes.begin() + numFrames);
+
+	stats.histogram.fill(0);
+
+	stats.numFrames = numFrames;
+	stats.numMissedVSyncs = 0;
+	stats.maxBinCount = 0;
+	stats.maxFrameTime = 0.0f;
+
+	constexpr float quantiles[] = {0.5f, 0.9f, 0.99f};
+
+	for (unsigned i = 0; i < 3; i++) {
+		stats.percentiles[i] = (numFrames > 0)? sortedTimes[std::min(numFrames - 1, unsigned(quantiles[i] * numFrames))]: 0.0f;
+	}
+
+	if (numFrames == 0)
+		return;
+
+	for (unsigned i = 0; i < numFrames; i++) {
+		const unsigned binIdx = std::min(unsigned(sortedTimes[i] / HISTOGRAM_BIN_SIZE), NUM_HISTOGRAM_BINS - 1);
+
+		stats.maxBinCount = std::max(stats.maxBinCount, ++stats.histogram[binIdx]);
+		stats.numMissedVSyncs += frameMisses[i];
+	}
+
+	stats.maxFrameTime = sortedTimes[numFrames - 1];
+}
+
+
+
+ScopedGLTimer::ScopedGLTimer(unsigned timerID): scopeIdx(glTimerProfiler.BeginScope(timerID)) {}
+ScopedGLTimer::~ScopedGLTimer() { glTimerProfiler.EndScope(scopeIdx); }
@@ -0,0 +1,139 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef GL_TIMER_PROFILER_H
+#define GL_TIMER_PROFILER_H
+
+#include <array>
+#include <string>
+#include <vector>
+
+#include "System/Misc/NonCopyable.h"
+#include "System/Misc/SpringTime.h"
+#include "System/UnorderedMap.hpp"
+
+// measures the GPU time of the enclosed GL commands; use the same name as
+// the SCOPED_TIMER of the pass to show both next to each other in /debug
+#define SCOPED_GL_TIMER(name) static const unsigned __scopedGLTimerID = glTimerProfiler.RegisterTimer("" name); ScopedGLTimer __scopedGLTimer(__scopedGLTimerID);
+
+
+/**
+ * @brief GPU pass timer and frame-pacing statistics
+ *
+ * Every scope issues a GL_TIMESTAMP query pair. Queries are kept in a ring
+ * of NUM_BUFFERS frames and only read back when their buffer is about to be
+ * reused, by which time the GPU has normally finished them; pairs whose
+ * results are still not available are dropped instead of waiting, so the
+ * CPU never stalls on the GPU.
+ *
+ * EndFrame (called after each buffer swap) also records the interval
+ * between swaps, from which the frame-time percentiles, histogram and the
+ * number of missed vsyncs are derived.
+ *
+ * Only used from the render thread.
+ */
+class CGLTimerProfiler : public spring::noncopyable
+{
+public:
+	static constexpr unsigned NUM_BUFFERS = 3;
+	static constexpr unsigned MAX_SCOPES = 128; // per frame, two queries each
+
+	static constexpr unsigned NUM_FRAME_TIMES = 600;
+	static constexpr unsigned NUM_HISTOGRAM_BINS = 25;
+	static constexpr float HISTOGRAM_BIN_SIZE = 2.0f; // milliseconds; the last bin also holds every longer frame
+
+	struct FrameTimeStats {
+		float percentiles[3]; // 50th, 90th and 99th, milliseconds
+		float maxFrameTime;
+
+		unsigned numFrames;
+		unsigned numMissedVSyncs; // within the last numFrames
+		unsigned maxBinCount;
+
+		std::array<unsigned, NUM_HISTOGRAM_BINS> histogram;
+	};
+
+public:
+	static CGLTimerProfiler& GetInstance();
+
+	/// require a GL context
+	void Init();
+	void Kill();
+
+	/// enabling clears all results
+	void SetEnabled(bool b);
+	bool IsEnabled() const { return enabled; }
+
+	/// same semantics as CTimeProfiler::RegisterTimer, but a separate id space
+	unsigned RegisterTimer(const char* name);
+	/// returns -1u if no timer is called name
+	unsigned FindTimer(const std::string& name) const;
+
+	/// returns the scope index to pass to EndScope, or -1u if not recording
+	unsigned BeginScope(unsigned timerID);
+	void EndScope(unsigned scopeIdx);
+
+	/**
+	 * vsyncRate is the expected swap rate in Hz (display refresh rate
+	 * divided by the swap interval), or 0 if vsync is disabled.
+	 */
+	void EndFrame(float vsyncRate);
+
+	/// GPU time per frame in milliseconds, smoothed over recent frames
+	float GetTimerTime(unsigned timerID) const { return ((timerID < timers.size())? timers[timerID].avgTime: 0.0f); }
+	/// scopes whose results were not yet available when read back
+	unsigned GetNumDroppedScopes() const { return numDroppedScopes; }
+
+	void GetFrameTimeStats(FrameTimeStats& stats) const;
+
+private:
+	void ResolveBuffer(unsigned bufferIdx);
+
+private:
+	struct Timer {
+		std::string name;
+
+		float frameTime = 0.0f;
+		float avgTime = 0.0f;
+	};
+	struct Scope {
+		unsigned timerID;
+		bool ended;
+	};
+	struct Buffer {
+		std::array<unsigned int, MAX_SCOPES * 2> queries;
+		std::array<Scope, MAX_SCOPES> scopes;
+
+		unsigned numScopes = 0;
+	};
+
+	std::vector<Timer> timers;
+	spring::unordered_map<std::string, unsigned> timerIDs;
+
+	std::array<Buffer, NUM_BUFFERS> buffers;
+	std::array<float, NUM_FRAME_TIMES> frameTimes;
+	std::array<unsigned char, NUM_FRAME_TIMES> frameMisses;
+
+	spring_time lastSwapTime;
+
+	unsigned curBuffer = 0;
+	unsigned numFrameTimes = 0;
+	unsigned numDroppedScopes = 0;
+
+	bool enabled = false;
+	bool haveQueries = false;
+};
+
+
+class ScopedGLTimer : public spring::noncopyable
+{
+public:
+	ScopedGLTimer(unsigned timerID);
+	~ScopedGLTimer();
+
+private:
+	const unsigned scopeIdx;
+};
+
+#define glTimerProfiler (CGLTimerProfiler::GetInstance())
+
+#endif // GL_TIMER_PROFILER_H
@@ -2,9 +2,12 @@
 
 #include "GeometryBuffer.h"
 #include "Rendering/GlobalRendering.h"
+#include "System/Config/ConfigHandler.h"
 #include <algorithm>
 #include <cstring> //memset
 
+CONFIG(bool, CompactGeometryBuffers).defaultValue(false).description("Store G-buffer normals with 10 bits per component and depth with 24 bits, and leave out the custom-data (misc) attachment that only Lua shaders write to. Saves a sixth of the G-buffer memory and bandwidth.");
+
 void GL::GeometryBuffer::Init(bool ctor) {
 	// if dead, this must be a non-ctor reload
 	assert(!dead || !ctor);
@@ -65,6 +68,9 @@ void GL::GeometryBuffer::DetachTextures(const bool init) {
 
 	// detach only actually attached textures, ATI drivers might crash
 	for (unsigned int i = 0; i < (ATTACHMENT_COUNT - 1); ++i) {
+		if (bufferTextureIDs[i] == 0)
+			continue;
+
 		buffer.Detach(GL_COLOR_ATTACHMENT0 + i);
 	}
 
@@ -103,9 +109,17 @@ void GL::GeometryBuffer::DrawDebug(const unsigned int texID, const float2 texMin
 }
 
 bool GL::GeometryBuffer::Create(const int2 size) {
+	static const bool compact = configHandler->GetBool("CompactGeometryBuffers");
+
 	unsigned int n = 0;
 
 	for (; n < ATTACHMENT_COUNT; n++) {
+		if (compact && n == ATTACHMENT_MISCTEX) {
+			// shader writes to a GL_NONE draw-buffer are discarded
+			bufferAttachments[n] = GL_NONE;
+			continue;
+		}
+
 		glGenTextures(1, &bufferTextureIDs[n]);
 		glBindTexture(GL_TEXTURE_2D, bufferTextureIDs[n]);
 
@@ -116,16 +130,22 @@ bool GL::GeometryBuffer::Create(const int2 size) {
 
 		if (n == ATTACHMENT_ZVALTEX) {
 			glTexParameteri(GL_TEXTURE_2D, GL_DEPTH_TEXTURE_MODE, GL_LUMINANCE);
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_DEPTH_COMPONENT32F, size.x, size.y, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+			glTexImage2D(GL_TEXTURE_2D, 0, compact? GL_DEPTH_COMPONENT24: GL_DEPTH_COMPONENT32F, size.x, size.y, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
 			bufferAttachments[n] = GL_DEPTH_ATTACHMENT;
 		} else {
-			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+			// normals are written as (n + 1) * 0.5 with alpha 1, which 10:10:10:2 keeps exact
+			const GLint intFormat = (compact && n == ATTACHMENT_NORMTEX)? GL_RGB10_A2: GL_RGBA;
+
+			glTexImage2D(GL_TEXTURE_2D, 0, intFormat, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
 			bufferAttachments[n] = GL_COLOR_ATTACHMENT0 + n;
 		}
 	}
 
 	// sic; Mesa complains about an incomplete FBO if calling Bind before TexImage (?)
 	for (buffer.Bind(); n > 0; n--) {
+		if (bufferTextureIDs[n - 1] == 0)
+			continue;
+
 		buffer.AttachTexture(bufferTextureIDs[n - 1], GL_TEXTURE_2D, bufferAttachments[n - 1]);
 	}
 
@@ -51,11 +51,8 @@ namespace GL {
 		}
 
 		void ClearDeathDependencies() {
-			// modified by DeleteDeathDependence
-			const auto& listeningObjs = GetListening(DEPENDENCE_LIGHT);
-
-			while (!listeningObjs.empty()) {
-				DeleteDeathDependence(listeningObjs.back(), DEPENDENCE_LIGHT);
+			for (CObject* obj = nullptr; (obj = GetListening(DEPENDENCE_LIGHT)) != nullptr; ) {
+				DeleteDeathDependence(obj, DEPENDENCE_LIGHT);
 			}
 		}
 
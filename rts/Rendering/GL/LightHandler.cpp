@@ -3,6 +3,8 @@
 #include "myGL.h"
 #include "LightHandler.h"
 #include "Game/GlobalUnsynced.h"
+#include "Map/ReadMap.h"
+#include "Rendering/GlobalRendering.h"
 #include "Rendering/Shaders/Shader.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/LosHandler.h"
@@ -14,6 +16,58 @@ void GL::LightHandler::Init(unsigned int cfgMaxLights) {
 	for (unsigned int i = 0; i < maxLights; i++) {
 		glLights[i].SetID(GL_LIGHT0 + i);
 	}
+
+	if (maxLights == 0)
+		return;
+
+	{
+		GLint maxTexBufferSize = 0;
+
+		// NB: the spec only guarantees 64K texels
+		glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexBufferSize);
+
+		maxGridTexels = maxTexBufferSize;
+		maxLights = std::min(maxLights, maxGridTexels / unsigned(sizeof(RawLight) / sizeof(float4)));
+	}
+
+	gridSize.x = (mapDims.mapx * SQUARE_SIZE + LIGHT_GRID_CELL_SIZE - 1) / LIGHT_GRID_CELL_SIZE;
+	gridSize.y = (mapDims.mapy * SQUARE_SIZE + LIGHT_GRID_CELL_SIZE - 1) / LIGHT_GRID_CELL_SIZE;
+
+	lightGridParams = {1.0f / LIGHT_GRID_CELL_SIZE, 1.0f / LIGHT_GRID_CELL_SIZE, gridSize.x * 1.0f, gridSize.y * 1.0f};
+
+	gridLights.reserve(maxLights);
+	gridData.reserve(gridSize.x * gridSize.y + 1 + maxLights);
+
+	glGenBuffers(1, &lightDataBuffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, lightDataBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, maxLights * sizeof(RawLight), nullptr, GL_STREAM_DRAW);
+	glGenBuffers(1, &lightGridBuffer);
+	glBindBuffer(GL_TEXTURE_BUFFER, lightGridBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, (gridSize.x * gridSize.y + 1) * sizeof(int), nullptr, GL_STREAM_DRAW);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	glGenTextures(1, &lightDataTexture);
+	glBindTexture(GL_TEXTURE_BUFFER, lightDataTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lightDataBuffer);
+	glGenTextures(1, &lightGridTexture);
+	glBindTexture(GL_TEXTURE_BUFFER, lightGridTexture);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32I, lightGridBuffer);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void GL::LightHandler::Kill() {
+	if (lightDataTexture == 0)
+		return;
+
+	glDeleteTextures(1, &lightDataTexture);
+	glDeleteTextures(1, &lightGridTexture);
+	glDeleteBuffers(1, &lightDataBuffer);
+	glDeleteBuffers(1, &lightGridBuffer);
+
+	lightDataTexture = 0;
+	lightGridTexture = 0;
+	lightDataBuffer = 0;
+	lightGridBuffer = 0;
 }
 
 
@@ -23,14 +77,16 @@ unsigned int GL::LightHandler::AddLight(const GL::Light& light) {
 	if ((light.GetIntensityWeight()).SqLength() <= 0.01f)
 		return -1u;
 
-	const auto it = std::find_if(glLights.begin(), glLights.end(), [&](const GL::Light& lgt) { return (lgt.GetTTL() == 0); });
+	// slots beyond maxLights are never updated, so must not be handed out
+	const auto end = glLights.begin() + maxLights;
+	const auto it = std::find_if(glLights.begin(), end, [&](const GL::Light& lgt) { return (lgt.GetTTL() == 0); });
 
-	if (it == glLights.end()) {
+	if (it == end) {
 		// if all are claimed, find the lowest-priority light we can evict
 		unsigned int minPriorityValue = light.GetPriority();
 		unsigned int minPriorityIndex = -1u;
 
-		for (unsigned int n = 0; n < glLights.size(); n++) {
+		for (unsigned int n = 0; n < maxLights; n++) {
 			const GL::Light& lgt = glLights[n];
 
 			if (lgt.GetPriority() < minPriorityValue) {
@@ -80,6 +136,14 @@ GL::Light* GL::LightHandler::GetLight(unsigned int lgtHandle) {
 void GL::LightHandler::Update() {
 	assert(maxLights != 0);
 
+	// called whenever a ground or model shader is enabled, but
+	// tracked positions and visibility only change once per frame
+	if (lastUpdateFrame == globalRendering->drawFrame)
+		return;
+
+	lastUpdateFrame = globalRendering->drawFrame;
+	gridLights.clear();
+
 	// float3 sumWeight;
 	float3 maxWeight = OnesVector * 0.01f;
 
@@ -163,6 +227,21 @@ void GL::LightHandler::Update() {
 			rawLights[i].diffColor = weightedDiffuseCol;
 			rawLights[i].specColor = weightedSpecularCol;
 			rawLights[i].ambiColor = weightedAmbientCol;
+
+			#if (OGL_SPEC_ATTENUATION == 1)
+			// infinite falloff, light can reach every cell
+			gridLights.push_back({i, {0, 0}, {gridSize.x - 1, gridSize.y - 1}});
+			#else
+			const float lightRadius = light.GetRadius();
+
+			gridLights.push_back({i, {
+				Clamp(int((lightPos.x - lightRadius) * lightGridParams.x), 0, gridSize.x - 1),
+				Clamp(int((lightPos.z - lightRadius) * lightGridParams.y), 0, gridSize.y - 1),
+			}, {
+				Clamp(int((lightPos.x + lightRadius) * lightGridParams.x), 0, gridSize.x - 1),
+				Clamp(int((lightPos.z + lightRadius) * lightGridParams.y), 0, gridSize.y - 1),
+			}});
+			#endif
 		} else {
 			// zero contribution from this light if not in LOS
 			// (whether or not camera can see it is irrelevant
@@ -176,5 +255,71 @@ void GL::LightHandler::Update() {
 		rawLights[i].fovRadius = {light.GetFOV(), light.GetRadius(), light.GetRadius(), light.GetRadius()};
 		#endif
 	}
+
+	UpdateLightGrid();
+	UploadLightGrid();
+}
+
+
+void GL::LightHandler::UpdateLightGrid() {
+	const int numCells = gridSize.x * gridSize.y;
+	const int cellBase = numCells + 1;
+
+	unsigned int numIndices = 0;
+
+	gridData.clear();
+	gridData.resize(cellBase, 0);
+
+	// count the lights overlapping each cell; drop any that would
+	// no longer fit into the buffer-texture
+	for (size_t n = 0; n < gridLights.size(); ) {
+		const GridLight& gl = gridLights[n];
+		const unsigned int numLightCells = (gl.maxs.x - gl.mins.x + 1) * (gl.maxs.y - gl.mins.y + 1);
+
+		if ((cellBase + numIndices + numLightCells) > maxGridTexels) {
+			gridLights[n] = gridLights.back();
+			gridLights.pop_back();
+			continue;
+		}
+
+		for (int z = gl.mins.y; z <= gl.maxs.y; z++) {
+			for (int x = gl.mins.x; x <= gl.maxs.x; x++) {
+				gridData[z * gridSize.x + x] += 1;
+			}
+		}
+
+		numIndices += numLightCells;
+		n += 1;
+	}
+
+	// turn counts into end-offsets (relative to the start of the buffer)
+	gridData[0] += cellBase;
+
+	for (int c = 1; c < numCells; c++) {
+		gridData[c] += gridData[c - 1];
+	}
+
+	gridData[numCells] = cellBase + numIndices;
+	gridData.resize(cellBase + numIndices);
+
+	// fill back-to-front; afterwards each cell's offset is its begin
+	// and the next cell's offset its end
+	for (const GridLight& gl: gridLights) {
+		for (int z = gl.mins.y; z <= gl.maxs.y; z++) {
+			for (int x = gl.mins.x; x <= gl.maxs.x; x++) {
+				gridData[--gridData[z * gridSize.x + x]] = gl.index;
+			}
+		}
+	}
 }
 
+void GL::LightHandler::UploadLightGrid() {
+	glBindBuffer(GL_TEXTURE_BUFFER, lightDataBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, maxLights * sizeof(RawLight), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_TEXTURE_BUFFER, 0, maxLights * sizeof(RawLight), rawLights.data());
+
+	glBindBuffer(GL_TEXTURE_BUFFER, lightGridBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, gridData.size() * sizeof(int), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_TEXTURE_BUFFER, 0, gridData.size() * sizeof(int), gridData.data());
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+}
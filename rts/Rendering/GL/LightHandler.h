@@ -4,8 +4,10 @@
 #define _GL_LIGHTHANDLER_H
 
 #include <array>
+#include <vector>
 
 #include "Light.h"
+#include "System/type2.h"
 
 namespace Shader {
 	struct IProgramObject;
@@ -18,7 +20,7 @@ namespace GL {
 		~LightHandler() { Kill(); }
 
 		void Init(unsigned int);
-		void Kill() {}
+		void Kill();
 		void Update();
 
 		unsigned int AddLight(const GL::Light&);
@@ -32,11 +34,22 @@ namespace GL {
 		static constexpr unsigned int MaxConfigLights()       { return MAX_LIGHTS; }
 		                 unsigned int NumConfigLights() const { return  maxLights; }
 
-		static constexpr unsigned int MaxUniformVecs()       { return (MaxConfigLights() * (sizeof(RawLight) / sizeof(float))); }
-		                 unsigned int NumUniformVecs() const { return (NumConfigLights() * (sizeof(RawLight) / sizeof(float))); }
+		// shaders fetch lights through two buffer-textures: RawLight's
+		// as RGBA32F texels, and a map-space grid whose cells each hold
+		// a [begin, end) range into the list of overlapping light indices
+		unsigned int GetLightDataTexture() const { return lightDataTexture; }
+		unsigned int GetLightGridTexture() const { return lightGridTexture; }
+
+		// {1/cellSize, 1/cellSize, numCellsX, numCellsZ}
+		const float4& GetLightGridParams() const { return lightGridParams; }
+
+	private:
+		void UpdateLightGrid();
+		void UploadLightGrid();
 
 	private:
-		static constexpr unsigned int MAX_LIGHTS = 32;
+		static constexpr unsigned int MAX_LIGHTS = 1024;
+		static constexpr unsigned int LIGHT_GRID_CELL_SIZE = 256;
 
 		struct RawLight {
 			float4 worldPos;
@@ -50,8 +63,31 @@ namespace GL {
 		std::array<GL::Light, MAX_LIGHTS> glLights;
 		std::array<RawLight, MAX_LIGHTS> rawLights;
 
+		struct GridLight {
+			unsigned int index;
+
+			// inclusive cell-rectangle covered by the light
+			int2 mins;
+			int2 maxs;
+		};
+
+		std::vector<GridLight> gridLights;
+		// cell offsets followed by per-cell light indices
+		std::vector<int> gridData;
+
+		int2 gridSize;
+		float4 lightGridParams;
+
 		unsigned int maxLights;
 		unsigned int lightHandle;
+
+		unsigned int lightDataBuffer = 0;
+		unsigned int lightDataTexture = 0;
+		unsigned int lightGridBuffer = 0;
+		unsigned int lightGridTexture = 0;
+
+		unsigned int maxGridTexels = 0;
+		unsigned int lastUpdateFrame = -1u;
 	};
 }
 
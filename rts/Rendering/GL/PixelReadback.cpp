@@ -0,0 +1,116 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cassert>
+
+#include "PixelReadback.h"
+
+void GL::PixelReadbackRing::Init(unsigned int numSlots)
+{
+	Kill();
+
+	slots.resize(numSlots);
+}
+
+void GL::PixelReadbackRing::Kill()
+{
+	if (mapped)
+		PopFinished();
+
+	for (Slot& slot: slots) {
+		if (slot.fence != nullptr)
+			glDeleteSync(slot.fence);
+	}
+
+	// buffers are deleted along with their slots
+	slots.clear();
+
+	firstPending = 0;
+	numPending = 0;
+}
+
+
+bool GL::PixelReadbackRing::ReadPixels(int x, int y, int w, int h, GLenum format, GLenum type, size_t dataSize)
+{
+	if (slots.empty() || Full())
+		return false;
+
+	Slot& slot = slots[(firstPending + numPending) % slots.size()];
+
+	slot.buffer.Bind();
+	slot.buffer.New(dataSize, GL_STREAM_READ);
+
+	// with a pack-buffer bound the pointer argument is an offset into it
+	glReadPixels(x, y, w, h, format, type, nullptr);
+
+	slot.buffer.Unbind();
+	slot.dataSize = dataSize;
+
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	numPending += 1;
+	return true;
+}
+
+
+const GLubyte* GL::PixelReadbackRing::MapFinished(bool wait)
+{
+	assert(!mapped);
+
+	if (numPending == 0)
+		return nullptr;
+
+	Slot& slot = slots[firstPending];
+
+	if (slot.fence != nullptr) {
+		// flush once so the fence is guaranteed to signal eventually
+		const GLbitfield waitFlags = GL_SYNC_FLUSH_COMMANDS_BIT;
+		const GLuint64 waitTimeout = wait? GL_TIMEOUT_IGNORED: 0;
+
+		switch (glClientWaitSync(slot.fence, waitFlags, waitTimeout)) {
+			case GL_ALREADY_SIGNALED:
+			case GL_CONDITION_SATISFIED: {
+			} break;
+			case GL_TIMEOUT_EXPIRED: {
+				if (!wait)
+					return nullptr;
+			} break;
+			default: {
+				// GL_WAIT_FAILED; the mapping is unsynchronized, so wait here
+				glFinish();
+			} break;
+		}
+
+		glDeleteSync(slot.fence);
+		slot.fence = nullptr;
+	}
+
+	slot.buffer.Bind();
+
+	const GLubyte* data = slot.buffer.MapBuffer(0, slot.dataSize, GL_READ_ONLY);
+
+	if (data == nullptr) {
+		slot.buffer.UnmapBuffer();
+		slot.buffer.Unbind();
+
+		// drop the slot, otherwise it would block the ring forever
+		firstPending = (firstPending + 1) % slots.size();
+		numPending -= 1;
+		return nullptr;
+	}
+
+	mapped = true;
+	return data;
+}
+
+void GL::PixelReadbackRing::PopFinished()
+{
+	assert(mapped);
+
+	Slot& slot = slots[firstPending];
+
+	slot.buffer.UnmapBuffer();
+	slot.buffer.Unbind();
+
+	firstPending = (firstPending + 1) % slots.size();
+	numPending -= 1;
+	mapped = false;
+}
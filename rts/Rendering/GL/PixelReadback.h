@@ -0,0 +1,70 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PIXEL_READBACK_H
+#define PIXEL_READBACK_H
+
+#include <vector>
+
+#include "Rendering/GL/myGL.h"
+#include "Rendering/GL/VBO.h"
+
+namespace GL {
+	/**
+	 * @brief ring of pixel-pack buffers for asynchronous framebuffer reads
+	 *
+	 * ReadPixels only queues the copy into a buffer object (plus a fence),
+	 * so the CPU does not wait for the GPU to finish the frame. Results are
+	 * retrieved in order a few frames later via MapFinished, which does not
+	 * block unless asked to.
+	 */
+	struct PixelReadbackRing {
+	public:
+		PixelReadbackRing() = default;
+		PixelReadbackRing(const PixelReadbackRing&) = delete;
+		~PixelReadbackRing() { Kill(); }
+
+		PixelReadbackRing& operator = (const PixelReadbackRing&) = delete;
+
+		void Init(unsigned int numSlots);
+		void Kill();
+
+		/**
+		 * Queues a read of the given area of the current read-buffer
+		 * (dataSize bytes in the given format) into the next slot.
+		 * @return false if every slot is still pending
+		 */
+		bool ReadPixels(int x, int y, int w, int h, GLenum format, GLenum type, size_t dataSize);
+
+		/**
+		 * @return the pixels of the oldest pending read if the GPU has
+		 *         completed it (or wait is true), nullptr otherwise; a
+		 *         non-null pointer stays valid until PopFinished
+		 */
+		const GLubyte* MapFinished(bool wait);
+		void PopFinished();
+
+		bool Valid() const { return (!slots.empty()); }
+
+		unsigned int NumPending() const { return numPending; }
+		bool Full() const { return (numPending == slots.size()); }
+		bool Empty() const { return (numPending == 0); }
+
+	private:
+		struct Slot {
+			Slot(): buffer(GL_PIXEL_PACK_BUFFER) {}
+
+			VBO buffer;
+			GLsync fence = nullptr;
+			size_t dataSize = 0;
+		};
+
+		std::vector<Slot> slots;
+
+		unsigned int firstPending = 0;
+		unsigned int numPending = 0;
+
+		bool mapped = false;
+	};
+}
+
+#endif // PIXEL_READBACK_H
@@ -5,6 +5,7 @@
 
 #include "myGL.h"
 #include "RenderDataBuffer.hpp"
+#include "StreamBuffer.h"
 
 // global general-purpose buffers
 static GL::RenderDataBuffer gRenderBuffer0[2];
@@ -32,6 +33,13 @@ static GL::RenderDataBufferTC tRenderBufferTC[2];
 static GL::RenderDataBuffer2D0 tRenderBuffer2D0[2];
 static GL::RenderDataBuffer2DT tRenderBuffer2DT[2];
 
+// fences behind the draws from each half of the t* pairs, swapped along with them
+static GLsync tRenderBufferFences[2] = {nullptr, nullptr};
+
+// shared by CVertexArray; 3 segments, so up to 4MB per draw
+static constexpr size_t STREAM_BUFFER_SIZE = 12 * 1024 * 1024;
+static constexpr unsigned int STREAM_BUFFER_SEGMENTS = 3;
+
 
 GL::RenderDataBuffer0* GL::GetRenderBuffer0() { return &tRenderBuffer0[0 /*globalRendering->drawFrame & 1*/ ]; }
 GL::RenderDataBufferN* GL::GetRenderBufferN() { return &tRenderBufferN[0 /*globalRendering->drawFrame & 1*/ ]; }
@@ -93,6 +101,8 @@ void GL::InitRenderBuffers() {
 
 	#undef CREATE_SHADER
 	#undef SETUP_RBUFFER
+
+	GL::GetStreamBuffer()->Init(STREAM_BUFFER_SIZE, STREAM_BUFFER_SEGMENTS);
 }
 
 void GL::KillRenderBuffers() {
@@ -108,7 +118,14 @@ void GL::KillRenderBuffers() {
 
 		gRenderBuffer2D0[i].Kill();
 		gRenderBuffer2DT[i].Kill();
+
+		if (tRenderBufferFences[i] != nullptr)
+			glDeleteSync(tRenderBufferFences[i]);
+
+		tRenderBufferFences[i] = nullptr;
 	}
+
+	GL::GetStreamBuffer()->Kill();
 }
 
 void GL::SwapRenderBuffers() {
@@ -119,6 +136,17 @@ void GL::SwapRenderBuffers() {
 	tRenderBufferC[1 - (globalRendering->drawFrame & 1)].Reset();
 	tRenderBufferT[1 - (globalRendering->drawFrame & 1)].Reset();
 	#else
+	GL::StreamBuffer* streamBuffer = GL::GetStreamBuffer();
+
+	streamBuffer->AddStreamedBytes(tRenderBuffer0[0].NumBytes() + tRenderBufferN[0].NumBytes() + tRenderBufferC[0].NumBytes() + tRenderBufferT[0].NumBytes());
+	streamBuffer->AddStreamedBytes(tRenderBufferT4[0].NumBytes() + tRenderBufferTN[0].NumBytes() + tRenderBufferTC[0].NumBytes());
+	streamBuffer->AddStreamedBytes(tRenderBuffer2D0[0].NumBytes() + tRenderBuffer2DT[0].NumBytes());
+
+	// the buffers are persistently mapped; do not overwrite the ones drawn
+	// from last frame before the GPU is done with them
+	tRenderBufferFences[0] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	std::swap(tRenderBufferFences[0], tRenderBufferFences[1]);
 	std::swap(tRenderBuffer0[0], tRenderBuffer0[1]);
 	std::swap(tRenderBufferN[0], tRenderBufferN[1]);
 	std::swap(tRenderBufferC[0], tRenderBufferC[1]);
@@ -142,6 +170,14 @@ void GL::SwapRenderBuffers() {
 
 	tRenderBuffer2D0[0].Reset();
 	tRenderBuffer2DT[0].Reset();
+
+	if (tRenderBufferFences[0] != nullptr) {
+		streamBuffer->WaitFence(tRenderBufferFences[0]);
+		glDeleteSync(tRenderBufferFences[0]);
+	}
+
+	tRenderBufferFences[0] = nullptr;
+	streamBuffer->EndFrame();
 	#endif
 }
 
@@ -369,6 +405,17 @@ void GL::RenderDataBuffer::Submit(uint32_t primType, uint32_t dataIndx, uint32_t
 	array.Unbind();
 }
 
+void GL::RenderDataBuffer::SubmitMulti(uint32_t primType, const int32_t* dataIndcs, const int32_t* dataSizes, uint32_t numDraws) const {
+	assert(elems.GetSize() != 0);
+
+	array.Bind();
+
+	// dataIndcs[i] := first elem, dataSizes[i] := numElems of the i-th range
+	glMultiDrawArrays(primType, dataIndcs, dataSizes, numDraws);
+
+	array.Unbind();
+}
+
 void GL::RenderDataBuffer::SubmitInstanced(uint32_t primType, uint32_t dataIndx, uint32_t dataSize, uint32_t numInsts) const {
 	array.Bind();
 	glDrawArraysInstanced(primType, dataIndx, dataSize, numInsts);
@@ -299,6 +299,7 @@ namespace GL {
 		);
 
 		void Submit(uint32_t primType, uint32_t dataIndx, uint32_t dataSize) const;
+		void SubmitMulti(uint32_t primType, const int32_t* dataIndcs, const int32_t* dataSizes, uint32_t numDraws) const;
 		void SubmitInstanced(uint32_t primType, uint32_t dataIndx, uint32_t dataSize, uint32_t numInsts) const;
 		void SubmitIndexed(uint32_t primType, uint32_t dataIndx, uint32_t dataSize) const;
 		void SubmitIndexedInstanced(uint32_t primType, uint32_t dataIndx, uint32_t dataSize, uint32_t numInsts) const;
@@ -418,6 +419,7 @@ namespace GL {
 		}
 
 		void Reset() {}
+		void SetupStaging(VertexArrayType* elems, size_t numElems) {}
 
 
 		bool CheckSizeE(size_t ne) const { return false; }
@@ -440,6 +442,10 @@ namespace GL {
 
 		size_t NumElems() const { return 0; }
 		size_t NumIndcs() const { return 0; }
+		size_t NumFreeElems() const { return 0; }
+		size_t NumBytes() const { return 0; }
+
+		const VertexArrayType* GetPendingElems() const { return nullptr; }
 
 		GL::RenderDataBuffer* GetBuffer() { return rdb; }
 		Shader::IProgramObject* GetShader() { return &(rdb->GetShader()); }
@@ -465,6 +471,7 @@ namespace GL {
 
 			std::swap(elemsMap, trdb.elemsMap);
 			std::swap(indcsMap, trdb.indcsMap);
+			std::swap(numStagingElems, trdb.numStagingElems);
 
 			std::swap(prvElemPos, trdb.prvElemPos);
 			std::swap(curElemPos, trdb.curElemPos);
@@ -496,9 +503,23 @@ namespace GL {
 			curIndxPos = 0;
 		}
 
+		// redirect appends into caller-owned (unmapped) memory; such a buffer
+		// can be filled from any thread and has no indices, its contents are
+		// later copied into a regular one via Append(GetPendingElems(), ...)
+		void SetupStaging(VertexArrayType* elems, size_t numElems) {
+			rdb = nullptr;
+
+			elemsMap = elems;
+			indcsMap = nullptr;
+
+			numStagingElems = numElems;
+
+			Reset();
+		}
+
 
-		bool CheckSizeE(size_t ne) const { return ((curElemPos + (ne - 1)) < rdb->GetNumElems<VertexArrayType>()); }
-		bool CheckSizeI(size_t ni) const { return ((curIndxPos + (ni - 1)) < rdb->GetNumIndcs< IndexArrayType>()); }
+		bool CheckSizeE(size_t ne) const { return ((curElemPos + (ne - 1)) < MaxElems()); }
+		bool CheckSizeI(size_t ni) const { return (rdb != nullptr && (curIndxPos + (ni - 1)) < rdb->GetNumIndcs< IndexArrayType>()); }
 
 		void AssertSizeE(size_t ne) const { assert(CheckSizeE(ne)); }
 		void AssertSizeI(size_t ni) const { assert(CheckSizeI(ni)); }
@@ -539,16 +560,28 @@ namespace GL {
 
 		size_t NumElems() const { return (curElemPos - prvElemPos); }
 		size_t NumIndcs() const { return (curIndxPos - prvIndxPos); }
+		size_t NumFreeElems() const { return (MaxElems() - curElemPos); }
+		// everything appended since the last Reset
+		size_t NumBytes() const { return (curElemPos * sizeof(VertexArrayType) + curIndxPos * sizeof(IndexArrayType)); }
+
+		// elements appended since the last Submit
+		const VertexArrayType* GetPendingElems() const { return (elemsMap + prvElemPos); }
 
 		GL::RenderDataBuffer* GetBuffer() { return rdb; }
 		Shader::IProgramObject* GetShader() { return &(rdb->GetShader()); }
 
+	private:
+		size_t MaxElems() const { return ((rdb != nullptr)? rdb->GetNumElems<VertexArrayType>(): numStagingElems); }
+
 	private:
 		RenderDataBuffer* rdb = nullptr;
 
 		VertexArrayType* elemsMap = nullptr;
 		IndexArrayType* indcsMap = nullptr;
 
+		// capacity if this is a staging buffer (rdb is null)
+		size_t numStagingElems = 0;
+
 		// these must never exceed rdb->GetNum{Elems,Indcs}<{Vertex,Index}ArrayType>()
 		size_t prvElemPos = 0;
 		size_t curElemPos = 0;
@@ -0,0 +1,154 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cassert>
+
+#include "StreamBuffer.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+
+static GL::StreamBuffer gStreamBuffer;
+
+GL::StreamBuffer* GL::GetStreamBuffer() { return &gStreamBuffer; }
+
+
+bool GL::StreamBuffer::Init(size_t numBytes, unsigned int numSegments)
+{
+	Kill();
+
+	// a segment is never reused while the one before it is being written
+	assert(numSegments >= 3);
+
+	segmentSize = numBytes / numSegments;
+
+	buffer.Bind();
+
+	if (!buffer.New(segmentSize * numSegments)) {
+		// New unbinds on failure
+		return false;
+	}
+
+	mappedMem = buffer.MapBuffer(GL_WRITE_ONLY);
+
+	buffer.Unbind();
+
+	if (mappedMem == nullptr) {
+		LOG_L(L_WARNING, "[GL::StreamBuffer::%s] could not map %u bytes, falling back to client-side arrays", __func__, unsigned(segmentSize * numSegments));
+		return false;
+	}
+
+	fences.resize(numSegments, nullptr);
+
+	headPos = 0;
+	curSegment = 0;
+
+	curStats = {};
+	prvStats = {};
+	return true;
+}
+
+void GL::StreamBuffer::Kill()
+{
+	for (GLsync& fence: fences) {
+		if (fence != nullptr)
+			glDeleteSync(fence);
+
+		fence = nullptr;
+	}
+
+	fences.clear();
+
+	if (buffer.vboId != 0) {
+		buffer.UnmapIf();
+		buffer.Delete();
+	}
+
+	buffer = std::move(VBO(GL_ARRAY_BUFFER, true));
+	mappedMem = nullptr;
+}
+
+
+std::uint8_t* GL::StreamBuffer::Alloc(size_t numBytes, size_t align, size_t* offset)
+{
+	if (mappedMem == nullptr || numBytes == 0 || (numBytes + align) > segmentSize)
+		return nullptr;
+
+	size_t allocPos = (headPos + (align - 1)) & ~(align - 1);
+
+	if ((allocPos + numBytes) > buffer.GetSize()) {
+		// wrap around; the unused tail keeps its last fence
+		EnterSegment(0);
+		allocPos = 0;
+	}
+
+	for (const unsigned int lastSegment = (allocPos + numBytes - 1) / segmentSize; curSegment < lastSegment; ) {
+		EnterSegment(curSegment + 1);
+	}
+
+	headPos = allocPos + numBytes;
+	curStats.streamedBytes += numBytes;
+
+	*offset = allocPos;
+	return (mappedMem + allocPos);
+}
+
+void GL::StreamBuffer::EnterSegment(unsigned int segment)
+{
+	// everything drawn from the segment we leave has been submitted by now
+	if (fences[curSegment] != nullptr)
+		glDeleteSync(fences[curSegment]);
+
+	fences[curSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+	WaitFence(fences[segment]);
+	glDeleteSync(fences[segment]);
+
+	fences[segment] = nullptr;
+	curSegment = segment;
+}
+
+
+void GL::StreamBuffer::WaitFence(GLsync fence)
+{
+	if (fence == nullptr)
+		return;
+
+	// poll first, only an actual stall is counted
+	switch (glClientWaitSync(fence, 0, 0)) {
+		case GL_ALREADY_SIGNALED:
+		case GL_CONDITION_SATISFIED: {
+			return;
+		} break;
+		default: {
+		} break;
+	}
+
+	const spring_time t0 = spring_now();
+
+	switch (glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED)) {
+		case GL_WAIT_FAILED: {
+			// memory is written unsynchronized, so wait anyway
+			glFinish();
+		} break;
+		default: {
+		} break;
+	}
+
+	curStats.fenceWaits += 1;
+	curStats.fenceWaitTime += (spring_now() - t0).toMilliSecsf();
+}
+
+
+void GL::StreamBuffer::EndFrame()
+{
+	if (mappedMem != nullptr) {
+		// covers draws from the current segment issued after it was entered
+		if (fences[curSegment] != nullptr)
+			glDeleteSync(fences[curSegment]);
+
+		fences[curSegment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	}
+
+	prvStats = curStats;
+	prvStats.bufferBytes = buffer.GetSize();
+	curStats = {};
+}
@@ -0,0 +1,86 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef GL_STREAM_BUFFER_H
+#define GL_STREAM_BUFFER_H
+
+#include <cstdint>
+#include <vector>
+
+#include "Rendering/GL/myGL.h"
+#include "Rendering/GL/VBO.h"
+
+namespace GL {
+	/**
+	 * @brief persistently mapped ring for per-draw vertex data
+	 *
+	 * The buffer is split into equal segments which are written front to
+	 * back; a fence is placed behind every segment as soon as it is left
+	 * (and behind the current one at the end of each frame), and waited on
+	 * before the segment is written again. Nothing is orphaned or allocated
+	 * after Init, and only wrapping into a segment the GPU has not consumed
+	 * yet stalls the CPU.
+	 *
+	 * Alloc'ed memory is meant for immediate use: it must be drawn from
+	 * before the next Alloc call.
+	 */
+	struct StreamBuffer {
+	public:
+		struct Stats {
+			size_t streamedBytes = 0;
+			size_t bufferBytes = 0;
+
+			unsigned int fenceWaits = 0;
+			float fenceWaitTime = 0.0f; // milliseconds
+		};
+
+		StreamBuffer(): buffer(GL_ARRAY_BUFFER, true) {}
+		StreamBuffer(const StreamBuffer&) = delete;
+
+		StreamBuffer& operator = (const StreamBuffer&) = delete;
+
+		bool Init(size_t numBytes, unsigned int numSegments);
+		void Kill();
+
+		/**
+		 * @return pointer to numBytes of write-only memory, or nullptr if
+		 *         the ring is unavailable or numBytes exceeds one segment
+		 * @param offset receives the memory's byte-offset into GetId()
+		 */
+		std::uint8_t* Alloc(size_t numBytes, size_t align, size_t* offset);
+
+		/// fences the current segment and rolls the stats over into GetStats
+		void EndFrame();
+
+		/// lets the other persistently mapped buffers share the accounting
+		void AddStreamedBytes(size_t numBytes) { curStats.streamedBytes += numBytes; }
+		void WaitFence(GLsync fence);
+
+		bool IsValid() const { return (mappedMem != nullptr); }
+
+		GLuint GetId() const { return buffer.GetId(); }
+
+		/// totals of the last completed frame
+		const Stats& GetStats() const { return prvStats; }
+
+	private:
+		void EnterSegment(unsigned int segment);
+
+	private:
+		VBO buffer;
+
+		std::uint8_t* mappedMem = nullptr;
+		std::vector<GLsync> fences;
+
+		size_t segmentSize = 0;
+		size_t headPos = 0;
+
+		unsigned int curSegment = 0;
+
+		Stats curStats;
+		Stats prvStats;
+	};
+
+	StreamBuffer* GetStreamBuffer();
+}
+
+#endif // GL_STREAM_BUFFER_H
@@ -3,6 +3,7 @@
 #include <cstring>
 
 #include "VertexArray.h"
+#include "StreamBuffer.h"
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -198,16 +199,50 @@ void CVertexArray::DrawArraysCallback(const GLenum mode, const unsigned int stri
 // 
 //////////////////////////////////////////////////////////////////////
 
+const float* CVertexArray::BindStreamArray()
+{
+	GL::StreamBuffer* streamBuffer = GL::GetStreamBuffer();
+
+	const size_t numBytes = drawIndex() * sizeof(float);
+
+	size_t offset = 0;
+	std::uint8_t* mem = streamBuffer->Alloc(numBytes, sizeof(float) * 4, &offset);
+
+	// too large or no ring available, draw from client memory as before
+	if (mem == nullptr)
+		return drawArray;
+
+	memcpy(mem, drawArray, numBytes);
+	glBindBuffer(GL_ARRAY_BUFFER, streamBuffer->GetId());
+
+	// with a buffer bound the attribute pointers are offsets into it
+	return (reinterpret_cast<const float*>(offset));
+}
+
+void CVertexArray::UnbindStreamArray(const float* base) const
+{
+	if (base == drawArray)
+		return;
+
+	glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+
 void CVertexArray::DrawArray0(const int drawType, unsigned int stride)
 {
 	if (drawIndex() == 0)
 		return;
 
 	CheckEndStrip();
+
+	const float* base = BindStreamArray();
+
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
+	glVertexPointer(3, GL_FLOAT, stride, base);
 	DrawArrays(drawType, stride);
 	glDisableClientState(GL_VERTEX_ARRAY);
+
+	UnbindStreamArray(base);
 }
 
 void CVertexArray::DrawArray2d0(const int drawType, unsigned int stride)
@@ -216,10 +251,15 @@ void CVertexArray::DrawArray2d0(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+
+	const float* base = BindStreamArray();
+
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(2, GL_FLOAT, stride, drawArray);
+	glVertexPointer(2, GL_FLOAT, stride, base);
 	DrawArrays(drawType, stride);
 	glDisableClientState(GL_VERTEX_ARRAY);
+
+	UnbindStreamArray(base);
 }
 
 void CVertexArray::DrawArrayN(const int drawType, unsigned int stride)
@@ -228,13 +268,18 @@ void CVertexArray::DrawArrayN(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+
+	const float* base = BindStreamArray();
+
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glNormalPointer(GL_FLOAT, stride, drawArray + 3);
+	glVertexPointer(3, GL_FLOAT, stride, base);
+	glNormalPointer(GL_FLOAT, stride, base + 3);
 	DrawArrays(drawType, stride);
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_NORMAL_ARRAY);
+
+	UnbindStreamArray(base);
 }
 
 
@@ -244,13 +289,18 @@ void CVertexArray::DrawArrayC(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+
+	const float* base = BindStreamArray();
+
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_COLOR_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glColorPointer(4, GL_UNSIGNED_BYTE, stride, drawArray + 3);
+	glVertexPointer(3, GL_FLOAT, stride, base);
+	glColorPointer(4, GL_UNSIGNED_BYTE, stride, base + 3);
 	DrawArrays(drawType, stride);
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_COLOR_ARRAY);
+
+	UnbindStreamArray(base);
 }
 
 
@@ -260,13 +310,18 @@ void CVertexArray::DrawArrayT(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+
+	const float* base = BindStreamArray();
+
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 3);
+	glVertexPointer(3, GL_FLOAT, stride, base);
+	glTexCoordPointer(2, GL_FLOAT, stride, base + 3);
 	DrawArrays(drawType, stride);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
+
+	UnbindStreamArray(base);
 }
 
 
@@ -276,13 +331,18 @@ void CVertexArray::DrawArray2dT(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+
+	const float* base = BindStreamArray();
+
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(2, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 2);
+	glVertexPointer(2, GL_FLOAT, stride, base);
+	glTexCoordPointer(2, GL_FLOAT, stride, base + 2);
 	DrawArrays(drawType, stride);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
+
+	UnbindStreamArray(base);
 }
 
 
@@ -292,16 +352,21 @@ void CVertexArray::DrawArray2dTC(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+
+	const float* base = BindStreamArray();
+
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_COLOR_ARRAY);
-	glVertexPointer(2, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 2);
-	glColorPointer(4, GL_UNSIGNED_BYTE, stride, drawArray + 4);
+	glVertexPointer(2, GL_FLOAT, stride, base);
+	glTexCoordPointer(2, GL_FLOAT, stride, base + 2);
+	glColorPointer(4, GL_UNSIGNED_BYTE, stride, base + 4);
 	DrawArrays(drawType, stride);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_COLOR_ARRAY);
+
+	UnbindStreamArray(base);
 }
 
 
@@ -311,13 +376,18 @@ void CVertexArray::DrawArray2dT(const int drawType, StripCallback callback, void
 		return;
 
 	CheckEndStrip();
+
+	const float* base = BindStreamArray();
+
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
-	glVertexPointer(2, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 2);
+	glVertexPointer(2, GL_FLOAT, stride, base);
+	glTexCoordPointer(2, GL_FLOAT, stride, base + 2);
 	DrawArraysCallback(drawType, stride, callback, data);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
+
+	UnbindStreamArray(base);
 }
 
 
@@ -327,18 +397,23 @@ void CVertexArray::DrawArrayTN(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+
+	const float* base = BindStreamArray();
+
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
 
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 3);
-	glNormalPointer(GL_FLOAT, stride, drawArray + 5);
+	glVertexPointer(3, GL_FLOAT, stride, base);
+	glTexCoordPointer(2, GL_FLOAT, stride, base + 3);
+	glNormalPointer(GL_FLOAT, stride, base + 5);
 	DrawArrays(drawType, stride);
 
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_NORMAL_ARRAY);
+
+	UnbindStreamArray(base);
 }
 
 void CVertexArray::DrawArrayTNT(const int drawType, unsigned int stride)
@@ -348,6 +423,9 @@ void CVertexArray::DrawArrayTNT(const int drawType, unsigned int stride)
 
 	CheckEndStrip();
 
+	const float* base = BindStreamArray();
+
+
 	#define SET_ENABLE_ACTIVE_TEX(texUnit)            \
 		glClientActiveTexture(texUnit);               \
 		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
@@ -358,13 +436,13 @@ void CVertexArray::DrawArrayTNT(const int drawType, unsigned int stride)
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_NORMAL_ARRAY);
 
-	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE0); glTexCoordPointer(2, GL_FLOAT, stride, drawArray +  3);
-	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE1); glTexCoordPointer(2, GL_FLOAT, stride, drawArray +  3); // FIXME? (format-specific)
-	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE5); glTexCoordPointer(3, GL_FLOAT, stride, drawArray +  8);
-	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE6); glTexCoordPointer(3, GL_FLOAT, stride, drawArray + 11);
+	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE0); glTexCoordPointer(2, GL_FLOAT, stride, base +  3);
+	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE1); glTexCoordPointer(2, GL_FLOAT, stride, base +  3); // FIXME? (format-specific)
+	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE5); glTexCoordPointer(3, GL_FLOAT, stride, base +  8);
+	SET_ENABLE_ACTIVE_TEX(GL_TEXTURE6); glTexCoordPointer(3, GL_FLOAT, stride, base + 11);
 
-	glVertexPointer(3, GL_FLOAT, stride, drawArray + 0);
-	glNormalPointer(GL_FLOAT, stride, drawArray + 5);
+	glVertexPointer(3, GL_FLOAT, stride, base + 0);
+	glNormalPointer(GL_FLOAT, stride, base + 5);
 
 	DrawArrays(drawType, stride);
 
@@ -378,6 +456,8 @@ void CVertexArray::DrawArrayTNT(const int drawType, unsigned int stride)
 
 	#undef SET_ENABLE_ACTIVE_TEX
 	#undef SET_DISABLE_ACTIVE_TEX
+
+	UnbindStreamArray(base);
 }
 
 
@@ -387,16 +467,21 @@ void CVertexArray::DrawArrayTC(const int drawType, unsigned int stride)
 		return;
 
 	CheckEndStrip();
+
+	const float* base = BindStreamArray();
+
 	glEnableClientState(GL_TEXTURE_COORD_ARRAY);
 	glEnableClientState(GL_VERTEX_ARRAY);
 	glEnableClientState(GL_COLOR_ARRAY);
-	glVertexPointer(3, GL_FLOAT, stride, drawArray);
-	glTexCoordPointer(2, GL_FLOAT, stride, drawArray + 3);
-	glColorPointer(4, GL_UNSIGNED_BYTE, stride, drawArray + 5);
+	glVertexPointer(3, GL_FLOAT, stride, base);
+	glTexCoordPointer(2, GL_FLOAT, stride, base + 3);
+	glColorPointer(4, GL_UNSIGNED_BYTE, stride, base + 5);
 	DrawArrays(drawType, stride);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
 	glDisableClientState(GL_COLOR_ARRAY);
+
+	UnbindStreamArray(base);
 }
 
 
@@ -110,6 +110,11 @@ protected:
 	void EnlargeDrawArray();
 	inline void CheckEndStrip();
 
+	/// copies the vertices into the shared stream buffer and binds it,
+	/// returns the base (offset) for the gl*Pointer calls
+	const float* BindStreamArray();
+	void UnbindStreamArray(const float* base) const;
+
 protected:
 	float* drawArray;
 	float* drawArrayPos;
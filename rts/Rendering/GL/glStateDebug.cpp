@@ -16,6 +16,11 @@
 static spring::unordered_map<std::string, std::string> lastSet;
 static spring::unordered_set<std::string> errorsSet;
 
+// state changes made through the wrappers (by the main thread) during the current frame
+static unsigned int numStateChanges = 0;
+static unsigned int numTextureBinds = 0;
+static unsigned int numProgramBinds = 0;
+
 template<typename T, typename F>
 static void VERIFYGL(F func, GLenum pname, T defaultValue, std::string pstr, std::string area) {
 	if (errorsSet.find(area + pstr) == errorsSet.end()) {
@@ -66,6 +71,8 @@ static void VERIFYGL4(F func, GLenum pname, T default0, T default1, T default2,
 
 void _wrap_glEnable(GLenum pname, std::string pstr, std::string location)
 {
+	numStateChanges += Threading::IsMainThread();
+
 	if (Threading::IsMainThread())
 		lastSet[pstr] = location;
 
@@ -74,6 +81,8 @@ void _wrap_glEnable(GLenum pname, std::string pstr, std::string location)
 
 void _wrap_glDisable(GLenum pname, std::string pstr, std::string location)
 {
+	numStateChanges += Threading::IsMainThread();
+
 	if (Threading::IsMainThread())
 		lastSet[pstr] = location;
 
@@ -82,6 +91,8 @@ void _wrap_glDisable(GLenum pname, std::string pstr, std::string location)
 
 void _wrap_glBlendFunc(GLenum sfactor, GLenum dfactor, std::string location)
 {
+	numStateChanges += Threading::IsMainThread();
+
 	if (Threading::IsMainThread()) {
 		lastSet["GL_BLEND_SRC_RGB"] = location;
 		lastSet["GL_BLEND_SRC_ALPHA"] = location;
@@ -93,6 +104,8 @@ void _wrap_glBlendFunc(GLenum sfactor, GLenum dfactor, std::string location)
 
 void _wrap_glBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha, std::string location)
 {
+	numStateChanges += Threading::IsMainThread();
+
 	if (Threading::IsMainThread()) {
 		lastSet["GL_BLEND_SRC_RGB"] = location;
 		lastSet["GL_BLEND_SRC_ALPHA"] = location;
@@ -104,6 +117,8 @@ void _wrap_glBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GL
 
 void _wrap_glColor3f(GLfloat red, GLfloat green, GLfloat blue, std::string location)
 {
+	numStateChanges += Threading::IsMainThread();
+
 	if (Threading::IsMainThread())
 		lastSet["GL_CURRENT_COLOR"] = location;
 
@@ -112,6 +127,8 @@ void _wrap_glColor3f(GLfloat red, GLfloat green, GLfloat blue, std::string locat
 
 void _wrap_glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha, std::string location)
 {
+	numStateChanges += Threading::IsMainThread();
+
 	if (Threading::IsMainThread())
 		lastSet["GL_CURRENT_COLOR"] = location;
 
@@ -120,6 +137,8 @@ void _wrap_glColor4f(GLfloat red, GLfloat green, GLfloat blue, GLfloat alpha, st
 
 void _wrap_glColor4fv(const GLfloat *v, std::string location)
 {
+	numStateChanges += Threading::IsMainThread();
+
 	if (Threading::IsMainThread())
 		lastSet["GL_CURRENT_COLOR"] = location;
 
@@ -128,6 +147,8 @@ void _wrap_glColor4fv(const GLfloat *v, std::string location)
 
 void _wrap_glDepthMask(GLboolean flag, std::string location)
 {
+	numStateChanges += Threading::IsMainThread();
+
 	if (Threading::IsMainThread())
 		lastSet["GL_DEPTH_WRITEMASK"] = location;
 
@@ -137,6 +158,8 @@ void _wrap_glDepthMask(GLboolean flag, std::string location)
 
 void _wrap_glDepthFunc(GLenum func, std::string location)
 {
+	numStateChanges += Threading::IsMainThread();
+
 	if (Threading::IsMainThread())
 		lastSet["GL_DEPTH_FUNC"] = location;
 
@@ -145,12 +168,30 @@ void _wrap_glDepthFunc(GLenum func, std::string location)
 
 void _wrap_glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha, std::string location)
 {
+	numStateChanges += Threading::IsMainThread();
+
 	if (Threading::IsMainThread())
 		lastSet["GL_COLOR_WRITEMASK"] = location;
 
 	glColorMask(red, green, blue, alpha);
 }
 
+void _wrap_glBindTexture(GLenum target, GLuint texture, std::string location)
+{
+	numStateChanges += Threading::IsMainThread();
+	numTextureBinds += Threading::IsMainThread();
+
+	glBindTexture(target, texture);
+}
+
+void _wrap_glUseProgram(GLuint program, std::string location)
+{
+	numStateChanges += Threading::IsMainThread();
+	numProgramBinds += Threading::IsMainThread();
+
+	glUseProgram(program);
+}
+
 void CGLStateChecker::VerifyState(std::string area) {
 	if (Threading::IsMainThread()) {
 		std::string _area = area + " " + id;
@@ -198,4 +239,13 @@ CGLStateChecker::~CGLStateChecker()
 	VerifyState("exiting");
 }
 
+void CGLStateChecker::EndFrame(unsigned int frame)
+{
+	LOG_L(L_DEBUG, "[GLStateChecker] frame %u: %u state changes (%u texture binds, %u program binds)", frame, numStateChanges, numTextureBinds, numProgramBinds);
+
+	numStateChanges = 0;
+	numTextureBinds = 0;
+	numProgramBinds = 0;
+}
+
 #endif //DEBUG_GLSTATE
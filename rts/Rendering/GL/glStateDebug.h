@@ -5,6 +5,7 @@
 
 #ifndef DEBUG_GLSTATE
 #define GL_STATE_CHECKER(name)
+#define GL_STATE_CHECKER_END_FRAME(frame)
 #else
 
 #include <string>
@@ -13,6 +14,8 @@
 // GL_STATE_CHECKER(name) verifies the GL state has default values when entering/exiting its scope.
 // If something isn't set correctly, it logs an error with a mention of when the value was last set (TODO: deal with lists)
 #define GL_STATE_CHECKER(name) CGLStateChecker __gl_state_checker(name)
+// GL_STATE_CHECKER_END_FRAME(frame) logs (at debug level) how many state changes went through the wrappers below since the last call
+#define GL_STATE_CHECKER_END_FRAME(frame) CGLStateChecker::EndFrame(frame)
 
 #define STRINGIFY(x) #x
 #define TOSTRING(x) STRINGIFY(x)
@@ -48,6 +51,10 @@
 		#undef glDepthMask
 	#endif
 
+	#ifdef glUseProgram
+		#undef glUseProgram
+	#endif
+
 	#define glBlendFunc(sfactor, dfactor) _wrap_glBlendFunc(sfactor, dfactor, FILEPOS)
 	#define glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha) _wrap_glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha, FILEPOS)
 	#define glColor3f(r, g, b) _wrap_glColor3f(r, g, b, FILEPOS)
@@ -56,6 +63,8 @@
 	#define glDepthMask(flag) _wrap_glDepthMask(flag, FILEPOS)
 	#define glDepthFunc(func) _wrap_glDepthFunc(func, FILEPOS)
 	#define glColorMask(r, g, b, a) _wrap_glColorMask(r, g, b, a, FILEPOS)
+	#define glBindTexture(target, texture) _wrap_glBindTexture(target, texture, FILEPOS)
+	#define glUseProgram(program) _wrap_glUseProgram(program, FILEPOS)
 #endif
 
 
@@ -79,6 +88,10 @@ extern void _wrap_glDepthFunc(GLenum func, std::string location);
 
 extern void _wrap_glColorMask(GLboolean red, GLboolean green, GLboolean blue, GLboolean alpha, std::string location);
 
+extern void _wrap_glBindTexture(GLenum target, GLuint texture, std::string location);
+
+extern void _wrap_glUseProgram(GLuint program, std::string location);
+
 class CGLStateChecker
 {
 public:
@@ -86,6 +99,8 @@ public:
 	~CGLStateChecker();
 	const std::string id;
 
+	static void EndFrame(unsigned int frame);
+
 private:
 	void VerifyState(std::string area);
 };
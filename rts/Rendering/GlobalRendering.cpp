@@ -10,6 +10,7 @@
 #include "Rendering/VerticalSync.h"
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/FBO.h"
+#include "Rendering/GL/GLTimerProfiler.h"
 #include "Rendering/GL/RenderDataBuffer.hpp"
 #include "System/bitops.h"
 #include "System/EventHandler.h"
@@ -148,9 +149,7 @@ CR_REG_METADATA(CGlobalRendering, (
 	CR_IGNORED(borderless),
 
 	CR_IGNORED(sdlWindows),
-	CR_IGNORED(glContexts),
-
-	CR_IGNORED(glTimerQueries)
+	CR_IGNORED(glContexts)
 ))
 
 CGlobalRendering::CGlobalRendering()
@@ -244,7 +243,7 @@ CGlobalRendering::~CGlobalRendering()
 	verticalSync->WrapRemoveObserver();
 
 	GL::KillRenderBuffers();
-	glDeleteQueries(NUM_GL_TIMER_QUERIES * 2, &glTimerQueries[0]);
+	glTimerProfiler.Kill();
 
 	DestroyWindowAndContext(sdlWindows[0], glContexts[0]);
 	DestroyWindowAndContext(sdlWindows[1], glContexts[1]);
@@ -538,38 +537,7 @@ void CGlobalRendering::PostInit() {
 	ToggleGLDebugOutput(0, 0, 0);
 
 	GL::InitRenderBuffers();
-	glGenQueries(NUM_GL_TIMER_QUERIES * 2, &glTimerQueries[0]);
-}
-
-
-void CGlobalRendering::SetGLTimeStamp(uint32_t queryIdx) const
-{
-	glQueryCounter(glTimerQueries[(NUM_GL_TIMER_QUERIES * (drawFrame & 1)) + queryIdx], GL_TIMESTAMP);
-}
-
-uint64_t CGlobalRendering::CalcGLDeltaTime(uint32_t queryIdx0, uint32_t queryIdx1) const
-{
-	const uint32_t queryBase = NUM_GL_TIMER_QUERIES * (1 - (drawFrame & 1));
-
-	assert(queryIdx0 < NUM_GL_TIMER_QUERIES);
-	assert(queryIdx1 < NUM_GL_TIMER_QUERIES);
-	assert(queryIdx0 < queryIdx1);
-
-	GLuint64 t0 = 0;
-	GLuint64 t1 = 0;
-
-	GLint res = 0;
-
-	// results from the previous frame should already (or soon) be available
-	while (!res) {
-		glGetQueryObjectiv(glTimerQueries[queryBase + queryIdx1], GL_QUERY_RESULT_AVAILABLE, &res);
-	}
-
-	glGetQueryObjectui64v(glTimerQueries[queryBase + queryIdx0], GL_QUERY_RESULT, &t0);
-	glGetQueryObjectui64v(glTimerQueries[queryBase + queryIdx1], GL_QUERY_RESULT, &t1);
-
-	// nanoseconds between timestamps
-	return (t1 - t0);
+	glTimerProfiler.Init();
 }
 
 
@@ -592,6 +560,17 @@ void CGlobalRendering::SwapBuffers(bool allowSwapBuffers, bool clearErrors)
 	SDL_GL_SwapWindow(sdlWindows[0]);
 	eventHandler.DbgTimingInfo(TIMING_SWAP, pre, spring_now());
 
+	if (glTimerProfiler.IsEnabled()) {
+		SDL_DisplayMode dmode;
+		SDL_GetWindowDisplayMode(sdlWindows[0], &dmode);
+
+		const int swapInterval = std::abs(verticalSync->GetInterval());
+
+		glTimerProfiler.EndFrame((swapInterval != 0)? (dmode.refresh_rate / float(swapInterval)): 0.0f);
+	}
+
+	GL_STATE_CHECKER_END_FRAME(drawFrame);
+
 	// NB: this does not just count frames drawn by game
 	drawFrame += 1;
 }
@@ -635,6 +614,7 @@ void CGlobalRendering::CheckGLExtensions() const
 	CHECK_OPT_EXT(GLEW_ARB_multi_bind); // 4.4
 	#endif
 	CHECK_OPT_EXT(GLEW_ARB_texture_storage); // 4.2
+	CHECK_OPT_EXT(GLEW_ARB_timer_query); // 3.3 (GL_TIMESTAMP queries)
 	CHECK_OPT_EXT(GLEW_ARB_program_interface_query); // 4.3
 	CHECK_OPT_EXT(GLEW_EXT_direct_state_access); // 3.3 (core in 4.5)
 	CHECK_OPT_EXT(GLEW_ARB_invalidate_subdata); // 4.3 (glInvalidateBufferData)
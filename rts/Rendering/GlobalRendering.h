@@ -40,9 +40,6 @@ public:
 	void KillSDL() const;
 	void PostInit();
 
-	void SetGLTimeStamp(uint32_t queryIdx) const;
-	uint64_t CalcGLDeltaTime(uint32_t queryIdx0, uint32_t queryIdx1) const;
-
 	void SwapBuffers(bool allowSwapBuffers, bool clearErrors);
 
 	void MakeCurrentContext(bool hidden, bool secondary, bool clear);
@@ -102,9 +99,6 @@ public:
 	static const int minWinSizeX;
 	static const int minWinSizeY;
 
-	static constexpr unsigned int NUM_GL_TIMER_QUERIES = 2;
-	static constexpr unsigned int FRAME_TIME_QUERY_IDX = NUM_GL_TIMER_QUERIES - 1;
-
 public:
 	/**
 	 * @brief time offset
@@ -310,9 +304,6 @@ private:
 	// [0] := primary, [1] := secondary (hidden)
 	SDL_Window* sdlWindows[2];
 	SDL_GLContext glContexts[2];
-
-	// double-buffered; results from frame N become available on frame N+1
-	unsigned int glTimerQueries[NUM_GL_TIMER_QUERIES * 2];
 };
 
 extern CGlobalRendering* globalRendering;
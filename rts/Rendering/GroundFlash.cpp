@@ -3,10 +3,9 @@
 
 #include "GroundFlash.h"
 #include "Map/Ground.h"
-#include "Game/Camera.h"
 #include "Rendering/GlobalRendering.h"
+#include "Rendering/GroundFlashDecals.h"
 #include "Rendering/GroundFlashInfo.h"
-#include "Rendering/GL/RenderDataBuffer.hpp"
 #include "Rendering/Textures/ColorMap.h"
 #include "Rendering/Textures/TextureAtlas.h"
 #include "Rendering/Env/Particles/ProjectileDrawer.h"
@@ -33,8 +32,6 @@ CR_REG_METADATA(CStandardGroundFlash, (
 		CR_MEMBER(color),
 	CR_MEMBER_ENDFLAG(CM_Config),
 
-	CR_MEMBER(side1),
-	CR_MEMBER(side2),
 	CR_MEMBER(circleSize),
 	CR_MEMBER(flashAge),
 	CR_MEMBER(flashAgeSpeed),
@@ -44,8 +41,6 @@ CR_REG_METADATA(CStandardGroundFlash, (
 
 CR_BIND_DERIVED(CSeismicGroundFlash, CGroundFlash, (ZeroVector, 1, 0, 1, 1, 1, ZeroVector))
 CR_REG_METADATA(CSeismicGroundFlash, (
-	CR_MEMBER(side1),
-	CR_MEMBER(side2),
 	CR_MEMBER(texture),
 	CR_MEMBER(sizeGrowth),
 	CR_MEMBER(alpha),
@@ -56,8 +51,6 @@ CR_REG_METADATA(CSeismicGroundFlash, (
 
 CR_BIND_DERIVED(CSimpleGroundFlash, CGroundFlash, )
 CR_REG_METADATA(CSimpleGroundFlash, (
-	CR_MEMBER(side1),
-	CR_MEMBER(side2),
 	CR_MEMBER(age),
 	CR_MEMBER(agerate),
  	CR_MEMBER_BEGINFLAG(CM_Config),
@@ -88,29 +81,6 @@ CGroundFlash::CGroundFlash(const float3& _pos): CExpGenSpawnable()
 	pos = _pos;
 }
 
-float3 CGroundFlash::CalcNormal(const float3 midPos, const float3 camDir, float quadSize) const
-{
-	// no degenerate quads, otherwise ANormalize() fails
-	// assert(quadSize > 1.0f);
-	quadSize = std::max(quadSize, 1.0f);
-
-	float3 p0 = float3(midPos.x + quadSize, 0.0f, midPos.z           );
-	float3 p1 = float3(midPos.x - quadSize, 0.0f, midPos.z           );
-	float3 p2 = float3(midPos.x,            0.0f, midPos.z + quadSize);
-	float3 p3 = float3(midPos.x,            0.0f, midPos.z - quadSize);
-
-	p0.y = CGround::GetApproximateHeight(p0.x, p0.z, false); p0 += camDir;
-	p1.y = CGround::GetApproximateHeight(p1.x, p1.z, false); p1 += camDir;
-	p2.y = CGround::GetApproximateHeight(p2.x, p2.z, false); p2 += camDir;
-	p3.y = CGround::GetApproximateHeight(p3.x, p3.z, false); p3 += camDir;
-
-	const float3 n0 = ((p2 - p0).cross(p3 - p0)).ANormalize();
-	const float3 n1 = ((p3 - p1).cross(p2 - p1)).ANormalize();
-
-	return ((n0 + n1).ANormalize());
-}
-
-
 bool CGroundFlash::GetMemberInfo(SExpGenSpawnableMemberInfo& memberInfo)
 {
 	if (CExpGenSpawnable::GetMemberInfo(memberInfo))
@@ -196,11 +166,6 @@ void CStandardGroundFlash::InitCommon(const float3& _pos, const float3& _color)
 
 	// flashSize is just backward compability
 	size = flashSize;
-
-	const float3 normal = CalcNormal(_pos, camera->GetDir() * -1000.0f, flashSize);
-
-	side1 = (normal.cross(RgtVector)).ANormalize();
-	side2 = side1.cross(normal);
 }
 
 bool CStandardGroundFlash::Update()
@@ -212,7 +177,7 @@ bool CStandardGroundFlash::Update()
 	return (std::max(--ttl, 0) > 0);
 }
 
-void CStandardGroundFlash::Draw(GL::RenderDataBufferTC* va) const
+void CStandardGroundFlash::Draw(CGroundFlashDecals* decals) const
 {
 	float iAlpha = Clamp(circleAlpha - (circleAlphaDec * globalRendering->timeOffset), 0.0f, 1.0f);
 
@@ -220,17 +185,10 @@ void CStandardGroundFlash::Draw(GL::RenderDataBufferTC* va) const
 	const float iAge = flashAge + flashAgeSpeed * globalRendering->timeOffset;
 
 	if (iAlpha > 0.0f) {
-		const float3 p1 = pos + (-side1 - side2) * iSize;
-		const float3 p2 = pos + ( side1 - side2) * iSize;
-		const float3 p3 = pos + ( side1 + side2) * iSize;
-		const float3 p4 = pos + (-side1 + side2) * iSize;
-
+		const AtlasedTexture* tex = projectileDrawer->groundringtex;
 		const SColor c = {color.r, color.g, color.b, uint8_t(iAlpha * 255)};
 
-		va->SafeAppend({p1, projectileDrawer->groundringtex->xstart, projectileDrawer->groundringtex->ystart, c});
-		va->SafeAppend({p2, projectileDrawer->groundringtex->xend,   projectileDrawer->groundringtex->ystart, c});
-		va->SafeAppend({p3, projectileDrawer->groundringtex->xend,   projectileDrawer->groundringtex->yend,   c});
-		va->SafeAppend({p4, projectileDrawer->groundringtex->xstart, projectileDrawer->groundringtex->yend,   c});
+		decals->Add(pos, iSize, {tex->xstart, tex->ystart, tex->xend, tex->yend}, c);
 	}
 
 	if (iAge < 1.0f) {
@@ -240,17 +198,11 @@ void CStandardGroundFlash::Draw(GL::RenderDataBufferTC* va) const
 			iAlpha = flashAlpha * (1.0f - iAge);
 		}
 
-		const float3 p1 = pos + (-side1 - side2) * size;
-		const float3 p2 = pos + ( side1 - side2) * size;
-		const float3 p3 = pos + ( side1 + side2) * size;
-		const float3 p4 = pos + (-side1 + side2) * size;
-
+		// flash texture is drawn upside down
+		const AtlasedTexture* tex = projectileDrawer->groundflashtex;
 		const SColor c = {color.r, color.g, color.b, uint8_t(Clamp(iAlpha, 0.0f, 1.0f) * 255)};
 
-		va->SafeAppend({p1, projectileDrawer->groundflashtex->xstart, projectileDrawer->groundflashtex->yend,   c});
-		va->SafeAppend({p2, projectileDrawer->groundflashtex->xend,   projectileDrawer->groundflashtex->yend,   c});
-		va->SafeAppend({p3, projectileDrawer->groundflashtex->xend,   projectileDrawer->groundflashtex->ystart, c});
-		va->SafeAppend({p4, projectileDrawer->groundflashtex->xstart, projectileDrawer->groundflashtex->ystart, c});
+		decals->Add(pos, size, {tex->xstart, tex->yend, tex->xend, tex->ystart}, c);
 	}
 }
 
@@ -289,28 +241,15 @@ void CSimpleGroundFlash::Init(const CUnit* owner, const float3& offset)
 	age = ttl ? 0.0f : 1.0f;
 	agerate = ttl ? 1.0f / ttl : 1.0f;
 
-	const float3 normal = CalcNormal(pos, camera->GetDir() * -1000.0f, size + (sizeGrowth * ttl));
-
-	side1 = (normal.cross(RgtVector)).ANormalize();
-	side2 = side1.cross(normal);
-
 	projectileHandler->AddGroundFlash(this);
 }
 
-void CSimpleGroundFlash::Draw(GL::RenderDataBufferTC* va) const
+void CSimpleGroundFlash::Draw(CGroundFlashDecals* decals) const
 {
 	unsigned char color[4] = {0, 0, 0, 0};
 	colorMap->GetColor(color, age);
 
-	const float3 p1 = pos + (-side1 - side2) * size;
-	const float3 p2 = pos + ( side1 - side2) * size;
-	const float3 p3 = pos + ( side1 + side2) * size;
-	const float3 p4 = pos + (-side1 + side2) * size;
-
-	va->SafeAppend({p1, texture->xstart, texture->ystart, color});
-	va->SafeAppend({p2, texture->xend,   texture->ystart, color});
-	va->SafeAppend({p3, texture->xend,   texture->yend,   color});
-	va->SafeAppend({p4, texture->xstart, texture->yend,   color});
+	decals->Add(pos, size, {texture->xstart, texture->ystart, texture->xend, texture->yend}, color);
 }
 
 bool CSimpleGroundFlash::Update()
@@ -363,30 +302,17 @@ CSeismicGroundFlash::CSeismicGroundFlash(
 	size = _size;
 	alwaysVisible = true;
 
-	const float3 normal = CalcNormal(_pos, camera->GetDir() * -1000.0f, size + (sizeGrowth * ttl));
-
-	side1 = (normal.cross(RgtVector)).SafeANormalize();
-	side2 = side1.cross(normal);
-
 	projectileHandler->AddGroundFlash(this);
 }
 
-void CSeismicGroundFlash::Draw(GL::RenderDataBufferTC* va) const
+void CSeismicGroundFlash::Draw(CGroundFlashDecals* decals) const
 {
-	const float3 p1 = pos + (-side1 - side2) * size;
-	const float3 p2 = pos + ( side1 - side2) * size;
-	const float3 p3 = pos + ( side1 + side2) * size;
-	const float3 p4 = pos + (-side1 + side2) * size;
-
 	// start alpha-fading when ttl drops below fade
 	constexpr uint8_t maxAlpha = 255;
 	const     uint8_t ttlAlpha = maxAlpha * (ttl / (1.0f * fade));
 	const     uint8_t curAlpha = mix(maxAlpha, ttlAlpha, ttl < fade);
 
-	va->SafeAppend({p1, texture->xstart, texture->ystart, {color.r, color.g, color.b, curAlpha}});
-	va->SafeAppend({p2, texture->xend,   texture->ystart, {color.r, color.g, color.b, curAlpha}});
-	va->SafeAppend({p3, texture->xend,   texture->yend,   {color.r, color.g, color.b, curAlpha}});
-	va->SafeAppend({p4, texture->xstart, texture->yend,   {color.r, color.g, color.b, curAlpha}});
+	decals->Add(pos, size, {texture->xstart, texture->ystart, texture->xend, texture->yend}, {color.r, color.g, color.b, curAlpha});
 }
 
 bool CSeismicGroundFlash::Update()
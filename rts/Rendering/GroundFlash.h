@@ -3,7 +3,6 @@
 #ifndef GROUND_FLASH_H
 #define GROUND_FLASH_H
 
-#include "Rendering/GL/RenderDataBufferFwd.hpp"
 #include "Sim/Projectiles/ExpGenSpawnable.h"
 #include "Sim/Projectiles/ExplosionGenerator.h"
 #include "System/Color.h"
@@ -11,7 +10,7 @@
 struct AtlasedTexture;
 struct GroundFlashInfo;
 class CColorMap;
-class CVertexArray;
+class CGroundFlashDecals;
 
 class CGroundFlash : public CExpGenSpawnable
 {
@@ -22,13 +21,11 @@ public:
 	CGroundFlash();
 
 	virtual ~CGroundFlash() {}
-	virtual void Draw(GL::RenderDataBufferTC* va) const {}
+	virtual void Draw(CGroundFlashDecals* decals) const {}
 	/// @return false when it should be deleted
 	virtual bool Update() { return false; }
 	virtual void Init(const CUnit* owner, const float3& offset) {}
 
-	float3 CalcNormal(const float3 midPos, const float3 camDir, float quadSize) const;
-
 protected:
 	static bool GetMemberInfo(SExpGenSpawnableMemberInfo& memberInfo);
 
@@ -59,15 +56,12 @@ public:
 
 	void InitCommon(const float3& _pos, const float3& _color);
 
-	void Draw(GL::RenderDataBufferTC* va) const override;
+	void Draw(CGroundFlashDecals* decals) const override;
 	bool Update() override;
 
 	static bool GetMemberInfo(SExpGenSpawnableMemberInfo& memberInfo);
 
 private:
-	float3 side1;
-	float3 side2;
-
 	int ttl;
 
 	float flashSize;
@@ -95,15 +89,12 @@ public:
 	CSimpleGroundFlash();
 
 	void Init(const CUnit* owner, const float3& offset) override;
-	void Draw(GL::RenderDataBufferTC* va) const override;
+	void Draw(CGroundFlashDecals* decals) const override;
 	bool Update() override;
 
 	static bool GetMemberInfo(SExpGenSpawnableMemberInfo& memberInfo);
 
 private:
-	float3 side1;
-	float3 side2;
-
 	float sizeGrowth;
 	int ttl;
 	float age, agerate;
@@ -133,14 +124,11 @@ public:
 		const float3& _color
 	);
 
-	void Draw(GL::RenderDataBufferTC* va) const override;
+	void Draw(CGroundFlashDecals* decals) const override;
 	/// @return false when it should be deleted
 	bool Update() override;
 
 private:
-	float3 side1;
-	float3 side2;
-
 	AtlasedTexture* texture;
 
 	float sizeGrowth;
@@ -0,0 +1,149 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <cstdio>
+#include <vector>
+
+#include "GroundFlashDecals.h"
+#include "Game/Camera.h"
+#include "Map/HeightMapTexture.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/Matrix44f.h"
+
+void CGroundFlashDecals::Init()
+{
+	{
+		// shared instance geometry, a [-1,1]^2 grid of GRID_QUADS^2 quads
+		std::vector<VA_TYPE_2d0> verts;
+		verts.reserve(GRID_QUADS * GRID_QUADS * 6);
+
+		const auto AddVert = [&](unsigned int i, unsigned int j) {
+			verts.push_back({(i * 2.0f) / GRID_QUADS - 1.0f, (j * 2.0f) / GRID_QUADS - 1.0f});
+		};
+
+		for (unsigned int j = 0; j < GRID_QUADS; j++) {
+			for (unsigned int i = 0; i < GRID_QUADS; i++) {
+				AddVert(i    , j    ); AddVert(i + 1, j    ); AddVert(i + 1, j + 1);
+				AddVert(i + 1, j + 1); AddVert(i    , j + 1); AddVert(i    , j    );
+			}
+		}
+
+		gridBuffer.Init();
+		gridBuffer.Upload2D0(verts.size(), 0, verts.data(), nullptr);
+	}
+	{
+		char vsBuf[65536];
+		char fsBuf[65536];
+		char defBuf[256];
+
+		std::snprintf(defBuf, sizeof(defBuf), "#define MAX_DECALS %u\n#define SQUARE_SIZE %d.0\n", MAX_DECALS, SQUARE_SIZE);
+
+		const char* vsVars =
+			"uniform vec4 u_decal_pos_size[MAX_DECALS];\n"
+			"uniform vec4 u_decal_tex_rect[MAX_DECALS];\n"
+			"uniform vec4 u_decal_color[MAX_DECALS];\n"
+			"uniform vec4 u_height_params;\n" // {texSizeX, texSizeY, haveTex, yOffset}
+			"uniform sampler2D u_height_tex;\n"
+			"out vec2 v_texcoor_st;\n"
+			"out vec4 v_color_rgba;\n"
+			"float GetHeight(vec2 xz) {\n"
+			"\t// corner heights, so the texel grid lines up with world squares\n"
+			"\tvec2 uv = clamp(xz / SQUARE_SIZE, vec2(0.0), u_height_params.xy - 1.0);\n"
+			"\tivec2 i0 = ivec2(floor(uv));\n"
+			"\tivec2 i1 = min(i0 + 1, ivec2(u_height_params.xy) - 1);\n"
+			"\tvec2 f = uv - vec2(i0);\n"
+			"\tfloat h00 = texelFetch(u_height_tex, ivec2(i0.x, i0.y), 0).r;\n"
+			"\tfloat h10 = texelFetch(u_height_tex, ivec2(i1.x, i0.y), 0).r;\n"
+			"\tfloat h01 = texelFetch(u_height_tex, ivec2(i0.x, i1.y), 0).r;\n"
+			"\tfloat h11 = texelFetch(u_height_tex, ivec2(i1.x, i1.y), 0).r;\n"
+			"\treturn (mix(mix(h00, h10, f.x), mix(h01, h11, f.x), f.y));\n"
+			"}\n";
+		const char* vsCode =
+			"\tvec4 posSize = u_decal_pos_size[gl_InstanceID];\n"
+			"\tvec4 texRect = u_decal_tex_rect[gl_InstanceID];\n"
+			"\tvec3 vertexPos = vec3(posSize.x + a_vertex_xy.x * posSize.w, posSize.y, posSize.z + a_vertex_xy.y * posSize.w);\n"
+			"\tif (u_height_params.z > 0.0)\n"
+			"\t\tvertexPos.y = GetHeight(vertexPos.xz) + u_height_params.w;\n"
+			"\tgl_Position = u_proj_mat * u_movi_mat * vec4(vertexPos, 1.0);\n"
+			"\tv_vertex_xy = a_vertex_xy;\n"
+			"\tv_texcoor_st = vec2(mix(texRect.x, texRect.z, 0.5 - 0.5 * a_vertex_xy.y), mix(texRect.y, texRect.w, 0.5 + 0.5 * a_vertex_xy.x));\n"
+			"\tv_color_rgba = u_decal_color[gl_InstanceID];\n";
+		const char* fsVars =
+			"in vec2 v_texcoor_st;\n"
+			"in vec4 v_color_rgba;\n";
+		const char* fsCode = "\tf_color_rgba = texture(u_tex0, v_texcoor_st) * v_color_rgba;\n";
+
+		GL::RenderDataBuffer::FormatShader2D0(vsBuf, vsBuf + sizeof(vsBuf), defBuf, vsVars, vsCode, "VS");
+		GL::RenderDataBuffer::FormatShader2D0(fsBuf, fsBuf + sizeof(fsBuf), defBuf, fsVars, fsCode, "FS");
+
+		Shader::GLSLShaderObject shaderObjs[2] = {{GL_VERTEX_SHADER, &vsBuf[0], ""}, {GL_FRAGMENT_SHADER, &fsBuf[0], ""}};
+
+		shader = gridBuffer.CreateShader((sizeof(shaderObjs) / sizeof(shaderObjs[0])), 0, &shaderObjs[0], nullptr);
+		shader->Enable();
+		shader->SetUniformMatrix4x4<const char*, float>("u_movi_mat", false, CMatrix44f::Identity());
+		shader->SetUniformMatrix4x4<const char*, float>("u_proj_mat", false, CMatrix44f::Identity());
+		shader->SetUniform("u_tex0", 0);
+		shader->SetUniform("u_height_tex", 1);
+		shader->Disable();
+	}
+
+	numDecals = 0;
+}
+
+void CGroundFlashDecals::Kill()
+{
+	gridBuffer.Kill();
+
+	shader = nullptr;
+	numDecals = 0;
+}
+
+
+void CGroundFlashDecals::Enable()
+{
+	const bool haveHeightTex = (heightMapTexture != nullptr && heightMapTexture->GetTextureID() != 0);
+
+	if (haveHeightTex) {
+		glActiveTexture(GL_TEXTURE1);
+		glBindTexture(GL_TEXTURE_2D, heightMapTexture->GetTextureID());
+		glActiveTexture(GL_TEXTURE0);
+	}
+
+	shader->Enable();
+	shader->SetUniformMatrix4x4<const char*, float>("u_movi_mat", false, camera->GetViewMatrix());
+	shader->SetUniformMatrix4x4<const char*, float>("u_proj_mat", false, camera->GetProjectionMatrix());
+
+	if (haveHeightTex) {
+		shader->SetUniform("u_height_params", heightMapTexture->GetSizeX() * 1.0f, heightMapTexture->GetSizeY() * 1.0f, 1.0f, 1.0f);
+	} else {
+		// decals stay flat at the height their flash was spawned at
+		shader->SetUniform("u_height_params", 1.0f, 1.0f, 0.0f, 0.0f);
+	}
+
+	numDecals = 0;
+}
+
+void CGroundFlashDecals::Disable()
+{
+	Flush();
+	shader->Disable();
+
+	glActiveTexture(GL_TEXTURE1);
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glActiveTexture(GL_TEXTURE0);
+}
+
+
+void CGroundFlashDecals::Flush()
+{
+	if (numDecals == 0)
+		return;
+
+	// always the whole arrays, short ones are only cache-compared on their first element
+	shader->SetUniform4v<const char*, float>("u_decal_pos_size", MAX_DECALS, posSizes);
+	shader->SetUniform4v<const char*, float>("u_decal_tex_rect", MAX_DECALS, texRects);
+	shader->SetUniform4v<const char*, float>("u_decal_color", MAX_DECALS, colors);
+
+	gridBuffer.SubmitInstanced(GL_TRIANGLES, 0, gridBuffer.GetNumElems<VA_TYPE_2d0>(), numDecals);
+
+	numDecals = 0;
+}
@@ -0,0 +1,65 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef GROUND_FLASH_DECALS_H
+#define GROUND_FLASH_DECALS_H
+
+#include "Rendering/GL/RenderDataBuffer.hpp"
+#include "System/Color.h"
+#include "System/float4.h"
+
+/**
+ * @brief instanced terrain decals for ground-flashes
+ *
+ * Decals are collected in a fixed-capacity ring of per-decal arrays
+ * (center and half-size, atlas rectangle, color) which map directly
+ * onto the uniform arrays the shader indexes by gl_InstanceID. Every
+ * decal is drawn as a small grid whose vertices are lifted onto the
+ * terrain by sampling the heightmap texture, so nothing is projected
+ * on the CPU. The ring is drawn as one batch whenever it fills up and
+ * on Flush.
+ */
+class CGroundFlashDecals {
+public:
+	static constexpr unsigned int MAX_DECALS = 64;
+	static constexpr unsigned int GRID_QUADS = 8;
+
+	void Init();
+	void Kill();
+
+	void Enable();
+	void Disable();
+
+	/**
+	 * @param texRect atlas coordinates at the decal's (-x,+z) and
+	 *        (+x,-z) corners, i.e. {s0, t0, s1, t1}
+	 */
+	void Add(const float3& pos, float size, const float4& texRect, const SColor& color) {
+		if (numDecals == MAX_DECALS)
+			Flush();
+
+		float* ps = &posSizes[numDecals * 4];
+		float* tr = &texRects[numDecals * 4];
+		float* cs = &colors[numDecals * 4];
+
+		ps[0] = pos.x; ps[1] = pos.y; ps[2] = pos.z; ps[3] = size;
+		tr[0] = texRect.x; tr[1] = texRect.y; tr[2] = texRect.z; tr[3] = texRect.w;
+		cs[0] = color.r * (1.0f / 255.0f); cs[1] = color.g * (1.0f / 255.0f);
+		cs[2] = color.b * (1.0f / 255.0f); cs[3] = color.a * (1.0f / 255.0f);
+
+		numDecals += 1;
+	}
+
+	void Flush();
+
+private:
+	GL::RenderDataBuffer gridBuffer;
+	Shader::IProgramObject* shader = nullptr;
+
+	float posSizes[MAX_DECALS * 4];
+	float texRects[MAX_DECALS * 4];
+	float colors[MAX_DECALS * 4];
+
+	unsigned int numDecals = 0;
+};
+
+#endif // GROUND_FLASH_DECALS_H
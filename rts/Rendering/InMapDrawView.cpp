@@ -2,12 +2,16 @@
 
 
 #include "InMapDrawView.h"
+
+#include <algorithm>
+
 #include "Rendering/Colors.h"
 #include "Rendering/Fonts/glFont.h"
 #include "Rendering/GL/VertexArray.h"
 #include "Rendering/GlobalRendering.h"
 
 #include "Game/Camera.h"
+#include "Game/GlobalUnsynced.h"
 #include "Game/InMapDrawModel.h"
 #include "Map/ReadMap.h"
 #include "Sim/Misc/TeamHandler.h"
@@ -112,6 +116,9 @@ struct InMapDraw_QuadDrawer: public CReadMap::IQuadDrawer
 	CVertexArray* pointsVa;
 	CVertexArray* linesVa;
 	std::vector<const CInMapDrawModel::MapPoint*>* visibleLabels;
+	const CInMapDrawView::TeamMarkState* teamMarkStates;
+
+	bool drawAllMarks;
 
 	void ResetState() {
 		pointsVa = nullptr;
@@ -120,6 +127,14 @@ struct InMapDraw_QuadDrawer: public CReadMap::IQuadDrawer
 	void DrawQuad(int x, int y);
 
 private:
+	// equivalent to MapDrawPrimitive::IsVisibleToPlayer, minus the per-mark alliance lookups
+	bool IsVisible(const CInMapDrawModel::MapDrawPrimitive& p) const {
+		return (drawAllMarks || (!p.IsBySpectator() && teamMarkStates[p.GetTeamID()].visible));
+	}
+	const unsigned char* GetColor(const CInMapDrawModel::MapDrawPrimitive& p) const {
+		return (p.IsBySpectator()? color4::white: teamMarkStates[p.GetTeamID()].color);
+	}
+
 	void DrawPoint(const CInMapDrawModel::MapPoint* point) const;
 	void DrawLine(const CInMapDrawModel::MapLine* line) const;
 };
@@ -132,7 +147,7 @@ void InMapDraw_QuadDrawer::DrawPoint(const CInMapDrawModel::MapPoint* point) con
 	const float3 dir2 = (dif.cross(dir1));
 
 
-	const unsigned char* color = point->IsBySpectator() ? color4::white : teamHandler->Team(point->GetTeamID())->color;
+	const unsigned char* color = GetColor(*point);
 	const unsigned char col[4] = {
 		color[0],
 		color[1],
@@ -166,7 +181,7 @@ void InMapDraw_QuadDrawer::DrawPoint(const CInMapDrawModel::MapPoint* point) con
 
 void InMapDraw_QuadDrawer::DrawLine(const CInMapDrawModel::MapLine* line) const
 {
-	const unsigned char* color = line->IsBySpectator() ? color4::white : teamHandler->Team(line->GetTeamID())->color;
+	const unsigned char* color = GetColor(*line);
 	linesVa->AddVertexQC(line->GetPos1() - (line->GetPos1() - camera->GetPos()).ANormalize() * 26, color);
 	linesVa->AddVertexQC(line->GetPos2() - (line->GetPos2() - camera->GetPos()).ANormalize() * 26, color);
 }
@@ -175,27 +190,50 @@ void InMapDraw_QuadDrawer::DrawQuad(int x, int y)
 {
 	const CInMapDrawModel::DrawQuad* dq = inMapDrawerModel->GetDrawQuad(x, y);
 
-	pointsVa->EnlargeArrays(dq->points.size() * 12, 0, VA_SIZE_TC);
-	//! draw point markers
-	for (const CInMapDrawModel::MapPoint& pi: dq->points) {
-		if (pi.IsVisibleToPlayer(inMapDrawerModel->GetAllMarksVisible())) {
-			DrawPoint(&pi);
+	if (!dq->points.empty()) {
+		pointsVa->EnlargeArrays(dq->points.size() * 12, 0, VA_SIZE_TC);
+		//! draw point markers
+		for (const CInMapDrawModel::MapPoint& pi: dq->points) {
+			if (IsVisible(pi)) {
+				DrawPoint(&pi);
+			}
 		}
 	}
 
-	linesVa->EnlargeArrays(dq->lines.size() * 2, 0, VA_SIZE_C);
-	//! draw line markers
-	for (const CInMapDrawModel::MapLine& li: dq->lines) {
-		if (li.IsVisibleToPlayer(inMapDrawerModel->GetAllMarksVisible())) {
-			DrawLine(&li);
+	if (!dq->lines.empty()) {
+		linesVa->EnlargeArrays(dq->lines.size() * 2, 0, VA_SIZE_C);
+		//! draw line markers
+		for (const CInMapDrawModel::MapLine& li: dq->lines) {
+			if (IsVisible(li)) {
+				DrawLine(&li);
+			}
 		}
 	}
 }
 
 
 
+void CInMapDrawView::UpdateTeamMarkStates()
+{
+	for (int teamID = 0, numTeams = std::min(teamHandler->ActiveTeams(), MAX_TEAMS); teamID < numTeams; teamID++) {
+		const int allyTeam = teamHandler->AllyTeam(teamID);
+
+		const bool alliedAB = teamHandler->Ally(allyTeam, gu->myAllyTeam);
+		const bool alliedBA = teamHandler->Ally(gu->myAllyTeam, allyTeam);
+
+		teamMarkStates[teamID].color = teamHandler->Team(teamID)->color;
+		teamMarkStates[teamID].visible = (alliedAB && alliedBA);
+	}
+}
+
 void CInMapDrawView::Draw()
 {
+	// nothing to draw; skip the grid traversal and state changes
+	if (inMapDrawerModel->GetNumPoints() == 0 && inMapDrawerModel->GetNumLines() == 0)
+		return;
+
+	UpdateTeamMarkStates();
+
 	CVertexArray* pointsVa = GetVertexArray();
 	pointsVa->Initialize();
 	CVertexArray* linesVa = GetVertexArray();
@@ -205,6 +243,8 @@ void CInMapDrawView::Draw()
 	drawer.linesVa = linesVa;
 	drawer.pointsVa = pointsVa;
 	drawer.visibleLabels = &visibleLabels;
+	drawer.teamMarkStates = &teamMarkStates[0];
+	drawer.drawAllMarks = (gu->spectating || inMapDrawerModel->GetAllMarksVisible());
 
 	glDepthMask(0);
 	glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
@@ -239,8 +279,7 @@ void CInMapDrawView::Draw()
 			float3 pos = point->GetPos();
 			pos.y += 111.0f;
 
-			const CTeam* team = teamHandler->Team(point->GetTeamID());
-			const unsigned char* color = point->IsBySpectator() ? color4::white : team->color;
+			const unsigned char* color = point->IsBySpectator() ? color4::white : teamMarkStates[point->GetTeamID()].color;
 
 			font->SetTextColor(color[0] / 255.0f, color[1] / 255.0f, color[2] / 255.0f, 1.0f); //FIXME (overload!)
 			font->glWorldPrint(pos, 26.0f, point->GetLabel());
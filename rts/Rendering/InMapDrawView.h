@@ -3,11 +3,13 @@
 #ifndef IN_MAP_DRAW_VIEW_H
 #define IN_MAP_DRAW_VIEW_H
 
+#include <array>
 #include <string>
 #include <vector>
 
 #include "System/float3.h"
 #include "Game/InMapDrawModel.h"
+#include "Sim/Misc/GlobalConstants.h"
 
 /**
  * The V in MVC for InMapDraw.
@@ -22,9 +24,20 @@ public:
 
 	void Draw();
 
+	/// per-team visibility and color of non-spectator marks, resolved once per frame
+	struct TeamMarkState {
+		const unsigned char* color;
+		bool visible;
+	};
+
+private:
+	void UpdateTeamMarkStates();
+
 private:
 	unsigned int texture;
 
+	std::array<TeamMarkState, MAX_TEAMS> teamMarkStates;
+
 	std::vector<const CInMapDrawModel::MapPoint*> visibleLabels;
 };
 
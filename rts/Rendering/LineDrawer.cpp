@@ -2,6 +2,7 @@
 
 #include "LineDrawer.h"
 
+#include <algorithm>
 #include <cmath>
 
 #include "Rendering/GL/myGL.h"
@@ -13,6 +14,19 @@
 CLineDrawer lineDrawer;
 
 
+static void SubmitLines(GL::RenderDataBufferC* buffer, const std::vector<VA_TYPE_C>& verts)
+{
+	// clip to whole segments if the buffer can not hold all of them
+	const size_t size = std::min(verts.size(), buffer->NumFreeElems() & ~size_t(1));
+
+	if (size == 0)
+		return;
+
+	buffer->SafeAppend(verts.data(), size);
+	buffer->Submit(GL_LINES);
+}
+
+
 CLineDrawer::CLineDrawer()
 	: lineStipple(false)
 	, useColorRestarts(false)
@@ -22,9 +36,10 @@ CLineDrawer::CLineDrawer()
 	, lastPos(ZeroVector)
 	, restartColor(nullptr)
 	, lastColor(nullptr)
+	, stripVertex({ZeroVector, SColor(0, 0, 0, 0)})
 {
-	regularLines.reserve(32);
-	stippleLines.reserve(32);
+	regularLines.reserve(1024);
+	stippleLines.reserve(1024);
 }
 
 
@@ -53,23 +68,12 @@ void CLineDrawer::SetupLineStipple()
 
 void CLineDrawer::Restart()
 {
-	LinePair* ptr;
-	if (lineStipple) {
-		stippleLines.emplace_back();
-		ptr = &stippleLines.back();
-	} else {
-		regularLines.emplace_back();
-		ptr = &regularLines.back();
-	}
-	LinePair& p = *ptr;
-
-	if (!useColorRestarts)	 {
-		p.glType = GL_LINE_STRIP;
+	// color-restart lines are independent segments, nothing to remember
+	if (useColorRestarts)
+		return;
 
-		p.verts.push_back({lastPos, lastColor});
-	} else {
-		p.glType = GL_LINES;
-	}
+	// a new strip begins at the last (Break or StartPath) position
+	stripVertex = {lastPos, lastColor};
 }
 
 
@@ -93,28 +97,11 @@ void CLineDrawer::DrawAll(bool onMiniMap)
 	shader->SetUniformMatrix4x4<const char*, float>("u_proj_mat", false, camera->GetProjectionMatrix());
 	shader->SetUniformMatrix4x4<const char*, float>("u_movi_mat", false, camera->GetViewMatrix());
 
-	for (size_t i = 0, s = regularLines.size(); i < s; ++i) {
-		const size_t size = regularLines[i].verts.size();
-
-		// TODO: batch lines of equal type
-		if (size > 0) {
-			buffer->SafeAppend(regularLines[i].verts.data(), size);
-			buffer->Submit(regularLines[i].glType);
-		}
-	}
+	SubmitLines(buffer, regularLines);
 
 	if (!stippleLines.empty()) {
 		glEnable(GL_LINE_STIPPLE);
-
-		for (size_t i = 0, s = stippleLines.size(); i < s; ++i) {
-			const size_t size = stippleLines[i].verts.size();
-
-			if (size > 0) {
-				buffer->SafeAppend(stippleLines[i].verts.data(), size);
-				buffer->Submit(stippleLines[i].glType);
-			}
-		}
-
+		SubmitLines(buffer, stippleLines);
 		glDisable(GL_LINE_STIPPLE);
 	}
 
@@ -50,14 +50,14 @@ private:
 	const float* restartColor;
 	const float* lastColor;
 	
-	// queue all lines and draw them in one go later
-	struct LinePair {
-		unsigned int glType;
-		std::vector<VA_TYPE_C> verts;
-	};
-
-	std::vector<LinePair> regularLines;
-	std::vector<LinePair> stippleLines;
+	// last vertex of the current strip; strips are queued as GL_LINES
+	// segments so every path of the same stipple-state is drawn at once
+	VA_TYPE_C stripVertex;
+
+	// queue all lines and draw them in one go later; the vectors keep
+	// their capacity between frames
+	std::vector<VA_TYPE_C> regularLines;
+	std::vector<VA_TYPE_C> stippleLines;
 };
 
 
@@ -103,14 +103,14 @@ inline void CLineDrawer::StartPath(const float3& pos, const float* color)
 
 inline void CLineDrawer::DrawLine(const float3& endPos, const float* color)
 {
-	LinePair* ptr = (lineStipple)? &stippleLines.back(): &regularLines.back();
-	LinePair& p = *ptr;
+	std::vector<VA_TYPE_C>& verts = (lineStipple)? stippleLines: regularLines;
 
 	if (!useColorRestarts) {
-		p.verts.push_back({endPos, color});
+		verts.push_back(stripVertex);
+		verts.push_back(stripVertex = {endPos, color});
 	} else {
-		p.verts.push_back({lastPos, useRestartColor? restartColor: SColor{color[0], color[1], color[2], color[3] * restartAlpha}});
-		p.verts.push_back({endPos, color});
+		verts.push_back({lastPos, useRestartColor? restartColor: SColor{color[0], color[1], color[2], color[3] * restartAlpha}});
+		verts.push_back({endPos, color});
 	}
 
 	lastPos = endPos;
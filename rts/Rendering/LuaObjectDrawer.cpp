@@ -399,7 +399,7 @@ void LuaObjectDrawer::DrawMaterialBins(LuaObjType objType, LuaMatType matType, b
 }
 
 void LuaObjectDrawer::DrawMaterialBin(
-	const LuaMatBin* currBin,
+	LuaMatBin* currBin,
 	const LuaMaterial* prevMat,
 	LuaObjType objType,
 	LuaMatType matType,
@@ -415,6 +415,10 @@ void LuaObjectDrawer::DrawMaterialBin(
 	if (!binShader->ValidForPass(shaderPasses[deferredPass]))
 		return;
 
+	// objects of the same team then share one team-color upload
+	if (!alphaMatBin)
+		currBin->SortObjectsByTeam(objType);
+
 	// reset; also sort objects by team
 	binObjTeam = -1;
 
@@ -634,6 +638,21 @@ void LuaObjectDrawer::SetObjectLOD(CSolidObject* obj, LuaObjType objType, unsign
 	obj->localModel.SetLODCount(lodCount);
 }
 
+void LuaObjectDrawer::PrepareObjectLOD(CSolidObject* obj, LuaObjType objType, LuaMatType matType)
+{
+	LuaObjectMaterialData* matData = obj->GetLuaMaterialData();
+
+	if (!matData->Enabled())
+		return;
+
+	matData->UpdateCurrentLOD(objType, camera->ProjectedDistance(obj->pos), matType);
+}
+
+bool LuaObjectDrawer::AddPreparedMaterialObject(CSolidObject* obj, LuaObjType objType, LuaMatType matType)
+{
+	return ((obj->GetLuaMaterialData())->AddObjectForCurrentLOD(obj, objType, matType));
+}
+
 bool LuaObjectDrawer::AddObjectForLOD(CSolidObject* obj, LuaObjType objType, bool useAlphaMat, bool useShadowMat)
 {
 	if (useShadowMat)
@@ -40,6 +40,12 @@ public:
 	static bool AddAlphaMaterialObject(CSolidObject* obj, LuaObjType objType);
 	static bool AddShadowMaterialObject(CSolidObject* obj, LuaObjType objType);
 
+	// split variant of Add*MaterialObject; PrepareObjectLOD selects the LOD
+	// for the current pass and camera and may run concurrently for distinct
+	// objects, AddPreparedMaterialObject then only bins the object
+	static void PrepareObjectLOD(CSolidObject* obj, LuaObjType objType, LuaMatType matType);
+	static bool AddPreparedMaterialObject(CSolidObject* obj, LuaObjType objType, LuaMatType matType);
+
 	static void DrawOpaqueMaterialObjects(LuaObjType objType, bool deferredPass);
 	static void DrawAlphaMaterialObjects(LuaObjType objType, bool deferredPass);
 	static void DrawShadowMaterialObjects(LuaObjType objType, bool deferredPass);
@@ -72,7 +78,7 @@ public:
 private:
 	static void DrawMaterialBins(LuaObjType objType, LuaMatType matType, bool deferredPass);
 	static void DrawMaterialBin(
-		const LuaMatBin* currBin,
+		LuaMatBin* currBin,
 		const LuaMaterial* prevMat,
 		LuaObjType objType,
 		LuaMatType matType,
@@ -108,8 +114,8 @@ private:
 	static bool bufferClearAllowed;
 
 	// team of last object visited in DrawMaterialBin
-	// (needed because bins are not sorted by team and
-	// Lua shaders do not have any uniform caching yet)
+	// (needed because alpha-bins are not sorted by team
+	// and Lua shaders do not have any uniform caching yet)
 	static int binObjTeam;
 
 	static float LODScale[LUAOBJ_LAST];
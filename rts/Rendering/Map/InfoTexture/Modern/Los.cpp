@@ -21,6 +21,9 @@ constexpr VA_TYPE_0 VERTS[] = {
 CLosTexture::CLosTexture()
 : CPboInfoTexture("los")
 , uploadTex(0)
+, lastAllyTeam(-1)
+, lastGlobalLOS(false)
+, lastLosMapVersion(0)
 {
 	texSize = losHandler->los.size;
 	texChannels = 1;
@@ -141,8 +144,29 @@ void CLosTexture::UpdateCPU()
 }
 
 
+bool CLosTexture::IsUpdateNeeded()
+{
+	if (gu->myAllyTeam != lastAllyTeam)
+		return true;
+	if (losHandler->globalLOS[gu->myAllyTeam] != lastGlobalLOS)
+		return true;
+
+	return (losHandler->los.losMaps[gu->myAllyTeam].GetVersion() != lastLosMapVersion);
+}
+
+
 void CLosTexture::Update()
 {
+	const CLosMap& losMap = losHandler->los.losMaps[gu->myAllyTeam];
+
+	// only the rows changed since the last update need to be uploaded, unless the viewed map switched
+	const bool fullUpdate = (gu->myAllyTeam != lastAllyTeam || losHandler->globalLOS[gu->myAllyTeam] != lastGlobalLOS);
+	const int2 dirtyRows = fullUpdate? int2(0, texSize.y): losMap.GetDirtyRows(lastLosMapVersion);
+
+	lastAllyTeam = gu->myAllyTeam;
+	lastGlobalLOS = losHandler->globalLOS[gu->myAllyTeam];
+	lastLosMapVersion = losMap.GetVersion();
+
 	if (!fbo.IsValid() || !shader->IsValid() || uploadTex == 0)
 		return UpdateCPU();
 
@@ -160,12 +184,19 @@ void CLosTexture::Update()
 	}
 
 
+	if (dirtyRows.x == dirtyRows.y)
+		return;
+
+	const size_t rowsOffset = dirtyRows.x * texSize.x * texChannels * sizeof(uint16_t);
+	const size_t rowsSize = (dirtyRows.y - dirtyRows.x) * texSize.x * texChannels * sizeof(uint16_t);
+
 	infoTexPBO.Bind();
 
 	      uint8_t* infoTexMem = reinterpret_cast<uint8_t*>(infoTexPBO.MapBuffer());
-	const uint16_t* myLos = &losHandler->los.losMaps[gu->myAllyTeam].front();
+	const uint8_t* myLos = reinterpret_cast<const uint8_t*>(&losMap.front());
 
-	memcpy(infoTexMem, myLos, texSize.x * texSize.y * texChannels * sizeof(uint16_t));
+	// uploadTex keeps the rows that did not change
+	memcpy(infoTexMem + rowsOffset, myLos + rowsOffset, rowsSize);
 	infoTexPBO.UnmapBuffer();
 
 
@@ -173,7 +204,7 @@ void CLosTexture::Update()
 	// Faster than doing it on the CPU! And uploading it as shorts would be slow, cause the GPU
 	// has no native support for them and so the transformation would happen on the CPU, too.
 	glBindTexture(GL_TEXTURE_2D, uploadTex);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize.x, texSize.y, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
+	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, dirtyRows.x, texSize.x, dirtyRows.y - dirtyRows.x, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr(rowsOffset));
 	infoTexPBO.Invalidate();
 	infoTexPBO.Unbind();
 
@@ -20,7 +20,7 @@ public:
 
 public:
 	void Update() override;
-	bool IsUpdateNeeded() override { return true; }
+	bool IsUpdateNeeded() override;
 
 private:
 	void UpdateCPU();
@@ -29,6 +29,11 @@ private:
 	FBO fbo;
 	GLuint uploadTex;
 	Shader::IProgramObject* shader;
+
+	// state of the last update, the LOS maps only change during sim frames
+	int lastAllyTeam;
+	bool lastGlobalLOS;
+	unsigned int lastLosMapVersion;
 };
 
 #endif // _LOS_TEXTURE_H
@@ -24,6 +24,11 @@ CRadarTexture::CRadarTexture()
 : CPboInfoTexture("radar")
 , uploadTexRadar(0)
 , uploadTexJammer(0)
+, lastAllyTeam(-1)
+, lastGlobalLOS(false)
+, lastLosMapVersion(0)
+, lastRadarMapVersion(0)
+, lastJammerMapVersion(0)
 {
 	texSize = losHandler->radar.size;
 	texChannels = 2;
@@ -173,8 +178,39 @@ void CRadarTexture::UpdateCPU()
 }
 
 
+bool CRadarTexture::IsUpdateNeeded()
+{
+	if (gu->myAllyTeam != lastAllyTeam)
+		return true;
+	if (losHandler->globalLOS[gu->myAllyTeam] != lastGlobalLOS)
+		return true;
+
+	const int jammerAllyTeam = modInfo.separateJammers ? gu->myAllyTeam : 0;
+
+	// the jammer overlay is masked by (and sampled from) the los texture
+	if (losHandler->los.losMaps[gu->myAllyTeam].GetVersion() != lastLosMapVersion)
+		return true;
+	if (losHandler->radar.losMaps[gu->myAllyTeam].GetVersion() != lastRadarMapVersion)
+		return true;
+
+	return (losHandler->jammer.losMaps[jammerAllyTeam].GetVersion() != lastJammerMapVersion);
+}
+
+
 void CRadarTexture::Update()
 {
+	lastAllyTeam = gu->myAllyTeam;
+	lastGlobalLOS = losHandler->globalLOS[gu->myAllyTeam];
+	lastLosMapVersion = losHandler->los.losMaps[gu->myAllyTeam].GetVersion();
+	lastRadarMapVersion = losHandler->radar.losMaps[gu->myAllyTeam].GetVersion();
+	lastJammerMapVersion = losHandler->jammer.losMaps[modInfo.separateJammers ? gu->myAllyTeam : 0].GetVersion();
+
+	// sampled by the post-processing pass, and not guaranteed to be updated before us
+	CPboInfoTexture* losTex = static_cast<CPboInfoTexture*>(infoTextureHandler->GetInfoTexture("los"));
+
+	if (losTex->IsUpdateNeeded())
+		losTex->Update();
+
 	if (!fbo.IsValid() || !shader->IsValid() || uploadTexRadar == 0 || uploadTexJammer == 0)
 		return UpdateCPU();
 
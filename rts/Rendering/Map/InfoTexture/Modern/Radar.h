@@ -21,7 +21,7 @@ public:
 
 public:
 	void Update() override;
-	bool IsUpdateNeeded() override { return true; }
+	bool IsUpdateNeeded() override;
 
 private:
 	void UpdateCPU();
@@ -31,6 +31,13 @@ private:
 	GLuint uploadTexRadar;
 	GLuint uploadTexJammer;
 	Shader::IProgramObject* shader;
+
+	// state of the last update, the LOS maps only change during sim frames
+	int lastAllyTeam;
+	bool lastGlobalLOS;
+	unsigned int lastLosMapVersion;
+	unsigned int lastRadarMapVersion;
+	unsigned int lastJammerMapVersion;
 };
 
 #endif // _RADAR_TEXTURE_H
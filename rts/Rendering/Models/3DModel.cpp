@@ -210,6 +210,14 @@ void S3DModel::Draw() const
 	glBindVertexArray(0);
 }
 
+void S3DModel::DrawInstanced(unsigned int numInstances) const
+{
+	// per-instance transforms are fetched by the shader via gl_InstanceID
+	glBindVertexArray(vertexArray);
+	glDrawElementsInstanced(GL_TRIANGLES, vboNumIndcs, GL_UNSIGNED_INT, nullptr, numInstances);
+	glBindVertexArray(0);
+}
+
 void S3DModel::DrawPiece(const S3DModelPiece* omp) const
 {
 	assert(std::find_if(pieceObjects.cbegin(), pieceObjects.cend(), [&](const S3DModelPiece* p) { return (p == omp); }) != pieceObjects.cend());
@@ -598,7 +606,7 @@ void LocalModel::UpdateBoundingVolume()
 			// transform only the corners of the piece's bounding-box
 			const float3 pMins = piece->mins;
 			const float3 pMaxs = piece->maxs;
-			const float3 verts[8] = {
+			float3 verts[8] = {
 				// bottom
 				float3(pMins.x,  pMins.y,  pMins.z),
 				float3(pMaxs.x,  pMins.y,  pMins.z),
@@ -611,11 +619,11 @@ void LocalModel::UpdateBoundingVolume()
 				float3(pMins.x,  pMaxs.y,  pMaxs.z),
 			};
 
-			for (unsigned int k = 0; k < 8; k++) {
-				const float3 vertex = matrix * verts[k];
+			matrix.TransformPoints(verts, verts, 8);
 
-				bbMins = float3::min(bbMins, vertex);
-				bbMaxs = float3::max(bbMaxs, vertex);
+			for (unsigned int k = 0; k < 8; k++) {
+				bbMins = float3::min(bbMins, verts[k]);
+				bbMaxs = float3::max(bbMaxs, verts[k]);
 			}
 		#if 0
 		} else {
@@ -249,6 +249,7 @@ struct S3DModel
 	void DeletePieces();
 
 	void Draw() const;
+	void DrawInstanced(unsigned int numInstances) const;
 	void DrawPiece(const S3DModelPiece* omp) const;
 	void DrawPieceRec(const S3DModelPiece* omp) const;
 
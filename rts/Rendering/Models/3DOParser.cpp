@@ -147,7 +147,8 @@ S3DModel C3DOParser::Load(const std::string& name)
 		if (file.Read(fileBuf.data(), fileBuf.size()) == 0)
 			throw content_error("[3DOParser] failed to read model-file " + name);
 	} else {
-		fileBuf = std::move(file.GetBuffer());
+		const IArchive::FileView& fileView = file.GetFileView();
+		fileBuf.assign(fileView.data, fileView.data + fileView.size);
 	}
 
 	S3DModel model;
@@ -187,8 +187,16 @@ void CModelLoader::PreloadModel(const std::string& modelName)
 	if (!ThreadPool::HasThreads())
 		return;
 
-	if (cache.find(StringToLower(modelName)) != cache.end())
-		return;
+	{
+		const std::string lowerName = StringToLower(modelName);
+
+		std::lock_guard<spring::mutex> lock(mutex);
+
+		if (cache.find(lowerName) != cache.end())
+			return;
+		if (pendingModels.find(lowerName) != pendingModels.end())
+			return;
+	}
 
 	ThreadPool::Enqueue([modelName]() {
 		modelLoader.LoadModel(modelName, true);
@@ -202,30 +210,49 @@ S3DModel* CModelLoader::LoadModel(std::string name, bool preload)
 	if (name.empty())
 		return nullptr;
 
-	std::lock_guard<spring::mutex> lock(mutex);
-
 	StringToLowerInPlace(name);
 
-	std::string  path;
-	std::string* refs[2] = {&name, &path};
+	std::unique_lock<spring::mutex> lock(mutex);
 
 	// search in cache first
-	for (unsigned int n = 0; n < 2; n++) {
-		S3DModel* cachedModel = LoadCachedModel(*refs[n], preload);
+	S3DModel* cachedModel = LoadCachedModel(lock, name, preload);
+
+	if (cachedModel != nullptr)
+		return cachedModel;
+
+	// claim the name; parsing happens without holding the lock so
+	// that other models can be loaded concurrently, anyone asking
+	// for this one in the meantime waits instead of parsing it too
+	pendingModels.insert(name);
+	lock.unlock();
 
-		if (cachedModel != nullptr)
+	// expensive, delay until needed
+	const std::string path = FindModelPath(name);
+
+	lock.lock();
+
+	if (path != name) {
+		if ((cachedModel = LoadCachedModel(lock, path, preload)) != nullptr) {
+			cache[name] = cachedModel->id;
+
+			ReleasePendingModel(name, path);
 			return cachedModel;
+		}
 
-		// expensive, delay until needed
-		path = FindModelPath(name);
+		pendingModels.insert(path);
 	}
 
+	lock.unlock();
+
 	// not found in cache, create the model and cache it
-	return (CreateModel(name, path, preload));
+	return (CreateModel(lock, name, path, preload));
 }
 
-S3DModel* CModelLoader::LoadCachedModel(const std::string& name, bool preload)
+S3DModel* CModelLoader::LoadCachedModel(std::unique_lock<spring::mutex>& lock, const std::string& name, bool preload)
 {
+	// another thread might be parsing this model right now
+	pendingCond.wait(lock, [&]() { return (pendingModels.find(name) == pendingModels.end()); });
+
 	const auto ci = cache.find(name);
 
 	if (ci == cache.end())
@@ -242,11 +269,23 @@ S3DModel* CModelLoader::LoadCachedModel(const std::string& name, bool preload)
 
 
 S3DModel* CModelLoader::CreateModel(
+	std::unique_lock<spring::mutex>& lock,
 	const std::string& name,
 	const std::string& path,
 	bool preload
 ) {
-	S3DModel model = std::move(ParseModel(name, path));
+	assert(!lock.owns_lock());
+
+	S3DModel model;
+
+	try {
+		model = std::move(ParseModel(name, path));
+	} catch (...) {
+		// do not leave anyone waiting for a model that will never arrive
+		lock.lock();
+		ReleasePendingModel(name, path);
+		throw;
+	}
 
 	if (model.numPieces == 0)
 		model = std::move(CreateDummyModel());
@@ -254,8 +293,7 @@ S3DModel* CModelLoader::CreateModel(
 	assert(model.GetRootPiece() != nullptr);
 	model.SetPieceMatrices();
 
-	if (!preload)
-		UploadRenderData(&model);
+	lock.lock();
 
 	// add (parsed or dummy) model to cache
 	model.id = models.size();
@@ -265,9 +303,22 @@ S3DModel* CModelLoader::CreateModel(
 
 	models.emplace_back();
 	models.back() = std::move(model);
+
+	ReleasePendingModel(name, path);
+
+	if (!preload)
+		UploadRenderData(&(models.back()));
+
 	return &(models.back());
 }
 
+void CModelLoader::ReleasePendingModel(const std::string& name, const std::string& path)
+{
+	pendingModels.erase(name);
+	pendingModels.erase(path);
+	pendingCond.notify_all();
+}
+
 
 
 IModelParser* CModelLoader::GetFormatParser(const std::string& pathExt)
@@ -307,6 +358,13 @@ S3DModel CModelLoader::ParseModel(const std::string& name, const std::string& pa
 
 
 void CModelLoader::UploadRenderData(S3DModel* model) {
+	#ifdef HEADLESS
+	// sim-only build: piece hierarchy, offsets, vertex positions and
+	// collision volumes are all that is needed, skip buffer creation,
+	// shatter-piece generation and texture decoding
+	return;
+	#endif
+
 	if (model->UploadedBuffers())
 		return;
 
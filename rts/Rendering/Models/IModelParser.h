@@ -8,6 +8,7 @@
 
 #include "3DModel.h"
 #include "System/UnorderedMap.hpp"
+#include "System/UnorderedSet.hpp"
 #include "System/Threading/SpringThreading.h"
 
 
@@ -43,8 +44,10 @@ public:
 
 private:
 	S3DModel ParseModel(const std::string& name, const std::string& path);
-	S3DModel* CreateModel(const std::string& name, const std::string& path, bool preload);
-	S3DModel* LoadCachedModel(const std::string& name, bool preload);
+	S3DModel* CreateModel(std::unique_lock<spring::mutex>& lock, const std::string& name, const std::string& path, bool preload);
+	S3DModel* LoadCachedModel(std::unique_lock<spring::mutex>& lock, const std::string& name, bool preload);
+
+	void ReleasePendingModel(const std::string& name, const std::string& path);
 
 	IModelParser* GetFormatParser(const std::string& pathExt);
 
@@ -59,6 +62,10 @@ private:
 	ParserMap parsers;
 
 	spring::mutex mutex;
+	spring::condition_variable_any pendingCond;
+
+	// names and paths of models being parsed (without holding the mutex)
+	spring::unordered_set<std::string> pendingModels;
 
 	// all unique models loaded so far
 	std::deque<S3DModel> models;
@@ -25,29 +25,34 @@ S3DModel CS3OParser::Load(const std::string& name)
 	if (!file.FileExists())
 		throw content_error("[S3OParser] could not find model-file " + name);
 
+	// parsed directly from the VFS buffer, which is never written to
+	const unsigned char* fileData = file.GetFileView().data;
+
 	if (!file.IsBuffered()) {
 		fileBuf.resize(file.FileSize(), 0);
 		file.Read(fileBuf.data(), fileBuf.size());
-	} else {
-		fileBuf = std::move(file.GetBuffer());
+
+		fileData = fileBuf.data();
 	}
 
 	S3OHeader header;
-	memcpy(&header, fileBuf.data(), sizeof(header));
+	memcpy(&header, fileData, sizeof(header));
 	header.swap();
 
 	S3DModel model;
 		model.name = name;
 		model.type = MODELTYPE_S3O;
 		model.numPieces = 0;
-		model.texs[0] = (header.texture1 == 0)? "" : (char*) &fileBuf[header.texture1];
-		model.texs[1] = (header.texture2 == 0)? "" : (char*) &fileBuf[header.texture2];
+		model.texs[0] = (header.texture1 == 0)? "" : (const char*) &fileData[header.texture1];
+		model.texs[1] = (header.texture2 == 0)? "" : (const char*) &fileData[header.texture2];
 		model.mins = DEF_MIN_SIZE;
 		model.maxs = DEF_MAX_SIZE;
 
+	#ifndef HEADLESS
 	texturehandlerS3O->PreloadTexture(&model);
+	#endif
 
-	model.FlattenPieceTree(LoadPiece(&model, nullptr, fileBuf.data(), header.rootPiece));
+	model.FlattenPieceTree(LoadPiece(&model, nullptr, fileData, header.rootPiece));
 
 	// set after the extrema are known
 	model.radius = (header.radius <= 0.01f)? model.CalcDrawRadius(): header.radius;
@@ -57,16 +62,20 @@ S3DModel CS3OParser::Load(const std::string& name)
 	return model;
 }
 
-SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, unsigned char* buf, int offset)
+SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, const unsigned char* buf, int offset)
 {
 	model->numPieces++;
 
-	// retrieve piece data
-	Piece* fp = (Piece*)&buf[offset]; fp->swap();
-	Vertex* vertexList = reinterpret_cast<Vertex*>(&buf[fp->vertices]);
+	// retrieve piece data; copied since buf is read-only (and may be shared)
+	Piece pieceData;
+	memcpy(&pieceData, &buf[offset], sizeof(pieceData));
+	pieceData.swap();
 
-	const int* indexList = reinterpret_cast<int*>(&buf[fp->vertexTable]);
-	const int* childList = reinterpret_cast<int*>(&buf[fp->children]);
+	const Piece* fp = &pieceData;
+	const unsigned char* vertexList = &buf[fp->vertices];
+
+	const int* indexList = reinterpret_cast<const int*>(&buf[fp->vertexTable]);
+	const int* childList = reinterpret_cast<const int*>(&buf[fp->children]);
 
 	// create piece
 	SS3OPiece* piece = new SS3OPiece();
@@ -74,14 +83,18 @@ SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, unsigned ch
 		piece->offset.y = fp->yoffset;
 		piece->offset.z = fp->zoffset;
 		piece->primType = fp->primitiveType;
-		piece->name = (char*) &buf[fp->name];
+		piece->name = (const char*) &buf[fp->name];
 		piece->parent = parent;
 
 	// retrieve vertices
 	piece->SetVertexCount(fp->numVertices);
 	for (int a = 0; a < fp->numVertices; ++a) {
-		Vertex* v = (vertexList++);
-		v->swap();
+		Vertex vertexData;
+		memcpy(&vertexData, vertexList, sizeof(vertexData));
+		vertexData.swap();
+
+		const Vertex* v = &vertexData;
+		vertexList += sizeof(Vertex);
 
 		SS3OVertex sv;
 		sv.pos = float3(v->xpos, v->ypos, v->zpos);
@@ -104,7 +117,10 @@ SS3OPiece* CS3OParser::LoadPiece(S3DModel* model, SS3OPiece* parent, unsigned ch
 	{
 		piece->SetGlobalOffset(CMatrix44f::Identity());
 		piece->Trianglize();
+		#ifndef HEADLESS
+		// only needed for normal-mapping
 		piece->SetVertexTangents();
+		#endif
 		piece->SetMinMaxExtends();
 
 		model->mins = float3::min(piece->goffset + piece->mins, model->mins);
@@ -50,13 +50,14 @@ void QTPFSPathDrawer::DrawAll() const {
 }
 
 void QTPFSPathDrawer::DrawNodeTree(const MoveDef* md) const {
-	QTPFS::QTNode* nt = pm->nodeTrees[md->pathType];
+	const QTPFS::QTNode* nt = pm->nodeTrees[md->pathLayer];
+	const QTPFS::NodeLayer& nl = pm->nodeLayers[md->pathLayer];
 	CVertexArray* va = GetVertexArray();
 
 	std::vector<const QTPFS::QTNode*> nodes;
 	std::vector<const QTPFS::QTNode*>::const_iterator nodesIt;
 
-	GetVisibleNodes(nt, nodes);
+	GetVisibleNodes(nt, nl, nodes);
 
 	va->Initialize();
 	va->EnlargeArrays(nodes.size() * 4, 0, VA_SIZE_C);
@@ -74,38 +75,39 @@ void QTPFSPathDrawer::DrawNodeTree(const MoveDef* md) const {
 
 void QTPFSPathDrawer::DrawNodeTreeRec(
 	const QTPFS::QTNode* nt,
+	const QTPFS::NodeLayer& nl,
 	const MoveDef* md,
 	CVertexArray* va
 ) const {
 	if (nt->IsLeaf()) {
 		DrawNode(nt, md, va, false, true, false);
 	} else {
-		for (unsigned int i = 0; i < nt->children.size(); i++) {
-			const QTPFS::QTNode* n = nt->children[i];
+		for (unsigned int i = 0; i < QTNODE_CHILD_COUNT; i++) {
+			const QTPFS::QTNode* n = nt->GetChild(nl, i);
 			const float3 mins = float3(n->xmin() * SQUARE_SIZE, 0.0f, n->zmin() * SQUARE_SIZE);
 			const float3 maxs = float3(n->xmax() * SQUARE_SIZE, 0.0f, n->zmax() * SQUARE_SIZE);
 
 			if (!camera->InView(mins, maxs))
 				continue;
 
-			DrawNodeTreeRec(nt->children[i], md, va);
+			DrawNodeTreeRec(n, nl, md, va);
 		}
 	}
 }
 
-void QTPFSPathDrawer::GetVisibleNodes(const QTPFS::QTNode* nt, std::vector<const QTPFS::QTNode*>& nodes) const {
+void QTPFSPathDrawer::GetVisibleNodes(const QTPFS::QTNode* nt, const QTPFS::NodeLayer& nl, std::vector<const QTPFS::QTNode*>& nodes) const {
 	if (nt->IsLeaf()) {
 		nodes.push_back(nt);
 	} else {
-		for (unsigned int i = 0; i < nt->children.size(); i++) {
-			const QTPFS::QTNode* n = nt->children[i];
+		for (unsigned int i = 0; i < QTNODE_CHILD_COUNT; i++) {
+			const QTPFS::QTNode* n = nt->GetChild(nl, i);
 			const float3 mins = float3(n->xmin() * SQUARE_SIZE, 0.0f, n->zmin() * SQUARE_SIZE);
 			const float3 maxs = float3(n->xmax() * SQUARE_SIZE, 0.0f, n->zmax() * SQUARE_SIZE);
 
 			if (!camera->InView(mins, maxs))
 				continue;
 
-			GetVisibleNodes(nt->children[i], nodes);
+			GetVisibleNodes(n, nl, nodes);
 		}
 	}
 }
@@ -113,7 +115,7 @@ void QTPFSPathDrawer::GetVisibleNodes(const QTPFS::QTNode* nt, std::vector<const
 
 
 void QTPFSPathDrawer::DrawPaths(const MoveDef* md) const {
-	const QTPFS::PathCache& pathCache = pm->pathCaches[md->pathType];
+	const QTPFS::PathCache& pathCache = pm->pathCaches[md->pathLayer];
 	const QTPFS::PathCache::PathMap& paths = pathCache.GetLivePaths();
 
 	QTPFS::PathCache::PathMap::const_iterator pathsIt;
@@ -339,7 +341,7 @@ void QTPFSPathDrawer::UpdateExtraTexture(int extraTex, int starty, int endy, int
 			const MoveDef* md = GetSelectedMoveDef();
 
 			if (md != nullptr) {
-				const QTPFS::NodeLayer& nl = pm->nodeLayers[md->pathType];
+				const QTPFS::NodeLayer& nl = pm->nodeLayers[md->pathLayer];
 
 				const float smr = 1.0f / nl.GetMaxRelSpeedMod();
 				const bool los = (gs->cheatEnabled || gu->spectating);
@@ -14,6 +14,7 @@ namespace QTPFS {
 	class PathManager;
 
 	struct QTNode;
+	struct NodeLayer;
 	struct IPath;
 	struct PathSearch;
 
@@ -39,11 +40,12 @@ private:
 	void DrawNodeTree(const MoveDef* md) const;
 	void DrawNodeTreeRec(
 		const QTPFS::QTNode* nt,
+		const QTPFS::NodeLayer& nl,
 		const MoveDef* md,
 		CVertexArray* va
 	) const;
 
-	void GetVisibleNodes(const QTPFS::QTNode* nt, std::vector<const QTPFS::QTNode*>& nodes) const;
+	void GetVisibleNodes(const QTPFS::QTNode* nt, const QTPFS::NodeLayer& nl, std::vector<const QTPFS::QTNode*>& nodes) const;
 
 	void DrawPaths(const MoveDef* md) const;
 	void DrawPath(const QTPFS::IPath* path, CVertexArray* va) const;
@@ -2,9 +2,11 @@
 
 #include "Screenshot.h"
 
+#include <deque>
 #include <vector>
 
 #include "Rendering/GL/myGL.h"
+#include "Rendering/GL/PixelReadback.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/Textures/Bitmap.h"
 #include "System/StringUtil.h"
@@ -26,6 +28,10 @@ struct FunctionArgs
 	int y;
 };
 
+// screenshots whose pixels are still being read back, oldest first
+static std::deque<FunctionArgs> pendingShots;
+static GL::PixelReadbackRing shotReadbacks;
+
 void TakeScreenshot(std::string type)
 {
 	if (type.empty())
@@ -44,15 +50,50 @@ void TakeScreenshot(std::string type)
 	// note: we no longer increment the counter until a "file not found" occurs
 	// since that stalls the thread and might run concurrently with an IL write
 	args.filename.assign("screenshots/screen" + IntToString(shotCounter, "%05d") + "." + type);
-	args.pixelbuf.resize(args.x * args.y * 4);
 
 	configHandler->Set("ScreenshotCounter", shotCounter + 1);
 
-	glReadPixels(0, 0, args.x, args.y, GL_RGBA, GL_UNSIGNED_BYTE, &args.pixelbuf[0]);
+	// more shots in quick succession than there are slots; should be rare
+	if (shotReadbacks.Full())
+		FinishScreenshots(true);
+	if (!shotReadbacks.Valid())
+		shotReadbacks.Init(2);
+
+	// the pixels are fetched by FinishScreenshots once the GPU is done, not stalling this frame
+	shotReadbacks.ReadPixels(0, 0, args.x, args.y, GL_RGBA, GL_UNSIGNED_BYTE, args.x * args.y * 4);
+	pendingShots.push_back(std::move(args));
+}
+
+void FinishScreenshots(bool wait)
+{
+	while (!pendingShots.empty()) {
+		const GLubyte* pixels = shotReadbacks.MapFinished(wait);
+
+		if (pixels == nullptr) {
+			// still in flight
+			if (shotReadbacks.NumPending() == pendingShots.size())
+				break;
+
+			LOG_L(L_ERROR, "[%s] could not read back pixels for %s", __func__, pendingShots.front().filename.c_str());
+			pendingShots.pop_front();
+			continue;
+		}
+
+		FunctionArgs& args = pendingShots.front();
+
+		args.pixelbuf.assign(pixels, pixels + args.x * args.y * 4);
+		shotReadbacks.PopFinished();
+
+		ThreadPool::Enqueue([](const FunctionArgs& args) {
+			CBitmap bmp(&args.pixelbuf[0], args.x, args.y);
+			bmp.ReverseYAxis();
+			bmp.Save(args.filename, true, true);
+		}, std::move(args));
+
+		pendingShots.pop_front();
+	}
 
-	ThreadPool::Enqueue([](const FunctionArgs& args) {
-		CBitmap bmp(&args.pixelbuf[0], args.x, args.y);
-		bmp.ReverseYAxis();
-		bmp.Save(args.filename, true, true);
-	}, args);
+	// release the buffers between screenshots
+	if (pendingShots.empty())
+		shotReadbacks.Kill();
 }
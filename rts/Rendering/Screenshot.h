@@ -6,5 +6,7 @@
 #include <string>
 
 void TakeScreenshot(std::string type);
+/// hands screenshots whose pixels have arrived from the GPU to the encoder; called once per frame
+void FinishScreenshots(bool wait = false);
 
 #endif
@@ -131,8 +131,8 @@ namespace Shader {
 
 	/*****************************************************************/
 
-	unsigned int IShaderObject::GetHash() const {
-		unsigned int hash = 127;
+	unsigned int IShaderObject::GetHash(unsigned int seed) const {
+		unsigned int hash = seed;
 		hash = HsiehHash((const void*)   srcText.data(),    srcText.size(), hash); // srcTextHash is not worth it, only called on reload
 		hash = HsiehHash((const void*)modDefStrs.data(), modDefStrs.size(), hash);
 		hash = HsiehHash((const void*)rawDefStrs.data(), rawDefStrs.size(), hash); // rawDefStrsHash is not worth it, only called on reload
@@ -260,6 +260,24 @@ namespace Shader {
 		if ((glid = glCreateProgram()) == 0)
 			return false;
 
+		const bool useBinaryCache = shaderHandler->UseProgramBinaryCache();
+
+		CShaderHandler::ProgramBinaryKey binaryKey;
+
+		if (useBinaryCache) {
+			// two differently seeded digests per object, sources include the current flags
+			for (const IShaderObject* so: shaderObjs) {
+				binaryKey.Add(so->GetType());
+				binaryKey.Add(so->GetHash());
+				binaryKey.Add(so->GetHash(binaryKey.check));
+			}
+
+			if (shaderHandler->LoadProgramBinary(glid, binaryKey))
+				return true;
+
+			glProgramParameteri(glid, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+		}
+
 		for (IShaderObject*& so: shaderObjs) {
 			// NOTE:
 			//   cso will call glDeleteShader when it goes out of scope
@@ -288,7 +306,13 @@ namespace Shader {
 		// append the linker-log
 		log.append(glslGetLog(glid));
 
-		return (glslIsValid(glid));
+		if (!glslIsValid(glid))
+			return false;
+
+		if (useBinaryCache)
+			shaderHandler->SaveProgramBinary(glid, binaryKey);
+
+		return true;
 	}
 
 	bool GLSLProgramObject::CopyUniformsAndValidate(unsigned int tgtProgID, unsigned int srcProgID)
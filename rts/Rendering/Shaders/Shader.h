@@ -53,7 +53,7 @@ namespace Shader {
 
 		unsigned int GetObjID() const { return glid; }
 		unsigned int GetType() const { return type; }
-		unsigned int GetHash() const;
+		unsigned int GetHash(unsigned int seed = 127) const;
 
 		const std::string& GetLog() const { return log; }
 
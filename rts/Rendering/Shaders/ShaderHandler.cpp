@@ -2,9 +2,40 @@
 
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Shaders/Shader.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
+#include "System/StringUtil.h"
+#include "System/Sync/HsiehHash.h"
 
 #include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+CONFIG(bool, UseShaderBinaryCache).defaultValue(false).description("Store linked shader programs as driver-specific binaries in the cache directory and load those instead of compiling the same sources again.");
+
+
+static constexpr char PROGRAM_BINARY_MAGIC[4] = {'S', 'P', 'G', 'B'};
+
+struct ProgramBinaryHeader {
+	char magic[4];
+
+	std::uint32_t check;
+	std::uint32_t format;
+	std::uint32_t size;
+};
+
+static const std::string GetProgramBinaryDir() {
+	return (FileSystem::GetCacheDir() + "/shaders/");
+}
+
+static std::string GetProgramBinaryFileName(unsigned int hash) {
+	return (GetProgramBinaryDir() + IntToString(hash, "%08x") + ".glbin");
+}
 
 
 CShaderHandler* CShaderHandler::GetInstance()
@@ -67,6 +98,126 @@ void CShaderHandler::ReleaseProgramObjectsMap(ProgramObjMap& poMap)
 }
 
 
+CShaderHandler::ProgramBinaryKey::ProgramBinaryKey()
+{
+	// binaries are only valid for the exact driver that produced them
+	for (const GLenum name: {GL_VENDOR, GL_RENDERER, GL_VERSION}) {
+		const char* str = reinterpret_cast<const char*>(glGetString(name));
+
+		if (str != nullptr)
+			Add(str, std::strlen(str));
+	}
+}
+
+void CShaderHandler::ProgramBinaryKey::Add(const void* data, size_t size)
+{
+	hash  = HsiehHash(data, size, hash  ^ 0x9e3779b9u);
+	check = HsiehHash(data, size, check ^ 0x7f4a7c15u);
+}
+
+
+bool CShaderHandler::UseProgramBinaryCache() const
+{
+	static const bool haveBinaryFormats = []() {
+		GLint numFormats = 0;
+
+		if (GLEW_ARB_get_program_binary)
+			glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numFormats);
+
+		return (numFormats > 0);
+	}();
+
+	return (haveBinaryFormats && configHandler->GetBool("UseShaderBinaryCache"));
+}
+
+bool CShaderHandler::LoadProgramBinary(unsigned int progID, const ProgramBinaryKey& key) const
+{
+	std::ifstream file(dataDirsAccess.LocateFile(GetProgramBinaryFileName(key.hash)), std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	ProgramBinaryHeader header;
+	std::vector<char> data;
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return false;
+	if (std::memcmp(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic)) != 0 || header.check != key.check)
+		return false;
+
+	data.resize(header.size);
+
+	if (!file.read(data.data(), data.size()))
+		return false;
+
+	GLint linkStatus = 0;
+
+	// fails (and leaves the program unlinked) if the driver rejects the binary
+	glProgramBinary(progID, header.format, data.data(), data.size());
+	glGetProgramiv(progID, GL_LINK_STATUS, &linkStatus);
+
+	return (linkStatus != 0);
+}
+
+bool CShaderHandler::SaveProgramBinary(unsigned int progID, const ProgramBinaryKey& key) const
+{
+	GLint binarySize = 0;
+	GLenum binaryFormat = 0;
+
+	glGetProgramiv(progID, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+
+	if (binarySize <= 0)
+		return false;
+
+	std::vector<char> data(binarySize);
+	glGetProgramBinary(progID, binarySize, &binarySize, &binaryFormat, data.data());
+
+	if (!FileSystem::CreateDirectory(GetProgramBinaryDir()))
+		return false;
+
+	const std::string cacheFileName = GetProgramBinaryFileName(key.hash);
+	const std::string tempFileName = dataDirsAccess.LocateFile(cacheFileName + ".tmp", FileQueryFlags::WRITE);
+
+	ProgramBinaryHeader header;
+
+	std::memcpy(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic));
+	header.check = key.check;
+	header.format = binaryFormat;
+	header.size = binarySize;
+
+	{
+		std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+			return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(data.data(), binarySize);
+
+		if (!file.good()) {
+			file.close();
+			FileSystem::Remove(tempFileName);
+			return false;
+		}
+	}
+
+	const std::string destFileName = dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE);
+
+	#ifdef _WIN32
+	// rename does not replace existing files here
+	FileSystem::Remove(destFileName);
+	#endif
+
+	// other instances must never see a partially written file
+	if (std::rename(tempFileName.c_str(), destFileName.c_str()) != 0) {
+		FileSystem::Remove(tempFileName);
+		return false;
+	}
+
+	return true;
+}
+
+
 Shader::IProgramObject* CShaderHandler::CreateProgramObject(const std::string& poClass, const std::string& poName, bool persistent)
 {
 	assert(!poClass.empty());
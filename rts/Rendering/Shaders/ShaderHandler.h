@@ -81,6 +81,27 @@ public:
 	const ShaderCache& GetShaderCache() const { return shaderCache; }
 	      ShaderCache& GetShaderCache()       { return shaderCache; }
 
+
+	// identifies a program binary by its sources (added by the caller)
+	// and the GL driver; <hash> selects the file, <check> is stored in
+	// it to rule out collisions
+	struct ProgramBinaryKey {
+	public:
+		ProgramBinaryKey();
+
+		void Add(const void* data, size_t size);
+		void Add(const std::string& str) { Add(str.data(), str.size()); }
+		void Add(unsigned int val) { Add(&val, sizeof(val)); }
+
+		unsigned int hash = 0;
+		unsigned int check = 0;
+	};
+
+	bool UseProgramBinaryCache() const;
+	/// programs must be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT to be saved
+	bool LoadProgramBinary(unsigned int progID, const ProgramBinaryKey& key) const;
+	bool SaveProgramBinary(unsigned int progID, const ProgramBinaryKey& key) const;
+
 private:
 	// [0] := game-created programs, by name
 	// [1] := menu-created (persistent) programs, by name
@@ -32,6 +32,14 @@
 CONFIG(int, Shadows).defaultValue(2).headlessValue(-1).minimumValue(-1).safemodeValue(-1).description("Sets whether shadows are rendered.\n-1:=forceoff, 0:=off, 1:=full, 2:=fast (skip terrain)"); //FIXME document bitmask
 CONFIG(int, ShadowMapSize).defaultValue(CShadowHandler::DEF_SHADOWMAP_SIZE).minimumValue(32).description("Sets the resolution of shadows. Higher numbers increase quality at the cost of performance.");
 CONFIG(int, ShadowProjectionMode).defaultValue(CShadowHandler::SHADOWPROMODE_CAM_CENTER);
+CONFIG(bool, ShadowStaticCache).defaultValue(false).headlessValue(false).safemodeValue(false).description("Render shadows of the map, trees and features into a cached depth-texture that is only redrawn when the terrain or features change or the view moves far enough. Trades some shadow resolution for a cheaper shadow pass.");
+
+// fraction by which the cached light-space view is enlarged, so the
+// player camera can move a bit before static casters are redrawn
+static constexpr float STATIC_CACHE_VIEW_MARGIN = 1.25f;
+// upper bound on the age (in draw-frames) of cached static casters;
+// covers changes that raise no event such as feature LOS updates
+static constexpr unsigned int STATIC_CACHE_MAX_AGE = 60;
 
 CShadowHandler* shadowHandler = nullptr;
 
@@ -39,6 +47,19 @@ bool CShadowHandler::shadowsSupported = false;
 bool CShadowHandler::firstInit = true;
 
 
+CShadowHandler::CShadowHandler(): CEventClient("[CShadowHandler]", 314159, false)
+{
+	Init();
+	eventHandler.AddClient(this);
+}
+
+CShadowHandler::~CShadowHandler()
+{
+	eventHandler.RemoveClient(this);
+	Kill();
+}
+
+
 void CShadowHandler::Reload(const char* argv)
 {
 	int nextShadowConfig = (shadowConfig + 1) & 0xF;
@@ -75,6 +96,10 @@ void CShadowHandler::Init()
 	shadowsLoaded = false;
 	inShadowPass = false;
 
+	useStaticCache = configHandler->GetBool("ShadowStaticCache");
+	staticCacheDirty = true;
+	staticCacheFrame = 0;
+
 	shadowTexture = 0;
 	dummyColorTexture = 0;
 
@@ -108,6 +133,11 @@ void CShadowHandler::Init()
 		return;
 	}
 
+	if (useStaticCache && !InitStaticCacheTarget()) {
+		LOG_L(L_WARNING, "[%s] failed to initialize static-caster cache FBO, disabling it", __func__);
+		useStaticCache = false;
+	}
+
 	if (tmpFirstInit)
 		shadowsSupported = true;
 
@@ -136,9 +166,15 @@ void CShadowHandler::FreeTextures() {
 		fb.DetachAll();
 		fb.Unbind();
 	}
+	if (staticCacheFB.IsValid()) {
+		staticCacheFB.Bind();
+		staticCacheFB.DetachAll();
+		staticCacheFB.Unbind();
+	}
 
-	glDeleteTextures(1, &shadowTexture    ); shadowTexture     = 0;
-	glDeleteTextures(1, &dummyColorTexture); dummyColorTexture = 0;
+	glDeleteTextures(1, &shadowTexture     ); shadowTexture      = 0;
+	glDeleteTextures(1, &dummyColorTexture ); dummyColorTexture  = 0;
+	glDeleteTextures(1, &staticCacheTexture); staticCacheTexture = 0;
 }
 
 
@@ -242,9 +278,13 @@ void CShadowHandler::LoadShadowGenShaders()
 		po->SetUniformLocation("$dummy$"      ); // idx 6, unused
 		po->SetUniformLocation("alphaMaskTex" ); // idx 7
 		po->SetUniformLocation("alphaParams"  ); // idx 8
+		po->SetUniformLocation("treeMatrixTex"); // idx 9
+		po->SetUniformLocation("instanceParams"); // idx 10
 
 		po->Enable();
 		po->SetUniform1i(7, 0);
+		po->SetUniform1i(9, 2);
+		po->SetUniform2i(10, 0, 0);
 		po->SetUniform2f(8, 0.5f, 0.5f);
 		po->Disable();
 		po->Validate();
@@ -340,6 +380,37 @@ bool CShadowHandler::InitDepthTarget()
 }
 
 
+bool CShadowHandler::InitStaticCacheTarget()
+{
+	if (!staticCacheFB.IsValid())
+		return false;
+
+	// depth-blits require matching formats, copy whatever InitDepthTarget settled on
+	GLint texFormat = GL_DEPTH_COMPONENT32;
+
+	glBindTexture(GL_TEXTURE_2D, shadowTexture);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &texFormat);
+
+	glGenTextures(1, &staticCacheTexture);
+	glBindTexture(GL_TEXTURE_2D, staticCacheTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, texFormat, shadowMapSize, shadowMapSize, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	staticCacheFB.Bind();
+	staticCacheFB.AttachTexture(staticCacheTexture, GL_TEXTURE_2D, GL_DEPTH_ATTACHMENT);
+
+	glDrawBuffer(GL_NONE);
+	glReadBuffer(GL_NONE);
+
+	const bool status = staticCacheFB.CheckStatus("SHADOW-STATIC");
+
+	staticCacheFB.Unbind();
+	return status;
+}
+
+
 bool CShadowHandler::WorkaroundUnsupportedFboRenderTargets()
 {
 	// some drivers/GPUs fail to render to GL_CLAMP_TO_BORDER (and GL_LINEAR may cause a drop in performance for them, too)
@@ -400,11 +471,17 @@ void CShadowHandler::DrawShadowPasses()
 		glEnable(GL_CULL_FACE);
 		glCullFace(GL_BACK);
 
+		if (useStaticCache) {
+			UpdateStaticCache();
+		} else {
+			DrawStaticShadowPasses();
+		}
+
 		eventHandler.DrawWorldShadow();
 
+		// grass is removed by explosions without raising any event, never cache it
 		if ((shadowGenBits & SHADOWGEN_BIT_TREE) != 0) {
 			currentShadowPass = SHADOWGEN_PROGRAM_TREE;
-			treeDrawer->DrawShadow();
 			grassDrawer->DrawShadow();
 		}
 
@@ -416,22 +493,6 @@ void CShadowHandler::DrawShadowPasses()
 		if ((shadowGenBits & SHADOWGEN_BIT_MODEL) != 0) {
 			currentShadowPass = SHADOWGEN_PROGRAM_MODEL;
 			unitDrawer->DrawShadowPass();
-			featureDrawer->DrawShadowPass();
-		}
-
-		// cull front-faces during the terrain shadow pass: sun direction
-		// can be set so oblique that geometry back-faces are visible (eg.
-		// from hills near map edges) from its POV
-		//
-		// not the best idea, causes acne when projecting the shadow-map
-		// (rasterizing back-faces writes different depth values) and is
-		// no longer required since border geometry will fully hide them
-		// (could just disable culling of terrain faces entirely, but we
-		// also want to prevent overdraw in low-angle passes)
-		// glCullFace(GL_FRONT);
-		if ((shadowGenBits & SHADOWGEN_BIT_MAP) != 0) {
-			currentShadowPass = SHADOWGEN_PROGRAM_MAP;
-			readMap->GetGroundDrawer()->DrawShadowPass();
 		}
 
 		currentShadowPass = SHADOWGEN_PROGRAM_LAST;
@@ -441,6 +502,61 @@ void CShadowHandler::DrawShadowPasses()
 	inShadowPass = false;
 }
 
+void CShadowHandler::DrawStaticShadowPasses()
+{
+	if ((shadowGenBits & SHADOWGEN_BIT_TREE) != 0) {
+		currentShadowPass = SHADOWGEN_PROGRAM_TREE;
+		treeDrawer->DrawShadow();
+	}
+
+	if ((shadowGenBits & SHADOWGEN_BIT_MODEL) != 0) {
+		currentShadowPass = SHADOWGEN_PROGRAM_MODEL;
+		featureDrawer->DrawShadowPass();
+	}
+
+	// cull front-faces during the terrain shadow pass: sun direction
+	// can be set so oblique that geometry back-faces are visible (eg.
+	// from hills near map edges) from its POV
+	//
+	// not the best idea, causes acne when projecting the shadow-map
+	// (rasterizing back-faces writes different depth values) and is
+	// no longer required since border geometry will fully hide them
+	// (could just disable culling of terrain faces entirely, but we
+	// also want to prevent overdraw in low-angle passes)
+	// glCullFace(GL_FRONT);
+	if ((shadowGenBits & SHADOWGEN_BIT_MAP) != 0) {
+		currentShadowPass = SHADOWGEN_PROGRAM_MAP;
+		readMap->GetGroundDrawer()->DrawShadowPass();
+	}
+
+	currentShadowPass = SHADOWGEN_PROGRAM_LAST;
+}
+
+void CShadowHandler::UpdateStaticCache()
+{
+	staticCacheDirty |= ((globalRendering->drawFrame - staticCacheFrame) >= STATIC_CACHE_MAX_AGE);
+
+	if (staticCacheDirty) {
+		staticCacheFB.Bind();
+		glClear(GL_DEPTH_BUFFER_BIT);
+
+		DrawStaticShadowPasses();
+
+		staticCacheDirty = false;
+		staticCacheFrame = globalRendering->drawFrame;
+	}
+
+	// overwrite the (cleared) shadow depth-buffer, dynamic casters are drawn on top
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, staticCacheFB.fboId);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, fb.fboId);
+	glBlitFramebuffer(
+		0, 0, shadowMapSize, shadowMapSize,
+		0, 0, shadowMapSize, shadowMapSize,
+		GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+	fb.Bind();
+}
+
 void CShadowHandler::SetShadowMapSizeFactors()
 {
 	#if (SHADOWMATRIX_NONLINEAR == 1)
@@ -491,8 +607,13 @@ static CMatrix44f ComposeScaleMatrix(const float4 scales)
 
 void CShadowHandler::SetShadowMatrix(CCamera* playerCam, CCamera* shadowCam)
 {
-	const CMatrix44f lightMatrix = std::move(ComposeLightMatrix(sky->GetLight()));
-	const CMatrix44f scaleMatrix = std::move(ComposeScaleMatrix(GetShadowProjectionScales(playerCam, lightMatrix)));
+	CMatrix44f lightMatrix = std::move(ComposeLightMatrix(sky->GetLight()));
+	float4 projScales = GetShadowProjectionScales(playerCam, lightMatrix);
+
+	if (useStaticCache)
+		projScales = GetStaticCacheProjectionScales(lightMatrix, projScales);
+
+	const CMatrix44f scaleMatrix = std::move(ComposeScaleMatrix(projScales));
 
 	// convert xy-diameter to radius
 	shadowCam->SetFrustumScales(shadowProjScales * float4(0.5f, 0.5f, 1.0f, 1.0f));
@@ -695,6 +816,39 @@ float4 CShadowHandler::GetShadowProjectionScales(CCamera* cam, const CMatrix44f&
 	return (shadowProjScales = projScales);
 }
 
+float4 CShadowHandler::GetStaticCacheProjectionScales(CMatrix44f& lightMatrix, const float4& projScales) {
+	const float3 lightDir = lightMatrix.GetZ();
+	const float3 midPosDif = projMidPos[2] - staticCacheMidPos;
+
+	// distance between both projection centers within the light's XY-plane
+	const float midPosDist = (midPosDif - lightDir * midPosDif.dot(lightDir)).Length();
+
+	// reuse the cached view while the current one still fits inside it and
+	// is not so much smaller that most of the shadow-map would be wasted
+	bool reuseView = true;
+
+	reuseView &= (lightDir.dot(staticCacheLightDir) >= 0.9999f);
+	reuseView &= (projScales.z == staticCacheScales.z && projScales.w == staticCacheScales.w);
+	reuseView &= ((midPosDist + projScales.x * 0.5f) <= (staticCacheScales.x * 0.5f));
+	reuseView &= ((projScales.x * STATIC_CACHE_VIEW_MARGIN * 2.0f) >= staticCacheScales.x);
+
+	if (!reuseView) {
+		staticCacheDirty = true;
+
+		staticCacheMidPos = projMidPos[2];
+		staticCacheLightDir = lightDir;
+		staticCacheScales = projScales * float4(STATIC_CACHE_VIEW_MARGIN, STATIC_CACHE_VIEW_MARGIN, 1.0f, 1.0f);
+	}
+
+	// small sun-direction changes are ignored as well, keep the cached light-space
+	lightMatrix.SetZ(staticCacheLightDir);
+	lightMatrix.SetX(((lightMatrix.GetZ()).cross(   UpVector       )).ANormalize());
+	lightMatrix.SetY(((lightMatrix.GetX()).cross(lightMatrix.GetZ())).ANormalize());
+
+	projMidPos[2] = staticCacheMidPos;
+	return (shadowProjScales = staticCacheScales);
+}
+
 float CShadowHandler::GetOrthoProjectedMapRadius(const float3& sunDir, float3& projPos) {
 	// to fit the map inside the frustum, we need to know
 	// the distance from one corner to its opposing corner
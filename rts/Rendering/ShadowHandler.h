@@ -6,6 +6,7 @@
 #include <array>
 
 #include "Rendering/GL/FBO.h"
+#include "System/EventClient.h"
 #include "System/float4.h"
 #include "System/Matrix44f.h"
 
@@ -14,11 +15,23 @@ namespace Shader {
 }
 
 class CCamera;
-class CShadowHandler
+class CShadowHandler: public CEventClient
 {
 public:
-	CShadowHandler() { Init(); }
-	~CShadowHandler() { Kill(); }
+	CShadowHandler();
+	~CShadowHandler();
+
+	// CEventClient interface; any of these invalidates the static-caster cache
+	bool WantsEvent(const std::string& eventName) override {
+		return (eventName == "UnsyncedHeightMapUpdate" || eventName == "RenderFeatureCreated" || eventName == "RenderFeatureDestroyed" || eventName == "FeatureMoved");
+	}
+	bool GetFullRead() const override { return true; }
+	int GetReadAllyTeam() const override { return AllAccessTeam; }
+
+	void UnsyncedHeightMapUpdate(const SRectangle& rect) override { staticCacheDirty = true; }
+	void RenderFeatureCreated(const CFeature* feature) override { staticCacheDirty = true; }
+	void RenderFeatureDestroyed(const CFeature* feature) override { staticCacheDirty = true; }
+	void FeatureMoved(const CFeature* feature, const float3& oldpos) override { staticCacheDirty = true; }
 
 	void Reload(const char* argv);
 
@@ -86,9 +99,12 @@ private:
 	void FreeTextures();
 
 	bool InitDepthTarget();
+	bool InitStaticCacheTarget();
 	bool WorkaroundUnsupportedFboRenderTargets();
 
 	void DrawShadowPasses();
+	void DrawStaticShadowPasses();
+	void UpdateStaticCache();
 	void LoadProjectionMatrix(const CCamera* shadowCam);
 	void LoadShadowGenShaders();
 
@@ -97,6 +113,7 @@ private:
 	void SetShadowCamera(CCamera* shadowCam);
 
 	float4 GetShadowProjectionScales(CCamera*, const CMatrix44f&);
+	float4 GetStaticCacheProjectionScales(CMatrix44f&, const float4&);
 	float3 CalcShadowProjectionPos(CCamera*, float3*);
 
 	float GetOrthoProjectedMapRadius(const float3&, float3&);
@@ -111,11 +128,20 @@ public:
 private:
 	unsigned int shadowTexture = 0;
 	unsigned int dummyColorTexture = 0;
+	unsigned int staticCacheTexture = 0;
 	unsigned int currentShadowPass = SHADOWGEN_PROGRAM_LAST;
 
 	bool shadowsLoaded;
 	bool inShadowPass;
 
+	// if true, static casters (map, trees, features) are rendered into
+	// a separate depth-texture only when invalidated and then copied to
+	// shadowTexture each frame before dynamic casters are drawn over it
+	bool useStaticCache;
+	bool staticCacheDirty;
+
+	unsigned int staticCacheFrame;
+
 	static bool firstInit;
 	static bool shadowsSupported;
 
@@ -136,7 +162,13 @@ private:
 	CMatrix44f projMatrix[2];
 	CMatrix44f viewMatrix[2];
 
+	// light-space parameters the static cache was last rendered with
+	float3 staticCacheMidPos;
+	float3 staticCacheLightDir;
+	float4 staticCacheScales;
+
 	FBO fb;
+	FBO staticCacheFB;
 };
 
 extern CShadowHandler* shadowHandler;
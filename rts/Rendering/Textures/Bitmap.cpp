@@ -2,7 +2,9 @@
 
 #include <algorithm>
 #include <utility>
+#include <cstdio>
 #include <cstring>
+#include <fstream>
 
 #include <IL/il.h>
 #include <SDL_video.h>
@@ -18,7 +20,11 @@
 #include "System/ScopedFPUSettings.h"
 #include "System/ContainerUtil.h"
 #include "System/SafeUtil.h"
+#include "System/StringUtil.h"
+#include "System/type2.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
+#include "System/Sync/HsiehHash.h"
 #include "System/Threading/ThreadPool.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
@@ -27,9 +33,68 @@
 #include "System/Threading/SpringThreading.h"
 
 
+CONFIG(bool, DecodedTextureCache).defaultValue(true).description("Keep decoded copies of the (non-DDS) textures loaded from pool archives in CacheDir/textures/. They are found by the hash of the file contents, so every game version containing the same texture shares one copy.");
+
 // libIL is not thread-safe, neither are {Alloc,Free}Mem
 static spring::mutex bmpMutex;
 
+// images smaller than this (in pixels) are not worth the thread-pool overhead
+static constexpr int MIN_PARALLEL_PIXELS = 256 * 256;
+
+// runs f(y) for every row, on the thread-pool for large images
+template<typename F>
+static void ForEachRow(int xsize, int ysize, F&& f)
+{
+	if ((xsize * ysize) < MIN_PARALLEL_PIXELS) {
+		for (int y = 0; y < ysize; ++y) {
+			f(y);
+		}
+
+		return;
+	}
+
+	for_mt(0, ysize, f);
+}
+
+// per-channel sums of the RGB values of all pixels passing pred, and their number;
+// integer sums so the result does not depend on how rows were distributed
+struct ChannelSums {
+	int rgb[3] = {0, 0, 0};
+	int numCounted = 0;
+};
+
+template<typename P>
+static ChannelSums SumChannels(const unsigned char* mem, int xsize, int ysize, P&& pred)
+{
+	std::vector<ChannelSums> rowSums(ysize);
+	ChannelSums sums;
+
+	ForEachRow(xsize, ysize, [&](const int y) {
+		ChannelSums& rowSum = rowSums[y];
+
+		for (int x = 0; x < xsize; ++x) {
+			const unsigned char* px = &mem[(y * xsize + x) * 4];
+
+			if (!pred(px))
+				continue;
+
+			rowSum.rgb[0] += px[0];
+			rowSum.rgb[1] += px[1];
+			rowSum.rgb[2] += px[2];
+			rowSum.numCounted += 1;
+		}
+	});
+
+	for (const ChannelSums& rowSum: rowSums) {
+		sums.rgb[0] += rowSum.rgb[0];
+		sums.rgb[1] += rowSum.rgb[1];
+		sums.rgb[2] += rowSum.rgb[2];
+		sums.numCounted += rowSum.numCounted;
+	}
+
+	return sums;
+}
+
 #if 0
 static std::deque< std::vector<unsigned char> > poolPages;
 static std::vector<size_t> poolIndcs;
@@ -212,6 +277,118 @@ void CBitmap::AllocDummy(const SColor fill)
 	reinterpret_cast<SColor*>(&mem[0])[0] = fill;
 }
 
+/*
+ * decoded-cache file layout: header, then xsize * ysize * channels bytes
+ * containing exactly what decoding the file would have put in mem
+ */
+static constexpr std::uint32_t DECODED_CACHE_VERSION = 1;
+static constexpr char DECODED_CACHE_MAGIC[8] = {'S', 'P', 'R', 'B', 'M', 'P', 'C', '\0'};
+
+struct DecodedCacheHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::int32_t xsize;
+	std::int32_t ysize;
+	std::int32_t channels;
+	std::uint32_t dataChecksum;
+};
+
+// empty if the file has no known content hash
+static std::string GetDecodedCacheFileName(const CFileHandler& file, int channels, unsigned char defaultAlpha)
+{
+	std::uint8_t md5sum[16];
+
+	if (!configHandler->GetBool("DecodedTextureCache"))
+		return "";
+	if (!file.GetContentHash(md5sum))
+		return "";
+
+	char hexSum[sizeof(md5sum) * 2 + 1];
+
+	for (size_t i = 0; i < sizeof(md5sum); i++) {
+		snprintf(&hexSum[i * 2], 3, "%02x", md5sum[i]);
+	}
+
+	return (FileSystem::GetCacheDir() + "/textures/" + hexSum + "-" + IntToString(channels) + "-" + IntToString(defaultAlpha, "%02x") + ".bmpcache");
+}
+
+bool CBitmap::LoadDecodedCache(const std::string& cacheFileName)
+{
+	if (!FileSystem::FileExists(cacheFileName))
+		return false;
+
+	std::ifstream file(dataDirsAccess.LocateFile(cacheFileName), std::ios::binary);
+	DecodedCacheHeader header;
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return false;
+
+	if (std::memcmp(header.magic, DECODED_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != DECODED_CACHE_VERSION)
+		return false;
+	if (header.channels != channels || header.xsize <= 0 || header.ysize <= 0 || header.xsize > 32768 || header.ysize > 32768)
+		return false;
+
+	std::vector<unsigned char> data(header.xsize * header.ysize * header.channels);
+
+	if (!file.read(reinterpret_cast<char*>(data.data()), data.size()))
+		return false;
+	if (HsiehHash(data.data(), data.size(), 0) != header.dataChecksum)
+		return false;
+
+	xsize = header.xsize;
+	ysize = header.ysize;
+	mem.swap(data);
+	return true;
+}
+
+bool CBitmap::SaveDecodedCache(const std::string& cacheFileName) const
+{
+	FileSystem::CreateDirectory(FileSystem::GetCacheDir() + "/textures/");
+
+	const std::string tempFileName = dataDirsAccess.LocateFile(cacheFileName + ".tmp", FileQueryFlags::WRITE);
+
+	DecodedCacheHeader header;
+
+	std::memcpy(header.magic, DECODED_CACHE_MAGIC, sizeof(header.magic));
+	header.version = DECODED_CACHE_VERSION;
+	header.xsize = xsize;
+	header.ysize = ysize;
+	header.channels = channels;
+	header.dataChecksum = HsiehHash(mem.data(), mem.size(), 0);
+
+	{
+		std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+			return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(mem.data()), mem.size());
+
+		if (!file.good()) {
+			file.close();
+			FileSystem::Remove(tempFileName);
+			return false;
+		}
+	}
+
+	const std::string destFileName = dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE);
+
+	#ifdef _WIN32
+	// rename does not replace existing files here
+	FileSystem::Remove(destFileName);
+	#endif
+
+	// other instances (and loading threads) must never see a partially written file
+	if (std::rename(tempFileName.c_str(), destFileName.c_str()) != 0) {
+		FileSystem::Remove(tempFileName);
+		return false;
+	}
+
+	return true;
+}
+
+
 bool CBitmap::Load(std::string const& filename, unsigned char defaultAlpha)
 {
 #ifndef BITMAP_NO_OPENGL
@@ -270,14 +447,24 @@ bool CBitmap::Load(std::string const& filename, unsigned char defaultAlpha)
 		return false;
 	}
 
+	// pool files (same hash, same pixels) need not be decoded again
+	const std::string cacheFileName = GetDecodedCacheFileName(file, channels, defaultAlpha);
+
+	if (!cacheFileName.empty() && LoadDecodedCache(cacheFileName))
+		return true;
+
 	std::vector<uint8_t> buffer;
 
+	// files loaded from the VFS are decoded in place
+	const uint8_t* fileData = file.GetFileView().data;
+	size_t fileDataSize = file.GetFileView().size;
+
 	if (!file.IsBuffered()) {
 		buffer.resize(file.FileSize() + 2, 0);
 		file.Read(buffer.data(), file.FileSize());
-	} else {
-		// steal if file was loaded from VFS
-		buffer = std::move(file.GetBuffer());
+
+		fileData = buffer.data();
+		fileDataSize = buffer.size();
 	}
 
 
@@ -295,7 +482,7 @@ bool CBitmap::Load(std::string const& filename, unsigned char defaultAlpha)
 			// do not signal floating point exceptions in devil library
 			ScopedDisableFpuExceptions fe;
 
-			const bool success = !!ilLoadL(IL_TYPE_UNKNOWN, buffer.data(), buffer.size());
+			const bool success = !!ilLoadL(IL_TYPE_UNKNOWN, fileData, fileDataSize);
 
 			// FPU control word has to be restored as well
 			streflop::streflop_init<streflop::Simple>();
@@ -329,13 +516,16 @@ bool CBitmap::Load(std::string const& filename, unsigned char defaultAlpha)
 	}
 
 	if (noAlpha) {
-		for (int y = 0; y < ysize; ++y) {
+		ForEachRow(xsize, ysize, [&](const int y) {
 			for (int x = 0; x < xsize; ++x) {
 				mem[((y * xsize + x) * 4) + 3] = defaultAlpha;
 			}
-		}
+		});
 	}
 
+	if (!cacheFileName.empty())
+		SaveDecodedCache(cacheFileName);
+
 	return true;
 }
 
@@ -351,14 +541,23 @@ bool CBitmap::LoadGrayscale(const std::string& filename)
 	if (!file.FileExists())
 		return false;
 
+	const std::string cacheFileName = GetDecodedCacheFileName(file, channels, 0);
+
+	if (!cacheFileName.empty() && LoadDecodedCache(cacheFileName))
+		return true;
+
 	std::vector<uint8_t> buffer;
 
+	// files loaded from the VFS are decoded in place
+	const uint8_t* fileData = file.GetFileView().data;
+	size_t fileDataSize = file.GetFileView().size;
+
 	if (!file.IsBuffered()) {
 		buffer.resize(file.FileSize() + 1, 0);
 		file.Read(buffer.data(), file.FileSize());
-	} else {
-		// steal if file was loaded from VFS
-		buffer = std::move(file.GetBuffer());
+
+		fileData = buffer.data();
+		fileDataSize = buffer.size();
 	}
 
 	{
@@ -371,7 +570,7 @@ bool CBitmap::LoadGrayscale(const std::string& filename)
 		ilGenImages(1, &imageID);
 		ilBindImage(imageID);
 
-		const bool success = !!ilLoadL(IL_TYPE_UNKNOWN, buffer.data(), buffer.size());
+		const bool success = !!ilLoadL(IL_TYPE_UNKNOWN, fileData, fileDataSize);
 		ilDisable(IL_ORIGIN_SET);
 
 		if (!success)
@@ -388,6 +587,9 @@ bool CBitmap::LoadGrayscale(const std::string& filename)
 		ilDeleteImages(1, &imageID);
 	}
 
+	if (!cacheFileName.empty())
+		SaveDecodedCache(cacheFileName);
+
 	return true;
 }
 
@@ -686,26 +888,14 @@ unsigned int CBitmap::CreateDDSTexture(unsigned int texID, float aniso, bool mip
 void CBitmap::CreateAlpha(unsigned char red, unsigned char green, unsigned char blue)
 {
 	float3 aCol;
-	for(int a=0; a < 3; ++a) {
-		int cCol = 0;
-		int numCounted = 0;
-		for (int y=0; y < ysize; ++y) {
-			for (int x=0; x < xsize; ++x) {
-				const int index = (y*xsize + x) * 4;
-				if ((mem[index + 3] != 0) &&
-					!(
-						(mem[index + 0] == red) &&
-						(mem[index + 1] == green) &&
-						(mem[index + 2] == blue)
-					))
-				{
-					cCol += mem[index + a];
-					++numCounted;
-				}
-			}
-		}
-		if (numCounted != 0) {
-			aCol[a] = cCol / 255.0f / numCounted;
+
+	const ChannelSums sums = SumChannels(mem.data(), xsize, ysize, [&](const unsigned char* px) {
+		return ((px[3] != 0) && !((px[0] == red) && (px[1] == green) && (px[2] == blue)));
+	});
+
+	if (sums.numCounted != 0) {
+		for (int a = 0; a < 3; ++a) {
+			aCol[a] = sums.rgb[a] / 255.0f / sums.numCounted;
 		}
 	}
 
@@ -724,13 +914,15 @@ void CBitmap::SetTransparent(const SColor& c, const SColor trans)
 	static const uint32_t RGB = 0x00FFFFFF;
 
 	uint32_t* mem_i = reinterpret_cast<uint32_t*>(&mem[0]);
-	for (int y = 0; y < ysize; ++y) {
+
+	ForEachRow(xsize, ysize, [&](const int y) {
+		uint32_t* row = mem_i + y * xsize;
+
 		for (int x = 0; x < xsize; ++x) {
-			if ((*mem_i & RGB) == (c.i & RGB))
-				*mem_i = trans.i;
-			mem_i++;
+			if ((row[x] & RGB) == (c.i & RGB))
+				row[x] = trans.i;
 		}
-	}
+	});
 }
 
 
@@ -739,32 +931,33 @@ void CBitmap::Renormalize(float3 newCol)
 	float3 aCol;
 	float3 colorDif;
 
+	const ChannelSums sums = SumChannels(mem.data(), xsize, ysize, [](const unsigned char* px) { return (px[3] != 0); });
+
 	for (int a = 0; a < 3; ++a) {
-		int cCol = 0;
-		int numCounted = 0;
-		for (int y = 0; y < ysize; ++y) {
-			for (int x = 0; x < xsize; ++x) {
-				const unsigned int index = (y* xsize + x) * 4;
-				if (mem[index + 3] != 0) {
-					cCol += mem[index + a];
-					++numCounted;
-				}
-			}
-		}
-		aCol[a] = cCol / 255.0f / numCounted;
+		aCol[a] = sums.rgb[a] / 255.0f / sums.numCounted;
 		//cCol /= xsize*ysize; //??
 		colorDif[a] = newCol[a] - aCol[a];
 	}
 
+	// every output value only depends on its input value, so tabulate them
+	unsigned char lut[3][256];
+
 	for (int a = 0; a < 3; ++a) {
-		for (int y = 0; y < ysize; ++y) {
-			for (int x = 0; x < xsize; ++x) {
-				const unsigned int index = (y * xsize + x) * 4;
-				float nc = float(mem[index + a]) / 255.0f + colorDif[a];
-				mem[index + a] = (unsigned char) (std::min(255.f, std::max(0.0f, nc*255)));
-			}
+		for (int v = 0; v < 256; ++v) {
+			const float nc = float(v) / 255.0f + colorDif[a];
+			lut[a][v] = (unsigned char) (std::min(255.f, std::max(0.0f, nc*255)));
 		}
 	}
+
+	ForEachRow(xsize, ysize, [&](const int y) {
+		unsigned char* row = &mem[y * xsize * 4];
+
+		for (int x = 0; x < xsize; ++x) {
+			row[x * 4 + 0] = lut[0][row[x * 4 + 0]];
+			row[x * 4 + 1] = lut[1][row[x * 4 + 1]];
+			row[x * 4 + 2] = lut[2][row[x * 4 + 2]];
+		}
+	});
 }
 
 
@@ -915,6 +1108,10 @@ CBitmap CBitmap::CreateRescaled(int newx, int newy) const
 	const float dx = (float) xsize / newx;
 	const float dy = (float) ysize / newy;
 
+	// source row and column ranges; accumulated serially as before
+	std::vector<int2> rowRanges(newy);
+	std::vector<int2> colRanges(newx);
+
 	float cy = 0;
 	for (int y=0; y < newy; ++y) {
 		const int sy = (int) cy;
@@ -924,14 +1121,29 @@ CBitmap CBitmap::CreateRescaled(int newx, int newy) const
 			ey = sy+1;
 		}
 
-		float cx = 0;
+		rowRanges[y] = {sy, ey};
+	}
+
+	float cx = 0;
+	for (int x=0; x < newx; ++x) {
+		const int sx = (int) cx;
+		cx += dx;
+		int ex = (int) cx;
+		if (ex == sx) {
+			ex = sx + 1;
+		}
+
+		colRanges[x] = {sx, ex};
+	}
+
+	ForEachRow(newx, newy, [&](const int y) {
+		const int sy = rowRanges[y].x;
+		const int ey = rowRanges[y].y;
+
+
 		for (int x=0; x < newx; ++x) {
-			const int sx = (int) cx;
-			cx += dx;
-			int ex = (int) cx;
-			if (ex == sx) {
-				ex = sx + 1;
-			}
+			const int sx = colRanges[x].x;
+			const int ex = colRanges[x].y;
 
 			int r=0, g=0, b=0, a=0;
 			for (int y2 = sy; y2 < ey; ++y2) {
@@ -950,7 +1162,7 @@ CBitmap CBitmap::CreateRescaled(int newx, int newy) const
 			bm.mem[index + 2] = b / denom;
 			bm.mem[index + 3] = a / denom;
 		}
-	}
+	});
 
 	return bm;
 }
@@ -961,7 +1173,7 @@ void CBitmap::InvertColors()
 	if (compressed) {
 		return;
 	}
-	for (int y = 0; y < ysize; ++y) {
+	ForEachRow(xsize, ysize, [&](const int y) {
 		for (int x = 0; x < xsize; ++x) {
 			const int base = ((y * xsize) + x) * 4;
 			mem[base + 0] = 0xFF - mem[base + 0];
@@ -969,7 +1181,7 @@ void CBitmap::InvertColors()
 			mem[base + 2] = 0xFF - mem[base + 2];
 			// do not invert alpha
 		}
-	}
+	});
 }
 
 
@@ -978,12 +1190,12 @@ void CBitmap::InvertAlpha()
 	if (compressed)
 		return; // Don't try to invert DDS
 
-	for (int y = 0; y < ysize; ++y) {
+	ForEachRow(xsize, ysize, [&](const int y) {
 		for (int x = 0; x < xsize; ++x) {
 			const int base = ((y * xsize) + x) * 4;
 			mem[base + 3] = 0xFF - mem[base + 3];
 		}
-	}
+	});
 }
 
 
@@ -992,7 +1204,7 @@ void CBitmap::MakeGrayScale()
 	if (compressed)
 		return;
 
-	for (int y = 0; y < ysize; ++y) {
+	ForEachRow(xsize, ysize, [&](const int y) {
 		for (int x = 0; x < xsize; ++x) {
 			const int base = ((y * xsize) + x) * 4;
 			const float illum =
@@ -1005,7 +1217,7 @@ void CBitmap::MakeGrayScale()
 			mem[base + 1] = cval;
 			mem[base + 2] = cval;
 		}
-	}
+	});
 }
 
 static ILubyte TintByte(ILubyte value, float tint)
@@ -1021,15 +1233,24 @@ void CBitmap::Tint(const float tint[3])
 	if (compressed) {
 		return;
 	}
-	for (int y = 0; y < ysize; y++) {
+
+	ILubyte lut[3][256];
+
+	for (int v = 0; v < 256; v++) {
+		lut[0][v] = TintByte(v, tint[0]);
+		lut[1][v] = TintByte(v, tint[1]);
+		lut[2][v] = TintByte(v, tint[2]);
+	}
+
+	ForEachRow(xsize, ysize, [&](const int y) {
 		for (int x = 0; x < xsize; x++) {
 			const int base = ((y * xsize) + x) * 4;
-			mem[base + 0] = TintByte(mem[base + 0], tint[0]);
-			mem[base + 1] = TintByte(mem[base + 1], tint[1]);
-			mem[base + 2] = TintByte(mem[base + 2], tint[2]);
+			mem[base + 0] = lut[0][mem[base + 0]];
+			mem[base + 1] = lut[1][mem[base + 1]];
+			mem[base + 2] = lut[2][mem[base + 2]];
 			// don't touch the alpha channel
 		}
-	}
+	});
 }
 
 
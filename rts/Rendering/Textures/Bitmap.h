@@ -81,6 +81,10 @@ public:
 	bool compressed;
 
 private:
+	/// decoded copies of files with known content hashes, see Load
+	bool LoadDecodedCache(const std::string& cacheFileName);
+	bool SaveDecodedCache(const std::string& cacheFileName) const;
+
 	std::vector<unsigned char> mem;
 
 public:
@@ -20,6 +20,8 @@ namespace CNamedTextures {
 	static spring::unordered_map<std::string, size_t> texInfoMap;
 
 	static std::vector<CNamedTextures::TexInfo> texInfoVec;
+	// maps name atoms to texInfoVec indices (or -1), filled by Bind(atom)
+	static std::vector<size_t> atomTexIndices;
 	static std::vector<size_t> freeIndices;
 	static std::vector<std::string> waitingTextures;
 
@@ -35,6 +37,7 @@ namespace CNamedTextures {
 		texInfoVec.reserve(128);
 
 		freeIndices.clear();
+		atomTexIndices.clear();
 
 		waitingTextures.clear();
 		waitingTextures.reserve(16);
@@ -60,6 +63,7 @@ namespace CNamedTextures {
 		}
 
 		std::swap(texInfoMap, tempMap);
+		atomTexIndices.clear();
 		waitingTextures.clear();
 	}
 
@@ -72,6 +76,9 @@ namespace CNamedTextures {
 		if (!loadTex)
 			waitingTextures.push_back(texName);
 
+		// (re)inserting may remap texName to a new index
+		atomTexIndices.clear();
+
 		if (freeIndices.empty()) {
 			texInfoMap[texName] = texInfoVec.size();
 			texInfoVec.push_back(texInfo);
@@ -123,6 +130,8 @@ namespace CNamedTextures {
 
 			freeIndices.push_back(texIdx);
 			texInfoMap.erase(it);
+			// index might get recycled, drop all atom mappings
+			atomTexIndices.clear();
 			return true;
 		}
 
@@ -304,6 +313,32 @@ namespace CNamedTextures {
 	}
 
 
+	bool Bind(StringAtoms::atom_t texAtom)
+	{
+		if (texAtom == StringAtoms::NONE)
+			return false;
+
+		if (texAtom < atomTexIndices.size() && atomTexIndices[texAtom] != size_t(-1)) {
+			const GLuint texID = texInfoVec[ atomTexIndices[texAtom] ].id;
+			glBindTexture(GL_TEXTURE_2D, texID);
+			return (texID != 0);
+		}
+
+		const std::string& texName = StringAtoms::GetString(texAtom);
+		const bool ret = Bind(texName);
+		const size_t texIdx = GetInfoIndex(texName);
+
+		if (texIdx != size_t(-1)) {
+			if (texAtom >= atomTexIndices.size())
+				atomTexIndices.resize(StringAtoms::GetCount(), size_t(-1));
+
+			atomTexIndices[texAtom] = texIdx;
+		}
+
+		return ret;
+	}
+
+
 	void Update()
 	{
 		if (waitingTextures.empty())
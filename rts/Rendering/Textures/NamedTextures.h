@@ -5,6 +5,8 @@
 
 #include <string>
 
+#include "System/StringAtoms.h"
+
 namespace CNamedTextures {
 	void Init();
 	void Kill(bool shutdown = false);
@@ -18,6 +20,8 @@ namespace CNamedTextures {
 	void Update();
 
 	bool Bind(const std::string& texName);
+	/// same as Bind(StringAtoms::GetString(texAtom)), without hashing the name once cached
+	bool Bind(StringAtoms::atom_t texAtom);
 	bool Free(const std::string& texName);
 
 	struct TexInfo {
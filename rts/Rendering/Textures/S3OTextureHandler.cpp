@@ -58,21 +58,69 @@ CS3OTextureHandler::~CS3OTextureHandler()
 }
 
 
+static void LoadBitmap(CBitmap* bitmap, const S3DModel* model, unsigned int texNum, bool invertAxis, bool invertAlpha)
+{
+	const auto& textureName = model->texs[texNum];
+
+	if (!bitmap->Load(textureName) && !bitmap->Load("unittextures/" + textureName)) {
+		if (texNum == 0)
+			LOG_L(L_WARNING, "[%s] could not load primary texture \"%s\" from model \"%s\"", __func__, textureName.c_str(), model->name.c_str());
+
+		// file not found (or headless build), set a single pixel so model is visible
+		bitmap->AllocDummy(SColor(255 * (texNum == 0), 0, 0, 255 * (1 - invertAlpha)));
+	}
+
+	if (invertAxis)
+		bitmap->ReverseYAxis();
+	if (invertAlpha)
+		bitmap->InvertAlpha();
+}
+
+
 void CS3OTextureHandler::PreloadTexture(S3DModel* model, bool invertAxis, bool invertAlpha)
 {
-	cacheMutex.lock();
-	LoadAndCacheTexture(model, 0, invertAxis, invertAlpha, true);
-	LoadAndCacheTexture(model, 1, invertAxis,       false, true); // never invert alpha for tex2
-	cacheMutex.unlock();
+	PreloadBitmap(model, 0, invertAxis, invertAlpha);
+	PreloadBitmap(model, 1, invertAxis,       false); // never invert alpha for tex2
+}
+
+void CS3OTextureHandler::PreloadBitmap(const S3DModel* model, unsigned int texNum, bool invertAxis, bool invertAlpha)
+{
+	const auto& textureName = model->texs[texNum];
+
+	{
+		std::lock_guard<spring::mutex> lock(cacheMutex);
+
+		// already a texture, preloaded, or being decoded by another thread
+		if (textureCache.find(textureName) != textureCache.end())
+			return;
+		if (bitmapCache.find(textureName) != bitmapCache.end())
+			return;
+		if (!pendingBitmaps.insert(textureName).second)
+			return;
+	}
+
+	// decode outside the lock so textures of different models load in parallel;
+	// don't generate a texture yet (no GL context here), just save the bitmap
+	CBitmap bitmap;
+	LoadBitmap(&bitmap, model, texNum, invertAxis, invertAlpha);
+
+	{
+		std::lock_guard<spring::mutex> lock(cacheMutex);
+
+		bitmapCache[textureName] = std::move(bitmap);
+		pendingBitmaps.erase(textureName);
+	}
+
+	pendingCond.notify_all();
 }
 
 
 void CS3OTextureHandler::LoadTexture(S3DModel* model)
 {
-	cacheMutex.lock();
+	std::unique_lock<spring::mutex> lock(cacheMutex);
 
-	const unsigned int tex1ID = LoadAndCacheTexture(model, 0, false, false, false);
-	const unsigned int tex2ID = LoadAndCacheTexture(model, 1, false, false, false);
+	const unsigned int tex1ID = LoadAndCacheTexture(lock, model, 0);
+	const unsigned int tex2ID = LoadAndCacheTexture(lock, model, 1);
 
 	const auto texTableIter = textureTable.find(TEX_MAT_UID(tex1ID, tex2ID));
 
@@ -83,67 +131,35 @@ void CS3OTextureHandler::LoadTexture(S3DModel* model)
 	} else {
 		model->textureType = texTableIter->second;
 	}
-
-	cacheMutex.unlock();
 }
 
-unsigned int CS3OTextureHandler::LoadAndCacheTexture(
-	const S3DModel* model,
-	unsigned int texNum,
-	bool invertAxis,
-	bool invertAlpha,
-	bool preloadCall
-) {
-	CBitmap* bitmap = nullptr;
-
+unsigned int CS3OTextureHandler::LoadAndCacheTexture(std::unique_lock<spring::mutex>& lock, const S3DModel* model, unsigned int texNum)
+{
 	const auto& textureName = model->texs[texNum];
+
+	// the bitmap may still be decoding on a preloading thread
+	pendingCond.wait(lock, [&]() { return (pendingBitmaps.find(textureName) == pendingBitmaps.end()); });
+
 	const auto textureIt = textureCache.find(textureName);
 
 	if (textureIt != textureCache.end())
 		return textureIt->second.texID;
 
-	const auto bitmapIt = bitmapCache.find(textureName);
-
-	if (bitmapIt != bitmapCache.end()) {
-		// bitmap was previously preloaded but not yet loaded
-		// if !preloading, we will now turn the bitmap into a
-		// texture and cache it
-		bitmap = &(bitmapIt->second);
-	} else {
-		// bitmap was not yet preloaded, meaning we are the
-		// first to (all non-3DO model textures are always
-		// preloaded)
-		assert(preloadCall);
-
-		auto pair = bitmapCache.emplace(textureName, {});
-		auto iter = pair.first;
-
-		bitmap = &(iter->second);
-
-		if (!bitmap->Load(textureName) && !bitmap->Load("unittextures/" + textureName)) {
-			if (texNum == 0)
-				LOG_L(L_WARNING, "[%s] could not load primary texture \"%s\" from model \"%s\"", __func__, textureName.c_str(), model->name.c_str());
-
-			// file not found (or headless build), set a single pixel so model is visible
-			bitmap->AllocDummy(SColor(255 * (texNum == 0), 0, 0, 255 * (1 - invertAlpha)));
-		}
-
-		if (invertAxis)
-			bitmap->ReverseYAxis();
-		if (invertAlpha)
-			bitmap->InvertAlpha();
+	if (bitmapCache.find(textureName) == bitmapCache.end()) {
+		// all non-3DO model textures are always preloaded
+		assert(false);
+		LoadBitmap(&bitmapCache[textureName], model, texNum, false, false);
 	}
 
-	// don't generate a texture yet, just save the bitmap for later
-	if (preloadCall)
-		return 0;
-
-	const unsigned int texID = bitmap->CreateMipMapTexture();
+	// bitmap was previously preloaded but not yet loaded,
+	// turn it into a texture and cache it
+	const CBitmap& bitmap = bitmapCache[textureName];
+	const unsigned int texID = bitmap.CreateMipMapTexture();
 
 	textureCache[textureName] = {
 		texID,
-		static_cast<unsigned int>(bitmap->xsize),
-		static_cast<unsigned int>(bitmap->ysize)
+		static_cast<unsigned int>(bitmap.xsize),
+		static_cast<unsigned int>(bitmap.ysize)
 	};
 
 	bitmapCache.erase(textureName);
@@ -9,6 +9,7 @@
 #include "Bitmap.h"
 #include "System/Threading/SpringThreading.h"
 #include "System/UnorderedMap.hpp"
+#include "System/UnorderedSet.hpp"
 
 struct S3DModel;
 class CBitmap;
@@ -50,13 +51,8 @@ public:
 	}
 
 private:
-	unsigned int LoadAndCacheTexture(
-		const S3DModel* model,
-		unsigned int texNum,
-		bool invertAxis,
-		bool invertAlpha,
-		bool preloadCall
-	);
+	void PreloadBitmap(const S3DModel* model, unsigned int texNum, bool invertAxis, bool invertAlpha);
+	unsigned int LoadAndCacheTexture(std::unique_lock<spring::mutex>& lock, const S3DModel* model, unsigned int texNum);
 	unsigned int InsertTextureMat(const S3DModel* model);
 
 private:
@@ -68,7 +64,11 @@ private:
 	TextureTable textureTable; // stores (primary, secondary) texture-pairs by unique ident
 	BitmapCache bitmapCache;
 
+	// names of bitmaps being decoded (without holding cacheMutex)
+	spring::unsynced_set<std::string> pendingBitmaps;
+
 	spring::mutex cacheMutex;
+	spring::condition_variable_any pendingCond;
 
 	std::vector<S3OTexMat> textures;
 };
@@ -0,0 +1,201 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "SkylineAtlasAlloc.h"
+
+#include <algorithm>
+#include <cassert>
+#include <limits>
+
+
+// texture spacing in the atlas (in pixels)
+#define TEXMARGIN 2
+
+
+bool CSkylineAtlasAlloc::IncreaseSize()
+{
+	// same growth policy as the legacy allocator, keeps the atlas roughly square
+	if (atlasSize.y < atlasSize.x) {
+		if ((atlasSize.y * 2) <= maxsize.y) {
+			atlasSize.y *= 2;
+			return true;
+		}
+		if ((atlasSize.x * 2) <= maxsize.x) {
+			atlasSize.x *= 2;
+			return true;
+		}
+	} else {
+		if ((atlasSize.x * 2) <= maxsize.x) {
+			atlasSize.x *= 2;
+			return true;
+		}
+		if ((atlasSize.y * 2) <= maxsize.y) {
+			atlasSize.y *= 2;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+
+int CSkylineAtlasAlloc::FindRestingHeight(size_t i, int w, int h) const
+{
+	const int x = skyline[i].x;
+
+	if ((x + w) > atlasSize.x)
+		return -1;
+
+	int y = 0;
+	int remWidth = w;
+
+	// the block rests on the highest segment it spans
+	for (size_t j = i; remWidth > 0; j++) {
+		assert(j < skyline.size());
+
+		y = std::max(y, skyline[j].y);
+		remWidth -= skyline[j].width;
+	}
+
+	if ((y + h) > atlasSize.y)
+		return -1;
+
+	return y;
+}
+
+void CSkylineAtlasAlloc::AddBlock(size_t i, int w, int h, int y)
+{
+	const int x = skyline[i].x;
+
+	skyline.insert(skyline.begin() + i, {x, y + h, w});
+
+	// shrink or remove the segments now covered by the block
+	for (size_t j = i + 1; j < skyline.size(); ) {
+		Segment& s = skyline[j];
+
+		const int overlap = (x + w) - s.x;
+
+		if (overlap <= 0)
+			break;
+
+		if (overlap < s.width) {
+			s.x += overlap;
+			s.width -= overlap;
+			break;
+		}
+
+		skyline.erase(skyline.begin() + j);
+	}
+
+	// merge neighbours of equal height
+	for (size_t j = 0; (j + 1) < skyline.size(); ) {
+		if (skyline[j].y != skyline[j + 1].y) {
+			j++;
+			continue;
+		}
+
+		skyline[j].width += skyline[j + 1].width;
+		skyline.erase(skyline.begin() + j + 1);
+	}
+}
+
+
+bool CSkylineAtlasAlloc::AllocateEntries(const std::vector<SAtlasEntry*>& sortedEntries, int2& usedSize)
+{
+	skyline.clear();
+	skyline.push_back({0, 0, atlasSize.x});
+
+	usedSize = {0, 0};
+
+	for (SAtlasEntry* entry: sortedEntries) {
+		const int w = entry->size.x + TEXMARGIN;
+		const int h = entry->size.y + TEXMARGIN;
+
+		size_t bestIdx = skyline.size();
+
+		int bestTop = std::numeric_limits<int>::max();
+		int bestWidth = std::numeric_limits<int>::max();
+		int bestY = 0;
+
+		for (size_t i = 0; i < skyline.size(); i++) {
+			const int y = FindRestingHeight(i, w, h);
+
+			if (y < 0)
+				continue;
+
+			// lowest top edge first, then the narrowest segment to keep wide ones free
+			if ((y + h) > bestTop)
+				continue;
+			if ((y + h) == bestTop && skyline[i].width >= bestWidth)
+				continue;
+
+			bestIdx = i;
+			bestTop = y + h;
+			bestWidth = skyline[i].width;
+			bestY = y;
+		}
+
+		if (bestIdx == skyline.size())
+			return false;
+
+		const int x = skyline[bestIdx].x;
+
+		entry->texCoords.x1 = x;
+		entry->texCoords.y1 = bestY;
+		entry->texCoords.x2 = x + entry->size.x - 1;
+		entry->texCoords.y2 = bestY + entry->size.y - 1;
+
+		usedSize.x = std::max(usedSize.x, x + w);
+		usedSize.y = std::max(usedSize.y, bestTop);
+
+		AddBlock(bestIdx, w, h, bestY);
+	}
+
+	return true;
+}
+
+
+bool CSkylineAtlasAlloc::Allocate()
+{
+	atlasSize.x = 32;
+	atlasSize.y = 32;
+
+	typedef decltype(entries)::value_type EntryPair;
+
+	std::vector<EntryPair*> sortedPairs;
+	std::vector<SAtlasEntry*> sortedEntries;
+
+	sortedPairs.reserve(entries.size());
+	sortedEntries.reserve(entries.size());
+
+	for (auto& pair: entries) {
+		sortedPairs.push_back(&pair);
+	}
+
+	// tallest first; names as tie-breaker so the layout does not depend on hash order
+	std::sort(sortedPairs.begin(), sortedPairs.end(), [](const EntryPair* a, const EntryPair* b) {
+		if (a->second.size.y != b->second.size.y)
+			return (a->second.size.y > b->second.size.y);
+		if (a->second.size.x != b->second.size.x)
+			return (a->second.size.x > b->second.size.x);
+
+		return (a->first < b->first);
+	});
+
+	for (EntryPair* pair: sortedPairs) {
+		sortedEntries.push_back(&pair->second);
+	}
+
+	int2 usedSize;
+
+	while (!AllocateEntries(sortedEntries, usedSize)) {
+		if (!IncreaseSize())
+			return false;
+	}
+
+	skyline.clear();
+
+	if (npot)
+		atlasSize = usedSize;
+
+	return true;
+}
@@ -0,0 +1,43 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SKYLINE_ATLAS_ALLOC_H
+#define SKYLINE_ATLAS_ALLOC_H
+
+#include <vector>
+
+#include "IAtlasAllocator.h"
+
+
+/**
+ * @brief bottom-left skyline packer
+ *
+ * Keeps the top contour of everything placed so far as a list of horizontal
+ * segments and puts each texture (tallest first) where its top edge ends up
+ * lowest. Wastes noticeably less space than the legacy shelf allocator when
+ * texture heights vary, i.e. produces smaller atlases.
+ */
+class CSkylineAtlasAlloc : public IAtlasAllocator
+{
+public:
+	virtual bool Allocate();
+	virtual int GetMaxMipMaps() { return 0; }
+
+private:
+	struct Segment {
+		int x;
+		int y;
+		int width;
+	};
+
+	bool IncreaseSize();
+	bool AllocateEntries(const std::vector<SAtlasEntry*>& sortedEntries, int2& usedSize);
+
+	/// @return y-position a block of width w would rest at if placed on segment i, or -1
+	int FindRestingHeight(size_t i, int w, int h) const;
+	void AddBlock(size_t i, int w, int h, int y);
+
+private:
+	std::vector<Segment> skyline;
+};
+
+#endif // SKYLINE_ATLAS_ALLOC_H
@@ -6,6 +6,7 @@
 #include "Bitmap.h"
 #include "LegacyAtlasAlloc.h"
 #include "QuadtreeAtlasAlloc.h"
+#include "SkylineAtlasAlloc.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/PBO.h"
@@ -13,6 +14,7 @@
 #include "System/Log/ILog.h"
 #include "System/StringUtil.h"
 #include "System/Exceptions.h"
+#include "System/Threading/ThreadPool.h"
 
 #include <cstring>
 
@@ -37,6 +39,7 @@ CTextureAtlas::CTextureAtlas(unsigned int allocType)
 	switch (allocType) {
 		case ATLAS_ALLOC_LEGACY: { atlasAllocator = new CLegacyAtlasAlloc(); } break;
 		case ATLAS_ALLOC_QUADTREE: { atlasAllocator = new CQuadtreeAtlasAlloc(); } break;
+		case ATLAS_ALLOC_SKYLINE: { atlasAllocator = new CSkylineAtlasAlloc(); } break;
 		default: { assert(false); } break;
 	}
 
@@ -96,21 +99,63 @@ size_t CTextureAtlas::AddTexFromFile(std::string name, std::string file)
 		return (it->second);
 	}
 
+	memTextures.emplace_back();
+	MemTex& tex = memTextures.back();
+
+	tex.names.emplace_back(std::move(name));
+	tex.file = std::move(file);
+
+	return (files[lcFile] = memTextures.size() - 1);
+}
+
+void CTextureAtlas::LoadPendingFiles()
+{
+	std::vector<size_t> pendingTexIndices;
+
+	for (size_t i = 0; i < memTextures.size(); i++) {
+		if (!memTextures[i].file.empty())
+			pendingTexIndices.push_back(i);
+	}
+
+	if (pendingTexIndices.empty())
+		return;
+
+	std::vector<CBitmap> bitmaps(pendingTexIndices.size());
+	std::vector<uint8_t> loaded(pendingTexIndices.size(), 0);
+
+	// reading and converting is independent per file (DevIL itself is serialized by CBitmap)
+	for_mt(0, pendingTexIndices.size(), [&](const int i) {
+		loaded[i] = bitmaps[i].Load(memTextures[pendingTexIndices[i]].file);
+	});
+
+	for (size_t i = 0; i < pendingTexIndices.size(); i++) {
+		MemTex& tex = memTextures[pendingTexIndices[i]];
+		CBitmap& bitmap = bitmaps[i];
 
-	CBitmap bitmap;
-	if (!bitmap.Load(file))
-		throw content_error("Could not load texture from file " + file);
+		if (!loaded[i])
+			throw content_error("Could not load texture from file " + tex.file);
 
-	// only suport RGBA for now
-	if (bitmap.channels != 4 || bitmap.compressed)
-		throw content_error("Unsupported bitmap format in file " + file);
+		// only suport RGBA for now
+		if (bitmap.channels != 4 || bitmap.compressed)
+			throw content_error("Unsupported bitmap format in file " + tex.file);
 
-	return (files[lcFile] = AddTexFromMem(std::move(name), bitmap.xsize, bitmap.ysize, RGBA32, bitmap.GetRawMem()));
+		tex.xsize = bitmap.xsize;
+		tex.ysize = bitmap.ysize;
+		tex.texType = RGBA32;
+		tex.mem.resize((tex.xsize * tex.ysize * GetBPP(tex.texType)) / 8, 0);
+		tex.file.clear();
+
+		std::memcpy(tex.mem.data(), bitmap.GetRawMem(), tex.mem.size());
+
+		atlasAllocator->AddEntry(tex.names[0], int2(tex.xsize, tex.ysize));
+	}
 }
 
 
 bool CTextureAtlas::Finalize()
 {
+	LoadPendingFiles();
+
 	const bool success = atlasAllocator->Allocate() && (initialized = CreateTexture());
 
 	memTextures.clear();
@@ -37,6 +37,7 @@ public:
 	enum {
 		ATLAS_ALLOC_LEGACY   = 0,
 		ATLAS_ALLOC_QUADTREE = 1,
+		ATLAS_ALLOC_SKYLINE  = 2,
 	};
 
 public:
@@ -45,7 +46,7 @@ public:
 
 	// add a texture from a memory pointer
 	size_t AddTexFromMem(std::string name, int xsize, int ysize, TextureType texType, void* data);
-	// add a texture from a file
+	// add a texture from a file; decoded (in parallel with all others) by Finalize
 	size_t AddTexFromFile(std::string name, std::string file);
 	// add a blank texture
 	size_t AddTex(std::string name, int xsize, int ysize, TextureType texType = RGBA32);
@@ -108,6 +109,7 @@ protected:
 		}
 	}
 	bool CreateTexture();
+	void LoadPendingFiles();
 
 protected:
 	IAtlasAllocator* atlasAllocator;
@@ -126,6 +128,7 @@ protected:
 
 			names = std::move(t.names);
 			mem = std::move(t.mem);
+			file = std::move(t.file);
 			return *this;
 		}
 
@@ -137,6 +140,9 @@ protected:
 
 		std::vector<std::string> names;
 		std::vector<char> mem;
+
+		// non-empty until the texture has been loaded from this file
+		std::string file;
 	};
 
 	std::string name;
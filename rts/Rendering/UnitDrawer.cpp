@@ -40,12 +40,16 @@
 #include "Sim/Units/UnitDef.h"
 #include "Sim/Units/UnitDefHandler.h"
 #include "Sim/Units/Unit.h"
+#include "Sim/Units/UnitHandler.h"
 
 #include "System/Config/ConfigHandler.h"
 #include "System/ContainerUtil.h"
 #include "System/EventHandler.h"
 #include "System/myMath.h"
 #include "System/SafeUtil.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <algorithm>
 
 CUnitDrawer* unitDrawer;
 
@@ -57,6 +61,18 @@ CONFIG(int, MaxDynamicModelLights)
 	.defaultValue(1)
 	.minimumValue(0);
 
+CONFIG(bool, InstancedUnitRendering)
+	.defaultValue(false)
+	.headlessValue(false)
+	.description("Draw opaque units sharing a model and team with a single instanced call; units with custom materials, Lua draw callins or nano-frames are unaffected.");
+
+CONFIG(bool, InterpolateUnitDrawPos)
+	.defaultValue(false)
+	.headlessValue(false)
+	.description("Draw units between their positions at the end of the last two sim frames (one frame behind), instead of extrapolating along their current speed; keeps motion smooth on uneven or slow sim frames.");
+
+static ConfigHandle<bool> interpolateUnitDrawPos("InterpolateUnitDrawPos");
+
 
 
 
@@ -177,17 +193,32 @@ static const SetTeamColorFunc setTeamColorFuncs[] = {
 
 
 
+// {texType, mdlType, shadow-pass} of the last BindModelTypeTexture call
+// since the most recent Push/PopModelRenderState; drawers visit objects
+// in texture-bin order, but bins of different quads (features) or model
+// sets (instanced units, projectiles) share textures and would otherwise
+// re-bind them
+static int boundModelTexKey = -1;
+
 // low-level (batch and solo)
 // note: also called during SP
 void CUnitDrawer::BindModelTypeTexture(int mdlType, int texType) {
-	const auto texFun = bindModelTexFuncs[shadowHandler->InShadowPass()][mdlType];
+	const int shadowPass = shadowHandler->InShadowPass();
+	const int texKey = ((texType * MODELTYPE_OTHER + mdlType) * 2) + shadowPass;
+
+	if (texKey == boundModelTexKey)
+		return;
+
+	const auto texFun = bindModelTexFuncs[shadowPass][mdlType];
 	const auto texMat = texturehandlerS3O->GetTexture(texType);
 
 	texFun(texMat);
+	boundModelTexKey = texKey;
 }
 
-void CUnitDrawer::PushModelRenderState(int mdlType) { renderStatePushFuncs[mdlType](); }
-void CUnitDrawer::PopModelRenderState (int mdlType) { renderStatePopFuncs [mdlType](); }
+// anything may bind textures between these, so forget the last model texture
+void CUnitDrawer::PushModelRenderState(int mdlType) { renderStatePushFuncs[mdlType](); boundModelTexKey = -1; }
+void CUnitDrawer::PopModelRenderState (int mdlType) { renderStatePopFuncs [mdlType](); boundModelTexKey = -1; }
 
 // mid-level (solo only)
 void CUnitDrawer::PushModelRenderState(const S3DModel* m) {
@@ -208,6 +239,7 @@ void CUnitDrawer::PopModelRenderState(const CSolidObject* o) { PopModelRenderSta
 CUnitDrawer::CUnitDrawer(): CEventClient("[CUnitDrawer]", 271828, false)
 {
 	eventHandler.AddClient(this);
+	eventHandler.GetUnitLosChannel().Subscribe(this, &UnitLosChanged);
 
 	LuaObjectDrawer::ReadLODScales(LUAOBJ_UNIT);
 	SetUnitDrawDist((float)configHandler->GetInt("UnitLodDist"));
@@ -238,6 +270,10 @@ CUnitDrawer::CUnitDrawer(): CEventClient("[CUnitDrawer]", 271828, false)
 	}
 
 	deadGhostBuildings.resize(teamHandler->ActiveAllyTeams());
+	ghostCellDims.x = (mapDims.mapx * SQUARE_SIZE + GHOST_CELL_SIZE - 1) / GHOST_CELL_SIZE;
+	ghostCellDims.y = (mapDims.mapy * SQUARE_SIZE + GHOST_CELL_SIZE - 1) / GHOST_CELL_SIZE;
+	deadGhostCells.resize(teamHandler->ActiveAllyTeams(), std::vector<std::vector<GhostSolidObject*>>(ghostCellDims.x * ghostCellDims.y));
+	newDeadGhosts.resize(teamHandler->ActiveAllyTeams());
 	liveGhostBuildings.resize(teamHandler->ActiveAllyTeams());
 
 	// LH must be initialized before drawer-state is initialized
@@ -259,6 +295,7 @@ CUnitDrawer::CUnitDrawer(): CEventClient("[CUnitDrawer]", 271828, false)
 	wireFrameMode = false;
 
 	unitDrawerStates[DRAWER_STATE_SSP]->Init(this);
+	drawInstanced = configHandler->GetBool("InstancedUnitRendering") && unitDrawerStates[DRAWER_STATE_SSP]->CanDrawInstanced();
 	cubeMapHandler->Init(); // can only fail if FBO's are invalid
 
 	// note: state must be pre-selected before the first drawn frame
@@ -269,6 +306,7 @@ CUnitDrawer::CUnitDrawer(): CEventClient("[CUnitDrawer]", 271828, false)
 CUnitDrawer::~CUnitDrawer()
 {
 	eventHandler.RemoveClient(this);
+	eventHandler.GetUnitLosChannel().Unsubscribe(this);
 
 	unitDrawerStates[DRAWER_STATE_NOP]->Kill(); IUnitDrawerState::FreeInstance(unitDrawerStates[DRAWER_STATE_NOP]);
 	unitDrawerStates[DRAWER_STATE_SSP]->Kill(); IUnitDrawerState::FreeInstance(unitDrawerStates[DRAWER_STATE_SSP]);
@@ -301,6 +339,8 @@ CUnitDrawer::~CUnitDrawer()
 		}
 	}
 	deadGhostBuildings.clear();
+	deadGhostCells.clear();
+	newDeadGhosts.clear();
 	liveGhostBuildings.clear();
 
 
@@ -356,6 +396,27 @@ void CUnitDrawer::Update()
 	}
 }
 
+void CUnitDrawer::UpdatePieceMatrices()
+{
+	// refresh the piece-matrices of all units likely to be drawn this frame
+	// across threads; the per-unit updates done while drawing (and by the
+	// instanced path) are then no-ops, units culled differently by another
+	// pass still update lazily
+	for_mt(0, unsortedUnits.size(), [&](const int i) {
+		CUnit* unit = unsortedUnits[i];
+
+		if (unit->noDraw || unit->isIcon || unit->IsInVoid())
+			return;
+		if (!(unit->losStatus[gu->myAllyTeam] & LOS_INLOS) && !gu->spectatingFullView)
+			return;
+		if (!camera->InView(unit->drawMidPos, unit->GetDrawRadius()))
+			return;
+
+		// each LocalModel owns its pieces, nothing is shared between units
+		unit->localModel.UpdatePieceMatrices(gs->frameNum);
+	});
+}
+
 
 
 
@@ -390,6 +451,8 @@ void CUnitDrawer::DrawOpaquePass(bool deferredPass)
 	if (inWaterRefrPass)
 		unitDrawerStates[DRAWER_STATE_SEL]->SetWaterClipPlane(DrawPass::WaterRefraction);
 
+	CullUnits(inWaterReflPass, inWaterRefrPass, false);
+
 	for (int modelType = MODELTYPE_3DO; modelType < MODELTYPE_OTHER; modelType++) {
 		PushModelRenderState(modelType);
 		DrawOpaqueUnits(modelType, inWaterReflPass, inWaterRefrPass);
@@ -400,7 +463,6 @@ void CUnitDrawer::DrawOpaquePass(bool deferredPass)
 	ResetOpaqueDrawing(deferredPass);
 
 	// draw all custom'ed units that were bypassed in the loop above
-	LuaObjectDrawer::SetDrawPassGlobalLODFactor(LUAOBJ_UNIT);
 	LuaObjectDrawer::DrawOpaqueMaterialObjects(LUAOBJ_UNIT, deferredPass);
 }
 
@@ -420,11 +482,14 @@ void CUnitDrawer::DrawOpaqueUnits(int modelType, bool drawReflection, bool drawR
 			DrawOpaqueUnit(unit, drawReflection, drawRefraction);
 		}
 	}
+
+	DrawInstancedUnits(modelType);
 }
 
 inline void CUnitDrawer::DrawOpaqueUnit(CUnit* unit, bool drawReflection, bool drawRefraction)
 {
-	if (!CanDrawOpaqueUnit(unit, drawReflection, drawRefraction))
+	// set by CullUnits via CanDrawOpaqueUnit
+	if (!unitVisibility[unit->id])
 		return;
 
 	if ((unit->pos).SqDistance(camera->GetPos()) > (unit->sqRadius * unitDrawDistSqr)) {
@@ -432,14 +497,86 @@ inline void CUnitDrawer::DrawOpaqueUnit(CUnit* unit, bool drawReflection, bool d
 		return;
 	}
 
-	if (LuaObjectDrawer::AddOpaqueMaterialObject(unit, LUAOBJ_UNIT))
+	// LOD was selected by CullUnits
+	if (LuaObjectDrawer::AddPreparedMaterialObject(unit, LUAOBJ_UNIT, LuaObjectDrawer::GetDrawPassOpaqueMat()))
+		return;
+
+	// deferred until all units of this model-type have been visited
+	if (CanDrawInstancedUnit(unit)) {
+		instancedUnits.push_back(unit);
 		return;
+	}
 
 	// draw the unit with the default (non-Lua) material
 	SetTeamColour(unit->team);
 	DrawUnitDefTrans(unit, false, false);
 }
 
+void CUnitDrawer::DrawInstancedUnits(int modelType)
+{
+	if (instancedUnits.empty())
+		return;
+
+	const IUnitDrawerState* state = unitDrawerStates[DRAWER_STATE_SEL];
+
+	// group by bin first so each texture is bound only once
+	std::sort(instancedUnits.begin(), instancedUnits.end(), [](const CUnit* a, const CUnit* b) {
+		if (a->model->textureType != b->model->textureType)
+			return (a->model->textureType < b->model->textureType);
+		if (a->model != b->model)
+			return (a->model->id < b->model->id);
+
+		return (a->team < b->team);
+	});
+
+	instanceMatrices.clear();
+
+	for (const CUnit* unit: instancedUnits) {
+		LocalModel* model = const_cast<LocalModel*>(&unit->localModel);
+
+		model->UpdatePieceMatrices(gs->frameNum);
+
+		const std::vector<CMatrix44f>& pieceMats = model->GetPieceMatrices();
+
+		instanceMatrices.push_back(unit->GetTransformMatrix());
+		instanceMatrices.insert(instanceMatrices.end(), pieceMats.begin(), pieceMats.end());
+	}
+
+	// false if the buffer can not hold all matrices, units are then drawn separately
+	const bool batched = state->SetInstanceMatrices(instanceMatrices.data(), instanceMatrices.size());
+
+	for (size_t i = 0, j = 0, matrixIdx = 0; i < instancedUnits.size(); i = j) {
+		const CUnit* unit = instancedUnits[i];
+		const S3DModel* model = unit->model;
+
+		const size_t numInstanceMats = 1 + unit->localModel.GetPieceMatrices().size();
+
+		for (j = i + 1; j < instancedUnits.size(); j++) {
+			if (instancedUnits[j]->model != model || instancedUnits[j]->team != unit->team)
+				break;
+		}
+
+		if (i == 0 || instancedUnits[i - 1]->model->textureType != model->textureType)
+			BindModelTypeTexture(modelType, model->textureType);
+
+		SetTeamColour(unit->team);
+
+		if (batched) {
+			state->SetInstanceParams(matrixIdx, numInstanceMats);
+			model->DrawInstanced(j - i);
+		} else {
+			for (size_t k = i; k < j; k++) {
+				DrawUnitDefTrans(instancedUnits[k], false, false);
+			}
+		}
+
+		matrixIdx += ((j - i) * numInstanceMats);
+	}
+
+	state->SetInstanceParams(0, 0);
+	instancedUnits.clear();
+}
+
 
 void CUnitDrawer::DrawOpaqueAIUnits(int modelType)
 {
@@ -489,11 +626,50 @@ void CUnitDrawer::DrawUnitIcons()
 	if (globalRendering->msaaLevel >= 4)
 		glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
 
-	for (CUnit* u: iconUnits) {
+	iconQuads.resize(iconUnits.size());
+
+	// positions and sizes are independent per unit, compute them in parallel
+	for_mt(0, iconUnits.size(), [&](const int i) {
+		CUnit* u = iconUnits[i];
+
 		const unsigned short closBits = (u->losStatus[gu->myAllyTeam] & (LOS_INLOS                  ));
 		const unsigned short plosBits = (u->losStatus[gu->myAllyTeam] & (LOS_PREVLOS | LOS_CONTRADAR));
 
-		DrawIcon(u, !gu->spectatingFullView && closBits == 0 && plosBits != (LOS_PREVLOS | LOS_CONTRADAR));
+		GetIconQuad(u, !gu->spectatingFullView && closBits == 0 && plosBits != (LOS_PREVLOS | LOS_CONTRADAR), iconQuads[i]);
+	});
+
+	// group by icon type so each type needs only one texture bind and draw
+	std::sort(iconQuads.begin(), iconQuads.end(), [](const UnitIconQuad& a, const UnitIconQuad& b) { return (a.iconData < b.iconData); });
+
+	const float3 camUp    = camera->GetUp();
+	const float3 camRight = camera->GetRight();
+
+	for (size_t i = 0, j = 0, n = iconQuads.size(); i < n; i = j) {
+		const icon::CIconData* iconData = iconQuads[i].iconData;
+
+		for (j = i + 1; j < n && iconQuads[j].iconData == iconData; j++);
+
+		CVertexArray* va = GetVertexArray();
+
+		va->Initialize();
+		va->EnlargeArrays((j - i) * 4, 0, VA_SIZE_TC);
+
+		for (size_t k = i; k < j; k++) {
+			const UnitIconQuad& q = iconQuads[k];
+
+			const float3 dy = camUp    * q.scale;
+			const float3 dx = camRight * q.scale;
+			const float3 vn = q.pos - dx;
+			const float3 vp = q.pos + dx;
+
+			va->AddVertexQTC(vn - dy, 0.0f, 1.0f, q.color);
+			va->AddVertexQTC(vp - dy, 1.0f, 1.0f, q.color);
+			va->AddVertexQTC(vp + dy, 1.0f, 0.0f, q.color);
+			va->AddVertexQTC(vn + dy, 0.0f, 0.0f, q.color);
+		}
+
+		iconData->BindTexture();
+		va->DrawArrayTC(GL_QUADS);
 	}
 
 	glPopAttrib();
@@ -504,6 +680,60 @@ void CUnitDrawer::DrawUnitIcons()
 /******************************************************************************/
 /******************************************************************************/
 
+void CUnitDrawer::CullUnits(bool drawReflection, bool drawRefraction, bool shadowPass)
+{
+	const CCamera* cam = CCamera::GetActiveCamera();
+	const LuaMatType matType = shadowPass? LuaObjectDrawer::GetDrawPassShadowMat(): LuaObjectDrawer::GetDrawPassOpaqueMat();
+
+	// LOD's are selected below, so the factor has to be set first
+	LuaObjectDrawer::SetDrawPassGlobalLODFactor(LUAOBJ_UNIT);
+
+	{
+		CullState cullState;
+		cullState.cam = cam;
+		cullState.camPos = cam->GetPos();
+		cullState.camDir = cam->GetDir();
+		cullState.lodFactor = LuaObjectMaterialData::GetGlobalLODFactor(LUAOBJ_UNIT);
+		cullState.drawFrame = globalRendering->drawFrame;
+		cullState.passFlags = (drawReflection << 0) | (drawRefraction << 1) | (shadowPass << 2);
+
+		const bool sameState =
+			cullState.cam == lastCullState.cam &&
+			cullState.camPos == lastCullState.camPos &&
+			cullState.camDir == lastCullState.camDir &&
+			cullState.lodFactor == lastCullState.lodFactor &&
+			cullState.drawFrame == lastCullState.drawFrame &&
+			cullState.passFlags == lastCullState.passFlags;
+
+		// no sim-frame (or other pass) in between, visibility and LOD's still hold
+		if (sameState && unitVisibility.size() == unitHandler->MaxUnits())
+			return;
+
+		lastCullState = cullState;
+	}
+
+	unitVisibility.resize(unitHandler->MaxUnits(), 0);
+
+	// run the visibility tests against the active camera for all units at
+	// once and across threads, the opaque draw-loops only read the results
+	// (each unit writes its own byte, so no two threads share an element)
+	// custom-material units also get their LOD for this pass selected here
+	for_mt(0, unsortedUnits.size(), [&](const int i) {
+		CUnit* unit = unsortedUnits[i];
+
+		if (shadowPass) {
+			unitVisibility[unit->id] = CanDrawOpaqueUnitShadow(unit);
+		} else {
+			unitVisibility[unit->id] = CanDrawOpaqueUnit(unit, drawReflection, drawRefraction);
+		}
+
+		if (unitVisibility[unit->id] == 0)
+			return;
+
+		LuaObjectDrawer::PrepareObjectLOD(unit, LUAOBJ_UNIT, matType);
+	});
+}
+
 bool CUnitDrawer::CanDrawOpaqueUnit(
 	const CUnit* unit,
 	bool drawReflection,
@@ -534,6 +764,18 @@ bool CUnitDrawer::CanDrawOpaqueUnit(
 	return (cam->InView(unit->drawMidPos, unit->GetDrawRadius()));
 }
 
+bool CUnitDrawer::CanDrawInstancedUnit(const CUnit* unit) const
+{
+	if (!drawInstanced)
+		return false;
+	// Lua may replace or augment the draw
+	if (unit->luaDraw)
+		return false;
+
+	// nano-frames need per-unit clip-planes
+	return (!unit->beingBuilt || !unit->unitDef->showNanoFrame);
+}
+
 bool CUnitDrawer::CanDrawOpaqueUnitShadow(const CUnit* unit) const
 {
 	if (unit->noDraw)
@@ -558,10 +800,11 @@ bool CUnitDrawer::CanDrawOpaqueUnitShadow(const CUnit* unit) const
 
 
 void CUnitDrawer::DrawOpaqueUnitShadow(CUnit* unit) {
-	if (!CanDrawOpaqueUnitShadow(unit))
+	// set by CullUnits via CanDrawOpaqueUnitShadow
+	if (!unitVisibility[unit->id])
 		return;
 
-	if (LuaObjectDrawer::AddShadowMaterialObject(unit, LUAOBJ_UNIT))
+	if (LuaObjectDrawer::AddPreparedMaterialObject(unit, LUAOBJ_UNIT, LuaObjectDrawer::GetDrawPassShadowMat()))
 		return;
 
 	DrawUnitDefTrans(unit, false, false);
@@ -604,6 +847,8 @@ void CUnitDrawer::DrawShadowPass()
 	{
 		assert((CCamera::GetActiveCamera())->GetCamType() == CCamera::CAMTYPE_SHADOW);
 
+		CullUnits(false, false, true);
+
 		// 3DO's have clockwise-wound faces and
 		// (usually) holes, so disable backface
 		// culling for them
@@ -624,13 +869,12 @@ void CUnitDrawer::DrawShadowPass()
 	glDisable(GL_ALPHA_TEST);
 	glDisable(GL_POLYGON_OFFSET_FILL);
 
-	LuaObjectDrawer::SetDrawPassGlobalLODFactor(LUAOBJ_UNIT);
 	LuaObjectDrawer::DrawShadowMaterialObjects(LUAOBJ_UNIT, false);
 }
 
 
 
-void CUnitDrawer::DrawIcon(CUnit* unit, bool useDefaultIcon)
+void CUnitDrawer::GetIconQuad(CUnit* unit, bool useDefaultIcon, UnitIconQuad& quad)
 {
 	// iconUnits should not never contain void-space units, see UpdateUnitIconState
 	assert(!unit->IsInVoid());
@@ -671,25 +915,18 @@ void CUnitDrawer::DrawIcon(CUnit* unit, bool useDefaultIcon)
 	// store the icon size so that we don't have to calculate it again
 	unit->iconRadius = scale;
 
+	quad.iconData = iconData;
+	quad.pos = pos;
+	quad.scale = scale;
+
 	// Is the unit selected? Then draw it white.
 	if (unit->isSelected) {
-		glColor3ub(255, 255, 255);
+		std::fill(quad.color, quad.color + 3, 255);
 	} else {
-		glColor3ubv(teamHandler->Team(unit->team)->color);
+		std::copy(teamHandler->Team(unit->team)->color, teamHandler->Team(unit->team)->color + 3, quad.color);
 	}
 
-	// calculate the vertices
-	const float3 dy = camera->GetUp()    * scale;
-	const float3 dx = camera->GetRight() * scale;
-	const float3 vn = pos - dx;
-	const float3 vp = pos + dx;
-	const float3 vnn = vn - dy;
-	const float3 vpn = vp - dy;
-	const float3 vnp = vn + dy;
-	const float3 vpp = vp + dy;
-
-	// Draw the icon.
-	iconData->Draw(vnn, vpn, vnp, vpp);
+	quad.color[3] = 255;
 }
 
 
@@ -723,6 +960,10 @@ void CUnitDrawer::ResetAlphaDrawing(bool deferredPass)
 
 void CUnitDrawer::DrawAlphaPass()
 {
+	// alpha-materials select their own LOD's (per unit, shared with
+	// the opaque ones) so a later opaque pass has to redo CullUnits
+	lastCullState.drawFrame = -1;
+
 	{
 		SetupAlphaDrawing(false);
 		glDisable(GL_ALPHA_TEST);
@@ -888,28 +1129,114 @@ void CUnitDrawer::DrawAlphaAIUnitBorder(const TempDrawUnit& unit)
 	glEnable(GL_TEXTURE_2D);
 }
 
-void CUnitDrawer::UpdateGhostedBuildings()
+void CUnitDrawer::UpdateDrawPosSnapshots(int frameNum)
+{
+	if (!interpolateUnitDrawPos.Get())
+		return;
+
+	drawPosSnapshots.resize(unitHandler->MaxUnits());
+
+	const int slot = frameNum & 1;
+
+	for (const CUnit* unit: unitHandler->GetActiveUnits()) {
+		DrawPosSnapshot& s = drawPosSnapshots[unit->id];
+
+		// a unit that jumped (e.g. was teleported) is not interpolated
+		if (s.frameNum[slot ^ 1] == (frameNum - 1) && s.pos[slot ^ 1].SqDistance(unit->pos) > Square(unit->speed.w * 4.0f + SQUARE_SIZE * 4.0f))
+			s.frameNum[slot ^ 1] = -1;
+
+		s.pos[slot] = unit->pos;
+		s.frameNum[slot] = frameNum;
+	}
+}
+
+
+int CUnitDrawer::GetGhostCellIndex(const float3& pos) const
+{
+	const int x = Clamp(int(pos.x) / GHOST_CELL_SIZE, 0, ghostCellDims.x - 1);
+	const int z = Clamp(int(pos.z) / GHOST_CELL_SIZE, 0, ghostCellDims.y - 1);
+
+	return (z * ghostCellDims.x + x);
+}
+
+bool CUnitDrawer::UpdateDeadGhost(int allyTeam, GhostSolidObject* gso)
+{
+	if (!losHandler->InLos(gso->pos, allyTeam))
+		return false;
+
+	spring::VectorErase(deadGhostCells[allyTeam][GetGhostCellIndex(gso->pos)], gso);
+	spring::VectorErase(deadGhostBuildings[allyTeam][gso->model->type], gso);
+
+	// obtained LOS on the ghost of a dead building
+	if (!gso->DecRef()) {
+		groundDecals->GhostDestroyed(gso);
+		spring::SafeDelete(gso);
+	}
+
+	return true;
+}
+
+void CUnitDrawer::UpdateGhostedBuildings(bool fullScan)
 {
+	const ILosType& los = losHandler->los;
+
 	for (int allyTeam = 0; allyTeam < deadGhostBuildings.size(); ++allyTeam) {
-		for (int modelType = MODELTYPE_3DO; modelType < MODELTYPE_OTHER; modelType++) {
-			auto& dgb = deadGhostBuildings[allyTeam][modelType];
+		auto& cells = deadGhostCells[allyTeam];
+		auto& ghosts = newDeadGhosts[allyTeam];
 
-			for (size_t i = 0; i < dgb.size(); /*no-op*/) {
-				GhostSolidObject* gso = dgb[i];
+		// ghosts might have been created inside areas that were already
+		// in LOS (before their LOS-status caught up), check these once
+		for (GhostSolidObject* gso: ghosts) {
+			UpdateDeadGhost(allyTeam, gso);
+		}
 
-				if (!losHandler->InLos(gso->pos, allyTeam)) {
-					++i;
-					continue;
+		ghosts.clear();
+
+		if (fullScan || losHandler->globalLOS[allyTeam]) {
+			for (auto& cell: cells) {
+				for (size_t i = 0; i < cell.size(); /*no-op*/) {
+					i += (!UpdateDeadGhost(allyTeam, cell[i]));
 				}
+			}
+
+			continue;
+		}
+
+		// sight is only ever gained where some LOS instance was (re)added, so
+		// only ghosts inside those areas can have become visible this frame
+		ghostCellIndices.clear();
+
+		for (const auto& p: los.gainedRects) {
+			if (p.first != allyTeam)
+				continue;
+
+			const SRectangle& r = p.second;
 
-				// obtained LOS on the ghost of a dead building
-				if (!gso->DecRef()) {
-					groundDecals->GhostDestroyed(gso);
-					spring::SafeDelete(gso);
+			const int x1 = Clamp((r.x1 * los.divisor) / GHOST_CELL_SIZE, 0, ghostCellDims.x - 1);
+			const int z1 = Clamp((r.z1 * los.divisor) / GHOST_CELL_SIZE, 0, ghostCellDims.y - 1);
+			const int x2 = Clamp((r.x2 * los.divisor) / GHOST_CELL_SIZE, 0, ghostCellDims.x - 1);
+			const int z2 = Clamp((r.z2 * los.divisor) / GHOST_CELL_SIZE, 0, ghostCellDims.y - 1);
+
+			for (int z = z1; z <= z2; z++) {
+				for (int x = x1; x <= x2; x++) {
+					const int idx = z * ghostCellDims.x + x;
+
+					if (cells[idx].empty())
+						continue;
+
+					ghostCellIndices.push_back(idx);
 				}
+			}
+		}
 
-				dgb[i] = dgb.back();
-				dgb.pop_back();
+		std::sort(ghostCellIndices.begin(), ghostCellIndices.end());
+		ghostCellIndices.erase(std::unique(ghostCellIndices.begin(), ghostCellIndices.end()), ghostCellIndices.end());
+
+		for (const int idx: ghostCellIndices) {
+			auto& cell = cells[idx];
+
+			for (size_t i = 0; i < cell.size(); /*no-op*/) {
+				i += (!UpdateDeadGhost(allyTeam, cell[i]));
 			}
 		}
 	}
@@ -1397,9 +1724,23 @@ inline void CUnitDrawer::UpdateUnitIconState(CUnit* unit) {
 	iconUnits.push_back(unit);
 }
 
-inline void CUnitDrawer::UpdateUnitDrawPos(CUnit* u) {
+inline void CUnitDrawer::UpdateUnitDrawPos(CUnit* u) const {
 	const CUnit* t = u->GetTransporter();
 
+	if (interpolateUnitDrawPos.Get() && size_t(u->id) < drawPosSnapshots.size()) {
+		const DrawPosSnapshot& s = drawPosSnapshots[u->id];
+
+		const int currSlot = gs->frameNum & 1;
+		const int prevSlot = currSlot ^ 1;
+
+		// units created or teleported this frame have no usable previous position
+		if (s.frameNum[currSlot] == gs->frameNum && s.frameNum[prevSlot] == (gs->frameNum - 1)) {
+			u->drawPos = mix(s.pos[prevSlot], s.pos[currSlot], Clamp(globalRendering->timeOffset, 0.0f, 1.0f));
+			u->drawMidPos = u->GetMdlDrawMidPos();
+			return;
+		}
+	}
+
 	if (t != nullptr) {
 		u->drawPos = u->GetDrawPos(t->speed, globalRendering->timeOffset);
 	} else {
@@ -1689,6 +2030,10 @@ void CUnitDrawer::UpdateUnitMiniMapIcon(const CUnit* unit, bool forced, bool kil
 void CUnitDrawer::RenderUnitCreated(const CUnit* u, int cloaked) {
 	CUnit* unit = const_cast<CUnit*>(u);
 
+	// forget the positions of a previous unit with the same ID
+	if (size_t(u->id) < drawPosSnapshots.size())
+		drawPosSnapshots[u->id] = {};
+
 	if (u->model != nullptr) {
 		if (cloaked) {
 			alphaModelRenderers[MDL_TYPE(u)]->AddUnit(u);
@@ -1736,6 +2081,8 @@ void CUnitDrawer::RenderUnitDestroyed(const CUnit* unit) {
 			// <gso> can be inserted for multiple allyteams
 			// (the ref-counter saves us come deletion time)
 			deadGhostBuildings[allyTeam][gsoModel->type].push_back(gso);
+			deadGhostCells[allyTeam][GetGhostCellIndex(gso->pos)].push_back(gso);
+			newDeadGhosts[allyTeam].push_back(gso);
 			gso->IncRef();
 		}
 
@@ -1773,42 +2120,39 @@ void CUnitDrawer::UnitDecloaked(const CUnit* unit) {
 	}
 }
 
-void CUnitDrawer::UnitEnteredLos(const CUnit* unit, int allyTeam) {
-	CUnit* u = const_cast<CUnit*>(unit); //cleanup
-
-	if (gameSetup->ghostedBuildings && unit->unitDef->IsImmobileUnit())
-		spring::VectorErase(liveGhostBuildings[allyTeam][MDL_TYPE(unit)], u);
-
-	if (allyTeam != gu->myAllyTeam)
-		return;
-
-	UpdateUnitMiniMapIcon(unit, false, false);
+void CUnitDrawer::UnitLosChanged(void* self, const UnitLosEvent* events, size_t count) {
+	static_cast<CUnitDrawer*>(self)->UpdateUnitLosStates(events, count);
 }
 
-void CUnitDrawer::UnitLeftLos(const CUnit* unit, int allyTeam) {
-	CUnit* u = const_cast<CUnit*>(unit); //cleanup
+void CUnitDrawer::UpdateUnitLosStates(const UnitLosEvent* events, size_t count) {
+	iconUpdateUnits.clear();
 
-	if (gameSetup->ghostedBuildings && unit->unitDef->IsImmobileUnit())
-		spring::VectorInsertUnique(liveGhostBuildings[allyTeam][MDL_TYPE(unit)], u, true);
-
-	if (allyTeam != gu->myAllyTeam)
-		return;
+	for (size_t i = 0; i < count; i++) {
+		const UnitLosEvent& e = events[i];
+		CUnit* u = const_cast<CUnit*>(e.unit); //cleanup
 
-	UpdateUnitMiniMapIcon(unit, false, false);
-}
+		// ghosts are tracked for every allyteam, in event order
+		if (gameSetup->ghostedBuildings && u->unitDef->IsImmobileUnit()) {
+			switch (e.type) {
+				case UnitLosEvent::ENTERED_LOS: { spring::VectorErase(liveGhostBuildings[e.allyTeam][MDL_TYPE(u)], u); } break;
+				case UnitLosEvent::LEFT_LOS: { spring::VectorInsertUnique(liveGhostBuildings[e.allyTeam][MDL_TYPE(u)], u, true); } break;
+				default: {} break;
+			}
+		}
 
-void CUnitDrawer::UnitEnteredRadar(const CUnit* unit, int allyTeam) {
-	if (allyTeam != gu->myAllyTeam)
-		return;
+		if (e.allyTeam != gu->myAllyTeam)
+			continue;
 
-	UpdateUnitMiniMapIcon(unit, false, false);
-}
+		iconUpdateUnits.push_back(e.unit);
+	}
 
-void CUnitDrawer::UnitLeftRadar(const CUnit* unit, int allyTeam) {
-	if (allyTeam != gu->myAllyTeam)
-		return;
+	// a unit entering (or leaving) both LOS and radar needs only one icon update
+	std::sort(iconUpdateUnits.begin(), iconUpdateUnits.end());
+	iconUpdateUnits.erase(std::unique(iconUpdateUnits.begin(), iconUpdateUnits.end()), iconUpdateUnits.end());
 
-	UpdateUnitMiniMapIcon(unit, false, false);
+	for (const CUnit* unit: iconUpdateUnits) {
+		UpdateUnitMiniMapIcon(unit, false, false);
+	}
 }
 
 
@@ -25,6 +25,7 @@ class CVertexArray;
 struct Command;
 struct BuildInfo;
 struct SolidObjectGroundDecal;
+struct UnitLosEvent;
 struct IUnitDrawerState;
 
 namespace icon {
@@ -63,8 +64,6 @@ public:
 		return
 			eventName == "RenderUnitCreated"      || eventName == "RenderUnitDestroyed"  ||
 			eventName == "UnitCloaked"            || eventName == "UnitDecloaked"        ||
-			eventName == "UnitEnteredRadar"       || eventName == "UnitEnteredLos"       ||
-			eventName == "UnitLeftRadar"          || eventName == "UnitLeftLos"          ||
 			eventName == "PlayerChanged"          || eventName == "SunChanged";
 	}
 	bool GetFullRead() const { return true; }
@@ -73,10 +72,8 @@ public:
 	void RenderUnitCreated(const CUnit*, int cloaked);
 	void RenderUnitDestroyed(const CUnit*);
 
-	void UnitEnteredRadar(const CUnit* unit, int allyTeam);
-	void UnitEnteredLos(const CUnit* unit, int allyTeam);
-	void UnitLeftRadar(const CUnit* unit, int allyTeam);
-	void UnitLeftLos(const CUnit* unit, int allyTeam);
+	/// LOS and radar changes of a sim-frame, see CEventHandler::GetUnitLosChannel
+	static void UnitLosChanged(void* self, const UnitLosEvent* events, size_t count);
 
 	void UnitCloaked(const CUnit* unit);
 	void UnitDecloaked(const CUnit* unit);
@@ -89,8 +86,13 @@ public:
 	~CUnitDrawer();
 
 	void Update();
+	void UpdatePieceMatrices();
 
-	void UpdateGhostedBuildings();
+	/// drops dead ghosts the local allyteams regained sight of; unless <fullScan> is set only
+	/// those inside areas the last LOS update added sight to (or added since the last call)
+	void UpdateGhostedBuildings(bool fullScan = false);
+	/// records the end-of-frame unit positions UpdateUnitDrawPos interpolates between
+	void UpdateDrawPosSnapshots(int frameNum);
 
 	void Draw();
 	void DrawOpaquePass(bool deferredPass);
@@ -168,6 +170,8 @@ public:
 
 	bool DrawForward() const { return drawForward; }
 	bool DrawDeferred() const { return drawDeferred; }
+	/// shared with FeatureDrawer, which batches its opaque pass the same way
+	bool DrawInstancedModels() const { return drawInstanced; }
 
 	bool& WireFrameModeRef() { return wireFrameMode; }
 
@@ -186,6 +190,15 @@ public:
 		bool drawBorder;
 	};
 
+	struct UnitIconQuad {
+		const icon::CIconData* iconData;
+
+		float3 pos;
+		float scale;
+
+		unsigned char color[4];
+	};
+
 	void AddTempDrawUnit(const TempDrawUnit& tempDrawUnit);
 	void UpdateTempDrawUnits(std::vector<TempDrawUnit>& tempDrawUnits);
 
@@ -195,8 +208,12 @@ private:
 
 	bool CanDrawOpaqueUnit(const CUnit* unit, bool drawReflection, bool drawRefraction) const;
 	bool CanDrawOpaqueUnitShadow(const CUnit* unit) const;
+	bool CanDrawInstancedUnit(const CUnit* unit) const;
+
+	void CullUnits(bool drawReflection, bool drawRefraction, bool shadowPass);
 
 	void DrawOpaqueUnit(CUnit* unit, bool drawReflection, bool drawRefraction);
+	void DrawInstancedUnits(int modelType);
 	void DrawOpaqueUnitShadow(CUnit* unit);
 	void DrawOpaqueUnitsShadow(int modelType);
 	void DrawOpaqueUnits(int modelType, bool drawReflection, bool drawRefraction);
@@ -212,15 +229,20 @@ private:
 
 	void DrawGhostedBuildings(int modelType);
 
+	int GetGhostCellIndex(const float3& pos) const;
+	/// returns true (and releases <gso>) if the allyteam has sight of it
+	bool UpdateDeadGhost(int allyTeam, GhostSolidObject* gso);
+
 public:
 	void DrawUnitIcons();
 	void DrawUnitMiniMapIcon(const CUnit* unit, CVertexArray* va) const;
 private:
 	void UpdateUnitMiniMapIcon(const CUnit* unit, bool forced, bool killed);
+	void UpdateUnitLosStates(const UnitLosEvent* events, size_t count);
 	void UpdateUnitIconState(CUnit* unit);
 
-	static void DrawIcon(CUnit* unit, bool asRadarBlip);
-	static void UpdateUnitDrawPos(CUnit* unit);
+	static void GetIconQuad(CUnit* unit, bool asRadarBlip, UnitIconQuad& quad);
+	void UpdateUnitDrawPos(CUnit* unit) const;
 
 public:
 	static void BindModelTypeTexture(int mdlType, int texType);
@@ -260,6 +282,7 @@ private:
 	bool drawForward;
 	bool drawDeferred;
 	bool wireFrameMode;
+	bool drawInstanced;
 
 	bool useDistToGroundForIcons;
 
@@ -277,13 +300,55 @@ private:
 
 	/// buildings that were in LOS_PREVLOS when they died and not in LOS since
 	std::vector<std::array<std::vector<GhostSolidObject*>, MODELTYPE_OTHER>> deadGhostBuildings;
+	/// deadGhostBuildings bucketed per allyteam into GHOST_CELL_SIZE^2 map areas
+	std::vector<std::vector<std::vector<GhostSolidObject*>>> deadGhostCells;
+	/// ghosts created since the last UpdateGhostedBuildings, tested once regardless of LOS changes
+	std::vector<std::vector<GhostSolidObject*>> newDeadGhosts;
+	/// scratch-space for the deadGhostCells touched by gained LOS
+	std::vector<int> ghostCellIndices;
+	int2 ghostCellDims;
+
+	static constexpr int GHOST_CELL_SIZE = 512;
 	/// buildings that left LOS but are still alive
 	std::vector<std::array<std::vector<CUnit*>, MODELTYPE_OTHER>> liveGhostBuildings;
 
 	/// units that are only rendered as icons this frame
 	std::vector<CUnit*> iconUnits;
+	/// billboards of iconUnits, grouped by icon type before drawing
+	std::vector<UnitIconQuad> iconQuads;
+
+	/// result of the last CullUnits call, indexed by unit ID
+	std::vector<uint8_t> unitVisibility;
+
+	/// inputs of the last CullUnits call; repeating it for the same camera
+	/// within a frame (deferred and forward opaque pass) reuses the results
+	struct CullState {
+		const void* cam = nullptr;
+		float3 camPos;
+		float3 camDir;
+		float lodFactor = 0.0f;
+		int drawFrame = -1;
+		int passFlags = 0;
+	};
+
+	CullState lastCullState;
+
+	/// opaque default-material units batched per (model, team) by DrawInstancedUnits
+	std::vector<const CUnit*> instancedUnits;
+	/// {model, piece[0], ..., piece[N-1]} matrices of each unit in instancedUnits
+	std::vector<CMatrix44f> instanceMatrices;
 
 	spring::unsynced_map<icon::CIconData*, std::vector<const CUnit*> > unitsByIcon;
+	/// scratch-space for UpdateUnitLosStates
+	std::vector<const CUnit*> iconUpdateUnits;
+
+	/// sim-frame positions of each unit (by ID), in slots of alternating frame parity
+	struct DrawPosSnapshot {
+		float3 pos[2];
+		int frameNum[2] = {-1, -1};
+	};
+
+	std::vector<DrawPosSnapshot> drawPosSnapshots;
 
 
 	// caches for ShowUnitBuildSquare
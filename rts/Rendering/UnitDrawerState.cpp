@@ -102,7 +102,6 @@ bool UnitDrawerStateGLSL::Init(const CUnitDrawer* ud) {
 	const std::string extraDefs =
 		("#define NUM_DYNAMIC_MODEL_LIGHTS " + IntToString(lightHandler->NumConfigLights()) + "\n") +
 		("#define MAX_DYNAMIC_MODEL_LIGHTS " + IntToString(GL::LightHandler::MaxConfigLights()) + "\n") +
-		("#define MAX_LIGHT_UNIFORM_VECS "   + IntToString(GL::LightHandler::MaxUniformVecs()) + "\n") +
 		("#define MDL_CLIP_PLANE_IDX "       + IntToString(            IWater::ClipPlaneIndex()) + "\n") +
 		("#define MDL_FRAGDATA_COUNT "       + IntToString(GL::GeometryBuffer::ATTACHMENT_COUNT) + "\n");
 
@@ -150,7 +149,11 @@ bool UnitDrawerStateGLSL::Init(const CUnitDrawer* ud) {
 		modelShaders[n]->SetUniformLocation("shadowMatrix");      // idx 21
 		modelShaders[n]->SetUniformLocation("shadowParams");      // idx 22
 		// modelShaders[n]->SetUniformLocation("alphaPass");         // idx 23
-		modelShaders[n]->SetUniformLocation("fwdDynLights");      // idx 23
+		modelShaders[n]->SetUniformLocation("lightGridParams");   // idx 23
+		modelShaders[n]->SetUniformLocation("instanceMatrixTex"); // idx 24
+		modelShaders[n]->SetUniformLocation("instanceParams");    // idx 25
+		modelShaders[n]->SetUniformLocation("lightDataTex");      // idx 26
+		modelShaders[n]->SetUniformLocation("lightGridTex");      // idx 27
 
 		modelShaders[n]->Enable();
 		modelShaders[n]->SetUniform1i(0, 0); // diffuseTex  (idx 0, texunit 0)
@@ -175,6 +178,11 @@ bool UnitDrawerStateGLSL::Init(const CUnitDrawer* ud) {
 		modelShaders[n]->SetUniformMatrix4fv(21, false, shadowHandler->GetShadowViewMatrixRaw());
 		modelShaders[n]->SetUniform4fv(22, shadowHandler->GetShadowParams());
 		// modelShaders[n]->SetUniform1f(23, 0.0f); // alphaPass
+		modelShaders[n]->SetUniform1i(24, 5); // instanceMatrixTex (idx 24, texunit 5)
+		modelShaders[n]->SetUniform2i(25, 0, 0);
+		modelShaders[n]->SetUniform4fv(23, &lightHandler->GetLightGridParams().x);
+		modelShaders[n]->SetUniform1i(26, 6); // lightDataTex (idx 26, texunit 6)
+		modelShaders[n]->SetUniform1i(27, 7); // lightGridTex (idx 27, texunit 7)
 		modelShaders[n]->Disable();
 		modelShaders[n]->Validate();
 	}
@@ -182,6 +190,25 @@ bool UnitDrawerStateGLSL::Init(const CUnitDrawer* ud) {
 	// make the active shader non-NULL
 	SetActiveShader(shadowHandler->ShadowsLoaded(), false);
 
+	{
+		GLint maxTexBufferSize = 0;
+
+		// NB: the spec only guarantees 64K texels, i.e. 16K matrices
+		glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexBufferSize);
+
+		maxInstanceMatrices = maxTexBufferSize / 4;
+
+		glGenBuffers(1, &instanceMatrixBuffer);
+		glBindBuffer(GL_TEXTURE_BUFFER, instanceMatrixBuffer);
+		glBufferData(GL_TEXTURE_BUFFER, sizeof(CMatrix44f), nullptr, GL_STREAM_DRAW);
+		glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+		glGenTextures(1, &instanceMatrixTexture);
+		glBindTexture(GL_TEXTURE_BUFFER, instanceMatrixTexture);
+		glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, instanceMatrixBuffer);
+		glBindTexture(GL_TEXTURE_BUFFER, 0);
+	}
+
 	#undef sh
 	return true;
 }
@@ -189,6 +216,13 @@ bool UnitDrawerStateGLSL::Init(const CUnitDrawer* ud) {
 void UnitDrawerStateGLSL::Kill() {
 	modelShaders.fill(nullptr);
 	shaderHandler->ReleaseProgramObjects("[UnitDrawer]");
+
+	glDeleteTextures(1, &instanceMatrixTexture);
+	glDeleteBuffers(1, &instanceMatrixBuffer);
+
+	instanceMatrixTexture = 0;
+	instanceMatrixBuffer = 0;
+	maxInstanceMatrices = 0;
 }
 
 void UnitDrawerStateGLSL::Enable(const CUnitDrawer* ud, bool deferredPass, bool alphaPass) {
@@ -204,7 +238,10 @@ void UnitDrawerStateGLSL::Enable(const CUnitDrawer* ud, bool deferredPass, bool
 
 	if (cLightHandler->NumConfigLights() > 0) {
 		mLightHandler->Update();
-		shader->SetUniform4fv(23, cLightHandler->NumUniformVecs(), cLightHandler->GetRawLightDataPtr());
+
+		glActiveTexture(GL_TEXTURE6); glBindTexture(GL_TEXTURE_BUFFER, cLightHandler->GetLightDataTexture());
+		glActiveTexture(GL_TEXTURE7); glBindTexture(GL_TEXTURE_BUFFER, cLightHandler->GetLightGridTexture());
+		glActiveTexture(GL_TEXTURE0);
 	}
 
 	shader->SetUniform3fv(10, &fogParams.x);
@@ -295,3 +332,24 @@ void UnitDrawerStateGLSL::SetBuildClipPlanes(const float4& upper, const float4&
 	modelShaders[MODEL_SHADER_ACTIVE]->SetUniform4fv(13, lower);
 }
 
+
+bool UnitDrawerStateGLSL::SetInstanceMatrices(const CMatrix44f* matrices, size_t numMatrices) const {
+	if (numMatrices > maxInstanceMatrices)
+		return false;
+
+	// orphan the previous frame's data so this upload does not wait on its draws
+	glBindBuffer(GL_TEXTURE_BUFFER, instanceMatrixBuffer);
+	glBufferData(GL_TEXTURE_BUFFER, numMatrices * sizeof(CMatrix44f), nullptr, GL_STREAM_DRAW);
+	glBufferSubData(GL_TEXTURE_BUFFER, 0, numMatrices * sizeof(CMatrix44f), matrices);
+	glBindBuffer(GL_TEXTURE_BUFFER, 0);
+
+	glActiveTexture(GL_TEXTURE5);
+	glBindTexture(GL_TEXTURE_BUFFER, instanceMatrixTexture);
+	glActiveTexture(GL_TEXTURE0);
+	return true;
+}
+
+void UnitDrawerStateGLSL::SetInstanceParams(size_t baseMatrixIdx, size_t numInstanceMatrices) const {
+	assert(modelShaders[MODEL_SHADER_ACTIVE]->IsBound());
+	modelShaders[MODEL_SHADER_ACTIVE]->SetUniform2i(25, baseMatrixIdx, numInstanceMatrices);
+}
@@ -46,6 +46,7 @@ public:
 	virtual bool CanEnable(const CUnitDrawer*) const { return false; }
 	virtual bool CanDrawAlpha() const { return false; }
 	virtual bool CanDrawDeferred() const { return false; }
+	virtual bool CanDrawInstanced() const { return false; }
 
 	virtual void Enable(const CUnitDrawer*, bool, bool) = 0;
 	virtual void Disable(const CUnitDrawer*, bool) = 0;
@@ -63,6 +64,10 @@ public:
 	virtual void SetWaterClipPlane(const DrawPass::e& drawPass) const = 0; // water
 	virtual void SetBuildClipPlanes(const float4&, const float4&) const = 0; // nano-frames
 
+	// instanced drawing; returns false if the matrices do not fit the instance buffer
+	virtual bool SetInstanceMatrices(const CMatrix44f* matrices, size_t numMatrices) const { return false; }
+	virtual void SetInstanceParams(size_t baseMatrixIdx, size_t numInstanceMatrices) const {}
+
 	void SetActiveShader(unsigned int shadowed, unsigned int deferred) {
 		// shadowed=1 --> shader 1 (deferred=0) or 3 (deferred=1)
 		// shadowed=0 --> shader 0 (deferred=0) or 2 (deferred=1)
@@ -157,6 +162,7 @@ public:
 	bool CanEnable(const CUnitDrawer*) const override { return true; }
 	bool CanDrawAlpha() const override { return true; }
 	bool CanDrawDeferred() const  override { return true; }
+	bool CanDrawInstanced() const override { return (instanceMatrixTexture != 0); }
 
 	void Enable(const CUnitDrawer*, bool, bool) override;
 	void Disable(const CUnitDrawer*, bool) override;
@@ -173,6 +179,16 @@ public:
 	void SetMatrices(const CMatrix44f& modelMat, const CMatrix44f* pieceMats, size_t numPieceMats) const override;
 	void SetWaterClipPlane(const DrawPass::e& drawPass) const override;
 	void SetBuildClipPlanes(const float4&, const float4&) const override;
+
+	bool SetInstanceMatrices(const CMatrix44f* matrices, size_t numMatrices) const override;
+	void SetInstanceParams(size_t baseMatrixIdx, size_t numInstanceMatrices) const override;
+
+private:
+	// buffer-texture holding the model and piece matrices of every instanced unit
+	unsigned int instanceMatrixBuffer = 0;
+	unsigned int instanceMatrixTexture = 0;
+
+	size_t maxInstanceMatrices = 0;
 };
 
 #endif
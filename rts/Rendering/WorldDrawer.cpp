@@ -13,6 +13,7 @@
 #include "Rendering/Env/IWater.h"
 #include "Rendering/CommandDrawer.h"
 #include "Rendering/DebugColVolDrawer.h"
+#include "Rendering/GL/GLTimerProfiler.h"
 #include "Rendering/FarTextureHandler.h"
 #include "Rendering/LineDrawer.h"
 #include "Rendering/LuaObjectDrawer.h"
@@ -157,6 +158,12 @@ void CWorldDrawer::Update(bool newSimFrame)
 	// lineDrawer.UpdateLineStipple();
 	treeDrawer->Update();
 	featureDrawer->Update();
+
+	{
+		SCOPED_TIMER("Update::World::Models");
+		unitDrawer->UpdatePieceMatrices();
+	}
+
 	IWater::ApplyPushedChanges(game);
 
 	if (newSimFrame) {
@@ -175,6 +182,7 @@ void CWorldDrawer::GenerateIBLTextures() const
 
 	if (shadowHandler->ShadowsLoaded()) {
 		SCOPED_TIMER("Draw::World::CreateShadows");
+		SCOPED_GL_TIMER("Draw::World::CreateShadows");
 		game->SetDrawMode(CGame::gameShadowDraw);
 		shadowHandler->CreateShadows();
 		game->SetDrawMode(CGame::gameNormalDraw);
@@ -182,14 +190,19 @@ void CWorldDrawer::GenerateIBLTextures() const
 
 	{
 		SCOPED_TIMER("Draw::World::UpdateReflTex");
+		SCOPED_GL_TIMER("Draw::World::UpdateReflTex");
 		cubeMapHandler->UpdateReflectionTexture();
 	}
 
-	if (sky->GetLight()->Update()) {
-		{
-			SCOPED_TIMER("Draw::World::UpdateSpecTex");
-			cubeMapHandler->UpdateSpecularTexture();
-		}
+	const bool lightChanged = sky->GetLight()->Update();
+
+	{
+		// time-sliced, continues for a while after each sun change
+		SCOPED_TIMER("Draw::World::UpdateSpecTex");
+		cubeMapHandler->UpdateSpecularTexture(lightChanged);
+	}
+
+	if (lightChanged) {
 		{
 			SCOPED_TIMER("Draw::World::UpdateSkyTex");
 			sky->UpdateSkyTexture();
@@ -221,6 +234,7 @@ void CWorldDrawer::ResetMVPMatrices() const
 void CWorldDrawer::Draw() const
 {
 	SCOPED_TIMER("Draw::World");
+	SCOPED_GL_TIMER("Draw::World");
 
 	glClearColor(sky->fogColor[0], sky->fogColor[1], sky->fogColor[2], 0.0f);
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
@@ -238,6 +252,7 @@ void CWorldDrawer::Draw() const
 
 	{
 		SCOPED_TIMER("Draw::World::Projectiles");
+		SCOPED_GL_TIMER("Draw::World::Projectiles");
 		projectileDrawer->Draw(false);
 	}
 
@@ -262,15 +277,18 @@ void CWorldDrawer::DrawOpaqueObjects() const
 	if (globalRendering->drawGround) {
 		{
 			SCOPED_TIMER("Draw::World::Terrain");
+			SCOPED_GL_TIMER("Draw::World::Terrain");
 			gd->Draw(DrawPass::Normal);
 		}
 		{
 			SCOPED_TIMER("Draw::World::Decals");
+			SCOPED_GL_TIMER("Draw::World::Decals");
 			groundDecals->Draw();
 			projectileDrawer->DrawGroundFlashes();
 		}
 		{
 			SCOPED_TIMER("Draw::World::Foliage");
+			SCOPED_GL_TIMER("Draw::World::Foliage");
 			grassDrawer->Draw();
 			treeDrawer->Draw();
 		}
@@ -290,6 +308,7 @@ void CWorldDrawer::DrawOpaqueObjects() const
 
 	{
 		SCOPED_TIMER("Draw::World::Models::Opaque");
+		SCOPED_GL_TIMER("Draw::World::Models::Opaque");
 		unitDrawer->Draw();
 		featureDrawer->Draw();
 
@@ -309,6 +328,7 @@ void CWorldDrawer::DrawAlphaObjects() const
 
 	{
 		SCOPED_TIMER("Draw::World::Models::Alpha");
+		SCOPED_GL_TIMER("Draw::World::Models::Alpha");
 		// clip in model-space
 		GL::PushMatrix();
 		GL::LoadIdentity();
@@ -326,6 +346,7 @@ void CWorldDrawer::DrawAlphaObjects() const
 	// draw water (in-between)
 	if (globalRendering->drawWater && !mapRendering->voidWater) {
 		SCOPED_TIMER("Draw::World::Water");
+		SCOPED_GL_TIMER("Draw::World::Water");
 
 		water->UpdateWater(game);
 		water->Draw();
@@ -333,6 +354,7 @@ void CWorldDrawer::DrawAlphaObjects() const
 
 	{
 		SCOPED_TIMER("Draw::World::Models::Alpha");
+		SCOPED_GL_TIMER("Draw::World::Models::Alpha");
 		GL::PushMatrix();
 		GL::LoadIdentity();
 		glClipPlane(GL_CLIP_PLANE3, abovePlaneEq);
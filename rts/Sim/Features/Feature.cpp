@@ -46,6 +46,8 @@ CR_REG_METADATA(CFeature, (
 	CR_MEMBER(lastReclaimFrame),
 	CR_MEMBER(fireTime),
 	CR_MEMBER(smokeTime),
+	CR_MEMBER(sleepFrame),
+	CR_MEMBER(wakeFrame),
 
 	CR_MEMBER(drawQuad),
 	CR_MEMBER(drawFlag),
@@ -90,6 +92,8 @@ CFeature::CFeature()
 , lastReclaimFrame(0)
 , fireTime(0)
 , smokeTime(0)
+, sleepFrame(-1)
+, wakeFrame(-1)
 
 , drawQuad(-2)
 , drawFlag(-1)
@@ -495,6 +499,10 @@ void CFeature::ForcedMove(const float3& newPos)
 
 	// insert into managers
 	quadField->AddFeature(this);
+
+	// a sleeping feature would otherwise only notice once it wakes up
+	if (IsSleeping())
+		featureHandler->SetFeatureUpdateable(this);
 }
 
 
@@ -503,6 +511,9 @@ void CFeature::ForcedSpin(const float3& newDir)
 	// update local direction-vectors
 	CSolidObject::ForcedSpin(newDir);
 	UpdateTransform(pos, true);
+
+	// drawers caching the transform need to know
+	eventHandler.FeatureMoved(this, pos);
 }
 
 
@@ -609,7 +620,11 @@ bool CFeature::UpdatePosition()
 
 bool CFeature::Update()
 {
-	bool continueUpdating = UpdatePosition();
+	assert(!IsSleeping());
+
+	const bool moved = UpdatePosition();
+
+	bool continueUpdating = moved;
 
 	continueUpdating |= (smokeTime != 0);
 	continueUpdating |= (fireTime != 0);
@@ -635,6 +650,25 @@ bool CFeature::Update()
 	smokeTime = std::max(smokeTime - 1, 0);
 	fireTime = std::max(fireTime - 1, 0);
 
+	wakeFrame = -1;
+
+	// a resting feature does nothing but count down until the next frame
+	// that emits smoke, ends its fire or removes it from the update-queue
+	if (continueUpdating && !moved && !deleteMe && !def->geoThermal) {
+		// frames until ((frameNum + id) & 3) is zero again
+		const int smokeFrames = 4 - ((gs->frameNum + id) & 3);
+
+		int numFrames = std::max(smokeTime, fireTime) + 1;
+
+		if (fireTime > 0)
+			numFrames = std::min(numFrames, fireTime);
+		if (smokeFrames <= smokeTime)
+			numFrames = std::min(numFrames, smokeFrames);
+
+		if (numFrames > 1)
+			wakeFrame = gs->frameNum + numFrames;
+	}
+
 	// return true so long as we need to stay in the FH update-queue
 	return continueUpdating;
 }
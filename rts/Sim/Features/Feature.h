@@ -92,6 +92,7 @@ public:
 
 	bool Update();
 	bool UpdatePosition();
+	bool IsSleeping() const { return (sleepFrame >= 0); }
 	bool UpdateVelocity(const float3& dragAccel, const float3& gravAccel, const float3& movMask, const float3& velMask);
 
 	void SetTransform(const CMatrix44f& m, bool synced) { transMatrix[synced] = m; }
@@ -140,6 +141,12 @@ public:
 	int fireTime;
 	int smokeTime;
 
+	/// last frame this feature was updated in before it went to sleep, -1 if not asleep
+	int sleepFrame;
+	/// frame at which a resting feature that is only counting down fireTime
+	/// or smokeTime next has work to do, set by Update (see CFeatureHandler)
+	int wakeFrame;
+
 	int drawQuad; /// which drawQuad we are part of (unsynced)
 	int drawFlag; /// one of FD_*_FLAG (unsynced)
 
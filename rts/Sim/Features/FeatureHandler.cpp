@@ -1,5 +1,8 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+#include <functional>
+
 #include "FeatureHandler.h"
 
 #include "FeatureDef.h"
@@ -10,6 +13,7 @@
 #include "Sim/Misc/SimObjectMemPool.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Units/CommandAI/BuilderCAI.h"
+#include "System/creg/STL_Map.h"
 #include "System/creg/STL_Set.h"
 #include "System/EventHandler.h"
 #include "System/TimeProfiler.h"
@@ -22,7 +26,9 @@ CR_REG_METADATA(CFeatureHandler, (
 	CR_MEMBER(deletedFeatureIDs),
 	CR_MEMBER(activeFeatureIDs),
 	CR_MEMBER(features),
-	CR_MEMBER(updateFeatures)
+	CR_MEMBER(updateFeatures),
+	CR_MEMBER(sleepingFeatures),
+	CR_MEMBER(updateFrame)
 ))
 
 /******************************************************************************/
@@ -179,6 +185,10 @@ void CFeatureHandler::Update()
 		deletedFeatureIDs.erase(iter, deletedFeatureIDs.end());
 	}
 	{
+		WakeSleepingFeatures();
+
+		updateFrame = gs->frameNum;
+
 		const auto& pred = [this](CFeature* feature) { return (this->UpdateFeature(feature)); };
 		const auto& iter = std::remove_if(updateFeatures.begin(), updateFeatures.end(), pred);
 
@@ -230,10 +240,59 @@ bool CFeatureHandler::UpdateFeature(CFeature* feature)
 		return true;
 	}
 
+	if (feature->wakeFrame > gs->frameNum) {
+		// nothing to do until then, leave the queue meanwhile
+		SleepFeature(feature);
+		return true;
+	}
+
 	return false;
 }
 
 
+void CFeatureHandler::SleepFeature(CFeature* feature)
+{
+	feature->inUpdateQue = false;
+	feature->sleepFrame = gs->frameNum;
+
+	sleepingFeatures.emplace_back(feature->wakeFrame, feature->id);
+	std::push_heap(sleepingFeatures.begin(), sleepingFeatures.end(), std::greater<std::pair<int, int>>());
+}
+
+void CFeatureHandler::WakeFeature(CFeature* feature)
+{
+	assert(feature->IsSleeping());
+
+	// count down the frames slept through, up to (excluding) the next
+	// frame the feature will be updated in; if woken early by an event
+	// after this frame's update-queue pass, that is only the next frame
+	const int numSkippedFrames = gs->frameNum - feature->sleepFrame - (updateFrame != gs->frameNum);
+
+	feature->smokeTime = std::max(feature->smokeTime - numSkippedFrames, 0);
+	feature->fireTime = std::max(feature->fireTime - numSkippedFrames, 0);
+
+	feature->sleepFrame = -1;
+	feature->wakeFrame = -1;
+}
+
+void CFeatureHandler::WakeSleepingFeatures()
+{
+	while (!sleepingFeatures.empty() && sleepingFeatures.front().first <= gs->frameNum) {
+		const std::pair<int, int> entry = sleepingFeatures.front();
+
+		std::pop_heap(sleepingFeatures.begin(), sleepingFeatures.end(), std::greater<std::pair<int, int>>());
+		sleepingFeatures.pop_back();
+
+		CFeature* feature = features[entry.second];
+
+		if (feature == nullptr || !feature->IsSleeping() || feature->wakeFrame != entry.first)
+			continue;
+
+		SetFeatureUpdateable(feature);
+	}
+}
+
+
 void CFeatureHandler::SetFeatureUpdateable(CFeature* feature)
 {
 	if (feature->inUpdateQue) {
@@ -241,6 +300,9 @@ void CFeatureHandler::SetFeatureUpdateable(CFeature* feature)
 		return;
 	}
 
+	if (feature->IsSleeping())
+		WakeFeature(feature);
+
 	// always true
 	feature->inUpdateQue = spring::VectorInsertUnique(updateFeatures, feature);
 }
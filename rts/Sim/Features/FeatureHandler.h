@@ -4,6 +4,7 @@
 #define _FEATURE_HANDLER_H
 
 #include <deque>
+#include <utility>
 #include <vector>
 
 #include "System/float3.h"
@@ -77,6 +78,10 @@ private:
 
 	void InsertActiveFeature(CFeature* feature);
 
+	void SleepFeature(CFeature* feature);
+	void WakeFeature(CFeature* feature);
+	void WakeSleepingFeatures();
+
 private:
 	SimObjectIDPool idPool;
 
@@ -84,6 +89,12 @@ private:
 	std::vector<int> deletedFeatureIDs;
 	std::vector<CFeature*> features;
 	std::vector<CFeature*> updateFeatures;
+
+	/// min-heap of {wake-frame, feature ID}; entries of features woken early are stale
+	std::vector<std::pair<int, int>> sleepingFeatures;
+
+	/// frame in which the update-queue was last processed
+	int updateFrame = -1;
 };
 
 extern CFeatureHandler* featureHandler;
@@ -11,6 +11,9 @@
 #include "System/Matrix44f.h"
 #include "System/Log/ILog.h"
 
+#include <limits>
+#include <xmmintrin.h>
+
 unsigned int CCollisionHandler::numDiscTests = 0;
 unsigned int CCollisionHandler::numContTests = 0;
 
@@ -73,6 +76,168 @@ bool CCollisionHandler::DetectHit(
 
 
 
+// tests four bounding-spheres at once against segment <p0, p0 + sd>
+// bit i of the returned mask is set iff the squared distance from
+// sphere i's center to the segment does not exceed rSq[i]
+static int SegmentSpheresMask(
+	const float* cx,
+	const float* cy,
+	const float* cz,
+	const float* rSq,
+	const float3& p0,
+	const float3& sd,
+	const float sdInvSq
+) {
+	const __m128 dx = _mm_set1_ps(sd.x);
+	const __m128 dy = _mm_set1_ps(sd.y);
+	const __m128 dz = _mm_set1_ps(sd.z);
+
+	// center relative to segment start
+	const __m128 wx = _mm_sub_ps(_mm_load_ps(cx), _mm_set1_ps(p0.x));
+	const __m128 wy = _mm_sub_ps(_mm_load_ps(cy), _mm_set1_ps(p0.y));
+	const __m128 wz = _mm_sub_ps(_mm_load_ps(cz), _mm_set1_ps(p0.z));
+
+	// parameter of closest point on segment, clamped to [0, 1]
+	__m128 t = _mm_add_ps(_mm_add_ps(_mm_mul_ps(wx, dx), _mm_mul_ps(wy, dy)), _mm_mul_ps(wz, dz));
+	t = _mm_mul_ps(t, _mm_set1_ps(sdInvSq));
+	t = _mm_min_ps(_mm_max_ps(t, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+
+	const __m128 qx = _mm_sub_ps(wx, _mm_mul_ps(t, dx));
+	const __m128 qy = _mm_sub_ps(wy, _mm_mul_ps(t, dy));
+	const __m128 qz = _mm_sub_ps(wz, _mm_mul_ps(t, dz));
+	const __m128 qq = _mm_add_ps(_mm_add_ps(_mm_mul_ps(qx, qx), _mm_mul_ps(qy, qy)), _mm_mul_ps(qz, qz));
+
+	return (_mm_movemask_ps(_mm_cmple_ps(qq, _mm_load_ps(rSq))));
+}
+
+// fills lane i with the bounding-sphere DetectHit uses for <o>
+static void SetBoundingSphere(const CSolidObject* o, float* cx, float* cy, float* cz, float* rSq, unsigned int i)
+{
+	const CollisionVolume* v = &o->collisionVolume;
+
+	// mirror DetectHit's early-outs; piece volumes are not bounded
+	// by the object's own so those always go to the scalar test
+	if (o->IsInVoid() || (!v->DefaultToPieceTree() && v->IgnoreHits())) {
+		cx[i] = 0.0f; cy[i] = 0.0f; cz[i] = 0.0f; rSq[i] = -1.0f;
+		return;
+	}
+	if (v->DefaultToPieceTree()) {
+		cx[i] = 0.0f; cy[i] = 0.0f; cz[i] = 0.0f; rSq[i] = std::numeric_limits<float>::max();
+		return;
+	}
+
+	const float3 c = v->GetWorldSpacePos(o);
+	// inflate the radius so rounding differences between this and
+	// the matrix-based exact tests can never reject a real hit
+	const float r = v->GetBoundingRadius() * 1.01f + 1.0f;
+
+	cx[i] = c.x; cy[i] = c.y; cz[i] = c.z; rSq[i] = r * r;
+}
+
+unsigned int CCollisionHandler::CullSegmentMisses(
+	const CSolidObject** objects,
+	unsigned int numObjects,
+	const float3 p0,
+	const float3 p1
+) {
+	constexpr unsigned int BATCH_SIZE = 64;
+
+	alignas(16) float cx[BATCH_SIZE];
+	alignas(16) float cy[BATCH_SIZE];
+	alignas(16) float cz[BATCH_SIZE];
+	alignas(16) float rSq[BATCH_SIZE];
+
+	const float3 sd = p1 - p0;
+	const float sdSq = sd.SqLength();
+	const float sdInvSq = (sdSq > 0.0f)? (1.0f / sdSq): 0.0f;
+
+	unsigned int numKept = 0;
+
+	for (unsigned int base = 0; base < numObjects; base += BATCH_SIZE) {
+		const unsigned int n = std::min(numObjects - base, BATCH_SIZE);
+		const unsigned int m = (n + 3) & ~3u;
+
+		for (unsigned int i = 0; i < n; i++) {
+			SetBoundingSphere(objects[base + i], cx, cy, cz, rSq, i);
+		}
+		for (unsigned int i = n; i < m; i++) {
+			cx[i] = 0.0f; cy[i] = 0.0f; cz[i] = 0.0f; rSq[i] = -1.0f;
+		}
+
+		for (unsigned int j = 0; j < m; j += 4) {
+			const int mask = SegmentSpheresMask(&cx[j], &cy[j], &cz[j], &rSq[j], p0, sd, sdInvSq);
+
+			for (unsigned int k = j; k < (j + 4); k++) {
+				if ((mask & (1 << (k - j))) == 0)
+					continue;
+
+				// never ahead of base + k, so no unread object gets overwritten
+				objects[numKept++] = objects[base + k];
+			}
+		}
+	}
+
+	return numKept;
+}
+
+int CCollisionHandler::DetectHitBatch(
+	const CSolidObject* const* objects,
+	unsigned int numObjects,
+	const float3 p0,
+	const float3 p1,
+	CollisionQuery* cq,
+	bool forceTrace
+) {
+	constexpr unsigned int BATCH_SIZE = 64;
+
+	alignas(16) float cx[BATCH_SIZE];
+	alignas(16) float cy[BATCH_SIZE];
+	alignas(16) float cz[BATCH_SIZE];
+	alignas(16) float rSq[BATCH_SIZE];
+
+	const float3 sd = p1 - p0;
+	const float sdSq = sd.SqLength();
+	const float sdInvSq = (sdSq > 0.0f)? (1.0f / sdSq): 0.0f;
+
+	for (unsigned int base = 0; base < numObjects; base += BATCH_SIZE) {
+		const unsigned int n = std::min(numObjects - base, BATCH_SIZE);
+		// pad to a multiple of the SIMD width with never-passing lanes
+		const unsigned int m = (n + 3) & ~3u;
+
+		for (unsigned int i = 0; i < n; i++) {
+			SetBoundingSphere(objects[base + i], cx, cy, cz, rSq, i);
+		}
+		for (unsigned int i = n; i < m; i++) {
+			cx[i] = 0.0f; cy[i] = 0.0f; cz[i] = 0.0f; rSq[i] = -1.0f;
+		}
+
+		for (unsigned int j = 0; j < m; j += 4) {
+			const int mask = SegmentSpheresMask(&cx[j], &cy[j], &cz[j], &rSq[j], p0, sd, sdInvSq);
+
+			if (mask == 0)
+				continue;
+
+			// visit survivors in their original order
+			for (unsigned int k = j; k < (j + 4); k++) {
+				if ((mask & (1 << (k - j))) == 0)
+					continue;
+
+				const CSolidObject* o = objects[base + k];
+
+				if (DetectHit(o, o->GetTransformMatrix(true), p0, p1, cq, forceTrace))
+					return (base + k);
+			}
+		}
+	}
+
+	if (cq != nullptr)
+		cq->Reset();
+
+	return -1;
+}
+
+
+
 bool CCollisionHandler::Collision(
 	const CSolidObject* o,
 	const CollisionVolume* v,
@@ -253,6 +418,13 @@ bool CCollisionHandler::IntersectPieceTreeHelper(
 }
 */
 
+// upper bound for the factor by which <m> scales lengths; exact for
+// matrices composed of rotations and axis-aligned scales like ours
+static float GetMaxAxisScale(const CMatrix44f& m)
+{
+	return (math::sqrt(std::max(m.GetX().SqLength(), std::max(m.GetY().SqLength(), m.GetZ().SqLength()))));
+}
+
 bool CCollisionHandler::IntersectPiecesHelper(
 	const CSolidObject* o,
 	const CMatrix44f& m,
@@ -265,36 +437,74 @@ bool CCollisionHandler::IntersectPiecesHelper(
 	float minDistSq = std::numeric_limits<float>::max();
 	float curDistSq = minDistSq;
 
-	for (unsigned int n = 0; n < o->localModel.pieces.size(); n++) {
-		const LocalModelPiece* lmp = o->localModel.GetPiece(n);
-		const CollisionVolume* lmpVol = lmp->GetCollisionVolume();
+	alignas(16) float cx[4];
+	alignas(16) float cy[4];
+	alignas(16) float cz[4];
+	alignas(16) float rSq[4];
 
-		if (!lmp->scriptSetVisible || lmpVol->IgnoreHits())
-			continue;
+	const float3 sd = p1 - p0;
+	const float sdSq = sd.SqLength();
+	const float sdInvSq = (sdSq > 0.0f)? (1.0f / sdSq): 0.0f;
+	const float objScale = GetMaxAxisScale(m);
 
-		volMat = m * lmp->GetModelSpaceMatrix();
-		volMat.Translate(lmpVol->GetOffsets());
+	const unsigned int numPieces = o->localModel.pieces.size();
+
+	for (unsigned int base = 0; base < numPieces; base += 4) {
+		// cull pieces whose volume's bounding-sphere the segment misses, four
+		// at a time; only the survivors get the (far more expensive) exact test
+		for (unsigned int k = 0; k < 4; k++) {
+			cx[k] = 0.0f; cy[k] = 0.0f; cz[k] = 0.0f; rSq[k] = -1.0f;
+
+			if ((base + k) >= numPieces)
+				continue;
+
+			const LocalModelPiece* lmp = o->localModel.GetPiece(base + k);
+			const CollisionVolume* lmpVol = lmp->GetCollisionVolume();
 
-		CollisionQuery cqn;
-		if (!CCollisionHandler::Intersect(lmpVol, volMat, p0, p1, &cqn))
-			continue;
+			if (!lmp->scriptSetVisible || lmpVol->IgnoreHits())
+				continue;
 
-		// skip if neither an ingress nor an egress hit
-		if (!cqn.AnyHit())
-			continue;
+			const CMatrix44f& pieceMat = lmp->GetModelSpaceMatrix();
+			const float3 c = m * (pieceMat * lmpVol->GetOffsets());
+			// inflated like SetBoundingSphere so rounding can not cull real hits
+			const float r = lmpVol->GetBoundingRadius() * objScale * GetMaxAxisScale(pieceMat) * 1.01f + 1.0f;
 
-		// save the closest intersection (others are not needed)
-		if ((curDistSq = (cqn.GetHitPos()).SqDistance(p0)) >= minDistSq)
-			continue;
+			cx[k] = c.x; cy[k] = c.y; cz[k] = c.z; rSq[k] = r * r;
+		}
+
+		const int mask = SegmentSpheresMask(cx, cy, cz, rSq, p0, sd, sdInvSq);
+
+		for (unsigned int k = 0; k < 4; k++) {
+			if ((mask & (1 << k)) == 0)
+				continue;
+
+			const LocalModelPiece* lmp = o->localModel.GetPiece(base + k);
+			const CollisionVolume* lmpVol = lmp->GetCollisionVolume();
+
+			volMat = m * lmp->GetModelSpaceMatrix();
+			volMat.Translate(lmpVol->GetOffsets());
 
-		minDistSq = curDistSq;
+			CollisionQuery cqn;
+			if (!CCollisionHandler::Intersect(lmpVol, volMat, p0, p1, &cqn))
+				continue;
 
-		// return early if caller only wants to know a collision exists
-		if (cq == nullptr)
-			return true;
+			// skip if neither an ingress nor an egress hit
+			if (!cqn.AnyHit())
+				continue;
 
-		*cq = cqn;
-		cq->SetHitPiece(lmp);
+			// save the closest intersection (others are not needed)
+			if ((curDistSq = (cqn.GetHitPos()).SqDistance(p0)) >= minDistSq)
+				continue;
+
+			minDistSq = curDistSq;
+
+			// return early if caller only wants to know a collision exists
+			if (cq == nullptr)
+				return true;
+
+			*cq = cqn;
+			cq->SetHitPiece(lmp);
+		}
 	}
 
 	// true iff at least one piece was intersected
@@ -96,6 +96,34 @@ class CCollisionHandler {
 			CollisionQuery* cq = nullptr,
 			bool forceTrace = false
 		);
+		/**
+		 * Batched variant of DetectHit for one ray-segment against many
+		 * objects (using their own volumes and synced transforms); a SIMD
+		 * bounding-sphere pass culls objects the segment can not touch so
+		 * the exact per-object tests only run for the remaining candidates.
+		 * The pre-pass is conservative, results are identical to calling
+		 * DetectHit on each object in order.
+		 * @return index of the first object that was hit, or -1
+		 */
+		static int DetectHitBatch(
+			const CSolidObject* const* objects,
+			unsigned int numObjects,
+			const float3 p0,
+			const float3 p1,
+			CollisionQuery* cq = nullptr,
+			bool forceTrace = false
+		);
+		/**
+		 * Runs only the bounding-sphere pass of DetectHitBatch, compacts
+		 * <objects> (preserving order) to those the segment might touch.
+		 * @return number of remaining objects
+		 */
+		static unsigned int CullSegmentMisses(
+			const CSolidObject** objects,
+			unsigned int numObjects,
+			const float3 p0,
+			const float3 p1
+		);
 		static bool MouseHit(
 			const CSolidObject* o,
 			const CMatrix44f& m,
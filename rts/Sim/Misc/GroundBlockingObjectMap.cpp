@@ -12,12 +12,82 @@
 
 CGroundBlockingObjectMap* groundBlockingObjectMap = nullptr;
 
-CR_BIND(CGroundBlockingObjectMap, (1))
+CR_BIND(CGroundBlockingObjectMap, (1, 1))
 CR_REG_METADATA(CGroundBlockingObjectMap, (
-	CR_MEMBER(groundBlockingMap)
+	CR_MEMBER(mapx),
+	CR_MEMBER(cellObjects),
+	CR_MEMBER(multiCells),
+	CR_MEMBER(occupiedBits),
+	CR_MEMBER(multiBits)
 ))
 
 
+CGroundBlockingObjectMap::CGroundBlockingObjectMap(int mapx, int mapy): mapx(mapx)
+{
+	const unsigned int numSquares = mapx * mapy;
+
+	cellObjects.clear();
+	cellObjects.resize(numSquares, nullptr);
+	multiCells.clear();
+
+	occupiedBits.clear();
+	occupiedBits.resize((numSquares + 63) / 64, 0);
+	multiBits.clear();
+	multiBits.resize((numSquares + 63) / 64, 0);
+}
+
+
+void CGroundBlockingObjectMap::AddToCell(unsigned int mapSquare, CSolidObject* object)
+{
+	CSolidObject*& firstObj = cellObjects[mapSquare];
+
+	if (firstObj == nullptr) {
+		firstObj = object;
+		occupiedBits[mapSquare / 64] |= (std::uint64_t(1) << (mapSquare % 64));
+		return;
+	}
+
+	if (!IsMultiCell(mapSquare)) {
+		if (firstObj == object)
+			return;
+
+		multiCells[mapSquare] = {firstObj, object};
+		multiBits[mapSquare / 64] |= (std::uint64_t(1) << (mapSquare % 64));
+		return;
+	}
+
+	spring::VectorInsertUnique(multiCells[mapSquare], object, true);
+}
+
+void CGroundBlockingObjectMap::RemoveFromCell(unsigned int mapSquare, CSolidObject* object)
+{
+	CSolidObject*& firstObj = cellObjects[mapSquare];
+
+	if (!IsMultiCell(mapSquare)) {
+		if (firstObj != object)
+			return;
+
+		firstObj = nullptr;
+		occupiedBits[mapSquare / 64] &= ~(std::uint64_t(1) << (mapSquare % 64));
+		return;
+	}
+
+	const auto it = multiCells.find(mapSquare);
+	std::vector<CSolidObject*>& objs = it->second;
+
+	// same (swap-and-pop) order as a plain per-square vector would have
+	spring::VectorErase(objs, object);
+
+	firstObj = objs[0];
+
+	if (objs.size() > 1)
+		return;
+
+	multiCells.erase(it);
+	multiBits[mapSquare / 64] &= ~(std::uint64_t(1) << (mapSquare % 64));
+}
+
+
 
 void CGroundBlockingObjectMap::AddGroundBlockingObject(CSolidObject* object)
 {
@@ -39,7 +109,7 @@ void CGroundBlockingObjectMap::AddGroundBlockingObject(CSolidObject* object)
 
 	for (int zSqr = minZSqr; zSqr < maxZSqr; zSqr++) {
 		for (int xSqr = minXSqr; xSqr < maxXSqr; xSqr++) {
-			spring::VectorInsertUnique(GetCellUnsafe(xSqr + zSqr * mapDims.mapx), object, true);
+			AddToCell(xSqr + zSqr * mapDims.mapx, object);
 		}
 	}
 
@@ -67,7 +137,7 @@ void CGroundBlockingObjectMap::AddGroundBlockingObject(CSolidObject* object, con
 			const float3 testPos = float3(x, 0.0f, z) * SQUARE_SIZE;
 
 			if (object->GetGroundBlockingMaskAtPos(testPos) & mask) {
-				spring::VectorInsertUnique(GetCellUnsafe(x + (z) * mapDims.mapx), object, true);
+				AddToCell(x + z * mapDims.mapx, object);
 			}
 		}
 	}
@@ -90,7 +160,7 @@ void CGroundBlockingObjectMap::RemoveGroundBlockingObject(CSolidObject* object)
 
 	for (int z = bz; z < bz + sz; ++z) {
 		for (int x = bx; x < bx + sx; ++x) {
-			spring::VectorErase(GetCellUnsafe(z * mapDims.mapx + x), object);
+			RemoveFromCell(z * mapDims.mapx + x, object);
 		}
 	}
 
@@ -102,6 +172,53 @@ void CGroundBlockingObjectMap::RemoveGroundBlockingObject(CSolidObject* object)
 
 
 
+void CGroundBlockingObjectMap::MoveGroundBlockingObject(CSolidObject* object)
+{
+	// mobile objects only; they have no yardmap and cause no TerrainChange's
+	assert(object->IsBlocking());
+	assert(object->moveDef != nullptr);
+	assert(object->blockMap == nullptr);
+
+	const int2 oldPos = object->mapPos;
+	const int2 newPos = object->GetMapPos();
+
+	const int sx = object->xsize;
+	const int sz = object->zsize;
+
+	object->mapPos = newPos;
+	object->groundBlockPos = object->pos;
+
+	// usually the case, the footprint did not leave its squares
+	if (newPos == oldPos)
+		return;
+
+	const auto InFootPrint = [&](const int2& fp, int x, int z) {
+		return (x >= fp.x && x < (fp.x + sx) && z >= fp.y && z < (fp.y + sz));
+	};
+
+	// squares of the old footprint that are not part of the new one
+	for (int z = oldPos.y; z < oldPos.y + sz; ++z) {
+		for (int x = oldPos.x; x < oldPos.x + sx; ++x) {
+			if (InFootPrint(newPos, x, z))
+				continue;
+
+			RemoveFromCell(z * mapDims.mapx + x, object);
+		}
+	}
+
+	// and vice versa
+	for (int z = newPos.y; z < newPos.y + sz; ++z) {
+		for (int x = newPos.x; x < newPos.x + sx; ++x) {
+			if (InFootPrint(oldPos, x, z))
+				continue;
+
+			AddToCell(z * mapDims.mapx + x, object);
+		}
+	}
+}
+
+
+
 CSolidObject* CGroundBlockingObjectMap::GroundBlocked(int x, int z) const {
 	if (x < 0 || x >= mapDims.mapx || z < 0 || z >= mapDims.mapy)
 		return nullptr;
@@ -122,20 +239,20 @@ bool CGroundBlockingObjectMap::GroundBlocked(int x, int z, const CSolidObject* i
 	if ((unsigned)x >= mapDims.mapx || (unsigned)z >= mapDims.mapy)
 		return false;
 
-	const BlockingMapCell& cell = GetCellUnsafeConst(z * mapDims.mapx + x);
+	const unsigned int mapSquare = z * mapDims.mapx + x;
 
-	if (cell.empty())
+	if (cellObjects[mapSquare] == nullptr)
 		return false;
 
-	// check if the first object in <cell> is NOT the ignoree
+	// check if the first object in the cell is NOT the ignoree
 	// if so the ground is definitely blocked at this location
-	if (*(cell.cbegin()) != ignoreObj)
+	if (cellObjects[mapSquare] != ignoreObj)
 		return true;
 
 	// otherwise the ground is considered blocked only if there
-	// is at least one other object in <cell> together with the
-	// ignoree
-	return (cell.size() >= 2);
+	// is at least one other object in the cell together with
+	// the ignoree
+	return (IsMultiCell(mapSquare));
 }
 
 
@@ -148,6 +265,43 @@ bool CGroundBlockingObjectMap::GroundBlocked(const float3& pos, const CSolidObje
 
 
 
+bool CGroundBlockingObjectMap::RangeOccupiedUnsafe(int xmin, int xmax, int zmin, int zmax) const
+{
+	assert(xmin >= 0 && xmax < mapx && xmin <= xmax);
+
+	for (int z = zmin; z <= zmax; z++) {
+		const unsigned int minSquare = z * mapx + xmin;
+		const unsigned int maxSquare = z * mapx + xmax;
+
+		const unsigned int minWord = minSquare / 64;
+		const unsigned int maxWord = maxSquare / 64;
+
+		const std::uint64_t minMask = ~std::uint64_t(0) << (minSquare % 64);
+		const std::uint64_t maxMask = ~std::uint64_t(0) >> (63 - (maxSquare % 64));
+
+		if (minWord == maxWord) {
+			if ((occupiedBits[minWord] & minMask & maxMask) != 0)
+				return true;
+
+			continue;
+		}
+
+		if ((occupiedBits[minWord] & minMask) != 0)
+			return true;
+		if ((occupiedBits[maxWord] & maxMask) != 0)
+			return true;
+
+		for (unsigned int w = minWord + 1; w < maxWord; w++) {
+			if (occupiedBits[w] != 0)
+				return true;
+		}
+	}
+
+	return false;
+}
+
+
+
 /**
   * Opens up a yard in a blocked area.
   * When a factory opens up, for example.
@@ -205,8 +359,8 @@ unsigned int CGroundBlockingObjectMap::CalcChecksum() const
 {
 	unsigned int checksum = 666;
 
-	for (unsigned int i = 0; i < groundBlockingMap.size(); ++i) {
-		if (!groundBlockingMap[i].empty()) {
+	for (unsigned int i = 0; i < cellObjects.size(); ++i) {
+		if (cellObjects[i] != nullptr) {
 			checksum = HsiehHash(&i, sizeof(i), checksum);
 		}
 	}
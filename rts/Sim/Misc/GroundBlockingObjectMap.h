@@ -3,32 +3,57 @@
 #ifndef GROUNDBLOCKINGOBJECTMAP_H
 #define GROUNDBLOCKINGOBJECTMAP_H
 
+#include <algorithm>
+#include <cstdint>
 #include <vector>
 
 #include "Sim/Objects/SolidObject.h"
 #include "System/creg/creg_cond.h"
 #include "System/float3.h"
+#include "System/UnorderedMap.hpp"
 
 
-typedef std::vector<CSolidObject*> BlockingMapCell;
-typedef std::vector<BlockingMapCell> BlockingMap;
+/**
+ * read-only view of the objects blocking a map square, in insertion
+ * order; invalidated by any change to the blocking map
+ */
+class BlockingMapCell {
+public:
+	BlockingMapCell(CSolidObject* const* b, CSolidObject* const* e): beg(b), end_(e) {}
+
+	CSolidObject* const* begin() const { return beg; }
+	CSolidObject* const* end() const { return end_; }
+
+	bool empty() const { return (beg == end_); }
+	size_t size() const { return (end_ - beg); }
+
+	CSolidObject* operator [] (size_t i) const { return beg[i]; }
+
+private:
+	CSolidObject* const* beg;
+	CSolidObject* const* end_;
+};
 
 
+/**
+ * Blocking objects are stored in layers: a bitmask marking the occupied
+ * squares (for footprint-sized range queries that test 64 squares at once), the first object of every square, and only for the relatively
+ * rare squares holding more than one object a list of all of them.
+ */
 class CGroundBlockingObjectMap
 {
 	CR_DECLARE_STRUCT(CGroundBlockingObjectMap)
 
 public:
-	CGroundBlockingObjectMap(int numSquares) {
-		groundBlockingMap.clear();
-		groundBlockingMap.resize(numSquares);
-	}
+	CGroundBlockingObjectMap(int mapx, int mapy);
 
 	unsigned int CalcChecksum() const;
 
 	void AddGroundBlockingObject(CSolidObject* object);
 	void AddGroundBlockingObject(CSolidObject* object, const YardMapStatus& mask);
 	void RemoveGroundBlockingObject(CSolidObject* object);
+	/// re-registers a blocking mobile object at its current position, touching only the squares it entered or left
+	void MoveGroundBlockingObject(CSolidObject* object);
 
 	void OpenBlockingYard(CSolidObject* object);
 	void CloseBlockingYard(CSolidObject* object);
@@ -43,42 +68,62 @@ public:
 
 	// same as GroundBlocked(), but does not bounds-check mapSquare
 	CSolidObject* GroundBlockedUnsafe(unsigned int mapSquare) const {
-		const BlockingMapCell& cell = GetCellUnsafeConst(mapSquare);
-
-		if (cell.empty())
-			return nullptr;
-
-		return (*cell.begin());
+		assert(mapSquare < cellObjects.size());
+		return cellObjects[mapSquare];
 	}
 
 
 	bool GroundBlocked(int x, int z, const CSolidObject* ignoreObj) const;
 	bool GroundBlocked(const float3& pos, const CSolidObject* ignoreObj) const;
 
+	/// true if any square in [xmin, xmax] x [zmin, zmax] holds an object, does not bounds-check
+	bool RangeOccupiedUnsafe(int xmin, int xmax, int zmin, int zmax) const;
+
 	bool ObjectInCell(unsigned int mapSquare, const CSolidObject* obj) const {
-		if (mapSquare >= groundBlockingMap.size())
+		if (mapSquare >= cellObjects.size())
 			return false;
 
-		const BlockingMapCell& cell = GetCellUnsafeConst(mapSquare);
-		const auto it = std::find(cell.cbegin(), cell.cend(), obj);
-		return (it != cell.cend());
+		const BlockingMapCell cell = GetCellUnsafeConst(mapSquare);
+		const auto it = std::find(cell.begin(), cell.end(), obj);
+		return (it != cell.end());
 	}
 
 
-	const BlockingMapCell& GetCellUnsafeConst(unsigned int mapSquare) const {
-		assert(mapSquare < groundBlockingMap.size());
-		return groundBlockingMap[mapSquare];
-	}
+	BlockingMapCell GetCellUnsafeConst(unsigned int mapSquare) const {
+		assert(mapSquare < cellObjects.size());
+
+		CSolidObject* const* obj = &cellObjects[mapSquare];
 
-	BlockingMapCell& GetCellUnsafe(unsigned int mapSquare) {
-		return (const_cast<BlockingMapCell&>(GetCellUnsafeConst(mapSquare)));
+		if (*obj == nullptr)
+			return {obj, obj};
+		if (!IsMultiCell(mapSquare))
+			return {obj, obj + 1};
+
+		const std::vector<CSolidObject*>& objs = multiCells.find(mapSquare)->second;
+		return {objs.data(), objs.data() + objs.size()};
 	}
 
 private:
 	bool CheckYard(CSolidObject* yardUnit, const YardMapStatus& mask) const;
 
+	void AddToCell(unsigned int mapSquare, CSolidObject* object);
+	void RemoveFromCell(unsigned int mapSquare, CSolidObject* object);
+
+	bool IsMultiCell(unsigned int mapSquare) const {
+		return ((multiBits[mapSquare / 64] >> (mapSquare % 64)) & 1);
+	}
+
 private:
-	BlockingMap groundBlockingMap;
+	int mapx;
+
+	/// first object of each square, nullptr if empty
+	std::vector<CSolidObject*> cellObjects;
+	/// all objects of squares holding more than one, by square index
+	spring::unordered_map<unsigned int, std::vector<CSolidObject*>> multiCells;
+
+	/// one bit per square (indexed like cellObjects, so the squares of a row are consecutive bits)
+	std::vector<std::uint64_t> occupiedBits;
+	std::vector<std::uint64_t> multiBits;
 };
 
 extern CGroundBlockingObjectMap* groundBlockingObjectMap;
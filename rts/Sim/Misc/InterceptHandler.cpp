@@ -6,6 +6,7 @@
 #include "InterceptHandler.h"
 
 #include "Map/Ground.h"
+#include "Map/ReadMap.h"
 #include "Sim/Weapons/Weapon.h"
 #include "Sim/Projectiles/WeaponProjectiles/WeaponProjectile.h"
 #include "Sim/Units/Unit.h"
@@ -20,97 +21,278 @@
 CR_BIND_DERIVED(CInterceptHandler, CObject, )
 CR_REG_METADATA(CInterceptHandler, (
 	CR_MEMBER(interceptors),
-	CR_MEMBER(interceptables)
+	CR_MEMBER(interceptables),
+
+	CR_IGNORED(gridCellOffsets),
+	CR_IGNORED(gridCellInterceptors),
+	CR_IGNORED(candidates),
+	CR_IGNORED(candidateMarks),
+	CR_IGNORED(candidateMark),
+	CR_IGNORED(coverageMins),
+	CR_IGNORED(coverageMaxs),
+	CR_IGNORED(gridSizeX),
+	CR_IGNORED(gridSizeZ),
+	CR_IGNORED(gridUpdateFrame)
 ))
 
 CInterceptHandler interceptHandler;
 
+// in elmos; interceptor coverage ranges are typically a few hundred to a few thousand
+static constexpr float GRID_CELL_SIZE = 512.0f;
 
 
 void CInterceptHandler::Update(bool forced) {
 	if (((gs->frameNum % UNIT_SLOWUPDATE_RATE) != 0) && !forced)
 		return;
 
-	for (CWeapon* w: interceptors) {
-		const WeaponDef* wDef = w->weaponDef;
-		const CUnit* wOwner = w->owner;
-
-		assert(wDef->interceptor || wDef->isShield);
-
-		for (CWeaponProjectile* p: interceptables) {
-			if (!p->CanBeInterceptedBy(wDef))
-				continue;
-			if (w->HasIncomingProjectile(p->id))
-				continue;
-
-			const int pAllyTeam = p->GetAllyteamID();
-
-			if (teamHandler->IsValidAllyTeam(pAllyTeam) && teamHandler->Ally(wOwner->allyteam, pAllyTeam))
-				continue;
-
-			// note: will be called every Update so long as gadget does not return true
-			if (!eventHandler.AllowWeaponInterceptTarget(wOwner, w, p))
-				continue;
-
-			// there are four cases when an interceptor <w> should fire at a projectile <p>:
-			//     1. p's target position inside w's interception circle (w's owner can move!)
-			//     2. p's current position inside w's interception circle
-			//     3. p's projected impact position inside w's interception circle
-			//     4. p's trajectory intersects w's interception circle
-			//
-			// these checks all need to be evaluated periodically, not just
-			// when a projectile is created and handed to AddInterceptTarget
-			const float weaponDist = w->aimFromPos.distance(p->pos);
-			const float impactDist = CGround::LineGroundCol(p->pos, p->pos + p->dir * weaponDist);
-
-			const float3& pImpactPos = p->pos + p->dir * impactDist;
-			const float3& pTargetPos = p->GetTargetPos();
-			const float3  pWeaponVec = p->pos - w->aimFromPos;
-
-			if (w->aimFromPos.SqDistance2D(pTargetPos) < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->AddIncomingProjectile(p->id);
-				continue; // 1
-			}
+	UpdateInterceptorGrid();
 
-			if (false /*wDef->noFlyThroughIntercept*/) {
-				// <w> is just a static interceptor and fires only at projectiles
-				// TARGETED within its current interception area; any projectiles
-				// CROSSING its interception area aren't targeted
-				//XXX implement in lua?
-				continue;
-			}
+	// per interceptor, projectiles are still handled in interceptables order
+	for (CWeaponProjectile* p: interceptables) {
+		GetInterceptorCandidates(p);
+
+		for (const unsigned int i: candidates) {
+			TryInterceptTarget(interceptors[i], p);
+		}
+	}
+}
 
-			if (pWeaponVec.SqLength2D() < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->AddIncomingProjectile(p->id);
-				continue; // 2
-			}
 
-			if (w->aimFromPos.SqDistance2D(pImpactPos) < Square(wDef->coverageRange)) {
-				const float3 pTargetDir = (pTargetPos - p->pos).SafeNormalize();
-				const float3 pImpactDir = (pImpactPos - p->pos).SafeNormalize();
-
-				// the projected impact position can briefly shift into the covered
-				// area during transition from vertical to horizontal flight, so we
-				// perform an extra test (NOTE: assumes non-parabolic trajectory)
-				if (pTargetDir.dot(pImpactDir) >= 0.999f) {
-					w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-					w->AddIncomingProjectile(p->id);
-					continue; // 3
-				}
+void CInterceptHandler::UpdateInterceptorGrid()
+{
+	gridUpdateFrame = gs->frameNum;
+
+	gridSizeX = std::max(1, int(math::ceil((mapDims.mapx * SQUARE_SIZE) / GRID_CELL_SIZE)));
+	gridSizeZ = std::max(1, int(math::ceil((mapDims.mapy * SQUARE_SIZE) / GRID_CELL_SIZE)));
+
+	gridCellOffsets.clear();
+	gridCellOffsets.resize(gridSizeX * gridSizeZ + 1, 0);
+	gridCellInterceptors.clear();
+
+	candidateMarks.clear();
+	candidateMarks.resize(interceptors.size(), 0);
+	candidateMark = 0;
+
+	coverageMins = float3( std::numeric_limits<float>::max(), 0.0f,  std::numeric_limits<float>::max());
+	coverageMaxs = float3(-std::numeric_limits<float>::max(), 0.0f, -std::numeric_limits<float>::max());
+
+	// a sampled point of a flight line (see GetInterceptorCandidates) is at
+	// most a quarter cell away from any point between it and the next sample;
+	// the rest is slack for interceptors that move before AddInterceptTarget
+	// gets called later in the same frame
+	const auto GetCellRect = [&](const CWeapon* w, int& x1, int& z1, int& x2, int& z2) {
+		const float r = w->weaponDef->coverageRange + GRID_CELL_SIZE * 0.25f + SQUARE_SIZE * 8.0f;
+		const float3& p = w->aimFromPos;
+
+		x1 = Clamp(int(math::floor((p.x - r) / GRID_CELL_SIZE)), 0, gridSizeX - 1);
+		z1 = Clamp(int(math::floor((p.z - r) / GRID_CELL_SIZE)), 0, gridSizeZ - 1);
+		x2 = Clamp(int(math::floor((p.x + r) / GRID_CELL_SIZE)), 0, gridSizeX - 1);
+		z2 = Clamp(int(math::floor((p.z + r) / GRID_CELL_SIZE)), 0, gridSizeZ - 1);
+
+		coverageMins.x = std::min(coverageMins.x, p.x - r);
+		coverageMins.z = std::min(coverageMins.z, p.z - r);
+		coverageMaxs.x = std::max(coverageMaxs.x, p.x + r);
+		coverageMaxs.z = std::max(coverageMaxs.z, p.z + r);
+	};
+
+	int x1, z1, x2, z2;
+
+	// count, then fill (cells get their interceptors in interceptors order)
+	for (const CWeapon* w: interceptors) {
+		GetCellRect(w, x1, z1, x2, z2);
+
+		for (int z = z1; z <= z2; z++) {
+			for (int x = x1; x <= x2; x++) {
+				gridCellOffsets[x + z * gridSizeX + 1] += 1;
 			}
+		}
+	}
 
-			const float3 pMinSepPos = p->pos + p->dir * Clamp(-(pWeaponVec.dot(p->dir)), 0.0f, impactDist);
-			const float3 pMinSepVec = w->aimFromPos - pMinSepPos;
+	for (size_t i = 1; i < gridCellOffsets.size(); i++) {
+		gridCellOffsets[i] += gridCellOffsets[i - 1];
+	}
+
+	gridCellInterceptors.resize(gridCellOffsets.back());
+
+	for (unsigned int i = 0; i < interceptors.size(); i++) {
+		GetCellRect(interceptors[i], x1, z1, x2, z2);
 
-			if (pMinSepVec.SqLength() < Square(wDef->coverageRange)) {
-				w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
-				w->AddIncomingProjectile(p->id);
-				continue; // 4
+		for (int z = z1; z <= z2; z++) {
+			for (int x = x1; x <= x2; x++) {
+				gridCellInterceptors[gridCellOffsets[x + z * gridSizeX]++] = i;
 			}
 		}
 	}
+
+	// shift the offsets (used as insertion indices above) back into place
+	for (size_t i = gridCellOffsets.size() - 1; i > 0; i--) {
+		gridCellOffsets[i] = gridCellOffsets[i - 1];
+	}
+
+	gridCellOffsets[0] = 0;
+}
+
+
+void CInterceptHandler::AddGridCellCandidates(int cx, int cz)
+{
+	const int cellIdx = Clamp(cx, 0, gridSizeX - 1) + Clamp(cz, 0, gridSizeZ - 1) * gridSizeX;
+
+	for (unsigned int n = gridCellOffsets[cellIdx]; n < gridCellOffsets[cellIdx + 1]; n++) {
+		const unsigned int i = gridCellInterceptors[n];
+
+		if (candidateMarks[i] == candidateMark)
+			continue;
+
+		candidateMarks[i] = candidateMark;
+		candidates.push_back(i);
+	}
+}
+
+
+void CInterceptHandler::GetInterceptorCandidates(const CWeaponProjectile* p)
+{
+	candidates.clear();
+
+	if (interceptors.empty())
+		return;
+
+	if ((++candidateMark) == 0) {
+		std::fill(candidateMarks.begin(), candidateMarks.end(), 0);
+		candidateMark = 1;
+	}
+
+	const auto GetCellX = [](float x) { return int(math::floor(x / GRID_CELL_SIZE)); };
+	const auto GetCellZ = [](float z) { return int(math::floor(z / GRID_CELL_SIZE)); };
+
+	// case 1 of TryInterceptTarget
+	AddGridCellCandidates(GetCellX(p->GetTargetPos().x), GetCellZ(p->GetTargetPos().z));
+
+	// cases 2-4 only look at points p->pos + p->dir * t with t in
+	// [-1, weaponDist], so walk the flight line from t = -1 for as
+	// long as it is inside the bounds of all coverage circles
+	const float3& pos = p->pos;
+	const float3& dir = p->dir;
+
+	float tMin = -1.0f;
+	float tMax = std::numeric_limits<float>::max();
+
+	const auto ClipSlab = [&](float o, float d, float mins, float maxs) {
+		if (d == 0.0f) {
+			if (o < mins || o > maxs)
+				tMax = -std::numeric_limits<float>::max();
+
+			return;
+		}
+
+		const float t1 = (mins - o) / d;
+		const float t2 = (maxs - o) / d;
+
+		tMin = std::max(tMin, std::min(t1, t2));
+		tMax = std::min(tMax, std::max(t1, t2));
+	};
+
+	ClipSlab(pos.x, dir.x, coverageMins.x, coverageMaxs.x);
+	ClipSlab(pos.z, dir.z, coverageMins.z, coverageMaxs.z);
+
+	if (tMin > tMax)
+		return;
+
+	// sample every half cell in 2D
+	const float dirLength2D = dir.Length2D();
+	const float tStep = (dirLength2D > 0.0f)? ((GRID_CELL_SIZE * 0.5f) / dirLength2D): std::numeric_limits<float>::max();
+
+	for (float t = tMin; ; t += tStep) {
+		const float ct = std::min(t, tMax);
+
+		AddGridCellCandidates(GetCellX(pos.x + dir.x * ct), GetCellZ(pos.z + dir.z * ct));
+
+		if (ct >= tMax || (t + tStep) <= t)
+			break;
+	}
+
+	// each cell is sorted, but the cells of the line are visited in any order
+	std::sort(candidates.begin(), candidates.end());
+}
+
+
+void CInterceptHandler::TryInterceptTarget(CWeapon* w, CWeaponProjectile* p)
+{
+	const WeaponDef* wDef = w->weaponDef;
+	const CUnit* wOwner = w->owner;
+
+	assert(wDef->interceptor || wDef->isShield);
+
+	if (!p->CanBeInterceptedBy(wDef))
+		return;
+	if (w->HasIncomingProjectile(p->id))
+		return;
+
+	const int pAllyTeam = p->GetAllyteamID();
+
+	if (teamHandler->IsValidAllyTeam(pAllyTeam) && teamHandler->Ally(wOwner->allyteam, pAllyTeam))
+		return;
+
+	// note: will be called every Update so long as gadget does not return true
+	if (!eventHandler.AllowWeaponInterceptTarget(wOwner, w, p))
+		return;
+
+	// there are four cases when an interceptor <w> should fire at a projectile <p>:
+	//     1. p's target position inside w's interception circle (w's owner can move!)
+	//     2. p's current position inside w's interception circle
+	//     3. p's projected impact position inside w's interception circle
+	//     4. p's trajectory intersects w's interception circle
+	//
+	// these checks all need to be evaluated periodically, not just
+	// when a projectile is created and handed to AddInterceptTarget
+	const float weaponDist = w->aimFromPos.distance(p->pos);
+	const float impactDist = CGround::LineGroundCol(p->pos, p->pos + p->dir * weaponDist);
+
+	const float3& pImpactPos = p->pos + p->dir * impactDist;
+	const float3& pTargetPos = p->GetTargetPos();
+	const float3  pWeaponVec = p->pos - w->aimFromPos;
+
+	if (w->aimFromPos.SqDistance2D(pTargetPos) < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->AddIncomingProjectile(p->id);
+		return; // 1
+	}
+
+	if (false /*wDef->noFlyThroughIntercept*/) {
+		// <w> is just a static interceptor and fires only at projectiles
+		// TARGETED within its current interception area; any projectiles
+		// CROSSING its interception area aren't targeted
+		//XXX implement in lua?
+		return;
+	}
+
+	if (pWeaponVec.SqLength2D() < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->AddIncomingProjectile(p->id);
+		return; // 2
+	}
+
+	if (w->aimFromPos.SqDistance2D(pImpactPos) < Square(wDef->coverageRange)) {
+		const float3 pTargetDir = (pTargetPos - p->pos).SafeNormalize();
+		const float3 pImpactDir = (pImpactPos - p->pos).SafeNormalize();
+
+		// the projected impact position can briefly shift into the covered
+		// area during transition from vertical to horizontal flight, so we
+		// perform an extra test (NOTE: assumes non-parabolic trajectory)
+		if (pTargetDir.dot(pImpactDir) >= 0.999f) {
+			w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+			w->AddIncomingProjectile(p->id);
+			return; // 3
+		}
+	}
+
+	const float3 pMinSepPos = p->pos + p->dir * Clamp(-(pWeaponVec.dot(p->dir)), 0.0f, impactDist);
+	const float3 pMinSepVec = w->aimFromPos - pMinSepPos;
+
+	if (pMinSepVec.SqLength() < Square(wDef->coverageRange)) {
+		w->AddDeathDependence(p, DEPENDENCE_INTERCEPT);
+		w->AddIncomingProjectile(p->id);
+		return; // 4
+	}
 }
 
 
@@ -118,6 +300,7 @@ void CInterceptHandler::Update(bool forced) {
 void CInterceptHandler::AddInterceptorWeapon(CWeapon* weapon)
 {
 	interceptors.push_back(weapon);
+	gridUpdateFrame = -1;
 }
 
 
@@ -127,6 +310,8 @@ void CInterceptHandler::RemoveInterceptorWeapon(CWeapon* weapon)
 	if (it != interceptors.end()) {
 		interceptors.erase(it);
 	}
+
+	gridUpdateFrame = -1;
 }
 
 
@@ -140,7 +325,15 @@ void CInterceptHandler::AddInterceptTarget(CWeaponProjectile* target, const floa
 	// die before the interceptable itself does)
 	AddDeathDependence(target, DEPENDENCE_INTERCEPTABLE);
 
-	Update(true);
+	// the other interceptables are rechecked by the next periodic Update
+	if (gridUpdateFrame != gs->frameNum)
+		UpdateInterceptorGrid();
+
+	GetInterceptorCandidates(target);
+
+	for (const unsigned int i: candidates) {
+		TryInterceptTarget(interceptors[i], target);
+	}
 }
 
 
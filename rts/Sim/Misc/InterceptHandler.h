@@ -4,8 +4,11 @@
 #define INTERCEPT_HANDLER_H
 
 #include <deque>
+#include <vector>
+
 #include "System/Misc/NonCopyable.h"
 #include "System/Object.h"
+#include "System/float3.h"
 
 class CWeapon;
 class CWeaponProjectile;
@@ -26,9 +29,37 @@ public:
 
 	void DependentDied(CObject* o);
 
+private:
+	/// sorts the interceptors' coverage circles into a coarse grid over the map
+	void UpdateInterceptorGrid();
+	/**
+	 * collects (in interceptors order) every interceptor whose coverage circle
+	 * can contain <p>'s target position or any point of its flight line
+	 */
+	void GetInterceptorCandidates(const CWeaponProjectile* p);
+	void AddGridCellCandidates(int cx, int cz);
+
+	void TryInterceptTarget(CWeapon* w, CWeaponProjectile* p);
+
 private:
 	std::deque<CWeapon*> interceptors;
 	std::deque<CWeaponProjectile*> interceptables;
+
+	/// interceptor indices per grid cell (cells in [gridCellOffsets[i], gridCellOffsets[i + 1]))
+	std::vector<unsigned int> gridCellOffsets;
+	std::vector<unsigned int> gridCellInterceptors;
+
+	std::vector<unsigned int> candidates;
+	std::vector<unsigned int> candidateMarks;
+	unsigned int candidateMark = 0;
+
+	/// bounds of all coverage circles
+	float3 coverageMins;
+	float3 coverageMaxs;
+
+	int gridSizeX = 0;
+	int gridSizeZ = 0;
+	int gridUpdateFrame = -1;
 };
 
 extern CInterceptHandler interceptHandler;
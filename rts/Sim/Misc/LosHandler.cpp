@@ -15,6 +15,8 @@
 #include "System/Threading/ThreadPool.h"
 #include "System/TimeProfiler.h"
 
+#include <atomic>
+
 #define USE_STAGGERED_UPDATES 0
 
 
@@ -61,6 +63,7 @@ inline void SLosInstance::Init(int radius, int allyteam, int2 basePos, float bas
 	this->isCache = false;
 	this->isQueuedForUpdate = false;
 	this->isQueuedForTerraform = false;
+	this->terraRect = SRectangle();
 }
 
 
@@ -85,6 +88,10 @@ ILosType::ILosType(const int mipLevel_, LosType type_)
 	, algoType((type == LOS_TYPE_LOS || type == LOS_TYPE_RADAR) ? LOS_ALGO_RAYCAST : LOS_ALGO_CIRCLE)
 	, losMaps(teamHandler->ActiveAllyTeams(),
 		CLosMap(size, type == LOS_TYPE_LOS, readMap->GetMIPHeightMapSynced(mipLevel_), int2(mapDims.mapx, mapDims.mapy)))
+	, numRaysCast(0)
+	, numRaysReused(0)
+	, sumRaysCast(0)
+	, sumRaysReused(0)
 {
 }
 
@@ -237,7 +244,7 @@ inline void ILosType::LosAdd(SLosInstance* li)
 	if (algoType == LOS_ALGO_RAYCAST) {
 		losMaps[li->allyteam].AddRaycast(li, 1);
 	} else {
-		losMaps[li->allyteam].AddCircle(li, 1);
+		losMaps[li->allyteam].AddCircleDeltas(li, 1);
 	}
 }
 
@@ -247,7 +254,7 @@ inline void ILosType::LosRemove(SLosInstance* li)
 	if (algoType == LOS_ALGO_RAYCAST) {
 		losMaps[li->allyteam].AddRaycast(li, -1);
 	} else {
-		losMaps[li->allyteam].AddCircle(li, -1);
+		losMaps[li->allyteam].AddCircleDeltas(li, -1);
 	}
 }
 
@@ -452,6 +459,11 @@ void ILosType::Update()
 		delayedTerraQue.pop_front();
 	}
 
+	numRaysCast = 0;
+	numRaysReused = 0;
+
+	gainedRects.clear();
+
 	// no updates? -> early exit
 	if (losUpdate.empty())
 		return;
@@ -513,18 +525,45 @@ void ILosType::Update()
 
 	// raycast terrain
 	if (algoType == LOS_ALGO_RAYCAST)  {
+		std::atomic<size_t> raysCast = {0};
+		std::atomic<size_t> raysTotal = {0};
+
 		for_mt(0, losRecalc.size(), [&](const int idx) {
 			auto li = losRecalc[idx];
 			assert(li->refCount > 0);
-			li->squares.clear();
-			losMaps[li->allyteam].PrepareRaycast(li);
+
+			const CLosMap::RaycastStats stats = losMaps[li->allyteam].UpdateRaycast(li, li->terraRect);
+
+			li->terraRect = SRectangle();
+
+			raysCast += stats.numRaysCast;
+			raysTotal += stats.numRaysTotal;
 		});
+
+		numRaysCast = raysCast;
+		numRaysReused = raysTotal - raysCast;
+		sumRaysCast += numRaysCast;
+		sumRaysReused += numRaysReused;
 	}
 
 	// add sight
+	gainedRects.reserve(losAdd.size());
+
 	for (SLosInstance* li: losAdd) {
 		assert(li->refCount > 0);
 		LosAdd(li);
+
+		const int2 p = li->basePos;
+		const int  r = li->radius;
+
+		gainedRects.emplace_back(li->allyteam, SRectangle(p.x - r, p.y - r, p.x + r, p.y + r));
+	}
+
+	// circles were only stamped as per-line deltas, integrate them
+	if (algoType == LOS_ALGO_CIRCLE) {
+		for (CLosMap& losMap: losMaps) {
+			losMap.ApplyCircleDeltas();
+		}
 	}
 
 	// delete / move to cache unused instances
@@ -588,14 +627,34 @@ void ILosType::UpdateHeightMapSynced(SRectangle rect)
 		DeleteInstance(li);
 	}
 
+	// changed area in LOS-map squares, padded by one since a mip-level
+	// height sample also depends on its neighbouring heightmap squares
+	const SRectangle losRect = {
+		(rect.x1 * SQUARE_SIZE) / divisor - 1,
+		(rect.z1 * SQUARE_SIZE) / divisor - 1,
+		(rect.x2 * SQUARE_SIZE) / divisor + 2,
+		(rect.z2 * SQUARE_SIZE) / divisor + 2,
+	};
+
 	// relos used instances
 	for (auto& p: instanceHash) {
 		for (SLosInstance* li: p.second) {
-			if (li->status & SLosInstance::TLosStatus::RECALC)
-				continue;
 			if (!CheckOverlap(li, rect))
 				continue;
 
+			// grow the dirty area of instances that are already queued
+			if (li->terraRect.GetArea() > 0) {
+				li->terraRect.x1 = std::min(li->terraRect.x1, losRect.x1);
+				li->terraRect.z1 = std::min(li->terraRect.z1, losRect.z1);
+				li->terraRect.x2 = std::max(li->terraRect.x2, losRect.x2);
+				li->terraRect.z2 = std::max(li->terraRect.z2, losRect.z2);
+			} else {
+				li->terraRect = losRect;
+			}
+
+			if (li->status & SLosInstance::TLosStatus::RECALC)
+				continue;
+
 			UpdateInstanceStatus(li, SLosInstance::TLosStatus::RECALC);
 		}
 	}
@@ -654,10 +713,20 @@ CLosHandler::~CLosHandler()
 	}
 	LOG_L(L_WARNING, "LosHandler MemUsage: ~%.1fMB", memUsage / (1024.f * 1024.f));*/
 
-	LOG("LosHandler stats: total instances=%u; shared=%.0f%%; from cache=%.0f%%",
+	size_t sumRaysCast = 0;
+	size_t sumRaysReused = 0;
+
+	for (const ILosType* lt: losTypes) {
+		sumRaysCast += lt->sumRaysCast;
+		sumRaysReused += lt->sumRaysReused;
+	}
+
+	LOG("LosHandler stats: total instances=%u; shared=%.0f%%; from cache=%.0f%%; rays cast=%lu; rays reused=%lu",
 		unsigned(ILosType::cacheHits + ILosType::cacheFails),
 		100.f * float(ILosType::cacheHits - ILosType::cacheReactivated) / (ILosType::cacheHits + ILosType::cacheFails),
-		100.f * float(ILosType::cacheReactivated) / (ILosType::cacheHits + ILosType::cacheFails));
+		100.f * float(ILosType::cacheReactivated) / (ILosType::cacheHits + ILosType::cacheFails),
+		(unsigned long) sumRaysCast,
+		(unsigned long) sumRaysReused);
 }
 
 
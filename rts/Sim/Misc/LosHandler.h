@@ -13,7 +13,7 @@
 #include "System/type2.h"
 #include "System/Rectangle.h"
 #include "System/EventClient.h"
-#include "System/UnorderedMap.hpp"
+#include "System/FlatHashMap.hpp"
 
 
 /**
@@ -79,6 +79,10 @@ public:
 	bool isCache;
 	bool isQueuedForUpdate;
 	bool isQueuedForTerraform;
+
+	// union of terraformed areas (in LOS-map squares) since the
+	// last raycast; only rays crossing it need to be recomputed
+	SRectangle terraRect;
 };
 
 
@@ -164,11 +168,22 @@ public:
 	const LosAlgoType algoType;
 	std::vector<CLosMap> losMaps;
 
+	// (unclipped) areas, in LOS-map squares, that had sight added by the last
+	// Update() as <allyteam, rect> pairs; lets unsynced code like the ghosted
+	// building cleanup look only at regions that could have become visible
+	std::vector<std::pair<int, SRectangle>> gainedRects;
+
 	static size_t cacheFails;
 	static size_t cacheHits;
 	static size_t cacheReactivated;
 
-	spring::unordered_map<int, std::vector<SLosInstance*> > instanceHash;
+	// raycast stats, for the last Update() and the whole game
+	size_t numRaysCast;
+	size_t numRaysReused;
+	size_t sumRaysCast;
+	size_t sumRaysReused;
+
+	spring::flat_hash_map<int, std::vector<SLosInstance*> > instanceHash;
 
 	std::deque<SLosInstance> instances;
 	std::deque<int> freeIDs;
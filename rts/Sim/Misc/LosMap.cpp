@@ -392,6 +392,9 @@ void CLosMap::AddCircle(SLosInstance* instance, int amount)
 	//only AddRaycast supports UnsyncedHeightMap updates
 #endif
 
+	version += 1;
+	MarkRowsDirty(instance->basePos.y - instance->radius, instance->basePos.y + instance->radius + 1);
+
 	MidpointCircleAlgoPerLine(instance->radius, [&](int width, int y) {
 		const unsigned y_ = instance->basePos.y + y;
 		if (y_ < size.y) {
@@ -406,11 +409,81 @@ void CLosMap::AddCircle(SLosInstance* instance, int amount)
 }
 
 
+void CLosMap::AddCircleDeltas(SLosInstance* instance, int amount)
+{
+	version += 1;
+	MarkRowsDirty(instance->basePos.y - instance->radius, instance->basePos.y + instance->radius + 1);
+
+	if (deltamap.empty())
+		deltamap.resize(size.x * size.y, 0);
+
+	MidpointCircleAlgoPerLine(instance->radius, [&](int width, int y) {
+		const unsigned y_ = instance->basePos.y + y;
+
+		if (y_ >= size.y)
+			return;
+
+		const int sx = Clamp(instance->basePos.x - width,     0, size.x);
+		const int ex = Clamp(instance->basePos.x + width + 1, 0, size.x);
+
+		if (sx >= ex)
+			return;
+
+		// a line that ends at the map border needs no closing delta
+		deltamap[(y_ * size.x) + sx] += amount;
+
+		if (ex < size.x)
+			deltamap[(y_ * size.x) + ex] -= amount;
+
+		deltaRect.x1 = std::min(deltaRect.x1, sx);
+		deltaRect.z1 = std::min(deltaRect.z1, int(y_));
+		deltaRect.x2 = std::max(deltaRect.x2, std::min(ex + 1, size.x));
+		deltaRect.z2 = std::max(deltaRect.z2, int(y_) + 1);
+	});
+}
+
+
+void CLosMap::ApplyCircleDeltas()
+{
+	if (deltaRect.x1 >= deltaRect.x2)
+		return;
+
+	// every closing delta lies inside the rect, so the running sum of each
+	// row is back to zero at x2 and the squares right of it are unaffected
+	for (int y = deltaRect.z1; y < deltaRect.z2; ++y) {
+		unsigned short* losRow = &losmap[y * size.x];
+		int* deltaRow = &deltamap[y * size.x];
+		int sum = 0;
+
+		for (int x = deltaRect.x1; x < deltaRect.x2; ++x) {
+			sum += deltaRow[x];
+			deltaRow[x] = 0;
+			losRow[x] += sum;
+		}
+	}
+
+	deltaRect = SRectangle(size.x, size.y, 0, 0);
+}
+
+
 void CLosMap::AddRaycast(SLosInstance* instance, int amount)
 {
 	if (instance->squares.empty() || instance->squares.front().length == SLosInstance::EMPTY_RLE.length)
 		return;
 
+	version += 1;
+
+	{
+		int2 rows = {size.y, 0};
+
+		for (const SLosInstance::RLE rle: instance->squares) {
+			rows.x = std::min(rows.x, int(rle.start) / size.x);
+			rows.y = std::max(rows.y, int(rle.start + rle.length - 1) / size.x + 1);
+		}
+
+		MarkRowsDirty(rows.x, rows.y);
+	}
+
 #ifdef USE_UNSYNCED_HEIGHTMAP
 	// Inform ReadMap when squares enter LoS
 	const bool updateUnsyncedHeightMap = (instance->allyteam >= 0 && (instance->allyteam == gu->myAllyTeam || gu->spectatingFullView));
@@ -461,6 +534,36 @@ void CLosMap::PrepareRaycast(SLosInstance* instance) const
 }
 
 
+CLosMap::RaycastStats CLosMap::UpdateRaycast(SLosInstance* instance, const SRectangle& dirtyRect) const
+{
+	CLosTableHelper& helper = losTableHelpers[ThreadPool::GetThreadNum()];
+	helper.GenerateForLosSize(instance->radius);
+
+	RaycastStats stats;
+	stats.numRaysTotal = helper.GetLosTableSize(instance->radius) * 4;
+	stats.numRaysCast = stats.numRaysTotal;
+
+	// partial updates need the previous result and are only implemented
+	// for instances away from the map edges (see UnsafeLosAdd); the base
+	// square also decides whether the instance is buried (see LosAdd)
+	const SRectangle safeRect(instance->radius, instance->radius, size.x - instance->radius, size.y - instance->radius);
+
+	const bool reuse =
+		(!instance->squares.empty() && instance->squares.front().length != SLosInstance::EMPTY_RLE.length) &&
+		(dirtyRect.GetArea() > 0 && !dirtyRect.Inside(instance->basePos)) &&
+		(instance->radius > 0 && safeRect.Inside(instance->basePos));
+
+	if (!reuse) {
+		instance->squares.clear();
+		PrepareRaycast(instance);
+		return stats;
+	}
+
+	stats.numRaysCast = PartialLosAdd(instance, dirtyRect);
+	return stats;
+}
+
+
 #define MAP_SQUARE(pos) ((pos).y * size.x + (pos).x)
 
 
@@ -519,6 +622,23 @@ inline void CastLos(float* prevAng, float* maxAng, const int2& off, std::vector<
 }
 
 
+// same as CastLos for a lazily computed angle; returns false if the square is occluded
+inline bool CastLosAngle(float* prevAng, float* maxAng, const float angle, const int2& off, int threadNum)
+{
+	if (angle < *maxAng)
+		return false;
+
+	if (angle < *prevAng) {
+		const float invR = isqrtTableLookup(off.x*off.x + off.y*off.y, threadNum);
+		*maxAng = *prevAng - LOS_BONUS_HEIGHT * invR;
+		if (angle < *maxAng)
+			return false;
+	}
+	*prevAng = angle;
+	return true;
+}
+
+
 void CLosMap::AddSquaresToInstance(SLosInstance* li, const std::vector<char>& squaresMap) const
 {
 	const int2 pos   = li->basePos;
@@ -625,6 +745,128 @@ void CLosMap::UnsafeLosAdd(SLosInstance* li) const
 }
 
 
+size_t CLosMap::PartialLosAdd(SLosInstance* li, const SRectangle& dirtyRect) const
+{
+	// How does it work?
+	// A square's visibility is the AND of the verdicts of all rays crossing it
+	// (see UnsafeLosAdd), and a ray's verdict at a square only depends on the
+	// heights up to that square. Squares lying at or behind a dirty square on
+	// some ray are "affected"; all others keep the value stored in the RLE.
+	// Rays crossing affected squares are re-cast up to their last affected
+	// square, and only the affected squares take the new verdicts.
+	const int threadNum = ThreadPool::GetThreadNum();
+
+	const int2 pos   = li->basePos;
+	const int radius = li->radius;
+	const float losHeight = li->baseHeight;
+
+	CLosTableHelper& helper = losTableHelpers[threadNum];
+	helper.GenerateForLosSize(radius);
+
+	std::vector<char> squaresMap(Square((2 * radius) + 1), false);
+	std::vector<char> affectedMap(Square((2 * radius) + 1), false);
+	std::vector<int> lineWidths((2 * radius) + 1, -1);
+
+	isqrtTableExpand((radius + 1) * (radius + 1), threadNum);
+
+	// squares outside of the circle never had an angle assigned
+	MidpointCircleAlgoPerLine(radius, [&](int width, int y) {
+		lineWidths[y + radius] = std::max(lineWidths[y + radius], width);
+	});
+
+	// restore the previous result
+	for (const SLosInstance::RLE rle: li->squares) {
+		const int2 off = IdxToCoord(rle.start, size.x) - pos;
+		std::fill_n(squaresMap.begin() + ToAngleMapIdx(off, radius), rle.length, true);
+	}
+
+	const auto MirrorSquare = [](const int2 square, const int k) {
+		switch (k) {
+			case 0: return (square);
+			case 1: return (-square);
+			case 2: return (int2(square.y, -square.x));
+			default: break;
+		}
+		return (int2(-square.y, square.x));
+	};
+
+	const size_t numRays = helper.GetLosTableSize(radius);
+
+	for (size_t i = 0; i < numRays; ++i) {
+		const size_t numSquares = helper.GetLosTableRaySize(radius, i);
+
+		for (int k = 0; k < 4; k++) {
+			size_t n = 0;
+
+			for (; n < numSquares; n++) {
+				if (dirtyRect.Inside(pos + MirrorSquare(helper.GetLosTableRaySquare(radius, i, n), k)))
+					break;
+			}
+			for (; n < numSquares; n++) {
+				const int2 off = MirrorSquare(helper.GetLosTableRaySquare(radius, i, n), k);
+				const size_t oidx = ToAngleMapIdx(off, radius);
+
+				if (affectedMap[oidx])
+					continue;
+
+				affectedMap[oidx] = true;
+				squaresMap[oidx] = (std::abs(off.x) <= lineWidths[off.y + radius]);
+			}
+		}
+	}
+
+	size_t numRaysCast = 0;
+
+	for (size_t i = 0; i < numRays; ++i) {
+		const size_t numSquares = helper.GetLosTableRaySize(radius, i);
+
+		for (int k = 0; k < 4; k++) {
+			size_t numCastSquares = 0;
+
+			for (size_t n = 0; n < numSquares; n++) {
+				if (affectedMap[ToAngleMapIdx(MirrorSquare(helper.GetLosTableRaySquare(radius, i, n), k), radius)])
+					numCastSquares = n + 1;
+			}
+
+			if (numCastSquares == 0)
+				continue;
+
+			float maxAng = -1e7;
+			float prevAng = -1e7;
+
+			for (size_t n = 0; n < numCastSquares; n++) {
+				const int2 off = MirrorSquare(helper.GetLosTableRaySquare(radius, i, n), k);
+				const size_t oidx = ToAngleMapIdx(off, radius);
+
+				float angle = -1e8;
+
+				if (std::abs(off.x) <= lineWidths[off.y + radius]) {
+					const float invR = isqrtTableLookup(off.x*off.x + off.y*off.y, threadNum);
+					const float dh = std::max(0.f, heightmap[MAP_SQUARE(pos + off)]) - losHeight;
+
+					angle = (dh + LOS_BONUS_HEIGHT) * invR;
+				}
+
+				if (!CastLosAngle(&prevAng, &maxAng, angle, off, threadNum) && affectedMap[oidx])
+					squaresMap[oidx] = false;
+			}
+
+			numRaysCast += 1;
+		}
+	}
+
+	li->squares.clear();
+
+	// translate visible square indices to map square idx + RLE
+	AddSquaresToInstance(li, squaresMap);
+
+	if (li->squares.empty())
+		li->squares.push_back(SLosInstance::EMPTY_RLE);
+
+	return numRaysCast;
+}
+
+
 void CLosMap::SafeLosAdd(SLosInstance* li) const
 {
 	// How does it work?
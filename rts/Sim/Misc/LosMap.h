@@ -5,9 +5,12 @@
 #ifndef LOS_MAP_H
 #define LOS_MAP_H
 
+#include <algorithm>
+#include <cassert>
 #include <vector>
 #include "System/type2.h"
 #include "System/myMath.h"
+#include "System/Rectangle.h"
 
 
 struct SLosInstance;
@@ -21,43 +24,100 @@ public:
 	: size(size_)
 	, LOS2HEIGHT(mapDims / size)
 	, losmap(size.x * size.y, 0)
+	, deltaRect(size.x, size.y, 0, 0)
+	, rowVersions(size.y, 0)
 	, sendReadmapEvents(sendReadmapEvents_)
 	, heightmap(heightmap_)
+	, version(0)
 	{ }
 
 public:
 	/// circular area, for airLosMap, circular radar maps, jammer maps, ...
 	void AddCircle(SLosInstance* instance, int amount);
 
+	/// same as AddCircle, but only records where each line of the circle
+	/// starts and ends (O(radius) instead of O(radius^2)); the map is not
+	/// valid until ApplyCircleDeltas is called
+	void AddCircleDeltas(SLosInstance* instance, int amount);
+
+	/// integrates the deltas recorded since the last call into the map,
+	/// one prefix-sum per row over the dirty rectangle
+	void ApplyCircleDeltas();
+
 	/// arbitrary area, for losMap, non-circular radar maps, ...
 	void AddRaycast(SLosInstance* instance, int amount);
 
 	/// arbitrary area, for losMap, non-circular radar maps, ...
 	void PrepareRaycast(SLosInstance* instance) const;
 
+	struct RaycastStats {
+		size_t numRaysCast;
+		size_t numRaysTotal;
+	};
+
+	/// recalculates the squares of an already raycast instance after the
+	/// terrain inside <dirtyRect> (in LOS-map squares) changed; only rays
+	/// that pass through it are cast again, falls back to a full raycast
+	/// if the previous result can not be reused
+	RaycastStats UpdateRaycast(SLosInstance* instance, const SRectangle& dirtyRect) const;
+
 public:
 	int At(int2 p) const {
 		p.x = Clamp(p.x, 0, size.x - 1);
 		p.y = Clamp(p.y, 0, size.y - 1);
+		assert(deltaRect.x1 >= deltaRect.x2);
 		return losmap[p.y * size.x + p.x];
 	}
 
 	// FIXME temp fix for CBaseGroundDrawer and AI interface, which need raw data
 	unsigned short& front() { return losmap.front(); }
+	const unsigned short& front() const { return losmap.front(); }
+
+	/// changes whenever the map is modified, lets unsynced consumers skip redundant uploads
+	unsigned int GetVersion() const { return version; }
+
+	/// range [x, y) of the rows modified after GetVersion() returned <sinceVersion>
+	/// (conservative, rows in between might be unchanged); x == y if there are none
+	int2 GetDirtyRows(unsigned int sinceVersion) const {
+		int2 rows = {size.y, 0};
+
+		for (int z = 0; z < size.y; z++) {
+			if (rowVersions[z] <= sinceVersion)
+				continue;
+
+			rows.x = std::min(rows.x, z    );
+			rows.y = std::max(rows.y, z + 1);
+		}
+
+		return ((rows.x < rows.y)? rows: int2(0, 0));
+	}
 
 private:
+	void MarkRowsDirty(int z1, int z2) {
+		std::fill(rowVersions.begin() + std::max(z1, 0), rowVersions.begin() + std::min(z2, size.y), version);
+	}
+
 	void LosAdd(SLosInstance* instance) const;
 	void UnsafeLosAdd(SLosInstance* instance) const;
 	void SafeLosAdd(SLosInstance* instance) const;
 
 	void AddSquaresToInstance(SLosInstance* li, const std::vector<char>& squaresMap) const;
+	size_t PartialLosAdd(SLosInstance* li, const SRectangle& dirtyRect) const;
 
 protected:
 	const int2 size;
 	const int2 LOS2HEIGHT;
 	std::vector<unsigned short> losmap;
+	/// per-square changes of the running sum along each row, see AddCircleDeltas
+	std::vector<int> deltamap;
+	/// bounds of the non-zero deltamap squares, empty (x1 >= x2) if none
+	SRectangle deltaRect;
+	/// value of version when each row was last modified
+	std::vector<unsigned int> rowVersions;
 	bool sendReadmapEvents;
 	const float* const heightmap;
+
+	unsigned int version;
 };
 
 #endif // LOS_MAP_H
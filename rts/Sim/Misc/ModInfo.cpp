@@ -31,6 +31,8 @@ void CModInfo::ResetState()
 	allowUnitCollisionOverlap = true;
 	allowGroundUnitGravity    = true;
 	allowHoverUnitStrafing    = true;
+	allowParallelMoveTypeUpdates = false;
+	allowUnitCollisionBroadphase = false;
 
 	constructionDecay      = true;
 	constructionDecayTime  = 1000;
@@ -80,8 +82,19 @@ void CModInfo::ResetState()
 	pathFinderSystem = PFS_TYPE_DEFAULT;
 	pfRawDistMult    = 1.25f;
 	pfUpdateRate     = 0.007f;
+	pfQueueRequests  = false;
+	pfShareGroupPaths = false;
+	pfParallelSearches = false;
+	pfCorridorCache = false;
 
 	allowTake = true;
+	allowParallelProjectileUpdates = false;
+	allowParallelWeaponTargeting = false;
+	unitUpdateReorderRate = 0;
+	allowBatchedExplosionDamage = false;
+	allowSmoothMeshUpdates = false;
+	allowParallelUnitSlowUpdate = false;
+	allowAreaTargetCache = false;
 }
 
 void CModInfo::Init(const char* modArchive)
@@ -117,8 +130,19 @@ void CModInfo::Init(const char* modArchive)
 		pathFinderSystem = system.GetInt("pathFinderSystem", PFS_TYPE_DEFAULT) % PFS_NUM_TYPES;
 		pfRawDistMult = system.GetFloat("pathFinderRawDistMult", pfRawDistMult);
 		pfUpdateRate = system.GetFloat("pathFinderUpdateRate", pfUpdateRate);
+		pfQueueRequests = system.GetBool("pathFinderQueueRequests", pfQueueRequests);
+		pfShareGroupPaths = system.GetBool("pathFinderShareGroupPaths", pfShareGroupPaths);
+		pfParallelSearches = system.GetBool("pathFinderParallelSearches", pfParallelSearches);
+		pfCorridorCache = system.GetBool("pathFinderCorridorCache", pfCorridorCache);
 
 		allowTake = system.GetBool("allowTake", true);
+		allowParallelProjectileUpdates = system.GetBool("allowParallelProjectileUpdates", false);
+		allowParallelWeaponTargeting = system.GetBool("allowParallelWeaponTargeting", false);
+		unitUpdateReorderRate = std::max(0, system.GetInt("unitUpdateReorderRate", 0));
+		allowBatchedExplosionDamage = system.GetBool("allowBatchedExplosionDamage", false);
+		allowSmoothMeshUpdates = system.GetBool("allowSmoothMeshUpdates", false);
+		allowParallelUnitSlowUpdate = system.GetBool("allowParallelUnitSlowUpdate", false);
+		allowAreaTargetCache = system.GetBool("allowAreaTargetCache", false);
 	}
 
 	{
@@ -134,6 +158,8 @@ void CModInfo::Init(const char* modArchive)
 		allowUnitCollisionOverlap = movementTbl.GetBool("allowUnitCollisionOverlap", true);
 		allowGroundUnitGravity = movementTbl.GetBool("allowGroundUnitGravity", true);
 		allowHoverUnitStrafing = movementTbl.GetBool("allowHoverUnitStrafing", (pathFinderSystem == PFS_TYPE_QTPFS));
+		allowParallelMoveTypeUpdates = movementTbl.GetBool("allowParallelMoveTypeUpdates", false);
+		allowUnitCollisionBroadphase = movementTbl.GetBool("allowUnitCollisionBroadphase", false);
 	}
 
 	{
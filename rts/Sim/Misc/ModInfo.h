@@ -50,6 +50,8 @@ public:
 	bool allowUnitCollisionOverlap;  //< determines if unit footprints are allowed to semi-overlap during collisions
 	bool allowGroundUnitGravity;     //< determines if (ground-)units experience gravity during regular movement
 	bool allowHoverUnitStrafing;     //< determines if (hover-)units carry their momentum sideways when turning
+	bool allowParallelMoveTypeUpdates; //< determines if MoveType updates are split into a parallel compute and a serial commit phase
+	bool allowUnitCollisionBroadphase; //< determines if ground-unit collision pairs come from a per-frame broadphase (and are pushed apart once per frame)
 
 	// Build behaviour
 	/// Should constructions without builders decay?
@@ -147,8 +149,30 @@ public:
 	int pathFinderSystem;
 	float pfRawDistMult;
 	float pfUpdateRate;
+	/// defer move-type path requests of the default PFS to the next PathManager update and run them in parallel
+	bool pfQueueRequests;
+	/// let move-type path requests with nearly equal start, goal and MoveDef in a single frame share one estimator path
+	bool pfShareGroupPaths;
+	/// let QTPFS execute the queued searches of all layers processed in an update concurrently
+	bool pfParallelSearches;
+	/// let the PathEstimator caches serve sub-paths of cached paths whose blocks are not touched by a map change
+	bool pfCorridorCache;
 
 	bool allowTake;
+	/// split synced projectile updates into a parallel compute and a serial (projectile-ID ordered) commit phase
+	bool allowParallelProjectileUpdates;
+	/// batch weapon auto-targeting per SlowUpdate round, gathering candidates in parallel
+	bool allowParallelWeaponTargeting;
+	/// if positive, activeUnits is re-sorted along a Z-order curve of unit positions every this many frames
+	int unitUpdateReorderRate;
+	/// defer damage of explosions during the synced projectile update, then apply it using one QuadField gather per group
+	bool allowBatchedExplosionDamage;
+	/// incrementally recompute the smoothed heightmesh (used by aircraft) around terrain changes
+	bool allowSmoothMeshUpdates;
+	/// gather read-only queries of the staggered unit SlowUpdate in parallel, then mutate serially in unit order
+	bool allowParallelUnitSlowUpdate;
+	/// let builders on area reclaim/repair/resurrect/capture share one QuadField search per circle and SlowUpdate period
+	bool allowAreaTargetCache;
 };
 
 extern CModInfo modInfo;
@@ -9,6 +9,7 @@
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "System/ContainerUtil.h"
+#include "System/Threading/ThreadPool.h"
 
 #ifndef UNIT_TEST
 	#include "Sim/Features/Feature.h"
@@ -25,17 +26,13 @@ CR_REG_METADATA(CQuadField, (
 	CR_MEMBER(quadSizeX),
 	CR_MEMBER(quadSizeZ),
 
-	CR_IGNORED(tempUnits),
-	CR_IGNORED(tempFeatures),
-	CR_IGNORED(tempProjectiles),
-	CR_IGNORED(tempSolids),
-	CR_IGNORED(tempQuads)
+	CR_IGNORED(queryScratch)
 ))
 
 CR_BIND(CQuadField::Quad, )
 CR_REG_METADATA_SUB(CQuadField, Quad, (
 	CR_MEMBER(units),
-	CR_IGNORED(teamUnits),
+	CR_IGNORED(unitOffsets),
 	CR_MEMBER(features),
 	CR_MEMBER(projectiles),
 	CR_MEMBER(repulsers),
@@ -99,16 +96,74 @@ void CQuadField::Resize(int quad_size)
 CQuadField::Quad::Quad()
 {
 #ifndef UNIT_TEST
-	teamUnits.resize(teamHandler->ActiveAllyTeams());
-	assert(teamUnits.capacity() == teamHandler->ActiveAllyTeams());
+	unitOffsets.resize(teamHandler->ActiveAllyTeams() + 1, 0);
 #endif
 }
 
+void CQuadField::Quad::InsertUnit(CUnit* unit, int allyTeam)
+{
+	const int numAllyTeams = unitOffsets.size() - 1;
+
+	assert(allyTeam < numAllyTeams);
+	assert(std::find(units.begin() + unitOffsets[allyTeam], units.begin() + unitOffsets[allyTeam + 1], unit) == (units.begin() + unitOffsets[allyTeam + 1]));
+
+	// open a hole at the end, then shift it down to the end of our run
+	// by moving the first element of every later run to that run's end
+	int holeIdx = units.size();
+
+	units.push_back(nullptr);
+
+	for (int a = numAllyTeams - 1; a > allyTeam; a--) {
+		units[holeIdx] = units[unitOffsets[a]];
+		holeIdx = unitOffsets[a];
+	}
+
+	units[holeIdx] = unit;
+
+	for (int a = allyTeam + 1; a <= numAllyTeams; a++) {
+		unitOffsets[a] += 1;
+	}
+}
+
+void CQuadField::Quad::EraseUnit(CUnit* unit, int allyTeam)
+{
+	const int numAllyTeams = unitOffsets.size() - 1;
+
+	const auto runBeg = units.begin() + unitOffsets[allyTeam    ];
+	const auto runEnd = units.begin() + unitOffsets[allyTeam + 1];
+	const auto unitIt = std::find(runBeg, runEnd, unit);
+
+	if (unitIt == runEnd)
+		return;
+
+	// inverse of InsertUnit; the hole travels up to the end of the array
+	int holeIdx = unitIt - units.begin();
+
+	for (int a = allyTeam; a < numAllyTeams; a++) {
+		units[holeIdx] = units[unitOffsets[a + 1] - 1];
+		holeIdx = unitOffsets[a + 1] - 1;
+	}
+
+	assert(holeIdx == (units.size() - 1));
+	units.pop_back();
+
+	for (int a = allyTeam + 1; a <= numAllyTeams; a++) {
+		unitOffsets[a] -= 1;
+	}
+}
+
 void CQuadField::Quad::PostLoad()
 {
 #ifndef UNIT_TEST
-	for (CUnit* unit: units) {
-		spring::VectorInsertUnique(teamUnits[unit->allyteam], unit, false);
+	// units are saved in partition-order, but rebuild defensively
+	std::stable_sort(units.begin(), units.end(), [](const CUnit* a, const CUnit* b) { return (a->allyteam < b->allyteam); });
+	std::fill(unitOffsets.begin(), unitOffsets.end(), 0);
+
+	for (const CUnit* unit: units) {
+		unitOffsets[unit->allyteam + 1] += 1;
+	}
+	for (size_t a = 1; a < unitOffsets.size(); a++) {
+		unitOffsets[a] += unitOffsets[a - 1];
 	}
 #endif
 }
@@ -126,6 +181,7 @@ CQuadField::CQuadField(int2 mapDims, int quad_size)
 	assert((mapDims.y * SQUARE_SIZE) % quad_size == 0);
 
 	baseQuads.resize(numQuadsX * numQuadsZ);
+	queryScratch.resize(ThreadPool::MAX_THREADS);
 }
 
 
@@ -149,12 +205,26 @@ int CQuadField::WorldPosToQuadFieldIdx(const float3 p) const
 }
 
 
-#ifndef UNIT_TEST
+CQuadField::QueryScratch& CQuadField::GetQueryScratch()
+{
+	assert(ThreadPool::GetThreadNum() < queryScratch.size());
+	QueryScratch& qs = queryScratch[ThreadPool::GetThreadNum()];
+
+	// allocate lazily, most threads never run a query
+	if (qs.unitMarks.empty()) {
+		qs.unitMarks.resize(MAX_UNITS, 0);
+		qs.featureMarks.resize(MAX_FEATURES, 0);
+	}
+
+	return qs;
+}
+
+
 void CQuadField::GetQuads(QuadFieldQuery& qfq, float3 pos, float radius)
 {
 	pos.AssertNaNs();
 	pos.ClampInBounds();
-	qfq.quads = tempQuads.GetVector();
+	qfq.quads = GetQueryScratch().tempQuads.GetVector();
 
 	const int2 min = WorldPosToQuadField(pos - radius);
 	const int2 max = WorldPosToQuadField(pos + radius);
@@ -184,7 +254,7 @@ void CQuadField::GetQuadsRectangle(QuadFieldQuery& qfq, const float3& mins, cons
 {
 	mins.AssertNaNs();
 	maxs.AssertNaNs();
-	qfq.quads = tempQuads.GetVector();
+	qfq.quads = GetQueryScratch().tempQuads.GetVector();
 
 	const int2 min = WorldPosToQuadField(mins);
 	const int2 max = WorldPosToQuadField(maxs);
@@ -202,7 +272,6 @@ void CQuadField::GetQuadsRectangle(QuadFieldQuery& qfq, const float3& mins, cons
 
 	return;
 }
-#endif // UNIT_TEST
 
 
 /// note: this function got an UnitTest, check the tests/ folder!
@@ -210,7 +279,7 @@ void CQuadField::GetQuadsOnRay(QuadFieldQuery& qfq, const float3& start, const f
 {
 	dir.AssertNaNs();
 	start.AssertNaNs();
-	qfq.quads = tempQuads.GetVector();
+	qfq.quads = GetQueryScratch().tempQuads.GetVector();
 
 	const float3 to = start + (dir * length);
 	const float3 invQuadSize = float3(1.0f / quadSizeX, 1.0f, 1.0f / quadSizeZ);
@@ -295,13 +364,11 @@ void CQuadField::MovedUnit(CUnit* unit)
 	}
 
 	for (const int qi: unit->quads) {
-		spring::VectorErase(baseQuads[qi].units, unit);
-		spring::VectorErase(baseQuads[qi].teamUnits[unit->allyteam], unit);
+		baseQuads[qi].EraseUnit(unit, unit->allyteam);
 	}
 
 	for (const int qi: *qfQuery.quads) {
-		spring::VectorInsertUnique(baseQuads[qi].units, unit, false);
-		spring::VectorInsertUnique(baseQuads[qi].teamUnits[unit->allyteam], unit, false);
+		baseQuads[qi].InsertUnit(unit, unit->allyteam);
 	}
 
 	unit->quads = std::move(*qfQuery.quads);
@@ -310,18 +377,15 @@ void CQuadField::MovedUnit(CUnit* unit)
 void CQuadField::RemoveUnit(CUnit* unit)
 {
 	for (const int qi: unit->quads) {
-		spring::VectorErase(baseQuads[qi].units, unit);
-		spring::VectorErase(baseQuads[qi].teamUnits[unit->allyteam], unit);
+		baseQuads[qi].EraseUnit(unit, unit->allyteam);
 	}
 
 	unit->quads.clear();
 
 	#ifdef DEBUG_QUADFIELD
 	for (const Quad& q: baseQuads) {
-		for (auto& teamUnits: q.teamUnits) {
-			for (CUnit* u: teamUnits) {
-				assert(u != unit);
-			}
+		for (CUnit* u: q.units) {
+			assert(u != unit);
 		}
 	}
 	#endif
@@ -454,15 +518,16 @@ void CQuadField::GetUnits(QuadFieldQuery& qfq, const float3& pos, float radius)
 {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
-	qfq.units = tempUnits.GetVector();
+	QueryScratch& qs = GetQueryScratch();
+	const int tempNum = ++qs.tempNum;
+	qfq.units = qs.tempUnits.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
-			if (u->tempNum == tempNum)
+			if (qs.unitMarks[u->id] == tempNum)
 				continue;
 
-			u->tempNum = tempNum;
+			qs.unitMarks[u->id] = tempNum;
 			qfq.units->push_back(u);
 		}
 	}
@@ -474,15 +539,16 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& pos, float rad
 {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
-	qfq.units = tempUnits.GetVector();
+	QueryScratch& qs = GetQueryScratch();
+	const int tempNum = ++qs.tempNum;
+	qfq.units = qs.tempUnits.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
-			if (u->tempNum == tempNum)
+			if (qs.unitMarks[u->id] == tempNum)
 				continue;
 
-			u->tempNum = tempNum;
+			qs.unitMarks[u->id] = tempNum;
 
 			const float totRad       = radius + u->radius;
 			const float totRadSq     = totRad * totRad;
@@ -504,16 +570,17 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& mins, const fl
 {
 	QuadFieldQuery qfQuery;
 	GetQuadsRectangle(qfQuery, mins, maxs);
-	const int tempNum = gs->GetTempNum();
-	qfq.units = tempUnits.GetVector();
+	QueryScratch& qs = GetQueryScratch();
+	const int tempNum = ++qs.tempNum;
+	qfq.units = qs.tempUnits.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* unit: baseQuads[qi].units) {
 
-			if (unit->tempNum == tempNum)
+			if (qs.unitMarks[unit->id] == tempNum)
 				continue;
 
-			unit->tempNum = tempNum;
+			qs.unitMarks[unit->id] = tempNum;
 
 			const float3& pos = unit->pos;
 			if (pos.x < mins.x || pos.x > maxs.x)
@@ -533,15 +600,16 @@ void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const float3& pos, float
 {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
-	qfq.features = tempFeatures.GetVector();
+	QueryScratch& qs = GetQueryScratch();
+	const int tempNum = ++qs.tempNum;
+	qfq.features = qs.tempFeatures.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CFeature* f: baseQuads[qi].features) {
-			if (f->tempNum == tempNum)
+			if (qs.featureMarks[f->id] == tempNum)
 				continue;
 
-			f->tempNum = tempNum;
+			qs.featureMarks[f->id] = tempNum;
 
 			const float totRad       = radius + f->radius;
 			const float totRadSq     = totRad * totRad;
@@ -563,15 +631,16 @@ void CQuadField::GetFeaturesExact(QuadFieldQuery& qfq, const float3& mins, const
 {
 	QuadFieldQuery qfQuery;
 	GetQuadsRectangle(qfQuery, mins, maxs);
-	const int tempNum = gs->GetTempNum();
-	qfq.features = tempFeatures.GetVector();
+	QueryScratch& qs = GetQueryScratch();
+	const int tempNum = ++qs.tempNum;
+	qfq.features = qs.tempFeatures.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CFeature* feature: baseQuads[qi].features) {
-			if (feature->tempNum == tempNum)
+			if (qs.featureMarks[feature->id] == tempNum)
 				continue;
 
-			feature->tempNum = tempNum;
+			qs.featureMarks[feature->id] = tempNum;
 
 			const float3& pos = feature->pos;
 			if (pos.x < mins.x || pos.x > maxs.x)
@@ -592,15 +661,20 @@ void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& pos, flo
 {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
-	qfq.projectiles = tempProjectiles.GetVector();
+	QueryScratch& qs = GetQueryScratch();
+	const int tempNum = ++qs.tempNum;
+	qfq.projectiles = qs.tempProjectiles.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CProjectile* p: baseQuads[qi].projectiles) {
-			if (p->tempNum == tempNum)
+			// synced projectile ID's are not bounded by a constant
+			if (p->id >= qs.projectileMarks.size())
+				qs.projectileMarks.resize(p->id + 1024, 0);
+
+			if (qs.projectileMarks[p->id] == tempNum)
 				continue;
 
-			p->tempNum = tempNum;
+			qs.projectileMarks[p->id] = tempNum;
 
 			if (pos.SqDistance(p->pos) >= Square(radius + p->radius))
 				continue;
@@ -616,15 +690,20 @@ void CQuadField::GetProjectilesExact(QuadFieldQuery& qfq, const float3& mins, co
 {
 	QuadFieldQuery qfQuery;
 	GetQuadsRectangle(qfQuery, mins, maxs);
-	const int tempNum = gs->GetTempNum();
-	qfq.projectiles = tempProjectiles.GetVector();
+	QueryScratch& qs = GetQueryScratch();
+	const int tempNum = ++qs.tempNum;
+	qfq.projectiles = qs.tempProjectiles.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CProjectile* p: baseQuads[qi].projectiles) {
-			if (p->tempNum == tempNum)
+			// synced projectile ID's are not bounded by a constant
+			if (p->id >= qs.projectileMarks.size())
+				qs.projectileMarks.resize(p->id + 1024, 0);
+
+			if (qs.projectileMarks[p->id] == tempNum)
 				continue;
 
-			p->tempNum = tempNum;
+			qs.projectileMarks[p->id] = tempNum;
 
 			const float3& pos = p->pos;
 			if (pos.x < mins.x || pos.x > maxs.x)
@@ -650,15 +729,16 @@ void CQuadField::GetSolidsExact(
 ) {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
-	qfq.solids = tempSolids.GetVector();
+	QueryScratch& qs = GetQueryScratch();
+	const int tempNum = ++qs.tempNum;
+	qfq.solids = qs.tempSolids.GetVector();
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
-			if (u->tempNum == tempNum)
+			if (qs.unitMarks[u->id] == tempNum)
 				continue;
 
-			u->tempNum = tempNum;
+			qs.unitMarks[u->id] = tempNum;
 
 			if (!u->HasPhysicalStateBit(physicalStateBits))
 				continue;
@@ -671,10 +751,10 @@ void CQuadField::GetSolidsExact(
 		}
 
 		for (CFeature* f: baseQuads[qi].features) {
-			if (f->tempNum == tempNum)
+			if (qs.featureMarks[f->id] == tempNum)
 				continue;
 
-			f->tempNum = tempNum;
+			qs.featureMarks[f->id] = tempNum;
 
 			if (!f->HasPhysicalStateBit(physicalStateBits))
 				continue;
@@ -699,14 +779,15 @@ bool CQuadField::NoSolidsExact(
 ) {
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
-	const int tempNum = gs->GetTempNum();
+	QueryScratch& qs = GetQueryScratch();
+	const int tempNum = ++qs.tempNum;
 
 	for (const int qi: *qfQuery.quads) {
 		for (CUnit* u: baseQuads[qi].units) {
-			if (u->tempNum == tempNum)
+			if (qs.unitMarks[u->id] == tempNum)
 				continue;
 
-			u->tempNum = tempNum;
+			qs.unitMarks[u->id] = tempNum;
 
 			if (!u->HasPhysicalStateBit(physicalStateBits))
 				continue;
@@ -719,10 +800,10 @@ bool CQuadField::NoSolidsExact(
 		}
 
 		for (CFeature* f: baseQuads[qi].features) {
-			if (f->tempNum == tempNum)
+			if (qs.featureMarks[f->id] == tempNum)
 				continue;
 
-			f->tempNum = tempNum;
+			qs.featureMarks[f->id] = tempNum;
 
 			if (!f->HasPhysicalStateBit(physicalStateBits))
 				continue;
@@ -747,7 +828,10 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 	std::vector<CFeature*>& features,
 	std::vector<CPlasmaRepulser*>* repulsers
 ) {
-	const int tempNum = gs->GetTempNum();
+	QueryScratch& qs = GetQueryScratch();
+	const int tempNum = ++qs.tempNum;
+	// repulser queries are main-thread only
+	const int repulserTempNum = (repulsers != nullptr)? gs->GetTempNum(): 0;
 
 	QuadFieldQuery qfQuery;
 	GetQuads(qfQuery, pos, radius);
@@ -758,10 +842,10 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 
 		for (CUnit* u: quad.units) {
 			// prevent double adding
-			if (u->tempNum == tempNum)
+			if (qs.unitMarks[u->id] == tempNum)
 				continue;
 
-			u->tempNum = tempNum;
+			qs.unitMarks[u->id] = tempNum;
 
 			const auto* colvol = &u->collisionVolume;
 			const float totRad = radius + colvol->GetBoundingRadius();
@@ -774,10 +858,10 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 
 		for (CFeature* f: quad.features) {
 			// prevent double adding
-			if (f->tempNum == tempNum)
+			if (qs.featureMarks[f->id] == tempNum)
 				continue;
 
-			f->tempNum = tempNum;
+			qs.featureMarks[f->id] = tempNum;
 
 			const auto* colvol = &f->collisionVolume;
 			const float totRad = radius + colvol->GetBoundingRadius();
@@ -790,10 +874,10 @@ void CQuadField::GetUnitsAndFeaturesColVol(
 		if (repulsers != nullptr) {
 			for (CPlasmaRepulser* r: quad.repulsers) {
 				// prevent double adding
-				if (r->tempNum == tempNum)
+				if (r->tempNum == repulserTempNum)
 					continue;
 
-				r->tempNum = tempNum;
+				r->tempNum = repulserTempNum;
 
 				const auto* colvol = &r->collisionVolume;
 				const float totRad = radius + colvol->GetBoundingRadius();
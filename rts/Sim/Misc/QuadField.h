@@ -4,6 +4,7 @@
 #define QUAD_FIELD_H
 
 #include <array>
+#include <deque>
 #include <vector>
 #include "System/Misc/NonCopyable.h"
 
@@ -21,17 +22,11 @@ struct QuadFieldQuery;
 template<typename T>
 class ExclusiveVectors {
 public:
-	// There should at most be 2 concurrent users of each vector type
-	// using 3 to be safe, increase this number if the assertions below
-	// fail
-	static constexpr int MAX_CONCURRENT_VECTORS = 3;
-	ExclusiveVectors() {
-		for (auto& v: vectors){
-			v.first = false;
-		}
-	}
+	// grows on demand (a deque never moves its elements, so handed-out
+	// vectors stay valid); normally no more than 2-3 are in concurrent
+	// use by any one thread
 	std::vector<T>* GetVector() {
-		for (auto& v: vectors){
+		for (auto& v: vectors) {
 			if (v.first)
 				continue;
 
@@ -39,15 +34,16 @@ public:
 			v.second.clear();
 			return &v.second;
 		}
-		assert(false);
-		return nullptr;
+
+		vectors.emplace_back(true, std::vector<T>());
+		return &vectors.back().second;
 	}
 
 	void ReleaseVector(std::vector<T>* released) {
 		if (released == nullptr)
 			return;
 
-		for (auto& v: vectors){
+		for (auto& v: vectors) {
 			if (&v.second != released)
 				continue;
 
@@ -57,7 +53,7 @@ public:
 		assert(false);
 	}
 
-	std::array<std::pair<bool, std::vector<T>>, MAX_CONCURRENT_VECTORS> vectors;
+	std::deque<std::pair<bool, std::vector<T>>> vectors;
 };
 
 
@@ -151,17 +147,41 @@ needed to support dynamic resizing (not used yet)
 	void MovedRepulser(CPlasmaRepulser* repulser);
 	void RemoveRepulser(CPlasmaRepulser* repulser);
 
-	void ReleaseVector(std::vector<CUnit*>* v       ) { tempUnits.ReleaseVector(v); }
-	void ReleaseVector(std::vector<CFeature*>* v    ) { tempFeatures.ReleaseVector(v); }
-	void ReleaseVector(std::vector<CProjectile*>* v ) { tempProjectiles.ReleaseVector(v); }
-	void ReleaseVector(std::vector<CSolidObject*>* v) { tempSolids.ReleaseVector(v); }
-	void ReleaseVector(std::vector<int>* v          ) { tempQuads.ReleaseVector(v); }
+	void ReleaseVector(std::vector<CUnit*>* v       ) { GetQueryScratch().tempUnits.ReleaseVector(v); }
+	void ReleaseVector(std::vector<CFeature*>* v    ) { GetQueryScratch().tempFeatures.ReleaseVector(v); }
+	void ReleaseVector(std::vector<CProjectile*>* v ) { GetQueryScratch().tempProjectiles.ReleaseVector(v); }
+	void ReleaseVector(std::vector<CSolidObject*>* v) { GetQueryScratch().tempSolids.ReleaseVector(v); }
+	void ReleaseVector(std::vector<int>* v          ) { GetQueryScratch().tempQuads.ReleaseVector(v); }
+
+	template<typename T>
+	struct ObjectRange {
+		const T* begin() const { return b; }
+		const T* end() const { return e; }
+
+		size_t size() const { return (e - b); }
+		bool empty() const { return (b == e); }
+
+		const T* b;
+		const T* e;
+	};
 
 	struct Quad {
 		CR_DECLARE_STRUCT(Quad)
 		Quad();
+
+		// units are stored in one contiguous array partitioned by
+		// allyteam, such that the run [unitOffsets[a], unitOffsets[a+1])
+		// holds all units of allyteam <a> that overlap this quad
+		ObjectRange<CUnit*> GetAllyTeamUnits(int allyTeam) const {
+			assert((allyTeam + 1) < unitOffsets.size());
+			return {units.data() + unitOffsets[allyTeam], units.data() + unitOffsets[allyTeam + 1]};
+		}
+
+		void InsertUnit(CUnit* unit, int allyTeam);
+		void EraseUnit(CUnit* unit, int allyTeam);
+
 		std::vector<CUnit*> units;
-		std::vector< std::vector<CUnit*> > teamUnits;
+		std::vector<int> unitOffsets;
 		std::vector<CFeature*> features;
 		std::vector<CProjectile*> projectiles;
 		std::vector<CPlasmaRepulser*> repulsers;
@@ -199,15 +219,30 @@ private:
 	int2 WorldPosToQuadField(const float3 p) const;
 	int WorldPosToQuadFieldIdx(const float3 p) const;
 
+	// per-thread state used by queries, so that unit and feature
+	// lookups can be made concurrently from ThreadPool workers
+	struct QueryScratch {
+		// preallocated vectors for Get*Exact functions
+		ExclusiveVectors<CUnit*> tempUnits;
+		ExclusiveVectors<CFeature*> tempFeatures;
+		ExclusiveVectors<CProjectile*> tempProjectiles;
+		ExclusiveVectors<CSolidObject*> tempSolids;
+		ExclusiveVectors<int> tempQuads;
+
+		// per-object (indexed by ID) duplicate-markers; take the role
+		// of CSolidObject::tempNum which can not be shared by threads
+		std::vector<int> unitMarks;
+		std::vector<int> featureMarks;
+		std::vector<int> projectileMarks;
+
+		int tempNum = 0;
+	};
+
+	QueryScratch& GetQueryScratch();
+
 private:
 	std::vector<Quad> baseQuads;
-
-	// preallocated vectors for Get*Exact functions
-	ExclusiveVectors<CUnit*> tempUnits;
-	ExclusiveVectors<CFeature*> tempFeatures;
-	ExclusiveVectors<CProjectile*> tempProjectiles;
-	ExclusiveVectors<CSolidObject*> tempSolids;
-	ExclusiveVectors<int> tempQuads;
+	std::vector<QueryScratch> queryScratch;
 
 	int numQuadsX;
 	int numQuadsZ;
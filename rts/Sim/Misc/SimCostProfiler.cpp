@@ -0,0 +1,246 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstdio>
+
+#include "SimCostProfiler.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Units/UnitDef.h"
+#include "Sim/Units/UnitDefHandler.h"
+#include "Sim/Weapons/WeaponDef.h"
+#include "Sim/Weapons/WeaponDefHandler.h"
+#include "System/Log/ILog.h"
+
+
+CSimCostProfiler& CSimCostProfiler::GetInstance()
+{
+	static CSimCostProfiler instance;
+	return instance;
+}
+
+
+void CSimCostProfiler::SetEnabled(bool b)
+{
+	if (b == IsEnabled())
+		return;
+
+	if (b) {
+		startFrame = gs->frameNum;
+	} else {
+		numFrames += (gs->frameNum - startFrame);
+	}
+
+	// scopes begun while enabled are not ended by the (unwrapped) gadgets anymore
+	gadgetScopes.clear();
+	enabled.store(b);
+}
+
+void CSimCostProfiler::Clear()
+{
+	// only called between frames, no other thread is adding costs
+	for (auto& categoryEntries: threadEntries) {
+		for (std::vector<Entry>& entries: categoryEntries) {
+			entries.clear();
+		}
+	}
+
+	gadgetScopes.clear();
+
+	startFrame = gs->frameNum;
+	numFrames = 0;
+}
+
+
+void CSimCostProfiler::AddCost(Category c, int id, Part p, spring_time deltaTime)
+{
+	std::vector<Entry>& entries = threadEntries[ThreadPool::GetThreadNum()][c];
+
+	if (size_t(id) >= entries.size())
+		entries.resize(id + 1);
+
+	entries[id].partTimes[p] += deltaTime.toNanoSecsi();
+	entries[id].partCalls[p] += 1;
+}
+
+
+void CSimCostProfiler::AddGadgetCost(int gadgetID, spring_time deltaTime, unsigned int numCalls)
+{
+	// gadgets only run on the sim thread
+	std::vector<Entry>& entries = threadEntries[0][CATEGORY_GADGET];
+
+	if (size_t(gadgetID) >= entries.size())
+		entries.resize(gadgetID + 1);
+
+	entries[gadgetID].partTimes[PART_GADGET_CALLINS] += deltaTime.toNanoSecsi();
+	entries[gadgetID].partCalls[PART_GADGET_CALLINS] += numCalls;
+}
+
+
+int CSimCostProfiler::BeginGadgetScope(const std::string& gadgetName)
+{
+	if (!IsEnabled())
+		return 0;
+
+	const spring_time now = spring_gettime();
+	const auto iter = gadgetIDs.find(gadgetName);
+
+	int gadgetID = gadgetNames.size();
+
+	if (iter == gadgetIDs.end()) {
+		gadgetIDs[gadgetName] = gadgetID;
+		gadgetNames.push_back(gadgetName);
+	} else {
+		gadgetID = iter->second;
+	}
+
+	// time spent in nested scopes is not charged to the enclosing gadget
+	if (!gadgetScopes.empty())
+		AddGadgetCost(gadgetScopes.back(), now - gadgetScopeTime, 0);
+
+	AddGadgetCost(gadgetID, spring_notime, 1);
+
+	gadgetScopes.push_back(gadgetID);
+	gadgetScopeTime = now;
+	return (gadgetScopes.size());
+}
+
+void CSimCostProfiler::EndGadgetScope(int depth)
+{
+	if (depth <= 0 || size_t(depth) > gadgetScopes.size())
+		return;
+
+	const spring_time now = spring_gettime();
+
+	// scopes above <depth> were left open by an error, close them too
+	AddGadgetCost(gadgetScopes.back(), now - gadgetScopeTime, 0);
+
+	gadgetScopes.resize(depth - 1);
+	gadgetScopeTime = now;
+}
+
+
+int CSimCostProfiler::GetNumFrames() const
+{
+	return (numFrames + (IsEnabled()? (gs->frameNum - startFrame): 0));
+}
+
+void CSimCostProfiler::GetRows(Category c, std::vector<Row>& rows) const
+{
+	rows.clear();
+
+	for (const auto& categoryEntries: threadEntries) {
+		const std::vector<Entry>& entries = categoryEntries[c];
+
+		if (entries.size() > rows.size()) {
+			for (size_t id = rows.size(); id < entries.size(); id++) {
+				rows.emplace_back();
+				rows.back().id = id;
+				rows.back().totalTime = 0;
+			}
+		}
+
+		for (size_t id = 0; id < entries.size(); id++) {
+			for (int p = 0; p < NUM_PARTS; p++) {
+				rows[id].entry.partTimes[p] += entries[id].partTimes[p];
+				rows[id].entry.partCalls[p] += entries[id].partCalls[p];
+				rows[id].totalTime += entries[id].partTimes[p];
+			}
+		}
+	}
+
+	rows.erase(std::remove_if(rows.begin(), rows.end(), [](const Row& r) { return (r.totalTime <= 0); }), rows.end());
+
+	for (Row& r: rows) {
+		r.name = GetEntryName(c, r.id);
+	}
+
+	std::sort(rows.begin(), rows.end(), [](const Row& a, const Row& b) {
+		return ((a.totalTime > b.totalTime) || (a.totalTime == b.totalTime && a.id < b.id));
+	});
+}
+
+
+void CSimCostProfiler::PrintRows(Category c, size_t maxEntries) const
+{
+	std::vector<Row> rows;
+	GetRows(c, rows);
+
+	const int frames = std::max(1, GetNumFrames());
+
+	std::int64_t totalTime = 0;
+
+	for (const Row& r: rows) {
+		totalTime += r.totalTime;
+	}
+
+	LOG("[SimCostProfiler::%s] %s over %d frames: %.3fms per frame", __func__, GetCategoryName(c), GetNumFrames(), totalTime * 1e-6 / frames);
+
+	for (size_t i = 0, n = std::min(rows.size(), maxEntries); i < n; i++) {
+		const Row& r = rows[i];
+
+		std::string parts;
+		char buf[128];
+
+		for (int p = 0; p < NUM_PARTS; p++) {
+			const char* partName = GetPartName(c, p);
+
+			if (partName == nullptr)
+				continue;
+
+			snprintf(buf, sizeof(buf), " %s=%.3fms/%.1f", partName, r.entry.partTimes[p] * 1e-6f / frames, r.entry.partCalls[p] / float(frames));
+			parts += buf;
+		}
+
+		LOG(
+			"\t%s (%d): %.3fms per frame (%.1f%%)%s",
+			r.name.c_str(), r.id,
+			r.totalTime * 1e-6f / frames, (r.totalTime * 100.0f) / std::max(totalTime, std::int64_t(1)),
+			parts.c_str()
+		);
+	}
+}
+
+
+const char* CSimCostProfiler::GetCategoryName(Category c)
+{
+	switch (c) {
+		case CATEGORY_UNITDEF  : return "unitdefs";
+		case CATEGORY_WEAPONDEF: return "weapondefs";
+		case CATEGORY_GADGET   : return "gadgets";
+		default                : break;
+	}
+
+	return "";
+}
+
+const char* CSimCostProfiler::GetPartName(Category c, int p)
+{
+	static constexpr const char* partNames[NUM_CATEGORIES][NUM_PARTS] = {
+		{"moveType", "slowUpdate", "update", "script"},
+		{"update", "projectiles", nullptr, nullptr},
+		{"callIns", nullptr, nullptr, nullptr},
+	};
+
+	return partNames[c][p];
+}
+
+std::string CSimCostProfiler::GetEntryName(Category c, int id) const
+{
+	switch (c) {
+		case CATEGORY_UNITDEF: {
+			const UnitDef* ud = unitDefHandler->GetUnitDefByID(id);
+			return ((ud != nullptr)? ud->name: "");
+		} break;
+		case CATEGORY_WEAPONDEF: {
+			const WeaponDef* wd = weaponDefHandler->GetWeaponDefByID(id);
+			return ((wd != nullptr)? wd->name: "");
+		} break;
+		case CATEGORY_GADGET: {
+			return gadgetNames[id];
+		} break;
+		default: {
+		} break;
+	}
+
+	return "";
+}
@@ -0,0 +1,139 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SIM_COST_PROFILER_H
+#define SIM_COST_PROFILER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+#include "System/Threading/ThreadPool.h"
+#include "System/UnorderedMap.hpp"
+
+/**
+ * Opt-in attribution of simulation time to the content causing it: per
+ * UnitDef (MoveType, SlowUpdate, Update and COB scripts), per WeaponDef
+ * (weapon and projectile updates) and per synced gadget (call-ins, timed
+ * by the gadget handler through Spring.{Begin,End}SimCostScope).
+ *
+ * Costs are accumulated per thread (so for_mt sections need no locking)
+ * and merged when read. When disabled the only cost per scope is one
+ * atomic load.
+ */
+class CSimCostProfiler
+{
+public:
+	static CSimCostProfiler& GetInstance();
+
+	enum Category {
+		CATEGORY_UNITDEF   = 0,
+		CATEGORY_WEAPONDEF = 1,
+		CATEGORY_GADGET    = 2,
+		NUM_CATEGORIES     = 3,
+	};
+
+	// parts are numbered per category
+	enum Part {
+		PART_UNIT_MOVETYPE      = 0,
+		PART_UNIT_SLOWUPDATE    = 1,
+		PART_UNIT_UPDATE        = 2,
+		PART_UNIT_SCRIPT        = 3,
+		PART_WEAPON_UPDATE      = 0,
+		PART_WEAPON_PROJECTILES = 1,
+		PART_GADGET_CALLINS     = 0,
+		NUM_PARTS               = 4,
+	};
+
+	struct Entry {
+		std::array<std::int64_t, NUM_PARTS> partTimes = {{0, 0, 0, 0}}; // nanoseconds
+		std::array<std::uint32_t, NUM_PARTS> partCalls = {{0, 0, 0, 0}};
+	};
+
+	struct Row {
+		int id;
+		std::string name;
+
+		std::int64_t totalTime; // nanoseconds
+		Entry entry;
+	};
+
+	struct ScopedCost {
+	public:
+		ScopedCost(Category c, int _id, Part p)
+			: category(c)
+			, part(p)
+			, id(GetInstance().IsEnabled()? _id: -1)
+		{
+			if (id < 0)
+				return;
+
+			startTime = spring_gettime();
+		}
+		~ScopedCost() {
+			if (id < 0)
+				return;
+
+			GetInstance().AddCost(category, id, part, spring_gettime() - startTime);
+		}
+
+	private:
+		Category category;
+		Part part;
+
+		int id;
+
+		spring_time startTime;
+	};
+
+public:
+	bool IsEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+	void SetEnabled(bool b);
+	void Clear();
+
+	void AddCost(Category c, int id, Part p, spring_time deltaTime);
+
+	/// starts timing a gadget, pausing the enclosing one; returns the new scope depth (0 if disabled)
+	int BeginGadgetScope(const std::string& gadgetName);
+	/// ends the scope returned by BeginGadgetScope and every scope left open inside it
+	void EndGadgetScope(int depth);
+	int GetGadgetScopeDepth() const { return gadgetScopes.size(); }
+
+	/// frames simulated while enabled since the last Clear
+	int GetNumFrames() const;
+	/// every id with a recorded cost, most expensive first
+	void GetRows(Category c, std::vector<Row>& rows) const;
+
+	void PrintRows(Category c, size_t maxEntries) const;
+
+	static const char* GetCategoryName(Category c);
+	/// nullptr for parts not used by the category
+	static const char* GetPartName(Category c, int p);
+
+private:
+	void AddGadgetCost(int gadgetID, spring_time deltaTime, unsigned int numCalls);
+
+	std::string GetEntryName(Category c, int id) const;
+
+private:
+	std::array<std::array<std::vector<Entry>, NUM_CATEGORIES>, ThreadPool::MAX_THREADS> threadEntries;
+
+	// gadgets only run on the sim thread
+	spring::unordered_map<std::string, int> gadgetIDs;
+	std::vector<std::string> gadgetNames;
+	std::vector<int> gadgetScopes;
+
+	spring_time gadgetScopeTime;
+
+	int startFrame = 0;
+	int numFrames = 0;
+
+	std::atomic<bool> enabled = {false};
+};
+
+#define simCostProfiler (CSimCostProfiler::GetInstance())
+
+#endif // SIM_COST_PROFILER_H
@@ -4,37 +4,50 @@
 #define SIMOBJECT_MEMPOOL_H
 
 #include <cassert>
+#include <cstddef> // max_align_t, offsetof
 #include <cstring> // memset
 #include <array>
-#include <deque>
+#include <memory>
 #include <vector>
 
-#include "System/UnorderedMap.hpp"
 #include "System/ContainerUtil.h"
 #include "System/SafeUtil.h"
 
+/**
+ * Pages live in fixed-size slabs that are never moved or freed before clear(),
+ * and carry their index in a header in front of the object so freeing needs no
+ * lookup. Memory is zeroed when an object is allocated (only as far as its size
+ * reaches) rather than when it is freed.
+ */
 template<size_t S> struct DynMemPool {
 public:
 
 	void* allocMem(size_t size) {
 		assert(size <= page_size());
-		uint8_t* m = nullptr;
 
 		size_t i = 0;
 
 		if (indcs.empty()) {
-			pages.emplace_back();
+			// new slabs are value-initialized, no need to clear their pages
+			// (reserve may already have added the one this page falls into)
+			if ((i = num_pages++) % slab_size() == 0 && (i / slab_size()) == slabs.size())
+				slabs.emplace_back(new Page[slab_size()]());
 
-			i = pages.size() - 1;
+			page(i).index = i;
 		} else {
 			// must pop before ctor runs; objects can be created recursively
 			i = spring::VectorBackPop(indcs);
+
+			std::memset(page(i).data, 0, size);
 		}
 
-		m = pages[curr_page_index = i].data();
+		Page& p = page(curr_page_index = i);
+
+		assert(!p.used);
+		p.used = true;
 
-		table.emplace(m, i);
-		return m;
+		num_used += 1;
+		return p.data;
 	}
 
 
@@ -50,13 +63,12 @@ public:
 	void freeMem(void* m) {
 		assert(mapped(m));
 
-		const auto iter = table.find(m);
-		const auto pair = std::pair<void*, size_t>{iter->first, iter->second};
+		Page* p = header(m);
 
-		std::memset(pages[pair.second].data(), 0, page_size());
+		p->used = false;
 
-		indcs.push_back(pair.second);
-		table.erase(pair.first);
+		indcs.push_back(p->index);
+		num_used -= 1;
 	}
 
 
@@ -73,32 +85,61 @@ public:
 	}
 
 	static constexpr size_t page_size() { return S; }
+	static constexpr size_t slab_size() { return 64; }
 
-	size_t alloc_size() const { return (pages.size() * page_size()); } // size of total number of pages added over the pool's lifetime
+	size_t alloc_size() const { return (num_pages * page_size()); } // size of total number of pages added over the pool's lifetime
 	size_t freed_size() const { return (indcs.size() * page_size()); } // size of number of pages that were freed and are awaiting reuse
 
-	bool mapped(void* p) const { return (table.find(p) != table.end()); }
-	bool alloced(void* p) const { return ((curr_page_index < pages.size()) && (&pages[curr_page_index][0] == p)); }
+	size_t used_count() const { return num_used; } // number of live objects
+	size_t peak_count() const { return num_pages; } // highest number of live objects, pages are only added when none are free
+
+	// p must point into some pool's page; only meant for asserts
+	bool mapped(const void* p) const {
+		const Page* h = header(p);
+		return (h->index < num_pages && &page(h->index) == h && h->used);
+	}
+	bool alloced(const void* p) const { return ((curr_page_index < num_pages) && (page(curr_page_index).data == p)); }
 
 	void clear() {
-		pages.clear();
+		slabs.clear();
 		indcs.clear();
-		table.clear();
 
+		num_pages = 0;
+		num_used = 0;
 		curr_page_index = 0;
 	}
+	// makes room for n live objects, adding all slabs up front
 	void reserve(size_t n) {
+		const size_t numSlabs = (n + slab_size() - 1) / slab_size();
+
 		indcs.reserve(n);
-		table.reserve(n);
+		slabs.reserve(numSlabs);
+
+		while (slabs.size() < numSlabs) {
+			slabs.emplace_back(new Page[slab_size()]());
+		}
 	}
 
 private:
-	std::deque<std::array<uint8_t,S>> pages;
-	std::vector<size_t> indcs;
+	struct Page {
+		size_t index;
+		bool used;
+
+		alignas(alignof(std::max_align_t)) uint8_t data[S];
+	};
 
-	// <pointer, page index> (non-intrusive)
-	spring::unsynced_map<void*, size_t> table;
+	static Page* header(void* m) { return reinterpret_cast<Page*>(reinterpret_cast<uint8_t*>(m) - offsetof(Page, data)); }
+	static const Page* header(const void* m) { return reinterpret_cast<const Page*>(reinterpret_cast<const uint8_t*>(m) - offsetof(Page, data)); }
 
+	      Page& page(size_t i)       { return slabs[i / slab_size()][i % slab_size()]; }
+	const Page& page(size_t i) const { return slabs[i / slab_size()][i % slab_size()]; }
+
+private:
+	std::vector< std::unique_ptr<Page[]> > slabs;
+	std::vector<size_t> indcs;
+
+	size_t num_pages = 0;
+	size_t num_used = 0;
 	size_t curr_page_index = 0;
 };
 
@@ -123,7 +164,9 @@ public:
 			i = indcs[--free_page_count];
 		}
 
-		return (pages[curr_page_index = i].data());
+		// cleared on allocation, only as far as the object reaches
+		std::memset(pages[curr_page_index = i].data(), 0, size);
+		return (pages[i].data());
 	}
 
 
@@ -136,8 +179,6 @@ public:
 		assert(can_free());
 		assert(mapped(m));
 
-		std::memset(m, 0, page_size());
-
 		// mark page as free
 		indcs[free_page_count++] = base_offset(m) / page_size();
 	}
@@ -159,6 +200,10 @@ public:
 	size_t alloc_size() const { return (used_page_count * page_size()); } // size of total number of pages added over the pool's lifetime
 	size_t freed_size() const { return (free_page_count * page_size()); } // size of number of pages that were freed and are awaiting reuse
 	size_t total_size() const { return (num_pages() * page_size()); }
+
+	size_t used_count() const { return (used_page_count - free_page_count); } // number of live objects
+	size_t peak_count() const { return used_page_count; } // highest number of live objects, pages are only added when none are free
+
 	size_t base_offset(const void* p) const { return (reinterpret_cast<const uint8_t*>(p) - reinterpret_cast<const uint8_t*>(&pages[0][0])); }
 
 	bool mapped(const void* p) const { return (((base_offset(p) / page_size()) < total_size()) && ((base_offset(p) % page_size()) == 0)); }
@@ -169,9 +214,7 @@ public:
 
 	void reserve(size_t) {} // no-op
 	void clear() {
-		std::memset(pages.data(), 0, total_size());
-		std::memset(indcs.data(), 0, num_pages());
-
+		// pages are cleared when allocated
 		used_page_count = 0;
 		free_page_count = 0;
 		curr_page_index = 0;
@@ -2,14 +2,18 @@
 
 #include <vector>
 #include <cassert>
+#include <cstring>
 #include <limits>
 
 #include "SmoothHeightMesh.h"
 
 #include "Map/Ground.h"
+#include "Map/MapDataCache.h"
 #include "Map/ReadMap.h"
 #include "System/float3.h"
 #include "System/myMath.h"
+#include "System/Rectangle.h"
+#include "System/Sync/HsiehHash.h"
 #include "System/TimeProfiler.h"
 #include "System/Threading/ThreadPool.h"
 
@@ -17,6 +21,11 @@
 
 SmoothHeightMesh* smoothGround = NULL;
 
+static constexpr int BLUR_RADIUS = 3;
+static constexpr int NUM_BLUR_PASSES = 3;
+// bump when the smoothing changes
+static constexpr int MESH_CACHE_VERSION = 1;
+
 
 static float Interpolate(float x, float y, const int maxx, const int maxy, const float res, const float* heightmap)
 {
@@ -407,10 +416,29 @@ void SmoothHeightMesh::MakeSmoothMesh()
 	const size_t size = (this->maxx + 1) * (this->maxy + 1);
 	// use sliding window of maximums to reduce computational complexity
 	const int intrad = smoothRadius / resolution;
-	const int smoothrad = 3;
+	const int smoothrad = BLUR_RADIUS;
 
 	assert(mesh.empty());
 	mesh.resize(size);
+	maxMesh.resize(size);
+
+	// the mesh of a pristine map only depends on the map and these parameters
+	const float* cornerHeightMap = readMap->GetCornerHeightMapSynced();
+	const float* origHeightMap = readMap->GetOriginalHeightMapSynced();
+	const size_t heightMapSize = mapDims.mapxp1 * mapDims.mapyp1 * sizeof(float);
+
+	const bool useCache = CMapDataCache::IsEnabled() && (std::memcmp(cornerHeightMap, origHeightMap, heightMapSize) == 0);
+	const float hashData[] = {float(maxx), float(maxy), resolution, smoothRadius, float(BLUR_RADIUS), float(NUM_BLUR_PASSES), float(MESH_CACHE_VERSION)};
+
+	CMapDataCache cache("smoothmesh", HsiehHash(hashData, sizeof(hashData), readMap->GetMapChecksum()));
+	cache.AddSection(mesh);
+	cache.AddSection(maxMesh);
+
+	if (useCache && cache.Read()) {
+		origMesh.resize(size);
+		std::copy(mesh.begin(), mesh.end(), origMesh.begin());
+		return;
+	}
 
 	std::vector<float> colsMaxima(maxx + 1, -std::numeric_limits<float>::max());
 	std::vector<int> maximaRows(maxx + 1, -1);
@@ -428,8 +456,11 @@ void SmoothHeightMesh::MakeSmoothMesh()
 #endif
 	}
 
+	// keep the unblurred maxima around for UpdateSmoothMesh
+	std::copy(mesh.begin(), mesh.end(), maxMesh.begin());
+
 	// actually smooth with approximate Gaussian blur passes
-	for (int numBlurs = 3; numBlurs > 0; --numBlurs) {
+	for (int numBlurs = NUM_BLUR_PASSES; numBlurs > 0; --numBlurs) {
 		BlurHorizontal(maxx, maxy, smoothrad, resolution, mesh, smoothed); mesh.swap(smoothed);
 		BlurVertical(maxx, maxy, smoothrad, resolution, mesh, smoothed); mesh.swap(smoothed);
 	}
@@ -437,4 +468,230 @@ void SmoothHeightMesh::MakeSmoothMesh()
 	// `mesh` now contains the smoothed heightmap, save it in origMesh
 	origMesh.resize(size);
 	std::copy(mesh.begin(), mesh.end(), origMesh.begin());
+
+	if (useCache)
+		cache.Write();
+}
+
+
+
+/**
+ * Writes the maximum of src[max(0, i - rad) * srcStride, ..., min(n - 1, i + rad) * srcStride]
+ * to dst[(i - i1) * dstStride] for each i in [i1, i2], using a monotone queue of candidates
+ * s.t. the cost does not depend on <rad>.
+ */
+static void SlidingWindowMaxima(
+	const float* src,
+	const int srcStride,
+	const int n,
+	const int rad,
+	const int i1,
+	const int i2,
+	float* dst,
+	const int dstStride,
+	std::vector<int>& queue
+) {
+	queue.clear();
+
+	size_t head = 0;
+
+	for (int i = i1, next = std::max(0, i1 - rad); i <= i2; i++) {
+		for (const int last = std::min(n - 1, i + rad); next <= last; next++) {
+			while (queue.size() > head && src[queue.back() * srcStride] <= src[next * srcStride])
+				queue.pop_back();
+
+			queue.push_back(next);
+		}
+
+		while (queue[head] < (i - rad))
+			head++;
+
+		dst[(i - i1) * dstStride] = src[queue[head] * srcStride];
+	}
+}
+
+void SmoothHeightMesh::UpdateSmoothMesh(const SRectangle& rect)
+{
+	SCOPED_TIMER("Sim::SmoothHeightMesh::Update");
+
+	const int intrad = smoothRadius / resolution;
+	const float sqrScale = SQUARE_SIZE / resolution;
+
+	// mesh-vertices sampling any of the changed squares; each sample
+	// interpolates the heightmap between neighbouring squares
+	const SRectangle dirtyRect = {
+		Clamp(int(rect.x1 * sqrScale) - 1, 0, maxx),
+		Clamp(int(rect.z1 * sqrScale) - 1, 0, maxy),
+		Clamp(int(rect.x2 * sqrScale) + 1, 0, maxx),
+		Clamp(int(rect.z2 * sqrScale) + 1, 0, maxy),
+	};
+	// mesh-vertices whose maximum-filter window contains a dirty vertex
+	const SRectangle maxRect = {
+		std::max(dirtyRect.x1 - intrad,    0),
+		std::max(dirtyRect.z1 - intrad,    0),
+		std::min(dirtyRect.x2 + intrad, maxx),
+		std::min(dirtyRect.z2 + intrad, maxy),
+	};
+
+	UpdateMaximaRect(maxRect, intrad);
+	UpdateBlurRect(maxRect, BLUR_RADIUS, NUM_BLUR_PASSES);
+}
+
+void SmoothHeightMesh::UpdateMaximaRect(const SRectangle& rect, int intrad)
+{
+	// vertices within reach of the windows around <rect>
+	const SRectangle smplRect = {
+		std::max(rect.x1 - intrad,    0),
+		std::max(rect.z1 - intrad,    0),
+		std::min(rect.x2 + intrad, maxx),
+		std::min(rect.z2 + intrad, maxy),
+	};
+
+	const int smplSizeX = smplRect.x2 - smplRect.x1 + 1;
+	const int smplSizeZ = smplRect.z2 - smplRect.z1 + 1;
+	const int rectSizeX = rect.x2 - rect.x1 + 1;
+	const int rectSizeZ = rect.z2 - rect.z1 + 1;
+
+	std::vector<float> heights(smplSizeX * smplSizeZ);
+	std::vector<float> colsMaxima(smplSizeX * rectSizeZ);
+	std::vector<float> rowsMaxima(rectSizeX * rectSizeZ);
+
+	for_mt(0, smplSizeZ, [&](const int z) {
+		for (int x = 0; x < smplSizeX; x++) {
+			heights[z * smplSizeX + x] = CGround::GetHeightAboveWater((smplRect.x1 + x) * resolution, (smplRect.z1 + z) * resolution);
+		}
+	});
+
+	// vertical pass; max-filter windows are clamped to the map (which
+	// smplRect reaches whenever a window would cross its boundaries)
+	for_mt(0, smplSizeX, [&](const int x) {
+		std::vector<int> queue;
+		SlidingWindowMaxima(&heights[x], smplSizeX, smplSizeZ, intrad, rect.z1 - smplRect.z1, rect.z2 - smplRect.z1, &colsMaxima[x], smplSizeX, queue);
+	});
+	// horizontal pass
+	for_mt(0, rectSizeZ, [&](const int z) {
+		std::vector<int> queue;
+		SlidingWindowMaxima(&colsMaxima[z * smplSizeX], 1, smplSizeX, intrad, rect.x1 - smplRect.x1, rect.x2 - smplRect.x1, &rowsMaxima[z * rectSizeX], 1, queue);
+	});
+
+	// same layout as produced by FindRadialMaximum, including the row
+	// overlap: vertex <maxx, z> shares its index with vertex <0, z + 1>
+	for (int z = rect.z1; z <= rect.z2; z++) {
+		const int x2 = (z == maxy)? rect.x2: std::min(rect.x2, maxx - 1);
+
+		for (int x = rect.x1; x <= x2; x++) {
+			maxMesh[x + z * maxx] = rowsMaxima[(z - rect.z1) * rectSizeX + (x - rect.x1)];
+		}
+	}
+}
+
+void SmoothHeightMesh::UpdateBlurRect(const SRectangle& rect, int smoothrad, int numBlurs)
+{
+	// the blur passes address the mesh with rows of <maxx + 1> vertices
+	// instead of <maxx>, so find the changed maxima in their coordinates
+	const int lineSize = maxx + 1;
+
+	SRectangle blurRect = {maxx, maxy, 0, 0};
+
+	for (int z = rect.z1; z <= rect.z2; z++) {
+		const int x2 = (z == maxy)? rect.x2: std::min(rect.x2, maxx - 1);
+
+		if (x2 < rect.x1)
+			continue;
+
+		const int idx1 = rect.x1 + z * maxx;
+		const int idx2 = x2 + z * maxx;
+
+		if ((idx1 / lineSize) != (idx2 / lineSize)) {
+			blurRect.x1 = 0;
+			blurRect.x2 = maxx;
+		} else {
+			blurRect.x1 = std::min(blurRect.x1, idx1 % lineSize);
+			blurRect.x2 = std::max(blurRect.x2, idx2 % lineSize);
+		}
+
+		blurRect.z1 = std::min(blurRect.z1, idx1 / lineSize);
+		blurRect.z2 = std::max(blurRect.z2, idx2 / lineSize);
+	}
+
+	if (blurRect.x1 > blurRect.x2 || blurRect.z1 > blurRect.z2)
+		return;
+
+	const int blurReach = smoothrad * numBlurs;
+
+	// vertices affected by the changed maxima after all passes
+	const SRectangle dstRect = {
+		std::max(blurRect.x1 - blurReach,    0),
+		std::max(blurRect.z1 - blurReach,    0),
+		std::min(blurRect.x2 + blurReach, maxx),
+		std::min(blurRect.z2 + blurReach, maxy),
+	};
+	// maxima needed to compute them; each pass invalidates <smoothrad>
+	// vertices along the inner edges of this rectangle in its direction
+	const SRectangle srcRect = {
+		std::max(dstRect.x1 - blurReach,    0),
+		std::max(dstRect.z1 - blurReach,    0),
+		std::min(dstRect.x2 + blurReach, maxx),
+		std::min(dstRect.z2 + blurReach, maxy),
+	};
+
+	const int srcSizeX = srcRect.x2 - srcRect.x1 + 1;
+	const int srcSizeZ = srcRect.z2 - srcRect.z1 + 1;
+
+	const float recipn = 1.0f / (2.0f * smoothrad + 1.0f);
+	const float maxHeight = readMap->GetCurrMaxHeight();
+
+	std::vector<float> blurred(srcSizeX * srcSizeZ);
+	std::vector<float> smoothed(srcSizeX * srcSizeZ);
+	std::vector<float> heights(srcSizeX * srcSizeZ);
+
+	for_mt(0, srcSizeZ, [&](const int z) {
+		for (int x = 0; x < srcSizeX; x++) {
+			const int idx = z * srcSizeX + x;
+
+			blurred[idx] = maxMesh[(srcRect.x1 + x) + (srcRect.z1 + z) * lineSize];
+			heights[idx] = CGround::GetHeightAboveWater((srcRect.x1 + x) * resolution, (srcRect.z1 + z) * resolution);
+		}
+	});
+
+	// same kernel as Blur{Horizontal,Vertical}, but with explicit sums
+	const auto BlurVertex = [&](int pos, int maxPos, int srcPos, int stride, int idx) {
+		const int pos1 = std::max(pos - smoothrad, 0);
+		const int pos2 = std::min(pos + smoothrad, maxPos);
+
+		float sum = 0.0f;
+
+		for (int p = std::max(pos1, srcPos); p <= std::min(pos2, srcPos + ((stride == 1)? srcSizeX: srcSizeZ) - 1); p++) {
+			sum += blurred[idx + (p - pos) * stride];
+		}
+
+		const float sh = (pos <= smoothrad || pos > (maxPos - smoothrad))? (sum / (pos2 - pos1 + 1)): (recipn * sum);
+
+		smoothed[idx] = std::min(maxHeight, std::max(heights[idx], sh));
+	};
+
+	for (int numBlur = numBlurs; numBlur > 0; --numBlur) {
+		for_mt(0, srcSizeZ, [&](const int z) {
+			for (int x = 0; x < srcSizeX; x++) {
+				BlurVertex(srcRect.x1 + x, maxx, srcRect.x1, 1, z * srcSizeX + x);
+			}
+		});
+		blurred.swap(smoothed);
+
+		for_mt(0, srcSizeX, [&](const int x) {
+			for (int z = 0; z < srcSizeZ; z++) {
+				BlurVertex(srcRect.z1 + z, maxy, srcRect.z1, srcSizeX, z * srcSizeX + x);
+			}
+		});
+		blurred.swap(smoothed);
+	}
+
+	for (int z = dstRect.z1; z <= dstRect.z2; z++) {
+		for (int x = dstRect.x1; x <= dstRect.x2; x++) {
+			const int idx = x + z * lineSize;
+
+			mesh[idx] = blurred[(z - srcRect.z1) * srcSizeX + (x - srcRect.x1)];
+			origMesh[idx] = mesh[idx];
+		}
+	}
 }
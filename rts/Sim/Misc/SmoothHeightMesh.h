@@ -6,6 +6,7 @@
 #include <vector>
 
 class CGround;
+struct SRectangle;
 
 /**
  * Provides a GetHeight(x, y) of its own that smooths the mesh.
@@ -22,6 +23,13 @@ public:
 	float AddHeight(int index, float h);
 	float SetMaxHeight(int index, float h);
 
+	/**
+	 * Recomputes the part of the mesh that depends on the heightmap-squares
+	 * within <rect> (inclusive), i.e. only the maximum-filter windows and the
+	 * blur kernels touching them. Overwrites any Lua changes in that area.
+	 */
+	void UpdateSmoothMesh(const SRectangle& rect);
+
 	int GetMaxX() const { return maxx; }
 	int GetMaxY() const { return maxy; }
 	float GetFMaxX() const { return fmaxx; }
@@ -34,6 +42,9 @@ public:
 private:
 	void MakeSmoothMesh();
 
+	void UpdateMaximaRect(const SRectangle& rect, int intrad);
+	void UpdateBlurRect(const SRectangle& rect, int smoothrad, int numBlurs);
+
 	const int maxx, maxy;
 	const float fmaxx, fmaxy;
 	const float resolution;
@@ -41,6 +52,8 @@ private:
 
 	std::vector<float> mesh;
 	std::vector<float> origMesh;
+	/// mesh before blurring, kept for UpdateSmoothMesh
+	std::vector<float> maxMesh;
 };
 
 extern SmoothHeightMesh* smoothGround;
@@ -303,13 +303,15 @@ void CTeam::SlowUpdate()
 	TeamStatistics& currentStats = GetCurrentStats();
 	float eShare = 0.0f, mShare = 0.0f;
 
+	const int allyTeamNum = teamHandler->AllyTeam(teamNum);
+
 	// calculate the total amount of resources that all
 	// (allied) teams can collectively receive through
 	// sharing
 	for (int a = 0; a < teamHandler->ActiveTeams(); ++a) {
 		CTeam* team = teamHandler->Team(a);
 
-		if ((a != teamNum) && (teamHandler->AllyTeam(teamNum) == teamHandler->AllyTeam(a))) {
+		if ((a != teamNum) && (allyTeamNum == teamHandler->AllyTeam(a))) {
 			if (team->isDead)
 				continue;
 
@@ -336,8 +338,9 @@ void CTeam::SlowUpdate()
 	if (mShare > 0.0f) { dm = std::min(1.0f, mExcess / mShare); }
 
 	// now evenly distribute our excess resources among allied teams
-	for (int a = 0; a < teamHandler->ActiveTeams(); ++a) {
-		if ((a != teamNum) && (teamHandler->AllyTeam(teamNum) == teamHandler->AllyTeam(a))) {
+	// (nothing to hand out without any allies, e.g. in FFA games)
+	for (int a = 0; a < teamHandler->ActiveTeams() && (eShare > 0.0f || mShare > 0.0f); ++a) {
+		if ((a != teamNum) && (allyTeamNum == teamHandler->AllyTeam(a))) {
 			CTeam* team = teamHandler->Team(a);
 			if (team->isDead)
 				continue;
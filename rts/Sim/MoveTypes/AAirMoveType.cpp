@@ -34,7 +34,11 @@ CR_REG_METADATA(AAirMoveType, (
 
 	CR_MEMBER(lastColWarning),
 
-	CR_MEMBER(lastColWarningType)
+	CR_MEMBER(lastColWarningType),
+
+	CR_IGNORED(nextColWarning),
+	CR_IGNORED(nextColWarningType),
+	CR_IGNORED(colWarningFrame)
 ))
 
 AAirMoveType::AAirMoveType(CUnit* unit):
@@ -57,7 +61,11 @@ AAirMoveType::AAirMoveType(CUnit* unit):
 
 	lastColWarning(nullptr),
 
-	lastColWarningType(0)
+	lastColWarningType(0),
+
+	nextColWarning(nullptr),
+	nextColWarningType(0),
+	colWarningFrame(-1)
 {
 	// creg
 	if (unit == nullptr)
@@ -205,11 +213,49 @@ void AAirMoveType::SetDefaultAltitude(float altitude)
 }
 
 
+void AAirMoveType::UpdateCompute()
+{
+	// the neighbour scan is the expensive part of CheckForCollision and
+	// only reads other units, so it can be done ahead on all threads for
+	// aircraft which will check this frame (see CUnitHandler::Update)
+	if (!collide || owner->GetTransporter() != nullptr)
+		return;
+	if (aircraftState == AIRCRAFT_LANDED)
+		return;
+	if (((gs->frameNum + owner->id) & 3) != 0)
+		return;
+
+	nextColWarningType = FindCollisionWarning(nextColWarning);
+	colWarningFrame = gs->frameNum;
+}
+
+
 void AAirMoveType::CheckForCollision()
 {
 	if (!collide)
 		return;
 
+	if (lastColWarning) {
+		DeleteDeathDependence(lastColWarning, DEPENDENCE_LASTCOLWARN);
+		lastColWarning = NULL;
+		lastColWarningType = 0;
+	}
+
+	if (colWarningFrame == gs->frameNum) {
+		lastColWarning = nextColWarning;
+		lastColWarningType = nextColWarningType;
+		colWarningFrame = -1;
+	} else {
+		lastColWarningType = FindCollisionWarning(lastColWarning);
+	}
+
+	if (lastColWarning != NULL)
+		AddDeathDependence(lastColWarning, DEPENDENCE_LASTCOLWARN);
+}
+
+
+int AAirMoveType::FindCollisionWarning(CUnit*& colWarning) const
+{
 	const SyncedFloat3& pos = owner->midPos;
 	const SyncedFloat3& forward = owner->frontdir;
 
@@ -219,11 +265,7 @@ void AAirMoveType::CheckForCollision()
 
 	float dist = 200.0f;
 
-	if (lastColWarning) {
-		DeleteDeathDependence(lastColWarning, DEPENDENCE_LASTCOLWARN);
-		lastColWarning = NULL;
-		lastColWarningType = 0;
-	}
+	colWarning = nullptr;
 
 	for (CUnit* unit: *qfQuery.units) {
 		if (unit == owner || !unit->unitDef->canfly) {
@@ -245,26 +287,20 @@ void AAirMoveType::CheckForCollision()
 
 		if (ortoDif.SqLength() < (minOrtoDif * minOrtoDif)) {
 			dist = frontLength;
-			lastColWarning = const_cast<CUnit*>(unit);
+			colWarning = const_cast<CUnit*>(unit);
 		}
 	}
 
-	if (lastColWarning != NULL) {
-		lastColWarningType = 2;
-		AddDeathDependence(lastColWarning, DEPENDENCE_LASTCOLWARN);
-		return;
-	}
+	if (colWarning != nullptr)
+		return 2;
 
 	for (CUnit* u: *qfQuery.units) {
 		if (u == owner)
 			continue;
 		if ((u->midPos - pos).SqLength() < (dist * dist)) {
-			lastColWarning = u;
+			colWarning = u;
 		}
 	}
 
-	if (lastColWarning != NULL) {
-		lastColWarningType = 1;
-		AddDeathDependence(lastColWarning, DEPENDENCE_LASTCOLWARN);
-	}
+	return ((colWarning != nullptr)? 1: 0);
 }
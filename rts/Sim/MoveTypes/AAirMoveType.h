@@ -29,6 +29,7 @@ public:
 	virtual ~AAirMoveType();
 
 	virtual bool Update();
+	void UpdateCompute() override;
 	virtual void UpdateLanded();
 	virtual void Takeoff() {}
 	virtual void Land() {}
@@ -72,12 +73,18 @@ public:
 
 protected:
 	void CheckForCollision();
+	int FindCollisionWarning(CUnit*& colWarning) const;
 
 	/// unit found to be dangerously close to our path
 	CUnit* lastColWarning;
 
 	/// 1=generally forward of us, 2=directly in path
 	int lastColWarningType;
+
+	/// result of FindCollisionWarning precomputed by UpdateCompute, valid during colWarningFrame
+	CUnit* nextColWarning;
+	int nextColWarningType;
+	int colWarningFrame;
 };
 
 #endif // A_AIR_MOVE_TYPE_H_
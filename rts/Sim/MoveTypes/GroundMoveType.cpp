@@ -89,6 +89,7 @@ CR_REG_METADATA(CGroundMoveType, (
 	CR_MEMBER(waypointDir),
 	CR_MEMBER(flatFrontDir),
 	CR_MEMBER(lastAvoidanceDir),
+	CR_MEMBER(avoidanceVec),
 	CR_MEMBER(mainHeadingPos),
 	CR_MEMBER(skidRotVector),
 
@@ -124,6 +125,7 @@ CR_REG_METADATA(CGroundMoveType, (
 	CR_MEMBER(pathID),
 
 	CR_MEMBER(nextObstacleAvoidanceFrame),
+	CR_MEMBER(avoidanceVecFrame),
 
 	CR_MEMBER(reversing),
 	CR_MEMBER(idling),
@@ -173,6 +175,7 @@ CGroundMoveType::CGroundMoveType(CUnit* owner):
 
 	flatFrontDir(FwdVector),
 	lastAvoidanceDir(ZeroVector),
+	avoidanceVec(ZeroVector),
 	mainHeadingPos(ZeroVector),
 	skidRotVector(UpVector),
 
@@ -214,6 +217,7 @@ CGroundMoveType::CGroundMoveType(CUnit* owner):
 	pathID(0),
 
 	nextObstacleAvoidanceFrame(0),
+	avoidanceVecFrame(-1u),
 
 	numIdlingUpdates(0),
 	numIdlingSlowUpdates(0),
@@ -349,6 +353,24 @@ bool CGroundMoveType::Update()
 	return (OwnerMoved(heading, owner->pos - oldPos, float3(float3::cmp_eps(), float3::cmp_eps() * 1e-2f, float3::cmp_eps())));
 }
 
+void CGroundMoveType::UpdateCompute()
+{
+	// mirror the early-outs taken by Update and FollowPath; the
+	// precomputed vector is only consumed (and valid) if commit
+	// reaches GetObstacleAvoidanceDir during this same frame
+	if (owner->GetTransporter() != nullptr)
+		return;
+	if (owner->IsSkidding() || owner->IsFalling())
+		return;
+	if (owner->IsStunned() || owner->beingBuilt || owner->UnderFirstPersonControl())
+		return;
+	if (WantToStop() || gs->frameNum < nextObstacleAvoidanceFrame)
+		return;
+
+	avoidanceVec = GetObstacleAvoidanceVec(false);
+	avoidanceVecFrame = gs->frameNum;
+}
+
 void CGroundMoveType::UpdateOwnerSpeedAndHeading()
 {
 	if (owner->IsStunned() || owner->beingBuilt) {
@@ -1094,28 +1116,67 @@ float3 CGroundMoveType::GetObstacleAvoidanceDir(const float3& desiredDir) {
 	if (gs->frameNum < nextObstacleAvoidanceFrame)
 		return lastAvoidanceDir;
 
-	float3 avoidanceVec = ZeroVector;
 	float3 avoidanceDir = desiredDir;
 
 	lastAvoidanceDir = desiredDir;
 	nextObstacleAvoidanceFrame = gs->frameNum + 1;
 
-	CUnit* avoider = owner;
-	// const UnitDef* avoiderUD = avoider->unitDef;
-	const MoveDef* avoiderMD = avoider->moveDef;
-
 	// degenerate case: if facing anti-parallel to desired direction,
 	// do not actively avoid obstacles since that can interfere with
 	// normal waypoint steering (if the final avoidanceDir demands a
 	// turn in the opposite direction of desiredDir)
-	if (avoider->frontdir.dot(desiredDir) < 0.0f)
+	if (owner->frontdir.dot(desiredDir) < 0.0f)
 		return lastAvoidanceDir;
 
-	static const float AVOIDER_DIR_WEIGHT = 1.0f;
 	static const float DESIRED_DIR_WEIGHT = 0.5f;
-	static const float MAX_AVOIDEE_COSINE = math::cosf(120.0f * math::DEG_TO_RAD);
 	static const float LAST_DIR_MIX_ALPHA = 0.7f;
 
+	// in two-phase mode the (expensive) gathering step has already
+	// been done by UpdateCompute, based on start-of-frame positions
+	if (avoidanceVecFrame != gs->frameNum)
+		avoidanceVec = GetObstacleAvoidanceVec(DEBUG_DRAWING_ENABLED);
+
+	avoidanceVecFrame = -1u;
+
+	// use a weighted combination of the desired- and the avoidance-directions
+	// also linearly smooth it using the vector calculated the previous frame
+	avoidanceDir = (mix(desiredDir, avoidanceVec, DESIRED_DIR_WEIGHT)).SafeNormalize();
+	avoidanceDir = (mix(avoidanceDir, lastAvoidanceDir, LAST_DIR_MIX_ALPHA)).SafeNormalize();
+
+	if (DEBUG_DRAWING_ENABLED) {
+		if (selectedUnitsHandler.selectedUnits.find(owner->id) != selectedUnitsHandler.selectedUnits.end()) {
+			const float3 p0 = owner->pos + (    UpVector * 20.0f);
+			const float3 p1 =         p0 + (avoidanceVec * 40.0f);
+			const float3 p2 =         p0 + (avoidanceDir * 40.0f);
+
+			const int avFigGroupID = geometricObjects->AddLine(p0, p1, 8.0f, 1, 4);
+			const int adFigGroupID = geometricObjects->AddLine(p0, p2, 8.0f, 1, 4);
+
+			geometricObjects->SetColor(avFigGroupID, 1, 0.3f, 0.3f, 0.6f);
+			geometricObjects->SetColor(adFigGroupID, 1, 0.3f, 0.3f, 0.6f);
+		}
+	}
+
+	return (lastAvoidanceDir = avoidanceDir);
+}
+
+
+/*
+ * Gathers the (unnormalized) avoidance response to all nearby
+ * obstacles; reads only shared state, so it can be called from
+ * worker threads as part of the two-phase MoveType update
+ */
+float3 CGroundMoveType::GetObstacleAvoidanceVec(bool debugDraw) const {
+	float3 avoidanceVec = ZeroVector;
+	float3 avoidanceDir = ZeroVector;
+
+	const CUnit* avoider = owner;
+	// const UnitDef* avoiderUD = avoider->unitDef;
+	const MoveDef* avoiderMD = avoider->moveDef;
+
+	static const float AVOIDER_DIR_WEIGHT = 1.0f;
+	static const float MAX_AVOIDEE_COSINE = math::cosf(120.0f * math::DEG_TO_RAD);
+
 	// now we do the obstacle avoidance proper
 	// avoider always uses its never-rotated MoveDef footprint
 	// note: should increase radius for smaller turnAccel values
@@ -1184,7 +1245,7 @@ float3 CGroundMoveType::GetObstacleAvoidanceDir(const float3& desiredDir) {
 		// if object and unit in relative motion are closing in on one another
 		// (or not yet fully apart), then the object is on the path of the unit
 		// and they are not collided
-		if (DEBUG_DRAWING_ENABLED) {
+		if (debugDraw) {
 			if (selectedUnitsHandler.selectedUnits.find(owner->id) != selectedUnitsHandler.selectedUnits.end()) {
 				geometricObjects->AddLine(avoider->pos + (UpVector * 20.0f), avoidee->pos + (UpVector * 20.0f), 3, 1, 4);
 			}
@@ -1215,31 +1276,10 @@ float3 CGroundMoveType::GetObstacleAvoidanceDir(const float3& desiredDir) {
 		avoidanceVec += (avoidanceDir * avoidanceResponse * avoidanceFallOff * avoideeMassScale);
 	}
 
-
-	// use a weighted combination of the desired- and the avoidance-directions
-	// also linearly smooth it using the vector calculated the previous frame
-	avoidanceDir = (mix(desiredDir, avoidanceVec, DESIRED_DIR_WEIGHT)).SafeNormalize();
-	avoidanceDir = (mix(avoidanceDir, lastAvoidanceDir, LAST_DIR_MIX_ALPHA)).SafeNormalize();
-
-	if (DEBUG_DRAWING_ENABLED) {
-		if (selectedUnitsHandler.selectedUnits.find(owner->id) != selectedUnitsHandler.selectedUnits.end()) {
-			const float3 p0 = owner->pos + (    UpVector * 20.0f);
-			const float3 p1 =         p0 + (avoidanceVec * 40.0f);
-			const float3 p2 =         p0 + (avoidanceDir * 40.0f);
-
-			const int avFigGroupID = geometricObjects->AddLine(p0, p1, 8.0f, 1, 4);
-			const int adFigGroupID = geometricObjects->AddLine(p0, p2, 8.0f, 1, 4);
-
-			geometricObjects->SetColor(avFigGroupID, 1, 0.3f, 0.3f, 0.6f);
-			geometricObjects->SetColor(adFigGroupID, 1, 0.3f, 0.3f, 0.6f);
-		}
-	}
-
-	return (lastAvoidanceDir = avoidanceDir);
+	return avoidanceVec;
 }
 
 
-
 #if 0
 // Calculates an aproximation of the physical 2D-distance between given two objects.
 // Old, no longer used since all separation tests are based on FOOTPRINT_RADIUS now.
@@ -1801,15 +1841,32 @@ void CGroundMoveType::HandleUnitCollisions(
 ) {
 	const float searchRadius = colliderSpeed + (colliderRadius * 2.0f);
 
+	CUnitCollisionBroadphase& broadphase = unitHandler->GetCollisionBroadphase();
+
+	const CUnitCollisionBroadphase::Contact* contactsBeg = nullptr;
+	const CUnitCollisionBroadphase::Contact* contactsEnd = nullptr;
+
 	// copy on purpose, since the below can call Lua
 	QuadFieldQuery qfQuery;
-	quadField->GetUnitsExact(qfQuery, collider->pos, searchRadius);
+
+	const bool haveContacts = broadphase.GetContacts(collider, contactsBeg, contactsEnd);
+
+	if (!haveContacts)
+		quadField->GetUnitsExact(qfQuery, collider->pos, searchRadius);
 
 	// NOTE: probably too large for most units (eg. causes tree falling animations to be skipped)
 	const int dirSign = Sign(int(!reversing));
 	const float3 crushImpulse = collider->speed * collider->mass * dirSign;
 
-	for (CUnit* collidee: *qfQuery.units) {
+	const size_t numCollidees = haveContacts? (contactsEnd - contactsBeg): qfQuery.units->size();
+
+	for (size_t n = 0; n < numCollidees; n++) {
+		CUnit* collidee = haveContacts? contactsBeg[n].unit: (*qfQuery.units)[n];
+
+		// broadphase contacts are a superset of what the query would return
+		if (haveContacts && collider->pos.SqDistance(collidee->pos) >= Square(searchRadius + collidee->radius))
+			continue;
+
 		if (collidee == collider) continue;
 		if (collidee->IsSkidding()) continue;
 		if (collidee->IsFlying()) continue;
@@ -1954,6 +2011,14 @@ void CGroundMoveType::HandleUnitCollisions(
 			continue;
 		}
 
+		// the first party of a broadphase pair to get here pushes both apart
+		if (haveContacts) {
+			if (broadphase.IsPairResolved(contactsBeg[n].pairIdx))
+				continue;
+
+			broadphase.SetPairResolved(contactsBeg[n].pairIdx);
+		}
+
 		const float colliderRelRadius = colliderRadius / (colliderRadius + collideeRadius);
 		const float collideeRelRadius = collideeRadius / (colliderRadius + collideeRadius);
 		const float collisionRadiusSum = modInfo.allowUnitCollisionOverlap?
@@ -32,6 +32,8 @@ public:
 	bool Update() override;
 	void SlowUpdate() override;
 
+	void UpdateCompute() override;
+
 	void StartMovingRaw(const float3 moveGoalPos, float moveGoalRadius) override;
 	void StartMoving(float3 pos, float goalRadius) override;
 	void StartMoving(float3 pos, float goalRadius, float speed) override { StartMoving(pos, goalRadius); }
@@ -79,6 +81,7 @@ public:
 
 private:
 	float3 GetObstacleAvoidanceDir(const float3& desiredDir);
+	float3 GetObstacleAvoidanceVec(bool debugDraw) const;
 	float3 GetNewSpeedVector(const float hAcc, const float vAcc) const;
 
 	#define SQUARE(x) ((x) * (x))
@@ -157,6 +160,7 @@ private:
 	float3 waypointDir;
 	float3 flatFrontDir;
 	float3 lastAvoidanceDir;
+	float3 avoidanceVec;                /// obstacle-avoidance vector precomputed by UpdateCompute
 	float3 mainHeadingPos;
 	float3 skidRotVector;               /// vector orthogonal to skidDir
 
@@ -197,6 +201,7 @@ private:
 
 	unsigned int pathID;
 	unsigned int nextObstacleAvoidanceFrame;
+	unsigned int avoidanceVecFrame;     /// frame in which avoidanceVec was last precomputed
 
 	unsigned int numIdlingUpdates;      /// {in, de}creased every Update if idling is true/false and pathId != 0
 	unsigned int numIdlingSlowUpdates;  /// {in, de}creased every SlowUpdate if idling is true/false and pathId != 0
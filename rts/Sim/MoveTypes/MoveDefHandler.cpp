@@ -9,9 +9,13 @@
 #include "System/creg/STL_Map.h"
 #include "System/Exceptions.h"
 #include "System/CRC.h"
+#include "System/Log/ILog.h"
 #include "System/myMath.h"
 #include "System/StringUtil.h"
 
+#include <algorithm>
+#include <cstring>
+
 CR_BIND(MoveDef, ())
 CR_BIND(MoveDefHandler, (nullptr))
 
@@ -33,6 +37,7 @@ CR_REG_METADATA(MoveDef, (
 	CR_MEMBER(speedModMults),
 
 	CR_MEMBER(pathType),
+	CR_MEMBER(pathLayer),
 
 	CR_MEMBER(followGround),
 	CR_MEMBER(subMarine),
@@ -51,6 +56,7 @@ CR_REG_METADATA(MoveDef, (
 CR_REG_METADATA(MoveDefHandler, (
 	CR_MEMBER(moveDefs),
 	CR_MEMBER(moveDefNames),
+	CR_MEMBER(pathLayerOwners),
 	CR_MEMBER(checksum)
 ))
 
@@ -93,6 +99,22 @@ static MoveDef::SpeedModClass ParseSpeedModClass(const std::string& moveDefName,
 	return MoveDef::KBot;
 }
 
+static bool HaveEqualPathRules(const MoveDef& a, const MoveDef& b)
+{
+	// everything in the packed block except the identifiers feeds into
+	// speed-mods, blocking tests or PF costs, so compare it all bytewise
+	const auto cmpBytes = [&](const void* aMin, const void* aMax) {
+		const unsigned char* aBytes = reinterpret_cast<const unsigned char*>(aMin);
+		const unsigned char* bBytes = reinterpret_cast<const unsigned char*>(&b) + (aBytes - reinterpret_cast<const unsigned char*>(&a));
+		return (std::memcmp(aBytes, bBytes, reinterpret_cast<const unsigned char*>(aMax) - aBytes) == 0);
+	};
+
+	if (!cmpBytes(&a.speedModClass, &a.pathType))
+		return false;
+
+	return (cmpBytes(&a.heatMod, &a.flowMapping + 1));
+}
+
 
 
 MoveDefHandler::MoveDefHandler(LuaParser* defsParser)
@@ -119,12 +141,27 @@ MoveDefHandler::MoveDefHandler(LuaParser* defsParser)
 			break;
 
 		moveDefs.emplace_back(moveDefTable, num);
-		const MoveDef& md = moveDefs.back();
+		MoveDef& md = moveDefs.back();
 		moveDefNames[md.name] = md.pathType;
 
+		// give each MoveDef the layer of the first one with the same rules,
+		// estimators and QTPFS keep their per-MoveDef data per layer only
+		const auto pred = [&](unsigned int owner) { return (HaveEqualPathRules(moveDefs[owner], md)); };
+		const auto iter = std::find_if(pathLayerOwners.begin(), pathLayerOwners.end(), pred);
+
+		if (iter == pathLayerOwners.end()) {
+			md.pathLayer = pathLayerOwners.size();
+			pathLayerOwners.push_back(md.pathType);
+		} else {
+			md.pathLayer = iter - pathLayerOwners.begin();
+		}
+
 		crc << md.GetCheckSum();
 	}
 
+	if (pathLayerOwners.size() < moveDefs.size())
+		LOG("[%s] %u MoveDefs share %u path layers (%u duplicates)", __func__, GetNumMoveDefs(), GetNumPathLayers(), GetNumMoveDefs() - GetNumPathLayers());
+
 	CMoveMath::noHoverWaterMove = (mapInfo->water.damage >= MAX_ALLOWED_WATER_DAMAGE_HMM);
 	CMoveMath::waterDamageCost = (mapInfo->water.damage >= MAX_ALLOWED_WATER_DAMAGE_GMM)?
 		0.0f: (1.0f / (1.0f + mapInfo->water.damage * 0.1f));
@@ -166,6 +203,7 @@ MoveDef::MoveDef()
 	, crushStrength(0.0f)
 
 	, pathType(0)
+	, pathLayer(0)
 
 	, heatMod(0.05f)
 	, flowMod(1.0f)
@@ -200,6 +238,7 @@ MoveDef::MoveDef(const LuaTable& moveDefTable, int moveDefID) {
 
 	name          = StringToLower(moveDefTable.GetString("name", ""));
 	pathType      = moveDefID - 1;
+	pathLayer     = pathType;
 	crushStrength = moveDefTable.GetFloat("crushStrength", 10.0f);
 
 	const LuaTable& depthModTable = moveDefTable.SubTable("depthModParams");
@@ -108,6 +108,9 @@ struct MoveDef {
 	float speedModMults[SPEEDMOD_MOBILE_NUM_MULTS + 1];
 
 	unsigned int pathType;
+	/// index of the estimator / QTPFS layer shared by all MoveDefs with
+	/// the same path rules, equal to pathType of the first such MoveDef
+	unsigned int pathLayer;
 
 	/// heatmap path-cost modifier
 	float heatMod;
@@ -147,13 +150,18 @@ public:
 
 	MoveDef* GetMoveDefByPathType(unsigned int pathType) { return &moveDefs[pathType]; }
 	MoveDef* GetMoveDefByName(const std::string& name);
+	/// returns the MoveDef that owns a path layer, see MoveDef::pathLayer
+	MoveDef* GetMoveDefByPathLayer(unsigned int pathLayer) { return &moveDefs[pathLayerOwners[pathLayer]]; }
 
 	unsigned int GetNumMoveDefs() const { return moveDefs.size(); }
+	unsigned int GetNumPathLayers() const { return pathLayerOwners.size(); }
 	unsigned int GetCheckSum() const { return checksum; }
 
 private:
 	std::vector<MoveDef> moveDefs;
 	spring::unordered_map<std::string, int> moveDefNames;
+	/// pathType of the first MoveDef in each path layer
+	std::vector<unsigned int> pathLayerOwners;
 
 	unsigned int checksum;
 };
@@ -7,11 +7,16 @@
 #include "Sim/Features/Feature.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/GroundBlockingObjectMap.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/Objects/SolidObject.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/CommandAI/CommandAI.h"
 #include "System/Platform/Threading.h"
+#include "System/myMath.h"
+
+#include <algorithm>
+#include <vector>
 
 bool CMoveMath::noHoverWaterMove = false;
 float CMoveMath::waterDamageCost = 0.0f;
@@ -19,6 +24,13 @@ float CMoveMath::waterDamageCost = 0.0f;
 static constexpr int FOOTPRINT_XSTEP = 2;
 static constexpr int FOOTPRINT_ZSTEP = 2;
 
+// speed-mod tables, indexed by typemap-square
+static std::vector< std::vector<float> > speedModMaps;
+// index of the table shared by each MoveDef, indexed by pathType
+static std::vector<unsigned int> speedModMapIndices;
+// pathType of the first MoveDef sharing each table
+static std::vector<unsigned int> speedModMapOwners;
+
 
 float CMoveMath::yLevel(const MoveDef& moveDef, int xSqr, int zSqr)
 {
@@ -46,6 +58,102 @@ float CMoveMath::yLevel(const MoveDef& moveDef, const float3& pos)
 
 
 
+static bool EqualSpeedModParams(const MoveDef& a, const MoveDef& b)
+{
+	if (a.speedModClass != b.speedModClass)
+		return false;
+	if (a.depth != b.depth || a.maxSlope != b.maxSlope || a.slopeMod != b.slopeMod)
+		return false;
+
+	return (std::equal(std::begin(a.depthModParams), std::end(a.depthModParams), std::begin(b.depthModParams)));
+}
+
+void CMoveMath::InitSpeedModMaps()
+{
+	FreeSpeedModMaps();
+
+	speedModMapIndices.resize(moveDefHandler->GetNumMoveDefs());
+
+	for (unsigned int i = 0; i < moveDefHandler->GetNumMoveDefs(); i++) {
+		const MoveDef* md = moveDefHandler->GetMoveDefByPathType(i);
+
+		unsigned int j = 0;
+
+		for (j = 0; j < i; j++) {
+			if (EqualSpeedModParams(*md, *moveDefHandler->GetMoveDefByPathType(j)))
+				break;
+		}
+
+		if (j < i) {
+			speedModMapIndices[i] = speedModMapIndices[j];
+			continue;
+		}
+
+		speedModMapIndices[i] = speedModMaps.size();
+		speedModMapOwners.push_back(i);
+		speedModMaps.emplace_back(mapDims.hmapx * mapDims.hmapy, 0.0f);
+	}
+
+	UpdateSpeedModMaps(0, 0, mapDims.mapxm1, mapDims.mapym1);
+}
+
+void CMoveMath::FreeSpeedModMaps()
+{
+	speedModMaps.clear();
+	speedModMapIndices.clear();
+	speedModMapOwners.clear();
+}
+
+void CMoveMath::UpdateSpeedModMaps(int x1, int z1, int x2, int z2)
+{
+	if (speedModMaps.empty())
+		return;
+
+	// convert to typemap-squares
+	const int tx1 = std::max(                0, x1 >> 1);
+	const int tz1 = std::max(                0, z1 >> 1);
+	const int tx2 = std::min(mapDims.hmapx - 1, x2 >> 1);
+	const int tz2 = std::min(mapDims.hmapy - 1, z2 >> 1);
+
+	for (unsigned int i = 0; i < speedModMaps.size(); i++) {
+		const MoveDef* md = moveDefHandler->GetMoveDefByPathType(speedModMapOwners[i]);
+
+		std::vector<float>& speedMods = speedModMaps[i];
+
+		for (int tz = tz1; tz <= tz2; tz++) {
+			for (int tx = tx1; tx <= tx2; tx++) {
+				speedMods[tz * mapDims.hmapx + tx] = CalcPosSpeedMod(*md, tz * mapDims.hmapx + tx);
+			}
+		}
+	}
+}
+
+void CMoveMath::GetRowSpeedMods(const MoveDef& moveDef, int xmin, int xmax, int zSquare, float* speedMods)
+{
+	if (zSquare < 0 || zSquare >= mapDims.mapy || moveDef.pathType >= speedModMapIndices.size()) {
+		for (int x = xmin; x < xmax; x++) {
+			speedMods[x - xmin] = GetPosSpeedMod(moveDef, x, zSquare);
+		}
+
+		return;
+	}
+
+	const float* rowSpeedMods = &speedModMaps[speedModMapIndices[moveDef.pathType]][(zSquare >> 1) * mapDims.hmapx];
+
+	const int cxmin = Clamp(xmin, 0, mapDims.mapx);
+	const int cxmax = Clamp(xmax, 0, mapDims.mapx);
+
+	std::fill(speedMods, speedMods + (cxmin - xmin), 0.0f);
+
+	// each typemap-square covers two squares of a row
+	for (int x = cxmin; x < cxmax; x++) {
+		speedMods[x - xmin] = rowSpeedMods[x >> 1];
+	}
+
+	std::fill(speedMods + (cxmax - xmin), speedMods + (xmax - xmin), 0.0f);
+}
+
+
 /* calculate the local speed-modifier for this MoveDef */
 float CMoveMath::GetPosSpeedMod(const MoveDef& moveDef, unsigned xSquare, unsigned zSquare)
 {
@@ -53,6 +161,15 @@ float CMoveMath::GetPosSpeedMod(const MoveDef& moveDef, unsigned xSquare, unsign
 		return 0.0f;
 
 	const int square = (xSquare >> 1) + ((zSquare >> 1) * mapDims.hmapx);
+
+	if (moveDef.pathType < speedModMapIndices.size())
+		return speedModMaps[speedModMapIndices[moveDef.pathType]][square];
+
+	return (CalcPosSpeedMod(moveDef, square));
+}
+
+float CMoveMath::CalcPosSpeedMod(const MoveDef& moveDef, int square)
+{
 	const int squareTerrType = readMap->GetTypeMapSynced()[square];
 
 	const float height  = readMap->GetMIPHeightMapSynced(1)[square];
@@ -76,6 +193,10 @@ float CMoveMath::GetPosSpeedMod(const MoveDef& moveDef, unsigned xSquare, unsign
 	if (xSquare >= mapDims.mapx || zSquare >= mapDims.mapy)
 		return 0.0f;
 
+	// {Ground,Hover}SpeedMod ignore the direction in this case, ShipSpeedMod never does
+	if (!modInfo.allowDirectionalPathing && moveDef.speedModClass != MoveDef::Ship)
+		return (GetPosSpeedMod(moveDef, xSquare, zSquare));
+
 	const int square = (xSquare >> 1) + ((zSquare >> 1) * mapDims.hmapx);
 	const int squareTerrType = readMap->GetTypeMapSynced()[square];
 
@@ -117,13 +238,17 @@ CMoveMath::BlockType CMoveMath::IsBlockedNoSpeedModCheck(const MoveDef& moveDef,
 	if (zmin < 0 || zmax >= mapDims.mapy)
 		return BLOCK_IMPASSABLE;
 
+	// most footprints are not touched by any object
+	if (!groundBlockingObjectMap->RangeOccupiedUnsafe(xmin, xmax, zmin, zmax))
+		return BLOCK_NONE;
+
 	BlockType ret = BLOCK_NONE;
 
 	// (footprints are point-symmetric around <xSquare, zSquare>)
 	for (int z = zmin; z <= zmax; z += FOOTPRINT_ZSTEP) {
 		const int zOffset = z * mapDims.mapx;
 		for (int x = xmin; x <= xmax; x += FOOTPRINT_XSTEP) {
-			const BlockingMapCell& cell = groundBlockingObjectMap->GetCellUnsafeConst(zOffset + x);
+			const BlockingMapCell cell = groundBlockingObjectMap->GetCellUnsafeConst(zOffset + x);
 			for (const CSolidObject* collidee: cell) {
 				ret |= ObjectBlockType(moveDef, collidee, collider);
 				if (ret & BLOCK_STRUCTURE)
@@ -254,7 +379,7 @@ CMoveMath::BlockType CMoveMath::SquareIsBlocked(const MoveDef& moveDef, int xSqu
 
 	BlockType r = BLOCK_NONE;
 
-	const BlockingMapCell& cell = groundBlockingObjectMap->GetCellUnsafeConst(zSquare * mapDims.mapx + xSquare);
+	const BlockingMapCell cell = groundBlockingObjectMap->GetCellUnsafeConst(zSquare * mapDims.mapx + xSquare);
 
 	for (const CSolidObject* collidee: cell) {
 		r |= ObjectBlockType(moveDef, collidee, collider);
@@ -271,6 +396,9 @@ CMoveMath::BlockType CMoveMath::RangeIsBlocked(const MoveDef& moveDef, int xmin,
 	if (zmin < 0 || zmax >= mapDims.mapy)
 		return BLOCK_IMPASSABLE;
 
+	if (!groundBlockingObjectMap->RangeOccupiedUnsafe(xmin, xmax, zmin, zmax))
+		return BLOCK_NONE;
+
 	BlockType ret = BLOCK_NONE;
 
 	const int tempNum = gs->GetTempNum();
@@ -280,7 +408,7 @@ CMoveMath::BlockType CMoveMath::RangeIsBlocked(const MoveDef& moveDef, int xmin,
 		const int zOffset = z * mapDims.mapx;
 
 		for (int x = xmin; x <= xmax; x += FOOTPRINT_XSTEP) {
-			const BlockingMapCell& cell = groundBlockingObjectMap->GetCellUnsafeConst(zOffset + x);
+			const BlockingMapCell cell = groundBlockingObjectMap->GetCellUnsafeConst(zOffset + x);
 
 			for (CSolidObject* collidee: cell) {
 				if (collidee->tempNum == tempNum)
@@ -20,6 +20,9 @@ protected:
 	static float ShipSpeedMod(const MoveDef& moveDef, float height, float slope);
 	static float ShipSpeedMod(const MoveDef& moveDef, float height, float slope, float dirSlopeMod);
 
+	// evaluates the heightmap, slopemap and typemap at typemap-square <tmSquare>
+	static float CalcPosSpeedMod(const MoveDef& moveDef, int tmSquare);
+
 public:
 	// gives the y-coordinate the unit will "stand on"
 	static float yLevel(const MoveDef& moveDef, const float3& pos);
@@ -49,6 +52,18 @@ public:
 		return (GetPosSpeedMod(moveDef, pos.x / SQUARE_SIZE, pos.z / SQUARE_SIZE, moveDir));
 	}
 
+	// writes the speed-multipliers of squares [xmin, xmax) in row <zSquare>
+	// to <speedMods>; squares outside the map receive a multiplier of zero
+	static void GetRowSpeedMods(const MoveDef& moveDef, int xmin, int xmax, int zSquare, float* speedMods);
+
+	// the non-directional speed-multipliers are kept in per-MoveDef tables
+	// at typemap resolution, shared by MoveDefs with equal speed-mod params
+	// (a zero entry means the terrain itself is impassable for the MoveDef)
+	static void InitSpeedModMaps();
+	static void FreeSpeedModMaps();
+	// recalculates the table entries for squares [x1, x2] x [z1, z2]
+	static void UpdateSpeedModMaps(int x1, int z1, int x2, int z2);
+
 	// tells whether a position is blocked (inaccessable for a given object's MoveDef)
 	static inline BlockType IsBlocked(const MoveDef& moveDef, const float3& pos, const CSolidObject* collider);
 	static inline BlockType IsBlocked(const MoveDef& moveDef, int xSquare, int zSquare, const CSolidObject* collider);
@@ -49,6 +49,13 @@ public:
 	virtual bool Update() = 0;
 	virtual void SlowUpdate();
 
+	// two-phase alternative to Update (see CUnitHandler::Update)
+	// UpdateCompute runs concurrently for all units and must not
+	// write to any state outside of this MoveType, UpdateCommit is
+	// called serially afterwards in unit-ID order
+	virtual void UpdateCompute() {}
+	virtual bool UpdateCommit() { return (Update()); }
+
 	virtual bool IsSkidding() const { return false; }
 	virtual bool IsFlying() const { return false; }
 	virtual bool IsReversing() const { return false; }
@@ -0,0 +1,155 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+
+#include "UnitCollisionBroadphase.h"
+#include "MoveDefHandler.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Units/Unit.h"
+#include "System/myMath.h"
+
+// offset for grid coordinates, keeps out-of-map positions positive
+static constexpr int CELL_COORD_OFFSET = 1 << 20;
+
+static std::uint64_t GetCellKey(int x, int z)
+{
+	return ((std::uint64_t(z + CELL_COORD_OFFSET) << 32) | std::uint32_t(x + CELL_COORD_OFFSET));
+}
+
+static float GetUnitExtent(const CUnit* unit)
+{
+	const MoveDef* md = unit->moveDef;
+
+	const int xsize = (md != nullptr)? md->xsize: unit->xsize;
+	const int zsize = (md != nullptr)? md->zsize: unit->zsize;
+
+	// circle bounding the footprint; HandleUnitCollisions searches within twice
+	// this (plus the collidee's radius), accounting for movement on both sides
+	// and leaving some room for pushes received earlier in the frame
+	const float footprintRadius = math::sqrt(float(xsize * xsize + zsize * zsize)) * 0.5f * SQUARE_SIZE;
+
+	return (unit->speed.w * 2.0f + std::max(footprintRadius * 2.0f, unit->radius) + SQUARE_SIZE);
+}
+
+
+void CUnitCollisionBroadphase::Update(const std::vector<CUnit*>& activeUnits, unsigned int maxUnits)
+{
+	for (const Entry& e: entries) {
+		unitEntries[e.unitID] = -1;
+	}
+
+	entries.clear();
+	cellEntries.clear();
+	pairs.clear();
+
+	unitEntries.resize(maxUnits, -1);
+	updateFrame = gs->frameNum;
+
+	float maxExtent = SQUARE_SIZE;
+
+	for (CUnit* unit: activeUnits) {
+		// neither can collide with ground units
+		if (unit->GetTransporter() != nullptr)
+			continue;
+		if (unit->IsFlying())
+			continue;
+
+		unitEntries[unit->id] = entries.size();
+		entries.push_back({unit, unit->id, unit->pos, GetUnitExtent(unit), unit->moveDef != nullptr});
+
+		maxExtent = std::max(maxExtent, entries.back().extent);
+	}
+
+	// every candidate pair is at most one cell apart along both axes
+	const float cellSize = maxExtent * 2.0f;
+	const float invCellSize = 1.0f / cellSize;
+
+	for (unsigned int i = 0; i < entries.size(); i++) {
+		const float3& p = entries[i].pos;
+		cellEntries.emplace_back(GetCellKey(int(math::floor(p.x * invCellSize)), int(math::floor(p.z * invCellSize))), i);
+	}
+
+	std::sort(cellEntries.begin(), cellEntries.end());
+
+	for (unsigned int i = 0; i < entries.size(); i++) {
+		const Entry& a = entries[i];
+
+		const int cx = int(math::floor(a.pos.x * invCellSize));
+		const int cz = int(math::floor(a.pos.z * invCellSize));
+
+		for (int z = cz - 1; z <= cz + 1; z++) {
+			// cells (cx - 1, z) to (cx + 1, z) have consecutive keys
+			const auto beg = std::lower_bound(cellEntries.begin(), cellEntries.end(), std::make_pair(GetCellKey(cx - 1, z), 0u));
+			const auto end = std::lower_bound(beg, cellEntries.end(), std::make_pair(GetCellKey(cx + 2, z), 0u));
+
+			for (auto it = beg; it != end; ++it) {
+				const unsigned int j = it->second;
+				const Entry& b = entries[j];
+
+				// each pair once; at least one party has to collide actively
+				if (j <= i)
+					continue;
+				if (!a.mobile && !b.mobile)
+					continue;
+				if (a.pos.SqDistance(b.pos) >= Square(a.extent + b.extent))
+					continue;
+
+				pairs.emplace_back(i, j);
+			}
+		}
+	}
+
+	pairResolved.clear();
+	pairResolved.resize(pairs.size(), 0);
+
+	// gather the contacts of every mobile entry, in pair order
+	contactOffsets.clear();
+	contactOffsets.resize(entries.size() + 1, 0);
+
+	for (const auto& p: pairs) {
+		contactOffsets[p.first + 1] += entries[p.first].mobile;
+		contactOffsets[p.second + 1] += entries[p.second].mobile;
+	}
+	for (unsigned int i = 0; i < entries.size(); i++) {
+		contactOffsets[i + 1] += contactOffsets[i];
+	}
+
+	contacts.resize(contactOffsets.back());
+
+	// contactOffsets[i] temporarily serves as insertion index
+	for (unsigned int n = 0; n < pairs.size(); n++) {
+		const auto& p = pairs[n];
+
+		if (entries[p.first].mobile)
+			contacts[contactOffsets[p.first]++] = {entries[p.second].unit, n};
+		if (entries[p.second].mobile)
+			contacts[contactOffsets[p.second]++] = {entries[p.first].unit, n};
+	}
+
+	// shift the offsets back into place
+	for (unsigned int i = entries.size(); i > 0; i--) {
+		contactOffsets[i] = contactOffsets[i - 1];
+	}
+
+	contactOffsets[0] = 0;
+}
+
+
+bool CUnitCollisionBroadphase::GetContacts(const CUnit* unit, const Contact*& beg, const Contact*& end) const
+{
+	if (updateFrame != gs->frameNum)
+		return false;
+	if (size_t(unit->id) >= unitEntries.size())
+		return false;
+
+	const int entryIdx = unitEntries[unit->id];
+
+	// also rejects units created after the broadphase was built
+	if (entryIdx < 0 || entries[entryIdx].unit != unit)
+		return false;
+
+	beg = contacts.data() + contactOffsets[entryIdx    ];
+	end = contacts.data() + contactOffsets[entryIdx + 1];
+	return true;
+}
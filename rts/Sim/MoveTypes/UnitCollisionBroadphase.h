@@ -0,0 +1,71 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef UNIT_COLLISION_BROADPHASE_H
+#define UNIT_COLLISION_BROADPHASE_H
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "System/float3.h"
+
+class CUnit;
+
+/**
+ * @brief per-frame candidate pairs for ground-unit collisions
+ *
+ * Built once per frame (before the MoveType updates) by sorting all units
+ * into a uniform grid sized by the largest unit extent of the frame, which
+ * yields every pair of units that can come into contact during the frame.
+ * CGroundMoveType::HandleUnitCollisions then walks the contacts of its
+ * owner instead of querying the QuadField, and pushes each pair apart only
+ * once per frame (see IsPairResolved).
+ *
+ * Units created during the frame are not known and fall back to the regular
+ * QuadField query. Everything is ordered by activeUnits, so the results are
+ * deterministic.
+ */
+class CUnitCollisionBroadphase
+{
+public:
+	struct Contact {
+		CUnit* unit;
+		unsigned int pairIdx;
+	};
+
+	void Update(const std::vector<CUnit*>& activeUnits, unsigned int maxUnits);
+
+	/// returns false if <unit> was not part of this frame's broadphase
+	bool GetContacts(const CUnit* unit, const Contact*& beg, const Contact*& end) const;
+
+	bool IsPairResolved(unsigned int pairIdx) const { return (pairResolved[pairIdx] != 0); }
+	void SetPairResolved(unsigned int pairIdx) { pairResolved[pairIdx] = 1; }
+
+	size_t GetNumPairs() const { return pairResolved.size(); }
+
+private:
+	struct Entry {
+		CUnit* unit;
+		/// copy, <unit> may have been deleted when the next frame resets unitEntries
+		int unitID;
+		float3 pos;
+		/// maximal distance from <pos> this unit can reach (and be reached at) this frame
+		float extent;
+		bool mobile;
+	};
+
+	std::vector<Entry> entries;
+	/// {grid-cell key, entry index}, sorted
+	std::vector<std::pair<std::uint64_t, unsigned int>> cellEntries;
+	/// per entry, the range of its contacts (mobile entries only)
+	std::vector<unsigned int> contactOffsets;
+	std::vector<Contact> contacts;
+	std::vector<std::pair<unsigned int, unsigned int>> pairs;
+	std::vector<std::uint8_t> pairResolved;
+	/// entry index by unit ID, or -1
+	std::vector<int> unitEntries;
+
+	int updateFrame = -1;
+};
+
+#endif // UNIT_COLLISION_BROADPHASE_H
@@ -264,10 +264,19 @@ void CSolidObject::Block()
 	if (IsBlocking() && !BlockMapPosChanged())
 		return;
 
+	// only block when `touching` the ground
+	const bool touchingGround = ((pos.y - radius) <= CGround::GetHeightAboveWater(pos.x, pos.z));
+
+	if (IsBlocking() && touchingGround && moveDef != nullptr && blockMap == nullptr) {
+		// a mobile object moving along the ground; instead of clearing and
+		// re-adding its whole footprint only update the squares it crossed
+		groundBlockingObjectMap->MoveGroundBlockingObject(this);
+		return;
+	}
+
 	UnBlock();
 
-	// only block when `touching` the ground
-	if ((pos.y - radius) <= CGround::GetHeightAboveWater(pos.x, pos.z)) {
+	if (touchingGround) {
 		groundBlockingObjectMap->AddGroundBlockingObject(this);
 		assert(IsBlocking());
 	}
@@ -98,7 +98,7 @@ IPath::SearchResult IPathFinder::GetPath(
 
 	// check cache (when there is one)
 	const int2 goalBlock = {int(pfDef.goalSquareX / BLOCK_SIZE), int(pfDef.goalSquareZ / BLOCK_SIZE)};
-	const CPathCache::CacheItem& ci = GetCache(mStartBlock, goalBlock, pfDef.sqGoalRadius, moveDef.pathType, pfDef.synced);
+	const CPathCache::CacheItem& ci = GetCache(mStartBlock, goalBlock, pfDef.sqGoalRadius, moveDef.pathLayer, pfDef.synced);
 
 	if (ci.pathType != -1) {
 		path = ci.path;
@@ -111,7 +111,7 @@ IPath::SearchResult IPathFinder::GetPath(
 	// if search was successful, generate new path and cache it
 	if (result == IPath::Ok || result == IPath::GoalOutOfRange) {
 		FinishSearch(moveDef, pfDef, path);
-		AddCache(&path, result, mStartBlock, goalBlock, pfDef.sqGoalRadius, moveDef.pathType, pfDef.synced);
+		AddCache(&path, result, mStartBlock, goalBlock, pfDef.sqGoalRadius, moveDef.pathLayer, pfDef.synced);
 
 		if (LOG_IS_ENABLED(L_DEBUG)) {
 			LOG_L(L_DEBUG, "==== %s: Search completed ====", (BLOCK_SIZE != 1) ? "PE" : "PF");
@@ -140,7 +140,7 @@ IPath::SearchResult IPathFinder::InitSearch(const MoveDef& moveDef, const CPathF
 	int2 square = mStartBlock;
 
 	if (BLOCK_SIZE != 1)
-		square = blockStates.peNodeOffsets[moveDef.pathType][mStartBlockIdx];
+		square = blockStates.peNodeOffsets[moveDef.pathLayer][mStartBlockIdx];
 
 	const bool isStartGoal = pfDef.IsGoal(square.x, square.y);
 	const bool startInGoal = pfDef.startInGoalRadius;
@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <algorithm>
+#include <limits>
 
 #include "PathCache.h"
 #include "Sim/Misc/GlobalConstants.h"
@@ -8,35 +9,46 @@
 #include "System/Log/ILog.h"
 
 #define MAX_CACHE_QUEUE_SIZE   200
+#define MAX_CORRIDOR_ITEMS     200
 #define MAX_PATH_LIFETIME_SECS   6
 #define USE_NONCOLLIDABLE_HASH   1
 
-CPathCache::CPathCache(int blocksX, int blocksZ)
+CPathCache::CPathCache(int blocksX, int blocksZ, bool useCorridors)
 	: numBlocksX(blocksX)
 	, numBlocksZ(blocksZ)
 	, numBlocks(numBlocksX * numBlocksZ)
-
-	, maxCacheSize(0)
-	, numCacheHits(0)
-	, numCacheMisses(0)
-	, numHashCollisions(0)
+	, useCorridors(useCorridors)
 {
 	// {result, path, strtBlock, goalBlock, goalRadius, pathType}
 	dummyCacheItem = {IPath::Error, {}, {-1, -1}, {-1, -1}, -1.0f, -1};
+	splicedCacheItem = dummyCacheItem;
+
+	for (CacheStats& cs: cacheStats) {
+		cs = {0, 0, 0, 0};
+	}
 
 	cachedPaths.reserve(4096);
+
+	if (!useCorridors)
+		return;
+
+	corridorItems.reserve(MAX_CORRIDOR_ITEMS);
+	corridorNodes.reserve(4096);
 }
 
 CPathCache::~CPathCache()
 {
 	const char* fmt =
 #ifdef _WIN32
-		"[%s(%ux%u)] cacheHits=%u hitPercentage=%.0f%% numHashColls=%u maxCacheSize=%I64u";
+		"[%s(%ux%u)][tier=%u] cacheHits=%u hitPercentage=%.0f%% numHashColls=%u maxCacheSize=%I64u";
 #else
-		"[%s(%ux%u)] cacheHits=%u hitPercentage=%.0f%% numHashColls=%u maxCacheSize=%lu";
+		"[%s(%ux%u)][tier=%u] cacheHits=%u hitPercentage=%.0f%% numHashColls=%u maxCacheSize=%lu";
 #endif
 
-	LOG(fmt, __FUNCTION__, numBlocksX, numBlocksZ, numCacheHits, GetCacheHitPercentage(), numHashCollisions, maxCacheSize);
+	for (unsigned int tier = CACHE_TIER_EXACT; tier < (CACHE_TIER_EXACT + 1 + useCorridors); tier++) {
+		const CacheStats& cs = cacheStats[tier];
+		LOG(fmt, __FUNCTION__, numBlocksX, numBlocksZ, tier, cs.numHits, GetCacheHitPercentage(tier), cs.numCollisions, cs.maxSize);
+	}
 }
 
 bool CPathCache::AddPath(
@@ -50,49 +62,250 @@ bool CPathCache::AddPath(
 	if (cacheQue.size() > MAX_CACHE_QUEUE_SIZE)
 		RemoveFrontQueItem();
 
+	CacheStats& cs = cacheStats[CACHE_TIER_EXACT];
+
 	const std::uint64_t hash = GetHash(strtBlock, goalBlock, goalRadius, pathType);
-	const std::uint32_t cols = numHashCollisions;
+	const std::uint32_t cols = cs.numCollisions;
 	const auto iter = cachedPaths.find(hash);
 
 	// register any hash collisions
 	if (iter != cachedPaths.end())
-		return ((numHashCollisions += HashCollision(iter->second, strtBlock, goalBlock, goalRadius, pathType)) != cols);
+		return ((cs.numCollisions += HashCollision(iter->second, strtBlock, goalBlock, goalRadius, pathType)) != cols);
 
 	cachedPaths[hash] = CacheItem{result, *path, strtBlock, goalBlock, goalRadius, pathType};
 
 	const int lifeTime = (result == IPath::Ok) ? GAME_SPEED * MAX_PATH_LIFETIME_SECS : GAME_SPEED * (MAX_PATH_LIFETIME_SECS / 2);
 
 	cacheQue.push_back({gs->frameNum + lifeTime, hash});
-	maxCacheSize = std::max<std::uint64_t>(maxCacheSize, cacheQue.size());
+	cs.maxSize = std::max<std::uint64_t>(cs.maxSize, cacheQue.size());
 	return false;
 }
 
+bool CPathCache::AddCorridor(
+	const IPath::Path* path,
+	const std::vector<int>& blockIdcs,
+	const std::vector<float>& pathCosts,
+	int pathType
+) {
+	if (!useCorridors)
+		return false;
+
+	// need at least two distinct blocks for a corridor to be worth splicing
+	if (blockIdcs.size() < 2 || blockIdcs.size() != path->path.size() || blockIdcs.size() != pathCosts.size())
+		return false;
+
+	if (corridorQue.size() >= MAX_CORRIDOR_ITEMS) {
+		RemoveCorridor(corridorQue.front());
+		corridorQue.pop_front();
+	}
+
+	std::uint32_t itemIdx = corridorItems.size();
+
+	if (!freeCorridorItems.empty()) {
+		itemIdx = freeCorridorItems.back();
+		freeCorridorItems.pop_back();
+	} else {
+		corridorItems.emplace_back();
+	}
+
+	CorridorItem& ci = corridorItems[itemIdx];
+
+	ci.path = *path;
+	ci.blockIdcs = blockIdcs;
+	ci.pathCosts = pathCosts;
+	ci.minBlock = {std::numeric_limits<int>::max(), std::numeric_limits<int>::max()};
+	ci.maxBlock = {-1, -1};
+	ci.pathType = pathType;
+
+	for (size_t i = 0, n = blockIdcs.size(); i < n; i++) {
+		const int2 block = {int(blockIdcs[i] % numBlocksX), int(blockIdcs[i] / numBlocksX)};
+
+		ci.minBlock.x = std::min(ci.minBlock.x, block.x);
+		ci.minBlock.y = std::min(ci.minBlock.y, block.y);
+		ci.maxBlock.x = std::max(ci.maxBlock.x, block.x);
+		ci.maxBlock.y = std::max(ci.maxBlock.y, block.y);
+
+		corridorNodes[GetCorridorKey(blockIdcs[i], pathType)].push_back({itemIdx, std::uint32_t(i)});
+	}
+
+	corridorQue.push_back(itemIdx);
+
+	CacheStats& cs = cacheStats[CACHE_TIER_CORRIDOR];
+	cs.maxSize = std::max<std::uint64_t>(cs.maxSize, corridorQue.size());
+	return true;
+}
+
+void CPathCache::RemoveCorridor(unsigned int itemIdx)
+{
+	CorridorItem& ci = corridorItems[itemIdx];
+
+	for (const int blockIdx: ci.blockIdcs) {
+		const auto iter = corridorNodes.find(GetCorridorKey(blockIdx, ci.pathType));
+
+		if (iter == corridorNodes.end())
+			continue;
+
+		std::vector<CorridorNode>& nodes = iter->second;
+
+		// a corridor can pass through the same block more than once
+		nodes.erase(std::remove_if(nodes.begin(), nodes.end(), [&](const CorridorNode& cn) { return (cn.itemIdx == itemIdx); }), nodes.end());
+
+		if (nodes.empty())
+			corridorNodes.erase(iter);
+	}
+
+	ci.path.path.clear();
+	ci.path.squares.clear();
+	ci.blockIdcs.clear();
+	ci.pathCosts.clear();
+	ci.pathType = -1;
+
+	freeCorridorItems.push_back(itemIdx);
+}
+
+void CPathCache::InvalidateCorridors(const int2 minBlock, const int2 maxBlock)
+{
+	if (corridorQue.empty())
+		return;
+
+	const auto IsInvalidated = [&](std::uint32_t itemIdx) {
+		const CorridorItem& ci = corridorItems[itemIdx];
+
+		if (ci.maxBlock.x < minBlock.x || ci.minBlock.x > maxBlock.x)
+			return false;
+		if (ci.maxBlock.y < minBlock.y || ci.minBlock.y > maxBlock.y)
+			return false;
+
+		for (const int blockIdx: ci.blockIdcs) {
+			const int2 block = {int(blockIdx % numBlocksX), int(blockIdx / numBlocksX)};
+
+			if (block.x < minBlock.x || block.x > maxBlock.x)
+				continue;
+			if (block.y < minBlock.y || block.y > maxBlock.y)
+				continue;
+
+			return true;
+		}
+
+		return false;
+	};
+
+	// keep FIFO-order of the surviving corridors
+	for (size_t i = 0, n = corridorQue.size(); i < n; i++) {
+		const std::uint32_t itemIdx = corridorQue.front();
+
+		corridorQue.pop_front();
+
+		if (IsInvalidated(itemIdx)) {
+			RemoveCorridor(itemIdx);
+			continue;
+		}
+
+		corridorQue.push_back(itemIdx);
+	}
+}
+
 const CPathCache::CacheItem& CPathCache::GetCachedPath(
 	const int2 strtBlock,
 	const int2 goalBlock,
 	float goalRadius,
 	int pathType
 ) {
+	CacheStats& cs = cacheStats[CACHE_TIER_EXACT];
+
 	const std::uint64_t hash = GetHash(strtBlock, goalBlock, goalRadius, pathType);
 	const auto iter = cachedPaths.find(hash);
 
 	if (iter == cachedPaths.end()) {
-		++numCacheMisses; return dummyCacheItem;
+		++cs.numMisses; return (GetCorridorPath(strtBlock, goalBlock, goalRadius, pathType));
 	}
 	if ((iter->second).strtBlock != strtBlock) {
-		++numCacheMisses; return dummyCacheItem;
+		++cs.numMisses; return (GetCorridorPath(strtBlock, goalBlock, goalRadius, pathType));
 	}
 	if ((iter->second).goalBlock != goalBlock) {
-		++numCacheMisses; return dummyCacheItem;
+		++cs.numMisses; return (GetCorridorPath(strtBlock, goalBlock, goalRadius, pathType));
 	}
 	if ((iter->second).pathType != pathType) {
-		++numCacheMisses; return dummyCacheItem;
+		++cs.numMisses; return (GetCorridorPath(strtBlock, goalBlock, goalRadius, pathType));
 	}
 
-	++numCacheHits;
+	++cs.numHits;
 	return (iter->second);
 }
 
+const CPathCache::CacheItem& CPathCache::GetCorridorPath(
+	const int2 strtBlock,
+	const int2 goalBlock,
+	float goalRadius,
+	int pathType
+) {
+	if (!useCorridors)
+		return dummyCacheItem;
+
+	CacheStats& cs = cacheStats[CACHE_TIER_CORRIDOR];
+
+	const int strtBlockIdx = strtBlock.y * numBlocksX + strtBlock.x;
+	const int goalBlockIdx = goalBlock.y * numBlocksX + goalBlock.x;
+
+	const auto iter = corridorNodes.find(GetCorridorKey(strtBlockIdx, pathType));
+
+	if (strtBlockIdx == goalBlockIdx || iter == corridorNodes.end()) {
+		++cs.numMisses; return dummyCacheItem;
+	}
+
+	bool reversed = false;
+
+	for (const CorridorNode& cn: iter->second) {
+		const CorridorItem& ci = corridorItems[cn.itemIdx];
+
+		if (goalBlock.x < ci.minBlock.x || goalBlock.x > ci.maxBlock.x)
+			continue;
+		if (goalBlock.y < ci.minBlock.y || goalBlock.y > ci.maxBlock.y)
+			continue;
+
+		// waypoints run from goal (index 0) to start, so the requested
+		// goal must precede the requested start along the corridor
+		const auto beg = ci.blockIdcs.begin();
+		const auto end = ci.blockIdcs.end();
+		const auto gIt = std::find(beg, end, goalBlockIdx);
+
+		if (gIt == end)
+			continue;
+
+		const std::uint32_t gIdx = gIt - beg;
+		const std::uint32_t sIdx = cn.pathIdx;
+
+		if (gIdx >= sIdx) {
+			reversed = true;
+			continue;
+		}
+
+		IPath::Path& sp = splicedCacheItem.path;
+
+		sp.path.assign(ci.path.path.begin() + gIdx, ci.path.path.begin() + sIdx + 1);
+		sp.squares.clear();
+		sp.desiredGoal = ci.path.desiredGoal;
+		sp.pathGoal = sp.path.front();
+		sp.goalRadius = goalRadius;
+		sp.pathCost = ci.pathCosts[gIdx] - ci.pathCosts[sIdx];
+
+		splicedCacheItem.result = IPath::Ok;
+		splicedCacheItem.strtBlock = strtBlock;
+		splicedCacheItem.goalBlock = goalBlock;
+		splicedCacheItem.goalRadius = goalRadius;
+		splicedCacheItem.pathType = pathType;
+
+		++cs.numHits;
+		return splicedCacheItem;
+	}
+
+	// corridors that only traverse the blocks in the opposite direction
+	// can not be spliced (costs are not symmetric) and count as collision
+	cs.numCollisions += reversed;
+	++cs.numMisses;
+	return dummyCacheItem;
+}
+
 void CPathCache::Update()
 {
 	while (!cacheQue.empty() && (cacheQue.front().timeout) < gs->frameNum)
@@ -4,15 +4,17 @@
 #define PATHCACHE_H
 
 #include <deque>
+#include <vector>
 
 #include "IPath.h"
 #include "System/type2.h"
+#include "System/FlatHashMap.hpp"
 #include "System/UnorderedMap.hpp"
 
 class CPathCache
 {
 public:
-	CPathCache(int blocksX, int blocksZ);
+	CPathCache(int blocksX, int blocksZ, bool useCorridors);
 	~CPathCache();
 
 	struct CacheItem {
@@ -24,6 +26,19 @@ public:
 		int pathType;
 	};
 
+	struct CacheStats {
+		std::uint32_t numHits;
+		std::uint32_t numMisses;
+		std::uint32_t numCollisions;
+		std::uint64_t maxSize;
+	};
+
+	enum {
+		CACHE_TIER_EXACT    = 0, // keyed on exact start- and goal-blocks
+		CACHE_TIER_CORRIDOR = 1, // sub-paths of any cached corridor
+		CACHE_TIER_COUNT    = 2,
+	};
+
 	void Update();
 	bool AddPath(
 		const IPath::Path* path,
@@ -41,8 +56,38 @@ public:
 		int pathType
 	);
 
+	/**
+	 * Adds a successful path as corridor; <blockIdcs> and <pathCosts> hold
+	 * the block-index and accumulated cost of each waypoint (which run from
+	 * goal to start like the path itself). Any later request whose start-
+	 * and goal-blocks both lie on the corridor (in that order) is served a
+	 * sub-path of it until a MapChanged rectangle touches one of its blocks.
+	 */
+	bool AddCorridor(
+		const IPath::Path* path,
+		const std::vector<int>& blockIdcs,
+		const std::vector<float>& pathCosts,
+		int pathType
+	);
+
+	void InvalidateCorridors(const int2 minBlock, const int2 maxBlock);
+
+	const CacheStats& GetStats(unsigned int tier) const { return cacheStats[tier]; }
+
 private:
 	void RemoveFrontQueItem();
+	void RemoveCorridor(unsigned int itemIdx);
+
+	const CacheItem& GetCorridorPath(
+		const int2 strtBlock,
+		const int2 goalBlock,
+		float goalRadius,
+		int pathType
+	);
+
+	std::uint64_t GetCorridorKey(int blockIdx, int pathType) const {
+		return (pathType * numBlocks + blockIdx);
+	}
 
 	std::uint64_t GetHash(
 		const int2 strtBlk,
@@ -59,11 +104,13 @@ private:
 		int pathType
 	) const;
 
-	float GetCacheHitPercentage() const {
-		if ((numCacheHits + numCacheMisses) == 0)
+	float GetCacheHitPercentage(unsigned int tier) const {
+		const CacheStats& cs = cacheStats[tier];
+
+		if ((cs.numHits + cs.numMisses) == 0)
 			return 0.0f;
 
-		return ((numCacheHits / float(numCacheHits + numCacheMisses)) * 100.0f);
+		return ((cs.numHits / float(cs.numHits + cs.numMisses)) * 100.0f);
 	}
 
 private:
@@ -72,20 +119,45 @@ private:
 		std::uint64_t hash;
 	};
 
+	struct CorridorItem {
+		IPath::Path path;
+
+		std::vector<int> blockIdcs;
+		std::vector<float> pathCosts;
+
+		int2 minBlock;
+		int2 maxBlock;
+
+		int pathType;
+	};
+
+	struct CorridorNode {
+		std::uint32_t itemIdx; // index into corridorItems
+		std::uint32_t pathIdx; // index of the block along the corridor
+	};
+
 	// returned on any cache-miss
 	CacheItem dummyCacheItem;
+	// returned on corridor-hits, valid until the next GetCachedPath
+	CacheItem splicedCacheItem;
 
 	std::deque<CacheQueItem> cacheQue;
-	spring::unordered_map<std::uint64_t, CacheItem> cachedPaths; // ints are sync-safe keys
+	spring::flat_hash_map<std::uint64_t, CacheItem> cachedPaths; // ints are sync-safe keys
+
+	// slots are recycled, FIFO-order is tracked by corridorQue
+	std::vector<CorridorItem> corridorItems;
+	std::vector<std::uint32_t> freeCorridorItems;
+	std::deque<std::uint32_t> corridorQue;
+	// maps each (pathType, block) to the corridors passing through it
+	spring::unordered_map<std::uint64_t, std::vector<CorridorNode>> corridorNodes;
 
 	std::uint32_t numBlocksX;
 	std::uint32_t numBlocksZ;
 	std::uint64_t numBlocks;
 
-	std::uint64_t maxCacheSize;
-	std::uint32_t numCacheHits;
-	std::uint32_t numCacheMisses;
-	std::uint32_t numHashCollisions;
+	bool useCorridors;
+
+	CacheStats cacheStats[CACHE_TIER_COUNT];
 };
 
 #endif
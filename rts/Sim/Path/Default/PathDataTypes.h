@@ -211,6 +211,22 @@ struct PathNodeStateBuffer {
 		er[synced].y = sz;
 	}
 
+	/// makes our extra-cost lookups read from the costs owned by {@param pnsb}
+	/// (which must have the same resolution); used by helper PF's searching in
+	/// parallel with the one holding the actual costs
+	void ShareNodeExtraCosts(const PathNodeStateBuffer& pnsb) {
+		for (const bool synced: {false, true}) {
+			if ((extraCostsOverlay[synced] = pnsb.extraCostsOverlay[synced]) != nullptr) {
+				er[synced] = pnsb.er[synced];
+				continue;
+			}
+
+			// null if vector is empty
+			extraCostsOverlay[synced] = pnsb.extraCosts[synced].data();
+			er[synced] = pnsb.br;
+		}
+	}
+
 public:
 	std::vector<float> fCost;
 	std::vector<float> gCost;
@@ -219,8 +235,8 @@ public:
 	std::vector<std::uint8_t> nodeMask;
 
 	/// for the PE, maintains an array of the best accessible
-	/// offset (from a block's center position) per path-type
-	/// peNodeOffsets[pathType][blockIdx]
+	/// offset (from a block's center position) per path-layer
+	/// peNodeOffsets[pathLayer][blockIdx]
 	std::vector< std::vector<short2> > peNodeOffsets;
 
 private:
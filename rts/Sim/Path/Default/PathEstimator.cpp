@@ -12,6 +12,8 @@
 #include "PathMemPool.h"
 #include "Game/GlobalUnsynced.h"
 #include "Game/LoadScreen.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
@@ -31,10 +33,16 @@
 #include "System/Sync/HsiehHash.h"
 #include "System/Sync/SHA512.hpp"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <limits>
+
 #define ENABLE_NETLOG_CHECKSUM 1
 
 
 CONFIG(int, MaxPathCostsMemoryFootPrint).defaultValue(512).minimumValue(64).description("Maximum memusage (in MByte) of multithreaded pathcache generator at loading time.");
+CONFIG(bool, MappedPathCacheFiles).defaultValue(true).description("Write path-estimator caches uncompressed s.t. they can be memory-mapped at load time (and shared between local instances). Compressed caches are still read.");
 
 PCMemPool pcMemPool;
 PEMemPool peMemPool;
@@ -44,6 +52,10 @@ static const std::string GetPathCacheDir() {
 	return (FileSystem::GetCacheDir() + "/paths/");
 }
 
+static std::string GetPathCacheFileName(const std::string& mapName, const std::string& baseFileName, std::uint32_t hashCode, const char* ext) {
+	return (GetPathCacheDir() + mapName + "." + baseFileName + "-" + IntToString(hashCode, "%x") + ext);
+}
+
 static size_t GetNumThreads() {
 	const size_t numThreads = std::max(0, configHandler->GetInt("PathingThreadCount"));
 	const size_t numCores = Threading::GetLogicalCpuCores();
@@ -63,10 +75,16 @@ CPathEstimator::CPathEstimator(IPathFinder* pf, unsigned int BLOCK_SIZE, const s
 	, costBlockNum(nbrOfBlocks.x * nbrOfBlocks.y)
 	, parentPathFinder(pf)
 	, nextPathEstimator(nullptr)
+	, vertexCosts(nullptr)
+	, numVertexCosts(0)
 	, blockUpdatePenalty(0)
+	, numQueuedBlocks(0)
 {
-	vertexCosts.resize(moveDefHandler->GetNumMoveDefs() * blockStates.GetSize() * PATH_DIRECTION_VERTICES, PATHCOST_INFINITY);
-	maxSpeedMods.resize(moveDefHandler->GetNumMoveDefs(), 0.001f);
+	vertexCostsMem.resize(moveDefHandler->GetNumPathLayers() * blockStates.GetSize() * PATH_DIRECTION_VERTICES, PATHCOST_INFINITY);
+	vertexCosts = vertexCostsMem.data();
+	numVertexCosts = vertexCostsMem.size();
+	blockDemand.resize(blockStates.GetSize(), 0);
+	maxSpeedMods.resize(moveDefHandler->GetNumPathLayers(), 0.001f);
 
 	CPathEstimator*  childPE = this;
 	CPathEstimator* parentPE = dynamic_cast<CPathEstimator*>(pf);
@@ -94,14 +112,16 @@ CPathEstimator::CPathEstimator(IPathFinder* pf, unsigned int BLOCK_SIZE, const s
 	if (BLOCK_SIZE == LOWRES_PE_BLOCKSIZE) {
 		assert(parentPE != nullptr);
 
-		// calculate map-wide maximum positional speedmod for each MoveDef
-		for_mt(0, moveDefHandler->GetNumMoveDefs(), [&](unsigned int i) {
-			const MoveDef* md = moveDefHandler->GetMoveDefByPathType(i);
+		// calculate map-wide maximum positional speedmod for each path layer
+		for_mt(0, moveDefHandler->GetNumPathLayers(), [&](unsigned int i) {
+			const MoveDef* md = moveDefHandler->GetMoveDefByPathLayer(i);
+
+			std::vector<float> rowSpeedMods(mapDims.mapx);
 
 			for (int y = 0; y < mapDims.mapy; y++) {
-				for (int x = 0; x < mapDims.mapx; x++) {
-					childPE->maxSpeedMods[i] = std::max(childPE->maxSpeedMods[i], CMoveMath::GetPosSpeedMod(*md, x, y));
-				}
+				CMoveMath::GetRowSpeedMods(*md, 0, mapDims.mapx, y, rowSpeedMods.data());
+
+				childPE->maxSpeedMods[i] = std::max(childPE->maxSpeedMods[i], *std::max_element(rowSpeedMods.begin(), rowSpeedMods.end()));
 			}
 		});
 
@@ -194,15 +214,15 @@ void CPathEstimator::InitEstimator(const std::string& cacheFileName, const std::
 	pfMemPool.free(pathFinders[0]);
 	pathFinders[0] = parentPathFinder;
 
-	pathCache[0] = pcMemPool.alloc<CPathCache>(nbrOfBlocks.x, nbrOfBlocks.y);
-	pathCache[1] = pcMemPool.alloc<CPathCache>(nbrOfBlocks.x, nbrOfBlocks.y);
+	pathCache[0] = pcMemPool.alloc<CPathCache>(nbrOfBlocks.x, nbrOfBlocks.y, modInfo.pfCorridorCache);
+	pathCache[1] = pcMemPool.alloc<CPathCache>(nbrOfBlocks.x, nbrOfBlocks.y, modInfo.pfCorridorCache);
 }
 
 
 void CPathEstimator::InitBlocks()
 {
-	blockStates.peNodeOffsets.resize(moveDefHandler->GetNumMoveDefs());
-	for (unsigned int idx = 0; idx < moveDefHandler->GetNumMoveDefs(); idx++) {
+	blockStates.peNodeOffsets.resize(moveDefHandler->GetNumPathLayers());
+	for (unsigned int idx = 0; idx < moveDefHandler->GetNumPathLayers(); idx++) {
 		blockStates.peNodeOffsets[idx].resize(nbrOfBlocks.x * nbrOfBlocks.y);
 	}
 }
@@ -245,10 +265,10 @@ void CPathEstimator::CalculateBlockOffsets(unsigned int blockIdx, unsigned int t
 		clientNet->Send(CBaseNetProtocol::Get().SendCPUUsage(BLOCK_SIZE | (blockIdx << 8)));
 	}
 
-	for (unsigned int i = 0; i < moveDefHandler->GetNumMoveDefs(); i++) {
-		const MoveDef* md = moveDefHandler->GetMoveDefByPathType(i);
+	for (unsigned int i = 0; i < moveDefHandler->GetNumPathLayers(); i++) {
+		const MoveDef* md = moveDefHandler->GetMoveDefByPathLayer(i);
 
-		blockStates.peNodeOffsets[md->pathType][blockIdx] = FindBlockPosOffset(*md, blockPos.x, blockPos.y);
+		blockStates.peNodeOffsets[md->pathLayer][blockIdx] = FindBlockPosOffset(*md, blockPos.x, blockPos.y);
 	}
 }
 
@@ -267,8 +287,8 @@ void CPathEstimator::EstimatePathCosts(unsigned int blockIdx, unsigned int threa
 		loadscreen->SetLoadMessage(calcMsg, (blockIdx != 0));
 	}
 
-	for (unsigned int i = 0; i < moveDefHandler->GetNumMoveDefs(); i++) {
-		const MoveDef* md = moveDefHandler->GetMoveDefByPathType(i);
+	for (unsigned int i = 0; i < moveDefHandler->GetNumPathLayers(); i++) {
+		const MoveDef* md = moveDefHandler->GetMoveDefByPathLayer(i);
 
 		CalcVertexPathCosts(*md, blockPos, threadNum);
 	}
@@ -360,7 +380,7 @@ void CPathEstimator::CalcVertexPathCost(
 	const unsigned int parentBlockIdx = BlockPosToIdx(parentBlockPos);
 	const unsigned int  childBlockIdx = BlockPosToIdx( childBlockPos);
 	const unsigned int  vertexCostIdx =
-		moveDef.pathType * blockStates.GetSize() * PATH_DIRECTION_VERTICES +
+		moveDef.pathLayer * blockStates.GetSize() * PATH_DIRECTION_VERTICES +
 		parentBlockIdx * PATH_DIRECTION_VERTICES +
 		pathDir;
 
@@ -372,8 +392,8 @@ void CPathEstimator::CalcVertexPathCost(
 
 
 	// start position within parent block, goal position within child block
-	const int2 parentSquare = blockStates.peNodeOffsets[moveDef.pathType][parentBlockIdx];
-	const int2  childSquare = blockStates.peNodeOffsets[moveDef.pathType][ childBlockIdx];
+	const int2 parentSquare = blockStates.peNodeOffsets[moveDef.pathLayer][parentBlockIdx];
+	const int2  childSquare = blockStates.peNodeOffsets[moveDef.pathLayer][ childBlockIdx];
 
 	const float3 startPos = SquareToFloat3(parentSquare.x, parentSquare.y);
 	const float3  goalPos = SquareToFloat3( childSquare.x,  childSquare.y);
@@ -443,33 +463,73 @@ void CPathEstimator::MapChanged(unsigned int x1, unsigned int z1, unsigned int x
 			if ((blockStates.nodeMask[idx] & PATHOPT_OBSOLETE) != 0)
 				continue;
 
-			updatedBlocks.emplace_back(x, z);
+			updatedBlocks.emplace_back(int2(x, z), gs->frameNum, numQueuedBlocks++);
 			blockStates.nodeMask[idx] |= PATHOPT_OBSOLETE;
 		}
 	}
+
+	// cached corridors through any of these blocks are no longer valid
+	pathCache[0]->InvalidateCorridors(int2(lowerX, lowerZ), int2(upperX, upperZ));
+	pathCache[1]->InvalidateCorridors(int2(lowerX, lowerZ), int2(upperX, upperZ));
+}
+
+
+void CPathEstimator::AddBlockDemand(const IPath::Path& path)
+{
+	for (const float3& pos: path.path) {
+		const int2 blockPos = {Clamp(int(pos.x / BLOCK_PIXEL_SIZE), 0, int(nbrOfBlocks.x - 1)), Clamp(int(pos.z / BLOCK_PIXEL_SIZE), 0, int(nbrOfBlocks.y - 1))};
+		const int blockIdx = BlockPosToIdx(blockPos);
+
+		blockDemand[blockIdx] += (blockDemand[blockIdx] < std::numeric_limits<std::uint16_t>::max());
+	}
+}
+
+int CPathEstimator::GetMaxQueuedBlockAge() const
+{
+	int minQueueFrame = gs->frameNum;
+
+	for (const QueuedBlock& qb: updatedBlocks) {
+		minQueueFrame = std::min(minQueueFrame, qb.queueFrame);
+	}
+
+	return (gs->frameNum - minQueueFrame);
 }
 
 
 /**
- * Update some obsolete blocks using the FIFO-principle
+ * Update some obsolete blocks, those with the highest demand first
+ * (and using the FIFO-principle among blocks with equal demand)
  */
 void CPathEstimator::Update()
 {
 	pathCache[0]->Update();
 	pathCache[1]->Update();
 
-	const unsigned int numMoveDefs = moveDefHandler->GetNumMoveDefs();
+	// let demand fade out over a few seconds once paths stop using a block
+	if ((gs->frameNum % GAME_SPEED) == 0) {
+		for (std::uint16_t& demand: blockDemand) {
+			demand >>= 1;
+		}
+	}
 
-	if (numMoveDefs == 0)
+	const unsigned int numPathLayers = moveDefHandler->GetNumPathLayers();
+
+	if (numPathLayers == 0)
 		return;
 
 	// determine how many blocks we should update
 	int blocksToUpdate = 0;
 	int consumeBlocks = 0;
 	{
-		const int progressiveUpdates = updatedBlocks.size() * numMoveDefs * modInfo.pfUpdateRate;
+		// the budget can not depend on (unsynced) frame timings, since block
+		// updates change synced state; grow it with the age of the backlog
+		// instead s.t. blocks do not stay stale for very long after large map
+		// changes
+		const int maxQueuedBlockAge = GetMaxQueuedBlockAge();
+
+		const int progressiveUpdates = updatedBlocks.size() * numPathLayers * modInfo.pfUpdateRate;
 		const int MIN_BLOCKS_TO_UPDATE = std::max<int>(BLOCKS_TO_UPDATE >> 1, 4U);
-		const int MAX_BLOCKS_TO_UPDATE = std::max<int>(BLOCKS_TO_UPDATE << 1, MIN_BLOCKS_TO_UPDATE);
+		const int MAX_BLOCKS_TO_UPDATE = std::max<int>(BLOCKS_TO_UPDATE << 1, MIN_BLOCKS_TO_UPDATE) * (1 + std::min(maxQueuedBlockAge / (GAME_SPEED * 4), 3));
 
 		blocksToUpdate = Clamp(progressiveUpdates, MIN_BLOCKS_TO_UPDATE, MAX_BLOCKS_TO_UPDATE);
 		blockUpdatePenalty = std::max(0, blockUpdatePenalty - blocksToUpdate);
@@ -478,7 +538,7 @@ void CPathEstimator::Update()
 			blocksToUpdate = std::max(0, blocksToUpdate - blockUpdatePenalty);
 
 		// we have to update blocks for all movedefs (PATHOPT_OBSOLETE applies per block, not per movedef)
-		consumeBlocks = int(progressiveUpdates != 0) * int(ceil(float(blocksToUpdate) / numMoveDefs)) * numMoveDefs;
+		consumeBlocks = int(progressiveUpdates != 0) * int(ceil(float(blocksToUpdate) / numPathLayers)) * numPathLayers;
 		blockUpdatePenalty += consumeBlocks;
 	}
 
@@ -491,9 +551,22 @@ void CPathEstimator::Update()
 	consumedBlocks.clear();
 	consumedBlocks.reserve(consumeBlocks);
 
+	{
+		// move the blocks consumed this frame to the front of the queue if not all fit
+		const size_t numBlocks = (blocksToUpdate + numPathLayers - 1) / numPathLayers;
+
+		if (numBlocks < updatedBlocks.size()) {
+			std::partial_sort(updatedBlocks.begin(), updatedBlocks.begin() + numBlocks, updatedBlocks.end(), [&](const QueuedBlock& a, const QueuedBlock& b) {
+				const std::uint16_t da = blockDemand[BlockPosToIdx(a.blockPos)];
+				const std::uint16_t db = blockDemand[BlockPosToIdx(b.blockPos)];
+				return ((da > db) || (da == db && a.queueIndex < b.queueIndex));
+			});
+		}
+	}
+
 	// get blocks to update
 	while (!updatedBlocks.empty()) {
-		const int2& pos = updatedBlocks.front();
+		const int2& pos = updatedBlocks.front().blockPos;
 		const int idx = BlockPosToIdx(pos);
 
 		if ((blockStates.nodeMask[idx] & PATHOPT_OBSOLETE) == 0) {
@@ -505,8 +578,8 @@ void CPathEstimator::Update()
 			break;
 
 		// issue repathing for all active movedefs
-		for (unsigned int i = 0; i < numMoveDefs; i++) {
-			const MoveDef* md = moveDefHandler->GetMoveDefByPathType(i);
+		for (unsigned int i = 0; i < numPathLayers; i++) {
+			const MoveDef* md = moveDefHandler->GetMoveDefByPathLayer(i);
 
 			consumedBlocks.emplace_back(pos, md);
 		}
@@ -531,7 +604,7 @@ void CPathEstimator::Update()
 			const SingleBlock sb = consumedBlocks[n];
 			const int blockN = BlockPosToIdx(sb.blockPos);
 			const MoveDef* currBlockMD = sb.moveDef;
-			blockStates.peNodeOffsets[currBlockMD->pathType][blockN] = FindBlockPosOffset(*currBlockMD, sb.blockPos.x, sb.blockPos.y);
+			blockStates.peNodeOffsets[currBlockMD->pathLayer][blockN] = FindBlockPosOffset(*currBlockMD, sb.blockPos.x, sb.blockPos.y);
 		});
 	}
 
@@ -553,6 +626,31 @@ const CPathCache::CacheItem& CPathEstimator::GetCache(const int2 strtBlock, cons
 void CPathEstimator::AddCache(const IPath::Path* path, const IPath::SearchResult result, const int2 strtBlock, const int2 goalBlock, float goalRadius, int pathType, const bool synced)
 {
 	pathCache[synced]->AddPath(path, result, strtBlock, goalBlock, goalRadius, pathType);
+
+	if (!modInfo.pfCorridorCache || result != IPath::Ok)
+		return;
+
+	// called directly after FinishSearch, so the g-costs of all
+	// blocks along the path still belong to the current search
+	corridorBlockIdcs.clear();
+	corridorPathCosts.clear();
+
+	for (const float3& pos: path->path) {
+		const int2 blockPos = {
+			Clamp(int(pos.x / BLOCK_PIXEL_SIZE), 0, int(nbrOfBlocks.x - 1)),
+			Clamp(int(pos.z / BLOCK_PIXEL_SIZE), 0, int(nbrOfBlocks.y - 1)),
+		};
+		const int blockIdx = BlockPosToIdx(blockPos);
+
+		// never build corridors over blocks that are awaiting an update
+		if ((blockStates.nodeMask[blockIdx] & PATHOPT_OBSOLETE) != 0)
+			return;
+
+		corridorBlockIdcs.push_back(blockIdx);
+		corridorPathCosts.push_back(blockStates.gCost[blockIdx]);
+	}
+
+	pathCache[synced]->AddCorridor(path, corridorBlockIdcs, corridorPathCosts, pathType);
 }
 
 
@@ -600,7 +698,7 @@ IPath::SearchResult CPathEstimator::DoSearch(const MoveDef& moveDef, const CPath
 
 	// get the goal square offset
 	const int2 goalSqrOffset = peDef.GoalSquareOffset(BLOCK_SIZE);
-	const float maxSpeedMod = maxSpeedMods[moveDef.pathType];
+	const float maxSpeedMod = maxSpeedMods[moveDef.pathLayer];
 
 	while (!openBlocks.empty() && (openBlockBuffer.GetSize() < maxBlocksToBeSearched)) {
 		// get the open block with lowest cost
@@ -612,7 +710,7 @@ IPath::SearchResult CPathEstimator::DoSearch(const MoveDef& moveDef, const CPath
 			continue;
 
 		// no, check if the goal is already reached
-		const int2 bSquare = blockStates.peNodeOffsets[moveDef.pathType][ob->nodeNum];
+		const int2 bSquare = blockStates.peNodeOffsets[moveDef.pathLayer][ob->nodeNum];
 		const int2 gSquare = ob->nodePos * BLOCK_SIZE + goalSqrOffset;
 
 		bool runBlkSearch = false;
@@ -704,17 +802,17 @@ bool CPathEstimator::TestBlock(
 	if (blockStates.nodeMask[testBlockIdx] & (PATHOPT_BLOCKED | PATHOPT_CLOSED))
 		return false;
 
-	const unsigned int vertexBaseIdx = moveDef.pathType * nbrOfBlocks.x * nbrOfBlocks.y * PATH_DIRECTION_VERTICES;
+	const unsigned int vertexBaseIdx = moveDef.pathLayer * nbrOfBlocks.x * nbrOfBlocks.y * PATH_DIRECTION_VERTICES;
 	const unsigned int vertexCostIdx =
 		vertexBaseIdx +
 		openBlockIdx * PATH_DIRECTION_VERTICES +
 		GetBlockVertexOffset(pathDir, nbrOfBlocks.x);
 
-	assert(testBlockIdx < blockStates.peNodeOffsets[moveDef.pathType].size());
-	assert(vertexCostIdx < vertexCosts.size());
+	assert(testBlockIdx < blockStates.peNodeOffsets[moveDef.pathLayer].size());
+	assert(vertexCostIdx < numVertexCosts);
 
 	// best accessible heightmap-coordinate within tested block
-	const int2 testBlockSquare = blockStates.peNodeOffsets[moveDef.pathType][testBlockIdx];
+	const int2 testBlockSquare = blockStates.peNodeOffsets[moveDef.pathLayer][testBlockIdx];
 
 	// transition-cost from parent to tested child
 	float testVertexCost = vertexCosts[vertexCostIdx];
@@ -881,7 +979,7 @@ void CPathEstimator::FinishSearch(const MoveDef& moveDef, const CPathFinderDef&
 
 		while (true) {
 			// use offset defined by the block
-			const int2 square = blockStates.peNodeOffsets[moveDef.pathType][blockIdx];
+			const int2 square = blockStates.peNodeOffsets[moveDef.pathLayer][blockIdx];
 
 			// foundPath.squares.push_back(square);
 			foundPath.path.emplace_back(square.x * SQUARE_SIZE, CMoveMath::yLevel(moveDef, square.x, square.y), square.y * SQUARE_SIZE);
@@ -909,6 +1007,9 @@ void CPathEstimator::FinishSearch(const MoveDef& moveDef, const CPathFinderDef&
  */
 bool CPathEstimator::ReadFile(const std::string& baseFileName, const std::string& mapName)
 {
+	if (ReadMappedFile(baseFileName, mapName))
+		return true;
+
 	const std::string hashHexString = IntToString(fileHashCode, "%x");
 	const std::string cacheFileName = GetPathCacheDir() + mapName + "." + baseFileName + "-" + hashHexString + ".zip";
 
@@ -953,24 +1054,24 @@ bool CPathEstimator::ReadFile(const std::string& baseFileName, const std::string
 		return false;
 	}
 
-	if (buffer.size() < (pos + blockSize * moveDefHandler->GetNumMoveDefs())) {
+	if (buffer.size() < (pos + blockSize * moveDefHandler->GetNumPathLayers())) {
 		FileSystem::Remove(cacheFileName);
 		return false;
 	}
 
 	// read center-offset data
-	for (int pathType = 0; pathType < moveDefHandler->GetNumMoveDefs(); ++pathType) {
+	for (int pathType = 0; pathType < moveDefHandler->GetNumPathLayers(); ++pathType) {
 		std::memcpy(&blockStates.peNodeOffsets[pathType][0], &buffer[pos], blockSize);
 		pos += blockSize;
 	}
 
 	// read vertex-cost data
-	if (buffer.size() < (pos + vertexCosts.size() * sizeof(float))) {
+	if (buffer.size() < (pos + numVertexCosts * sizeof(float))) {
 		FileSystem::Remove(cacheFileName);
 		return false;
 	}
 
-	std::memcpy(&vertexCosts[0], &buffer[pos], vertexCosts.size() * sizeof(float));
+	std::memcpy(&vertexCosts[0], &buffer[pos], numVertexCosts * sizeof(float));
 	return true;
 }
 
@@ -984,6 +1085,9 @@ void CPathEstimator::WriteFile(const std::string& baseFileName, const std::strin
 	if (!FileSystem::CreateDirectory(GetPathCacheDir()))
 		return;
 
+	if (configHandler->GetBool("MappedPathCacheFiles") && WriteMappedFile(baseFileName, mapName))
+		return;
+
 	const std::string hashHexString = IntToString(fileHashCode, "%x");
 	const std::string cacheFileName = GetPathCacheDir() + mapName + "." + baseFileName + "-" + hashHexString + ".zip";
 
@@ -1001,12 +1105,12 @@ void CPathEstimator::WriteFile(const std::string& baseFileName, const std::strin
 	zipWriteInFileInZip(file, (const void*) &fileHashCode, 4);
 
 	// write center-offsets
-	for (int pathType = 0; pathType < moveDefHandler->GetNumMoveDefs(); ++pathType) {
+	for (int pathType = 0; pathType < moveDefHandler->GetNumPathLayers(); ++pathType) {
 		zipWriteInFileInZip(file, (const void*) &blockStates.peNodeOffsets[pathType][0], blockStates.peNodeOffsets[pathType].size() * sizeof(short2));
 	}
 
 	// write vertex-costs
-	zipWriteInFileInZip(file, vertexCosts.data(), vertexCosts.size() * sizeof(float));
+	zipWriteInFileInZip(file, vertexCosts, numVertexCosts * sizeof(float));
 
 	zipCloseFileInZip(file);
 	zipClose(file, nullptr);
@@ -1026,6 +1130,214 @@ void CPathEstimator::WriteFile(const std::string& baseFileName, const std::strin
 }
 
 
+
+/*
+ * uncompressed cache-file layout (all sizes and positions in bytes):
+ *   header, section table (one entry per path layer)
+ *   [page-aligned] block-offsets of every path layer
+ *   [page-aligned] vertex-costs of every path layer (contiguous, like vertexCosts)
+ * the vertex-cost region is mapped copy-on-write and used in place; the file
+ * is only trusted if its header matches and its data checksum is correct
+ */
+static constexpr std::uint32_t MAPPED_CACHE_VERSION = 1;
+static constexpr std::uint32_t MAPPED_CACHE_ALIGNMENT = 4096;
+static constexpr char MAPPED_CACHE_MAGIC[8] = {'S', 'P', 'R', 'P', 'E', 'C', 'C', '\0'};
+
+struct MappedCacheHeader {
+	char magic[8];
+	std::uint32_t version;
+	std::uint32_t fileHashCode;
+	std::uint32_t blockSize;
+	std::uint32_t numMoveDefs;
+	std::uint32_t numBlocks;
+	std::uint32_t dataChecksum; // over everything following the first aligned position
+	std::uint64_t dataPos;
+	std::uint64_t fileSize;
+};
+
+struct MappedCacheSection {
+	std::uint64_t offsetsPos;
+	std::uint64_t offsetsSize;
+	std::uint64_t costsPos;
+	std::uint64_t costsSize;
+};
+
+static std::uint64_t AlignMappedCachePos(std::uint64_t pos) {
+	return ((pos + MAPPED_CACHE_ALIGNMENT - 1) & ~std::uint64_t(MAPPED_CACHE_ALIGNMENT - 1));
+}
+
+static std::uint32_t CalcMappedCacheChecksum(const std::uint8_t* data, std::uint64_t size) {
+	std::uint32_t cs = 0;
+
+	// HsiehHash takes an int length
+	for (std::uint64_t pos = 0, len = 0; pos < size; pos += len) {
+		len = std::min(size - pos, std::uint64_t(1) << 30);
+		cs = HsiehHash(data + pos, len, cs);
+	}
+
+	return cs;
+}
+
+
+bool CPathEstimator::ReadMappedFile(const std::string& baseFileName, const std::string& mapName)
+{
+	const std::string cacheFileName = GetPathCacheFileName(mapName, baseFileName, fileHashCode, ".pecache");
+
+	if (!FileSystem::FileExists(cacheFileName))
+		return false;
+
+	LOG("[PathEstimator::%s] file=\"%s\"", __func__, cacheFileName.c_str());
+
+	const unsigned int numMoveDefs = moveDefHandler->GetNumPathLayers();
+	const unsigned int numBlocks = blockStates.GetSize();
+
+	const auto DiscardFile = [&]() {
+		mappedCacheFile.Close();
+		FileSystem::Remove(cacheFileName);
+		return false;
+	};
+
+	if (!mappedCacheFile.Open(dataDirsAccess.LocateFile(cacheFileName)))
+		return false;
+
+	const std::uint8_t* fileData = mappedCacheFile.GetData();
+	const std::uint64_t fileSize = mappedCacheFile.GetSize();
+
+	if (fileSize < (sizeof(MappedCacheHeader) + numMoveDefs * sizeof(MappedCacheSection)))
+		return (DiscardFile());
+
+	MappedCacheHeader header;
+	std::memcpy(&header, fileData, sizeof(header));
+
+	if (std::memcmp(header.magic, MAPPED_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != MAPPED_CACHE_VERSION)
+		return (DiscardFile());
+	if (header.fileHashCode != fileHashCode || header.blockSize != BLOCK_SIZE)
+		return (DiscardFile());
+	if (header.numMoveDefs != numMoveDefs || header.numBlocks != numBlocks)
+		return (DiscardFile());
+	if (header.fileSize != fileSize || header.dataPos > fileSize)
+		return (DiscardFile());
+
+	char calcMsg[512];
+	sprintf(calcMsg, "Reading Estimate PathCosts [%d]", BLOCK_SIZE);
+	loadscreen->SetLoadMessage(calcMsg);
+
+	if (CalcMappedCacheChecksum(fileData + header.dataPos, fileSize - header.dataPos) != header.dataChecksum)
+		return (DiscardFile());
+
+	const MappedCacheSection* sections = reinterpret_cast<const MappedCacheSection*>(fileData + sizeof(MappedCacheHeader));
+
+	const std::uint64_t offsetsSize = numBlocks * sizeof(short2);
+	const std::uint64_t costsSize = numBlocks * PATH_DIRECTION_VERTICES * sizeof(float);
+
+	for (unsigned int pathType = 0; pathType < numMoveDefs; pathType++) {
+		const MappedCacheSection& section = sections[pathType];
+
+		if (section.offsetsSize != offsetsSize || section.costsSize != costsSize)
+			return (DiscardFile());
+		if ((section.offsetsPos + offsetsSize) > fileSize || (section.costsPos + costsSize) > fileSize)
+			return (DiscardFile());
+		// costs are used in place, so must be contiguous and suitably aligned
+		if (section.costsPos != (sections[0].costsPos + pathType * costsSize) || (section.costsPos % sizeof(float)) != 0)
+			return (DiscardFile());
+	}
+
+	// offsets are small, copy them
+	for (unsigned int pathType = 0; pathType < numMoveDefs; pathType++) {
+		std::memcpy(&blockStates.peNodeOffsets[pathType][0], fileData + sections[pathType].offsetsPos, offsetsSize);
+	}
+
+	vertexCosts = reinterpret_cast<float*>(mappedCacheFile.GetData() + sections[0].costsPos);
+
+	// release the heap copy
+	vertexCostsMem.clear();
+	vertexCostsMem.shrink_to_fit();
+	return true;
+}
+
+bool CPathEstimator::WriteMappedFile(const std::string& baseFileName, const std::string& mapName)
+{
+	const std::string cacheFileName = GetPathCacheFileName(mapName, baseFileName, fileHashCode, ".pecache");
+	const std::string tempFileName = dataDirsAccess.LocateFile(cacheFileName + ".tmp", FileQueryFlags::WRITE);
+
+	LOG("[PathEstimator::%s] file=\"%s\"", __func__, cacheFileName.c_str());
+
+	const unsigned int numMoveDefs = moveDefHandler->GetNumPathLayers();
+	const unsigned int numBlocks = blockStates.GetSize();
+
+	const std::uint64_t offsetsSize = numBlocks * sizeof(short2);
+	const std::uint64_t costsSize = numBlocks * PATH_DIRECTION_VERTICES * sizeof(float);
+
+	MappedCacheHeader header;
+	std::vector<MappedCacheSection> sections(numMoveDefs);
+
+	std::memcpy(header.magic, MAPPED_CACHE_MAGIC, sizeof(header.magic));
+	header.version = MAPPED_CACHE_VERSION;
+	header.fileHashCode = fileHashCode;
+	header.blockSize = BLOCK_SIZE;
+	header.numMoveDefs = numMoveDefs;
+	header.numBlocks = numBlocks;
+	header.dataPos = AlignMappedCachePos(sizeof(MappedCacheHeader) + numMoveDefs * sizeof(MappedCacheSection));
+
+	const std::uint64_t costsPos = AlignMappedCachePos(header.dataPos + numMoveDefs * offsetsSize);
+
+	for (unsigned int pathType = 0; pathType < numMoveDefs; pathType++) {
+		sections[pathType].offsetsPos = header.dataPos + pathType * offsetsSize;
+		sections[pathType].offsetsSize = offsetsSize;
+		sections[pathType].costsPos = costsPos + pathType * costsSize;
+		sections[pathType].costsSize = costsSize;
+	}
+
+	header.fileSize = costsPos + numMoveDefs * costsSize;
+
+	// assemble the data region once to checksum it, then write it out
+	std::vector<std::uint8_t> data(header.fileSize - header.dataPos, 0);
+
+	for (unsigned int pathType = 0; pathType < numMoveDefs; pathType++) {
+		std::memcpy(&data[sections[pathType].offsetsPos - header.dataPos], blockStates.peNodeOffsets[pathType].data(), offsetsSize);
+	}
+
+	std::memcpy(&data[costsPos - header.dataPos], vertexCosts, numVertexCosts * sizeof(float));
+
+	header.dataChecksum = CalcMappedCacheChecksum(data.data(), data.size());
+
+	{
+		std::ofstream file(tempFileName, std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+			return false;
+
+		const std::vector<char> padding(header.dataPos - (sizeof(MappedCacheHeader) + numMoveDefs * sizeof(MappedCacheSection)), 0);
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(sections.data()), numMoveDefs * sizeof(MappedCacheSection));
+		file.write(padding.data(), padding.size());
+		file.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+		if (!file.good()) {
+			file.close();
+			FileSystem::Remove(tempFileName);
+			return false;
+		}
+	}
+
+	const std::string destFileName = dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE);
+
+	#ifdef _WIN32
+	// rename does not replace existing files here
+	FileSystem::Remove(destFileName);
+	#endif
+
+	// other instances must never see a partially written file
+	if (std::rename(tempFileName.c_str(), destFileName.c_str()) != 0) {
+		FileSystem::Remove(tempFileName);
+		return false;
+	}
+
+	return true;
+}
+
+
 std::uint32_t CPathEstimator::CalcChecksum() const
 {
 	std::uint32_t cs = 0;
@@ -1049,14 +1361,14 @@ std::uint32_t CPathEstimator::CalcChecksum() const
 		#endif
 	}
 
-	nb = vertexCosts.size() * sizeof(float);
-	cs = HsiehHash(vertexCosts.data(), nb, cs);
+	nb = numVertexCosts * sizeof(float);
+	cs = HsiehHash(vertexCosts, nb, cs);
 
 	#if (ENABLE_NETLOG_CHECKSUM == 1)
 	{
 		rawBytes.resize(rawBytes.size() + nb);
 
-		std::memcpy(&rawBytes[rawBytes.size() - nb], vertexCosts.data(), nb);
+		std::memcpy(&rawBytes[rawBytes.size() - nb], vertexCosts, nb);
 		sha512::calc_digest(rawBytes, shaBytes); // hash(offsets|costs)
 		sha512::dump_digest(shaBytes, hexChars); // hexify(hash)
 
@@ -14,6 +14,7 @@
 #include "PathConstants.h"
 #include "PathDataTypes.h"
 #include "System/float3.h"
+#include "System/FileSystem/MappedFile.h"
 #include "System/Threading/SpringThreading.h"
 
 
@@ -57,6 +58,15 @@ public:
 	 */
 	void Update();
 
+	/**
+	 * Raises the update priority of the obsolete blocks the (synced)
+	 * path runs through, s.t. they are updated before untouched ones.
+	 */
+	void AddBlockDemand(const IPath::Path& path);
+
+	/// number of frames the longest-waiting obsolete block has been queued
+	int GetMaxQueuedBlockAge() const;
+
 	IPathFinder* GetParent() override { return parentPathFinder; }
 
 	/**
@@ -114,6 +124,8 @@ private:
 
 	bool ReadFile(const std::string& baseFileName, const std::string& mapName);
 	void WriteFile(const std::string& baseFileName, const std::string& mapName);
+	bool ReadMappedFile(const std::string& baseFileName, const std::string& mapName);
+	bool WriteMappedFile(const std::string& baseFileName, const std::string& mapName);
 
 	std::uint32_t CalcChecksum() const;
 	std::uint32_t CalcHash(const char* caller) const;
@@ -136,14 +148,33 @@ private:
 	IPathFinder* parentPathFinder; // parent (PF if BLOCK_SIZE is 16, PE[16] if 32)
 	CPathEstimator* nextPathEstimator; // next lower-resolution estimator
 	CPathCache* pathCache[2]; // [0] = !synced, [1] = synced
+	/// per-waypoint block-indices and g-costs of the path passed to AddCache
+	std::vector<int> corridorBlockIdcs;
+	std::vector<float> corridorPathCosts;
 
 	std::vector<IPathFinder*> pathFinders; // InitEstimator helpers
 	std::vector<spring::thread> threads;
 
 	std::vector<float> maxSpeedMods;
-	std::vector<float> vertexCosts;
+	/// points into vertexCostsMem or into the mapped cache-file
+	float* vertexCosts;
+	size_t numVertexCosts;
+
+	std::vector<float> vertexCostsMem;
+	CMappedFile mappedCacheFile;
+	struct QueuedBlock {
+		int2 blockPos;
+		int queueFrame;
+		unsigned int queueIndex; // FIFO order among blocks with equal demand
+		QueuedBlock(const int2& pos, int frame, unsigned int index) : blockPos(pos), queueFrame(frame), queueIndex(index) {}
+	};
+
 	/// blocks that may need an update due to map changes
-	std::deque<int2> updatedBlocks;
+	std::deque<QueuedBlock> updatedBlocks;
+	/// per-block count of synced paths that ran through it, halved periodically
+	std::vector<std::uint16_t> blockDemand;
+
+	unsigned int numQueuedBlocks;
 
 	int blockUpdatePenalty;
 
@@ -14,6 +14,7 @@
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "System/Log/ILog.h"
 #include "System/TimeProfiler.h"
+#include "System/Threading/ThreadPool.h"
 
 
 
@@ -47,6 +48,10 @@ CPathManager::~CPathManager()
 	peMemPool.free(medResPE);
 	pfMemPool.free(maxResPF);
 
+	for (CPathFinder* pf: maxResPFs) {
+		pfMemPool.free(pf);
+	}
+
 	PathHeatMap::FreeInstance(pathHeatMap);
 	PathFlowMap::FreeInstance(pathFlowMap);
 	IPathFinder::KillStatic();
@@ -109,20 +114,66 @@ void CPathManager::FinalizePath(MultiPath* path, const float3 startPos, const fl
 }
 
 
+// choose the PF or the PE depending on the projected 2D goal-distance
+// NOTE: this distance can be far smaller than the actual path length!
+// NOTE: take height difference into consideration for "special" cases
+// (unit at top of cliff, goal at bottom or vv.)
+static float GetHeurGoalDist2D(const CPathFinderDef* pfDef, const float3& startPos, const float3& goalPos) {
+	return (pfDef->Heuristic(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE, 1) + math::fabs(goalPos.y - startPos.y) / SQUARE_SIZE);
+}
+
+
+// runs the searches that only involve the max-res PF, before ArrangePath
+// (Error if none were in range); safe to call from any thread given a
+// private thread-safe <pathFinder>
+IPath::SearchResult CPathManager::ArrangeMaxResPath(
+	MultiPath* newPath,
+	const MoveDef* moveDef,
+	const float3& startPos,
+	const float3& goalPos,
+	const CSolidObject* caller,
+	CPathFinder* pathFinder
+) const {
+	CPathFinderDef* pfDef = &newPath->peDef;
+	IPath::Path* maxResPath = &newPath->maxResPath;
+
+	const float heurGoalDist2D = GetHeurGoalDist2D(pfDef, startPos, goalPos);
+	constexpr unsigned int nodeLimit = MAX_SEARCHED_NODES_PF >> 3;
+
+	IPath::SearchResult bestResult = IPath::Error;
+
+	if (heurGoalDist2D <= (MAXRES_SEARCH_DISTANCE * modInfo.pfRawDistMult)) {
+		pfDef->AllowRawPathSearch( true);
+		pfDef->AllowDefPathSearch(false); // block default search
+
+		// only the max-res CPathFinder implements DoRawSearch
+		bestResult = pathFinder->GetPath(*moveDef, *pfDef, caller, startPos, *maxResPath, nodeLimit);
+
+		pfDef->AllowRawPathSearch(false);
+		pfDef->AllowDefPathSearch( true);
+	}
+
+	if (bestResult == IPath::Ok || heurGoalDist2D > MAXRES_SEARCH_DISTANCE)
+		return bestResult;
+
+	// constraints are disabled since these break search completeness
+	pfDef->DisableConstraint(true);
+	pfDef->AllowRawPathSearch(false);
+
+	return (std::min(bestResult, pathFinder->GetPath(*moveDef, *pfDef, caller, startPos, *maxResPath, nodeLimit)));
+}
+
 IPath::SearchResult CPathManager::ArrangePath(
 	MultiPath* newPath,
 	const MoveDef* moveDef,
 	const float3& startPos,
 	const float3& goalPos,
-	CSolidObject* caller
+	CSolidObject* caller,
+	IPath::SearchResult maxResResult
 ) const {
 	CPathFinderDef* pfDef = &newPath->peDef;
 
-	// choose the PF or the PE depending on the projected 2D goal-distance
-	// NOTE: this distance can be far smaller than the actual path length!
-	// NOTE: take height difference into consideration for "special" cases
-	// (unit at top of cliff, goal at bottom or vv.)
-	const float heurGoalDist2D = pfDef->Heuristic(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE, 1) + math::fabs(goalPos.y - startPos.y) / SQUARE_SIZE;
+	const float heurGoalDist2D = GetHeurGoalDist2D(pfDef, startPos, goalPos);
 	const float searchDistances[] = {std::numeric_limits<float>::max(), MEDRES_SEARCH_DISTANCE, MAXRES_SEARCH_DISTANCE};
 
 	// MAX_SEARCHED_NODES_PF is 65536, MAXRES_SEARCH_DISTANCE is 50 squares
@@ -141,55 +192,45 @@ IPath::SearchResult CPathManager::ArrangePath(
 	IPathFinder* pathFinders[] = {lowResPE, medResPE, maxResPF};
 	IPath::Path* pathObjects[] = {&newPath->lowResPath, &newPath->medResPath, &newPath->maxResPath};
 
-	IPath::SearchResult bestResult = IPath::Error;
+	IPath::SearchResult bestResult = maxResResult;
 
 #if 1
 
-	unsigned int bestSearch = -1u; // index
-
 	enum {
 		PATH_LOW_RES = 0,
 		PATH_MED_RES = 1,
 		PATH_MAX_RES = 2,
 	};
 
-	{
-		if (heurGoalDist2D <= (MAXRES_SEARCH_DISTANCE * modInfo.pfRawDistMult)) {
-			pfDef->AllowRawPathSearch( true);
-			pfDef->AllowDefPathSearch(false); // block default search
-
-			// only the max-res CPathFinder implements DoRawSearch
-			bestResult = pathFinders[PATH_MAX_RES]->GetPath(*moveDef, *pfDef, caller, startPos, *pathObjects[PATH_MAX_RES], nodeLimits[PATH_MAX_RES]);
-			bestSearch = PATH_MAX_RES;
+	// index; the max-res searches were already done by ArrangeMaxResPath
+	unsigned int bestSearch = (bestResult != IPath::Error)? PATH_MAX_RES: -1u;
 
-			pfDef->AllowRawPathSearch(false);
-			pfDef->AllowDefPathSearch( true);
-		}
+	if (bestResult == IPath::Ok)
+		return bestResult;
 
-		if (bestResult != IPath::Ok) {
-			// try each pathfinder in order from MAX to LOW limited by distance,
-			// with constraints disabled for all three since these break search
-			// completeness (CPU usage is still limited by MAX_SEARCHED_NODES_*)
-			for (int n = PATH_MAX_RES; n >= PATH_LOW_RES; n--) {
-				// distance-limits are in ascending order
-				if (heurGoalDist2D > searchDistances[n])
-					continue;
+	{
+		// try each estimator in order from MED to LOW limited by distance,
+		// with constraints disabled for both since these break search
+		// completeness (CPU usage is still limited by MAX_SEARCHED_NODES_*)
+		for (int n = PATH_MED_RES; n >= PATH_LOW_RES; n--) {
+			// distance-limits are in ascending order
+			if (heurGoalDist2D > searchDistances[n])
+				continue;
 
-				pfDef->DisableConstraint(!useConstraints[n]);
-				pfDef->AllowRawPathSearch(allowRawSearch[n]);
+			pfDef->DisableConstraint(!useConstraints[n]);
+			pfDef->AllowRawPathSearch(allowRawSearch[n]);
 
-				const IPath::SearchResult currResult = pathFinders[n]->GetPath(*moveDef, *pfDef, caller, startPos, *pathObjects[n], nodeLimits[n]);
+			const IPath::SearchResult currResult = pathFinders[n]->GetPath(*moveDef, *pfDef, caller, startPos, *pathObjects[n], nodeLimits[n]);
 
-				// note: GEQ s.t. MED-OK will be preferred over LOW-OK, etc
-				if (currResult >= bestResult)
-					continue;
+			// note: GEQ s.t. MED-OK will be preferred over LOW-OK, etc
+			if (currResult >= bestResult)
+				continue;
 
-				bestResult = currResult;
-				bestSearch = n;
+			bestResult = currResult;
+			bestSearch = n;
 
-				if (currResult == IPath::Ok)
-					break;
-			}
+			if (currResult == IPath::Ok)
+				break;
 		}
 	}
 
@@ -329,6 +370,52 @@ IPath::SearchResult CPathManager::ArrangePath(
 }
 
 
+// estimator searches for requests with (nearly) the same start, goal and
+// MoveDef made during one frame, e.g. for mass move orders, have the same
+// result; the group shares the low- and med-res path of its first member
+// and RefinePath computes a max-res connector from each member's own start
+IPath::SearchResult CPathManager::ArrangeGroupPath(MultiPath* newPath, IPath::SearchResult maxResResult)
+{
+	if (!modInfo.pfShareGroupPaths || maxResResult == IPath::Ok || newPath->caller == nullptr)
+		return (ArrangePath(newPath, newPath->moveDef, newPath->start, newPath->finalGoal, newPath->caller, maxResResult));
+
+	for (const GroupPath& groupPath: groupPaths) {
+		if (groupPath.pathType != newPath->moveDef->pathType || groupPath.synced != newPath->peDef.synced)
+			continue;
+		if (groupPath.goal.SqDistance2D(newPath->finalGoal) > Square(MEDRES_PE_BLOCKSIZE * SQUARE_SIZE * 0.5f))
+			continue;
+
+		// a low-res path is refined into med-res waypoints first, so allows a larger start offset
+		const float maxStartDist = groupPath.lowResPath.path.empty()? MAXRES_SEARCH_DISTANCE_EXT: MEDRES_SEARCH_DISTANCE_EXT;
+
+		if (groupPath.start.SqDistance2D(newPath->start) > Square(maxStartDist))
+			continue;
+
+		newPath->lowResPath = groupPath.lowResPath;
+		newPath->medResPath = groupPath.medResPath;
+		newPath->maxResPath.path.clear();
+		newPath->maxResPath.squares.clear();
+		return IPath::Ok;
+	}
+
+	CSolidObject* caller = newPath->caller;
+	const IPath::SearchResult result = ArrangePath(newPath, newPath->moveDef, newPath->start, newPath->finalGoal, caller, maxResResult);
+
+	// only complete estimator paths are shared
+	if (result != IPath::Ok || !newPath->maxResPath.path.empty())
+		return result;
+
+	groupPaths.emplace_back();
+	groupPaths.back().lowResPath = newPath->lowResPath;
+	groupPaths.back().medResPath = newPath->medResPath;
+	groupPaths.back().start = newPath->start;
+	groupPaths.back().goal = newPath->finalGoal;
+	groupPaths.back().pathType = newPath->moveDef->pathType;
+	groupPaths.back().synced = newPath->peDef.synced;
+	return result;
+}
+
+
 /*
 Request a new multipath, store the result and return a handle-id to it.
 */
@@ -345,6 +432,8 @@ unsigned int CPathManager::RequestPath(
 
 	// in misc since it is called from many points
 	SCOPED_TIMER("Misc::Path::RequestPath");
+	numRequestedPaths.fetch_add(1, std::memory_order_relaxed);
+
 	startPos.ClampInBounds();
 	goalPos.ClampInBounds();
 
@@ -357,33 +446,27 @@ unsigned int CPathManager::RequestPath(
 	newPath.caller = caller;
 	newPath.peDef.synced = synced;
 
+	// move-type requests are deferred to the next Update if so configured,
+	// the caller gets temporary waypoints from NextWayPoint until then (Lua
+	// and AI requests always need their result immediately)
+	if (modInfo.pfQueueRequests && caller != nullptr && synced) {
+		newPath.queued = true;
+
+		const unsigned int pathID = Store(newPath);
+
+		queuedPathIDs.push_back(pathID);
+		return pathID;
+	}
+
 	if (caller != nullptr)
 		caller->UnBlock();
 
-	const IPath::SearchResult result = ArrangePath(&newPath, moveDef, startPos, goalPos, caller);
+	const IPath::SearchResult result = ArrangeGroupPath(&newPath, ArrangeMaxResPath(&newPath, moveDef, startPos, goalPos, caller, maxResPF));
 
 	unsigned int pathID = 0;
 
 	if (result != IPath::Error) {
-		if (newPath.maxResPath.path.empty()) {
-			if (result != IPath::CantGetCloser) {
-				LowRes2MedRes(newPath, startPos, caller, synced);
-				MedRes2MaxRes(newPath, startPos, caller, synced);
-			} else {
-				// add one dummy waypoint so that the calling MoveType
-				// does not consider this request a failure, which can
-				// happen when startPos is very close to goalPos
-				//
-				// otherwise, code relying on MoveType::progressState
-				// (eg. BuilderCAI::MoveInBuildRange) would misbehave
-				// (eg. reject build orders)
-				newPath.maxResPath.path.push_back(startPos);
-				newPath.maxResPath.squares.push_back(int2(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE));
-			}
-		}
-
-		FinalizePath(&newPath, startPos, goalPos, result == IPath::CantGetCloser);
-		newPath.searchResult = result;
+		RefinePath(newPath, result);
 		pathID = Store(newPath);
 	}
 
@@ -393,6 +476,105 @@ unsigned int CPathManager::RequestPath(
 	return pathID;
 }
 
+void CPathManager::RefinePath(MultiPath& path, IPath::SearchResult result) const
+{
+	const float3& startPos = path.start;
+	const float3& goalPos = path.finalGoal;
+
+	// obsolete blocks on synced paths are updated first
+	if (path.peDef.synced) {
+		medResPE->AddBlockDemand(path.medResPath);
+		lowResPE->AddBlockDemand(path.lowResPath);
+	}
+
+	if (path.maxResPath.path.empty()) {
+		if (result != IPath::CantGetCloser) {
+			LowRes2MedRes(path, startPos, path.caller, path.peDef.synced);
+			MedRes2MaxRes(path, startPos, path.caller, path.peDef.synced);
+		} else {
+			// add one dummy waypoint so that the calling MoveType
+			// does not consider this request a failure, which can
+			// happen when startPos is very close to goalPos
+			//
+			// otherwise, code relying on MoveType::progressState
+			// (eg. BuilderCAI::MoveInBuildRange) would misbehave
+			// (eg. reject build orders)
+			path.maxResPath.path.push_back(startPos);
+			path.maxResPath.squares.push_back(int2(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE));
+		}
+	}
+
+	FinalizePath(&path, startPos, goalPos, result == IPath::CantGetCloser);
+	path.searchResult = result;
+}
+
+void CPathManager::UpdateQueuedPaths()
+{
+	if (queuedPathIDs.empty())
+		return;
+
+	SCOPED_TIMER("Sim::Path::Queued");
+
+	queuedPaths.clear();
+	queuedPaths.reserve(queuedPathIDs.size());
+
+	// requests deleted before being processed are skipped
+	for (const unsigned int pathID: queuedPathIDs) {
+		MultiPath* multiPath = GetMultiPath(pathID);
+
+		if (multiPath == nullptr)
+			continue;
+
+		queuedPaths.push_back(multiPath);
+	}
+
+	queuedPathIDs.clear();
+	queuedResults.clear();
+	queuedResults.resize(queuedPaths.size(), IPath::Error);
+
+	// maxResPF is not thread-safe, so each thread gets its own PF (sharing
+	// the extra costs of maxResPF) for the max-res searches; these are the
+	// only independent ones since PE's have path-caches and shared state
+	while (maxResPFs.size() < size_t(ThreadPool::GetNumThreads())) {
+		maxResPFs.push_back(pfMemPool.alloc<CPathFinder>(true));
+	}
+
+	for (CPathFinder* pf: maxResPFs) {
+		pf->GetNodeStateBuffer().ShareNodeExtraCosts(maxResPF->GetNodeStateBuffer());
+	}
+
+	for_mt(0, queuedPaths.size(), [&](const int i) {
+		MultiPath* multiPath = queuedPaths[i];
+		CPathFinder* pathFinder = maxResPFs[ThreadPool::GetThreadNum()];
+
+		// callers stay blocked, but never block their own searches
+		queuedResults[i] = ArrangeMaxResPath(multiPath, multiPath->moveDef, multiPath->start, multiPath->finalGoal, multiPath->caller, pathFinder);
+	});
+
+	// finish the remaining (estimator) searches in request order
+	for (size_t i = 0, n = queuedPaths.size(); i < n; i++) {
+		MultiPath* multiPath = queuedPaths[i];
+		CSolidObject* caller = multiPath->caller;
+
+		if (queuedResults[i] != IPath::Ok) {
+			caller->UnBlock();
+			queuedResults[i] = ArrangeGroupPath(multiPath, queuedResults[i]);
+			caller->Block();
+		}
+
+		multiPath->queued = false;
+
+		// failed requests keep their ID but have no waypoints, NextWayPoint
+		// will return the no-path point for them
+		if (queuedResults[i] == IPath::Error)
+			continue;
+
+		caller->UnBlock();
+		RefinePath(*multiPath, queuedResults[i]);
+		caller->Block();
+	}
+}
+
 
 // converts part of a med-res path into a max-res path
 void CPathManager::MedRes2MaxRes(MultiPath& multiPath, const float3& startPos, const CSolidObject* owner, bool synced) const
@@ -505,6 +687,14 @@ float3 CPathManager::NextWayPoint(
 	if (multiPath == nullptr)
 		return noPathPoint;
 
+	if (multiPath->queued) {
+		// request has not been processed yet; send the caller a short
+		// distance toward its goal to hide latency (the y-coordinate
+		// marks this as a temporary waypoint, see QTPFS)
+		const float3 targetDirec = (multiPath->finalGoal - callerPos).SafeNormalize2D() * SQUARE_SIZE;
+		return (float3(callerPos.x + targetDirec.x, -1.0f, callerPos.z + targetDirec.z));
+	}
+
 	if (numRetries > MAX_PATH_REFINEMENT_DEPTH)
 		return (multiPath->finalGoal);
 
@@ -574,7 +764,6 @@ float3 CPathManager::NextWayPoint(
 	} while ((callerPos.SqDistance2D(waypoint) < Square(radius)) && (waypoint != maxResPath.pathGoal));
 
 	// y=0 indicates this is not a temporary waypoint
-	// (the default PFS does not queue path-requests)
 	return (waypoint * XZVector);
 }
 
@@ -584,6 +773,9 @@ void CPathManager::TerrainChange(unsigned int x1, unsigned int z1, unsigned int
 	if (!IsFinalized())
 		return;
 
+	// group paths are only valid for an unchanged map
+	groupPaths.clear();
+
 	medResPE->MapChanged(x1, z1, x2, z2);
 
 	// low-res PE will be informed via (medRes)PE::Update
@@ -600,11 +792,16 @@ void CPathManager::Update()
 	SCOPED_TIMER("Sim::Path");
 	assert(IsFinalized());
 
+	// group paths are shared only among same-frame requests
+	groupPaths.clear();
+
 	pathFlowMap->Update();
 	pathHeatMap->Update();
 
 	medResPE->Update();
 	lowResPE->Update();
+
+	UpdateQueuedPaths();
 }
 
 // used to deposit heat on the heat-map as a unit moves along its path
@@ -775,3 +972,14 @@ int2 CPathManager::GetNumQueuedUpdates() const {
 	return data;
 }
 
+int2 CPathManager::GetQueuedUpdateAges() const {
+	int2 data;
+
+	if (IsFinalized()) {
+		data.x = medResPE->GetMaxQueuedBlockAge();
+		data.y = lowResPE->GetMaxQueuedBlockAge();
+	}
+
+	return data;
+}
+
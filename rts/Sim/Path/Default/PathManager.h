@@ -4,6 +4,7 @@
 #define PATHMANAGER_H
 
 #include <cinttypes>
+#include <vector>
 
 #include "Sim/Path/IPathManager.h"
 #include "IPath.h"
@@ -90,16 +91,18 @@ public:
 	const float* GetNodeExtraCosts(bool) const override;
 
 	int2 GetNumQueuedUpdates() const override;
+	int2 GetQueuedUpdateAges() const override;
 
 private:
 	struct MultiPath {
-		MultiPath(): moveDef(nullptr), caller(nullptr) {}
+		MultiPath(): moveDef(nullptr), caller(nullptr), queued(false) {}
 		MultiPath(const MoveDef* moveDef, const float3& startPos, const float3& goalPos, float goalRadius)
 			: searchResult(IPath::Error)
 			, start(startPos)
 			, peDef(startPos, goalPos, goalRadius, 3.0f, 2000)
 			, moveDef(moveDef)
 			, caller(nullptr)
+			, queued(false)
 		{}
 
 		MultiPath(const MultiPath& mp) = delete;
@@ -119,6 +122,7 @@ private:
 			peDef   = mp.peDef;
 			moveDef = mp.moveDef;
 			caller  = mp.caller;
+			queued  = mp.queued;
 
 			mp.moveDef = nullptr;
 			mp.caller  = nullptr;
@@ -142,6 +146,21 @@ private:
 
 		// additional information
 		CSolidObject* caller;
+
+		// true until the search for a queued request has been run
+		bool queued;
+	};
+
+	// estimator paths shared among requests made in the same frame
+	struct GroupPath {
+		IPath::Path lowResPath;
+		IPath::Path medResPath;
+
+		float3 start;
+		float3 goal;
+
+		unsigned int pathType;
+		bool synced;
 	};
 
 private:
@@ -150,8 +169,22 @@ private:
 		const MoveDef* moveDef,
 		const float3& startPos,
 		const float3& goalPos,
-		CSolidObject* caller
+		CSolidObject* caller,
+		IPath::SearchResult maxResResult
 	) const;
+	IPath::SearchResult ArrangeMaxResPath(
+		MultiPath* newPath,
+		const MoveDef* moveDef,
+		const float3& startPos,
+		const float3& goalPos,
+		const CSolidObject* caller,
+		CPathFinder* pathFinder
+	) const;
+
+	IPath::SearchResult ArrangeGroupPath(MultiPath* newPath, IPath::SearchResult maxResResult);
+
+	void RefinePath(MultiPath& path, IPath::SearchResult result) const;
+	void UpdateQueuedPaths();
 
 	MultiPath* GetMultiPath(int pathID) { return (const_cast<MultiPath*>(GetMultiPathConst(pathID))); }
 
@@ -180,11 +213,21 @@ private:
 	CPathEstimator* medResPE;
 	CPathEstimator* lowResPE;
 
+	// thread-safe copies of maxResPF, one per thread; only used for queued requests
+	std::vector<CPathFinder*> maxResPFs;
+
 	PathFlowMap* pathFlowMap;
 	PathHeatMap* pathHeatMap;
 
 	spring::unordered_map<unsigned int, MultiPath> pathMap;
 
+	// requests deferred to the next Update when pathFinderQueueRequests is enabled
+	std::vector<unsigned int> queuedPathIDs;
+	std::vector<MultiPath*> queuedPaths;
+	std::vector<IPath::SearchResult> queuedResults;
+
+	std::vector<GroupPath> groupPaths;
+
 	unsigned int nextPathID;
 };
 
@@ -3,6 +3,7 @@
 #ifndef I_PATH_MANAGER_H
 #define I_PATH_MANAGER_H
 
+#include <atomic>
 #include <vector>
 #include <cinttypes>
 
@@ -164,6 +165,14 @@ public:
 	virtual const float* GetNodeExtraCosts(bool synced) const { return NULL; }
 
 	virtual int2 GetNumQueuedUpdates() const { return (int2(0, 0)); }
+	/// age in frames of the oldest queued update
+	virtual int2 GetQueuedUpdateAges() const { return (int2(0, 0)); }
+
+	/// RequestPath calls since construction (including failed ones)
+	unsigned int GetNumPathRequests() const { return numRequestedPaths.load(std::memory_order_relaxed); }
+
+protected:
+	std::atomic<unsigned int> numRequestedPaths = {0};
 };
 
 extern IPathManager* pathManager;
@@ -222,41 +222,35 @@ QTPFS::QTNode::QTNode(
 	moveCostAvg = -1.0f;
 
 	prevNode = NULL;
+	pathPoint = ZeroVector;
 
-	// for leafs, all children remain NULL
-	children.fill(NULL);
-}
-
-void QTPFS::QTNode::Delete() {
-	if (!IsLeaf()) {
-		for (unsigned int i = 0; i < children.size(); i++) {
-			children[i]->Delete(); children[i] = NULL;
-		}
-	}
+	// for leafs, this remains -1
+	childIndex = -1u;
 
-	delete this;
+	ngbsIndex    = 0;
+	numNeighbors = 0;
+	maxNeighbors = 0;
 }
 
+// releases all descendants and the neighbor-cache, but not <this>
+// (nodes are owned by the pool, which frees our children's block)
+void QTPFS::QTNode::Delete(NodeLayer& nl) {
+	ClearNeighborCache(nl);
 
+	if (IsLeaf())
+		return;
 
-std::uint64_t QTPFS::QTNode::GetMemFootPrint() const {
-	std::uint64_t memFootPrint = sizeof(QTNode);
-
-	if (IsLeaf()) {
-		memFootPrint += (neighbors.size() * sizeof(INode*));
-		// already counted; std::array<> statically allocates
-		// memFootPrint += (children.size() * sizeof(QTNode*));
-		memFootPrint += (netpoints.size() * sizeof(float3));
-	} else {
-		for (unsigned int i = 0; i < children.size(); i++) {
-			memFootPrint += (children[i]->GetMemFootPrint());
-		}
+	for (unsigned int i = 0; i < QTNODE_CHILD_COUNT; i++) {
+		GetChild(nl, i)->Delete(nl);
 	}
 
-	return memFootPrint;
+	nl.FreeChildNodes(childIndex);
+	childIndex = -1u;
 }
 
-std::uint64_t QTPFS::QTNode::GetCheckSum() const {
+
+
+std::uint64_t QTPFS::QTNode::GetCheckSum(const NodeLayer& nl) const {
 	std::uint64_t sum = 0;
 
 	{
@@ -283,8 +277,8 @@ std::uint64_t QTPFS::QTNode::GetCheckSum() const {
 	}
 
 	if (!IsLeaf()) {
-		for (unsigned int n = 0; n < children.size(); n++) {
-			sum ^= (((nodeNumber << 8) + 1) * children[n]->GetCheckSum());
+		for (unsigned int n = 0; n < QTNODE_CHILD_COUNT; n++) {
+			sum ^= (((nodeNumber << 8) + 1) * GetChild(nl, n)->GetCheckSum(nl));
 		}
 	}
 
@@ -293,13 +287,20 @@ std::uint64_t QTPFS::QTNode::GetCheckSum() const {
 
 
 
+const QTPFS::QTNode* QTPFS::QTNode::GetChild(const NodeLayer& nl, unsigned int i) const {
+	assert(!IsLeaf());
+	assert(i < QTNODE_CHILD_COUNT);
+	return (nl.GetPoolNode(childIndex + i));
+}
+
+QTPFS::QTNode* QTPFS::QTNode::GetChild(NodeLayer& nl, unsigned int i) {
+	assert(!IsLeaf());
+	assert(i < QTNODE_CHILD_COUNT);
+	return (nl.GetPoolNode(childIndex + i));
+}
+
 bool QTPFS::QTNode::IsLeaf() const {
-	assert(children.size() == QTNODE_CHILD_COUNT);
-	assert(
-		(children[0] == NULL && children[1] == NULL && children[2] == NULL && children[3] == NULL) ||
-		(children[0] != NULL && children[1] != NULL && children[2] != NULL && children[3] != NULL)
-	);
-	return (children[0] == NULL);
+	return (childIndex == -1u);
 }
 
 bool QTPFS::QTNode::CanSplit(bool forced) const {
@@ -330,19 +331,13 @@ bool QTPFS::QTNode::Split(NodeLayer& nl, bool forced) {
 	if (!CanSplit(forced))
 		return false;
 
-	neighbors.clear();
-	netpoints.clear();
+	ClearNeighborCache(nl);
 
-	// can only split leaf-nodes (ie. nodes with NULL-children)
-	assert(children[NODE_IDX_TL] == NULL);
-	assert(children[NODE_IDX_TR] == NULL);
-	assert(children[NODE_IDX_BR] == NULL);
-	assert(children[NODE_IDX_BL] == NULL);
+	// can only split leaf-nodes (ie. nodes without children)
+	assert(IsLeaf());
 
-	children[NODE_IDX_TL] = new QTNode(this, GetChildID(NODE_IDX_TL),  xmin(), zmin(),  xmid(), zmid());
-	children[NODE_IDX_TR] = new QTNode(this, GetChildID(NODE_IDX_TR),  xmid(), zmin(),  xmax(), zmid());
-	children[NODE_IDX_BR] = new QTNode(this, GetChildID(NODE_IDX_BR),  xmid(), zmid(),  xmax(), zmax());
-	children[NODE_IDX_BL] = new QTNode(this, GetChildID(NODE_IDX_BL),  xmin(), zmid(),  xmid(), zmax());
+	// NOTE: pool-growth does not move existing nodes, <this> stays valid
+	childIndex = nl.AllocChildNodes(this);
 
 	nl.SetNumLeafNodes(nl.GetNumLeafNodes() + (4 - 1));
 	assert(!IsLeaf());
@@ -354,13 +349,16 @@ bool QTPFS::QTNode::Merge(NodeLayer& nl) {
 		return false;
 	}
 
-	neighbors.clear();
+	ClearNeighborCache(nl);
 
 	// get rid of our children completely, but not of <this>!
-	for (unsigned int i = 0; i < children.size(); i++) {
-		children[i]->Delete(); children[i] = NULL;
+	for (unsigned int i = 0; i < QTNODE_CHILD_COUNT; i++) {
+		GetChild(nl, i)->Delete(nl);
 	}
 
+	nl.FreeChildNodes(childIndex);
+	childIndex = -1u;
+
 	nl.SetNumLeafNodes(nl.GetNumLeafNodes() - (4 - 1));
 	assert(IsLeaf());
 	return true;
@@ -383,10 +381,10 @@ bool QTPFS::QTNode::Merge(NodeLayer& nl) {
 		bool cont = false;
 
 		if (!IsLeaf()) {
-			for (unsigned int i = 0; i < children.size(); i++) {
-				if ((cont |= (children[i]->GetRectangleRelation(r) == REL_RECT_INTERIOR_NODE))) {
+			for (unsigned int i = 0; i < QTNODE_CHILD_COUNT; i++) {
+				if ((cont |= (GetChild(nl, i)->GetRectangleRelation(r) == REL_RECT_INTERIOR_NODE))) {
 					// only need to descend down one branch
-					children[i]->PreTesselate(nl, r, ur);
+					GetChild(nl, i)->PreTesselate(nl, r, ur);
 					break;
 				}
 			}
@@ -440,8 +438,8 @@ bool QTPFS::QTNode::Merge(NodeLayer& nl) {
 			return;
 		}
 
-		for (unsigned int i = 0; i < children.size(); i++) {
-			children[i]->PreTesselate(nl, cr, ur);
+		for (unsigned int i = 0; i < QTNODE_CHILD_COUNT; i++) {
+			GetChild(nl, i)->PreTesselate(nl, cr, ur);
 		}
 	}
 
@@ -487,8 +485,8 @@ void QTPFS::QTNode::Tesselate(NodeLayer& nl, const SRectangle& r) {
 	if ((wantSplit && Split(nl, false)) || (needSplit && Split(nl, true))) {
 		registerNode = false;
 
-		for (unsigned int i = 0; i < children.size(); i++) {
-			QTNode* cn = children[i];
+		for (unsigned int i = 0; i < QTNODE_CHILD_COUNT; i++) {
+			QTNode* cn = GetChild(nl, i);
 			SRectangle cr = cn->ClipRectangle(r);
 
 			cn->Tesselate(nl, cr);
@@ -674,36 +672,35 @@ void QTPFS::QTNode::Serialize(std::fstream& fStream, NodeLayer& nodeLayer, unsig
 	}
 
 	for (unsigned int i = 0; i < numChildren; i++) {
-		children[i]->Serialize(fStream, nodeLayer, streamSize, readMode);
+		GetChild(nodeLayer, i)->Serialize(fStream, nodeLayer, streamSize, readMode);
 	}
 }
 
-unsigned int QTPFS::QTNode::GetNeighbors(const std::vector<INode*>& nodes, std::vector<INode*>& ngbs) {
+QTPFS::INode* const* QTPFS::QTNode::GetNeighbors(NodeLayer& nl) {
 	#ifdef QTPFS_CONSERVATIVE_NEIGHBOR_CACHE_UPDATES
-	UpdateNeighborCache(nodes);
+	UpdateNeighborCache(nl);
 	#endif
+	return (nl.GetNeighbors(ngbsIndex));
+}
 
-	if (!neighbors.empty()) {
-		ngbs.clear();
-		ngbs.resize(neighbors.size());
-
-		std::copy(neighbors.begin(), neighbors.end(), ngbs.begin());
-	}
-
-	return (neighbors.size());
+const float3* QTPFS::QTNode::GetNeighborEdgeTransitionPoints(const NodeLayer& nl) const {
+	return (nl.GetNetpoints(ngbsIndex));
 }
 
-const std::vector<QTPFS::INode*>& QTPFS::QTNode::GetNeighbors(const std::vector<INode*>& nodes) {
-	#ifdef QTPFS_CONSERVATIVE_NEIGHBOR_CACHE_UPDATES
-	UpdateNeighborCache(nodes);
-	#endif
-	return neighbors;
+void QTPFS::QTNode::ClearNeighborCache(NodeLayer& nl) {
+	nl.FreeNeighbors(ngbsIndex, maxNeighbors);
+
+	ngbsIndex    = 0;
+	numNeighbors = 0;
+	maxNeighbors = 0;
 }
 
 // this is *either* called from ::GetNeighbors when the conservative
 // update-scheme is enabled, *or* from PM::ExecQueuedNodeLayerUpdates
 // (never both)
-bool QTPFS::QTNode::UpdateNeighborCache(const std::vector<INode*>& nodes) {
+bool QTPFS::QTNode::UpdateNeighborCache(NodeLayer& nl) {
+	const std::vector<INode*>& nodes = nl.GetNodes();
+
 	assert(IsLeaf());
 	assert(!nodes.empty());
 
@@ -715,14 +712,14 @@ bool QTPFS::QTNode::UpdateNeighborCache(const std::vector<INode*>& nodes) {
 
 		// regenerate our neighbor cache
 		if (maxNgbs > 0) {
-			neighbors.clear();
-			neighbors.reserve(maxNgbs + 4);
+			// collect into the layer's scratch-buffers first, the number
+			// of neighbors is not known until all edges have been walked
+			std::vector<INode*>& neighbors = nl.GetTempNeighbors();
+			std::vector<float3>& netpoints = nl.GetTempNetpoints();
 
+			neighbors.clear();
 			netpoints.clear();
-			netpoints.reserve(1 + maxNgbs * QTPFS_MAX_NETPOINTS_PER_NODE_EDGE + 4);
 			// NOTE: caching ETP's breaks QTPFS_ORTHOPROJECTED_EDGE_TRANSITIONS
-			// NOTE: [0] is a reserved index and must always be valid
-			netpoints.push_back(float3());
 
 			INode* ngb = NULL;
 
@@ -870,11 +867,18 @@ bool QTPFS::QTNode::UpdateNeighborCache(const std::vector<INode*>& nodes) {
 			}
 			#endif
 
-			// NOTE: gcc 4.7 should FINALLY define __cplusplus properly (and accept -std=c++11)
-			#if (__cplusplus >= 201103L)
-			// neighbors.shrink_to_fit();
-			// netpoints.shrink_to_fit();
-			#endif
+			// re-use our slots in the shared buffer when the new set fits
+			if (neighbors.size() > maxNeighbors) {
+				ClearNeighborCache(nl);
+
+				ngbsIndex = nl.AllocNeighbors(neighbors.size());
+				maxNeighbors = neighbors.size();
+			}
+
+			numNeighbors = neighbors.size();
+
+			std::copy(neighbors.begin(), neighbors.end(), nl.GetNeighbors(ngbsIndex));
+			std::copy(netpoints.begin(), netpoints.end(), nl.GetNetpoints(ngbsIndex));
 		}
 
 		return true;
@@ -3,7 +3,6 @@
 #ifndef QTPFS_NODE_HDR
 #define QTPFS_NODE_HDR
 
-#include <array>
 #include <vector>
 #include <fstream>
 #include <cinttypes>
@@ -38,12 +37,10 @@ namespace QTPFS {
 
 		#ifdef QTPFS_VIRTUAL_NODE_FUNCTIONS
 		virtual void Serialize(std::fstream&, NodeLayer&, unsigned int*, bool) = 0;
-		virtual unsigned int GetNeighbors(const std::vector<INode*>&, std::vector<INode*>&) = 0;
-		virtual const std::vector<INode*>& GetNeighbors(const std::vector<INode*>& v) = 0;
-		virtual bool UpdateNeighborCache(const std::vector<INode*>& nodes) = 0;
-
-		virtual void SetNeighborEdgeTransitionPoint(unsigned int ngbIdx, const float3& point) = 0;
-		virtual const float3& GetNeighborEdgeTransitionPoint(unsigned int ngbIdx) const = 0;
+		virtual INode* const* GetNeighbors(NodeLayer& nl) = 0;
+		virtual const float3* GetNeighborEdgeTransitionPoints(const NodeLayer& nl) const = 0;
+		virtual unsigned int GetNumNeighbors() const = 0;
+		virtual bool UpdateNeighborCache(NodeLayer& nl) = 0;
 		#endif
 
 		unsigned int GetNeighborRelation(const INode* ngb) const;
@@ -84,7 +81,14 @@ namespace QTPFS {
 		void SetPrevNode(INode* n) { prevNode = n; }
 		INode* GetPrevNode() { return prevNode; }
 
+		// transition-point through which the current search entered this node
+		void SetPathPoint(const float3& point) { pathPoint = point; }
+		const float3& GetPathPoint() const { return pathPoint; }
+
 	protected:
+		// NOTE:
+		//     INode only holds per-search state, the topology (extents,
+		//     costs and neighbors) is kept by QTNode and its NodeLayer
 		// NOTE:
 		//     storing the heap-index is an *UGLY* break of abstraction,
 		//     but the only way to keep the cost of resorting acceptable
@@ -98,6 +102,8 @@ namespace QTPFS {
 		// points back to previous node in path
 		INode* prevNode;
 
+		float3 pathPoint;
+
 	#ifdef QTPFS_VIRTUAL_NODE_FUNCTIONS
 	};
 	#endif
@@ -114,6 +120,9 @@ namespace QTPFS {
 			unsigned int x1, unsigned int z1,
 			unsigned int x2, unsigned int z2
 		);
+		QTNode(const QTNode& n) = default;
+
+		QTNode& operator = (const QTNode& n) = default;
 
 		static void InitStatic();
 
@@ -123,10 +132,12 @@ namespace QTPFS {
 		unsigned int GetChildID(unsigned int i) const { return (nodeNumber << 2) + (i + 1); }
 		unsigned int GetParentID() const { return ((nodeNumber - 1) >> 2); }
 
-		std::uint64_t GetMemFootPrint() const;
-		std::uint64_t GetCheckSum() const;
+		std::uint64_t GetCheckSum(const NodeLayer& nl) const;
 
-		void Delete();
+		const QTNode* GetChild(const NodeLayer& nl, unsigned int i) const;
+		      QTNode* GetChild(      NodeLayer& nl, unsigned int i);
+
+		void Delete(NodeLayer& nl);
 		void PreTesselate(NodeLayer& nl, const SRectangle& r, SRectangle& ur);
 		void Tesselate(NodeLayer& nl, const SRectangle& r);
 		void Serialize(std::fstream& fStream, NodeLayer& nodeLayer, unsigned int* streamSize, bool readMode);
@@ -138,12 +149,16 @@ namespace QTPFS {
 		bool Merge(NodeLayer& nl);
 
 		unsigned int GetMaxNumNeighbors() const;
-		unsigned int GetNeighbors(const std::vector<INode*>&, std::vector<INode*>&);
-		const std::vector<INode*>& GetNeighbors(const std::vector<INode*>&);
-		bool UpdateNeighborCache(const std::vector<INode*>& nodes);
-
-		void SetNeighborEdgeTransitionPoint(unsigned int ngbIdx, const float3& point) { netpoints[ngbIdx] = point; }
-		const float3& GetNeighborEdgeTransitionPoint(unsigned int ngbIdx) const { return netpoints[ngbIdx]; }
+		unsigned int GetNumNeighbors() const { return numNeighbors; }
+		// NOTE:
+		//   the returned pointers index NodeLayer's shared buffers and are
+		//   only valid until the next neighbor-cache update in that layer
+		//   edge transition-points are stored QTPFS_MAX_NETPOINTS_PER_NODE_EDGE
+		//   per neighbor, in the same order as the neighbors themselves
+		INode* const* GetNeighbors(NodeLayer& nl);
+		const float3* GetNeighborEdgeTransitionPoints(const NodeLayer& nl) const;
+		bool UpdateNeighborCache(NodeLayer& nl);
+		void ClearNeighborCache(NodeLayer& nl);
 
 		unsigned int xmin() const { return (_xminxmax  & 0xFFFF); }
 		unsigned int zmin() const { return (_zminzmax  & 0xFFFF); }
@@ -173,6 +188,9 @@ namespace QTPFS {
 		static unsigned int MinSizeZ() { return MIN_SIZE_Z; }
 
 	private:
+		// compacts the shared neighbor buffer
+		friend struct NodeLayer;
+
 		bool UpdateMoveCost(
 			const NodeLayer& nl,
 			const SRectangle& r,
@@ -199,13 +217,15 @@ namespace QTPFS {
 		unsigned int currMagicNum;
 		unsigned int prevMagicNum;
 
-		std::array<QTNode*, QTNODE_CHILD_COUNT> children;
-		std::vector<INode*> neighbors;
+		// index of our first child in NodeLayer's node-pool; all four
+		// children are allocated consecutively (-1u if we are a leaf)
+		unsigned int childIndex;
 
-		// NOTE:
-		//   these should be float2's, but profiling shows float3's to be *faster* and
-		//   float3's are also more convenient to work with (so we take the memory hit)
-		std::vector<float3> netpoints;
+		// range [ngbsIndex, ngbsIndex + numNeighbors) of our neighbors in
+		// NodeLayer's shared neighbor buffer; maxNeighbors slots are owned
+		unsigned int ngbsIndex;
+		unsigned int numNeighbors;
+		unsigned int maxNeighbors;
 	};
 }
 
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <limits>
 
 #include "NodeLayer.hpp"
@@ -22,6 +23,8 @@ QTPFS::NodeLayer::NodeLayer()
 	: layerNumber(0)
 	, numLeafNodes(0)
 	, updateCounter(0)
+	, numLiveNeighbors(0)
+	, numDeadNeighbors(0)
 	, xsize(0)
 	, zsize(0)
 	, maxRelSpeedMod(0.0f)
@@ -43,6 +46,139 @@ void QTPFS::NodeLayer::RegisterNode(INode* n) {
 	}
 }
 
+QTPFS::QTNode* QTPFS::NodeLayer::AllocRootNode(const SRectangle& r) {
+	assert(nodePool.empty());
+
+	nodePool.emplace_back(nullptr, 0,  r.x1, r.z1,  r.x2, r.z2);
+	return &nodePool[0];
+}
+
+unsigned int QTPFS::NodeLayer::AllocChildNodes(const QTNode* parent) {
+	const QTNode childNodes[QTNODE_CHILD_COUNT] = {
+		QTNode(parent, parent->GetChildID(NODE_IDX_TL),  parent->xmin(), parent->zmin(),  parent->xmid(), parent->zmid()),
+		QTNode(parent, parent->GetChildID(NODE_IDX_TR),  parent->xmid(), parent->zmin(),  parent->xmax(), parent->zmid()),
+		QTNode(parent, parent->GetChildID(NODE_IDX_BR),  parent->xmid(), parent->zmid(),  parent->xmax(), parent->zmax()),
+		QTNode(parent, parent->GetChildID(NODE_IDX_BL),  parent->xmin(), parent->zmid(),  parent->xmid(), parent->zmax()),
+	};
+
+	unsigned int poolIndex = nodePool.size();
+
+	if (freeNodeBlocks.empty()) {
+		nodePool.insert(nodePool.end(), childNodes, childNodes + QTNODE_CHILD_COUNT);
+	} else {
+		poolIndex = freeNodeBlocks.back();
+		freeNodeBlocks.pop_back();
+
+		std::copy(childNodes, childNodes + QTNODE_CHILD_COUNT, nodePool.begin() + poolIndex);
+	}
+
+	return poolIndex;
+}
+
+void QTPFS::NodeLayer::FreeChildNodes(unsigned int poolIndex) {
+	assert((poolIndex + QTNODE_CHILD_COUNT) <= nodePool.size());
+	freeNodeBlocks.push_back(poolIndex);
+}
+
+
+unsigned int QTPFS::NodeLayer::AllocNeighbors(unsigned int numNgbs) {
+	// compact once more slots are dead than alive; this might move the
+	// ranges of all other nodes, so pointers obtained earlier are stale
+	if (numDeadNeighbors > std::max(numLiveNeighbors, 1024u))
+		CompactNeighbors();
+
+	const unsigned int ngbsIndex = nodeNeighbors.size();
+
+	nodeNeighbors.resize(ngbsIndex + numNgbs, nullptr);
+	nodeNetpoints.resize((ngbsIndex + numNgbs) * QTPFS_MAX_NETPOINTS_PER_NODE_EDGE);
+
+	numLiveNeighbors += numNgbs;
+	return ngbsIndex;
+}
+
+void QTPFS::NodeLayer::FreeNeighbors(unsigned int ngbsIndex, unsigned int numNgbs) {
+	if (numNgbs == 0)
+		return;
+
+	assert((ngbsIndex + numNgbs) <= nodeNeighbors.size());
+	assert(numLiveNeighbors >= numNgbs);
+
+	numLiveNeighbors -= numNgbs;
+
+	// the most recently allocated range can simply be given back
+	if ((ngbsIndex + numNgbs) == nodeNeighbors.size()) {
+		nodeNeighbors.resize(ngbsIndex);
+		nodeNetpoints.resize(ngbsIndex * QTPFS_MAX_NETPOINTS_PER_NODE_EDGE);
+		return;
+	}
+
+	numDeadNeighbors += numNgbs;
+}
+
+void QTPFS::NodeLayer::CompactNeighbors() {
+	std::vector<INode*> liveNeighbors;
+	std::vector<float3> liveNetpoints;
+
+	liveNeighbors.reserve(numLiveNeighbors);
+	liveNetpoints.reserve(numLiveNeighbors * QTPFS_MAX_NETPOINTS_PER_NODE_EDGE);
+
+	// nodes in free pool-blocks (and internal nodes) own no slots
+	for (QTNode& node: nodePool) {
+		if (node.maxNeighbors == 0)
+			continue;
+
+		const auto ngbsBeg = nodeNeighbors.begin() + node.ngbsIndex;
+		const auto ngbsEnd = ngbsBeg + node.maxNeighbors;
+		const auto npsBeg = nodeNetpoints.begin() + node.ngbsIndex * QTPFS_MAX_NETPOINTS_PER_NODE_EDGE;
+		const auto npsEnd = npsBeg + node.maxNeighbors * QTPFS_MAX_NETPOINTS_PER_NODE_EDGE;
+
+		node.ngbsIndex = liveNeighbors.size();
+
+		liveNeighbors.insert(liveNeighbors.end(), ngbsBeg, ngbsEnd);
+		liveNetpoints.insert(liveNetpoints.end(), npsBeg, npsEnd);
+	}
+
+	assert(liveNeighbors.size() == numLiveNeighbors);
+
+	nodeNeighbors.swap(liveNeighbors);
+	nodeNetpoints.swap(liveNetpoints);
+
+	numDeadNeighbors = 0;
+}
+
+
+std::uint64_t QTPFS::NodeLayer::GetNodeMemFootPrint() const {
+	std::uint64_t memFootPrint = 0;
+	memFootPrint += (nodePool.size() * sizeof(QTNode));
+	memFootPrint += (freeNodeBlocks.capacity() * sizeof(unsigned int));
+	memFootPrint += (nodeNeighbors.capacity() * sizeof(INode*));
+	memFootPrint += (nodeNetpoints.capacity() * sizeof(float3));
+	memFootPrint += (tempNeighbors.capacity() * sizeof(INode*));
+	memFootPrint += (tempNetpoints.capacity() * sizeof(float3));
+	return memFootPrint;
+}
+
+std::uint64_t QTPFS::NodeLayer::GetLinkedNodeMemFootPrint() const {
+	// each node held four child-pointers and two vectors instead of the pool- and
+	// neighbor-indices, leafs stored the search path-point as extra netpoint and
+	// neighbors were not shared (allocator overhead per node is not included)
+	const size_t linkedNodeSize =
+		sizeof(QTNode) - sizeof(unsigned int) * 4 +
+		sizeof(QTNode*) * QTNODE_CHILD_COUNT +
+		sizeof(std::vector<INode*>) +
+		sizeof(std::vector<float3>);
+	const size_t numTreeNodes = nodePool.size() - freeNodeBlocks.size() * QTNODE_CHILD_COUNT;
+
+	std::uint64_t memFootPrint = 0;
+	memFootPrint += (numTreeNodes * linkedNodeSize);
+	memFootPrint += (numLeafNodes * sizeof(float3));
+	memFootPrint += (numLiveNeighbors * sizeof(INode*));
+	memFootPrint += (numLiveNeighbors * sizeof(float3) * QTPFS_MAX_NETPOINTS_PER_NODE_EDGE);
+	return memFootPrint;
+}
+
+
+
 void QTPFS::NodeLayer::Init(unsigned int layerNum) {
 	assert((QTPFS::NodeLayer::NUM_SPEEDMOD_BINS + 1) <= MaxSpeedBinTypeValue());
 
@@ -63,6 +199,16 @@ void QTPFS::NodeLayer::Init(unsigned int layerNum) {
 
 void QTPFS::NodeLayer::Clear() {
 	nodeGrid.clear();
+	nodePool.clear();
+	freeNodeBlocks.clear();
+
+	nodeNeighbors.clear();
+	nodeNetpoints.clear();
+	tempNeighbors.clear();
+	tempNetpoints.clear();
+
+	numLiveNeighbors = 0;
+	numDeadNeighbors = 0;
 
 	curSpeedMods.clear();
 	oldSpeedMods.clear();
@@ -90,13 +236,14 @@ void QTPFS::NodeLayer::QueueUpdate(const SRectangle& r, const MoveDef* md) {
 
 	// make a snapshot of the terrain-state within <r>
 	for (unsigned int hmz = r.z1; hmz < r.z2; hmz++) {
+		CMoveMath::GetRowSpeedMods(*md, r.x1, r.x2, hmz, layerUpdate->speedMods.data() + (hmz - r.z1) * r.GetWidth());
+
 		for (unsigned int hmx = r.x1; hmx < r.x2; hmx++) {
 			const unsigned int recIdx = (hmz - r.z1) * r.GetWidth() + (hmx - r.x1);
 
 			const unsigned int chmx = Clamp(int(hmx), md->xsizeh, r.x2 - md->xsizeh - 1);
 			const unsigned int chmz = Clamp(int(hmz), md->zsizeh, r.z2 - md->zsizeh - 1);
 
-			layerUpdate->speedMods[recIdx] = CMoveMath::GetPosSpeedMod(*md, hmx, hmz);
 			layerUpdate->blockBits[recIdx] = CMoveMath::IsBlockedNoSpeedModCheck(*md, chmx, chmz, NULL);
 			// layerUpdate->blockBits[recIdx] = CMoveMath::SquareIsBlocked(*md, hmx, hmz, NULL);
 		}
@@ -110,7 +257,7 @@ bool QTPFS::NodeLayer::ExecQueuedUpdate() {
 	const std::vector<float>* speedMods = &layerUpdate.speedMods;
 	const std::vector<  int>* blockBits = &layerUpdate.blockBits;
 
-	return (Update(rectangle, moveDefHandler->GetMoveDefByPathType(layerNumber), speedMods, blockBits));
+	return (Update(rectangle, moveDefHandler->GetMoveDefByPathLayer(layerNumber), speedMods, blockBits));
 }
 #endif
 
@@ -266,7 +413,7 @@ void QTPFS::NodeLayer::ExecNodeNeighborCacheUpdate(unsigned int currFrameNum, un
 				zspan = std::max(zspan, 1u);
 
 				n->SetMagicNumber(currMagicNum);
-				n->GetNeighbors(nodeGrid);
+				n->GetNeighbors(*this);
 			}
 
 			z += zspan;
@@ -288,7 +435,7 @@ void QTPFS::NodeLayer::ExecNodeNeighborCacheUpdate(unsigned int currFrameNum, un
 				zspan = std::max(zspan, 1u);
 
 				n->SetMagicNumber(currMagicNum);
-				n->GetNeighbors(nodeGrid);
+				n->GetNeighbors(*this);
 			}
 
 			z += zspan;
@@ -310,7 +457,7 @@ void QTPFS::NodeLayer::ExecNodeNeighborCacheUpdate(unsigned int currFrameNum, un
 				zspan = std::max(zspan, 1u);
 
 				n->SetMagicNumber(currMagicNum);
-				n->GetNeighbors(nodeGrid);
+				n->GetNeighbors(*this);
 			}
 
 			z += zspan;
@@ -332,7 +479,7 @@ void QTPFS::NodeLayer::ExecNodeNeighborCacheUpdate(unsigned int currFrameNum, un
 				zspan = std::max(zspan, 1u);
 
 				n->SetMagicNumber(currMagicNum);
-				n->GetNeighbors(nodeGrid);
+				n->GetNeighbors(*this);
 			}
 
 			z += zspan;
@@ -367,7 +514,7 @@ void QTPFS::NodeLayer::ExecNodeNeighborCacheUpdates(const SRectangle& ur, unsign
 			//   during initialization, currMagicNum == 0 which nodes start with already 
 			//   (does not matter because prevMagicNum == -1, so updates are not no-ops)
 			n->SetMagicNumber(currMagicNum);
-			n->UpdateNeighborCache(nodeGrid);
+			n->UpdateNeighborCache(*this);
 		}
 
 		z += zspan;
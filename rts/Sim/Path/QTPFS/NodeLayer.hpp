@@ -5,17 +5,17 @@
 
 #include <limits>
 #include <vector>
-#include <deque> // for QTPFS_STAGGERED_LAYER_UPDATES
+#include <deque>
 #include <cinttypes>
 
+#include "System/float3.h"
 #include "System/Rectangle.h"
 #include "PathDefines.hpp"
+#include "Node.hpp"
 
 struct MoveDef;
 
 namespace QTPFS {
-	struct INode;
-
 	#ifdef QTPFS_STAGGERED_LAYER_UPDATES
 	struct LayerUpdate {
 		SRectangle rectangle;
@@ -74,6 +74,29 @@ namespace QTPFS {
 		std::vector<INode*>& GetNodes() { return nodeGrid; }
 		void RegisterNode(INode* n);
 
+		// node-pool; indices remain valid (and nodes keep their addresses)
+		// until the nodes are freed again, a freed block of four children
+		// is recycled by the next split
+		QTNode* AllocRootNode(const SRectangle& r);
+		unsigned int AllocChildNodes(const QTNode* parent);
+		void FreeChildNodes(unsigned int poolIndex);
+
+		const QTNode* GetPoolNode(unsigned int poolIndex) const { return &nodePool[poolIndex]; }
+		      QTNode* GetPoolNode(unsigned int poolIndex)       { return &nodePool[poolIndex]; }
+
+		// shared (CSR-like) neighbor storage for all leaf nodes
+		unsigned int AllocNeighbors(unsigned int numNgbs);
+		void FreeNeighbors(unsigned int ngbsIndex, unsigned int numNgbs);
+
+		INode* const* GetNeighbors(unsigned int ngbsIndex) const { return (nodeNeighbors.data() + ngbsIndex); }
+		INode**       GetNeighbors(unsigned int ngbsIndex)       { return (nodeNeighbors.data() + ngbsIndex); }
+		const float3* GetNetpoints(unsigned int ngbsIndex) const { return (nodeNetpoints.data() + ngbsIndex * QTPFS_MAX_NETPOINTS_PER_NODE_EDGE); }
+		      float3* GetNetpoints(unsigned int ngbsIndex)       { return (nodeNetpoints.data() + ngbsIndex * QTPFS_MAX_NETPOINTS_PER_NODE_EDGE); }
+
+		// scratch-space for UpdateNeighborCache (used by one node at a time)
+		std::vector<INode*>& GetTempNeighbors() { return tempNeighbors; }
+		std::vector<float3>& GetTempNetpoints() { return tempNetpoints; }
+
 		void SetNumLeafNodes(unsigned int n) { numLeafNodes = n; }
 		unsigned int GetNumLeafNodes() const { return numLeafNodes; }
 
@@ -92,9 +115,26 @@ namespace QTPFS {
 			return memFootPrint;
 		}
 
+		// memory used by the node-pool and the shared neighbor buffers
+		std::uint64_t GetNodeMemFootPrint() const;
+		// memory the same tree would need with individually allocated nodes
+		// and per-node neighbor vectors (the pre-pool representation)
+		std::uint64_t GetLinkedNodeMemFootPrint() const;
+
+	private:
+		void CompactNeighbors();
+
 	private:
 		std::vector<INode*> nodeGrid;
 
+		std::deque<QTNode> nodePool;
+		std::vector<unsigned int> freeNodeBlocks;
+
+		std::vector<INode*> nodeNeighbors;
+		std::vector<float3> nodeNetpoints;
+		std::vector<INode*> tempNeighbors;
+		std::vector<float3> tempNetpoints;
+
 		std::vector<SpeedModType> curSpeedMods;
 		std::vector<SpeedModType> oldSpeedMods;
 		std::vector<SpeedBinType> curSpeedBins;
@@ -116,6 +156,11 @@ namespace QTPFS {
 		unsigned int numLeafNodes;
 		unsigned int updateCounter;
 
+		// number of nodeNeighbors slots that are owned by a leaf (live) or
+		// were released (dead) by a split, merge or larger re-allocation
+		unsigned int numLiveNeighbors;
+		unsigned int numDeadNeighbors;
+
 		unsigned int xsize;
 		unsigned int zsize;
 
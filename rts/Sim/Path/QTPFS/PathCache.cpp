@@ -8,6 +8,7 @@
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/CollisionHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
+#include "System/FrameArena.h"
 #include "System/Rectangle.h"
 
 static void GetRectangleCollisionVolume(const SRectangle& r, CollisionVolume& v, float3& rm) {
@@ -134,7 +135,7 @@ bool QTPFS::PathCache::MarkDeadPaths(const SRectangle& r) {
 	// "mark" any live path crossing the area of a terrain
 	// deformation, for which some or all of its waypoints
 	// might now be invalid and need to be recomputed
-	std::vector<PathMapIt> livePathIts;
+	FrameVector<PathMapIt> livePathIts;
 	livePathIts.reserve(livePaths.size());
 
 	for (PathMapIt it = livePaths.begin(); it != livePaths.end(); ++it) {
@@ -13,6 +13,7 @@
 #include "Game/LoadScreen.h"
 #include "Map/MapInfo.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/MoveTypes/MoveMath/MoveMath.h"
@@ -102,7 +103,7 @@ QTPFS::PathManager::PathManager() {
 
 QTPFS::PathManager::~PathManager() {
 	for (unsigned int layerNum = 0; layerNum < nodeLayers.size(); layerNum++) {
-		nodeTrees[layerNum]->Delete();
+		nodeTrees[layerNum]->Delete(nodeLayers[layerNum]);
 		nodeLayers[layerNum].Clear();
 
 		for (auto searchesIt = pathSearches[layerNum].begin(); searchesIt != pathSearches[layerNum].end(); ++searchesIt) {
@@ -122,10 +123,12 @@ QTPFS::PathManager::~PathManager() {
 	pathTypes.clear();
 	pathTraces.clear();
 
-	numCurrExecutedSearches.clear();
-	numPrevExecutedSearches.clear();
+	sharedPaths.clear();
+	numExecutedSearches.clear();
+	failedSearchPathIDs.clear();
+	searchStateOffsets.clear();
 
-	PathSearch::FreeGlobalQueue();
+	PathSearch::FreeGlobalQueues();
 
 	#ifdef QTPFS_ENABLE_THREADED_UPDATE
 	// at this point the thread is waiting, so notify it
@@ -171,20 +174,27 @@ void QTPFS::PathManager::InitStatic() {
 void QTPFS::PathManager::Load() {
 	pmLoadScreen.SetLoading(true);
 
-	// NOTE: offset *must* start at a non-zero value
-	searchStateOffset = NODE_STATE_OFFSET;
 	numTerrainChanges = 0;
 	numPathRequests   = 0;
 	maxNumLeafNodes   = 0;
 
-	nodeTrees.resize(moveDefHandler->GetNumMoveDefs(), NULL);
-	nodeLayers.resize(moveDefHandler->GetNumMoveDefs());
-	pathCaches.resize(moveDefHandler->GetNumMoveDefs());
-	pathSearches.resize(moveDefHandler->GetNumMoveDefs());
+	nodeTrees.resize(moveDefHandler->GetNumPathLayers(), NULL);
+	nodeLayers.resize(moveDefHandler->GetNumPathLayers());
+	pathCaches.resize(moveDefHandler->GetNumPathLayers());
+	pathSearches.resize(moveDefHandler->GetNumPathLayers());
+	sharedPaths.resize(moveDefHandler->GetNumPathLayers());
 
-	// add one extra element for object-less requests
-	numCurrExecutedSearches.resize(teamHandler->ActiveTeams() + 1, 0);
-	numPrevExecutedSearches.resize(teamHandler->ActiveTeams() + 1, 0);
+	// NOTE: offsets *must* start at a non-zero value
+	searchStateOffsets.resize(moveDefHandler->GetNumPathLayers(), NODE_STATE_OFFSET);
+
+	// one set of counters per layer that can be processed in an update
+	numExecutedSearches.resize(std::max(1u, std::min(LAYERS_PER_UPDATE, static_cast<unsigned int>(moveDefHandler->GetNumPathLayers()))));
+	failedSearchPathIDs.resize(numExecutedSearches.size());
+
+	for (std::vector<unsigned int>& teamSearches: numExecutedSearches) {
+		// add one extra element for object-less requests
+		teamSearches.resize(teamHandler->ActiveTeams() + 1, 0);
+	}
 
 	{
 		const std::uint32_t mapCheckSum = archiveScanner->GetArchiveCompleteChecksum(gameSetup->mapName);
@@ -219,29 +229,29 @@ void QTPFS::PathManager::Load() {
 			}
 			#endif
 
-			pfsCheckSum ^= nodeTrees[layerNum]->GetCheckSum();
+			pfsCheckSum ^= nodeTrees[layerNum]->GetCheckSum(nodeLayers[layerNum]);
 			maxNumLeafNodes = std::max(nodeLayers[layerNum].GetNumLeafNodes(), maxNumLeafNodes);
 		}
 
 		{ SyncedUint tmp(pfsCheckSum); }
 
-		PathSearch::InitGlobalQueue(maxNumLeafNodes);
+		PathSearch::InitGlobalQueues(maxNumLeafNodes, 1);
 	}
 
 	{
 		const std::string sumStr = "pfs-checksum: " + IntToString(pfsCheckSum, "%08x") + ", ";
-		const std::string memStr = "mem-footprint: " + IntToString(GetMemFootPrint()) + "MB";
+		const std::string memStr = "mem-footprint: " + IntToString(GetMemFootPrint(false)) + "MB (" + IntToString(GetMemFootPrint(true)) + "MB with linked nodes)";
 		pmLoadScreen.AddLoadMessage("[" + std::string(__FUNCTION__) + "] " + sumStr + memStr);
 		pmLoadScreen.SetLoading(false);
 	}
 }
 
-std::uint64_t QTPFS::PathManager::GetMemFootPrint() const {
+std::uint64_t QTPFS::PathManager::GetMemFootPrint(bool linkedNodes) const {
 	std::uint64_t memFootPrint = sizeof(PathManager);
 
 	for (unsigned int i = 0; i < nodeLayers.size(); i++) {
 		memFootPrint += nodeLayers[i].GetMemFootPrint();
-		memFootPrint += nodeTrees[i]->GetMemFootPrint();
+		memFootPrint += (linkedNodes? nodeLayers[i].GetLinkedNodeMemFootPrint(): nodeLayers[i].GetNodeMemFootPrint());
 	}
 
 	// convert to megabytes
@@ -295,9 +305,8 @@ void QTPFS::PathManager::InitNodeLayersThreaded(const SRectangle& rect) {
 			InitNodeLayer(layerNum, rect);
 			UpdateNodeLayer(layerNum, rect);
 
-			const QTNode* tree = nodeTrees[layerNum];
 			const NodeLayer& layer = nodeLayers[layerNum];
-			const unsigned int mem = (tree->GetMemFootPrint() + layer.GetMemFootPrint()) / (1024 * 1024);
+			const unsigned int mem = (layer.GetNodeMemFootPrint() + layer.GetMemFootPrint()) / (1024 * 1024);
 
 			#ifndef NDEBUG
 			sprintf(loadMsg, pstFmtStr, layerNum, mem, layer.GetNumLeafNodes(), layer.GetNodeRatio());
@@ -345,9 +354,8 @@ void QTPFS::PathManager::InitNodeLayersThread(
 		InitNodeLayer(layerNum, rect);
 		UpdateNodeLayer(layerNum, rect);
 
-		const QTNode* tree = nodeTrees[layerNum];
 		const NodeLayer& layer = nodeLayers[layerNum];
-		const unsigned int mem = (tree->GetMemFootPrint() + layer.GetMemFootPrint()) / (1024 * 1024);
+		const unsigned int mem = (layer.GetNodeMemFootPrint() + layer.GetMemFootPrint()) / (1024 * 1024);
 
 		#ifndef NDEBUG
 		sprintf(loadMsg, pstFmtStr, layerNum, mem, layer.GetNumLeafNodes(), layer.GetNodeRatio());
@@ -357,9 +365,9 @@ void QTPFS::PathManager::InitNodeLayersThread(
 }
 
 void QTPFS::PathManager::InitNodeLayer(unsigned int layerNum, const SRectangle& r) {
-	nodeTrees[layerNum] = new QTPFS::QTNode(NULL,  0,  r.x1, r.z1,  r.x2, r.z2);
-
 	nodeLayers[layerNum].Init(layerNum);
+
+	nodeTrees[layerNum] = nodeLayers[layerNum].AllocRootNode(r);
 	nodeLayers[layerNum].RegisterNode(nodeTrees[layerNum]);
 }
 
@@ -404,7 +412,7 @@ void QTPFS::PathManager::UpdateNodeLayersThread(
 // called in the non-staggered (#ifndef QTPFS_STAGGERED_LAYER_UPDATES)
 // layer update scheme and during initialization; see ::TerrainChange
 void QTPFS::PathManager::UpdateNodeLayer(unsigned int layerNum, const SRectangle& r) {
-	const MoveDef* md = moveDefHandler->GetMoveDefByPathType(layerNum);
+	const MoveDef* md = moveDefHandler->GetMoveDefByPathLayer(layerNum);
 
 	if (!IsFinalized())
 		return;
@@ -449,7 +457,7 @@ void QTPFS::PathManager::UpdateNodeLayer(unsigned int layerNum, const SRectangle
 #ifdef QTPFS_STAGGERED_LAYER_UPDATES
 void QTPFS::PathManager::QueueNodeLayerUpdates(const SRectangle& r) {
 	for (unsigned int layerNum = 0; layerNum < nodeLayers.size(); layerNum++) {
-		const MoveDef* md = moveDefHandler->GetMoveDefByPathType(layerNum);
+		const MoveDef* md = moveDefHandler->GetMoveDefByPathLayer(layerNum);
 
 		SRectangle mr;
 		// SRectangle ur;
@@ -541,7 +549,7 @@ void QTPFS::PathManager::Serialize(const std::string& cacheFileDir) {
 
 	// TODO: compress the tree cache-files?
 	for (unsigned int i = 0; i < nodeTrees.size(); i++) {
-		const MoveDef* md = moveDefHandler->GetMoveDefByPathType(i);
+		const MoveDef* md = moveDefHandler->GetMoveDefByPathLayer(i);
 
 		fileNames[i] = cacheFileDir + "tree" + IntToString(i, "%02x") + "-" + md->name;
 		fileStreams[i] = new std::fstream();
@@ -687,9 +695,13 @@ void QTPFS::PathManager::ThreadUpdate() {
 		static unsigned int minPathTypeUpdate = 0;
 		static unsigned int maxPathTypeUpdate = numPathTypeUpdates;
 
-		sharedPaths.clear();
+		for (std::vector<unsigned int>& teamSearches: numExecutedSearches) {
+			std::fill(teamSearches.begin(), teamSearches.end(), 0);
+		}
 
 		for (unsigned int pathTypeUpdate = minPathTypeUpdate; pathTypeUpdate < maxPathTypeUpdate; pathTypeUpdate++) {
+			sharedPaths[pathTypeUpdate].clear();
+
 			#ifndef QTPFS_IGNORE_DEAD_PATHS
 			QueueDeadPathSearches(pathTypeUpdate);
 			#endif
@@ -698,11 +710,34 @@ void QTPFS::PathManager::ThreadUpdate() {
 			// NOTE: *must* be called between QueueDeadPathSearches and ExecuteQueuedSearches
 			ExecQueuedNodeLayerUpdates(pathTypeUpdate, !pathSearches[pathTypeUpdate].empty());
 			#endif
+		}
 
-			ExecuteQueuedSearches(pathTypeUpdate);
+		#if (!defined(QTPFS_TRACE_PATH_SEARCHES) && !defined(QTPFS_ENABLE_THREADED_UPDATE))
+		if (modInfo.pfParallelSearches) {
+			// layers do not share any nodes, so their searches can run concurrently
+			// each layer gets its own team-counters s.t. the outcome does not depend
+			// on the order in which threads finish; failed paths are deleted below
+			if (PathSearch::GetNumGlobalQueues() < ThreadPool::GetNumThreads())
+				PathSearch::InitGlobalQueues(maxNumLeafNodes, ThreadPool::GetNumThreads());
+
+			for_mt(minPathTypeUpdate, maxPathTypeUpdate, [&](const int pathTypeUpdate) {
+				ExecuteQueuedSearches(pathTypeUpdate, pathTypeUpdate - minPathTypeUpdate, ThreadPool::GetThreadNum());
+			});
+		} else
+		#endif
+		{
+			for (unsigned int pathTypeUpdate = minPathTypeUpdate; pathTypeUpdate < maxPathTypeUpdate; pathTypeUpdate++) {
+				ExecuteQueuedSearches(pathTypeUpdate, 0, 0);
+			}
 		}
 
-		std::copy(numCurrExecutedSearches.begin(), numCurrExecutedSearches.end(), numPrevExecutedSearches.begin());
+		for (std::vector<unsigned int>& pathIDs: failedSearchPathIDs) {
+			for (const unsigned int pathID: pathIDs) {
+				DeletePath(pathID);
+			}
+
+			pathIDs.clear();
+		}
 
 		minPathTypeUpdate = (minPathTypeUpdate + numPathTypeUpdates);
 		maxPathTypeUpdate = (minPathTypeUpdate + numPathTypeUpdates);
@@ -724,7 +759,7 @@ void QTPFS::PathManager::ThreadUpdate() {
 
 
 
-void QTPFS::PathManager::ExecuteQueuedSearches(unsigned int pathType) {
+void QTPFS::PathManager::ExecuteQueuedSearches(unsigned int pathType, unsigned int updateNum, unsigned int threadNum) {
 	NodeLayer& nodeLayer = nodeLayers[pathType];
 	PathCache& pathCache = pathCaches[pathType];
 
@@ -735,8 +770,8 @@ void QTPFS::PathManager::ExecuteQueuedSearches(unsigned int pathType) {
 		// execute pending searches collected via
 		// RequestPath and QueueDeadPathSearches
 		while (searchesIt != searches.end()) {
-			if (ExecuteSearch(searches, searchesIt, nodeLayer, pathCache, pathType)) {
-				searchStateOffset += NODE_STATE_OFFSET;
+			if (ExecuteSearch(searches, searchesIt, nodeLayer, pathCache, pathType, updateNum, threadNum)) {
+				searchStateOffsets[pathType] += NODE_STATE_OFFSET;
 			}
 		}
 	}
@@ -747,7 +782,9 @@ bool QTPFS::PathManager::ExecuteSearch(
 	PathSearchVectIt& searchesIt,
 	NodeLayer& nodeLayer,
 	PathCache& pathCache,
-	unsigned int pathType
+	unsigned int pathType,
+	unsigned int updateNum,
+	unsigned int threadNum
 ) {
 	IPathSearch* search = *searchesIt;
 	IPath* path = pathCache.GetTempPath(search->GetID());
@@ -777,9 +814,9 @@ bool QTPFS::PathManager::ExecuteSearch(
 
 	{
 		#ifdef QTPFS_SEARCH_SHARED_PATHS
-		SharedPathMap::const_iterator sharedPathsIt = sharedPaths.find(path->GetHash());
+		SharedPathMap::const_iterator sharedPathsIt = sharedPaths[pathType].find(path->GetHash());
 
-		if (sharedPathsIt != sharedPaths.end()) {
+		if (sharedPathsIt != sharedPaths[pathType].end()) {
 			if (search->SharedFinalize(sharedPathsIt->second, path)) {
 				DeleteSearch(search, searches, searchesIt);
 				return false;
@@ -788,30 +825,29 @@ bool QTPFS::PathManager::ExecuteSearch(
 		#endif
 
 		#ifdef QTPFS_LIMIT_TEAM_SEARCHES
-		const unsigned int numCurrSearches = numCurrExecutedSearches[search->GetTeam()];
-		const unsigned int numPrevSearches = numPrevExecutedSearches[search->GetTeam()];
+		unsigned int& numTeamSearches = numExecutedSearches[updateNum][search->GetTeam()];
 
-		if ((numCurrSearches - numPrevSearches) >= MAX_TEAM_SEARCHES) {
+		if (numTeamSearches >= MAX_TEAM_SEARCHES) {
 			++searchesIt; return false;
 		}
 
-		numCurrExecutedSearches[search->GetTeam()] += 1;
+		numTeamSearches += 1;
 		#endif
 	}
 
 	// removes path from temp-paths, adds it to live-paths
-	if (search->Execute(searchStateOffset, numTerrainChanges)) {
+	if (search->Execute(searchStateOffsets[pathType], numTerrainChanges, threadNum)) {
 		search->Finalize(path);
 
 		#ifdef QTPFS_SEARCH_SHARED_PATHS
-		sharedPaths[path->GetHash()] = path;
+		sharedPaths[pathType][path->GetHash()] = path;
 		#endif
 
 		#ifdef QTPFS_TRACE_PATH_SEARCHES
 		pathTraces[path->GetID()] = search->GetExecutionTrace();
 		#endif
 	} else {
-		DeletePath(path->GetID());
+		failedSearchPathIDs[updateNum].push_back(path->GetID());
 	}
 
 	DeleteSearch(search, searches, searchesIt);
@@ -823,7 +859,7 @@ void QTPFS::PathManager::QueueDeadPathSearches(unsigned int pathType) {
 	PathCache::PathMap::const_iterator deadPathsIt;
 
 	const PathCache::PathMap& deadPaths = pathCache.GetDeadPaths();
-	const MoveDef* moveDef = moveDefHandler->GetMoveDefByPathType(pathType);
+	const MoveDef* moveDef = moveDefHandler->GetMoveDefByPathLayer(pathType);
 
 	if (!deadPaths.empty()) {
 		// re-request LIVE paths that were marked as DEAD by a TerrainChange
@@ -906,12 +942,12 @@ unsigned int QTPFS::PathManager::QueueSearch(
 		newSearch->SetTeam((object != NULL)? object->team: teamHandler->ActiveTeams());
 	}
 
-	assert((pathCaches[moveDef->pathType].GetTempPath(newPath->GetID()))->GetID() == 0);
+	assert((pathCaches[moveDef->pathLayer].GetTempPath(newPath->GetID()))->GetID() == 0);
 
 	// map the path-ID to the index of the cache that stores it
-	pathTypes[newPath->GetID()] = moveDef->pathType;
-	pathSearches[moveDef->pathType].push_back(newSearch);
-	pathCaches[moveDef->pathType].AddTempPath(newPath);
+	pathTypes[newPath->GetID()] = moveDef->pathLayer;
+	pathSearches[moveDef->pathLayer].push_back(newSearch);
+	pathCaches[moveDef->pathLayer].AddTempPath(newPath);
 
 	return (newPath->GetID());
 }
@@ -962,6 +998,8 @@ unsigned int QTPFS::PathManager::RequestPath(
 	if (!IsFinalized())
 		return 0;
 
+	numRequestedPaths.fetch_add(1, std::memory_order_relaxed);
+
 	return (QueueSearch(NULL, object, moveDef, sourcePoint, targetPoint, radius, synced));
 }
 
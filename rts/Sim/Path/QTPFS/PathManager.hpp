@@ -9,6 +9,7 @@
 #include "NodeLayer.hpp"
 #include "PathCache.hpp"
 #include "PathSearch.hpp"
+#include "System/FlatHashMap.hpp"
 #include "System/UnorderedMap.hpp"
 
 struct MoveDef;
@@ -74,7 +75,7 @@ namespace QTPFS {
 		void ThreadUpdate();
 		void Load();
 
-		std::uint64_t GetMemFootPrint() const;
+		std::uint64_t GetMemFootPrint(bool linkedNodes) const;
 
 		typedef void (PathManager::*MemberFunc)(
 			unsigned int threadNum,
@@ -85,8 +86,8 @@ namespace QTPFS {
 		typedef spring::unordered_map<unsigned int, unsigned int>::iterator PathTypeMapIt;
 		typedef spring::unordered_map<unsigned int, PathSearchTrace::Execution*> PathTraceMap;
 		typedef spring::unordered_map<unsigned int, PathSearchTrace::Execution*>::iterator PathTraceMapIt;
-		typedef spring::unordered_map<std::uint64_t, IPath*> SharedPathMap;
-		typedef spring::unordered_map<std::uint64_t, IPath*>::iterator SharedPathMapIt;
+		typedef spring::flat_hash_map<std::uint64_t, IPath*> SharedPathMap;
+		typedef SharedPathMap::iterator SharedPathMapIt;
 
 		typedef std::vector<IPathSearch*> PathSearchVect;
 		typedef std::vector<IPathSearch*>::iterator PathSearchVectIt;
@@ -113,7 +114,7 @@ namespace QTPFS {
 		void ExecQueuedNodeLayerUpdates(unsigned int layerNum, bool flushQueue);
 		#endif
 
-		void ExecuteQueuedSearches(unsigned int pathType);
+		void ExecuteQueuedSearches(unsigned int pathType, unsigned int updateNum, unsigned int threadNum);
 		void QueueDeadPathSearches(unsigned int pathType);
 
 		unsigned int QueueSearch(
@@ -131,7 +132,9 @@ namespace QTPFS {
 			PathSearchVectIt& searchesIt,
 			NodeLayer& nodeLayer,
 			PathCache& pathCache,
-			unsigned int pathType
+			unsigned int pathType,
+			unsigned int updateNum,
+			unsigned int threadNum
 		);
 
 		bool IsFinalized() const { return (!nodeTrees.empty()); }
@@ -148,16 +151,23 @@ namespace QTPFS {
 		spring::unordered_map<unsigned int, unsigned int> pathTypes;
 		spring::unordered_map<unsigned int, PathSearchTrace::Execution*> pathTraces;
 
-		// maps "hashes" of executed searches to the found paths
-		spring::unordered_map<std::uint64_t, IPath*> sharedPaths;
+		// maps "hashes" of executed searches to the found paths (per layer)
+		std::vector<SharedPathMap> sharedPaths;
 
-		std::vector<unsigned int> numCurrExecutedSearches;
-		std::vector<unsigned int> numPrevExecutedSearches;
+		// per-team number of searches executed during the current update; indexed
+		// by the layer's position within the update if searches run in parallel,
+		// otherwise only the first entry is used (and shared by all layers)
+		std::vector< std::vector<unsigned int> > numExecutedSearches;
+		// IDs of paths whose searches failed during the current update, deleted
+		// after all layers have been processed (in the same order as above)
+		std::vector< std::vector<unsigned int> > failedSearchPathIDs;
+
+		// per-layer offset that identifies nodes as part of the current search
+		std::vector<unsigned int> searchStateOffsets;
 
 		static unsigned int LAYERS_PER_UPDATE;
 		static unsigned int MAX_TEAM_SEARCHES;
 
-		unsigned int searchStateOffset;
 		unsigned int numTerrainChanges;
 		unsigned int numPathRequests;
 		unsigned int maxNumLeafNodes;
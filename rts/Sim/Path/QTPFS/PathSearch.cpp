@@ -15,7 +15,7 @@
 
 #include "System/float3.h"
 
-QTPFS::binary_heap<QTPFS::INode*> QTPFS::PathSearch::openNodes;
+std::vector< QTPFS::binary_heap<QTPFS::INode*> > QTPFS::PathSearch::openNodeQueues;
 
 
 
@@ -44,10 +44,14 @@ void QTPFS::PathSearch::Initialize(
 
 bool QTPFS::PathSearch::Execute(
 	unsigned int searchStateOffset,
-	unsigned int searchMagicNumber
+	unsigned int searchMagicNumber,
+	unsigned int searchThreadNum
 ) {
+	assert(searchThreadNum < openNodeQueues.size());
+
 	searchState = searchStateOffset; // starts at NODE_STATE_OFFSET
 	searchMagic = searchMagicNumber; // starts at numTerrainChanges
+	openNodes = &openNodeQueues[searchThreadNum];
 
 	haveFullPath = (srcNode == tgtNode);
 	havePartPath = false;
@@ -82,8 +86,8 @@ bool QTPFS::PathSearch::Execute(
 	ResetState(srcNode);
 	UpdateNode(srcNode, NULL, 0);
 
-	while (!openNodes.empty()) {
-		IterateNodes(nodeLayer->GetNodes());
+	while (!openNodes->empty()) {
+		IterateNodes();
 
 		#ifdef QTPFS_TRACE_PATH_SEARCHES
 		searchExec->AddIteration(searchIter);
@@ -94,7 +98,7 @@ bool QTPFS::PathSearch::Execute(
 		havePartPath = (minNode != srcNode);
 
 		if (haveFullPath) {
-			openNodes.reset();
+			openNodes->reset();
 		}
 	}
 
@@ -139,8 +143,8 @@ void QTPFS::PathSearch::ResetState(INode* node) {
 		hCosts[i] = 0.0f;
 	}
 
-	openNodes.reset();
-	openNodes.push(node);
+	openNodes->reset();
+	openNodes->push(node);
 }
 
 void QTPFS::PathSearch::UpdateNode(INode* nextNode, INode* prevNode, unsigned int netPointIdx) {
@@ -152,11 +156,11 @@ void QTPFS::PathSearch::UpdateNode(INode* nextNode, INode* prevNode, unsigned in
 	nextNode->SetPrevNode(prevNode);
 	nextNode->SetPathCosts(gCosts[netPointIdx], hCosts[netPointIdx]);
 	nextNode->SetSearchState(searchState | NODE_STATE_OPEN);
-	nextNode->SetNeighborEdgeTransitionPoint(0, netPoints[netPointIdx]);
+	nextNode->SetPathPoint(netPoints[netPointIdx]);
 }
 
-void QTPFS::PathSearch::IterateNodes(const std::vector<INode*>& allNodes) {
-	curNode = openNodes.top();
+void QTPFS::PathSearch::IterateNodes() {
+	curNode = openNodes->top();
 	curNode->SetSearchState(searchState | NODE_STATE_CLOSED);
 	#ifdef QTPFS_CONSERVATIVE_NEIGHBOR_CACHE_UPDATES
 	// in the non-conservative case, this is done from
@@ -164,8 +168,8 @@ void QTPFS::PathSearch::IterateNodes(const std::vector<INode*>& allNodes) {
 	curNode->SetMagicNumber(searchMagic);
 	#endif
 
-	openNodes.pop();
-	openNodes.check_heap_property(0);
+	openNodes->pop();
+	openNodes->check_heap_property(0);
 
 	#ifdef QTPFS_TRACE_PATH_SEARCHES
 	searchIter.SetPoppedNodeIdx(curNode->zmin() * mapDims.mapx + curNode->xmin());
@@ -187,14 +191,18 @@ void QTPFS::PathSearch::IterateNodes(const std::vector<INode*>& allNodes) {
 		minNode = curNode;
 	#endif
 
-	IterateNodeNeighbors(curNode->GetNeighbors(allNodes));
+	// NOTE: must be called before GetNumNeighbors, it might update the cache
+	INode* const* nxtNodes = curNode->GetNeighbors(*nodeLayer);
+
+	IterateNodeNeighbors(nxtNodes, curNode->GetNumNeighbors());
 }
 
-void QTPFS::PathSearch::IterateNodeNeighbors(const std::vector<INode*>& nxtNodes) {
+void QTPFS::PathSearch::IterateNodeNeighbors(INode* const* nxtNodes, unsigned int numNxtNodes) {
 	// if curNode equals srcNode, this is just the original srcPoint
-	const float3 curPoint = curNode->GetNeighborEdgeTransitionPoint(0);
+	const float3 curPoint = curNode->GetPathPoint();
+	const float3* nxtPoints = curNode->GetNeighborEdgeTransitionPoints(*nodeLayer);
 
-	for (unsigned int i = 0; i < nxtNodes.size(); i++) {
+	for (unsigned int i = 0; i < numNxtNodes; i++) {
 		// NOTE:
 		//   this uses the actual distance that edges of the final path will cover,
 		//   from <curPoint> (initialized to sourcePoint) to a position on the edge
@@ -230,7 +238,7 @@ void QTPFS::PathSearch::IterateNodeNeighbors(const std::vector<INode*>& nxtNodes
 			// to be fancy (note that this is not always the best
 			// option, it causes local and global sub-optimalities
 			// which SmoothPath can only partially address)
-			netPoints[0] = curNode->GetNeighborEdgeTransitionPoint(1 + i);
+			netPoints[0] = nxtPoints[i];
 
 			// cannot use squared-distances because that will bias paths
 			// towards smaller nodes (eg. 1^2 + 1^2 + 1^2 + 1^2 != 4^2)
@@ -250,7 +258,7 @@ void QTPFS::PathSearch::IterateNodeNeighbors(const std::vector<INode*>& nxtNodes
 		// not handle; more points means a greater degree
 		// of non-cardinality (but gets expensive quickly)
 		for (unsigned int j = 0; j < QTPFS_MAX_NETPOINTS_PER_NODE_EDGE; j++) {
-			netPoints[j] = curNode->GetNeighborEdgeTransitionPoint(1 + i * QTPFS_MAX_NETPOINTS_PER_NODE_EDGE + j);
+			netPoints[j] = nxtPoints[i * QTPFS_MAX_NETPOINTS_PER_NODE_EDGE + j];
 
 			gDists[j] = curPoint.distance(netPoints[j]);
 			hDists[j] = tgtPoint.distance(netPoints[j]);
@@ -269,8 +277,8 @@ void QTPFS::PathSearch::IterateNodeNeighbors(const std::vector<INode*>& nxtNodes
 		if (!isCurrent) {
 			UpdateNode(nxtNode, curNode, netPointIdx);
 
-			openNodes.push(nxtNode);
-			openNodes.check_heap_property(0);
+			openNodes->push(nxtNode);
+			openNodes->check_heap_property(0);
 
 			#ifdef QTPFS_TRACE_PATH_SEARCHES
 			searchIter.AddPushedNodeIdx(nxtNode->zmin() * mapDims.mapx + nxtNode->xmin());
@@ -281,7 +289,7 @@ void QTPFS::PathSearch::IterateNodeNeighbors(const std::vector<INode*>& nxtNodes
 		if (gCosts[netPointIdx] >= nxtNode->GetPathCost(NODE_PATH_COST_G))
 			continue;
 		if (isClosed)
-			openNodes.push(nxtNode);
+			openNodes->push(nxtNode);
 
 		UpdateNode(nxtNode, curNode, netPointIdx);
 
@@ -289,8 +297,8 @@ void QTPFS::PathSearch::IterateNodeNeighbors(const std::vector<INode*>& nxtNodes
 		// (changing the f-cost of an OPEN node messes up the
 		// queue's internal consistency; a pushed node remains
 		// OPEN until it gets popped)
-		openNodes.resort(nxtNode);
-		openNodes.check_heap_property(0);
+		openNodes->resort(nxtNode);
+		openNodes->check_heap_property(0);
 	}
 }
 
@@ -318,7 +326,7 @@ void QTPFS::PathSearch::TracePath(IPath* path) {
 		float3 prvPoint = tgtPoint;
 
 		while ((prvNode != nullptr) && (tmpNode != srcNode)) {
-			const float3& tmpPoint = tmpNode->GetNeighborEdgeTransitionPoint(0);
+			const float3& tmpPoint = tmpNode->GetPathPoint();
 
 			assert(!math::isinf(tmpPoint.x) && !math::isinf(tmpPoint.z));
 			assert(!math::isnan(tmpPoint.x) && !math::isnan(tmpPoint.z));
@@ -93,7 +93,8 @@ namespace QTPFS {
 		) = 0;
 		virtual bool Execute(
 			unsigned int searchStateOffset = 0,
-			unsigned int searchMagicNumber = 0
+			unsigned int searchMagicNumber = 0,
+			unsigned int searchThreadNum = 0
 		) = 0;
 		virtual void Finalize(IPath* path) = 0;
 		virtual bool SharedFinalize(const IPath* srcPath, IPath* dstPath) { return false; }
@@ -120,6 +121,7 @@ namespace QTPFS {
 	public:
 		PathSearch(unsigned int pathSearchType)
 			: IPathSearch(pathSearchType)
+			, openNodes(NULL)
 			, nodeLayer(NULL)
 			, pathCache(NULL)
 			, searchExec(NULL)
@@ -132,7 +134,6 @@ namespace QTPFS {
 			, haveFullPath(false)
 			, havePartPath(false)
 			{}
-		~PathSearch() { openNodes.reset(); }
 
 		void Initialize(
 			NodeLayer* layer,
@@ -143,7 +144,8 @@ namespace QTPFS {
 		);
 		bool Execute(
 			unsigned int searchStateOffset = 0,
-			unsigned int searchMagicNumber = 0
+			unsigned int searchMagicNumber = 0,
+			unsigned int searchThreadNum = 0
 		);
 		void Finalize(IPath* path);
 		bool SharedFinalize(const IPath* srcPath, IPath* dstPath);
@@ -151,23 +153,34 @@ namespace QTPFS {
 
 		const std::uint64_t GetHash(std::uint64_t N, std::uint32_t k) const;
 
-		static void InitGlobalQueue(unsigned int n) { openNodes.reserve(n); }
-		static void FreeGlobalQueue() { openNodes.clear(); }
+		static void InitGlobalQueues(unsigned int n, unsigned int numQueues) {
+			openNodeQueues.resize(numQueues);
+
+			for (binary_heap<INode*>& queue: openNodeQueues) {
+				queue.reserve(n);
+			}
+		}
+		static void FreeGlobalQueues() { openNodeQueues.clear(); }
+		static unsigned int GetNumGlobalQueues() { return (openNodeQueues.size()); }
 
 	private:
 		void ResetState(INode* node);
 		void UpdateNode(INode* nextNode, INode* prevNode, unsigned int netPointIdx);
 
-		void IterateNodes(const std::vector<INode*>& allNodes);
-		void IterateNodeNeighbors(const std::vector<INode*>& nxtNodes);
+		void IterateNodes();
+		void IterateNodeNeighbors(INode* const* nxtNodes, unsigned int numNxtNodes);
 
 		void TracePath(IPath* path);
 		void SmoothPath(IPath* path) const;
 		bool SmoothPathIter(IPath* path) const;
 
-		// global queue: allocated once, re-used by all searches without clear()'s
+		// global queues: allocated once, re-used by all searches without clear()'s
 		// this relies on INode::operator< to sort the INode*'s by increasing f-cost
-		static binary_heap<INode*> openNodes;
+		// there is one queue per thread that can execute searches (concurrently, on
+		// different layers), each search uses the one given by its searchThreadNum
+		static std::vector< binary_heap<INode*> > openNodeQueues;
+
+		binary_heap<INode*>* openNodes;
 
 		NodeLayer* nodeLayer;
 		PathCache* pathCache;
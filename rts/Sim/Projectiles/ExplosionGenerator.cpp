@@ -4,6 +4,8 @@
 #include <stdexcept>
 #include <cassert>
 #include <cinttypes>
+#include <cstring>
+#include <algorithm>
 
 #include "ExplosionGenerator.h"
 #include "ExpGenSpawner.h" //!!
@@ -17,6 +19,7 @@
 #include "Rendering/Env/Particles/ProjectileDrawer.h"
 #include "Rendering/Textures/ColorMap.h"
 #include "Rendering/Textures/TextureAtlas.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Projectiles/ProjectileHandler.h"
 #include "Sim/Projectiles/ProjectileMemPool.h"
 #include "Rendering/Env/Particles/Classes/BubbleProjectile.h"
@@ -83,6 +86,11 @@ CR_REG_METADATA(CCustomExplosionGenerator, (
 
 
 
+CONFIG(int, CEGSpawnBudget).defaultValue(0).minimumValue(0).description("Maximum number of CEG particles spawned per simulation frame, 0 is unlimited. Explosions with a lower level-of-detail priority (far away or out of view) lose access to the budget first.");
+CONFIG(float, CEGOffscreenSpawnScale).defaultValue(1.0f).minimumValue(0.0f).maximumValue(1.0f).description("Multiplier for the particle counts of explosions outside the camera's view, 0 skips them entirely.");
+CONFIG(float, CEGSpawnLODDistance).defaultValue(0.0f).minimumValue(0.0f).description("Camera distance in elmos beyond which explosion particle counts fall off inversely with distance, 0 disables distance scaling.");
+CONFIG(float, CEGLoadReductionThreshold).defaultValue(1.0f).minimumValue(0.0f).maximumValue(1.0f).description("Fraction of MaxParticles above which explosion particle counts are reduced linearly, reaching zero at the limit.");
+
 static DynMemPool<sizeof(CCustomExplosionGenerator)> egMemPool;
 
 CExplosionGeneratorHandler* explGenHandler = nullptr;
@@ -192,6 +200,11 @@ CExplosionGeneratorHandler::CExplosionGeneratorHandler()
 	aliasParser = nullptr;
 	explTblRoot = nullptr;
 
+	spawnBudget = configHandler->GetInt("CEGSpawnBudget");
+	offscreenSpawnScale = configHandler->GetFloat("CEGOffscreenSpawnScale");
+	spawnLODDistance = configHandler->GetFloat("CEGSpawnLODDistance");
+	loadReductionThreshold = configHandler->GetFloat("CEGLoadReductionThreshold");
+
 	ParseExplosionTables();
 }
 
@@ -373,8 +386,65 @@ bool CExplosionGeneratorHandler::GenExplosion(
 
 	if (expGen == nullptr)
 		return false;
+	// purely visual; nothing to spawn while catching up
+	// (both generator types would also have returned true)
+	if (gu->fastForwarding)
+		return true;
+
+	// nested calls (useDefaultExplosions) are covered by the outer explosion
+	if (genExplosionDepth > 0)
+		return (expGen->Explosion(pos, dir, damage, radius, gfxMod, owner, hit));
+
+	if ((spawnScale = GetSpawnPriority(pos, radius)) <= 0.0f) {
+		spawnScale = 1.0f;
+		return true;
+	}
 
-	return (expGen->Explosion(pos, dir, damage, radius, gfxMod, owner, hit));
+	genExplosionDepth += 1;
+
+	// CStdExplosionGenerator derives its particle counts from gfxMod, CCEG's
+	// scale their spawn-counts by spawnScale
+	const bool ret = expGen->Explosion(pos, dir, damage, radius, gfxMod * spawnScale, owner, hit);
+
+	genExplosionDepth -= 1;
+	spawnScale = 1.0f;
+	return ret;
+}
+
+float CExplosionGeneratorHandler::GetSpawnPriority(const float3& pos, float radius)
+{
+	float priority = 1.0f;
+
+	if (offscreenSpawnScale < 1.0f && !camera->InView(pos, std::max(radius, 1.0f) * 2.0f))
+		priority *= offscreenSpawnScale;
+
+	if (spawnLODDistance > 0.0f) {
+		const float camDist = camera->GetPos().distance(pos);
+
+		if (camDist > spawnLODDistance)
+			priority *= (spawnLODDistance / camDist);
+	}
+
+	if (loadReductionThreshold < 1.0f) {
+		const float saturation = projectileHandler->GetParticleSaturation(false);
+		const float reduction = (saturation - loadReductionThreshold) / (1.0f - loadReductionThreshold);
+
+		priority *= Clamp(1.0f - reduction, 0.0f, 1.0f);
+	}
+
+	if (spawnBudget == 0 || priority <= 0.0f)
+		return priority;
+
+	if (spawnBudgetFrame != gs->frameNum) {
+		spawnBudgetFrame = gs->frameNum;
+		spawnBudgetUsed = 0;
+	}
+
+	// low-priority explosions may only use a proportional part of the budget
+	if (spawnBudgetUsed >= (spawnBudget * priority))
+		return 0.0f;
+
+	return priority;
 }
 
 
@@ -603,13 +673,43 @@ bool CStdExplosionGenerator::Explosion(
 
 
 
-void CCustomExplosionGenerator::ExecuteExplosionCode(const char* code, float damage, char* instance, int spawnIndex, const float3& dir)
-{
-	float val = 0.0f;
-	void* ptr = NULL;
-	float buffer[16];
+// scratch-space for batched script evaluation; per-instance values and
+// yank-buffers are stored as rows of numInstances floats (SoA)
+static std::vector<CExpGenSpawnable*> cegSpawnables;
+static std::vector<float> cegValues;
+static std::vector<float> cegBuffers;
 
-	std::memset(&buffer[0], 0, 16 * sizeof(float));
+void CCustomExplosionGenerator::ExecuteExplosionCode(
+	const char* code,
+	float damage,
+	CExpGenSpawnable** instances,
+	unsigned int numInstances,
+	const float3& dir
+) {
+	// every op is decoded once and then applied to all instances, rather
+	// than interpreting the whole script again for each spawned particle
+	cegValues.clear();
+	cegValues.resize(numInstances, 0.0f);
+	cegBuffers.resize(CEG_BUFFER_SIZE * numInstances);
+
+	float* vals = cegValues.data();
+	void* ptr = nullptr;
+
+	// buffer rows are only zeroed on first use; a yank overwrites a full row
+	unsigned int bufferRows = 0;
+
+	const auto GetBufferRow = [&](int slot, bool write) {
+		float* row = &cegBuffers[slot * numInstances];
+
+		if ((bufferRows & (1u << slot)) == 0 && !write)
+			std::fill(row, row + numInstances, 0.0f);
+
+		bufferRows |= (1u << slot);
+		return row;
+	};
+	const auto GetCodeFloat = [](const char*& code) { float f; std::memcpy(&f, code, sizeof(f)); code += sizeof(f); return f; };
+	const auto GetCodeInt = [](const char*& code) { int i; std::memcpy(&i, code, sizeof(i)); code += sizeof(i); return i; };
+	const auto GetCodeOffset = [](const char*& code) { std::uint16_t o; std::memcpy(&o, code, sizeof(o)); code += sizeof(o); return o; };
 
 	for (;;) {
 		switch (*(code++)) {
@@ -617,107 +717,123 @@ void CCustomExplosionGenerator::ExecuteExplosionCode(const char* code, float dam
 				return;
 			}
 			case OP_STOREI: {
-				std::uint8_t  size   = *(std::uint8_t*)  code; code++;
-				std::uint16_t offset = *(std::uint16_t*) code; code += 2;
-				switch (size) {
-					case 1: { *(std::int8_t*)  (instance + offset) = (int) val; } break;
-					case 2: { *(std::int16_t*) (instance + offset) = (int) val; } break;
-					case 4: { *(std::int32_t*) (instance + offset) = (int) val; } break;
-					case 8: { *(std::int64_t*) (instance + offset) = (int) val; } break;
-					default: { /*no op*/ } break;
+				const std::uint8_t  size   = *(std::uint8_t*)  code; code++;
+				const std::uint16_t offset = GetCodeOffset(code);
+
+				for (unsigned int n = 0; n < numInstances; n++) {
+					char* instance = reinterpret_cast<char*>(instances[n]);
+
+					switch (size) {
+						case 1: { *(std::int8_t*)  (instance + offset) = (int) vals[n]; } break;
+						case 2: { *(std::int16_t*) (instance + offset) = (int) vals[n]; } break;
+						case 4: { *(std::int32_t*) (instance + offset) = (int) vals[n]; } break;
+						case 8: { *(std::int64_t*) (instance + offset) = (int) vals[n]; } break;
+						default: { /*no op*/ } break;
+					}
+
+					vals[n] = 0.0f;
 				}
-				val = 0.0f;
 				break;
 			}
 			case OP_STOREF: {
-				std::uint8_t  size   = *(std::uint8_t*)  code; code++;
-				std::uint16_t offset = *(std::uint16_t*) code; code += 2;
-				switch (size) {
-					case 4: { *(float*)  (instance + offset) = val; } break;
-					case 8: { *(double*) (instance + offset) = val; } break;
-					default: { /*no op*/ } break;
+				const std::uint8_t  size   = *(std::uint8_t*)  code; code++;
+				const std::uint16_t offset = GetCodeOffset(code);
+
+				for (unsigned int n = 0; n < numInstances; n++) {
+					char* instance = reinterpret_cast<char*>(instances[n]);
+
+					switch (size) {
+						case 4: { *(float*)  (instance + offset) = vals[n]; } break;
+						case 8: { *(double*) (instance + offset) = vals[n]; } break;
+						default: { /*no op*/ } break;
+					}
+
+					vals[n] = 0.0f;
 				}
-				val = 0.0f;
 				break;
 			}
 			case OP_ADD: {
-				val += *(float*) code;
-				code += 4;
+				const float v = GetCodeFloat(code);
+				for (unsigned int n = 0; n < numInstances; n++) { vals[n] += v; }
 				break;
 			}
 			case OP_RAND: {
-				val += guRNG.NextFloat() * (*(float*) code);
-				code += 4;
+				const float v = GetCodeFloat(code);
+				for (unsigned int n = 0; n < numInstances; n++) { vals[n] += (guRNG.NextFloat() * v); }
 				break;
 			}
 			case OP_DAMAGE: {
-				val += damage * (*(float*) code);
-				code += 4;
+				const float v = damage * GetCodeFloat(code);
+				for (unsigned int n = 0; n < numInstances; n++) { vals[n] += v; }
 				break;
 			}
 			case OP_INDEX: {
-				val += spawnIndex * (*(float*) code);
-				code += 4;
+				const float v = GetCodeFloat(code);
+				for (unsigned int n = 0; n < numInstances; n++) { vals[n] += (n * v); }
 				break;
 			}
 			case OP_LOADP: {
-				ptr = *(void**) code;
+				std::memcpy(&ptr, code, sizeof(void*));
 				code += sizeof(void*);
 				break;
 			}
 			case OP_STOREP: {
-				std::uint16_t offset = *(std::uint16_t*) code;
-				code += 2;
-				*(void**) (instance + offset) = ptr;
-				ptr = NULL;
+				const std::uint16_t offset = GetCodeOffset(code);
+
+				for (unsigned int n = 0; n < numInstances; n++) {
+					*(void**) (reinterpret_cast<char*>(instances[n]) + offset) = ptr;
+				}
+
+				ptr = nullptr;
 				break;
 			}
 			case OP_DIR: {
-				std::uint16_t offset = *(std::uint16_t*) code;
-				code += 2;
-				*reinterpret_cast<float3*>(instance + offset) = dir;
+				const std::uint16_t offset = GetCodeOffset(code);
+
+				for (unsigned int n = 0; n < numInstances; n++) {
+					*reinterpret_cast<float3*>(reinterpret_cast<char*>(instances[n]) + offset) = dir;
+				}
 				break;
 			}
 			case OP_SAWTOOTH: {
 				// this translates to modulo except it works with floats
-				val -= (*(float*) code) * math::floor(val / (*(float*) code));
-				code += 4;
+				const float v = GetCodeFloat(code);
+				for (unsigned int n = 0; n < numInstances; n++) { vals[n] -= (v * math::floor(vals[n] / v)); }
 				break;
 			}
 			case OP_DISCRETE: {
-				val = (*(float*) code) * math::floor(spring::SafeDivide(val, (*(float*) code)));
-				code += 4;
+				const float v = GetCodeFloat(code);
+				for (unsigned int n = 0; n < numInstances; n++) { vals[n] = v * math::floor(spring::SafeDivide(vals[n], v)); }
 				break;
 			}
 			case OP_SINE: {
-				val = (*(float*) code) * math::sin(val);
-				code += 4;
+				const float v = GetCodeFloat(code);
+				for (unsigned int n = 0; n < numInstances; n++) { vals[n] = v * math::sin(vals[n]); }
 				break;
 			}
 			case OP_YANK: {
-				buffer[(*(int*) code)] = val;
-				val = 0;
-				code += 4;
+				float* row = GetBufferRow(GetCodeInt(code), true);
+				for (unsigned int n = 0; n < numInstances; n++) { row[n] = vals[n]; vals[n] = 0.0f; }
 				break;
 			}
 			case OP_MULTIPLY: {
-				val *= buffer[(*(int*) code)];
-				code += 4;
+				const float* row = GetBufferRow(GetCodeInt(code), false);
+				for (unsigned int n = 0; n < numInstances; n++) { vals[n] *= row[n]; }
 				break;
 			}
 			case OP_ADDBUFF: {
-				val += buffer[(*(int*) code)];
-				code += 4;
+				const float* row = GetBufferRow(GetCodeInt(code), false);
+				for (unsigned int n = 0; n < numInstances; n++) { vals[n] += row[n]; }
 				break;
 			}
 			case OP_POW: {
-				val = math::pow(val, (*(float*) code));
-				code += 4;
+				const float v = GetCodeFloat(code);
+				for (unsigned int n = 0; n < numInstances; n++) { vals[n] = math::pow(vals[n], v); }
 				break;
 			}
 			case OP_POWBUFF: {
-				val = math::pow(val, buffer[(*(int*) code)]);
-				code += 4;
+				const float* row = GetBufferRow(GetCodeInt(code), false);
+				for (unsigned int n = 0; n < numInstances; n++) { vals[n] = math::pow(vals[n], row[n]); }
 				break;
 			}
 			default: {
@@ -843,7 +959,7 @@ void CCustomExplosionGenerator::ParseExplosionCode(
 			code += opcode;
 			code.append((char*) &v, ((char*) &v) + sizeof(v));
 		} else {
-			const int v = std::max(0, std::min(16, (int)strtol(&script.c_str()[p], &endp, 10)));
+			const int v = std::max(0, std::min(CEG_BUFFER_SIZE - 1, (int)strtol(&script.c_str()[p], &endp, 10)));
 
 			p += (endp - &script.c_str()[p]);
 			code += opcode;
@@ -982,11 +1098,23 @@ bool CCustomExplosionGenerator::Explosion(
 		if (projectileHandler->GetParticleSaturation() > 1.0f)
 			break;
 
-		for (unsigned int c = 0; c < psi.count; c++) {
-			CExpGenSpawnable* projectile = CExpGenSpawnable::CreateSpawnable(psi.spawnableID);
-			ExecuteExplosionCode(&psi.code[0], damage, (char*) projectile, c, dir);
+		// round the scaled count stochastically so small spawns are not always lost
+		const float spawnScale = explGenHandler->GetSpawnScale();
+		const unsigned int spawnCount = (spawnScale < 1.0f)? std::min(psi.count, unsigned(psi.count * spawnScale + guRNG.NextFloat())): psi.count;
+
+		cegSpawnables.clear();
+
+		for (unsigned int c = 0; c < spawnCount; c++) {
+			cegSpawnables.push_back(CExpGenSpawnable::CreateSpawnable(psi.spawnableID));
+		}
+
+		ExecuteExplosionCode(&psi.code[0], damage, cegSpawnables.data(), cegSpawnables.size(), dir);
+
+		for (CExpGenSpawnable* projectile: cegSpawnables) {
 			projectile->Init(owner, pos);
 		}
+
+		explGenHandler->AddSpawnedParticles(spawnCount);
 	}
 
 	if (groundExplosion && (groundFlash.ttl > 0) && (groundFlash.flashSize > 1))
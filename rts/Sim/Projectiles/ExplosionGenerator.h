@@ -16,6 +16,7 @@ class LuaTable;
 class float3;
 class CUnit;
 class IExplosionGenerator;
+class CExpGenSpawnable;
 
 struct SExpGenSpawnableMemberInfo;
 
@@ -68,6 +69,14 @@ public:
 	const LuaTable* GetExplosionTableRoot() const { return explTblRoot; }
 	const ClassAliasList& GetProjectileClasses() const { return projectileClasses; }
 
+	/// multiplier for the spawn-counts of the explosion currently being generated
+	float GetSpawnScale() const { return spawnScale; }
+	void AddSpawnedParticles(unsigned int n) { spawnBudgetUsed += n; }
+
+private:
+	/// level-of-detail and budget priority of an explosion in (0, 1], or 0 to skip it
+	float GetSpawnPriority(const float3& pos, float radius);
+
 protected:
 	ClassAliasList projectileClasses;
 
@@ -82,6 +91,19 @@ protected:
 
 	typedef spring::unordered_map<std::string, unsigned int>::const_iterator TagIdentMapConstIt;
 	typedef spring::unordered_map<unsigned int, std::string>::const_iterator IdentTagMapConstIt;
+
+	float spawnScale = 1.0f;
+	/// >0 while inside GenExplosion, nested explosions inherit the outer scale
+	unsigned int genExplosionDepth = 0;
+
+	int spawnBudgetFrame = -1;
+	unsigned int spawnBudgetUsed = 0;
+
+	// configured in CExplosionGeneratorHandler(), see CEG* options
+	unsigned int spawnBudget = 0;
+	float offscreenSpawnScale = 1.0f;
+	float spawnLODDistance = 0.0f;
+	float loadReductionThreshold = 1.0f;
 };
 
 
@@ -224,9 +246,13 @@ public:
 		OP_POWBUFF  = 18, // Power with buffer as exponent
 	};
 
+	/// number of yank-buffer slots addressable by scripts
+	static constexpr int CEG_BUFFER_SIZE = 16;
+
 private:
 	void ParseExplosionCode(ProjectileSpawnInfo* psi, const std::string& script, SExpGenSpawnableMemberInfo& memberInfo, std::string& code);
-	void ExecuteExplosionCode(const char* code, float damage, char* instance, int spawnIndex, const float3& dir);
+	/// evaluates the script for all instances of a spawn at once
+	void ExecuteExplosionCode(const char* code, float damage, CExpGenSpawnable** instances, unsigned int numInstances, const float3& dir);
 
 protected:
 	ExpGenParams expGenParams;
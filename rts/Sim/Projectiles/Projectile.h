@@ -43,6 +43,13 @@ public:
 	//Not inheritable - used for removing a projectile from Lua.
 	void Delete();
 	virtual void Update();
+	// two-phase variant of Update, used for synced projectiles when the
+	// allowParallelProjectileUpdates modrule is set: UpdateCompute can run
+	// on any thread and may only modify the projectile itself (no spawning,
+	// damage or RNG use); it returns true if work was deferred to UpdateCommit
+	// which runs serially in projectile-ID order
+	virtual bool UpdateCompute() { return true; }
+	virtual void UpdateCommit() { Update(); }
 	virtual void Init(const CUnit* owner, const float3& offset) override;
 
 	virtual void Draw(GL::RenderDataBufferTC* va) const {}
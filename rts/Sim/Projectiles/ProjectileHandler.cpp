@@ -5,6 +5,7 @@
 #include "Projectile.h"
 #include "ProjectileHandler.h"
 #include "ProjectileMemPool.h"
+#include "Game/GameHelper.h"
 #include "Game/GlobalUnsynced.h"
 #include "Game/TraceRay.h"
 #include "Map/Ground.h"
@@ -14,7 +15,9 @@
 #include "Sim/Features/FeatureDef.h"
 #include "Sim/Misc/CollisionHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/QuadField.h"
+#include "Sim/Misc/SimCostProfiler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Rendering/Env/Particles/Classes/FlyingPiece.h"
 #include "Rendering/Env/Particles/Classes/NanoProjectile.h"
@@ -29,6 +32,7 @@
 #include "System/Log/ILog.h"
 #include "System/myMath.h"
 #include "System/TimeProfiler.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/creg/STL_Deque.h"
 
 
@@ -41,6 +45,7 @@ using namespace std;
 
 CONFIG(int, MaxParticles).defaultValue(10000).headlessValue(1).minimumValue(1);
 CONFIG(int, MaxNanoParticles).defaultValue(2000).headlessValue(1).minimumValue(1);
+CONFIG(int, MaxGroundFlashes).defaultValue(4096).headlessValue(1).minimumValue(1).description("Maximum number of live ground-flashes, the oldest are removed first when exceeded.");
 
 
 CR_BIND(CProjectileHandler, )
@@ -53,6 +58,7 @@ CR_REG_METADATA(CProjectileHandler, (
 
 	CR_MEMBER(maxParticles),
 	CR_MEMBER(maxNanoParticles),
+	CR_MEMBER(maxGroundFlashes),
 	CR_MEMBER(currentNanoParticles),
 	CR_MEMBER_UN(lastCurrentParticles),
 	CR_MEMBER_UN(lastSyncedProjectilesCount),
@@ -88,6 +94,7 @@ CProjectileHandler::CProjectileHandler()
 {
 	maxParticles     = configHandler->GetInt("MaxParticles");
 	maxNanoParticles = configHandler->GetInt("MaxNanoParticles");
+	maxGroundFlashes = configHandler->GetInt("MaxGroundFlashes");
 
 	projMemPool.clear();
 	projMemPool.reserve(1024);
@@ -108,7 +115,7 @@ CProjectileHandler::CProjectileHandler()
 	}
 
 	// register ConfigNotify()
-	configHandler->NotifyOnChange(this, {"MaxParticles", "MaxNanoParticles"});
+	configHandler->NotifyOnChange(this, {"MaxParticles", "MaxNanoParticles", "MaxGroundFlashes"});
 }
 
 CProjectileHandler::~CProjectileHandler()
@@ -157,6 +164,7 @@ void CProjectileHandler::ConfigNotify(const std::string& key, const std::string&
 {
 	maxParticles     = configHandler->GetInt("MaxParticles");
 	maxNanoParticles = configHandler->GetInt("MaxNanoParticles");
+	maxGroundFlashes = configHandler->GetInt("MaxGroundFlashes");
 }
 
 
@@ -228,11 +236,63 @@ void CProjectileHandler::UpdateProjectileContainer(ProjectileContainer& pc, bool
 
 	SCOPED_TIMER("Sim::Projectiles::Update");
 
+	// weapon projectiles are attributed to their WeaponDef, the rest is not recorded
+	const auto GetWeaponDefID = [](const CProjectile* p) {
+		return (p->weapon? static_cast<const CWeaponProjectile*>(p)->GetWeaponDef()->id: -1);
+	};
+
+	size_t numUpdated = 0;
+
+	if (synced && modInfo.allowParallelProjectileUpdates) {
+		// per-thread queues of projectiles whose side-effects were deferred
+		static std::array<std::vector<CProjectile*>, ThreadPool::MAX_THREADS> deferredQueues;
+		static std::vector<CProjectile*> commitQueue;
+
+		numUpdated = pc.size();
+
+		for_mt(0, numUpdated, [&](const int i) {
+			CProjectile* p = pc[i];
+			CSimCostProfiler::ScopedCost cost(CSimCostProfiler::CATEGORY_WEAPONDEF, GetWeaponDefID(p), CSimCostProfiler::PART_WEAPON_PROJECTILES);
+
+			MAPPOS_SANITY_CHECK(p->pos);
+
+			if (p->UpdateCompute())
+				deferredQueues[ThreadPool::GetThreadNum()].push_back(p);
+		});
+
+		for (auto& queue: deferredQueues) {
+			commitQueue.insert(commitQueue.end(), queue.begin(), queue.end());
+			queue.clear();
+		}
+
+		// merge order must not depend on how the work was split
+		std::sort(commitQueue.begin(), commitQueue.end(), [](const CProjectile* a, const CProjectile* b) { return (a->id < b->id); });
+
+		// creations and explosions happen here; new projectiles are appended
+		// to <pc> and receive a regular update below like in the serial path
+		for (CProjectile* p: commitQueue) {
+			CSimCostProfiler::ScopedCost cost(CSimCostProfiler::CATEGORY_WEAPONDEF, GetWeaponDefID(p), CSimCostProfiler::PART_WEAPON_PROJECTILES);
+			p->UpdateCommit();
+		}
+
+		commitQueue.clear();
+
+		for (size_t i = 0; i < numUpdated; ++i) {
+			CProjectile* p = pc[i];
+
+			quadField->MovedProjectile(p);
+
+			MAPPOS_SANITY_CHECK(p->pos);
+		}
+	}
+
 	// WARNING: same as above but for p->Update()
-	for (size_t i = 0; i < pc.size(); ++i) {
+	for (size_t i = numUpdated; i < pc.size(); ++i) {
 		CProjectile* p = pc[i];
 		assert(p != nullptr);
 
+		CSimCostProfiler::ScopedCost cost(CSimCostProfiler::CATEGORY_WEAPONDEF, GetWeaponDefID(p), CSimCostProfiler::PART_WEAPON_PROJECTILES);
+
 		MAPPOS_SANITY_CHECK(p->pos);
 
 		p->Update();
@@ -243,26 +303,26 @@ void CProjectileHandler::UpdateProjectileContainer(ProjectileContainer& pc, bool
 }
 
 
+// keeps items in creation order, so the oldest go first when over maxSize
 template<class T>
-static void UPDATE_PTR_CONTAINER(T& cont) {
+static void UPDATE_PTR_CONTAINER(T& cont, size_t maxSize) {
 	if (cont.empty())
 		return;
 
-#ifndef NDEBUG
 	const size_t origSize = cont.size();
-#endif
-	size_t size = cont.size();
+	const size_t numOver = origSize - std::min(origSize, maxSize);
 
-	for (unsigned int i = 0; i < size; /*no-op*/) {
-		CGroundFlash*& gf = cont[i];
+	size_t size = 0;
+
+	for (size_t i = 0; i < origSize; i++) {
+		CGroundFlash* gf = cont[i];
 
-		if (!gf->Update()) {
+		if (i < numOver || !gf->Update()) {
 			projMemPool.free(gf);
-			gf = cont[size -= 1];
 			continue;
 		}
 
-		++i;
+		cont[size++] = gf;
 	}
 
 	// WARNING:
@@ -273,10 +333,11 @@ static void UPDATE_PTR_CONTAINER(T& cont) {
 	cont.erase(cont.begin() + size, cont.end());
 }
 
+// returns true if any items were removed (which reorders the container)
 template<class T>
-static void UPDATE_REF_CONTAINER(T& cont) {
+static bool UPDATE_REF_CONTAINER(T& cont) {
 	if (cont.empty())
-		return;
+		return false;
 
 #ifndef NDEBUG
 	const size_t origSize = cont.size();
@@ -298,7 +359,11 @@ static void UPDATE_REF_CONTAINER(T& cont) {
 	// we didn't update the newest items
 	assert(cont.size() == origSize);
 
+	if (size == cont.size())
+		return false;
+
 	cont.erase(cont.begin() + size, cont.end());
+	return true;
 }
 
 
@@ -308,21 +373,24 @@ void CProjectileHandler::Update()
 		SCOPED_TIMER("Sim::Projectiles");
 
 		// particles
+		helper->BeginExplosionBatch(modInfo.allowBatchedExplosionDamage);
 		CheckCollisions(); // before :Update() to check if the particles move into stuff
 		UpdateProjectileContainer(syncedProjectiles, true);
+		helper->FlushExplosionBatch();
 		UpdateProjectileContainer(unsyncedProjectiles, false);
 
 		// groundflashes
-		UPDATE_PTR_CONTAINER(groundFlashes);
+		UPDATE_PTR_CONTAINER(groundFlashes, maxGroundFlashes);
 
-		// flying pieces; sort these every now and then
+		// flying pieces; sort these only when the set has changed
 		for (int modelType = 0; modelType < MODELTYPE_OTHER; ++modelType) {
 			auto& fpc = flyingPieces[modelType];
 
-			UPDATE_REF_CONTAINER(fpc);
+			resortFlyingPieces[modelType] |= UPDATE_REF_CONTAINER(fpc);
 
 			if (resortFlyingPieces[modelType]) {
 				std::stable_sort(fpc.begin(), fpc.end());
+				resortFlyingPieces[modelType] = false;
 			}
 		}
 	}
@@ -439,7 +507,7 @@ void CProjectileHandler::CheckUnitCollisions(
 	if (!p->checkCol)
 		return;
 
-	CollisionQuery cq;
+	static std::vector<const CSolidObject*> tempObjects;
 
 	for (CUnit* unit: tempUnits) {
 		assert(unit != nullptr);
@@ -453,21 +521,29 @@ void CProjectileHandler::CheckUnitCollisions(
 		if (!CheckProjectileCollisionFlags(p, unit))
 			continue;
 
-		if (CCollisionHandler::DetectHit(unit, unit->GetTransformMatrix(true), ppos0, ppos1, &cq)) {
-			if (cq.GetHitPiece() != nullptr)
-				unit->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum);
+		tempObjects.push_back(unit);
+	}
+
+	CollisionQuery cq;
 
-			if (!cq.InsideHit()) {
-				p->SetPosition(cq.GetHitPos());
-				p->Collision(unit);
-				p->SetPosition(ppos0);
-			} else {
-				p->Collision(unit);
-			}
+	const int hitIndex = CCollisionHandler::DetectHitBatch(tempObjects.data(), tempObjects.size(), ppos0, ppos1, &cq);
 
-			break;
+	if (hitIndex >= 0) {
+		CUnit* unit = static_cast<CUnit*>(const_cast<CSolidObject*>(tempObjects[hitIndex]));
+
+		if (cq.GetHitPiece() != nullptr)
+			unit->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum);
+
+		if (!cq.InsideHit()) {
+			p->SetPosition(cq.GetHitPos());
+			p->Collision(unit);
+			p->SetPosition(ppos0);
+		} else {
+			p->Collision(unit);
 		}
 	}
+
+	tempObjects.clear();
 }
 
 void CProjectileHandler::CheckFeatureCollisions(
@@ -483,7 +559,7 @@ void CProjectileHandler::CheckFeatureCollisions(
 	if ((p->GetCollisionFlags() & Collision::NOFEATURES) != 0)
 		return;
 
-	CollisionQuery cq;
+	static std::vector<const CSolidObject*> tempObjects;
 
 	for (CFeature* feature: tempFeatures) {
 		assert(feature != nullptr);
@@ -491,21 +567,29 @@ void CProjectileHandler::CheckFeatureCollisions(
 		if (!feature->HasCollidableStateBit(CSolidObject::CSTATE_BIT_PROJECTILES))
 			continue;
 
-		if (CCollisionHandler::DetectHit(feature, feature->GetTransformMatrix(true), ppos0, ppos1, &cq)) {
-			if (cq.GetHitPiece() != nullptr)
-				feature->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum);
+		tempObjects.push_back(feature);
+	}
 
-			if (!cq.InsideHit()) {
-				p->SetPosition(cq.GetHitPos());
-				p->Collision(feature);
-				p->SetPosition(ppos0);
-			} else {
-				p->Collision(feature);
-			}
+	CollisionQuery cq;
+
+	const int hitIndex = CCollisionHandler::DetectHitBatch(tempObjects.data(), tempObjects.size(), ppos0, ppos1, &cq);
+
+	if (hitIndex >= 0) {
+		CFeature* feature = static_cast<CFeature*>(const_cast<CSolidObject*>(tempObjects[hitIndex]));
 
-			break;
+		if (cq.GetHitPiece() != nullptr)
+			feature->SetLastHitPiece(cq.GetHitPiece(), gs->frameNum);
+
+		if (!cq.InsideHit()) {
+			p->SetPosition(cq.GetHitPos());
+			p->Collision(feature);
+			p->SetPosition(ppos0);
+		} else {
+			p->Collision(feature);
 		}
 	}
+
+	tempObjects.clear();
 }
 
 
@@ -643,6 +727,9 @@ void CProjectileHandler::AddFlyingPiece(
 	const float2 pieceParams,
 	const int2 renderParams
 ) {
+	if (gu->fastForwarding)
+		return;
+
 	flyingPieces[model->type].emplace_back(model, piece, m, pos, speed, pieceParams, renderParams);
 	resortFlyingPieces[model->type] = true;
 }
@@ -661,6 +748,8 @@ void CProjectileHandler::AddNanoParticle(
 		return;
 	if (!unitDef->showNanoSpray)
 		return;
+	if (gu->fastForwarding)
+		return;
 
 	float3 dif = (endPos - startPos);
 	const float l = fastmath::apxsqrt2(dif.SqLength());
@@ -694,6 +783,8 @@ void CProjectileHandler::AddNanoParticle(
 		return;
 	if (!unitDef->showNanoSpray)
 		return;
+	if (gu->fastForwarding)
+		return;
 
 	float3 dif = (endPos - startPos);
 	const float l = fastmath::apxsqrt2(dif.SqLength());
@@ -74,6 +74,7 @@ public:
 public:
 	int maxParticles;              // different effects should start to cut down on unnececary(unsynced) particles when this number is reached
 	int maxNanoParticles;
+	int maxGroundFlashes;
 	int currentNanoParticles;
 
 	// these vars are used to precache parts of GetCurrentParticles() calculations
@@ -20,13 +20,17 @@ CR_BIND_DERIVED(CExplosiveProjectile, CWeaponProjectile, )
 CR_REG_METADATA(CExplosiveProjectile, (
 	CR_SETFLAG(CF_Synced),
 	CR_MEMBER(invttl),
-	CR_MEMBER(curTime)
+	CR_MEMBER(curTime),
+	CR_IGNORED(deferredEffects),
+	CR_IGNORED(deferredBounce)
 ))
 
 
 CExplosiveProjectile::CExplosiveProjectile(const ProjectileParams& params): CWeaponProjectile(params)
 	, invttl(0.0f)
 	, curTime(0.0f)
+	, deferredEffects(false)
+	, deferredBounce(false)
 {
 	projectileType = WEAPON_EXPLOSIVE_PROJECTILE;
 
@@ -74,6 +78,53 @@ void CExplosiveProjectile::Update()
 	UpdateInterception();
 }
 
+bool CExplosiveProjectile::UpdateCompute()
+{
+	CProjectile::Update();
+
+	--ttl;
+	curTime += invttl;
+	curTime = std::min(curTime, 1.0f);
+
+	const bool noExplodeHit = (weaponDef->noExplode && TraveledRange());
+
+	// a bounce scheduled last frame is resolved now and spawns its CEG
+	deferredBounce = bounced;
+	// expiry, trail CEG's and noExplode removal all happen before the
+	// bounce in Update(), so the bounce response has to wait with them
+	deferredEffects = (ttl == 0 || (ttl > 0 && cegID != -1u) || noExplodeHit || deferredBounce);
+
+	// without a pending bounce this only runs the (read-only) ground and
+	// water intersection test, which is the expensive part
+	if (!deferredBounce && !noExplodeHit)
+		UpdateGroundBounce();
+
+	return (deferredEffects || target != nullptr);
+}
+
+void CExplosiveProjectile::UpdateCommit()
+{
+	if (deferredEffects) {
+		if (ttl == 0) {
+			Collision();
+		} else {
+			if (ttl > 0) {
+				explGenHandler->GenExplosion(cegID, pos, speed, ttl, damages->damageAreaOfEffect, 0.0f, nullptr, nullptr);
+			}
+		}
+
+		if (weaponDef->noExplode && TraveledRange()) {
+			CProjectile::Collision();
+			return;
+		}
+
+		if (deferredBounce)
+			UpdateGroundBounce();
+	}
+
+	UpdateInterception();
+}
+
 void CExplosiveProjectile::Draw(GL::RenderDataBufferTC* va) const
 {
 	// do not draw if a 3D model has been defined for us
@@ -15,6 +15,8 @@ public:
 	CExplosiveProjectile(const ProjectileParams& params);
 
 	void Update() override;
+	bool UpdateCompute() override;
+	void UpdateCommit() override;
 	void Draw(GL::RenderDataBufferTC* va) const override;
 
 	int GetProjectilesCount() const override;
@@ -24,6 +26,10 @@ public:
 private:
 	float invttl;
 	float curTime;
+
+	// set by UpdateCompute for UpdateCommit
+	bool deferredEffects;
+	bool deferredBounce;
 };
 
 #endif // _EXPLOSIVE_PROJECTILE_H
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cassert>
 
 #include "BuilderCAI.h"
@@ -12,7 +13,9 @@
 #include "Sim/Features/Feature.h"
 #include "Sim/Features/FeatureDef.h"
 #include "Sim/Features/FeatureHandler.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/GroundBlockingObjectMap.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/Team.h"
 #include "Sim/Misc/TeamHandler.h"
@@ -57,6 +60,133 @@ spring::unordered_set<int> CBuilderCAI::featureReclaimers;
 spring::unordered_set<int> CBuilderCAI::resurrecters;
 
 
+// objects found in the circles of area commands, shared by all builders that
+// search the same circle during one SlowUpdate period (allowAreaTargetCache)
+struct AreaTargets {
+	float3 pos;
+	float radius;
+	int frame;
+
+	bool haveUnits;
+	bool haveFeatures;
+
+	std::vector<int> unitIDs;
+	std::vector<int> featureIDs;
+};
+
+static std::vector<AreaTargets> areaTargets;
+static std::vector<CUnit*> areaUnits;
+static std::vector<CFeature*> areaFeatures;
+
+static AreaTargets& GetAreaTargets(const float3& pos, float radius)
+{
+	// frames restart at zero when a new game is loaded
+	const auto isExpired = [](const AreaTargets& at) {
+		return (gs->frameNum < at.frame || gs->frameNum >= (at.frame + UNIT_SLOWUPDATE_RATE));
+	};
+
+	areaTargets.erase(std::remove_if(areaTargets.begin(), areaTargets.end(), isExpired), areaTargets.end());
+
+	for (AreaTargets& at: areaTargets) {
+		if (at.pos.x != pos.x || at.pos.y != pos.y || at.pos.z != pos.z)
+			continue;
+		if (at.radius != radius)
+			continue;
+
+		return at;
+	}
+
+	areaTargets.push_back({pos, radius, gs->frameNum, false, false, {}, {}});
+	return areaTargets.back();
+}
+
+static inline bool InAreaCircle(const CSolidObject* obj, const float3& pos, float radius)
+{
+	// same test as QuadField::Get*Exact
+	return (pos.SqDistance2D(obj->pos) < Square(radius + obj->radius));
+}
+
+/**
+ * Returns the units overlapping an area command's circle. The first search
+ * of a circle during a SlowUpdate period queries the QuadField, later ones
+ * reuse its result minus objects that died or left the circle since; units
+ * that enter the circle are seen at the next period.
+ */
+static const std::vector<CUnit*>& GetAreaUnits(QuadFieldQuery& qfQuery, const float3& pos, float radius, bool areaCmd)
+{
+	if (!areaCmd || !modInfo.allowAreaTargetCache) {
+		quadField->GetUnitsExact(qfQuery, pos, radius, false);
+		return *qfQuery.units;
+	}
+
+	AreaTargets& at = GetAreaTargets(pos, radius);
+
+	if (!at.haveUnits) {
+		quadField->GetUnitsExact(qfQuery, pos, radius, false);
+
+		at.unitIDs.clear();
+		at.haveUnits = true;
+
+		for (const CUnit* u: *qfQuery.units) {
+			at.unitIDs.push_back(u->id);
+		}
+
+		return *qfQuery.units;
+	}
+
+	areaUnits.clear();
+
+	for (const int unitID: at.unitIDs) {
+		CUnit* u = unitHandler->GetUnit(unitID);
+
+		// also catches IDs that were recycled by a unit elsewhere
+		if (u == nullptr || !InAreaCircle(u, pos, radius))
+			continue;
+
+		areaUnits.push_back(u);
+	}
+
+	return areaUnits;
+}
+
+/// see GetAreaUnits
+static const std::vector<CFeature*>& GetAreaFeatures(QuadFieldQuery& qfQuery, const float3& pos, float radius, bool areaCmd)
+{
+	if (!areaCmd || !modInfo.allowAreaTargetCache) {
+		quadField->GetFeaturesExact(qfQuery, pos, radius, false);
+		return *qfQuery.features;
+	}
+
+	AreaTargets& at = GetAreaTargets(pos, radius);
+
+	if (!at.haveFeatures) {
+		quadField->GetFeaturesExact(qfQuery, pos, radius, false);
+
+		at.featureIDs.clear();
+		at.haveFeatures = true;
+
+		for (const CFeature* f: *qfQuery.features) {
+			at.featureIDs.push_back(f->id);
+		}
+
+		return *qfQuery.features;
+	}
+
+	areaFeatures.clear();
+
+	for (const int featureID: at.featureIDs) {
+		CFeature* f = featureHandler->GetFeature(featureID);
+
+		if (f == nullptr || !InAreaCircle(f, pos, radius))
+			continue;
+
+		areaFeatures.push_back(f);
+	}
+
+	return areaFeatures;
+}
+
+
 static std::string GetUnitDefBuildOptionToolTip(const UnitDef* ud, bool disabled) {
 	std::string tooltip;
 
@@ -229,6 +359,8 @@ void CBuilderCAI::InitStatic()
 	spring::clear_unordered_set(reclaimers);
 	spring::clear_unordered_set(featureReclaimers);
 	spring::clear_unordered_set(resurrecters);
+
+	areaTargets.clear();
 }
 
 void CBuilderCAI::PostLoad()
@@ -767,7 +899,7 @@ void CBuilderCAI::ExecuteRepair(Command& c)
 		const float radius = c.params[3];
 
 		ownerBuilder->StopBuild();
-		if (FindRepairTargetAndRepair(pos, radius, c.options, false, (c.options & META_KEY))) {
+		if (FindRepairTargetAndRepair(pos, radius, c.options, false, (c.options & META_KEY), true)) {
 			inCommand = false;
 			SlowUpdate();
 			return;
@@ -821,7 +953,7 @@ void CBuilderCAI::ExecuteCapture(Command& c)
 
 		ownerBuilder->StopBuild();
 
-		if (FindCaptureTargetAndCapture(pos, radius, c.options, (c.options & META_KEY))) {
+		if (FindCaptureTargetAndCapture(pos, radius, c.options, (c.options & META_KEY), true)) {
 			inCommand = false;
 			SlowUpdate();
 			return;
@@ -980,7 +1112,7 @@ void CBuilderCAI::ExecuteReclaim(Command& c)
 				if (recEnemyOnly) recopt |= REC_ENEMYONLY;
 				if (recSpecial)   recopt |= REC_SPECIAL;
 
-				const int rid = FindReclaimTarget(pos, radius, c.options, recopt, curdist);
+				const int rid = FindReclaimTarget(pos, radius, c.options, recopt, curdist, true);
 				if ((rid > 0) && (rid != uid)) {
 					StopMoveAndFinishCommand();
 					RemoveUnitFromReclaimers(owner);
@@ -1062,7 +1194,7 @@ void CBuilderCAI::ExecuteReclaim(Command& c)
 		if (recEnemyOnly) recopt |= REC_ENEMYONLY;
 		if (recSpecial)   recopt |= REC_SPECIAL;
 
-		if (FindReclaimTargetAndReclaim(pos, radius, c.options, recopt)) {
+		if (FindReclaimTargetAndReclaim(pos, radius, c.options, recopt, true)) {
 			inCommand = false;
 			SlowUpdate();
 			return;
@@ -1136,7 +1268,7 @@ void CBuilderCAI::ExecuteResurrect(Command& c)
 		const float3 pos = c.GetPos(0);
 		const float radius = c.params[3];
 
-		if (FindResurrectableFeatureAndResurrect(pos, radius, c.options, (c.options & META_KEY))) {
+		if (FindResurrectableFeatureAndResurrect(pos, radius, c.options, (c.options & META_KEY), true)) {
 			inCommand = false;
 			SlowUpdate();
 			return;
@@ -1462,7 +1594,7 @@ bool CBuilderCAI::ReclaimObject(CSolidObject* object) {
 }
 
 
-int CBuilderCAI::FindReclaimTarget(const float3& pos, float radius, unsigned char cmdopt, ReclaimOption recoptions, float bestStartDist) const
+int CBuilderCAI::FindReclaimTarget(const float3& pos, float radius, unsigned char cmdopt, ReclaimOption recoptions, float bestStartDist, bool areaCmd) const
 {
 	const bool noResCheck   = recoptions & REC_NORESCHECK;
 	const bool recUnits     = recoptions & REC_UNITS;
@@ -1478,8 +1610,7 @@ int CBuilderCAI::FindReclaimTarget(const float3& pos, float radius, unsigned cha
 
 	if (recUnits || recEnemy || recEnemyOnly) {
 		QuadFieldQuery qfQuery;
-		quadField->GetUnitsExact(qfQuery, pos, radius, false);
-		for (const CUnit* u: *qfQuery.units) {
+		for (const CUnit* u: GetAreaUnits(qfQuery, pos, radius, areaCmd)) {
 
 			if (u == owner)
 				continue;
@@ -1518,9 +1649,8 @@ int CBuilderCAI::FindReclaimTarget(const float3& pos, float radius, unsigned cha
 		best = NULL;
 		const CTeam* team = teamHandler->Team(owner->team);
 		QuadFieldQuery qfQuery;
-		quadField->GetFeaturesExact(qfQuery, pos, radius, false);
 		bool metal = false;
-		for (const CFeature* f: *qfQuery.features) {
+		for (const CFeature* f: GetAreaFeatures(qfQuery, pos, radius, areaCmd)) {
 			if (f->def->reclaimable && (recSpecial || f->def->autoreclaim) &&
 				(!recNonRez || f->udef == nullptr)
 			) {
@@ -1563,9 +1693,9 @@ int CBuilderCAI::FindReclaimTarget(const float3& pos, float radius, unsigned cha
 //  Area searches
 //
 
-bool CBuilderCAI::FindReclaimTargetAndReclaim(const float3& pos, float radius, unsigned char cmdopt, ReclaimOption recoptions)
+bool CBuilderCAI::FindReclaimTargetAndReclaim(const float3& pos, float radius, unsigned char cmdopt, ReclaimOption recoptions, bool areaCmd)
 {
-	const int rid = FindReclaimTarget(pos, radius, cmdopt, recoptions);
+	const int rid = FindReclaimTarget(pos, radius, cmdopt, recoptions, 1.0e30f, areaCmd);
 
 	if (rid >= 0) {
 		if (!(recoptions & REC_NORESCHECK)) {
@@ -1586,15 +1716,15 @@ bool CBuilderCAI::FindReclaimTargetAndReclaim(const float3& pos, float radius, u
 bool CBuilderCAI::FindResurrectableFeatureAndResurrect(const float3& pos,
                                                        float radius,
                                                        unsigned char options,
-                                                       bool freshOnly)
+                                                       bool freshOnly,
+                                                       bool areaCmd)
 {
 	QuadFieldQuery qfQuery;
-	quadField->GetFeaturesExact(qfQuery, pos, radius, false);
 
 	const CFeature* best = NULL;
 	float bestDist = 1.0e30f;
 
-	for (const CFeature* f: *qfQuery.features) {
+	for (const CFeature* f: GetAreaFeatures(qfQuery, pos, radius, areaCmd)) {
 		if (f->udef != nullptr) {
 			if (!f->IsInLosForAllyTeam(owner->allyteam)) {
 				continue;
@@ -1629,17 +1759,16 @@ bool CBuilderCAI::FindResurrectableFeatureAndResurrect(const float3& pos,
 
 bool CBuilderCAI::FindCaptureTargetAndCapture(const float3& pos, float radius,
                                               unsigned char options,
-											  bool healthyOnly)
+											  bool healthyOnly,
+											  bool areaCmd)
 {
 	QuadFieldQuery qfQuery;
-	quadField->GetUnitsExact(qfQuery, pos, radius, false);
-	std::vector<CUnit*>::const_iterator ui;
 
 	const CUnit* best = NULL;
 	float bestDist = 1.0e30f;
 	bool stationary = false;
 
-	for (const CUnit* unit: *qfQuery.units) {
+	for (const CUnit* unit: GetAreaUnits(qfQuery, pos, radius, areaCmd)) {
 		if ((((options & CONTROL_KEY) && owner->team != unit->team) ||
 			!teamHandler->Ally(owner->allyteam, unit->allyteam)) && (unit != owner) &&
 			(unit->losStatus[owner->allyteam] & (LOS_INRADAR|LOS_INLOS)) &&
@@ -1677,10 +1806,10 @@ bool CBuilderCAI::FindCaptureTargetAndCapture(const float3& pos, float radius,
 bool CBuilderCAI::FindRepairTargetAndRepair(const float3& pos, float radius,
                                             unsigned char options,
                                             bool attackEnemy,
-											bool builtOnly)
+											bool builtOnly,
+											bool areaCmd)
 {
 	QuadFieldQuery qfQuery;
-	quadField->GetUnitsExact(qfQuery, pos, radius, false);
 	const CUnit* bestUnit = NULL;
 
 	const float maxSpeed = owner->moveType->GetMaxSpeed();
@@ -1691,7 +1820,7 @@ bool CBuilderCAI::FindRepairTargetAndRepair(const float3& pos, float radius,
 	bool trySelfRepair = false;
 	bool stationary = false;
 
-	for (const CUnit* unit: *qfQuery.units) {
+	for (const CUnit* unit: GetAreaUnits(qfQuery, pos, radius, areaCmd)) {
 		if (teamHandler->Ally(owner->allyteam, unit->allyteam)) {
 			if (!haveEnemy && (unit->health < unit->maxHealth)) {
 				// don't help allies build unless set on roam
@@ -87,25 +87,29 @@ private:
 	 * @param cmdopts command options
 	 * @param recoptions reclaim optioons
 	 */
-	bool FindReclaimTargetAndReclaim(const float3& pos, float radius, unsigned char cmdopt, ReclaimOption recoptions);
+	bool FindReclaimTargetAndReclaim(const float3& pos, float radius, unsigned char cmdopt, ReclaimOption recoptions, bool areaCmd = false);
 	/**
 	 * @param freshOnly reclaims only corpses that have rez progress or all the metal left
 	 */
-	bool FindResurrectableFeatureAndResurrect(const float3& pos, float radius, unsigned char options, bool freshOnly);
+	bool FindResurrectableFeatureAndResurrect(const float3& pos, float radius, unsigned char options, bool freshOnly, bool areaCmd = false);
 
 	/**
 	 * @param builtOnly skips units that are under construction
 	 */
-	bool FindRepairTargetAndRepair(const float3& pos, float radius, unsigned char options, bool attackEnemy, bool builtOnly);
+	bool FindRepairTargetAndRepair(const float3& pos, float radius, unsigned char options, bool attackEnemy, bool builtOnly, bool areaCmd = false);
 	/**
 	 * @param pos         position where to search for units to capture
 	 * @param radius      radius in which are searched units to capture
 	 * @param options     command options
 	 * @param healthyOnly only capture units with capture progress or 100% health remaining
 	 */
-	bool FindCaptureTargetAndCapture(const float3& pos, float radius, unsigned char options, bool healthyOnly);
+	bool FindCaptureTargetAndCapture(const float3& pos, float radius, unsigned char options, bool healthyOnly, bool areaCmd = false);
 
-	int FindReclaimTarget(const float3& pos, float radius, unsigned char cmdopt, ReclaimOption recoptions, float bestStartDist = 1.0e30f) const;
+	/**
+	 * @param areaCmd whether <pos> and <radius> are the circle of an area command,
+	 *                whose objects may be shared with other builders (see GetAreaUnits)
+	 */
+	int FindReclaimTarget(const float3& pos, float radius, unsigned char cmdopt, ReclaimOption recoptions, float bestStartDist = 1.0e30f, bool areaCmd = false) const;
 
 	float GetBuildRange(const float targetRadius) const;
 	bool MoveInBuildRange(const CWorldObject* obj, const bool checkMoveTypeForFailed = false);
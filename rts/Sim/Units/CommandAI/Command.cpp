@@ -1,6 +1,8 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "Command.h"
+#include "System/Log/ILog.h"
+#include "System/Platform/CrashHandler.h"
 
 CR_BIND(Command, )
 CR_REG_METADATA(Command, (
@@ -13,3 +15,17 @@ CR_REG_METADATA(Command, (
 
 	CR_MEMBER(params)
 ))
+
+
+float& CommandParams::OutOfBounds(size_type i, size_type n)
+{
+	static float def = 0.0f;
+
+	LOG_L(L_ERROR, "[CommandParams::%s] index %u out of bounds! (size %u)", __func__, i, n);
+#ifndef UNITSYNC
+	CrashHandler::OutputStacktrace();
+#endif
+
+	// a previous out-of-bounds write may have changed it
+	return (def = 0.0f);
+}
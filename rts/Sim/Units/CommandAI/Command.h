@@ -9,7 +9,7 @@
 #ifdef BUILDING_AI
 #include <vector>
 #else
-#include "System/SafeVector.h"
+#include "Sim/Units/CommandAI/CommandParams.h"
 #endif
 
 #include "System/creg/creg_cond.h"
@@ -253,7 +253,7 @@ public:
 		rc.numParams   = params.size();
 		rc.tag         = tag;
 		rc.options     = options;
-		rc.params      = &params[0];
+		rc.params      = params.data();
 		return rc;
 	}
 
@@ -371,7 +371,7 @@ public:
 	void PushParam(float par) { params.push_back(par); }
 	float GetParam(size_t idx) const { return params[idx]; }
 
-	/// const safe_vector<float>& GetParams() const { return params; }
+	/// const CommandParams& GetParams() const { return params; }
 	const size_t GetParamsCount() const { return params.size(); }
 
 	void SetID(int id) _deprecated { this->id = id; params.clear(); }
@@ -444,7 +444,7 @@ public:
 	#ifdef BUILDING_AI
 	std::vector<float> params;
 	#else
-	safe_vector<float> params;
+	CommandParams params;
 	#endif
 };
 
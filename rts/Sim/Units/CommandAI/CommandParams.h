@@ -0,0 +1,211 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef COMMAND_PARAMS_H
+#define COMMAND_PARAMS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <new>
+#include <utility>
+
+#include "System/creg/creg_cond.h"
+
+/**
+ * @brief parameter storage of a Command
+ *
+ * Up to MAX_INLINE_PARAMS parameters (which covers positions, areas, build
+ * orders and CMD_INSERT's of those) are stored inside the object, so making
+ * copies of a command never allocates. Longer lists live in a reference
+ * counted block that is shared between copies (e.g. a custom command given
+ * to a whole selection) and only duplicated when a shared list is modified.
+ *
+ * Behaves like the safe_vector<float> it replaces: out-of-bounds reads
+ * return zero and log an error. Non-const accessors, including operator[],
+ * unshare the block first.
+ */
+class CommandParams
+{
+public:
+	typedef float value_type;
+	typedef unsigned int size_type;
+
+	static constexpr size_type MAX_INLINE_PARAMS = 8;
+
+	CommandParams() {}
+	CommandParams(const CommandParams& p) { *this = p; }
+	CommandParams(CommandParams&& p) { *this = std::move(p); }
+	~CommandParams() { Release(); }
+
+	CommandParams& operator = (const CommandParams& p) {
+		if (this == &p)
+			return *this;
+
+		Release();
+
+		if ((onHeap = p.onHeap)) {
+			block = p.block;
+			block->numRefs.fetch_add(1, std::memory_order_relaxed);
+		} else {
+			std::memcpy(inlineParams, p.inlineParams, p.numParams * sizeof(float));
+		}
+
+		numParams = p.numParams;
+		return *this;
+	}
+	CommandParams& operator = (CommandParams&& p) {
+		if (this == &p)
+			return *this;
+
+		Release();
+
+		if ((onHeap = p.onHeap)) {
+			block = p.block;
+		} else {
+			std::memcpy(inlineParams, p.inlineParams, p.numParams * sizeof(float));
+		}
+
+		numParams = p.numParams;
+
+		p.numParams = 0;
+		p.onHeap = false;
+		return *this;
+	}
+
+	bool empty() const { return (numParams == 0); }
+	size_type size() const { return numParams; }
+
+	const float* data() const { return (Params()); }
+	      float* data()       { MakeUnique(); return (Params()); }
+
+	const float* begin() const { return (data()); }
+	const float* end() const { return (data() + numParams); }
+	const float* cbegin() const { return (begin()); }
+	const float* cend() const { return (end()); }
+
+	const float& operator [] (size_type i) const {
+		if (i >= numParams)
+			return OutOfBounds(i, numParams);
+
+		return Params()[i];
+	}
+	float& operator [] (size_type i) {
+		if (i >= numParams)
+			return OutOfBounds(i, numParams);
+
+		return data()[i];
+	}
+
+	const float& at(size_type i) const { return ((*this)[i]); }
+	      float& at(size_type i)       { return ((*this)[i]); }
+
+	void push_back(float p) {
+		Reserve(numParams + 1);
+		MakeUnique();
+
+		Params()[numParams++] = p;
+	}
+
+	void resize(size_type n) {
+		Reserve(n);
+		MakeUnique();
+
+		float* params = Params();
+
+		for (size_type i = numParams; i < n; i++) {
+			params[i] = 0.0f;
+		}
+
+		numParams = n;
+	}
+
+	void reserve(size_type n) { Reserve(n); }
+
+	void clear() {
+		Release();
+
+		numParams = 0;
+		onHeap = false;
+	}
+
+private:
+	struct Block {
+		std::atomic<unsigned int> numRefs;
+		size_type capacity;
+
+		float* Data() { return (reinterpret_cast<float*>(this + 1)); }
+
+		static Block* Alloc(size_type capacity) {
+			Block* b = static_cast<Block*>(::operator new(sizeof(Block) + capacity * sizeof(float)));
+			new (&b->numRefs) std::atomic<unsigned int>(1);
+			b->capacity = capacity;
+			return b;
+		}
+	};
+
+	const float* Params() const { return (onHeap? block->Data(): inlineParams); }
+	      float* Params()       { return (onHeap? block->Data(): inlineParams); }
+
+	size_type Capacity() const { return (onHeap? block->capacity: MAX_INLINE_PARAMS); }
+
+	void Reserve(size_type n) {
+		if (n <= Capacity())
+			return;
+
+		Block* b = Block::Alloc(std::max(n, Capacity() * 2));
+
+		std::memcpy(b->Data(), Params(), numParams * sizeof(float));
+		Release();
+
+		block = b;
+		onHeap = true;
+	}
+
+	void MakeUnique() {
+		if (!onHeap || block->numRefs.load(std::memory_order_relaxed) == 1)
+			return;
+
+		Block* b = Block::Alloc(block->capacity);
+
+		std::memcpy(b->Data(), block->Data(), numParams * sizeof(float));
+		Release();
+
+		block = b;
+		onHeap = true;
+	}
+
+	void Release() {
+		if (!onHeap)
+			return;
+		if (block->numRefs.fetch_sub(1, std::memory_order_acq_rel) == 1)
+			::operator delete(block);
+
+		onHeap = false;
+	}
+
+	static float& OutOfBounds(size_type i, size_type n);
+
+private:
+	union {
+		float inlineParams[MAX_INLINE_PARAMS];
+		Block* block;
+	};
+
+	size_type numParams = 0;
+	bool onHeap = false;
+};
+
+
+#ifdef USING_CREG
+namespace creg
+{
+	template<>
+	struct DeduceType<CommandParams> {
+		static std::unique_ptr<IType> Get() {
+			return std::unique_ptr<IType>(new DynamicArrayType<CommandParams>());
+		}
+	};
+}
+#endif // USING_CREG
+
+#endif // COMMAND_PARAMS_H
@@ -4,8 +4,14 @@
 #include "CobEngine.h"
 #include "CobThread.h"
 #include "CobFile.h"
+#include "CobInstance.h"
+#include "Sim/Misc/SimCostProfiler.h"
+#include "Sim/Units/Unit.h"
+#include "Sim/Units/UnitDef.h"
 #include "System/FileSystem/FileHandler.h"
 
+#include <algorithm>
+
 
 CCobEngine* cobEngine = nullptr;
 CCobFileHandler* cobFileHandler = nullptr;
@@ -19,10 +25,12 @@ CR_BIND(CCobEngine, )
 CR_REG_METADATA(CCobEngine, (
 	CR_MEMBER(currentTime),
 	CR_MEMBER(running),
-	CR_MEMBER(sleeping),
+	CR_MEMBER(sleepSlots),
+	CR_MEMBER(numSleeping),
 
 	//always null/empty when saving
 	CR_IGNORED(wantToRun),
+	CR_IGNORED(wakeUps),
 	CR_IGNORED(curThread)
 ))
 
@@ -30,8 +38,10 @@ CR_REG_METADATA(CCobEngine, (
 CCobEngine::CCobEngine()
 	: curThread(nullptr)
 	, currentTime(0)
-
-{ }
+	, numSleeping(0)
+{
+	sleepSlots.resize(NUM_SLEEP_SLOTS);
+}
 
 
 CCobEngine::~CCobEngine()
@@ -48,13 +58,16 @@ CCobEngine::~CCobEngine()
 			wantToRun.pop_back();
 			delete tmp;
 		}
-		while (!sleeping.empty()) {
-			CCobThread* tmp = sleeping.top();
-			sleeping.pop();
-			delete tmp;
+		for (std::vector<CCobThread*>& slot: sleepSlots) {
+			while (!slot.empty()) {
+				CCobThread* tmp = slot.back();
+				slot.pop_back();
+				numSleeping--;
+				delete tmp;
+			}
 		}
 		// callbacks may add new threads
-	} while (!running.empty() || !wantToRun.empty() || !sleeping.empty());
+	} while (!running.empty() || !wantToRun.empty() || numSleeping > 0);
 }
 
 
@@ -74,9 +87,13 @@ void CCobEngine::AddThread(CCobThread *thread)
 		case CCobThread::Run:
 			wantToRun.push_back(thread);
 			break;
-		case CCobThread::Sleep:
-			sleeping.push(thread);
-			break;
+		case CCobThread::Sleep: {
+			// overdue threads (negative sleeps) wake up on the next tick
+			const int slotTime = std::max(thread->GetWakeTime(), currentTime);
+
+			sleepSlots[(slotTime / SLEEP_SLOT_TIME) & (NUM_SLEEP_SLOTS - 1)].push_back(thread);
+			numSleeping++;
+		} break;
 		default:
 			LOG_L(L_ERROR, "thread added to scheduler with unknown state (%d)", thread->state);
 			break;
@@ -88,15 +105,68 @@ void CCobEngine::TickThread(CCobThread* thread)
 {
 	curThread = thread; // for error messages originating in CUnitScript
 
-	if (!thread->Tick())
-		delete thread;
+	{
+		// the thread may be deleted by Tick, so look its unit up first
+		const int unitDefID = (thread->owner != nullptr)? thread->owner->GetUnit()->unitDef->id: -1;
+		CSimCostProfiler::ScopedCost cost(CSimCostProfiler::CATEGORY_UNITDEF, unitDefID, CSimCostProfiler::PART_UNIT_SCRIPT);
+
+		if (!thread->Tick())
+			delete thread;
+	}
 
 	curThread = nullptr;
 }
 
 
+void CCobEngine::WakeSleepingThreads(int prevTime)
+{
+	if (numSleeping == 0)
+		return;
+
+	// every sleeping thread is due no earlier than prevTime, so only the
+	// slots spanning [prevTime, currentTime) can hold threads to wake up
+	const int firstSlot = prevTime / SLEEP_SLOT_TIME;
+	const int lastSlot = std::min((currentTime - 1) / SLEEP_SLOT_TIME, firstSlot + NUM_SLEEP_SLOTS - 1);
+
+	wakeUps.clear();
+
+	for (int n = firstSlot; n <= lastSlot; n++) {
+		std::vector<CCobThread*>& slot = sleepSlots[n & (NUM_SLEEP_SLOTS - 1)];
+
+		// keep insertion order for the remaining threads, it breaks ties below
+		const auto iter = std::stable_partition(slot.begin(), slot.end(), [&](const CCobThread* t) { return (t->GetWakeTime() >= currentTime); });
+
+		wakeUps.insert(wakeUps.end(), iter, slot.end());
+		slot.erase(iter, slot.end());
+	}
+
+	numSleeping -= wakeUps.size();
+
+	// threads with equal wake-times share a slot, so this is deterministic
+	std::stable_sort(wakeUps.begin(), wakeUps.end(), [](const CCobThread* a, const CCobThread* b) { return (a->GetWakeTime() < b->GetWakeTime()); });
+
+	for (CCobThread* cur: wakeUps) {
+		//Run forward again. This can quite possibly readd the thread to a sleeping slot again
+		//But it will not interfere since it is guaranteed to sleep > 0 ms
+		//LOG_L(L_DEBUG, "Now 2running %d: %s", currentTime, cur->GetName().c_str());
+		if (cur->state == CCobThread::Sleep) {
+			cur->state = CCobThread::Run;
+			TickThread(cur);
+		} else if (cur->state == CCobThread::Dead) {
+			delete cur;
+		} else {
+			LOG_L(L_ERROR, "Sleeping thread strange state %d", cur->state);
+		}
+	}
+
+	wakeUps.clear();
+}
+
+
 void CCobEngine::Tick(int deltaTime)
 {
+	const int prevTime = currentTime;
+
 	currentTime += deltaTime;
 
 	// Advance all running threads
@@ -115,31 +185,7 @@ void CCobEngine::Tick(int deltaTime)
 	std::swap(running, wantToRun);
 
 	//Check on the sleeping threads
-	if (!sleeping.empty()) {
-		CCobThread* cur = sleeping.top();
-
-		while ((cur != nullptr) && (cur->GetWakeTime() < currentTime)) {
-			// Start with removing the executing thread from the queue
-			sleeping.pop();
-
-			//Run forward again. This can quite possibly readd the thread to the sleeping array again
-			//But it will not interfere since it is guaranteed to sleep > 0 ms
-			//LOG_L(L_DEBUG, "Now 2running %d: %s", currentTime, cur->GetName().c_str());
-			if (cur->state == CCobThread::Sleep) {
-				cur->state = CCobThread::Run;
-				TickThread(cur);
-			} else if (cur->state == CCobThread::Dead) {
-				delete cur;
-			} else {
-				LOG_L(L_ERROR, "Sleeping thread strange state %d", cur->state);
-			}
-
-			if (!sleeping.empty())
-				cur = sleeping.top();
-			else
-				cur = nullptr;
-		}
-	}
+	WakeSleepingThreads(prevTime);
 }
 
 
@@ -14,7 +14,6 @@
 #include "CobThread.h"
 #include "System/creg/creg_cond.h"
 
-#include "System/creg/STL_Queue.h"
 #include "System/UnorderedMap.hpp"
 
 
@@ -23,17 +22,13 @@ class CCobInstance;
 class CCobFile;
 
 
-class CCobThreadPtr_less : public std::binary_function<CCobThread*, CCobThread*, bool> {
-public:
-	bool operator() (const CCobThread* const& a, const CCobThread* const& b) const {
-		return a->GetWakeTime() > b->GetWakeTime();
-	}
-};
-
-
 class CCobEngine
 {
 	CR_DECLARE_STRUCT(CCobEngine)
+public:
+	static constexpr int SLEEP_SLOT_TIME = 16;
+	static constexpr int NUM_SLEEP_SLOTS = 256;
+
 protected:
 	std::vector<CCobThread*> running;
 	/**
@@ -41,10 +36,20 @@ protected:
 	 * And moved to real running after running is empty.
 	 */
 	std::vector<CCobThread*> wantToRun;
-	std::priority_queue<CCobThread*, std::vector<CCobThread*>, CCobThreadPtr_less> sleeping;
+	/**
+	 * Sleeping threads, bucketed by wake-time into a timer wheel of
+	 * NUM_SLEEP_SLOTS slots that each cover SLEEP_SLOT_TIME milliseconds.
+	 * Threads sleeping longer than one revolution stay in their slot and
+	 * are skipped until their time comes around.
+	 */
+	std::vector< std::vector<CCobThread*> > sleepSlots;
+	/// threads that woke up this tick, sorted by wake-time
+	std::vector<CCobThread*> wakeUps;
 	CCobThread* curThread;
 	int currentTime;
+	int numSleeping;
 	void TickThread(CCobThread* thread);
+	void WakeSleepingThreads(int prevTime);
 public:
 	CCobEngine();
 	~CCobEngine();
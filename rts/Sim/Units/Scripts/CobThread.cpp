@@ -8,6 +8,8 @@
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/GlobalSynced.h"
 
+#include <algorithm>
+#include <iterator>
 #include <sstream>
 
 CR_BIND(CCobThread, )
@@ -133,82 +135,183 @@ int CCobThread::GetWakeTime() const
 // Command documentation from http://visualta.tauniverse.com/Downloads/cob-commands.txt
 // And some information from basm0.8 source (basm ops.txt)
 
-// Model interaction
-const int MOVE       = 0x10001000;
-const int TURN       = 0x10002000;
-const int SPIN       = 0x10003000;
-const int STOP_SPIN  = 0x10004000;
-const int SHOW       = 0x10005000;
-const int HIDE       = 0x10006000;
-const int CACHE      = 0x10007000;
-const int DONT_CACHE = 0x10008000;
-const int MOVE_NOW   = 0x1000B000;
-const int TURN_NOW   = 0x1000C000;
-const int SHADE      = 0x1000D000;
-const int DONT_SHADE = 0x1000E000;
-const int EMIT_SFX   = 0x1000F000;
-
-// Blocking operations
-const int WAIT_TURN  = 0x10011000;
-const int WAIT_MOVE  = 0x10012000;
-const int SLEEP      = 0x10013000;
-
-// Stack manipulation
-const int PUSH_CONSTANT    = 0x10021001;
-const int PUSH_LOCAL_VAR   = 0x10021002;
-const int PUSH_STATIC      = 0x10021004;
-const int CREATE_LOCAL_VAR = 0x10022000;
-const int POP_LOCAL_VAR    = 0x10023002;
-const int POP_STATIC       = 0x10023004;
-const int POP_STACK        = 0x10024000; ///< Not sure what this is supposed to do
-
-// Arithmetic operations
-const int ADD         = 0x10031000;
-const int SUB         = 0x10032000;
-const int MUL         = 0x10033000;
-const int DIV         = 0x10034000;
-const int MOD		  = 0x10034001; ///< spring specific
-const int BITWISE_AND = 0x10035000;
-const int BITWISE_OR  = 0x10036000;
-const int BITWISE_XOR = 0x10037000;
-const int BITWISE_NOT = 0x10038000;
-
-// Native function calls
-const int RAND           = 0x10041000;
-const int GET_UNIT_VALUE = 0x10042000;
-const int GET            = 0x10043000;
-
-// Comparison
-const int SET_LESS             = 0x10051000;
-const int SET_LESS_OR_EQUAL    = 0x10052000;
-const int SET_GREATER          = 0x10053000;
-const int SET_GREATER_OR_EQUAL = 0x10054000;
-const int SET_EQUAL            = 0x10055000;
-const int SET_NOT_EQUAL        = 0x10056000;
-const int LOGICAL_AND          = 0x10057000;
-const int LOGICAL_OR           = 0x10058000;
-const int LOGICAL_XOR          = 0x10059000;
-const int LOGICAL_NOT          = 0x1005A000;
-
-// Flow control
-const int START           = 0x10061000;
-const int CALL            = 0x10062000; ///< converted when executed
-const int REAL_CALL       = 0x10062001; ///< spring custom
-const int LUA_CALL        = 0x10062002; ///< spring custom
-const int JUMP            = 0x10064000;
-const int RETURN          = 0x10065000;
-const int JUMP_NOT_EQUAL  = 0x10066000;
-const int SIGNAL          = 0x10067000;
-const int SET_SIGNAL_MASK = 0x10068000;
-
-// Piece destruction
-const int EXPLODE    = 0x10071000;
-const int PLAY_SOUND = 0x10072000;
-
-// Special functions
-const int SET    = 0x10082000;
-const int ATTACH = 0x10083000;
-const int DROP   = 0x10084000;
+// Opcodes are replaced in-place by their (contiguous) dense equivalents when
+// first executed, so the interpreter switch compiles to a single jump-table.
+// The base is arbitrary, it only has to keep dense and raw values apart.
+static constexpr int COB_DENSE_OPCODE_BASE = 0x7CB00000;
+
+enum {
+	// Model interaction
+	MOVE = COB_DENSE_OPCODE_BASE,
+	TURN,
+	SPIN,
+	STOP_SPIN,
+	SHOW,
+	HIDE,
+	CACHE,
+	DONT_CACHE,
+	MOVE_NOW,
+	TURN_NOW,
+	SHADE,
+	DONT_SHADE,
+	EMIT_SFX,
+
+	// Blocking operations
+	WAIT_TURN,
+	WAIT_MOVE,
+	SLEEP,
+
+	// Stack manipulation
+	PUSH_CONSTANT,
+	PUSH_LOCAL_VAR,
+	PUSH_STATIC,
+	CREATE_LOCAL_VAR,
+	POP_LOCAL_VAR,
+	POP_STATIC,
+	POP_STACK, ///< Not sure what this is supposed to do
+
+	// Arithmetic operations
+	ADD,
+	SUB,
+	MUL,
+	DIV,
+	MOD, ///< spring specific
+	BITWISE_AND,
+	BITWISE_OR,
+	BITWISE_XOR,
+	BITWISE_NOT,
+
+	// Native function calls
+	RAND,
+	GET_UNIT_VALUE,
+	GET,
+
+	// Comparison
+	SET_LESS,
+	SET_LESS_OR_EQUAL,
+	SET_GREATER,
+	SET_GREATER_OR_EQUAL,
+	SET_EQUAL,
+	SET_NOT_EQUAL,
+	LOGICAL_AND,
+	LOGICAL_OR,
+	LOGICAL_XOR,
+	LOGICAL_NOT,
+
+	// Flow control
+	START,
+	CALL, ///< converted when executed
+	REAL_CALL, ///< spring custom
+	LUA_CALL, ///< spring custom
+	JUMP,
+	RETURN,
+	JUMP_NOT_EQUAL,
+	SIGNAL,
+	SET_SIGNAL_MASK,
+
+	// Piece destruction
+	EXPLODE,
+	PLAY_SOUND,
+
+	// Special functions
+	SET,
+	ATTACH,
+	DROP,
+
+	COB_DENSE_OPCODE_END
+};
+
+// raw opcodes as found in .cob files, in ascending order and matching the enum above
+static constexpr int rawOpcodes[] = {
+	// Model interaction
+	0x10001000, // MOVE
+	0x10002000, // TURN
+	0x10003000, // SPIN
+	0x10004000, // STOP_SPIN
+	0x10005000, // SHOW
+	0x10006000, // HIDE
+	0x10007000, // CACHE
+	0x10008000, // DONT_CACHE
+	0x1000B000, // MOVE_NOW
+	0x1000C000, // TURN_NOW
+	0x1000D000, // SHADE
+	0x1000E000, // DONT_SHADE
+	0x1000F000, // EMIT_SFX
+
+	// Blocking operations
+	0x10011000, // WAIT_TURN
+	0x10012000, // WAIT_MOVE
+	0x10013000, // SLEEP
+
+	// Stack manipulation
+	0x10021001, // PUSH_CONSTANT
+	0x10021002, // PUSH_LOCAL_VAR
+	0x10021004, // PUSH_STATIC
+	0x10022000, // CREATE_LOCAL_VAR
+	0x10023002, // POP_LOCAL_VAR
+	0x10023004, // POP_STATIC
+	0x10024000, // POP_STACK
+
+	// Arithmetic operations
+	0x10031000, // ADD
+	0x10032000, // SUB
+	0x10033000, // MUL
+	0x10034000, // DIV
+	0x10034001, // MOD
+	0x10035000, // BITWISE_AND
+	0x10036000, // BITWISE_OR
+	0x10037000, // BITWISE_XOR
+	0x10038000, // BITWISE_NOT
+
+	// Native function calls
+	0x10041000, // RAND
+	0x10042000, // GET_UNIT_VALUE
+	0x10043000, // GET
+
+	// Comparison
+	0x10051000, // SET_LESS
+	0x10052000, // SET_LESS_OR_EQUAL
+	0x10053000, // SET_GREATER
+	0x10054000, // SET_GREATER_OR_EQUAL
+	0x10055000, // SET_EQUAL
+	0x10056000, // SET_NOT_EQUAL
+	0x10057000, // LOGICAL_AND
+	0x10058000, // LOGICAL_OR
+	0x10059000, // LOGICAL_XOR
+	0x1005A000, // LOGICAL_NOT
+
+	// Flow control
+	0x10061000, // START
+	0x10062000, // CALL
+	0x10062001, // REAL_CALL
+	0x10062002, // LUA_CALL
+	0x10064000, // JUMP
+	0x10065000, // RETURN
+	0x10066000, // JUMP_NOT_EQUAL
+	0x10067000, // SIGNAL
+	0x10068000, // SET_SIGNAL_MASK
+
+	// Piece destruction
+	0x10071000, // EXPLODE
+	0x10072000, // PLAY_SOUND
+
+	// Special functions
+	0x10082000, // SET
+	0x10083000, // ATTACH
+	0x10084000, // DROP
+};
+
+static_assert((sizeof(rawOpcodes) / sizeof(rawOpcodes[0])) == (COB_DENSE_OPCODE_END - COB_DENSE_OPCODE_BASE), "");
+
+static int GetDenseOpcode(int rawOpcode)
+{
+	const int* iter = std::lower_bound(std::begin(rawOpcodes), std::end(rawOpcodes), rawOpcode);
+
+	if (iter == std::end(rawOpcodes) || *iter != rawOpcode)
+		return -1;
+
+	return (COB_DENSE_OPCODE_BASE + (iter - std::begin(rawOpcodes)));
+}
 
 // Indices for SET, GET, and GET_UNIT_VALUE for LUA return values
 #define LUA0 110 // (LUA0 returns the lua call status, 0 or 1)
@@ -702,7 +805,15 @@ bool CCobThread::Tick()
 				}
 				//LOG_L(L_DEBUG, "Showing %d", r1);
 				break;}
-			default:
+			default: {
+				// first execution of this instruction, swap in its dense opcode and dispatch again
+				const int denseOpcode = GetDenseOpcode(opcode);
+
+				if (denseOpcode != -1) {
+					owner->script->code[--PC] = denseOpcode;
+					break;
+				}
+
 				LOG_L(L_ERROR, "Unknown opcode %x (in %s:%s at %x)",
 						opcode, owner->script->name.c_str(),
 						owner->script->scriptNames[callStack.back().functionId].c_str(),
@@ -715,6 +826,7 @@ bool CCobThread::Tick()
 				// }
 				state = Dead;
 				return false;
+			}
 		}
 	}
 
@@ -738,6 +850,10 @@ void CCobThread::ShowError(const string& msg)
 
 string CCobThread::GetOpcodeName(int opcode)
 {
+	// accept both raw and (already replaced) dense opcodes
+	if (GetDenseOpcode(opcode) != -1)
+		opcode = GetDenseOpcode(opcode);
+
 	switch (opcode) {
 		case MOVE: return "move";
 		case TURN: return "turn";
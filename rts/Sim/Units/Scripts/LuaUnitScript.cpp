@@ -7,6 +7,7 @@
 #include "CobInstance.h"
 #include "LuaInclude.h"
 #include "NullUnitScript.h"
+#include "UnitScriptEngine.h"
 #include "UnitScriptFactory.h"
 #include "LuaScriptNames.h"
 #include "Lua/LuaConfig.h"
@@ -20,6 +21,9 @@
 #include "System/SafeUtil.h"
 #include "System/StringUtil.h"
 
+#include <cmath>
+#include <cstring>
+
 static inline LocalModelPiece* ParseLocalModelPiece(lua_State* L, CUnitScript* script, const char* caller)
 {
 	const int piece = luaL_checkint(L, 1) - 1;
@@ -923,6 +927,11 @@ bool CLuaUnitScript::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(WaitForTurn);
 	REGISTER_LUA_CFUNC(WaitForMove);
 
+	REGISTER_LUA_CFUNC(CreateAnimSequence);
+	REGISTER_LUA_CFUNC(PlayAnimSequence);
+	REGISTER_LUA_CFUNC(StopAnimSequence);
+	REGISTER_LUA_CFUNC(GetAnimSequence);
+
 	REGISTER_LUA_CFUNC(SetDeathScriptFinished);
 
 	REGISTER_LUA_CFUNC(GetPieceTranslation);
@@ -1395,6 +1404,121 @@ int CLuaUnitScript::WaitForMove(lua_State* L)
 }
 
 
+static CUnitScript::AnimKeyFrame ParseAnimKeyFrame(lua_State* L, const char* caller, int table)
+{
+	CUnitScript::AnimKeyFrame kf;
+
+	// {"turn" | "move", piece, axis, destination[, speed]} or {"spin", piece, axis, speed[, accel]}
+	for (int i = 1; i <= 6; i++) {
+		lua_rawgeti(L, table, i);
+	}
+
+	const int top = lua_gettop(L);
+	const char* type = luaL_checkstring(L, top - 5);
+
+	kf.piece = luaL_checkint(L, top - 4) - 1;
+	kf.axis = ParseAxis(L, caller, top - 3);
+	kf.dest = 0.0f;
+	kf.speed = 0.0f;
+	kf.accel = 0.0f;
+
+	if (strcmp(type, "turn") == 0 || strcmp(type, "move") == 0) {
+		kf.type = (type[0] == 't')? CUnitScript::ATurn: CUnitScript::AMove;
+		kf.dest = luaL_checkfloat(L, top - 2);
+		kf.speed = std::fabs(luaL_optfloat(L, top - 1, 0.0f));
+	} else if (strcmp(type, "spin") == 0) {
+		kf.type = CUnitScript::ASpin;
+		kf.speed = luaL_checkfloat(L, top - 2);
+		kf.accel = luaL_optfloat(L, top - 1, 0.0f);
+	} else {
+		luaL_error(L, "%s(): bad keyframe type \"%s\"", caller, type);
+	}
+
+	lua_pop(L, 6);
+	return kf;
+}
+
+
+int CLuaUnitScript::CreateAnimSequence(lua_State* L)
+{
+	// int CreateAnimSequence({{keyframe, ...}, ...}, bool loop)
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	CUnitScript::AnimSequence seq;
+
+	seq.loop = luaL_optboolean(L, 2, false);
+	seq.stepOffsets.push_back(0);
+
+	for (int i = 1, n = lua_objlen(L, 1); i <= n; i++) {
+		lua_rawgeti(L, 1, i);
+
+		if (!lua_istable(L, -1))
+			luaL_error(L, "%s(): step %d is not a table", __func__, i);
+
+		for (int j = 1, m = lua_objlen(L, -1); j <= m; j++) {
+			lua_rawgeti(L, -1, j);
+
+			if (!lua_istable(L, -1))
+				luaL_error(L, "%s(): keyframe %d of step %d is not a table", __func__, j, i);
+
+			seq.keyFrames.push_back(ParseAnimKeyFrame(L, __func__, lua_gettop(L)));
+			lua_pop(L, 1);
+		}
+
+		lua_pop(L, 1);
+		seq.stepOffsets.push_back(seq.keyFrames.size());
+	}
+
+	if (seq.NumSteps() == 0)
+		luaL_error(L, "%s(): sequence has no steps", __func__);
+
+	lua_pushnumber(L, unitScriptEngine->AddAnimSequence(std::move(seq)));
+	return 1;
+}
+
+
+int CLuaUnitScript::PlayAnimSequence(lua_State* L)
+{
+	// void PlayAnimSequence(int seqID, float speedScale = 1);
+	if (activeScript == nullptr)
+		return 0;
+
+	const int seqID = luaL_checkint(L, 1);
+	const float speedScale = luaL_optfloat(L, 2, 1.0f);
+
+	if (seqID < 0 || seqID >= int(unitScriptEngine->GetNumAnimSequences()))
+		luaL_error(L, "%s(): bad sequence ID %d", __func__, seqID);
+	if (speedScale <= 0.0f)
+		luaL_error(L, "%s(): speed scale must be positive", __func__);
+
+	activeScript->PlayAnimSequence(seqID, speedScale);
+	return 0;
+}
+
+
+int CLuaUnitScript::StopAnimSequence(lua_State* L)
+{
+	// void StopAnimSequence(); running turns and moves are not stopped
+	if (activeScript == nullptr)
+		return 0;
+
+	activeScript->StopAnimSequence();
+	return 0;
+}
+
+
+int CLuaUnitScript::GetAnimSequence(lua_State* L)
+{
+	// int seqID, int step GetAnimSequence(); nothing if not playing
+	if (activeScript == nullptr || activeScript->GetAnimSequenceID() < 0)
+		return 0;
+
+	lua_pushnumber(L, activeScript->GetAnimSequenceID());
+	lua_pushnumber(L, activeScript->GetAnimSequenceStep() + 1);
+	return 2;
+}
+
+
 int CLuaUnitScript::SetDeathScriptFinished(lua_State* L)
 {
 	if (activeUnit == nullptr || activeScript == nullptr)
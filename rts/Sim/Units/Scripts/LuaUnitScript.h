@@ -166,6 +166,11 @@ private:
 	static int WaitForTurn(lua_State* L);
 	static int WaitForMove(lua_State* L);
 
+	static int CreateAnimSequence(lua_State* L);
+	static int PlayAnimSequence(lua_State* L);
+	static int StopAnimSequence(lua_State* L);
+	static int GetAnimSequence(lua_State* L);
+
 	// Lua COB function to work around lack of working CBCobThreadFinish
 	static int SetDeathScriptFinished(lua_State* L);
 
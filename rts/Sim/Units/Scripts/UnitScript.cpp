@@ -53,6 +53,10 @@ CR_REG_METADATA(CUnitScript, (
 	CR_MEMBER(unit),
 	CR_MEMBER(busy),
 	CR_MEMBER(anims),
+	CR_IGNORED(doneAnims),
+	CR_MEMBER(animSeqID),
+	CR_MEMBER(animSeqStep),
+	CR_MEMBER(animSeqSpeed),
 
 	//Populated by children
 	CR_IGNORED(pieces),
@@ -73,10 +77,32 @@ CR_REG_METADATA_SUB(CUnitScript, AnimInfo,(
 	CR_MEMBER(hasWaiting)
 ))
 
+CR_BIND(CUnitScript::AnimKeyFrame,)
+
+CR_REG_METADATA_SUB(CUnitScript, AnimKeyFrame,(
+	CR_MEMBER(type),
+	CR_MEMBER(piece),
+	CR_MEMBER(axis),
+	CR_MEMBER(dest),
+	CR_MEMBER(speed),
+	CR_MEMBER(accel)
+))
+
+CR_BIND(CUnitScript::AnimSequence,)
+
+CR_REG_METADATA_SUB(CUnitScript, AnimSequence,(
+	CR_MEMBER(keyFrames),
+	CR_MEMBER(stepOffsets),
+	CR_MEMBER(loop)
+))
+
 
 CUnitScript::CUnitScript(CUnit* unit)
 	: unit(unit)
 	, busy(false)
+	, animSeqID(-1)
+	, animSeqStep(0)
+	, animSeqSpeed(1.0f)
 	, hasSetSFXOccupy(false)
 	, hasRockUnit(false)
 	, hasStartBuilding(false)
@@ -191,24 +217,25 @@ void CUnitScript::TickAnims(int tickRate, const TickAnimFunc& tickAnimFunc, Anim
 	}
 }
 
-/**
- * @brief Called by the engine when we are registered as animating.
-          If we return false there are no active animations left.
- * @param deltaTime int delta time to update
- * @return true if there are still active animations
- */
-bool CUnitScript::Tick(int deltaTime)
+void CUnitScript::TickAnims(int deltaTime)
 {
-	// vector of indexes of finished animations,
-	// so we can get rid of them in constant time
-	static AnimContainerType doneAnims[AMove + 1];
 	// tick-functions; these never change address
 	static constexpr TickAnimFunc tickAnimFuncs[AMove + 1] = {&CUnitScript::TickTurnAnim, &CUnitScript::TickSpinAnim, &CUnitScript::TickMoveAnim};
 
 	for (int animType = ATurn; animType <= AMove; animType++) {
 		TickAnims(1000 / deltaTime, tickAnimFuncs[animType], anims[animType], doneAnims[animType]);
 	}
+}
 
+/**
+ * @brief Called by the engine when we are registered as animating,
+          after TickAnims. If we return false there are no active
+          animations left.
+ * @param deltaTime int delta time to update
+ * @return true if there are still active animations
+ */
+bool CUnitScript::Tick(int deltaTime)
+{
 	// Tell listeners to unblock, and remove finished animations from the unit/script.
 	for (int animType = ATurn; animType <= AMove; animType++) {
 		for (AnimInfo& ai: doneAnims[animType]) {
@@ -218,10 +245,87 @@ bool CUnitScript::Tick(int deltaTime)
 		doneAnims[animType].clear();
 	}
 
+	if (animSeqID >= 0)
+		TickAnimSequence();
+
 	return (HaveAnimations());
 }
 
 
+void CUnitScript::TickAnimSequence()
+{
+	const AnimSequence& seq = unitScriptEngine->GetAnimSequence(animSeqID);
+
+	for (int i = seq.stepOffsets[animSeqStep], n = seq.stepOffsets[animSeqStep + 1]; i < n; i++) {
+		const AnimKeyFrame& kf = seq.keyFrames[i];
+
+		// spins never finish by themselves
+		if (kf.type != ASpin && IsInAnimation(AnimType(kf.type), kf.piece, kf.axis))
+			return;
+	}
+
+	if ((animSeqStep += 1) == seq.NumSteps()) {
+		animSeqStep = 0;
+
+		if (!seq.loop) {
+			animSeqID = -1;
+			return;
+		}
+	}
+
+	// at most one step per tick, even if it consists of only Now-keyframes
+	StartAnimSequenceStep(seq);
+}
+
+void CUnitScript::StartAnimSequenceStep(const AnimSequence& seq)
+{
+	for (int i = seq.stepOffsets[animSeqStep], n = seq.stepOffsets[animSeqStep + 1]; i < n; i++) {
+		const AnimKeyFrame& kf = seq.keyFrames[i];
+		const float speed = kf.speed * animSeqSpeed;
+
+		switch (kf.type) {
+			case ATurn: {
+				if (speed == 0.0f) {
+					TurnNow(kf.piece, kf.axis, kf.dest);
+				} else {
+					Turn(kf.piece, kf.axis, speed, kf.dest);
+				}
+			} break;
+			case AMove: {
+				if (speed == 0.0f) {
+					MoveNow(kf.piece, kf.axis, kf.dest);
+				} else {
+					Move(kf.piece, kf.axis, speed, kf.dest);
+				}
+			} break;
+			case ASpin: {
+				Spin(kf.piece, kf.axis, speed, kf.accel * animSeqSpeed);
+			} break;
+			default: {
+			} break;
+		}
+	}
+}
+
+void CUnitScript::PlayAnimSequence(int seqID, float speedScale)
+{
+	if (seqID == animSeqID) {
+		animSeqSpeed = speedScale;
+		return;
+	}
+
+	// keeps us scheduled for as long as the sequence plays
+	if (!HaveAnimations())
+		unitScriptEngine->AddInstance(this);
+
+	animSeqID = seqID;
+	animSeqStep = 0;
+	animSeqSpeed = speedScale;
+
+	StartAnimSequenceStep(unitScriptEngine->GetAnimSequence(animSeqID));
+}
+
+
 
 CUnitScript::AnimContainerTypeIt CUnitScript::FindAnim(AnimType type, int piece, int axis)
 {
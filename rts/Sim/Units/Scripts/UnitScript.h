@@ -19,9 +19,36 @@ class CUnitScript
 {
 	CR_DECLARE(CUnitScript)
 	CR_DECLARE_SUB(AnimInfo)
+	CR_DECLARE_SUB(AnimKeyFrame)
+	CR_DECLARE_SUB(AnimSequence)
 public:
 	enum AnimType {ANone = -1, ATurn = 0, ASpin = 1, AMove = 2};
 
+	// one Turn, Move or Spin call of an animation sequence step
+	struct AnimKeyFrame {
+		CR_DECLARE_STRUCT(AnimKeyFrame)
+		int type;
+		int piece;
+		int axis;
+		float dest;     // unused by spins
+		float speed;    // zero means TurnNow or MoveNow, final speed when spinning
+		float accel;    // spins only
+	};
+
+	// a sequence of steps registered once and played natively, i.e. without
+	// resuming a script thread; each step is started when every turn and move
+	// of the previous step has finished (as if waited for with WaitForTurn/Move)
+	struct AnimSequence {
+		CR_DECLARE_STRUCT(AnimSequence)
+		int NumSteps() const { return (int(stepOffsets.size()) - 1); }
+
+		// keyframes of step i are [stepOffsets[i], stepOffsets[i + 1])
+		std::vector<AnimKeyFrame> keyFrames;
+		std::vector<int> stepOffsets;
+
+		bool loop;
+	};
+
 public:
 	static const int UNIT_VAR_COUNT   = 8;
 	static const int TEAM_VAR_COUNT   = 64;
@@ -59,6 +86,13 @@ protected:
 	typedef bool(CUnitScript::*TickAnimFunc)(int, LocalModelPiece&, AnimInfo&);
 
 	AnimContainerType anims[AMove + 1];
+	// finished animations with waiting threads, between TickAnims and Tick
+	AnimContainerType doneAnims[AMove + 1];
+
+	// currently played sequence (index into CUnitScriptEngine::animSequences)
+	int animSeqID;
+	int animSeqStep;
+	float animSeqSpeed;
 
 
 	bool hasSetSFXOccupy;
@@ -73,6 +107,9 @@ protected:
 	void RemoveAnim(AnimType type, const AnimContainerTypeIt& animInfoIt);
 	void AddAnim(AnimType type, int piece, int axis, float speed, float dest, float accel);
 
+	void TickAnimSequence();
+	void StartAnimSequenceStep(const AnimSequence& seq);
+
 	virtual void ShowScriptError(const std::string& msg) = 0;
 
 	void ShowUnitScriptError(const std::string& msg);
@@ -122,7 +159,13 @@ public:
 	      CUnit* GetUnit()       { return unit; }
 	const CUnit* GetUnit() const { return unit; }
 
-	bool Tick(int tickRate);
+	/**
+	 * Advances all piece animations; touches nothing but this script and
+	 * its unit's pieces, so scripts can be ticked concurrently. Tick must
+	 * be called afterwards (serially) to run the AnimFinished callbacks.
+	 */
+	void TickAnims(int deltaTime);
+	bool Tick(int deltaTime);
 	// note: must copy-and-set here (LMP dirty flag, etc)
 	bool TickMoveAnim(int tickRate, LocalModelPiece& lmp, AnimInfo& ai) { float3 pos = lmp.GetPosition(); const bool ret = MoveToward(pos[ai.axis], ai.dest, ai.speed / tickRate); lmp.SetPosition(pos); return ret; }
 	bool TickTurnAnim(int tickRate, LocalModelPiece& lmp, AnimInfo& ai) { float3 rot = lmp.GetRotation(); const bool ret = TurnToward(rot[ai.axis], ai.dest, ai.speed / tickRate); lmp.SetRotation(rot); return ret; }
@@ -137,6 +180,14 @@ public:
 	void MoveNow(int piece, int axis, float destination);
 	void TurnNow(int piece, int axis, float destination);
 
+	// speedScale multiplies all keyframe speeds; replaying the current sequence
+	// only changes its speed (from the next step onwards)
+	void PlayAnimSequence(int seqID, float speedScale);
+	void StopAnimSequence() { animSeqID = -1; animSeqStep = 0; }
+
+	int GetAnimSequenceID() const { return animSeqID; }
+	int GetAnimSequenceStep() const { return animSeqStep; }
+
 	bool NeedsWait(AnimType type, int piece, int axis);
 
 	// misc, used by CCobThread and callouts for Lua unitscripts
@@ -158,7 +209,7 @@ public:
 		return (FindAnim(type, piece, axis) != anims[type].end());
 	}
 	bool HaveAnimations() const {
-		return (!anims[ATurn].empty() || !anims[ASpin].empty() || !anims[AMove].empty());
+		return (!anims[ATurn].empty() || !anims[ASpin].empty() || !anims[AMove].empty() || animSeqID >= 0);
 	}
 
 	// checks for callin existence
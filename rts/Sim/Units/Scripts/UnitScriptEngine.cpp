@@ -12,14 +12,19 @@
 #include "System/ContainerUtil.h"
 #include "System/SafeUtil.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/Threading/ThreadPool.h" // for_mt
 
 CUnitScriptEngine* unitScriptEngine = nullptr;
 
+// below this many animating scripts threading costs more than it saves
+static constexpr size_t MIN_PARALLEL_ANIMATING = 256;
+
 
 CR_BIND(CUnitScriptEngine, )
 
 CR_REG_METADATA(CUnitScriptEngine, (
 	CR_MEMBER(animating),
+	CR_MEMBER(animSequences),
 
 	//always null when saving
 	CR_IGNORED(currentScript)
@@ -119,7 +124,20 @@ void CUnitScriptEngine::Tick(int deltaTime)
 {
 	cobEngine->Tick(deltaTime);
 
-	// Tick all instances that have registered themselves as animating
+	// advance the animations of all instances that have registered themselves
+	// as animating; every script only touches its own pieces, so the outcome
+	// does not depend on how work is split over threads
+	if (animating.size() >= MIN_PARALLEL_ANIMATING) {
+		for_mt(0, animating.size(), [&](const int i) {
+			animating[i]->TickAnims(deltaTime);
+		});
+	} else {
+		for (CUnitScript* script: animating) {
+			script->TickAnims(deltaTime);
+		}
+	}
+
+	// run callbacks and sequences serially in the usual order
 	size_t i = 0;
 	while (i < animating.size()) {
 		currentScript = animating[i];
@@ -5,12 +5,12 @@
 #ifndef UNIT_SCRIPT_ENGINE_H
 #define UNIT_SCRIPT_ENGINE_H
 
+#include "UnitScript.h"
 #include "System/creg/creg_cond.h"
 #include <vector>
 
 struct UnitDef;
 class CUnit;
-class CUnitScript;
 
 
 class CUnitScriptEngine
@@ -19,6 +19,7 @@ class CUnitScriptEngine
 
 protected:
 	std::vector<CUnitScript*> animating; // hash would be optimal, but not crucial
+	std::vector<CUnitScript::AnimSequence> animSequences; // shared by all scripts, never removed
 	void CheckForDuplicates(const char* name, const CUnitScript* instance);
 
 public:
@@ -29,6 +30,14 @@ public:
 	void ReloadScripts(const UnitDef* udef);
 	void Tick(int deltaTime);
 
+	int AddAnimSequence(CUnitScript::AnimSequence&& seq) {
+		animSequences.push_back(std::move(seq));
+		return (animSequences.size() - 1);
+	}
+
+	const CUnitScript::AnimSequence& GetAnimSequence(int seqID) const { return animSequences[seqID]; }
+	size_t GetNumAnimSequences() const { return animSequences.size(); }
+
 	static void InitStatic();
 	static void KillStatic();
 private:
@@ -187,6 +187,8 @@ CUnit::CUnit()
 , cloakTimeout(128)
 , curCloakTimeout(gs->frameNum)
 , decloakDistance(0.0f)
+, decloakQueryFrame(-1)
+, decloakQueryResult(false)
 , lastTerrainType(-1)
 , curTerrainType(0)
 , selfDCountdown(0)
@@ -1183,6 +1185,19 @@ void CUnit::SlowUpdate()
 }
 
 
+void CUnit::GatherSlowUpdate()
+{
+	// mirrors the conditions under which SlowUpdate reaches GetNewCloakState(false)
+	if (health < 0.0f || beingBuilt || IsStunned())
+		return;
+	if (decloakDistance <= 0.0f || scriptCloak >= 3 || !(wantCloak || (scriptCloak >= 1)))
+		return;
+
+	decloakQueryFrame = gs->frameNum;
+	decloakQueryResult = (CGameHelper::GetClosestEnemyUnitNoLosTest(NULL, midPos, decloakDistance, allyteam, unitDef->decloakSpherical, false) != NULL);
+}
+
+
 bool CUnit::CanUpdateWeapons() const
 {
 	return (!beingBuilt && !IsStunned() && !dontUseWeapons && !dontFire && !isDead);
@@ -1616,17 +1631,15 @@ void CUnit::ChangeTeamReset()
 	// stop friendly units shooting at us
 	std::vector<CUnit*> alliedunits;
 
-	for (const auto& objs: GetAllListeners()) {
-		for (CObject* obj: objs) {
-			CUnit* u = dynamic_cast<CUnit*>(obj);
+	for (const Dependence& d: GetAllListeners()) {
+		CUnit* u = dynamic_cast<CUnit*>(d.obj);
 
-			if (u == nullptr)
-				continue;
-			if (!teamHandler->AlliedTeams(team, u->team))
-				continue;
+		if (u == nullptr)
+			continue;
+		if (!teamHandler->AlliedTeams(team, u->team))
+			continue;
 
-			alliedunits.push_back(u);
-		}
+		alliedunits.push_back(u);
 	}
 	for (auto ui = alliedunits.cbegin(); ui != alliedunits.cend(); ++ui) {
 		(*ui)->StopAttackingAllyTeam(allyteam);
@@ -2430,10 +2443,19 @@ bool CUnit::GetNewCloakState(bool stunCheck) {
 		return true;
 
 	if (wantCloak || (scriptCloak >= 1)) {
-		const CUnit* closestEnemy = CGameHelper::GetClosestEnemyUnitNoLosTest(NULL, midPos, decloakDistance, allyteam, unitDef->decloakSpherical, false);
 		const float cloakCost = (Square(speed.w) > 0.2f)? unitDef->cloakCostMoving: unitDef->cloakCost;
 
-		if (decloakDistance > 0.0f && closestEnemy != NULL) {
+		bool enemyInRange = false;
+
+		if (decloakDistance > 0.0f) {
+			if (decloakQueryFrame == gs->frameNum) {
+				enemyInRange = decloakQueryResult;
+			} else {
+				enemyInRange = (CGameHelper::GetClosestEnemyUnitNoLosTest(NULL, midPos, decloakDistance, allyteam, unitDef->decloakSpherical, false) != NULL);
+			}
+		}
+
+		if (enemyInRange) {
 			curCloakTimeout = gs->frameNum + cloakTimeout;
 			return false;
 		}
@@ -2940,6 +2962,8 @@ CR_REG_METADATA(CUnit, (
 	CR_MEMBER(curCloakTimeout),
 	CR_MEMBER(isCloaked),
 	CR_MEMBER(decloakDistance),
+	CR_IGNORED(decloakQueryFrame),
+	CR_IGNORED(decloakQueryResult),
 
 	CR_MEMBER(lastTerrainType),
 	CR_MEMBER(curTerrainType),
@@ -80,6 +80,8 @@ public:
 
 	virtual void SlowUpdate();
 	virtual void SlowUpdateWeapons();
+	/// read-only queries of the next SlowUpdate, may run concurrently for different units
+	void GatherSlowUpdate();
 	virtual void Update();
 
 	const SolidObjectDef* GetDef() const { return ((const SolidObjectDef*) unitDef); }
@@ -513,6 +515,9 @@ public:
 	/// the earliest frame the unit can cloak again
 	int curCloakTimeout;
 	float decloakDistance;
+	/// frame of the last GatherSlowUpdate that queried for enemies within decloakDistance, and its result
+	int decloakQueryFrame;
+	bool decloakQueryResult;
 
 	int lastTerrainType;
 	/// Used for calling setSFXoccupy which TA scripts want
@@ -48,6 +48,9 @@ CUnitDefHandler::CUnitDefHandler(LuaParser* defsParser) : noCost(false)
 		const string& unitName = unitDefNames[a];
 		LuaTable udTable = rootTable.SubTable(unitName);
 
+		// UnitDef reads a few hundred keys, most of them absent
+		udTable.IndexFields();
+
 		// parse the unitdef data (but don't load buildpics, etc...)
 		PushNewUnitDef(StringToLower(unitName), udTable);
 	}
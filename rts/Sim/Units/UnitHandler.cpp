@@ -1,6 +1,8 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cassert>
+#include <cstdint>
 
 #include "UnitHandler.h"
 #include "Unit.h"
@@ -11,15 +13,20 @@
 #include "UnitTypes/Factory.h"
 
 #include "CommandAI/BuilderCAI.h"
+#include "Game/GameHelper.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/ModInfo.h"
+#include "Sim/Misc/SimCostProfiler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/MoveTypes/MoveType.h"
 #include "Sim/Weapons/Weapon.h"
+#include "Sim/Weapons/WeaponDef.h"
 #include "System/EventHandler.h"
 #include "System/Log/ILog.h"
 #include "System/myMath.h"
 #include "System/TimeProfiler.h"
 #include "System/Sync/SyncTracer.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/creg/STL_Deque.h"
 #include "System/creg/STL_List.h"
 #include "System/creg/STL_Set.h"
@@ -31,6 +38,11 @@ CR_REG_METADATA(CUnitHandler, (
 	CR_MEMBER(unitsByDefs),
 	CR_MEMBER(activeUnits),
 	CR_MEMBER(builderCAIs),
+	CR_IGNORED(autoTargetQueue),
+	CR_IGNORED(autoTargetLists),
+	CR_IGNORED(slowUpdatedUnits),
+	CR_IGNORED(collisionBroadphase),
+	CR_IGNORED(reorderKeys),
 	CR_MEMBER(idPool),
 	CR_MEMBER(unitsToBeRemoved),
 	CR_MEMBER(activeSlowUpdateUnit),
@@ -189,6 +201,9 @@ void CUnitHandler::DeleteUnitsNow()
 	if (unitsToBeRemoved.empty())
 		return;
 
+	// queued events may still reference these units
+	eventHandler.FlushQueuedEvents();
+
 	while (!unitsToBeRemoved.empty()) {
 		DeleteUnitNow(unitsToBeRemoved.back());
 		unitsToBeRemoved.pop_back();
@@ -247,28 +262,64 @@ void CUnitHandler::Update()
 	};
 
 	DeleteUnitsNow();
+	ReorderActiveUnits();
+
+	auto UPDATE_MOVETYPE = [&](CUnit* unit, bool twoPhase) {
+		AMoveType* moveType = unit->moveType;
+		CSimCostProfiler::ScopedCost cost(CSimCostProfiler::CATEGORY_UNITDEF, unit->unitDef->id, CSimCostProfiler::PART_UNIT_MOVETYPE);
+
+		UNIT_SANITY_CHECK(unit);
+
+		if (twoPhase? moveType->UpdateCommit(): moveType->Update())
+			movedUnits.push_back(unit);
+
+		if (!unit->pos.IsInBounds() && (unit->speed.w > MAX_UNIT_SPEED)) {
+			// this unit is not coming back, kill it now without any death
+			// sequence (so deathScriptFinished becomes true immediately)
+			unit->KillUnit(nullptr, false, true, false);
+		}
+
+		UNIT_SANITY_CHECK(unit);
+	};
 
 	{
 		SCOPED_TIMER("Sim::Unit::MoveType");
 
-		for (activeUpdateUnit = 0; activeUpdateUnit < activeUnits.size(); ++activeUpdateUnit) {
-			CUnit* unit = activeUnits[activeUpdateUnit];
-			AMoveType* moveType = unit->moveType;
+		movedUnits.clear();
 
-			UNIT_SANITY_CHECK(unit);
+		if (modInfo.allowUnitCollisionBroadphase) {
+			SCOPED_TIMER("Sim::Unit::MoveType::Broadphase");
+			collisionBroadphase.Update(activeUnits, maxUnits);
+		}
 
-			if (moveType->Update())
-				eventHandler.UnitMoved(unit);
+		if (!modInfo.allowParallelMoveTypeUpdates) {
+			for (activeUpdateUnit = 0; activeUpdateUnit < activeUnits.size(); ++activeUpdateUnit) {
+				CUnit* unit = activeUnits[activeUpdateUnit];
 
-			if (!unit->pos.IsInBounds() && (unit->speed.w > MAX_UNIT_SPEED)) {
-				// this unit is not coming back, kill it now without any death
-				// sequence (so deathScriptFinished becomes true immediately)
-				unit->KillUnit(nullptr, false, true, false);
+				UPDATE_MOVETYPE(unit, false);
+				assert(activeUnits[activeUpdateUnit] == unit);
+			}
+		} else {
+			// compute-phase; every unit only sees start-of-frame state so
+			// the outcome does not depend on how work is split over threads
+			for_mt(0, activeUnits.size(), [&](const int i) {
+				CUnit* unit = activeUnits[i];
+				CSimCostProfiler::ScopedCost cost(CSimCostProfiler::CATEGORY_UNITDEF, unit->unitDef->id, CSimCostProfiler::PART_UNIT_MOVETYPE);
+
+				unit->moveType->UpdateCompute();
+			});
+
+			// commit-phase; apply in ID-order (independent of insertion order)
+			for (CUnit* unit: units) {
+				if (unit == nullptr)
+					continue;
+
+				UPDATE_MOVETYPE(unit, true);
 			}
-
-			UNIT_SANITY_CHECK(unit);
-			assert(activeUnits[activeUpdateUnit] == unit);
 		}
+
+		// units killed above are still alive until the deletion pass below
+		eventHandler.UnitsMoved(movedUnits.data(), movedUnits.size());
 	}
 
 	{
@@ -307,18 +358,53 @@ void CUnitHandler::Update()
 		if ((gs->frameNum % UNIT_SLOWUPDATE_RATE) == 0)
 			activeSlowUpdateUnit = 0;
 
+		if (modInfo.allowParallelWeaponTargeting)
+			CWeapon::autoTargetQueue = &autoTargetQueue;
+
+		const size_t numSlowUpdates = (activeUnits.size() / UNIT_SLOWUPDATE_RATE) + 1;
+		const bool parallelSlowUpdate = modInfo.allowParallelUnitSlowUpdate;
+
+		if (parallelSlowUpdate) {
+			// gather-phase; units created or killed by the serial phase below
+			// simply have nothing gathered and query on their own again
+			const size_t beg = std::min(activeSlowUpdateUnit, activeUnits.size());
+			const size_t end = std::min(beg + numSlowUpdates, activeUnits.size());
+
+			for_mt(beg, end, [&](const int i) {
+				activeUnits[i]->GatherSlowUpdate();
+			});
+
+			slowUpdatedUnits.clear();
+		}
+
 		// stagger the SlowUpdate's
-		for (size_t n = (activeUnits.size() / UNIT_SLOWUPDATE_RATE) + 1; (activeSlowUpdateUnit < activeUnits.size() && n != 0); ++activeSlowUpdateUnit) {
+		for (size_t n = numSlowUpdates; (activeSlowUpdateUnit < activeUnits.size() && n != 0); ++activeSlowUpdateUnit) {
 			CUnit* unit = activeUnits[activeSlowUpdateUnit];
+			CSimCostProfiler::ScopedCost cost(CSimCostProfiler::CATEGORY_UNITDEF, unit->unitDef->id, CSimCostProfiler::PART_UNIT_SLOWUPDATE);
 
 			UNIT_SANITY_CHECK(unit);
 			unit->SlowUpdate();
 			unit->SlowUpdateWeapons();
-			unit->SlowUpdateLocalModel();
+
+			if (parallelSlowUpdate) {
+				slowUpdatedUnits.push_back(unit);
+			} else {
+				unit->SlowUpdateLocalModel();
+			}
 			UNIT_SANITY_CHECK(unit);
 
 			n--;
 		}
+
+		// a unit's bounding-volume only depends on its own pieces
+		if (parallelSlowUpdate) {
+			for_mt(0, slowUpdatedUnits.size(), [&](const int i) {
+				slowUpdatedUnits[i]->SlowUpdateLocalModel();
+			});
+		}
+
+		CWeapon::autoTargetQueue = nullptr;
+		UpdateAutoTargets();
 	}
 
 	{
@@ -326,6 +412,8 @@ void CUnitHandler::Update()
 
 		for (activeUpdateUnit = 0; activeUpdateUnit < activeUnits.size(); ++activeUpdateUnit) {
 			CUnit* unit = activeUnits[activeUpdateUnit];
+			CSimCostProfiler::ScopedCost cost(CSimCostProfiler::CATEGORY_UNITDEF, unit->unitDef->id, CSimCostProfiler::PART_UNIT_UPDATE);
+
 			UNIT_SANITY_CHECK(unit);
 			unit->Update();
 			// unsynced; done on-demand when drawing unit
@@ -342,6 +430,7 @@ void CUnitHandler::Update()
 			CUnit* unit = activeUnits[activeUpdateUnit];
 			if (unit->CanUpdateWeapons()) {
 				for (CWeapon* w: unit->weapons) {
+					CSimCostProfiler::ScopedCost cost(CSimCostProfiler::CATEGORY_WEAPONDEF, w->weaponDef->id, CSimCostProfiler::PART_WEAPON_UPDATE);
 					w->Update();
 				}
 			}
@@ -352,6 +441,87 @@ void CUnitHandler::Update()
 
 
 
+static std::uint32_t SpreadBits16(std::uint32_t v)
+{
+	v = (v | (v << 8)) & 0x00FF00FFu;
+	v = (v | (v << 4)) & 0x0F0F0F0Fu;
+	v = (v | (v << 2)) & 0x33333333u;
+	v = (v | (v << 1)) & 0x55555555u;
+	return v;
+}
+
+void CUnitHandler::ReorderActiveUnits()
+{
+	if (modInfo.unitUpdateReorderRate <= 0)
+		return;
+
+	// only reorder when a new round of staggered SlowUpdate's is about to
+	// begin (activeSlowUpdateUnit gets reset), otherwise some units would
+	// be skipped or SlowUpdate'd twice in the same round
+	const int reorderRate = ((modInfo.unitUpdateReorderRate + UNIT_SLOWUPDATE_RATE - 1) / UNIT_SLOWUPDATE_RATE) * UNIT_SLOWUPDATE_RATE;
+
+	if ((gs->frameNum % reorderRate) != 0)
+		return;
+
+	SCOPED_TIMER("Sim::Unit::Reorder");
+
+	reorderKeys.clear();
+	reorderKeys.reserve(activeUnits.size());
+
+	// key on (synced) map-square coordinates; the ID in the low bits keeps
+	// the sort stable and equal on all clients even for stacked units
+	for (const CUnit* unit: activeUnits) {
+		const std::uint32_t sx = Clamp(int(unit->pos.x / SQUARE_SIZE), 0, 0xFFFF);
+		const std::uint32_t sz = Clamp(int(unit->pos.z / SQUARE_SIZE), 0, 0xFFFF);
+		const std::uint64_t zk = SpreadBits16(sx) | (SpreadBits16(sz) << 1);
+
+		reorderKeys.push_back((zk << 32) | unit->id);
+	}
+
+	std::sort(reorderKeys.begin(), reorderKeys.end());
+
+	for (size_t i = 0, n = reorderKeys.size(); i < n; i++) {
+		activeUnits[i] = units[reorderKeys[i] & 0xFFFFFFFFu];
+	}
+}
+
+
+void CUnitHandler::UpdateAutoTargets()
+{
+	if (autoTargetQueue.empty())
+		return;
+
+	SCOPED_TIMER("Sim::Unit::Weapon::AutoTarget");
+
+	if (autoTargetLists.size() < autoTargetQueue.size())
+		autoTargetLists.resize(autoTargetQueue.size());
+
+	// gather-phase; nothing is written to sim-state, so every weapon sees the
+	// same (post-SlowUpdate) snapshot regardless of how work is split between
+	// threads
+	for_mt(0, autoTargetQueue.size(), [&](const int i) {
+		const CWeapon* weapon = autoTargetQueue[i];
+
+		autoTargetLists[i].clear();
+		CGameHelper::GatherWeaponTargets(weapon, weapon->GetAvoidTarget(), autoTargetLists[i]);
+	});
+
+	// pick-phase; in queue (i.e. SlowUpdate) order
+	for (size_t i = 0, n = autoTargetQueue.size(); i < n; i++) {
+		CWeapon* weapon = autoTargetQueue[i];
+
+		// owner may have been killed by a later unit's SlowUpdate
+		if (!weapon->owner->CanUpdateWeapons())
+			continue;
+
+		CGameHelper::FilterWeaponTargets(weapon, autoTargetLists[i]);
+		weapon->AutoTarget(autoTargetLists[i]);
+	}
+
+	autoTargetQueue.clear();
+}
+
+
 void CUnitHandler::AddBuilderCAI(CBuilderCAI* b)
 {
 	// called from CBuilderCAI --> owner is already valid
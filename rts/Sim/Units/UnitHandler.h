@@ -3,14 +3,17 @@
 #ifndef UNITHANDLER_H
 #define UNITHANDLER_H
 
+#include <cstdint>
 #include <vector>
 
 #include "UnitDef.h"
 #include "Sim/Misc/SimObjectIDPool.h"
+#include "Sim/MoveTypes/UnitCollisionBroadphase.h"
 #include "System/creg/STL_Map.h"
 
 class CUnit;
 class CBuilderCAI;
+class CWeapon;
 
 class CUnitHandler
 {
@@ -56,6 +59,8 @@ public:
 
 	const spring::unordered_map<unsigned int, CBuilderCAI*>& GetBuilderCAIs() const { return builderCAIs; }
 
+	CUnitCollisionBroadphase& GetCollisionBroadphase() { return collisionBroadphase; }
+
 public:
 	// FIXME
 	std::vector<std::vector<std::vector<CUnit*>>> unitsByDefs; ///< units sorted by team and unitDef
@@ -65,6 +70,8 @@ private:
 	void DeleteUnitNow(CUnit* unit);
 	void DeleteUnitsNow();
 	void InsertActiveUnit(CUnit* unit);
+	void UpdateAutoTargets();
+	void ReorderActiveUnits();
 
 private:
 	SimObjectIDPool idPool;
@@ -75,6 +82,19 @@ private:
 
 	spring::unordered_map<unsigned int, CBuilderCAI*> builderCAIs;
 
+	///< weapons queued for auto-targeting during this frame's SlowUpdate
+	///< batch, and the candidate targets gathered (in parallel) for each
+	std::vector<CWeapon*> autoTargetQueue;
+	std::vector<std::vector<std::pair<float, CUnit*>>> autoTargetLists;
+	///< units SlowUpdate'd this frame, their local models are updated in parallel
+	std::vector<CUnit*> slowUpdatedUnits;
+	///< candidate ground-unit collision pairs, rebuilt every frame
+	CUnitCollisionBroadphase collisionBroadphase;
+	///< units whose MoveType reported a move this frame, in update order
+	std::vector<const CUnit*> movedUnits;
+	///< scratch-space for ReorderActiveUnits; {Z-order key, unit ID}
+	std::vector<std::uint64_t> reorderKeys;
+
 	size_t activeSlowUpdateUnit;  ///< first unit of batch that will be SlowUpdate'd this frame
 	size_t activeUpdateUnit;  ///< first unit of batch that will be SlowUpdate'd this frame
 
@@ -3,24 +3,21 @@
 // Used for all metal-extractors.
 // Handles the metal-make-process.
 
-#include <typeinfo>
+#include <algorithm>
 #include "ExtractorBuilding.h"
 #include "Sim/Units/Scripts/UnitScript.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Map/ReadMap.h"
 #include "Sim/Units/UnitDef.h"
 #include "Map/MetalMap.h"
-#include "Sim/Misc/QuadField.h"
 #include "System/Sync/SyncTracer.h"
-#include "System/ContainerUtil.h"
 
 
 CR_BIND_DERIVED(CExtractorBuilding, CBuilding, )
 CR_REG_METADATA(CExtractorBuilding, (
 	CR_MEMBER(extractionRange),
 	CR_MEMBER(extractionDepth),
-	CR_MEMBER(metalAreaOfControl),
-	CR_MEMBER(neighbours)
+	CR_MEMBER(metalAreaOfControl)
 ))
 
 CR_BIND(CExtractorBuilding::MetalSquareOfControl, )
@@ -31,9 +28,6 @@ CR_REG_METADATA_SUB(CExtractorBuilding,MetalSquareOfControl, (
 	CR_MEMBER(extractionDepth)
 ))
 
-// TODO: How are class statics incorporated into creg?
-float CExtractorBuilding::maxExtractionRange = 0.0f;
-
 CExtractorBuilding::~CExtractorBuilding()
 {
 	// if uh == NULL then all pointers to units should be considered dangling pointers
@@ -42,58 +36,59 @@ CExtractorBuilding::~CExtractorBuilding()
 	}
 }
 
-/* resets the metalMap and notifies the neighbours */
+/* resets the metalMap and hands our squares to the extractors also covering them */
 void CExtractorBuilding::ResetExtraction()
 {
-	// undo the extraction-area
-	for (auto si = metalAreaOfControl.begin(); si != metalAreaOfControl.end(); ++si) {
-		readMap->metalMap->RemoveExtraction(si->x, si->z, si->extractionDepth);
-	}
+	CMetalMap* metalMap = readMap->metalMap;
 
-	metalAreaOfControl.clear();
+	std::vector<CMetalMap::ExtractionChange> changes;
 
-	// tell the neighbours (if any) to take it over
-	for (CExtractorBuilding* ngb: neighbours) {
-		ngb->RemoveNeighbour(this);
-		ngb->ReCalculateMetalExtraction();
+	// undo the extraction-area; only squares we covered are touched
+	for (const MetalSquareOfControl& msqr: metalAreaOfControl) {
+		metalMap->RemoveExtractor(msqr.x, msqr.z, id, changes);
 	}
-	neighbours.clear();
-}
 
+	metalAreaOfControl.clear();
 
+	// apply per extractor in ID order so the float sums are reproducible
+	std::sort(changes.begin(), changes.end(), [](const CMetalMap::ExtractionChange& a, const CMetalMap::ExtractionChange& b) {
+		return ((a.unitID < b.unitID) || (a.unitID == b.unitID && a.areaIdx < b.areaIdx));
+	});
 
-/* determine if two extraction areas overlap */
-bool CExtractorBuilding::IsNeighbour(CExtractorBuilding* other)
-{
-	// circle vs. circle
-	return (this->pos.SqDistance2D(other->pos) < Square(this->extractionRange + other->extractionRange));
-}
+	for (const CMetalMap::ExtractionChange& change: changes) {
+		CExtractorBuilding* eb = static_cast<CExtractorBuilding*>(unitHandler->GetUnit(change.unitID));
+		MetalSquareOfControl& msqr = eb->metalAreaOfControl[change.areaIdx];
 
-/* sets the range of extraction for this extractor, also finds overlapping neighbours. */
-void CExtractorBuilding::SetExtractionRangeAndDepth(float range, float depth)
-{
-	extractionRange = std::max(range, 0.001f);
-	extractionDepth = std::max(depth, 0.0f);
-	maxExtractionRange = std::max(extractionRange, maxExtractionRange);
+		assert(eb != this);
 
-	// find any neighbouring extractors
-	QuadFieldQuery qfQuery;
-	quadField->GetUnits(qfQuery, pos, extractionRange + maxExtractionRange);
+		msqr.extractionDepth += change.delta;
+		eb->metalExtract += change.delta * metalMap->GetMetalAmount(msqr.x, msqr.z);
+	}
 
-	for (CUnit* u: *qfQuery.units) {
-		if (u == this)
-			continue;
-		if (typeid(*u) != typeid(CExtractorBuilding))
+	// set the new rotation-speeds only after all shares are settled, since
+	// scripts are free to change extraction from within the call-in
+	for (size_t i = 0, n = changes.size(); i < n; i++) {
+		if (i > 0 && changes[i].unitID == changes[i - 1].unitID)
 			continue;
 
-		CExtractorBuilding* eb = static_cast<CExtractorBuilding*>(u);
+		CExtractorBuilding* eb = static_cast<CExtractorBuilding*>(unitHandler->GetUnit(changes[i].unitID));
 
-		if (!IsNeighbour(eb))
+		if (eb == nullptr)
 			continue;
 
-		this->AddNeighbour(eb);
-		eb->AddNeighbour(this);
+		eb->script->ExtractionRateChanged(eb->metalExtract);
 	}
+}
+
+
+
+/* sets the range of extraction for this extractor and claims its share of every square in range */
+void CExtractorBuilding::SetExtractionRangeAndDepth(float range, float depth)
+{
+	extractionRange = std::max(range, 0.001f);
+	extractionDepth = std::max(depth, 0.0f);
+
+	CMetalMap* metalMap = readMap->metalMap;
 
 	// calculate this extractor's area of control and metalExtract amount
 	metalExtract = 0;
@@ -117,9 +112,9 @@ void CExtractorBuilding::SetExtractionRangeAndDepth(float range, float depth)
 				msqr.x = x;
 				msqr.z = z;
 				// extraction is done in a cylinder of height <depth>
-				msqr.extractionDepth = readMap->metalMap->RequestExtraction(x, z, depth);
+				msqr.extractionDepth = metalMap->AddExtractor(x, z, id, metalAreaOfControl.size(), extractionDepth);
 				metalAreaOfControl.push_back(msqr);
-				metalExtract += msqr.extractionDepth * readMap->metalMap->GetMetalAmount(msqr.x, msqr.z);
+				metalExtract += msqr.extractionDepth * metalMap->GetMetalAmount(msqr.x, msqr.z);
 			}
 		}
 	}
@@ -129,41 +124,6 @@ void CExtractorBuilding::SetExtractionRangeAndDepth(float range, float depth)
 }
 
 
-/* adds a neighbour for this extractor */
-void CExtractorBuilding::AddNeighbour(CExtractorBuilding* neighbour)
-{
-	assert(neighbour != this);
-	spring::VectorInsertUnique(neighbours, neighbour, true);
-}
-
-/* removes a neighbour for this extractor */
-void CExtractorBuilding::RemoveNeighbour(CExtractorBuilding* neighbour)
-{
-	assert(neighbour != this);
-	spring::VectorErase(neighbours, neighbour);
-}
-
-
-/* recalculate metalExtract for this extractor (eg. when a neighbour dies) */
-void CExtractorBuilding::ReCalculateMetalExtraction()
-{
-	metalExtract = 0;
-
-	CMetalMap* metalMap = readMap->metalMap;
-
-	for (MetalSquareOfControl& msqr: metalAreaOfControl) {
-		metalMap->RemoveExtraction(msqr.x, msqr.z, msqr.extractionDepth);
-
-		// extraction is done in a cylinder
-		msqr.extractionDepth = metalMap->RequestExtraction(msqr.x, msqr.z, extractionDepth);
-		metalExtract += msqr.extractionDepth * metalMap->GetMetalAmount(msqr.x, msqr.z);
-	}
-
-	// set the new rotation-speed
-	script->ExtractionRateChanged(metalExtract);
-}
-
-
 /* Finds the amount of metal to extract and sets the rotationspeed when the extractor is built. */
 void CExtractorBuilding::FinishedBuilding(bool postInit)
 {
@@ -20,10 +20,6 @@ public:
 
 	void ResetExtraction();
 	void SetExtractionRangeAndDepth(float range, float depth);
-	void ReCalculateMetalExtraction();
-	bool IsNeighbour(CExtractorBuilding* neighbour);
-	void AddNeighbour(CExtractorBuilding* neighbour);
-	void RemoveNeighbour(CExtractorBuilding* neighbour);
 
 	float GetExtractionRange() const { return extractionRange; }
 	float GetExtractionDepth() const { return extractionDepth; }
@@ -40,9 +36,6 @@ protected:
 
 	float extractionRange, extractionDepth;
 	std::vector<MetalSquareOfControl> metalAreaOfControl;
-	std::vector<CExtractorBuilding*> neighbours;
-
-	static float maxExtractionRange;
 };
 
 #endif // _EXTRACTOR_BUILDING_H
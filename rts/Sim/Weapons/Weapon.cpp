@@ -98,6 +98,8 @@ CR_REG_METADATA(CWeapon, (
 ))
 
 
+std::vector<CWeapon*>* CWeapon::autoTargetQueue = nullptr;
+
 
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
@@ -624,8 +626,6 @@ bool CWeapon::AutoTarget()
 	// search for other in range targets
 	lastTargetRetry = gs->frameNum;
 
-	const CUnit* avoidUnit = (avoidTarget && currentTarget.type == Target_Unit) ? currentTarget.unit : nullptr;
-
 	// NOTE:
 	//   GenerateWeaponTargets sorts by INCREASING order of priority, so lower equals better
 	//   <targets> is normally sorted such that all bad TargetCategory units are at the end,
@@ -635,8 +635,13 @@ bool CWeapon::AutoTarget()
 	targets.clear();
 	targets.reserve(16);
 
-	CGameHelper::GenerateWeaponTargets(this, avoidUnit, targets);
+	CGameHelper::GenerateWeaponTargets(this, GetAvoidTarget(), targets);
+
+	return (AutoTarget(targets));
+}
 
+bool CWeapon::AutoTarget(const std::vector<std::pair<float, CUnit*>>& targets)
+{
 	CUnit* goodTargetUnit = nullptr;
 	CUnit* badTargetUnit = nullptr;
 
@@ -710,7 +715,17 @@ void CWeapon::SlowUpdate()
 		Attack(owner->lastAttacker);
 	}
 	// AutoTarget: Find new/better Target
-	AutoTarget();
+	if (autoTargetQueue == nullptr) {
+		AutoTarget();
+		return;
+	}
+
+	// batched; candidates are generated for all queued weapons at once
+	if (!AllowWeaponAutoTarget())
+		return;
+
+	lastTargetRetry = gs->frameNum;
+	autoTargetQueue->push_back(this);
 }
 
 
@@ -75,6 +75,9 @@ public:
 	virtual void UpdateRange(const float val) { range = val; }
 
 	bool AutoTarget();
+	/// picks the first valid target from the filtered and sorted candidates <targets>
+	bool AutoTarget(const std::vector<std::pair<float, CUnit*>>& targets);
+	const CUnit* GetAvoidTarget() const { return ((avoidTarget && currentTarget.type == Target_Unit) ? currentTarget.unit : nullptr); }
 	void AimReady(const int value);
 	void Fire(const bool scriptCall);
 
@@ -114,6 +117,10 @@ private:
 	bool TryTarget(const float3 tgtPos, const SWeaponTarget& trg, bool preFire = false) const;
 
 public:
+	// if non-null, SlowUpdate queues weapons that are due for a new target
+	// here instead of searching immediately (see CUnitHandler::Update)
+	static std::vector<CWeapon*>* autoTargetQueue;
+
 	CUnit* owner;
 	CWeapon* slavedTo;                      // use this weapon to choose target
 
@@ -31,7 +31,11 @@ CWeaponDefHandler::CWeaponDefHandler(LuaParser* defsParser)
 
 	for (int wid = 0; wid < weaponNames.size(); wid++) {
 		const std::string& name = weaponNames[wid];
-		const LuaTable wdTable = rootTable.SubTable(name);
+		LuaTable wdTable = rootTable.SubTable(name);
+
+		// WeaponDefs.Load probes every registered tag
+		wdTable.IndexFields();
+
 		weaponDefs.emplace_back(wdTable, name, wid);
 		weaponID[name] = wid;
 	}
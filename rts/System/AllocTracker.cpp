@@ -0,0 +1,300 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifdef ALLOC_TRACKER
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <vector>
+
+#if defined(__linux__) || defined(__APPLE__)
+	#include <dlfcn.h>
+#endif
+
+#include "System/AllocTracker.h"
+#include "System/TimeProfiler.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+
+#ifdef __GNUC__
+	#define ALLOC_CALLER() __builtin_return_address(0)
+#else
+	#define ALLOC_CALLER() nullptr
+#endif
+
+
+struct ScopeCounters {
+	std::atomic<std::uint64_t> numAllocs;
+	std::atomic<std::uint64_t> numBytes;
+	std::atomic<std::uint64_t> numFrees;
+};
+
+/// sampled call-sites, keyed by scope (upper 16 bits) and return address (lower 48)
+struct CallSite {
+	std::atomic<std::uint64_t> key;
+	std::atomic<std::uint64_t> numAllocs;
+	std::atomic<std::uint64_t> numBytes;
+};
+
+/// must be a power of two
+static constexpr unsigned NUM_CALL_SITES = 1 << 12;
+static constexpr unsigned MAX_CALL_SITE_PROBES = 16;
+static constexpr unsigned CALL_SITE_SAMPLE_RATE = 64;
+
+// statics are zero-initialized before anything can allocate
+static std::array<ScopeCounters, AllocTracker::MAX_SCOPES + 1> frameCounters;
+static std::array<ScopeCounters, AllocTracker::MAX_SCOPES + 1> totalCounters;
+static std::array<CallSite, NUM_CALL_SITES> callSites;
+
+static std::atomic<bool> enabled{false};
+static spring_time enableTime;
+
+// trivially initialized, safe to use from operator new at any time
+static thread_local unsigned curScope = AllocTracker::NO_SCOPE;
+static thread_local unsigned numThreadAllocs = 0;
+
+
+static std::uint64_t GetCallSiteKey(unsigned scopeID, const void* caller)
+{
+	return ((std::uint64_t(scopeID) << 48) | (reinterpret_cast<std::uintptr_t>(caller) & ((std::uint64_t(1) << 48) - 1)));
+}
+
+static void RecordAlloc(size_t size, const void* caller)
+{
+	if (!enabled.load(std::memory_order_relaxed))
+		return;
+
+	const unsigned scopeID = curScope;
+
+	frameCounters[scopeID].numAllocs.fetch_add(1, std::memory_order_relaxed);
+	frameCounters[scopeID].numBytes.fetch_add(size, std::memory_order_relaxed);
+	totalCounters[scopeID].numAllocs.fetch_add(1, std::memory_order_relaxed);
+	totalCounters[scopeID].numBytes.fetch_add(size, std::memory_order_relaxed);
+
+	if (((numThreadAllocs++) % CALL_SITE_SAMPLE_RATE) != 0)
+		return;
+
+	const std::uint64_t key = GetCallSiteKey(scopeID, caller);
+	const std::uint64_t hash = key * 0x9E3779B97F4A7C15ull;
+
+	// open addressing, slots are claimed once and never freed while enabled
+	for (unsigned i = 0; i < MAX_CALL_SITE_PROBES; i++) {
+		CallSite& cs = callSites[((hash >> 40) + i) & (NUM_CALL_SITES - 1)];
+
+		std::uint64_t slotKey = cs.key.load(std::memory_order_relaxed);
+
+		if (slotKey == 0 && cs.key.compare_exchange_strong(slotKey, key, std::memory_order_relaxed))
+			slotKey = key;
+		if (slotKey != key)
+			continue;
+
+		cs.numAllocs.fetch_add(1, std::memory_order_relaxed);
+		cs.numBytes.fetch_add(size, std::memory_order_relaxed);
+		return;
+	}
+
+	// neighbourhood full, the sample is dropped
+}
+
+static void RecordFree(void* ptr)
+{
+	if (ptr == nullptr || !enabled.load(std::memory_order_relaxed))
+		return;
+
+	frameCounters[curScope].numFrees.fetch_add(1, std::memory_order_relaxed);
+	totalCounters[curScope].numFrees.fetch_add(1, std::memory_order_relaxed);
+}
+
+static void* Allocate(size_t size)
+{
+	// same as the default operator new
+	for (size = std::max(size, size_t(1)); ; ) {
+		void* ptr = std::malloc(size);
+
+		if (ptr != nullptr)
+			return ptr;
+
+		std::new_handler handler = std::get_new_handler();
+
+		if (handler == nullptr)
+			throw std::bad_alloc();
+
+		handler();
+	}
+}
+
+
+void* operator new  (std::size_t size) { RecordAlloc(size, ALLOC_CALLER()); return (Allocate(size)); }
+void* operator new[](std::size_t size) { RecordAlloc(size, ALLOC_CALLER()); return (Allocate(size)); }
+void* operator new  (std::size_t size, const std::nothrow_t&) noexcept { RecordAlloc(size, ALLOC_CALLER()); return (std::malloc(std::max(size, size_t(1)))); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { RecordAlloc(size, ALLOC_CALLER()); return (std::malloc(std::max(size, size_t(1)))); }
+
+void operator delete  (void* ptr) noexcept { RecordFree(ptr); std::free(ptr); }
+void operator delete[](void* ptr) noexcept { RecordFree(ptr); std::free(ptr); }
+void operator delete  (void* ptr, const std::nothrow_t&) noexcept { RecordFree(ptr); std::free(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { RecordFree(ptr); std::free(ptr); }
+
+
+
+bool AllocTracker::IsEnabled() { return (enabled.load(std::memory_order_relaxed)); }
+
+void AllocTracker::SetEnabled(bool b)
+{
+	if (b == IsEnabled())
+		return;
+
+	if (b) {
+		for (unsigned i = 0; i <= MAX_SCOPES; i++) {
+			frameCounters[i].numAllocs = 0;
+			frameCounters[i].numBytes = 0;
+			frameCounters[i].numFrees = 0;
+			totalCounters[i].numAllocs = 0;
+			totalCounters[i].numBytes = 0;
+			totalCounters[i].numFrees = 0;
+		}
+
+		for (CallSite& cs: callSites) {
+			cs.key = 0;
+			cs.numAllocs = 0;
+			cs.numBytes = 0;
+		}
+
+		enableTime = spring_gettime();
+	}
+
+	enabled.store(b);
+}
+
+
+unsigned AllocTracker::EnterScope(unsigned scopeID)
+{
+	const unsigned prevScopeID = curScope;
+
+	curScope = std::min(scopeID, NO_SCOPE);
+	return prevScopeID;
+}
+
+void AllocTracker::LeaveScope(unsigned prevScopeID) { curScope = prevScopeID; }
+
+
+AllocTracker::ScopeStats AllocTracker::CollectScope(unsigned scopeID)
+{
+	ScopeCounters& c = frameCounters[std::min(scopeID, NO_SCOPE)];
+	ScopeStats stats;
+
+	stats.numAllocs = c.numAllocs.exchange(0, std::memory_order_relaxed);
+	stats.numBytes = c.numBytes.exchange(0, std::memory_order_relaxed);
+	stats.numFrees = c.numFrees.exchange(0, std::memory_order_relaxed);
+	return stats;
+}
+
+AllocTracker::ScopeStats AllocTracker::GetScopeTotals(unsigned scopeID)
+{
+	const ScopeCounters& c = totalCounters[std::min(scopeID, NO_SCOPE)];
+	ScopeStats stats;
+
+	stats.numAllocs = c.numAllocs.load(std::memory_order_relaxed);
+	stats.numBytes = c.numBytes.load(std::memory_order_relaxed);
+	stats.numFrees = c.numFrees.load(std::memory_order_relaxed);
+	return stats;
+}
+
+
+static const char* GetScopeName(unsigned scopeID)
+{
+	if (scopeID >= profiler.GetNumTimers())
+		return "(no scope)";
+
+	return (profiler.GetTimerName(scopeID).c_str());
+}
+
+void AllocTracker::PrintProfilingInfo(size_t maxEntries)
+{
+	if (!IsEnabled()) {
+		LOG_L(L_WARNING, "[AllocTracker::%s] not enabled", __func__);
+		return;
+	}
+
+	struct ScopeEntry {
+		unsigned scopeID;
+		ScopeStats stats;
+	};
+	struct CallSiteEntry {
+		std::uint64_t key;
+		std::uint64_t numAllocs;
+		std::uint64_t numBytes;
+	};
+
+	std::vector<ScopeEntry> scopes;
+	std::vector<CallSiteEntry> sites;
+
+	scopes.reserve(MAX_SCOPES + 1);
+	sites.reserve(NUM_CALL_SITES);
+
+	for (unsigned i = 0; i <= MAX_SCOPES; i++) {
+		scopes.push_back({i, GetScopeTotals(i)});
+	}
+	for (const CallSite& cs: callSites) {
+		if (cs.key.load(std::memory_order_relaxed) == 0)
+			continue;
+
+		sites.push_back({cs.key.load(std::memory_order_relaxed), cs.numAllocs.load(std::memory_order_relaxed), cs.numBytes.load(std::memory_order_relaxed)});
+	}
+
+	std::sort(scopes.begin(), scopes.end(), [](const ScopeEntry& a, const ScopeEntry& b) { return (a.stats.numAllocs > b.stats.numAllocs); });
+	std::sort(sites.begin(), sites.end(), [](const CallSiteEntry& a, const CallSiteEntry& b) { return (a.numAllocs > b.numAllocs); });
+
+	const float secs = std::max(0.001f, (spring_gettime() - enableTime).toSecsf());
+
+	LOG("[AllocTracker::%s] allocations per scope over %.1fs (excluding nested timed scopes)", __func__, secs);
+
+	for (size_t i = 0, n = std::min(scopes.size(), maxEntries); i < n && scopes[i].stats.numAllocs > 0; i++) {
+		const ScopeStats& s = scopes[i].stats;
+
+		LOG("\t%s: allocs=%llu (%.0f/s) bytes=%.1fKB (%.1fKB/s) frees=%llu",
+			GetScopeName(scopes[i].scopeID),
+			static_cast<unsigned long long>(s.numAllocs), s.numAllocs / secs,
+			s.numBytes / 1024.0f, s.numBytes / (1024.0f * secs),
+			static_cast<unsigned long long>(s.numFrees)
+		);
+	}
+
+	LOG("[AllocTracker::%s] top call-sites (1 in %u allocations sampled)", __func__, CALL_SITE_SAMPLE_RATE);
+
+	for (size_t i = 0, n = std::min(sites.size(), maxEntries); i < n; i++) {
+		const CallSiteEntry& s = sites[i];
+		const std::uintptr_t address = s.key & ((std::uint64_t(1) << 48) - 1);
+
+		char location[512] = {0};
+
+		#if defined(__linux__) || defined(__APPLE__)
+		Dl_info info;
+
+		// symbols are only known for exported functions, otherwise give the
+		// offset into the module (as addr2line expects for PIE executables)
+		if (dladdr(reinterpret_cast<void*>(address), &info) != 0) {
+			const char* moduleName = (info.dli_fname != nullptr)? info.dli_fname: "?";
+
+			if (info.dli_sname != nullptr) {
+				snprintf(location, sizeof(location), "%s+0x%lx (%s)", info.dli_sname, static_cast<unsigned long>(address - reinterpret_cast<std::uintptr_t>(info.dli_saddr)), moduleName);
+			} else {
+				snprintf(location, sizeof(location), "0x%lx (%s)", static_cast<unsigned long>(address - reinterpret_cast<std::uintptr_t>(info.dli_fbase)), moduleName);
+			}
+		}
+		#endif
+
+		if (location[0] == 0)
+			snprintf(location, sizeof(location), "0x%lx", static_cast<unsigned long>(address));
+
+		LOG("\t[%s] %s: ~%llu allocs, ~%.1fKB",
+			GetScopeName(s.key >> 48), location,
+			static_cast<unsigned long long>(s.numAllocs * CALL_SITE_SAMPLE_RATE),
+			(s.numBytes * CALL_SITE_SAMPLE_RATE) / 1024.0f
+		);
+	}
+}
+
+#endif // ALLOC_TRACKER
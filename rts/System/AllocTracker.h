@@ -0,0 +1,64 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief counts heap allocations per profiler timer
+ *
+ * Only compiled in when building with ALLOC_TRACKER=ON, which replaces the
+ * global operator new and delete; otherwise every function here is a no-op.
+ * While enabled, each allocation is charged to the innermost id-registered
+ * ScopedTimer (or ScopedMtTimer) running on the allocating thread, so the
+ * counts of a scope exclude those of the timed scopes nested in it. Every
+ * 64th allocation also records its call-site (the caller of operator new).
+ */
+namespace AllocTracker {
+	/// same as the number of profiler timer ids; allocations outside any scope go to NO_SCOPE
+	static constexpr unsigned MAX_SCOPES = 512;
+	static constexpr unsigned NO_SCOPE = MAX_SCOPES;
+
+	struct ScopeStats {
+		std::uint64_t numAllocs = 0;
+		std::uint64_t numBytes = 0;
+		std::uint64_t numFrees = 0;
+	};
+
+#ifdef ALLOC_TRACKER
+	constexpr bool IsAvailable() { return true; }
+
+	bool IsEnabled();
+	/// enabling clears the totals and call-sites recorded before
+	void SetEnabled(bool b);
+
+	/// returns the scope that was current before, to be passed to LeaveScope
+	unsigned EnterScope(unsigned scopeID);
+	void LeaveScope(unsigned prevScopeID);
+
+	/// returns the counts since the previous call for scopeID and resets them
+	ScopeStats CollectScope(unsigned scopeID);
+	/// counts since SetEnabled(true)
+	ScopeStats GetScopeTotals(unsigned scopeID);
+
+	/// logs the scopes and sampled call-sites that allocated the most
+	void PrintProfilingInfo(size_t maxEntries);
+#else
+	constexpr bool IsAvailable() { return false; }
+
+	inline bool IsEnabled() { return false; }
+	inline void SetEnabled(bool b) {}
+
+	inline unsigned EnterScope(unsigned scopeID) { return NO_SCOPE; }
+	inline void LeaveScope(unsigned prevScopeID) {}
+
+	inline ScopeStats CollectScope(unsigned scopeID) { return {}; }
+	inline ScopeStats GetScopeTotals(unsigned scopeID) { return {}; }
+
+	inline void PrintProfilingInfo(size_t maxEntries) {}
+#endif
+}
+
+#endif // ALLOC_TRACKER_H
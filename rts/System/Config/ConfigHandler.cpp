@@ -213,6 +213,8 @@ void ConfigHandlerImpl::Delete(const std::string& key)
 
 		rwcs->Delete(key);
 	}
+
+	PublishHandles(key);
 }
 
 bool ConfigHandlerImpl::IsSet(const std::string& key) const
@@ -307,6 +309,9 @@ void ConfigHandlerImpl::SetString(const std::string& key, const std::string& val
 		}
 	}
 
+	// handles are refreshed right away, observers only on the next Update
+	PublishHandles(key);
+
 	std::lock_guard<spring::mutex> lck(observerMutex);
 	changedValues[key] = value;
 }
@@ -390,6 +395,7 @@ void ConfigHandler::Instantiate(const std::string configSource, const bool safem
 	}
 
 	configHandler = new ConfigHandlerImpl(locations, safemode);
+	configHandler->PublishHandles("");
 
 	//assert(configHandler->GetString("test") == "x y z");
 }
@@ -405,4 +411,24 @@ bool ConfigHandler::Get(const std::string& key) const
 }
 
 
+std::atomic<unsigned int> ConfigHandler::handleEpoch = {0};
+
+std::vector<ConfigHandleBase*>& ConfigHandler::GetHandles()
+{
+	// filled during static initialization, never modified afterwards
+	static std::vector<ConfigHandleBase*> handles;
+	return handles;
+}
+
+void ConfigHandler::PublishHandles(const std::string& key) const
+{
+	for (ConfigHandleBase* handle: GetHandles()) {
+		if (!key.empty() && handle->GetKey() != key)
+			continue;
+
+		handle->Publish(this);
+	}
+}
+
+
 /******************************************************************************/
@@ -8,10 +8,14 @@
 #include <vector>
 #include <map>
 
+#include <atomic>
 #include <functional>
+#include <type_traits>
 
 #include "ConfigVariable.h"
 
+class ConfigHandleBase;
+
 /**
  * @brief Config handler interface
  */
@@ -151,6 +155,24 @@ public:
 	 */
 	virtual void EnableWriting(bool write) = 0;
 
+	/**
+	 * @brief Incremented whenever a new value is published to a ConfigHandle
+	 *
+	 * Lets code that derives state from several handles check with a single
+	 * load whether any of them changed since it last looked.
+	 */
+	static unsigned int GetHandleEpoch() { return handleEpoch.load(std::memory_order_acquire); }
+
+protected:
+	/// @brief (Re-)parse the cached values of all handles registered for <key>, or of every handle if empty
+	void PublishHandles(const std::string& key) const;
+
+private:
+	friend class ConfigHandleBase;
+
+	static std::vector<ConfigHandleBase*>& GetHandles();
+	static std::atomic<unsigned int> handleEpoch;
+
 protected:
 	typedef std::function<void(const std::string&, const std::string&)> ConfigNotifyCallback;
 
@@ -175,4 +197,73 @@ private:
 
 extern ConfigHandler* configHandler;
 
+
+class ConfigHandleBase
+{
+public:
+	const std::string& GetKey() const { return key; }
+
+protected:
+	ConfigHandleBase(const char* k): key(k) { ConfigHandler::GetHandles().push_back(this); }
+	virtual ~ConfigHandleBase() {}
+
+	virtual void Publish(const ConfigHandler* handler) = 0;
+
+	static void BumpEpoch() { ConfigHandler::handleEpoch.fetch_add(1, std::memory_order_acq_rel); }
+
+private:
+	friend class ConfigHandler;
+
+	std::string key;
+};
+
+/**
+ * @brief Typed handle to a config variable for hot-path reads
+ *
+ * Must be declared with static storage duration, like CONFIG:
+ *
+ *   static ConfigHandle<float> edgeMoveWidth("EdgeMoveWidth");
+ *
+ * The value is parsed once whenever the variable is set (from any thread,
+ * including Lua and /set commands) or the configHandler is (re)instantiated;
+ * Get() is a single atomic load instead of a string-keyed lookup through all
+ * config sources. Before the first configHandler exists it returns T().
+ */
+template<typename T>
+class ConfigHandle : public ConfigHandleBase
+{
+	static_assert(std::is_arithmetic<T>::value, "ConfigHandle only supports bool, integer and floating-point values");
+
+public:
+	ConfigHandle(const char* k): ConfigHandleBase(k), value(T()) {
+		if (configHandler != nullptr)
+			Publish(configHandler);
+	}
+
+	T Get() const { return (value.load(std::memory_order_relaxed)); }
+	operator T () const { return (Get()); }
+
+private:
+	void Publish(const ConfigHandler* handler) override {
+		if (!handler->IsSet(GetKey()))
+			return;
+
+		value.store(Parse(handler), std::memory_order_relaxed);
+		BumpEpoch();
+	}
+
+	T Parse(const ConfigHandler* handler) const {
+		std::istringstream buf(handler->GetString(GetKey()));
+		T temp = T();
+		buf >> temp;
+		return temp;
+	}
+
+private:
+	std::atomic<T> value;
+};
+
+template<>
+inline bool ConfigHandle<bool>::Parse(const ConfigHandler* handler) const { return (handler->GetBool(GetKey())); }
+
 #endif /* CONFIGHANDLER_H */
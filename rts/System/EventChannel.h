@@ -0,0 +1,81 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef EVENT_CHANNEL_H
+#define EVENT_CHANNEL_H
+
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+/**
+ * @brief typed event channel for engine-internal subscribers
+ *
+ * Unlike CEventClient call-ins (one virtual call per client per event, for
+ * every event) subscribers register a plain function pointer plus optional
+ * per-item filter, and receive all items published together as one span.
+ * A filtered subscriber is only called with the items that pass its filter,
+ * and not at all if none do.
+ *
+ * Not thread-safe; subscribers must not (un)subscribe or publish to the same
+ * channel from inside their callback.
+ */
+template<typename T>
+class EventChannel
+{
+public:
+	typedef void (*Callback)(void* self, const T* items, size_t count);
+	typedef bool (*Filter)(const T& item);
+
+	void Subscribe(void* self, Callback callback, Filter filter = nullptr) {
+		assert(!IsSubscribed(self));
+		subscribers.push_back({self, callback, filter});
+	}
+
+	void Unsubscribe(void* self) {
+		subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(), [&](const Subscriber& s) { return (s.self == self); }), subscribers.end());
+	}
+
+	bool IsSubscribed(const void* self) const {
+		return (std::find_if(subscribers.begin(), subscribers.end(), [&](const Subscriber& s) { return (s.self == self); }) != subscribers.end());
+	}
+
+	bool Empty() const { return subscribers.empty(); }
+
+	void Publish(const T& item) const { Publish(&item, 1); }
+	void Publish(const T* items, size_t count) const {
+		if (count == 0)
+			return;
+
+		for (const Subscriber& s: subscribers) {
+			if (s.filter == nullptr) {
+				s.callback(s.self, items, count);
+				continue;
+			}
+
+			filtered.clear();
+
+			for (size_t i = 0; i < count; i++) {
+				if (s.filter(items[i]))
+					filtered.push_back(items[i]);
+			}
+
+			if (filtered.empty())
+				continue;
+
+			s.callback(s.self, filtered.data(), filtered.size());
+		}
+	}
+
+private:
+	struct Subscriber {
+		void* self;
+		Callback callback;
+		Filter filter;
+	};
+
+	std::vector<Subscriber> subscribers;
+	/// scratch-space for filtered spans
+	mutable std::vector<T> filtered;
+};
+
+#endif // EVENT_CHANNEL_H
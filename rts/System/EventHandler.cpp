@@ -38,9 +38,18 @@ void CEventHandler::ResetState()
 	handles.clear();
 	handles.reserve(16);
 
+	queuedUnitLosEvents.clear();
+
 	SetupEvents();
 }
 
+
+void CEventHandler::FlushQueuedEvents()
+{
+	unitLosChannel.Publish(queuedUnitLosEvents.data(), queuedUnitLosEvents.size());
+	queuedUnitLosEvents.clear();
+}
+
 void CEventHandler::SetupEvents()
 {
 	#define SETUP_EVENT(name, props) SetupEvent(#name, &list ## name, props);
@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 
+#include "System/EventChannel.h"
 #include "System/EventClient.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Features/Feature.h"
@@ -15,6 +16,19 @@ class CWeapon;
 struct Command;
 struct BuildInfo;
 
+struct UnitLosEvent {
+	enum {
+		ENTERED_LOS   = 0,
+		LEFT_LOS      = 1,
+		ENTERED_RADAR = 2,
+		LEFT_RADAR    = 3,
+	};
+
+	const CUnit* unit;
+	int allyTeam;
+	int type;
+};
+
 
 class CEventHandler
 {
@@ -40,6 +54,18 @@ class CEventHandler
 		bool IsUnsynced(const std::string& ciName) const;
 		bool IsController(const std::string& ciName) const;
 
+		/// typed channels for engine-internal subscribers, published after the matching call-ins
+		EventChannel<const CUnit*>& GetUnitsMovedChannel() { return unitsMovedChannel; }
+		/// queued, published by FlushQueuedEvents
+		EventChannel<UnitLosEvent>& GetUnitLosChannel() { return unitLosChannel; }
+
+		/**
+		 * Publishes the queued channel events. Called once per SimFrame after
+		 * the LOS update, and before units are deleted so no queued event can
+		 * outlive its unit.
+		 */
+		void FlushQueuedEvents();
+
 
 	public:
 		/**
@@ -113,6 +139,7 @@ class CEventHandler
 		bool UnitUnitCollision(const CUnit* collider, const CUnit* collidee);
 		bool UnitFeatureCollision(const CUnit* collider, const CFeature* collidee);
 		void UnitMoved(const CUnit* unit);
+		void UnitsMoved(const CUnit* const* units, size_t count);
 		void UnitMoveFailed(const CUnit* unit);
 
 		void FeatureCreated(const CFeature* feature);
@@ -330,6 +357,11 @@ class CEventHandler
 
 		EventClientList handles;
 
+		EventChannel<const CUnit*> unitsMovedChannel;
+		EventChannel<UnitLosEvent> unitLosChannel;
+
+		std::vector<UnitLosEvent> queuedUnitLosEvents;
+
 	#define SETUP_EVENT(name, props) EventClientList list ## name;
 	#define SETUP_UNMANAGED_EVENT(name, props)
 		#include "Events.def"
@@ -412,7 +444,27 @@ UNIT_CALLIN_NO_PARAM(UnitEnteredWater)
 UNIT_CALLIN_NO_PARAM(UnitEnteredAir)
 UNIT_CALLIN_NO_PARAM(UnitLeftWater)
 UNIT_CALLIN_NO_PARAM(UnitLeftAir)
-UNIT_CALLIN_NO_PARAM(UnitMoved)
+
+inline void CEventHandler::UnitsMoved(const CUnit* const* units, size_t count)
+{
+	for (size_t n = 0; n < count; n++) {
+		const CUnit* unit = units[n];
+		const auto unitAllyTeam = unit->allyteam;
+
+		for (size_t i = 0; i < listUnitMoved.size(); ) {
+			CEventClient* ec = listUnitMoved[i];
+
+			if (ec->CanReadAllyTeam(unitAllyTeam))
+				ec->UnitMoved(unit);
+
+			i += (i < listUnitMoved.size() && ec == listUnitMoved[i]);
+		}
+	}
+
+	unitsMovedChannel.Publish(units, count);
+}
+
+inline void CEventHandler::UnitMoved(const CUnit* unit) { UnitsMoved(&unit, 1); }
 
 #define UNIT_CALLIN_INT_PARAMS(name)                                              \
 	inline void CEventHandler:: Unit ## name (const CUnit* unit, int p1, int p2)  \
@@ -424,16 +476,19 @@ UNIT_CALLIN_INT_PARAMS(Taken)
 UNIT_CALLIN_INT_PARAMS(Given)
 
 
-#define UNIT_CALLIN_LOS_PARAM(name)                                        \
+#define UNIT_CALLIN_LOS_PARAM(name, type)                                  \
 	inline void CEventHandler:: Unit ## name (const CUnit* unit, int at)   \
 	{                                                                      \
 		ITERATE_ALLYTEAM_EVENTCLIENTLIST(Unit ## name, at, unit, at)       \
+                                                                           \
+		if (!unitLosChannel.Empty())                                       \
+			queuedUnitLosEvents.push_back({unit, at, UnitLosEvent::type}); \
 	}
 
-UNIT_CALLIN_LOS_PARAM(EnteredRadar)
-UNIT_CALLIN_LOS_PARAM(EnteredLos)
-UNIT_CALLIN_LOS_PARAM(LeftRadar)
-UNIT_CALLIN_LOS_PARAM(LeftLos)
+UNIT_CALLIN_LOS_PARAM(EnteredRadar, ENTERED_RADAR)
+UNIT_CALLIN_LOS_PARAM(EnteredLos, ENTERED_LOS)
+UNIT_CALLIN_LOS_PARAM(LeftRadar, LEFT_RADAR)
+UNIT_CALLIN_LOS_PARAM(LeftLos, LEFT_LOS)
 
 
 
@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <array>
 #include <cstdio>
+#include <cstring>
 #include <memory>
 
 #include <sys/types.h>
@@ -51,7 +52,7 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_ARCHIVESCANNER)
  * but mapping them all, every time to make the list is)
  */
 
-constexpr int INTERNAL_VER = 12;
+constexpr int INTERNAL_VER = 14;
 
 
 /*
@@ -351,6 +352,7 @@ bool CArchiveScanner::ArchiveData::GetInfoValueBool(const std::string& key) cons
 
 
 static spring::recursive_mutex scannerMutex;
+static spring::mutex fileCRCMutex;
 static std::atomic<uint32_t> numScannedArchives{0};
 
 
@@ -361,7 +363,7 @@ static std::atomic<uint32_t> numScannedArchives{0};
 CArchiveScanner::CArchiveScanner(): isDirty(false)
 {
 	// the "cache" dir is created in DataDirLocater
-	ReadCacheData(cachefile = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER, "ArchiveCache%i.lua"));
+	ReadCacheData(cachefile = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER, "ArchiveCache%i.bin"));
 	ScanAllDirs();
 }
 
@@ -394,8 +396,13 @@ void CArchiveScanner::Reload()
 	brokenArchives.clear();
 	cachefile.clear();
 
+	{
+		std::lock_guard<spring::mutex> crcLock(fileCRCMutex);
+		fileCRCs.clear();
+	}
+
 	// ctor
-	ReadCacheData(cachefile = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER, "ArchiveCache%i.lua"));
+	ReadCacheData(cachefile = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER, "ArchiveCache%i.bin"));
 	ScanAllDirs();
 }
 
@@ -455,12 +462,38 @@ void CArchiveScanner::ScanDirs(const std::vector<std::string>& scanDirs)
 		}
 	}*/
 
-	// Create archiveInfos etc. if not in cache already
+	std::vector<ScannedArchive> scannedArchives;
+
+	// cache lookups modify archiveInfos and brokenArchives, do them up front
 	for (const std::string& archive: foundArchives) {
-		ScanArchive(archive, false);
+		ScannedArchive sa;
+
+		if (CheckCachedData(archive, &sa.modified, &sa.size, false))
+			continue;
+
+		sa.fullName = archive;
+		scannedArchives.push_back(std::move(sa));
+	}
+
+	// opening archives and executing their {map,mod}info.lua is what takes
+	// time, and each of them is independent of the others until merged
+	for_mt_dynamic(0, scannedArchives.size(), [&](const int i) {
+		ScanArchiveFile(scannedArchives[i]);
 	#if !defined(DEDICATED) && !defined(UNITSYNC)
 		Watchdog::ClearTimer(WDT_MAIN);
 	#endif
+	});
+
+	// merge in the order archives were found, which decides what a duplicate is
+	for (ScannedArchive& sa: scannedArchives) {
+		unsigned modified = 0;
+		std::uint64_t size = 0;
+
+		// an earlier archive with the same name might have been added meanwhile
+		if (CheckCachedData(sa.fullName, &modified, &size, false))
+			continue;
+
+		AddScannedArchive(sa);
 	}
 
 	// Now we'll have to parse the replaces-stuff found in the mods
@@ -564,29 +597,42 @@ std::string CArchiveScanner::SearchMapFile(const IArchive* ar, std::string& erro
 
 void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 {
-	unsigned modifiedTime = 0;
-	if (CheckCachedData(fullName, &modifiedTime, doChecksum))
+	ScannedArchive sa;
+
+	if (CheckCachedData(fullName, &sa.modified, &sa.size, doChecksum))
 		return;
 
-	isDirty = true;
+	sa.fullName = fullName;
 
+	ScanArchiveFile(sa);
+
+	if (doChecksum && !sa.isBroken)
+		sa.archiveInfo.checksum = GetCRC(fullName);
+
+	AddScannedArchive(sa);
+}
+
+void CArchiveScanner::ScanArchiveFile(ScannedArchive& sa)
+{
+	const std::string& fullName = sa.fullName;
 	const std::string& fn    = FileSystem::GetFilename(fullName);
 	const std::string& fpath = FileSystem::GetDirectory(fullName);
-	const std::string& lcfn  = StringToLower(fn);
 
 	std::unique_ptr<IArchive> ar(archiveLoader.OpenArchive(fullName));
 	if (ar == nullptr || !ar->IsOpen()) {
 		LOG_L(L_WARNING, "[AS::%s] unable to open archive \"%s\"", __func__, fullName.c_str());
 
 		// record it as broken, so we don't need to look inside everytime
-		BrokenArchive& ba = brokenArchives[lcfn];
+		BrokenArchive& ba = sa.brokenArchive;
 		ba.path = fpath;
-		ba.modified = modifiedTime;
+		ba.modified = sa.modified;
+		ba.size = sa.size;
 		ba.updated = true;
 		ba.problem = "Unable to open archive";
 
 		// does not count as a scan
-		// numScannedArchives += 1;
+		sa.isBroken = true;
+		sa.isCounted = false;
 		return;
 	}
 
@@ -598,7 +644,7 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 	const bool hasMapinfo = ar->FileExists("mapinfo.lua");
 
 
-	ArchiveInfo ai;
+	ArchiveInfo& ai = sa.archiveInfo;
 	ArchiveData& ad = ai.archiveData;
 
 	// execute the respective .lua, otherwise assume this archive is a map
@@ -620,14 +666,16 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 		LOG_L(L_WARNING, "[AS::%s] failed to scan \"%s\" (%s)", __func__, fullName.c_str(), error.c_str());
 
 		// record it as broken, so we don't need to look inside everytime
-		BrokenArchive& ba = brokenArchives[lcfn];
+		BrokenArchive& ba = sa.brokenArchive;
 		ba.path = fpath;
-		ba.modified = modifiedTime;
+		ba.modified = sa.modified;
+		ba.size = sa.size;
 		ba.updated = true;
 		ba.problem = error;
 
 		// does count as a scan
-		numScannedArchives += 1;
+		sa.isBroken = true;
+		sa.isCounted = true;
 		return;
 	}
 
@@ -659,22 +707,48 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 	}
 
 	ai.path = fpath;
-	ai.modified = modifiedTime;
+	ai.modified = sa.modified;
+	ai.size = sa.size;
 	ai.origName = fn;
 	ai.updated = true;
-	ai.checksum = (doChecksum) ? GetCRC(fullName) : 0;
-	archiveInfos[lcfn] = ai;
+	ai.checksum = 0;
 
-	numScannedArchives += 1;
+	sa.isBroken = false;
+	sa.isCounted = true;
 }
 
+void CArchiveScanner::AddScannedArchive(ScannedArchive& sa)
+{
+	const std::string& lcfn = StringToLower(FileSystem::GetFilename(sa.fullName));
+
+	isDirty = true;
 
-bool CArchiveScanner::CheckCachedData(const std::string& fullName, unsigned* modified, bool doChecksum)
+	if (sa.isBroken) {
+		brokenArchives[lcfn] = std::move(sa.brokenArchive);
+	} else {
+		archiveInfos[lcfn] = std::move(sa.archiveInfo);
+	}
+
+	if (sa.isCounted)
+		numScannedArchives += 1;
+}
+
+
+static std::uint64_t GetRegularFileSize(const std::string& fullName)
+{
+	// directories (e.g. .sdd archives) have no size of their own
+	const size_t size = FileSystemAbstraction::GetFileSize(fullName);
+	return ((size == size_t(-1))? 0: size);
+}
+
+bool CArchiveScanner::CheckCachedData(const std::string& fullName, unsigned* modified, std::uint64_t* size, bool doChecksum)
 {
 	// If stat fails, assume the archive is not broken nor cached
 	if ((*modified = FileSystemAbstraction::GetFileModificationTime(fullName)) == 0)
 		return false;
 
+	*size = GetRegularFileSize(fullName);
+
 	const std::string& fn    = FileSystem::GetFilename(fullName);
 	const std::string& fpath = FileSystem::GetDirectory(fullName);
 	const std::string& lcfn  = StringToLower(fn);
@@ -686,7 +760,7 @@ bool CArchiveScanner::CheckCachedData(const std::string& fullName, unsigned* mod
 	if (bai != brokenArchives.end()) {
 		BrokenArchive& ba = bai->second;
 
-		if (*modified == ba.modified && fpath == ba.path) {
+		if (*modified == ba.modified && *size == ba.size && fpath == ba.path) {
 			return (ba.updated = true);
 		}
 	}
@@ -702,7 +776,7 @@ bool CArchiveScanner::CheckCachedData(const std::string& fullName, unsigned* mod
 		if (!ai.replaced.empty())
 			return true;
 
-		if (*modified == ai.modified && fpath == ai.path) {
+		if (*modified == ai.modified && *size == ai.size && fpath == ai.path) {
 			// cache found update checksum if wanted
 			ai.updated = true;
 
@@ -820,6 +894,11 @@ unsigned int CArchiveScanner::GetCRC(const std::string& arcName)
 	// sort by filename
 	std::stable_sort(files.begin(), files.end());
 
+	const bool isDirArchive = FileSystem::DirExists(arcName);
+
+	const std::string& lcArchiveName = StringToLower(FileSystem::GetFilename(arcName));
+	const std::string& archiveDir = FileSystem::EnsurePathSepAtEnd(arcName);
+
 	for (std::string& f: files) {
 		crcs.push_back(CRCPair{&f, 0, 0});
 	}
@@ -834,7 +913,9 @@ unsigned int CArchiveScanner::GetCRC(const std::string& arcName)
 		assert(crcp.filename == &files[i]);
 		const unsigned int nameCRC = CRC::GetCRC(crcp.filename->data(), crcp.filename->size());
 		const unsigned fid = ar->FindFile(*crcp.filename);
-		const unsigned int dataCRC = ar->GetCrc32(fid);
+		const unsigned int dataCRC = isDirArchive?
+			GetFileCRC(ar.get(), fid, lcArchiveName, archiveDir + ar->FileInfo(fid).first):
+			ar->GetCrc32(fid);
 		crcp.nameCRC = nameCRC;
 		crcp.dataCRC = dataCRC;
 	#if !defined(DEDICATED) && !defined(UNITSYNC)
@@ -851,6 +932,9 @@ unsigned int CArchiveScanner::GetCRC(const std::string& arcName)
 	#endif
 	}
 
+	// new file CRCs and the archive checksum itself need to be written out
+	isDirty |= isDirArchive;
+
 	// A value of 0 is used to indicate no crc.. so never return that
 	// Shouldn't happen all that often
 	const unsigned int digest = crc.GetDigest();
@@ -858,12 +942,118 @@ unsigned int CArchiveScanner::GetCRC(const std::string& arcName)
 }
 
 
+unsigned int CArchiveScanner::GetFileCRC(IArchive* ar, unsigned int fid, const std::string& lcArchiveName, const std::string& filePath)
+{
+	const unsigned int modified = FileSystemAbstraction::GetFileModificationTime(filePath);
+	const std::uint64_t size = GetRegularFileSize(filePath);
+
+	if (modified != 0) {
+		std::lock_guard<spring::mutex> lck(fileCRCMutex);
+
+		const auto it = fileCRCs.find(filePath);
+
+		if (it != fileCRCs.end() && it->second.modified == modified && it->second.size == size)
+			return (it->second.crc);
+	}
+
+	// read the file outside the lock, this is what GetCRC runs in parallel
+	const unsigned int crc = ar->GetCrc32(fid);
+
+	if (modified != 0) {
+		std::lock_guard<spring::mutex> lck(fileCRCMutex);
+		fileCRCs[filePath] = {lcArchiveName, modified, size, crc};
+	}
+
+	return crc;
+}
+
+
 void CArchiveScanner::ComputeChecksumForArchive(const std::string& filePath)
 {
 	ScanArchive(filePath, true);
 }
 
 
+/*
+ * ArchiveCache format: every field is written in native byte order (the cache
+ * never leaves the machine it was made on), strings are prefixed with their
+ * length. Everything is read back without executing any Lua.
+ *
+ *   uint32 magic, uint32 version
+ *   uint32 numArchives, per archive:
+ *     string name, string path, uint32 modified, uint32 checksum, uint64 size
+ *     uint32 numInfoItems, per item: string key, uint8 type, value
+ *     uint32 numDepends, string depend...
+ *     uint32 numReplaces, string replace...
+ *   uint32 numBrokenArchives, per archive:
+ *     string name, string path, uint32 modified, uint64 size, string problem
+ *   uint32 numFileCRCs, per file (of a directory archive):
+ *     string path, string archive, uint32 modified, uint64 size, uint32 crc
+ */
+static constexpr std::uint32_t CACHE_MAGIC = 0x43415053; // "SPAC"
+
+namespace {
+	struct CacheWriter {
+		template<typename T> void Write(T v) {
+			const size_t pos = buf.size();
+			buf.resize(pos + sizeof(T));
+			std::memcpy(&buf[pos], &v, sizeof(T));
+		}
+		void WriteString(const std::string& s) {
+			Write<std::uint32_t>(s.size());
+			buf.insert(buf.end(), s.begin(), s.end());
+		}
+		void WriteStrings(const std::vector<std::string>& v) {
+			Write<std::uint32_t>(v.size());
+
+			for (const std::string& s: v) {
+				WriteString(s);
+			}
+		}
+
+		std::vector<std::uint8_t> buf;
+	};
+
+	struct CacheReader {
+		CacheReader(const std::vector<std::uint8_t>& buf): pos(buf.data()), end(buf.data() + buf.size()), valid(true) {}
+
+		bool Check(size_t n) { return (valid = (valid && size_t(end - pos) >= n)); }
+
+		template<typename T> T Read() {
+			T v = T();
+
+			if (!Check(sizeof(T)))
+				return v;
+
+			std::memcpy(&v, pos, sizeof(T));
+			pos += sizeof(T);
+			return v;
+		}
+		std::string ReadString() {
+			const std::uint32_t n = Read<std::uint32_t>();
+
+			if (!Check(n))
+				return "";
+
+			const char* s = reinterpret_cast<const char*>(pos);
+			pos += n;
+			return {s, s + n};
+		}
+		void ReadStrings(std::vector<std::string>& v) {
+			const std::uint32_t n = Read<std::uint32_t>();
+
+			for (std::uint32_t i = 0; i < n && valid; i++) {
+				v.push_back(ReadString());
+			}
+		}
+
+		const std::uint8_t* pos;
+		const std::uint8_t* end;
+		bool valid;
+	};
+}
+
+
 void CArchiveScanner::ReadCacheData(const std::string& filename)
 {
 	std::lock_guard<spring::recursive_mutex> lck(scannerMutex);
@@ -872,75 +1062,93 @@ void CArchiveScanner::ReadCacheData(const std::string& filename)
 		return;
 	}
 
-	LuaParser p(filename, SPRING_VFS_RAW, SPRING_VFS_BASE);
-	if (!p.Execute()) {
-		LOG_L(L_ERROR, "[AS::%s] failed to parse ArchiveCache: %s", __func__, p.GetErrorLog().c_str());
-		return;
+	std::vector<std::uint8_t> buf;
+
+	{
+		FILE* in = fopen(filename.c_str(), "rb");
+
+		if (in == nullptr) {
+			LOG_L(L_ERROR, "[AS::%s] failed to read \"%s\"!", __func__, filename.c_str());
+			return;
+		}
+
+		buf.resize(FileSystem::GetFileSize(filename));
+		buf.resize(fread(buf.data(), 1, buf.size(), in));
+		fclose(in);
 	}
 
-	const LuaTable& archiveCache = p.GetRoot();
-	const LuaTable& archives = archiveCache.SubTable("archives");
-	const LuaTable& brokenArchives = archiveCache.SubTable("brokenArchives");
+	CacheReader reader(buf);
 
 	// Do not load old version caches
-	const int ver = archiveCache.GetInt("internalVer", (INTERNAL_VER + 1));
-	if (ver != INTERNAL_VER)
+	if (reader.Read<std::uint32_t>() != CACHE_MAGIC || reader.Read<std::uint32_t>() != INTERNAL_VER)
 		return;
 
-	for (int i = 1; archives.KeyExists(i); ++i) {
-		const LuaTable& curArchive = archives.SubTable(i);
-		const LuaTable& archived = curArchive.SubTable("archivedata");
-		std::string name = curArchive.GetString("name", "");
+	// fill these first, such that a truncated cache leaves nothing behind
+	decltype(archiveInfos) cachedArchiveInfos;
+	decltype(brokenArchives) cachedBrokenArchives;
+	decltype(fileCRCs) cachedFileCRCs;
+
+	for (std::uint32_t i = 0, n = reader.Read<std::uint32_t>(); i < n && reader.valid; i++) {
+		const std::string& name = reader.ReadString();
 
-		ArchiveInfo& ai = archiveInfos[StringToLower(name)];
+		ArchiveInfo& ai = cachedArchiveInfos[StringToLower(name)];
 		ai.origName = name;
-		ai.path     = curArchive.GetString("path", "");
-
-		// do not use LuaTable.GetInt() for 32-bit integers: the Spring lua
-		// library uses 32-bit floats to represent numbers, which can only
-		// represent 2^24 consecutive integers
-		ai.modified = strtoul(curArchive.GetString("modified", "0").c_str(), 0, 10);
-		ai.checksum = strtoul(curArchive.GetString("checksum", "0").c_str(), 0, 10);
-		ai.updated = false;
-
-		ai.archiveData = CArchiveScanner::ArchiveData(archived, true);
-		if (ai.archiveData.IsMap()) {
-			AddDependency(ai.archiveData.GetDependencies(), GetMapHelperContentName());
-		} else if (ai.archiveData.IsGame()) {
-			AddDependency(ai.archiveData.GetDependencies(), GetSpringBaseContentName());
+		ai.path     = reader.ReadString();
+		ai.modified = reader.Read<std::uint32_t>();
+		ai.checksum = reader.Read<std::uint32_t>();
+		ai.size     = reader.Read<std::uint64_t>();
+		ai.updated  = false;
+
+		ArchiveData& ad = ai.archiveData;
+
+		for (std::uint32_t j = 0, m = reader.Read<std::uint32_t>(); j < m && reader.valid; j++) {
+			const std::string& key = reader.ReadString();
+
+			// keys come from ArchiveData, so are never reserved
+			switch (reader.Read<std::uint8_t>()) {
+				case INFO_VALUE_TYPE_STRING : { ad.SetInfoItemValueString (key, reader.ReadString()            ); } break;
+				case INFO_VALUE_TYPE_INTEGER: { ad.SetInfoItemValueInteger(key, reader.Read<std::int32_t>()    ); } break;
+				case INFO_VALUE_TYPE_FLOAT  : { ad.SetInfoItemValueFloat  (key, reader.Read<float>()           ); } break;
+				case INFO_VALUE_TYPE_BOOL   : { ad.SetInfoItemValueBool   (key, reader.Read<std::uint8_t>() != 0); } break;
+				default                     : { reader.valid = false;                                            } break;
+			}
 		}
-	}
 
-	for (int i = 1; brokenArchives.KeyExists(i); ++i) {
-		const LuaTable& curArchive = brokenArchives.SubTable(i);
-		const std::string& name = StringToLower(curArchive.GetString("name", ""));
+		reader.ReadStrings(ad.GetDependencies());
+		reader.ReadStrings(ad.GetReplaces());
+	}
 
-		BrokenArchive& ba = this->brokenArchives[name];
-		ba.path = curArchive.GetString("path", "");
-		ba.modified = strtoul(curArchive.GetString("modified", "0").c_str(), 0, 10);
-		ba.updated = false;
-		ba.problem = curArchive.GetString("problem", "unknown");
+	for (std::uint32_t i = 0, n = reader.Read<std::uint32_t>(); i < n && reader.valid; i++) {
+		BrokenArchive& ba = cachedBrokenArchives[StringToLower(reader.ReadString())];
+		ba.path     = reader.ReadString();
+		ba.modified = reader.Read<std::uint32_t>();
+		ba.size     = reader.Read<std::uint64_t>();
+		ba.updated  = false;
+		ba.problem  = reader.ReadString();
 	}
 
-	isDirty = false;
-}
+	for (std::uint32_t i = 0, n = reader.Read<std::uint32_t>(); i < n && reader.valid; i++) {
+		FileCRC& fc = cachedFileCRCs[reader.ReadString()];
+		fc.archive  = reader.ReadString();
+		fc.modified = reader.Read<std::uint32_t>();
+		fc.size     = reader.Read<std::uint64_t>();
+		fc.crc      = reader.Read<std::uint32_t>();
+	}
 
-static inline void SafeStr(FILE* out, const char* prefix, const std::string& str)
-{
-	if (str.empty())
+	if (!reader.valid) {
+		LOG_L(L_ERROR, "[AS::%s] ArchiveCache %s is corrupt, rescanning all archives", __func__, filename.c_str());
 		return;
+	}
 
-	if ( (str.find_first_of("\\\"") != std::string::npos) || (str.find_first_of("\n") != std::string::npos )) {
-		fprintf(out, "%s[[%s]],\n", prefix, str.c_str());
-	} else {
-		fprintf(out, "%s\"%s\",\n", prefix, str.c_str());
+	archiveInfos = std::move(cachedArchiveInfos);
+	brokenArchives = std::move(cachedBrokenArchives);
+
+	{
+		std::lock_guard<spring::mutex> crcLock(fileCRCMutex);
+		fileCRCs = std::move(cachedFileCRCs);
 	}
-}
 
-void FilterDep(std::vector<std::string>& deps, const std::string& exclude)
-{
-	auto it = std::remove_if(deps.begin(), deps.end(), [&](const std::string& dep) { return (dep == exclude); });
-	deps.erase(it, deps.end());
+	isDirty = false;
 }
 
 void CArchiveScanner::WriteCacheData(const std::string& filename)
@@ -949,7 +1157,7 @@ void CArchiveScanner::WriteCacheData(const std::string& filename)
 	if (!isDirty)
 		return;
 
-	FILE* out = fopen(filename.c_str(), "wt");
+	FILE* out = fopen(filename.c_str(), "wb");
 	if (out == nullptr) {
 		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
 		return;
@@ -963,71 +1171,78 @@ void CArchiveScanner::WriteCacheData(const std::string& filename)
 		return !p.second.updated;
 	});
 
-	fprintf(out, "local archiveCache = {\n\n");
-	fprintf(out, "\tinternalver = %i,\n\n", INTERNAL_VER);
-	fprintf(out, "\tarchives = {  -- count = %u\n", unsigned(archiveInfos.size()));
+	CacheWriter writer;
+
+	writer.Write<std::uint32_t>(CACHE_MAGIC);
+	writer.Write<std::uint32_t>(INTERNAL_VER);
+	writer.Write<std::uint32_t>(archiveInfos.size());
 
 	for (const auto& arcIt: archiveInfos) {
 		const ArchiveInfo& arcInfo = arcIt.second;
-
-		fprintf(out, "\t\t{\n");
-		SafeStr(out, "\t\t\tname = ",              arcInfo.origName);
-		SafeStr(out, "\t\t\tpath = ",              arcInfo.path);
-		fprintf(out, "\t\t\tmodified = \"%u\",\n", arcInfo.modified);
-		fprintf(out, "\t\t\tchecksum = \"%u\",\n", arcInfo.checksum);
-		SafeStr(out, "\t\t\treplaced = ",          arcInfo.replaced);
-
-		// mod info?
 		const ArchiveData& archData = arcInfo.archiveData;
-		if (!archData.GetName().empty()) {
-			fprintf(out, "\t\t\tarchivedata = {\n");
-
-			for (const auto& ii: archData.GetInfo()) {
-				if (ii.second.valueType == INFO_VALUE_TYPE_STRING) {
-					SafeStr(out, std::string("\t\t\t\t" + ii.first + " = ").c_str(), ii.second.valueTypeString);
-				} else {
-					fprintf(out, "\t\t\t\t%s = %s,\n", ii.first.c_str(), ii.second.GetValueAsString(false).c_str());
-				}
-			}
 
-			std::vector<std::string> deps = archData.GetDependencies();
-			if (archData.IsMap()) {
-				FilterDep(deps, GetMapHelperContentName());
-			} else if (archData.IsGame()) {
-				FilterDep(deps, GetSpringBaseContentName());
-			}
-
-			if (!deps.empty()) {
-				fprintf(out, "\t\t\t\tdepend = {\n");
-				for (unsigned d = 0; d < deps.size(); d++) {
-					SafeStr(out, "\t\t\t\t\t", deps[d]);
-				}
-				fprintf(out, "\t\t\t\t},\n");
+		// replaced is not stored, ScanDirs recreates it every time
+		writer.WriteString(arcInfo.origName);
+		writer.WriteString(arcInfo.path);
+		writer.Write<std::uint32_t>(arcInfo.modified);
+		writer.Write<std::uint32_t>(arcInfo.checksum);
+		writer.Write<std::uint64_t>(arcInfo.size);
+		writer.Write<std::uint32_t>(archData.GetInfo().size());
+
+		for (const auto& ii: archData.GetInfo()) {
+			const InfoItem& item = ii.second;
+
+			writer.WriteString(item.key);
+			writer.Write<std::uint8_t>(item.valueType);
+
+			switch (item.valueType) {
+				case INFO_VALUE_TYPE_STRING : { writer.WriteString(item.valueTypeString);       } break;
+				case INFO_VALUE_TYPE_INTEGER: { writer.Write<std::int32_t>(item.value.typeInteger); } break;
+				case INFO_VALUE_TYPE_FLOAT  : { writer.Write<float>(item.value.typeFloat);          } break;
+				case INFO_VALUE_TYPE_BOOL   : { writer.Write<std::uint8_t>(item.value.typeBool);     } break;
+				default                     : { assert(false);                                  } break;
 			}
-			fprintf(out, "\t\t\t},\n");
 		}
 
-		fprintf(out, "\t\t},\n");
+		writer.WriteStrings(archData.GetDependencies());
+		writer.WriteStrings(archData.GetReplaces());
 	}
 
-	fprintf(out, "\t},\n\n"); // close 'archives'
-	fprintf(out, "\tbrokenArchives = {  -- count = %u\n", unsigned(brokenArchives.size()));
+	writer.Write<std::uint32_t>(brokenArchives.size());
 
 	for (const auto& bai: brokenArchives) {
 		const BrokenArchive& ba = bai.second;
 
-		fprintf(out, "\t\t{\n");
-		SafeStr(out, "\t\t\tname = ", bai.first);
-		SafeStr(out, "\t\t\tpath = ", ba.path);
-		fprintf(out, "\t\t\tmodified = \"%u\",\n", ba.modified);
-		SafeStr(out, "\t\t\tproblem = ", ba.problem);
-		fprintf(out, "\t\t},\n");
+		writer.WriteString(bai.first);
+		writer.WriteString(ba.path);
+		writer.Write<std::uint32_t>(ba.modified);
+		writer.Write<std::uint64_t>(ba.size);
+		writer.WriteString(ba.problem);
 	}
 
-	fprintf(out, "\t},\n"); // close 'brokenArchives'
-	fprintf(out, "}\n\n"); // close 'archiveCache'
-	fprintf(out, "return archiveCache\n");
+	{
+		std::lock_guard<spring::mutex> crcLock(fileCRCMutex);
 
+		// files of archives that are gone will not be asked for again
+		spring::map_erase_if(fileCRCs, [&](const decltype(fileCRCs)::value_type& p) {
+			return (archiveInfos.find(p.second.archive) == archiveInfos.end());
+		});
+
+		writer.Write<std::uint32_t>(fileCRCs.size());
+
+		for (const auto& fci: fileCRCs) {
+			const FileCRC& fc = fci.second;
+
+			writer.WriteString(fci.first);
+			writer.WriteString(fc.archive);
+			writer.Write<std::uint32_t>(fc.modified);
+			writer.Write<std::uint64_t>(fc.size);
+			writer.Write<std::uint32_t>(fc.crc);
+		}
+	}
+
+	if (fwrite(writer.buf.data(), 1, writer.buf.size(), out) != writer.buf.size())
+		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
 	if (fclose(out) == EOF)
 		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
 
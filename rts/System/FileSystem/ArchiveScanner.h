@@ -3,6 +3,7 @@
 #ifndef _ARCHIVE_SCANNER_H
 #define _ARCHIVE_SCANNER_H
 
+#include <cstdint>
 #include <string>
 #include <deque>
 #include <map>
@@ -151,6 +152,7 @@ private:
 		ArchiveInfo()
 			: modified(0)
 			, checksum(0)
+			, size(0)
 			, updated(false)
 			{}
 		std::string path;
@@ -159,23 +161,55 @@ private:
 		ArchiveData archiveData;
 		unsigned int modified;
 		unsigned int checksum;
+		std::uint64_t size;       ///< 0 for directory archives
 		bool updated;
 	};
 	struct BrokenArchive {
 		BrokenArchive()
 			: modified(0)
+			, size(0)
 			, updated(false)
 			{}
 		std::string path;
 		unsigned int modified;
+		std::uint64_t size;
 		bool updated;
 		std::string problem;
 	};
 
+	/// data CRC of a file inside a directory archive
+	struct FileCRC {
+		std::string archive;      ///< lowercase name of the archive it belongs to
+		unsigned int modified;
+		std::uint64_t size;
+		unsigned int crc;
+	};
+
+	/// what scanning an archive that was not in the cache found
+	struct ScannedArchive {
+		std::string fullName;
+		unsigned int modified = 0;
+		std::uint64_t size = 0;
+
+		ArchiveInfo archiveInfo;
+		BrokenArchive brokenArchive;
+
+		bool isBroken = false;
+		bool isCounted = false; ///< whether it counts towards numScannedArchives
+	};
+
 private:
 	void ScanDirs(const std::vector<std::string>& dirs);
 	void ScanDir(const std::string& curPath, std::deque<std::string>& foundArchives);
 
+	/**
+	 * Opens and inspects sa.fullName, touching no member state,
+	 * so it can be called for several archives concurrently.
+	 */
+	void ScanArchiveFile(ScannedArchive& sa);
+	/// adds what ScanArchiveFile found to archiveInfos or brokenArchives
+	void AddScannedArchive(ScannedArchive& sa);
+
 	/// scan mapinfo / modinfo lua files
 	bool ScanArchiveLua(IArchive* ar, const std::string& fileName, ArchiveInfo& ai, std::string& err);
 
@@ -196,9 +230,15 @@ private:
 	 * Returns 0 if file could not be opened.
 	 */
 	unsigned int GetCRC(const std::string& filename);
+	/**
+	 * Data CRC of one file of a directory archive; these have to be read
+	 * in full to hash them, so the result is kept for as long as the file's
+	 * modification time and size stay the same (also across runs).
+	 */
+	unsigned int GetFileCRC(IArchive* ar, unsigned int fid, const std::string& lcArchiveName, const std::string& filePath);
 	void ComputeChecksumForArchive(const std::string& filePath);
 
-	bool CheckCachedData(const std::string& fullName, unsigned* modified, bool doChecksum);
+	bool CheckCachedData(const std::string& fullName, unsigned* modified, std::uint64_t* size, bool doChecksum);
 
 	/**
 	 * Returns a value > 0 if the file is rated as a meta-file.
@@ -224,6 +264,8 @@ private:
 private:
 	std::map<std::string, ArchiveInfo> archiveInfos;
 	std::map<std::string, BrokenArchive> brokenArchives;
+	/// keyed by the file's full path
+	std::map<std::string, FileCRC> fileCRCs;
 
 	bool isDirty;
 	std::string cachefile;
@@ -14,17 +14,88 @@ bool CBufferedArchive::GetFile(unsigned int fid, std::vector<std::uint8_t>& buff
 	std::lock_guard<spring::mutex> lck(archiveLock);
 	assert(IsFileId(fid));
 
-	if (!caching)
-		return GetFileImpl(fid, buffer);
+	if (!caching) {
+		if (fid >= cache.size() || !cache[fid].populated)
+			return GetFileImpl(fid, buffer);
 
+		// prefetched, hand it out once
+		buffer = *cache[fid].data;
+		cache[fid] = FileBuffer();
+		return true;
+	}
+
+	const std::vector<std::uint8_t>* data = GetCachedFile(fid);
+
+	if (data == nullptr)
+		return false;
+
+	buffer = *data;
+	return true;
+}
+
+bool CBufferedArchive::GetFileView(unsigned int fid, FileView& view)
+{
+	std::lock_guard<spring::mutex> lck(archiveLock);
+	assert(IsFileId(fid));
+
+	if (!caching) {
+		if (fid < cache.size() && cache[fid].populated) {
+			// prefetched, the view becomes its only owner
+			view = FileView(cache[fid].data);
+			cache[fid] = FileBuffer();
+			return true;
+		}
+
+		std::vector<std::uint8_t> buffer;
+
+		if (!GetFileImpl(fid, buffer))
+			return false;
+
+		view = FileView(std::move(buffer));
+		return true;
+	}
+
+	if (GetCachedFile(fid) == nullptr)
+		return false;
+
+	view = FileView(cache[fid].data);
+	return true;
+}
+
+
+const std::vector<std::uint8_t>* CBufferedArchive::GetCachedFile(unsigned int fid)
+{
 	if (fid >= cache.size())
 		cache.resize(std::max(size_t(fid + 1), cache.size() * 2));
 
-	if (!cache[fid].populated) {
-		cache[fid].exists = GetFileImpl(fid, cache[fid].data);
-		cache[fid].populated = true;
+	FileBuffer& fb = cache[fid];
+
+	if (!fb.populated) {
+		std::vector<std::uint8_t> buffer;
+
+		fb.exists = GetFileImpl(fid, buffer);
+		fb.populated = true;
+		fb.data = std::make_shared<const std::vector<std::uint8_t> >(std::move(buffer));
 	}
 
-	buffer = cache[fid].data;
-	return cache[fid].exists;
+	if (!fb.exists)
+		return nullptr;
+
+	return fb.data.get();
+}
+
+void CBufferedArchive::InsertPrefetchedFile(unsigned int fid, std::vector<std::uint8_t>&& buffer)
+{
+	if (fid >= cache.size())
+		cache.resize(std::max(size_t(fid + 1), cache.size() * 2));
+
+	FileBuffer& fb = cache[fid];
+
+	// already cached, or prefetched before
+	if (fb.populated)
+		return;
+
+	fb.exists = true;
+	fb.populated = true;
+	fb.data = std::make_shared<const std::vector<std::uint8_t> >(std::move(buffer));
 }
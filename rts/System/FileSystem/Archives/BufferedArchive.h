@@ -19,10 +19,21 @@ public:
 	virtual ~CBufferedArchive() {}
 
 	virtual bool GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer);
+	/// views into the cache directly (if caching), without copying
+	virtual bool GetFileView(unsigned int fid, FileView& view);
 
 protected:
 	virtual bool GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer) = 0;
 
+	/// returns the cached buffer of file fid, reading it first if needed
+	const std::vector<std::uint8_t>* GetCachedFile(unsigned int fid);
+	/**
+	 * Stores the contents of a file read by PrefetchFiles; if this archive
+	 * does not cache, they are released again once the file has been read.
+	 * Must be called with archiveLock held.
+	 */
+	void InsertPrefetchedFile(unsigned int fid, std::vector<std::uint8_t>&& buffer);
+
 	spring::mutex archiveLock; // neither 7zip nor zlib are threadsafe
 
 	struct FileBuffer {
@@ -41,7 +52,9 @@ protected:
 
 		bool populated; // files may be empty (0 bytes)
 		bool exists;
-		std::vector<std::uint8_t> data;
+
+		// shared with any FileView handed out, never modified once populated
+		std::shared_ptr<const std::vector<std::uint8_t> > data;
 	};
 
 	std::vector<FileBuffer> cache; // cache[fileId]
@@ -9,9 +9,13 @@
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/MappedFile.h"
 #include "System/StringUtil.h"
 
 
+static constexpr size_t MIN_MAPPED_FILE_SIZE = 64 * 1024;
+
+
 CDirArchiveFactory::CDirArchiveFactory()
 	: IArchiveFactory("sdd")
 {
@@ -77,6 +81,27 @@ bool CDirArchive::GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer)
 	}
 }
 
+bool CDirArchive::GetFileView(unsigned int fid, FileView& view)
+{
+	assert(IsFileId(fid));
+
+	const std::string rawPath = dataDirsAccess.LocateFile(dirName + searchFiles[fid]);
+
+	// small files are cheaper to read than to map (and empty ones can not be)
+	if (FileSystem::GetFileSize(rawPath) < MIN_MAPPED_FILE_SIZE)
+		return (IArchive::GetFileView(fid, view));
+
+	const std::shared_ptr<CMappedFile> mappedFile = std::make_shared<CMappedFile>();
+
+	if (!mappedFile->Open(rawPath))
+		return (IArchive::GetFileView(fid, view));
+
+	view.data = mappedFile->GetData();
+	view.size = mappedFile->GetSize();
+	view.owner = mappedFile;
+	return true;
+}
+
 void CDirArchive::FileInfo(unsigned int fid, std::string& name, int& size) const
 {
 	assert(IsFileId(fid));
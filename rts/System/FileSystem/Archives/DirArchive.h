@@ -36,6 +36,8 @@ public:
 
 	virtual unsigned int NumFiles() const;
 	virtual bool GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer);
+	/// maps the file into memory instead of reading it
+	virtual bool GetFileView(unsigned int fid, FileView& view);
 	virtual void FileInfo(unsigned int fid, std::string& name, int& size) const;
 
 private:
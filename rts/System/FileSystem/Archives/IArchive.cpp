@@ -42,3 +42,24 @@ bool IArchive::GetFile(const std::string& name, std::vector<std::uint8_t>& buffe
 	return true;
 }
 
+
+bool IArchive::GetFileView(unsigned int fid, FileView& view)
+{
+	std::vector<std::uint8_t> buffer;
+
+	if (!GetFile(fid, buffer))
+		return false;
+
+	view = FileView(std::move(buffer));
+	return true;
+}
+
+bool IArchive::GetFileView(const std::string& name, FileView& view)
+{
+	const unsigned int fid = FindFile(name);
+
+	if (!IsFileId(fid))
+		return false;
+
+	return (GetFileView(fid, view));
+}
@@ -6,6 +6,7 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
 #include <cinttypes>
 
 /**
@@ -21,6 +22,33 @@ class IArchive
 protected:
 	IArchive(const std::string& archiveName);
 
+public:
+	/**
+	 * Read-only view of the contents of a file, which does not copy them.
+	 * The memory (a mapping of the file, or a buffer shared with the cache
+	 * of its archive) is kept alive for as long as any copy of the view is,
+	 * even if the archive itself gets closed in the meantime.
+	 */
+	struct FileView {
+		FileView() = default;
+		FileView(const std::shared_ptr<const std::vector<std::uint8_t> >& buffer)
+			: data(buffer->data())
+			, size(buffer->size())
+			, owner(buffer)
+		{}
+		/// takes ownership of buffer
+		explicit FileView(std::vector<std::uint8_t>&& buffer)
+			: FileView(std::make_shared<const std::vector<std::uint8_t> >(std::move(buffer)))
+		{}
+
+		bool empty() const { return (size == 0); }
+
+		const std::uint8_t* data = nullptr;
+		size_t size = 0;
+
+		std::shared_ptr<const void> owner;
+	};
+
 public:
 	virtual ~IArchive() {}
 
@@ -76,6 +104,20 @@ public:
 	 */
 	bool GetFile(const std::string& name, std::vector<std::uint8_t>& buffer);
 
+	/**
+	 * Fetches a read-only view of the content of a file by its ID.
+	 * Archives that can hand out memory-mapped or already cached contents
+	 * do so without copying them; by default a copy is read via GetFile.
+	 * @param fid file ID in [0, NumFiles())
+	 * @return true if the file was found, and view refers to its contents
+	 */
+	virtual bool GetFileView(unsigned int fid, FileView& view);
+	/**
+	 * Fetches a read-only view of the content of a file by its name.
+	 * @see GetFileView(unsigned int fid, FileView& view)
+	 */
+	bool GetFileView(const std::string& name, FileView& view);
+
 	std::pair<std::string, int> FileInfo(unsigned int fid) const {
 		std::pair<std::string, int> info;
 		FileInfo(fid, info.first, info.second);
@@ -111,6 +153,14 @@ public:
 	 */
 	virtual bool HasLowReadingCost(unsigned int fid) const { return true; }
 
+	/**
+	 * Tells the archive which files are about to be read, so that solid
+	 * archives can decode each of their blocks just once (instead of again
+	 * for every file read from it out of order). Does nothing by default.
+	 * @param fids file IDs in [0, NumFiles())
+	 */
+	virtual void PrefetchFiles(const std::vector<unsigned int>& fids) {}
+
 	/**
 	 * @return true if archive type can be packed solid (which is VERY slow when reading)
 	 */
@@ -119,6 +169,13 @@ public:
 	 * Fetches the CRC32 hash of a file by its ID.
 	 */
 	virtual unsigned int GetCrc32(unsigned int fid);
+	/**
+	 * Fetches the MD5 hash of the content of a file by its ID, for archives
+	 * that store it (i.e. content-addressed pool archives).
+	 * @param md5sum on success, filled with the 16 bytes of the hash
+	 * @return true if the archive knows the hash without reading the file
+	 */
+	virtual bool GetFileHash(unsigned int fid, std::uint8_t* md5sum) const { return false; }
 
 
 protected:
@@ -3,6 +3,7 @@
 #ifndef _POOL_ARCHIVE_H
 #define _POOL_ARCHIVE_H
 
+#include <cstring>
 #include <zlib.h>
 
 #include "ArchiveFactory.h"
@@ -89,6 +90,11 @@ public:
 		assert(IsFileId(fid));
 		return files[fid].crc32;
 	}
+	bool GetFileHash(unsigned int fid, std::uint8_t* md5sum) const override {
+		assert(IsFileId(fid));
+		std::memcpy(md5sum, files[fid].md5sum, sizeof(files[fid].md5sum));
+		return true;
+	}
 
 protected:
 	bool GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer) override;
@@ -3,6 +3,7 @@
 #include "SevenZipArchive.h"
 
 #include <algorithm>
+#include <map>
 #include <stdexcept>
 #include <string.h> //memcpy
 
@@ -14,6 +15,7 @@ extern "C" {
 
 #include "System/StringUtil.h"
 #include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
 
 static Byte kUtf8Limits[5] = { 0xC0, 0xE0, 0xF0, 0xF8, 0xFC };
 static Bool Utf16_To_Utf8(char *dest, size_t *destLen, const UInt16 *src, size_t srcLen)
@@ -260,6 +262,92 @@ bool CSevenZipArchive::GetFileImpl(unsigned int fid, std::vector<std::uint8_t>&
 	}
 }
 
+void CSevenZipArchive::PrefetchFiles(const std::vector<unsigned int>& fids)
+{
+	if (!isOpen)
+		return;
+
+	// group by solid block; asking for files of different blocks
+	// in turn would decode each block again for every such file
+	std::map<UInt32, std::vector<unsigned int> > blockFiles;
+
+	{
+		std::lock_guard<spring::mutex> lck(archiveLock);
+
+		for (const unsigned int fid: fids) {
+			assert(IsFileId(fid));
+
+			if (fid < cache.size() && cache[fid].populated)
+				continue;
+
+			blockFiles[db.FileIndexToFolderIndexMap[fileData[fid].fp]].push_back(fid);
+		}
+	}
+
+	std::vector< std::vector<unsigned int> > blocks;
+	blocks.reserve(blockFiles.size());
+
+	for (auto& p: blockFiles) {
+		blocks.emplace_back(std::move(p.second));
+	}
+
+	// blocks differ a lot in size
+	for_mt_dynamic(0, blocks.size(), [&](const int i) {
+		PrefetchBlockFiles(blocks[i]);
+	});
+}
+
+void CSevenZipArchive::PrefetchBlockFiles(const std::vector<unsigned int>& fids)
+{
+	// the archive's own stream and block buffer belong to GetFileImpl,
+	// decode into separate ones (db itself is only read by extraction)
+	CFileInStream blockArchiveStream;
+	CLookToRead blockLookStream;
+
+	if (InFile_Open(&blockArchiveStream.file, GetArchiveName().c_str()) != 0)
+		return;
+
+	FileInStream_CreateVTable(&blockArchiveStream);
+	LookToRead_CreateVTable(&blockLookStream, False);
+
+	blockLookStream.realStream = &blockArchiveStream.s;
+	LookToRead_Init(&blockLookStream);
+
+	UInt32 blockBufferIndex = 0xFFFFFFFF;
+	Byte* blockBuffer = nullptr;
+	size_t blockBufferSize = 0;
+
+	std::vector< std::pair<unsigned int, std::vector<std::uint8_t> > > files;
+	files.reserve(fids.size());
+
+	for (const unsigned int fid: fids) {
+		size_t offset = 0;
+		size_t outSizeProcessed = 0;
+
+		// only the first call per block decodes, the others reuse blockBuffer
+		const SRes res = SzArEx_Extract(&db, &blockLookStream.s, fileData[fid].fp, &blockBufferIndex, &blockBuffer, &blockBufferSize, &offset, &outSizeProcessed, &allocImp, &allocTempImp);
+
+		if (res != SZ_OK) {
+			LOG_L(L_WARNING, "[7zArchive::%s] could not prefetch \"%s\" from \"%s\": %s", __func__, fileData[fid].origName.c_str(), GetArchiveName().c_str(), GetErrorStr(res));
+			continue;
+		}
+
+		files.emplace_back(fid, std::vector<std::uint8_t>(blockBuffer + offset, blockBuffer + offset + outSizeProcessed));
+	}
+
+	if (blockBuffer != nullptr)
+		IAlloc_Free(&allocImp, blockBuffer);
+
+	File_Close(&blockArchiveStream.file);
+
+	std::lock_guard<spring::mutex> lck(archiveLock);
+
+	for (auto& file: files) {
+		InsertPrefetchedFile(file.first, std::move(file.second));
+	}
+}
+
+
 void CSevenZipArchive::FileInfo(unsigned int fid, std::string& name, int& size) const
 {
 	assert(IsFileId(fid));
@@ -44,6 +44,12 @@ public:
 	virtual bool HasLowReadingCost(unsigned int fid) const;
 	virtual unsigned GetCrc32(unsigned int fid);
 
+	/// decodes the solid blocks containing fids once each, in parallel
+	virtual void PrefetchFiles(const std::vector<unsigned int>& fids);
+
+private:
+	void PrefetchBlockFiles(const std::vector<unsigned int>& fids);
+
 private:
 	UInt32 blockIndex;
 	Byte* outBuffer;
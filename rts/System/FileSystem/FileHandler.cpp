@@ -91,11 +91,9 @@ bool CFileHandler::TryReadFromVFS(const string& fileName, int section)
 	if (vfsHandler == nullptr)
 		return false;
 
-	if (vfsHandler->LoadFile(StringToLower(fileName), fileBuffer, (CVFSHandler::Section) section)) {
-		// capacity can exceed size if FH was used to open more than one file
-		// assert(fileBuffer.size() == fileBuffer.capacity());
-
-		fileSize = fileBuffer.size();
+	if (vfsHandler->LoadFileView(StringToLower(fileName), fileView, (CVFSHandler::Section) section)) {
+		fileSize = fileView.size;
+		fileSection = section;
 		return true;
 	}
 #endif
@@ -123,11 +121,26 @@ void CFileHandler::Open(const string& fileName, const string& modes)
 
 void CFileHandler::Close()
 {
+	fileSection = -1;
 	filePos = 0;
 	fileSize = -1;
 
 	ifs.close();
-	fileBuffer.clear();
+	fileView = {};
+}
+
+
+
+bool CFileHandler::GetContentHash(std::uint8_t* md5sum) const
+{
+#ifndef TOOLS
+	if (!IsBuffered() || fileSection < 0 || vfsHandler == nullptr)
+		return false;
+
+	return (vfsHandler->GetFileHash(StringToLower(fileName), md5sum, (CVFSHandler::Section) fileSection));
+#else
+	return false;
+#endif
 }
 
 
@@ -171,15 +184,15 @@ int CFileHandler::Read(void* buf, int length)
 		return ifs.gcount();
 	}
 
-	if (fileBuffer.empty())
+	if (fileView.empty())
 		return 0;
 
 	if ((length + filePos) > fileSize)
 		length = fileSize - filePos;
 
 	if (length > 0) {
-		assert(fileBuffer.size() >= (filePos + length));
-		memcpy(buf, &fileBuffer[filePos], length);
+		assert(fileView.size >= (filePos + length));
+		memcpy(buf, fileView.data + filePos, length);
 		filePos += length;
 	}
 
@@ -213,7 +226,7 @@ void CFileHandler::Seek(int length, std::ios_base::seekdir where)
 		ifs.seekg(length, where);
 		return;
 	}
-	if (fileBuffer.empty())
+	if (fileView.empty())
 		return;
 
 	switch (where) {
@@ -229,7 +242,7 @@ bool CFileHandler::Eof() const
 	if (ifs.is_open())
 		return ifs.eof();
 
-	if (!fileBuffer.empty())
+	if (!fileView.empty())
 		return (filePos >= fileSize);
 
 	return true;
@@ -10,6 +10,7 @@
 #include <cinttypes>
 
 #include "VFSModes.h"
+#include "System/FileSystem/Archives/IArchive.h"
 
 /**
  * This is for direct VFS file content access.
@@ -38,7 +39,7 @@ public:
 	// true if any of TryReadFrom{RawFS,PWD,VFS} succeed
 	bool FileExists() const { return (fileSize >= 0); }
 	// true if (and only if) TryReadFromVFS succeeds
-	bool IsBuffered() const { return (!fileBuffer.empty()); }
+	bool IsBuffered() const { return (!fileView.empty()); }
 
 	bool Eof() const;
 	int GetPos();
@@ -47,7 +48,13 @@ public:
 	bool LoadStringData(std::string& data);
 	std::string GetFileExt() const;
 
-	std::vector<std::uint8_t>& GetBuffer() { return fileBuffer; }
+	/// contents of a buffered file, shared with (and not copied from) its archive
+	const IArchive::FileView& GetFileView() const { return fileView; }
+	/**
+	 * MD5 hash of the contents of a buffered file, if its archive stores one.
+	 * @see CVFSHandler::GetFileHash
+	 */
+	bool GetContentHash(std::uint8_t* md5sum) const;
 
 	static bool InReadDir(const std::string& path);
 	static bool InWriteDir(const std::string& path);
@@ -75,7 +82,9 @@ protected:
 
 	std::string fileName;
 	std::ifstream ifs;
-	std::vector<std::uint8_t> fileBuffer;
+	IArchive::FileView fileView;
+	/// CVFSHandler::Section the file was found in, if buffered
+	int fileSection;
 	int filePos;
 	int fileSize;
 };
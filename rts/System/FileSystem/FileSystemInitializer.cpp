@@ -63,7 +63,10 @@ bool FileSystemInitializer::Initialize()
 		dataDirLocater.LocateDataDirs();
 		dataDirLocater.Check();
 
-		archiveScanner = new CArchiveScanner();
+		// a batch-replay supervisor (see CDemoBatch) may have scanned already
+		if (archiveScanner == nullptr)
+			archiveScanner = new CArchiveScanner();
+
 		vfsHandler = new CVFSHandler();
 
 		initSuccess = true;
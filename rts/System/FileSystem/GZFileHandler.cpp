@@ -36,18 +36,25 @@ CGZFileHandler::CGZFileHandler(const std::string& fileName, const std::string& m
 
 bool CGZFileHandler::ReadToBuffer(const std::string& path)
 {
-	assert(fileBuffer.empty());
+	assert(fileView.empty());
 
 	gzFile file = gzopen(path.c_str(), "rb");
 	if (file == Z_NULL)
 		return false;
 
+	std::vector<std::uint8_t> fileBuffer;
 	std::uint8_t unzipBuffer[BUFFER_SIZE];
 
 	while (true) {
 		int unzippedBytes = gzread(file, unzipBuffer, BUFFER_SIZE);
 		if (unzippedBytes < 0) {
-			fileBuffer.clear();
+			int error = Z_OK;
+			gzerror(file, &error);
+
+			// truncated file (eg. a demo of a crashed game), keep what could be read
+			if (error == Z_BUF_ERROR)
+				break;
+
 			fileSize = -1;
 			gzclose(file);
 			return false;
@@ -59,13 +66,17 @@ bool CGZFileHandler::ReadToBuffer(const std::string& path)
 	gzclose(file);
 
 	fileSize = fileBuffer.size();
+	fileView = IArchive::FileView(std::move(fileBuffer));
 	return true;
 }
 
 bool CGZFileHandler::UncompressBuffer()
 {
-	std::vector<std::uint8_t> compressed;
-	std::swap(compressed, fileBuffer);
+	// inflate straight from the view of the compressed file
+	const IArchive::FileView compressed = std::move(fileView);
+	std::vector<std::uint8_t> fileBuffer;
+
+	fileView = {};
 
 
 	z_stream zstream;
@@ -77,8 +88,8 @@ bool CGZFileHandler::UncompressBuffer()
 	//+16 marks it's a gzip header
 	inflateInit2(&zstream, 15 + 16);
 
-	zstream.next_in   = &compressed[0];
-	zstream.avail_in  = compressed.size();
+	zstream.next_in   = const_cast<std::uint8_t*>(compressed.data);
+	zstream.avail_in  = compressed.size;
 
 	std::uint8_t unzipBuffer[BUFFER_SIZE];
 
@@ -87,7 +98,6 @@ bool CGZFileHandler::UncompressBuffer()
 		zstream.next_out = unzipBuffer;
 		const int ret = inflate(&zstream, Z_NO_FLUSH);
 		if (ret != Z_OK) {
-			fileBuffer.clear();
 			fileSize = -1;
 			return false;
 		}
@@ -103,6 +113,7 @@ bool CGZFileHandler::UncompressBuffer()
 
 
 	fileSize = fileBuffer.size();
+	fileView = IArchive::FileView(std::move(fileBuffer));
 	return true;
 }
 
@@ -0,0 +1,99 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "MappedFile.h"
+
+#ifdef _WIN32
+	#include "System/Platform/Win/win32.h"
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+
+bool CMappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+#ifdef _WIN32
+	HANDLE fh = ::CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (fh == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize;
+
+	if (!::GetFileSizeEx(fh, &fileSize) || fileSize.QuadPart <= 0) {
+		::CloseHandle(fh);
+		return false;
+	}
+
+	HANDLE mh = ::CreateFileMappingA(fh, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+
+	if (mh == nullptr) {
+		::CloseHandle(fh);
+		return false;
+	}
+
+	void* ptr = ::MapViewOfFile(mh, FILE_MAP_COPY, 0, 0, 0);
+
+	if (ptr == nullptr) {
+		::CloseHandle(mh);
+		::CloseHandle(fh);
+		return false;
+	}
+
+	fileHandle = fh;
+	mapHandle = mh;
+
+	data = reinterpret_cast<std::uint8_t*>(ptr);
+	size = fileSize.QuadPart;
+#else
+	const int fd = ::open(filePath.c_str(), O_RDONLY);
+
+	if (fd < 0)
+		return false;
+
+	struct stat fileInfo;
+
+	if (::fstat(fd, &fileInfo) != 0 || fileInfo.st_size <= 0) {
+		::close(fd);
+		return false;
+	}
+
+	// a private mapping of a read-only descriptor may still be written to
+	void* ptr = ::mmap(nullptr, fileInfo.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+	// the mapping keeps its own reference to the file
+	::close(fd);
+
+	if (ptr == MAP_FAILED)
+		return false;
+
+	data = reinterpret_cast<std::uint8_t*>(ptr);
+	size = fileInfo.st_size;
+#endif
+
+	return true;
+}
+
+void CMappedFile::Close()
+{
+	if (data == nullptr)
+		return;
+
+#ifdef _WIN32
+	::UnmapViewOfFile(data);
+	::CloseHandle(mapHandle);
+	::CloseHandle(fileHandle);
+
+	fileHandle = nullptr;
+	mapHandle = nullptr;
+#else
+	::munmap(data, size);
+#endif
+
+	data = nullptr;
+	size = 0;
+}
@@ -0,0 +1,41 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef MAPPED_FILE_H
+#define MAPPED_FILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * Private (copy-on-write) memory-mapping of a file; pages are shared
+ * with other processes mapping the same file until they are written.
+ * Writes are never stored back into the file.
+ */
+class CMappedFile {
+public:
+	CMappedFile() = default;
+	CMappedFile(const CMappedFile&) = delete;
+	~CMappedFile() { Close(); }
+
+	CMappedFile& operator = (const CMappedFile&) = delete;
+
+	bool Open(const std::string& filePath);
+	void Close();
+
+	bool IsOpen() const { return (data != nullptr); }
+
+	std::uint8_t* GetData() const { return data; }
+	size_t GetSize() const { return size; }
+
+private:
+	std::uint8_t* data = nullptr;
+	size_t size = 0;
+
+	#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mapHandle = nullptr;
+	#endif
+};
+
+#endif // MAPPED_FILE_H
@@ -27,6 +27,7 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_VFS)
 
 
 CVFSHandler* vfsHandler = nullptr;
+std::atomic<std::uint64_t> CVFSHandler::numBytesLoaded{0};
 
 
 CVFSHandler::CVFSHandler()
@@ -234,10 +235,81 @@ bool CVFSHandler::LoadFile(const std::string& filePath, std::vector<std::uint8_t
 		return false;
 	}
 
+	numBytesLoaded += buffer.size();
 	return true;
 }
 
 
+bool CVFSHandler::LoadFileView(const std::string& filePath, IArchive::FileView& view, Section section)
+{
+	assert(section < Section::Count);
+
+	LOG_L(L_DEBUG, "[VFSH::%s(filePath=\"%s\", )]", __func__, filePath.c_str());
+
+	const std::string& normalizedPath = GetNormalizedPath(filePath);
+	const FileData* fileData = GetFileData(normalizedPath, section);
+
+	if (fileData == nullptr) {
+		LOG_L(L_DEBUG, "[VFHS::%s] file \"%s\" does not exist in VFS", __func__, filePath.c_str());
+		return false;
+	}
+
+	if (!fileData->ar->GetFileView(normalizedPath, view)) {
+		LOG_L(L_DEBUG, "[VFHS::%s] file \"%s\" does not exist in archive", __func__, filePath.c_str());
+		return false;
+	}
+
+	numBytesLoaded += view.size;
+	return true;
+}
+
+
+bool CVFSHandler::GetFileHash(const std::string& filePath, std::uint8_t* md5sum, Section section)
+{
+	assert(section < Section::Count);
+
+	const std::string& normalizedPath = GetNormalizedPath(filePath);
+	const FileData* fileData = GetFileData(normalizedPath, section);
+
+	if (fileData == nullptr)
+		return false;
+
+	const unsigned int fid = fileData->ar->FindFile(normalizedPath);
+
+	if (!fileData->ar->IsFileId(fid))
+		return false;
+
+	return (fileData->ar->GetFileHash(fid, md5sum));
+}
+
+
+void CVFSHandler::PrefetchFiles(const std::vector<std::string>& filePaths, Section section)
+{
+	assert(section < Section::Count);
+
+	std::map<IArchive*, std::vector<unsigned int> > archiveFiles;
+
+	for (const std::string& filePath: filePaths) {
+		const std::string& normalizedPath = GetNormalizedPath(filePath);
+		const FileData* fileData = GetFileData(normalizedPath, section);
+
+		if (fileData == nullptr)
+			continue;
+
+		const unsigned int fid = fileData->ar->FindFile(normalizedPath);
+
+		if (!fileData->ar->IsFileId(fid))
+			continue;
+
+		archiveFiles[fileData->ar].push_back(fid);
+	}
+
+	for (const auto& p: archiveFiles) {
+		p.first->PrefetchFiles(p.second);
+	}
+}
+
+
 bool CVFSHandler::FileExists(const std::string& filePath, Section section)
 {
 	assert(section < Section::Count);
@@ -4,12 +4,13 @@
 #define _VFS_HANDLER_H
 
 #include <array>
+#include <atomic>
 #include <map>
 #include <string>
 #include <vector>
 #include <cinttypes>
 
-class IArchive;
+#include "System/FileSystem/Archives/IArchive.h"
 
 /**
  * Main API for accessing the Virtual File System (VFS).
@@ -51,6 +52,25 @@ public:
 	 * @return true if the file exists in the VFS and was successfully read
 	 */
 	bool LoadFile(const std::string& filePath, std::vector<std::uint8_t>& buffer, Section section);
+	/**
+	 * Like LoadFile, but without copying the contents of the file if its
+	 * archive can provide a view of them.
+	 * @see IArchive::GetFileView
+	 */
+	bool LoadFileView(const std::string& filePath, IArchive::FileView& view, Section section);
+	/**
+	 * Fetches the MD5 hash of the contents of a file, if its archive stores it.
+	 * @see IArchive::GetFileHash
+	 */
+	bool GetFileHash(const std::string& filePath, std::uint8_t* md5sum, Section section);
+	/// total size of all files loaded via LoadFile{,View} so far
+	static std::uint64_t GetNumBytesLoaded() { return numBytesLoaded; }
+	/**
+	 * Announces files that are about to be loaded, which allows solid
+	 * archives to decode each of their blocks once for all of them.
+	 * @see IArchive::PrefetchFiles
+	 */
+	void PrefetchFiles(const std::vector<std::string>& filePaths, Section section);
 
 	/**
 	 * Returns all the files in the given (virtual) directory without the
@@ -97,6 +117,8 @@ protected:
 	std::array<std::map<std::string, FileData>, Section::Count> files;
 	std::map<std::string, IArchive*> archives;
 
+	static std::atomic<std::uint64_t> numBytesLoaded;
+
 private:
 	std::string GetNormalizedPath(const std::string& rawPath);
 	const FileData* GetFileData(const std::string& normalizedFilePath, Section section);
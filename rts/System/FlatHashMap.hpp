@@ -0,0 +1,436 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _SPRING_FLAT_HASH_MAP_H_
+#define _SPRING_FLAT_HASH_MAP_H_
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <iterator>
+#include <new>
+#include <utility>
+#include <vector>
+
+#include "SpringHash.h"
+#include "SpringHashMap.hpp"
+
+namespace spring {
+	/**
+	 * @brief open-addressing hash map with robin-hood probing
+	 *
+	 * Drop-in for the subset of the spring::unordered_map interface used by
+	 * hot-path maps with heavy insert/erase churn. Unlike emilib::HashMap it
+	 * erases by shifting the following entries back instead of writing
+	 * tombstones, so probe lengths stay bounded no matter how many entries
+	 * were erased since the last rehash.
+	 *
+	 * Buckets are chosen by a Fibonacci multiply of the (synced) key hash,
+	 * and probing never wraps around: a table of capacity N has N + maxProbe
+	 * slots and is grown whenever an entry would end up further than maxProbe
+	 * slots from its home bucket. Iteration therefore visits entries in slot
+	 * order, which only depends on the hash values and on the sequence of
+	 * operations applied, and erasing through an iterator during iteration
+	 * neither skips nor repeats entries.
+	 *
+	 * As with spring::unordered_map, synced instances must be reconstructed
+	 * rather than clear()'ed on reload. Any insertion or erasure may move
+	 * other entries, invalidating pointers and references to them.
+	 */
+	template<typename K, typename V, typename H = spring::synced_hash<K>, typename C = emilib::HashMapEqualTo<K>>
+	class flat_hash_map {
+	private:
+		typedef flat_hash_map<K, V, H, C> MyType;
+		typedef std::pair<K, V> PairT;
+
+		typedef std::int16_t dist_t;
+
+		static constexpr dist_t MAX_PROBE_LIMIT = 0x3fff;
+		static constexpr std::uint64_t FIB_MULT = 11400714819323198485ull;
+		// load factor limit, in eighths
+		static constexpr size_t MAX_LOAD = 7;
+
+		template<typename MapT, typename ValueT>
+		class iterator_base {
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef std::ptrdiff_t difference_type;
+			typedef ValueT value_type;
+			typedef ValueT* pointer;
+			typedef ValueT& reference;
+
+			iterator_base() {}
+			iterator_base(MapT* m, size_t s): map(m), slot(s) {}
+
+			template<typename OtherMapT, typename OtherValueT>
+			iterator_base(const iterator_base<OtherMapT, OtherValueT>& it): map(it.map), slot(it.slot) {}
+
+			iterator_base& operator ++ () { slot = map->next_filled_slot(slot + 1); return *this; }
+			iterator_base operator ++ (int) { iterator_base it = *this; ++(*this); return it; }
+
+			reference operator * () const { return map->pairs[slot]; }
+			pointer operator -> () const { return &map->pairs[slot]; }
+
+			bool operator == (const iterator_base& it) const { return (slot == it.slot); }
+			bool operator != (const iterator_base& it) const { return (slot != it.slot); }
+
+		public:
+			MapT* map = nullptr;
+			size_t slot = 0;
+		};
+
+	public:
+		typedef K key_type;
+		typedef V mapped_type;
+		typedef PairT value_type;
+		typedef size_t size_type;
+
+		typedef iterator_base<MyType, PairT> iterator;
+		typedef iterator_base<const MyType, const PairT> const_iterator;
+
+		flat_hash_map() {}
+		flat_hash_map(std::initializer_list<PairT> list) {
+			reserve(list.size());
+
+			for (const PairT& p: list) {
+				insert(p);
+			}
+		}
+		flat_hash_map(const flat_hash_map& m) { *this = m; }
+		flat_hash_map(flat_hash_map&& m) { *this = std::move(m); }
+		~flat_hash_map() { release(); }
+
+		flat_hash_map& operator = (const flat_hash_map& m) {
+			if (this == &m)
+				return *this;
+
+			release();
+
+			if (m.numSlots == 0)
+				return *this;
+
+			allocate(m.capacity, m.maxProbe);
+
+			// same layout, no need to rehash
+			for (size_t i = 0; i < numSlots; i++) {
+				if ((dists[i] = m.dists[i]) < 0)
+					continue;
+
+				new (&pairs[i]) PairT(m.pairs[i]);
+			}
+
+			numFilled = m.numFilled;
+			return *this;
+		}
+		flat_hash_map& operator = (flat_hash_map&& m) {
+			if (this == &m)
+				return *this;
+
+			release();
+
+			std::swap(pairs, m.pairs);
+			std::swap(dists, m.dists);
+			std::swap(capacity, m.capacity);
+			std::swap(numSlots, m.numSlots);
+			std::swap(numFilled, m.numFilled);
+			std::swap(shift, m.shift);
+			std::swap(maxProbe, m.maxProbe);
+			return *this;
+		}
+
+		iterator begin() { return {this, next_filled_slot(0)}; }
+		iterator end() { return {this, numSlots}; }
+		const_iterator begin() const { return {this, next_filled_slot(0)}; }
+		const_iterator end() const { return {this, numSlots}; }
+		const_iterator cbegin() const { return (begin()); }
+		const_iterator cend() const { return (end()); }
+
+		bool empty() const { return (numFilled == 0); }
+		size_t size() const { return numFilled; }
+		size_t bucket_count() const { return capacity; }
+		float load_factor() const { return (numFilled / std::max(1.0f, capacity * 1.0f)); }
+
+		iterator find(const K& key) { return {this, find_slot(key)}; }
+		const_iterator find(const K& key) const { return {this, find_slot(key)}; }
+
+		bool contains(const K& key) const { return (find_slot(key) != numSlots); }
+		size_t count(const K& key) const { return (contains(key)); }
+
+		V* try_get(const K& key) {
+			const size_t slot = find_slot(key);
+			return ((slot != numSlots)? &pairs[slot].second: nullptr);
+		}
+		const V* try_get(const K& key) const {
+			const size_t slot = find_slot(key);
+			return ((slot != numSlots)? &pairs[slot].second: nullptr);
+		}
+
+		std::pair<iterator, bool> insert(const PairT& p) { return (emplace_impl(p.first, p.second)); }
+		std::pair<iterator, bool> insert(PairT&& p) { return (emplace_impl(std::move(p.first), std::move(p.second))); }
+		std::pair<iterator, bool> insert(const K& key, const V& value) { return (emplace_impl(key, value)); }
+		std::pair<iterator, bool> emplace(const K& key, const V& value) { return (emplace_impl(key, value)); }
+		std::pair<iterator, bool> emplace(K&& key, V&& value) { return (emplace_impl(std::move(key), std::move(value))); }
+
+		V& operator [] (const K& key) {
+			const size_t slot = find_slot(key);
+
+			if (slot != numSlots)
+				return pairs[slot].second;
+
+			return (emplace_impl(key, V()).first->second);
+		}
+
+		bool erase(const K& key) {
+			const size_t slot = find_slot(key);
+
+			if (slot == numSlots)
+				return false;
+
+			erase_slot(slot);
+			return true;
+		}
+		/// returns an iterator to the entry following it in iteration order
+		iterator erase(const_iterator it) {
+			assert(it.map == this && it.slot < numSlots && dists[it.slot] >= 0);
+
+			// the following entry was shifted into it.slot (if any)
+			erase_slot(it.slot);
+			return {this, next_filled_slot(it.slot)};
+		}
+
+		/// removes all entries but keeps the allocated slots
+		void clear() {
+			for (size_t i = 0; i < numSlots; i++) {
+				if (dists[i] < 0)
+					continue;
+
+				pairs[i].~PairT();
+				dists[i] = -1;
+			}
+
+			numFilled = 0;
+		}
+
+		void reserve(size_t numElems) {
+			size_t newCapacity = std::max(capacity, size_t(4));
+
+			while ((newCapacity * MAX_LOAD) < (numElems * 8))
+				newCapacity *= 2;
+
+			if (newCapacity == capacity)
+				return;
+
+			rehash(newCapacity, std::max(default_max_probe(newCapacity), maxProbe));
+		}
+
+	private:
+		size_t home_slot(const K& key) const {
+			return (size_t((std::uint64_t(hasher(key)) * FIB_MULT) >> shift));
+		}
+
+		size_t next_filled_slot(size_t slot) const {
+			while (slot < numSlots && dists[slot] < 0)
+				slot++;
+
+			return slot;
+		}
+
+		size_t find_slot(const K& key) const {
+			if (numFilled == 0)
+				return numSlots;
+
+			size_t slot = home_slot(key);
+
+			// entries in a probe chain are ordered by distance, so stop once
+			// ours would have been placed before the current occupant
+			for (dist_t dist = 0; dists[slot] >= dist; slot++, dist++) {
+				if (comparer(pairs[slot].first, key))
+					return slot;
+			}
+
+			return numSlots;
+		}
+
+		template<typename VT>
+		std::pair<iterator, bool> emplace_impl(const K& key, VT&& value) {
+			size_t slot = find_slot(key);
+
+			if (slot != numSlots)
+				return {iterator(this, slot), false};
+
+			if (((numFilled + 1) * 8) > (capacity * MAX_LOAD))
+				reserve(numFilled + 1);
+
+			PairT p(key, std::forward<VT>(value));
+
+			if ((slot = insert_new(p)) != numSlots)
+				return {iterator(this, slot), true};
+
+			// p now holds whichever entry was pushed out of reach; grow and retry
+			do {
+				grow();
+			} while (insert_new(p) == numSlots);
+
+			return {iterator(this, find_slot(key)), true};
+		}
+
+		/**
+		 * Assumes p's key is not present. Returns the slot p was placed in, or
+		 * numSlots if some entry (p itself or one it displaced, which is then
+		 * swapped into p) ended up further than maxProbe from its home slot.
+		 */
+		size_t insert_new(PairT& p) {
+			size_t slot = home_slot(p.first);
+			size_t placed = numSlots;
+
+			for (dist_t dist = 0; dist <= maxProbe; slot++, dist++) {
+				if (dists[slot] < 0) {
+					new (&pairs[slot]) PairT(std::move(p));
+					dists[slot] = dist;
+					numFilled++;
+					return ((placed != numSlots)? placed: slot);
+				}
+
+				// robin-hood: take the slot of an entry that is closer to its home
+				if (dists[slot] < dist) {
+					std::swap(p, pairs[slot]);
+					std::swap(dist, dists[slot]);
+
+					if (placed == numSlots)
+						placed = slot;
+				}
+			}
+
+			// if anything was swapped in, one entry went in and another came out
+			return numSlots;
+		}
+
+		void erase_slot(size_t slot) {
+			pairs[slot].~PairT();
+			dists[slot] = -1;
+			numFilled--;
+
+			// backward-shift deletion; the trailing sentinel stops this
+			for (size_t next = slot + 1; dists[next] > 0; slot++, next++) {
+				new (&pairs[slot]) PairT(std::move(pairs[next]));
+				pairs[next].~PairT();
+
+				dists[slot] = dists[next] - 1;
+				dists[next] = -1;
+			}
+		}
+
+		void allocate(size_t newCapacity, dist_t newMaxProbe) {
+			assert((newCapacity & (newCapacity - 1)) == 0);
+
+			capacity = newCapacity;
+			maxProbe = newMaxProbe;
+			numSlots = capacity + maxProbe;
+			shift = 64;
+
+			for (size_t c = capacity; c > 1; c >>= 1)
+				shift--;
+
+			// one extra slot as end-of-chain sentinel
+			pairs = static_cast<PairT*>(std::malloc((numSlots + 1) * sizeof(PairT)));
+			dists = static_cast<dist_t*>(std::malloc((numSlots + 1) * sizeof(dist_t)));
+
+			if (pairs == nullptr || dists == nullptr)
+				throw std::bad_alloc();
+
+			std::fill(dists, dists + numSlots + 1, dist_t(-1));
+		}
+
+		void release() {
+			clear();
+
+			std::free(pairs);
+			std::free(dists);
+
+			pairs = nullptr;
+			dists = nullptr;
+			capacity = 0;
+			numSlots = 0;
+			shift = 63;
+			maxProbe = 0;
+		}
+
+		static dist_t default_max_probe(size_t cap) {
+			// log2 of the capacity, at least 4
+			dist_t n = 4;
+
+			for (size_t c = cap; c > 16; c >>= 1)
+				n++;
+
+			return n;
+		}
+
+		void grow() {
+			// an overflowing chain at low load means clustered hashes; allow
+			// longer chains rather than doubling the table over and over
+			if ((numFilled * 2) < capacity && maxProbe < MAX_PROBE_LIMIT) {
+				rehash(capacity, dist_t((maxProbe < (MAX_PROBE_LIMIT / 2))? (maxProbe * 2): (MAX_PROBE_LIMIT + 0)));
+				return;
+			}
+
+			rehash(capacity * 2, std::max(default_max_probe(capacity * 2), maxProbe));
+		}
+
+		void rehash(size_t newCapacity, dist_t newMaxProbe) {
+			PairT* oldPairs = pairs;
+			dist_t* oldDists = dists;
+			const size_t oldNumSlots = numSlots;
+
+			allocate(newCapacity, newMaxProbe);
+
+			numFilled = 0;
+
+			// entries that did not fit (pathological clustering)
+			std::vector<PairT> overflow;
+
+			for (size_t i = 0; i < oldNumSlots; i++) {
+				if (oldDists[i] < 0)
+					continue;
+
+				PairT p(std::move(oldPairs[i]));
+				oldPairs[i].~PairT();
+
+				if (insert_new(p) == numSlots)
+					overflow.push_back(std::move(p));
+			}
+
+			std::free(oldPairs);
+			std::free(oldDists);
+
+			while (!overflow.empty()) {
+				grow();
+
+				while (!overflow.empty()) {
+					PairT p(std::move(overflow.back()));
+					overflow.pop_back();
+
+					if (insert_new(p) == numSlots) {
+						overflow.push_back(std::move(p));
+						break;
+					}
+				}
+			}
+		}
+
+	private:
+		PairT* pairs = nullptr;
+		dist_t* dists = nullptr;
+
+		size_t capacity = 0;
+		size_t numSlots = 0;
+		size_t numFilled = 0;
+
+		unsigned int shift = 63;
+		dist_t maxProbe = 0;
+
+		H hasher;
+		C comparer;
+	};
+};
+
+#endif
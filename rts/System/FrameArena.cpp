@@ -0,0 +1,164 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "FrameArena.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <new>
+
+namespace {
+	// large enough to take the temporaries of a typical frame in one chunk
+	static constexpr size_t CHUNK_SIZE = 256 * 1024;
+
+	struct Chunk {
+		std::uint8_t* mem;
+		size_t size;
+	};
+
+	struct ThreadArena {
+		~ThreadArena() {
+			for (const Chunk& c: chunks) {
+				::operator delete(c.mem);
+			}
+		}
+
+		std::vector<Chunk> chunks;
+
+		size_t chunkIdx = 0;
+		// first free byte in chunks[chunkIdx]
+		size_t offset = 0;
+		// sum of the sizes of chunks[0, chunkIdx)
+		size_t prevBytes = 0;
+		size_t peakBytes = 0;
+
+		unsigned int frameNum = 0;
+	};
+
+	static thread_local ThreadArena threadArena;
+
+	static std::atomic<unsigned int> curFrameNum = {0};
+	static std::atomic<size_t> curPeakBytes = {0};
+
+	static unsigned int curFrameType = FrameArena::FRAME_TYPE_SIM;
+	static size_t lastPeakBytes[FrameArena::FRAME_TYPE_CNT] = {0, 0};
+
+
+	static Chunk NewChunk(size_t size) {
+		return {static_cast<std::uint8_t*>(::operator new(size)), size};
+	}
+
+	static void ResetArena(ThreadArena& a, unsigned int frameNum) {
+		a.frameNum = frameNum;
+		a.chunkIdx = 0;
+		a.offset = 0;
+		a.prevBytes = 0;
+		a.peakBytes = 0;
+
+		if (a.chunks.size() <= 1)
+			return;
+
+		// the previous frame overflowed the first chunk; replace them all by
+		// one big enough for everything so the next frames do not fragment
+		size_t totalSize = 0;
+
+		for (const Chunk& c: a.chunks) {
+			totalSize += c.size;
+			::operator delete(c.mem);
+		}
+
+		a.chunks.clear();
+		a.chunks.push_back(NewChunk(totalSize));
+	}
+
+	static void UpdatePeak(ThreadArena& a) {
+		const size_t usedBytes = a.prevBytes + a.offset;
+
+		if (usedBytes <= a.peakBytes)
+			return;
+
+		a.peakBytes = usedBytes;
+
+		for (size_t peakBytes = curPeakBytes.load(std::memory_order_relaxed); peakBytes < usedBytes; ) {
+			if (curPeakBytes.compare_exchange_weak(peakBytes, usedBytes, std::memory_order_relaxed))
+				break;
+		}
+	}
+}
+
+
+void FrameArena::BeginFrame(unsigned int frameType)
+{
+	lastPeakBytes[curFrameType] = curPeakBytes.exchange(0, std::memory_order_relaxed);
+	curFrameType = frameType;
+
+	// every thread resets its own arena on its next allocation
+	curFrameNum.fetch_add(1, std::memory_order_release);
+}
+
+
+void* FrameArena::Alloc(size_t size, size_t align)
+{
+	ThreadArena& a = threadArena;
+
+	const unsigned int frameNum = curFrameNum.load(std::memory_order_acquire);
+
+	if (a.frameNum != frameNum)
+		ResetArena(a, frameNum);
+
+	for (;;) {
+		if (a.chunkIdx == a.chunks.size())
+			a.chunks.push_back(NewChunk(std::max(CHUNK_SIZE, size + align)));
+
+		const Chunk& c = a.chunks[a.chunkIdx];
+
+		const std::uintptr_t mem = reinterpret_cast<std::uintptr_t>(c.mem);
+		const std::uintptr_t beg = (mem + a.offset + align - 1) & ~std::uintptr_t(align - 1);
+		const std::uintptr_t end = beg + size;
+
+		if (end <= (mem + c.size)) {
+			a.offset = end - mem;
+
+			UpdatePeak(a);
+			return (reinterpret_cast<void*>(beg));
+		}
+
+		// does not fit, continue in the next chunk (if any) or a new one
+		a.prevBytes += c.size;
+		a.chunkIdx += 1;
+		a.offset = 0;
+	}
+}
+
+void FrameArena::Free(void* ptr, size_t size)
+{
+	ThreadArena& a = threadArena;
+
+	if (a.frameNum != curFrameNum.load(std::memory_order_relaxed))
+		return;
+	if (a.chunkIdx >= a.chunks.size())
+		return;
+
+	const Chunk& c = a.chunks[a.chunkIdx];
+
+	// only the most recent allocation can be given back
+	if ((static_cast<std::uint8_t*>(ptr) + size) != (c.mem + a.offset))
+		return;
+
+	a.offset = static_cast<std::uint8_t*>(ptr) - c.mem;
+}
+
+
+FrameArena::Stats FrameArena::GetStats()
+{
+	Stats stats;
+	stats.peakBytes[FRAME_TYPE_SIM] = lastPeakBytes[FRAME_TYPE_SIM];
+	stats.peakBytes[FRAME_TYPE_DRAW] = lastPeakBytes[FRAME_TYPE_DRAW];
+	stats.chunkBytes = 0;
+
+	for (const Chunk& c: threadArena.chunks) {
+		stats.chunkBytes += c.size;
+	}
+
+	return stats;
+}
@@ -0,0 +1,63 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief per-thread bump allocator for temporaries that die within a frame
+ *
+ * Every thread allocates from its own set of chunks by bumping a pointer;
+ * freeing is a no-op except for the most recent allocation, which is rolled
+ * back (so scoped temporaries are recycled LIFO-style). All memory handed out
+ * is reclaimed at once when the main thread starts a new sim- or draw-frame;
+ * other threads catch up on their next allocation. Chunks are kept and merged
+ * into one on reset, so after a few frames no more heap allocations happen.
+ *
+ * Memory must not be held across a SimFrame or Draw boundary, which also
+ * rules out tasks that run asynchronously to the frame loop.
+ */
+namespace FrameArena {
+	enum {
+		FRAME_TYPE_SIM  = 0,
+		FRAME_TYPE_DRAW = 1,
+		FRAME_TYPE_CNT  = 2,
+	};
+
+	struct Stats {
+		/// highest number of bytes any one thread had in use during the last frame of each type
+		size_t peakBytes[FRAME_TYPE_CNT];
+		/// chunk memory currently held by the calling thread
+		size_t chunkBytes;
+	};
+
+	/// main thread only
+	void BeginFrame(unsigned int frameType);
+
+	void* Alloc(size_t size, size_t align);
+	void Free(void* ptr, size_t size);
+
+	Stats GetStats();
+}
+
+
+template<typename T>
+struct FrameAllocator {
+	typedef T value_type;
+
+	FrameAllocator() = default;
+	template<typename U> FrameAllocator(const FrameAllocator<U>&) {}
+
+	T* allocate(size_t n) { return (static_cast<T*>(FrameArena::Alloc(n * sizeof(T), alignof(T)))); }
+	void deallocate(T* p, size_t n) { FrameArena::Free(p, n * sizeof(T)); }
+
+	template<typename U> bool operator == (const FrameAllocator<U>&) const { return true; }
+	template<typename U> bool operator != (const FrameAllocator<U>&) const { return false; }
+};
+
+/// drop-in for function-local std::vector's that do not outlive the frame
+template<typename T> using FrameVector = std::vector<T, FrameAllocator<T>>;
+
+#endif // FRAME_ARENA_H
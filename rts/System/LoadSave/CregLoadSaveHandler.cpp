@@ -1,8 +1,16 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <cerrno>
+#include <cstring>
 #include <sstream>
 #include <zlib.h>
 
+#ifndef WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #include "ExternalAI/SkirmishAIHandler.h"
 #include "ExternalAI/EngineOutHandler.h"
 #include "CregLoadSaveHandler.h"
@@ -15,7 +23,9 @@
 #include "Game/UI/Groups/GroupHandler.h"
 #include "Net/GameServer.h"
 #include "Sim/Features/FeatureHandler.h"
+#include "Sim/Features/FeatureMemPool.h"
 #include "Sim/Units/UnitHandler.h"
+#include "Sim/Units/UnitMemPool.h"
 #include "Sim/Misc/BuildingMaskMap.h"
 #include "Sim/Misc/InterceptHandler.h"
 #include "Sim/Misc/LosHandler.h"
@@ -24,12 +34,19 @@
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/Wind.h"
+#include "Sim/Projectiles/ExpGenSpawnable.h"
 #include "Sim/Projectiles/ProjectileHandler.h"
+#include "Sim/Projectiles/ProjectileMemPool.h"
 #include "Sim/Units/CommandAI/CommandDescription.h"
 #include "Sim/Units/Scripts/CobEngine.h"
 #include "Sim/Units/Scripts/UnitScriptEngine.h"
 #include "Sim/Units/Scripts/NullUnitScript.h"
+#include "Sim/Weapons/Weapon.h"
+#include "Sim/Weapons/WeaponMemPool.h"
 #include "System/SafeUtil.h"
+#include "System/SpringExitCode.h"
+#include "System/StringUtil.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Platform/errorhandler.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
@@ -40,6 +57,8 @@
 #include "System/Log/ILog.h"
 
 
+CONFIG(bool, SaveGameInBackground).defaultValue(false).description("Write savegames from a forked copy of the engine, so the game does not stall while the state is serialized (not available on Windows, ignored while the local client runs Skirmish AIs).");
+
 
 CCregLoadSaveHandler::CCregLoadSaveHandler()
 	: iss(nullptr)
@@ -93,6 +112,30 @@ void CGameStateCollector::Serialize(creg::ISerializer* s)
 	s->SerializeObjectInstance(eoh, eoh->GetClass());
 }
 
+
+static void ReserveSimObjectPools(const std::vector<creg::Class*>& classes, const std::vector<size_t>& counts)
+{
+	size_t numUnits = 0;
+	size_t numFeatures = 0;
+	size_t numWeapons = 0;
+	size_t numSpawnables = 0;
+
+	for (size_t i = 0; i < classes.size(); i++) {
+		const creg::Class* c = classes[i];
+
+		numUnits      += (counts[i] * c->IsSubclassOf(CUnit::StaticClass()));
+		numFeatures   += (counts[i] * c->IsSubclassOf(CFeature::StaticClass()));
+		numWeapons    += (counts[i] * c->IsSubclassOf(CWeapon::StaticClass()));
+		numSpawnables += (counts[i] * c->IsSubclassOf(CExpGenSpawnable::StaticClass()));
+	}
+
+	// no-ops for the static pools
+	unitMemPool.reserve(numUnits);
+	featureMemPool.reserve(numFeatures);
+	weaponMemPool.reserve(numWeapons);
+	projMemPool.reserve(numSpawnables);
+}
+
 static void WriteString(std::ostream& s, const std::string& str)
 {
 	assert(str.length() < (1 << 16));
@@ -122,42 +165,54 @@ static void ReadString(std::istream& s, std::string& str)
 
 
 
+void CCregLoadSaveHandler::SaveGameState(std::stringstream& oss, bool printSizes)
+{
+#ifdef USING_CREG
+	// write our own header. SavePackage() will add its own
+	WriteString(oss, SpringVersion::GetSync());
+	WriteString(oss, gameSetup->setupText);
+	WriteString(oss, modName);
+	WriteString(oss, mapName);
+
+	CGameStateCollector gsc = CGameStateCollector();
+
+	// save creg state
+	creg::COutputStreamSerializer os;
+	os.SavePackage(&oss, &gsc, gsc.GetClass());
+	if (printSizes)
+		PrintSize("Game", oss.tellp());
+
+	// save AI state
+	const int aiStart = oss.tellp();
+
+	for (const auto& ai: skirmishAIHandler.GetAllSkirmishAIs()) {
+		std::stringstream aiData;
+		eoh->Save(&aiData, ai.first);
+
+		std::streamsize aiSize = aiData.tellp();
+		os.SerializeInt(&aiSize, sizeof(aiSize));
+		if (aiSize > 0)
+			oss << aiData.rdbuf();
+	}
+	if (printSizes)
+		PrintSize("AIs", ((int)oss.tellp()) - aiStart);
+
+	//FIXME add lua state
+#endif //USING_CREG
+}
+
 void CCregLoadSaveHandler::SaveGame(const std::string& path)
 {
 #ifdef USING_CREG
 	LOG("[LSH::%s] saving game to \"%s\"", __func__, path.c_str());
 
+	if (SaveGameForked(path))
+		return;
+
 	try {
 		std::stringstream oss;
 
-		// write our own header. SavePackage() will add its own
-		WriteString(oss, SpringVersion::GetSync());
-		WriteString(oss, gameSetup->setupText);
-		WriteString(oss, modName);
-		WriteString(oss, mapName);
-
-		CGameStateCollector gsc = CGameStateCollector();
-
-		{
-			// save creg state
-			creg::COutputStreamSerializer os;
-			os.SavePackage(&oss, &gsc, gsc.GetClass());
-			PrintSize("Game", oss.tellp());
-
-			// save AI state
-			const int aiStart = oss.tellp();
-
-			for (const auto& ai: skirmishAIHandler.GetAllSkirmishAIs()) {
-				std::stringstream aiData;
-				eoh->Save(&aiData, ai.first);
-
-				std::streamsize aiSize = aiData.tellp();
-				os.SerializeInt(&aiSize, sizeof(aiSize));
-				if (aiSize > 0)
-					oss << aiData.rdbuf();
-			}
-			PrintSize("AIs", ((int)oss.tellp()) - aiStart);
-		}
+		SaveGameState(oss);
 
 		{
 			gzFile file = gzopen(dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE).c_str(), "wb9");
@@ -178,8 +233,6 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 			// need to keep a reference to the future around or its destructor will block
 			ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), file, std::move(data))));
 		}
-
-		//FIXME add lua state
 	} catch (const content_error& ex) {
 		LOG_L(L_ERROR, "[LSH::%s] content error \"%s\"", __func__, ex.what());
 	} catch (const std::exception& ex) {
@@ -196,6 +249,162 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 #endif //USING_CREG
 }
 
+bool CCregLoadSaveHandler::SaveGameForked(const std::string& path)
+{
+#if defined(USING_CREG) && !defined(WIN32)
+	if (!configHandler->GetBool("SaveGameInBackground"))
+		return false;
+
+	// AI libraries (and whatever runtime they embed) can not be expected to
+	// function in a child that only inherited the calling thread, and their
+	// state would not be saved if they were skipped
+	for (const auto& ai: skirmishAIHandler.GetAllSkirmishAIs()) {
+		if (!ai.second.isLuaAI && skirmishAIHandler.IsLocalSkirmishAI(ai.first))
+			return false;
+	}
+
+	const std::string filePath = dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE);
+
+	// otherwise buffered output would be written twice
+	fflush(nullptr);
+
+	const pid_t pid = fork();
+
+	if (pid == -1) {
+		LOG_L(L_WARNING, "[LSH::%s] fork failed (%s), saving in the foreground", __func__, strerror(errno));
+		return false;
+	}
+
+	if (pid != 0) {
+		// reap the child when it is done; the game continues meanwhile
+		std::function<void(pid_t, std::string)> func = [](pid_t pid, std::string path) {
+			int status = 0;
+
+			while (waitpid(pid, &status, 0) == -1) {
+				if (errno == EINTR)
+					continue;
+
+				LOG_L(L_ERROR, "[LSH::%s] waitpid failed for \"%s\": %s", __func__, path.c_str(), strerror(errno));
+				return;
+			}
+
+			if (WIFEXITED(status) && WEXITSTATUS(status) == spring::EXIT_CODE_SUCCESS) {
+				LOG("[LSH::%s] saved game to \"%s\"", __func__, path.c_str());
+				return;
+			}
+
+			// the child does not log by itself, see below
+			const std::string reason = WIFEXITED(status)? IntToString(int(int8_t(WEXITSTATUS(status))), "exit code %i"): IntToString(WTERMSIG(status), "signal %i");
+
+			LOG_L(L_ERROR, "[LSH::%s] saving to \"%s\" failed (%s)", __func__, path.c_str(), reason.c_str());
+		};
+
+		ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), pid, path)));
+		return true;
+	}
+
+	// child: the address space is a copy-on-write snapshot of the current frame
+	// but none of the other threads exist here, so anything they might have been
+	// holding a lock on at the time of the fork (log sinks, the thread pool) is
+	// off-limits; _exit skips all atexit handlers and static destructors
+	int exitCode = spring::EXIT_CODE_FAILURE;
+
+	try {
+		std::stringstream oss;
+
+		SaveGameState(oss, false);
+
+		gzFile file = gzopen(filePath.c_str(), "wb9");
+
+		if (file != nullptr) {
+			const std::string data = std::move(oss.str());
+
+			if (gzwrite(file, data.c_str(), data.size()) == int(data.size()) && gzclose(file) == Z_OK)
+				exitCode = spring::EXIT_CODE_SUCCESS;
+		}
+	} catch (...) {
+	}
+
+	_exit(exitCode);
+#else
+	return false;
+#endif
+}
+
+
+bool CCregLoadSaveHandler::SaveGameToBuffer(std::vector<std::uint8_t>& buffer)
+{
+#ifdef USING_CREG
+	try {
+		std::stringstream oss;
+
+		SaveGameState(oss);
+
+		const std::string data = std::move(oss.str());
+		const std::uint32_t rawSize = data.size();
+
+		uLongf packedSize = compressBound(rawSize);
+
+		// uncompressed size first, see LoadGameFromBuffer
+		buffer.resize(sizeof(rawSize) + packedSize);
+		std::memcpy(buffer.data(), &rawSize, sizeof(rawSize));
+
+		if (compress2(buffer.data() + sizeof(rawSize), &packedSize, reinterpret_cast<const Bytef*>(data.data()), rawSize, Z_BEST_SPEED) != Z_OK)
+			return false;
+
+		buffer.resize(sizeof(rawSize) + packedSize);
+		return true;
+	} catch (const content_error& ex) {
+		LOG_L(L_ERROR, "[LSH::%s] content error \"%s\"", __func__, ex.what());
+	} catch (const std::exception& ex) {
+		LOG_L(L_ERROR, "[LSH::%s] exception \"%s\"", __func__, ex.what());
+	} catch (...) {
+		LOG_L(L_ERROR, "[LSH::%s] unknown error", __func__);
+	}
+#endif //USING_CREG
+
+	return false;
+}
+
+bool CCregLoadSaveHandler::LoadGameFromBuffer(const std::vector<std::uint8_t>& buffer)
+{
+	std::uint32_t rawSize = 0;
+
+	if (buffer.size() <= sizeof(rawSize))
+		return false;
+
+	std::memcpy(&rawSize, buffer.data(), sizeof(rawSize));
+
+	std::vector<char> data(rawSize);
+	uLongf unpackedSize = rawSize;
+
+	if (uncompress(reinterpret_cast<Bytef*>(data.data()), &unpackedSize, buffer.data() + sizeof(rawSize), buffer.size() - sizeof(rawSize)) != Z_OK || unpackedSize != rawSize)
+		return false;
+
+	iss = new std::stringstream;
+	iss->rdbuf()->sputn(data.data(), data.size());
+
+	std::string saveVersion;
+	ReadString(*iss, saveVersion);
+
+	// checkpoints are only exchanged between clients of the same game
+	if (saveVersion != SpringVersion::GetSync()) {
+		spring::SafeDelete(iss);
+		return false;
+	}
+
+	scriptText = "";
+	modName = "";
+	mapName = "";
+
+	ReadString(*iss, scriptText);
+	ReadString(*iss, modName);
+	ReadString(*iss, mapName);
+
+	LoadGame();
+	return true;
+}
+
 /// this just loads the mapname and some other early stuff
 void CCregLoadSaveHandler::LoadGameStartInfo(const std::string& path)
 {
@@ -249,6 +458,7 @@ void CCregLoadSaveHandler::LoadGame()
 
 	// load creg state
 	creg::CInputStreamSerializer inputStream;
+	inputStream.SetReserveCallback(ReserveSimObjectPools);
 	inputStream.LoadPackage(iss, pGSC, gsccls);
 	assert(pGSC && gsccls == CGameStateCollector::StaticClass());
 
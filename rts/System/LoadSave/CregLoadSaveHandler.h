@@ -3,8 +3,10 @@
 #ifndef CREG_LOAD_SAVE_HANDLER_H
 #define CREG_LOAD_SAVE_HANDLER_H
 
+#include <cstdint>
 #include <string>
 #include <sstream>
+#include <vector>
 #include "LoadSaveHandler.h"
 
 class CCregLoadSaveHandler : public ILoadSaveHandler
@@ -17,6 +19,16 @@ public:
 	void LoadGameStartInfo(const std::string& path);
 	void LoadGame();
 
+	/// save the game state into a (compressed) memory buffer, as used for late-join checkpoints
+	bool SaveGameToBuffer(std::vector<std::uint8_t>& buffer);
+	/// replaces LoadGameStartInfo and LoadGame for buffers created by SaveGameToBuffer
+	bool LoadGameFromBuffer(const std::vector<std::uint8_t>& buffer);
+
+protected:
+	void SaveGameState(std::stringstream& oss, bool printSizes = true);
+	/// serialize and write the game from a fork()'ed child, returns false if not possible
+	bool SaveGameForked(const std::string& path);
+
 protected:
 	std::stringstream* iss;
 };
@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "Demo.h"
+#include "Net/Protocol/BaseNetProtocol.h"
 
 #include <cstring>
 
@@ -9,3 +10,65 @@ CDemo::CDemo():
 {
 	memset(&fileHeader, 0, sizeof(DemoFileHeader));
 }
+
+
+void CDemoFrameIndex::AddPacket(const unsigned char* buf, unsigned int length, std::uint32_t streamOffset)
+{
+	if (length < (1 + sizeof(int)) || buf[0] != NETMSG_KEYFRAME)
+		return;
+
+	DemoIndexEntry entry;
+	entry.frameNum = *reinterpret_cast<const int*>(buf + 1);
+	entry.streamOffset = streamOffset;
+
+	if (!entries.empty() && entry.frameNum < (entries.back().frameNum + DEMOFILE_INDEX_PERIOD))
+		return;
+
+	entries.push_back(entry);
+}
+
+void CDemoFrameIndex::AddCheckpoint(int frameNum, std::uint32_t streamOffset, const std::vector<std::uint8_t>& data)
+{
+	DemoCheckpointHeader header;
+	header.frameNum = frameNum;
+	header.streamOffset = streamOffset;
+	header.dataSize = data.size();
+
+	checkpoints.push_back(header);
+	checkpointData.push_back(data);
+}
+
+unsigned int CDemoFrameIndex::Write(std::ostream& stream)
+{
+	const std::streampos pos = stream.tellp();
+
+	DemoIndexHeader indexHeader;
+	indexHeader.indexPeriod = DEMOFILE_INDEX_PERIOD;
+	indexHeader.numEntries = entries.size();
+	indexHeader.numCheckpoints = checkpoints.size();
+	indexHeader.swab();
+
+	stream.write(reinterpret_cast<const char*>(&indexHeader), sizeof(indexHeader));
+
+	for (DemoIndexEntry entry: entries) {
+		entry.swab();
+		stream.write(reinterpret_cast<const char*>(&entry), sizeof(entry));
+	}
+
+	for (size_t n = 0; n < checkpoints.size(); n++) {
+		DemoCheckpointHeader header = checkpoints[n];
+		header.swab();
+
+		stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		stream.write(reinterpret_cast<const char*>(checkpointData[n].data()), checkpointData[n].size());
+	}
+
+	return (stream.tellp() - pos);
+}
+
+void CDemoFrameIndex::Clear()
+{
+	entries.clear();
+	checkpoints.clear();
+	checkpointData.clear();
+}
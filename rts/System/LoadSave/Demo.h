@@ -3,7 +3,10 @@
 #ifndef _DEMO_H
 #define _DEMO_H
 
+#include <cinttypes>
+#include <ostream>
 #include <string>
+#include <vector>
 
 #include "demofile.h"
 
@@ -24,5 +27,33 @@ protected:
 	std::string demoName;
 };
 
+
+/**
+@brief frame index and checkpoints of a demo being written
+Collected while recording (or by DemoTool for existing demos) and appended
+after the statistics, see DemoIndexHeader
+*/
+class CDemoFrameIndex
+{
+public:
+	/// adds an entry if buf is a keyframe at least DEMOFILE_INDEX_PERIOD frames after the last entry
+	void AddPacket(const unsigned char* buf, unsigned int length, std::uint32_t streamOffset);
+	void AddCheckpoint(int frameNum, std::uint32_t streamOffset, const std::vector<std::uint8_t>& data);
+
+	/// writes the index chunk, returns its size
+	unsigned int Write(std::ostream& stream);
+	void Clear();
+
+	bool Empty() const { return (entries.empty() && checkpoints.empty()); }
+
+	size_t GetNumEntries() const { return entries.size(); }
+	size_t GetNumCheckpoints() const { return checkpoints.size(); }
+
+private:
+	std::vector<DemoIndexEntry> entries;
+	std::vector<DemoCheckpointHeader> checkpoints;
+	std::vector< std::vector<std::uint8_t> > checkpointData;
+};
+
 #endif // _DEMO_H
 
@@ -31,7 +31,7 @@ CDemoReader::CDemoReader(const std::string& filename, float curTime): playbackDe
 
 	if (memcmp(fileHeader.magic, DEMOFILE_MAGIC, sizeof(fileHeader.magic))
 		|| fileHeader.version != DEMOFILE_VERSION
-		|| fileHeader.headerSize != sizeof(fileHeader)
+		|| (fileHeader.headerSize != sizeof(fileHeader) && fileHeader.headerSize != DEMOFILE_HEADER_SIZE_NOINDEX)
 		|| fileHeader.playerStatElemSize != sizeof(PlayerStatistics)
 		|| fileHeader.teamStatElemSize != sizeof(TeamStatistics)
 		// Don't compare spring version in debug mode: we don't want to make
@@ -49,12 +49,21 @@ CDemoReader::CDemoReader(const std::string& filename, float curTime): playbackDe
 			LOG_L(L_WARNING, "%s", demoMsg.c_str());
 	}
 
+	// older demos end their header before the index field
+	if (fileHeader.headerSize == DEMOFILE_HEADER_SIZE_NOINDEX)
+		fileHeader.indexSize = 0;
+
+	playbackDemo->Seek(fileHeader.headerSize);
+
 	if (fileHeader.scriptSize != 0) {
 		std::vector<char> buf(fileHeader.scriptSize);
 		playbackDemo->Read(&buf[0], fileHeader.scriptSize);
 		setupScript = std::string(&buf[0], fileHeader.scriptSize);
 	}
 
+	streamStartPos = playbackDemo->GetPos();
+	streamOffset = 0;
+
 	playbackDemo->Read((char*)&chunkHeader, sizeof(chunkHeader));
 	chunkHeader.swab();
 
@@ -75,6 +84,8 @@ CDemoReader::CDemoReader(const std::string& filename, float curTime): playbackDe
 		bytesRemaining = playbackDemoSize - curPos;
 	}
 	playbackDemo->Seek(curPos);
+
+	LoadFrameIndex();
 }
 
 
@@ -100,6 +111,7 @@ netcode::RawPacket* CDemoReader::GetData(const float readTime)
 			return nullptr;
 		}
 		bytesRemaining -= chunkHeader.length;
+		streamOffset += (sizeof(chunkHeader) + chunkHeader.length);
 
 		if (!ReachedEnd()) {
 			// read next chunk header
@@ -135,7 +147,7 @@ void CDemoReader::LoadStats()
 		return;
 
 	const int curPos = playbackDemo->GetPos();
-	playbackDemo->Seek(fileHeader.headerSize + fileHeader.scriptSize + fileHeader.demoStreamSize);
+	playbackDemo->Seek(streamStartPos + fileHeader.demoStreamSize);
 
 	winningAllyTeams.clear();
 	playerStats.clear();
@@ -172,3 +184,69 @@ void CDemoReader::LoadStats()
 
 	playbackDemo->Seek(curPos);
 }
+
+
+void CDemoReader::LoadFrameIndex()
+{
+	// no index, or the demo was not closed properly (then nothing follows the stream)
+	if (fileHeader.indexSize <= 0 || fileHeader.demoStreamSize == 0)
+		return;
+
+	const int curPos = playbackDemo->GetPos();
+	const int indexPos = streamStartPos + fileHeader.demoStreamSize + fileHeader.winningAllyTeamsSize + fileHeader.playerStatSize + fileHeader.teamStatSize;
+	const int indexEnd = indexPos + fileHeader.indexSize;
+
+	playbackDemo->Seek(indexPos);
+
+	DemoIndexHeader indexHeader = {0, 0, 0};
+
+	if (playbackDemo->Read((char*)&indexHeader, sizeof(indexHeader)) == sizeof(indexHeader))
+		indexHeader.swab();
+
+	if (indexHeader.numEntries > 0 && indexHeader.numEntries <= ((indexEnd - playbackDemo->GetPos()) / int(sizeof(DemoIndexEntry)))) {
+		frameIndex.resize(indexHeader.numEntries);
+		playbackDemo->Read((char*)frameIndex.data(), frameIndex.size() * sizeof(DemoIndexEntry));
+
+		for (DemoIndexEntry& entry: frameIndex) {
+			entry.swab();
+		}
+	}
+
+	for (int n = 0; n < indexHeader.numCheckpoints; n++) {
+		DemoCheckpointHeader header;
+
+		if (playbackDemo->Read((char*)&header, sizeof(header)) < sizeof(header))
+			break;
+
+		header.swab();
+
+		if (header.dataSize > unsigned(indexEnd - playbackDemo->GetPos()))
+			break;
+
+		checkpoints.push_back(header);
+		checkpointDataPos.push_back(playbackDemo->GetPos());
+
+		playbackDemo->Seek(header.dataSize, std::ios_base::cur);
+	}
+
+	if (frameIndex.size() != size_t(indexHeader.numEntries) || checkpoints.size() != size_t(indexHeader.numCheckpoints) || indexHeader.indexPeriod <= 0)
+		LOG_L(L_WARNING, "[DemoReader::%s] frame index is corrupt, loaded %u of %d entries and %u of %d checkpoints", __func__, unsigned(frameIndex.size()), indexHeader.numEntries, unsigned(checkpoints.size()), indexHeader.numCheckpoints);
+
+	playbackDemo->Seek(curPos);
+}
+
+bool CDemoReader::ReadCheckpoint(size_t n, std::vector<std::uint8_t>& data)
+{
+	if (n >= checkpoints.size())
+		return false;
+
+	const int curPos = playbackDemo->GetPos();
+
+	data.resize(checkpoints[n].dataSize);
+
+	playbackDemo->Seek(checkpointDataPos[n]);
+	const bool ret = (playbackDemo->Read((char*)data.data(), data.size()) == int(data.size()));
+	playbackDemo->Seek(curPos);
+
+	return ret;
+}
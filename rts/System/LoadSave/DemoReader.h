@@ -39,6 +39,9 @@ public:
 	*/
 	bool ReachedEnd();
 
+	/// offset of the next chunk within the demo stream
+	std::uint32_t GetStreamOffset() const { return streamOffset; }
+
 	float GetModGameTime() const { return chunkHeader.modGameTime; }
 	float GetDemoTimeOffset() const { return demoTimeOffset; }
 	float GetNextDemoReadTime() const { return nextDemoReadTime; }
@@ -52,9 +55,18 @@ public:
 	const std::vector< std::vector<TeamStatistics> >& GetTeamStats() const { return teamStats; }
 	const std::vector< unsigned char >& GetWinningAllyTeams() const { return winningAllyTeams; }
 
+	const std::vector<DemoIndexEntry>& GetFrameIndex() const { return frameIndex; }
+	const std::vector<DemoCheckpointHeader>& GetCheckpoints() const { return checkpoints; }
+
+	/// reads the game-state of checkpoint n, see CCregLoadSaveHandler::LoadGameFromBuffer
+	bool ReadCheckpoint(size_t n, std::vector<std::uint8_t>& data);
+
 	/// Not needed for normal demo watching
 	void LoadStats();
 
+private:
+	void LoadFrameIndex();
+
 private:
 	CFileHandler* playbackDemo;
 
@@ -63,6 +75,9 @@ private:
 	int bytesRemaining;
 	int playbackDemoSize;
 
+	int streamStartPos;
+	std::uint32_t streamOffset;
+
 	DemoStreamChunkHeader chunkHeader;
 
 	std::string setupScript;	// the original, unaltered version from script
@@ -70,6 +85,11 @@ private:
 	std::vector<PlayerStatistics> playerStats; // one stat per player
 	std::vector< std::vector<TeamStatistics> > teamStats; // many stats per team
 	std::vector<unsigned char> winningAllyTeams;
+
+	std::vector<DemoIndexEntry> frameIndex;
+	std::vector<DemoCheckpointHeader> checkpoints;
+	/// file position of each checkpoint's data
+	std::vector<int> checkpointDataPos;
 };
 
 #endif
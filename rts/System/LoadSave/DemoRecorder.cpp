@@ -2,8 +2,9 @@
 
 #include <cassert>
 #include <cerrno>
+#include <cstdio>
 #include <cstring>
-#include <memory>
+#include <functional>
 
 #include "DemoRecorder.h"
 #include "Game/GameVersion.h"
@@ -15,7 +16,7 @@
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/Log/ILog.h"
-#include "System/Threading/ThreadPool.h"
+#include "System/Platform/Threading.h"
 
 #ifdef CreateDirectory
 #undef CreateDirectory
@@ -25,16 +26,25 @@
 #undef GetCurrentTime
 #endif
 
-// server and client memory-streams
-static std::unique_ptr<std::stringstream> demoStreams[2] = {nullptr, nullptr};
-
-CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modName, bool serverDemo): isServerDemo(serverDemo)
+// chunks are handed to the writer thread when this many bytes are buffered
+static constexpr size_t DEMO_BUFFER_SIZE = 256 * 1024;
+// or this many seconds have passed since the last hand-over (then flushed to disk)
+static constexpr int DEMO_FLUSH_INTERVAL = 2;
+
+CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modName, bool serverDemo)
+	: file(nullptr)
+	, writerThread(nullptr)
+	, headerChanged(false)
+	, closing(false)
+	, isServerDemo(serverDemo)
 {
-	SetStream();
 	SetName(mapName, modName);
 	SetFileHeader();
 
-	file = gzopen(demoName.c_str(), "wb9");
+	buffer.reserve(DEMO_BUFFER_SIZE);
+	lastFlushTime = spring_gettime();
+
+	writerThread = new spring::thread(std::bind(&CDemoRecorder::WriterLoop, this));
 }
 
 CDemoRecorder::~CDemoRecorder()
@@ -43,17 +53,18 @@ CDemoRecorder::~CDemoRecorder()
 	WriteWinnerList();
 	WritePlayerStats();
 	WriteTeamStats();
+	WriteFrameIndex();
+	FlushBuffer();
 	WriteFileHeader(true);
-	WriteDemoFile();
-}
 
-void CDemoRecorder::SetStream()
-{
-	if (demoStreams[isServerDemo].get() == nullptr)
-		demoStreams[isServerDemo].reset(new std::stringstream(std::ios::binary | std::ios::out));
+	{
+		std::lock_guard<spring::mutex> lock(writerMutex);
+		closing = true;
+	}
 
-	demoStreams[isServerDemo]->clear();
-	demoStreams[isServerDemo]->seekp(0);
+	writerCond.notify_one();
+	writerThread->join();
+	delete writerThread;
 }
 
 void CDemoRecorder::SetFileHeader()
@@ -69,35 +80,135 @@ void CDemoRecorder::SetFileHeader()
 	fileHeader.teamStatPeriod = TeamStatistics::statsPeriod;
 	fileHeader.winningAllyTeamsSize = 0;
 
-	demoStreams[isServerDemo]->seekp(WriteFileHeader(false) + sizeof(DemoFileHeader));
+	WriteFileHeader(false);
 }
 
-void CDemoRecorder::WriteDemoFile()
+void CDemoRecorder::FlushBuffer()
 {
-	// using operator<<(basic_stringbuf*) requires the stream to be opened with std::ios::in
-	// stringbuf::{eback(), egptr(), gptr()} are protected so we cannot access them directly
-	// (plus data is not guaranteed to be stored contiguously) ==> the only clean OO solution
-	// that avoids str()'s copy would be to supply our own stringbuffer backend to demoStream
-	// which is slightly overdoing it
-	//
-	// zlib FAQ claims the lib is thread-safe, "however any library routines that zlib uses and
-	// any application-provided memory allocation routines must also be thread-safe. zlib's gz*
-	// functions use stdio library routines, and most of zlib's functions use the library memory
-	// allocation routines by default" (should be OK)
-	std::string data = std::move(demoStreams[isServerDemo]->str());
-	std::function<void(gzFile, std::string&&)> func = [](gzFile file, std::string&& data) {
-		gzwrite(file, data.c_str(), data.size());
-		gzflush(file, Z_FINISH);
-		gzclose(file);
-	};
-
-	#ifndef WIN32
-	// NOTE: can not use ThreadPool for this directly here, workers are already gone
-	// FIXME: does not currently (august 2017) compile on Windows mingw buildbots
-	ThreadPool::AddExtJob(spring::thread(std::move(func), file, std::move(data)));
-	#else
-	ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), file, std::move(data))));
-	#endif
+	lastFlushTime = spring_gettime();
+
+	if (buffer.empty())
+		return;
+
+	{
+		std::lock_guard<spring::mutex> lock(writerMutex);
+		writerQueue.emplace_back(std::move(buffer));
+	}
+
+	writerCond.notify_one();
+
+	buffer.clear();
+	buffer.reserve(DEMO_BUFFER_SIZE);
+}
+
+void CDemoRecorder::WriterLoop()
+{
+	Threading::SetThreadName("demowriter");
+
+	std::vector<std::string> chunks;
+	std::string header;
+
+	bool headerPending = false;
+	bool done = false;
+
+	size_t headerMemberSize = 0;
+
+	while (!done) {
+		{
+			std::unique_lock<spring::mutex> lock(writerMutex);
+			writerCond.wait(lock, [&]() { return (!writerQueue.empty() || headerChanged || closing); });
+
+			chunks.swap(writerQueue);
+
+			if (headerChanged)
+				header = headerData;
+
+			headerPending |= headerChanged;
+			headerChanged = false;
+			done = closing;
+		}
+
+		// nothing is written before the first chunk, the setup text is known by then
+		if (headerMemberSize == 0 && chunks.empty() && !done)
+			continue;
+
+		if (headerMemberSize == 0) {
+			headerMemberSize = WriteHeaderMember(header, 0);
+			headerPending = false;
+
+			// a new gzip member follows the header, gz readers concatenate them
+			if (headerMemberSize != 0 && (file = gzopen(demoName.c_str(), "ab1")) == nullptr)
+				LOG_L(L_ERROR, "[DemoRecorder::%s] could not open \"%s\" for writing", __func__, demoName.c_str());
+		}
+
+		if (file != nullptr) {
+			for (const std::string& chunk: chunks) {
+				gzwrite(file, chunk.data(), chunk.size());
+			}
+
+			// everything up to here can be decompressed, even if the process dies
+			if (!chunks.empty())
+				gzflush(file, Z_SYNC_FLUSH);
+
+			if (done) {
+				gzclose(file);
+				file = nullptr;
+			}
+		}
+
+		chunks.clear();
+
+		// the final header is written last, once the stream it describes is complete
+		if (headerPending && headerMemberSize != 0) {
+			WriteHeaderMember(header, headerMemberSize);
+			headerPending = false;
+		}
+	}
+}
+
+size_t CDemoRecorder::WriteHeaderMember(const std::string& data, size_t memberSize)
+{
+	// stored (level 0) deflate output only depends on the input length,
+	// so every later header replaces the first one in place
+	z_stream zstream;
+	zstream.opaque = Z_NULL;
+	zstream.zalloc = Z_NULL;
+	zstream.zfree  = Z_NULL;
+
+	if (deflateInit2(&zstream, Z_NO_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return 0;
+
+	std::vector<std::uint8_t> member(deflateBound(&zstream, data.size()));
+
+	zstream.next_in   = reinterpret_cast<Bytef*>(const_cast<char*>(data.data()));
+	zstream.avail_in  = data.size();
+	zstream.next_out  = member.data();
+	zstream.avail_out = member.size();
+
+	const int ret = deflate(&zstream, Z_FINISH);
+
+	member.resize(zstream.total_out);
+	deflateEnd(&zstream);
+
+	if (ret != Z_STREAM_END)
+		return 0;
+
+	if (memberSize != 0 && member.size() != memberSize) {
+		LOG_L(L_ERROR, "[DemoRecorder::%s] header of \"%s\" changed size (%u vs. %u bytes)", __func__, demoName.c_str(), unsigned(member.size()), unsigned(memberSize));
+		return 0;
+	}
+
+	FILE* fp = fopen(demoName.c_str(), (memberSize == 0)? "wb": "r+b");
+
+	if (fp == nullptr) {
+		LOG_L(L_ERROR, "[DemoRecorder::%s] could not open \"%s\" for writing (%s)", __func__, demoName.c_str(), strerror(errno));
+		return 0;
+	}
+
+	const size_t numWritten = fwrite(member.data(), 1, member.size(), fp);
+
+	fclose(fp);
+	return ((numWritten == member.size())? numWritten: 0);
 }
 
 void CDemoRecorder::WriteSetupText(const std::string& text)
@@ -108,19 +219,26 @@ void CDemoRecorder::WriteSetupText(const std::string& text)
 	}
 
 	fileHeader.scriptSize = length;
-	demoStreams[isServerDemo]->write(text.c_str(), length);
+	setupText.assign(text.c_str(), length);
+
+	WriteFileHeader(false);
 }
 
 void CDemoRecorder::SaveToDemo(const unsigned char* buf, const unsigned length, const float modGameTime)
 {
 	DemoStreamChunkHeader chunkHeader;
 
+	frameIndex.AddPacket(buf, length, fileHeader.demoStreamSize);
+
 	chunkHeader.modGameTime = modGameTime;
 	chunkHeader.length = length;
 	chunkHeader.swab();
-	demoStreams[isServerDemo]->write((char*) &chunkHeader, sizeof(chunkHeader));
-	demoStreams[isServerDemo]->write((char*) buf, length);
+	buffer.append((char*) &chunkHeader, sizeof(chunkHeader));
+	buffer.append((char*) buf, length);
 	fileHeader.demoStreamSize += (length + sizeof(chunkHeader));
+
+	if (buffer.size() >= DEMO_BUFFER_SIZE || (spring_gettime() - lastFlushTime) >= spring_secs(DEMO_FLUSH_INTERVAL))
+		FlushBuffer();
 }
 
 void CDemoRecorder::SetName(const std::string& mapName, const std::string& modName)
@@ -212,50 +330,46 @@ void CDemoRecorder::SetWinningAllyTeams(const std::vector<unsigned char>& winnin
 	winningAllyTeams = winningAllyTeamIDs;
 }
 
-/** @brief Write DemoFileHeader
-Write the DemoFileHeader at the start of the file and restores the original
-position in the file afterwards. */
-unsigned int CDemoRecorder::WriteFileHeader(bool updateStreamLength)
+void CDemoRecorder::AddCheckpoint(int frameNum, const std::vector<std::uint8_t>& data)
 {
-#ifdef _MSC_VER // MSVC8 behaves strange if tell/seek is called before anything has been written
-	const bool empty = (demoStreams[isServerDemo]->str() == "");
-	const unsigned int pos = empty? 0 : demoStreams[isServerDemo]->tellp();
-#else
-	const unsigned int pos = demoStreams[isServerDemo]->tellp();
-#endif
+	// the keyframe was the last chunk written, the next one starts the replayed part
+	frameIndex.AddCheckpoint(frameNum, fileHeader.demoStreamSize, data);
+}
 
+/** @brief Write DemoFileHeader
+Hands the DemoFileHeader (followed by the setup text) to the writer thread,
+which replaces the header member at the start of the file with it. */
+void CDemoRecorder::WriteFileHeader(bool updateStreamLength)
+{
 	DemoFileHeader tmpHeader;
 	memcpy(&tmpHeader, &fileHeader, sizeof(fileHeader));
 	if (!updateStreamLength)
 		tmpHeader.demoStreamSize = 0;
 	tmpHeader.swab(); // to little endian
 
-#ifdef _MSC_VER
-	if (!empty)
-#endif
 	{
-		demoStreams[isServerDemo]->seekp(0);
-	}
+		std::lock_guard<spring::mutex> lock(writerMutex);
 
+		headerData.assign((char*) &tmpHeader, sizeof(tmpHeader));
+		headerData.append(setupText);
+		headerChanged = true;
+	}
 
-	demoStreams[isServerDemo]->write((char*) &tmpHeader, sizeof(tmpHeader));
-	demoStreams[isServerDemo]->seekp(pos);
-
-	return pos;
+	writerCond.notify_one();
 }
 
 /** @brief Write the CPlayer::Statistics at the current position in the file. */
 void CDemoRecorder::WritePlayerStats()
 {
-	int pos = demoStreams[isServerDemo]->tellp();
+	const size_t pos = buffer.size();
 
 	for (PlayerStatistics& stats: playerStats) {
 		stats.swab();
-		demoStreams[isServerDemo]->write(reinterpret_cast<char*>(&stats), sizeof(PlayerStatistics));
+		buffer.append(reinterpret_cast<char*>(&stats), sizeof(PlayerStatistics));
 	}
 
 	fileHeader.numPlayers = playerStats.size();
-	fileHeader.playerStatSize = (int)demoStreams[isServerDemo]->tellp() - pos;
+	fileHeader.playerStatSize = buffer.size() - pos;
 
 	playerStats.clear();
 }
@@ -268,38 +382,52 @@ void CDemoRecorder::WriteWinnerList()
 	if (fileHeader.numTeams == 0)
 		return;
 
-	const int pos = demoStreams[isServerDemo]->tellp();
+	const size_t pos = buffer.size();
 
 	// Write the array of winningAllyTeams.
 	for (std::vector<unsigned char>::const_iterator it = winningAllyTeams.begin(); it != winningAllyTeams.end(); ++it) {
-		demoStreams[isServerDemo]->write((char*) &(*it), sizeof(unsigned char));
+		buffer.append((char*) &(*it), sizeof(unsigned char));
 	}
 
 	winningAllyTeams.clear();
 
-	fileHeader.winningAllyTeamsSize = int(demoStreams[isServerDemo]->tellp()) - pos;
+	fileHeader.winningAllyTeamsSize = buffer.size() - pos;
 }
 
 /** @brief Write the TeamStatistics at the current position in the file. */
 void CDemoRecorder::WriteTeamStats()
 {
-	int pos = demoStreams[isServerDemo]->tellp();
+	const size_t pos = buffer.size();
 
 	// Write array of dwords indicating number of TeamStatistics per team.
 	for (std::vector<TeamStatistics>& history: teamStats) {
 		unsigned int c = swabDWord(history.size());
-		demoStreams[isServerDemo]->write((char*)&c, sizeof(unsigned int));
+		buffer.append((char*)&c, sizeof(unsigned int));
 	}
 
 	// Write big array of TeamStatistics.
 	for (std::vector<TeamStatistics>& history: teamStats) {
 		for (TeamStatistics& stats: history) {
 			stats.swab();
-			demoStreams[isServerDemo]->write(reinterpret_cast<char*>(&stats), sizeof(TeamStatistics));
+			buffer.append(reinterpret_cast<char*>(&stats), sizeof(TeamStatistics));
 		}
 	}
 
-	fileHeader.teamStatSize = (int)demoStreams[isServerDemo]->tellp() - pos;
+	fileHeader.teamStatSize = buffer.size() - pos;
 
 	teamStats.clear();
 }
+
+/** @brief Write the frame index (if any) at the current position in the file. */
+void CDemoRecorder::WriteFrameIndex()
+{
+	if (frameIndex.Empty())
+		return;
+
+	std::ostringstream stream(std::ios::binary);
+
+	fileHeader.indexSize = frameIndex.Write(stream);
+	buffer.append(stream.str());
+
+	frameIndex.Clear();
+}
@@ -10,10 +10,17 @@
 #include "Demo.h"
 #include "Game/Players/PlayerStatistics.h"
 #include "Sim/Misc/TeamStatistics.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Threading/SpringThreading.h"
 
 
 /**
  * @brief Used to record demos
+ *
+ * Chunks are compressed and written to disk by a background thread while the
+ * game runs, flushed every few seconds so the demo stays readable (like one of
+ * a crashed Spring, see DemoFileHeader) if the process dies. The header lives
+ * in an uncompressed gzip member of its own so it can be patched in place.
  */
 class CDemoRecorder : public CDemo
 {
@@ -24,7 +31,6 @@ public:
 	void WriteSetupText(const std::string& text);
 	void SaveToDemo(const unsigned char* buf, const unsigned length, const float modGameTime);
 
-	void SetStream();
 	void SetName(const std::string& mapName, const std::string& modName);
 	const std::string& GetName() const { return demoName; }
 
@@ -37,13 +43,22 @@ public:
 	void SetTeamStats(int teamNum, const std::vector<TeamStatistics>& stats);
 	void SetWinningAllyTeams(const std::vector<unsigned char>& winningAllyTeams);
 
+	/// embeds a game-state saved right after keyframe frameNum was simulated
+	void AddCheckpoint(int frameNum, const std::vector<std::uint8_t>& data);
+
 private:
-	unsigned int WriteFileHeader(bool updateStreamLength);
+	void WriteFileHeader(bool updateStreamLength);
 	void SetFileHeader();
 	void WritePlayerStats();
 	void WriteTeamStats();
 	void WriteWinnerList();
-	void WriteDemoFile();
+	void WriteFrameIndex();
+
+	/// hands the buffered chunks to the writer thread
+	void FlushBuffer();
+	void WriterLoop();
+	/// writes (memberSize == 0) or replaces the header member, returns its size or 0 on failure
+	size_t WriteHeaderMember(const std::string& data, size_t memberSize);
 
 private:
 	gzFile file;
@@ -52,6 +67,25 @@ private:
 	std::vector< std::vector<TeamStatistics> > teamStats;
 	std::vector<unsigned char> winningAllyTeams;
 
+	CDemoFrameIndex frameIndex;
+
+	/// chunks (and at the end statistics) not yet handed to the writer
+	std::string buffer;
+	std::string setupText;
+
+	spring_time lastFlushTime;
+
+	spring::thread* writerThread;
+	spring::mutex writerMutex;
+	spring::condition_variable writerCond;
+
+	/// shared with the writer thread
+	std::vector<std::string> writerQueue;
+	std::string headerData;
+
+	bool headerChanged;
+	bool closing;
+
 	bool isServerDemo;
 };
 
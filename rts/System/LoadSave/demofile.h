@@ -13,6 +13,7 @@
 
 #include "System/Platform/byteorder.h"
 #include <cinttypes>
+#include <cstddef>
 
 /** The first 16 bytes of each demofile. */
 #define DEMOFILE_MAGIC "spring demofile"
@@ -23,6 +24,11 @@
  */
 #define DEMOFILE_VERSION 5
 
+/**
+ * Minimum number of frames between two entries of the frame index (stable).
+ */
+#define DEMOFILE_INDEX_PERIOD 300
+
 #pragma pack(push, 1)
 
 /**
@@ -34,12 +40,14 @@
  *   - Data chunks:
  *     - Startscript (scriptSize)
  *     - Demo stream (demoStreamSize)
+ *     - Winning ally teams, one byte each (winningAllyTeamsSize)
  *     - Player statistics, one PlayerStatistic for each player
  *     - Team statistics, consisting of:
  *       - Array of numTeams dwords indicating the number of
  *         CTeam::Statistics for each team.
  *       - Array of all CTeam::Statistics (total number of items is the
  *         sum of the elements in the array of dwords).
+ *     - Frame index (indexSize, optional), see DemoIndexHeader
  *
  * The header is designed to be extensible: it contains a version field and a
  * headerSize field to support this. The version field is a major version number
@@ -49,6 +57,9 @@
  *
  * If Spring did not cleanup properly (crashed), the demoStreamSize is 0 and it
  * can be assumed the demo stream continues until the end of the file.
+ *
+ * Demos recorded before the frame index was added have a headerSize equal to
+ * DEMOFILE_HEADER_SIZE_NOINDEX and no indexSize field.
  */
 struct DemoFileHeader
 {
@@ -70,6 +81,7 @@ struct DemoFileHeader
 	int teamStatElemSize;         ///< sizeof(CTeam::Statistics)
 	int teamStatPeriod;           ///< Interval (in seconds) between team stats.
 	int winningAllyTeamsSize;     ///< The size of the vector of the winning ally teams
+	int indexSize;                ///< Size of the frame index chunk, 0 if the demo has none.
 
 
 	/// Change structure from host endian to little endian or vice versa.
@@ -89,9 +101,13 @@ struct DemoFileHeader
 		swabDWordInPlace(teamStatElemSize);
 		swabDWordInPlace(teamStatPeriod);
 		swabDWordInPlace(winningAllyTeamsSize);
+		swabDWordInPlace(indexSize);
 	}
 };
 
+/** headerSize of demos without a frame index */
+#define DEMOFILE_HEADER_SIZE_NOINDEX offsetof(DemoFileHeader, indexSize)
+
 /**
  * @brief Spring demo stream chunk header
  *
@@ -115,6 +131,62 @@ struct DemoStreamChunkHeader
 	}
 };
 
+/**
+ * @brief Spring demo frame index header
+ *
+ * The frame index chunk lets players seek in the demo stream without reading
+ * it from the start, its layout is as follows:
+ *
+ * - DemoIndexHeader
+ * - numEntries DemoIndexEntry, in stream order
+ * - numCheckpoints times:
+ *   - DemoCheckpointHeader
+ *   - dataSize bytes of game-state
+ *
+ * Index entries point at keyframes at least indexPeriod frames apart. The
+ * checkpoint data is a compressed creg savegame (unstable, it can only be
+ * loaded by the Spring version that recorded the demo).
+ */
+struct DemoIndexHeader
+{
+	int indexPeriod;     ///< DEMOFILE_INDEX_PERIOD at the time of writing.
+	int numEntries;      ///< Number of DemoIndexEntry that follow.
+	int numCheckpoints;  ///< Number of checkpoints following the entries.
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swabDWordInPlace(indexPeriod);
+		swabDWordInPlace(numEntries);
+		swabDWordInPlace(numCheckpoints);
+	}
+};
+
+struct DemoIndexEntry
+{
+	int frameNum;                ///< Frame number carried by the keyframe.
+	std::uint32_t streamOffset;  ///< Offset of the keyframe's DemoStreamChunkHeader within the demo stream.
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swabDWordInPlace(frameNum);
+		swabDWordInPlace(streamOffset);
+	}
+};
+
+struct DemoCheckpointHeader
+{
+	int frameNum;                ///< The game-state was saved after simulating this keyframe.
+	std::uint32_t streamOffset;  ///< Offset of the first chunk after the keyframe within the demo stream.
+	std::uint32_t dataSize;      ///< Length of the game-state following this header.
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swabDWordInPlace(frameNum);
+		swabDWordInPlace(streamOffset);
+		swabDWordInPlace(dataSize);
+	}
+};
+
 #pragma pack(pop)
 
 #endif // DEMO_FILE_H
@@ -0,0 +1,273 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifdef _WIN32
+	#include <windows.h>
+#else
+	#include <time.h>
+	#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+#include "System/LoadTrace.h"
+#include "System/Log/ILog.h"
+#include "System/Threading/SpringThreading.h"
+
+static spring::mutex traceMutex;
+
+
+#ifdef _WIN32
+static std::int64_t FileTimeToMicroSecs(const FILETIME& ft) {
+	// 100ns intervals
+	return (((std::int64_t(ft.dwHighDateTime) << 32) | ft.dwLowDateTime) / 10);
+}
+#endif
+
+std::int64_t CLoadTrace::GetThreadCpuTime()
+{
+	#ifdef _WIN32
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+
+	if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime))
+		return 0;
+
+	return (FileTimeToMicroSecs(kernelTime) + FileTimeToMicroSecs(userTime));
+	#else
+	timespec ts;
+
+	if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+		return 0;
+
+	return (std::int64_t(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000);
+	#endif
+}
+
+std::int64_t CLoadTrace::GetProcessCpuTime()
+{
+	#ifdef _WIN32
+	FILETIME creationTime, exitTime, kernelTime, userTime;
+
+	if (!GetProcessTimes(GetCurrentProcess(), &creationTime, &exitTime, &kernelTime, &userTime))
+		return 0;
+
+	return (FileTimeToMicroSecs(kernelTime) + FileTimeToMicroSecs(userTime));
+	#else
+	timespec ts;
+
+	if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0)
+		return 0;
+
+	return (std::int64_t(ts.tv_sec) * 1000000 + ts.tv_nsec / 1000);
+	#endif
+}
+
+std::uint64_t CLoadTrace::GetResidentMemory()
+{
+	#ifdef __linux__
+	FILE* f = fopen("/proc/self/statm", "r");
+
+	if (f == nullptr)
+		return 0;
+
+	unsigned long numPages = 0;
+	unsigned long numResidentPages = 0;
+
+	if (fscanf(f, "%lu %lu", &numPages, &numResidentPages) != 2)
+		numResidentPages = 0;
+
+	fclose(f);
+	return (std::uint64_t(numResidentPages) * sysconf(_SC_PAGESIZE));
+	#else
+	return 0;
+	#endif
+}
+
+
+CLoadTrace& CLoadTrace::GetInstance()
+{
+	static CLoadTrace instance;
+	return instance;
+}
+
+
+void CLoadTrace::Start()
+{
+	std::lock_guard<spring::mutex> lck(traceMutex);
+
+	events.clear();
+	threadIDs.clear();
+
+	startTime = spring_gettime();
+	curPhase.name.clear();
+
+	active = true;
+}
+
+bool CLoadTrace::Stop(const std::string& filePath, std::uint64_t vfsBytesRead)
+{
+	std::lock_guard<spring::mutex> lck(traceMutex);
+
+	if (!active)
+		return false;
+
+	active = false;
+
+	EndPhase(spring_gettime(), vfsBytesRead);
+
+	if (filePath.empty())
+		return true;
+
+	std::ofstream file(filePath, std::ios::trunc);
+
+	if (!file.is_open())
+		return false;
+
+	const auto EscapeString = [](const std::string& s) {
+		std::string e;
+		e.reserve(s.size());
+
+		for (const char c: s) {
+			if (c == '"' || c == '\\') {
+				e += '\\';
+				e += c;
+				continue;
+			}
+			if (static_cast<unsigned char>(c) < 0x20) {
+				e += ' ';
+				continue;
+			}
+
+			e += c;
+		}
+
+		return e;
+	};
+
+	char buf[512];
+
+	file << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+
+	file << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": 0, \"args\": {\"name\": \"phases\"}},\n";
+
+	for (size_t n = 0; n < threadIDs.size(); n++) {
+		snprintf(buf, sizeof(buf), "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": %u, \"args\": {\"name\": \"thread-%u\"}},\n", unsigned(n + 1), unsigned(n));
+		file << buf;
+	}
+
+	for (size_t n = 0; n < events.size(); n++) {
+		const Event& e = events[n];
+
+		file << "{\"name\": \"" << EscapeString(e.name) << "\", ";
+
+		snprintf(buf, sizeof(buf), "\"cat\": \"%s\", \"ph\": \"X\", \"pid\": 0, \"tid\": %d, \"ts\": %lld, \"dur\": %lld, ",
+			(e.isPhase? "phase": "scope"),
+			e.threadIdx,
+			static_cast<long long>(e.startTime),
+			static_cast<long long>(e.duration)
+		);
+		file << buf;
+
+		if (e.isPhase) {
+			// cpu_cores is the average number of threads kept busy during the phase
+			snprintf(buf, sizeof(buf), "\"args\": {\"cpu_ms\": %.3f, \"cpu_cores\": %.2f, \"vfs_kb\": %.1f, \"rss_delta_kb\": %.1f}}",
+				e.cpuTime * 0.001,
+				e.cpuTime / std::max(1.0, double(e.duration)),
+				e.vfsBytesRead / 1024.0,
+				e.memoryDelta / 1024.0
+			);
+		} else {
+			snprintf(buf, sizeof(buf), "\"args\": {\"cpu_ms\": %.3f}}", e.cpuTime * 0.001);
+		}
+
+		file << buf << (((n + 1) < events.size())? ",\n": "\n");
+	}
+
+	file << "]}\n";
+
+	LOG("[LoadTrace::%s] wrote %u events to \"%s\"", __func__, unsigned(events.size()), filePath.c_str());
+	return (file.good());
+}
+
+
+void CLoadTrace::SetPhase(const std::string& name, std::uint64_t vfsBytesRead)
+{
+	if (!active)
+		return;
+
+	const spring_time time = spring_gettime();
+
+	std::lock_guard<spring::mutex> lck(traceMutex);
+
+	// recheck under the lock, Stop might have won
+	if (!active)
+		return;
+
+	EndPhase(time, vfsBytesRead);
+
+	curPhase.name = name;
+	curPhase.startTime = time;
+	curPhase.startCpuTime = GetProcessCpuTime();
+	curPhase.startVfsBytesRead = vfsBytesRead;
+	curPhase.startMemory = GetResidentMemory();
+}
+
+void CLoadTrace::EndPhase(spring_time time, std::uint64_t vfsBytesRead)
+{
+	if (curPhase.name.empty())
+		return;
+
+	Event e;
+	e.name = curPhase.name;
+	e.startTime = (curPhase.startTime - startTime).toMicroSecsi();
+	e.duration = (time - curPhase.startTime).toMicroSecsi();
+	e.cpuTime = GetProcessCpuTime() - curPhase.startCpuTime;
+	// phases are shown in a row of their own
+	e.threadIdx = 0;
+	e.isPhase = true;
+	e.vfsBytesRead = vfsBytesRead - curPhase.startVfsBytesRead;
+	e.memoryDelta = std::int64_t(GetResidentMemory()) - std::int64_t(curPhase.startMemory);
+
+	events.push_back(e);
+	curPhase.name.clear();
+}
+
+
+void CLoadTrace::AddScope(const std::string& name, spring_time scopeStartTime, spring_time scopeEndTime, std::int64_t threadCpuTime)
+{
+	if (!active)
+		return;
+
+	std::lock_guard<spring::mutex> lck(traceMutex);
+
+	if (!active)
+		return;
+
+	// a scope that began before Start is clamped to it
+	scopeStartTime = std::max(scopeStartTime, startTime);
+
+	Event e;
+	e.name = name;
+	e.startTime = (scopeStartTime - startTime).toMicroSecsi();
+	e.duration = (scopeEndTime - scopeStartTime).toMicroSecsi();
+	e.cpuTime = threadCpuTime;
+	e.threadIdx = GetThreadIndex() + 1;
+	e.isPhase = false;
+	e.vfsBytesRead = 0;
+	e.memoryDelta = 0;
+
+	events.push_back(e);
+}
+
+int CLoadTrace::GetThreadIndex()
+{
+	const std::thread::id id = std::this_thread::get_id();
+	const auto it = std::find(threadIDs.begin(), threadIDs.end(), id);
+
+	if (it != threadIDs.end())
+		return (it - threadIDs.begin());
+
+	threadIDs.push_back(id);
+	return (threadIDs.size() - 1);
+}
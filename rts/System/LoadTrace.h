@@ -0,0 +1,90 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LOAD_TRACE_H
+#define LOAD_TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "System/Misc/SpringTime.h"
+
+/**
+ * @brief records what happens while a game is loading
+ *
+ * Every load-screen message starts a new phase, which ends when the next one
+ * starts; phases are annotated with the CPU time used by the whole process,
+ * the bytes loaded from the VFS and the change in resident memory. Scopes
+ * (every ScopedOnceTimer, usually nested in a phase) are recorded with the
+ * CPU time used by the thread running them.
+ *
+ * The result is written in the Chrome trace-event format, which can be
+ * opened in chrome://tracing or https://ui.perfetto.dev.
+ */
+class CLoadTrace
+{
+public:
+	static CLoadTrace& GetInstance();
+
+	/// clears everything recorded before and starts recording
+	void Start();
+	/// ends the current phase and writes the trace to filePath unless it is empty
+	bool Stop(const std::string& filePath, std::uint64_t vfsBytesRead);
+
+	bool IsActive() const { return active; }
+
+	/// ends the current phase (if any) and starts a new one
+	void SetPhase(const std::string& name, std::uint64_t vfsBytesRead);
+	/// threadCpuTime is in microseconds, see GetThreadCpuTime
+	void AddScope(const std::string& name, spring_time startTime, spring_time endTime, std::int64_t threadCpuTime);
+
+	/// microseconds of CPU time used so far by the calling thread
+	static std::int64_t GetThreadCpuTime();
+	/// microseconds of CPU time used so far by all threads of the process
+	static std::int64_t GetProcessCpuTime();
+	/// in bytes, or 0 where unknown
+	static std::uint64_t GetResidentMemory();
+
+private:
+	struct Event {
+		std::string name;
+
+		std::int64_t startTime; // microseconds since Start
+		std::int64_t duration;
+		std::int64_t cpuTime;
+
+		int threadIdx;
+
+		// phases only
+		bool isPhase;
+		std::uint64_t vfsBytesRead;
+		std::int64_t memoryDelta;
+	};
+
+	struct Phase {
+		std::string name;
+
+		spring_time startTime;
+		std::int64_t startCpuTime;
+		std::uint64_t startVfsBytesRead;
+		std::uint64_t startMemory;
+	};
+
+	void EndPhase(spring_time time, std::uint64_t vfsBytesRead);
+	int GetThreadIndex();
+
+private:
+	std::atomic<bool> active{false};
+
+	spring_time startTime;
+	Phase curPhase;
+
+	std::vector<Event> events;
+	std::vector<std::thread::id> threadIDs;
+};
+
+#define loadTrace (CLoadTrace::GetInstance())
+
+#endif // LOAD_TRACE_H
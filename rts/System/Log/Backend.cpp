@@ -1,12 +1,24 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdio>
 #include <cstdarg>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
 
 #include "Backend.h"
 #include "DefaultFilter.h"
+#include "FramePrefixer.h"
+#include "Level.h"
 #include "LogUtil.h"
 #include "System/MainDefines.h"
 
@@ -21,6 +33,307 @@ namespace {
 		static std::set<log_cleanup_ptr> cleanupFuncs;
 		return cleanupFuncs;
 	}
+
+	// sinks are not thread-safe, the async writer holds this while calling them;
+	// recursive because they may log (or register sinks) themselves
+	std::recursive_mutex& log_formatter_getSinksMutex() {
+		static std::recursive_mutex mutex;
+		return mutex;
+	}
+
+	void log_backend_sinkRecord(int level, const char* section, const char* record) {
+		for (log_sink_ptr fptr: log_formatter_getSinks()) {
+			fptr(level, section, record);
+		}
+	}
+
+
+	// records logged by the sinks on the writer thread are written right away
+	thread_local bool isWriterThread = false;
+
+	/**
+	 * Bounded multi-producer single-consumer queue of formatted records, and
+	 * the thread that writes them to the sinks. Producers claim slots with a
+	 * CAS on <head> and publish them through the per-slot sequence number;
+	 * the slot strings keep their capacity so that, once warmed up, pushing
+	 * a record does not allocate either.
+	 */
+	class CAsyncWriter {
+	public:
+		void Start(unsigned int queueSize, unsigned int sectionRateLimit) {
+			if (running.load())
+				return;
+
+			unsigned int numSlots = 2;
+
+			while (numSlots < queueSize)
+				numSlots *= 2;
+
+			slots.reset(new Slot[numSlots]);
+			slotMask = numSlots - 1;
+			rateLimit = sectionRateLimit;
+
+			for (unsigned int i = 0; i < numSlots; i++) {
+				slots[i].seq.store(i, std::memory_order_relaxed);
+			}
+
+			head.store(0);
+			tail = 0;
+			numWritten.store(0);
+			numDropped.store(0);
+			running.store(true);
+
+			thread = std::thread([this]() { Run(); });
+		}
+
+		void Stop() {
+			if (!running.exchange(false))
+				return;
+
+			// everybody still inside Push has claimed a slot or is waiting for one
+			while (numPushers.load() > 0)
+				std::this_thread::yield();
+
+			Wake();
+			thread.join();
+
+			// records pushed before <running> was cleared; <thread> can no longer touch the queue
+			std::lock_guard<std::recursive_mutex> lock(log_formatter_getSinksMutex());
+			Slot* slot = nullptr;
+
+			while ((slot = Front()) != nullptr) {
+				WriteRecord(*slot);
+				Pop();
+			}
+		}
+
+		/// returns false if the record has to be written synchronously
+		bool Push(int level, const char* section, const char* record) {
+			if (!running.load(std::memory_order_relaxed))
+				return false;
+			if (isWriterThread)
+				return false;
+
+			numPushers.fetch_add(1);
+
+			if (!running.load()) {
+				numPushers.fetch_sub(1);
+				return false;
+			}
+
+			// 1: written after pushing, 0: dropped
+			const bool pushed = PushRecord(level, section, record);
+
+			if (!pushed)
+				numDropped.fetch_add(1, std::memory_order_relaxed);
+
+			numPushers.fetch_sub(1);
+
+			if (pushed && writerIdle.load())
+				Wake();
+
+			return true;
+		}
+
+		/// waits until all records pushed so far were written, for at most <timeout>
+		void Flush(std::chrono::milliseconds timeout) {
+			if (!running.load())
+				return;
+			if (isWriterThread)
+				return;
+
+			const size_t target = head.load();
+			const auto timeoutTime = std::chrono::steady_clock::now() + timeout;
+
+			Wake();
+
+			while (numWritten.load() < target && std::chrono::steady_clock::now() < timeoutTime)
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+
+	private:
+		struct Slot {
+			std::atomic<size_t> seq;
+
+			int level;
+			int frameNum;
+
+			// copies, both can be temporary (e.g. Spring.Log sections)
+			std::string section;
+			std::string record;
+		};
+
+		bool PushRecord(int level, const char* section, const char* record) {
+			size_t pos = head.load(std::memory_order_relaxed);
+			Slot* slot = nullptr;
+
+			std::chrono::steady_clock::time_point waitTime;
+
+			for (;;) {
+				slot = &slots[pos & slotMask];
+
+				const size_t seq = slot->seq.load(std::memory_order_acquire);
+				const intptr_t dif = intptr_t(seq) - intptr_t(pos);
+
+				if (dif == 0) {
+					if (head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+						break;
+
+					continue;
+				}
+
+				if (dif > 0) {
+					pos = head.load(std::memory_order_relaxed);
+					continue;
+				}
+
+				// full; warnings and errors wait for the writer (for a while, it
+				// might be stuck on a lock held by this thread), the rest is dropped
+				if (level < LOG_LEVEL_WARNING)
+					return false;
+
+				if (waitTime == std::chrono::steady_clock::time_point())
+					waitTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(100);
+				else if (std::chrono::steady_clock::now() > waitTime)
+					return false;
+
+				Wake();
+				std::this_thread::yield();
+
+				pos = head.load(std::memory_order_relaxed);
+			}
+
+			slot->level = level;
+			slot->frameNum = log_framePrefixer_getFrameNum();
+			slot->section.assign((section != nullptr)? section: "");
+			slot->record.assign(record);
+			slot->seq.store(pos + 1, std::memory_order_release);
+			return true;
+		}
+
+		Slot* Front() {
+			Slot* slot = &slots[tail & slotMask];
+
+			if (slot->seq.load(std::memory_order_acquire) != (tail + 1))
+				return nullptr;
+
+			return slot;
+		}
+
+		void Pop() {
+			slots[tail & slotMask].seq.store(tail + slotMask + 1, std::memory_order_release);
+			tail += 1;
+			numWritten.store(tail, std::memory_order_release);
+		}
+
+		void Wake() {
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			wakeCond.notify_one();
+		}
+
+		void WriteRecord(const Slot& slot) {
+			if (slot.level < LOG_LEVEL_WARNING && rateLimit > 0 && !AllowRecord(slot.section))
+				return;
+
+			log_framePrefixer_setRecordFrameNum(slot.frameNum);
+			log_backend_sinkRecord(slot.level, slot.section.c_str(), slot.record.c_str());
+			log_framePrefixer_setRecordFrameNum(LOG_FRAME_CURRENT);
+		}
+
+		bool AllowRecord(const std::string& section) {
+			SectionBudget& budget = sectionBudgets[section];
+
+			const long long second = std::chrono::duration_cast<std::chrono::seconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+			if (budget.second != second) {
+				if (budget.numSuppressed > 0) {
+					char buf[256];
+					SNPRINTF(buf, sizeof(buf), "[LogBackend] suppressed %u records of section \"%s\" (limit is %u per second)", budget.numSuppressed, section.c_str(), rateLimit);
+					log_backend_sinkRecord(LOG_LEVEL_WARNING, section.c_str(), buf);
+				}
+
+				budget.second = second;
+				budget.numWritten = 0;
+				budget.numSuppressed = 0;
+			}
+
+			if (budget.numWritten < rateLimit) {
+				budget.numWritten += 1;
+				return true;
+			}
+
+			budget.numSuppressed += 1;
+			return false;
+		}
+
+		void Run() {
+			isWriterThread = true;
+
+			while (running.load() || numPushers.load() > 0 || Front() != nullptr) {
+				Slot* slot = nullptr;
+
+				{
+					// one lock for the whole batch, at most a queue's worth
+					std::lock_guard<std::recursive_mutex> lock(log_formatter_getSinksMutex());
+
+					for (size_t n = 0; n <= slotMask && (slot = Front()) != nullptr; n++) {
+						WriteRecord(*slot);
+						Pop();
+					}
+
+					const unsigned int dropped = numDropped.exchange(0, std::memory_order_relaxed);
+
+					if (dropped > 0) {
+						char buf[128];
+						SNPRINTF(buf, sizeof(buf), "[LogBackend] log queue full, dropped %u records", dropped);
+						log_backend_sinkRecord(LOG_LEVEL_WARNING, "", buf);
+					}
+				}
+
+				std::unique_lock<std::mutex> lock(wakeMutex);
+
+				// re-check after announcing, or a push in between would go unnoticed
+				writerIdle.store(true);
+
+				if (Front() == nullptr && running.load())
+					wakeCond.wait_for(lock, std::chrono::milliseconds(10));
+
+				writerIdle.store(false);
+			}
+		}
+
+	private:
+		struct SectionBudget {
+			long long second = 0;
+			unsigned int numWritten = 0;
+			unsigned int numSuppressed = 0;
+		};
+
+		std::unique_ptr<Slot[]> slots;
+		size_t slotMask = 0;
+
+		std::atomic<size_t> head = {0};
+		// only touched by the writer (or by Stop after joining it)
+		size_t tail = 0;
+		std::atomic<size_t> numWritten = {0};
+
+		std::atomic<unsigned int> numPushers = {0};
+		std::atomic<unsigned int> numDropped = {0};
+		std::atomic<bool> running = {false};
+		std::atomic<bool> writerIdle = {false};
+
+		std::mutex wakeMutex;
+		std::condition_variable wakeCond;
+		std::thread thread;
+
+		std::unordered_map<std::string, SectionBudget> sectionBudgets;
+		unsigned int rateLimit = 0;
+	};
+
+	CAsyncWriter& log_backend_getAsyncWriter() {
+		static CAsyncWriter writer;
+		return writer;
+	}
 }
 
 
@@ -36,13 +349,41 @@ static _threadlocal log_record_t prv_record = {{0}, "", "",  0, 0};
 
 extern void log_formatter_format(log_record_t* log, va_list arguments);
 
-void log_backend_registerSink(log_sink_ptr sink) { log_formatter_getSinks().insert(sink); }
-void log_backend_unregisterSink(log_sink_ptr sink) { log_formatter_getSinks().erase(sink); }
+void log_backend_registerSink(log_sink_ptr sink) {
+	std::lock_guard<std::recursive_mutex> lock(log_formatter_getSinksMutex());
+	log_formatter_getSinks().insert(sink);
+}
+void log_backend_unregisterSink(log_sink_ptr sink) {
+	std::lock_guard<std::recursive_mutex> lock(log_formatter_getSinksMutex());
+	log_formatter_getSinks().erase(sink);
+}
 
 void log_backend_registerCleanup(log_cleanup_ptr cleanupFunc) { log_formatter_getCleanupFuncs().insert(cleanupFunc); }
 void log_backend_unregisterCleanup(log_cleanup_ptr cleanupFunc) { log_formatter_getCleanupFuncs().erase(cleanupFunc); }
 
 
+static void log_backend_stopAsyncAtExit() { log_backend_stopAsync(); }
+
+void log_backend_startAsync(unsigned int queueSize, unsigned int sectionRateLimit)
+{
+	static bool atExitRegistered = false;
+
+	// runs before the (earlier constructed) sink containers are destroyed
+	if (!atExitRegistered)
+		atExitRegistered = (std::atexit(&log_backend_stopAsyncAtExit) == 0);
+
+	log_backend_getAsyncWriter().Start(queueSize, sectionRateLimit);
+}
+
+void log_backend_stopAsync()
+{
+	log_backend_getAsyncWriter().Stop();
+}
+
+void log_backend_lockSinks() { log_formatter_getSinksMutex().lock(); }
+void log_backend_unlockSinks() { log_formatter_getSinksMutex().unlock(); }
+
+
 /**
  * @name logging_backend
  * ILog.h backend implementation.
@@ -75,10 +416,9 @@ void log_backend_record(int level, const char* section, const char* fmt, va_list
 		return;
 
 
-	// sink the record into each registered sink
-	for (log_sink_ptr fptr: sinks) {
-		fptr(level, section, cur_record.msg);
-	}
+	// sink the record into each registered sink, or let the writer thread do it
+	if (!log_backend_getAsyncWriter().Push(level, section, cur_record.msg))
+		log_backend_sinkRecord(level, section, cur_record.msg);
 
 	if (cur_record.cnt > 0)
 		return;
@@ -88,6 +428,9 @@ void log_backend_record(int level, const char* section, const char* fmt, va_list
 
 /// Passes on a cleanup request to all sinks
 void log_backend_cleanup() {
+	// pending records first; bounded, the writer might be what crashed
+	log_backend_getAsyncWriter().Flush(std::chrono::milliseconds(1000));
+
 	for (log_cleanup_ptr fptr: log_formatter_getCleanupFuncs()) {
 		fptr();
 	}
@@ -98,4 +441,3 @@ void log_backend_cleanup() {
 #ifdef __cplusplus
 } // extern "C"
 #endif
-
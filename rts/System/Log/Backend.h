@@ -40,6 +40,31 @@ void log_backend_registerCleanup(log_cleanup_ptr cleanupFunc);
  */
 void log_backend_unregisterCleanup(log_cleanup_ptr cleanupFunc);
 
+
+/**
+ * Hands formatted records to a dedicated writer thread instead of calling the
+ * sinks on the logging thread, which then only waits for the sinks when the
+ * queue of <queueSize> records (rounded up to a power of two) is full.
+ * In that case records below LOG_LEVEL_WARNING are dropped (and counted),
+ * the others wait for room.
+ * If <sectionRateLimit> is non-zero, at most that many records below
+ * LOG_LEVEL_WARNING are written per second and section.
+ */
+void log_backend_startAsync(unsigned int queueSize, unsigned int sectionRateLimit);
+
+/**
+ * Writes all pending records and stops the writer thread, if running.
+ * Also happens automatically at exit.
+ */
+void log_backend_stopAsync();
+
+/**
+ * Keeps the writer thread out of the sinks until unlocked, for sinks that
+ * forward records to a set of their own which is about to change.
+ */
+void log_backend_lockSinks();
+void log_backend_unlockSinks();
+
 ///@}
 
 #ifdef __cplusplus
@@ -4,6 +4,7 @@
  * This eventually prefixes log records with the current frame number.
  */
 
+#include "FramePrefixer.h"
 #include "System/MainDefines.h"
 
 #include <cstdarg>
@@ -17,14 +18,27 @@ extern "C" {
 // GlobalSynced makes sure this can not be dangling
 static int* frameNumRef = NULL;
 
+// set by the asynchronous log writer, see Backend.cpp
+static _threadlocal int recordFrameNum = LOG_FRAME_CURRENT;
+
 void log_framePrefixer_setFrameNumReference(int* frameNumReference)
 {
 	frameNumRef = frameNumReference;
 }
 
+int log_framePrefixer_getFrameNum()
+{
+	return ((frameNumRef != NULL)? *frameNumRef: -1);
+}
+
+void log_framePrefixer_setRecordFrameNum(int frameNum)
+{
+	recordFrameNum = frameNum;
+}
+
 size_t log_framePrefixer_createPrefix(char* result, size_t resultSize)
 {
-	if (frameNumRef == NULL) {
+	if (frameNumRef == NULL || recordFrameNum == -1) {
 		if (resultSize > 0) {
 			result[0] = '\0';
 			return 1;
@@ -32,7 +46,7 @@ size_t log_framePrefixer_createPrefix(char* result, size_t resultSize)
 		return 0;
 	}
 
-	return (SNPRINTF(result, resultSize, "[f=%07d] ", *frameNumRef));
+	return (SNPRINTF(result, resultSize, "[f=%07d] ", (recordFrameNum == LOG_FRAME_CURRENT)? *frameNumRef: recordFrameNum));
 }
 
 #ifdef __cplusplus
@@ -15,6 +15,20 @@ extern "C" {
  */
 void log_framePrefixer_setFrameNumReference(int* frameNumReference);
 
+/**
+ * Returns the current frame number, or -1 if it is not available.
+ */
+int log_framePrefixer_getFrameNum();
+
+/**
+ * Makes createPrefix use the given frame number (-1 for none) instead of the
+ * current one on the calling thread, for records that are written after the
+ * frame they were logged in. LOG_FRAME_CURRENT restores the default.
+ */
+void log_framePrefixer_setRecordFrameNum(int frameNum);
+
+#define LOG_FRAME_CURRENT (-2)
+
 /**
  * Fills a string containing the frame number, if it is available.
  * Else fils in the empty string.
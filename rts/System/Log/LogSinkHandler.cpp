@@ -16,9 +16,21 @@ static void log_sink_record_logSinkHandler(int level, const char* section, const
 
 
 
+namespace {
+	// records can be passed on by the async log writer thread, see Backend.h
+	struct ScopedSinksLock {
+		ScopedSinksLock() { log_backend_lockSinks(); }
+		~ScopedSinksLock() { log_backend_unlockSinks(); }
+	};
+}
+
+
+
 void LogSinkHandler::AddSink(ILogSink* logSink) {
 	assert(logSink != nullptr);
 
+	const ScopedSinksLock lock;
+
 	if (sinks.empty())
 		log_backend_registerSink(&log_sink_record_logSinkHandler);
 
@@ -27,6 +39,10 @@ void LogSinkHandler::AddSink(ILogSink* logSink) {
 
 void LogSinkHandler::RemoveSink(ILogSink* logSink) {
 	assert(logSink != nullptr);
+
+	// also waits until a record being passed to <logSink> is done
+	const ScopedSinksLock lock;
+
 	sinks.erase(logSink);
 
 	if (!sinks.empty())
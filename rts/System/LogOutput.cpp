@@ -6,6 +6,7 @@
 #include "Game/GameVersion.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/Log/Backend.h"
 #include "System/Log/DefaultFilter.h"
 #include "System/Log/FileSink.h"
 #include "System/Log/ILog.h"
@@ -43,6 +44,20 @@ CONFIG(int, LogRepeatLimit)
 	.defaultValue(10)
 	.description("Allow at most this many consecutive identical messages to be logged.");
 
+CONFIG(bool, LogAsync)
+	.defaultValue(false)
+	.description("Write log records from a dedicated thread, so that logging threads do not wait for the log file and console.");
+
+CONFIG(int, LogAsyncQueueSize)
+	.defaultValue(4096)
+	.minimumValue(64)
+	.description("Number of log records that can wait for the LogAsync writer thread. When full, records below warning level are dropped.");
+
+CONFIG(int, LogSectionRateLimit)
+	.defaultValue(0)
+	.minimumValue(0)
+	.description("With LogAsync, write at most this many records below warning level per second and log section (0 means unlimited).");
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -264,6 +279,9 @@ void CLogOutput::Initialize()
 	log_file_addLogFile(filePath.c_str(), NULL, LOG_LEVEL_ALL, configHandler->GetInt("LogFlushLevel"));
 	InitializeLogSections();
 
+	if (configHandler->GetBool("LogAsync"))
+		log_backend_startAsync(configHandler->GetInt("LogAsyncQueueSize"), configHandler->GetInt("LogSectionRateLimit"));
+
 	LOG("LogOutput initialized.");
 }
 
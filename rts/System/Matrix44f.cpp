@@ -392,6 +392,69 @@ float4 CMatrix44f::operator* (const float4 v) const
 }
 
 
+__FORCE_ALIGN_STACK__
+void CMatrix44f::TransformPoints(const float3* in, float3* out, size_t count) const
+{
+	const __m128 c0 = _mm_loadu_ps(&md[0][0]);
+	const __m128 c1 = _mm_loadu_ps(&md[1][0]);
+	const __m128 c2 = _mm_loadu_ps(&md[2][0]);
+	const __m128 c3 = _mm_loadu_ps(&md[3][0]);
+
+	for (size_t i = 0; i < count; i++) {
+		const float3 v = in[i];
+
+		// same evaluation order as operator*; c3 * 1.0f is exact
+		__m128 r;
+		r =               _mm_mul_ps(c0, _mm_set1_ps(v.x)) ;
+		r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(v.y)));
+		r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(v.z)));
+		r = _mm_add_ps(r, c3);
+
+		float fout[4];
+		_mm_storeu_ps(fout, r);
+		out[i] = float3(fout[0], fout[1], fout[2]);
+	}
+}
+
+__FORCE_ALIGN_STACK__
+void CMatrix44f::TransformVectors(const float3* in, float3* out, size_t count) const
+{
+	const __m128 c0 = _mm_loadu_ps(&md[0][0]);
+	const __m128 c1 = _mm_loadu_ps(&md[1][0]);
+	const __m128 c2 = _mm_loadu_ps(&md[2][0]);
+	// keep the w=0 term, adding it can still flip the sign of a zero
+	const __m128 c3 = _mm_mul_ps(_mm_loadu_ps(&md[3][0]), _mm_setzero_ps());
+
+	for (size_t i = 0; i < count; i++) {
+		const float3 v = in[i];
+
+		__m128 r;
+		r =               _mm_mul_ps(c0, _mm_set1_ps(v.x)) ;
+		r = _mm_add_ps(r, _mm_mul_ps(c1, _mm_set1_ps(v.y)));
+		r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_set1_ps(v.z)));
+		r = _mm_add_ps(r, c3);
+
+		float fout[4];
+		_mm_storeu_ps(fout, r);
+		out[i] = float3(fout[0], fout[1], fout[2]);
+	}
+}
+
+void CMatrix44f::MultiplyHierarchy(const CMatrix44f* in, const int* parents, CMatrix44f* out, size_t count)
+{
+	for (size_t i = 0; i < count; i++) {
+		assert(parents[i] < int(i));
+
+		if (parents[i] < 0) {
+			out[i] = in[i];
+			continue;
+		}
+
+		MatrixMatrixMultiplySSE(out[parents[i]], in[i], &out[i]);
+	}
+}
+
+
 void CMatrix44f::SetUpVector(const float3 up)
 {
 	float3 zdir(m[8], m[9], m[10]);
@@ -77,6 +77,18 @@ public:
 	float3 Mul(const float3 v) const { return ((*this) * v); }
 	float4 Mul(const float4 v) const { return ((*this) * v); }
 
+	/// batch point (w=1) and vector (w=0) multiply, <in> and <out> may alias
+	/// results are bitwise identical to Mul on each element (sync-safe)
+	void TransformPoints(const float3* in, float3* out, size_t count) const;
+	void TransformVectors(const float3* in, float3* out, size_t count) const;
+
+	/**
+	 * batch matrix multiply along a hierarchy: out[i] = out[parents[i]] * in[i]
+	 * (or in[i] if parents[i] is negative); every parent index must be smaller
+	 * than that of its children, results again match operator* exactly
+	 */
+	static void MultiplyHierarchy(const CMatrix44f* in, const int* parents, CMatrix44f* out, size_t count);
+
 	/// matrix multiply
 	CMatrix44f  operator  *  (const CMatrix44f& mat) const;
 	CMatrix44f& operator >>= (const CMatrix44f& mat);
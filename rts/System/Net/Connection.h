@@ -11,6 +11,22 @@
 namespace netcode
 {
 
+/**
+ * @brief link quality as measured by a connection, zero while unknown
+ */
+struct LinkStats
+{
+	/// smoothed round-trip time and its mean deviation, in milliseconds
+	float rtt = 0.0f;
+	float rttVar = 0.0f;
+	/// fraction of recent chunk transmissions that were resends
+	float lossRate = 0.0f;
+	/// current retransmission timeout, in milliseconds
+	float resendTimeout = 0.0f;
+	/// number of unacknowledged chunks allowed in flight
+	unsigned int sendWindow = 0;
+};
+
 /**
  * @brief Base class for connecting to various recievers / senders
  */
@@ -63,6 +79,7 @@ public:
 	virtual bool NeedsReconnect() = 0;
 
 	unsigned int GetDataReceived() const { return dataRecv; }
+	unsigned int GetDataSent() const { return dataSent; }
 	virtual unsigned int GetPacketQueueSize() const { return 0; }
 
 	virtual std::string Statistics() const = 0;
@@ -70,6 +87,7 @@ public:
 	virtual void Unmute() = 0;
 	virtual void Close(bool flush = false) = 0;
 	virtual void SetLossFactor(int factor) = 0;
+	virtual LinkStats GetLinkStats() const { return LinkStats(); }
 
 	/**
 	 * @brief update internals
@@ -2,8 +2,17 @@
 
 #include "UDPConnection.h"
 
+#include <algorithm>
+#include <array>
 #include <memory>
 #include <cinttypes>
+#include <cmath>
+#include <cstring>
+
+#ifdef __linux__
+	#include <sys/socket.h>
+	#include <cerrno>
+#endif
 
 
 #include "Socket.h"
@@ -29,6 +38,14 @@ static const unsigned udpMaxPacketSize = 4096;
 static const int maxChunkSize = 254;
 static const int chunksPerSec = 30;
 
+// NAKs address at most 256 chunks past the last acked one
+static const unsigned int minSendWindow = 64;
+static const unsigned int maxSendWindow = 256;
+
+// bounds of the adaptive retransmission timeout, in milliseconds
+static const float minResendTimeout = 50.0f;
+static const float maxResendTimeout = 2000.0f;
+
 
 
 #if NETWORK_TEST
@@ -129,6 +146,9 @@ public:
 	void Pack(std::vector<std::uint8_t>& _data) {
 		std::copy(_data.begin(), _data.end(), std::back_inserter(data));
 	}
+	void Pack(const std::vector<std::uint8_t>& _data) {
+		std::copy(_data.begin(), _data.end(), std::back_inserter(data));
+	}
 
 private:
 	std::vector<std::uint8_t>& data;
@@ -141,13 +161,52 @@ void Chunk::UpdateChecksum(CRC& crc) const {
 	crc << chunkNumber;
 	crc << (unsigned int)chunkSize;
 
-	if (!data.empty()) {
-		crc.Update(&data[0], data.size());
+	const std::vector<std::uint8_t>& payload = GetData();
+
+	if (!payload.empty()) {
+		crc.Update(&payload[0], payload.size());
 	}
 }
 
 
 
+const BroadcastGroup::SharedChunk* BroadcastGroup::FindChunk(const PacketList& queue, unsigned offset) const
+{
+	if (queue.empty())
+		return nullptr;
+
+	// newest first, the previous member has most likely just built it
+	for (unsigned int n = 0; n < NUM_CHUNKS; n++) {
+		const SharedChunk& chunk = chunks[(nextChunk + NUM_CHUNKS - 1 - n) % NUM_CHUNKS];
+
+		// slots are filled in order, the remaining ones are empty too
+		if (chunk.payload == nullptr)
+			break;
+
+		if (chunk.offset != offset || chunk.packets.front() != queue.front())
+			continue;
+		if (chunk.packets.size() > queue.size())
+			continue;
+		// a partially filled chunk only matches if there is nothing more to add
+		if (chunk.queueEnd && chunk.packets.size() != queue.size())
+			continue;
+		if (!std::equal(chunk.packets.begin(), chunk.packets.end(), queue.begin()))
+			continue;
+
+		return &chunk;
+	}
+
+	return nullptr;
+}
+
+void BroadcastGroup::AddChunk(SharedChunk&& chunk)
+{
+	chunks[nextChunk] = std::move(chunk);
+	nextChunk = (nextChunk + 1) % NUM_CHUNKS;
+}
+
+
+
 Packet::Packet(const unsigned char* data, unsigned length)
 {
 	Unpacker buf(data, length);
@@ -226,7 +285,7 @@ void Packet::Serialize(std::vector<std::uint8_t>& data)
 	for (auto ci = chunks.begin(); ci != chunks.end(); ++ci) {
 		buf.Pack((*ci)->chunkNumber);
 		buf.Pack((*ci)->chunkSize);
-		buf.Pack((*ci)->data);
+		buf.Pack((*ci)->GetData());
 	}
 }
 
@@ -292,12 +351,29 @@ void UDPConnection::Init()
 	numTotalGetDataCalls = 0;
 	#endif
 	currentPacketChunkNum = 0;
+	numSendBuffers = 0;
 
 	lastNak = -1;
 	sentOverhead = 0;
 	recvOverhead = 0;
 	fragmentBuffer = 0;
 	resentChunks = 0;
+	sharedChunks = 0;
+	sentChunks = 0;
+	outgoingOffset = 0;
+
+	roundTripTime = 0.0f;
+	roundTripVar = 0.0f;
+	lossRate = 0.0f;
+
+	sendWindow = maxSendWindow;
+	sendWindowGrowth = 0.0f;
+
+	lastWindowCutTime = spring_gettime();
+	lastLossRateTime = spring_gettime();
+
+	lossRateSentChunks = 0;
+	lossRateResentChunks = 0;
 	sentPackets = recvPackets = 0;
 	droppedChunks = 0;
 	mtu = globalConfig->mtu;
@@ -431,6 +507,8 @@ void UDPConnection::Update()
 	}
 	#endif
 
+	UpdateLossRate();
+
 	if (!sharedSocket && !closed) {
 		// duplicated code with UDPListener
 		netservice.poll();
@@ -532,6 +610,10 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 				}
 			}
 		}
+
+		// the other side is missing chunks, back off
+		if (incoming.nakType != 0)
+			ReduceSendWindow();
 	}
 
 	for (auto ci = incoming.chunks.begin(); ci != incoming.chunks.end(); ++ci) {
@@ -639,6 +721,9 @@ void UDPConnection::Flush(const bool forced)
 		std::uint8_t buffer[udpMaxPacketSize];
 		unsigned pos = 0;
 
+		// packets copied into buffer, recorded for the broadcast group
+		BroadcastGroup::SharedChunk chunkSource;
+
 		// Manually fragment packets to respect configured UDP_MTU.
 		// This is an attempt to fix the bug where players drop out of the game if
 		// someone in the game gives a large order.
@@ -650,7 +735,12 @@ void UDPConnection::Flush(const bool forced)
 			sendMore |= ((globalConfig->linkOutgoingBandwidth <= 0) || partialPacket || forced);
 
 			if (!outgoingData.empty() && sendMore) {
-				std::shared_ptr<const RawPacket>& packet = *(outgoingData.begin());
+				if (pos == 0 && ShareChunk()) {
+					partialPacket = (outgoingOffset > 0);
+					continue;
+				}
+
+				const std::shared_ptr<const RawPacket>& packet = *(outgoingData.begin());
 
 				if (!partialPacket && !ProtocolDef::GetInstance()->IsValidPacket(packet->data, packet->length)) {
 					LOG_L(L_ERROR,
@@ -659,25 +749,40 @@ void UDPConnection::Flush(const bool forced)
 						packet->length);
 					outgoingData.pop_front();
 				} else {
-					const unsigned numBytes = std::min((unsigned)maxChunkSize - pos, packet->length);
+					const unsigned numBytes = std::min((unsigned)maxChunkSize - pos, packet->length - outgoingOffset);
 
 					assert(packet->length > 0);
-					memcpy(buffer + pos, packet->data, numBytes);
+					memcpy(buffer + pos, packet->data + outgoingOffset, numBytes);
+
+					if (chunkSource.packets.empty())
+						chunkSource.offset = outgoingOffset;
+
+					chunkSource.packets.push_back(packet);
+
 					pos += numBytes;
+					outgoingOffset += numBytes;
 					outgoing.DataSent(numBytes, true);
-					partialPacket = (numBytes != packet->length);
+					partialPacket = (outgoingOffset != packet->length);
+					chunkSource.endOffset = outgoingOffset;
 
-					if (partialPacket) {
-						// partially transfered
-						packet.reset(new RawPacket(packet->data + numBytes, packet->length - numBytes));
-					} else {
+					if (!partialPacket) {
 						// full packet copied
 						outgoingData.pop_front();
+						outgoingOffset = 0;
 					}
 				}
 			}
 			if ((pos > 0) && (outgoingData.empty() || (pos == maxChunkSize) || !sendMore)) {
 				CreateChunk(buffer, pos, currentPacketChunkNum++);
+
+				// chunks cut short by the bandwidth limit are of no use to others
+				if (broadcastGroup != nullptr && !chunkSource.packets.empty() && (pos == maxChunkSize || outgoingData.empty())) {
+					chunkSource.payload = newChunks.back()->sharedData;
+					chunkSource.queueEnd = (pos != maxChunkSize);
+					broadcastGroup->AddChunk(std::move(chunkSource));
+				}
+
+				chunkSource = BroadcastGroup::SharedChunk();
 				pos = 0;
 			}
 		} while (!outgoingData.empty() && sendMore);
@@ -730,8 +835,10 @@ std::string UDPConnection::Statistics() const
 			dataSent, sentPackets, spring::SafeDivide(dataSent, sentPackets));
 	msg += spring::format("\tRelative protocol overhead: %f up, %f down\n",
 			spring::SafeDivide(sentOverhead, dataSent), spring::SafeDivide(recvOverhead, dataRecv) );
-	msg += spring::format("\t%u incoming chunks dropped, %u outgoing chunks resent\n",
-			droppedChunks, resentChunks);
+	msg += spring::format("\t%u incoming chunks dropped, %u outgoing chunks resent, %u shared\n",
+			droppedChunks, resentChunks, sharedChunks);
+	msg += spring::format("\tRound-trip time %.1fms (+-%.1fms), loss rate %.3f, send window %u chunks\n",
+			roundTripTime, roundTripVar, lossRate, sendWindow);
 	return msg;
 }
 
@@ -755,14 +862,48 @@ void UDPConnection::SetMTU(unsigned mtu2)
 void UDPConnection::CreateChunk(const unsigned char* data, const unsigned length, const int packetNum)
 {
 	assert((length > 0) && (length < 255));
+	CreateChunk(std::make_shared< std::vector<std::uint8_t> >(data, data + length), packetNum);
+}
+
+void UDPConnection::CreateChunk(BroadcastGroup::PayloadPtr payload, const int packetNum)
+{
 	ChunkPtr buf(new Chunk);
 	buf->chunkNumber = packetNum;
-	buf->chunkSize = length;
-	std::copy(data, data+length, std::back_inserter(buf->data));
+	buf->chunkSize = payload->size();
+	buf->sharedData = payload;
 	newChunks.push_back(buf);
 	lastChunkCreatedTime = spring_gettime();
 }
 
+bool UDPConnection::ShareChunk()
+{
+	if (broadcastGroup == nullptr)
+		return false;
+
+	const BroadcastGroup::SharedChunk* chunk = broadcastGroup->FindChunk(outgoingData, outgoingOffset);
+
+	if (chunk == nullptr)
+		return false;
+
+	for (size_t n = 1; n < chunk->packets.size(); n++) {
+		outgoingData.pop_front();
+	}
+
+	// the last packet may continue in the next chunk
+	if (chunk->endOffset == outgoingData.front()->length) {
+		outgoingData.pop_front();
+		outgoingOffset = 0;
+	} else {
+		outgoingOffset = chunk->endOffset;
+	}
+
+	outgoing.DataSent(chunk->payload->size(), true);
+	CreateChunk(chunk->payload, currentPacketChunkNum++);
+
+	++sharedChunks;
+	return true;
+}
+
 void UDPConnection::SendIfNecessary(bool flushed)
 {
 	const spring_time curTime = spring_gettime();
@@ -794,7 +935,10 @@ void UDPConnection::SendIfNecessary(bool flushed)
 			}
 		}
 
-		if ((numContinuous < 8) && (curTime - lastNakTime) > spring_msecs(200 >> netLossFactor)) {
+		// asking again before a resent chunk could have arrived only creates duplicates
+		const spring_time nakInterval = spring_msecs(std::max(200 >> netLossFactor, int(roundTripTime)));
+
+		if ((numContinuous < 8) && (curTime - lastNakTime) > nakInterval) {
 			nak = std::min(dropped.size(), (size_t)127);
 			// needs 1 byte per requested packet, so do not spam to often
 			lastNakTime = curTime;
@@ -803,13 +947,17 @@ void UDPConnection::SendIfNecessary(bool flushed)
 		}
 	}
 
+	const spring_time resendTimeout = GetResendTimeout();
+
 	if (!unackedChunks.empty() &&
-		(curTime - lastChunkCreatedTime) > spring_msecs(400 >> netLossFactor) &&
-		(curTime - lastUnackResentTime) > spring_msecs(400 >> netLossFactor)) {
+		(curTime - lastChunkCreatedTime) > resendTimeout &&
+		(curTime - lastUnackResentTime) > resendTimeout) {
 		// resend last packet if we didn't get an ack within reasonable time
 		// and don't plan sending out a new chunk either
-		if (newChunks.empty())
+		if (newChunks.empty()) {
 			RequestResend(*unackedChunks.rbegin());
+			ReduceSendWindow();
+		}
 		lastUnackResentTime = curTime;
 	}
 
@@ -871,7 +1019,7 @@ void UDPConnection::SendIfNecessary(bool flushed)
 					((buf.GetSize() +
 					(((netLossFactor == MIN_LOSS_FACTOR) || (rev == 0)) ? resIter->second->GetSize() : ((rev == 1) ? resRevIter->second->GetSize() : resMidIter->second->GetSize())) // resend chunk size
 					) <= mtu);
-				bool canSendNew = !newChunks.empty() && ((buf.GetSize() + newChunks[0]->GetSize()) <= mtu);
+				bool canSendNew = !newChunks.empty() && ((buf.GetSize() + newChunks[0]->GetSize()) <= mtu) && (unackedChunks.size() < sendWindow);
 
 				if (!canResend && !canSendNew)
 					break;
@@ -907,10 +1055,13 @@ void UDPConnection::SendIfNecessary(bool flushed)
 						}
 						rev = (rev + 1) % 4;
 					}
+					buf.chunks.back()->resent = true;
 					++resentChunks;
 					--maxResend;
 					sent = true;
 				} else if (!resend && canSendNew) {
+					newChunks[0]->sendTime = curTime;
+					++sentChunks;
 					buf.chunks.push_back(newChunks[0]);
 					unackedChunks.push_back(newChunks[0]);
 					newChunks.pop_front();
@@ -925,6 +1076,8 @@ void UDPConnection::SendIfNecessary(bool flushed)
 			SendPacket(buf);
 		}
 
+		FlushSendBuffers();
+
 		if (netLossFactor != MIN_LOSS_FACTOR) {
 			// on a lossy connection the packet will be sent multiple times
 			for (int i = unackPrevSize; i < unackedChunks.size(); ++i)
@@ -935,29 +1088,101 @@ void UDPConnection::SendIfNecessary(bool flushed)
 
 void UDPConnection::SendPacket(Packet& pkt)
 {
-	std::vector<std::uint8_t> data;
+	// buffers are kept around, FlushSendBuffers sends them all at once
+	if (numSendBuffers == sendBuffers.size())
+		sendBuffers.emplace_back();
+
+	std::vector<std::uint8_t>& data = sendBuffers[numSendBuffers++];
+
+	data.clear();
 	pkt.Serialize(data);
 
 	outgoing.DataSent(data.size());
 	lastPacketSendTime = spring_gettime();
+}
+
+void UDPConnection::FlushSendBuffers()
+{
+#if (defined(__linux__) && !NETWORK_TEST)
+	std::array<mmsghdr, SEND_BATCH_SIZE> msgs;
+	std::array<iovec, SEND_BATCH_SIZE> iovecs;
+
+	for (size_t i = 0; i < numSendBuffers; ) {
+		const size_t numMsgs = std::min(numSendBuffers - i, size_t(SEND_BATCH_SIZE));
+
+		for (size_t n = 0; n < numMsgs; n++) {
+			std::memset(&msgs[n], 0, sizeof(msgs[n]));
+
+			iovecs[n].iov_base = sendBuffers[i + n].data();
+			iovecs[n].iov_len = sendBuffers[i + n].size();
+
+			msgs[n].msg_hdr.msg_name = addr.data();
+			msgs[n].msg_hdr.msg_namelen = addr.size();
+			msgs[n].msg_hdr.msg_iov = &iovecs[n];
+			msgs[n].msg_hdr.msg_iovlen = 1;
+		}
+
+		const int numSent = sendmmsg(mySocket->native_handle(), msgs.data(), numMsgs, MSG_DONTWAIT);
+
+		if (numSent <= 0) {
+			asio::error_code err(errno, asio::system_category());
+			CheckErrorCode(err);
+			break;
+		}
+
+		for (int n = 0; n < numSent; n++) {
+			dataSent += sendBuffers[i + n].size();
+			++sentPackets;
+		}
+
+		i += numSent;
+	}
+#else
 	ip::udp::socket::message_flags flags = 0;
 	asio::error_code err;
 
-	EMULATE_LATENCY( !EMULATE_PACKET_LOSS( LOSS_COUNTER ) ) {
-		mySocket->send_to(buffer(data), addr, flags, err);
-	}
+	for (size_t i = 0; i < numSendBuffers; i++) {
+		const std::vector<std::uint8_t>& data = sendBuffers[i];
 
-	if (CheckErrorCode(err))
-		return;
+		EMULATE_LATENCY( !EMULATE_PACKET_LOSS( LOSS_COUNTER ) ) {
+			mySocket->send_to(buffer(data), addr, flags, err);
+		}
+
+		if (CheckErrorCode(err))
+			break;
+
+		dataSent += data.size();
+		++sentPackets;
+	}
+#endif
 
-	dataSent += data.size();
-	++sentPackets;
+	numSendBuffers = 0;
 }
 
 void UDPConnection::AckChunks(int lastAck)
 {
-	while (!unackedChunks.empty() && (lastAck >= (*unackedChunks.begin())->chunkNumber))
+	const spring_time curTime = spring_gettime();
+
+	spring_time sampleTime;
+	unsigned int numAcked = 0;
+
+	while (!unackedChunks.empty() && (lastAck >= (*unackedChunks.begin())->chunkNumber)) {
+		// only chunks sent exactly once give unambiguous samples, the newest one is enough
+		if (!unackedChunks.front()->resent)
+			sampleTime = unackedChunks.front()->sendTime;
+
 		unackedChunks.pop_front();
+		numAcked += 1;
+	}
+
+	if (spring_istime(sampleTime))
+		UpdateRoundTripTime((curTime - sampleTime).toMilliSecsf());
+
+	// grow by one chunk per window's worth of acks
+	if ((sendWindowGrowth += (numAcked / float(sendWindow))) >= 1.0f) {
+		sendWindow = std::min(sendWindow + 1, maxSendWindow);
+		sendWindowGrowth = 0.0f;
+	}
 
 	// resend requested and later acked, happens every now and then
 	while (!resendRequested.empty() && lastAck >= resendRequested.begin()->first)
@@ -971,6 +1196,78 @@ void UDPConnection::RequestResend(ChunkPtr ptr)
 		resendRequested[ptr->chunkNumber] = ptr;
 }
 
+void UDPConnection::UpdateRoundTripTime(float sample)
+{
+	sample = std::max(sample, 1.0f);
+
+	if (roundTripTime <= 0.0f) {
+		roundTripTime = sample;
+		roundTripVar = sample * 0.5f;
+		return;
+	}
+
+	// RFC 6298 smoothing
+	roundTripVar = roundTripVar * 0.75f + std::fabs(roundTripTime - sample) * 0.25f;
+	roundTripTime = roundTripTime * 0.875f + sample * 0.125f;
+}
+
+void UDPConnection::ReduceSendWindow()
+{
+	const spring_time curTime = spring_gettime();
+
+	// NAKs keep coming until the missing chunk arrives, count them as one loss
+	if ((curTime - lastWindowCutTime) < spring_msecs(std::max(200, int(roundTripTime))))
+		return;
+
+	sendWindow = std::max(sendWindow / 2, minSendWindow);
+	sendWindowGrowth = 0.0f;
+	lastWindowCutTime = curTime;
+}
+
+void UDPConnection::UpdateLossRate()
+{
+	const spring_time curTime = spring_gettime();
+
+	if ((curTime - lastLossRateTime) < spring_secs(1))
+		return;
+
+	const unsigned int numSent = sentChunks - lossRateSentChunks;
+	const unsigned int numResent = resentChunks - lossRateResentChunks;
+
+	lossRate *= 0.75f;
+
+	if ((numSent + numResent) > 0)
+		lossRate += (numResent / float(numSent + numResent)) * 0.25f;
+
+	lossRateSentChunks = sentChunks;
+	lossRateResentChunks = resentChunks;
+	lastLossRateTime = curTime;
+}
+
+spring_time UDPConnection::GetResendTimeout() const
+{
+	// fixed timer until the first sample arrives
+	if (roundTripTime <= 0.0f)
+		return spring_msecs(400 >> netLossFactor);
+
+	const float timeout = std::min(std::max(roundTripTime + 4.0f * roundTripVar, minResendTimeout), maxResendTimeout);
+
+	return spring_msecs(int(timeout) >> netLossFactor);
+}
+
+LinkStats UDPConnection::GetLinkStats() const
+{
+	LinkStats stats;
+
+	stats.rtt = roundTripTime;
+	stats.rttVar = roundTripVar;
+	stats.lossRate = lossRate;
+	stats.resendTimeout = GetResendTimeout().toMilliSecsf();
+	stats.sendWindow = sendWindow;
+
+	return stats;
+}
+
 UDPConnection::BandwidthUsage::BandwidthUsage()
 	: lastTime(0)
 	, trafficSinceLastTime(1)
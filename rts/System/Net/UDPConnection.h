@@ -4,6 +4,7 @@
 #define _UDP_CONNECTION_H
 
 #include <asio/ip/udp.hpp>
+#include <array>
 #include <map>
 #include <memory>
 #include <deque>
@@ -30,16 +31,66 @@ namespace netcode {
 class Chunk
 {
 public:
-	unsigned GetSize() const { return (data.size() + headerSize); }
+	unsigned GetSize() const { return (GetData().size() + headerSize); }
+	const std::vector<std::uint8_t>& GetData() const { return ((sharedData != nullptr)? *sharedData: data); }
 	void UpdateChecksum(CRC& crc) const;
 	static const unsigned maxSize = 254;
 	static const unsigned headerSize = 5;
 	std::int32_t chunkNumber;
 	std::uint8_t chunkSize;
+	/// payload of received chunks
 	std::vector<std::uint8_t> data;
+	/// payload of outgoing chunks, can be shared with other connections
+	std::shared_ptr<const std::vector<std::uint8_t>> sharedData;
+
+	/// when an outgoing chunk was first sent, and whether it was sent again since
+	spring_time sendTime;
+	bool resent = false;
 };
 typedef std::shared_ptr<Chunk> ChunkPtr;
 
+
+/**
+ * @brief chunk payloads shared between connections sending the same packets
+ *
+ * Every member remembers which packets went into the chunks it builds. When
+ * another member's outgoing queue starts with the same packets (as it does for
+ * anything CGameServer::Broadcast sends), that member takes the payload over
+ * instead of copying the data again; only chunk numbers and ack/resend state
+ * stay per connection.
+ */
+class BroadcastGroup
+{
+public:
+	typedef std::shared_ptr<const std::vector<std::uint8_t>> PayloadPtr;
+	typedef std::list< std::shared_ptr<const RawPacket> > PacketList;
+
+	struct SharedChunk {
+		/// packets (partially) contained in payload, in order
+		std::vector< std::shared_ptr<const RawPacket> > packets;
+		PayloadPtr payload;
+
+		/// where the payload starts in the first packet and ends in the last
+		unsigned offset = 0;
+		unsigned endOffset = 0;
+
+		/// payload was cut short by the end of the queue rather than its size
+		bool queueEnd = false;
+	};
+
+	/// @return a chunk built from the front of queue, or nullptr
+	const SharedChunk* FindChunk(const PacketList& queue, unsigned offset) const;
+	void AddChunk(SharedChunk&& chunk);
+
+private:
+	/// members flush one after another, only recent chunks are worth keeping
+	static constexpr unsigned int NUM_CHUNKS = 64;
+
+	std::array<SharedChunk, NUM_CHUNKS> chunks;
+
+	unsigned int nextChunk = 0;
+};
+
 class Packet
 {
 public:
@@ -122,6 +173,8 @@ public:
 	void Unmute() { muted = false; }
 	void Close(bool flush);
 	void SetLossFactor(int factor);
+	LinkStats GetLinkStats() const;
+	void SetBroadcastGroup(std::shared_ptr<BroadcastGroup> group) { broadcastGroup = group; }
 
 	const asio::ip::udp::endpoint &GetEndpoint() const { return addr; }
 
@@ -138,11 +191,27 @@ private:
 	/// add header to data and send it
 	void CreateChunk(const unsigned char* data, const unsigned length,
 			const int packetNum);
+	void CreateChunk(BroadcastGroup::PayloadPtr payload, const int packetNum);
+	/// take the next chunk from the broadcast group, if any member built it
+	bool ShareChunk();
 	void SendIfNecessary(bool flushed);
 	void AckChunks(int lastAck);
 
 	void RequestResend(ChunkPtr ptr);
+
+	/// feed one round-trip sample (in milliseconds) into the estimator
+	void UpdateRoundTripTime(float sample);
+	/// halve the send window, at most once per round-trip
+	void ReduceSendWindow();
+	void UpdateLossRate();
+
+	spring_time GetResendTimeout() const;
+	/// serialize pkt into a send buffer
 	void SendPacket(Packet& pkt);
+	/// send all buffered packets, through sendmmsg where available
+	void FlushSendBuffers();
+
+	static constexpr unsigned int SEND_BATCH_SIZE = 32;
 
 	spring_time lastChunkCreatedTime;
 	spring_time lastPacketSendTime;
@@ -174,6 +243,10 @@ private:
 
 	/// outgoing stuff (pure data without header) waiting to be sent
 	packetList outgoingData;
+	/// bytes of the first outgoing packet that are already in a chunk
+	unsigned outgoingOffset;
+
+	std::shared_ptr<BroadcastGroup> broadcastGroup;
 	/// packets we have received but not yet read
 	packetMap waitingPackets;
 
@@ -202,6 +275,10 @@ private:
 	/// Our socket
 	std::shared_ptr<asio::ip::udp::socket> mySocket;
 
+	/// serialized packets of the current SendIfNecessary pass, reused by the next
+	std::vector< std::vector<std::uint8_t> > sendBuffers;
+	size_t numSendBuffers;
+
 	RawPacket* fragmentBuffer;
 
 	// Traffic statistics and stuff
@@ -220,6 +297,27 @@ private:
 	/// packets that are resent
 	unsigned int resentChunks;
 	unsigned int droppedChunks;
+	/// chunk payloads taken over from the broadcast group
+	unsigned int sharedChunks;
+	/// chunks sent for the first time
+	unsigned int sentChunks;
+
+	/// smoothed round-trip time and its mean deviation (in ms), zero until measured
+	float roundTripTime;
+	float roundTripVar;
+	/// fraction of chunk transmissions that were resends, smoothed over a few seconds
+	float lossRate;
+
+	/// maximum number of unacked chunks; halved on loss, grows with acks
+	unsigned int sendWindow;
+	float sendWindowGrowth;
+
+	spring_time lastWindowCutTime;
+	spring_time lastLossRateTime;
+
+	/// counter values when lossRate was last updated
+	unsigned int lossRateSentChunks;
+	unsigned int lossRateResentChunks;
 
 	unsigned int sentOverhead, recvOverhead;
 	unsigned int sentPackets, recvPackets;
@@ -7,11 +7,21 @@
 #endif
 #include "System/Misc/NonCopyable.h"
 
+#include <array>
 #include <memory>
 #include <asio.hpp>
 #include <cinttypes>
+#include <cstring>
 #include <queue>
 
+#ifdef __linux__
+	#include <sys/socket.h>
+	#include <cerrno>
+#endif
+#ifndef _WIN32
+	#include <sys/select.h>
+#endif
+
 
 #include "ProtocolDef.h"
 #include "UDPConnection.h"
@@ -25,7 +35,9 @@ namespace netcode
 {
 using namespace asio;
 
-UDPListener::UDPListener(int port, const std::string& ip): acceptNewConnections(false)
+UDPListener::UDPListener(int port, const std::string& ip)
+	: acceptNewConnections(false)
+	, broadcastGroup(std::make_shared<BroadcastGroup>())
 {
 	SocketPtr socket;
 
@@ -115,6 +127,9 @@ std::string UDPListener::TryBindSocket(int port, SocketPtr* socket, const std::s
 void UDPListener::Update() {
 	netservice.poll();
 
+#ifdef __linux__
+	ReceiveBatched();
+#else
 	size_t bytes_avail = 0;
 
 	while ((bytes_avail = mySocket->available()) > 0) {
@@ -126,53 +141,12 @@ void UDPListener::Update() {
 
 		const size_t bytesReceived = mySocket->receive_from(asio::buffer(buffer), sender_endpoint, flags, err);
 
-		const auto ci = connMap.find(sender_endpoint);
-		const bool knownConnection = (ci != connMap.end());
-
-		if (knownConnection && ci->second.expired())
-			continue;
-
 		if (CheckErrorCode(err))
 			break;
 
-		if (bytesReceived < Packet::headerSize)
-			continue;
-
-		Packet data(&buffer[0], bytesReceived);
-
-		if (knownConnection) {
-			ci->second.lock()->ProcessRawPacket(data);
-		} else {
-			// still have the packet (means no connection with the sender's address found)
-			if (acceptNewConnections && data.lastContinuous == -1 && data.nakType == 0)	{
-				if (!data.chunks.empty() && (*data.chunks.begin())->chunkNumber == 0) {
-					// new client wants to connect
-					std::shared_ptr<UDPConnection> incoming(new UDPConnection(mySocket, sender_endpoint));
-					waiting.push(incoming);
-					connMap[sender_endpoint] = incoming;
-					incoming->ProcessRawPacket(data);
-				}
-			} else {
-				const asio::ip::address& senderAddr = sender_endpoint.address();
-				const std::string& senderIP = senderAddr.to_string();
-
-				if (dropMap.find(senderIP) == dropMap.end()) {
-					LOG_L(L_DEBUG, "[UDPListener::%s] dropping packet from unknown IP: [%s]:%i", __func__, senderIP.c_str(), sender_endpoint.port());
-					dropMap[senderIP] = 0;
-				} else {
-					dropMap[senderIP] += 1;
-				}
-
-			#ifdef DEBUG
-				std::string conns;
-				for (auto it = connMap.cbegin(); it != connMap.cend(); ++it) {
-					conns += spring::format(" [%s]:%i;", it->first.address().to_string().c_str(),it->first.port());
-				}
-				LOG_L(L_DEBUG, "[UDPListener::%s] open connections: %s", __func__, conns.c_str());
-			#endif
-			}
-		}
+		ProcessDatagram(buffer.data(), bytesReceived, sender_endpoint);
 	}
+#endif
 
 	for (auto i = connMap.cbegin(); i != connMap.cend(); ) {
 		if (i->second.expired()) {
@@ -185,6 +159,106 @@ void UDPListener::Update() {
 	}
 }
 
+void UDPListener::ProcessDatagram(const std::uint8_t* buffer, size_t bytesReceived, const ip::udp::endpoint& sender_endpoint)
+{
+	const auto ci = connMap.find(sender_endpoint);
+	const bool knownConnection = (ci != connMap.end());
+
+	if (knownConnection && ci->second.expired())
+		return;
+
+	if (bytesReceived < Packet::headerSize)
+		return;
+
+	Packet data(buffer, bytesReceived);
+
+	if (knownConnection) {
+		ci->second.lock()->ProcessRawPacket(data);
+		return;
+	}
+
+	// still have the packet (means no connection with the sender's address found)
+	if (acceptNewConnections && data.lastContinuous == -1 && data.nakType == 0)	{
+		if (!data.chunks.empty() && (*data.chunks.begin())->chunkNumber == 0) {
+			// new client wants to connect
+			std::shared_ptr<UDPConnection> incoming(new UDPConnection(mySocket, sender_endpoint));
+			waiting.push(incoming);
+			connMap[sender_endpoint] = incoming;
+			incoming->ProcessRawPacket(data);
+		}
+	} else {
+		const asio::ip::address& senderAddr = sender_endpoint.address();
+		const std::string& senderIP = senderAddr.to_string();
+
+		if (dropMap.find(senderIP) == dropMap.end()) {
+			LOG_L(L_DEBUG, "[UDPListener::%s] dropping packet from unknown IP: [%s]:%i", __func__, senderIP.c_str(), sender_endpoint.port());
+			dropMap[senderIP] = 0;
+		} else {
+			dropMap[senderIP] += 1;
+		}
+
+	#ifdef DEBUG
+		std::string conns;
+		for (auto it = connMap.cbegin(); it != connMap.cend(); ++it) {
+			conns += spring::format(" [%s]:%i;", it->first.address().to_string().c_str(),it->first.port());
+		}
+		LOG_L(L_DEBUG, "[UDPListener::%s] open connections: %s", __func__, conns.c_str());
+	#endif
+	}
+}
+
+#ifdef __linux__
+void UDPListener::ReceiveBatched()
+{
+	// drain the socket with as few syscalls as possible, one buffer per datagram
+	std::array<mmsghdr, RECV_BATCH_SIZE> msgs;
+	std::array<iovec, RECV_BATCH_SIZE> iovecs;
+	std::array<sockaddr_storage, RECV_BATCH_SIZE> addrs;
+
+	recvBuffer.resize(RECV_BATCH_SIZE * RECV_BUFFER_SIZE);
+
+	while (true) {
+		for (unsigned int n = 0; n < RECV_BATCH_SIZE; n++) {
+			std::memset(&msgs[n], 0, sizeof(msgs[n]));
+
+			iovecs[n].iov_base = &recvBuffer[n * RECV_BUFFER_SIZE];
+			iovecs[n].iov_len = RECV_BUFFER_SIZE;
+
+			msgs[n].msg_hdr.msg_name = &addrs[n];
+			msgs[n].msg_hdr.msg_namelen = sizeof(addrs[n]);
+			msgs[n].msg_hdr.msg_iov = &iovecs[n];
+			msgs[n].msg_hdr.msg_iovlen = 1;
+		}
+
+		const int numMsgs = recvmmsg(mySocket->native_handle(), msgs.data(), RECV_BATCH_SIZE, MSG_DONTWAIT, nullptr);
+
+		if (numMsgs < 0) {
+			asio::error_code err(errno, asio::system_category());
+
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+				CheckErrorCode(err);
+
+			break;
+		}
+
+		for (int n = 0; n < numMsgs; n++) {
+			ip::udp::endpoint sender_endpoint;
+
+			if (msgs[n].msg_hdr.msg_namelen > sender_endpoint.capacity())
+				continue;
+
+			std::memcpy(sender_endpoint.data(), &addrs[n], msgs[n].msg_hdr.msg_namelen);
+			sender_endpoint.resize(msgs[n].msg_hdr.msg_namelen);
+
+			ProcessDatagram(&recvBuffer[n * RECV_BUFFER_SIZE], msgs[n].msg_len, sender_endpoint);
+		}
+
+		if (numMsgs < int(RECV_BATCH_SIZE))
+			break;
+	}
+}
+#endif
+
 std::shared_ptr<UDPConnection> UDPListener::SpawnConnection(const std::string& ip, const unsigned port)
 {
 	std::shared_ptr<UDPConnection> newConn(new UDPConnection(mySocket, ip::udp::endpoint(WrapIP(ip), port)));
@@ -217,6 +291,7 @@ std::shared_ptr<UDPConnection> UDPListener::AcceptConnection()
 	std::shared_ptr<UDPConnection> newConn = waiting.front();
 	waiting.pop();
 	connMap[newConn->GetEndpoint()] = newConn;
+	newConn->SetBroadcastGroup(broadcastGroup);
 	return newConn;
 }
 
@@ -225,6 +300,22 @@ void UDPListener::RejectConnection()
 	waiting.pop();
 }
 
+bool UDPListener::WaitForData(int timeout) const {
+	// asio offers no blocking wait with a deadline on synchronous sockets
+	const auto handle = mySocket->native_handle();
+
+	fd_set readSet;
+	FD_ZERO(&readSet);
+	FD_SET(handle, &readSet);
+
+	timeval tv;
+	tv.tv_sec = timeout / 1000;
+	tv.tv_usec = (timeout % 1000) * 1000;
+
+	// the first argument is ignored by winsock
+	return (select(int(handle) + 1, &readSet, nullptr, nullptr, &tv) > 0);
+}
+
 void UDPListener::UpdateConnections() {
 	for (auto i = connMap.begin(); i != connMap.end(); ) {
 		std::shared_ptr<UDPConnection> uc = i->second.lock();
@@ -6,13 +6,16 @@
 #include "System/Misc/NonCopyable.h"
 #include <memory>
 #include <asio/ip/udp.hpp>
+#include <cstdint>
 #include <map>
 #include <queue>
 #include <string>
+#include <vector>
 
 namespace netcode
 {
 class UDPConnection;
+class BroadcastGroup;
 typedef std::shared_ptr<asio::ip::udp::socket> SocketPtr;
 
 /**
@@ -56,6 +59,13 @@ public:
 	 */
 	void Update();
 
+	/**
+	 * @brief Block until the socket has data to read
+	 * @param  timeout maximum number of milliseconds to wait
+	 * @return false if the timeout passed without data arriving
+	 */
+	bool WaitForData(int timeout) const;
+
 	/**
 	 * @brief Initiate a connection
 	 * Make a new connection to ip:port. It will be pushed back in conn.
@@ -76,6 +86,20 @@ public:
 	void RejectConnection();
 	void UpdateConnections(); // Updates connections when the endpoint has been reconnected
 
+private:
+	/// hand one received datagram to its connection, or open a new one
+	void ProcessDatagram(const std::uint8_t* buffer, size_t bytesReceived, const asio::ip::udp::endpoint& sender_endpoint);
+
+#ifdef __linux__
+	/// read all pending datagrams through recvmmsg, RECV_BATCH_SIZE per call
+	void ReceiveBatched();
+
+	static constexpr unsigned int RECV_BATCH_SIZE = 16;
+	static constexpr unsigned int RECV_BUFFER_SIZE = 65536;
+
+	std::vector<std::uint8_t> recvBuffer;
+#endif
+
 private:
 	/**
 	 * @brief Do we accept packets from unknown sources?
@@ -92,6 +116,9 @@ private:
 	std::map< std::string, size_t> dropMap;
 
 	std::queue< std::shared_ptr<UDPConnection> > waiting;
+
+	/// shared by all accepted connections
+	std::shared_ptr<BroadcastGroup> broadcastGroup;
 };
 
 }
@@ -1,9 +1,9 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 
+#include <algorithm>
+
 #include "System/Object.h"
-#include "System/ContainerUtil.h"
-#include "System/creg/STL_Map.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/CrashHandler.h"
 
@@ -15,23 +15,49 @@ CR_REG_METADATA(CObject, (
 	CR_MEMBER(detached),
 
 	CR_MEMBER(listening),
-	CR_MEMBER(listeners),
-	CR_MEMBER(listenersDepTbl),
-	CR_MEMBER(listeningDepTbl)
+	CR_MEMBER(listeners)
+))
+
+CR_BIND(CObject::Dependence, )
+CR_REG_METADATA_SUB(CObject, Dependence, (
+	CR_MEMBER(obj),
+	CR_MEMBER(type)
 ))
 
 std::atomic<std::int64_t> CObject::cur_sync_id(0);
 
 
 
-static bool VectorInsertSorted(std::vector<CObject*>& v, CObject* o)
+static bool DependenceLess(const CObject::Dependence& a, const CObject::Dependence& b)
 {
-	return (spring::VectorInsertUniqueSorted(v, o, [](const CObject* a, const CObject* b) { return (a->GetSyncID() < b->GetSyncID()); }));
+	if (a.obj->GetSyncID() != b.obj->GetSyncID())
+		return (a.obj->GetSyncID() < b.obj->GetSyncID());
+
+	return (a.type < b.type);
 }
 
-static bool VectorEraseSorted(std::vector<CObject*>& v, CObject* o)
+static bool VectorInsertSorted(CObject::TDependenceList& v, CObject* o, int type)
 {
-	return (spring::VectorEraseUniqueSorted(v, o, [](const CObject* a, const CObject* b) { return (a->GetSyncID() < b->GetSyncID()); }));
+	const CObject::Dependence d = {o, type};
+	const auto it = std::lower_bound(v.begin(), v.end(), d, DependenceLess);
+
+	if (it != v.end() && it->obj == o && it->type == type)
+		return false;
+
+	v.insert(it, d);
+	return true;
+}
+
+static bool VectorEraseSorted(CObject::TDependenceList& v, CObject* o, int type)
+{
+	const CObject::Dependence d = {o, type};
+	const auto it = std::lower_bound(v.begin(), v.end(), d, DependenceLess);
+
+	if (it == v.end() || it->obj != o || it->type != type)
+		return false;
+
+	v.erase(it);
+	return true;
 }
 
 
@@ -54,34 +80,18 @@ CObject::~CObject()
 	assert(!detached);
 	detached = true;
 
-	for (const auto& p: listenersDepTbl) {
-		assert(p.first >= DEPENDENCE_ATTACKER && p.first < DEPENDENCE_COUNT);
-		assert(p.second < listeners.size());
-
-		for (CObject* obj: listeners[p.second]) {
-			obj->DependentDied(this);
-
-			const auto jt = obj->listeningDepTbl.find(p.first);
+	for (const Dependence& d: listeners) {
+		assert(d.type >= DEPENDENCE_ATTACKER && d.type < DEPENDENCE_COUNT);
 
-			if (jt == obj->listeningDepTbl.end())
-				continue;
+		d.obj->DependentDied(this);
 
-			VectorEraseSorted(obj->listening[ jt->second ], this);
-		}
+		VectorEraseSorted(d.obj->listening, this, d.type);
 	}
 
-	for (const auto& p: listeningDepTbl) {
-		assert(p.first >= DEPENDENCE_ATTACKER && p.first < DEPENDENCE_COUNT);
-		assert(p.second < listening.size());
+	for (const Dependence& d: listening) {
+		assert(d.type >= DEPENDENCE_ATTACKER && d.type < DEPENDENCE_COUNT);
 
-		for (CObject* obj: listening[p.second]) {
-			const auto jt = obj->listenersDepTbl.find(p.first);
-
-			if (jt == obj->listenersDepTbl.end())
-				continue;
-
-			VectorEraseSorted(obj->listeners[ jt->second ], this);
-		}
+		VectorEraseSorted(d.obj->listeners, this, d.type);
 	}
 }
 
@@ -99,8 +109,8 @@ void CObject::AddDeathDependence(CObject* obj, DependenceType dep)
 	if (detached || obj->detached)
 		return;
 
-	VectorInsertSorted(const_cast<TSyncSafeSet&>(     GetListening(dep)),  obj);
-	VectorInsertSorted(const_cast<TSyncSafeSet&>(obj->GetListeners(dep)), this);
+	VectorInsertSorted(     listening,  obj, dep);
+	VectorInsertSorted(obj->listeners, this, dep);
 }
 
 
@@ -111,10 +121,6 @@ void CObject::DeleteDeathDependence(CObject* obj, DependenceType dep)
 	if (detached || obj->detached)
 		return;
 
-	const auto it =      listeningDepTbl.find(dep);
-	const auto jt = obj->listenersDepTbl.find(dep);
-
-	if (it !=      listeningDepTbl.end()) VectorEraseSorted(     listening[ it->second ],  obj);
-	if (jt != obj->listenersDepTbl.end()) VectorEraseSorted(obj->listeners[ jt->second ], this);
+	VectorEraseSorted(     listening,  obj, dep);
+	VectorEraseSorted(obj->listeners, this, dep);
 }
-
@@ -8,12 +8,12 @@
 
 #include "ObjectDependenceTypes.h"
 #include "System/creg/creg_cond.h"
-#include "System/UnorderedMap.hpp"
 
 class CObject
 {
 public:
 	CR_DECLARE(CObject)
+	CR_DECLARE_SUB(Dependence)
 
 	CObject();
 	virtual ~CObject();
@@ -73,44 +73,38 @@ private:
 	static std::atomic<std::int64_t> cur_sync_id;
 
 public:
-	typedef std::vector<CObject*> TSyncSafeSet;
-	typedef std::vector<TSyncSafeSet> TDependenceMap;
+	struct Dependence {
+		CR_DECLARE_STRUCT(Dependence)
 
-	bool detached;
-
-protected:
-	const TSyncSafeSet& GetListeners(const DependenceType dep) {
-		const auto it = listenersDepTbl.find(dep);
+		CObject* obj;
+		int type;
+	};
 
-		if (it == listenersDepTbl.end()) {
-			listeners.emplace_back();
-			listenersDepTbl[dep] = listeners.size() - 1;
-			return (listeners.back());
-		}
+	/// sorted by {sync_id, type}, so every pair occurs at most once
+	typedef std::vector<Dependence> TDependenceList;
 
-		return (listeners[it->second]);
-	}
-	const TSyncSafeSet& GetListening(const DependenceType dep) {
-		const auto it = listeningDepTbl.find(dep);
+	bool detached;
 
-		if (it == listeningDepTbl.end()) {
-			listening.emplace_back();
-			listeningDepTbl[dep] = listening.size() - 1;
-			return (listening.back());
+protected:
+	/// first object of type dep this is listening to, or nullptr
+	CObject* GetListening(const DependenceType dep) const {
+		for (const Dependence& d: listening) {
+			if (d.type == dep)
+				return d.obj;
 		}
 
-		return (listening[it->second]);
+		return nullptr;
 	}
 
-	const TDependenceMap& GetAllListeners() const { return listeners; }
-	const TDependenceMap& GetAllListening() const { return listening; }
+	const TDependenceList& GetAllListeners() const { return listeners; }
+	const TDependenceList& GetAllListening() const { return listening; }
 
 protected:
-	spring::unordered_map<int, size_t> listenersDepTbl; // maps dependence-type to index into listeners
-	spring::unordered_map<int, size_t> listeningDepTbl; // maps dependence-type to index into listening
-
-	TDependenceMap listeners;
-	TDependenceMap listening;
+	// one list per direction instead of one per dependence-type; an object
+	// rarely has more than a handful of dependences, which makes a sorted
+	// vector cheaper than any per-type index
+	TDependenceList listeners;
+	TDependenceList listening;
 };
 
 #endif /* OBJECT_H */
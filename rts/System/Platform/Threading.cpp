@@ -9,8 +9,11 @@
 	#include "System/Sync/FPUCheck.h"
 #endif
 
+#include <algorithm>
+#include <cstdio>
 #include <functional>
 #include <memory>
+#include <vector>
 #include <cinttypes>
 #if defined(__APPLE__) || defined(__FreeBSD__)
 #elif defined(WIN32)
@@ -52,6 +55,257 @@ namespace Threading {
 	static cpu_set_t cpusSystem;
 #endif
 
+	static CpuTopology cpuTopology;
+
+
+	#if defined(__APPLE__) || defined(__FreeBSD__)
+	static void DetectCpuTopology(CpuTopology& topo) {}
+
+	#elif defined(WIN32)
+	// mirrors SYSTEM_LOGICAL_PROCESSOR_INFORMATION_EX, which older
+	// SDK's only declare when targeting Windows 7 or later; looked
+	// up at runtime so the binary still starts on older versions
+	struct GLPIGroupAffinity {
+		ULONG_PTR mask;
+		WORD group;
+		WORD reserved[3];
+	};
+	struct GLPIEntry {
+		DWORD relationship; // 0=ProcessorCore, 2=Cache
+		DWORD size;
+
+		union {
+			struct {
+				BYTE flags; // LTP_PC_SMT
+				BYTE efficiencyClass; // higher is faster
+				BYTE reserved[20];
+				WORD groupCount;
+				GLPIGroupAffinity groupMask[1];
+			} processor;
+			struct {
+				BYTE level;
+				BYTE associativity;
+				WORD lineSize;
+				DWORD cacheSize;
+				DWORD type;
+				BYTE reserved[18];
+				WORD groupCount;
+				GLPIGroupAffinity groupMask;
+			} cache;
+		};
+	};
+
+	static void DetectCpuTopology(CpuTopology& topo) {
+		typedef BOOL (WINAPI *GLPIExFunc)(int, void*, DWORD*);
+
+		const GLPIExFunc glpiEx = reinterpret_cast<GLPIExFunc>(GetProcAddress(GetModuleHandleA("kernel32"), "GetLogicalProcessorInformationEx"));
+
+		if (glpiEx == nullptr)
+			return;
+
+		DWORD bufSize = 0;
+		glpiEx(0xFFFF, nullptr, &bufSize); // RelationAll
+
+		std::vector<std::uint8_t> buffer(bufSize);
+
+		if (bufSize == 0 || !glpiEx(0xFFFF, buffer.data(), &bufSize))
+			return;
+
+		std::uint32_t coreMasks[32] = {0};
+		int coreClasses[32] = {0};
+		int maxClass = 0;
+		int numCores = 0;
+
+		for (DWORD ofs = 0; ofs < bufSize; ) {
+			const GLPIEntry* e = reinterpret_cast<const GLPIEntry*>(buffer.data() + ofs);
+
+			ofs += e->size;
+
+			switch (e->relationship) {
+				case 0: {
+					const std::uint32_t mask = (e->processor.groupMask[0].group == 0)? static_cast<std::uint32_t>(e->processor.groupMask[0].mask): 0;
+
+					topo.numPhysicalCores += 1;
+
+					if (mask == 0 || numCores == 32)
+						continue;
+
+					coreMasks[numCores] = mask;
+					coreClasses[numCores] = e->processor.efficiencyClass;
+					maxClass = std::max(maxClass, coreClasses[numCores++]);
+				} break;
+				case 2: {
+					if (e->cache.level != 3)
+						continue;
+
+					topo.numL3Domains += 1;
+
+					if (e->cache.groupMask.group != 0)
+						continue;
+
+					const std::uint32_t mask = static_cast<std::uint32_t>(e->cache.groupMask.mask);
+
+					for (int n = 0; n < 32; n++) {
+						if ((mask & (1u << n)) != 0)
+							topo.l3DomainMasks[n] = mask;
+					}
+				} break;
+				default: {
+				} break;
+			}
+		}
+
+		for (int i = 0; i < numCores; i++) {
+			const std::uint32_t mask = coreMasks[i];
+
+			topo.primaryThreadMask |= (mask & -mask);
+			topo.numPerfCores += (coreClasses[i] == maxClass);
+
+			for (int n = 0; n < 32; n++) {
+				if ((mask & (1u << n)) == 0)
+					continue;
+
+				topo.smtSiblingMasks[n] = mask;
+				topo.perfCoreMask |= (std::uint32_t(coreClasses[i] == maxClass) << n);
+			}
+		}
+	}
+
+	#else
+	// parses sysfs CPU lists such as "0-3,8-11"
+	static std::vector<int> ReadCpuList(const char* path) {
+		std::vector<int> cpus;
+		FILE* f = fopen(path, "r");
+
+		if (f == nullptr)
+			return cpus;
+
+		for (int a = 0, b = 0; fscanf(f, "%d", &a) == 1; ) {
+			b = a;
+
+			const int c = fgetc(f);
+
+			if (c == '-' && fscanf(f, "%d", &b) == 1) {
+				fgetc(f);
+			}
+
+			for (int n = a; n <= b; n++) {
+				cpus.push_back(n);
+			}
+		}
+
+		fclose(f);
+		return cpus;
+	}
+
+	static int ReadSysInt(const char* path) {
+		int value = 0;
+		FILE* f = fopen(path, "r");
+
+		if (f == nullptr)
+			return 0;
+		if (fscanf(f, "%d", &value) != 1)
+			value = 0;
+
+		fclose(f);
+		return value;
+	}
+
+	static std::uint32_t CpuListToMask(const std::vector<int>& cpus) {
+		std::uint32_t mask = 0;
+
+		for (const int n: cpus) {
+			mask |= ((n >= 0 && n < 32) ? (1u << n) : 0u);
+		}
+
+		return mask;
+	}
+
+	static void DetectCpuTopology(CpuTopology& topo) {
+		char path[256];
+
+		// hybrid Intel CPU's register one PMU per core type
+		const std::vector<int> bigCores = ReadCpuList("/sys/devices/cpu_core/cpus");
+
+		std::vector<int> coreLeaders;
+		std::vector<int> l3Leaders;
+		std::vector<int> coreSpeeds(CPU_SETSIZE, 0);
+
+		int maxSpeed = 0;
+
+		for (int n = 0; n < CPU_SETSIZE; n++) {
+			if (!CPU_ISSET(n, &cpusSystem))
+				continue;
+
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/topology/thread_siblings_list", n);
+			const std::vector<int> siblings = ReadCpuList(path);
+
+			if (siblings.empty())
+				continue;
+
+			if (std::find(coreLeaders.begin(), coreLeaders.end(), siblings[0]) == coreLeaders.end())
+				coreLeaders.push_back(siblings[0]);
+
+			for (int i = 0; i < 8; i++) {
+				snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/level", n, i);
+
+				if (ReadSysInt(path) != 3)
+					continue;
+
+				snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cache/index%d/shared_cpu_list", n, i);
+				const std::vector<int> sharing = ReadCpuList(path);
+
+				if (sharing.empty())
+					break;
+				if (std::find(l3Leaders.begin(), l3Leaders.end(), sharing[0]) == l3Leaders.end())
+					l3Leaders.push_back(sharing[0]);
+
+				if (n < 32)
+					topo.l3DomainMasks[n] = CpuListToMask(sharing);
+
+				break;
+			}
+
+			// ARM big.LITTLE exposes a capacity, otherwise fall back to the
+			// maximum clock which also separates hybrid x86 core types
+			snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpu_capacity", n);
+
+			if ((coreSpeeds[n] = ReadSysInt(path)) == 0) {
+				snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d/cpufreq/cpuinfo_max_freq", n);
+				coreSpeeds[n] = ReadSysInt(path);
+			}
+
+			maxSpeed = std::max(maxSpeed, coreSpeeds[n]);
+
+			if (n >= 32)
+				continue;
+
+			topo.smtSiblingMasks[n] = CpuListToMask(siblings);
+			topo.primaryThreadMask |= (std::uint32_t(siblings[0] == n) << n);
+		}
+
+		topo.numPhysicalCores = coreLeaders.size();
+		topo.numL3Domains = l3Leaders.size();
+
+		for (const int n: coreLeaders) {
+			// boost clocks differ by a few percent per core even on uniform CPU's
+			const bool isBigCore = bigCores.empty()?
+				(coreSpeeds[n] >= (maxSpeed * 4 / 5)):
+				(std::find(bigCores.begin(), bigCores.end(), n) != bigCores.end());
+
+			if (!isBigCore)
+				continue;
+
+			topo.numPerfCores += 1;
+
+			if (n < 32)
+				topo.perfCoreMask |= topo.smtSiblingMasks[n];
+		}
+	}
+	#endif
+
+	const CpuTopology& GetCpuTopology() { return cpuTopology; }
+
 
 	void DetectCores()
 	{
@@ -70,6 +324,7 @@ namespace Threading {
 	#endif
 
 		GetPhysicalCpuCores(); // (uses a static, too)
+		DetectCpuTopology(cpuTopology);
 	}
 
 
@@ -209,6 +464,11 @@ namespace Threading {
 	    (across all existing processors, if more than one)*/
 	int GetPhysicalCpuCores() {
 		static springproc::CPUID cpuid;
+
+		// the OS knows better than CPUID on multi-socket and non-Intel CPU's
+		if (cpuTopology.numPhysicalCores > 0)
+			return cpuTopology.numPhysicalCores;
+
 		return cpuid.getTotalNumCores();
 	}
 
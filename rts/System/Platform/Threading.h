@@ -114,6 +114,31 @@ namespace Threading {
 	int GetLogicalCpuCores();  /// physical + hyperthreading
 	bool HasHyperThreading();
 
+	/**
+	 * Processor layout as reported by the OS (sysfs on Linux, GLPI on Windows),
+	 * filled in by DetectCores. All masks use the same bit-per-logical-CPU form
+	 * as the affinity functions above, so only the first 32 CPU's are covered.
+	 */
+	struct CpuTopology {
+		bool IsValid() const { return (primaryThreadMask != 0); }
+
+		/// CPU's of the fastest core type (every core unless the CPU is hybrid)
+		std::uint32_t perfCoreMask = 0;
+		/// first hardware thread of every physical core
+		std::uint32_t primaryThreadMask = 0;
+		/// per CPU, all hardware threads of its physical core
+		std::uint32_t smtSiblingMasks[32] = {};
+		/// per CPU, all CPU's sharing its L3 cache (a CCD/CCX on Ryzens)
+		std::uint32_t l3DomainMasks[32] = {};
+
+		/// counts cover every CPU, not just the first 32
+		int numPhysicalCores = 0;
+		int numPerfCores = 0;
+		int numL3Domains = 0;
+	};
+
+	const CpuTopology& GetCpuTopology();
+
 	/**
 	 * Inform the OS kernel that we are a cpu-intensive task
 	 */
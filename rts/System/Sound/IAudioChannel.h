@@ -62,7 +62,7 @@ public:
 	virtual float StreamGetTime() = 0;
 	virtual float StreamGetPlayTime() = 0;
 
-	void UpdateFrame() { emitsThisFrame = 0; }
+	virtual void UpdateFrame() { emitsThisFrame = 0; }
 	void SetMaxEmits(unsigned max) { emitsPerFrame = max; }
 	void SetMaxConcurrent(unsigned max) { maxConcurrentSources = max; }
 
@@ -10,8 +10,10 @@
 #include "Sim/Objects/WorldObject.h"
 #include "System/Sound/ISound.h"
 #include "System/Sound/SoundLog.h"
+#include "System/Threading/LockStats.h"
 #include "System/Threading/SpringThreading.h"
 
+#include <cfloat>
 #include <climits>
 
 extern spring::recursive_mutex soundMutex;
@@ -25,7 +27,7 @@ void AudioChannel::SetVolume(float newVolume)
 	if (curSources.empty())
 		return;
 
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	for (auto it = curSources.begin(); it != curSources.end(); ++it) {
 		(*it)->UpdateVolume();
@@ -35,9 +37,18 @@ void AudioChannel::SetVolume(float newVolume)
 }
 
 
+void AudioChannel::UpdateFrame()
+{
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
+
+	IAudioChannel::UpdateFrame();
+	frameEmitCells.clear();
+}
+
+
 void AudioChannel::Enable(bool newState)
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	if ((enabled = newState))
 		return;
@@ -63,7 +74,7 @@ void AudioChannel::SoundSourceFinished(CSoundSource* sndSource)
 
 void AudioChannel::FindSourceAndPlay(size_t id, const float3& pos, const float3& velocity, float volume, bool relative)
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	if (!enabled)
 		return;
@@ -79,14 +90,37 @@ void AudioChannel::FindSourceAndPlay(size_t id, const float3& pos, const float3&
 		return;
 	}
 
+	const float listenerDist = pos.distance(sound->GetListenerPos());
+	const bool positional = (!relative && sndItem->In3D());
+
 	// check distance to listener
-	if (pos.distance(sound->GetListenerPos()) > sndItem->MaxDistance()) {
+	if (listenerDist > sndItem->MaxDistance()) {
 		if (!relative)
 			return;
 
 		LOG("CSound::PlaySample: maxdist ignored for relative playback: %s", sndItem->Name().c_str());
 	}
 
+	// everything below is cheaper than claiming (and possibly aborting) a source
+	// only for SoundSource::Play to find the item's maxconcurrent limit reached
+	if (!sndItem->CanPlay())
+		return;
+
+	// rank by estimated gain at the listener (ignoring the random gain modulation)
+	float audibility = volume * sndItem->GetBaseGain() * this->volume;
+
+	if (positional) {
+		if ((audibility *= CSoundSource::GetDistanceGain(listenerDist, sndItem->GetRolloff())) < MIN_AUDIBLE_GAIN)
+			return;
+
+		// many identical sounds at (almost) the same spot in one frame only need one source
+		const std::uint32_t cx = std::uint16_t(int(pos.x / EMIT_CELL_SIZE));
+		const std::uint32_t cz = std::uint16_t(int(pos.z / EMIT_CELL_SIZE));
+
+		if (!frameEmitCells.insert((std::uint64_t(id) << 32) | (cx << 16) | cz).second)
+			return;
+	}
+
 	// don't spam to many sounds per frame
 	if (emitsThisFrame >= emitsPerFrame)
 		return;
@@ -97,15 +131,23 @@ void AudioChannel::FindSourceAndPlay(size_t id, const float3& pos, const float3&
 		CSoundSource* src = nullptr;
 
 		int prio = INT_MAX;
+		float srcAudibility = FLT_MAX;
 
+		// least audible of the lowest priority
 		for (auto it = curSources.begin(); it != curSources.end(); ++it) {
-			if ((*it)->GetCurrentPriority() < prio) {
-				src  = *it;
-				prio = src->GetCurrentPriority();
-			}
+			const int curPrio = (*it)->GetCurrentPriority();
+
+			if (curPrio > prio)
+				continue;
+			if (curPrio == prio && (*it)->GetCurrentAudibility() >= srcAudibility)
+				continue;
+
+			src  = *it;
+			prio = curPrio;
+			srcAudibility = src->GetCurrentAudibility();
 		}
 
-		if (src == nullptr || prio > sndItem->GetPriority()) {
+		if (src == nullptr || prio > sndItem->GetPriority() || (prio == sndItem->GetPriority() && srcAudibility >= audibility)) {
 			LOG_L(L_DEBUG, "CSound::PlaySample: Max concurrent sounds in channel reached! Dropping playback!");
 			return;
 		}
@@ -116,7 +158,13 @@ void AudioChannel::FindSourceAndPlay(size_t id, const float3& pos, const float3&
 	// find a sound source to play the item in
 	CSoundSource* sndSource = sound->GetNextBestSource();
 
-	if (sndSource == nullptr || (sndSource->GetCurrentPriority() >= sndItem->GetPriority())) {
+	if (sndSource == nullptr)
+		return;
+
+	// a busy source of equal priority is only taken over by a more audible sound
+	const int srcPriority = sndSource->GetCurrentPriority();
+
+	if (srcPriority > sndItem->GetPriority() || (srcPriority == sndItem->GetPriority() && sndSource->GetCurrentAudibility() >= audibility)) {
 		LOG_L(L_DEBUG, "CSound::PlaySample: Max sounds reached! Dropping playback!");
 		return;
 	}
@@ -124,7 +172,7 @@ void AudioChannel::FindSourceAndPlay(size_t id, const float3& pos, const float3&
 		sound->numAbortedPlays++;
 
 	// play the sound item
-	sndSource->PlayAsync(this, sndItem, pos, velocity, volume, relative);
+	sndSource->PlayAsync(this, sndItem, pos, velocity, volume, audibility, relative);
 	curSources.insert(sndSource);
 }
 
@@ -170,7 +218,7 @@ void AudioChannel::PlayRandomSample(const GuiSoundSet& soundSet, const float3& p
 
 void AudioChannel::StreamPlay(const std::string& filepath, float volume, bool enqueue)
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	if (!enabled)
 		return;
@@ -198,7 +246,7 @@ void AudioChannel::StreamPlay(const std::string& filepath, float volume, bool en
 
 void AudioChannel::StreamPause()
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	if (curStreamSrc != nullptr)
 		curStreamSrc->StreamPause();
@@ -206,7 +254,7 @@ void AudioChannel::StreamPause()
 
 void AudioChannel::StreamStop()
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	if (curStreamSrc != nullptr)
 		curStreamSrc->StreamStop();
@@ -214,7 +262,7 @@ void AudioChannel::StreamStop()
 
 float AudioChannel::StreamGetTime()
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	if (curStreamSrc != nullptr)
 		return curStreamSrc->GetStreamTime();
@@ -224,7 +272,7 @@ float AudioChannel::StreamGetTime()
 
 float AudioChannel::StreamGetPlayTime()
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	if (curStreamSrc != nullptr)
 		return curStreamSrc->GetStreamPlayTime();
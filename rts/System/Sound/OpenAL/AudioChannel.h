@@ -4,6 +4,7 @@
 #define AUDIO_CHANNEL_H
 
 #include <vector>
+#include <cstdint>
 #include <cstring>
 
 #include "System/Sound/IAudioChannel.h"
@@ -29,6 +30,8 @@ public:
 	void Enable(bool newState);
 	void SetVolume(float newVolume);
 
+	void UpdateFrame() override;
+
 	void PlaySample(size_t id, float volume = 1.0f);
 	void PlaySample(size_t id, const float3& pos, float volume = 1.0f);
 	void PlaySample(size_t id, const float3& pos, const float3& velocity, float volume = 1.0f);
@@ -58,11 +61,17 @@ protected:
 
 private:
 	spring::unsynced_set<CSoundSource*> curSources;
+	/// {sound id, coarse map cell} of every positional sound started this frame
+	spring::unsynced_set<std::uint64_t> frameEmitCells;
 	std::vector<StreamQueueItem> streamQueue;
 
 	CSoundSource* curStreamSrc;
 
 	static constexpr size_t MAX_STREAM_QUEUESIZE = 10;
+	/// identical sounds started closer together than this (in elmos) within a frame are merged
+	static constexpr float EMIT_CELL_SIZE = 64.0f;
+	/// estimated gain at the listener below which a sound is not worth a source
+	static constexpr float MIN_AUDIBLE_GAIN = 1.0f / 256.0f;
 };
 
 #endif // AUDIO_CHANNEL_H
@@ -12,6 +12,7 @@
 // #include <alext.h>
 #endif
 
+#include <cfloat>
 #include <climits>
 #include <cinttypes>
 #include <functional>
@@ -36,6 +37,7 @@
 #include "System/StringUtil.h"
 #include "System/Platform/Threading.h"
 #include "System/Platform/Watchdog.h"
+#include "System/Threading/LockStats.h"
 #include "System/Threading/SpringThreading.h"
 
 #include "System/float3.h"
@@ -56,7 +58,7 @@ CSound::CSound()
 	, soundThreadQuit(false)
 	, canLoadDefs(false)
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	masterVolume = configHandler->GetInt("snd_volmaster") * 0.01f;
 	pitchAdjustMode = configHandler->GetInt("PitchAdjust");
@@ -108,31 +110,72 @@ bool CSound::HasSoundItem(const std::string& name) const
 
 size_t CSound::GetSoundId(const std::string& name)
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	std::string filePath;
+
+	{
+		LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
+
+		if (soundSources.empty())
+			return 0;
+
+		const auto it = soundMap.find(name);
+		if (it != soundMap.end())
+			return it->second;
+
+		const auto itemDefIt = soundItemDefsMap.find(StringToLower(name));
+
+		if (itemDefIt != soundItemDefsMap.end()) {
+			const auto fileIt = itemDefIt->second.find("file");
+
+			if (fileIt == itemDefIt->second.end() || SoundBuffer::GetId(fileIt->second) > 0)
+				return MakeItemFromDef(itemDefIt->second);
+
+			filePath = fileIt->second;
+		} else {
+			if (SoundBuffer::GetId(name) > 0)
+				return MakeItemFromRawFile(name);
+
+			filePath = name;
+		}
+	}
+
+	// read and decode the file without holding up the audio thread, which needs
+	// the lock for every update
+	const std::shared_ptr<SoundBuffer> buffer = DecodeSoundBuffer(filePath);
+
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	if (soundSources.empty())
 		return 0;
 
+	// may have been created by another thread meanwhile
 	const auto it = soundMap.find(name);
 	if (it != soundMap.end())
 		return it->second;
 
+	if (buffer != nullptr && SoundBuffer::GetId(filePath) == 0)
+		SoundBuffer::Insert(buffer);
+
 	const auto itemDefIt = soundItemDefsMap.find(StringToLower(name));
 
 	if (itemDefIt != soundItemDefsMap.end())
 		return MakeItemFromDef(itemDefIt->second);
 
-	if (LoadSoundBuffer(name) > 0) {
-		// maybe raw filename?
-		SoundItemNameMap temp = defaultItemNameMap;
-		temp["file"] = name;
-		return MakeItemFromDef(temp);
-	}
+	// maybe raw filename?
+	if (SoundBuffer::GetId(name) > 0)
+		return MakeItemFromRawFile(name);
 
 	LOG_L(L_ERROR, "[Sound::%s] could not find sound \"%s\"", __func__, name.c_str());
 	return 0;
 }
 
+size_t CSound::MakeItemFromRawFile(const std::string& fileName)
+{
+	SoundItemNameMap temp = defaultItemNameMap;
+	temp["file"] = fileName;
+	return MakeItemFromDef(temp);
+}
+
 SoundItem* CSound::GetSoundItem(size_t id) const {
 	// id==0 is a special id and invalid
 	if (id == 0 || id >= soundItems.size())
@@ -159,19 +202,26 @@ CSoundSource* CSound::GetNextBestSource(bool lock)
 			return &src;
 	}
 
-	// check the next best free source
+	// check the next best free source; the least audible of the lowest priority
 	CSoundSource* bestSrc = nullptr;
 	int bestPriority = INT_MAX;
+	float bestAudibility = FLT_MAX;
 
 	for (CSoundSource& src: soundSources) {
 		#if 0
 		if (!src.IsPlaying(true))
 			return &src;
 		#endif
-		if (src.GetCurrentPriority() <= bestPriority) {
-			bestSrc = &src;
-			bestPriority = src.GetCurrentPriority();
-		}
+		const int srcPriority = src.GetCurrentPriority();
+
+		if (srcPriority > bestPriority)
+			continue;
+		if (srcPriority == bestPriority && src.GetCurrentAudibility() > bestAudibility)
+			continue;
+
+		bestSrc = &src;
+		bestPriority = srcPriority;
+		bestAudibility = src.GetCurrentAudibility();
 	}
 
 	return bestSrc;
@@ -179,7 +229,7 @@ CSoundSource* CSound::GetNextBestSource(bool lock)
 
 void CSound::PitchAdjust(const float newPitch)
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	switch (pitchAdjustMode) {
 		case 1: { CSoundSource::SetPitch(std::sqrt(newPitch)); } break;
@@ -190,7 +240,7 @@ void CSound::PitchAdjust(const float newPitch)
 
 void CSound::ConfigNotify(const std::string& key, const std::string& value)
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	if (key == "snd_volmaster") {
 		masterVolume = std::atoi(value.c_str()) * 0.01f;
@@ -255,7 +305,7 @@ void CSound::ConfigNotify(const std::string& key, const std::string& value)
 
 bool CSound::Mute()
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	if ((mute = !mute))
 		alListenerf(AL_GAIN, 0.0f);
@@ -267,7 +317,7 @@ bool CSound::Mute()
 
 void CSound::Iconified(bool state)
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	if (appIsIconified != state && !mute) {
 		if (!state)
@@ -286,7 +336,7 @@ void CSound::InitThread(int cfgMaxSounds)
 	assert(cfgMaxSounds > 0);
 
 	{
-		std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+		LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 		// if empty, open default device
 		std::string configDeviceName;
 
@@ -429,7 +479,7 @@ void CSound::UpdateThread(int cfgMaxSounds)
 
 void CSound::Update()
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex); // lock
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND); // lock
 
 	for (CSoundSource& source: soundSources)
 		source.Update();
@@ -512,7 +562,7 @@ void CSound::UpdateListenerReal()
 
 void CSound::PrintDebugInfo()
 {
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	LOG_L(L_DEBUG, "OpenAL Sound System:");
 	LOG_L(L_DEBUG, "# SoundSources: %i", (int)soundSources.size());
@@ -527,7 +577,7 @@ void CSound::PrintDebugInfo()
 bool CSound::LoadSoundDefsImpl(const std::string& fileName, const std::string& modes)
 {
 	//! can be called from LuaUnsyncedCtrl too
-	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
+	LockStats::ScopedLock<spring::recursive_mutex> lck(soundMutex, LockStats::LOCK_SOUND);
 
 	LuaParser parser(fileName, modes, modes);
 	parser.Execute();
@@ -607,23 +657,26 @@ size_t CSound::LoadSoundBuffer(const std::string& path)
 	if (id > 0)
 		return id; // file is loaded already
 
-	// initial ctor Open is a no-op
-	static CFileHandler file("", "");
+	const std::shared_ptr<SoundBuffer> buffer = DecodeSoundBuffer(path);
 
-	file.Close();
-	file.Open(path, SPRING_VFS_RAW_FIRST);
+	if (buffer == nullptr)
+		return 0;
+
+	return (SoundBuffer::Insert(buffer));
+}
+
+//! does not need the lock, see GetSoundId
+std::shared_ptr<SoundBuffer> CSound::DecodeSoundBuffer(const std::string& path)
+{
+	CFileHandler file(path, SPRING_VFS_RAW_FIRST);
 
 	if (!file.FileExists()) {
-		file.Close();
 		LOG_L(L_ERROR, "[%s] unable to open audio file \"%s\"", __func__, path.c_str());
-		return 0;
+		return nullptr;
 	}
 
-	// safe, caller locks
-	static std::vector<std::uint8_t> buf;
+	std::vector<std::uint8_t> buf(file.FileSize());
 
-	buf.clear();
-	buf.resize(file.FileSize());
 	// copy file into buffer
 	file.Read(buf.data(), file.FileSize());
 	file.Close();
@@ -641,13 +694,13 @@ size_t CSound::LoadSoundBuffer(const std::string& path)
 		LOG_L(L_WARNING, "[%s] unknown audio format \"%s\"", __func__, ending.c_str());
 	}
 
-	CheckError("[Sound::LoadSoundBuffer]");
+	CheckError("[Sound::DecodeSoundBuffer]");
 	if (!success) {
 		LOG_L(L_WARNING, "[%s] failed to load file \"%s\"", __func__, path.c_str());
-		return 0;
+		return nullptr;
 	}
 
-	return (SoundBuffer::Insert(buffer));
+	return buffer;
 }
 
 void CSound::NewFrame()
@@ -3,6 +3,7 @@
 #ifndef _SOUND_H_
 #define _SOUND_H_
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -67,7 +68,9 @@ private:
 	void GenSources(int alMaxSounds);
 
 	size_t MakeItemFromDef(const SoundItemNameMap& itemDef);
+	size_t MakeItemFromRawFile(const std::string& fileName);
 	size_t LoadSoundBuffer(const std::string& filename);
+	static std::shared_ptr<SoundBuffer> DecodeSoundBuffer(const std::string& filename);
 
 private:
 	spring::thread soundThread;
@@ -45,6 +45,7 @@ SoundItem::SoundItem(std::shared_ptr<SoundBuffer> _buffer, const spring::unorder
 	, priority(0)
 	, maxConcurrent(16)
 	, currentlyPlaying(0)
+	, numQueued(0)
 	, loopTime(0)
 	, in3D(true)
 {
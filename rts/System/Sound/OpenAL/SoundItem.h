@@ -26,6 +26,8 @@ public:
 
 	bool PlayNow();
 	void StopPlay();
+	/// false if PlayNow would fail once all queued plays have started
+	bool CanPlay() const { return ((currentlyPlaying + numQueued) <= maxConcurrent); }
 
 	float MaxDistance() const { return maxDist; }
 	const std::string& Name() const { return name; }
@@ -33,6 +35,10 @@ public:
 
 	float GetGain() const;
 	float GetPitch() const;
+	/// gain without random modulation
+	float GetBaseGain() const { return gain; }
+	float GetRolloff() const { return rolloff; }
+	bool In3D() const { return in3D; }
 
 private:
 	std::shared_ptr<SoundBuffer> buffer;
@@ -53,6 +59,8 @@ private:
 
 	unsigned maxConcurrent;
 	unsigned currentlyPlaying;
+	/// handed to a source by PlayAsync, but not yet started by it
+	unsigned numQueued;
 
 	unsigned loopTime;
 
@@ -2,6 +2,8 @@
 
 #include "SoundSource.h"
 
+#include <algorithm>
+#include <cfloat>
 #include <climits>
 #include <alc.h>
 
@@ -29,6 +31,7 @@ CSoundSource::CSoundSource()
 	: curPlaying(nullptr)
 	, curChannel(nullptr)
 	, curVolume(1.f)
+	, curAudibility(0.0f)
 	, loopStop(1e9)
 	, in3D(false)
 	, efxEnabled(false)
@@ -60,7 +63,10 @@ CSoundSource::~CSoundSource()
 void CSoundSource::Update()
 {
 	if (asyncPlay.buffer != nullptr) {
+		asyncPlay.buffer->numQueued -= 1;
+
 		Play(asyncPlay.channel, asyncPlay.buffer, asyncPlay.pos, asyncPlay.velocity, asyncPlay.volume, asyncPlay.relative);
+		curAudibility = asyncPlay.audibility;
 		asyncPlay = AsyncSoundItemData();
 	}
 
@@ -113,6 +119,29 @@ int CSoundSource::GetCurrentPriority() const
 	return (curPlaying->GetPriority());
 }
 
+float CSoundSource::GetCurrentAudibility() const
+{
+	if (asyncPlay.buffer != nullptr)
+		return asyncPlay.audibility;
+
+	if (curStream.Valid())
+		return FLT_MAX;
+
+	if (curPlaying == nullptr)
+		return 0.0f;
+
+	return curAudibility;
+}
+
+float CSoundSource::GetDistanceGain(float distance, float rolloff)
+{
+	// AL_INVERSE_DISTANCE_CLAMPED, no AL_MAX_DISTANCE; see Play
+	const float rolloffFactor = ROLLOFF_FACTOR * rolloff * heightRolloffModifier;
+	const float clampedDist = std::max(distance, referenceDistance);
+
+	return (referenceDistance / (referenceDistance + rolloffFactor * (clampedDist - referenceDistance)));
+}
+
 bool CSoundSource::IsPlaying(const bool checkOpenAl) const
 {
 	if (curStream.Valid())
@@ -234,14 +263,21 @@ void CSoundSource::Play(IAudioChannel* channel, SoundItem* item, float3 pos, flo
 }
 
 
-void CSoundSource::PlayAsync(IAudioChannel* channel, SoundItem* buffer, float3 pos, float3 velocity, float volume, bool relative)
+void CSoundSource::PlayAsync(IAudioChannel* channel, SoundItem* buffer, float3 pos, float3 velocity, float volume, float audibility, bool relative)
 {
-	asyncPlay.channel  = channel;
-	asyncPlay.buffer   = buffer;
-	asyncPlay.pos      = pos;
-	asyncPlay.velocity = velocity;
-	asyncPlay.volume   = volume;
-	asyncPlay.relative = relative;
+	// replaces a play that did not start yet
+	if (asyncPlay.buffer != nullptr)
+		asyncPlay.buffer->numQueued -= 1;
+
+	buffer->numQueued += 1;
+
+	asyncPlay.channel    = channel;
+	asyncPlay.buffer     = buffer;
+	asyncPlay.pos        = pos;
+	asyncPlay.velocity   = velocity;
+	asyncPlay.volume     = volume;
+	asyncPlay.audibility = audibility;
+	asyncPlay.relative   = relative;
 }
 
 
@@ -40,12 +40,14 @@ public:
 	bool IsValid() const { return (id != 0); };
 
 	int GetCurrentPriority() const;
+	/// estimated gain at the listener when the current sound was started
+	float GetCurrentAudibility() const;
 	bool IsPlaying(const bool checkOpenAl = false) const;
 	void Stop();
 
 	/// will stop a currently playing sound, if any
 	void Play(IAudioChannel* channel, SoundItem* buffer, float3 pos, float3 velocity, float volume, bool relative = false);
-	void PlayAsync(IAudioChannel* channel, SoundItem* buffer, float3 pos, float3 velocity, float volume, bool relative = false);
+	void PlayAsync(IAudioChannel* channel, SoundItem* buffer, float3 pos, float3 velocity, float volume, float audibility, bool relative = false);
 	void PlayStream(IAudioChannel* channel, const std::string& stream, float volume);
 	void StreamStop();
 	void StreamPause();
@@ -55,6 +57,9 @@ public:
 	static void SetPitch(const float& newPitch) { globalPitch = newPitch; }
 	static void SetHeightRolloffModifer(const float& mod) { heightRolloffModifier = mod; }
 
+	/// attenuation of a 3D sound with the given rolloff at <distance> elmos, as applied by OpenAL
+	static float GetDistanceGain(float distance, float rolloff);
+
 private:
 	struct AsyncSoundItemData {
 		IAudioChannel* channel;
@@ -64,12 +69,14 @@ private:
 		float3 velocity;
 
 		float volume;
+		float audibility;
 		bool relative;
 
 		AsyncSoundItemData()
 		: channel(nullptr)
 		, buffer(nullptr)
 		, volume(1.0f)
+		, audibility(0.0f)
 		, relative(false)
 		{}
 	};
@@ -91,6 +98,7 @@ private:
 	COggStream curStream;
 
 	float curVolume;
+	float curAudibility;
 	spring_time loopStop;
 	bool in3D;
 	bool efxEnabled;
@@ -31,6 +31,7 @@
 #include "Game/Benchmark.h"
 #include "Game/Camera.h"
 #include "Game/ClientSetup.h"
+#include "Game/DemoBatch.h"
 #include "Game/GameSetup.h"
 #include "Game/GameVersion.h"
 #include "Game/GameController.h"
@@ -117,6 +118,11 @@ DEFINE_string   (server,                                   "",    "Set listening
 DEFINE_bool     (textureatlas,                             false, "Dump each finalized textureatlas in textureatlasN.tga");
 DEFINE_int32    (benchmark,                                -1,    "Enable benchmark mode (writes a benchmark.data file). The given number specifies the timespan to test.");
 DEFINE_int32    (benchmarkstart,                           -1,    "Benchmark start time in minutes.");
+DEFINE_string_EX(demo_batch,         "demo-batch",         "",    "Replay every demo listed (one per line) in the given file, each in a forked instance");
+DEFINE_string_EX(batch_output,       "batch-output",       "demobatch.jsonl", "File the JSON-lines records of a --demo-batch run are written to");
+DEFINE_int32    (batchjobs,                                0,     "Number of demos a --demo-batch run replays concurrently (0: one per physical core)");
+DEFINE_bool_EX  (batch_unlimited,    "batch-unlimited",    false, "Replay --demo-batch demos as fast as possible and skip all unsynced work");
+DEFINE_bool_EX  (batch_timers,       "batch-timers",       false, "Write per-frame percentiles of every profiler timer to the records of each --demo-batch demo");
 
 DEFINE_bool_EX  (list_ai_interfaces, "list-ai-interfaces", false, "Dump a list of available AI Interfaces to stdout");
 DEFINE_bool_EX  (list_skirmish_ais,  "list-skirmish-ais",  false, "Dump a list of available Skirmish AIs to stdout");
@@ -479,6 +485,11 @@ void SpringApp::ParseCmdLine(int argc, char* argv[])
 
 		CBenchmark::endFrame = CBenchmark::startFrame + FLAGS_benchmark * 60 * GAME_SPEED;
 	}
+
+	if (!FLAGS_demo_batch.empty()) {
+		CDemoBatch::unlimited = FLAGS_batch_unlimited;
+		CDemoBatch::recordTimers = FLAGS_batch_timers;
+	}
 }
 
 
@@ -785,6 +796,10 @@ int SpringApp::Run()
 {
 	Threading::Error* thrErr = nullptr;
 
+	// the supervisor only forks and waits, each child continues as a regular replay
+	if (!FLAGS_demo_batch.empty() && CDemoBatch::Supervise(FLAGS_demo_batch, FLAGS_batch_output, FLAGS_batchjobs, inputFile, spring::exitCode))
+		return spring::exitCode;
+
 	// initialize crash reporting
 	CrashHandler::Install();
 
@@ -0,0 +1,77 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <atomic>
+#include <cassert>
+#include <memory>
+
+#include "StringAtoms.h"
+#include "System/UnorderedMap.hpp"
+#include "System/Threading/SpringThreading.h"
+
+namespace StringAtoms {
+	// strings live in fixed-size chunks that are never moved or freed, which
+	// keeps GetString lock-free while other threads intern new strings
+	static constexpr size_t CHUNK_SIZE = 1024;
+	static constexpr size_t MAX_CHUNKS = 1024;
+
+	static std::unique_ptr<std::string[]> chunks[MAX_CHUNKS];
+	static std::atomic<atom_t> numAtoms = {1};
+
+	static spring::unordered_map<std::string, atom_t> atomMap;
+	static spring::mutex mutex;
+
+
+	atom_t Get(const std::string& str)
+	{
+		if (str.empty())
+			return NONE;
+
+		const std::lock_guard<spring::mutex> lck(mutex);
+		const auto it = atomMap.find(str);
+
+		if (it != atomMap.end())
+			return it->second;
+
+		const atom_t atom = numAtoms.load(std::memory_order_relaxed);
+		const size_t chunkIdx = atom / CHUNK_SIZE;
+
+		assert(chunkIdx < MAX_CHUNKS);
+
+		if (chunks[chunkIdx] == nullptr)
+			chunks[chunkIdx].reset(new std::string[CHUNK_SIZE]);
+
+		chunks[chunkIdx][atom % CHUNK_SIZE] = str;
+		atomMap[str] = atom;
+
+		// publish only after the string is in place
+		numAtoms.store(atom + 1, std::memory_order_release);
+		return atom;
+	}
+
+	atom_t Find(const std::string& str)
+	{
+		if (str.empty())
+			return NONE;
+
+		const std::lock_guard<spring::mutex> lck(mutex);
+		const auto it = atomMap.find(str);
+
+		if (it != atomMap.end())
+			return it->second;
+
+		return NONE;
+	}
+
+
+	const std::string& GetString(atom_t atom)
+	{
+		static const std::string empty;
+
+		if (atom == NONE || atom >= numAtoms.load(std::memory_order_acquire))
+			return empty;
+
+		return chunks[atom / CHUNK_SIZE][atom % CHUNK_SIZE];
+	}
+
+	atom_t GetCount() { return (numAtoms.load(std::memory_order_acquire)); }
+}
@@ -0,0 +1,33 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef STRING_ATOMS_H
+#define STRING_ATOMS_H
+
+#include <string>
+
+/**
+ * @brief process-wide string interning
+ *
+ * Maps strings to small dense ids ("atoms") that stay valid for the whole
+ * lifetime of the process, so per-frame lookups can index flat arrays with
+ * an id resolved once instead of hashing (or copying) a string every time.
+ * Atom 0 is reserved for the empty string.
+ *
+ * Get() and Find() take a lock, GetString() does not.
+ */
+namespace StringAtoms {
+	typedef unsigned int atom_t;
+
+	static constexpr atom_t NONE = 0;
+
+	/// returns the atom for <str>, interning it if necessary
+	atom_t Get(const std::string& str);
+	/// returns the atom for <str> or NONE if it was never interned
+	atom_t Find(const std::string& str);
+
+	const std::string& GetString(atom_t atom);
+	/// upper bound (exclusive) of all atoms handed out so far
+	atom_t GetCount();
+}
+
+#endif // STRING_ATOMS_H
@@ -3,11 +3,109 @@
 
 #ifdef SYNCCHECK
 
+#include <cstdint>
+
 #include "SyncChecker.h"
 
 
-unsigned CSyncChecker::g_checksum;
+CSyncChecker::SyncBuffer CSyncChecker::buffers[SYNC_SUBSYSTEM_COUNT];
+unsigned CSyncChecker::checksums[SYNC_SUBSYSTEM_COUNT];
+CSyncChecker::Subsystem CSyncChecker::curSubsystem = CSyncChecker::SYNC_MISC;
 int CSyncChecker::inSyncedCode;
 
 
+static constexpr std::uint32_t CHECKSUM_SEED = 0xfade1eaf;
+
+static constexpr std::uint32_t PRIME1 = 2654435761u;
+static constexpr std::uint32_t PRIME2 = 2246822519u;
+static constexpr std::uint32_t PRIME3 = 3266489917u;
+static constexpr std::uint32_t PRIME4 =  668265263u;
+static constexpr std::uint32_t PRIME5 =  374761393u;
+
+static inline std::uint32_t RotL(std::uint32_t x, unsigned r) { return ((x << r) | (x >> (32 - r))); }
+static inline std::uint32_t Read32(const unsigned char* p) { std::uint32_t v; std::memcpy(&v, p, sizeof(v)); return v; }
+static inline std::uint32_t Round(std::uint32_t acc, std::uint32_t v) { return (RotL(acc + v * PRIME2, 13) * PRIME1); }
+
+/**
+ * XXH32; the four independent lanes of the main loop are
+ * what lets the compiler keep (or vectorize) them in parallel
+ */
+static std::uint32_t HashBlock(const void* data, unsigned size, std::uint32_t seed)
+{
+	const unsigned char* p = reinterpret_cast<const unsigned char*>(data);
+	const unsigned char* end = p + size;
+
+	std::uint32_t h;
+
+	if (size >= 16) {
+		std::uint32_t v[4] = {seed + PRIME1 + PRIME2, seed + PRIME2, seed, seed - PRIME1};
+
+		for (const unsigned char* limit = end - 16; p <= limit; p += 16) {
+			for (unsigned i = 0; i < 4; i++) {
+				v[i] = Round(v[i], Read32(p + i * 4));
+			}
+		}
+
+		h = RotL(v[0], 1) + RotL(v[1], 7) + RotL(v[2], 12) + RotL(v[3], 18);
+	} else {
+		h = seed + PRIME5;
+	}
+
+	h += size;
+
+	for (; (p + 4) <= end; p += 4) {
+		h = RotL(h + Read32(p) * PRIME3, 17) * PRIME4;
+	}
+	for (; p < end; p += 1) {
+		h = RotL(h + (*p) * PRIME5, 11) * PRIME1;
+	}
+
+	h ^= (h >> 15); h *= PRIME2;
+	h ^= (h >> 13); h *= PRIME3;
+	h ^= (h >> 16);
+	return h;
+}
+
+
+unsigned CSyncChecker::GetChecksum()
+{
+	unsigned subsystemChecksums[SYNC_SUBSYSTEM_COUNT];
+
+	GetSubsystemChecksums(subsystemChecksums);
+	return (HashBlock(subsystemChecksums, sizeof(subsystemChecksums), CHECKSUM_SEED));
+}
+
+void CSyncChecker::GetSubsystemChecksums(unsigned* subsystemChecksums)
+{
+	for (unsigned s = 0; s < SYNC_SUBSYSTEM_COUNT; s++) {
+		FlushBuffer(s);
+		subsystemChecksums[s] = checksums[s];
+	}
+}
+
+
+void CSyncChecker::NewFrame()
+{
+	for (unsigned s = 0; s < SYNC_SUBSYSTEM_COUNT; s++) {
+		buffers[s].size = 0;
+		checksums[s] = CHECKSUM_SEED;
+	}
+}
+
+
+void CSyncChecker::FlushBuffer(unsigned s)
+{
+	if (buffers[s].size == 0)
+		return;
+
+	HashDirect(s, buffers[s].data, buffers[s].size);
+	buffers[s].size = 0;
+}
+
+void CSyncChecker::HashDirect(unsigned s, const void* p, unsigned size)
+{
+	checksums[s] = HashBlock(p, size, checksums[s]);
+}
+
+
 #endif // SYNCDEBUG
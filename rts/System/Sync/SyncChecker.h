@@ -14,15 +14,45 @@
 #endif
 
 #include <assert.h>
+#include <cstring>
 
 /**
  * @brief sync checker class
  *
  * A Lightweight sync debugger that just keeps a running checksum over all
  * assignments to synced variables.
+ *
+ * Assignments are collected per subsystem (units, projectiles, ...) in small
+ * buffers which are hashed a block at a time, so individual writes cost only
+ * a memcpy. The per-subsystem checksums are exchanged every now and then to
+ * tell which part of the simulation went out of sync first.
  */
 class CSyncChecker {
 
+	public:
+		enum Subsystem {
+			SYNC_MISC        = 0,
+			SYNC_UNITS       = 1,
+			SYNC_PROJECTILES = 2,
+			SYNC_FEATURES    = 3,
+			SYNC_PATH        = 4,
+			SYNC_LUA         = 5,
+			SYNC_SUBSYSTEM_COUNT
+		};
+
+		/**
+		 * @brief marks the synced writes of a scope as belonging to subsystem s
+		 *
+		 * Scopes nest; whatever was active before is restored on exit.
+		 */
+		class ScopedSubsystem {
+			public:
+				ScopedSubsystem(Subsystem s, bool enabled = true): prevSubsystem(curSubsystem) { if (enabled) curSubsystem = s; }
+				~ScopedSubsystem() { curSubsystem = prevSubsystem; }
+			private:
+				Subsystem prevSubsystem;
+		};
+
 	public:
 		/**
 		 * Whether one thread (doesn't have to be the current thread!!!) is currently processing a SimFrame.
@@ -32,66 +62,67 @@ class CSyncChecker {
 		static void LeaveSyncedCode() { assert(InSyncedCode()); --inSyncedCode; }
 
 		/**
-		 * Keeps a running checksum over all assignments to synced variables.
+		 * Keeps a running checksum over all assignments to synced variables,
+		 * combined from the subsystem checksums.
 		 */
-		static unsigned GetChecksum() { return g_checksum; }
-		static void NewFrame() { g_checksum = 0xfade1eaf; }
+		static unsigned GetChecksum();
+		/// fills checksums[SYNC_SUBSYSTEM_COUNT]
+		static void GetSubsystemChecksums(unsigned* checksums);
+		static const char* GetSubsystemName(unsigned s) {
+			// inline, the dedicated server does not link SyncChecker.cpp
+			static const char* names[SYNC_SUBSYSTEM_COUNT] = {"misc", "units", "projectiles", "features", "path", "lua"};
+			return ((s < SYNC_SUBSYSTEM_COUNT)? names[s]: "unknown");
+		}
+
+		static void NewFrame();
 
 		static void Sync(const void* p, unsigned size) {
-			// most common cases first, make it easy for compiler to optimize for it
-			// simple xor is not enough to detect multiple zeroes, e.g.
+			const unsigned s = curSubsystem;
+
 #ifdef TRACE_SYNC_HEAVY
-			g_checksum = HsiehHash((const char*)p, size, g_checksum);
+			// every write is traced, so always keep the checksum current
+			checksums[s] = HsiehHash((const char*)p, size, checksums[s]);
 #else
-			switch(size) {
-			case 1:
-				g_checksum += *(const unsigned char*)p;
-				g_checksum ^= g_checksum << 10;
-				g_checksum += g_checksum >> 1;
-				break;
-			case 2:
-				g_checksum += *(const unsigned short*)(const char*)p;
-				g_checksum ^= g_checksum << 11;
-				g_checksum += g_checksum >> 17;
-				break;
-			case 3:
-				// just here to make the switch statements contiguous (so it can be optimized)
-				for (unsigned i = 0; i < 3; ++i) {
-					g_checksum += *(const unsigned char*)p + i;
-					g_checksum ^= g_checksum << 10;
-					g_checksum += g_checksum >> 1;
-				}
-				break;
-			case 4:
-				g_checksum += *(const unsigned int*)(const char*)p;
-				g_checksum ^= g_checksum << 16;
-				g_checksum += g_checksum >> 11;
-				break;
-			default:
-			{
-				unsigned i = 0;
-				for (; i < (size & ~3) / 4; ++i) {
-					g_checksum += *(reinterpret_cast<const unsigned int*>(p) + i);
-					g_checksum ^= g_checksum << 16;
-					g_checksum += g_checksum >> 11;
-				}
-				for (; i < size; ++i) {
-					g_checksum += *(const unsigned char*)p + i;
-					g_checksum ^= g_checksum << 10;
-					g_checksum += g_checksum >> 1;
+			SyncBuffer& buffer = buffers[s];
+
+			// read once; keeps the copy in bounds even if (erroneously) called from several threads
+			unsigned bufferSize = buffer.size;
+
+			if ((bufferSize + size) > SYNC_BUFFER_SIZE) {
+				FlushBuffer(s);
+				bufferSize = 0;
+
+				if (size > SYNC_BUFFER_SIZE) {
+					HashDirect(s, p, size);
+					return;
 				}
-				break;
-			}
 			}
+
+			std::memcpy(&buffer.data[bufferSize], p, size);
+			buffer.size = bufferSize + size;
 #endif
 		}
 
 	private:
+		static void FlushBuffer(unsigned s);
+		static void HashDirect(unsigned s, const void* p, unsigned size);
+
+	private:
+		static constexpr unsigned SYNC_BUFFER_SIZE = 1024;
+
+		struct SyncBuffer {
+			unsigned char data[SYNC_BUFFER_SIZE];
+			unsigned size;
+		};
+
+		static SyncBuffer buffers[SYNC_SUBSYSTEM_COUNT];
 
 		/**
-		 * The sync checksum
+		 * The sync checksum of each subsystem
 		 */
-		static unsigned g_checksum;
+		static unsigned checksums[SYNC_SUBSYSTEM_COUNT];
+
+		static Subsystem curSubsystem;
 
 		/**
 		 * @brief in synced code
@@ -70,6 +70,15 @@ namespace Sync {
 #  define LEAVE_SYNCED_CODE()
 #endif
 
+// attributes the synced writes of the enclosing scope to a CSyncChecker subsystem
+#ifdef SYNCCHECK
+#  define SCOPED_SYNC_SUBSYSTEM(s) CSyncChecker::ScopedSubsystem __syncSubsystem(CSyncChecker::s)
+#  define SCOPED_SYNC_SUBSYSTEM_IF(c, s) CSyncChecker::ScopedSubsystem __syncSubsystem(CSyncChecker::s, (c))
+#else
+#  define SCOPED_SYNC_SUBSYSTEM(s)
+#  define SCOPED_SYNC_SUBSYSTEM_IF(c, s)
+#endif
+
 #ifdef SYNCDEBUG
 #  define ASSERT_SYNCED(x) Sync::AssertDebugger(x, "assert(" #x ")")
 #else
@@ -0,0 +1,107 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _LOCK_STATS_H
+#define _LOCK_STATS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "System/Misc/SpringTime.h"
+
+/**
+ * @brief contention counters for a few engine-wide locks
+ *
+ * Every acquisition first tries to take the lock without blocking; only if
+ * that fails is the time spent blocking measured, so uncontended locks cost
+ * one relaxed atomic increment more than a plain std::lock_guard.
+ *
+ * Header-only since the instrumented locks are also compiled into unitsync,
+ * the dedicated server and the tests.
+ */
+namespace LockStats {
+	enum LockID {
+		LOCK_LUA   = 0,
+		LOCK_SOUND = 1,
+		LOCK_LOG   = 2,
+		NUM_LOCKS  = 3,
+	};
+
+	struct Stats {
+		uint64_t numLocks;
+		uint64_t numContended;
+		// nanoseconds spent blocking on contended acquisitions
+		uint64_t sumWaitTime;
+		uint64_t maxWaitTime;
+	};
+
+	struct Counters {
+		std::atomic<uint64_t> numLocks;
+		std::atomic<uint64_t> numContended;
+		std::atomic<uint64_t> sumWaitTime;
+		std::atomic<uint64_t> maxWaitTime;
+	};
+
+	// zero-initialized before any lock can be taken
+	inline std::array<Counters, NUM_LOCKS>& GetCounters() {
+		static std::array<Counters, NUM_LOCKS> counters;
+		return counters;
+	}
+
+	inline const char* GetLockName(unsigned int lockID) {
+		constexpr const char* names[NUM_LOCKS] = {"Lua", "Sound", "Log"};
+		return ((lockID < NUM_LOCKS)? names[lockID]: "(unknown)");
+	}
+
+	/// totals since the engine started
+	inline Stats GetStats(unsigned int lockID) {
+		const Counters& c = GetCounters()[lockID];
+
+		return {
+			c.numLocks.load(std::memory_order_relaxed),
+			c.numContended.load(std::memory_order_relaxed),
+			c.sumWaitTime.load(std::memory_order_relaxed),
+			c.maxWaitTime.load(std::memory_order_relaxed),
+		};
+	}
+
+
+	template<typename M> void Lock(M& mutex, unsigned int lockID) {
+		Counters& c = GetCounters()[lockID];
+
+		c.numLocks.fetch_add(1, std::memory_order_relaxed);
+
+		if (mutex.try_lock())
+			return;
+
+		const spring_time t0 = spring_now();
+
+		mutex.lock();
+
+		const uint64_t waitTime = (spring_now() - t0).toNanoSecsi();
+
+		c.numContended.fetch_add(1, std::memory_order_relaxed);
+		c.sumWaitTime.fetch_add(waitTime, std::memory_order_relaxed);
+
+		for (uint64_t maxWaitTime = c.maxWaitTime.load(std::memory_order_relaxed); waitTime > maxWaitTime; ) {
+			if (c.maxWaitTime.compare_exchange_weak(maxWaitTime, waitTime, std::memory_order_relaxed))
+				break;
+		}
+	}
+
+
+	/// drop-in replacement for std::lock_guard
+	template<typename M> class ScopedLock {
+	public:
+		ScopedLock(M& m, unsigned int lockID): mutex(m) { Lock(mutex, lockID); }
+		~ScopedLock() { mutex.unlock(); }
+
+		ScopedLock(const ScopedLock&) = delete;
+		ScopedLock& operator = (const ScopedLock&) = delete;
+
+	private:
+		M& mutex;
+	};
+}
+
+#endif // _LOCK_STATS_H
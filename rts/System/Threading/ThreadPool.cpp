@@ -10,6 +10,7 @@
 #endif
 #include "System/TimeProfiler.h"
 #include "System/StringUtil.h"
+#include "System/bitops.h"
 #ifndef UNIT_TEST
 	#include "System/Config/ConfigHandler.h"
 #endif
@@ -22,6 +23,7 @@
 #undef unlikely
 #endif
 
+#include <algorithm>
 #include <utility>
 #include <functional>
 
@@ -52,6 +54,11 @@ struct ThreadStats {
 	uint64_t sumWaitTime;
 	uint64_t minWaitTime;
 	uint64_t maxWaitTime;
+	uint64_t numRangeSteals;
+	uint64_t numStealAttempts;
+	uint64_t numWaits;
+	uint64_t sumIdleTime;
+	uint64_t sumBlockTime;
 };
 
 
@@ -136,6 +143,50 @@ int GetMaxThreads() { return std::min(MAX_THREADS, Threading::GetPhysicalCpuCore
 
 bool HasThreads() { return !workerThreads[false].empty(); }
 
+void AddRangeSteal(int tid)
+{
+	#ifdef USE_TASK_STATS_TRACKING
+	// only ever called by the stealing thread itself
+	threadStats[false][tid].numRangeSteals += 1;
+	#endif
+}
+
+void AddStealAttempt(int tid)
+{
+	#ifdef USE_TASK_STATS_TRACKING
+	threadStats[false][tid].numStealAttempts += 1;
+	#endif
+}
+
+WorkerStats GetWorkerStats(int tid, bool async)
+{
+	WorkerStats ws = {0, 0, 0, 0, 0, 0, 0};
+
+	#ifdef USE_TASK_STATS_TRACKING
+	// written without synchronization by the owning thread, values can lag
+	const ThreadStats& ts = threadStats[async][tid];
+
+	ws.numTasksRun = ts.numTasksRun;
+	ws.numStealAttempts = ts.numStealAttempts;
+	ws.numRangeSteals = ts.numRangeSteals;
+	ws.numWaits = ts.numWaits;
+	ws.sumExecTime = ts.sumExecTime;
+	ws.sumIdleTime = ts.sumIdleTime;
+	ws.sumBlockTime = ts.sumBlockTime;
+	#endif
+
+	return ws;
+}
+
+#ifdef USE_TASK_STATS_TRACKING
+// time since t0 that was not spent executing tasks (sumExecTime0 is the value at t0)
+static uint64_t GetNonExecTime(const ThreadStats& ts, spring_time t0, uint64_t sumExecTime0)
+{
+	const int64_t dt = (spring_now() - t0).toNanoSecsi() - int64_t(ts.sumExecTime - sumExecTime0);
+	return (std::max(dt, int64_t(0)));
+}
+#endif
+
 
 
 static bool DoTask(int tid, bool async)
@@ -228,15 +279,24 @@ static void WorkerLoop(int tid, bool async)
 	const auto maxSleepTime = spring_time::fromMilliSecs(30);
 
 	while (!exitFlags[tid]) {
-		const auto spinlockEnd = spring_now() + ourSpinTime;
+		const auto spinlockBeg = spring_now();
+		const auto spinlockEnd = spinlockBeg + ourSpinTime;
 		      auto sleepTime   = spring_time::fromMicroSecs(1);
 
+		#ifdef USE_TASK_STATS_TRACKING
+		const uint64_t sumExecTime = threadStats[async][tid].sumExecTime;
+		#endif
+
 		while (!DoTask(tid, async) && !exitFlags[tid]) {
 			if (spring_now() < spinlockEnd)
 				continue;
 
 			newTasksSignal[async].wait_for(sleepTime = std::min(sleepTime * 1.25f, maxSleepTime));
 		}
+
+		#ifdef USE_TASK_STATS_TRACKING
+		threadStats[async][tid].sumIdleTime += GetNonExecTime(threadStats[async][tid], spinlockBeg, sumExecTime);
+		#endif
 	}
 }
 
@@ -278,6 +338,11 @@ void WaitForFinished(std::shared_ptr<ITaskGroup>&& taskGroup)
 	// task hasn't completed yet, use waiting time to execute other tasks
 	NotifyWorkerThreads(true, false);
 
+	#ifdef USE_TASK_STATS_TRACKING
+	const spring_time waitTime = spring_now();
+	const uint64_t sumExecTime = threadStats[false][tid].sumExecTime;
+	#endif
+
 	do {
 		const auto spinlockEnd = spring_now() + spring_time::fromMilliSecs(500);
 
@@ -291,6 +356,11 @@ void WaitForFinished(std::shared_ptr<ITaskGroup>&& taskGroup)
 		}
 	} while (!taskGroup->IsFinished() && !exitFlags[tid]);
 
+	#ifdef USE_TASK_STATS_TRACKING
+	threadStats[false][tid].numWaits += 1;
+	threadStats[false][tid].sumBlockTime += GetNonExecTime(threadStats[false][tid], waitTime, sumExecTime);
+	#endif
+
 	while (taskGroup->IsInJobQueue()) {
 		DoTask(tid, false);
 	}
@@ -458,6 +528,62 @@ static std::uint32_t FindWorkerThreadCore(std::int32_t index, std::uint32_t avai
 
 
 
+// places the main (sim + render) thread on a fast core of the L3-domain with
+// the most fast cores, and orders the remaining CPU's for the pool workers:
+// physical cores sharing that L3 first, then those of other domains, fast
+// core types before slow ones within each, and SMT siblings last
+static std::uint32_t GetTopologyPlacement(std::uint32_t systemCores, std::vector<int>& workerCPUs)
+{
+	const Threading::CpuTopology& topo = Threading::GetCpuTopology();
+
+	workerCPUs.clear();
+
+	if (!topo.IsValid())
+		return 0;
+
+	const std::uint32_t mainCandidates = systemCores & topo.primaryThreadMask & topo.perfCoreMask;
+
+	std::uint32_t mainDomain = 0;
+	unsigned int mainDomainSize = 0;
+
+	for (int n = 0; n < 32; n++) {
+		if ((mainCandidates & (1u << n)) == 0)
+			continue;
+
+		const std::uint32_t domain = (topo.l3DomainMasks[n] != 0)? topo.l3DomainMasks[n]: systemCores;
+		const unsigned int domainSize = count_bits_set(domain & mainCandidates);
+
+		if (domainSize <= mainDomainSize)
+			continue;
+
+		mainDomain = domain;
+		mainDomainSize = domainSize;
+	}
+
+	if (mainDomainSize == 0)
+		return 0;
+
+	const std::uint32_t mainCPU = (mainDomain & mainCandidates) & -(mainDomain & mainCandidates);
+	const std::uint32_t mainCores = topo.smtSiblingMasks[count_bits_set(mainCPU - 1)] & systemCores;
+
+	for (int n = 0; n < 32; n++) {
+		if (((systemCores & ~mainCores) & (1u << n)) != 0)
+			workerCPUs.push_back(n);
+	}
+
+	const auto GetRank = [&](int n) {
+		int rank = 0;
+		rank += (((topo.primaryThreadMask >> n) & 1) == 0) * 4;
+		rank += ((         (mainDomain >> n) & 1) == 0) * 2;
+		rank += (((     topo.perfCoreMask >> n) & 1) == 0) * 1;
+		return rank;
+	};
+
+	std::stable_sort(workerCPUs.begin(), workerCPUs.end(), [&](int a, int b) { return (GetRank(a) < GetRank(b)); });
+	return mainCores;
+}
+
+
 void SetThreadCount(int wantedNumThreads)
 {
 	const int curNumThreads = GetNumThreads(); // includes main
@@ -467,7 +593,7 @@ void SetThreadCount(int wantedNumThreads)
 		"[ThreadPool::%s][1] wanted=%d current=%d maximum=%d (init=%d)",
 		"[ThreadPool::%s][2] workers=%lu",
 		"\t[async=%d] threads=%d tasks=%lu {sum,avg}{exec,wait}time={{%.3f, %.3f}, {%.3f, %.3f}}ms",
-		"\t\tthread=%d tasks=%lu {sum,min,max,avg}{exec,wait}time={{%.3f, %.3f, %.3f, %.3f}, {%.3f, %.3f, %.3f, %.3f}}ms",
+		"\t\tthread=%d tasks=%lu steals=%lu/%lu {sum,min,max,avg}{exec,wait}time={{%.3f, %.3f, %.3f, %.3f}, {%.3f, %.3f, %.3f, %.3f}}ms {idle,blocked}time={%.3f, %.3f}ms",
 	};
 
 	// total number of tasks executed by pool; total time spent in DoTask
@@ -495,6 +621,11 @@ void SetThreadCount(int wantedNumThreads)
 				threadStats[async][i].sumWaitTime = std::numeric_limits<uint64_t>::min();
 				threadStats[async][i].minWaitTime = std::numeric_limits<uint64_t>::max();
 				threadStats[async][i].maxWaitTime = std::numeric_limits<uint64_t>::min();
+				threadStats[async][i].numRangeSteals = 0;
+				threadStats[async][i].numStealAttempts = 0;
+				threadStats[async][i].numWaits = 0;
+				threadStats[async][i].sumIdleTime = 0;
+				threadStats[async][i].sumBlockTime = 0;
 			}
 		}
 		#endif
@@ -541,7 +672,7 @@ void SetThreadCount(int wantedNumThreads)
 				const float tAvgExecTime = tSumExecTime / std::max(ts.numTasksRun, uint64_t(1));
 				const float tAvgWaitTime = tSumWaitTime / std::max(ts.numTasksRun, uint64_t(1));
 
-				LOG(fmts[3], i, ts.numTasksRun,  tSumExecTime, tMinExecTime, tMaxExecTime, tAvgExecTime,  tSumWaitTime, tMinWaitTime, tMaxWaitTime, tAvgWaitTime);
+				LOG(fmts[3], i, ts.numTasksRun, ts.numRangeSteals, ts.numStealAttempts,  tSumExecTime, tMinExecTime, tMaxExecTime, tAvgExecTime,  tSumWaitTime, tMinWaitTime, tMaxWaitTime, tAvgWaitTime,  ts.sumIdleTime * 1e-6f, ts.sumBlockTime * 1e-6f);
 			}
 		}
 	}
@@ -582,6 +713,12 @@ void SetDefaultThreadCount()
 
 	std::uint32_t workerAvailCores = systemCores & ~mainAffinity;
 
+	// without an explicit main-thread mask, place threads by CPU topology
+	std::vector<int> workerCPUs;
+
+	if (mainAffinity == 0 && (mainAffinity = GetTopologyPlacement(systemCores, workerCPUs)) != 0)
+		workerAvailCores = systemCores & ~mainAffinity;
+
 	SetThreadCount(GetDefaultNumWorkers());
 
 	{
@@ -595,7 +732,9 @@ void SetDefaultThreadCount()
 			if (i == 0)
 				return 0;
 
-			const std::uint32_t workerCore = FindWorkerThreadCore(i - 1, workerAvailCores, mainAffinity);
+			const std::uint32_t workerCore = ((i - 1) < workerCPUs.size())?
+				(1u << workerCPUs[i - 1]):
+				FindWorkerThreadCore(i - 1, workerAvailCores, mainAffinity);
 			// const std::uint32_t workerCore = workerAvailCores;
 
 			Threading::SetAffinity(workerCore);
@@ -610,6 +749,24 @@ void SetDefaultThreadCount()
 
 		Threading::SetAffinityHelper("Main", mainAffinity & mainCoreAffinity);
 	}
+
+	const Threading::CpuTopology& topo = Threading::GetCpuTopology();
+
+	if (!topo.IsValid())
+		return;
+
+	LOG("[ThreadPool::%s] CPU topology: %d physical cores (%d fast), %d L3-domain(s), SMT %s",
+		__func__, topo.numPhysicalCores, topo.numPerfCores, topo.numL3Domains, Threading::HasHyperThreading()? "on": "off");
+
+	for (size_t i = 0, n = std::min(workerCPUs.size(), size_t(GetNumThreads() - 1)); i < n; i++) {
+		const int cpu = workerCPUs[i];
+
+		LOG("[ThreadPool::%s] worker %u on CPU %d (%s core, %s L3%s)",
+			__func__, unsigned(i + 1), cpu,
+			((topo.perfCoreMask >> cpu) & 1)? "fast": "slow",
+			((topo.l3DomainMasks[cpu] & mainAffinity) != 0 || topo.l3DomainMasks[cpu] == 0)? "main-thread": "other",
+			((topo.primaryThreadMask >> cpu) & 1)? "": ", SMT sibling");
+	}
 }
 
 
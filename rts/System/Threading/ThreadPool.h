@@ -3,6 +3,24 @@
 #ifndef _THREADPOOL_H
 #define _THREADPOOL_H
 
+#include <cstdint>
+
+namespace ThreadPool {
+	struct WorkerStats {
+		uint64_t numTasksRun;
+		uint64_t numStealAttempts;
+		uint64_t numRangeSteals;
+		uint64_t numWaits;
+
+		// nanoseconds spent running tasks, waiting for new tasks (workers)
+		// and waiting in WaitForFinished for tasks run by other threads
+		uint64_t sumExecTime;
+		uint64_t sumIdleTime;
+		uint64_t sumBlockTime;
+	};
+}
+
+
 #ifndef THREADPOOL
 #include  <functional>
 #include "System/Threading/SpringThreading.h"
@@ -26,6 +44,7 @@ namespace ThreadPool {
 	static inline int GetNumThreads() { return 1; }
 	static inline void NotifyWorkerThreads(bool force, bool async) {}
 	static inline bool HasThreads() { return false; }
+	static inline WorkerStats GetWorkerStats(int tid, bool async) { return {0, 0, 0, 0, 0, 0, 0}; }
 
 	static constexpr int MAX_THREADS = 1;
 }
@@ -48,6 +67,11 @@ static inline void for_mt2(int start, int end, unsigned worksize, const std::fun
 	for_mt(start, end, 1, std::move(f));
 }
 
+static inline void for_mt_dynamic(int start, int end, const std::function<void(const int i)>&& f)
+{
+	for_mt(start, end, 1, std::move(f));
+}
+
 
 static inline void parallel(const std::function<void()>&& f)
 {
@@ -106,6 +130,11 @@ namespace ThreadPool {
 	int GetMaxThreads();
 	int GetNumThreads();
 	void NotifyWorkerThreads(bool force, bool async);
+	void AddRangeSteal(int tid);
+	void AddStealAttempt(int tid);
+
+	/// totals since the pool was created, tid=0 is the main thread
+	WorkerStats GetWorkerStats(int tid, bool async);
 
 	static constexpr int MAX_THREADS = 16;
 }
@@ -637,6 +666,135 @@ private:
 
 
 
+// work-stealing variant of ForTaskGroup for loops with uneven per-index cost
+// each thread starts on its own contiguous sub-range and takes chunks from the
+// front (adaptively sized, shrinking as the range drains); a thread that runs
+// dry steals the back half of the largest remaining range instead of hammering
+// one shared counter
+template<typename F>
+class ForDynamicTaskGroup: public ITaskGroup
+{
+public:
+	ForDynamicTaskGroup(bool pooled) : ITaskGroup(false, pooled) {}
+
+	void Enqueue(const int from, const int to, F& func)
+	{
+		assert(to >= from);
+
+		const uint32_t numItems = to - from;
+		const uint32_t numParts = ThreadPool::GetNumThreads();
+
+		remainingTasks.store(numItems);
+
+		for (uint32_t i = 0; i < ranges.size(); i++) {
+			const uint32_t b = (numItems * uint64_t(std::min(i    , numParts))) / numParts;
+			const uint32_t e = (numItems * uint64_t(std::min(i + 1, numParts))) / numParts;
+
+			ranges[i].store(PackRange(b, e));
+		}
+
+		this->from = from;
+		this->func = func;
+	}
+
+	bool IsSliceTask() const override { return true; }
+	bool ExecuteStep() override
+	{
+		const int tid = ThreadPool::GetThreadNum();
+
+		uint32_t b = 0;
+		uint32_t e = 0;
+
+		if (!PopFront(tid, b, e) && !StealBack(tid, b, e))
+			return false;
+
+		for (uint32_t i = b; i < e; i++) {
+			func(from + i);
+		}
+
+		remainingTasks -= (e - b);
+		return true;
+	}
+
+private:
+	static uint64_t PackRange(uint32_t b, uint32_t e) { return ((uint64_t(e) << 32) | b); }
+	static uint32_t RangeBeg(uint64_t r) { return (r & 0xFFFFFFFFu); }
+	static uint32_t RangeEnd(uint64_t r) { return (r >> 32); }
+
+	bool PopFront(int tid, uint32_t& b, uint32_t& e) {
+		std::atomic<uint64_t>& range = ranges[tid];
+		uint64_t r = range.load();
+
+		while (RangeBeg(r) < RangeEnd(r)) {
+			// take ~1/8th of what is left, at least one item
+			const uint32_t n = std::max((RangeEnd(r) - RangeBeg(r)) >> 3, 1u);
+
+			if (range.compare_exchange_weak(r, PackRange(RangeBeg(r) + n, RangeEnd(r)))) {
+				b = RangeBeg(r);
+				e = RangeBeg(r) + n;
+				return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool StealBack(int tid, uint32_t& b, uint32_t& e) {
+		ThreadPool::AddStealAttempt(tid);
+
+		while (true) {
+			uint32_t victim = tid;
+			uint32_t maxSize = 0;
+
+			for (uint32_t i = 0; i < ranges.size(); i++) {
+				const uint64_t r = ranges[i].load(std::memory_order_relaxed);
+				const uint32_t n = RangeEnd(r) - std::min(RangeBeg(r), RangeEnd(r));
+
+				if (n <= maxSize)
+					continue;
+
+				victim = i;
+				maxSize = n;
+			}
+
+			if (maxSize == 0)
+				return false;
+
+			uint64_t r = ranges[victim].load();
+
+			if (RangeBeg(r) >= RangeEnd(r))
+				continue;
+
+			// a single remaining item is stolen whole
+			const uint32_t mid = RangeBeg(r) + ((RangeEnd(r) - RangeBeg(r)) >> 1);
+
+			if (!ranges[victim].compare_exchange_strong(r, PackRange(RangeBeg(r), mid)))
+				continue;
+
+			ThreadPool::AddRangeSteal(tid);
+
+			// our own range is empty, so only failed thief CAS's can touch it
+			// execute the first chunk of the loot now and keep the rest local
+			const uint32_t n = std::max((RangeEnd(r) - mid) >> 3, 1u);
+
+			ranges[tid].store(PackRange(mid + n, RangeEnd(r)));
+
+			b = mid;
+			e = mid + n;
+			return true;
+		}
+	}
+
+private:
+	// [begin, end) offsets relative to <from>, packed so owner and thieves can CAS them
+	std::array<std::atomic<uint64_t>, ThreadPool::MAX_THREADS> ranges;
+	std::function<void(const int)> func;
+
+	int from;
+};
+
+
+
 
 
 
@@ -720,6 +878,36 @@ static inline void for_mt(int start, int end, F&& f)
 	for_mt(start, end, 1, f);
 }
 
+// like for_mt, but balances loops whose iterations differ widely in cost
+// through per-thread ranges with work-stealing (see ForDynamicTaskGroup)
+template <typename F>
+static inline void for_mt_dynamic(int start, int end, F&& f)
+{
+	if (!ThreadPool::HasThreads() || ((end - start) < 2)) {
+		for (int i = start; i < end; ++i) {
+			f(i);
+		}
+		return;
+	}
+
+	SCOPED_MT_TIMER("::ThreadWorkers (dynamic)");
+
+	static TaskPool<ForDynamicTaskGroup, F> pool;
+	auto taskGroup = pool.GetTaskGroup();
+
+	taskGroup->Enqueue(start, end, f);
+	taskGroup->UpdateId();
+
+	assert(taskGroup->IsInJobQueue());
+
+	for (size_t i = 1; i < ThreadPool::GetNumThreads(); ++i) {
+		taskGroup->wantedThread.store(i);
+		ThreadPool::PushTaskGroup(taskGroup);
+	}
+
+	ThreadPool::WaitForFinished(taskGroup);
+}
+
 
 template <typename F>
 static inline void parallel(F&& f)
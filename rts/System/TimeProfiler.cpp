@@ -1,12 +1,19 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <algorithm>
+#include <array>
 #include <climits>
 #include <cstring>
+#include <fstream>
+#include <limits>
+#include <memory>
 
 #include "System/TimeProfiler.h"
+#include "System/AllocTracker.h"
 #include "System/GlobalRNG.h"
+#include "System/LoadTrace.h"
 #include "System/Log/ILog.h"
+#include "System/UnorderedSet.hpp"
 #include "System/Threading/SpringThreading.h"
 
 #ifdef THREADPOOL
@@ -20,6 +27,78 @@ static spring::unordered_map<int, int> refCounters;
 static CGlobalUnsyncedRNG profileColorRNG;
 
 
+/// slot 0 collects the time of all timers registered after the table is full
+static constexpr unsigned MAX_TIMERS = 512;
+
+static_assert(MAX_TIMERS <= AllocTracker::MAX_SCOPES, "timer ids must be valid AllocTracker scopes");
+
+struct TimerSlot {
+	// accumulated since the last CollectTimersRaw
+	std::atomic<std::int64_t> time;
+	std::atomic<std::int64_t> maxTime;
+	std::atomic<std::uint32_t> numCalls;
+	std::atomic<bool> showGraph;
+
+	std::atomic<std::int64_t> totalTime;
+
+	// constant after registration
+	unsigned nameHash;
+	std::string name;
+};
+
+static spring::mutex timerMutex;
+static spring::unordered_map<std::string, unsigned> timerIDs;
+static std::array<TimerSlot, MAX_TIMERS> timerSlots;
+static std::atomic<unsigned> numTimers{0};
+
+// nesting depth of each ScopedTimer (by id) on this thread
+static thread_local std::array<int, MAX_TIMERS> timerRefCounts;
+
+
+/// per thread; must be a power of two
+static constexpr unsigned TRACE_BUFFER_SIZE = 1 << 16;
+/// oldest events of full buffers not written out by StopTrace
+static constexpr unsigned TRACE_BUFFER_SLACK = 256;
+
+struct TraceEvent {
+	std::int64_t time;
+	unsigned nameHash;
+	bool begin;
+};
+
+struct TraceBuffer {
+	std::vector<TraceEvent> events;
+	std::atomic<std::uint64_t> numEvents;
+	std::atomic<unsigned> traceIndex;
+
+	/// hashes whose names were registered by this thread, never read by others
+	spring::unordered_set<unsigned> knownNames;
+};
+
+static spring::mutex traceMutex;
+// buffers of threads that have ended are kept, never freed while tracing
+static std::vector< std::unique_ptr<TraceBuffer> > traceBuffers;
+static spring::unordered_map<unsigned, std::string> traceNames;
+static std::atomic<unsigned> curTraceIndex{0};
+
+static thread_local TraceBuffer* threadTraceBuffer = nullptr;
+
+static std::string EscapeJSON(const std::string& str)
+{
+	std::string ret;
+
+	for (const char c: str) {
+		switch (c) {
+			case '"' : { ret += "\\\""; } break;
+			case '\\': { ret += "\\\\"; } break;
+			default  : { ret += ((c >= 0x20)? c: '?'); } break;
+		}
+	}
+
+	return ret;
+}
+
+
 
 static unsigned HashString(const char* s, size_t n)
 {
@@ -46,6 +125,7 @@ static unsigned HashString(const std::string& s) {
 
 BasicTimer::BasicTimer(const std::string& timerName)
 	: nameHash(HashString(timerName))
+	, timerID(INVALID_TIMER_ID)
 	, startTime(spring_gettime())
 
 	, name(timerName)
@@ -67,6 +147,7 @@ BasicTimer::BasicTimer(const std::string& timerName)
 
 BasicTimer::BasicTimer(const char* timerName)
 	: nameHash(HashString(timerName, std::string::npos))
+	, timerID(INVALID_TIMER_ID)
 	, startTime(spring_gettime())
 
 	, name(timerName)
@@ -85,6 +166,13 @@ BasicTimer::BasicTimer(const char* timerName)
 	}
 }
 
+BasicTimer::BasicTimer(unsigned timerID)
+	: nameHash(profiler.GetTimerNameHash(timerID))
+	, timerID(timerID)
+	, startTime(spring_gettime())
+{
+}
+
 spring_time BasicTimer::GetDuration() const
 {
 	return spring_difftime(spring_gettime(), startTime);
@@ -116,6 +204,8 @@ ScopedTimer::ScopedTimer(const char* timerName, bool _autoShowGraph, bool _speci
 	// note that address-comparison is intended here, timer names are (and must be) literals
 	, autoShowGraph(_autoShowGraph)
 	, specialTimer(_specialTimer)
+	, traced(profiler.IsTracing())
+	, prevAllocScope(AllocTracker::NO_SCOPE)
 {
 	auto iter = refCounters.find(nameHash);
 
@@ -123,10 +213,42 @@ ScopedTimer::ScopedTimer(const char* timerName, bool _autoShowGraph, bool _speci
 		iter = refCounters.insert(std::pair<int, int>(nameHash, 0)).first;
 
 	++(iter->second);
+
+	if (traced)
+		profiler.AddTraceEvent(timerName, nameHash, true);
+}
+
+ScopedTimer::ScopedTimer(unsigned timerID, bool _autoShowGraph, bool _specialTimer)
+	: BasicTimer(timerID)
+
+	, autoShowGraph(_autoShowGraph)
+	, specialTimer(_specialTimer)
+	, traced(profiler.IsTracing())
+{
+	timerRefCounts[timerID] += 1;
+
+	if (traced)
+		profiler.AddTraceEvent(timerSlots[timerID].name.c_str(), nameHash, true);
+
+	// last, so the profiler's own allocations are not charged to this scope
+	prevAllocScope = AllocTracker::EnterScope(timerID);
 }
 
 ScopedTimer::~ScopedTimer()
 {
+	if (timerID != INVALID_TIMER_ID)
+		AllocTracker::LeaveScope(prevAllocScope);
+
+	if (traced)
+		profiler.AddTraceEvent(nullptr, nameHash, false);
+
+	if (timerID != INVALID_TIMER_ID) {
+		if ((timerRefCounts[timerID] -= 1) == 0)
+			profiler.AddTime(timerID, startTime, GetDuration(), autoShowGraph, specialTimer, false);
+
+		return;
+	}
+
 	// no avoiding a second lookup since iterators can be invalidated with unordered_map
 	auto iter = refCounters.find(nameHash);
 
@@ -142,18 +264,21 @@ ScopedTimer::~ScopedTimer()
 
 ScopedOnceTimer::ScopedOnceTimer(const char* timerName)
 	: startTime(spring_gettime())
+	, startCpuTime(CLoadTrace::GetThreadCpuTime())
 	, name(timerName)
 {
 }
 
 ScopedOnceTimer::ScopedOnceTimer(const std::string& timerName)
 	: startTime(spring_gettime())
+	, startCpuTime(CLoadTrace::GetThreadCpuTime())
 	, name(timerName)
 {
 }
 
 ScopedOnceTimer::~ScopedOnceTimer()
 {
+	loadTrace.AddScope(name, startTime, spring_gettime(), CLoadTrace::GetThreadCpuTime() - startCpuTime);
 	LOG("[%s][%s] %ims", __func__, name.c_str(), int(GetDuration().toMilliSecsi()));
 }
 
@@ -179,12 +304,41 @@ ScopedMtTimer::ScopedMtTimer(const std::string& timerName, bool _autoShowGraph)
 ScopedMtTimer::ScopedMtTimer(const char* timerName, bool _autoShowGraph)
 	: BasicTimer(spring_gettime())
 	, autoShowGraph(_autoShowGraph)
+	, traced(profiler.IsTracing())
+	, traceNameHash(0)
+	, prevAllocScope(AllocTracker::NO_SCOPE)
 {
 	name = timerName;
+
+	if (traced)
+		profiler.AddTraceEvent(timerName, traceNameHash = HashString(timerName, std::string::npos), true);
+}
+
+ScopedMtTimer::ScopedMtTimer(unsigned timerID, bool _autoShowGraph)
+	: BasicTimer(timerID)
+	, autoShowGraph(_autoShowGraph)
+	, traced(profiler.IsTracing())
+	, traceNameHash(nameHash)
+{
+	if (traced)
+		profiler.AddTraceEvent(timerSlots[timerID].name.c_str(), traceNameHash, true);
+
+	prevAllocScope = AllocTracker::EnterScope(timerID);
 }
 
 ScopedMtTimer::~ScopedMtTimer()
 {
+	if (timerID != INVALID_TIMER_ID)
+		AllocTracker::LeaveScope(prevAllocScope);
+
+	if (traced)
+		profiler.AddTraceEvent(nullptr, traceNameHash, false);
+
+	if (timerID != INVALID_TIMER_ID) {
+		profiler.AddTime(timerID, startTime, GetDuration(), autoShowGraph, false, true);
+		return;
+	}
+
 	profiler.AddTime(GetName(), startTime, GetDuration(), autoShowGraph, false, true);
 }
 
@@ -196,7 +350,11 @@ ScopedMtTimer::~ScopedMtTimer()
 
 CTimeProfiler::CTimeProfiler()
 {
+	tracing = false;
 	ResetState();
+
+	// takes slot 0
+	RegisterTimer("Misc::Profiler::Overflow");
 }
 
 CTimeProfiler::~CTimeProfiler()
@@ -222,6 +380,15 @@ void CTimeProfiler::ResetState() {
 
 	profile.clear();
 	sortedProfile.clear();
+
+	// registrations are kept, call-sites hold on to their ids
+	for (TimerSlot& slot: timerSlots) {
+		slot.time = 0;
+		slot.maxTime = 0;
+		slot.numCalls = 0;
+		slot.showGraph = false;
+	}
+
 	#ifdef THREADPOOL
 	threadProfile.clear();
 	threadProfile.resize(ThreadPool::GetMaxThreads());
@@ -231,6 +398,7 @@ void CTimeProfiler::ResetState() {
 
 	currentPosition = 0;
 	resortProfiles = 0;
+	numUpdates = 0;
 
 	enabled = false;
 }
@@ -248,6 +416,7 @@ void CTimeProfiler::ToggleLock(bool lock)
 void CTimeProfiler::Update()
 {
 	if (!enabled) {
+		CollectTimersRaw();
 		UpdateRaw();
 		ResortProfilesRaw();
 		RefreshProfilesRaw();
@@ -258,6 +427,7 @@ void CTimeProfiler::Update()
 	std::unique_lock<spring::mutex> ulk(profileMutex, std::defer_lock);
 	while (!ulk.try_lock()) {}
 
+	CollectTimersRaw();
 	UpdateRaw();
 	ResortProfilesRaw();
 	RefreshProfilesRaw();
@@ -267,6 +437,7 @@ void CTimeProfiler::UpdateRaw()
 {
 	currentPosition += 1;
 	currentPosition &= (TimeRecord::numFrames - 1);
+	numUpdates += 1;
 
 	for (auto& pi: profile) {
 		pi.second.frames[currentPosition] = spring_notime;
@@ -283,6 +454,11 @@ void CTimeProfiler::UpdateRaw()
 			p.percent = spring_tomsecs(p.current) / timeDiff;
 			p.current = spring_notime;
 
+			p.allocsPerFrame = p.curAllocs / float(numUpdates);
+			p.allocKBPerFrame = p.curAllocBytes / (1024.0f * numUpdates);
+			p.curAllocs = 0;
+			p.curAllocBytes = 0;
+
 			p.newLagPeak = false;
 			p.newPeak = false;
 
@@ -292,6 +468,7 @@ void CTimeProfiler::UpdateRaw()
 			}
 		}
 		lastBigUpdate = curTime;
+		numUpdates = 0;
 	}
 
 	if (curTime.toSecsi() % 6 == 0) {
@@ -301,6 +478,33 @@ void CTimeProfiler::UpdateRaw()
 	}
 }
 
+void CTimeProfiler::CollectTimersRaw()
+{
+	const unsigned n = numTimers.load(std::memory_order_acquire);
+	const bool trackAllocs = AllocTracker::IsEnabled();
+
+	for (unsigned i = 0; i < n; i++) {
+		TimerSlot& slot = timerSlots[i];
+
+		// collected even for idle slots s.t. counts never go stale
+		const AllocTracker::ScopeStats allocStats = trackAllocs? AllocTracker::CollectScope(i): AllocTracker::ScopeStats();
+
+		if (slot.numCalls.load(std::memory_order_relaxed) == 0)
+			continue;
+
+		// a concurrent AddTime might land half in this and half in the next update
+		slot.numCalls.store(0, std::memory_order_relaxed);
+
+		const spring_time time = spring_time::fromNanoSecs(slot.time.exchange(0, std::memory_order_relaxed));
+		const spring_time maxTime = spring_time::fromNanoSecs(slot.maxTime.exchange(0, std::memory_order_relaxed));
+
+		AddTimeRaw(slot.name, time, maxTime, slot.showGraph.load(std::memory_order_relaxed));
+
+		if (trackAllocs)
+			AddAllocsRaw(slot.name, allocStats.numAllocs, allocStats.numBytes);
+	}
+}
+
 void CTimeProfiler::ResortProfilesRaw()
 {
 	if (resortProfiles > 0) {
@@ -380,8 +584,8 @@ void CTimeProfiler::AddTime(
 			return;
 
 		assert(!threadTimer);
-		AddTimeRaw(name, startTime, deltaTime, showGraph, threadTimer);
-		AddTimeRaw("Misc::Profiler::AddTime", t0, spring_now() - t0, false, false);
+		AddTimeRaw(name, deltaTime, deltaTime, showGraph);
+		AddTimeRaw("Misc::Profiler::AddTime", spring_now() - t0, spring_now() - t0, false);
 		return;
 	}
 
@@ -390,22 +594,72 @@ void CTimeProfiler::AddTime(
 	std::unique_lock<spring::mutex> ulk(profileMutex, std::defer_lock);
 	while (!ulk.try_lock()) {}
 
-	AddTimeRaw(name, startTime, deltaTime, showGraph, threadTimer);
-	AddTimeRaw("Misc::Profiler::AddTime", t0, spring_now() - t0, false, false);
+	if (threadTimer)
+		AddThreadSpanRaw(startTime);
+
+	AddTimeRaw(name, deltaTime, deltaTime, showGraph);
+	AddTimeRaw("Misc::Profiler::AddTime", spring_now() - t0, spring_now() - t0, false);
 }
 
-void CTimeProfiler::AddTimeRaw(
-	const std::string& name,
+void CTimeProfiler::AddTime(
+	unsigned timerID,
 	const spring_time startTime,
 	const spring_time deltaTime,
 	const bool showGraph,
+	const bool specialTimer,
 	const bool threadTimer
 ) {
+	if (!enabled && !specialTimer)
+		return;
+
+	TimerSlot& slot = timerSlots[timerID];
+
+	const std::int64_t time = deltaTime.toNanoSecsi();
+
+	slot.time.fetch_add(time, std::memory_order_relaxed);
+	slot.totalTime.fetch_add(time, std::memory_order_relaxed);
+	slot.numCalls.fetch_add(1, std::memory_order_relaxed);
+
+	for (std::int64_t maxTime = slot.maxTime.load(std::memory_order_relaxed); time > maxTime; ) {
+		if (slot.maxTime.compare_exchange_weak(maxTime, time, std::memory_order_relaxed))
+			break;
+	}
+
+	if (showGraph)
+		slot.showGraph.store(true, std::memory_order_relaxed);
+
+	// spans are only drawn (and recorded) while enabled, the rest is lock-free
+	if (!threadTimer || !enabled)
+		return;
+
+	std::unique_lock<spring::mutex> ulk(profileMutex, std::defer_lock);
+	while (!ulk.try_lock()) {}
+
+	AddThreadSpanRaw(startTime);
+}
+
+void CTimeProfiler::AddThreadSpanRaw(const spring_time startTime)
+{
 #ifdef THREADPOOL
-	if (threadTimer)
-		threadProfile[ThreadPool::GetThreadNum()].emplace_back(startTime, spring_gettime());
+	threadProfile[ThreadPool::GetThreadNum()].emplace_back(startTime, spring_gettime());
 #endif
+}
 
+void CTimeProfiler::AddAllocsRaw(const std::string& name, std::uint64_t numAllocs, std::uint64_t numBytes)
+{
+	// only called after AddTimeRaw, the record exists
+	TimeRecord& p = profile[name];
+
+	p.curAllocs += numAllocs;
+	p.curAllocBytes += numBytes;
+}
+
+void CTimeProfiler::AddTimeRaw(
+	const std::string& name,
+	const spring_time deltaTime,
+	const spring_time maxDeltaTime,
+	const bool showGraph
+) {
 	auto pi = profile.find(name);
 	auto& p = (pi != profile.end())? pi->second: profile[name];
 
@@ -413,8 +667,8 @@ void CTimeProfiler::AddTimeRaw(
 	p.total   += deltaTime;
 	p.current += deltaTime;
 
-	p.newLagPeak = (p.maxLag > 0.0f && deltaTime.toMilliSecsf() > p.maxLag);
-	p.maxLag     = std::max(p.maxLag, deltaTime.toMilliSecsf());
+	p.newLagPeak = (p.maxLag > 0.0f && maxDeltaTime.toMilliSecsf() > p.maxLag);
+	p.maxLag     = std::max(p.maxLag, maxDeltaTime.toMilliSecsf());
 
 	if (pi != profile.end()) {
 		// profile already exists
@@ -430,6 +684,156 @@ void CTimeProfiler::AddTimeRaw(
 	}
 }
 
+unsigned CTimeProfiler::RegisterTimer(const char* name)
+{
+	std::lock_guard<spring::mutex> lck(timerMutex);
+
+	const auto it = timerIDs.find(name);
+
+	if (it != timerIDs.end())
+		return it->second;
+
+	const unsigned timerID = numTimers.load(std::memory_order_relaxed);
+
+	if (timerID == MAX_TIMERS) {
+		LOG_L(L_WARNING, "[TimeProfiler::%s] too many timers, \"%s\" is counted as \"%s\"", __func__, name, timerSlots[0].name.c_str());
+		return 0;
+	}
+
+	TimerSlot& slot = timerSlots[timerID];
+	slot.nameHash = HashString(name, std::string::npos);
+	slot.name = name;
+
+	timerIDs.emplace(name, timerID);
+	// publishes the slot's name to CollectTimersRaw
+	numTimers.store(timerID + 1, std::memory_order_release);
+	return timerID;
+}
+
+unsigned CTimeProfiler::GetTimerNameHash(unsigned timerID) const
+{
+	// the caller got the id from RegisterTimer, so the slot is visible
+	return timerSlots[timerID].nameHash;
+}
+
+unsigned CTimeProfiler::GetNumTimers() const { return (numTimers.load(std::memory_order_acquire)); }
+const std::string& CTimeProfiler::GetTimerName(unsigned timerID) const { return timerSlots[timerID].name; }
+
+spring_time CTimeProfiler::GetTimerTotal(unsigned timerID) const
+{
+	return (spring_time::fromNanoSecs(timerSlots[timerID].totalTime.load(std::memory_order_relaxed)));
+}
+
+
+void CTimeProfiler::StartTrace()
+{
+	// threads notice the new index on their next event and restart their buffers
+	curTraceIndex += 1;
+	tracing = true;
+}
+
+bool CTimeProfiler::StopTrace(const std::string& filePath)
+{
+	if (!tracing.exchange(false))
+		return false;
+
+	return (WriteTraceEvents(filePath, std::numeric_limits<std::int64_t>::min(), std::numeric_limits<std::int64_t>::max()));
+}
+
+bool CTimeProfiler::WriteTrace(const std::string& filePath, spring_time beginTime, spring_time endTime) const
+{
+	if (!IsTracing())
+		return false;
+
+	return (WriteTraceEvents(filePath, beginTime.toMicroSecsi(), endTime.toMicroSecsi()));
+}
+
+bool CTimeProfiler::WriteTraceEvents(const std::string& filePath, std::int64_t minTime, std::int64_t maxTime) const
+{
+	std::ofstream file(filePath);
+
+	if (!file.is_open())
+		return false;
+
+	std::lock_guard<spring::mutex> lck(traceMutex);
+
+	const char* sep = "";
+
+	file << "{\"traceEvents\":[\n";
+
+	for (size_t i = 0; i < traceBuffers.size(); i++) {
+		const TraceBuffer* buffer = traceBuffers[i].get();
+
+		if (buffer->traceIndex.load(std::memory_order_acquire) != curTraceIndex)
+			continue;
+
+		const std::uint64_t numEvents = buffer->numEvents.load(std::memory_order_acquire);
+		// threads still ending their traced scopes could be overwriting the oldest slots of a full buffer
+		const std::uint64_t minEvent = (numEvents > TRACE_BUFFER_SIZE)? (numEvents - TRACE_BUFFER_SIZE + TRACE_BUFFER_SLACK): 0;
+
+		for (std::uint64_t n = minEvent; n < numEvents; n++) {
+			const TraceEvent& e = buffer->events[n & (TRACE_BUFFER_SIZE - 1)];
+
+			if (e.time < minTime || e.time > maxTime)
+				continue;
+
+			const auto it = traceNames.find(e.nameHash);
+
+			file << sep << "{\"name\":\"" << ((it != traceNames.end())? EscapeJSON(it->second): "?") << "\",\"cat\":\"engine\"";
+			file << ",\"ph\":\"" << (e.begin? "B": "E") << "\",\"ts\":" << e.time << ",\"pid\":0,\"tid\":" << i << "}";
+			sep = ",\n";
+		}
+	}
+
+	file << "\n]}\n";
+	return (file.good());
+}
+
+void CTimeProfiler::AddTraceEvent(const char* name, unsigned nameHash, bool begin)
+{
+	TraceBuffer* buffer = threadTraceBuffer;
+
+	if (buffer == nullptr) {
+		std::lock_guard<spring::mutex> lck(traceMutex);
+
+		traceBuffers.emplace_back(new TraceBuffer());
+
+		buffer = threadTraceBuffer = traceBuffers.back().get();
+		buffer->events.resize(TRACE_BUFFER_SIZE);
+		buffer->numEvents = 0;
+		buffer->traceIndex = curTraceIndex.load();
+	}
+
+	// only the owning thread writes to its buffer, so no lock is needed here
+	const unsigned traceIndex = curTraceIndex.load(std::memory_order_relaxed);
+
+	if (buffer->traceIndex.load(std::memory_order_relaxed) != traceIndex) {
+		buffer->numEvents.store(0, std::memory_order_relaxed);
+		buffer->traceIndex.store(traceIndex, std::memory_order_release);
+	}
+
+	if (begin && buffer->knownNames.insert(nameHash).second) {
+		std::lock_guard<spring::mutex> lck(traceMutex);
+		traceNames.emplace(nameHash, name);
+	}
+
+	const std::uint64_t numEvents = buffer->numEvents.load(std::memory_order_relaxed);
+
+	TraceEvent& e = buffer->events[numEvents & (TRACE_BUFFER_SIZE - 1)];
+	e.time = spring_gettime().toMicroSecsi();
+	e.nameHash = nameHash;
+	e.begin = begin;
+
+	buffer->numEvents.store(numEvents + 1, std::memory_order_release);
+}
+
+
+void CTimeProfiler::GetThreadProfile(std::vector< std::deque< std::pair<spring_time, spring_time> > >& spans) const
+{
+	std::lock_guard<spring::mutex> lck(profileMutex);
+	spans = threadProfile;
+}
+
 void CTimeProfiler::PrintProfilingInfo() const
 {
 	if (sortedProfile.empty())
@@ -4,6 +4,7 @@
 #define TIME_PROFILER_H
 
 #include <atomic>
+#include <cstdint>
 #include <cstring> // memset
 #include <string>
 #include <deque>
@@ -16,23 +17,33 @@
 
 // disable this if you want minimal profiling
 // (sim time is still measured because of game slowdown)
-#define SCOPED_TIMER(name) ScopedTimer __scopedTimer(name);
-#define SCOPED_SPECIAL_TIMER(name) ScopedTimer __scopedTimer(name, false, true)
-#define SCOPED_MT_TIMER(name) ScopedMtTimer __scopedTimer(name);
+//
+// names must be literals; every call-site registers its name once (on first
+// use) and from then on only passes around the id, see RegisterTimer
+#define SCOPED_TIMER(name) static const unsigned __scopedTimerID = profiler.RegisterTimer("" name); ScopedTimer __scopedTimer(__scopedTimerID);
+#define SCOPED_SPECIAL_TIMER(name) static const unsigned __scopedTimerID = profiler.RegisterTimer("" name); ScopedTimer __scopedTimer(__scopedTimerID, false, true)
+#define SCOPED_MT_TIMER(name) static const unsigned __scopedTimerID = profiler.RegisterTimer("" name); ScopedMtTimer __scopedTimer(__scopedTimerID);
+// for names only known at runtime; looks the name up on every use
+#define SCOPED_NAMED_TIMER(name) ScopedTimer __scopedTimer(name);
+
+static constexpr unsigned INVALID_TIMER_ID = -1u;
 
 
 class BasicTimer : public spring::noncopyable
 {
 public:
-	BasicTimer(const spring_time time): nameHash(0), startTime(time) {}
+	BasicTimer(const spring_time time): nameHash(0), timerID(INVALID_TIMER_ID), startTime(time) {}
 	BasicTimer(const std::string& timerName);
 	BasicTimer(const char* timerName);
+	BasicTimer(unsigned timerID);
 
+	/// empty for timers constructed from an id
 	const std::string& GetName() const { return name; }
 	spring_time GetDuration() const;
 
 protected:
 	const unsigned nameHash;
+	const unsigned timerID;
 	const spring_time startTime;
 
 	std::string name;
@@ -50,11 +61,17 @@ class ScopedTimer : public BasicTimer
 public:
 	ScopedTimer(const std::string& timerName, bool _autoShowGraph = false, bool _specialTimer = false);
 	ScopedTimer(const char* timerName, bool _autoShowGraph = false, bool _specialTimer = false);
+	ScopedTimer(unsigned timerID, bool _autoShowGraph = false, bool _specialTimer = false);
 	~ScopedTimer();
 
 private:
 	const bool autoShowGraph;
 	const bool specialTimer;
+	/// whether the begin of this scope was traced
+	const bool traced;
+
+	/// AllocTracker scope to restore, only set for timers constructed from an id
+	unsigned prevAllocScope;
 };
 
 
@@ -63,16 +80,22 @@ class ScopedMtTimer : public BasicTimer
 public:
 	ScopedMtTimer(const std::string& timerName, bool _autoShowGraph = false);
 	ScopedMtTimer(const char* timerName, bool _autoShowGraph = false);
+	ScopedMtTimer(unsigned timerID, bool _autoShowGraph = false);
 	~ScopedMtTimer();
 
 private:
 	const bool autoShowGraph;
+	const bool traced;
+	unsigned traceNameHash;
+	unsigned prevAllocScope;
 };
 
 
 
 /**
  * @brief print passed time to infolog
+ *
+ * Also recorded as a scope of the load trace while that is active.
  */
 class ScopedOnceTimer
 {
@@ -85,6 +108,7 @@ public:
 
 protected:
 	const spring_time startTime;
+	const std::int64_t startCpuTime;
 
 	std::string name;
 };
@@ -114,6 +138,8 @@ public:
 	void Update();
 	void UpdateRaw();
 
+	/// moves the time accumulated by registered timers into profile
+	void CollectTimersRaw();
 	void ResortProfilesRaw();
 	void RefreshProfiles();
 	void RefreshProfilesRaw();
@@ -121,6 +147,24 @@ public:
 	void SetEnabled(bool b) { enabled = b; }
 	void PrintProfilingInfo() const;
 
+	// copies the busy-spans recorded per ThreadPool thread
+	void GetThreadProfile(std::vector< std::deque< std::pair<spring_time, spring_time> > >& spans) const;
+
+	/**
+	 * Returns the id of the timer called name, registering it if new; ids
+	 * stay valid (and keep their name) for the lifetime of the process.
+	 * Time added by id is accumulated atomically without locking and only
+	 * merged into profile by Update.
+	 */
+	unsigned RegisterTimer(const char* name);
+	unsigned GetTimerNameHash(unsigned timerID) const;
+
+	/// ids are [0, GetNumTimers())
+	unsigned GetNumTimers() const;
+	const std::string& GetTimerName(unsigned timerID) const;
+	/// all time ever added by id, never reset (not even by ResetState)
+	spring_time GetTimerTotal(unsigned timerID) const;
+
 	void AddTime(
 		const std::string& name,
 		const spring_time startTime,
@@ -129,13 +173,40 @@ public:
 		const bool specialTimer = false,
 		const bool threadTimer = false
 	);
+	void AddTime(
+		unsigned timerID,
+		const spring_time startTime,
+		const spring_time deltaTime,
+		const bool showGraph = false,
+		const bool specialTimer = false,
+		const bool threadTimer = false
+	);
+	/// maxDeltaTime is the longest single measurement within deltaTime
 	void AddTimeRaw(
 		const std::string& name,
-		const spring_time startTime,
 		const spring_time deltaTime,
-		const bool showGraph,
-		const bool threadTimer
+		const spring_time maxDeltaTime,
+		const bool showGraph
 	);
+	void AddThreadSpanRaw(const spring_time startTime);
+	void AddAllocsRaw(const std::string& name, std::uint64_t numAllocs, std::uint64_t numBytes);
+
+	/**
+	 * While tracing, ScopedTimer and ScopedMtTimer record their begin and end
+	 * (by name-hash) in a ring buffer of the thread running them; unlike AddTime
+	 * this takes no lock and keeps the nesting. StopTrace writes the latest
+	 * events of every thread in the Chrome trace-event format.
+	 */
+	void StartTrace();
+	bool StopTrace(const std::string& filePath);
+	/// stops tracing without writing the events out
+	void AbortTrace() { tracing = false; }
+	/// writes the events recorded during [beginTime, endTime] while tracing continues
+	bool WriteTrace(const std::string& filePath, spring_time beginTime, spring_time endTime) const;
+	bool IsTracing() const { return tracing.load(std::memory_order_relaxed); }
+
+	/// name is only read the first time a thread traces a hash
+	void AddTraceEvent(const char* name, unsigned nameHash, bool begin);
 
 public:
 	struct TimeRecord {
@@ -147,6 +218,11 @@ public:
 		, percent(0.0f)
 		, peak(0.0f)
 
+		, allocsPerFrame(0.0f)
+		, allocKBPerFrame(0.0f)
+		, curAllocs(0)
+		, curAllocBytes(0)
+
 		, newPeak(false)
 		, newLagPeak(false)
 		, showGraph(false)
@@ -164,6 +240,13 @@ public:
 		float percent;
 		float peak;
 
+		// AllocTracker counts, averaged like percent
+		float allocsPerFrame;
+		float allocKBPerFrame;
+
+		std::uint64_t curAllocs;
+		std::uint64_t curAllocBytes;
+
 		float3 color;
 
 		bool newPeak;
@@ -176,15 +259,22 @@ public:
 	std::vector< std::pair<std::string, TimeRecord> > sortedProfile;
 	std::vector< std::deque< std::pair<spring_time, spring_time> > > threadProfile;
 
+private:
+	/// times in microseconds
+	bool WriteTraceEvents(const std::string& filePath, std::int64_t minTime, std::int64_t maxTime) const;
+
 private:
 	spring_time lastBigUpdate;
 
 	/// increases each update, from 0 to (numFrames-1)
 	unsigned currentPosition;
 	unsigned resortProfiles;
+	/// since percentages were last updated
+	unsigned numUpdates;
 
 	// if false, AddTime is a no-op for (almost) all timers
 	std::atomic<bool> enabled;
+	std::atomic<bool> tracing;
 };
 
 #define profiler (CTimeProfiler::GetInstance())
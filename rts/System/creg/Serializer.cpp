@@ -108,6 +108,10 @@ void ReadVarSizeUInt(std::istream* stream, T* buf)
 template<typename T>
 void WriteVarSizeUInt(std::ostream* stream, T val)
 {
+	// encode first, one stream write per value instead of per byte
+	unsigned char buf[10];
+	unsigned int len = 0;
+
 	std::uint64_t v = val;
 	do {
 		unsigned char a = v & 0x7F;
@@ -116,8 +120,10 @@ void WriteVarSizeUInt(std::ostream* stream, T val)
 		if (v > 0)
 			a |= 0x80;
 
-		stream->write((char*)&a, sizeof(char));
+		buf[len++] = a;
 	} while (v > 0);
+
+	stream->write((char*)&buf[0], len);
 }
 
 //-------------------------------------------------------------------------
@@ -135,59 +141,56 @@ bool COutputStreamSerializer::IsWriting()
 
 COutputStreamSerializer::ObjectRef* COutputStreamSerializer::FindObjectRef(void* inst, creg::Class* objClass, bool isEmbedded)
 {
-	std::vector<ObjectRef*>* refs = &(ptrToId[inst]);
-	for (std::vector<ObjectRef*>::iterator i = refs->begin(); i != refs->end(); ++i) {
-		if ((*i)->isThisObject(inst, objClass, isEmbedded))
-			return *i;
+	const auto it = ptrToRef.find(inst);
+
+	if (it == ptrToRef.end())
+		return nullptr;
+
+	for (ObjectRef* ref = it->second; ref != nullptr; ref = ref->nextRef) {
+		if (ref->isThisObject(inst, objClass, isEmbedded))
+			return ref;
 	}
 	return nullptr;
 }
 
+COutputStreamSerializer::ObjectRef* COutputStreamSerializer::AddObjectRef(void* inst, creg::Class* objClass, bool isEmbedded)
+{
+	objects.emplace_back(inst, objects.size(), isEmbedded, objClass);
+
+	ObjectRef* obj = &objects.back();
+	ObjectRef*& head = ptrToRef[inst];
+
+	// prepend, at most a handful of references share an address
+	obj->nextRef = head;
+	head = obj;
+	return obj;
+}
+
 void COutputStreamSerializer::SerializeObject(Class* c, void* ptr, ObjectRef* objr)
 {
-	const unsigned objstart = stream->tellp();
+	// per-class statistics are only logged at debug level, tellp is not free
+	const bool trackSizes = LOG_IS_ENABLED(L_DEBUG);
+	const unsigned objstart = trackSizes? unsigned(stream->tellp()): 0;
 
 	if (c->base())
 		SerializeObject(c->base(), ptr, objr);
 
-	ObjectMemberGroup omg;
-	omg.membersClass = c;
-	omg.size = 0;
-
 	for (uint a = 0; a < c->members.size(); a++)
 	{
 		creg::Class::Member* m = &c->members[a];
 		if (m->flags & CM_NoSerialize)
 			continue;
 
-		ObjectMember om;
-		om.member = m;
-		om.memberId = a;
 		void* memberAddr = ((char*)ptr) + m->offset;
-		unsigned mstart = stream->tellp();
 		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s::%s type:%s", c->name, m->name, m->type->GetName().c_str());
 		m->type->Serialize(this, memberAddr);
-		unsigned mend = stream->tellp();
-		om.size = mend - mstart;
-		omg.members.push_back(om);
-		omg.size += om.size;
-		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s::%s type:%s size:%d", c->name, m->name, m->type->GetName().c_str(), om.size);
 	}
 
-
-	if (c->HasSerialize()) {
-		ObjectMember om;
-		om.member = nullptr;
-		om.memberId = -1;
-		unsigned mstart = stream->tellp();
+	if (c->HasSerialize())
 		c->CallSerializeProc(ptr, this);
-		unsigned mend = stream->tellp();
-		om.size = mend - mstart;
-		omg.members.push_back(om);
-		omg.size += om.size;
-	}
 
-	objr->memberGroups.push_back(omg);
+	if (!trackSizes)
+		return;
 
 	const unsigned objend = stream->tellp();
 	const int sz = objend - objstart;
@@ -200,21 +203,16 @@ void COutputStreamSerializer::SerializeObjectInstance(void* inst, creg::Class* o
 	// register the object, and mark it as embedded if a pointer was already referencing it
 	ObjectRef* obj = FindObjectRef(inst, objClass, true);
 	if (!obj) {
-		objects.emplace_back(inst, objects.size(), true, objClass);
-		obj = &objects.back();
-		ptrToId[inst].push_back(obj);
+		obj = AddObjectRef(inst, objClass, true);
 	} else if (obj->isEmbedded) {
 		throw std::string("Reserialization of embedded object (") + objClass->name + ")";
-	} else {
-		std::vector<ObjectRef*>::iterator it = std::find(pendingObjects.begin(), pendingObjects.end(), obj);
-		if (it == pendingObjects.end()) {
-			throw std::string("Object pointer was serialized (") + objClass->name + ")";
-		} else {
-			pendingObjects.erase(it);
-		}
+	} else if (!obj->isPending) {
+		throw std::string("Object pointer was serialized (") + objClass->name + ")";
 	}
+	// if still pending, the object is written here and skipped by SavePackage
 	obj->class_ = objClass;
 	obj->isEmbedded = true;
+	obj->isPending = false;
 
 	// write an object ID
 	WriteVarSizeUInt(stream, obj->id);
@@ -230,9 +228,8 @@ void COutputStreamSerializer::SerializeObjectPtr(void** ptr, creg::Class* objCla
 		int id;
 		ObjectRef* obj = FindObjectRef(*ptr, objClass, false);
 		if (!obj) {
-			objects.push_back(ObjectRef(*ptr, objects.size(), false, objClass));
-			obj = &objects.back();
-			ptrToId[*ptr].push_back(obj);
+			obj = AddObjectRef(*ptr, objClass, false);
+			obj->isPending = true;
 			pendingObjects.push_back(obj);
 		}
 		id = obj->id;
@@ -285,28 +282,25 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	ph.objDataOffset = (int)stream->tellp();
 
 	// Insert dummy object with id 0
-	objects.push_back(ObjectRef(0, 0, true, 0));
-	ObjectRef* obj = &objects.back();
-	obj->classIndex = 0;
+	objects.emplace_back(nullptr, 0, true, nullptr);
 
 	// Insert the first object that will provide references to everything
-	objects.push_back(ObjectRef(rootObj, objects.size(), false, rootObjClass));
-	obj = &objects.back();
-	ptrToId[rootObj].push_back(obj);
+	ObjectRef* obj = AddObjectRef(rootObj, rootObjClass, false);
+	obj->isPending = true;
 	pendingObjects.push_back(obj);
 
-	// Save until all the referenced objects have been stored
-	while (!pendingObjects.empty())
+	// Save until all the referenced objects have been stored; objects are
+	// written in the order of their IDs, which LoadPackage relies on
+	for (size_t i = 0; i < pendingObjects.size(); i++)
 	{
-		const std::vector<ObjectRef*> po = pendingObjects;
-		pendingObjects.clear();
-
-		for (std::vector<ObjectRef*>::const_iterator i = po.begin(); i != po.end(); ++i)
-		{
-			ObjectRef* obj = *i;
-			SerializeObject(obj->class_, obj->ptr, obj);
-			//LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s size:%i", obj->class_->name.c_str(), sz);
-		}
+		ObjectRef* obj = pendingObjects[i];
+
+		// embedded into another object meanwhile
+		if (!obj->isPending)
+			continue;
+
+		obj->isPending = false;
+		SerializeObject(obj->class_, obj->ptr, obj);
 	}
 
 	// Collect a set of all used classes
@@ -382,7 +376,7 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 			ph.metadataChecksum, int(objects.size()), int(classRefs.size()));
 
 	stream->seekp(endOffset);
-	ptrToId.clear();
+	ptrToRef.clear();
 	pendingObjects.clear();
 	objects.clear();
 }
@@ -543,7 +537,11 @@ void CInputStreamSerializer::LoadPackage(std::istream* s, void*& root, creg::Cla
 	if (checksum != ph.metadataChecksum)
 		throw std::runtime_error("Metadata checksum error: Package file was saved with a different version");
 
-	// Create all non-embedded objects
+	// Read the object table first, instances are created once the
+	// per-class counts are known
+	std::vector<size_t> objectSizes(ph.numObjects, 0);
+	std::vector<size_t> classCounts(ph.numObjClassRefs, 0);
+
 	s->seekg(ph.objTableOffset);
 	objects.resize(ph.numObjects);
 	for (int a = 0; a < ph.numObjects; a++)
@@ -552,6 +550,10 @@ void CInputStreamSerializer::LoadPackage(std::istream* s, void*& root, creg::Cla
 		char isEmbedded;
 		ReadVarSizeUInt(stream, &classRefIndex);
 		stream->read((char*)&isEmbedded, sizeof(char));
+
+		if (classRefIndex >= classRefs.size())
+			throw std::runtime_error("Package file contains an object of unknown class");
+
 		Class* c = classRefs[classRefIndex];
 
 		objects[a].obj = NULL;
@@ -562,14 +564,26 @@ void CInputStreamSerializer::LoadPackage(std::istream* s, void*& root, creg::Cla
 			} else {
 				size = c->size;
 			}
-			// Allocate and construct
-			void* inst = c->CreateInstance(size);
-			objects[a].obj = inst;
+			objectSizes[a] = size;
+			classCounts[classRefIndex] += 1;
 		}
 		objects[a].isEmbedded = !!isEmbedded;
 		objects[a].classRef = classRefIndex;
 	}
 
+	if (reserveCallback != nullptr)
+		reserveCallback(classRefs, classCounts);
+
+	// Create all non-embedded objects
+	for (int a = 0; a < ph.numObjects; a++)
+	{
+		if (objects[a].isEmbedded)
+			continue;
+
+		// Allocate and construct
+		objects[a].obj = classRefs[objects[a].classRef]->CreateInstance(objectSizes[a]);
+	}
+
 	int endOffset = s->tellg();
 
 	// Read the object data using serialization
@@ -8,11 +8,14 @@
 
 #ifdef USING_CREG
 
+#include <cstdint>
 #include <map>
 #include <vector>
 #include <deque>
 #include <istream>
 
+#include "System/UnorderedMap.hpp"
+
 namespace creg {
 
 	/**
@@ -23,43 +26,24 @@ namespace creg {
 	class COutputStreamSerializer : public ISerializer
 	{
 	protected:
-		struct ObjectMember {
-			Class::Member* member;
-			int memberId;
-			int size;
-		};
-		struct ObjectMemberGroup {
-			Class* membersClass;
-			std::vector<COutputStreamSerializer::ObjectMember> members;
-			int size;
-		};
 		struct ObjectRef {
-			ObjectRef() {
-				ptr = 0;
-				id=0;
-				classIndex=0;
-				isEmbedded=false;
-				class_=0;
-			}
 			ObjectRef(void* ptr, int id, bool isEmbedded, Class* class_) {
 				this->ptr = ptr;
-				this->id=id;
-				classIndex=0;
-				this->isEmbedded=isEmbedded;
-				this->class_=class_;
-			}
-			ObjectRef(const ObjectRef&src) :memberGroups(src.memberGroups){
-				ptr=src.ptr;
-				id=src.id;
-				classIndex=src.classIndex;
-				isEmbedded=src.isEmbedded;
-				class_=src.class_;
+				this->nextRef = nullptr;
+				this->id = id;
+				this->classIndex = 0;
+				this->isEmbedded = isEmbedded;
+				this->isPending = false;
+				this->class_ = class_;
 			}
 			void* ptr;
+			// next reference to the same address (e.g. an object and its first embedded member)
+			ObjectRef* nextRef;
 			int id, classIndex;
 			bool isEmbedded;
+			// referenced through a pointer and neither written nor embedded yet
+			bool isPending;
 			Class* class_;
-			std::vector<COutputStreamSerializer::ObjectMemberGroup> memberGroups;
 			bool isThisObject(void* objPtr, Class* objClass, bool objEmbedded) const
 			{
 				if (ptr != objPtr) return false;
@@ -77,11 +61,21 @@ namespace creg {
 			}
 		};
 
+		struct PtrHash {
+			size_t operator()(const void* p) const {
+				// objects are aligned, mix the upper bits into the lower ones used for bucket selection
+				const std::uint64_t x = reinterpret_cast<std::uintptr_t>(p);
+				return ((x * 0x9E3779B97F4A7C15ull) >> 32);
+			}
+		};
+
 		// Temporary class reference
 		struct ClassRef;
 
 		std::ostream* stream;
-		std::map<void*,std::vector<ObjectRef*> > ptrToId;
+		// first reference per address, see ObjectRef::nextRef
+		spring::unsynced_map<void*, ObjectRef*, PtrHash> ptrToRef;
+		// deque: references have to stay valid while objects are being added
 		std::deque<ObjectRef> objects;
 		std::vector<ObjectRef*> pendingObjects; // these objects still have to be saved
 		std::map<Class*, int> classSizes;
@@ -93,6 +87,7 @@ namespace creg {
 		void WriteObjectRef(void* inst, Class* cls, bool embedded);
 
 		ObjectRef* FindObjectRef(void* inst, Class* objClass, bool isEmbedded);
+		ObjectRef* AddObjectRef(void* inst, Class* objClass, bool isEmbedded);
 
 		void SerializeObject(Class* c, void* ptr, ObjectRef* objr);
 
@@ -157,6 +152,17 @@ namespace creg {
 		};
 		std::vector<PostLoadCallback> callbacks;
 
+	public:
+		/**
+		 * Receives the number of non-embedded objects of every class in the
+		 * package (parallel to the classes array) before any is created, so
+		 * pools can be grown in one go instead of page by page.
+		 */
+		typedef void (*ReserveCallback)(const std::vector<Class*>& classes, const std::vector<size_t>& counts);
+
+	protected:
+		ReserveCallback reserveCallback = nullptr;
+
 		void SerializeObject(Class* c, void* ptr);
 	public:
 		CInputStreamSerializer();
@@ -180,6 +186,8 @@ namespace creg {
 		/** @see ISerializer::AddPostLoadCallback */
 		void AddPostLoadCallback(void (*cb)(void* userdata), void* userdata);
 
+		void SetReserveCallback(ReserveCallback cb) { reserveCallback = cb; }
+
 		/** Load a package that is saved by CInputStreamSerializer
 		 * @param s the input stream to read from
 		 * @param root the root object address will be assigned to this
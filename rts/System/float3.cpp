@@ -4,6 +4,8 @@
 #include "System/creg/creg_cond.h"
 #include "System/myMath.h"
 
+#include <cstring>
+
 CR_BIND(float3, )
 CR_REG_METADATA(float3, (CR_MEMBER(x), CR_MEMBER(y), CR_MEMBER(z)))
 
@@ -60,6 +62,86 @@ float3 float3::fabs(const float3 v)
 	return float3(std::fabs(v.x), std::fabs(v.y), std::fabs(v.z));
 }
 
+
+void float3::Lengths(const float3* vecs, float* lengths, size_t count)
+{
+	size_t i = 0;
+
+	#ifndef DEDICATED_NOSSE
+	for (; (i + 4) <= count; i += 4) {
+		const float3* v = &vecs[i];
+
+		const __m128 vx = _mm_setr_ps(v[0].x, v[1].x, v[2].x, v[3].x);
+		const __m128 vy = _mm_setr_ps(v[0].y, v[1].y, v[2].y, v[3].y);
+		const __m128 vz = _mm_setr_ps(v[0].z, v[1].z, v[2].z, v[3].z);
+
+		// (x*x + y*y) + z*z like SqLength, sqrtps rounds exactly like sqrtss
+		const __m128 sql = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+
+		_mm_storeu_ps(&lengths[i], _mm_sqrt_ps(sql));
+	}
+	#endif
+
+	for (; i < count; i++) {
+		lengths[i] = vecs[i].Length();
+	}
+}
+
+void float3::SafeNormalize(float3* vecs, size_t count)
+{
+	size_t i = 0;
+
+	#ifndef DEDICATED_NOSSE
+	for (; (i + 4) <= count; i += 4) {
+		float3* v = &vecs[i];
+
+		const __m128 vx = _mm_setr_ps(v[0].x, v[1].x, v[2].x, v[3].x);
+		const __m128 vy = _mm_setr_ps(v[0].y, v[1].y, v[2].y, v[3].y);
+		const __m128 vz = _mm_setr_ps(v[0].z, v[1].z, v[2].z, v[3].z);
+		const __m128 sql = _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+
+		// math::isqrt (fastmath::isqrt2_nosse) lane by lane; the initial guess
+		// needs integer math which SSE1 lacks, the Newton steps do not
+		float sqls[4];
+		float isqs[4];
+		_mm_storeu_ps(sqls, sql);
+
+		for (int k = 0; k < 4; k++) {
+			std::int32_t n;
+			std::memcpy(&n, &sqls[k], sizeof(n));
+			n = 0x5f375a86 - (n >> 1);
+			std::memcpy(&isqs[k], &n, sizeof(n));
+		}
+
+		const __m128 xh = _mm_mul_ps(_mm_set1_ps(0.5f), sql);
+		const __m128 c = _mm_set1_ps(1.5f);
+
+		__m128 isq = _mm_loadu_ps(isqs);
+		isq = _mm_mul_ps(isq, _mm_sub_ps(c, _mm_mul_ps(xh, _mm_mul_ps(isq, isq))));
+		isq = _mm_mul_ps(isq, _mm_sub_ps(c, _mm_mul_ps(xh, _mm_mul_ps(isq, isq))));
+
+		// leave (near-)zero vectors untouched, scaling by one is exact
+		const __m128 mask = _mm_cmpgt_ps(sql, _mm_set1_ps(nrm_eps()));
+		const __m128 scale = _mm_or_ps(_mm_and_ps(mask, isq), _mm_andnot_ps(mask, _mm_set1_ps(1.0f)));
+
+		float nx[4];
+		float ny[4];
+		float nz[4];
+		_mm_storeu_ps(nx, _mm_mul_ps(vx, scale));
+		_mm_storeu_ps(ny, _mm_mul_ps(vy, scale));
+		_mm_storeu_ps(nz, _mm_mul_ps(vz, scale));
+
+		for (int k = 0; k < 4; k++) {
+			v[k] = float3(nx[k], ny[k], nz[k]);
+		}
+	}
+	#endif
+
+	for (; i < count; i++) {
+		vecs[i].SafeNormalize();
+	}
+}
+
 bool float3::equals(const float3& f, const float3& eps) const
 {
 	return (epscmp(x, f.x, eps.x) && epscmp(y, f.y, eps.y) && epscmp(z, f.z, eps.z));
@@ -692,6 +692,10 @@ public:
 	static float3 max(const float3 v1, const float3 v2);
 	static float3 fabs(const float3 v);
 
+	/// batch Length and SafeNormalize, bitwise identical to the scalar versions (sync-safe)
+	static void Lengths(const float3* vecs, float* lengths, size_t count);
+	static void SafeNormalize(float3* vecs, size_t count);
+
 	#if (__cplusplus <= 199711L) && !defined(__GXX_EXPERIMENTAL_CXX0X__) && (!defined(__GNUC__) || defined (__clang__)) && !(_MSC_VER >= 1900)
 	static float cmp_eps() { return 1e-04f; }
 	static float nrm_eps() { return 1e-12f; }
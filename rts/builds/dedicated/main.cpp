@@ -1,6 +1,9 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <cstdlib>
+#include <memory>
 #include <string>
+#include <vector>
 
 #ifdef _WIN32
 #include <windows.h>
@@ -11,6 +14,7 @@
 #include "Game/GameData.h"
 #include "Game/GameVersion.h"
 #include "Net/GameServer.h"
+#include "Net/RelayServer.h"
 #include "System/Exceptions.h"
 #include "System/GlobalConfig.h"
 #include "System/GlobalRNG.h"
@@ -48,6 +52,10 @@ DEFINE_bool     (isolation,                            false, "Limit the data-di
 DEFINE_string_EX(isolation_dir,    "isolation-dir",    "",    "Specify the isolation-mode data-dir (see --isolation)");
 DEFINE_bool     (nocolor,                              false, "Disables colorized stdout");
 DEFINE_uint32   (sleeptime,                            1,     "Number of seconds to sleep between game-over checks");
+DEFINE_string   (relay,                                "",    "Instead of hosting a script, relay the game of the server (or relay) at <address>[:port] to spectators");
+DEFINE_uint32   (relayport,                            8452,  "Port on which to accept spectators in relay mode");
+DEFINE_string_EX(relay_name,       "relay-name",       "relay", "Spectator name used to join the upstream server in relay mode");
+DEFINE_string_EX(relay_passwd,     "relay-passwd",     "",    "Password used to join the upstream server in relay mode");
 
 #ifdef __cplusplus
 extern "C"
@@ -74,7 +82,7 @@ void ParseCmdLine(int argc, char* argv[], std::string& scriptName)
 	if (argc >= 2)
 		scriptName = argv[1];
 
-	if (scriptName.empty() && !FLAGS_list_config_vars) {
+	if (scriptName.empty() && !FLAGS_list_config_vars && FLAGS_relay.empty()) {
 		gflags::ShowUsageWithFlags(argv[0]);
 		exit(1);
 	}
@@ -106,6 +114,118 @@ void ParseCmdLine(int argc, char* argv[], std::string& scriptName)
 
 
 
+static void RunRelay(unsigned int sleepTime)
+{
+	const size_t sep = FLAGS_relay.rfind(':');
+
+	const std::string host = FLAGS_relay.substr(0, sep);
+	const unsigned int port = (sep != std::string::npos)? std::atoi(FLAGS_relay.c_str() + sep + 1): 8452;
+
+	LOG("starting relay...");
+
+	CRelayServer relay(host, port, FLAGS_relayport, FLAGS_relay_name, FLAGS_relay_passwd);
+
+	while (!relay.HasFinished()) {
+		spring_secs(sleepTime).sleep(true);
+	}
+}
+
+
+struct DedicatedGame {
+	std::string scriptName;
+
+	// server will take ownership of these
+	std::shared_ptr<ClientSetup> clientSetup;
+	std::shared_ptr<GameData> gameData;
+	std::shared_ptr<CGameSetup> gameSetup;
+
+	std::unique_ptr<CGameServer> server;
+
+	bool printedDemoInfo = false;
+};
+
+static bool LoadGame(const std::string& scriptName, CGlobalUnsyncedRNG& rng, bool unloadMap, DedicatedGame& game)
+{
+	LOG("loading script from file: %s", scriptName.c_str());
+
+	game.scriptName = scriptName;
+	game.clientSetup.reset(new ClientSetup());
+	game.gameData.reset(new GameData());
+	game.gameSetup.reset(new CGameSetup());
+
+	std::string scriptText;
+	CFileHandler fh(scriptName);
+
+	if (!fh.FileExists())
+		throw content_error("script does not exist in given location: " + scriptName);
+
+	if (!fh.LoadStringData(scriptText))
+		throw content_error("script cannot be read: " + scriptName);
+
+	game.clientSetup->LoadFromStartScript(scriptText);
+
+	if (!game.gameSetup->Init(scriptText)) {
+		// read the script provided by cmdline
+		LOG_L(L_ERROR, "failed to load script %s", scriptName.c_str());
+		return false;
+	}
+
+	game.gameData->SetRandomSeed(rng.NextInt());
+
+	//  Use script provided hashes if they exist
+	if (game.gameSetup->mapHash != 0) {
+		game.gameData->SetMapChecksum(game.gameSetup->mapHash);
+		game.gameSetup->LoadStartPositions(false); // reduced mode
+	} else {
+		const std::string& mapName = game.gameSetup->mapName;
+
+		game.gameData->SetMapChecksum(archiveScanner->GetArchiveCompleteChecksum(mapName));
+
+		CFileHandler f("maps/" + mapName);
+
+		const bool addMap = !f.FileExists();
+
+		if (addMap)
+			vfsHandler->AddArchiveWithDeps(mapName, false);
+
+		game.gameSetup->LoadStartPositions(); // full mode
+
+		// the map's mapinfo would shadow those of maps hosted later on
+		if (addMap && unloadMap) {
+			for (const std::string& archiveName: archiveScanner->GetAllArchivesUsedBy(mapName)) {
+				vfsHandler->RemoveArchive(archiveName);
+			}
+		}
+	}
+
+	if (game.gameSetup->modHash != 0) {
+		game.gameData->SetModChecksum(game.gameSetup->modHash);
+	} else {
+		const std::string& modArchive = archiveScanner->ArchiveFromName(game.gameSetup->modName);
+		const unsigned int modCheckSum = archiveScanner->GetArchiveCompleteChecksum(modArchive);
+		game.gameData->SetModChecksum(modCheckSum);
+	}
+
+	game.gameData->SetSetupText(game.gameSetup->setupText);
+	return true;
+}
+
+static void PrintDemoInfo(const DedicatedGame& game)
+{
+	const std::unique_ptr<CDemoRecorder>& demoRec = game.server->GetDemoRecorder();
+
+	if (demoRec == nullptr)
+		return;
+
+	const std::uint8_t* gameID = (demoRec->GetFileHeader()).gameID;
+
+	LOG("recording demo: %s", (demoRec->GetName()).c_str());
+	LOG("using mod: %s", (game.gameSetup->modName).c_str());
+	LOG("using map: %s", (game.gameSetup->mapName).c_str());
+	LOG("GameID: %02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x", gameID[0], gameID[1], gameID[2], gameID[3], gameID[4], gameID[5], gameID[6], gameID[7], gameID[8], gameID[9], gameID[10], gameID[11], gameID[12], gameID[13], gameID[14], gameID[15]);
+}
+
+
 int main(int argc, char* argv[])
 {
 	Threading::SetMainThread();
@@ -118,10 +238,9 @@ int main(int argc, char* argv[])
 		CLogOutput::LogSystemInfo();
 
 		std::string scriptName;
-		std::string scriptText;
 		std::string binaryName = argv[0];
 
-		gflags::SetUsageMessage("Usage: " + binaryName + " [options] path_to_script.txt");
+		gflags::SetUsageMessage("Usage: " + binaryName + " [options] path_to_script.txt [path_to_script2.txt ...]");
 		gflags::SetVersionString(SpringVersion::GetFull());
 		gflags::ParseCommandLineFlags(&argc, &argv, true);
 		ParseCmdLine(argc, argv, scriptName);
@@ -134,92 +253,80 @@ int main(int argc, char* argv[])
 		CrashHandler::Install();
 
 		LOG("report any errors to Mantis or the forums.");
-		LOG("loading script from file: %s", scriptName.c_str());
-
-		// server will take ownership of these
-		std::shared_ptr<ClientSetup> dsClientSetup(new ClientSetup());
-		std::shared_ptr<GameData> dsGameData(new GameData());
-		std::shared_ptr<CGameSetup> dsGameSetup(new CGameSetup());
-
-		CFileHandler fh(scriptName);
-
-		if (!fh.FileExists())
-			throw content_error("script does not exist in given location: " + scriptName);
 
-		if (!fh.LoadStringData(scriptText))
-			throw content_error("script cannot be read: " + scriptName);
+		if (!FLAGS_relay.empty()) {
+			RunRelay(FLAGS_sleeptime);
 
-		dsClientSetup->LoadFromStartScript(scriptText);
+			FileSystemInitializer::Cleanup();
+			GlobalConfig::Deallocate();
+			DataDirLocater::FreeInstance();
 
-		if (!dsGameSetup->Init(scriptText)) {
-			// read the script provided by cmdline
-			LOG_L(L_ERROR, "failed to load script %s", scriptName.c_str());
-			return 1;
+			spring_clock::PopTickRate();
+			return 0;
 		}
 
-		// Create the server, it will run in a separate thread
-		CGlobalUnsyncedRNG rng;
-
+		const std::vector<std::string> scriptNames(argv + 1, argv + argc);
 		const unsigned sleepTime = FLAGS_sleeptime;
 		const unsigned randSeed = time(nullptr) % ((spring_gettime().toNanoSecsi() + 1) * 9007);
 
+		// all games share this process' archive scanner and VFS
+		std::vector< std::unique_ptr<DedicatedGame> > games;
+		games.reserve(scriptNames.size());
+
+		CGlobalUnsyncedRNG rng;
 		rng.Seed(randSeed);
-		dsGameData->SetRandomSeed(rng.NextInt());
 
-		//  Use script provided hashes if they exist
-		if (dsGameSetup->mapHash != 0) {
-			dsGameData->SetMapChecksum(dsGameSetup->mapHash);
-			dsGameSetup->LoadStartPositions(false); // reduced mode
-		} else {
-			dsGameData->SetMapChecksum(archiveScanner->GetArchiveCompleteChecksum(dsGameSetup->mapName));
+		for (const std::string& name: scriptNames) {
+			std::unique_ptr<DedicatedGame> game(new DedicatedGame());
+
+			if (scriptNames.size() == 1) {
+				if (!LoadGame(name, rng, false, *game))
+					return 1;
+			} else {
+				// one broken script should not take down the other games
+				try {
+					if (!LoadGame(name, rng, true, *game))
+						continue;
+				} catch (const content_error& e) {
+					LOG_L(L_ERROR, "failed to load script %s: %s", name.c_str(), e.what());
+					continue;
+				}
+			}
 
-			CFileHandler f("maps/" + dsGameSetup->mapName);
-			if (!f.FileExists())
-				vfsHandler->AddArchiveWithDeps(dsGameSetup->mapName, false);
+			LOG("starting server for %s...", name.c_str());
 
-			dsGameSetup->LoadStartPositions(); // full mode
+			// runs in a separate thread
+			game->server.reset(new CGameServer(game->clientSetup, game->gameData, game->gameSetup));
+			games.push_back(std::move(game));
 		}
 
-		if (dsGameSetup->modHash != 0) {
-			dsGameData->SetModChecksum(dsGameSetup->modHash);
-		} else {
-			const std::string& modArchive = archiveScanner->ArchiveFromName(dsGameSetup->modName);
-			const unsigned int modCheckSum = archiveScanner->GetArchiveCompleteChecksum(modArchive);
-			dsGameData->SetModChecksum(modCheckSum);
-		}
-
-		LOG("starting server...");
-
-		{
-			dsGameData->SetSetupText(dsGameSetup->setupText);
-			CGameServer server(dsClientSetup, dsGameData, dsGameSetup);
+		if (games.empty())
+			return 1;
 
-			while (!server.HasGameID()) {
-				// wait until gameID has been generated or
-				// a timeout occurs (if no clients connect)
-				if (server.HasFinished())
-					break;
+		while (!games.empty()) {
+			for (auto it = games.begin(); it != games.end(); ) {
+				DedicatedGame* game = it->get();
+				CGameServer* server = game->server.get();
 
-				spring_sleep(spring_secs(sleepTime));
-			}
+				if (server->HasFinished()) {
+					LOG("game from %s has finished", (game->scriptName).c_str());
 
-			while (!server.HasFinished()) {
-				static bool printData = (server.GetDemoRecorder() != nullptr);
-
-				if (printData) {
-					printData = false;
+					// joins the server thread and finalizes its demo
+					it = games.erase(it);
+					continue;
+				}
 
-					const std::unique_ptr<CDemoRecorder>& demoRec = server.GetDemoRecorder();
-					const std::uint8_t* gameID = (demoRec->GetFileHeader()).gameID;
+				// wait until gameID has been generated
+				if (!game->printedDemoInfo && server->HasGameID()) {
+					game->printedDemoInfo = true;
 
-					LOG("recording demo: %s", (demoRec->GetName()).c_str());
-					LOG("using mod: %s", (dsGameSetup->modName).c_str());
-					LOG("using map: %s", (dsGameSetup->mapName).c_str());
-					LOG("GameID: %02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x%02x", gameID[0], gameID[1], gameID[2], gameID[3], gameID[4], gameID[5], gameID[6], gameID[7], gameID[8], gameID[9], gameID[10], gameID[11], gameID[12], gameID[13], gameID[14], gameID[15]);
+					PrintDemoInfo(*game);
 				}
 
-				spring_secs(sleepTime).sleep(true);
+				++it;
 			}
+
+			spring_secs(sleepTime).sleep(true);
 		}
 
 		LOG("exiting");
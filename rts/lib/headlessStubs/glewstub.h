@@ -42,6 +42,7 @@ extern "C" {
 #define GLEW_ARB_map_buffer_range GL_FALSE
 #define GLEW_EXT_texture_filter_anisotropic GL_FALSE
 #define GLEW_ARB_texture_float GL_FALSE
+#define GLEW_ARB_timer_query GL_FALSE
 #define GLEW_ARB_texture_non_power_of_two GL_TRUE
 #define GLEW_ARB_texture_env_combine GL_TRUE
 #define GLEW_ARB_texture_rectangle GL_TRUE
@@ -72,6 +73,7 @@ extern "C" {
 #define GLEW_EXT_blend_equation_separate GL_FALSE
 #define GLEW_EXT_blend_func_separate GL_FALSE
 #define GLEW_ARB_framebuffer_object GL_FALSE
+#define GLEW_ARB_get_program_binary GL_FALSE
 
 #define GLXEW_SGI_video_sync GL_FALSE
 
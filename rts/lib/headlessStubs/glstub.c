@@ -45,6 +45,10 @@ GLAPI void APIENTRY glEnableVertexAttribArray(GLuint index) {}
 GLAPI void APIENTRY glDisableVertexAttribArray(GLuint index) {}
 GLAPI void APIENTRY glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) {}
 GLAPI void APIENTRY glVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) {}
+GLAPI void APIENTRY glVertexAttribDivisor(GLuint index, GLuint divisor) {}
+GLAPI GLboolean APIENTRY glIsVertexArray(GLuint array) { return GL_FALSE; }
+GLAPI GLboolean APIENTRY glIsBuffer(GLuint buffer) { return GL_FALSE; }
+GLAPI void APIENTRY glTexBuffer(GLenum target, GLenum internalformat, GLuint buffer) {}
 
 GLAPI void APIENTRY glGenFramebuffers(GLsizei n, GLuint *framebuffers) {}
 GLAPI GLenum APIENTRY glCheckFramebufferStatus(GLenum target) { return 0; }
@@ -61,6 +65,9 @@ GLAPI void APIENTRY glDeleteProgram(GLuint program) {}
 GLAPI void APIENTRY glProgramParameteriEXT(GLuint program, GLenum pname, GLint value) {}
 GLAPI void APIENTRY glLinkProgram(GLuint program) {}
 GLAPI void APIENTRY glGetProgramiv(GLuint program, GLenum pname, GLint *params) {}
+GLAPI void APIENTRY glGetProgramBinary(GLuint program, GLsizei bufSize, GLsizei *length, GLenum *binaryFormat, void *binary) {}
+GLAPI void APIENTRY glProgramBinary(GLuint program, GLenum binaryFormat, const void *binary, GLsizei length) {}
+GLAPI void APIENTRY glProgramParameteri(GLuint program, GLenum pname, GLint value) {}
 GLAPI void APIENTRY glGetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog) {}
 
 GLAPI void APIENTRY glMultiTexCoord2fARB(GLenum target, GLfloat s, GLfloat t) {}
@@ -254,6 +261,10 @@ GLAPI void APIENTRY glGetFenceivNV(GLuint fence, GLenum pname, GLint *params) {}
 GLAPI void APIENTRY glFinishFenceNV(GLuint fence) {}
 GLAPI void APIENTRY glSetFenceNV(GLuint fence, GLenum condition) {}
 
+GLAPI GLsync APIENTRY glFenceSync(GLenum condition, GLbitfield flags) { return (GLsync) NULL; }
+GLAPI void APIENTRY glDeleteSync(GLsync sync) {}
+GLAPI GLenum APIENTRY glClientWaitSync(GLsync sync, GLbitfield flags, GLuint64 timeout) { return GL_ALREADY_SIGNALED; }
+
 GLAPI void APIENTRY glGetRenderbufferParameteriv(GLenum target, GLenum pname, GLint *params) {}
 GLAPI void APIENTRY glGetRenderbufferParameterivEXT(GLenum target, GLenum pname, GLint *params) {}
 GLAPI GLboolean APIENTRY glIsFramebuffer(GLuint framebuffer) { return GL_FALSE; }
@@ -400,6 +411,7 @@ GLAPI void APIENTRY glColorPointer(GLint size, GLenum type, GLsizei stride, cons
 GLAPI void APIENTRY glNormalPointer(GLenum type, GLsizei stride, const GLvoid *ptr) {}
 GLAPI void APIENTRY glDrawArrays(GLenum mode, GLint first, GLsizei count) {}
 GLAPI void APIENTRY glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei primcount) {}
+GLAPI void APIENTRY glMultiDrawArrays(GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawcount) {}
 
 GLAPI void APIENTRY glTexEnvi(GLenum target, GLenum pname, GLint param) {}
 
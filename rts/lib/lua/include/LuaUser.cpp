@@ -14,6 +14,7 @@
 
 #if (ENABLE_USERSTATE_LOCKS != 0)
 	#include "System/UnorderedMap.hpp"
+	#include "System/Threading/LockStats.h"
 	#include "System/Threading/SpringThreading.h"
 #endif
 
@@ -110,10 +111,8 @@ void LuaMutexLock(lua_State* L)
 
 	spring::recursive_mutex* mutex = GetLuaContextData(L)->luamutex;
 
-	if (mutex->try_lock())
-		return;
-
-	mutex->lock();
+	// counts towards the Lua lock contention stats
+	LockStats::Lock(*mutex, LockStats::LOCK_LUA);
 #endif
 }
 
@@ -0,0 +1,183 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "Benchmark.h"
+#include "System/Misc/SpringTime.h"
+
+struct Benchmark {
+	const char* name;
+	BenchmarkFunc func;
+};
+
+struct BenchmarkResult {
+	std::string name;
+
+	size_t numIterations;
+	size_t itemsPerIteration;
+	size_t numSamples;
+
+	// per iteration, in nanoseconds
+	double minTime;
+	double medianTime;
+	double meanTime;
+	double madTime;
+};
+
+static std::vector<Benchmark>& GetBenchmarks()
+{
+	static std::vector<Benchmark> benchmarks;
+	return benchmarks;
+}
+
+BenchmarkRegistrar::BenchmarkRegistrar(const char* name, BenchmarkFunc func)
+{
+	GetBenchmarks().push_back({name, func});
+}
+
+
+static double RunSample(const Benchmark& benchmark, BenchmarkState& state)
+{
+	state.itemsPerIteration = 1;
+
+	const spring_time t0 = spring_gettime();
+	benchmark.func(state);
+	const spring_time t1 = spring_gettime();
+
+	return ((t1 - t0).toNanoSecsi() * 1.0);
+}
+
+static BenchmarkResult RunBenchmark(const Benchmark& benchmark, size_t numSamples, double minSampleTime)
+{
+	BenchmarkState state;
+	state.numIterations = 1;
+	state.itemsPerIteration = 1;
+
+	// the first (smallest) samples also serve as warm-up
+	while (RunSample(benchmark, state) < minSampleTime && state.numIterations < (size_t(1) << 40))
+		state.numIterations *= 2;
+
+	for (int n = 0; n < 2; n++) {
+		RunSample(benchmark, state);
+	}
+
+	std::vector<double> times(numSamples);
+
+	for (double& t: times) {
+		t = RunSample(benchmark, state) / state.numIterations;
+	}
+
+	std::sort(times.begin(), times.end());
+
+	BenchmarkResult result;
+	result.name = benchmark.name;
+	result.numIterations = state.numIterations;
+	result.itemsPerIteration = state.itemsPerIteration;
+	result.numSamples = numSamples;
+	result.minTime = times.front();
+	result.medianTime = times[numSamples / 2];
+	result.meanTime = 0.0;
+
+	for (const double t: times) {
+		result.meanTime += (t / numSamples);
+	}
+
+	for (double& t: times) {
+		t = std::fabs(t - result.medianTime);
+	}
+
+	std::sort(times.begin(), times.end());
+
+	result.madTime = times[numSamples / 2];
+	return result;
+}
+
+
+static bool WriteJSON(const char* fileName, const char* binaryName, const std::vector<BenchmarkResult>& results)
+{
+	FILE* f = fopen(fileName, "w");
+
+	if (f == nullptr)
+		return false;
+
+	std::string binary;
+
+	for (const char* c = binaryName; *c != 0; c++) {
+		if (*c == '"' || *c == '\\')
+			binary += '\\';
+
+		binary += *c;
+	}
+
+	// benchmark names are identifiers, no escaping needed
+	fprintf(f, "{\"binary\":\"%s\",\"benchmarks\":[", binary.c_str());
+
+	for (size_t n = 0; n < results.size(); n++) {
+		const BenchmarkResult& r = results[n];
+
+		fprintf(f, "%s\n{\"name\":\"%s\",\"iterations\":%u,\"samples\":%u,", ((n > 0)? ",": ""), r.name.c_str(), unsigned(r.numIterations), unsigned(r.numSamples));
+		fprintf(f, "\"minNs\":%.3f,\"medianNs\":%.3f,\"meanNs\":%.3f,\"madNs\":%.3f,", r.minTime, r.medianTime, r.meanTime, r.madTime);
+		fprintf(f, "\"itemsPerSecond\":%.1f}", (r.itemsPerIteration * 1e9) / r.medianTime);
+	}
+
+	fprintf(f, "\n]}\n");
+	return (fclose(f) == 0);
+}
+
+
+int main(int argc, char** argv)
+{
+	InitSpringTime initSpringTime;
+
+	const char* filter = "";
+	const char* jsonFile = nullptr;
+
+	size_t numSamples = 15;
+	double minSampleTime = 10.0 * 1e6;
+
+	for (int i = 1; i < argc; i++) {
+		const bool hasValue = ((i + 1) < argc);
+
+		if (hasValue && strcmp(argv[i], "--filter") == 0) {
+			filter = argv[++i];
+		} else if (hasValue && strcmp(argv[i], "--samples") == 0) {
+			numSamples = std::max(1, atoi(argv[++i]));
+		} else if (hasValue && strcmp(argv[i], "--min-time") == 0) {
+			minSampleTime = std::max(0.1, atof(argv[++i])) * 1e6;
+		} else if (hasValue && strcmp(argv[i], "--json") == 0) {
+			jsonFile = argv[++i];
+		} else {
+			printf("usage: %s [--filter <substring>] [--samples <n>] [--min-time <ms>] [--json <file>]\n", argv[0]);
+			return 1;
+		}
+	}
+
+	std::vector<BenchmarkResult> results;
+
+	printf("%-40s %14s %14s %10s %16s\n", "benchmark", "median", "min", "mad", "items/s");
+
+	for (const Benchmark& benchmark: GetBenchmarks()) {
+		if (strstr(benchmark.name, filter) == nullptr)
+			continue;
+
+		results.push_back(RunBenchmark(benchmark, numSamples, minSampleTime));
+
+		const BenchmarkResult& r = results.back();
+
+		printf("%-40s %11.1f ns %11.1f ns %9.1f%% %16.0f\n", r.name.c_str(), r.medianTime, r.minTime, (r.madTime * 100.0) / std::max(r.medianTime, 1e-9), (r.itemsPerIteration * 1e9) / r.medianTime);
+		fflush(stdout);
+	}
+
+	if (jsonFile != nullptr && !WriteJSON(jsonFile, argv[0], results)) {
+		printf("can not write %s\n", jsonFile);
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,47 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SPRING_BENCHMARK_H
+#define SPRING_BENCHMARK_H
+
+#include <cstddef>
+
+/**
+ * @brief minimal microbenchmark harness
+ *
+ * Every SPRING_BENCHMARK body must run the operation it measures
+ * state.numIterations times. The harness doubles that number until one
+ * sample takes at least the minimum sample time, runs a few unmeasured
+ * warm-up samples and then reports the min, median and mean time per
+ * iteration over all measured samples, with the median absolute deviation
+ * as an indicator of noise; compare medians, not single runs.
+ *
+ * usage: bench_<name> [--filter <substring>] [--samples <n>] [--min-time <ms>] [--json <file>]
+ */
+struct BenchmarkState {
+	size_t numIterations;
+	/// set by the body if an iteration processes more than one item (reported as items/s)
+	size_t itemsPerIteration;
+};
+
+typedef void (*BenchmarkFunc)(BenchmarkState& state);
+
+struct BenchmarkRegistrar {
+	BenchmarkRegistrar(const char* name, BenchmarkFunc func);
+};
+
+/// keeps the compiler from optimizing away value and whatever computed it
+template<typename T> inline void DoNotOptimize(const T& value) {
+#ifdef __GNUC__
+	asm volatile("" : : "r,m"(value) : "memory");
+#else
+	static volatile const void* sink;
+	sink = &value;
+#endif
+}
+
+#define SPRING_BENCHMARK(name) \
+	static void Benchmark_##name(BenchmarkState& state); \
+	static BenchmarkRegistrar benchmarkRegistrar_##name(#name, &Benchmark_##name); \
+	static void Benchmark_##name(BenchmarkState& state)
+
+#endif // SPRING_BENCHMARK_H
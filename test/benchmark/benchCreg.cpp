@@ -0,0 +1,122 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Benchmark.h"
+#include "System/creg/creg_cond.h"
+#include "System/creg/Serializer.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+static constexpr int NUM_OBJECTS = 1000;
+
+
+struct BenchChild {
+	CR_DECLARE(BenchChild);
+
+	BenchChild(): index(0), health(0.0f), sibling(nullptr) {}
+	virtual ~BenchChild() {}
+
+	int index;
+	float health;
+	float pos[3];
+	std::string name;
+	std::vector<int> commands;
+
+	BenchChild* sibling;
+};
+
+CR_BIND(BenchChild, );
+CR_REG_METADATA(BenchChild, (
+	CR_MEMBER(index),
+	CR_MEMBER(health),
+	CR_MEMBER(pos),
+	CR_MEMBER(name),
+	CR_MEMBER(commands),
+	CR_MEMBER(sibling)
+));
+
+
+// roughly the shape of a handler owning many objects that point at each other
+struct BenchRoot {
+	CR_DECLARE(BenchRoot);
+
+	virtual ~BenchRoot() {
+		for (BenchChild* c: children) {
+			delete c;
+		}
+	}
+
+	std::vector<BenchChild*> children;
+	std::vector<float> heights;
+};
+
+CR_BIND(BenchRoot, );
+CR_REG_METADATA(BenchRoot, (
+	CR_MEMBER(children),
+	CR_MEMBER(heights)
+));
+
+
+static BenchRoot* CreateRoot()
+{
+	BenchRoot* root = new BenchRoot();
+	root->heights.resize(256 * 256, 1.0f);
+
+	for (int n = 0; n < NUM_OBJECTS; n++) {
+		BenchChild* c = new BenchChild();
+		c->index = n;
+		c->health = n * 0.5f;
+		c->pos[0] = c->pos[1] = c->pos[2] = n;
+		c->name = "object";
+		c->commands.resize(n % 16, n);
+
+		root->children.push_back(c);
+	}
+
+	for (int n = 0; n < NUM_OBJECTS; n++) {
+		root->children[n]->sibling = root->children[(n * 7) % NUM_OBJECTS];
+	}
+
+	return root;
+}
+
+static std::string SaveRoot(BenchRoot* root)
+{
+	std::stringstream ss(std::ios::in | std::ios::out | std::ios::binary);
+	creg::COutputStreamSerializer os;
+	os.SavePackage(&ss, root, root->GetClass());
+	return ss.str();
+}
+
+
+SPRING_BENCHMARK(Creg_SavePackage)
+{
+	BenchRoot* root = CreateRoot();
+
+	for (size_t i = 0; i < state.numIterations; i++) {
+		DoNotOptimize(SaveRoot(root).size());
+	}
+
+	delete root;
+}
+
+SPRING_BENCHMARK(Creg_LoadPackage)
+{
+	BenchRoot* root = CreateRoot();
+	const std::string data = SaveRoot(root);
+
+	delete root;
+
+	for (size_t i = 0; i < state.numIterations; i++) {
+		std::stringstream ss(data, std::ios::in | std::ios::binary);
+
+		void* loadedRoot = nullptr;
+		creg::Class* loadedRootCls = nullptr;
+
+		creg::CInputStreamSerializer is;
+		is.LoadPackage(&ss, loadedRoot, loadedRootCls);
+
+		delete static_cast<BenchRoot*>(loadedRoot);
+	}
+}
@@ -0,0 +1,114 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Benchmark.h"
+#include "System/FlatHashMap.hpp"
+#include "System/GlobalRNG.h"
+#include "System/UnorderedMap.hpp"
+
+#include <cstdint>
+#include <vector>
+
+static constexpr size_t NUM_KEYS = 4096;
+
+// spread-out 64-bit keys, like the path-cache and shared-path hashes
+static std::vector<std::uint64_t> GetKeys(unsigned int seed)
+{
+	CGlobalUnsyncedRNG rng;
+	rng.Seed(seed);
+
+	std::vector<std::uint64_t> keys(NUM_KEYS);
+
+	for (std::uint64_t& key: keys) {
+		key = (std::uint64_t(rng.NextInt()) << 32) | rng.NextInt();
+	}
+
+	return keys;
+}
+
+static const std::vector<std::uint64_t> hitKeys = GetKeys(1234);
+static const std::vector<std::uint64_t> missKeys = GetKeys(4321);
+
+
+template<typename MapType>
+static void FindHit(BenchmarkState& state)
+{
+	MapType map;
+
+	for (size_t i = 0; i < NUM_KEYS; i++) {
+		map[hitKeys[i]] = i;
+	}
+
+	for (size_t i = 0; i < state.numIterations; i++) {
+		DoNotOptimize(map.find(hitKeys[i % NUM_KEYS])->second);
+	}
+}
+
+template<typename MapType>
+static void FindMiss(BenchmarkState& state)
+{
+	MapType map;
+
+	for (size_t i = 0; i < NUM_KEYS; i++) {
+		map[hitKeys[i]] = i;
+	}
+
+	for (size_t i = 0; i < state.numIterations; i++) {
+		DoNotOptimize(map.find(missKeys[i % NUM_KEYS]) == map.end());
+	}
+}
+
+// FIFO insert/erase with a constant number of live entries, like CPathCache
+template<typename MapType>
+static void InsertEraseChurn(BenchmarkState& state)
+{
+	MapType map;
+	map.reserve(NUM_KEYS);
+
+	std::vector<std::uint64_t> queue(NUM_KEYS / 2, 0);
+
+	for (size_t i = 0; i < state.numIterations; i++) {
+		const size_t j = i % queue.size();
+
+		if (i >= queue.size())
+			map.erase(map.find(queue[j]));
+
+		// make every key unique over the run
+		map[queue[j] = hitKeys[i % NUM_KEYS] + (i / NUM_KEYS)] = i;
+		DoNotOptimize(map.size());
+	}
+}
+
+template<typename MapType>
+static void Iterate(BenchmarkState& state)
+{
+	MapType map;
+
+	for (size_t i = 0; i < NUM_KEYS; i++) {
+		map[hitKeys[i]] = i;
+	}
+
+	state.itemsPerIteration = NUM_KEYS;
+
+	for (size_t i = 0; i < state.numIterations; i++) {
+		size_t sum = 0;
+
+		for (const auto& p: map) {
+			sum += p.second;
+		}
+
+		DoNotOptimize(sum);
+	}
+}
+
+
+typedef spring::unordered_map<std::uint64_t, size_t> EmilibMap;
+typedef spring::flat_hash_map<std::uint64_t, size_t> FlatMap;
+
+SPRING_BENCHMARK(UnorderedMap_FindHit) { FindHit<EmilibMap>(state); }
+SPRING_BENCHMARK(FlatHashMap_FindHit) { FindHit<FlatMap>(state); }
+SPRING_BENCHMARK(UnorderedMap_FindMiss) { FindMiss<EmilibMap>(state); }
+SPRING_BENCHMARK(FlatHashMap_FindMiss) { FindMiss<FlatMap>(state); }
+SPRING_BENCHMARK(UnorderedMap_InsertEraseChurn) { InsertEraseChurn<EmilibMap>(state); }
+SPRING_BENCHMARK(FlatHashMap_InsertEraseChurn) { InsertEraseChurn<FlatMap>(state); }
+SPRING_BENCHMARK(UnorderedMap_Iterate) { Iterate<EmilibMap>(state); }
+SPRING_BENCHMARK(FlatHashMap_Iterate) { Iterate<FlatMap>(state); }
@@ -0,0 +1,87 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Benchmark.h"
+#include "Lua/LuaMemPool.h"
+#include "System/GlobalRNG.h"
+
+#include <cstdlib>
+#include <vector>
+
+static constexpr size_t NUM_LIVE_ALLOCS = 1024;
+
+// Lua mostly allocates small strings, tables and closures
+static std::vector<size_t> GetAllocSizes()
+{
+	CGlobalUnsyncedRNG rng;
+	rng.Seed(1234);
+
+	std::vector<size_t> sizes(NUM_LIVE_ALLOCS * 4);
+
+	for (size_t& size: sizes) {
+		size = (rng.NextInt(8) == 0)? (256 + rng.NextInt(4096)): (LuaMemPool::MIN_ALLOC_SIZE + rng.NextInt(128));
+	}
+
+	return sizes;
+}
+
+static const std::vector<size_t> allocSizes = GetAllocSizes();
+
+
+template<typename AllocFunc, typename FreeFunc>
+static void AllocFreeLoop(BenchmarkState& state, AllocFunc allocFunc, FreeFunc freeFunc)
+{
+	// a window of live allocations, the oldest one is replaced each iteration
+	std::vector<void*> ptrs(NUM_LIVE_ALLOCS, nullptr);
+	std::vector<size_t> sizes(NUM_LIVE_ALLOCS, 0);
+
+	for (size_t i = 0; i < state.numIterations; i++) {
+		const size_t j = i % NUM_LIVE_ALLOCS;
+
+		if (ptrs[j] != nullptr)
+			freeFunc(ptrs[j], sizes[j]);
+
+		ptrs[j] = allocFunc(sizes[j] = allocSizes[i % allocSizes.size()]);
+		DoNotOptimize(ptrs[j]);
+	}
+
+	for (size_t j = 0; j < NUM_LIVE_ALLOCS; j++) {
+		if (ptrs[j] != nullptr)
+			freeFunc(ptrs[j], sizes[j]);
+	}
+}
+
+
+SPRING_BENCHMARK(LuaMemPool_AllocFree)
+{
+	LuaMemPool::InitStatic(true);
+	LuaMemPool pool(0);
+
+	AllocFreeLoop(state, [&](size_t size) { return pool.Alloc(size); }, [&](void* ptr, size_t size) { pool.Free(ptr, size); });
+}
+
+SPRING_BENCHMARK(LuaMemPool_Realloc)
+{
+	LuaMemPool::InitStatic(true);
+	LuaMemPool pool(0);
+
+	void* ptr = nullptr;
+	size_t size = 0;
+
+	// grows and shrinks one block, e.g. a table's array part
+	for (size_t i = 0; i < state.numIterations; i++) {
+		const size_t nsize = allocSizes[i % allocSizes.size()];
+
+		ptr = pool.Realloc(ptr, nsize, size);
+		size = nsize;
+
+		DoNotOptimize(ptr);
+	}
+
+	pool.Free(ptr, size);
+}
+
+// baseline for LuaMemPool_AllocFree
+SPRING_BENCHMARK(LuaMemPool_MallocFree)
+{
+	AllocFreeLoop(state, [](size_t size) { return ::malloc(size); }, [](void* ptr, size_t) { ::free(ptr); });
+}
@@ -0,0 +1,84 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Benchmark.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/QuadField.h"
+#include "System/float3.h"
+#include "System/GlobalRNG.h"
+
+#include <vector>
+
+// a 16x16 map
+static constexpr int MAP_SIZE = 16 * 64;
+static constexpr int NUM_QUERIES = 1024;
+
+struct QuadFieldQueries {
+	QuadFieldQueries(): qf(int2(MAP_SIZE, MAP_SIZE), CQuadField::BASE_QUAD_SIZE) {
+		CGlobalUnsyncedRNG rng;
+		rng.Seed(1234);
+
+		quadField = &qf;
+
+		// for ClampInBounds
+		float3::maxxpos = MAP_SIZE * SQUARE_SIZE - 1;
+		float3::maxzpos = MAP_SIZE * SQUARE_SIZE - 1;
+
+		for (int n = 0; n < NUM_QUERIES; n++) {
+			const float3 pos = {rng.NextFloat() * MAP_SIZE * SQUARE_SIZE, 0.0f, rng.NextFloat() * MAP_SIZE * SQUARE_SIZE};
+			const float3 dir = float3(rng.NextFloat() - 0.5f, 0.0f, rng.NextFloat() - 0.5f).SafeNormalize();
+
+			positions.push_back(pos);
+			directions.push_back(dir);
+			radii.push_back(50.0f + rng.NextFloat() * 1000.0f);
+		}
+	}
+
+	CQuadField qf;
+
+	std::vector<float3> positions;
+	std::vector<float3> directions;
+	std::vector<float> radii;
+};
+
+static QuadFieldQueries& GetQueries()
+{
+	static QuadFieldQueries queries;
+	return queries;
+}
+
+
+SPRING_BENCHMARK(QuadField_GetQuads)
+{
+	QuadFieldQueries& q = GetQueries();
+
+	for (size_t i = 0; i < state.numIterations; i++) {
+		QuadFieldQuery qfQuery;
+		q.qf.GetQuads(qfQuery, q.positions[i % NUM_QUERIES], q.radii[i % NUM_QUERIES]);
+		DoNotOptimize(qfQuery.quads->size());
+	}
+}
+
+SPRING_BENCHMARK(QuadField_GetQuadsRectangle)
+{
+	QuadFieldQueries& q = GetQueries();
+
+	for (size_t i = 0; i < state.numIterations; i++) {
+		const float3& pos = q.positions[i % NUM_QUERIES];
+		const float3 ext = {q.radii[i % NUM_QUERIES], 0.0f, q.radii[(i + 1) % NUM_QUERIES]};
+
+		QuadFieldQuery qfQuery;
+		q.qf.GetQuadsRectangle(qfQuery, pos - ext, pos + ext);
+		DoNotOptimize(qfQuery.quads->size());
+	}
+}
+
+SPRING_BENCHMARK(QuadField_GetQuadsOnRay)
+{
+	QuadFieldQueries& q = GetQueries();
+
+	for (size_t i = 0; i < state.numIterations; i++) {
+		QuadFieldQuery qfQuery;
+		q.qf.GetQuadsOnRay(qfQuery, q.positions[i % NUM_QUERIES], q.directions[i % NUM_QUERIES], q.radii[i % NUM_QUERIES] * 2.0f);
+		DoNotOptimize(qfQuery.quads->size());
+	}
+}
@@ -0,0 +1,77 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Benchmark.h"
+#include "System/Platform/Threading.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <cmath>
+#include <vector>
+
+static constexpr int NUM_ITEMS = 4096;
+
+struct ThreadPoolInit {
+	ThreadPoolInit() {
+		Threading::DetectCores();
+		ThreadPool::SetThreadCount(ThreadPool::GetMaxThreads());
+	}
+	~ThreadPoolInit() {
+		ThreadPool::SetThreadCount(0);
+	}
+};
+
+static ThreadPoolInit threadPoolInit;
+static std::vector<float> items(NUM_ITEMS, 1.0f);
+
+
+// mostly scheduling overhead
+SPRING_BENCHMARK(ThreadPool_for_mt_Empty)
+{
+	state.itemsPerIteration = NUM_ITEMS;
+
+	for (size_t i = 0; i < state.numIterations; i++) {
+		for_mt(0, NUM_ITEMS, [&](const int j) { DoNotOptimize(j); });
+	}
+}
+
+// a few hundred cycles of work per item, as in most sim loops
+SPRING_BENCHMARK(ThreadPool_for_mt_Work)
+{
+	state.itemsPerIteration = NUM_ITEMS;
+
+	for (size_t i = 0; i < state.numIterations; i++) {
+		for_mt(0, NUM_ITEMS, [&](const int j) {
+			float x = items[j];
+
+			for (int k = 0; k < 32; k++) {
+				x = std::sqrt(x + k);
+			}
+
+			items[j] = x;
+		});
+	}
+}
+
+SPRING_BENCHMARK(ThreadPool_for_mt_dynamic_Work)
+{
+	state.itemsPerIteration = NUM_ITEMS;
+
+	for (size_t i = 0; i < state.numIterations; i++) {
+		for_mt_dynamic(0, NUM_ITEMS, [&](const int j) {
+			float x = items[j];
+
+			for (int k = 0; k < 32; k++) {
+				x = std::sqrt(x + k);
+			}
+
+			items[j] = x;
+		});
+	}
+}
+
+// round-trip latency of a single task
+SPRING_BENCHMARK(ThreadPool_Enqueue_Wait)
+{
+	for (size_t i = 0; i < state.numIterations; i++) {
+		ThreadPool::Enqueue([]() { return 0; })->get();
+	}
+}
@@ -0,0 +1,62 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Benchmark.h"
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "System/Net/UDPConnection.h"
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+static constexpr int NUM_PACKETS = 1024;
+
+// serialized packets carrying consecutive chunks, each full of frame messages
+static std::vector< std::vector<std::uint8_t> > GetPackets()
+{
+	std::vector< std::vector<std::uint8_t> > packets(NUM_PACKETS);
+
+	for (int n = 0; n < NUM_PACKETS; n++) {
+		netcode::ChunkPtr chunk(new netcode::Chunk());
+		chunk->chunkNumber = n;
+
+		for (int frameNum = n * 50; chunk->data.size() + 6 <= netcode::Chunk::maxSize; frameNum++) {
+			chunk->data.push_back(NETMSG_KEYFRAME);
+			chunk->data.insert(chunk->data.end(), reinterpret_cast<const std::uint8_t*>(&frameNum), reinterpret_cast<const std::uint8_t*>(&frameNum) + sizeof(frameNum));
+			chunk->data.push_back(NETMSG_NEWFRAME);
+		}
+
+		chunk->chunkSize = chunk->data.size();
+
+		netcode::Packet packet(0, 0);
+		packet.chunks.push_back(chunk);
+		packet.checksum = packet.GetChecksum();
+		packet.Serialize(packets[n]);
+	}
+
+	return packets;
+}
+
+
+// parsing, reassembly and splitting into messages on the receiving side;
+// includes creating one connection (and socket) per NUM_PACKETS packets
+SPRING_BENCHMARK(UDPConnection_ProcessRawPacket)
+{
+	static const std::vector< std::vector<std::uint8_t> > packets = GetPackets();
+
+	std::unique_ptr<netcode::UDPConnection> conn;
+
+	for (size_t i = 0; i < state.numIterations; i++) {
+		const std::vector<std::uint8_t>& data = packets[i % NUM_PACKETS];
+
+		// chunk numbers must restart with each connection
+		if ((i % NUM_PACKETS) == 0)
+			conn.reset(new netcode::UDPConnection(0, "127.0.0.1", 8452));
+
+		netcode::Packet packet(data.data(), data.size());
+		conn->ProcessRawPacket(packet);
+
+		while (conn->HasIncomingData()) {
+			DoNotOptimize(conn->GetData());
+		}
+	}
+}
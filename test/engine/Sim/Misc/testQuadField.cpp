@@ -5,6 +5,8 @@
 #include "System/myMath.h"
 #include <stdlib.h>
 #include <time.h>
+#include <algorithm>
+#include <vector>
 
 #define BOOST_TEST_MODULE QuadField
 #include <boost/test/unit_test.hpp>
@@ -101,3 +103,52 @@ BOOST_AUTO_TEST_CASE( QuadField )
 
 	BOOST_CHECK_MESSAGE(!fail, "Too less quads returned!");
 }
+
+
+BOOST_AUTO_TEST_CASE( QuadUnitPartitions )
+{
+	static const int NUM_ALLYTEAMS = 4;
+	static const int NUM_UNITS = 64;
+	static const int TEST_RUNS = 10000;
+
+	// units are never dereferenced by Quad, fake their addresses
+	std::vector<int> dummies(NUM_UNITS);
+	std::vector<int> allyTeams(NUM_UNITS, -1);
+	std::vector<bool> inserted(NUM_UNITS, false);
+
+	CQuadField::Quad quad;
+	quad.unitOffsets.resize(NUM_ALLYTEAMS + 1, 0);
+
+	bool fail = false;
+
+	for (int n = 0; n < TEST_RUNS && !fail; ++n) {
+		const int i = rand() % NUM_UNITS;
+		CUnit* u = reinterpret_cast<CUnit*>(&dummies[i]);
+
+		if (inserted[i]) {
+			quad.EraseUnit(u, allyTeams[i]);
+		} else {
+			quad.InsertUnit(u, allyTeams[i] = rand() % NUM_ALLYTEAMS);
+		}
+
+		inserted[i] = !inserted[i];
+
+		// every inserted unit must be found exactly once, in its own run
+		size_t numInserted = 0;
+
+		for (int j = 0; j < NUM_UNITS; ++j) {
+			if (!inserted[j])
+				continue;
+
+			numInserted++;
+
+			const auto run = quad.GetAllyTeamUnits(allyTeams[j]);
+			fail |= (std::count(run.begin(), run.end(), reinterpret_cast<CUnit*>(&dummies[j])) != 1);
+		}
+
+		fail |= (quad.units.size() != numInserted);
+		fail |= (quad.unitOffsets[NUM_ALLYTEAMS] != numInserted);
+	}
+
+	BOOST_CHECK_MESSAGE(!fail, "Quad unit partitions are inconsistent!");
+}
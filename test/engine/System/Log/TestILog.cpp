@@ -1,5 +1,6 @@
 
 #include "System/Log/ILog.h"
+#include "System/Log/Backend.h"
 #include "System/Log/FileSink.h"
 #include "System/Log/StreamSink.h"
 #include "System/Log/LogUtil.h"
@@ -11,6 +12,10 @@
 using boost::test_tools::output_test_stream;
 
 #include <cstdarg>
+#include <cstdio>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 
 
@@ -236,5 +241,53 @@ BOOST_AUTO_TEST_CASE(IsEnabled)
 }
 
 
+BOOST_AUTO_TEST_CASE(Async)
+{
+	const int numThreads = 4;
+	const int numRecords = 1000;
+
+	std::stringstream asyncStream;
+	std::vector<std::thread> threads;
+
+	log_sink_stream_setLogStream(&asyncStream);
+	// small enough to fill up; warnings wait for room instead of being dropped
+	log_backend_startAsync(64, 0);
+
+	for (int t = 0; t < numThreads; t++) {
+		threads.emplace_back([t]() {
+			for (int i = 0; i < numRecords; i++) {
+				LOG_L(L_WARNING, "async %d %d", t, i);
+			}
+		});
+	}
+	for (std::thread& t: threads) {
+		t.join();
+	}
+
+	log_backend_stopAsync();
+	log_sink_stream_setLogStream(&logStream);
+
+	// every record arrives, in the order its thread logged it
+	std::vector<int> nextRecords(numThreads, 0);
+	std::string line;
+
+	int t = -1;
+	int i = -1;
+
+	while (std::getline(asyncStream, line)) {
+		BOOST_REQUIRE(sscanf(line.c_str(), "Warning: async %d %d", &t, &i) == 2);
+		BOOST_REQUIRE(t >= 0 && t < numThreads);
+		BOOST_CHECK_EQUAL(i, nextRecords[t]++);
+	}
+	for (int n = 0; n < numThreads; n++) {
+		BOOST_CHECK_EQUAL(nextRecords[n], numRecords);
+	}
+
+	// synchronous again
+	LOG( "Testing synchronous logging after async");
+	TLOG("Testing synchronous logging after async");
+}
+
+
 BOOST_AUTO_TEST_SUITE_END()
 
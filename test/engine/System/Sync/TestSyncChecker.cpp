@@ -0,0 +1,92 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SYNCCHECK
+	#error "This test requires SYNCCHECK to be defined on the compiler command line."
+#endif
+#include "System/Sync/SyncedPrimitive.h"
+
+#include <vector>
+
+#define BOOST_TEST_MODULE SyncChecker
+#include <boost/test/unit_test.hpp>
+
+
+static void SyncValues(int count, int offset)
+{
+	for (int i = 0; i < count; i++) {
+		const int value = i + offset;
+		CSyncChecker::Sync(&value, sizeof(value));
+	}
+}
+
+
+BOOST_AUTO_TEST_CASE(Deterministic)
+{
+	std::vector<unsigned char> block(5000, 0x5a);
+
+	CSyncChecker::NewFrame();
+	SyncValues(2000, 0);
+	CSyncChecker::Sync(block.data(), block.size());
+	const unsigned checksum = CSyncChecker::GetChecksum();
+
+	CSyncChecker::NewFrame();
+	SyncValues(2000, 0);
+	CSyncChecker::Sync(block.data(), block.size());
+	BOOST_CHECK_EQUAL(checksum, CSyncChecker::GetChecksum());
+
+	CSyncChecker::NewFrame();
+	SyncValues(2000, 1);
+	CSyncChecker::Sync(block.data(), block.size());
+	BOOST_CHECK(checksum != CSyncChecker::GetChecksum());
+
+	// checksums keep running across frames until reset
+	const unsigned runningChecksum = CSyncChecker::GetChecksum();
+	SyncValues(1, 0);
+	BOOST_CHECK(runningChecksum != CSyncChecker::GetChecksum());
+}
+
+
+BOOST_AUTO_TEST_CASE(Subsystems)
+{
+	unsigned baseChecksums[CSyncChecker::SYNC_SUBSYSTEM_COUNT];
+	unsigned checksums[CSyncChecker::SYNC_SUBSYSTEM_COUNT];
+
+	CSyncChecker::NewFrame();
+	SyncValues(100, 0);
+	CSyncChecker::GetSubsystemChecksums(baseChecksums);
+
+	CSyncChecker::NewFrame();
+	SyncValues(50, 0);
+	{
+		// switching without writing anything changes nothing
+		SCOPED_SYNC_SUBSYSTEM(SYNC_PATH);
+	}
+	{
+		SCOPED_SYNC_SUBSYSTEM_IF(false, SYNC_LUA);
+		SyncValues(0, 0);
+	}
+	SyncValues(50, 50);
+	CSyncChecker::GetSubsystemChecksums(checksums);
+
+	for (unsigned s = 0; s < CSyncChecker::SYNC_SUBSYSTEM_COUNT; s++) {
+		BOOST_CHECK_EQUAL(baseChecksums[s], checksums[s]);
+	}
+
+	CSyncChecker::NewFrame();
+	SyncValues(50, 0);
+	{
+		SCOPED_SYNC_SUBSYSTEM(SYNC_UNITS);
+		SyncValues(1, 0);
+	}
+	SyncValues(50, 50);
+	CSyncChecker::GetSubsystemChecksums(checksums);
+
+	// only the subsystem that saw the extra write differs
+	for (unsigned s = 0; s < CSyncChecker::SYNC_SUBSYSTEM_COUNT; s++) {
+		if (s == CSyncChecker::SYNC_UNITS) {
+			BOOST_CHECK(baseChecksums[s] != checksums[s]);
+		} else {
+			BOOST_CHECK_EQUAL(baseChecksums[s], checksums[s]);
+		}
+	}
+}
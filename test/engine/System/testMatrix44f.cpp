@@ -1,6 +1,8 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <xmmintrin.h> //SSE1
+#include <algorithm>
+#include <cstring>
 
 #include "System/Matrix44f.h"
 #include "System/float4.h"
@@ -290,3 +292,111 @@ BOOST_AUTO_TEST_CASE( Matrix44MatrixMultiply )
 	BOOST_WARN(TestMMSpring2() == correctHash);
 	BOOST_WARN(TestMMSSE()     == correctHash);
 }
+
+
+static const int batchSize = 256;
+static const int batchRuns = testRuns / batchSize;
+
+static float3 batchIn[batchSize];
+static float3 batchOut[batchSize];
+
+_noinline static int TestTransformLoop()
+{
+	ScopedOnceTimer timer("Matrix-Point-Mult: spring (loop)");
+	for (int i = 0; i < batchRuns; ++i) {
+		for (int k = 0; k < batchSize; ++k) {
+			batchOut[k] = m * batchIn[k];
+		}
+	}
+	return HsiehHash(batchOut, sizeof(batchOut), 0);
+}
+
+_noinline static int TestTransformBatch()
+{
+	ScopedOnceTimer timer("Matrix-Point-Mult: spring (batch)");
+	for (int i = 0; i < batchRuns; ++i) {
+		m.TransformPoints(batchIn, batchOut, batchSize);
+	}
+	return HsiehHash(batchOut, sizeof(batchOut), 0);
+}
+
+_noinline static int TestNormalizeLoop()
+{
+	ScopedOnceTimer timer("Vector-Normalize: spring (loop)");
+	for (int i = 0; i < batchRuns; ++i) {
+		for (int k = 0; k < batchSize; ++k) {
+			batchOut[k] = batchIn[k];
+			batchOut[k].SafeNormalize();
+		}
+	}
+	return HsiehHash(batchOut, sizeof(batchOut), 0);
+}
+
+_noinline static int TestNormalizeBatch()
+{
+	ScopedOnceTimer timer("Vector-Normalize: spring (batch)");
+	for (int i = 0; i < batchRuns; ++i) {
+		std::copy(batchIn, batchIn + batchSize, batchOut);
+		float3::SafeNormalize(batchOut, batchSize);
+	}
+	return HsiehHash(batchOut, sizeof(batchOut), 0);
+}
+
+BOOST_AUTO_TEST_CASE( Matrix44BatchTransform )
+{
+	for (int i = 0; i < 16; ++i) {
+		m[i] = ((i != 3) && (i != 7) && (i != 11))? (float(i + 1) / 31.5f): 0.0f;
+	}
+	m[15] = 1.0f;
+
+	for (int k = 0; k < batchSize; ++k) {
+		batchIn[k] = float3(k - 128.0f, (k % 7) * 0.25f, 1.0f / (k + 1.0f));
+	}
+	// (near-)zero vectors must pass through SafeNormalize unchanged
+	batchIn[5] = ZeroVector;
+	batchIn[6] = float3(1e-7f, 0.0f, 0.0f);
+
+	// batch kernels must reproduce the per-element operators bit for bit
+	BOOST_CHECK(TestTransformBatch() == TestTransformLoop());
+	BOOST_CHECK(TestNormalizeBatch() == TestNormalizeLoop());
+
+	float lengths[batchSize];
+	float3::Lengths(batchIn, lengths, batchSize);
+
+	for (int k = 0; k < batchSize; ++k) {
+		BOOST_CHECK(lengths[k] == batchIn[k].Length());
+	}
+
+	float3 vecs[batchSize];
+	m.TransformVectors(batchIn, vecs, batchSize);
+
+	for (int k = 0; k < batchSize; ++k) {
+		const float3 v = m * float4(batchIn[k], 0.0f);
+		BOOST_CHECK(std::memcmp(&vecs[k], &v, sizeof(float3)) == 0);
+	}
+}
+
+BOOST_AUTO_TEST_CASE( Matrix44MultiplyHierarchy )
+{
+	constexpr int numPieces = 7;
+	constexpr int parents[numPieces] = {-1, 0, 1, 1, 0, 4, -1};
+
+	CMatrix44f local[numPieces];
+	CMatrix44f global[numPieces];
+
+	for (int i = 0; i < numPieces; ++i) {
+		local[i].RotateEulerYXZ(float3(i * 0.1f, i * 0.2f, i * 0.3f));
+		local[i].Translate(float3(i, i * 2.0f, i * 3.0f));
+	}
+
+	CMatrix44f::MultiplyHierarchy(local, parents, global, numPieces);
+
+	for (int i = 0; i < numPieces; ++i) {
+		CMatrix44f expected = local[i];
+
+		if (parents[i] >= 0)
+			expected >>= global[parents[i]];
+
+		BOOST_CHECK(std::memcmp(&expected, &global[i], sizeof(CMatrix44f)) == 0);
+	}
+}
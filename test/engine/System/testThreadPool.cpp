@@ -96,6 +96,32 @@ BOOST_AUTO_TEST_CASE( test_stepped_for_mt )
 	assert(hash == hashMT);
 }
 
+BOOST_AUTO_TEST_CASE( test_dynamic_for_mt )
+{
+	LOG("[%s::test_dynamic_for_mt]", __func__);
+
+	std::vector<int> runs(NUM_RUNS * 100, 0);
+
+	for_mt_dynamic(0, runs.size(), [&](const int i) {
+		const int threadnum = ThreadPool::GetThreadNum();
+		SAFE_BOOST_CHECK(threadnum >= 0);
+		SAFE_BOOST_CHECK(threadnum < NUM_THREADS);
+		runs[i]++;
+	});
+
+	// every index must be visited exactly once, stolen or not
+	for (size_t i = 0; i < runs.size(); i++) {
+		BOOST_CHECK(runs[i] == 1);
+	}
+
+	for_mt_dynamic(0, 0, [&](const int i) {
+		SAFE_BOOST_CHECK(false);
+	});
+	for_mt_dynamic(10, 0, [&](const int i) {
+		SAFE_BOOST_CHECK(false);
+	});
+}
+
 BOOST_AUTO_TEST_CASE( test_parallel )
 {
 	LOG("[%s::test_parallel]", __func__);
@@ -257,6 +283,50 @@ BOOST_AUTO_TEST_CASE( test_for_vs_for_mt )
 }
 
 
+static void for_mt_vs_for_mt_dynamic_kernel(const int numRuns, const spring_time kernelLoad)
+{
+	LOG("\t[%s] running skewed %.3fms kernel for %i runs:", __func__, kernelLoad.toMilliSecsf(), numRuns);
+
+	spring_time t_formt;
+	spring_time t_fordyn;
+
+	// cost grows with the index, so static slicing would leave the last thread doing most of the work
+	const auto& ExecKernel = [&](const int i) {
+		const spring_time finish = spring_now() + spring_time::fromNanoSecs((kernelLoad.toNanoSecsi() * 2 * i) / numRuns);
+		while (spring_now() < finish) {}
+	};
+
+	{
+		const spring_time start = spring_now();
+
+		for_mt(0, numRuns, [&](const int i) {
+			ExecKernel(i);
+		});
+
+		t_formt = (spring_now() - start);
+	}
+	{
+		const spring_time start = spring_now();
+
+		for_mt_dynamic(0, numRuns, [&](const int i) {
+			ExecKernel(i);
+		});
+
+		t_fordyn = (spring_now() - start);
+	}
+
+	LOG("\t\tfor_mt         took %.4fms", t_formt.toMilliSecsf());
+	LOG("\t\tfor_mt_dynamic took %.4fms", t_fordyn.toMilliSecsf());
+}
+
+BOOST_AUTO_TEST_CASE( test_for_mt_vs_for_mt_dynamic )
+{
+	for_mt_vs_for_mt_dynamic_kernel(10000, spring_time::fromMicroSecs(1));
+	for_mt_vs_for_mt_dynamic_kernel(1000,  spring_time::fromMicroSecs(10));
+	for_mt_vs_for_mt_dynamic_kernel(100,   spring_time::fromMicroSecs(100));
+}
+
+
 static void test_parallel_reaction_times_aux(int numRuns)
 {
 	LOG("\t[%s]", __func__);
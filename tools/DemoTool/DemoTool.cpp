@@ -3,12 +3,15 @@
 #include <string>
 #include <map>
 #include <iostream>
+#include <sstream>
 #include <gflags/gflags.h>
 #include <iomanip> //hex
+#include <zlib.h>
 
 #include "StringSerializer.h"
 
 #include "Net/Protocol/BaseNetProtocol.h"
+#include "System/FileSystem/GZFileHandler.h"
 #include "System/LoadSave/DemoReader.h"
 #include "System/Net/RawPacket.h"
 #include "Sim/Units/CommandAI/Command.h"
@@ -32,10 +35,12 @@ no console output (you still could use this.exe > z.tzt though).
 	DEFINE_bool  (teamstats,    false, "Print teamstats");
 	DEFINE_int32 (team,         -1,    "Select team");
 	DEFINE_string(teamsstatcsv, "",    "Write teamstats in a csv file");
+	DEFINE_string(buildindex,   "",    "Write a copy of the demo with a frame index to the given file");
 
 
 void TrafficDump(CDemoReader& reader, bool trafficStats);
 void WriteTeamstatHistory(CDemoReader& reader, unsigned team, const std::string& file);
+bool WriteIndexedDemo(CDemoReader& reader, const std::string& demoFile, const std::string& file);
 
 int main (int argc, char* argv[])
 {
@@ -59,6 +64,10 @@ int main (int argc, char* argv[])
 		TrafficDump(reader, true);
 		return 0;
 	}
+	if (!FLAGS_buildindex.empty())
+	{
+		return (WriteIndexedDemo(reader, filename, FLAGS_buildindex)? 0: 1);
+	}
 	if (!FLAGS_teamsstatcsv.empty())
 	{
 		if (FLAGS_team < 0)
@@ -343,6 +352,18 @@ void TrafficDump(CDemoReader& reader, bool trafficStats)
 				}
 				std::cout << std::endl;
 				break;
+			case NETMSG_SELECT_DELTA:
+				std::cout << "NETMSG_SELECT_DELTA: Playernum: " << (unsigned)buffer[3];
+				std::cout << " Length: " << (unsigned)packet->length;
+				std::cout << " Gen: " << (unsigned)buffer[4];
+				std::cout << " Removed IDs:";
+				for (unsigned short i = 7; i < packet->length; i += 2) {
+					if (i == 7 + 2 * *((unsigned short*)(buffer + 5)))
+						std::cout << " Added IDs:";
+					std::cout << " " << *((short*)(buffer + i));
+				}
+				std::cout << std::endl;
+				break;
 			case NETMSG_GAMEOVER:
 				std::cout << "NETMSG_GAMEOVER";
 				std::cout << " Length: " << (unsigned)packet->length;
@@ -490,3 +511,74 @@ void WriteTeamstatHistory(CDemoReader& reader, unsigned team, const std::string&
 		exit(1);
 	}
 };
+
+
+bool WriteIndexedDemo(CDemoReader& reader, const std::string& demoFile, const std::string& file)
+{
+	CDemoFrameIndex frameIndex;
+
+	while (!reader.ReachedEnd())
+	{
+		const uint32_t streamOffset = reader.GetStreamOffset();
+		netcode::RawPacket* packet = reader.GetData(3.402823466e+38f);
+		if (packet == NULL)
+			continue;
+		frameIndex.AddPacket(packet->data, packet->length, streamOffset);
+		delete packet;
+	}
+
+	// checkpoints can only be recorded by the engine, keep those of an older index
+	for (size_t n = 0; n < reader.GetCheckpoints().size(); ++n)
+	{
+		std::vector<uint8_t> data;
+		if (reader.ReadCheckpoint(n, data))
+			frameIndex.AddCheckpoint(reader.GetCheckpoints()[n].frameNum, reader.GetCheckpoints()[n].streamOffset, data);
+	}
+
+	DemoFileHeader header = reader.GetFileHeader();
+	std::string demo;
+	CGZFileHandler(demoFile, SPRING_VFS_PWD_ALL).LoadStringData(demo);
+
+	const int scriptPos = header.headerSize;
+	int statsSize = header.winningAllyTeamsSize + header.playerStatSize + header.teamStatSize;
+
+	if (header.demoStreamSize == 0)
+	{
+		// demo was not closed properly, there are no stats and the stream ends with the last complete chunk
+		header.demoStreamSize = reader.GetStreamOffset();
+		header.numPlayers = 0;
+		header.numTeams = 0;
+		header.winningAllyTeamsSize = 0;
+		header.playerStatSize = 0;
+		header.teamStatSize = 0;
+		statsSize = 0;
+	}
+
+	const size_t copySize = header.scriptSize + header.demoStreamSize + statsSize;
+	if ((scriptPos + copySize) > demo.size())
+	{
+		std::cout << "Demofile " << demoFile << " is truncated" << std::endl;
+		return false;
+	}
+
+	std::ostringstream index;
+	header.headerSize = sizeof(DemoFileHeader);
+	header.indexSize = frameIndex.Write(index);
+	header.swab();
+
+	gzFile out = gzopen(file.c_str(), "wb9");
+	if (out == NULL)
+	{
+		std::cout << "Could not open " << file << " for writing" << std::endl;
+		return false;
+	}
+
+	const std::string indexData = index.str();
+	gzwrite(out, &header, sizeof(header));
+	gzwrite(out, demo.data() + scriptPos, copySize);
+	gzwrite(out, indexData.data(), indexData.size());
+	gzclose(out);
+
+	std::cout << "Wrote " << file << " with " << frameIndex.GetNumEntries() << " index entries and " << frameIndex.GetNumCheckpoints() << " checkpoints" << std::endl;
+	return true;
+}
@@ -41,6 +41,7 @@ wstringstream& operator<<(wstringstream& str, const DemoFileHeader& header)
 	str<<L"TeamStatElemSize: " <<header.teamStatElemSize<<endl;
 	str<<L"TeamStatPeriod: " <<header.teamStatPeriod<<endl;
 	str<<L"WinningAllyTeamsSize: " << header.winningAllyTeamsSize<<endl;
+	str<<L"IndexSize: " << header.indexSize<<endl;
 	return str;
 }
 
@@ -0,0 +1,693 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <gflags/gflags.h>
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
+#include "Game/GameVersion.h"
+#include "Net/Protocol/BaseNetProtocol.h"
+#include "System/GlobalConfig.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirLocater.h"
+#include "System/FileSystem/FileSystemInitializer.h"
+#include "System/LoadSave/DemoReader.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Net/RawPacket.h"
+#include "System/Net/Socket.h"
+#include "System/Net/UDPConnection.h"
+
+/*
+Usage:
+Start a dedicated server with the script of the demo to replay (--writescript
+extracts it; add AllowSpectatorJoin=1 to [GAME] for --numspectators), then run
+
+  netloadtool --demofile=<demo.sdfz> --host=<server> --port=8452 [options]
+
+Every player of the demo is impersonated by one client that replays the
+commands, selections, map-drawings, chat and Lua messages of that player at
+the sim-frame they were recorded at. Clients beyond the number of recorded
+players cycle through the recorded streams again (these join as spectators,
+the server rejects their commands but still has to parse them). Spectators
+only acknowledge frames and report their CPU usage, like idle real clients.
+
+Loss and latency are emulated on the incoming side of each client: received
+datagrams are dropped or held back before they reach the UDPConnection, which
+then requests resends and acks late exactly as on a bad link.
+
+When compiling for windows with MinGW, make sure to use the
+-Wl,-subsystem,console flag when linking.
+*/
+
+	DEFINE_string(demofile,        "",     "Path to the demo whose command streams are replayed");
+	DEFINE_string(writescript,     "",     "Only write the setup script of the demo to the given file");
+	DEFINE_string(host,            "localhost", "Address of the server");
+	DEFINE_int32 (port,            8452,   "Port of the server");
+	DEFINE_string(password,        "",     "Password sent by every client");
+	DEFINE_string(config,          "",     "Exclusive configuration file");
+	DEFINE_int32 (numplayers,      -1,     "Number of replaying clients, -1 for one per recorded player");
+	DEFINE_int32 (numspectators,   0,      "Number of additional idle spectators");
+	DEFINE_int32 (connectinterval, 50,     "Milliseconds between two connection attempts");
+	DEFINE_int32 (latency,         0,      "Milliseconds every received datagram is delayed by");
+	DEFINE_int32 (jitter,          0,      "Maximum random milliseconds added to latency and to every replayed message");
+	DEFINE_double(loss,            0.0,    "Fraction [0,1] of received datagrams to drop");
+	DEFINE_double(cpuusage,        0.3,    "CPU usage every client reports, used by the server's lag protection");
+	DEFINE_bool  (syncresponses,   true,   "Answer frames with sync responses like a SYNCCHECK client");
+	DEFINE_int32 (duration,        0,      "Stop after this many seconds, 0 to stop at the end of the demo");
+	DEFINE_int32 (serverpid,       0,      "Process id of a local server to sample the CPU usage of (Linux only)");
+	DEFINE_int32 (seed,            0,      "Seed for loss and jitter");
+
+
+static constexpr unsigned int NUM_INTERVAL_BINS = 500;
+
+struct RecordedMessage {
+	int frameNum;
+	unsigned int playerOffset;
+	std::vector<unsigned char> data;
+};
+
+struct RecordedPlayer {
+	std::string name;
+	std::vector<RecordedMessage> messages;
+
+	// the last STARTPOS announced for this player, if any
+	bool haveStartPos = false;
+	unsigned char team = 0;
+	float startPos[3] = {0.0f, 0.0f, 0.0f};
+};
+
+struct Datagram {
+	spring_time time;
+	std::vector<unsigned char> data;
+};
+
+struct Bot {
+	std::string name;
+
+	// index into the recorded players, -1 for spectators
+	int recordedPlayer = -1;
+
+	int playerNum = -1;
+	int frameNum = 0;
+
+	bool quit = false;
+
+	size_t nextMessage = 0;
+
+	spring_time lastFrameTime;
+	spring_time lastCPUUsageTime;
+
+	std::shared_ptr<asio::ip::udp::socket> socket;
+	std::unique_ptr<netcode::UDPConnection> conn;
+
+	// received but not yet handed to conn, sorted by time
+	std::deque<Datagram> inbound;
+	// replayed messages due to be sent, sorted by time
+	std::deque< std::pair<spring_time, CBaseNetProtocol::PacketType> > outbound;
+};
+
+struct Stats {
+	// inter-frame arrival intervals of all clients, 1ms bins
+	std::array<uint64_t, NUM_INTERVAL_BINS> intervals;
+
+	uint64_t numFrames = 0;
+	uint64_t numDroppedDatagrams = 0;
+	uint64_t numReplayedMessages = 0;
+
+	float minSpeed = 1e9f;
+	float curSpeed = 1.0f;
+	unsigned int numSpeedChanges = 0;
+
+	// highest ping the server reported for any client
+	int maxPing = 0;
+
+	int maxFrameNum = 0;
+	bool gameOver = false;
+};
+
+
+static unsigned int GetPlayerNumOffset(unsigned char msgID)
+{
+	switch (msgID) {
+		case NETMSG_COMMAND:
+		case NETMSG_SELECT:
+		case NETMSG_SELECT_DELTA:
+		case NETMSG_LUAMSG:
+			return 3;
+		case NETMSG_MAPDRAW:
+		case NETMSG_CHAT:
+			return 2;
+		default:
+			break;
+	}
+
+	return 0;
+}
+
+static bool ReadDemo(CDemoReader& reader, std::vector<RecordedPlayer>& players, int& lastFrameNum)
+{
+	int frameNum = 0;
+
+	while (!reader.ReachedEnd()) {
+		std::unique_ptr<netcode::RawPacket> packet(reader.GetData(3.402823466e+38f));
+
+		if (packet == nullptr || packet->length == 0)
+			continue;
+
+		const unsigned char* buffer = packet->data;
+		const unsigned char msgID = buffer[0];
+
+		switch (msgID) {
+			case NETMSG_KEYFRAME:
+				frameNum = *(int*)(buffer + 1);
+				break;
+			case NETMSG_NEWFRAME:
+				frameNum += 1;
+				break;
+
+			case NETMSG_PLAYERNAME: {
+				const unsigned char playerNum = buffer[2];
+
+				if (playerNum >= players.size())
+					players.resize(playerNum + 1);
+
+				players[playerNum].name = std::string((const char*)(buffer + 3), strnlen((const char*)(buffer + 3), packet->length - 3));
+			} break;
+
+			case NETMSG_STARTPOS: {
+				const unsigned char playerNum = buffer[1];
+
+				if (playerNum >= players.size())
+					players.resize(playerNum + 1);
+
+				RecordedPlayer& p = players[playerNum];
+
+				p.haveStartPos = true;
+				p.team = buffer[2];
+
+				std::memcpy(p.startPos, buffer + 4, sizeof(p.startPos));
+			} break;
+
+			default: {
+				const unsigned int offset = GetPlayerNumOffset(msgID);
+
+				if (offset == 0 || packet->length <= offset)
+					break;
+
+				const unsigned char playerNum = buffer[offset];
+
+				if (playerNum >= players.size())
+					players.resize(playerNum + 1);
+
+				players[playerNum].messages.push_back({frameNum, offset, std::vector<unsigned char>(buffer, buffer + packet->length)});
+			} break;
+		}
+	}
+
+	lastFrameNum = frameNum;
+
+	// players that never sent anything (spectators, AI hosts) are not replayed
+	players.erase(std::remove_if(players.begin(), players.end(), [](const RecordedPlayer& p) { return (p.name.empty() || p.messages.empty()); }), players.end());
+	return !players.empty();
+}
+
+
+static void ReceiveDatagrams(Bot& bot, Stats& stats, std::mt19937& rng, spring_time now)
+{
+	std::uniform_real_distribution<float> lossDist(0.0f, 1.0f);
+	std::uniform_int_distribution<int> jitterDist(0, FLAGS_jitter);
+
+	size_t bytesAvail = 0;
+
+	while ((bytesAvail = bot.socket->available()) > 0) {
+		Datagram dgram;
+		dgram.data.resize(bytesAvail);
+
+		asio::ip::udp::endpoint sender;
+		asio::error_code err;
+
+		const size_t bytesReceived = bot.socket->receive_from(asio::buffer(dgram.data), sender, 0, err);
+
+		if (netcode::CheckErrorCode(err))
+			break;
+		if (bytesReceived < netcode::Packet::headerSize)
+			continue;
+
+		if (lossDist(rng) < FLAGS_loss) {
+			stats.numDroppedDatagrams += 1;
+			continue;
+		}
+
+		// never reorder, the UDPConnection would only see it as extra loss
+		dgram.data.resize(bytesReceived);
+		dgram.time = now + spring_msecs(FLAGS_latency + jitterDist(rng));
+
+		if (!bot.inbound.empty())
+			dgram.time = std::max(dgram.time, bot.inbound.back().time);
+
+		bot.inbound.push_back(std::move(dgram));
+	}
+
+	while (!bot.inbound.empty() && bot.inbound.front().time <= now) {
+		Datagram& dgram = bot.inbound.front();
+		netcode::Packet packet(&dgram.data[0], dgram.data.size());
+
+		bot.conn->ProcessRawPacket(packet);
+		bot.inbound.pop_front();
+	}
+}
+
+static void HandleFrame(Bot& bot, bool primary, Stats& stats, spring_time now)
+{
+	if (bot.frameNum > 1) {
+		const unsigned int binIdx = (now - bot.lastFrameTime).toMilliSecsi();
+		stats.intervals[std::min(binIdx, NUM_INTERVAL_BINS - 1)] += 1;
+	}
+
+	bot.lastFrameTime = now;
+
+	if (FLAGS_syncresponses)
+		bot.conn->SendData(CBaseNetProtocol::Get().SendSyncResponse(bot.playerNum, bot.frameNum, 0));
+
+	stats.numFrames += primary;
+	stats.maxFrameNum = std::max(stats.maxFrameNum, bot.frameNum);
+}
+
+static void HandleMessage(Bot& bot, bool primary, const std::vector<RecordedPlayer>& players, Stats& stats, spring_time now, const netcode::RawPacket& packet)
+{
+	const unsigned char* buffer = packet.data;
+
+	switch (buffer[0]) {
+		case NETMSG_SETPLAYERNUM: {
+			bot.playerNum = buffer[1];
+
+			bot.conn->SendData(CBaseNetProtocol::Get().SendPlayerName(bot.playerNum, bot.name));
+
+			if (bot.recordedPlayer < 0)
+				break;
+
+			const RecordedPlayer& p = players[bot.recordedPlayer];
+
+			if (p.haveStartPos)
+				bot.conn->SendData(CBaseNetProtocol::Get().SendStartPos(bot.playerNum, p.team, 1, p.startPos[0], p.startPos[1], p.startPos[2]));
+		} break;
+
+		case NETMSG_REJECT_CONNECT:
+		case NETMSG_QUIT: {
+			LOG_L(L_WARNING, "[%s] client \"%s\" was disconnected: %.*s", __func__, bot.name.c_str(), int(packet.length) - 3, (const char*)(buffer + 3));
+			bot.quit = true;
+		} break;
+
+		case NETMSG_KEYFRAME: {
+			bot.frameNum = *(int*)(buffer + 1);
+			bot.conn->SendData(CBaseNetProtocol::Get().SendKeyFrame(bot.frameNum));
+			HandleFrame(bot, primary, stats, now);
+		} break;
+		case NETMSG_NEWFRAME: {
+			bot.frameNum += 1;
+			HandleFrame(bot, primary, stats, now);
+		} break;
+
+		case NETMSG_INTERNAL_SPEED: {
+			if (!primary)
+				break;
+
+			const float speed = *(float*)(buffer + 1);
+
+			stats.numSpeedChanges += (speed != stats.curSpeed);
+			stats.curSpeed = speed;
+			stats.minSpeed = std::min(stats.minSpeed, speed);
+		} break;
+
+		case NETMSG_PLAYERINFO: {
+			if (primary)
+				stats.maxPing = std::max(stats.maxPing, *(int*)(buffer + 6));
+		} break;
+
+		case NETMSG_GAMEOVER: {
+			stats.gameOver = true;
+		} break;
+
+		default: {
+		} break;
+	}
+}
+
+static void ReplayMessages(Bot& bot, const std::vector<RecordedPlayer>& players, Stats& stats, std::mt19937& rng, spring_time now)
+{
+	if (bot.recordedPlayer < 0 || bot.playerNum < 0)
+		return;
+
+	std::uniform_int_distribution<int> jitterDist(0, FLAGS_jitter);
+
+	const std::vector<RecordedMessage>& messages = players[bot.recordedPlayer].messages;
+
+	for (; bot.nextMessage < messages.size() && messages[bot.nextMessage].frameNum <= bot.frameNum; bot.nextMessage++) {
+		const RecordedMessage& msg = messages[bot.nextMessage];
+
+		std::shared_ptr<netcode::RawPacket> packet = std::make_shared<netcode::RawPacket>(&msg.data[0], msg.data.size());
+		packet->data[msg.playerOffset] = bot.playerNum;
+
+		spring_time sendTime = now + spring_msecs(jitterDist(rng));
+
+		if (!bot.outbound.empty())
+			sendTime = std::max(sendTime, bot.outbound.back().first);
+
+		bot.outbound.emplace_back(sendTime, packet);
+	}
+
+	while (!bot.outbound.empty() && bot.outbound.front().first <= now) {
+		bot.conn->SendData(bot.outbound.front().second);
+		bot.outbound.pop_front();
+
+		stats.numReplayedMessages += 1;
+	}
+}
+
+
+static void UpdateBot(Bot& bot, bool primary, const std::vector<RecordedPlayer>& players, Stats& stats, std::mt19937& rng, spring_time now)
+{
+	ReceiveDatagrams(bot, stats, rng, now);
+
+	for (std::shared_ptr<const netcode::RawPacket> packet; !bot.quit && (packet = bot.conn->GetData()) != nullptr; ) {
+		if (packet->length > 0)
+			HandleMessage(bot, primary, players, stats, now, *packet);
+	}
+
+	if (bot.quit)
+		return;
+
+	ReplayMessages(bot, players, stats, rng, now);
+
+	if (bot.playerNum >= 0 && (now - bot.lastCPUUsageTime) >= spring_secs(1)) {
+		bot.conn->SendData(CBaseNetProtocol::Get().SendCPUUsage(FLAGS_cpuusage));
+		bot.lastCPUUsageTime = now;
+	}
+
+	bot.conn->Update();
+
+	if (bot.conn->CheckTimeout()) {
+		LOG_L(L_WARNING, "[%s] client \"%s\" timed out", __func__, bot.name.c_str());
+		bot.quit = true;
+	}
+}
+
+
+static bool ConnectBot(Bot& bot, const asio::ip::udp::endpoint& serverAddr)
+{
+	asio::error_code err;
+
+	bot.socket = std::make_shared<asio::ip::udp::socket>(netcode::netservice);
+	bot.socket->open(serverAddr.protocol(), err);
+
+	if (!err)
+		bot.socket->bind(asio::ip::udp::endpoint(netcode::GetAnyAddress(serverAddr.address().is_v6()), 0), err);
+
+	if (err) {
+		LOG_L(L_ERROR, "[%s] could not open a socket for client \"%s\": %s", __func__, bot.name.c_str(), err.message().c_str());
+		return false;
+	}
+
+	bot.conn.reset(new netcode::UDPConnection(bot.socket, serverAddr));
+	bot.conn->Unmute();
+	bot.conn->SendData(CBaseNetProtocol::Get().SendAttemptConnect(bot.name, FLAGS_password, SpringVersion::GetFull(), globalConfig->networkLossFactor));
+	bot.conn->Flush(true);
+
+	bot.lastFrameTime = spring_gettime();
+	bot.lastCPUUsageTime = spring_gettime();
+	return true;
+}
+
+
+/// user+system time of a process, in seconds
+static float GetProcessCPUTime(int pid)
+{
+#ifdef __linux__
+	char path[64];
+	snprintf(path, sizeof(path), "/proc/%d/stat", pid);
+
+	FILE* file = fopen(path, "r");
+
+	if (file == nullptr)
+		return -1.0f;
+
+	unsigned long utime = 0;
+	unsigned long stime = 0;
+	// skip pid, comm (a parenthesized name without spaces for engine binaries) and 11 more fields
+	const int numRead = fscanf(file, "%*d %*s %*c %*d %*d %*d %*d %*d %*u %*u %*u %*u %*u %lu %lu", &utime, &stime);
+
+	fclose(file);
+
+	if (numRead != 2)
+		return -1.0f;
+
+	return ((utime + stime) / float(sysconf(_SC_CLK_TCK)));
+#else
+	return -1.0f;
+#endif
+}
+
+
+static void PrintIntervals(const Stats& stats)
+{
+	uint64_t numIntervals = 0;
+
+	for (const uint64_t n: stats.intervals) {
+		numIntervals += n;
+	}
+
+	if (numIntervals == 0)
+		return;
+
+	constexpr float quantiles[] = {0.5f, 0.9f, 0.99f, 0.999f};
+
+	std::cout << "frame arrival intervals (ms):";
+
+	for (const float q: quantiles) {
+		const uint64_t rank = uint64_t(q * numIntervals);
+		uint64_t sum = 0;
+		unsigned int binIdx = 0;
+
+		while (binIdx < (NUM_INTERVAL_BINS - 1) && (sum += stats.intervals[binIdx]) <= rank) {
+			binIdx++;
+		}
+
+		std::cout << " p" << (q * 100.0f) << "=" << binIdx;
+	}
+
+	unsigned int maxBinIdx = NUM_INTERVAL_BINS - 1;
+
+	while (maxBinIdx > 0 && stats.intervals[maxBinIdx] == 0) {
+		maxBinIdx--;
+	}
+
+	std::cout << " max=" << maxBinIdx << ((maxBinIdx == (NUM_INTERVAL_BINS - 1))? "+": "") << std::endl;
+}
+
+
+int main(int argc, char* argv[])
+{
+	gflags::SetUsageMessage(std::string("Usage: ") + argv[0] + " [options] --demofile=path_to_demo.sdfz");
+	gflags::ParseCommandLineFlags(&argc, &argv, true);
+
+	if (FLAGS_demofile.empty()) {
+		std::cout << "No demofile given" << std::endl;
+		gflags::ShowUsageWithFlags(argv[0]);
+		return 1;
+	}
+
+	spring_clock::PushTickRate();
+	spring_time::setstarttime(spring_time::gettime(true));
+
+	std::vector<RecordedPlayer> players;
+	int lastDemoFrameNum = 0;
+
+	try {
+		CDemoReader reader(FLAGS_demofile, 0.0f);
+
+		if (!FLAGS_writescript.empty()) {
+			FILE* file = fopen(FLAGS_writescript.c_str(), "w");
+
+			if (file == nullptr) {
+				std::cout << "Could not open " << FLAGS_writescript << std::endl;
+				return 1;
+			}
+
+			fputs(reader.GetSetupScript().c_str(), file);
+			fclose(file);
+			return 0;
+		}
+
+		if (!ReadDemo(reader, players, lastDemoFrameNum)) {
+			std::cout << "Demo contains no player messages to replay" << std::endl;
+			return 1;
+		}
+	} catch (const std::exception& ex) {
+		std::cout << "Could not read " << FLAGS_demofile << ": " << ex.what() << std::endl;
+		return 1;
+	}
+
+	FileSystemInitializer::PreInitializeConfigHandler(FLAGS_config);
+	GlobalConfig::Instantiate();
+
+	asio::error_code err;
+	const asio::ip::udp::endpoint serverAddr = netcode::ResolveAddr(FLAGS_host, FLAGS_port, &err);
+
+	if (err) {
+		std::cout << "Could not resolve " << FLAGS_host << ": " << err.message() << std::endl;
+		return 1;
+	}
+
+	const int numPlayers = (FLAGS_numplayers < 0)? players.size(): FLAGS_numplayers;
+	const int numBots = std::max(0, numPlayers) + std::max(0, FLAGS_numspectators);
+
+	std::vector<Bot> bots(numBots);
+
+	for (int i = 0; i < numBots; i++) {
+		Bot& bot = bots[i];
+
+		if (i < numPlayers) {
+			bot.recordedPlayer = i % players.size();
+			bot.name = players[bot.recordedPlayer].name;
+
+			// unknown names join as spectators, but still send their streams
+			if (i >= int(players.size()))
+				bot.name += "_" + std::to_string(i / players.size());
+		} else {
+			bot.name = "LoadSpectator" + std::to_string(i - numPlayers);
+		}
+	}
+
+	std::cout << "Replaying " << players.size() << " recorded players (" << lastDemoFrameNum << " frames) with "
+	          << numPlayers << " clients and " << FLAGS_numspectators << " spectators against " << FLAGS_host << ":" << FLAGS_port << std::endl;
+
+	std::mt19937 rng(FLAGS_seed);
+	Stats stats;
+	stats.intervals.fill(0);
+
+	const spring_time startTime = spring_gettime();
+	const float serverStartCPUTime = (FLAGS_serverpid > 0)? GetProcessCPUTime(FLAGS_serverpid): -1.0f;
+
+	spring_time lastReportTime = startTime;
+	spring_time lastConnectTime = startTime - spring_msecs(FLAGS_connectinterval);
+
+	float lastServerCPUTime = serverStartCPUTime;
+	unsigned int lastBytesSent = 0;
+	unsigned int lastBytesRecv = 0;
+	int numConnected = 0;
+
+	while (true) {
+		const spring_time now = spring_gettime();
+
+		if (numConnected < numBots && (now - lastConnectTime) >= spring_msecs(FLAGS_connectinterval)) {
+			bots[numConnected].quit = !ConnectBot(bots[numConnected], serverAddr);
+			numConnected += 1;
+			lastConnectTime = now;
+		}
+
+		netcode::netservice.poll();
+
+		int numActive = 0;
+
+		for (int i = 0; i < numConnected; i++) {
+			if (bots[i].quit)
+				continue;
+
+			UpdateBot(bots[i], i == 0, players, stats, rng, now);
+			numActive += (!bots[i].quit);
+		}
+
+		if (numConnected == numBots && numActive == 0)
+			break;
+		if (stats.gameOver)
+			break;
+		if (FLAGS_duration > 0 && (now - startTime) >= spring_secs(FLAGS_duration))
+			break;
+		if (FLAGS_duration <= 0 && stats.maxFrameNum > lastDemoFrameNum)
+			break;
+
+		if ((now - lastReportTime) >= spring_secs(1)) {
+			const float dt = (now - lastReportTime).toSecsf();
+
+			unsigned int bytesSent = 0;
+			unsigned int bytesRecv = 0;
+			float maxRTT = 0.0f;
+
+			for (int i = 0; i < numConnected; i++) {
+				if (bots[i].conn == nullptr)
+					continue;
+
+				bytesSent += bots[i].conn->GetDataSent();
+				bytesRecv += bots[i].conn->GetDataReceived();
+				maxRTT = std::max(maxRTT, bots[i].conn->GetLinkStats().rtt);
+			}
+
+			const float serverCPUTime = (FLAGS_serverpid > 0)? GetProcessCPUTime(FLAGS_serverpid): -1.0f;
+
+			char line[256];
+			snprintf(line, sizeof(line), "t=%5.1fs clients=%d frame=%d speed=%.2f server-cpu=%5.1f%% in=%.1fKB/s out=%.1fKB/s max-rtt=%.0fms max-ping=%dms",
+				(now - startTime).toSecsf(), numActive, stats.maxFrameNum, stats.curSpeed,
+				(serverCPUTime >= 0.0f)? (serverCPUTime - lastServerCPUTime) * 100.0f / dt: 0.0f,
+				(bytesRecv - lastBytesRecv) / (1024.0f * dt),
+				(bytesSent - lastBytesSent) / (1024.0f * dt),
+				maxRTT, stats.maxPing
+			);
+			std::cout << line << std::endl;
+
+			lastReportTime = now;
+			lastServerCPUTime = serverCPUTime;
+			lastBytesSent = bytesSent;
+			lastBytesRecv = bytesRecv;
+		}
+
+		spring_msecs(1).sleep(true);
+	}
+
+	const float runTime = (spring_gettime() - startTime).toSecsf();
+	const float serverCPUTime = (FLAGS_serverpid > 0)? GetProcessCPUTime(FLAGS_serverpid): -1.0f;
+
+	uint64_t bytesSent = 0;
+	uint64_t bytesRecv = 0;
+
+	for (Bot& bot: bots) {
+		if (bot.conn == nullptr)
+			continue;
+
+		bot.conn->SendData(CBaseNetProtocol::Get().SendQuit("netloadtool finished"));
+		bot.conn->Flush(true);
+
+		bytesSent += bot.conn->GetDataSent();
+		bytesRecv += bot.conn->GetDataReceived();
+	}
+
+	std::cout << std::endl;
+	std::cout << "ran " << runTime << "s, " << stats.numFrames << " frames (" << (stats.numFrames / std::max(runTime, 1.0f)) << "/s), reached frame " << stats.maxFrameNum << std::endl;
+	std::cout << "replayed " << stats.numReplayedMessages << " messages, dropped " << stats.numDroppedDatagrams << " datagrams" << std::endl;
+	std::cout << "traffic: in " << (bytesRecv / 1024) << "KB, out " << (bytesSent / 1024) << "KB over " << numBots << " clients" << std::endl;
+	std::cout << "lag protection: min speed " << ((stats.minSpeed > 1e8f)? 1.0f: stats.minSpeed) << ", " << stats.numSpeedChanges << " speed changes, max ping " << stats.maxPing << "ms" << std::endl;
+
+	if (serverStartCPUTime >= 0.0f && serverCPUTime >= 0.0f)
+		std::cout << "server cpu: " << ((serverCPUTime - serverStartCPUTime) * 100.0f / std::max(runTime, 1.0f)) << "%" << std::endl;
+
+	PrintIntervals(stats);
+
+	bots.clear();
+
+	GlobalConfig::Deallocate();
+	ConfigHandler::Deallocate();
+	DataDirLocater::FreeInstance();
+
+	spring_clock::PopTickRate();
+	return 0;
+}
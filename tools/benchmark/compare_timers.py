@@ -0,0 +1,89 @@
+#!/usr/bin/python3
+#
+# Compares the "timer" records of two --demo-batch --batch-timers runs (see
+# sim_benchmark.sh) and flags every timer whose per-frame time regressed.
+#
+# usage: ./compare_timers.py [options] baseline.jsonl results.jsonl
+#
+# A timer regressed if one of the compared percentiles grew by more than the
+# relative *and* the absolute threshold; both are needed since short timers
+# are noisy in relative terms and long ones in absolute terms. Demos whose
+# replays ended in a different frame are reported as well, their timings are
+# not comparable. Exits with 1 if anything regressed.
+
+import argparse
+import json
+import sys
+
+
+def read_records(path):
+	timers = {}
+	ends = {}
+
+	with open(path) as f:
+		for line in f:
+			line = line.strip()
+
+			if not line:
+				continue
+
+			rec = json.loads(line)
+
+			if rec["type"] == "timer":
+				timers[(rec["demo"], rec["timer"])] = rec
+			elif rec["type"] == "end":
+				ends[rec["demo"]] = rec
+
+	return timers, ends
+
+
+def main():
+	parser = argparse.ArgumentParser(description = "flag per-frame timer regressions between two benchmark runs")
+	parser.add_argument("baseline")
+	parser.add_argument("results")
+	parser.add_argument("--relative", type = float, default = 0.10, help = "relative growth threshold (default 0.10)")
+	parser.add_argument("--absolute", type = float, default = 0.05, help = "absolute growth threshold in ms (default 0.05)")
+	parser.add_argument("--keys", default = "mean,p50,p90,p99", help = "compared statistics (default mean,p50,p90,p99)")
+	parser.add_argument("--output", help = "also write the comparison as JSON to this file")
+	args = parser.parse_args()
+
+	baseTimers, baseEnds = read_records(args.baseline)
+	curTimers, curEnds = read_records(args.results)
+
+	keys = args.keys.split(",")
+	rows = []
+	regressed = False
+
+	for demo in sorted(set(baseEnds) & set(curEnds)):
+		if baseEnds[demo]["frame"] != curEnds[demo]["frame"]:
+			print("%s: replay ended in frame %d instead of %d" % (demo, curEnds[demo]["frame"], baseEnds[demo]["frame"]))
+			regressed = True
+
+	for demo in sorted(set(baseEnds) ^ set(curEnds)):
+		print("%s: only replayed in %s" % (demo, args.baseline if demo in baseEnds else args.results))
+
+	for key in sorted(set(baseTimers) & set(curTimers)):
+		base = baseTimers[key]
+		cur = curTimers[key]
+
+		for stat in keys:
+			delta = cur[stat] - base[stat]
+			ratio = (delta / base[stat]) if base[stat] > 0.0 else 0.0
+			worse = (delta > args.absolute and ratio > args.relative)
+
+			rows.append({"demo": key[0], "timer": key[1], "stat": stat, "baseline": base[stat], "current": cur[stat], "ratio": ratio, "regressed": worse})
+			regressed |= worse
+
+			if worse:
+				print("%s: %s %s %.4fms -> %.4fms (%+.1f%%)" % (key[0], key[1], stat, base[stat], cur[stat], ratio * 100.0))
+
+	if args.output:
+		with open(args.output, "w") as f:
+			json.dump({"regressed": regressed, "comparisons": rows}, f, indent = 1)
+
+	print("%d timer statistics compared, %s" % (len(rows), "REGRESSIONS FOUND" if regressed else "no regressions"))
+	return (1 if regressed else 0)
+
+
+if __name__ == "__main__":
+	sys.exit(main())
@@ -0,0 +1,29 @@
+#!/bin/bash
+#
+# Replays a fixed set of demos in the headless engine as fast as possible and
+# compares the per-frame timer percentiles against a stored baseline.
+#
+# usage: ./sim_benchmark.sh <spring-headless> <results.jsonl> [baseline.jsonl] [demo-list]
+#
+# Without a baseline the results are only written; keep them as the baseline
+# of later runs. The exit code is non-zero if a replay failed or a timer
+# regressed (see compare_timers.py for the thresholds).
+
+set -e
+
+if [ $# -lt 2 ]; then
+	echo "Usage: $0 <spring-headless> <results.jsonl> [baseline.jsonl] [demo-list]"
+	exit 1
+fi
+
+SPRING="$1"
+RESULTS="$2"
+BASELINE="$3"
+DEMOLIST="${4:-$(dirname "$0")/sim_benchmark_demos.txt}"
+
+# one demo at a time, concurrent replays would skew each other's timings
+"$SPRING" --demo-batch "$DEMOLIST" --batch-output "$RESULTS" --batchjobs 1 --batch-unlimited --batch-timers
+
+if [ -n "$BASELINE" ]; then
+	python3 "$(dirname "$0")/compare_timers.py" "$BASELINE" "$RESULTS"
+fi
@@ -331,12 +331,14 @@ public:
 
 
 static void internal_deleteMapInfos();
+static void internal_deleteMinimaps();
 static UnitsyncConfigObserver* unitsyncConfigObserver = nullptr;
 
 static void _Cleanup()
 {
 	spring::SafeDelete(unitsyncConfigObserver);
 	internal_deleteMapInfos();
+	internal_deleteMinimaps();
 
 	lpClose();
 	LOG("deinitialized");
@@ -983,6 +985,22 @@ static unsigned short* GetMinimapSMF(std::string mapFileName, int mipLevel)
 	return colors;
 }
 
+// decoded minimaps, least recently used first; lobbies tend to request
+// the same handful of maps over and over while browsing, and every miss
+// mounts the map archive and decompresses its minimap
+struct CachedMinimap {
+	std::string mapName;
+	int mipLevel;
+	std::vector<unsigned short> pixels;
+};
+
+static constexpr size_t MAX_CACHED_MINIMAPS = 16;
+static std::vector<CachedMinimap> cachedMinimaps;
+
+static void internal_deleteMinimaps() {
+	cachedMinimaps.clear();
+}
+
 EXPORT(unsigned short*) GetMinimap(const char* mapName, int mipLevel)
 {
 	try {
@@ -992,6 +1010,16 @@ EXPORT(unsigned short*) GetMinimap(const char* mapName, int mipLevel)
 		if (mipLevel < 0 || mipLevel > 8)
 			throw std::out_of_range("Miplevel must be between 0 and 8 (inclusive) in GetMinimap.");
 
+		const auto it = std::find_if(cachedMinimaps.begin(), cachedMinimaps.end(), [&](const CachedMinimap& cm) {
+			return (cm.mipLevel == mipLevel && cm.mapName == mapName);
+		});
+
+		if (it != cachedMinimaps.end()) {
+			// moving keeps the pixel buffer (and pointers into it) intact
+			std::rotate(it, it + 1, cachedMinimaps.end());
+			return (cachedMinimaps.back().pixels.data());
+		}
+
 		const std::string mapFile = GetMapFile(mapName);
 		ScopedMapLoader mapLoader(mapName, mapFile);
 
@@ -1003,7 +1031,16 @@ EXPORT(unsigned short*) GetMinimap(const char* mapName, int mipLevel)
 			ret = GetMinimapSM3(mapFile, mipLevel);
 		}
 
-		return ret;
+		if (ret == NULL)
+			return ret;
+
+		if (cachedMinimaps.size() == MAX_CACHED_MINIMAPS)
+			cachedMinimaps.erase(cachedMinimaps.begin());
+
+		const size_t mipSize = 1024 >> mipLevel;
+
+		cachedMinimaps.push_back({mapName, mipLevel, std::vector<unsigned short>(ret, ret + mipSize * mipSize)});
+		return (cachedMinimaps.back().pixels.data());
 	}
 	UNITSYNC_CATCH_BLOCKS;
 	return NULL;
@@ -352,6 +352,8 @@ EXPORT(unsigned int) GetMapChecksumFromName(const char* mapName);
  * @return A pointer to a static memory area containing the minimap as a 16 bit
  * packed RGB-565 (MSB to LSB: 5 bits red, 6 bits green, 5 bits blue) linear
  * bitmap on success; NULL on error.
+ * Recently requested minimaps are cached until the next Init or UnInit call,
+ * the returned memory stays valid at least until the next GetMinimap call.
  *
  * An example usage would be GetMinimap("SmallDivide", 2).
  * This would return a 16 bit packed RGB-565 256x256 (= 1024/2^2) bitmap.